@@ -19,6 +19,9 @@ HLSEnableNSManagedObjectValidation();
 // Enable preloading
 HLSEnableApplicationPreloading();
 
+// Display dates in the system time zone as well when logging them
+HLSEnableNSDateSystemTimeZoneDescription();
+
 @interface CoconutKit_demoAppDelegate ()
 
 @property (nonatomic, retain) CoconutKit_demoApplication *application;
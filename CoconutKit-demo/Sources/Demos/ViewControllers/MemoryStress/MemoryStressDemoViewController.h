@@ -0,0 +1,27 @@
+//
+//  MemoryStressDemoViewController.h
+//  CoconutKit-demo
+//
+//  Created by Samuel Défago on 15.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+/**
+ * Automated memory stress test for CoconutKit containers. An HLSStackController, an HLSPlaceholderViewController
+ * and an HLSWizardViewController are successively displayed and subjected to a randomized sequence of operations
+ * (push, pop, insertion and removal for the stack, inset swapping for the placeholder, page hopping for the wizard).
+ * Each phase ends with a simulated memory warning, after which the resident memory and the number of live view
+ * controllers and loaded views are reported. The same figures are reported again once the container has been
+ * removed, so that leaked view controllers or views are easily spotted
+ *
+ * Designated initializer: -init
+ */
+@interface MemoryStressDemoViewController : HLSPlaceholderViewController {
+@private
+    UIButton *m_startButton;
+    UITextView *m_reportTextView;
+    NSUInteger m_phase;
+    NSUInteger m_remainingOperations;
+}
+
+@end
@@ -0,0 +1,490 @@
+//
+//  MemoryStressDemoViewController.m
+//  CoconutKit-demo
+//
+//  Created by Samuel Défago on 15.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "MemoryStressDemoViewController.h"
+
+#import <mach/mach.h>
+
+typedef enum {
+    MemoryStressPhaseIndexEnumBegin = 0,
+    MemoryStressPhaseIndexStack = MemoryStressPhaseIndexEnumBegin,
+    MemoryStressPhaseIndexPlaceholder,
+    MemoryStressPhaseIndexWizard,
+    MemoryStressPhaseIndexEnumEnd,
+    MemoryStressPhaseIndexEnumSize = MemoryStressPhaseIndexEnumEnd - MemoryStressPhaseIndexEnumBegin
+} MemoryStressPhaseIndex;
+
+static const NSUInteger kMemoryStressOperationCount = 60;
+static const NSUInteger kMemoryStressStackMaxCount = 12;
+static const NSUInteger kMemoryStressWizardPageCount = 10;
+static const size_t kMemoryStressPageBlockSize = 1024 * 1024;
+
+static NSUInteger s_livePageViewControllerCount = 0;
+static NSUInteger s_loadedPageViewCount = 0;
+
+/**
+ * Page view controller used during stress tests. Each loaded view holds a 1 MB block of resident memory, and the
+ * number of live instances and loaded views is tracked
+ */
+@interface MemoryStressPageViewController : HLSViewController {
+@private
+    void *m_block;
+}
+
+@end
+
+/**
+ * Placeholder view controller with two side-by-side placeholder views
+ */
+@interface MemoryStressPlaceholderViewController : HLSPlaceholderViewController
+
+@end
+
+/**
+ * Wizard view controller without buttons, whose pages are changed programmatically
+ */
+@interface MemoryStressWizardViewController : HLSWizardViewController
+
+@end
+
+@interface MemoryStressDemoViewController ()
+
+@property (nonatomic, retain) UIButton *startButton;
+@property (nonatomic, retain) UITextView *reportTextView;
+
+- (NSString *)nameForPhase:(MemoryStressPhaseIndex)phase;
+- (UIViewController *)containerViewControllerForPhase:(MemoryStressPhaseIndex)phase;
+
+- (void)beginPhase;
+- (void)performOperation;
+- (void)performStackOperation:(HLSStackController *)stackController;
+- (void)performPlaceholderOperation:(HLSPlaceholderViewController *)placeholderViewController;
+- (void)performWizardOperation:(HLSWizardViewController *)wizardViewController;
+- (void)endPhase;
+- (void)endTeardown;
+
+- (void)reportWithTitle:(NSString *)title;
+
+- (void)start:(id)sender;
+
+@end
+
+@implementation MemoryStressPageViewController
+
+#pragma mark Object creation and destruction
+
+- (id)init
+{
+    if ((self = [super init])) {
+        ++s_livePageViewControllerCount;
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    --s_livePageViewControllerCount;
+
+    [super dealloc];
+}
+
+- (void)releaseViews
+{
+    [super releaseViews];
+
+    if (m_block) {
+        free(m_block);
+        m_block = NULL;
+
+        --s_loadedPageViewCount;
+    }
+}
+
+#pragma mark View lifecycle
+
+- (void)loadView
+{
+    self.view = [[[UIView alloc] initWithFrame:[[UIScreen mainScreen] applicationFrame]] autorelease];
+    self.view.autoresizingMask = UIViewAutoresizingFlexibleWidth | UIViewAutoresizingFlexibleHeight;
+}
+
+- (void)viewDidLoad
+{
+    [super viewDidLoad];
+
+    self.view.backgroundColor = [UIColor randomColor];
+
+    // Touch the memory so that it is really resident
+    if (! m_block) {
+        m_block = malloc(kMemoryStressPageBlockSize);
+        memset(m_block, 0xff, kMemoryStressPageBlockSize);
+
+        ++s_loadedPageViewCount;
+    }
+}
+
+@end
+
+@implementation MemoryStressPlaceholderViewController
+
+#pragma mark View lifecycle
+
+- (void)loadView
+{
+    self.view = [[[UIView alloc] initWithFrame:[[UIScreen mainScreen] applicationFrame]] autorelease];
+    self.view.autoresizingMask = UIViewAutoresizingFlexibleWidth | UIViewAutoresizingFlexibleHeight;
+
+    CGFloat halfWidth = floorf(CGRectGetWidth(self.view.bounds) / 2.f);
+    UIView *leftPlaceholderView = [[[UIView alloc] initWithFrame:CGRectMake(0.f,
+                                                                            0.f,
+                                                                            halfWidth,
+                                                                            CGRectGetHeight(self.view.bounds))] autorelease];
+    leftPlaceholderView.autoresizingMask = UIViewAutoresizingFlexibleRightMargin | UIViewAutoresizingFlexibleWidth | UIViewAutoresizingFlexibleHeight;
+    leftPlaceholderView.tag = 0;
+    [self.view addSubview:leftPlaceholderView];
+
+    UIView *rightPlaceholderView = [[[UIView alloc] initWithFrame:CGRectMake(halfWidth,
+                                                                             0.f,
+                                                                             CGRectGetWidth(self.view.bounds) - halfWidth,
+                                                                             CGRectGetHeight(self.view.bounds))] autorelease];
+    rightPlaceholderView.autoresizingMask = UIViewAutoresizingFlexibleLeftMargin | UIViewAutoresizingFlexibleWidth | UIViewAutoresizingFlexibleHeight;
+    rightPlaceholderView.tag = 1;
+    [self.view addSubview:rightPlaceholderView];
+
+    self.placeholderViews = [NSArray arrayWithObjects:leftPlaceholderView, rightPlaceholderView, nil];
+}
+
+@end
+
+@implementation MemoryStressWizardViewController
+
+#pragma mark View lifecycle
+
+- (void)loadView
+{
+    self.view = [[[UIView alloc] initWithFrame:[[UIScreen mainScreen] applicationFrame]] autorelease];
+    self.view.autoresizingMask = UIViewAutoresizingFlexibleWidth | UIViewAutoresizingFlexibleHeight;
+
+    UIView *placeholderView = [[[UIView alloc] initWithFrame:self.view.bounds] autorelease];
+    placeholderView.autoresizingMask = UIViewAutoresizingFlexibleWidth | UIViewAutoresizingFlexibleHeight;
+    [self.view addSubview:placeholderView];
+
+    self.placeholderViews = [NSArray arrayWithObject:placeholderView];
+}
+
+@end
+
+@implementation MemoryStressDemoViewController
+
+#pragma mark Object creation and destruction
+
+- (void)releaseViews
+{
+    [super releaseViews];
+
+    self.startButton = nil;
+    self.reportTextView = nil;
+}
+
+#pragma mark Accessors and mutators
+
+@synthesize startButton = m_startButton;
+
+@synthesize reportTextView = m_reportTextView;
+
+#pragma mark View lifecycle
+
+- (void)loadView
+{
+    self.view = [[[UIView alloc] initWithFrame:[[UIScreen mainScreen] applicationFrame]] autorelease];
+    self.view.autoresizingMask = UIViewAutoresizingFlexibleWidth | UIViewAutoresizingFlexibleHeight;
+    self.view.backgroundColor = [UIColor whiteColor];
+
+    CGFloat width = CGRectGetWidth(self.view.bounds);
+    CGFloat height = CGRectGetHeight(self.view.bounds);
+    CGFloat placeholderHeight = floorf(height / 3.f);
+
+    UIView *placeholderView = [[[UIView alloc] initWithFrame:CGRectMake(0.f, 0.f, width, placeholderHeight)] autorelease];
+    placeholderView.autoresizingMask = UIViewAutoresizingFlexibleWidth | UIViewAutoresizingFlexibleBottomMargin;
+    placeholderView.clipsToBounds = YES;
+    [self.view addSubview:placeholderView];
+    self.placeholderViews = [NSArray arrayWithObject:placeholderView];
+
+    self.startButton = [UIButton buttonWithType:UIButtonTypeRoundedRect];
+    self.startButton.frame = CGRectMake(10.f, placeholderHeight + 10.f, width - 20.f, 37.f);
+    self.startButton.autoresizingMask = UIViewAutoresizingFlexibleWidth | UIViewAutoresizingFlexibleBottomMargin;
+    [self.startButton addTarget:self action:@selector(start:) forControlEvents:UIControlEventTouchUpInside];
+    [self.view addSubview:self.startButton];
+
+    CGFloat reportOriginY = CGRectGetMaxY(self.startButton.frame) + 10.f;
+    self.reportTextView = [[[UITextView alloc] initWithFrame:CGRectMake(0.f, reportOriginY, width, height - reportOriginY)] autorelease];
+    self.reportTextView.autoresizingMask = UIViewAutoresizingFlexibleWidth | UIViewAutoresizingFlexibleHeight;
+    self.reportTextView.editable = NO;
+    self.reportTextView.font = [UIFont fontWithName:@"Courier" size:12.f];
+    [self.view addSubview:self.reportTextView];
+}
+
+- (void)viewDidDisappear:(BOOL)animated
+{
+    [super viewDidDisappear:animated];
+
+    // Stop a running test
+    [NSObject cancelPreviousPerformRequestsWithTarget:self];
+    [self setInsetViewController:nil atIndex:0];
+    self.startButton.enabled = YES;
+}
+
+#pragma mark Phases
+
+- (NSString *)nameForPhase:(MemoryStressPhaseIndex)phase
+{
+    switch (phase) {
+        case MemoryStressPhaseIndexStack: {
+            return @"HLSStackController";
+            break;
+        }
+
+        case MemoryStressPhaseIndexPlaceholder: {
+            return @"HLSPlaceholderViewController";
+            break;
+        }
+
+        case MemoryStressPhaseIndexWizard: {
+            return @"HLSWizardViewController";
+            break;
+        }
+
+        default: {
+            return nil;
+            break;
+        }
+    }
+}
+
+- (UIViewController *)containerViewControllerForPhase:(MemoryStressPhaseIndex)phase
+{
+    switch (phase) {
+        case MemoryStressPhaseIndexStack: {
+            MemoryStressPageViewController *rootViewController = [[[MemoryStressPageViewController alloc] init] autorelease];
+            return [[[HLSStackController alloc] initWithRootViewController:rootViewController] autorelease];
+            break;
+        }
+
+        case MemoryStressPhaseIndexPlaceholder: {
+            return [[[MemoryStressPlaceholderViewController alloc] init] autorelease];
+            break;
+        }
+
+        case MemoryStressPhaseIndexWizard: {
+            NSMutableArray *pageViewControllers = [NSMutableArray array];
+            for (NSUInteger i = 0; i < kMemoryStressWizardPageCount; ++i) {
+                [pageViewControllers addObject:[[[MemoryStressPageViewController alloc] init] autorelease]];
+            }
+
+            MemoryStressWizardViewController *wizardViewController = [[[MemoryStressWizardViewController alloc] init] autorelease];
+            wizardViewController.viewControllers = [NSArray arrayWithArray:pageViewControllers];
+            return wizardViewController;
+            break;
+        }
+
+        default: {
+            return nil;
+            break;
+        }
+    }
+}
+
+// Each step is performed during a separate run loop iteration, so that transitions can complete and autoreleased
+// objects get released in between
+- (void)beginPhase
+{
+    if (m_phase == MemoryStressPhaseIndexEnumEnd) {
+        [self reportWithTitle:NSLocalizedString(@"Done", @"Done")];
+        self.startButton.enabled = YES;
+        return;
+    }
+
+    [self setInsetViewController:[self containerViewControllerForPhase:m_phase] atIndex:0];
+    m_remainingOperations = kMemoryStressOperationCount;
+    [self performSelector:@selector(performOperation) withObject:nil afterDelay:0.];
+}
+
+- (void)performOperation
+{
+    if (m_remainingOperations == 0) {
+        [[NSNotificationCenter defaultCenter] postNotificationName:UIApplicationDidReceiveMemoryWarningNotification
+                                                            object:[UIApplication sharedApplication]];
+        [self performSelector:@selector(endPhase) withObject:nil afterDelay:0.];
+        return;
+    }
+
+    UIViewController *containerViewController = [self insetViewControllerAtIndex:0];
+    switch (m_phase) {
+        case MemoryStressPhaseIndexStack: {
+            [self performStackOperation:(HLSStackController *)containerViewController];
+            break;
+        }
+
+        case MemoryStressPhaseIndexPlaceholder: {
+            [self performPlaceholderOperation:(HLSPlaceholderViewController *)containerViewController];
+            break;
+        }
+
+        case MemoryStressPhaseIndexWizard: {
+            [self performWizardOperation:(HLSWizardViewController *)containerViewController];
+            break;
+        }
+
+        default: {
+            break;
+        }
+    }
+
+    --m_remainingOperations;
+    [self performSelector:@selector(performOperation) withObject:nil afterDelay:0.];
+}
+
+- (void)performStackOperation:(HLSStackController *)stackController
+{
+    NSUInteger count = [stackController count];
+    switch (arc4random() % 4) {
+        case 0: {
+            if (count < kMemoryStressStackMaxCount) {
+                [stackController pushViewController:[[[MemoryStressPageViewController alloc] init] autorelease]
+                                withTransitionClass:[HLSTransitionNone class]
+                                           animated:NO];
+            }
+            break;
+        }
+
+        case 1: {
+            if (count > 1) {
+                [stackController popViewControllerAnimated:NO];
+            }
+            break;
+        }
+
+        case 2: {
+            if (count < kMemoryStressStackMaxCount) {
+                // Index 0 (root) is invalid for insertion
+                NSUInteger index = 1 + arc4random() % count;
+                [stackController insertViewController:[[[MemoryStressPageViewController alloc] init] autorelease]
+                                              atIndex:index
+                                  withTransitionClass:[HLSTransitionNone class]
+                                             duration:kAnimationTransitionDefaultDuration
+                                             animated:NO];
+            }
+            break;
+        }
+
+        case 3: {
+            if (count > 1) {
+                NSUInteger index = 1 + arc4random() % (count - 1);
+                [stackController removeViewControllerAtIndex:index animated:NO];
+            }
+            break;
+        }
+
+        default: {
+            break;
+        }
+    }
+}
+
+- (void)performPlaceholderOperation:(HLSPlaceholderViewController *)placeholderViewController
+{
+    NSUInteger index = arc4random() % 2;
+
+    // Remove the inset once in a while
+    UIViewController *insetViewController = nil;
+    if (arc4random() % 4 != 0) {
+        insetViewController = [[[MemoryStressPageViewController alloc] init] autorelease];
+    }
+    [placeholderViewController setInsetViewController:insetViewController atIndex:index];
+}
+
+- (void)performWizardOperation:(HLSWizardViewController *)wizardViewController
+{
+    [wizardViewController moveToPage:arc4random() % [wizardViewController.viewControllers count]];
+}
+
+- (void)endPhase
+{
+    [self reportWithTitle:[NSString stringWithFormat:NSLocalizedString(@"%@ after memory warning", @"%@ after memory warning"),
+                           [self nameForPhase:m_phase]]];
+
+    [self setInsetViewController:nil atIndex:0];
+    [self performSelector:@selector(endTeardown) withObject:nil afterDelay:0.];
+}
+
+- (void)endTeardown
+{
+    // No page view controller must survive its container
+    [self reportWithTitle:[NSString stringWithFormat:NSLocalizedString(@"%@ after removal", @"%@ after removal"),
+                           [self nameForPhase:m_phase]]];
+    if (s_livePageViewControllerCount != 0) {
+        HLSLoggerError(@"%d page view controllers leaked", s_livePageViewControllerCount);
+    }
+
+    ++m_phase;
+    [self performSelector:@selector(beginPhase) withObject:nil afterDelay:0.];
+}
+
+#pragma mark Reporting
+
+- (void)reportWithTitle:(NSString *)title
+{
+    struct task_basic_info info;
+    mach_msg_type_number_t infoCount = TASK_BASIC_INFO_COUNT;
+    kern_return_t result = task_info(mach_task_self(), TASK_BASIC_INFO, (task_info_t)&info, &infoCount);
+
+    NSString *residentSizeString = nil;
+    if (result == KERN_SUCCESS) {
+        residentSizeString = [NSString stringWithFormat:@"%.1f MB", info.resident_size / (1024. * 1024.)];
+    }
+    else {
+        residentSizeString = @"N/A";
+    }
+
+    NSString *report = [NSString stringWithFormat:@"%@\n"
+                        "  %@: %@\n"
+                        "  %@: %d\n"
+                        "  %@: %d\n",
+                        title,
+                        NSLocalizedString(@"Resident memory", @"Resident memory"), residentSizeString,
+                        NSLocalizedString(@"Live view controllers", @"Live view controllers"), s_livePageViewControllerCount,
+                        NSLocalizedString(@"Loaded views", @"Loaded views"), s_loadedPageViewCount];
+    HLSLoggerInfo(@"%@", report);
+
+    self.reportTextView.text = [self.reportTextView.text stringByAppendingString:report];
+}
+
+#pragma mark Event callbacks
+
+- (void)start:(id)sender
+{
+    self.startButton.enabled = NO;
+    self.reportTextView.text = @"";
+
+    [self reportWithTitle:NSLocalizedString(@"Baseline", @"Baseline")];
+
+    m_phase = MemoryStressPhaseIndexEnumBegin;
+    [self beginPhase];
+}
+
+#pragma mark Localization
+
+- (void)localize
+{
+    [super localize];
+
+    self.title = @"MemoryStressDemoViewController";
+    [self.startButton setTitle:NSLocalizedString(@"Start", @"Start") forState:UIControlStateNormal];
+}
+
+@end
@@ -9,7 +9,6 @@
 @interface TableSearchDisplayDemoViewController : HLSTableSearchDisplayViewController {
 @private
     NSArray *m_devices;
-    NSArray *m_filteredDevices;
 }
 
 @end
@@ -21,12 +21,11 @@ typedef enum {
     ScopeButtonIndexEnumSize = ScopeButtonIndexEnumEnd - ScopeButtonIndexEnumBegin
 } ScopeButtonIndex;
 
+static ScopeButtonIndex scopeButtonIndexForDeviceType(DeviceType deviceType);
+
 @interface TableSearchDisplayDemoViewController ()
 
 @property (nonatomic, retain) NSArray *devices;
-@property (nonatomic, retain) NSArray *filteredDevices;
-
-- (void)filterDevices;
 
 @end
 
@@ -70,6 +69,16 @@ typedef enum {
         [devices addObject:[DeviceInfo deviceInfoWithName:@"Samsung Galaxy Tab" type:DeviceTypeTablet]];
         
         self.devices = [NSArray arrayWithArray:devices];
+        
+        // Search devices by name using an index, on a background thread
+        HLSSearchIndex *searchIndex = [[[HLSSearchIndex alloc] initWithKeyPaths:[NSArray arrayWithObject:@"name"]] autorelease];
+        for (DeviceInfo *device in self.devices) {
+            NSMutableIndexSet *scopeButtonIndexes = [NSMutableIndexSet indexSetWithIndex:ScopeButtonIndexAll];
+            [scopeButtonIndexes addIndex:scopeButtonIndexForDeviceType(device.type)];
+            [searchIndex addObject:device scopeButtonIndexes:scopeButtonIndexes];
+        }
+        self.searchIndex = searchIndex;
+        self.searchingAsynchronously = YES;
     }
     return self;
 }
@@ -77,7 +86,6 @@ typedef enum {
 - (void)dealloc
 {
     self.devices = nil;
-    self.filteredDevices = nil;
     [super dealloc];
 }
 
@@ -85,8 +93,6 @@ typedef enum {
 
 @synthesize devices = m_devices;
 
-@synthesize filteredDevices = m_filteredDevices;
-
 #pragma mark UISearchDisplayDelegate protocol implementation
 
 - (void)searchDisplayControllerWillBeginSearch:(UISearchDisplayController *)controller
@@ -97,34 +103,12 @@ typedef enum {
     self.searchBar.selectedScopeButtonIndex = ScopeButtonIndexAll;
 }
 
-- (BOOL)searchDisplayController:(UISearchDisplayController *)controller shouldReloadTableForSearchString:(NSString *)searchString
-{
-    [super searchDisplayController:controller shouldReloadTableForSearchString:searchString];
-    
-    // Refresh the results
-    [self filterDevices];
-    
-    // Trigger a search result table view reload
-    return YES;
-}
-
-- (BOOL)searchDisplayController:(UISearchDisplayController *)controller shouldReloadTableForSearchScope:(NSInteger)searchOption
-{
-    [super searchDisplayController:controller shouldReloadTableForSearchScope:searchOption];
-    
-    // Refresh the results
-    [self filterDevices];
-    
-    // Trigger a search result table view reload
-    return YES;
-}
-
 #pragma mark UITableViewDataSource protocol implementation
 
 - (NSInteger)tableView:(UITableView *)tableView numberOfRowsInSection:(NSInteger)section
 {
     if (tableView == self.searchResultsTableView) {
-        return [self.filteredDevices count];
+        return [self.searchResults count];
     }
     else {
         return [self.devices count];
@@ -135,7 +119,7 @@ typedef enum {
 {   
     DeviceInfo *device = nil;
     if (tableView == self.searchResultsTableView) {
-        device = [self.filteredDevices objectAtIndex:indexPath.row];
+        device = [self.searchResults objectAtIndex:indexPath.row];
     }
     else {
         device = [self.devices objectAtIndex:indexPath.row];
@@ -171,70 +155,45 @@ typedef enum {
     }
 }
 
-#pragma mark Creating the search filter
+#pragma mark Localization
+
+- (void)localize
+{
+    [super localize];
+    
+    self.title = @"HLSTableSearchDisplayViewController";
+    self.searchBar.scopeButtonTitles = [NSArray arrayWithObjects:NSLocalizedString(@"All", @"All"),
+                                        NSLocalizedString(@"Music players", @"Music players"),
+                                        NSLocalizedString(@"Phones", @"Phones"),
+                                        NSLocalizedString(@"Tablets", @"Tablets"),
+                                        nil];
+}
+
+@end
+
+#pragma mark Static functions
 
-- (void)filterDevices
+static ScopeButtonIndex scopeButtonIndexForDeviceType(DeviceType deviceType)
 {
-    DeviceType deviceType;
-    switch (self.searchBar.selectedScopeButtonIndex) {            
-        case ScopeButtonIndexMusicPlayers: {
-            deviceType = DeviceTypeMusicPlayer;
+    switch (deviceType) {
+        case DeviceTypeMusicPlayer: {
+            return ScopeButtonIndexMusicPlayers;
             break;
         }
             
-        case ScopeButtonIndexPhones: {
-            deviceType = DeviceTypePhone;            
+        case DeviceTypePhone: {
+            return ScopeButtonIndexPhones;
             break;
         }
             
-        case ScopeButtonIndexTablets: {
-            deviceType = DeviceTypeTablet;
+        case DeviceTypeTablet: {
+            return ScopeButtonIndexTablets;
             break;
         }
             
-        case ScopeButtonIndexAll:
         default: {
-            deviceType = DeviceTypeAll;
+            return ScopeButtonIndexAll;
             break;
         }
     }
-    
-    NSString *pattern = self.searchBar.text;
-    NSMutableArray *filteredDevices = [NSMutableArray array];
-    for (DeviceInfo *device in self.devices) {
-        // Try to locate the pattern in the name (if any)
-        if ([pattern length] != 0) {
-            NSRange prefixRange = [device.name rangeOfString:pattern
-                                                     options:NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch];
-            if (prefixRange.length == 0) {
-                continue;
-            }        
-        }
-        
-        // Check against device type (if any)
-        if (deviceType != DeviceTypeAll && device.type != deviceType) {
-            continue;
-        }
-        
-        // All checks successful; matches the filter criteria
-        [filteredDevices addObject:device];
-    }
-    
-    self.filteredDevices = [NSArray arrayWithArray:filteredDevices];
 }
-
-#pragma mark Localization
-
-- (void)localize
-{
-    [super localize];
-    
-    self.title = @"HLSTableSearchDisplayViewController";
-    self.searchBar.scopeButtonTitles = [NSArray arrayWithObjects:NSLocalizedString(@"All", @"All"),
-                                        NSLocalizedString(@"Music players", @"Music players"),
-                                        NSLocalizedString(@"Phones", @"Phones"),
-                                        NSLocalizedString(@"Tablets", @"Tablets"),
-                                        nil];
-}
-
-@end
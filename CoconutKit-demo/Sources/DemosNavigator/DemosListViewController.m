@@ -15,6 +15,7 @@
 #import "FixedSizeViewController.h"
 #import "LabelDemoViewController.h"
 #import "LayerPropertiesTestViewController.h"
+#import "MemoryStressDemoViewController.h"
 #import "ParallaxScrollingDemoViewController.h"
 #import "ParallelProcessingDemoViewController.h"
 #import "PlaceholderDemoViewController.h"
@@ -91,6 +92,7 @@ typedef enum {
     ViewControllersDemoIndexTableSearchDisplayViewController,
     ViewControllersDemoIndexWebViewController,
     ViewControllersDemoIndexSegue,
+    ViewControllersDemoIndexMemoryStress,
     ViewControllersDemoIndexEnumEnd,
     ViewControllersDemoIndexEnumSize = ViewControllersDemoIndexEnumEnd - ViewControllersDemoIndexEnumBegin
 } ViewControllersDemoIndex;
@@ -387,6 +389,11 @@ typedef enum {
                     }
                     break;
                 }
+                    
+                case ViewControllersDemoIndexMemoryStress: {
+                    cell.textLabel.text = NSLocalizedString(@"Memory stress test", @"Memory stress test");
+                    break;
+                }
 
                 default: {
                     return nil;
@@ -563,6 +570,11 @@ typedef enum {
                     break;
                 }
                     
+                case ViewControllersDemoIndexMemoryStress: {
+                    demoViewController = [[[MemoryStressDemoViewController alloc] init] autorelease];
+                    break;
+                }
+                    
                 default: {
                     return;
                     break;
@@ -0,0 +1,50 @@
+//
+//  HLSAnimationGroupTestCase.m
+//  CoconutKit-test
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSAnimationGroupTestCase.h"
+
+@implementation HLSAnimationGroupTestCase
+
+#pragma mark Test setup and tear down
+
+- (BOOL)shouldRunOnMainThread
+{
+    // Layer animations are played on the main thread
+    return YES;
+}
+
+#pragma mark Tests
+
+- (void)testAnimationGroup
+{
+    CALayer *layer1 = [CALayer layer];
+    CALayer *layer2 = [CALayer layer];
+    
+    HLSLayerAnimationStep *animationStep1 = [HLSLayerAnimationStep animationStep];
+    HLSLayerAnimation *layerAnimation1 = [HLSLayerAnimation animation];
+    [layerAnimation1 addToOpacity:-0.5f];
+    [animationStep1 addLayerAnimation:layerAnimation1 forLayer:layer1];
+    
+    HLSLayerAnimationStep *animationStep2 = [HLSLayerAnimationStep animationStep];
+    animationStep2.duration = 0.4;
+    HLSLayerAnimation *layerAnimation2 = [HLSLayerAnimation animation];
+    [layerAnimation2 addToOpacity:-0.25f];
+    [animationStep2 addLayerAnimation:layerAnimation2 forLayer:layer2];
+    
+    HLSAnimationGroup *animationGroup = [HLSAnimationGroup animationGroup];
+    [animationGroup addAnimation:[HLSAnimation animationWithAnimationStep:animationStep1] withOffset:0.];
+    [animationGroup addAnimation:[HLSAnimation animationWithAnimationStep:animationStep2] withOffset:0.3];
+    GHAssertTrue(doubleeq(animationGroup.duration, 0.7), @"Duration");
+    
+    [animationGroup playAnimated:NO];
+    GHAssertFalse(animationGroup.running, @"Running");
+    GHAssertTrue(floateq(layer1.opacity, 0.5f), @"Opacity");
+    GHAssertTrue(floateq(layer2.opacity, 0.75f), @"Opacity");
+}
+
+@end
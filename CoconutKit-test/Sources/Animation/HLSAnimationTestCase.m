@@ -0,0 +1,74 @@
+//
+//  HLSAnimationTestCase.m
+//  CoconutKit-test
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSAnimationTestCase.h"
+
+@implementation HLSAnimationTestCase
+
+#pragma mark Test setup and tear down
+
+- (BOOL)shouldRunOnMainThread
+{
+    // Layer animations are played on the main thread
+    return YES;
+}
+
+#pragma mark Tests
+
+- (void)testStartTime
+{
+    CALayer *layer = [CALayer layer];
+    
+    NSMutableArray *animationSteps = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 50; ++i) {
+        HLSLayerAnimationStep *animationStep = [HLSLayerAnimationStep animationStep];
+        animationStep.duration = 0.1;
+        HLSLayerAnimation *layerAnimation = [HLSLayerAnimation animation];
+        [layerAnimation addToOpacity:-0.01f];
+        [animationStep addLayerAnimation:layerAnimation forLayer:layer];
+        [animationSteps addObject:animationStep];
+    }
+    HLSAnimation *animation = [HLSAnimation animationWithAnimationSteps:animationSteps];
+    
+    // All steps ending before the start time are played at once. The step containing the start time is then
+    // started, its final values are therefore already set on the layer
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    [animation playWithStartTime:4.95];
+    CFTimeInterval duration = CFAbsoluteTimeGetCurrent() - startTime;
+    GHTestLog(@"Started an animation of %d steps near its end in %.3f s", [animationSteps count], duration);
+    GHAssertTrue(fabsf(layer.opacity - 0.5f) < 1e-4f, @"Opacity");
+    [animation cancel];
+    GHAssertTrue(fabsf(layer.opacity - 0.5f) < 1e-4f, @"Opacity");
+}
+
+- (void)testInstantaneousPlayback
+{
+    CALayer *layer = [CALayer layer];
+    
+    HLSLayerAnimationStep *animationStep1 = [HLSLayerAnimationStep animationStep];
+    HLSLayerAnimation *layerAnimation1 = [HLSLayerAnimation animation];
+    [layerAnimation1 translateByVectorWithX:10.f y:0.f z:0.f];
+    [layerAnimation1 addToOpacity:-0.2f];
+    [animationStep1 addLayerAnimation:layerAnimation1 forLayer:layer];
+    
+    HLSLayerAnimationStep *animationStep2 = [HLSLayerAnimationStep animationStep];
+    HLSLayerAnimation *layerAnimation2 = [HLSLayerAnimation animation];
+    [layerAnimation2 translateByVectorWithX:0.f y:5.f z:0.f];
+    [layerAnimation2 addToOpacity:-0.3f];
+    [animationStep2 addLayerAnimation:layerAnimation2 forLayer:layer];
+    
+    // All steps and repeats are applied at once, synchronously
+    HLSAnimation *animation = [HLSAnimation animationWithAnimationSteps:[NSArray arrayWithObjects:animationStep1, animationStep2, nil]];
+    [animation playWithRepeatCount:2 animated:NO];
+    GHAssertFalse(animation.running, @"Running");
+    GHAssertTrue(floateq(layer.transform.m41, 20.f) && floateq(layer.transform.m42, 10.f), @"Translation");
+    GHAssertTrue(floateq(layer.opacity, 0.f), @"Opacity");
+    GHAssertEquals([[layer animationKeys] count], (NSUInteger)0, @"Animations");
+}
+
+@end
@@ -0,0 +1,215 @@
+//
+//  HLSLayerAnimationStepTestCase.m
+//  CoconutKit-test
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSLayerAnimationStepTestCase.h"
+
+static const NSUInteger kBenchmarkLayerCount = 1000;
+
+@implementation HLSLayerAnimationStepTestCase
+
+#pragma mark Test setup and tear down
+
+- (BOOL)shouldRunOnMainThread
+{
+    // Layer animations are played on the main thread
+    return YES;
+}
+
+#pragma mark Tests
+
+- (void)testReplacingLayerAnimation
+{
+    CALayer *layer = [CALayer layer];
+    
+    HLSLayerAnimationStep *animationStep = [HLSLayerAnimationStep animationStep];
+    HLSLayerAnimation *layerAnimation1 = [HLSLayerAnimation animation];
+    [layerAnimation1 addToOpacity:-0.5f];
+    [animationStep addLayerAnimation:layerAnimation1 forLayer:layer];
+    HLSLayerAnimation *layerAnimation2 = [HLSLayerAnimation animation];
+    [layerAnimation2 addToOpacity:-0.2f];
+    [animationStep addLayerAnimation:layerAnimation2 forLayer:layer];
+    
+    // The animation of a layer is applied once, even if set several times
+    HLSAnimation *animation = [HLSAnimation animationWithAnimationStep:animationStep];
+    [animation playAnimated:NO];
+    GHAssertTrue(floateq(layer.opacity, 0.8f), @"Opacity");
+}
+
+- (void)testAdditiveAnimations
+{
+    CALayer *layer = [CALayer layer];
+    
+    HLSLayerAnimationStep *animationStep1 = [HLSLayerAnimationStep animationStep];
+    animationStep1.additive = YES;
+    HLSLayerAnimation *layerAnimation1 = [HLSLayerAnimation animation];
+    [layerAnimation1 addToOpacity:-0.5f];
+    [layerAnimation1 translateByVectorWithX:10.f y:0.f z:0.f];
+    [animationStep1 addLayerAnimation:layerAnimation1 forLayer:layer];
+    HLSAnimation *animation1 = [HLSAnimation animationWithAnimationStep:animationStep1];
+    
+    HLSLayerAnimationStep *animationStep2 = [HLSLayerAnimationStep animationStep];
+    animationStep2.additive = YES;
+    HLSLayerAnimation *layerAnimation2 = [HLSLayerAnimation animation];
+    [layerAnimation2 addToOpacity:0.25f];
+    [animationStep2 addLayerAnimation:layerAnimation2 forLayer:layer];
+    HLSAnimation *animation2 = [HLSAnimation animationWithAnimationStep:animationStep2];
+    
+    // The second animation starts while the first one is running, without replacing its animations
+    [animation1 playAnimated:YES];
+    [animation2 playAnimated:YES];
+    GHAssertEquals([[layer animationKeys] count], (NSUInteger)2, @"Animations");
+    
+    CAAnimationGroup *animationGroup = (CAAnimationGroup *)[layer animationForKey:[[layer animationKeys] lastObject]];
+    CABasicAnimation *opacityAnimation = [animationGroup.animations objectAtIndex:0];
+    GHAssertTrue(opacityAnimation.additive, @"Additive");
+    GHAssertTrue(floateq([opacityAnimation.fromValue floatValue], -0.25f), @"From value");
+    GHAssertTrue(floateq([opacityAnimation.toValue floatValue], 0.f), @"To value");
+    
+    // Cancelling one animation does not affect the other one
+    [animation1 cancel];
+    GHAssertEquals([[layer animationKeys] count], (NSUInteger)1, @"Animations");
+    [animation2 cancel];
+    GHAssertTrue(floateq(layer.opacity, 0.75f), @"Opacity");
+    GHAssertTrue(floateq(layer.transform.m41, 10.f), @"Translation");
+}
+
+- (void)testBakedLoopRepeats
+{
+    CALayer *layer = [CALayer layer];
+    
+    HLSLayerAnimationStep *animationStep1 = [HLSLayerAnimationStep animationStep];
+    animationStep1.duration = 0.1;
+    HLSLayerAnimation *layerAnimation1 = [HLSLayerAnimation animation];
+    [layerAnimation1 addToOpacity:-0.5f];
+    [animationStep1 addLayerAnimation:layerAnimation1 forLayer:layer];
+    
+    HLSLayerAnimationStep *animationStep2 = [HLSLayerAnimationStep animationStep];
+    animationStep2.duration = 0.2;
+    HLSLayerAnimation *layerAnimation2 = [HLSLayerAnimation animation];
+    [layerAnimation2 translateByVectorWithX:10.f y:0.f z:0.f];
+    [animationStep2 addLayerAnimation:layerAnimation2 forLayer:layer];
+    
+    HLSAnimation *animation = [HLSAnimation animationWithAnimationSteps:[NSArray arrayWithObjects:animationStep1, animationStep2, nil]];
+    animation.baked = YES;
+    HLSAnimation *loopAnimation = [animation loopAnimation];
+    
+    // All repeats are played by Core Animation, autoreversing each property animation
+    [loopAnimation playWithRepeatCount:3 animated:YES];
+    GHAssertEquals([[layer animationKeys] count], (NSUInteger)1, @"Animations");
+    CAAnimationGroup *animationGroup = (CAAnimationGroup *)[layer animationForKey:[[layer animationKeys] lastObject]];
+    GHAssertEquals([animationGroup.animations count], (NSUInteger)2, @"One animation per property");
+    for (CAKeyframeAnimation *keyframeAnimation in animationGroup.animations) {
+        GHAssertTrue([keyframeAnimation isKindOfClass:[CAKeyframeAnimation class]], @"Keyframe animation");
+        GHAssertTrue(keyframeAnimation.autoreverses, @"Reverse half of the loop");
+        GHAssertTrue(floateq(keyframeAnimation.repeatCount, 3.f), @"Repeat count");
+    }
+    
+    // The layer ends in its initial state
+    GHAssertTrue(floateq(layer.opacity, 1.f), @"Opacity");
+    GHAssertTrue(CATransform3DIsIdentity(layer.transform), @"Transform");
+    [loopAnimation cancel];
+    GHAssertEquals([[layer animationKeys] count], (NSUInteger)0, @"Animations");
+    
+    // Repeat forever
+    [loopAnimation playWithRepeatCount:NSUIntegerMax animated:YES];
+    animationGroup = (CAAnimationGroup *)[layer animationForKey:[[layer animationKeys] lastObject]];
+    GHAssertTrue(isinf(animationGroup.repeatCount), @"Group repeat count");
+    for (CAKeyframeAnimation *keyframeAnimation in animationGroup.animations) {
+        GHAssertTrue(keyframeAnimation.autoreverses, @"Reverse half of the loop");
+        GHAssertTrue(isinf(keyframeAnimation.repeatCount), @"Repeat count");
+    }
+    [loopAnimation cancel];
+    GHAssertTrue(floateq(layer.opacity, 1.f), @"Opacity");
+    GHAssertTrue(CATransform3DIsIdentity(layer.transform), @"Transform");
+}
+
+- (void)testSeek
+{
+    // Attach the layer to a window so that its animations run to completion
+    UIWindow *window = [[[UIWindow alloc] initWithFrame:[UIScreen mainScreen].bounds] autorelease];
+    CALayer *layer = [CALayer layer];
+    [window.layer addSublayer:layer];
+    
+    HLSLayerAnimationStep *animationStep = [HLSLayerAnimationStep animationStep];
+    animationStep.duration = 1.;
+    HLSLayerAnimation *layerAnimation = [HLSLayerAnimation animation];
+    [layerAnimation addToOpacity:-0.5f];
+    [animationStep addLayerAnimation:layerAnimation forLayer:layer];
+    HLSAnimation *animation = [HLSAnimation animationWithAnimationStep:animationStep];
+    
+    // Wait until the initial delay is over and the step is actually being played
+    [animation playAnimated:YES];
+    NSDate *timeoutDate = [NSDate dateWithTimeIntervalSinceNow:2.];
+    while (! animation.started && [timeoutDate timeIntervalSinceNow] > 0.) {
+        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    }
+    [animation pause];
+    GHAssertTrue(animation.paused, @"Paused");
+    
+    // The local time of a paused layer does not advance anymore. Seeking moves it to the requested time (the step
+    // was paused right after it started)
+    CFTimeInterval pausedLayerTime = [layer convertTime:CACurrentMediaTime() fromLayer:nil];
+    [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.1]];
+    GHAssertTrue(doubleeq([layer convertTime:CACurrentMediaTime() fromLayer:nil], pausedLayerTime), @"Paused layer time");
+    
+    [animation seekToTime:0.8];
+    CFTimeInterval timeShift = [layer convertTime:CACurrentMediaTime() fromLayer:nil] - pausedLayerTime;
+    GHAssertTrue(timeShift > 0.7 && timeShift < 0.8 + 1e-3, @"Layer time moved");
+    
+    // Once resumed, only the remaining part of the step is played
+    CFTimeInterval resumeTime = CACurrentMediaTime();
+    [animation resume];
+    timeoutDate = [NSDate dateWithTimeIntervalSinceNow:2.];
+    while (animation.running && [timeoutDate timeIntervalSinceNow] > 0.) {
+        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    }
+    GHAssertFalse(animation.running, @"Finished");
+    GHAssertTrue(CACurrentMediaTime() - resumeTime < 0.6, @"Resumed from the new time");
+    GHAssertTrue(floateq(layer.opacity, 0.5f), @"Opacity");
+}
+
+- (void)testManyLayersBenchmark
+{
+    NSMutableArray *layers = [NSMutableArray arrayWithCapacity:kBenchmarkLayerCount];
+    for (NSUInteger i = 0; i < kBenchmarkLayerCount; ++i) {
+        [layers addObject:[CALayer layer]];
+    }
+    
+    HLSLayerAnimationStep *animationStep = [HLSLayerAnimationStep animationStep];
+    HLSLayerAnimation *layerAnimation = [HLSLayerAnimation animation];
+    [layerAnimation translateByVectorWithX:10.f y:20.f z:0.f];
+    [layerAnimation addToOpacity:-0.5f];
+    for (CALayer *layer in layers) {
+        [animationStep addLayerAnimation:layerAnimation forLayer:layer];
+    }
+    HLSAnimation *animation = [HLSAnimation animationWithAnimationStep:animationStep];
+    
+    CFAbsoluteTime playStartTime = CFAbsoluteTimeGetCurrent();
+    [animation playAnimated:NO];
+    CFTimeInterval playDuration = CFAbsoluteTimeGetCurrent() - playStartTime;
+    GHTestLog(@"Played a step for %d layers (non-animated) in %.3f s", kBenchmarkLayerCount, playDuration);
+    
+    for (CALayer *layer in layers) {
+        GHAssertTrue(floateq(layer.opacity, 0.5f), @"Opacity");
+        GHAssertTrue(floateq(layer.transform.m41, 10.f) && floateq(layer.transform.m42, 20.f), @"Translation");
+    }
+    
+    HLSAnimation *reverseAnimation = [animation reverseAnimation];
+    CFAbsoluteTime reverseStartTime = CFAbsoluteTimeGetCurrent();
+    [reverseAnimation playAnimated:YES];
+    CFTimeInterval reverseDuration = CFAbsoluteTimeGetCurrent() - reverseStartTime;
+    GHTestLog(@"Started a step for %d layers (animated) in %.3f s", kBenchmarkLayerCount, reverseDuration);
+    [reverseAnimation cancel];
+    
+    for (CALayer *layer in layers) {
+        GHAssertTrue(floateq(layer.opacity, 1.f), @"Opacity");
+        GHAssertTrue(CATransform3DIsIdentity(layer.transform), @"Translation");
+    }
+}
+
+@end
@@ -0,0 +1,47 @@
+//
+//  HLSLayerPropertyAnimationTestCase.m
+//  CoconutKit-test
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSLayerPropertyAnimationTestCase.h"
+
+@implementation HLSLayerPropertyAnimationTestCase
+
+#pragma mark Test setup and tear down
+
+- (BOOL)shouldRunOnMainThread
+{
+    // Layer animations are played on the main thread
+    return YES;
+}
+
+#pragma mark Tests
+
+- (void)testLayerPropertyAnimation
+{
+    CAShapeLayer *layer = [CAShapeLayer layer];
+    layer.strokeEnd = 0.25f;
+    
+    HLSLayerAnimationStep *animationStep = [HLSLayerAnimationStep animationStep];
+    HLSLayerPropertyAnimation *layerPropertyAnimation = [HLSLayerPropertyAnimation animation];
+    [layerPropertyAnimation addToValue:0.5f forKeyPath:@"strokeEnd"];
+    [layerPropertyAnimation addToValue:4.f forKeyPath:@"cornerRadius"];
+    [layerPropertyAnimation addToOpacity:-0.5f];
+    [animationStep addLayerAnimation:layerPropertyAnimation forLayer:layer];
+    
+    HLSAnimation *animation = [HLSAnimation animationWithAnimationStep:animationStep];
+    [animation playAnimated:NO];
+    GHAssertTrue(floateq(layer.strokeEnd, 0.75f), @"Stroke end");
+    GHAssertTrue(floateq(layer.cornerRadius, 4.f), @"Corner radius");
+    GHAssertTrue(floateq(layer.opacity, 0.5f), @"Opacity");
+    
+    [[animation reverseAnimation] playAnimated:NO];
+    GHAssertTrue(floateq(layer.strokeEnd, 0.25f), @"Stroke end");
+    GHAssertTrue(floateq(layer.cornerRadius, 0.f), @"Corner radius");
+    GHAssertTrue(floateq(layer.opacity, 1.f), @"Opacity");
+}
+
+@end
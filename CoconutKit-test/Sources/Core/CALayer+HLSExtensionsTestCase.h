@@ -0,0 +1,11 @@
+//
+//  CALayer+HLSExtensionsTestCase.h
+//  CoconutKit-test
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+@interface CALayer_HLSExtensionsTestCase : GHTestCase
+
+@end
@@ -0,0 +1,68 @@
+//
+//  CALayer+HLSExtensionsTestCase.m
+//  CoconutKit-test
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "CALayer+HLSExtensionsTestCase.h"
+
+static const NSUInteger kBenchmarkBranchCount = 50;
+static const NSUInteger kBenchmarkLeafCountPerBranch = 99;
+
+@implementation CALayer_HLSExtensionsTestCase
+
+#pragma mark Tests
+
+- (void)testAnimationControlBenchmark
+{
+    // 50 * (1 + 99) = 5000 layers, one leaf out of ten being animated
+    CALayer *rootLayer = [CALayer layer];
+    CALayer *animatedLayer = nil;
+    for (NSUInteger i = 0; i < kBenchmarkBranchCount; ++i) {
+        CALayer *branchLayer = [CALayer layer];
+        for (NSUInteger j = 0; j < kBenchmarkLeafCountPerBranch; ++j) {
+            CALayer *leafLayer = [CALayer layer];
+            if (j % 10 == 0) {
+                CABasicAnimation *animation = [CABasicAnimation animationWithKeyPath:@"opacity"];
+                animation.toValue = [NSNumber numberWithFloat:0.f];
+                animation.duration = 10.;
+                [leafLayer addAnimation:animation forKey:@"opacity"];
+                animatedLayer = leafLayer;
+            }
+            [branchLayer addSublayer:leafLayer];
+        }
+        [rootLayer addSublayer:branchLayer];
+    }
+    
+    CFAbsoluteTime pauseStartTime = CFAbsoluteTimeGetCurrent();
+    [rootLayer pauseAllAnimations];
+    CFTimeInterval pauseDuration = CFAbsoluteTimeGetCurrent() - pauseStartTime;
+    GHTestLog(@"Paused a tree of %d layers in %.6f s", kBenchmarkBranchCount * (kBenchmarkLeafCountPerBranch + 1), pauseDuration);
+    
+    GHAssertTrue([rootLayer isPaused], nil);
+    GHAssertEquals(rootLayer.speed, 0.f, nil);
+    GHAssertFalse([animatedLayer isPaused], nil);
+    
+    CFAbsoluteTime resumeStartTime = CFAbsoluteTimeGetCurrent();
+    [rootLayer resumeAllAnimations];
+    CFTimeInterval resumeDuration = CFAbsoluteTimeGetCurrent() - resumeStartTime;
+    GHTestLog(@"Resumed a tree of %d layers in %.6f s", kBenchmarkBranchCount * (kBenchmarkLeafCountPerBranch + 1), resumeDuration);
+    
+    GHAssertFalse([rootLayer isPaused], nil);
+    GHAssertEquals(rootLayer.speed, 1.f, nil);
+    
+    [rootLayer pauseAllAnimations];
+    
+    CFAbsoluteTime removeStartTime = CFAbsoluteTimeGetCurrent();
+    [rootLayer removeAllAnimationsRecursively];
+    CFTimeInterval removeDuration = CFAbsoluteTimeGetCurrent() - removeStartTime;
+    GHTestLog(@"Removed animations from a tree of %d layers in %.3f s", kBenchmarkBranchCount * (kBenchmarkLeafCountPerBranch + 1), removeDuration);
+    
+    GHAssertFalse([rootLayer isPaused], nil);
+    GHAssertEquals(rootLayer.speed, 1.f, nil);
+    GHAssertNil([animatedLayer animationKeys], nil);
+}
+
+@end
@@ -30,6 +30,40 @@
         GHAssertTrue(floateq(inverseEaseInValues[0], easeOutValues[0]), nil);
         GHAssertTrue(floateq(inverseEaseInValues[1], easeOutValues[1]), nil);
     }
+    
+    // Inverse functions are cached
+    CAMediaTimingFunction *easeInTimingFunction = [CAMediaTimingFunction functionWithControlPoints:0.42f :0.f :1.f :1.f];
+    GHAssertEquals([easeInTimingFunction inverseFunction], inverseEaseInTimingFunction, nil);
+    
+    // Non-symmetric curve: Playing the inverse function must yield p'(t) = 1 - p(1 - t)
+    CAMediaTimingFunction *timingFunction = [CAMediaTimingFunction functionWithControlPoints:0.1f :0.7f :0.6f :0.9f];
+    CAMediaTimingFunction *inverseTimingFunction = [timingFunction inverseFunction];
+    for (NSUInteger i = 0; i <= 10; ++i) {
+        CGFloat time = i / 10.f;
+        GHAssertTrue(fabsf([inverseTimingFunction progressAtTime:time] - (1.f - [timingFunction progressAtTime:1.f - time])) < 1e-4f, nil);
+    }
+}
+
+- (void)testProgress
+{
+    CAMediaTimingFunction *linearTimingFunction = [CAMediaTimingFunction functionWithName:kCAMediaTimingFunctionLinear];
+    for (NSUInteger i = 0; i <= 10; ++i) {
+        CGFloat time = i / 10.f;
+        GHAssertTrue(fabsf([linearTimingFunction progressAtTime:time] - time) < 1e-4f, nil);
+    }
+    
+    // Values outside [0, 1] are clamped
+    GHAssertTrue(floateq([linearTimingFunction progressAtTime:-1.f], 0.f), nil);
+    GHAssertTrue(floateq([linearTimingFunction progressAtTime:2.f], 1.f), nil);
+    
+    // Symmetric curve
+    CAMediaTimingFunction *easeInEaseOutTimingFunction = [CAMediaTimingFunction functionWithName:kCAMediaTimingFunctionEaseInEaseOut];
+    GHAssertTrue(fabsf([easeInEaseOutTimingFunction progressAtTime:0.5f] - 0.5f) < 1e-4f, nil);
+    GHAssertTrue([easeInEaseOutTimingFunction progressAtTime:0.25f] < 0.25f, nil);
+    
+    // Ease in (0.42, 0, 1, 1) at t = 0.5 (reference value obtained from the Bézier curve definition)
+    CAMediaTimingFunction *easeInTimingFunction = [CAMediaTimingFunction functionWithName:kCAMediaTimingFunctionEaseIn];
+    GHAssertTrue(fabsf([easeInTimingFunction progressAtTime:0.5f] - 0.3153f) < 1e-3f, nil);
 }
 
 @end
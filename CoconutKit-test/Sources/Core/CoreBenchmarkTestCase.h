@@ -0,0 +1,27 @@
+//
+//  CoreBenchmarkTestCase.h
+//  CoconutKit-test
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+@interface CoreBenchmarkTestCase : GHTestCase {
+@private
+    NSTimeZone *m_timeZone;
+    NSDate *m_date;
+    NSData *m_data;
+    NSString *m_string;
+    UIFont *m_font;
+    NSDictionary *m_dictionary;
+    NSArray *m_sortedArray;
+    NSSortDescriptor *m_sortDescriptor;
+    NSNumber *m_searchedNumber;
+    NSObject *m_object;
+    UILabel *m_label;
+    float m_floatValue;
+    NSUInteger m_floatEqualityCount;
+    BOOL m_labelTextToggle;
+}
+
+@end
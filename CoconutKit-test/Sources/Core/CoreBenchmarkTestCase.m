@@ -0,0 +1,291 @@
+//
+//  CoreBenchmarkTestCase.m
+//  CoconutKit-test
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "CoreBenchmarkTestCase.h"
+
+#import "BenchmarkRunner.h"
+
+/**
+ * Microbenchmarks for frequently used Core helpers. Results are logged as CSV and compared with the baseline (see
+ * BenchmarkRunner)
+ */
+static NSString * const kCoreBenchmarkSuiteName = @"CoreBenchmark";
+static const NSUInteger kCoreBenchmarkCollectionCount = 1000;
+static const NSUInteger kCoreBenchmarkDataLength = 1024;
+
+@interface CoreBenchmarkTestCase ()
+
+@property (nonatomic, retain) NSTimeZone *timeZone;
+@property (nonatomic, retain) NSDate *date;
+@property (nonatomic, retain) NSData *data;
+@property (nonatomic, retain) NSString *string;
+@property (nonatomic, retain) UIFont *font;
+@property (nonatomic, retain) NSDictionary *dictionary;
+@property (nonatomic, retain) NSArray *sortedArray;
+@property (nonatomic, retain) NSSortDescriptor *sortDescriptor;
+@property (nonatomic, retain) NSNumber *searchedNumber;
+@property (nonatomic, retain) NSObject *object;
+@property (nonatomic, retain) UILabel *label;
+
+- (void)benchmarkStartDateOfUnit;
+- (void)benchmarkNumberOfDaysInUnit;
+- (void)benchmarkDateAtNoon;
+- (void)benchmarkISO8601DateParsing;
+- (void)benchmarkFormattedDateParsing;
+- (void)benchmarkDataMD5Hash;
+- (void)benchmarkDataSHA1Hash;
+- (void)benchmarkStringMD5Hash;
+- (void)benchmarkFontSize;
+- (void)benchmarkFloatEquality;
+- (void)benchmarkDictionaryBySettingObject;
+- (void)benchmarkDictionaryByRemovingObject;
+- (void)benchmarkArrayRotation;
+- (void)benchmarkSortedArraySearch;
+- (void)benchmarkZeroingWeakRefCreation;
+- (void)benchmarkDefaultFileManager;
+- (void)benchmarkCurrentModelManager;
+- (void)benchmarkUnlocalizedLabelText;
+- (void)benchmarkControlCreation;
+
+@end
+
+@implementation CoreBenchmarkTestCase
+
+#pragma mark Object creation and destruction
+
+- (void)dealloc
+{
+    self.timeZone = nil;
+    self.date = nil;
+    self.data = nil;
+    self.string = nil;
+    self.font = nil;
+    self.dictionary = nil;
+    self.sortedArray = nil;
+    self.sortDescriptor = nil;
+    self.searchedNumber = nil;
+    self.object = nil;
+    self.label = nil;
+    
+    [super dealloc];
+}
+
+#pragma mark Accessors and mutators
+
+@synthesize timeZone = m_timeZone;
+
+@synthesize date = m_date;
+
+@synthesize data = m_data;
+
+@synthesize string = m_string;
+
+@synthesize font = m_font;
+
+@synthesize dictionary = m_dictionary;
+
+@synthesize sortedArray = m_sortedArray;
+
+@synthesize sortDescriptor = m_sortDescriptor;
+
+@synthesize searchedNumber = m_searchedNumber;
+
+@synthesize object = m_object;
+
+@synthesize label = m_label;
+
+#pragma mark Test setup and tear down
+
+- (BOOL)shouldRunOnMainThread
+{
+    // Font size calculations involve UIKit
+    return YES;
+}
+
+- (void)setUpClass
+{
+    [super setUpClass];
+    
+    self.timeZone = [NSTimeZone timeZoneWithName:@"Europe/Zurich"];
+    
+    // 2012-03-01 06:12:00 (CET, UTC+1)
+    self.date = [NSDate dateWithTimeIntervalSinceReferenceDate:352271520.];
+    
+    NSMutableData *data = [NSMutableData dataWithLength:kCoreBenchmarkDataLength];
+    unsigned char *bytes = [data mutableBytes];
+    for (NSUInteger i = 0; i < kCoreBenchmarkDataLength; ++i) {
+        bytes[i] = i % 256;
+    }
+    self.data = [NSData dataWithData:data];
+    self.string = @"The quick brown fox jumps over the lazy dog, again and again, until the label is full";
+    self.font = [UIFont systemFontOfSize:17.f];
+    
+    NSMutableDictionary *dictionary = [NSMutableDictionary dictionaryWithCapacity:kCoreBenchmarkCollectionCount];
+    NSMutableArray *sortedArray = [NSMutableArray arrayWithCapacity:kCoreBenchmarkCollectionCount];
+    for (NSUInteger i = 0; i < kCoreBenchmarkCollectionCount; ++i) {
+        NSNumber *number = [NSNumber numberWithUnsignedInteger:i];
+        [dictionary setObject:number forKey:[number stringValue]];
+        [sortedArray addObject:number];
+    }
+    self.dictionary = [NSDictionary dictionaryWithDictionary:dictionary];
+    self.sortedArray = [NSArray arrayWithArray:sortedArray];
+    self.sortDescriptor = [NSSortDescriptor sortDescriptorWithKey:@"self" ascending:YES];
+    self.searchedNumber = [NSNumber numberWithUnsignedInteger:kCoreBenchmarkCollectionCount / 3];
+    
+    self.object = [[[NSObject alloc] init] autorelease];
+    self.label = [[[UILabel alloc] initWithFrame:CGRectMake(0.f, 0.f, 200.f, 40.f)] autorelease];
+    m_floatValue = 0.1f;
+}
+
+#pragma mark Tests
+
+- (void)testCoreBenchmarks
+{
+    if (! [BenchmarkRunner shouldRunBenchmarks]) {
+        return;
+    }
+    
+    BenchmarkRunner *runner = [[[BenchmarkRunner alloc] initWithSuiteName:kCoreBenchmarkSuiteName] autorelease];
+    
+    [runner runBenchmarkWithName:@"startDateOfUnit" target:self selector:@selector(benchmarkStartDateOfUnit)];
+    [runner runBenchmarkWithName:@"numberOfDaysInUnit" target:self selector:@selector(benchmarkNumberOfDaysInUnit)];
+    [runner runBenchmarkWithName:@"dateAtNoon" target:self selector:@selector(benchmarkDateAtNoon)];
+    [runner runBenchmarkWithName:@"ISO8601DateParsing" target:self selector:@selector(benchmarkISO8601DateParsing)];
+    [runner runBenchmarkWithName:@"formattedDateParsing" target:self selector:@selector(benchmarkFormattedDateParsing)];
+    [runner runBenchmarkWithName:@"dataMD5Hash" target:self selector:@selector(benchmarkDataMD5Hash)];
+    [runner runBenchmarkWithName:@"dataSHA1Hash" target:self selector:@selector(benchmarkDataSHA1Hash)];
+    [runner runBenchmarkWithName:@"stringMD5Hash" target:self selector:@selector(benchmarkStringMD5Hash)];
+    [runner runBenchmarkWithName:@"fontSize" target:self selector:@selector(benchmarkFontSize)];
+    [runner runBenchmarkWithName:@"floatEquality" target:self selector:@selector(benchmarkFloatEquality)];
+    [runner runBenchmarkWithName:@"dictionaryBySettingObject" target:self selector:@selector(benchmarkDictionaryBySettingObject)];
+    [runner runBenchmarkWithName:@"dictionaryByRemovingObject" target:self selector:@selector(benchmarkDictionaryByRemovingObject)];
+    [runner runBenchmarkWithName:@"arrayRotation" target:self selector:@selector(benchmarkArrayRotation)];
+    [runner runBenchmarkWithName:@"sortedArraySearch" target:self selector:@selector(benchmarkSortedArraySearch)];
+    [runner runBenchmarkWithName:@"zeroingWeakRefCreation" target:self selector:@selector(benchmarkZeroingWeakRefCreation)];
+    [runner runBenchmarkWithName:@"defaultFileManager" target:self selector:@selector(benchmarkDefaultFileManager)];
+    [runner runBenchmarkWithName:@"currentModelManager" target:self selector:@selector(benchmarkCurrentModelManager)];
+    [runner runBenchmarkWithName:@"unlocalizedLabelText" target:self selector:@selector(benchmarkUnlocalizedLabelText)];
+    [runner runBenchmarkWithName:@"controlCreation" target:self selector:@selector(benchmarkControlCreation)];
+    
+    GHTestLog(@"Core benchmark results (times per call in microseconds):\n%@", [runner report]);
+    GHAssertTrue(m_floatEqualityCount != 0, @"The float comparisons must not have been optimized away");
+    GHAssertTrue([runner updateBaselineIfNeeded], @"The baseline could not be saved");
+}
+
+#pragma mark Benchmarks
+
+- (void)benchmarkStartDateOfUnit
+{
+    [NSCalendar startDateOfUnit:NSMonthCalendarUnit containingDate:self.date inTimeZone:self.timeZone];
+}
+
+- (void)benchmarkNumberOfDaysInUnit
+{
+    [NSCalendar numberOfDaysInUnit:NSYearCalendarUnit containingDate:self.date inTimeZone:self.timeZone];
+}
+
+- (void)benchmarkDateAtNoon
+{
+    [NSCalendar dateAtNoonTheSameDayAsDate:self.date inTimeZone:self.timeZone];
+}
+
+- (void)benchmarkISO8601DateParsing
+{
+    [HLSConverters dateFromISO8601String:@"2012-10-14T12:34:56.789+02:00"];
+}
+
+- (void)benchmarkFormattedDateParsing
+{
+    [HLSConverters dateFromString:@"14.10.2012 12:34" usingFormatString:@"dd.MM.yyyy HH:mm"];
+}
+
+- (void)benchmarkDataMD5Hash
+{
+    [self.data md5hash];
+}
+
+- (void)benchmarkDataSHA1Hash
+{
+    [self.data sha1hash];
+}
+
+- (void)benchmarkStringMD5Hash
+{
+    [self.string md5hash];
+}
+
+- (void)benchmarkFontSize
+{
+    [self.string fontSizeWithFont:self.font constrainedToSize:CGSizeMake(200.f, 40.f) minFontSize:8.f numberOfLines:2];
+}
+
+- (void)benchmarkFloatEquality
+{
+    // Compare values computed at runtime so that the comparisons cannot be evaluated at compile time
+    float value = m_floatValue;
+    for (NSUInteger i = 0; i < 100; ++i) {
+        if (floateq_dist(value * 3.f, 0.3f, HLSFloatDefaultMaxDist)) {
+            ++m_floatEqualityCount;
+        }
+        value += 1e-9f;
+    }
+}
+
+- (void)benchmarkDictionaryBySettingObject
+{
+    [self.dictionary dictionaryBySettingObject:self.object forKey:@"object"];
+}
+
+- (void)benchmarkDictionaryByRemovingObject
+{
+    [self.dictionary dictionaryByRemovingObjectForKey:@"500"];
+}
+
+- (void)benchmarkArrayRotation
+{
+    [self.sortedArray arrayByLeftRotatingNumberOfObjects:kCoreBenchmarkCollectionCount / 4];
+}
+
+- (void)benchmarkSortedArraySearch
+{
+    [self.sortedArray indexOfObject:self.searchedNumber sortedUsingDescriptor:self.sortDescriptor];
+}
+
+- (void)benchmarkZeroingWeakRefCreation
+{
+    HLSZeroingWeakRef *zeroingWeakRef = [[HLSZeroingWeakRef alloc] initWithObject:self.object];
+    [zeroingWeakRef release];
+}
+
+- (void)benchmarkDefaultFileManager
+{
+    [HLSFileManager defaultManager];
+}
+
+- (void)benchmarkCurrentModelManager
+{
+    // Looked up by all context-free methods, e.g. for each object inserted using +insert
+    [HLSModelManager currentModelManager];
+}
+
+- (void)benchmarkUnlocalizedLabelText
+{
+    // Texts without localization prefix, as set on table view cell labels when scrolling. Alternate between two
+    // texts so that each call actually changes the text
+    m_labelTextToggle = ! m_labelTextToggle;
+    self.label.text = m_labelTextToggle ? self.string : @"Another text";
+}
+
+- (void)benchmarkControlCreation
+{
+    // Includes the exclusive touch setup performed after each UIControl initializer
+    UIButton *button = [[UIButton alloc] initWithFrame:CGRectMake(0.f, 0.f, 100.f, 40.f)];
+    [button release];
+}
+
+@end
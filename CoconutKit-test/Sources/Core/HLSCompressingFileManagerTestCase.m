@@ -0,0 +1,41 @@
+//
+//  HLSCompressingFileManagerTestCase.m
+//  CoconutKit-test
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSCompressingFileManagerTestCase.h"
+
+@implementation HLSCompressingFileManagerTestCase
+
+#pragma mark Tests
+
+- (void)testCompressionOnTopOfEncryption
+{
+    HLSInMemoryFileManager *inMemoryFileManager = [[[HLSInMemoryFileManager alloc] init] autorelease];
+    NSData *key = [@"0123456789abcdef" dataUsingEncoding:NSUTF8StringEncoding];
+    HLSEncryptingFileManager *encryptingFileManager = [[[HLSEncryptingFileManager alloc] initWithFileManager:inMemoryFileManager 
+                                                                                                         key:key] autorelease];
+    HLSCompressingFileManager *compressingFileManager = [[[HLSCompressingFileManager alloc] initWithFileManager:encryptingFileManager] autorelease];
+    
+    NSMutableString *text = [NSMutableString string];
+    for (NSUInteger i = 0; i < 10000; ++i) {
+        [text appendFormat:@"Line %d\n", i];
+    }
+    NSData *data = [text dataUsingEncoding:NSUTF8StringEncoding];
+    
+    GHAssertTrue([compressingFileManager createFileAtPath:@"/compressed.txt" contents:data error:NULL], nil);
+    GHAssertTrue([[inMemoryFileManager contentsOfFileAtPath:@"/compressed.txt" error:NULL] length] < [data length] / 3, nil);
+    GHAssertTrue([compressingFileManager appendContents:data toFileAtPath:@"/compressed.txt" error:NULL], nil);
+    NSMutableData *expectedData = [NSMutableData dataWithData:data];
+    [expectedData appendData:data];
+    GHAssertEqualObjects([compressingFileManager contentsOfFileAtPath:@"/compressed.txt" error:NULL], expectedData, nil);
+    GHAssertEqualObjects([compressingFileManager contentsOfFileAtPath:@"/compressed.txt" range:NSMakeRange([data length] - 10, 20) error:NULL],
+                         [expectedData subdataWithRange:NSMakeRange([data length] - 10, 20)], nil);
+    GHAssertEqualStrings([compressingFileManager hexDigestOfFileAtPath:@"/compressed.txt" usingAlgorithm:HLSDigestAlgorithmSHA1 error:NULL],
+                         [expectedData sha1hash], nil);
+}
+
+@end
@@ -0,0 +1,81 @@
+//
+//  HLSConvertersTestCase.m
+//  CoconutKit-test
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSConvertersTestCase.h"
+
+@implementation HLSConvertersTestCase
+
+#pragma mark Tests
+
+- (void)testISO8601DateParsing
+{
+    GHAssertEquals([[HLSConverters dateFromISO8601String:@"1970-01-01T00:00:00Z"] timeIntervalSince1970], 0., nil);
+    GHAssertEquals([[HLSConverters dateFromISO8601String:@"2012-02-29T12:30:15Z"] timeIntervalSince1970], 1330518615., nil);
+    GHAssertEquals([[HLSConverters dateFromISO8601String:@"2012-02-29 12:30:15Z"] timeIntervalSince1970], 1330518615., nil);
+    GHAssertEquals([[HLSConverters dateFromISO8601String:@"2012-02-29T13:30:15+01:00"] timeIntervalSince1970], 1330518615., nil);
+    GHAssertEquals([[HLSConverters dateFromISO8601String:@"2012-02-29T13:30:15+0100"] timeIntervalSince1970], 1330518615., nil);
+    GHAssertEquals([[HLSConverters dateFromISO8601String:@"2012-02-29T07:00:15-05:30"] timeIntervalSince1970], 1330518615., nil);
+    GHAssertEquals([[HLSConverters dateFromISO8601String:@"2012-02-29T12:30:15.5Z"] timeIntervalSince1970], 1330518615.5, nil);
+    
+    GHAssertNil([HLSConverters dateFromISO8601String:nil], nil);
+    GHAssertNil([HLSConverters dateFromISO8601String:@"2012-02-29T12:30:15"], nil);
+    GHAssertNil([HLSConverters dateFromISO8601String:@"2011-02-29T12:30:15Z"], nil);
+    GHAssertNil([HLSConverters dateFromISO8601String:@"2012-13-01T12:30:15Z"], nil);
+    GHAssertNil([HLSConverters dateFromISO8601String:@"2012-02-29T24:30:15Z"], nil);
+    GHAssertNil([HLSConverters dateFromISO8601String:@"2012-02-29T12:30:15Zabc"], nil);
+    GHAssertNil([HLSConverters dateFromISO8601String:@"2012-02-29T12:30:15.Z"], nil);
+    GHAssertNil([HLSConverters dateFromISO8601String:@"2012-2-29T12:30:15Z"], nil);
+}
+
+- (void)testDateFromStringFastPath
+{
+    NSDate *date = [HLSConverters dateFromString:@"2012-02-29T13:30:15+0100" usingFormatString:@"yyyy-MM-dd'T'HH:mm:ssZ"];
+    GHAssertEquals([date timeIntervalSince1970], 1330518615., nil);
+    
+    NSDate *date2 = [HLSConverters dateFromString:@"2012-02-29T13:30:15+01:00" usingFormatString:@"yyyy-MM-dd'T'HH:mm:ssZZZZZ"];
+    GHAssertEquals([date2 timeIntervalSince1970], 1330518615., nil);
+    
+    NSDate *date3 = [HLSConverters dateFromString:@"2012-02-29T12:30:15Z" usingFormatString:@"yyyy-MM-dd'T'HH:mm:ssZZZZZ"];
+    GHAssertEquals([date3 timeIntervalSince1970], 1330518615., nil);
+    
+    // Variants only accepted by +dateFromISO8601String: are not accepted for a format which does not describe them
+    GHAssertNil([HLSConverters dateFromString:@"2012-02-29T12:30:15.5+0000" usingFormatString:@"yyyy-MM-dd'T'HH:mm:ssZ"], nil);
+}
+
+- (void)testDictionaryMapping
+{
+    HLSDictionaryMapping *mapping = [[[HLSDictionaryMapping alloc] init] autorelease];
+    [mapping addStringRuleForSourceKey:@"name" destKey:@"fullName"];
+    [mapping addUnsignedIntRuleForSourceKey:@"count" destKey:@"numberOfItems"];
+    [mapping addDateRuleForSourceKey:@"date" destKey:@"creationDate" formatString:@"yyyy-MM-dd'T'HH:mm:ssZ"];
+    
+    NSMutableArray *dictionaries = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 1000; ++i) {
+        [dictionaries addObject:[NSDictionary dictionaryWithObjectsAndKeys:[NSString stringWithFormat:@"%d", i], @"name",
+                                 [NSString stringWithFormat:@"%d", i], @"count", 
+                                 @"2012-02-29T12:30:15Z", @"date", 
+                                 [NSNull null], @"ignored",
+                                 nil]];
+    }
+    [dictionaries addObject:[NSDictionary dictionaryWithObject:[NSNull null] forKey:@"name"]];
+    
+    NSArray *convertedDictionaries = [mapping dictionariesFromDictionaries:dictionaries concurrently:YES];
+    GHAssertEquals([convertedDictionaries count], (NSUInteger)1001, nil);
+    for (NSUInteger i = 0; i < 1000; ++i) {
+        NSDictionary *convertedDictionary = [convertedDictionaries objectAtIndex:i];
+        GHAssertEquals([convertedDictionary count], (NSUInteger)3, nil);
+        GHAssertEqualStrings([convertedDictionary objectForKey:@"fullName"], ([NSString stringWithFormat:@"%d", i]), nil);
+        GHAssertEquals([[convertedDictionary objectForKey:@"numberOfItems"] unsignedIntegerValue], i, nil);
+        GHAssertEquals([[convertedDictionary objectForKey:@"creationDate"] timeIntervalSince1970], 1330518615., nil);
+    }
+    GHAssertEquals([[convertedDictionaries lastObject] count], (NSUInteger)0, nil);
+    
+    GHAssertEqualObjects([mapping dictionariesFromDictionaries:dictionaries concurrently:NO], convertedDictionaries, nil);
+}
+
+@end
@@ -0,0 +1,14 @@
+//
+//  HLSDirectoryEnumeratorTestCase.h
+//  CoconutKit-test
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+@interface HLSDirectoryEnumeratorTestCase : GHTestCase {
+@private
+    
+}
+
+@end
@@ -0,0 +1,48 @@
+//
+//  HLSDirectoryEnumeratorTestCase.m
+//  CoconutKit-test
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSDirectoryEnumeratorTestCase.h"
+
+@implementation HLSDirectoryEnumeratorTestCase
+
+#pragma mark Tests
+
+- (void)testDirectoryEnumeration
+{
+    HLSInMemoryFileManager *fileManager = [[[HLSInMemoryFileManager alloc] init] autorelease];
+    NSData *data = [@"data" dataUsingEncoding:NSUTF8StringEncoding];
+    [fileManager createDirectoryAtPath:@"/a/b/c" withIntermediateDirectories:YES error:NULL];
+    [fileManager createDirectoryAtPath:@"/d" withIntermediateDirectories:YES error:NULL];
+    [fileManager createFileAtPath:@"/file1" contents:data error:NULL];
+    [fileManager createFileAtPath:@"/a/file2" contents:data error:NULL];
+    [fileManager createFileAtPath:@"/a/b/c/file3" contents:data error:NULL];
+    
+    GHAssertEquals([[[fileManager enumeratorAtPath:@"/" recursive:NO] allObjects] count], (NSUInteger)3, nil);
+    GHAssertEquals([[[fileManager enumeratorAtPath:@"/" recursive:YES] allObjects] count], (NSUInteger)7, nil);
+    
+    HLSDirectoryEnumerator *fileEnumerator = [fileManager enumeratorAtPath:@"/" recursive:YES];
+    fileEnumerator.predicate = [NSPredicate predicateWithFormat:@"directory == NO"];
+    NSArray *fileEntries = [fileEnumerator allObjects];
+    GHAssertEquals([fileEntries count], (NSUInteger)3, nil);
+    GHAssertEquals([[fileEntries valueForKeyPath:@"@sum.size"] unsignedLongLongValue], 3ULL * [data length], nil);
+    
+    HLSDirectoryEnumerator *skippingEnumerator = [fileManager enumeratorAtPath:@"/" recursive:YES];
+    NSUInteger count = 0;
+    HLSDirectoryEntry *entry = nil;
+    while ((entry = [skippingEnumerator nextObject])) {
+        if ([entry.name isEqualToString:@"a"]) {
+            [skippingEnumerator skipDescendants];
+        }
+        ++count;
+    }
+    GHAssertEquals(count, (NSUInteger)3, nil);
+    
+    GHAssertEquals([[[fileManager enumeratorAtPath:@"/missing" recursive:YES] allObjects] count], (NSUInteger)0, nil);
+}
+
+@end
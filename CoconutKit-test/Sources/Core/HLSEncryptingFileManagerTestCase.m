@@ -0,0 +1,39 @@
+//
+//  HLSEncryptingFileManagerTestCase.m
+//  CoconutKit-test
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSEncryptingFileManagerTestCase.h"
+
+@implementation HLSEncryptingFileManagerTestCase
+
+#pragma mark Tests
+
+- (void)testEncryption
+{
+    HLSInMemoryFileManager *inMemoryFileManager = [[[HLSInMemoryFileManager alloc] init] autorelease];
+    NSData *key = [@"0123456789abcdef" dataUsingEncoding:NSUTF8StringEncoding];
+    HLSEncryptingFileManager *encryptingFileManager = [[[HLSEncryptingFileManager alloc] initWithFileManager:inMemoryFileManager 
+                                                                                                         key:key] autorelease];
+    
+    NSMutableString *text = [NSMutableString string];
+    for (NSUInteger i = 0; i < 10000; ++i) {
+        [text appendFormat:@"Line %d\n", i];
+    }
+    NSData *data = [text dataUsingEncoding:NSUTF8StringEncoding];
+    
+    GHAssertTrue([encryptingFileManager createFileAtPath:@"/encrypted.txt" contents:data error:NULL], nil);
+    GHAssertEquals([[inMemoryFileManager contentsOfFileAtPath:@"/encrypted.txt" error:NULL] length], [data length] + 16, nil);
+    GHAssertFalse([[inMemoryFileManager contentsOfFileAtPath:@"/encrypted.txt" error:NULL] isEqualToData:data], nil);
+    GHAssertEqualObjects([encryptingFileManager contentsOfFileAtPath:@"/encrypted.txt" error:NULL], data, nil);
+    GHAssertEqualObjects([encryptingFileManager contentsOfFileAtPath:@"/encrypted.txt" range:NSMakeRange(1001, 2000) error:NULL],
+                         [data subdataWithRange:NSMakeRange(1001, 2000)], nil);
+    GHAssertTrue([encryptingFileManager appendContents:data toFileAtPath:@"/encrypted.txt" error:NULL], nil);
+    GHAssertEqualObjects([encryptingFileManager contentsOfFileAtPath:@"/encrypted.txt" range:NSMakeRange([data length], NSUIntegerMax) error:NULL],
+                         data, nil);
+}
+
+@end
@@ -99,6 +99,23 @@
     GHAssertEquals([[self.error2 customUserInfo] count], 3U, @"Incorrect custom user information");
 }
 
+- (void)testUserInfoUpdate
+{
+    HLSError *error = [HLSError errorWithDomain:@"ch.hortis.CoconutKit-test" code:3];
+    GHAssertEquals([[error userInfo] count], 0U, @"Empty user information");
+    
+    [error setLocalizedDescription:@"Localized description"];
+    NSDictionary *userInfo = [error userInfo];
+    GHAssertEquals([error userInfo], userInfo, @"User information must only be built once when unchanged");
+    
+    // Information previously read must not change when the error is updated
+    [error setLocalizedFailureReason:@"Localized failure reason"];
+    [error setLocalizedDescription:nil];
+    GHAssertEquals([userInfo count], 1U, @"Previously read user information must not change");
+    GHAssertEquals([[error userInfo] count], 1U, @"Incorrect user information");
+    GHAssertEqualStrings([error localizedFailureReason], @"Localized failure reason", @"Incorrect failure reason");
+}
+
 - (void)testCopy
 {
     NSError *error2Copy = [self.error2 copy];
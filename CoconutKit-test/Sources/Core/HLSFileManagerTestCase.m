@@ -0,0 +1,37 @@
+//
+//  HLSFileManagerTestCase.m
+//  CoconutKit-test
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSFileManagerTestCase.h"
+
+@implementation HLSFileManagerTestCase
+
+#pragma mark Tests
+
+- (void)testAsynchronousOperations
+{
+    HLSInMemoryFileManager *fileManager = [[[HLSInMemoryFileManager alloc] init] autorelease];
+    for (NSUInteger i = 0; i < 100; ++i) {
+        NSData *data = [[NSString stringWithFormat:@"%d", i] dataUsingEncoding:NSUTF8StringEncoding];
+        [fileManager writeContents:data toFileAtPath:@"/file" completionTarget:nil action:NULL];
+    }
+    [fileManager removeItemAtPath:@"/file" completionTarget:nil action:NULL];
+    [fileManager writeContents:[@"last" dataUsingEncoding:NSUTF8StringEncoding] toFileAtPath:@"/file" completionTarget:nil action:NULL];
+    [fileManager waitUntilAsynchronousOperationsAreFinished];
+    
+    GHAssertEqualObjects([fileManager contentsOfFileAtPath:@"/file" error:NULL], [@"last" dataUsingEncoding:NSUTF8StringEncoding], nil);
+}
+
+- (void)testDefaultManager
+{
+    HLSInMemoryFileManager *fileManager = [[[HLSInMemoryFileManager alloc] init] autorelease];
+    HLSFileManager *previousManager = [HLSFileManager setDefaultManager:fileManager];
+    GHAssertEquals([HLSFileManager defaultManager], (HLSFileManager *)fileManager, nil);
+    GHAssertEquals([HLSFileManager setDefaultManager:previousManager], (HLSFileManager *)fileManager, nil);
+}
+
+@end
@@ -61,6 +61,41 @@
     
     GHAssertEquals(doublemax(1., 1.), 1., @"doublemax");
     GHAssertEquals(doublemax(1., 2.), 2., @"doublemax");
+    
+    GHAssertTrue(doubleeq(1., nextafter(1., 2.)), @"doubleeq");
+    GHAssertTrue(doubleeq(nextafter(1., 2.), 1.), @"doubleeq");
+}
+
+- (void)testArrayComparisons
+{
+    // Not a multiple of the vector size, so that the remaining values are compared as well
+    enum { kCount = 10 };
+    float x[kCount] = {1.f, -1.f, 0.f, 1.f, 3.f, -2.f, 0.5f, 7.f, -7.f, 4.f};
+    float y[kCount] = {1.f, -1.f, -0.f, 2.f, 3.f, 2.f, 0.5f, 7.f, 7.f, 4.f};
+    y[6] = nextafterf(x[6], 1.f);
+    y[9] = nextafterf(x[9], 5.f);
+    
+    uint8_t result[kCount];
+    floateq_dist_n(x, y, kCount, HLSFloatDefaultMaxDist, result);
+    for (size_t i = 0; i < kCount; ++i) {
+        GHAssertEquals((BOOL)result[i], floateq(x[i], y[i]), @"floateq_dist_n at index %d", i);
+    }
+    
+    double dx[kCount], dy[kCount];
+    for (size_t i = 0; i < kCount; ++i) {
+        dx[i] = x[i];
+        dy[i] = y[i];
+    }
+    doubleeq_dist_n(dx, dy, kCount, HLSFloatDefaultMaxDist, result);
+    for (size_t i = 0; i < kCount; ++i) {
+        GHAssertEquals((BOOL)result[i], doubleeq(dx[i], dy[i]), @"doubleeq_dist_n at index %d", i);
+    }
+    
+    GHAssertEquals(floatmin_n(x, kCount), -7.f, @"floatmin_n");
+    GHAssertEquals(floatmax_n(x, kCount), 7.f, @"floatmax_n");
+    GHAssertEquals(floatmin_n(x, 3), -1.f, @"floatmin_n");
+    GHAssertEquals(doublemin_n(dx, kCount), -7., @"doublemin_n");
+    GHAssertEquals(doublemax_n(dy, kCount), 7., @"doublemax_n");
 }
 
 @end
@@ -0,0 +1,77 @@
+//
+//  HLSInMemoryFileManagerTestCase.m
+//  CoconutKit-test
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSInMemoryFileManagerTestCase.h"
+
+@implementation HLSInMemoryFileManagerTestCase
+
+#pragma mark Tests
+
+- (void)testFilesAndDirectories
+{
+    HLSInMemoryFileManager *fileManager = [[[HLSInMemoryFileManager alloc] init] autorelease];
+    NSData *data = [@"Hello, World!" dataUsingEncoding:NSUTF8StringEncoding];
+    
+    GHAssertFalse([fileManager createFileAtPath:@"/folder/file.txt" contents:data error:NULL], nil);
+    GHAssertFalse([fileManager createDirectoryAtPath:@"/folder/subfolder" withIntermediateDirectories:NO error:NULL], nil);
+    GHAssertTrue([fileManager createDirectoryAtPath:@"/folder/subfolder" withIntermediateDirectories:YES error:NULL], nil);
+    GHAssertTrue([fileManager createFileAtPath:@"/folder/file.txt" contents:data error:NULL], nil);
+    GHAssertTrue([fileManager appendContents:data toFileAtPath:@"/folder/file.txt" error:NULL], nil);
+    GHAssertEquals(fileManager.size, 2ULL * [data length], nil);
+    
+    BOOL isDirectory = NO;
+    GHAssertTrue([fileManager fileExistsAtPath:@"/folder/subfolder" isDirectory:&isDirectory], nil);
+    GHAssertTrue(isDirectory, nil);
+    GHAssertEquals([[fileManager contentsOfDirectoryAtPath:@"/folder" error:NULL] count], (NSUInteger)2, nil);
+    GHAssertEqualObjects([fileManager contentsOfFileAtPath:@"/folder/file.txt" range:NSMakeRange(0, 5) error:NULL],
+                         [@"Hello" dataUsingEncoding:NSUTF8StringEncoding], nil);
+    
+    GHAssertTrue([fileManager copyItemAtPath:@"/folder" toPath:@"/folder copy" error:NULL], nil);
+    GHAssertEquals(fileManager.size, 4ULL * [data length], nil);
+    GHAssertTrue([fileManager contentsOfFileAtPath:@"/folder/file.txt" error:NULL] 
+                 == [fileManager contentsOfFileAtPath:@"/folder copy/file.txt" error:NULL], nil);
+    GHAssertTrue([fileManager createFileAtPath:@"/folder copy/file.txt" contents:data error:NULL], nil);
+    GHAssertEquals([[fileManager contentsOfFileAtPath:@"/folder/file.txt" error:NULL] length], 2 * [data length], nil);
+    
+    GHAssertFalse([fileManager moveItemAtPath:@"/folder" toPath:@"/folder/subfolder/folder" error:NULL], nil);
+    GHAssertTrue([fileManager moveItemAtPath:@"/folder" toPath:@"/folder copy/subfolder/folder" error:NULL], nil);
+    GHAssertFalse([fileManager fileExistsAtPath:@"/folder"], nil);
+    GHAssertTrue([fileManager removeItemAtPath:@"/folder copy" error:NULL], nil);
+    GHAssertEquals(fileManager.size, 0ULL, nil);
+    GHAssertFalse([fileManager removeItemAtPath:@"/" error:NULL], nil);
+}
+
+- (void)testSizeLimit
+{
+    HLSInMemoryFileManager *fileManager = [[[HLSInMemoryFileManager alloc] init] autorelease];
+    fileManager.sizeLimit = 10;
+    
+    NSData *data = [@"12345678" dataUsingEncoding:NSUTF8StringEncoding];
+    GHAssertTrue([fileManager createFileAtPath:@"/file1" contents:data error:NULL], nil);
+    
+    NSError *error = nil;
+    GHAssertFalse([fileManager copyItemAtPath:@"/file1" toPath:@"/file2" error:&error], nil);
+    GHAssertEquals([error code], (NSInteger)NSFileWriteOutOfSpaceError, nil);
+    GHAssertTrue([fileManager createFileAtPath:@"/file1" contents:[NSData dataWithBytes:"1234567890" length:10] error:NULL], nil);
+    GHAssertFalse([fileManager appendContents:data toFileAtPath:@"/file1" error:NULL], nil);
+}
+
+- (void)testDirectoryEntries
+{
+    HLSInMemoryFileManager *fileManager = [[[HLSInMemoryFileManager alloc] init] autorelease];
+    NSData *data = [@"data" dataUsingEncoding:NSUTF8StringEncoding];
+    [fileManager createDirectoryAtPath:@"/a/b" withIntermediateDirectories:YES error:NULL];
+    [fileManager createFileAtPath:@"/file1" contents:data error:NULL];
+    [fileManager createFileAtPath:@"/a/file2" contents:data error:NULL];
+    
+    NSArray *entries = [fileManager entriesOfDirectoryAtPath:@"/" error:NULL];
+    GHAssertEquals([entries count], (NSUInteger)2, nil);
+    GHAssertEquals([[entries valueForKeyPath:@"@sum.size"] unsignedLongLongValue], (unsigned long long)[data length], nil);
+}
+
+@end
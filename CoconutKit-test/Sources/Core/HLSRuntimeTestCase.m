@@ -0,0 +1,107 @@
+//
+//  HLSRuntimeTestCase.m
+//  CoconutKit-test
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSRuntimeTestCase.h"
+
+#pragma mark Test classes
+
+@interface HLSRuntimeTestParent : NSObject
+
+- (NSInteger)ownValue;
+- (NSInteger)inheritedValue;
+
+@end
+
+@interface HLSRuntimeTestChild : HLSRuntimeTestParent
+
+@end
+
+@implementation HLSRuntimeTestParent
+
+- (NSInteger)ownValue
+{
+    return 1;
+}
+
+- (NSInteger)inheritedValue
+{
+    return 2;
+}
+
+@end
+
+@implementation HLSRuntimeTestChild
+
+- (NSInteger)ownValue
+{
+    return 3;
+}
+
+@end
+
+static NSInteger (*s_HLSRuntimeTestChild__ownValue_Imp)(id, SEL) = NULL;
+static NSInteger (*s_HLSRuntimeTestChild__inheritedValue_Imp)(id, SEL) = NULL;
+static IMP s_HLSRuntimeTestChild__missingValue_Imp = (IMP)1;
+
+static NSInteger swizzled_HLSRuntimeTestChild__ownValue_Imp(id self, SEL _cmd)
+{
+    return 10 * (*s_HLSRuntimeTestChild__ownValue_Imp)(self, _cmd);
+}
+
+static NSInteger swizzled_HLSRuntimeTestChild__inheritedValue_Imp(id self, SEL _cmd)
+{
+    return 10 * (*s_HLSRuntimeTestChild__inheritedValue_Imp)(self, _cmd);
+}
+
+@implementation HLSRuntimeTestCase
+
+#pragma mark Tests
+
+- (void)testSwizzleSelectors
+{
+    HLSSwizzling swizzlings[] = {
+        {@selector(ownValue), (IMP)swizzled_HLSRuntimeTestChild__ownValue_Imp, (IMP *)&s_HLSRuntimeTestChild__ownValue_Imp},
+        {@selector(inheritedValue), (IMP)swizzled_HLSRuntimeTestChild__inheritedValue_Imp, (IMP *)&s_HLSRuntimeTestChild__inheritedValue_Imp},
+        {NSSelectorFromString(@"missingValue"), (IMP)swizzled_HLSRuntimeTestChild__ownValue_Imp, &s_HLSRuntimeTestChild__missingValue_Imp}
+    };
+    HLSSwizzleSelectors([HLSRuntimeTestChild class], swizzlings, sizeof(swizzlings) / sizeof(HLSSwizzling));
+    
+    HLSRuntimeTestParent *parent = [[[HLSRuntimeTestParent alloc] init] autorelease];
+    HLSRuntimeTestChild *child = [[[HLSRuntimeTestChild alloc] init] autorelease];
+    
+    // Methods implemented by the class are swizzled in place, inherited ones are overridden (parent unaffected)
+    GHAssertEquals([child ownValue], (NSInteger)30, nil);
+    GHAssertEquals([child inheritedValue], (NSInteger)20, nil);
+    GHAssertEquals([parent ownValue], (NSInteger)1, nil);
+    GHAssertEquals([parent inheritedValue], (NSInteger)2, nil);
+    
+    // Missing methods are not added
+    GHAssertNULL(s_HLSRuntimeTestChild__missingValue_Imp, nil);
+    GHAssertFalse([child respondsToSelector:NSSelectorFromString(@"missingValue")], nil);
+}
+
+- (void)testMessageSendProfiling
+{
+    HLSRuntimeTestParent *parent = [[[HLSRuntimeTestParent alloc] init] autorelease];
+    
+    HLSMessageSendProfilingStart([NSArray arrayWithObject:@"HLSRuntimeTestParent"], 0., 0.);
+    for (NSUInteger i = 0; i < 3; ++i) {
+        [parent inheritedValue];
+    }
+    HLSMessageSendProfilingStop();
+    
+    // Profiled methods are never cached, each message send is logged. Other classes are not logged
+    NSString *log = [NSString stringWithContentsOfFile:HLSMessageSendProfilingFilePath() encoding:NSUTF8StringEncoding error:NULL];
+    NSArray *lines = [log componentsSeparatedByString:@"\n"];
+    GHAssertEquals([[lines filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"SELF == '- HLSRuntimeTestParent HLSRuntimeTestParent inheritedValue'"]] count], 
+                   (NSUInteger)3, nil);
+    GHAssertEquals([[lines filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"NOT SELF CONTAINS 'HLSRuntimeTestParent' AND SELF != ''"]] count], 
+                   (NSUInteger)0, nil);
+}
+
+@end
@@ -0,0 +1,90 @@
+//
+//  HLSSearchIndexTestCase.m
+//  CoconutKit-test
+//
+//  Created by Samuel Défago on 15.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSSearchIndexTestCase.h"
+
+@implementation HLSSearchIndexTestCase
+
+#pragma mark Tests
+
+- (void)testSearch
+{
+    NSMutableDictionary *ipod = [NSMutableDictionary dictionaryWithObjectsAndKeys:@"Apple iPod", @"name", @"Music", @"category", nil];
+    NSMutableDictionary *iphone = [NSMutableDictionary dictionaryWithObjectsAndKeys:@"Apple iPhone", @"name", @"Phone", @"category", nil];
+    NSMutableDictionary *galaxy = [NSMutableDictionary dictionaryWithObjectsAndKeys:@"Samsung Galaxy", @"name", @"Phone", @"category", nil];
+    NSMutableDictionary *cafe = [NSMutableDictionary dictionaryWithObjectsAndKeys:@"Café Phone", @"name", nil];
+    
+    HLSSearchIndex *searchIndex = [[[HLSSearchIndex alloc] initWithKeyPaths:[NSArray arrayWithObjects:@"name", @"category", nil]] autorelease];
+    [searchIndex addObject:ipod scopeButtonIndexes:[NSIndexSet indexSetWithIndex:1]];
+    [searchIndex addObject:iphone scopeButtonIndexes:[NSIndexSet indexSetWithIndex:2]];
+    [searchIndex addObject:galaxy scopeButtonIndexes:[NSIndexSet indexSetWithIndex:2]];
+    [searchIndex addObject:cafe scopeButtonIndexes:nil];
+    GHAssertEquals([searchIndex count], 4U, @"Count");
+    
+    // Empty search text: All objects in the scope, in insertion order
+    NSArray *expectedObjects1 = [NSArray arrayWithObjects:iphone, galaxy, cafe, nil];
+    GHAssertEqualObjects([searchIndex objectsMatchingSearchText:nil scopeButtonIndex:2 cancellationToken:nil], expectedObjects1, @"Empty search");
+    
+    // Short search text
+    GHAssertEqualObjects([searchIndex objectsMatchingSearchText:@"ip" scopeButtonIndex:1 cancellationToken:nil], [NSArray arrayWithObject:ipod], @"Short search");
+    GHAssertEqualObjects([searchIndex objectsMatchingSearchText:@"IP" scopeButtonIndex:NSNotFound cancellationToken:nil], [NSArray array], @"Short search");
+    
+    // Case and diacritic insensitive, on all key paths, narrowing the previous search
+    NSArray *expectedObjects3 = [NSArray arrayWithObjects:iphone, galaxy, cafe, nil];
+    GHAssertEqualObjects([searchIndex objectsMatchingSearchText:@"PH" scopeButtonIndex:2 cancellationToken:nil], expectedObjects3, @"Search");
+    GHAssertEqualObjects([searchIndex objectsMatchingSearchText:@"PHO" scopeButtonIndex:2 cancellationToken:nil], expectedObjects3, @"Narrowed search");
+    GHAssertEqualObjects([searchIndex objectsMatchingSearchText:@"iPhone" scopeButtonIndex:2 cancellationToken:nil], [NSArray arrayWithObject:iphone], @"Narrowed search");
+    GHAssertEqualObjects([searchIndex objectsMatchingSearchText:@"cafe" scopeButtonIndex:5 cancellationToken:nil], [NSArray arrayWithObject:cafe], @"Diacritics");
+    
+    // Scope change after a search
+    GHAssertEqualObjects([searchIndex objectsMatchingSearchText:@"ip" scopeButtonIndex:1 cancellationToken:nil], [NSArray arrayWithObject:ipod], @"Scope");
+    GHAssertEqualObjects([searchIndex objectsMatchingSearchText:@"ip" scopeButtonIndex:2 cancellationToken:nil], [NSArray arrayWithObject:iphone], @"Scope");
+    
+    // Update (position is kept)
+    [ipod setObject:@"Apple iPod Phone" forKey:@"name"];
+    [searchIndex addObject:ipod scopeButtonIndexes:[NSIndexSet indexSetWithIndex:2]];
+    GHAssertEquals([searchIndex count], 4U, @"Count");
+    NSArray *expectedObjects4 = [NSArray arrayWithObjects:ipod, iphone, galaxy, cafe, nil];
+    GHAssertEqualObjects([searchIndex objectsMatchingSearchText:@"phone" scopeButtonIndex:2 cancellationToken:nil], expectedObjects4, @"Updated");
+    
+    // Removal
+    [searchIndex removeObject:iphone];
+    GHAssertEquals([searchIndex count], 3U, @"Count");
+    NSArray *expectedObjects5 = [NSArray arrayWithObjects:ipod, galaxy, cafe, nil];
+    GHAssertEqualObjects([searchIndex objectsMatchingSearchText:@"phone" scopeButtonIndex:2 cancellationToken:nil], expectedObjects5, @"Removed");
+    
+    [searchIndex removeAllObjects];
+    GHAssertEquals([searchIndex count], 0U, @"Count");
+    GHAssertEqualObjects([searchIndex objectsMatchingSearchText:@"phone" scopeButtonIndex:2 cancellationToken:nil], [NSArray array], @"Removed");
+}
+
+- (void)testTrigrams
+{
+    HLSSearchIndex *searchIndex = [[[HLSSearchIndex alloc] initWithKeyPaths:[NSArray arrayWithObject:@"description"]] autorelease];
+    [searchIndex addObject:@"abcd bcde" scopeButtonIndexes:nil];
+    
+    // All trigrams are found, but not as a contiguous sequence
+    GHAssertEqualObjects([searchIndex objectsMatchingSearchText:@"abcde" scopeButtonIndex:0 cancellationToken:nil], [NSArray array], @"Not contiguous");
+    GHAssertEqualObjects([searchIndex objectsMatchingSearchText:@"abcd" scopeButtonIndex:0 cancellationToken:nil], 
+                         [NSArray arrayWithObject:@"abcd bcde"], @"Contiguous");
+    GHAssertEqualObjects([searchIndex objectsMatchingSearchText:@"xyz" scopeButtonIndex:0 cancellationToken:nil], [NSArray array], @"Missing trigram");
+}
+
+- (void)testCancellation
+{
+    HLSSearchIndex *searchIndex = [[[HLSSearchIndex alloc] initWithKeyPaths:[NSArray arrayWithObject:@"description"]] autorelease];
+    [searchIndex addObject:@"Hello, World!" scopeButtonIndexes:nil];
+    
+    HLSCancellationToken *cancellationToken = [[[HLSCancellationToken alloc] init] autorelease];
+    [cancellationToken cancel];
+    GHAssertNil([searchIndex objectsMatchingSearchText:@"world" scopeButtonIndex:0 cancellationToken:cancellationToken], @"Cancelled");
+    GHAssertEqualObjects([searchIndex objectsMatchingSearchText:@"world" scopeButtonIndex:0 cancellationToken:nil], 
+                         [NSArray arrayWithObject:@"Hello, World!"], @"Not cancelled");
+}
+
+@end
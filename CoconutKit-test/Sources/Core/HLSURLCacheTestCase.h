@@ -0,0 +1,14 @@
+//
+//  HLSURLCacheTestCase.h
+//  CoconutKit-test
+//
+//  Created by Samuel Défago on 15.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+@interface HLSURLCacheTestCase : GHTestCase {
+@private
+    HLSURLCache *m_URLCache;
+}
+
+@end
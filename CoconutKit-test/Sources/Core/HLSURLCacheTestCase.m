@@ -0,0 +1,277 @@
+//
+//  HLSURLCacheTestCase.m
+//  CoconutKit-test
+//
+//  Created by Samuel Défago on 15.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSURLCacheTestCase.h"
+
+static NSString * const kURLCacheTestHost = @"hlsurlcachetestcase.test";
+
+// Status code and body of the responses served to revalidation requests
+static NSInteger s_revalidationStatusCode = 304;
+static NSString *s_revalidationBody = nil;
+
+// Revalidation requests received so far
+static NSMutableArray *s_revalidationRequests = nil;
+
+/**
+ * Serve the requests made to kURLCacheTestHost locally, so that revalidation can be tested without network
+ */
+@interface URLCacheTestURLProtocol : NSURLProtocol
+
+@end
+
+@interface HLSURLCache (HLSURLCacheTestCase)
+
+@property (nonatomic, readonly, retain) NSOperationQueue *revalidationQueue;
+
+@end
+
+@interface HLSURLCacheTestCase ()
+
+@property (nonatomic, retain) HLSURLCache *URLCache;
+
+- (NSString *)cacheDirectoryPath;
+- (NSURLRequest *)requestWithName:(NSString *)name;
+- (NSCachedURLResponse *)cachedResponseForRequest:(NSURLRequest *)request body:(NSString *)body cacheControl:(NSString *)cacheControl;
+- (NSString *)bodyOfCachedResponse:(NSCachedURLResponse *)cachedResponse;
+- (NSUInteger)revalidationRequestCount;
+
+@end
+
+@implementation HLSURLCacheTestCase
+
+#pragma mark Test setup and tear down
+
+- (void)setUpClass
+{
+    [super setUpClass];
+    
+    s_revalidationRequests = [[NSMutableArray alloc] init];
+    [NSURLProtocol registerClass:[URLCacheTestURLProtocol class]];
+}
+
+- (void)tearDownClass
+{
+    [NSURLProtocol unregisterClass:[URLCacheTestURLProtocol class]];
+    [s_revalidationRequests release];
+    s_revalidationRequests = nil;
+    
+    [super tearDownClass];
+}
+
+- (void)setUp
+{
+    [super setUp];
+    
+    [[NSFileManager defaultManager] removeItemAtPath:[self cacheDirectoryPath] error:NULL];
+    
+    // No memory capacity, so that responses are always read from disk
+    self.URLCache = [[[HLSURLCache alloc] initWithMemoryCapacity:0 diskCapacity:1024 * 1024 diskPath:[self cacheDirectoryPath]] autorelease];
+    
+    @synchronized(s_revalidationRequests) {
+        [s_revalidationRequests removeAllObjects];
+    }
+    s_revalidationStatusCode = 304;
+    s_revalidationBody = nil;
+}
+
+- (void)tearDown
+{
+    [self.URLCache.revalidationQueue waitUntilAllOperationsAreFinished];
+    self.URLCache = nil;
+    [[NSFileManager defaultManager] removeItemAtPath:[self cacheDirectoryPath] error:NULL];
+    
+    [super tearDown];
+}
+
+#pragma mark Accessors and mutators
+
+@synthesize URLCache = m_URLCache;
+
+#pragma mark Tests
+
+- (void)testHit
+{
+    NSURLRequest *request = [self requestWithName:@"hit"];
+    GHAssertFalse([self.URLCache hasCachedResponseForRequest:request], @"No response yet");
+    GHAssertNil([self.URLCache cachedResponseForRequest:request], @"No response yet");
+    
+    [self.URLCache storeCachedResponse:[self cachedResponseForRequest:request body:@"hit" cacheControl:@"max-age=3600"]
+                            forRequest:request];
+    GHAssertTrue([self.URLCache hasCachedResponseForRequest:request], @"Stored");
+    GHAssertEqualStrings([self bodyOfCachedResponse:[self.URLCache cachedResponseForRequest:request]], @"hit", @"Hit");
+    
+    // The index is restored from disk
+    HLSURLCache *URLCache = [[[HLSURLCache alloc] initWithMemoryCapacity:0 diskCapacity:1024 * 1024 diskPath:[self cacheDirectoryPath]] autorelease];
+    GHAssertEqualStrings([self bodyOfCachedResponse:[URLCache cachedResponseForRequest:request]], @"hit", @"Hit after reload");
+    
+    // Fresh responses are not revalidated
+    [self.URLCache.revalidationQueue waitUntilAllOperationsAreFinished];
+    [URLCache.revalidationQueue waitUntilAllOperationsAreFinished];
+    GHAssertEquals([self revalidationRequestCount], 0U, @"No revalidation");
+    
+    // Only GET requests are cached
+    NSMutableURLRequest *postRequest = [[[self requestWithName:@"post"] mutableCopy] autorelease];
+    [postRequest setHTTPMethod:@"POST"];
+    [self.URLCache storeCachedResponse:[self cachedResponseForRequest:postRequest body:@"post" cacheControl:@"max-age=3600"]
+                            forRequest:postRequest];
+    GHAssertFalse([self.URLCache hasCachedResponseForRequest:postRequest], @"POST");
+    
+    [self.URLCache removeCachedResponseForRequest:request];
+    GHAssertFalse([self.URLCache hasCachedResponseForRequest:request], @"Removed");
+    GHAssertEquals([self.URLCache currentDiskUsage], 0U, @"Disk usage");
+}
+
+- (void)testExpiry
+{
+    NSURLRequest *request = [self requestWithName:@"expiry"];
+    [self.URLCache storeCachedResponse:[self cachedResponseForRequest:request body:@"expiry" cacheControl:@"max-age=1"]
+                            forRequest:request];
+    GHAssertEqualStrings([self bodyOfCachedResponse:[self.URLCache cachedResponseForRequest:request]], @"expiry", @"Fresh");
+    [self.URLCache.revalidationQueue waitUntilAllOperationsAreFinished];
+    GHAssertEquals([self revalidationRequestCount], 0U, @"No revalidation while fresh");
+    
+    [NSThread sleepForTimeInterval:1.5];
+    
+    // Stale responses are still returned, but revalidated in the background
+    GHAssertEqualStrings([self bodyOfCachedResponse:[self.URLCache cachedResponseForRequest:request]], @"expiry", @"Stale");
+    [self.URLCache.revalidationQueue waitUntilAllOperationsAreFinished];
+    GHAssertEquals([self revalidationRequestCount], 1U, @"Revalidation");
+    
+    // No revalidation when disabled
+    self.URLCache.revalidatingInBackground = NO;
+    [NSThread sleepForTimeInterval:1.5];
+    GHAssertEqualStrings([self bodyOfCachedResponse:[self.URLCache cachedResponseForRequest:request]], @"expiry", @"Stale");
+    [self.URLCache.revalidationQueue waitUntilAllOperationsAreFinished];
+    GHAssertEquals([self revalidationRequestCount], 1U, @"Revalidation disabled");
+    
+    // Responses without freshness information are always stale
+    NSURLRequest *noCacheRequest = [self requestWithName:@"no-cache"];
+    [self.URLCache storeCachedResponse:[self cachedResponseForRequest:noCacheRequest body:@"no-cache" cacheControl:@"no-cache"]
+                            forRequest:noCacheRequest];
+    self.URLCache.revalidatingInBackground = YES;
+    GHAssertEqualStrings([self bodyOfCachedResponse:[self.URLCache cachedResponseForRequest:noCacheRequest]], @"no-cache", @"Stale");
+    [self.URLCache.revalidationQueue waitUntilAllOperationsAreFinished];
+    GHAssertEquals([self revalidationRequestCount], 2U, @"Revalidation");
+}
+
+- (void)testRevalidation
+{
+    // Not modified: The stored response is kept and fresh again
+    NSURLRequest *request = [self requestWithName:@"revalidation"];
+    [self.URLCache storeCachedResponse:[self cachedResponseForRequest:request body:@"original" cacheControl:@"max-age=1"]
+                            forRequest:request];
+    [NSThread sleepForTimeInterval:1.5];
+    GHAssertEqualStrings([self bodyOfCachedResponse:[self.URLCache cachedResponseForRequest:request]], @"original", @"Stale");
+    [self.URLCache.revalidationQueue waitUntilAllOperationsAreFinished];
+    GHAssertEquals([self revalidationRequestCount], 1U, @"Revalidation");
+    
+    NSURLRequest *revalidationRequest = [s_revalidationRequests objectAtIndex:0];
+    GHAssertEqualStrings([revalidationRequest valueForHTTPHeaderField:@"If-None-Match"], @"\"original\"", @"Validator");
+    
+    GHAssertEqualStrings([self bodyOfCachedResponse:[self.URLCache cachedResponseForRequest:request]], @"original", @"Not modified");
+    [self.URLCache.revalidationQueue waitUntilAllOperationsAreFinished];
+    GHAssertEquals([self revalidationRequestCount], 1U, @"Fresh again");
+    
+    // Modified: The new response replaces the stored one
+    s_revalidationStatusCode = 200;
+    s_revalidationBody = @"modified";
+    [NSThread sleepForTimeInterval:1.5];
+    GHAssertEqualStrings([self bodyOfCachedResponse:[self.URLCache cachedResponseForRequest:request]], @"original", @"Stale");
+    [self.URLCache.revalidationQueue waitUntilAllOperationsAreFinished];
+    GHAssertEquals([self revalidationRequestCount], 2U, @"Revalidation");
+    
+    GHAssertEqualStrings([self bodyOfCachedResponse:[self.URLCache cachedResponseForRequest:request]], @"modified", @"Modified");
+    [self.URLCache.revalidationQueue waitUntilAllOperationsAreFinished];
+    GHAssertEquals([self revalidationRequestCount], 2U, @"Fresh");
+}
+
+#pragma mark Helpers
+
+- (NSString *)cacheDirectoryPath
+{
+    return [NSTemporaryDirectory() stringByAppendingPathComponent:@"HLSURLCacheTestCase"];
+}
+
+- (NSURLRequest *)requestWithName:(NSString *)name
+{
+    NSString *URLString = [NSString stringWithFormat:@"http://%@/%@", kURLCacheTestHost, name];
+    return [NSURLRequest requestWithURL:[NSURL URLWithString:URLString]];
+}
+
+- (NSCachedURLResponse *)cachedResponseForRequest:(NSURLRequest *)request body:(NSString *)body cacheControl:(NSString *)cacheControl
+{
+    NSDictionary *headerFields = [NSDictionary dictionaryWithObjectsAndKeys:cacheControl, @"Cache-Control",
+                                  [NSString stringWithFormat:@"\"%@\"", body], @"ETag",
+                                  nil];
+    NSHTTPURLResponse *response = [[[NSHTTPURLResponse alloc] initWithURL:[request URL]
+                                                               statusCode:200
+                                                              HTTPVersion:@"HTTP/1.1"
+                                                             headerFields:headerFields] autorelease];
+    return [[[NSCachedURLResponse alloc] initWithResponse:response data:[body dataUsingEncoding:NSUTF8StringEncoding]] autorelease];
+}
+
+- (NSString *)bodyOfCachedResponse:(NSCachedURLResponse *)cachedResponse
+{
+    if (! cachedResponse) {
+        return nil;
+    }
+    return [[[NSString alloc] initWithData:[cachedResponse data] encoding:NSUTF8StringEncoding] autorelease];
+}
+
+- (NSUInteger)revalidationRequestCount
+{
+    @synchronized(s_revalidationRequests) {
+        return [s_revalidationRequests count];
+    }
+}
+
+@end
+
+@implementation URLCacheTestURLProtocol
+
++ (BOOL)canInitWithRequest:(NSURLRequest *)request
+{
+    return [[[request URL] host] isEqualToString:kURLCacheTestHost];
+}
+
++ (NSURLRequest *)canonicalRequestForRequest:(NSURLRequest *)request
+{
+    return request;
+}
+
+- (void)startLoading
+{
+    @synchronized(s_revalidationRequests) {
+        [s_revalidationRequests addObject:[self request]];
+    }
+    
+    NSDictionary *headerFields = nil;
+    NSData *data = nil;
+    if (s_revalidationStatusCode == 200) {
+        headerFields = [NSDictionary dictionaryWithObjectsAndKeys:@"max-age=3600", @"Cache-Control",
+                        [NSString stringWithFormat:@"\"%@\"", s_revalidationBody], @"ETag",
+                        nil];
+        data = [s_revalidationBody dataUsingEncoding:NSUTF8StringEncoding];
+    }
+    NSHTTPURLResponse *response = [[[NSHTTPURLResponse alloc] initWithURL:[[self request] URL]
+                                                               statusCode:s_revalidationStatusCode
+                                                              HTTPVersion:@"HTTP/1.1"
+                                                             headerFields:headerFields] autorelease];
+    [[self client] URLProtocol:self didReceiveResponse:response cacheStoragePolicy:NSURLCacheStorageNotAllowed];
+    if (data) {
+        [[self client] URLProtocol:self didLoadData:data];
+    }
+    [[self client] URLProtocolDidFinishLoading:self];
+}
+
+- (void)stopLoading
+{
+
+}
+
+@end
@@ -57,6 +57,31 @@
     GHAssertFalse([HLSValidators validateEmailAddress:@"Test \\ Folding \\ Whitespace@example.com"], @"E-mail");            // inconsistency
     GHAssertFalse([HLSValidators validateEmailAddress:@"HM2Kinsists@(that comments are allowed)this.is.ok"], @"E-mail");    // inconsistency
     GHAssertTrue([HLSValidators validateEmailAddress:@"user%%uucp!path@somehost.edu"], @"E-mail");
+    GHAssertFalse([HLSValidators validateEmailAddress:@"a@bar.com\n"], @"E-mail");
+    GHAssertFalse([HLSValidators validateEmailAddress:nil], @"E-mail");
+}
+
+- (void)testEmailAddressBatchValidation
+{
+    GHAssertEquals([[HLSValidators validateEmailAddresses:nil] count], (NSUInteger)0, @"Empty batch");
+    
+    // Large enough to be split into several work items
+    NSMutableArray *emailAddresses = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 1000; ++i) {
+        if (i % 3 == 0) {
+            [emailAddresses addObject:[NSString stringWithFormat:@"name%d@domain.com", i]];
+        }
+        else {
+            [emailAddresses addObject:[NSString stringWithFormat:@"name%d@domain", i]];
+        }
+    }
+    [emailAddresses addObject:[NSNumber numberWithInt:1]];
+    
+    NSIndexSet *validIndexes = [HLSValidators validateEmailAddresses:emailAddresses];
+    GHAssertEquals([validIndexes count], (NSUInteger)334, @"Valid addresses");
+    for (NSUInteger i = 0; i < [emailAddresses count]; ++i) {
+        GHAssertEquals([validIndexes containsIndex:i], (BOOL)(i % 3 == 0 && i < 1000), @"Index %d", i);
+    }
 }
 
 @end
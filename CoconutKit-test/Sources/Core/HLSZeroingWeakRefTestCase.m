@@ -8,12 +8,64 @@
 
 #import "HLSZeroingWeakRefTestCase.h"
 
+#import <libkern/OSAtomic.h>
+
+static const NSUInteger kBenchmarkThreadCount = 8;
+static const NSUInteger kBenchmarkZeroingWeakRefCount = 20000;
+static const NSUInteger kBenchmarkSharedObjectCount = 16;
+
 @interface BasicClass : NSObject
 
 @end
 
+static volatile int32_t s_cleanupCount = 0;
+static volatile int32_t s_finishedThreadCount = 0;
+
+@interface HLSZeroingWeakRefTestCase ()
+
+- (void)cleanup;
+- (void)createAndReleaseZeroingWeakRefsToObjects:(NSArray *)objects;
+- (void)runThreadsWithObjects:(NSArray *)objects;
+
+@end
+
 @implementation HLSZeroingWeakRefTestCase
 
+#pragma mark Cleanup
+
+- (void)cleanup
+{
+    OSAtomicIncrement32Barrier(&s_cleanupCount);
+}
+
+#pragma mark Benchmark helpers
+
+// Called on a secondary thread
+- (void)createAndReleaseZeroingWeakRefsToObjects:(NSArray *)objects
+{
+    NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+    for (NSUInteger i = 0; i < kBenchmarkZeroingWeakRefCount; ++i) {
+        HLSZeroingWeakRef *zeroingWeakRef = [[HLSZeroingWeakRef alloc] initWithObject:[objects objectAtIndex:i % [objects count]]];
+        if (i % 2 == 0) {
+            [zeroingWeakRef addCleanupAction:@selector(cleanup) onTarget:self];
+        }
+        [zeroingWeakRef release];
+    }
+    OSAtomicIncrement32Barrier(&s_finishedThreadCount);
+    [pool drain];
+}
+
+- (void)runThreadsWithObjects:(NSArray *)objects
+{
+    s_finishedThreadCount = 0;
+    for (NSUInteger i = 0; i < kBenchmarkThreadCount; ++i) {
+        [NSThread detachNewThreadSelector:@selector(createAndReleaseZeroingWeakRefsToObjects:) toTarget:self withObject:objects];
+    }
+    while (OSAtomicAdd32Barrier(0, &s_finishedThreadCount) != kBenchmarkThreadCount) {
+        [NSThread sleepForTimeInterval:0.001];
+    }
+}
+
 #pragma mark Tests
 
 - (void)testNonTollFreeBridgedObject
@@ -25,6 +77,74 @@
     GHAssertNil(zeroingWeakRef.object, @"Zeroed object reference");
 }
 
+- (void)testCleanupActions
+{
+    s_cleanupCount = 0;
+    BasicClass *basicClass = [[BasicClass alloc] init];
+    HLSZeroingWeakRef *zeroingWeakRef1 = [[[HLSZeroingWeakRef alloc] initWithObject:basicClass] autorelease];
+    [zeroingWeakRef1 addCleanupAction:@selector(cleanup) onTarget:self];
+    HLSZeroingWeakRef *zeroingWeakRef2 = [[[HLSZeroingWeakRef alloc] initWithObject:basicClass] autorelease];
+    [zeroingWeakRef2 addCleanupAction:@selector(cleanup) onTarget:self];
+    
+    // A released weak reference must not perform its cleanup actions anymore
+    HLSZeroingWeakRef *zeroingWeakRef3 = [[HLSZeroingWeakRef alloc] initWithObject:basicClass];
+    [zeroingWeakRef3 addCleanupAction:@selector(cleanup) onTarget:self];
+    [zeroingWeakRef3 release];
+    
+    GHAssertTrue([basicClass class] == [BasicClass class], nil);
+    [basicClass release];
+    GHAssertNil(zeroingWeakRef1.object, nil);
+    GHAssertNil(zeroingWeakRef2.object, nil);
+    GHAssertEquals(s_cleanupCount, (int32_t)2, nil);
+}
+
+- (void)testConcurrentAccess
+{
+    s_cleanupCount = 0;
+    
+    // A few objects shared by all threads (maximum contention)
+    NSMutableArray *sharedObjects = [NSMutableArray array];
+    for (NSUInteger i = 0; i < kBenchmarkSharedObjectCount; ++i) {
+        [sharedObjects addObject:[[[BasicClass alloc] init] autorelease]];
+    }
+    
+    // Keep weak references alive while the objects are deallocated
+    NSMutableArray *zeroingWeakRefs = [NSMutableArray array];
+    for (BasicClass *sharedObject in sharedObjects) {
+        HLSZeroingWeakRef *zeroingWeakRef = [[[HLSZeroingWeakRef alloc] initWithObject:sharedObject] autorelease];
+        [zeroingWeakRef addCleanupAction:@selector(cleanup) onTarget:self];
+        [zeroingWeakRefs addObject:zeroingWeakRef];
+    }
+    
+    CFAbsoluteTime sharedStartTime = CFAbsoluteTimeGetCurrent();
+    [self runThreadsWithObjects:sharedObjects];
+    CFTimeInterval sharedDuration = CFAbsoluteTimeGetCurrent() - sharedStartTime;
+    GHTestLog(@"Created and released %d zeroing weak refs to %d shared objects from %d threads in %.3f s (%.0f refs / s)",
+              kBenchmarkThreadCount * kBenchmarkZeroingWeakRefCount, kBenchmarkSharedObjectCount, kBenchmarkThreadCount, 
+              sharedDuration, kBenchmarkThreadCount * kBenchmarkZeroingWeakRefCount / sharedDuration);
+    
+    // Released weak references must not have performed their cleanup actions
+    GHAssertEquals(s_cleanupCount, (int32_t)0, nil);
+    [sharedObjects removeAllObjects];
+    GHAssertEquals(s_cleanupCount, (int32_t)kBenchmarkSharedObjectCount, nil);
+    for (HLSZeroingWeakRef *zeroingWeakRef in zeroingWeakRefs) {
+        GHAssertNil(zeroingWeakRef.object, nil);
+    }
+    
+    // Many objects (little contention)
+    NSMutableArray *objects = [NSMutableArray array];
+    for (NSUInteger i = 0; i < kBenchmarkZeroingWeakRefCount; ++i) {
+        [objects addObject:[[[BasicClass alloc] init] autorelease]];
+    }
+    
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    [self runThreadsWithObjects:objects];
+    CFTimeInterval duration = CFAbsoluteTimeGetCurrent() - startTime;
+    GHTestLog(@"Created and released %d zeroing weak refs to %d objects from %d threads in %.3f s (%.0f refs / s)",
+              kBenchmarkThreadCount * kBenchmarkZeroingWeakRefCount, kBenchmarkZeroingWeakRefCount, kBenchmarkThreadCount, 
+              duration, kBenchmarkThreadCount * kBenchmarkZeroingWeakRefCount / duration);
+}
+
 - (void)testTollFreeBridgedObject
 {
     NSNumber *number = [[NSNumber alloc] initWithInt:1012];
@@ -32,6 +32,66 @@
     NSArray *rightArray = [array arrayByRightRotatingNumberOfObjects:2];
     NSArray *expectedRightArray = [NSArray arrayWithObjects:@"2", @"3", @"1", nil];
     GHAssertTrue([rightArray isEqualToArray:expectedRightArray], @"right");
+    
+    NSArray *leftRightArray = [leftArray arrayByRightRotatingNumberOfObjects:2];
+    GHAssertTrue([leftRightArray isEqualToArray:array], @"left then right");
+    
+    NSMutableArray *mutableLeftArray = [[leftArray mutableCopy] autorelease];
+    [mutableLeftArray addObject:@"4"];
+    NSArray *expectedMutableLeftArray = [NSArray arrayWithObjects:@"3", @"1", @"2", @"4", nil];
+    GHAssertTrue([mutableLeftArray isEqualToArray:expectedMutableLeftArray], @"mutable copy");
+    GHAssertTrue([leftArray isEqualToArray:expectedLeftArray], @"left unchanged");
+    
+    NSArray *emptyArray = [NSArray array];
+    GHAssertEquals([[emptyArray arrayByLeftRotatingNumberOfObjects:2] count], 0U, @"empty");
+}
+
+- (void)testSorting
+{
+    // Few distinct values, so that stability matters. Above the parallel sort threshold
+    NSMutableArray *array = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 20000; ++i) {
+        [array addObject:[NSDictionary dictionaryWithObjectsAndKeys:[NSNumber numberWithUnsignedInteger:(i * 7919) % 100], @"value",
+                          [NSNumber numberWithUnsignedInteger:i], @"index", nil]];
+    }
+    
+    NSSortDescriptor *sortDescriptor = [NSSortDescriptor sortDescriptorWithKey:@"value" ascending:NO];
+    
+    CFAbsoluteTime referenceStartTime = CFAbsoluteTimeGetCurrent();
+    NSArray *referenceSortedArray = [array sortedArrayUsingDescriptors:[NSArray arrayWithObject:sortDescriptor]];
+    CFTimeInterval referenceDuration = CFAbsoluteTimeGetCurrent() - referenceStartTime;
+    
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    NSArray *sortedArray = [array sortedArrayUsingDescriptor:sortDescriptor];
+    CFTimeInterval duration = CFAbsoluteTimeGetCurrent() - startTime;
+    GHTestLog(@"Sorted %d objects in %.3f s (%.3f s with -sortedArrayUsingDescriptors:)", [array count], duration, referenceDuration);
+    
+    GHAssertEquals([sortedArray count], [referenceSortedArray count], @"count");
+    for (NSUInteger i = 1; i < [sortedArray count]; ++i) {
+        NSDictionary *previousObject = [sortedArray objectAtIndex:i - 1];
+        NSDictionary *object = [sortedArray objectAtIndex:i];
+        NSComparisonResult valueResult = [[previousObject objectForKey:@"value"] compare:[object objectForKey:@"value"]];
+        GHAssertNotEquals(valueResult, NSOrderedAscending, @"order");
+        
+        // Stable sort
+        if (valueResult == NSOrderedSame) {
+            GHAssertEquals([[previousObject objectForKey:@"index"] compare:[object objectForKey:@"index"]], NSOrderedAscending, @"stability");
+        }
+    }
+    
+    NSMutableArray *insertionArray = [NSMutableArray array];
+    NSArray *numbers = [NSArray arrayWithObjects:[NSNumber numberWithInt:3], [NSNumber numberWithInt:1], [NSNumber numberWithInt:2], 
+                        [NSNumber numberWithInt:1], nil];
+    NSSortDescriptor *numberSortDescriptor = [NSSortDescriptor sortDescriptorWithKey:@"self" ascending:YES];
+    for (NSNumber *number in numbers) {
+        [insertionArray insertObject:number sortedUsingDescriptor:numberSortDescriptor];
+    }
+    NSArray *expectedInsertionArray = [NSArray arrayWithObjects:[NSNumber numberWithInt:1], [NSNumber numberWithInt:1], 
+                                       [NSNumber numberWithInt:2], [NSNumber numberWithInt:3], nil];
+    GHAssertTrue([insertionArray isEqualToArray:expectedInsertionArray], @"insertion");
+    GHAssertEquals([insertionArray indexOfObject:[NSNumber numberWithInt:1] sortedUsingDescriptor:numberSortDescriptor], 0U, @"lookup");
+    GHAssertEquals([insertionArray indexOfObject:[NSNumber numberWithInt:3] sortedUsingDescriptor:numberSortDescriptor], 3U, @"lookup");
+    GHAssertEquals([insertionArray indexOfObject:[NSNumber numberWithInt:4] sortedUsingDescriptor:numberSortDescriptor], (NSUInteger)NSNotFound, @"lookup");
 }
 
 - (void)testSafeInsert
@@ -913,4 +913,50 @@
     GHAssertTrue([self.calendar compareDaysBetweenDate:self.date2 andDate:otherDateTahiti2 inTimeZone:self.timeZoneTahiti] == NSOrderedSame, @"Day");
 }
 
+- (void)testGetStartTimeIntervalsOfUnitContainingTimeIntervalsInTimeZone
+{
+    // Hourly dates over a month containing the CET -> CEST transition, in reverse order
+    static const NSUInteger kCount = 31 * 24;
+    NSTimeInterval timeIntervals[kCount];
+    for (NSUInteger i = 0; i < kCount; ++i) {
+        timeIntervals[i] = [self.date5 timeIntervalSinceReferenceDate] + 15. * 24. * 60. * 60. - i * 60. * 60. - 17.;
+    }
+    
+    NSCalendarUnit units[] = { NSDayCalendarUnit, NSWeekCalendarUnit, NSMonthCalendarUnit };
+    NSArray *timeZones = [NSArray arrayWithObjects:self.timeZoneZurich, self.timeZoneTahiti, nil];
+    for (NSUInteger j = 0; j < sizeof(units) / sizeof(NSCalendarUnit); ++j) {
+        for (NSTimeZone *timeZone in timeZones) {
+            NSTimeInterval startTimeIntervals[kCount];
+            [self.calendar getStartTimeIntervals:startTimeIntervals ofUnit:units[j] containingTimeIntervals:timeIntervals count:kCount inTimeZone:timeZone];
+            for (NSUInteger i = 0; i < kCount; ++i) {
+                NSDate *date = [NSDate dateWithTimeIntervalSinceReferenceDate:timeIntervals[i]];
+                NSDate *startDate = [self.calendar startDateOfUnit:units[j] containingDate:date inTimeZone:timeZone];
+                GHAssertEquals(startTimeIntervals[i], [startDate timeIntervalSinceReferenceDate], nil);
+            }
+        }
+    }
+}
+
+- (void)testClassMethodsBenchmark
+{
+    static const NSUInteger kBenchmarkCallCount = 10000;
+    
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    for (NSUInteger i = 0; i < kBenchmarkCallCount; ++i) {
+        NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+        [NSCalendar isDate:self.date1 theSameDayAsDate:self.date2];
+        [pool drain];
+    }
+    CFTimeInterval duration = CFAbsoluteTimeGetCurrent() - startTime;
+    GHTestLog(@"Called +isDate:theSameDayAsDate: %d times in %.3f s", kBenchmarkCallCount, duration);
+    
+    // Results must follow default time zone changes
+    NSTimeZone *defaultTimeZone = [NSTimeZone defaultTimeZone];
+    [NSTimeZone setDefaultTimeZone:self.timeZoneZurich];
+    GHAssertEqualObjects([NSCalendar dateAtMidnightTheSameDayAsDate:self.date1], [self.calendar dateAtMidnightTheSameDayAsDate:self.date1 inTimeZone:self.timeZoneZurich], nil);
+    [NSTimeZone setDefaultTimeZone:self.timeZoneTahiti];
+    GHAssertEqualObjects([NSCalendar dateAtMidnightTheSameDayAsDate:self.date1], [self.calendar dateAtMidnightTheSameDayAsDate:self.date1 inTimeZone:self.timeZoneTahiti], nil);
+    [NSTimeZone setDefaultTimeZone:defaultTimeZone];
+}
+
 @end
@@ -26,4 +26,51 @@
     GHAssertEqualStrings([testData sha512hash], @"374d794a95cdcfd8b35993185fef9ba368f160d8daf432d08ba9f1ed1e5abe6cc69291e0fa2fe0006a52570ef18c19def4e617c33ce52ef0a6e5fbe318cb0387", @"sha512");
 }
 
+- (void)testXXH64
+{
+    GHAssertEqualStrings([[NSData data] xxh64hash], @"ef46db3751d8e999", nil);
+    GHAssertEqualStrings([[@"abc" dataUsingEncoding:NSUTF8StringEncoding] xxh64hash], @"44bc2cf5ad770999", nil);
+    GHAssertEqualStrings([[@"Nobody inspects the spammish repetition" dataUsingEncoding:NSUTF8StringEncoding] xxh64hash], @"fbcea83c8a378bf1", nil);
+    GHAssertEquals([@"Nobody inspects the spammish repetition" xxh64Value], 0xfbcea83c8a378bf1ULL, nil);
+    GHAssertEqualStrings([@"abc" xxh64hash], @"44bc2cf5ad770999", nil);
+}
+
+- (void)testIncrementalDigest
+{
+    NSData *testData = [@"Hello, World!" dataUsingEncoding:NSUTF8StringEncoding];
+    
+    HLSDigest *digest = [[[HLSDigest alloc] initWithAlgorithm:HLSDigestAlgorithmSHA256] autorelease];
+    [digest updateWithBytes:[testData bytes] length:5];
+    [digest updateWithData:[testData subdataWithRange:NSMakeRange(5, [testData length] - 5)]];
+    GHAssertEqualStrings([digest finalHexDigest], [testData sha256hash], nil);
+    GHAssertEqualStrings([digest finalHexDigest], [testData sha256hash], nil);
+    
+    HLSDigest *emptyDigest = [[[HLSDigest alloc] initWithAlgorithm:HLSDigestAlgorithmMD5] autorelease];
+    GHAssertEqualStrings([emptyDigest finalHexDigest], [[NSData data] md5hash], nil);
+}
+
+- (void)testFileDigest
+{
+    NSMutableData *fileData = [NSMutableData dataWithLength:3 * 1024 * 1024 + 17];
+    unsigned char *bytes = (unsigned char *)[fileData mutableBytes];
+    for (NSUInteger i = 0; i < [fileData length]; ++i) {
+        bytes[i] = i % 251;
+    }
+    
+    NSString *filePath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"HLSFileDigestTest.data"];
+    GHAssertTrue([[HLSFileManager defaultManager] createFileAtPath:filePath contents:fileData error:NULL], nil);
+    GHAssertEqualStrings([[HLSFileManager defaultManager] hexDigestOfFileAtPath:filePath usingAlgorithm:HLSDigestAlgorithmSHA1 error:NULL], 
+                         [fileData sha1hash], nil);
+    
+    NSData *rangeData = [[HLSFileManager defaultManager] contentsOfFileAtPath:filePath range:NSMakeRange([fileData length] - 10, 20) error:NULL];
+    GHAssertEqualObjects(rangeData, [fileData subdataWithRange:NSMakeRange([fileData length] - 10, 10)], nil);
+    GHAssertEquals([[[HLSFileManager defaultManager] contentsOfFileAtPath:filePath range:NSMakeRange([fileData length] + 1, 20) error:NULL] length], 
+                   (NSUInteger)0, nil);
+    GHAssertTrue([[HLSFileManager defaultManager] removeItemAtPath:filePath error:NULL], nil);
+    
+    NSError *error = nil;
+    GHAssertNil([[HLSFileManager defaultManager] hexDigestOfFileAtPath:filePath usingAlgorithm:HLSDigestAlgorithmSHA1 error:&error], nil);
+    GHAssertNotNil(error, nil);
+}
+
 @end
@@ -25,6 +25,53 @@
     GHAssertEquals([dictionary2 count], 0U, @"remove many");
 }
 
+- (void)testPersistentUpdates
+{
+    NSMutableDictionary *referenceDictionary = [NSMutableDictionary dictionary];
+    NSDictionary *dictionary = [NSDictionary dictionary];
+    for (NSUInteger i = 0; i < 2000; ++i) {
+        NSString *key = [NSString stringWithFormat:@"key%d", i % 1500];
+        NSNumber *object = [NSNumber numberWithUnsignedInteger:i];
+        dictionary = [dictionary dictionaryBySettingObject:object forKey:key];
+        [referenceDictionary setObject:object forKey:key];
+    }
+    GHAssertTrue([dictionary isKindOfClass:[HLSPersistentDictionary class]], @"class");
+    GHAssertTrue([dictionary isEqualToDictionary:referenceDictionary], @"set");
+    
+    // Previous versions are left untouched
+    NSDictionary *previousDictionary = dictionary;
+    for (NSUInteger i = 0; i < 1500; i += 2) {
+        NSString *key = [NSString stringWithFormat:@"key%d", i];
+        dictionary = [dictionary dictionaryByRemovingObjectForKey:key];
+        [referenceDictionary removeObjectForKey:key];
+    }
+    GHAssertTrue([dictionary isEqualToDictionary:referenceDictionary], @"remove");
+    GHAssertEquals([previousDictionary count], 1500U, @"previous");
+    GHAssertNotNil([previousDictionary objectForKey:@"key0"], @"previous");
+    
+    NSUInteger keyCount = 0;
+    for (NSString *key in dictionary) {
+        GHAssertNotNil([referenceDictionary objectForKey:key], @"enumeration");
+        ++keyCount;
+    }
+    GHAssertEquals(keyCount, [referenceDictionary count], @"enumeration");
+    
+    GHAssertEquals([dictionary dictionaryByRemovingObjectForKey:@"unknown"], dictionary, @"remove unknown");
+    
+    // Plain dictionaries are converted, immutable ones only once. Updates never alter the receiver
+    NSDictionary *plainDictionary = [NSDictionary dictionaryWithObjectsAndKeys:@"obj1", @"key1", @"obj2", @"key2", nil];
+    GHAssertEqualObjects([[plainDictionary dictionaryBySettingObject:@"obj3" forKey:@"key3"] objectForKey:@"key3"], @"obj3", @"plain set");
+    GHAssertEquals([[plainDictionary dictionaryByRemovingObjectForKey:@"key1"] count], 1U, @"plain remove");
+    GHAssertEquals([[plainDictionary dictionaryBySettingObject:@"obj4" forKey:@"key4"] count], 3U, @"plain set again");
+    GHAssertEquals([plainDictionary count], 2U, @"plain unchanged");
+    
+    // Mutable dictionaries can change between updates
+    NSMutableDictionary *mutableDictionary = [NSMutableDictionary dictionaryWithObject:@"obj1" forKey:@"key1"];
+    GHAssertEquals([[mutableDictionary dictionaryBySettingObject:@"obj2" forKey:@"key2"] count], 2U, @"mutable set");
+    [mutableDictionary setObject:@"obj3" forKey:@"key3"];
+    GHAssertEquals([[mutableDictionary dictionaryBySettingObject:@"obj2" forKey:@"key2"] count], 3U, @"mutable changed");
+}
+
 - (void)testSafeInsert
 {
     NSMutableDictionary *dictionary = [NSMutableDictionary dictionary];
@@ -20,6 +20,19 @@
     GHAssertFalse([@"" isFilled], @"!filled");
     GHAssertFalse([@"     \t  " isFilled], @"!filled");
     GHAssertTrue([@"  abc  " isFilled], @"filled");
+    
+    GHAssertEqualStrings([@"   " stringByTrimmingWhitespaces], @"", @"trim");
+    GHAssertEqualStrings([@"a" stringByTrimmingWhitespaces], @"a", @"trim");
+    GHAssertEqualStrings([@" a b " stringByTrimmingWhitespaces], @"a b", @"trim");
+    
+    // Nothing to trim: No new string is created
+    NSString *trimmedString = @"Hello, World!";
+    GHAssertEquals([trimmedString stringByTrimmingWhitespaces], trimmedString, @"trim");
+    
+    NSMutableString *mutableString = [NSMutableString stringWithString:@"Hello"];
+    NSString *trimmedMutableString = [mutableString stringByTrimmingWhitespaces];
+    [mutableString appendString:@", World!"];
+    GHAssertEqualStrings(trimmedMutableString, @"Hello", @"trim");
 }
 
 - (void)testHashMethods
@@ -55,4 +68,15 @@
     GHAssertEqualStrings([string urlEncodedStringUsingEncoding:NSUTF8StringEncoding], encodedStringReference, @"urlEncodedStringUsingEncoding");
 }
 
+- (void)testQueryString
+{
+    NSDictionary *parameters = [NSDictionary dictionaryWithObjectsAndKeys:@"hello world", @"b", 
+                                [NSNumber numberWithInt:12], @"a",
+                                @"\u00e9t\u00e9&co", @"c d", nil];
+    GHAssertEqualStrings([NSString queryStringWithParameters:parameters usingEncoding:NSUTF8StringEncoding],
+                         @"a=12&b=hello%20world&c%20d=%C3%A9t%C3%A9%26co", @"Query string");
+    GHAssertEqualStrings([NSString queryStringWithParameters:[NSDictionary dictionary] usingEncoding:NSUTF8StringEncoding], @"", @"Empty");
+    GHAssertNil([NSString queryStringWithParameters:parameters usingEncoding:NSASCIIStringEncoding], @"Not representable");
+}
+
 @end
@@ -369,4 +369,23 @@
     GHAssertEquals(timeIntervalTahiti54, 26. * 60. * 60., @"Incorrect time interval");
 }
 
+- (void)testOffsetsForTimeInterval
+{
+    // Hourly over 2012, as well as outside the range covered by transition tables
+    NSMutableArray *timeIntervals = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 366 * 24; ++i) {
+        [timeIntervals addObject:[NSNumber numberWithDouble:[self.date1 timeIntervalSinceReferenceDate] + i * 60. * 60.]];
+    }
+    [timeIntervals addObject:[NSNumber numberWithDouble:-2000000000.]];
+    [timeIntervals addObject:[NSNumber numberWithDouble:4000000000.]];
+    
+    for (NSNumber *timeIntervalNumber in timeIntervals) {
+        NSTimeInterval timeInterval = [timeIntervalNumber doubleValue];
+        NSDate *date = [NSDate dateWithTimeIntervalSinceReferenceDate:timeInterval];
+        GHAssertEquals([self.timeZoneZurich secondsFromGMTForTimeInterval:timeInterval], [self.timeZoneZurich secondsFromGMTForDate:date], nil);
+        GHAssertEquals([self.timeZoneZurich daylightSavingTimeOffsetForTimeInterval:timeInterval], [self.timeZoneZurich daylightSavingTimeOffsetForDate:date], nil);
+        GHAssertEquals([self.timeZoneTahiti secondsFromGMTForTimeInterval:timeInterval], [self.timeZoneTahiti secondsFromGMTForDate:date], nil);
+    }
+}
+
 @end
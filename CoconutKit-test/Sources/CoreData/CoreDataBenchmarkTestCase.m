@@ -0,0 +1,275 @@
+//
+//  CoreDataBenchmarkTestCase.m
+//  CoconutKit-test
+//
+//  Created by Samuel Défago on 15.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "CoreDataBenchmarkTestCase.h"
+
+#import "BankAccount.h"
+#import "BenchmarkRunner.h"
+#import "ConcreteClassD.h"
+#import "ConcreteSubclassB.h"
+#import "Person.h"
+
+/**
+ * Throughput of the Core Data operations CoconutKit provides helpers for, measured for SQLite, binary and in-memory
+ * stores holding 1'000, 10'000 and 100'000 objects. Objects are inserted in units of 4 objects: A Person owning a 
+ * BankAccount (used to measure duplication, which deeply copies the account), and a ConcreteSubclassB with one 
+ * ConcreteClassD (used to measure validation, since their constraints are mostly defined in code). Each sample starts
+ * with an empty store, in which units are inserted, checked, saved, fetched again after the context has been reset,
+ * duplicated, and finally deleted and saved.
+ *
+ * Times per object are logged as CSV and compared with the baseline (see BenchmarkRunner)
+ */
+static NSString * const kCoreDataBenchmarkSuiteName = @"CoreDataBenchmark";
+static NSString * const kCoreDataBenchmarkModelFileName = @"CoconutKitTestData";
+static NSString * const kCoreDataBenchmarkStoreNames[] = {@"sqlite", @"binary", @"inMemory"};
+static const NSUInteger kCoreDataBenchmarkObjectCounts[] = {1000, 10000, 100000};
+static const NSUInteger kCoreDataBenchmarkObjectCountPerUnit = 4;
+static const NSUInteger kCoreDataBenchmarkSampleCount = 3;
+
+typedef enum {
+    CoreDataBenchmarkOperationEnumBegin = 0,
+    CoreDataBenchmarkOperationInsert = CoreDataBenchmarkOperationEnumBegin,
+    CoreDataBenchmarkOperationCheck,
+    CoreDataBenchmarkOperationSaveInsertions,
+    CoreDataBenchmarkOperationFetch,
+    CoreDataBenchmarkOperationDuplicate,
+    CoreDataBenchmarkOperationDeleteAllObjects,
+    CoreDataBenchmarkOperationSaveDeletions,
+    CoreDataBenchmarkOperationEnumEnd,
+    CoreDataBenchmarkOperationEnumSize = CoreDataBenchmarkOperationEnumEnd - CoreDataBenchmarkOperationEnumBegin
+} CoreDataBenchmarkOperation;
+
+static NSString * const kCoreDataBenchmarkOperationNames[] = {@"insert", @"check", @"saveInsertions", @"fetch", @"duplicate",
+    @"deleteAllObjects", @"saveDeletions"};
+
+@interface CoreDataBenchmarkTestCase ()
+
+- (NSString *)storeDirectoryPath;
+- (HLSModelManager *)modelManagerForStoreName:(NSString *)storeName;
+- (void)removeStoreFile;
+- (void)measureOperationsForStoreName:(NSString *)storeName
+                          objectCount:(NSUInteger)objectCount
+                            durations:(NSTimeInterval *)durations;
+
+@end
+
+@implementation CoreDataBenchmarkTestCase
+
+#pragma mark Tests
+
+- (void)testCoreDataBenchmarks
+{
+    if (! [BenchmarkRunner shouldRunBenchmarks]) {
+        return;
+    }
+    
+    BenchmarkRunner *runner = [[[BenchmarkRunner alloc] initWithSuiteName:kCoreDataBenchmarkSuiteName] autorelease];
+    
+    for (NSUInteger i = 0; i < sizeof(kCoreDataBenchmarkStoreNames) / sizeof(NSString *); ++i) {
+        NSString *storeName = kCoreDataBenchmarkStoreNames[i];
+        for (NSUInteger j = 0; j < sizeof(kCoreDataBenchmarkObjectCounts) / sizeof(NSUInteger); ++j) {
+            NSUInteger objectCount = kCoreDataBenchmarkObjectCounts[j];
+            
+            NSTimeInterval samples[CoreDataBenchmarkOperationEnumSize][kCoreDataBenchmarkSampleCount];
+            for (NSUInteger k = 0; k < kCoreDataBenchmarkSampleCount; ++k) {
+                NSTimeInterval durations[CoreDataBenchmarkOperationEnumSize];
+                [self measureOperationsForStoreName:storeName objectCount:objectCount durations:durations];
+                for (CoreDataBenchmarkOperation operation = CoreDataBenchmarkOperationEnumBegin; operation < CoreDataBenchmarkOperationEnumEnd; ++operation) {
+                    samples[operation][k] = durations[operation];
+                }
+            }
+            
+            for (CoreDataBenchmarkOperation operation = CoreDataBenchmarkOperationEnumBegin; operation < CoreDataBenchmarkOperationEnumEnd; ++operation) {
+                NSString *name = [NSString stringWithFormat:@"%@.%d.%@", storeName, objectCount, kCoreDataBenchmarkOperationNames[operation]];
+                [runner recordBenchmarkWithName:name samples:samples[operation] count:kCoreDataBenchmarkSampleCount];
+            }
+        }
+    }
+    
+    GHTestLog(@"Core Data benchmark results (times per object in microseconds):\n%@", [runner report]);
+    GHAssertTrue([runner updateBaselineIfNeeded], @"The baseline could not be saved");
+}
+
+#pragma mark Benchmark helpers
+
+- (NSString *)storeDirectoryPath
+{
+    return [NSTemporaryDirectory() stringByAppendingPathComponent:kCoreDataBenchmarkSuiteName];
+}
+
+- (HLSModelManager *)modelManagerForStoreName:(NSString *)storeName
+{
+    if ([storeName isEqualToString:@"inMemory"]) {
+        return [HLSModelManager inMemoryModelManagerWithModelFileName:kCoreDataBenchmarkModelFileName
+                                                             inBundle:nil
+                                                        configuration:nil
+                                                              options:nil];
+    }
+    
+    // File-based stores always start empty
+    NSString *storeDirectoryPath = [self storeDirectoryPath];
+    NSError *error = nil;
+    if (! [[NSFileManager defaultManager] createDirectoryAtPath:storeDirectoryPath withIntermediateDirectories:YES attributes:nil error:&error]) {
+        HLSLoggerError(@"Could not create the store directory. Reason: %@", error);
+        return nil;
+    }
+    [self removeStoreFile];
+    
+    if ([storeName isEqualToString:@"sqlite"]) {
+        return [HLSModelManager SQLiteManagerWithModelFileName:kCoreDataBenchmarkModelFileName
+                                                      inBundle:nil
+                                                 configuration:nil
+                                                storeDirectory:storeDirectoryPath
+                                                       options:HLSModelManagerLightweightMigrationOptions];
+    }
+    else if ([storeName isEqualToString:@"binary"]) {
+        return [HLSModelManager binaryModelManagerWithModelFileName:kCoreDataBenchmarkModelFileName
+                                                           inBundle:nil
+                                                      configuration:nil
+                                                     storeDirectory:storeDirectoryPath
+                                                            options:HLSModelManagerLightweightMigrationOptions];
+    }
+    else {
+        HLSLoggerError(@"Unknown store %@", storeName);
+        return nil;
+    }
+}
+
+- (void)removeStoreFile
+{
+    NSString *storeFilePath = [HLSModelManager storeFilePathForModelFileName:kCoreDataBenchmarkModelFileName
+                                                              storeDirectory:[self storeDirectoryPath]];
+    if (storeFilePath && [[NSFileManager defaultManager] fileExistsAtPath:storeFilePath]) {
+        NSError *error = nil;
+        if (! [[NSFileManager defaultManager] removeItemAtPath:storeFilePath error:&error]) {
+            HLSLoggerWarn(@"Could not remove store at path %@", storeFilePath);
+        }
+    }
+}
+
+- (void)measureOperationsForStoreName:(NSString *)storeName
+                          objectCount:(NSUInteger)objectCount
+                            durations:(NSTimeInterval *)durations
+{
+    NSUInteger unitCount = objectCount / kCoreDataBenchmarkObjectCountPerUnit;
+    
+    NSAutoreleasePool *cyclePool = [[NSAutoreleasePool alloc] init];
+    
+    HLSModelManager *modelManager = [self modelManagerForStoreName:storeName];
+    if (! modelManager) {
+        [cyclePool drain];
+        GHFail(@"The %@ store could not be created", storeName);
+    }
+    [HLSModelManager pushModelManager:modelManager];
+    
+    // Failed assertions raise exceptions. Always restore the model manager stack and remove the store. Since the
+    // exception is autoreleased in the cycle pool, it must be kept alive until it is raised again
+    NSException *failureException = nil;
+    @try {
+        // Objects autoreleased during an operation are released before the operation ends, so that the cost of 
+        // releasing them is included in the measurement
+        CFAbsoluteTime insertStartTime = CFAbsoluteTimeGetCurrent();
+        NSAutoreleasePool *insertPool = [[NSAutoreleasePool alloc] init];
+        for (NSUInteger i = 0; i < unitCount; ++i) {
+            Person *person = [Person insert];
+            person.firstName = @"Tony";
+            person.lastName = [NSString stringWithFormat:@"Slowprano %d", i];
+            
+            BankAccount *bankAccount = [BankAccount insert];
+            bankAccount.name = @"Clean account";
+            bankAccount.balanceValue = i;
+            bankAccount.owner = person;
+            
+            ConcreteSubclassB *bInstance = [ConcreteSubclassB insert];
+            bInstance.codeMandatoryNotEmptyStringA = @"Hello, World!";
+            bInstance.codeMandatoryNumberBValue = 7;
+            bInstance.modelMandatoryBoundedNumberBValue = 5;
+            bInstance.modelMandatoryCodeNotZeroNumberBValue = 1;
+            
+            ConcreteClassD *dInstance = [ConcreteClassD insert];
+            dInstance.noValidationStringD = @"Not locked";
+            bInstance.codeMandatoryConcreteClassesD = [NSSet setWithObject:dInstance];
+        }
+        [insertPool drain];
+        durations[CoreDataBenchmarkOperationInsert] = (CFAbsoluteTimeGetCurrent() - insertStartTime) / objectCount;
+        
+        NSArray *bInstances = [ConcreteSubclassB allObjects];
+        NSUInteger checkFailureCount = 0;
+        CFAbsoluteTime checkStartTime = CFAbsoluteTimeGetCurrent();
+        NSAutoreleasePool *checkPool = [[NSAutoreleasePool alloc] init];
+        for (ConcreteSubclassB *bInstance in bInstances) {
+            NSError *error = nil;
+            if (! [bInstance check:&error]) {
+                ++checkFailureCount;
+            }
+        }
+        [checkPool drain];
+        durations[CoreDataBenchmarkOperationCheck] = (CFAbsoluteTimeGetCurrent() - checkStartTime) / objectCount;
+        GHAssertEquals(checkFailureCount, 0U, @"All objects must be valid");
+        
+        CFAbsoluteTime saveInsertionsStartTime = CFAbsoluteTimeGetCurrent();
+        BOOL insertionsSaved = [HLSModelManager saveCurrentModelContext:NULL];
+        durations[CoreDataBenchmarkOperationSaveInsertions] = (CFAbsoluteTimeGetCurrent() - saveInsertionsStartTime) / objectCount;
+        GHAssertTrue(insertionsSaved, @"Insertions must have been saved");
+        
+        // Reset the context so that objects are really fetched from the store (faults are fired as well)
+        [[HLSModelManager currentModelContext] reset];
+        CFAbsoluteTime fetchStartTime = CFAbsoluteTimeGetCurrent();
+        NSAutoreleasePool *fetchPool = [[NSAutoreleasePool alloc] init];
+        for (Person *person in [Person allObjects]) {
+            [person firstName];
+        }
+        for (ConcreteSubclassB *bInstance in [ConcreteSubclassB allObjects]) {
+            [bInstance codeMandatoryNotEmptyStringA];
+        }
+        [fetchPool drain];
+        durations[CoreDataBenchmarkOperationFetch] = (CFAbsoluteTimeGetCurrent() - fetchStartTime) / objectCount;
+        
+        NSArray *persons = [Person allObjects];
+        CFAbsoluteTime duplicateStartTime = CFAbsoluteTimeGetCurrent();
+        NSAutoreleasePool *duplicatePool = [[NSAutoreleasePool alloc] init];
+        for (Person *person in persons) {
+            [person duplicate];
+        }
+        [duplicatePool drain];
+        durations[CoreDataBenchmarkOperationDuplicate] = (CFAbsoluteTimeGetCurrent() - duplicateStartTime) / objectCount;
+        [HLSModelManager rollbackCurrentModelContext];
+        
+        // Accounts and ConcreteClassD objects are deleted in cascade
+        CFAbsoluteTime deleteAllObjectsStartTime = CFAbsoluteTimeGetCurrent();
+        NSAutoreleasePool *deleteAllObjectsPool = [[NSAutoreleasePool alloc] init];
+        [Person deleteAllObjects];
+        [ConcreteSubclassB deleteAllObjects];
+        [deleteAllObjectsPool drain];
+        durations[CoreDataBenchmarkOperationDeleteAllObjects] = (CFAbsoluteTimeGetCurrent() - deleteAllObjectsStartTime) / objectCount;
+        
+        CFAbsoluteTime saveDeletionsStartTime = CFAbsoluteTimeGetCurrent();
+        BOOL deletionsSaved = [HLSModelManager saveCurrentModelContext:NULL];
+        durations[CoreDataBenchmarkOperationSaveDeletions] = (CFAbsoluteTimeGetCurrent() - saveDeletionsStartTime) / objectCount;
+        GHAssertTrue(deletionsSaved, @"Deletions must have been saved");
+        GHAssertEquals([[ConcreteClassD allObjects] count], 0U, @"All objects must have been deleted");
+    }
+    @catch (NSException *exception) {
+        failureException = [exception retain];
+    }
+    @finally {
+        [HLSModelManager popModelManager];
+        [cyclePool drain];
+        
+        // The model manager has been released with the pool, the store file can now be removed
+        if (! [storeName isEqualToString:@"inMemory"]) {
+            [self removeStoreFile];
+        }
+    }
+    
+    if (failureException) {
+        @throw [failureException autorelease];
+    }
+}
+
+@end
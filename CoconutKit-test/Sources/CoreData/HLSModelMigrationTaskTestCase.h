@@ -0,0 +1,14 @@
+//
+//  HLSModelMigrationTaskTestCase.h
+//  CoconutKit-test
+//
+//  Created by Samuel Défago on 15.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+@interface HLSModelMigrationTaskTestCase : GHTestCase {
+@private
+    
+}
+
+@end
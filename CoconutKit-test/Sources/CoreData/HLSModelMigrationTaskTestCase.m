@@ -0,0 +1,199 @@
+//
+//  HLSModelMigrationTaskTestCase.m
+//  CoconutKit-test
+//
+//  Created by Samuel Défago on 15.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSModelMigrationTaskTestCase.h"
+
+#import "BankAccount.h"
+#import "House.h"
+#import "Person.h"
+
+static NSString * const kModelFileName = @"CoconutKitTestData";
+
+@interface HLSModelMigrationTaskTestCase ()
+
+- (NSString *)sourceStoreDirectoryPath;
+- (NSString *)destinationStoreDirectoryPath;
+- (HLSModelManager *)seededModelManagerWithPersonCount:(NSUInteger)personCount;
+- (void)waitUntilTaskIsFinished:(HLSTask *)task;
+
+@end
+
+@implementation HLSModelMigrationTaskTestCase
+
+#pragma mark Test setup and tear down
+
+- (BOOL)shouldRunOnMainThread
+{
+    // Task status notifications are delivered through the run loop of the thread tasks are submitted from
+    return YES;
+}
+
+- (void)tearDown
+{
+    [super tearDown];
+    
+    [[NSFileManager defaultManager] removeItemAtPath:[self sourceStoreDirectoryPath] error:NULL];
+    [[NSFileManager defaultManager] removeItemAtPath:[self destinationStoreDirectoryPath] error:NULL];
+}
+
+#pragma mark Tests
+
+- (void)testMigration
+{
+    // Persons share houses in pairs, and each one owns two accounts
+    static const NSUInteger kPersonCount = 100;
+    HLSModelManager *sourceModelManager = [self seededModelManagerWithPersonCount:kPersonCount];
+    
+    // Small batches, so that objects and relationships are copied across several batches
+    NSString *destinationStoreFilePath = [[[self destinationStoreDirectoryPath] stringByAppendingPathComponent:kModelFileName] 
+                                          stringByAppendingPathExtension:@"sqlite"];
+    HLSModelMigrationTask *migrationTask = [[[HLSModelMigrationTask alloc] initWithModelManager:sourceModelManager
+                                                                                       storeURL:[NSURL fileURLWithPath:destinationStoreFilePath]
+                                                                                      storeType:NSSQLiteStoreType] autorelease];
+    migrationTask.batchSize = 7;
+    [self waitUntilTaskIsFinished:migrationTask];
+    GHAssertNil(migrationTask.error, @"No error expected");
+    GHAssertTrue(floateq(migrationTask.progress, 1.f), @"Complete progress");
+    
+    // The migrated store must be opened with the original model, without any migration
+    HLSModelManager *destinationModelManager = [HLSModelManager SQLiteManagerWithModelFileName:kModelFileName
+                                                                                      inBundle:nil
+                                                                                 configuration:nil
+                                                                                storeDirectory:[self destinationStoreDirectoryPath]
+                                                                                       options:nil];
+    GHAssertNotNil(destinationModelManager, @"The migrated store must be opened with the original model");
+    [HLSModelManager pushModelManager:destinationModelManager];
+    
+    NSArray *persons = [Person allObjects];
+    GHAssertEquals([persons count], kPersonCount, @"Persons");
+    GHAssertEquals([[BankAccount allObjects] count], 2 * kPersonCount, @"Accounts");
+    GHAssertEquals([[House allObjects] count], kPersonCount / 2, @"Houses");
+    
+    NSUInteger accountCount = 0;
+    NSUInteger houseCount = 0;
+    for (Person *person in persons) {
+        accountCount += [person.accounts count];
+        houseCount += [person.houses count];
+        for (BankAccount *bankAccount in person.accounts) {
+            GHAssertEquals(bankAccount.owner, person, @"Account owner");
+        }
+    }
+    GHAssertEquals(accountCount, 2 * kPersonCount, @"Person accounts");
+    GHAssertEquals(houseCount, kPersonCount, @"Person houses");
+    
+    for (House *house in [House allObjects]) {
+        GHAssertEquals([house.owners count], 2U, @"House owners");
+    }
+    
+    [HLSModelManager popModelManager];
+    [HLSModelManager popModelManager];
+}
+
+- (void)testCancel
+{
+    HLSModelManager *sourceModelManager = [self seededModelManagerWithPersonCount:2000];
+    
+    NSString *destinationStoreFilePath = [[[self destinationStoreDirectoryPath] stringByAppendingPathComponent:kModelFileName] 
+                                          stringByAppendingPathExtension:@"sqlite"];
+    HLSModelMigrationTask *migrationTask = [[[HLSModelMigrationTask alloc] initWithModelManager:sourceModelManager
+                                                                                       storeURL:[NSURL fileURLWithPath:destinationStoreFilePath]
+                                                                                      storeType:NSSQLiteStoreType] autorelease];
+    migrationTask.batchSize = 10;
+    
+    HLSTaskManager *taskManager = [[[HLSTaskManager alloc] init] autorelease];
+    [taskManager submitTask:migrationTask];
+    
+    // Cancel once the destination store has been partially filled
+    NSDate *timeoutDate = [NSDate dateWithTimeIntervalSinceNow:30.];
+    while (! migrationTask.finished && floateq(migrationTask.progress, 0.f) && [timeoutDate timeIntervalSinceNow] > 0.) {
+        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    }
+    GHAssertFalse(migrationTask.finished, @"The migration must not be finished yet");
+    [taskManager cancelTask:migrationTask];
+    
+    while (! migrationTask.finished && [timeoutDate timeIntervalSinceNow] > 0.) {
+        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    }
+    GHAssertTrue(migrationTask.cancelled, @"The migration must have been cancelled");
+    
+    // The operation might still be cleaning up when the task is reported as cancelled
+    timeoutDate = [NSDate dateWithTimeIntervalSinceNow:10.];
+    while ([[NSFileManager defaultManager] fileExistsAtPath:destinationStoreFilePath] && [timeoutDate timeIntervalSinceNow] > 0.) {
+        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    }
+    GHAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:destinationStoreFilePath], @"The partial store must have been removed");
+    
+    [HLSModelManager popModelManager];
+}
+
+#pragma mark Helpers
+
+- (NSString *)sourceStoreDirectoryPath
+{
+    return [NSTemporaryDirectory() stringByAppendingPathComponent:@"HLSModelMigrationTaskTestCase-source"];
+}
+
+- (NSString *)destinationStoreDirectoryPath
+{
+    return [NSTemporaryDirectory() stringByAppendingPathComponent:@"HLSModelMigrationTaskTestCase-destination"];
+}
+
+// The model manager is pushed, and must be popped by the caller
+- (HLSModelManager *)seededModelManagerWithPersonCount:(NSUInteger)personCount
+{
+    [[NSFileManager defaultManager] removeItemAtPath:[self sourceStoreDirectoryPath] error:NULL];
+    [[NSFileManager defaultManager] removeItemAtPath:[self destinationStoreDirectoryPath] error:NULL];
+    [[NSFileManager defaultManager] createDirectoryAtPath:[self sourceStoreDirectoryPath] withIntermediateDirectories:YES attributes:nil error:NULL];
+    [[NSFileManager defaultManager] createDirectoryAtPath:[self destinationStoreDirectoryPath] withIntermediateDirectories:YES attributes:nil error:NULL];
+    
+    HLSModelManager *modelManager = [HLSModelManager SQLiteManagerWithModelFileName:kModelFileName
+                                                                           inBundle:nil
+                                                                      configuration:nil
+                                                                     storeDirectory:[self sourceStoreDirectoryPath]
+                                                                            options:HLSModelManagerLightweightMigrationOptions];
+    [HLSModelManager pushModelManager:modelManager];
+    
+    House *house = nil;
+    for (NSUInteger i = 0; i < personCount; ++i) {
+        Person *person = [Person insert];
+        person.firstName = @"Tony";
+        person.lastName = [NSString stringWithFormat:@"Slowprano %d", i];
+        
+        for (NSUInteger j = 0; j < 2; ++j) {
+            BankAccount *bankAccount = [BankAccount insert];
+            bankAccount.name = [NSString stringWithFormat:@"Account %d", j];
+            bankAccount.balanceValue = i;
+            bankAccount.owner = person;
+        }
+        
+        if (i % 2 == 0) {
+            house = [House insert];
+            house.name = [NSString stringWithFormat:@"House %d", i / 2];
+        }
+        person.houses = [NSSet setWithObject:house];
+    }
+    
+    NSError *error = nil;
+    GHAssertTrue([HLSModelManager saveCurrentModelContext:&error], @"The store could not be seeded; reason: %@", error);
+    
+    return modelManager;
+}
+
+- (void)waitUntilTaskIsFinished:(HLSTask *)task
+{
+    HLSTaskManager *taskManager = [[[HLSTaskManager alloc] init] autorelease];
+    [taskManager submitTask:task];
+    
+    NSDate *timeoutDate = [NSDate dateWithTimeIntervalSinceNow:30.];
+    while (! task.finished && [timeoutDate timeIntervalSinceNow] > 0.) {
+        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    }
+    GHAssertTrue(task.finished, @"The task must have ended");
+}
+
+@end
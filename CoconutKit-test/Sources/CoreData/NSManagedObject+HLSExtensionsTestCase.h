@@ -13,6 +13,7 @@
 @private
     Person *m_person1;
     Person *m_person2;
+    NSDictionary *m_changeSets;
 }
 
 @end
@@ -14,6 +14,9 @@
 
 @property (nonatomic, retain) Person *person1;
 @property (nonatomic, retain) Person *person2;
+@property (nonatomic, retain) NSDictionary *changeSets;
+
+- (void)modelManagerDidChange:(NSNotification *)notification;
 
 @end
 
@@ -25,6 +28,7 @@
 {
     self.person1 = nil;
     self.person2 = nil;
+    self.changeSets = nil;
     
     [super dealloc];
 }
@@ -35,6 +39,8 @@
 
 @synthesize person2 = m_person2;
 
+@synthesize changeSets = m_changeSets;
+
 #pragma mark Test setup and tear down
 
 - (void)setUpClass
@@ -110,4 +116,151 @@
     GHAssertTrue([HLSModelManager saveCurrentModelContext:NULL], @"Invalid objects");
 }
 
+- (void)testChangeSets
+{
+    HLSModelManager *modelManager = [HLSModelManager currentModelManager];
+    modelManager.publishingChangeSets = YES;
+    [[NSNotificationCenter defaultCenter] addObserver:self
+                                             selector:@selector(modelManagerDidChange:)
+                                                 name:HLSModelManagerDidChangeNotification
+                                               object:modelManager];
+    
+    Person *anna = [Person insert];
+    anna.firstName = @"Anna";
+    anna.lastName = @"Bluesprano";
+    
+    Person *bella = [Person insert];
+    bella.firstName = @"Bella";
+    bella.lastName = @"Bluesprano";
+    
+    Person *carla = [Person insert];
+    carla.firstName = @"Carla";
+    carla.lastName = @"Bluesprano";
+    
+    GHAssertTrue([HLSModelManager saveCurrentModelContext:NULL], @"Failed to insert test data");
+    [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.1]];
+    GHAssertEquals([[[self.changeSets objectForKey:@"Person"] insertedObjectIDs] count], (NSUInteger)3, @"Inserted objects");
+    
+    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"lastName == %@", @"Bluesprano"];
+    NSArray *sortDescriptors = [NSArray arrayWithObject:[NSSortDescriptor sortDescriptorWithKey:@"firstName" ascending:YES]];
+    NSArray *objects = [Person filteredObjectsUsingPredicate:predicate sortedUsingDescriptors:sortDescriptors];
+    
+    // Anna -> Dora moves to the end, Bella is deleted, and Alma is inserted at the beginning. Saves made in the same 
+    // run loop iteration are coalesced
+    anna.firstName = @"Dora";
+    GHAssertTrue([HLSModelManager saveCurrentModelContext:NULL], @"Failed to update test data");
+    
+    [HLSModelManager deleteObjectFromCurrentModelContext:bella];
+    Person *alma = [Person insert];
+    alma.firstName = @"Alma";
+    alma.lastName = @"Bluesprano";
+    GHAssertTrue([HLSModelManager saveCurrentModelContext:NULL], @"Failed to update test data");
+    
+    self.changeSets = nil;
+    [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.1]];
+    
+    HLSModelChangeSet *changeSet = [self.changeSets objectForKey:@"Person"];
+    GHAssertNotNil(changeSet, @"Missing change set");
+    GHAssertEquals([changeSet.insertedObjectIDs count], (NSUInteger)1, @"Inserted objects");
+    GHAssertEquals([changeSet.updatedObjectIDs count], (NSUInteger)1, @"Updated objects");
+    GHAssertEquals([changeSet.deletedObjectIDs count], (NSUInteger)1, @"Deleted objects");
+    
+    HLSModelListChanges *listChanges = [changeSet listChangesForObjects:objects predicate:predicate sortDescriptors:sortDescriptors];
+    NSArray *expectedObjects = [NSArray arrayWithObjects:alma, carla, anna, nil];
+    GHAssertTrue([listChanges.objects isEqualToArray:expectedObjects], @"Objects");
+    GHAssertTrue([listChanges.deletedIndexes isEqualToIndexSet:[NSIndexSet indexSetWithIndex:1]], @"Deleted indexes");
+    GHAssertTrue([listChanges.insertedIndexes isEqualToIndexSet:[NSIndexSet indexSetWithIndex:0]], @"Inserted indexes");
+    GHAssertEquals([listChanges.movedFromIndexes count], (NSUInteger)1, @"A single move is required");
+    GHAssertEquals([listChanges.updatedIndexes count] + [listChanges.movedFromIndexes count], (NSUInteger)2, @"Remaining objects");
+    
+    [[NSNotificationCenter defaultCenter] removeObserver:self name:HLSModelManagerDidChangeNotification object:modelManager];
+    modelManager.publishingChangeSets = NO;
+    
+    [HLSModelManager deleteObjectFromCurrentModelContext:anna];
+    [HLSModelManager deleteObjectFromCurrentModelContext:carla];
+    [HLSModelManager deleteObjectFromCurrentModelContext:alma];
+    GHAssertTrue([HLSModelManager saveCurrentModelContext:NULL], @"Failed to remove test data");
+}
+
+- (void)testFetchTemplates
+{
+    [Person registerFetchTemplateWithName:@"PeopleWithLastName"
+                          predicateFormat:@"lastName == $lastName"
+                   sortedUsingDescriptors:[NSArray arrayWithObject:[NSSortDescriptor sortDescriptorWithKey:@"firstName" ascending:YES]]];
+    
+    NSArray *people = [Person objectsFromTemplateWithName:@"PeopleWithLastName"
+                                    substitutionVariables:[NSDictionary dictionaryWithObject:@"Slowprano" forKey:@"lastName"]];
+    NSArray *expectedPeople = [NSArray arrayWithObjects:self.person2, self.person1, nil];
+    GHAssertTrue([people isEqualToArray:expectedPeople], @"Incorrect people");
+    
+    NSArray *otherPeople = [Person objectsFromTemplateWithName:@"PeopleWithLastName"
+                                         substitutionVariables:[NSDictionary dictionaryWithObject:@"Nobody" forKey:@"lastName"]];
+    GHAssertEquals([otherPeople count], (NSUInteger)0, @"Incorrect people");
+    
+    GHAssertNil([Person fetchRequestFromTemplateWithName:@"Unknown" substitutionVariables:nil], @"Unknown template");
+}
+
+- (void)testInstrumentation
+{
+    [HLSModelManager resetInstrumentation];
+    [HLSModelManager setInstrumentationEnabled:YES];
+    
+    [Person registerFetchTemplateWithName:@"PeopleWithFirstName"
+                          predicateFormat:@"firstName == $firstName"
+                   sortedUsingDescriptors:nil];
+    [Person objectsFromTemplateWithName:@"PeopleWithFirstName"
+                  substitutionVariables:[NSDictionary dictionaryWithObject:@"Tony" forKey:@"firstName"]];
+    NSUInteger personCount = [[Person allObjects] count];
+    
+    self.person1.firstName = @"Anthony";
+    [HLSModelManager saveCurrentModelContext:NULL];
+    
+    [HLSModelManager setInstrumentationEnabled:NO];
+    [Person allObjects];
+    
+    NSDictionary *personMetrics = [[HLSModelManager instrumentationSnapshot] objectForKey:@"Person"];
+    GHAssertEquals([[personMetrics objectForKey:HLSModelMetricsFetchCountKey] unsignedIntegerValue], (NSUInteger)2, @"Incorrect fetch count");
+    GHAssertEquals([[personMetrics objectForKey:HLSModelMetricsRowCountKey] unsignedIntegerValue], personCount + 1, @"Incorrect row count");
+    GHAssertEquals([[personMetrics objectForKey:HLSModelMetricsSaveCountKey] unsignedIntegerValue], (NSUInteger)1, @"Incorrect save count");
+    GHAssertEquals([[personMetrics objectForKey:HLSModelMetricsChangedObjectCountKey] unsignedIntegerValue], (NSUInteger)1, @"Incorrect changed object count");
+    
+    NSDictionary *templateMetrics = [[personMetrics objectForKey:HLSModelMetricsTemplatesKey] objectForKey:@"PeopleWithFirstName"];
+    GHAssertEquals([[templateMetrics objectForKey:HLSModelMetricsFetchCountKey] unsignedIntegerValue], (NSUInteger)1, @"Incorrect template fetch count");
+    
+    [HLSModelManager resetInstrumentation];
+    GHAssertEquals([[HLSModelManager instrumentationSnapshot] count], (NSUInteger)0, @"Metrics must have been discarded");
+    
+    self.person1.firstName = @"Tony";
+    [HLSModelManager saveCurrentModelContext:NULL];
+}
+
+- (void)testReadOnlyDuplicate
+{
+    HLSModelManager *readOnlyModelManager = [[HLSModelManager currentModelManager] readOnlyDuplicate];
+    GHAssertTrue(readOnlyModelManager.readOnly, @"Read-only duplicate expected");
+    GHAssertEquals(readOnlyModelManager.persistentStoreCoordinator, [HLSModelManager currentModelManager].persistentStoreCoordinator,
+                   @"The coordinator must be shared");
+    
+    [HLSModelManager pushModelManager:readOnlyModelManager];
+    
+    NSArray *people = [Person filteredObjectsUsingPredicate:[NSPredicate predicateWithFormat:@"lastName == %@", @"Slowprano"]
+                                     sortedUsingDescriptor:nil];
+    GHAssertEquals([people count], (NSUInteger)2, @"Saved objects must be visible");
+    
+    Person *person = [Person insert];
+    person.firstName = @"Paulie";
+    person.lastName = @"Walnuts";
+    GHAssertFalse([HLSModelManager saveCurrentModelContext:NULL], @"Read-only contexts cannot be saved");
+    [HLSModelManager rollbackCurrentModelContext];
+    
+    [HLSModelManager popModelManager];
+}
+
+#pragma mark Notification callbacks
+
+- (void)modelManagerDidChange:(NSNotification *)notification
+{
+    self.changeSets = [[notification userInfo] objectForKey:HLSModelManagerChangeSetsKey];
+}
+
 @end
@@ -280,6 +280,68 @@
     [HLSModelManager rollbackCurrentModelContext];
 }
 
+- (void)testUpdate
+{
+    ConcreteClassD *dInstance = [ConcreteClassD insert];
+    dInstance.noValidationStringD = @"D";
+    
+    // Save a valid ConcreteSubclassC instance
+    ConcreteSubclassC *cInstance = [ConcreteSubclassC insert];
+    cInstance.noValidationStringA = @"Consistency check";
+    cInstance.codeMandatoryNotEmptyStringA = @"Mandatory A";
+    cInstance.codeMandatoryNumberB = [NSNumber numberWithInteger:0];
+    cInstance.modelMandatoryBoundedNumberB = [NSNumber numberWithInteger:6];
+    cInstance.modelMandatoryCodeNotZeroNumberB = [NSNumber numberWithInteger:3];
+    cInstance.noValidationNumberB = [NSNumber numberWithInteger:-12];
+    cInstance.codeMandatoryStringC = @"Mandatory C";
+    cInstance.modelMandatoryBoundedPatternStringC = @"Hello, World!";
+    cInstance.noValidationNumberC = [NSNumber numberWithInteger:1012];
+    cInstance.codeMandatoryConcreteClassesD = [NSSet setWithObject:dInstance];
+    
+    NSError *error1 = nil;
+    GHAssertTrue([HLSModelManager saveCurrentModelContext:&error1], @"Incorrect result when saving");
+    GHAssertNil(error1, @"Error incorrectly returned");
+    
+    // Changed field validated in code
+    cInstance.modelMandatoryCodeNotZeroNumberB = [NSNumber numberWithInteger:0];
+    NSError *error2 = nil;
+    GHAssertFalse([HLSModelManager saveCurrentModelContext:&error2], @"Incorrect result when saving");
+    GHAssertTrue([error2 hasCode:TestValidationIncorrectValueError withinDomain:TestValidationErrorDomain], @"Incorrect error domain and code");
+    [HLSModelManager rollbackCurrentModelContext];
+    
+    // Changed field validated in the xcdatamodel
+    cInstance.modelMandatoryBoundedNumberB = [NSNumber numberWithInteger:11];
+    NSError *error3 = nil;
+    GHAssertFalse([HLSModelManager saveCurrentModelContext:&error3], @"Incorrect result when saving");
+    GHAssertTrue([error3 hasCode:NSValidationNumberTooLargeError withinDomain:NSCocoaErrorDomain], @"Incorrect error domain and code");
+    [HLSModelManager rollbackCurrentModelContext];
+    
+    // Changed field a consistency check declares it depends on (ConcreteSubclassC)
+    cInstance.noValidationNumberC = nil;
+    NSError *error4 = nil;
+    GHAssertFalse([HLSModelManager saveCurrentModelContext:&error4], @"Incorrect result when saving");
+    GHAssertTrue([error4 hasCode:TestValidationInconsistencyError withinDomain:TestValidationErrorDomain], @"Incorrect error domain and code");
+    [HLSModelManager rollbackCurrentModelContext];
+    
+    // Changed field checked by a consistency check which does not declare its dependencies (ConcreteSubclassB)
+    cInstance.noValidationNumberB = nil;
+    NSError *error5 = nil;
+    GHAssertFalse([HLSModelManager saveCurrentModelContext:&error5], @"Incorrect result when saving");
+    GHAssertTrue([error5 hasCode:TestValidationInconsistencyError withinDomain:TestValidationErrorDomain], @"Incorrect error domain and code");
+    [HLSModelManager rollbackCurrentModelContext];
+    
+    // Valid change
+    cInstance.noValidationNumberC = [NSNumber numberWithInteger:2012];
+    NSError *error6 = nil;
+    GHAssertTrue([HLSModelManager saveCurrentModelContext:&error6], @"Incorrect result when saving");
+    GHAssertNil(error6, @"Error incorrectly returned");
+    
+    // Cleanup
+    [HLSModelManager deleteObjectFromCurrentModelContext:cInstance];
+    [HLSModelManager deleteObjectFromCurrentModelContext:dInstance];
+    GHAssertTrue([HLSModelManager saveCurrentModelContext:NULL], @"Incorrect result when saving");
+}
+
 - (void)testDelete
 {    
     [HLSModelManager deleteObjectFromCurrentModelContext:self.lockedDInstance];
@@ -0,0 +1,89 @@
+//
+//  BenchmarkRunner.h
+//  CoconutKit-test
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+/**
+ * Run microbenchmarks with warm-up and repeated sampling, and compare their results with a baseline.
+ *
+ * A benchmark is a method without parameters performing a single unit of work. It is first called a number of times
+ * to warm up caches, then timed over several samples of a fixed number of iterations each. The time per call is
+ * reported for each sample, and the minimum, median, mean and standard deviation are computed over all samples.
+ *
+ * The median time per call of each benchmark is compared with the one stored in the baseline file of the suite
+ * (a plist saved in the Documents directory and named after the suite). Once all benchmarks of a suite have been
+ * run, call -updateBaselineIfNeeded to save the results as baseline if none exists yet, or if the 
+ * HLSBenchmarkUpdateBaseline environment variable is set (e.g. after a deliberate performance change). Only results
+ * measured on a device are meaningful.
+ *
+ * Designated initializer: -initWithSuiteName:
+ */
+@interface BenchmarkRunner : NSObject {
+@private
+    NSString *m_suiteName;
+    NSUInteger m_warmUpIterationCount;
+    NSUInteger m_sampleCount;
+    NSUInteger m_iterationCount;
+    NSDictionary *m_baseline;
+    NSMutableDictionary *m_results;
+    NSMutableArray *m_reportLines;
+}
+
+/**
+ * Return YES iff benchmarks must be run. Benchmarks take long and are therefore only run if the HLSBenchmarkRun
+ * environment variable is set. Otherwise a message explaining how to run them is logged, and benchmark test methods 
+ * should return immediately
+ */
++ (BOOL)shouldRunBenchmarks;
+
+/**
+ * Create a runner for a benchmark suite
+ */
+- (id)initWithSuiteName:(NSString *)suiteName;
+
+/**
+ * Number of warm-up calls (default is 100), number of samples (default is 10) and number of calls per sample (default
+ * is 1000)
+ */
+@property (nonatomic, assign) NSUInteger warmUpIterationCount;
+@property (nonatomic, assign) NSUInteger sampleCount;
+@property (nonatomic, assign) NSUInteger iterationCount;
+
+/**
+ * The baseline loaded when the runner was created (median times per call in seconds, by benchmark name), nil if none
+ */
+@property (nonatomic, readonly, retain) NSDictionary *baseline;
+
+/**
+ * Run the benchmark implemented by the method of target with the given selector (which must not take any parameter).
+ * Return the median time per call in seconds
+ */
+- (NSTimeInterval)runBenchmarkWithName:(NSString *)name target:(id)target selector:(SEL)selector;
+
+/**
+ * Record the results of a benchmark timed by the caller, e.g. when each sample requires some setup which must not
+ * be measured. Samples are times per unit of work in seconds, and are compared with the baseline as for benchmarks
+ * run by the runner itself. Return the median time per unit of work in seconds
+ */
+- (NSTimeInterval)recordBenchmarkWithName:(NSString *)name samples:(const NSTimeInterval *)samples count:(NSUInteger)count;
+
+/**
+ * The report of all benchmarks run so far, as CSV (one line per benchmark, times in microseconds)
+ */
+- (NSString *)report;
+
+/**
+ * Save the results of all benchmarks run so far as baseline for the suite. Return YES iff successful
+ */
+- (BOOL)saveResultsAsBaseline;
+
+/**
+ * Save the results as baseline if no baseline exists or if the HLSBenchmarkUpdateBaseline environment variable is
+ * set, otherwise do nothing. Return NO iff the baseline had to be saved but could not
+ */
+- (BOOL)updateBaselineIfNeeded;
+
+@end
@@ -0,0 +1,218 @@
+//
+//  BenchmarkRunner.m
+//  CoconutKit-test
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "BenchmarkRunner.h"
+
+#import <mach/mach_time.h>
+
+// Function declarations
+static NSTimeInterval timeIntervalFromMachTime(uint64_t machTime);
+static int compareTimeIntervals(const void *timeInterval1, const void *timeInterval2);
+
+@interface BenchmarkRunner ()
+
+@property (nonatomic, retain) NSString *suiteName;
+@property (nonatomic, retain) NSDictionary *baseline;
+@property (nonatomic, retain) NSMutableDictionary *results;
+@property (nonatomic, retain) NSMutableArray *reportLines;
+
+- (NSString *)baselineFilePath;
+
+@end
+
+@implementation BenchmarkRunner
+
+#pragma mark Class methods
+
++ (BOOL)shouldRunBenchmarks
+{
+    if (! getenv("HLSBenchmarkRun")) {
+        NSLog(@"Benchmarks skipped. Set the HLSBenchmarkRun environment variable to run them");
+        return NO;
+    }
+    return YES;
+}
+
+#pragma mark Object creation and destruction
+
+- (id)initWithSuiteName:(NSString *)suiteName
+{
+    if ((self = [super init])) {
+        self.suiteName = suiteName;
+        self.warmUpIterationCount = 100;
+        self.sampleCount = 10;
+        self.iterationCount = 1000;
+        self.baseline = [NSDictionary dictionaryWithContentsOfFile:[self baselineFilePath]];
+        self.results = [NSMutableDictionary dictionary];
+        self.reportLines = [NSMutableArray arrayWithObject:@"benchmark,min,median,mean,stddev,baseline,ratio"];
+    }
+    return self;
+}
+
+- (id)init
+{
+    HLSForbiddenInheritedMethod();
+    return nil;
+}
+
+- (void)dealloc
+{
+    self.suiteName = nil;
+    self.baseline = nil;
+    self.results = nil;
+    self.reportLines = nil;
+    
+    [super dealloc];
+}
+
+#pragma mark Accessors and mutators
+
+@synthesize suiteName = m_suiteName;
+
+@synthesize warmUpIterationCount = m_warmUpIterationCount;
+
+@synthesize sampleCount = m_sampleCount;
+
+@synthesize iterationCount = m_iterationCount;
+
+@synthesize baseline = m_baseline;
+
+@synthesize results = m_results;
+
+@synthesize reportLines = m_reportLines;
+
+- (NSString *)baselineFilePath
+{
+    NSString *documentsDirectoryPath = [NSSearchPathForDirectoriesInDomains(NSDocumentDirectory, NSUserDomainMask, YES) objectAtIndex:0];
+    NSString *fileName = [NSString stringWithFormat:@"%@Baseline.plist", self.suiteName];
+    return [documentsDirectoryPath stringByAppendingPathComponent:fileName];
+}
+
+#pragma mark Running benchmarks
+
+- (NSTimeInterval)runBenchmarkWithName:(NSString *)name target:(id)target selector:(SEL)selector
+{
+    NSAssert(self.sampleCount != 0 && self.iterationCount != 0, @"At least one sample of one iteration is required");
+    
+    // Call the method directly to keep the measurement overhead as low as possible
+    void (*benchmarkImp)(id, SEL) = (void (*)(id, SEL))[target methodForSelector:selector];
+    
+    for (NSUInteger i = 0; i < self.warmUpIterationCount; ++i) {
+        NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+        (*benchmarkImp)(target, selector);
+        [pool drain];
+    }
+    
+    // Objects autoreleased by the benchmark are released at the end of each sample, so that the cost of releasing 
+    // them is included in the measurement
+    NSTimeInterval *samples = malloc(self.sampleCount * sizeof(NSTimeInterval));
+    for (NSUInteger i = 0; i < self.sampleCount; ++i) {
+        uint64_t startTime = mach_absolute_time();
+        NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+        for (NSUInteger j = 0; j < self.iterationCount; ++j) {
+            (*benchmarkImp)(target, selector);
+        }
+        [pool drain];
+        samples[i] = timeIntervalFromMachTime(mach_absolute_time() - startTime) / self.iterationCount;
+    }
+    
+    NSTimeInterval median = [self recordBenchmarkWithName:name samples:samples count:self.sampleCount];
+    free(samples);
+    return median;
+}
+
+- (NSTimeInterval)recordBenchmarkWithName:(NSString *)name samples:(const NSTimeInterval *)samples count:(NSUInteger)count
+{
+    NSAssert(count != 0, @"At least one sample is required");
+    
+    // Statistics
+    NSTimeInterval *sortedSamples = malloc(count * sizeof(NSTimeInterval));
+    memcpy(sortedSamples, samples, count * sizeof(NSTimeInterval));
+    qsort(sortedSamples, count, sizeof(NSTimeInterval), compareTimeIntervals);
+    NSTimeInterval median = (count % 2 == 1) ? sortedSamples[count / 2]
+        : (sortedSamples[count / 2 - 1] + sortedSamples[count / 2]) / 2.;
+    NSTimeInterval mean = 0.;
+    for (NSUInteger i = 0; i < count; ++i) {
+        mean += sortedSamples[i];
+    }
+    mean /= count;
+    NSTimeInterval variance = 0.;
+    for (NSUInteger i = 0; i < count; ++i) {
+        variance += (sortedSamples[i] - mean) * (sortedSamples[i] - mean);
+    }
+    variance /= count;
+    NSTimeInterval minimum = sortedSamples[0];
+    free(sortedSamples);
+    
+    [self.results setObject:[NSNumber numberWithDouble:median] forKey:name];
+    
+    NSNumber *baselineNumber = [self.baseline objectForKey:name];
+    NSString *baselineString = baselineNumber ? [NSString stringWithFormat:@"%.3f", [baselineNumber doubleValue] * 1e6] : @"";
+    NSString *ratioString = baselineNumber ? [NSString stringWithFormat:@"%.2f", median / [baselineNumber doubleValue]] : @"";
+    [self.reportLines addObject:[NSString stringWithFormat:@"%@,%.3f,%.3f,%.3f,%.3f,%@,%@", 
+                                 name,
+                                 minimum * 1e6,
+                                 median * 1e6,
+                                 mean * 1e6,
+                                 sqrt(variance) * 1e6,
+                                 baselineString,
+                                 ratioString]];
+    
+    return median;
+}
+
+- (NSString *)report
+{
+    return [self.reportLines componentsJoinedByString:@"\n"];
+}
+
+- (BOOL)saveResultsAsBaseline
+{
+    return [self.results writeToFile:[self baselineFilePath] atomically:YES];
+}
+
+- (BOOL)updateBaselineIfNeeded
+{
+    // The first run creates the baseline
+    if (self.baseline && ! getenv("HLSBenchmarkUpdateBaseline")) {
+        return YES;
+    }
+    return [self saveResultsAsBaseline];
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; suiteName: %@; warmUpIterationCount: %d; sampleCount: %d; iterationCount: %d>",
+            [self class],
+            self,
+            self.suiteName,
+            self.warmUpIterationCount,
+            self.sampleCount,
+            self.iterationCount];
+}
+
+@end
+
+#pragma mark Static functions
+
+static NSTimeInterval timeIntervalFromMachTime(uint64_t machTime)
+{
+    static mach_timebase_info_data_t s_timebaseInfo;
+    if (s_timebaseInfo.denom == 0) {
+        mach_timebase_info(&s_timebaseInfo);
+    }
+    return (machTime * s_timebaseInfo.numer / s_timebaseInfo.denom) / 1e9;
+}
+
+static int compareTimeIntervals(const void *timeInterval1, const void *timeInterval2)
+{
+    NSTimeInterval difference = *(const NSTimeInterval *)timeInterval1 - *(const NSTimeInterval *)timeInterval2;
+    return (difference > 0.) - (difference < 0.);
+}
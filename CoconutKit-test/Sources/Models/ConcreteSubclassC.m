@@ -23,6 +23,11 @@
 
 #pragma mark Global validations
 
++ (NSSet *)keysAffectingConsistency
+{
+    return [NSSet setWithObjects:@"noValidationStringA", @"noValidationNumberC", nil];
+}
+
 - (BOOL)checkForConsistency:(NSError **)pError
 {
     if ([self.noValidationStringA isFilled] && ! self.noValidationNumberC) {
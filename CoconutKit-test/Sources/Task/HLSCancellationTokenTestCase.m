@@ -0,0 +1,198 @@
+//
+//  HLSCancellationTokenTestCase.m
+//  CoconutKit-test
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSCancellationTokenTestCase.h"
+
+#include <libkern/OSAtomic.h>
+
+static volatile int32_t s_blockedTaskOperationCount = 0;
+static volatile int32_t s_interruptedTaskOperationCount = 0;
+
+@interface CancellationCounter : NSObject {
+@private
+    volatile int32_t _count;
+}
+
+- (void)increment;
+
+@property (nonatomic, readonly, assign) int32_t count;
+
+@end
+
+@interface BlockingTask : HLSTask
+
+@end
+
+@interface BlockingTaskOperation : HLSTaskOperation {
+@private
+    dispatch_semaphore_t _semaphore;
+}
+
+- (void)unblock;
+
+@end
+
+@implementation HLSCancellationTokenTestCase
+
+#pragma mark Test setup and tear down
+
+- (BOOL)shouldRunOnMainThread
+{
+    // Task status notifications are delivered through the run loop of the thread tasks are submitted from
+    return YES;
+}
+
+#pragma mark Tests
+
+- (void)testCancelAfterRegistration
+{
+    HLSCancellationToken *token = [[[HLSCancellationToken alloc] init] autorelease];
+    
+    CancellationCounter *actionCounter = [[[CancellationCounter alloc] init] autorelease];
+    [token addCancellationAction:@selector(increment) onTarget:actionCounter];
+    
+    CancellationCounter *invocationCounter = [[[CancellationCounter alloc] init] autorelease];
+    NSInvocation *invocation = [NSInvocation invocationWithMethodSignature:[invocationCounter methodSignatureForSelector:@selector(increment)]];
+    invocation.target = invocationCounter;
+    invocation.selector = @selector(increment);
+    [token addInvocation:invocation];
+    
+    HLSCancellationToken *childToken = [[[HLSCancellationToken alloc] init] autorelease];
+    CancellationCounter *childActionCounter = [[[CancellationCounter alloc] init] autorelease];
+    [childToken addCancellationAction:@selector(increment) onTarget:childActionCounter];
+    [token addChildToken:childToken];
+    
+    GHAssertEquals(actionCounter.count, 0, @"Nothing must be performed before cancellation");
+    GHAssertEquals(invocationCounter.count, 0, @"Nothing must be performed before cancellation");
+    GHAssertFalse(childToken.cancelled, @"Child tokens must not be cancelled before their parent");
+    
+    [token cancel];
+    GHAssertTrue(token.cancelled, @"The token must be cancelled");
+    GHAssertEquals(actionCounter.count, 1, @"The action must have been performed");
+    GHAssertEquals(invocationCounter.count, 1, @"The invocation must have been performed");
+    GHAssertTrue(childToken.cancelled, @"Child tokens must be cancelled with their parent");
+    GHAssertEquals(childActionCounter.count, 1, @"The action of the child token must have been performed");
+    
+    // Cancelling again does nothing
+    [token cancel];
+    GHAssertEquals(actionCounter.count, 1, @"Actions must only be performed once");
+    GHAssertEquals(invocationCounter.count, 1, @"Invocations must only be performed once");
+    GHAssertEquals(childActionCounter.count, 1, @"Actions of child tokens must only be performed once");
+}
+
+- (void)testCancelBeforeRegistration
+{
+    HLSCancellationToken *token = [[[HLSCancellationToken alloc] init] autorelease];
+    [token cancel];
+    
+    // Actions registered after cancellation are performed immediately
+    CancellationCounter *actionCounter = [[[CancellationCounter alloc] init] autorelease];
+    [token addCancellationAction:@selector(increment) onTarget:actionCounter];
+    GHAssertEquals(actionCounter.count, 1, @"The action must have been performed immediately");
+    
+    HLSCancellationToken *childToken = [[[HLSCancellationToken alloc] init] autorelease];
+    [token addChildToken:childToken];
+    GHAssertTrue(childToken.cancelled, @"The child token must have been cancelled immediately");
+    
+    // Cancelling again does not perform them again
+    [token cancel];
+    GHAssertEquals(actionCounter.count, 1, @"Actions must only be performed once");
+}
+
+- (void)testOperationCancellation
+{
+    s_blockedTaskOperationCount = 0;
+    s_interruptedTaskOperationCount = 0;
+    
+    HLSTaskManager *taskManager = [[[HLSTaskManager alloc] init] autorelease];
+    BlockingTask *task = [[[BlockingTask alloc] init] autorelease];
+    [taskManager submitTask:task];
+    
+    NSDate *timeoutDate = [NSDate dateWithTimeIntervalSinceNow:10.];
+    while (s_blockedTaskOperationCount == 0 && [timeoutDate timeIntervalSinceNow] > 0.) {
+        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    }
+    GHAssertTrue(s_blockedTaskOperationCount == 1, @"The operation must be blocked");
+    
+    // Cancelling the task cancels the token of its operation, whose action unblocks it
+    [taskManager cancelTask:task];
+    
+    timeoutDate = [NSDate dateWithTimeIntervalSinceNow:10.];
+    while (! task.finished && [timeoutDate timeIntervalSinceNow] > 0.) {
+        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    }
+    GHAssertTrue(task.finished, @"The task must have ended");
+    GHAssertTrue(task.cancelled, @"The task must have been cancelled");
+    GHAssertTrue(s_interruptedTaskOperationCount == 1, @"The operation must have been interrupted by its cancellation token");
+}
+
+@end
+
+@implementation CancellationCounter
+
+#pragma mark Accessors and mutators
+
+- (int32_t)count
+{
+    return _count;
+}
+
+#pragma mark Counting
+
+- (void)increment
+{
+    OSAtomicIncrement32Barrier(&_count);
+}
+
+@end
+
+@implementation BlockingTask
+
+#pragma mark Accessors and mutators
+
+- (Class)operationClass
+{
+    return [BlockingTaskOperation class];
+}
+
+@end
+
+@implementation BlockingTaskOperation
+
+#pragma mark Object creation and destruction
+
+- (void)dealloc
+{
+    if (_semaphore) {
+        dispatch_release(_semaphore);
+    }
+    [super dealloc];
+}
+
+#pragma mark Overrides
+
+- (void)operationMain
+{
+    _semaphore = dispatch_semaphore_create(0);
+    [[self cancellationToken] addCancellationAction:@selector(unblock) onTarget:self];
+    OSAtomicIncrement32Barrier(&s_blockedTaskOperationCount);
+    
+    // Wait for the cancellation action (with a timeout so that a failing test does not block forever)
+    if (dispatch_semaphore_wait(_semaphore, dispatch_time(DISPATCH_TIME_NOW, 5 * NSEC_PER_SEC)) == 0) {
+        OSAtomicIncrement32Barrier(&s_interruptedTaskOperationCount);
+    }
+}
+
+#pragma mark Unblocking
+
+- (void)unblock
+{
+    dispatch_semaphore_signal(_semaphore);
+}
+
+@end
@@ -0,0 +1,15 @@
+//
+//  HLSTaskManagerBenchmarkTestCase.h
+//  CoconutKit-test
+//
+//  Created by Samuel Défago on 15.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+@interface HLSTaskManagerBenchmarkTestCase : GHTestCase <HLSTaskDelegate, HLSTaskGroupDelegate> {
+@private
+    NSUInteger m_callbackCount;
+    NSTimeInterval m_callbackCPUTime;
+}
+
+@end
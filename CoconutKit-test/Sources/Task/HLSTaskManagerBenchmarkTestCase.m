@@ -0,0 +1,491 @@
+//
+//  HLSTaskManagerBenchmarkTestCase.m
+//  CoconutKit-test
+//
+//  Created by Samuel Défago on 15.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSTaskManagerBenchmarkTestCase.h"
+
+#import "BenchmarkRunner.h"
+
+#import <mach/mach.h>
+
+/**
+ * Synthetic workloads (similar to the ones of the ParallelProcessing demo) are submitted as task groups of various
+ * shapes, with various numbers of tasks processed simultaneously, and to each task manager configuration ("engine")
+ * listed below. For each run, the following figures are measured:
+ *   - throughput (tasks per second, from submission until the task group has been processed)
+ *   - latency percentiles between the time a task is ready (submitted, and all tasks it depends on have ended) and
+ *     the time its operation starts. Latency therefore includes the time spent waiting for a free thread
+ *   - number of delegate callbacks received, and CPU time spent by the main thread in them (the time spent by the
+ *     test waiting for callbacks is not included)
+ *
+ * Results are logged and saved as CSV (one line per engine, workload, shape and concurrency) in the Documents
+ * directory, so that they can be compared between releases. To compare a new engine with the existing ones, add
+ * its name to kBenchmarkEngineNames and configure task managers accordingly in -configureTaskManager:forEngineName:.
+ * Run on a device, results measured on the simulator are meaningless
+ */
+static NSString * const kBenchmarkEngineNames[] = {@"private-synchronous", @"private-asynchronous", @"shared-asynchronous"};
+static const NSInteger kBenchmarkMaxConcurrentTaskCounts[] = {1, 2, 4, 8};
+static const NSUInteger kBenchmarkFlatTaskCount = 200;
+static const NSUInteger kBenchmarkDAGLayerCount = 10;
+static const NSUInteger kBenchmarkDAGLayerWidth = 20;
+static const NSUInteger kBenchmarkFanOutWidth = 200;
+static const NSUInteger kBenchmarkCPUIterationCount = 100000;
+static const NSTimeInterval kBenchmarkIOTimeInterval = 0.005;
+static const NSUInteger kBenchmarkProgressUpdateCount = 100;
+static NSString * const kBenchmarkResultsFileName = @"TaskManagerBenchmark.csv";
+static const NSTimeInterval kBenchmarkRunTimeout = 60.;
+
+typedef enum {
+    BenchmarkWorkloadEnumBegin = 0,
+    BenchmarkWorkloadCPU = BenchmarkWorkloadEnumBegin,          // Busy loop
+    BenchmarkWorkloadIO,                                        // Waiting, as for a file or network access
+    BenchmarkWorkloadCallbacks,                                 // Many progress updates
+    BenchmarkWorkloadEnumEnd,
+    BenchmarkWorkloadEnumSize = BenchmarkWorkloadEnumEnd - BenchmarkWorkloadEnumBegin
+} BenchmarkWorkload;
+
+typedef enum {
+    BenchmarkShapeEnumBegin = 0,
+    BenchmarkShapeFlat = BenchmarkShapeEnumBegin,               // Independent tasks
+    BenchmarkShapeDAG,                                          // Layers of tasks, each one depending on two tasks of the previous layer
+    BenchmarkShapeFanOut,                                       // One task, many tasks depending on it, and one task depending on all of them
+    BenchmarkShapeEnumEnd,
+    BenchmarkShapeEnumSize = BenchmarkShapeEnumEnd - BenchmarkShapeEnumBegin
+} BenchmarkShape;
+
+static NSString * const kBenchmarkWorkloadNames[] = {@"cpu", @"io", @"callbacks"};
+static NSString * const kBenchmarkShapeNames[] = {@"flat", @"dag", @"fanout"};
+
+// Function declarations
+static NSTimeInterval currentThreadCPUTime(void);
+static int compareTimeIntervals(const void *pTimeInterval1, const void *pTimeInterval2);
+static NSTimeInterval percentile(NSTimeInterval *sortedTimeIntervals, NSUInteger count, double fraction);
+
+@interface TaskManagerBenchmarkTask : HLSTask {
+@private
+    BenchmarkWorkload m_workload;
+    NSArray *m_prerequisiteTasks;
+    CFAbsoluteTime m_submissionTime;
+    CFAbsoluteTime m_startTime;
+    CFAbsoluteTime m_endTime;
+}
+
+- (id)initWithWorkload:(BenchmarkWorkload)workload;
+
+@property (nonatomic, readonly, assign) BenchmarkWorkload workload;
+
+// The tasks this task depends on
+@property (nonatomic, retain) NSArray *prerequisiteTasks;
+
+// Set on the submitting thread, resp. by the operation
+@property (nonatomic, assign) CFAbsoluteTime submissionTime;
+@property (nonatomic, assign) CFAbsoluteTime startTime;
+@property (nonatomic, assign) CFAbsoluteTime endTime;
+
+// Time at which the task could have been started, if a thread had been available
+- (CFAbsoluteTime)readyTime;
+
+@end
+
+@interface TaskManagerBenchmarkTaskOperation : HLSTaskOperation
+
+@end
+
+@interface HLSTaskManagerBenchmarkTestCase ()
+
+- (void)configureTaskManager:(HLSTaskManager *)taskManager forEngineName:(NSString *)engineName;
+- (HLSTaskGroup *)taskGroupWithWorkload:(BenchmarkWorkload)workload shape:(BenchmarkShape)shape;
+- (NSString *)resultLineForEngineName:(NSString *)engineName
+                             workload:(BenchmarkWorkload)workload
+                                shape:(BenchmarkShape)shape
+               maxConcurrentTaskCount:(NSInteger)maxConcurrentTaskCount;
+
+@end
+
+@implementation HLSTaskManagerBenchmarkTestCase
+
+#pragma mark Test setup and tear down
+
+- (BOOL)shouldRunOnMainThread
+{
+    // Task status notifications are delivered through the run loop of the thread tasks are submitted from
+    return YES;
+}
+
+#pragma mark Tests
+
+- (void)testTaskManagerBenchmark
+{
+    if (! [BenchmarkRunner shouldRunBenchmarks]) {
+        return;
+    }
+    
+    NSMutableArray *resultLines = [NSMutableArray arrayWithObject:@"engine,workload,shape,maxConcurrentTaskCount,taskCount,"
+                                   "duration,tasksPerSecond,latencyP50,latencyP90,latencyP99,latencyMax,callbackCount,callbackCPUTime"];
+    for (NSUInteger i = 0; i < sizeof(kBenchmarkEngineNames) / sizeof(NSString *); ++i) {
+        for (BenchmarkWorkload workload = BenchmarkWorkloadEnumBegin; workload < BenchmarkWorkloadEnumEnd; ++workload) {
+            for (BenchmarkShape shape = BenchmarkShapeEnumBegin; shape < BenchmarkShapeEnumEnd; ++shape) {
+                for (NSUInteger j = 0; j < sizeof(kBenchmarkMaxConcurrentTaskCounts) / sizeof(NSInteger); ++j) {
+                    NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+                    NSString *resultLine = [self resultLineForEngineName:kBenchmarkEngineNames[i]
+                                                                workload:workload
+                                                                   shape:shape
+                                                  maxConcurrentTaskCount:kBenchmarkMaxConcurrentTaskCounts[j]];
+                    if (resultLine) {
+                        [resultLines addObject:resultLine];
+                    }
+                    [pool drain];
+                }
+            }
+        }
+    }
+    
+    NSString *results = [resultLines componentsJoinedByString:@"\n"];
+    GHTestLog(@"%@", results);
+    
+    NSString *documentsDirectoryPath = [NSSearchPathForDirectoriesInDomains(NSDocumentDirectory, NSUserDomainMask, YES) objectAtIndex:0];
+    NSString *resultsFilePath = [documentsDirectoryPath stringByAppendingPathComponent:kBenchmarkResultsFileName];
+    NSError *error = nil;
+    if (! [results writeToFile:resultsFilePath atomically:YES encoding:NSUTF8StringEncoding error:&error]) {
+        GHFail(@"The benchmark results could not be saved. Reason: %@", error);
+    }
+    GHTestLog(@"Results saved to %@", resultsFilePath);
+}
+
+#pragma mark Benchmark helpers
+
+- (void)configureTaskManager:(HLSTaskManager *)taskManager forEngineName:(NSString *)engineName
+{
+    if ([engineName isEqualToString:@"private-synchronous"]) {
+        // Default configuration
+    }
+    else if ([engineName isEqualToString:@"private-asynchronous"]) {
+        taskManager.notificationMode = HLSTaskNotificationModeAsynchronous;
+    }
+    else if ([engineName isEqualToString:@"shared-asynchronous"]) {
+        taskManager.usingSharedThreadPool = YES;
+        taskManager.notificationMode = HLSTaskNotificationModeAsynchronous;
+    }
+    else {
+        GHFail(@"Unknown engine %@", engineName);
+    }
+}
+
+- (HLSTaskGroup *)taskGroupWithWorkload:(BenchmarkWorkload)workload shape:(BenchmarkShape)shape
+{
+    HLSTaskGroup *taskGroup = [[[HLSTaskGroup alloc] init] autorelease];
+    switch (shape) {
+        case BenchmarkShapeFlat: {
+            for (NSUInteger i = 0; i < kBenchmarkFlatTaskCount; ++i) {
+                [taskGroup addTask:[[[TaskManagerBenchmarkTask alloc] initWithWorkload:workload] autorelease]];
+            }
+            break;
+        }
+        
+        case BenchmarkShapeDAG: {
+            NSArray *previousLayerTasks = nil;
+            for (NSUInteger i = 0; i < kBenchmarkDAGLayerCount; ++i) {
+                NSMutableArray *layerTasks = [NSMutableArray arrayWithCapacity:kBenchmarkDAGLayerWidth];
+                for (NSUInteger j = 0; j < kBenchmarkDAGLayerWidth; ++j) {
+                    TaskManagerBenchmarkTask *task = [[[TaskManagerBenchmarkTask alloc] initWithWorkload:workload] autorelease];
+                    [taskGroup addTask:task];
+                    [layerTasks addObject:task];
+                    
+                    if (previousLayerTasks) {
+                        TaskManagerBenchmarkTask *prerequisiteTask1 = [previousLayerTasks objectAtIndex:j];
+                        TaskManagerBenchmarkTask *prerequisiteTask2 = [previousLayerTasks objectAtIndex:(j + 1) % kBenchmarkDAGLayerWidth];
+                        [taskGroup addDependencyForTask:task onTask:prerequisiteTask1 strong:YES];
+                        [taskGroup addDependencyForTask:task onTask:prerequisiteTask2 strong:YES];
+                        task.prerequisiteTasks = [NSArray arrayWithObjects:prerequisiteTask1, prerequisiteTask2, nil];
+                    }
+                }
+                previousLayerTasks = layerTasks;
+            }
+            break;
+        }
+        
+        case BenchmarkShapeFanOut: {
+            TaskManagerBenchmarkTask *sourceTask = [[[TaskManagerBenchmarkTask alloc] initWithWorkload:workload] autorelease];
+            [taskGroup addTask:sourceTask];
+            
+            NSMutableArray *fanOutTasks = [NSMutableArray arrayWithCapacity:kBenchmarkFanOutWidth];
+            for (NSUInteger i = 0; i < kBenchmarkFanOutWidth; ++i) {
+                TaskManagerBenchmarkTask *task = [[[TaskManagerBenchmarkTask alloc] initWithWorkload:workload] autorelease];
+                [taskGroup addTask:task];
+                [taskGroup addDependencyForTask:task onTask:sourceTask strong:YES];
+                task.prerequisiteTasks = [NSArray arrayWithObject:sourceTask];
+                [fanOutTasks addObject:task];
+            }
+            
+            TaskManagerBenchmarkTask *sinkTask = [[[TaskManagerBenchmarkTask alloc] initWithWorkload:workload] autorelease];
+            [taskGroup addTask:sinkTask];
+            for (TaskManagerBenchmarkTask *task in fanOutTasks) {
+                [taskGroup addDependencyForTask:sinkTask onTask:task strong:YES];
+            }
+            sinkTask.prerequisiteTasks = fanOutTasks;
+            break;
+        }
+        
+        default: {
+            HLSLoggerError(@"Unknown shape");
+            return nil;
+        }
+    }
+    return taskGroup;
+}
+
+- (NSString *)resultLineForEngineName:(NSString *)engineName
+                             workload:(BenchmarkWorkload)workload
+                                shape:(BenchmarkShape)shape
+               maxConcurrentTaskCount:(NSInteger)maxConcurrentTaskCount
+{
+    HLSTaskExecutionClass executionClass = HLSTaskExecutionClassDefault;
+    if (workload == BenchmarkWorkloadCPU) {
+        executionClass = HLSTaskExecutionClassCPU;
+    }
+    else if (workload == BenchmarkWorkloadIO) {
+        executionClass = HLSTaskExecutionClassIO;
+    }
+    
+    HLSTaskManager *taskManager = [[[HLSTaskManager alloc] init] autorelease];
+    [self configureTaskManager:taskManager forEngineName:engineName];
+    [taskManager setMaxConcurrentTaskCount:maxConcurrentTaskCount forExecutionClass:executionClass];
+    
+    HLSTaskGroup *taskGroup = [self taskGroupWithWorkload:workload shape:shape];
+    NSSet *tasks = [taskGroup allTasks];
+    for (TaskManagerBenchmarkTask *task in tasks) {
+        task.executionClass = executionClass;
+        [taskManager registerDelegate:self forTask:task];
+    }
+    [taskManager registerDelegate:self forTaskGroup:taskGroup];
+    
+    m_callbackCount = 0;
+    m_callbackCPUTime = 0.;
+    CFAbsoluteTime submissionTime = CFAbsoluteTimeGetCurrent();
+    for (TaskManagerBenchmarkTask *task in tasks) {
+        task.submissionTime = submissionTime;
+    }
+    [taskManager submitTaskGroup:taskGroup];
+    
+    // Sleep until a notification is received (the run loop returns after each source it processes)
+    NSDate *timeoutDate = [NSDate dateWithTimeIntervalSinceNow:kBenchmarkRunTimeout];
+    while (! taskGroup.finished && [timeoutDate timeIntervalSinceNow] > 0.) {
+        [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:timeoutDate];
+    }
+    CFTimeInterval duration = CFAbsoluteTimeGetCurrent() - submissionTime;
+    
+    if (! taskGroup.finished) {
+        [taskManager unregisterDelegateAndCancelAssociatedTasks:self];
+        GHFail(@"The run %@ / %@ / %@ / %d did not end", engineName, kBenchmarkWorkloadNames[workload],
+               kBenchmarkShapeNames[shape], maxConcurrentTaskCount);
+        return nil;
+    }
+    GHAssertEquals([taskGroup nbrFailures], 0U, @"No failures");
+    
+    NSUInteger taskCount = [tasks count];
+    NSTimeInterval *latencies = malloc(taskCount * sizeof(NSTimeInterval));
+    NSUInteger i = 0;
+    for (TaskManagerBenchmarkTask *task in tasks) {
+        latencies[i] = task.startTime - [task readyTime];
+        ++i;
+    }
+    qsort(latencies, taskCount, sizeof(NSTimeInterval), compareTimeIntervals);
+    
+    NSString *resultLine = [NSString stringWithFormat:@"%@,%@,%@,%d,%d,%.4f,%.1f,%.6f,%.6f,%.6f,%.6f,%d,%.4f",
+                            engineName,
+                            kBenchmarkWorkloadNames[workload],
+                            kBenchmarkShapeNames[shape],
+                            maxConcurrentTaskCount,
+                            taskCount,
+                            duration,
+                            taskCount / duration,
+                            percentile(latencies, taskCount, 0.5),
+                            percentile(latencies, taskCount, 0.9),
+                            percentile(latencies, taskCount, 0.99),
+                            latencies[taskCount - 1],
+                            m_callbackCount,
+                            m_callbackCPUTime];
+    free(latencies);
+    return resultLine;
+}
+
+#pragma mark HLSTaskDelegate protocol implementation
+
+- (void)taskHasStartedProcessing:(HLSTask *)task
+{
+    NSTimeInterval startCPUTime = currentThreadCPUTime();
+    ++m_callbackCount;
+    m_callbackCPUTime += currentThreadCPUTime() - startCPUTime;
+}
+
+- (void)taskProgressUpdated:(HLSTask *)task
+{
+    NSTimeInterval startCPUTime = currentThreadCPUTime();
+    ++m_callbackCount;
+    m_callbackCPUTime += currentThreadCPUTime() - startCPUTime;
+}
+
+- (void)taskHasBeenProcessed:(HLSTask *)task
+{
+    NSTimeInterval startCPUTime = currentThreadCPUTime();
+    ++m_callbackCount;
+    m_callbackCPUTime += currentThreadCPUTime() - startCPUTime;
+}
+
+#pragma mark HLSTaskGroupDelegate protocol implementation
+
+- (void)taskGroupHasStartedProcessing:(HLSTaskGroup *)taskGroup
+{
+    NSTimeInterval startCPUTime = currentThreadCPUTime();
+    ++m_callbackCount;
+    m_callbackCPUTime += currentThreadCPUTime() - startCPUTime;
+}
+
+- (void)taskGroupProgressUpdated:(HLSTaskGroup *)taskGroup
+{
+    NSTimeInterval startCPUTime = currentThreadCPUTime();
+    ++m_callbackCount;
+    m_callbackCPUTime += currentThreadCPUTime() - startCPUTime;
+}
+
+- (void)taskGroupHasBeenProcessed:(HLSTaskGroup *)taskGroup
+{
+    NSTimeInterval startCPUTime = currentThreadCPUTime();
+    ++m_callbackCount;
+    m_callbackCPUTime += currentThreadCPUTime() - startCPUTime;
+}
+
+@end
+
+@implementation TaskManagerBenchmarkTask
+
+#pragma mark Object creation and destruction
+
+- (id)initWithWorkload:(BenchmarkWorkload)workload
+{
+    if ((self = [super init])) {
+        m_workload = workload;
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    self.prerequisiteTasks = nil;
+    
+    [super dealloc];
+}
+
+#pragma mark Accessors and mutators
+
+- (Class)operationClass
+{
+    return [TaskManagerBenchmarkTaskOperation class];
+}
+
+@synthesize workload = m_workload;
+
+@synthesize prerequisiteTasks = m_prerequisiteTasks;
+
+@synthesize submissionTime = m_submissionTime;
+
+@synthesize startTime = m_startTime;
+
+@synthesize endTime = m_endTime;
+
+- (CFAbsoluteTime)readyTime
+{
+    CFAbsoluteTime readyTime = self.submissionTime;
+    for (TaskManagerBenchmarkTask *prerequisiteTask in self.prerequisiteTasks) {
+        readyTime = MAX(readyTime, prerequisiteTask.endTime);
+    }
+    return readyTime;
+}
+
+@end
+
+@implementation TaskManagerBenchmarkTaskOperation
+
+#pragma mark Overrides
+
+- (void)operationMain
+{
+    TaskManagerBenchmarkTask *task = (TaskManagerBenchmarkTask *)self.task;
+    task.startTime = CFAbsoluteTimeGetCurrent();
+    
+    switch (task.workload) {
+        case BenchmarkWorkloadCPU: {
+            volatile double dummy = 0.;
+            for (NSUInteger i = 0; i < kBenchmarkCPUIterationCount; ++i) {
+                dummy += sqrt(i);
+            }
+            break;
+        }
+        
+        case BenchmarkWorkloadIO: {
+            [NSThread sleepForTimeInterval:kBenchmarkIOTimeInterval];
+            break;
+        }
+        
+        case BenchmarkWorkloadCallbacks: {
+            for (NSUInteger i = 0; i < kBenchmarkProgressUpdateCount; ++i) {
+                if ([self isCancelled]) {
+                    break;
+                }
+                [self updateProgressToValue:(float)(i + 1) / kBenchmarkProgressUpdateCount];
+            }
+            break;
+        }
+        
+        default: {
+            break;
+        }
+    }
+    
+    task.endTime = CFAbsoluteTimeGetCurrent();
+}
+
+@end
+
+#pragma mark Static functions
+
+static NSTimeInterval currentThreadCPUTime(void)
+{
+    thread_basic_info_data_t info;
+    mach_msg_type_number_t count = THREAD_BASIC_INFO_COUNT;
+    mach_port_t thread = mach_thread_self();
+    kern_return_t result = thread_info(thread, THREAD_BASIC_INFO, (thread_info_t)&info, &count);
+    mach_port_deallocate(mach_task_self(), thread);
+    if (result != KERN_SUCCESS) {
+        return 0.;
+    }
+    
+    return info.user_time.seconds + info.user_time.microseconds / 1e6
+        + info.system_time.seconds + info.system_time.microseconds / 1e6;
+}
+
+static int compareTimeIntervals(const void *pTimeInterval1, const void *pTimeInterval2)
+{
+    NSTimeInterval timeInterval1 = *(const NSTimeInterval *)pTimeInterval1;
+    NSTimeInterval timeInterval2 = *(const NSTimeInterval *)pTimeInterval2;
+    if (timeInterval1 < timeInterval2) {
+        return -1;
+    }
+    else if (timeInterval1 > timeInterval2) {
+        return 1;
+    }
+    else {
+        return 0;
+    }
+}
+
+// Nearest-rank percentile of an array sorted in ascending order
+static NSTimeInterval percentile(NSTimeInterval *sortedTimeIntervals, NSUInteger count, double fraction)
+{
+    NSUInteger rank = (NSUInteger)ceil(fraction * count);
+    return sortedTimeIntervals[MAX(rank, 1) - 1];
+}
@@ -0,0 +1,921 @@
+//
+//  HLSTaskManagerTestCase.m
+//  CoconutKit-test
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSTaskManagerTestCase.h"
+
+#include <libkern/OSAtomic.h>
+
+static const NSUInteger kBenchmarkTaskCount = 10000;
+static const NSUInteger kBatchItemCount = 100000;
+
+static volatile int32_t s_runningSleepingTaskCount = 0;
+static volatile int32_t s_maxRunningSleepingTaskCount = 0;
+static volatile int32_t s_cachedTaskProcessingCount = 0;
+
+@interface BenchmarkTask : HLSTask
+
+@end
+
+@interface BenchmarkTaskOperation : HLSTaskOperation
+
+@end
+
+@interface CachedTask : HLSTask
+
+@end
+
+@interface CachedTaskOperation : HLSTaskOperation
+
+@end
+
+@interface CancellableTask : HLSTask
+
+@end
+
+@interface CancellableTaskOperation : HLSTaskOperation
+
+@end
+
+@interface CountingBatchTask : HLSBatchTask {
+@private
+    volatile int32_t *_counters;
+}
+
+- (int32_t)counterAtIndex:(NSUInteger)index;
+
+@end
+
+@interface ProgressTask : HLSTask
+
+@end
+
+@interface ProgressTaskOperation : HLSTaskOperation
+
+@end
+
+@interface TaskEventRecorder : NSObject <HLSTaskDelegate> {
+@private
+    dispatch_queue_t _expectedQueue;
+    NSMutableArray *_events;
+    NSMutableArray *_progressValues;
+    BOOL _deliveredOnExpectedQueue;
+    BOOL _finished;
+}
+
+- (id)initWithExpectedQueue:(dispatch_queue_t)expectedQueue;
+
+@property (nonatomic, readonly, retain) NSArray *events;
+@property (nonatomic, readonly, retain) NSArray *progressValues;
+@property (nonatomic, readonly, assign) BOOL deliveredOnExpectedQueue;
+@property (nonatomic, readonly, assign, getter=isFinished) BOOL finished;
+
+@end
+
+@interface SleepingTask : HLSTask
+
+@end
+
+@interface SleepingTaskOperation : HLSTaskOperation
+
+@end
+
+@interface ThrottlingTestPolicy : HLSTaskThrottlingPolicy {
+@private
+    float _concurrencyFactor;
+    BOOL _deferringTasks;
+}
+
+@property (nonatomic, assign) float concurrencyFactor;
+@property (nonatomic, assign) BOOL deferringTasks;
+
+@end
+
+// Submit a task from a task manager delegate queue. The context is an array containing the task manager, the task
+// and its delegate
+static void submitTaskWithDelegate(void *context)
+{
+    NSArray *arguments = (NSArray *)context;
+    HLSTaskManager *taskManager = [arguments objectAtIndex:0];
+    HLSTask *task = [arguments objectAtIndex:1];
+    [taskManager registerDelegate:[arguments objectAtIndex:2] forTask:task];
+    [taskManager submitTask:task];
+}
+
+// Release a task manager on its delegate queue, after all pending bookkeeping has been performed
+static void releaseTaskManager(void *context)
+{
+    [(HLSTaskManager *)context release];
+}
+
+@implementation HLSTaskManagerTestCase
+
+#pragma mark Test setup and tear down
+
+- (BOOL)shouldRunOnMainThread
+{
+    // Task status notifications are delivered through the run loop of the thread tasks are submitted from
+    return YES;
+}
+
+#pragma mark Tests
+
+- (void)testSubmitAndCancelThroughput
+{
+    HLSTaskManager *taskManager = [[[HLSTaskManager alloc] init] autorelease];
+    
+    NSMutableArray *tasks = [NSMutableArray arrayWithCapacity:kBenchmarkTaskCount];
+    for (NSUInteger i = 0; i < kBenchmarkTaskCount; ++i) {
+        BenchmarkTask *task = [[[BenchmarkTask alloc] init] autorelease];
+        task.tag = (i % 2 == 0) ? @"even" : @"odd";
+        [tasks addObject:task];
+    }
+    
+    // Submit. Since the run loop does not run during the test, tasks cannot end and remain queued (or blocked
+    // when starting)
+    CFAbsoluteTime submitStartTime = CFAbsoluteTimeGetCurrent();
+    for (BenchmarkTask *task in tasks) {
+        [taskManager registerDelegate:self forTask:task];
+        [taskManager submitTask:task];
+    }
+    CFTimeInterval submitDuration = CFAbsoluteTimeGetCurrent() - submitStartTime;
+    GHTestLog(@"Submitted %d tasks in %.3f s (%.0f tasks / s)", kBenchmarkTaskCount, submitDuration, 
+              kBenchmarkTaskCount / submitDuration);
+    
+    // Lookup by tag
+    CFAbsoluteTime lookupStartTime = CFAbsoluteTimeGetCurrent();
+    NSUInteger nbrEvenTasks = [[taskManager tasksWithTag:@"even"] count];
+    NSUInteger nbrOddTasks = [[taskManager tasksWithTag:@"odd"] count];
+    CFTimeInterval lookupDuration = CFAbsoluteTimeGetCurrent() - lookupStartTime;
+    GHTestLog(@"Looked up tasks by tag in %.6f s", lookupDuration);
+    GHAssertEquals(nbrEvenTasks, kBenchmarkTaskCount / 2, @"Tasks with tag");
+    GHAssertEquals(nbrOddTasks, kBenchmarkTaskCount / 2, @"Tasks with tag");
+    GHAssertEquals([[taskManager tasksWithTag:@"none"] count], 0U, @"Tasks with unused tag");
+    GHAssertEquals([[taskManager tasksWithTag:@"even|odd"] count], kBenchmarkTaskCount, @"Tasks with tag matching a pattern");
+    GHAssertEquals([[taskManager tasksWithTag:@"e.*"] count], kBenchmarkTaskCount / 2, @"Tasks with tag matching a pattern");
+    
+    // Cancel by tag, then by delegate
+    CFAbsoluteTime cancelStartTime = CFAbsoluteTimeGetCurrent();
+    [taskManager cancelTasksWithTag:@"even"];
+    [taskManager unregisterDelegateAndCancelAssociatedTasks:self];
+    CFTimeInterval cancelDuration = CFAbsoluteTimeGetCurrent() - cancelStartTime;
+    GHTestLog(@"Cancelled %d tasks in %.3f s (%.0f tasks / s)", kBenchmarkTaskCount, cancelDuration, 
+              kBenchmarkTaskCount / cancelDuration);
+    
+    // Let tasks which had already been started end
+    NSDate *timeoutDate = [NSDate dateWithTimeIntervalSinceNow:10.];
+    while (([[taskManager tasksWithTag:@"even"] count] != 0 || [[taskManager tasksWithTag:@"odd"] count] != 0)
+           && [timeoutDate timeIntervalSinceNow] > 0.) {
+        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    }
+    GHAssertEquals([[taskManager tasksWithTag:@"even"] count], 0U, @"All tasks must have ended");
+    GHAssertEquals([[taskManager tasksWithTag:@"odd"] count], 0U, @"All tasks must have ended");
+}
+
+- (void)testBatchTask
+{
+    HLSTaskManager *taskManager = [[[HLSTaskManager alloc] init] autorelease];
+    taskManager.metricsEnabled = YES;
+    
+    CountingBatchTask *batchTask = [[[CountingBatchTask alloc] initWithRange:NSMakeRange(0, kBatchItemCount)] autorelease];
+    batchTask.tag = @"batch";
+    batchTask.maxWorkerCount = 4;
+    [taskManager submitTask:batchTask];
+    
+    NSDate *timeoutDate = [NSDate dateWithTimeIntervalSinceNow:30.];
+    while (! batchTask.finished && [timeoutDate timeIntervalSinceNow] > 0.) {
+        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    }
+    GHAssertTrue(batchTask.finished, @"The batch task must have ended");
+    GHAssertTrue(floateq(batchTask.progress, 1.f), @"Progress must be aggregated");
+    
+    // Each item must have been processed exactly once, whichever worker processed it
+    for (NSUInteger i = 0; i < kBatchItemCount; ++i) {
+        GHAssertEquals([batchTask counterAtIndex:i], 1, @"Item %d", i);
+    }
+    
+    HLSTaskMetrics *metrics = [[taskManager metricsByTag] objectForKey:@"batch"];
+    GHTestLog(@"Batch task metrics: %@", metrics);
+    GHAssertEquals(metrics.pendingTaskCount, 0U, @"No pending task");
+    GHAssertEquals(metrics.runningTaskCount, 0U, @"No running task");
+    GHAssertEquals(metrics.finishedTaskCount, 1U, @"One finished task");
+}
+
+- (void)testNestedTaskGroups
+{
+    HLSTaskManager *taskManager = [[[HLSTaskManager alloc] init] autorelease];
+    
+    // Two stages, each one made of parallel tasks, the second one depending on the first one
+    HLSTaskGroup *rootTaskGroup = [[[HLSTaskGroup alloc] init] autorelease];
+    HLSTaskGroup *firstStageTaskGroup = [[[HLSTaskGroup alloc] init] autorelease];
+    HLSTaskGroup *secondStageTaskGroup = [[[HLSTaskGroup alloc] init] autorelease];
+    for (NSUInteger i = 0; i < 10; ++i) {
+        [firstStageTaskGroup addTask:[[[BenchmarkTask alloc] init] autorelease]];
+        [secondStageTaskGroup addTask:[[[BenchmarkTask alloc] init] autorelease]];
+    }
+    [rootTaskGroup addTaskGroup:firstStageTaskGroup];
+    [rootTaskGroup addTaskGroup:secondStageTaskGroup];
+    
+    // An empty task group has nothing to wait for
+    HLSTaskGroup *emptyTaskGroup = [[[HLSTaskGroup alloc] init] autorelease];
+    emptyTaskGroup.tag = @"empty";
+    [rootTaskGroup addTaskGroup:emptyTaskGroup];
+    [rootTaskGroup addDependencyForTaskGroup:secondStageTaskGroup onTaskGroup:firstStageTaskGroup strong:YES];
+    GHAssertEquals([[rootTaskGroup allTasks] count], 20U, @"All tasks");
+    GHAssertEquals(firstStageTaskGroup.parentTaskGroup, rootTaskGroup, @"Parent task group");
+    
+    // Cycles are rejected
+    [firstStageTaskGroup addTaskGroup:rootTaskGroup];
+    GHAssertNil(rootTaskGroup.parentTaskGroup, @"A task group cannot contain itself");
+    
+    [taskManager submitTaskGroup:rootTaskGroup];
+    GHAssertTrue(emptyTaskGroup.finished, @"An empty task group must end immediately");
+    GHAssertEquals([[taskManager taskGroupsWithTag:@"empty"] count], 0U, @"An empty task group must not remain registered");
+    
+    NSDate *timeoutDate = [NSDate dateWithTimeIntervalSinceNow:10.];
+    while (! rootTaskGroup.finished && [timeoutDate timeIntervalSinceNow] > 0.) {
+        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    }
+    GHAssertTrue(rootTaskGroup.finished, @"The task group must have ended");
+    GHAssertTrue(firstStageTaskGroup.finished, @"Contained task groups must have ended");
+    GHAssertTrue(secondStageTaskGroup.finished, @"Contained task groups must have ended");
+    GHAssertTrue(floateq(rootTaskGroup.progress, 1.f), @"Progress must be aggregated");
+    GHAssertEquals([rootTaskGroup nbrFailures], 0U, @"No failures");
+}
+
+- (void)testDelegateQueue
+{
+    dispatch_queue_t delegateQueue = dispatch_queue_create("ch.hortis.CoconutKit-test.HLSTaskManagerTestCase", NULL);
+    HLSTaskManager *taskManager = [[HLSTaskManager alloc] init];
+    taskManager.delegateQueue = delegateQueue;
+    
+    // Notifications must be delivered on the task manager queue, from which the task manager must be used
+    ProgressTask *task = [[[ProgressTask alloc] init] autorelease];
+    TaskEventRecorder *recorder = [[[TaskEventRecorder alloc] initWithExpectedQueue:delegateQueue] autorelease];
+    dispatch_sync_f(delegateQueue, [NSArray arrayWithObjects:taskManager, task, recorder, nil], submitTaskWithDelegate);
+    
+    NSDate *timeoutDate = [NSDate dateWithTimeIntervalSinceNow:10.];
+    while (! recorder.finished && [timeoutDate timeIntervalSinceNow] > 0.) {
+        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    }
+    GHAssertTrue(recorder.finished, @"The task must have ended");
+    GHAssertTrue(recorder.deliveredOnExpectedQueue, @"Notifications must be delivered on the task manager queue");
+    [self checkEventsOfRecorder:recorder];
+    
+    // A task can deliver notifications to its own delegate on another queue (here the main queue, drained by the
+    // run loop)
+    ProgressTask *mainQueueTask = [[[ProgressTask alloc] init] autorelease];
+    mainQueueTask.delegateQueue = dispatch_get_main_queue();
+    TaskEventRecorder *mainQueueRecorder = [[[TaskEventRecorder alloc] initWithExpectedQueue:dispatch_get_main_queue()] autorelease];
+    dispatch_sync_f(delegateQueue, [NSArray arrayWithObjects:taskManager, mainQueueTask, mainQueueRecorder, nil], 
+                    submitTaskWithDelegate);
+    
+    timeoutDate = [NSDate dateWithTimeIntervalSinceNow:10.];
+    while (! mainQueueRecorder.finished && [timeoutDate timeIntervalSinceNow] > 0.) {
+        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    }
+    GHAssertTrue(mainQueueRecorder.finished, @"The task must have ended");
+    GHAssertTrue(mainQueueRecorder.deliveredOnExpectedQueue, @"Notifications must be delivered on the task queue");
+    [self checkEventsOfRecorder:mainQueueRecorder];
+    
+    dispatch_sync_f(delegateQueue, taskManager, releaseTaskManager);
+    dispatch_release(delegateQueue);
+}
+
+- (void)testThrottlingPolicy
+{
+    s_runningSleepingTaskCount = 0;
+    s_maxRunningSleepingTaskCount = 0;
+    
+    HLSTaskManager *taskManager = [[[HLSTaskManager alloc] init] autorelease];
+    [taskManager setMaxConcurrentTaskCount:4 forExecutionClass:HLSTaskExecutionClassDefault];
+    
+    ThrottlingTestPolicy *throttlingPolicy = [[[ThrottlingTestPolicy alloc] init] autorelease];
+    throttlingPolicy.concurrencyFactor = 0.5f;
+    throttlingPolicy.deferringTasks = YES;
+    taskManager.throttlingPolicy = throttlingPolicy;
+    GHAssertTrue([taskManager isDeferringTasks], @"Deferrable tasks must be deferred");
+    
+    NSMutableArray *tasks = [NSMutableArray array];
+    NSMutableArray *deferrableTasks = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 8; ++i) {
+        SleepingTask *task = [[[SleepingTask alloc] init] autorelease];
+        [tasks addObject:task];
+        [taskManager submitTask:task];
+        
+        SleepingTask *deferrableTask = [[[SleepingTask alloc] init] autorelease];
+        deferrableTask.deferrable = YES;
+        [deferrableTasks addObject:deferrableTask];
+        [taskManager submitTask:deferrableTask];
+    }
+    
+    // Only half of the tasks can run concurrently, and deferrable tasks must not be started
+    NSDate *timeoutDate = [NSDate dateWithTimeIntervalSinceNow:10.];
+    while ([[tasks valueForKeyPath:@"@sum.finished"] unsignedIntegerValue] != [tasks count]
+           && [timeoutDate timeIntervalSinceNow] > 0.) {
+        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    }
+    GHAssertEquals([[tasks valueForKeyPath:@"@sum.finished"] unsignedIntegerValue], [tasks count], @"All tasks must have ended");
+    GHAssertTrue(s_maxRunningSleepingTaskCount <= 2, @"At most 4 * 0.5 tasks can run concurrently");
+    for (SleepingTask *deferrableTask in deferrableTasks) {
+        GHAssertFalse(deferrableTask.running || deferrableTask.finished, @"Deferrable tasks must not have been started");
+    }
+    
+    // Lift the restrictions. Deferrable tasks must now be processed, with full concurrency
+    s_maxRunningSleepingTaskCount = 0;
+    throttlingPolicy.concurrencyFactor = 1.f;
+    throttlingPolicy.deferringTasks = NO;
+    [taskManager updateThrottling];
+    GHAssertFalse([taskManager isDeferringTasks], @"Deferrable tasks must not be deferred anymore");
+    
+    timeoutDate = [NSDate dateWithTimeIntervalSinceNow:10.];
+    while ([[deferrableTasks valueForKeyPath:@"@sum.finished"] unsignedIntegerValue] != [deferrableTasks count]
+           && [timeoutDate timeIntervalSinceNow] > 0.) {
+        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    }
+    GHAssertEquals([[deferrableTasks valueForKeyPath:@"@sum.finished"] unsignedIntegerValue], [deferrableTasks count], 
+                   @"Deferrable tasks must have ended");
+    GHAssertTrue(s_maxRunningSleepingTaskCount <= 4, @"At most 4 tasks can run concurrently");
+}
+
+- (void)testResultCache
+{
+    s_cachedTaskProcessingCount = 0;
+    
+    HLSTaskManager *taskManager = [[[HLSTaskManager alloc] init] autorelease];
+    taskManager.resultCacheEnabled = YES;
+    
+    // Identical tasks submitted while the first one is running wait for its result
+    NSMutableArray *tasks = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 5; ++i) {
+        CachedTask *task = [[[CachedTask alloc] init] autorelease];
+        task.tag = @"cached";
+        task.userInfo = [NSDictionary dictionaryWithObject:@"value" forKey:@"key"];
+        [tasks addObject:task];
+        [taskManager submitTask:task];
+    }
+    GHAssertEquals([[taskManager tasksWithTag:@"cached"] count], 5U, @"Waiting tasks must be found as any other task");
+    
+    [self waitUntilTasksHaveEnded:tasks];
+    GHAssertTrue(s_cachedTaskProcessingCount == 1, @"Identical tasks must only be processed once");
+    for (CachedTask *task in tasks) {
+        GHAssertFalse(task.cancelled, @"No task must have been cancelled");
+        GHAssertEqualObjects(task.returnInfo, [[tasks objectAtIndex:0] returnInfo], @"All tasks must receive the result");
+    }
+    
+    // The result is now found in the cache. It is delivered on the next run loop iteration with the usual events
+    CachedTask *cachedTask = [[[CachedTask alloc] init] autorelease];
+    cachedTask.tag = @"cached";
+    cachedTask.userInfo = [NSDictionary dictionaryWithObject:@"value" forKey:@"key"];
+    TaskEventRecorder *recorder = [[[TaskEventRecorder alloc] initWithExpectedQueue:dispatch_get_main_queue()] autorelease];
+    [taskManager submitTask:cachedTask];
+    [taskManager registerDelegate:recorder forTask:cachedTask];
+    GHAssertFalse(cachedTask.finished, @"A cached result must be delivered asynchronously");
+    GHAssertEquals([[taskManager tasksWithTag:@"cached"] count], 1U, @"A task waiting for a cached result must be found");
+    
+    [self waitUntilTasksHaveEnded:[NSArray arrayWithObject:cachedTask]];
+    GHAssertTrue(s_cachedTaskProcessingCount == 1, @"A cached result must not be computed again");
+    GHAssertEqualObjects(cachedTask.returnInfo, [[tasks objectAtIndex:0] returnInfo], @"The cached result must be received");
+    [self checkEventsOfRecorder:recorder];
+    GHAssertEquals([[taskManager tasksWithTag:@"cached"] count], 0U, @"The task must not be registered anymore");
+}
+
+- (void)testResultCacheCancellation
+{
+    s_cachedTaskProcessingCount = 0;
+    
+    HLSTaskManager *taskManager = [[[HLSTaskManager alloc] init] autorelease];
+    taskManager.resultCacheEnabled = YES;
+    
+    // Cancelling a task waiting for an identical one does not affect the latter
+    CachedTask *task = [[[CachedTask alloc] init] autorelease];
+    task.userInfo = [NSDictionary dictionaryWithObject:@"value" forKey:@"key"];
+    [taskManager submitTask:task];
+    CachedTask *duplicateTask = [[[CachedTask alloc] init] autorelease];
+    duplicateTask.userInfo = [NSDictionary dictionaryWithObject:@"value" forKey:@"key"];
+    [taskManager submitTask:duplicateTask];
+    [taskManager cancelTask:duplicateTask];
+    GHAssertTrue(duplicateTask.cancelled, @"The waiting task must have been cancelled");
+    
+    [self waitUntilTasksHaveEnded:[NSArray arrayWithObject:task]];
+    GHAssertFalse(task.cancelled, @"The processed task must not have been cancelled");
+    GHAssertNotNil(task.returnInfo, @"The processed task must have a result");
+    GHAssertNil(duplicateTask.returnInfo, @"The cancelled task must not receive the result");
+    
+    // A task cancelled before its cached result is delivered is only notified about its cancellation
+    CachedTask *cachedTask = [[[CachedTask alloc] init] autorelease];
+    cachedTask.tag = @"cached";
+    cachedTask.userInfo = [NSDictionary dictionaryWithObject:@"value" forKey:@"key"];
+    TaskEventRecorder *recorder = [[[TaskEventRecorder alloc] initWithExpectedQueue:dispatch_get_main_queue()] autorelease];
+    [taskManager submitTask:cachedTask];
+    [taskManager registerDelegate:recorder forTask:cachedTask];
+    [taskManager cancelTasksWithTag:@"cached"];
+    
+    [self waitUntilTasksHaveEnded:[NSArray arrayWithObject:cachedTask]];
+    GHAssertTrue(cachedTask.cancelled, @"The task must have been cancelled");
+    GHAssertNil(cachedTask.returnInfo, @"The cancelled task must not receive the cached result");
+    GHAssertEqualObjects(recorder.events, [NSArray arrayWithObject:@"cancelled"], @"Only the cancellation must be notified");
+    GHAssertEquals([[taskManager tasksWithTag:@"cached"] count], 0U, @"The task must not be registered anymore");
+    GHAssertTrue(s_cachedTaskProcessingCount == 1, @"A cached result must not be computed again");
+}
+
+- (void)testDeadline
+{
+    HLSTaskManager *taskManager = [[[HLSTaskManager alloc] init] autorelease];
+    ThrottlingTestPolicy *throttlingPolicy = [[[ThrottlingTestPolicy alloc] init] autorelease];
+    throttlingPolicy.concurrencyFactor = 1.f;
+    throttlingPolicy.deferringTasks = YES;
+    taskManager.throttlingPolicy = throttlingPolicy;
+    
+    // A running task is cancelled when its deadline passes
+    CancellableTask *runningTask = [[[CancellableTask alloc] init] autorelease];
+    runningTask.timeoutInterval = 0.2;
+    [taskManager submitTask:runningTask];
+    
+    // A task which has not been started when its deadline passes is dropped without being started
+    SleepingTask *deferredTask = [[[SleepingTask alloc] init] autorelease];
+    deferredTask.deferrable = YES;
+    deferredTask.timeoutInterval = 0.2;
+    TaskEventRecorder *recorder = [[[TaskEventRecorder alloc] initWithExpectedQueue:dispatch_get_main_queue()] autorelease];
+    [taskManager registerDelegate:recorder forTask:deferredTask];
+    [taskManager submitTask:deferredTask];
+    
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    [self waitUntilTasksHaveEnded:[NSArray arrayWithObjects:runningTask, deferredTask, nil]];
+    GHAssertTrue(CFAbsoluteTimeGetCurrent() - startTime < 2., @"The tasks must have ended when their deadline passed");
+    
+    for (HLSTask *task in [NSArray arrayWithObjects:runningTask, deferredTask, nil]) {
+        GHAssertTrue(task.finished, @"The task must have ended");
+        GHAssertTrue(task.cancelled, @"The task must be reported as cancelled");
+        GHAssertEqualStrings([task.error domain], HLSTaskErrorDomain, @"A timeout error must be attached");
+        GHAssertTrue([task.error code] == HLSTaskErrorTimeout, @"A timeout error must be attached");
+    }
+    GHAssertEqualObjects(recorder.events, [NSArray arrayWithObject:@"cancelled"], @"The deferred task must not have been started");
+    
+    // Release the operation of the deferred task, which is still waiting in its queue
+    throttlingPolicy.deferringTasks = NO;
+    [taskManager updateThrottling];
+}
+
+- (void)testJournalResume
+{
+    HLSFileManager *previousFileManager = [HLSFileManager setDefaultManager:[[[HLSInMemoryFileManager alloc] init] autorelease]];
+    
+    // Since the run loop does not run, the end of submitted tasks cannot be recorded
+    HLSTaskManager *taskManager = [[[HLSTaskManager alloc] init] autorelease];
+    GHAssertTrue([taskManager openJournalAtPath:@"/journal" error:NULL], @"The journal must be opened");
+    SleepingTask *journaledTask = [[[SleepingTask alloc] init] autorelease];
+    journaledTask.tag = @"journaled";
+    journaledTask.userInfo = [NSDictionary dictionaryWithObject:@"value" forKey:@"key"];
+    journaledTask.executionClass = HLSTaskExecutionClassIO;
+    journaledTask.journaled = YES;
+    [taskManager submitTask:journaledTask];
+    SleepingTask *task = [[[SleepingTask alloc] init] autorelease];
+    [taskManager submitTask:task];
+    
+    // Reopen the journal as if the application had been terminated. Only the unfinished journaled task is resumed
+    HLSTaskManager *resumingTaskManager = [[[HLSTaskManager alloc] init] autorelease];
+    GHAssertTrue([resumingTaskManager openJournalAtPath:@"/journal" error:NULL], @"The journal must be opened");
+    NSArray *resumedTasks = [resumingTaskManager resumeJournaledTasks];
+    GHAssertEquals([resumedTasks count], 1U, @"The unfinished journaled task must be resumed");
+    HLSTask *resumedTask = [resumedTasks lastObject];
+    GHAssertTrue([resumedTask isKindOfClass:[SleepingTask class]], @"The task class must be restored");
+    GHAssertEqualStrings(resumedTask.tag, @"journaled", @"The tag must be restored");
+    GHAssertEqualObjects(resumedTask.userInfo, journaledTask.userInfo, @"The user information must be restored");
+    GHAssertTrue(resumedTask.executionClass == HLSTaskExecutionClassIO, @"The execution class must be restored");
+    GHAssertEquals([[resumingTaskManager resumeJournaledTasks] count], 0U, @"Tasks must only be resumed once");
+    
+    [self waitUntilTasksHaveEnded:[NSArray arrayWithObjects:journaledTask, task, resumedTask, nil]];
+    GHAssertTrue(resumedTask.finished, @"The resumed task must have ended");
+    
+    // The end of the resumed task has been recorded
+    HLSTaskManager *reopeningTaskManager = [[[HLSTaskManager alloc] init] autorelease];
+    GHAssertTrue([reopeningTaskManager openJournalAtPath:@"/journal" error:NULL], @"The journal must be opened");
+    GHAssertEquals([[reopeningTaskManager resumeJournaledTasks] count], 0U, @"An ended task must not be resumed");
+    
+    [HLSFileManager setDefaultManager:previousFileManager];
+}
+
+- (void)testJournalCorruptTail
+{
+    HLSFileManager *previousFileManager = [HLSFileManager setDefaultManager:[[[HLSInMemoryFileManager alloc] init] autorelease]];
+    
+    HLSTaskManager *taskManager = [[[HLSTaskManager alloc] init] autorelease];
+    GHAssertTrue([taskManager openJournalAtPath:@"/journal" error:NULL], @"The journal must be opened");
+    SleepingTask *task = [[[SleepingTask alloc] init] autorelease];
+    task.journaled = YES;
+    [taskManager submitTask:task];
+    
+    // Append a complete task record whose archive is garbage (identifier 1000, 4 payload bytes), then a record
+    // interrupted while it was written (announcing 64 payload bytes, only 3 of which are available)
+    const uint8_t corruptRecords[] = {
+        1, 12, 0, 0, 0, 0xe8, 0x03, 0, 0, 0, 0, 0, 0, 0xde, 0xad, 0xbe, 0xef,
+        1, 64, 0, 0, 0, 1, 2, 3
+    };
+    GHAssertTrue([[HLSFileManager defaultManager] appendContents:[NSData dataWithBytes:corruptRecords length:sizeof(corruptRecords)]
+                                                    toFileAtPath:@"/journal" 
+                                                           error:NULL], @"The journal must be writable");
+    
+    // The valid part of the journal must still be read
+    HLSTaskManager *resumingTaskManager = [[[HLSTaskManager alloc] init] autorelease];
+    GHAssertTrue([resumingTaskManager openJournalAtPath:@"/journal" error:NULL], @"A corrupt tail must not prevent opening");
+    NSArray *resumedTasks = [resumingTaskManager resumeJournaledTasks];
+    GHAssertEquals([resumedTasks count], 1U, @"The valid task record must be resumed");
+    
+    // Compaction has discarded the corrupt records. Since the journal now ends with a valid record, new records
+    // appended after it are read as well
+    HLSTaskManager *reopeningTaskManager = [[[HLSTaskManager alloc] init] autorelease];
+    GHAssertTrue([reopeningTaskManager openJournalAtPath:@"/journal" error:NULL], @"The journal must be opened");
+    NSArray *resumedAgainTasks = [reopeningTaskManager resumeJournaledTasks];
+    GHAssertEquals([resumedAgainTasks count], 1U, @"The unfinished task must be resumed again");
+    
+    [self waitUntilTasksHaveEnded:[[resumedTasks arrayByAddingObjectsFromArray:resumedAgainTasks] arrayByAddingObject:task]];
+    
+    [HLSFileManager setDefaultManager:previousFileManager];
+}
+
+- (void)testJournalCompaction
+{
+    HLSFileManager *previousFileManager = [HLSFileManager setDefaultManager:[[[HLSInMemoryFileManager alloc] init] autorelease]];
+    HLSFileManager *fileManager = [HLSFileManager defaultManager];
+    
+    HLSTaskManager *taskManager = [[[HLSTaskManager alloc] init] autorelease];
+    GHAssertTrue([taskManager openJournalAtPath:@"/journal" error:NULL], @"The journal must be opened");
+    
+    // Journaled tasks which end, as well as the tasks of a journaled task group
+    NSMutableArray *tasks = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 10; ++i) {
+        SleepingTask *task = [[[SleepingTask alloc] init] autorelease];
+        task.journaled = YES;
+        [tasks addObject:task];
+        [taskManager submitTask:task];
+    }
+    HLSTaskGroup *taskGroup = [[[HLSTaskGroup alloc] init] autorelease];
+    taskGroup.journaled = YES;
+    for (NSUInteger i = 0; i < 5; ++i) {
+        SleepingTask *task = [[[SleepingTask alloc] init] autorelease];
+        [tasks addObject:task];
+        [taskGroup addTask:task];
+    }
+    [taskManager submitTaskGroup:taskGroup];
+    [self waitUntilTasksHaveEnded:tasks];
+    
+    // One journaled task which does not end
+    SleepingTask *unfinishedTask = [[[SleepingTask alloc] init] autorelease];
+    unfinishedTask.tag = @"unfinished";
+    unfinishedTask.journaled = YES;
+    [taskManager submitTask:unfinishedTask];
+    NSUInteger length = [[fileManager contentsOfFileAtPath:@"/journal" error:NULL] length];
+    
+    // Opening the journal only keeps the record of the unfinished task
+    HLSTaskManager *reopeningTaskManager = [[[HLSTaskManager alloc] init] autorelease];
+    GHAssertTrue([reopeningTaskManager openJournalAtPath:@"/journal" error:NULL], @"The journal must be opened");
+    NSUInteger compactedLength = [[fileManager contentsOfFileAtPath:@"/journal" error:NULL] length];
+    GHAssertTrue(compactedLength < length, @"The journal must have been compacted");
+    
+    // Compacting again does not change anything
+    HLSTaskManager *resumingTaskManager = [[[HLSTaskManager alloc] init] autorelease];
+    GHAssertTrue([resumingTaskManager openJournalAtPath:@"/journal" error:NULL], @"The journal must be opened");
+    GHAssertEquals([[fileManager contentsOfFileAtPath:@"/journal" error:NULL] length], compactedLength, 
+                   @"Only unfinished work must be kept");
+    NSArray *resumedTasks = [resumingTaskManager resumeJournaledTasks];
+    GHAssertEquals([resumedTasks count], 1U, @"Only the unfinished task must be resumed");
+    GHAssertEqualStrings([[resumedTasks lastObject] tag], @"unfinished", @"Only the unfinished task must be resumed");
+    
+    [self waitUntilTasksHaveEnded:[resumedTasks arrayByAddingObject:unfinishedTask]];
+    
+    [HLSFileManager setDefaultManager:previousFileManager];
+}
+
+#pragma mark Helpers
+
+- (void)waitUntilTasksHaveEnded:(NSArray *)tasks
+{
+    NSDate *timeoutDate = [NSDate dateWithTimeIntervalSinceNow:10.];
+    while ([[tasks valueForKeyPath:@"@sum.finished"] unsignedIntegerValue] != [tasks count]
+           && [timeoutDate timeIntervalSinceNow] > 0.) {
+        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    }
+}
+
+- (void)checkEventsOfRecorder:(TaskEventRecorder *)recorder
+{
+    // Start first, end last, progress in between
+    NSArray *events = recorder.events;
+    GHAssertTrue([events count] >= 3, @"Start, progress and end must have been notified");
+    GHAssertEqualStrings([events objectAtIndex:0], @"started", @"The start must be notified first");
+    GHAssertEqualStrings([events lastObject], @"processed", @"The end must be notified last");
+    for (NSUInteger i = 1; i < [events count] - 1; ++i) {
+        GHAssertEqualStrings([events objectAtIndex:i], @"progress", @"Only progress must be notified in between");
+    }
+    
+    // Progress values are received in order
+    float lastProgress = 0.f;
+    for (NSNumber *progressValue in recorder.progressValues) {
+        GHAssertTrue([progressValue floatValue] >= lastProgress, @"Progress values must be received in order");
+        lastProgress = [progressValue floatValue];
+    }
+}
+
+@end
+
+@implementation BenchmarkTask
+
+#pragma mark Accessors and mutators
+
+- (Class)operationClass
+{
+    return [BenchmarkTaskOperation class];
+}
+
+@end
+
+@implementation BenchmarkTaskOperation
+
+#pragma mark Overrides
+
+- (void)operationMain
+{
+    // Nothing to do, only the task management overhead is measured
+}
+
+@end
+
+@implementation CachedTask
+
+#pragma mark Accessors and mutators
+
+- (Class)operationClass
+{
+    return [CachedTaskOperation class];
+}
+
+- (id)resultCacheKey
+{
+    return self.userInfo;
+}
+
+@end
+
+@implementation CachedTaskOperation
+
+#pragma mark Overrides
+
+- (void)operationMain
+{
+    OSAtomicIncrement32Barrier(&s_cachedTaskProcessingCount);
+    
+    // Long enough for identical tasks to be submitted while the task is running
+    [NSThread sleepForTimeInterval:0.1];
+    
+    [self attachReturnInfo:[NSDictionary dictionaryWithObject:[NSDate date] forKey:@"date"]];
+}
+
+@end
+
+@implementation CancellableTask
+
+#pragma mark Accessors and mutators
+
+- (Class)operationClass
+{
+    return [CancellableTaskOperation class];
+}
+
+@end
+
+@implementation CancellableTaskOperation
+
+#pragma mark Overrides
+
+- (void)operationMain
+{
+    // Run until cancelled (at most 5 seconds so that a failing test does not block forever)
+    NSDate *endDate = [NSDate dateWithTimeIntervalSinceNow:5.];
+    while (! [self isCancelled] && [endDate timeIntervalSinceNow] > 0.) {
+        [NSThread sleepForTimeInterval:0.01];
+    }
+}
+
+@end
+
+@implementation CountingBatchTask
+
+#pragma mark Object creation and destruction
+
+- (id)initWithRange:(NSRange)range
+{
+    if ((self = [super initWithRange:range])) {
+        _counters = calloc(range.length, sizeof(int32_t));
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    free((void *)_counters);
+    [super dealloc];
+}
+
+#pragma mark Accessors and mutators
+
+- (int32_t)counterAtIndex:(NSUInteger)index
+{
+    return _counters[index - self.range.location];
+}
+
+#pragma mark Overrides
+
+- (void)processItemAtIndex:(NSUInteger)index
+{
+    // Items have very different costs, so that workers need to steal from each other
+    volatile NSUInteger dummy = 0;
+    for (NSUInteger i = 0; i < index % 1000; ++i) {
+        ++dummy;
+    }
+    
+    OSAtomicIncrement32Barrier(&_counters[index - self.range.location]);
+}
+
+@end
+
+@implementation ProgressTask
+
+#pragma mark Accessors and mutators
+
+- (Class)operationClass
+{
+    return [ProgressTaskOperation class];
+}
+
+@end
+
+@implementation ProgressTaskOperation
+
+#pragma mark Overrides
+
+- (void)operationMain
+{
+    for (NSUInteger i = 1; i <= 4; ++i) {
+        [self updateProgressToValue:i / 4.f];
+    }
+}
+
+@end
+
+@implementation SleepingTask
+
+#pragma mark Accessors and mutators
+
+- (Class)operationClass
+{
+    return [SleepingTaskOperation class];
+}
+
+@end
+
+@implementation SleepingTaskOperation
+
+#pragma mark Overrides
+
+- (void)operationMain
+{
+    // Record the maximum number of operations running concurrently
+    int32_t runningTaskCount = OSAtomicIncrement32Barrier(&s_runningSleepingTaskCount);
+    int32_t maxRunningTaskCount = s_maxRunningSleepingTaskCount;
+    while (runningTaskCount > maxRunningTaskCount 
+           && ! OSAtomicCompareAndSwap32Barrier(maxRunningTaskCount, runningTaskCount, &s_maxRunningSleepingTaskCount)) {
+        maxRunningTaskCount = s_maxRunningSleepingTaskCount;
+    }
+    
+    [NSThread sleepForTimeInterval:0.05];
+    
+    OSAtomicDecrement32Barrier(&s_runningSleepingTaskCount);
+}
+
+@end
+
+@implementation ThrottlingTestPolicy
+
+#pragma mark Accessors and mutators
+
+@synthesize concurrencyFactor = _concurrencyFactor;
+
+@synthesize deferringTasks = _deferringTasks;
+
+#pragma mark Overrides
+
+- (float)concurrencyFactorForExecutionClass:(HLSTaskExecutionClass)executionClass
+{
+    return self.concurrencyFactor;
+}
+
+- (BOOL)shouldDeferTasks
+{
+    return self.deferringTasks;
+}
+
+@end
+
+@implementation TaskEventRecorder
+
+#pragma mark Object creation and destruction
+
+- (id)initWithExpectedQueue:(dispatch_queue_t)expectedQueue
+{
+    if ((self = [super init])) {
+        _expectedQueue = expectedQueue;
+        dispatch_retain(_expectedQueue);
+        _events = [[NSMutableArray alloc] init];
+        _progressValues = [[NSMutableArray alloc] init];
+        _deliveredOnExpectedQueue = YES;
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    dispatch_release(_expectedQueue);
+    [_events release];
+    [_progressValues release];
+    [super dealloc];
+}
+
+#pragma mark Accessors and mutators
+
+- (NSArray *)events
+{
+    @synchronized(self) {
+        return [NSArray arrayWithArray:_events];
+    }
+}
+
+- (NSArray *)progressValues
+{
+    @synchronized(self) {
+        return [NSArray arrayWithArray:_progressValues];
+    }
+}
+
+- (BOOL)deliveredOnExpectedQueue
+{
+    @synchronized(self) {
+        return _deliveredOnExpectedQueue;
+    }
+}
+
+- (BOOL)isFinished
+{
+    @synchronized(self) {
+        return _finished;
+    }
+}
+
+#pragma mark Recording events
+
+- (void)recordEvent:(NSString *)event
+{
+    @synchronized(self) {
+        if (dispatch_get_current_queue() != _expectedQueue) {
+            _deliveredOnExpectedQueue = NO;
+        }
+        [_events addObject:event];
+    }
+}
+
+#pragma mark HLSTaskDelegate protocol implementation
+
+- (void)taskHasStartedProcessing:(HLSTask *)task
+{
+    [self recordEvent:@"started"];
+}
+
+- (void)taskProgressUpdated:(HLSTask *)task
+{
+    [self recordEvent:@"progress"];
+    @synchronized(self) {
+        [_progressValues addObject:[NSNumber numberWithFloat:task.progress]];
+    }
+}
+
+- (void)taskHasBeenProcessed:(HLSTask *)task
+{
+    [self recordEvent:@"processed"];
+    @synchronized(self) {
+        _finished = YES;
+    }
+}
+
+- (void)taskHasBeenCancelled:(HLSTask *)task
+{
+    [self recordEvent:@"cancelled"];
+    @synchronized(self) {
+        _finished = YES;
+    }
+}
+
+@end
@@ -0,0 +1,94 @@
+//
+//  HLSURLTaskTestCase.m
+//  CoconutKit-test
+//
+//  Created by Samuel Défago on 15.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSURLTaskTestCase.h"
+
+@interface HLSURLTaskTestCase ()
+
+- (NSURL *)sourceFileURLWithContents:(NSData *)contents;
+- (void)runTask:(HLSURLTask *)URLTask;
+
+@end
+
+@implementation HLSURLTaskTestCase
+
+#pragma mark Test setup and tear down
+
+- (BOOL)shouldRunOnMainThread
+{
+    // Task status notifications are delivered through the run loop of the thread tasks are submitted from
+    return YES;
+}
+
+#pragma mark Tests
+
+- (void)testDownloadToFile
+{
+    NSData *contents = [@"Downloaded contents" dataUsingEncoding:NSUTF8StringEncoding];
+    NSURL *sourceFileURL = [self sourceFileURLWithContents:contents];
+    
+    // Longer existing contents must be entirely replaced
+    NSString *downloadFilePath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"HLSURLTaskTestCase-download.txt"];
+    NSData *previousContents = [@"Previous contents, longer than the downloaded contents" dataUsingEncoding:NSUTF8StringEncoding];
+    [previousContents writeToFile:downloadFilePath atomically:YES];
+    
+    HLSURLTask *URLTask = [[[HLSURLTask alloc] initWithRequest:[NSURLRequest requestWithURL:sourceFileURL]] autorelease];
+    URLTask.downloadFilePath = downloadFilePath;
+    URLTask.fileManager = [[[HLSStandardFileManager alloc] init] autorelease];
+    [self runTask:URLTask];
+    
+    GHAssertNil(URLTask.error, @"No error expected");
+    GHAssertNil([URLTask.returnInfo objectForKey:HLSURLTaskDataKey], @"Data must not be returned in memory");
+    GHAssertEqualObjects([NSData dataWithContentsOfFile:downloadFilePath], contents, @"Downloaded contents");
+    
+    [[NSFileManager defaultManager] removeItemAtPath:downloadFilePath error:NULL];
+    [[NSFileManager defaultManager] removeItemAtURL:sourceFileURL error:NULL];
+}
+
+- (void)testDownloadToInMemoryFile
+{
+    NSData *contents = [@"Downloaded contents" dataUsingEncoding:NSUTF8StringEncoding];
+    NSURL *sourceFileURL = [self sourceFileURLWithContents:contents];
+    
+    // Streaming writes are not supported by the in-memory file manager. The task must fail with an error
+    HLSInMemoryFileManager *fileManager = [[[HLSInMemoryFileManager alloc] init] autorelease];
+    HLSURLTask *URLTask = [[[HLSURLTask alloc] initWithRequest:[NSURLRequest requestWithURL:sourceFileURL]] autorelease];
+    URLTask.downloadFilePath = @"/download.txt";
+    URLTask.fileManager = fileManager;
+    [self runTask:URLTask];
+    
+    GHAssertEqualStrings([URLTask.error domain], HLSURLTaskErrorDomain, @"Error domain");
+    GHAssertEquals([URLTask.error code], (NSInteger)HLSURLTaskErrorFileWrite, @"Error code");
+    GHAssertEqualStrings([[URLTask.error userInfo] objectForKey:NSFilePathErrorKey], @"/download.txt", @"Failing path");
+    GHAssertFalse([fileManager fileExistsAtPath:@"/download.txt"], @"No file must have been written");
+    
+    [[NSFileManager defaultManager] removeItemAtURL:sourceFileURL error:NULL];
+}
+
+#pragma mark Helpers
+
+- (NSURL *)sourceFileURLWithContents:(NSData *)contents
+{
+    NSString *sourceFilePath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"HLSURLTaskTestCase-source.txt"];
+    [contents writeToFile:sourceFilePath atomically:YES];
+    return [NSURL fileURLWithPath:sourceFilePath];
+}
+
+- (void)runTask:(HLSURLTask *)URLTask
+{
+    HLSTaskManager *taskManager = [[[HLSTaskManager alloc] init] autorelease];
+    [taskManager submitTask:URLTask];
+    
+    NSDate *timeoutDate = [NSDate dateWithTimeIntervalSinceNow:10.];
+    while (! URLTask.finished && [timeoutDate timeIntervalSinceNow] > 0.) {
+        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    }
+    GHAssertTrue(URLTask.finished, @"The task must have ended");
+}
+
+@end
@@ -0,0 +1,14 @@
+//
+//  HLSSlideshowTestCase.h
+//  CoconutKit-test
+//
+//  Created by Samuel Défago on 15.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+@interface HLSSlideshowTestCase : GHTestCase {
+@private
+    
+}
+
+@end
@@ -0,0 +1,262 @@
+//
+//  HLSSlideshowTestCase.m
+//  CoconutKit-test
+//
+//  Created by Samuel Défago on 15.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSSlideshowTestCase.h"
+
+static NSString * const kSlideshowTestHost = @"hlsslideshowtestcase.test";
+
+// Requests whose path starts with this prefix receive part of the image, but never complete
+static NSString * const kSlideshowTestStalledPathPrefix = @"/stalled";
+
+// The image served for all requests
+static NSData *s_imageData = nil;
+
+/**
+ * Serve the requests made to kSlideshowTestHost locally, so that downloads can be tested without network
+ */
+@interface SlideshowTestURLProtocol : NSURLProtocol
+
+@end
+
+@interface HLSSlideshow (HLSSlideshowTestCase)
+
+@property (nonatomic, readonly, retain) NSMutableArray *upcomingImageIndexes;
+@property (nonatomic, readonly, retain) NSMutableDictionary *downloadTasks;
+@property (nonatomic, readonly, retain) NSMutableArray *remoteImageFileNames;
+
+- (NSString *)remoteImageFilePathForNameOrPath:(NSString *)imageNameOrPath;
+- (BOOL)isImageAvailableWithNameOrPath:(NSString *)imageNameOrPath;
+- (void)touchRemoteImageWithNameOrPath:(NSString *)imageNameOrPath;
+- (void)trimRemoteImageCacheKeepingImageNamesOrPaths:(NSArray *)imageNamesOrPaths;
+
+@end
+
+@interface HLSSlideshowTestCase ()
+
+- (NSString *)cacheDirectoryPath;
+- (NSArray *)imageURLStringsWithPath:(NSString *)path count:(NSUInteger)count;
+- (NSString *)downloadFilePathForImageURLString:(NSString *)imageURLString slideshow:(HLSSlideshow *)slideshow;
+
+@end
+
+@implementation HLSSlideshowTestCase
+
+#pragma mark Test setup and tear down
+
+- (BOOL)shouldRunOnMainThread
+{
+    // Download notifications are delivered on the main thread
+    return YES;
+}
+
+- (void)setUpClass
+{
+    [super setUpClass];
+    
+    UIGraphicsBeginImageContext(CGSizeMake(4.f, 4.f));
+    UIImage *image = UIGraphicsGetImageFromCurrentImageContext();
+    UIGraphicsEndImageContext();
+    s_imageData = [UIImagePNGRepresentation(image) retain];
+    
+    [NSURLProtocol registerClass:[SlideshowTestURLProtocol class]];
+}
+
+- (void)tearDownClass
+{
+    [NSURLProtocol unregisterClass:[SlideshowTestURLProtocol class]];
+    [s_imageData release];
+    s_imageData = nil;
+    
+    [super tearDownClass];
+}
+
+- (void)setUp
+{
+    [super setUp];
+    
+    [[NSFileManager defaultManager] removeItemAtPath:[self cacheDirectoryPath] error:NULL];
+}
+
+- (void)tearDown
+{
+    [[NSFileManager defaultManager] removeItemAtPath:[self cacheDirectoryPath] error:NULL];
+    
+    [super tearDown];
+}
+
+#pragma mark Tests
+
+- (void)testPrefetchQueue
+{
+    HLSSlideshow *slideshow = [[[HLSSlideshow alloc] initWithFrame:CGRectMake(0.f, 0.f, 320.f, 480.f)] autorelease];
+    slideshow.remoteImageCacheDirectoryPath = [self cacheDirectoryPath];
+    slideshow.remoteImagePrefetchCount = 2;
+    NSArray *imageURLStrings = [self imageURLStringsWithPath:@"/image" count:6];
+    slideshow.imageNamesOrPaths = imageURLStrings;
+    [slideshow play];
+    
+    // The current and next images are displayed first, followed by the queued ones, in display order
+    GHAssertEquals([slideshow.upcomingImageIndexes count], 2U, @"Upcoming images");
+    GHAssertEquals([[slideshow.upcomingImageIndexes objectAtIndex:0] integerValue], 2, @"First upcoming image");
+    GHAssertEquals([[slideshow.upcomingImageIndexes objectAtIndex:1] integerValue], 3, @"Second upcoming image");
+    
+    // Only the images in this window are downloaded
+    NSSet *downloadedImageURLStrings = [NSSet setWithArray:[imageURLStrings subarrayWithRange:NSMakeRange(0, 4)]];
+    GHAssertEqualObjects([NSSet setWithArray:[slideshow.downloadTasks allKeys]], downloadedImageURLStrings, @"Downloads");
+    
+    NSDate *timeoutDate = [NSDate dateWithTimeIntervalSinceNow:10.];
+    while ([slideshow.downloadTasks count] != 0 && [timeoutDate timeIntervalSinceNow] > 0.) {
+        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    }
+    GHAssertEquals([slideshow.downloadTasks count], 0U, @"All downloads must have ended");
+    
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    for (NSString *imageURLString in imageURLStrings) {
+        NSString *filePath = [slideshow remoteImageFilePathForNameOrPath:imageURLString];
+        if ([downloadedImageURLStrings containsObject:imageURLString]) {
+            GHAssertTrue([fileManager fileExistsAtPath:filePath], @"Downloaded image %@", imageURLString);
+        }
+        else {
+            GHAssertFalse([fileManager fileExistsAtPath:filePath], @"Image %@ not downloaded", imageURLString);
+        }
+        GHAssertFalse([fileManager fileExistsAtPath:[self downloadFilePathForImageURLString:imageURLString slideshow:slideshow]], 
+                      @"No temporary file left");
+    }
+    
+    [slideshow stop];
+}
+
+- (void)testCancelledDownloads
+{
+    HLSSlideshow *slideshow = [[[HLSSlideshow alloc] initWithFrame:CGRectMake(0.f, 0.f, 320.f, 480.f)] autorelease];
+    slideshow.remoteImageCacheDirectoryPath = [self cacheDirectoryPath];
+    slideshow.remoteImagePrefetchCount = 1;
+    NSArray *imageURLStrings = [self imageURLStringsWithPath:kSlideshowTestStalledPathPrefix count:3];
+    slideshow.imageNamesOrPaths = imageURLStrings;
+    [slideshow play];
+    
+    // Wait until the first image has been partially downloaded
+    NSString *downloadFilePath = [self downloadFilePathForImageURLString:[imageURLStrings objectAtIndex:0] slideshow:slideshow];
+    NSDate *timeoutDate = [NSDate dateWithTimeIntervalSinceNow:10.];
+    while (! [[NSFileManager defaultManager] fileExistsAtPath:downloadFilePath] && [timeoutDate timeIntervalSinceNow] > 0.) {
+        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    }
+    GHAssertTrue([[NSFileManager defaultManager] fileExistsAtPath:downloadFilePath], @"Partial download");
+    
+    // Cancelled downloads leave no temporary file behind
+    [slideshow stop];
+    GHAssertEquals([slideshow.downloadTasks count], 0U, @"Downloads cancelled");
+    for (NSString *imageURLString in imageURLStrings) {
+        GHAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:[self downloadFilePathForImageURLString:imageURLString slideshow:slideshow]], 
+                      @"No temporary file left");
+    }
+}
+
+- (void)testEviction
+{
+    HLSSlideshow *slideshow = [[[HLSSlideshow alloc] initWithFrame:CGRectMake(0.f, 0.f, 320.f, 480.f)] autorelease];
+    slideshow.remoteImageCacheDirectoryPath = [self cacheDirectoryPath];
+    slideshow.remoteImageCacheCapacity = 2;
+    
+    // Images downloaded by a previous run, and an incomplete download
+    NSArray *imageURLStrings = [self imageURLStringsWithPath:@"/image" count:3];
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    [fileManager createDirectoryAtPath:[self cacheDirectoryPath] withIntermediateDirectories:YES attributes:nil error:NULL];
+    for (NSString *imageURLString in imageURLStrings) {
+        [s_imageData writeToFile:[slideshow remoteImageFilePathForNameOrPath:imageURLString] atomically:YES];
+    }
+    NSString *incompleteImageURLString = [NSString stringWithFormat:@"http://%@/incomplete", kSlideshowTestHost];
+    NSString *incompleteDownloadFilePath = [self downloadFilePathForImageURLString:incompleteImageURLString slideshow:slideshow];
+    [s_imageData writeToFile:incompleteDownloadFilePath atomically:YES];
+    
+    // Incomplete downloads are discarded when the cache is loaded
+    GHAssertTrue([slideshow isImageAvailableWithNameOrPath:[imageURLStrings objectAtIndex:0]], @"Downloaded by a previous run");
+    GHAssertFalse([slideshow isImageAvailableWithNameOrPath:incompleteImageURLString], @"Incomplete");
+    GHAssertFalse([fileManager fileExistsAtPath:incompleteDownloadFilePath], @"Incomplete download removed");
+    
+    // Displayed in this order, the first image is now the least recently used one
+    for (NSString *imageURLString in imageURLStrings) {
+        [slideshow touchRemoteImageWithNameOrPath:imageURLString];
+    }
+    NSMutableArray *fileNames = [NSMutableArray array];
+    for (NSString *imageURLString in imageURLStrings) {
+        [fileNames addObject:[imageURLString md5hash]];
+    }
+    GHAssertEqualObjects(slideshow.remoteImageFileNames, fileNames, @"Least recently used first");
+    
+    // The least recently used image which is not kept is evicted first
+    NSString *keptImageURLString = [imageURLStrings objectAtIndex:0];
+    NSString *evictedImageURLString = [imageURLStrings objectAtIndex:1];
+    [slideshow trimRemoteImageCacheKeepingImageNamesOrPaths:[NSArray arrayWithObject:keptImageURLString]];
+    GHAssertEquals([slideshow.remoteImageFileNames count], 2U, @"Capacity");
+    GHAssertTrue([fileManager fileExistsAtPath:[slideshow remoteImageFilePathForNameOrPath:keptImageURLString]], @"Kept");
+    GHAssertFalse([fileManager fileExistsAtPath:[slideshow remoteImageFilePathForNameOrPath:evictedImageURLString]], @"Evicted");
+    GHAssertTrue([fileManager fileExistsAtPath:[slideshow remoteImageFilePathForNameOrPath:[imageURLStrings objectAtIndex:2]]], 
+                 @"Most recently used");
+}
+
+#pragma mark Helpers
+
+- (NSString *)cacheDirectoryPath
+{
+    return [NSTemporaryDirectory() stringByAppendingPathComponent:@"HLSSlideshowTestCase"];
+}
+
+- (NSArray *)imageURLStringsWithPath:(NSString *)path count:(NSUInteger)count
+{
+    NSMutableArray *imageURLStrings = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; ++i) {
+        [imageURLStrings addObject:[NSString stringWithFormat:@"http://%@%@%d.png", kSlideshowTestHost, path, i]];
+    }
+    return [NSArray arrayWithArray:imageURLStrings];
+}
+
+- (NSString *)downloadFilePathForImageURLString:(NSString *)imageURLString slideshow:(HLSSlideshow *)slideshow
+{
+    return [[slideshow remoteImageFilePathForNameOrPath:imageURLString] stringByAppendingPathExtension:@"download"];
+}
+
+@end
+
+@implementation SlideshowTestURLProtocol
+
++ (BOOL)canInitWithRequest:(NSURLRequest *)request
+{
+    return [[[request URL] host] isEqualToString:kSlideshowTestHost];
+}
+
++ (NSURLRequest *)canonicalRequestForRequest:(NSURLRequest *)request
+{
+    return request;
+}
+
+- (void)startLoading
+{
+    NSDictionary *headerFields = [NSDictionary dictionaryWithObject:[NSString stringWithFormat:@"%d", [s_imageData length]] 
+                                                             forKey:@"Content-Length"];
+    NSHTTPURLResponse *response = [[[NSHTTPURLResponse alloc] initWithURL:[[self request] URL]
+                                                               statusCode:200
+                                                              HTTPVersion:@"HTTP/1.1"
+                                                             headerFields:headerFields] autorelease];
+    [[self client] URLProtocol:self didReceiveResponse:response cacheStoragePolicy:NSURLCacheStorageNotAllowed];
+    
+    if ([[[[self request] URL] path] hasPrefix:kSlideshowTestStalledPathPrefix]) {
+        [[self client] URLProtocol:self didLoadData:[s_imageData subdataWithRange:NSMakeRange(0, [s_imageData length] / 2)]];
+        return;
+    }
+    
+    [[self client] URLProtocol:self didLoadData:s_imageData];
+    [[self client] URLProtocolDidFinishLoading:self];
+}
+
+- (void)stopLoading
+{
+
+}
+
+@end
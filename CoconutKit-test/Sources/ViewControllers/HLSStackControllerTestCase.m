@@ -0,0 +1,461 @@
+//
+//  HLSStackControllerTestCase.m
+//  CoconutKit-test
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSStackControllerTestCase.h"
+
+static const NSUInteger kBenchmarkViewControllerCount = 1000;
+static const NSUInteger kBenchmarkAccessorCallCount = 100000;
+
+@interface ReusableTestViewController : UIViewController <HLSReusableViewController> {
+@private
+    NSUInteger m_prepareForReuseCount;
+}
+
+@property (nonatomic, readonly, assign) NSUInteger prepareForReuseCount;
+
+@end
+
+@implementation ReusableTestViewController
+
+@synthesize prepareForReuseCount = m_prepareForReuseCount;
+
+- (void)prepareForReuse
+{
+    ++m_prepareForReuseCount;
+}
+
+@end
+
+@implementation HLSStackControllerTestCase
+
+#pragma mark Test setup and tear down
+
+- (BOOL)shouldRunOnMainThread
+{
+    // View controllers must be manipulated on the main thread
+    return YES;
+}
+
+#pragma mark Tests
+
+- (void)testPushPopBenchmark
+{
+    UIViewController *rootViewController = [[[UIViewController alloc] init] autorelease];
+    HLSStackController *stackController = [[[HLSStackController alloc] initWithRootViewController:rootViewController] autorelease];
+    
+    // Display the stack controller so that its children go through their whole view lifecycle
+    UIWindow *window = [[[UIWindow alloc] initWithFrame:[UIScreen mainScreen].bounds] autorelease];
+    [window addSubview:stackController.view];
+    [stackController viewWillAppear:NO];
+    [stackController viewDidAppear:NO];
+    
+    NSMutableArray *viewControllers = [NSMutableArray arrayWithCapacity:kBenchmarkViewControllerCount];
+    for (NSUInteger i = 0; i < kBenchmarkViewControllerCount; ++i) {
+        [viewControllers addObject:[[[UIViewController alloc] init] autorelease]];
+    }
+    
+    CFAbsoluteTime pushStartTime = CFAbsoluteTimeGetCurrent();
+    for (UIViewController *viewController in viewControllers) {
+        [stackController pushViewController:viewController withTransitionClass:[HLSTransitionNone class] animated:NO];
+    }
+    CFTimeInterval pushDuration = CFAbsoluteTimeGetCurrent() - pushStartTime;
+    GHTestLog(@"Pushed %d view controllers in %.3f s", kBenchmarkViewControllerCount, pushDuration);
+    
+    GHAssertEquals([stackController.viewControllers count], kBenchmarkViewControllerCount + 1, @"Count");
+    GHAssertEquals([[viewControllers lastObject] lifeCyclePhase], HLSViewControllerLifeCyclePhaseViewDidAppear, @"Phase");
+    
+    CFAbsoluteTime popStartTime = CFAbsoluteTimeGetCurrent();
+    for (NSUInteger i = 0; i < kBenchmarkViewControllerCount; ++i) {
+        [stackController popViewControllerAnimated:NO];
+    }
+    CFTimeInterval popDuration = CFAbsoluteTimeGetCurrent() - popStartTime;
+    GHTestLog(@"Popped %d view controllers in %.3f s", kBenchmarkViewControllerCount, popDuration);
+    
+    GHAssertEquals([stackController.viewControllers count], (NSUInteger)1, @"Count");
+    GHAssertEquals([rootViewController lifeCyclePhase], HLSViewControllerLifeCyclePhaseViewDidAppear, @"Phase");
+    
+    [stackController viewWillDisappear:NO];
+    [stackController viewDidDisappear:NO];
+    [stackController.view removeFromSuperview];
+}
+
+- (void)testViewControllerReuse
+{
+    [HLSContainerStack purgeReusableViewControllers];
+    
+    UIViewController *rootViewController = [[[UIViewController alloc] init] autorelease];
+    HLSStackController *stackController = [[[HLSStackController alloc] initWithRootViewController:rootViewController] autorelease];
+    
+    UIWindow *window = [[[UIWindow alloc] initWithFrame:[UIScreen mainScreen].bounds] autorelease];
+    [window addSubview:stackController.view];
+    [stackController viewWillAppear:NO];
+    [stackController viewDidAppear:NO];
+    
+    GHAssertNil([HLSContainerStack dequeueReusableViewControllerOfClass:[ReusableTestViewController class]], @"Empty pool");
+    
+    // Popped reusable view controllers are recycled with their view loaded
+    ReusableTestViewController *viewController = [[[ReusableTestViewController alloc] init] autorelease];
+    [stackController pushViewController:viewController withTransitionClass:[HLSTransitionNone class] animated:NO];
+    UIView *view = viewController.view;
+    [stackController popViewControllerAnimated:NO];
+    
+    ReusableTestViewController *reusedViewController = [HLSContainerStack dequeueReusableViewControllerOfClass:[ReusableTestViewController class]];
+    GHAssertEquals(reusedViewController, viewController, @"Reused");
+    GHAssertEquals([reusedViewController prepareForReuseCount], (NSUInteger)1, @"Prepared");
+    GHAssertTrue([reusedViewController isViewLoaded], @"View loaded");
+    GHAssertEquals(reusedViewController.view, view, @"Same view");
+    GHAssertNil([HLSContainerStack dequeueReusableViewControllerOfClass:[ReusableTestViewController class]], @"Dequeued once");
+    
+    // The view controller can be pushed again
+    [stackController pushViewController:reusedViewController withTransitionClass:[HLSTransitionNone class] animated:NO];
+    GHAssertEquals([stackController topViewController], (UIViewController *)reusedViewController, @"Pushed again");
+    GHAssertEquals([reusedViewController lifeCyclePhase], HLSViewControllerLifeCyclePhaseViewDidAppear, @"Phase");
+    
+    // Non-reusable view controllers are not kept
+    [stackController popViewControllerAnimated:NO];
+    [stackController pushViewController:[[[UIViewController alloc] init] autorelease] withTransitionClass:[HLSTransitionNone class] animated:NO];
+    [stackController popViewControllerAnimated:NO];
+    GHAssertNil([HLSContainerStack dequeueReusableViewControllerOfClass:[UIViewController class]], @"Not reusable");
+    
+    // Memory warnings empty the pool
+    [[NSNotificationCenter defaultCenter] postNotificationName:UIApplicationDidReceiveMemoryWarningNotification object:nil];
+    GHAssertNil([HLSContainerStack dequeueReusableViewControllerOfClass:[ReusableTestViewController class]], @"Purged");
+    
+    // Batched updates are only available from the underlying container stack
+    HLSContainerStack *containerStack = [stackController valueForKey:@"containerStack"];
+    UIViewController *viewController1 = [[[UIViewController alloc] init] autorelease];
+    UIViewController *viewController2 = [[[UIViewController alloc] init] autorelease];
+    UIViewController *topViewController = [[[UIViewController alloc] init] autorelease];
+    [stackController pushViewController:viewController withTransitionClass:[HLSTransitionNone class] animated:NO];
+    [stackController pushViewController:viewController1 withTransitionClass:[HLSTransitionNone class] animated:NO];
+    [stackController pushViewController:viewController2 withTransitionClass:[HLSTransitionNone class] animated:NO];
+    [stackController pushViewController:topViewController withTransitionClass:[HLSTransitionNone class] animated:NO];
+    
+    // A reusable view controller moved below the top is removed and inserted again, but not recycled
+    [containerStack beginUpdates];
+    [containerStack removeViewController:viewController animated:NO];
+    [containerStack insertViewController:viewController
+                                 atIndex:3
+                     withTransitionClass:[HLSTransitionNone class]
+                                duration:kAnimationTransitionDefaultDuration
+                                animated:NO];
+    [containerStack endUpdatesAnimated:NO];
+    
+    NSArray *expectedViewControllers = [NSArray arrayWithObjects:rootViewController, viewController1, viewController2,
+                                        viewController, topViewController, nil];
+    GHAssertEqualObjects([stackController viewControllers], expectedViewControllers, @"Moved below the top");
+    GHAssertEquals([viewController parentViewController], (UIViewController *)stackController, @"Still contained");
+    GHAssertNil([HLSContainerStack dequeueReusableViewControllerOfClass:[ReusableTestViewController class]], @"Not recycled when moved");
+    
+    // Same when the reusable view controller is moved while popping to a view controller below it
+    [containerStack beginUpdates];
+    [containerStack popViewControllerAnimated:NO];
+    [containerStack removeViewController:viewController animated:NO];
+    [containerStack insertViewController:viewController
+                                 atIndex:1
+                     withTransitionClass:[HLSTransitionNone class]
+                                duration:kAnimationTransitionDefaultDuration
+                                animated:NO];
+    [containerStack endUpdatesAnimated:NO];
+    
+    expectedViewControllers = [NSArray arrayWithObjects:rootViewController, viewController, viewController1, viewController2, nil];
+    GHAssertEqualObjects([stackController viewControllers], expectedViewControllers, @"Moved when popping");
+    GHAssertEquals([viewController parentViewController], (UIViewController *)stackController, @"Still contained");
+    GHAssertNil([HLSContainerStack dequeueReusableViewControllerOfClass:[ReusableTestViewController class]], @"Not recycled when popping");
+    
+    // A recycled view controller installed again without being dequeued leaves the reuse pool
+    [stackController popToRootViewControllerAnimated:NO];
+    [stackController pushViewController:viewController withTransitionClass:[HLSTransitionNone class] animated:NO];
+    GHAssertNil([HLSContainerStack dequeueReusableViewControllerOfClass:[ReusableTestViewController class]], @"Installed again");
+    [stackController popViewControllerAnimated:NO];
+    [HLSContainerStack purgeReusableViewControllers];
+    
+    [stackController viewWillDisappear:NO];
+    [stackController viewDidDisappear:NO];
+    [stackController.view removeFromSuperview];
+}
+
+- (void)testBatchedPushAndPop
+{
+    UIViewController *rootViewController = [[[UIViewController alloc] init] autorelease];
+    HLSStackController *stackController = [[[HLSStackController alloc] initWithRootViewController:rootViewController] autorelease];
+    
+    UIWindow *window = [[[UIWindow alloc] initWithFrame:[UIScreen mainScreen].bounds] autorelease];
+    [window addSubview:stackController.view];
+    [stackController viewWillAppear:NO];
+    [stackController viewDidAppear:NO];
+    
+    // Batched updates are only available from the underlying container stack
+    HLSContainerStack *containerStack = [stackController valueForKey:@"containerStack"];
+    
+    // A view controller pushed and popped within the same batch is neither loaded nor displayed
+    UIViewController *viewController = [[[UIViewController alloc] init] autorelease];
+    [containerStack beginUpdates];
+    [containerStack pushViewController:viewController
+                   withTransitionClass:[HLSTransitionCoverFromBottom class]
+                              duration:kAnimationTransitionDefaultDuration
+                              animated:YES];
+    GHAssertEquals([containerStack topViewController], viewController, @"Recorded");
+    [containerStack popViewControllerAnimated:YES];
+    [containerStack endUpdatesAnimated:YES];
+    
+    GHAssertEqualObjects([stackController viewControllers], [NSArray arrayWithObject:rootViewController], @"No change");
+    GHAssertFalse([viewController isViewLoaded], @"Not loaded");
+    GHAssertTrue([viewController lifeCyclePhase] == HLSViewControllerLifeCyclePhaseInitialized, @"No view lifecycle events");
+    GHAssertTrue([rootViewController lifeCyclePhase] == HLSViewControllerLifeCyclePhaseViewDidAppear, @"Still displayed");
+    
+    [stackController viewWillDisappear:NO];
+    [stackController viewDidDisappear:NO];
+    [stackController.view removeFromSuperview];
+}
+
+- (void)testBatchedPopToViewController
+{
+    UIViewController *rootViewController = [[[UIViewController alloc] init] autorelease];
+    HLSStackController *stackController = [[[HLSStackController alloc] initWithRootViewController:rootViewController] autorelease];
+    
+    UIWindow *window = [[[UIWindow alloc] initWithFrame:[UIScreen mainScreen].bounds] autorelease];
+    [window addSubview:stackController.view];
+    [stackController viewWillAppear:NO];
+    [stackController viewDidAppear:NO];
+    
+    // Batched updates are only available from the underlying container stack
+    HLSContainerStack *containerStack = [stackController valueForKey:@"containerStack"];
+    UIViewController *viewController1 = [[[UIViewController alloc] init] autorelease];
+    UIViewController *viewController2 = [[[UIViewController alloc] init] autorelease];
+    UIViewController *viewController3 = [[[UIViewController alloc] init] autorelease];
+    [stackController pushViewController:viewController1 withTransitionClass:[HLSTransitionNone class] animated:NO];
+    [stackController pushViewController:viewController2 withTransitionClass:[HLSTransitionNone class] animated:NO];
+    [stackController pushViewController:viewController3 withTransitionClass:[HLSTransitionNone class] animated:NO];
+    
+    // Popping to a view controller already in the stack removes all view controllers above it
+    [containerStack beginUpdates];
+    [containerStack popToViewController:viewController1 animated:NO];
+    [containerStack endUpdatesAnimated:NO];
+    
+    NSArray *expectedViewControllers = [NSArray arrayWithObjects:rootViewController, viewController1, nil];
+    GHAssertEqualObjects([stackController viewControllers], expectedViewControllers, @"Popped");
+    GHAssertTrue([viewController1 lifeCyclePhase] == HLSViewControllerLifeCyclePhaseViewDidAppear, @"Revealed");
+    GHAssertNil([viewController2 parentViewController], @"Removed");
+    GHAssertNil([viewController3 parentViewController], @"Removed");
+    
+    [stackController viewWillDisappear:NO];
+    [stackController viewDidDisappear:NO];
+    [stackController.view removeFromSuperview];
+}
+
+- (void)testBatchedReorder
+{
+    UIViewController *rootViewController = [[[UIViewController alloc] init] autorelease];
+    HLSStackController *stackController = [[[HLSStackController alloc] initWithRootViewController:rootViewController] autorelease];
+    
+    UIWindow *window = [[[UIWindow alloc] initWithFrame:[UIScreen mainScreen].bounds] autorelease];
+    [window addSubview:stackController.view];
+    [stackController viewWillAppear:NO];
+    [stackController viewDidAppear:NO];
+    
+    // Batched updates are only available from the underlying container stack
+    HLSContainerStack *containerStack = [stackController valueForKey:@"containerStack"];
+    UIViewController *viewController1 = [[[UIViewController alloc] init] autorelease];
+    UIViewController *viewController2 = [[[UIViewController alloc] init] autorelease];
+    UIViewController *viewController3 = [[[UIViewController alloc] init] autorelease];
+    UIViewController *topViewController = [[[UIViewController alloc] init] autorelease];
+    [stackController pushViewController:viewController1 withTransitionClass:[HLSTransitionNone class] animated:NO];
+    [stackController pushViewController:viewController2 withTransitionClass:[HLSTransitionNone class] animated:NO];
+    [stackController pushViewController:viewController3 withTransitionClass:[HLSTransitionNone class] animated:NO];
+    [stackController pushViewController:topViewController withTransitionClass:[HLSTransitionNone class] animated:NO];
+    
+    // Moving a view controller below the top keeps all view controllers, and the top one stays displayed
+    [containerStack beginUpdates];
+    [containerStack removeViewController:viewController3 animated:NO];
+    [containerStack insertViewController:viewController3
+                                 atIndex:1
+                     withTransitionClass:[HLSTransitionNone class]
+                                duration:kAnimationTransitionDefaultDuration
+                                animated:NO];
+    [containerStack endUpdatesAnimated:NO];
+    
+    NSArray *expectedViewControllers = [NSArray arrayWithObjects:rootViewController, viewController3, viewController1, viewController2,
+                                        topViewController, nil];
+    GHAssertEqualObjects([stackController viewControllers], expectedViewControllers, @"Reordered");
+    for (UIViewController *viewController in expectedViewControllers) {
+        GHAssertEquals([viewController parentViewController], (UIViewController *)stackController, @"Still contained");
+    }
+    GHAssertTrue([topViewController lifeCyclePhase] == HLSViewControllerLifeCyclePhaseViewDidAppear, @"Still displayed");
+    
+    [stackController viewWillDisappear:NO];
+    [stackController viewDidDisappear:NO];
+    [stackController.view removeFromSuperview];
+}
+
+- (void)testBatchedUpdatesDuringAnimation
+{
+    UIViewController *rootViewController = [[[UIViewController alloc] init] autorelease];
+    HLSStackController *stackController = [[[HLSStackController alloc] initWithRootViewController:rootViewController] autorelease];
+    
+    UIWindow *window = [[[UIWindow alloc] initWithFrame:[UIScreen mainScreen].bounds] autorelease];
+    [window addSubview:stackController.view];
+    [stackController viewWillAppear:NO];
+    [stackController viewDidAppear:NO];
+    
+    // Batched updates are only available from the underlying container stack
+    HLSContainerStack *containerStack = [stackController valueForKey:@"containerStack"];
+    UIViewController *viewController1 = [[[UIViewController alloc] init] autorelease];
+    UIViewController *viewController2 = [[[UIViewController alloc] init] autorelease];
+    UIViewController *viewController3 = [[[UIViewController alloc] init] autorelease];
+    [stackController pushViewController:viewController1 withTransitionClass:[HLSTransitionNone class] animated:NO];
+    [stackController pushViewController:viewController2 withTransitionClass:[HLSTransitionCoverFromBottom class] duration:0.2 animated:YES];
+    
+    // The batch ends while the push transition is running. Its changes are applied once the transition is over
+    [containerStack beginUpdates];
+    [containerStack removeViewController:viewController1 animated:NO];
+    [containerStack pushViewController:viewController3
+                   withTransitionClass:[HLSTransitionNone class]
+                              duration:kAnimationTransitionDefaultDuration
+                              animated:NO];
+    [containerStack endUpdatesAnimated:NO];
+    
+    NSArray *runningViewControllers = [NSArray arrayWithObjects:rootViewController, viewController1, viewController2, nil];
+    GHAssertEqualObjects([stackController viewControllers], runningViewControllers, @"Not applied yet");
+    
+    NSDate *timeoutDate = [NSDate dateWithTimeIntervalSinceNow:2.];
+    while ([stackController topViewController] != viewController3 && [timeoutDate timeIntervalSinceNow] > 0.) {
+        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    }
+    
+    NSArray *expectedViewControllers = [NSArray arrayWithObjects:rootViewController, viewController2, viewController3, nil];
+    GHAssertEqualObjects([stackController viewControllers], expectedViewControllers, @"Applied after the transition");
+    GHAssertNil([viewController1 parentViewController], @"Removed");
+    GHAssertTrue([viewController3 lifeCyclePhase] == HLSViewControllerLifeCyclePhaseViewDidAppear, @"Displayed");
+    
+    [stackController viewWillDisappear:NO];
+    [stackController viewDidDisappear:NO];
+    [stackController.view removeFromSuperview];
+}
+
+- (void)testInteractivePopTransition
+{
+    UIViewController *rootViewController = [[[UIViewController alloc] init] autorelease];
+    HLSStackController *stackController = [[[HLSStackController alloc] initWithRootViewController:rootViewController] autorelease];
+    
+    UIWindow *window = [[[UIWindow alloc] initWithFrame:[UIScreen mainScreen].bounds] autorelease];
+    [window addSubview:stackController.view];
+    [stackController viewWillAppear:NO];
+    [stackController viewDidAppear:NO];
+    
+    // Interactive transitions are only available from the underlying container stack
+    HLSContainerStack *containerStack = [stackController valueForKey:@"containerStack"];
+    UIViewController *viewController = [[[UIViewController alloc] init] autorelease];
+    [stackController pushViewController:viewController withTransitionClass:[HLSTransitionCoverFromBottom class] animated:NO];
+    
+    // A cancelled transition animates the top view controller back. It stays in the stack
+    [containerStack beginInteractivePopTransition];
+    GHAssertTrue([containerStack isInteractivePopTransitionRunning], @"Running");
+    GHAssertTrue([viewController lifeCyclePhase] == HLSViewControllerLifeCyclePhaseViewWillDisappear, @"Disappearing");
+    [containerStack updateInteractivePopTransitionWithProgress:0.5f];
+    [containerStack cancelInteractivePopTransition];
+    GHAssertFalse([containerStack isInteractivePopTransitionRunning], @"Not running anymore");
+    
+    NSDate *timeoutDate = [NSDate dateWithTimeIntervalSinceNow:2.];
+    while ([viewController lifeCyclePhase] != HLSViewControllerLifeCyclePhaseViewDidAppear && [timeoutDate timeIntervalSinceNow] > 0.) {
+        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    }
+    
+    NSArray *expectedViewControllers = [NSArray arrayWithObjects:rootViewController, viewController, nil];
+    GHAssertEqualObjects([stackController viewControllers], expectedViewControllers, @"Kept");
+    GHAssertTrue([viewController lifeCyclePhase] == HLSViewControllerLifeCyclePhaseViewDidAppear, @"Displayed again");
+    GHAssertTrue([rootViewController lifeCyclePhase] == HLSViewControllerLifeCyclePhaseViewDidDisappear, @"Covered again");
+    
+    // A finished transition pops the top view controller
+    [containerStack beginInteractivePopTransition];
+    [containerStack updateInteractivePopTransitionWithProgress:0.5f];
+    [containerStack finishInteractivePopTransition];
+    GHAssertFalse([containerStack isInteractivePopTransitionRunning], @"Not running anymore");
+    
+    timeoutDate = [NSDate dateWithTimeIntervalSinceNow:2.];
+    while ([stackController count] != 1 && [timeoutDate timeIntervalSinceNow] > 0.) {
+        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    }
+    
+    GHAssertEqualObjects([stackController viewControllers], [NSArray arrayWithObject:rootViewController], @"Popped");
+    GHAssertNil([viewController parentViewController], @"Removed");
+    GHAssertTrue([rootViewController lifeCyclePhase] == HLSViewControllerLifeCyclePhaseViewDidAppear, @"Revealed");
+    
+    [stackController viewWillDisappear:NO];
+    [stackController viewDidDisappear:NO];
+    [stackController.view removeFromSuperview];
+}
+
+- (void)testLifeCycleTiming
+{
+    BOOL lifeCycleTimingEnabled = [UIViewController isLifeCycleTimingEnabled];
+    [UIViewController setLifeCycleTimingEnabled:YES];
+    [UIViewController resetLifeCycleTimings];
+    
+    UIViewController *rootViewController = [[[UIViewController alloc] init] autorelease];
+    HLSStackController *stackController = [[[HLSStackController alloc] initWithRootViewController:rootViewController] autorelease];
+    
+    UIWindow *window = [[[UIWindow alloc] initWithFrame:[UIScreen mainScreen].bounds] autorelease];
+    [window addSubview:stackController.view];
+    [stackController viewWillAppear:NO];
+    [stackController viewDidAppear:NO];
+    
+    ReusableTestViewController *viewController = [[[ReusableTestViewController alloc] init] autorelease];
+    [stackController pushViewController:viewController withTransitionClass:[HLSTransitionNone class] animated:NO];
+    [stackController popViewControllerAnimated:NO];
+    
+    NSDictionary *metricToStatisticsMap = [[UIViewController lifeCycleTimings] objectForKey:NSStringFromClass([ReusableTestViewController class])];
+    GHAssertEquals([[[metricToStatisticsMap objectForKey:HLSViewControllerLifeCycleMetricLoadView] objectForKey:HLSViewControllerLifeCycleTimingCountKey] unsignedIntegerValue],
+                   (NSUInteger)1, @"View loaded once");
+    GHAssertEquals([[[metricToStatisticsMap objectForKey:HLSViewControllerLifeCycleMetricAppearance] objectForKey:HLSViewControllerLifeCycleTimingCountKey] unsignedIntegerValue],
+                   (NSUInteger)1, @"Appeared once");
+    GHAssertEquals([[[metricToStatisticsMap objectForKey:HLSViewControllerLifeCycleMetricDisappearance] objectForKey:HLSViewControllerLifeCycleTimingCountKey] unsignedIntegerValue],
+                   (NSUInteger)1, @"Disappeared once");
+    GHAssertNotNil([[UIViewController lifeCycleTimings] objectForKey:NSStringFromClass([HLSStackController class])], @"Container");
+    [UIViewController logLifeCycleTimings];
+    
+    [UIViewController resetLifeCycleTimings];
+    GHAssertEquals([[UIViewController lifeCycleTimings] count], (NSUInteger)0, @"Reset");
+    
+    [stackController viewWillDisappear:NO];
+    [stackController viewDidDisappear:NO];
+    [stackController.view removeFromSuperview];
+    
+    [HLSContainerStack purgeReusableViewControllers];
+    [UIViewController setLifeCycleTimingEnabled:lifeCycleTimingEnabled];
+}
+
+- (void)testParentViewControllerBenchmark
+{
+    // No view controller is inserted in a container: The accessors behave as if CoconutKit were not loaded
+    UIViewController *viewController = [[[UIViewController alloc] init] autorelease];
+    CFAbsoluteTime standaloneStartTime = CFAbsoluteTimeGetCurrent();
+    for (NSUInteger i = 0; i < kBenchmarkAccessorCallCount; ++i) {
+        [viewController parentViewController];
+    }
+    CFTimeInterval standaloneDuration = CFAbsoluteTimeGetCurrent() - standaloneStartTime;
+    GHTestLog(@"Called -parentViewController %d times without any container in use in %.3f s", kBenchmarkAccessorCallCount, 
+              standaloneDuration);
+    
+    // A view controller is inserted in a container: The accessors must look for an associated container
+    UIViewController *rootViewController = [[[UIViewController alloc] init] autorelease];
+    HLSStackController *stackController = [[[HLSStackController alloc] initWithRootViewController:rootViewController] autorelease];
+    GHAssertEquals([rootViewController parentViewController], (UIViewController *)stackController, @"Parent");
+    
+    CFAbsoluteTime containedStartTime = CFAbsoluteTimeGetCurrent();
+    for (NSUInteger i = 0; i < kBenchmarkAccessorCallCount; ++i) {
+        [viewController parentViewController];
+    }
+    CFTimeInterval containedDuration = CFAbsoluteTimeGetCurrent() - containedStartTime;
+    GHTestLog(@"Called -parentViewController %d times with a container in use in %.3f s", kBenchmarkAccessorCallCount, 
+              containedDuration);
+    
+    GHAssertNil([viewController parentViewController], @"Parent");
+}
+
+@end
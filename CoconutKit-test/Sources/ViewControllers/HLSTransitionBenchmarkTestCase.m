@@ -0,0 +1,293 @@
+//
+//  HLSTransitionBenchmarkTestCase.m
+//  CoconutKit-test
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSTransitionBenchmarkTestCase.h"
+
+#import "BenchmarkRunner.h"
+
+#import <mach/mach.h>
+
+/**
+ * Each transition is pushed and popped with views of increasing complexity (number of subviews). Results are logged
+ * and saved as CSV (one line per transition, complexity and direction) in the Documents directory, so that they can
+ * be compared between releases. Run on a device, results measured on the simulator are meaningless
+ */
+static const NSUInteger kBenchmarkViewComplexities[] = {1, 50, 250};
+static NSString * const kBenchmarkResultsFileName = @"TransitionBenchmark.csv";
+static const NSTimeInterval kBenchmarkTransitionTimeout = 10.;
+
+// Function declarations
+static NSTimeInterval mainThreadCPUTime(void);
+
+/**
+ * Collect frame information on the main thread using a display link
+ */
+@interface TransitionFrameRecorder : NSObject {
+@private
+    CADisplayLink *m_displayLink;
+    CFTimeInterval m_startTime;
+    CFTimeInterval m_previousFrameTimestamp;
+    NSTimeInterval m_startCPUTime;
+    NSTimeInterval m_firstFrameLatency;
+    NSTimeInterval m_maxFrameTimeInterval;
+    NSTimeInterval m_duration;
+    NSTimeInterval m_CPUTime;
+    NSUInteger m_frameCount;
+    NSUInteger m_droppedFrameCount;
+}
+
+- (void)start;
+- (void)stop;
+
+@property (nonatomic, readonly, assign) NSTimeInterval firstFrameLatency;
+@property (nonatomic, readonly, assign) NSTimeInterval maxFrameTimeInterval;
+@property (nonatomic, readonly, assign) NSTimeInterval duration;
+@property (nonatomic, readonly, assign) NSTimeInterval CPUTime;
+@property (nonatomic, readonly, assign) NSUInteger frameCount;
+@property (nonatomic, readonly, assign) NSUInteger droppedFrameCount;
+
+- (void)tick:(CADisplayLink *)displayLink;
+
+@end
+
+@interface HLSTransitionBenchmarkTestCase ()
+
+- (UIViewController *)viewControllerWithComplexity:(NSUInteger)complexity;
+- (void)waitForTransition;
+- (NSString *)resultLineWithTransitionName:(NSString *)transitionName
+                                complexity:(NSUInteger)complexity
+                                 direction:(NSString *)direction
+                                  recorder:(TransitionFrameRecorder *)recorder;
+
+@end
+
+@implementation HLSTransitionBenchmarkTestCase
+
+#pragma mark Test setup and tear down
+
+- (BOOL)shouldRunOnMainThread
+{
+    // View controllers must be manipulated on the main thread
+    return YES;
+}
+
+#pragma mark Tests
+
+- (void)testTransitionsBenchmark
+{
+    if (! [BenchmarkRunner shouldRunBenchmarks]) {
+        return;
+    }
+    
+    UIViewController *rootViewController = [self viewControllerWithComplexity:1];
+    HLSStackController *stackController = [[[HLSStackController alloc] initWithRootViewController:rootViewController] autorelease];
+    stackController.delegate = self;
+    
+    // Transitions must really be displayed for frames to be rendered
+    UIWindow *window = [[[UIWindow alloc] initWithFrame:[UIScreen mainScreen].bounds] autorelease];
+    window.rootViewController = stackController;
+    [window makeKeyAndVisible];
+    
+    NSMutableArray *resultLines = [NSMutableArray arrayWithObject:@"transition,complexity,direction,duration,firstFrameLatency,"
+                                   "frameCount,droppedFrameCount,maxFrameTimeInterval,mainThreadCPUTime"];
+    for (NSString *transitionName in [HLSTransition availableTransitionNames]) {
+        Class transitionClass = NSClassFromString(transitionName);
+        for (NSUInteger i = 0; i < sizeof(kBenchmarkViewComplexities) / sizeof(NSUInteger); ++i) {
+            NSUInteger complexity = kBenchmarkViewComplexities[i];
+            UIViewController *viewController = [self viewControllerWithComplexity:complexity];
+            
+            TransitionFrameRecorder *pushRecorder = [[[TransitionFrameRecorder alloc] init] autorelease];
+            m_transitionRunning = YES;
+            [pushRecorder start];
+            [stackController pushViewController:viewController withTransitionClass:transitionClass animated:YES];
+            [self waitForTransition];
+            [pushRecorder stop];
+            GHAssertFalse(m_transitionRunning, @"The push transition %@ did not end", transitionName);
+            [resultLines addObject:[self resultLineWithTransitionName:transitionName
+                                                           complexity:complexity
+                                                            direction:@"push"
+                                                             recorder:pushRecorder]];
+            
+            TransitionFrameRecorder *popRecorder = [[[TransitionFrameRecorder alloc] init] autorelease];
+            m_transitionRunning = YES;
+            [popRecorder start];
+            [stackController popViewControllerAnimated:YES];
+            [self waitForTransition];
+            [popRecorder stop];
+            GHAssertFalse(m_transitionRunning, @"The pop transition %@ did not end", transitionName);
+            [resultLines addObject:[self resultLineWithTransitionName:transitionName
+                                                           complexity:complexity
+                                                            direction:@"pop"
+                                                             recorder:popRecorder]];
+        }
+    }
+    
+    NSString *results = [resultLines componentsJoinedByString:@"\n"];
+    GHTestLog(@"%@", results);
+    
+    NSString *documentsDirectoryPath = [NSSearchPathForDirectoriesInDomains(NSDocumentDirectory, NSUserDomainMask, YES) objectAtIndex:0];
+    NSString *resultsFilePath = [documentsDirectoryPath stringByAppendingPathComponent:kBenchmarkResultsFileName];
+    NSError *error = nil;
+    if (! [results writeToFile:resultsFilePath atomically:YES encoding:NSUTF8StringEncoding error:&error]) {
+        GHFail(@"The benchmark results could not be saved. Reason: %@", error);
+    }
+    GHTestLog(@"Results saved to %@", resultsFilePath);
+    
+    stackController.delegate = nil;
+    window.hidden = YES;
+}
+
+#pragma mark Benchmark helpers
+
+- (UIViewController *)viewControllerWithComplexity:(NSUInteger)complexity
+{
+    UIViewController *viewController = [[[UIViewController alloc] init] autorelease];
+    viewController.view.backgroundColor = [UIColor whiteColor];
+    
+    // Semi-transparent labels, so that blending is required as in real-world views
+    CGSize size = viewController.view.bounds.size;
+    for (NSUInteger i = 0; i < complexity; ++i) {
+        CGRect frame = CGRectMake(arc4random() % (NSUInteger)size.width, arc4random() % (NSUInteger)size.height, 80.f, 20.f);
+        UILabel *label = [[[UILabel alloc] initWithFrame:frame] autorelease];
+        label.text = [NSString stringWithFormat:@"Label %d", i];
+        label.backgroundColor = [UIColor colorWithRed:(i % 3) / 2.f green:(i % 5) / 4.f blue:(i % 7) / 6.f alpha:0.5f];
+        [viewController.view addSubview:label];
+    }
+    return viewController;
+}
+
+- (void)waitForTransition
+{
+    NSDate *timeoutDate = [NSDate dateWithTimeIntervalSinceNow:kBenchmarkTransitionTimeout];
+    while (m_transitionRunning && [timeoutDate timeIntervalSinceNow] > 0.) {
+        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    }
+}
+
+- (NSString *)resultLineWithTransitionName:(NSString *)transitionName
+                                complexity:(NSUInteger)complexity
+                                 direction:(NSString *)direction
+                                  recorder:(TransitionFrameRecorder *)recorder
+{
+    return [NSString stringWithFormat:@"%@,%d,%@,%.4f,%.4f,%d,%d,%.4f,%.4f",
+            transitionName,
+            complexity,
+            direction,
+            recorder.duration,
+            recorder.firstFrameLatency,
+            recorder.frameCount,
+            recorder.droppedFrameCount,
+            recorder.maxFrameTimeInterval,
+            recorder.CPUTime];
+}
+
+#pragma mark HLSStackControllerDelegate protocol implementation
+
+- (void)stackController:(HLSStackController *)stackController
+  didPushViewController:(UIViewController *)pushedViewController
+    coverViewController:(UIViewController *)coveredViewController
+               animated:(BOOL)animated
+{
+    m_transitionRunning = NO;
+}
+
+- (void)stackController:(HLSStackController *)stackController
+   didPopViewController:(UIViewController *)poppedViewController
+   revealViewController:(UIViewController *)revealedViewController
+               animated:(BOOL)animated
+{
+    m_transitionRunning = NO;
+}
+
+@end
+
+@implementation TransitionFrameRecorder
+
+#pragma mark Object creation and destruction
+
+- (void)dealloc
+{
+    [m_displayLink invalidate];
+    [m_displayLink release];
+    
+    [super dealloc];
+}
+
+#pragma mark Accessors and mutators
+
+@synthesize firstFrameLatency = m_firstFrameLatency;
+
+@synthesize maxFrameTimeInterval = m_maxFrameTimeInterval;
+
+@synthesize duration = m_duration;
+
+@synthesize CPUTime = m_CPUTime;
+
+@synthesize frameCount = m_frameCount;
+
+@synthesize droppedFrameCount = m_droppedFrameCount;
+
+#pragma mark Recording
+
+- (void)start
+{
+    m_startTime = CACurrentMediaTime();
+    m_startCPUTime = mainThreadCPUTime();
+    
+    m_displayLink = [[CADisplayLink displayLinkWithTarget:self selector:@selector(tick:)] retain];
+    [m_displayLink addToRunLoop:[NSRunLoop mainRunLoop] forMode:NSRunLoopCommonModes];
+}
+
+- (void)stop
+{
+    m_duration = CACurrentMediaTime() - m_startTime;
+    m_CPUTime = mainThreadCPUTime() - m_startCPUTime;
+    
+    // The display link retains its target
+    [m_displayLink invalidate];
+    [m_displayLink release];
+    m_displayLink = nil;
+}
+
+- (void)tick:(CADisplayLink *)displayLink
+{
+    if (m_frameCount == 0) {
+        m_firstFrameLatency = displayLink.timestamp - m_startTime;
+    }
+    else {
+        NSTimeInterval frameTimeInterval = displayLink.timestamp - m_previousFrameTimestamp;
+        m_maxFrameTimeInterval = MAX(m_maxFrameTimeInterval, frameTimeInterval);
+        
+        NSUInteger elapsedFrameCount = (NSUInteger)round(frameTimeInterval / displayLink.duration);
+        if (elapsedFrameCount > 1) {
+            m_droppedFrameCount += elapsedFrameCount - 1;
+        }
+    }
+    
+    ++m_frameCount;
+    m_previousFrameTimestamp = displayLink.timestamp;
+}
+
+@end
+
+#pragma mark Static functions
+
+static NSTimeInterval mainThreadCPUTime(void)
+{
+    thread_basic_info_data_t info;
+    mach_msg_type_number_t count = THREAD_BASIC_INFO_COUNT;
+    mach_port_t thread = mach_thread_self();
+    kern_return_t result = thread_info(thread, THREAD_BASIC_INFO, (thread_info_t)&info, &count);
+    mach_port_deallocate(mach_task_self(), thread);
+    if (result != KERN_SUCCESS) {
+        return 0.;
+    }
+    
+    return info.user_time.seconds + info.user_time.microseconds / 1e6
+        + info.system_time.seconds + info.system_time.microseconds / 1e6;
+}
@@ -0,0 +1,31 @@
+//
+//  HLSAnimation+Friend.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+/**
+ * Interface meant to be used by friend classes of HLSAnimation (= classes which must have access to private implementation
+ * details)
+ */
+@interface HLSAnimation (Friend)
+
+/**
+ * If set to NO, the animation does not interrupt and resume itself when the application enters background, respectively
+ * foreground. This must be done by the object which plays the animation
+ *
+ * Default value is YES
+ */
+@property (nonatomic, assign, getter=isHandlingApplicationStateChanges) BOOL handlingApplicationStateChanges;
+
+/**
+ * Called by the animation registry when the application enters background, respectively foreground. A running animation
+ * is cancelled and rewound when suspended, in which case the method returns YES. It is then played again from the time
+ * at which it was suspended when resumed
+ */
+- (BOOL)suspendBeforeEnteringBackground;
+- (void)resumeAfterEnteringForeground;
+
+@end
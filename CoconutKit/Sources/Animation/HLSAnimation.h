@@ -6,9 +6,11 @@
 //  Copyright 2011 Hortis. All rights reserved.
 //
 
+#import "HLSAnimationMetrics.h"
 #import "HLSAnimationStep.h"
 
 // Forward declarations
+@class HLSUserInterfaceLockToken;
 @class HLSZeroingWeakRef;
 @protocol HLSAnimationDelegate;
 
@@ -40,7 +42,9 @@
  * Animations can be played animated or not (yeah, that sounds weird, but I called it that way :-) ). When played
  * non-animated, an animation reaches its end state instantaneously. This is a perfect way to replay an animation
  * when rebuilding a view which has been unloaded (typically after a view controller received a memory warning 
- * notification on iOS 4 & 5. Note that views are not unloaded anymore since iOS 6)
+ * notification on iOS 4 & 5. Note that views are not unloaded anymore since iOS 6). If the delegate does not implement
+ * -animation:didFinishStep:animated:, all steps are then applied at once within a single transaction, which makes
+ * restoring many animations cheap
  *
  * Running animations (this includes animations which have been paused) are automatically paused and resumed (if they
  * were running before) when the application enters, respectively exits background. Note that this mechanism works 
@@ -60,19 +64,37 @@
 @interface HLSAnimation : NSObject <NSCopying> {
 @private
     NSArray *m_animationSteps;                                      // a copy of the HLSAnimationSteps passed at initialization time
-    NSArray *m_animationStepCopies;                                 // another copy made temporarily during animation
-    NSEnumerator *m_animationStepsEnumerator;                       // enumerator over steps
+    NSArray *m_animationStepCopies;                                 // another copy, kept and played again as long as possible
+    NSArray *m_bakedAnimationStepCopies;                            // the same copies, baked (if possible)
+    NSArray *m_playedAnimationSteps;                                // the steps currently being played (one of the two arrays above)
+    NSArray *m_reverseAnimationSteps;                               // cached reverse animation steps
+    NSUInteger m_loopAnimationStepCount;                            // for loop animations, the number of steps before the reverse ones
+    HLSAnimationStep *m_delayAnimationStep;                         // dummy step used to implement delays
+    NSUInteger m_nextAnimationStepIndex;                            // index of the next step to play
+    NSArray *m_timedAnimationSteps;                                 // the steps for which the end times below have been calculated
+    NSTimeInterval *m_animationStepEndTimes;                        // cumulative end times of the steps, measured from the animation start
+    BOOL m_skippingAnimationSteps;                                  // are steps being played instantaneously to reach the start time?
     HLSAnimationStep *m_currentAnimationStep;                       // the currently played animation step
     NSString *m_tag;
     NSDictionary *m_userInfo;
     BOOL m_lockingUI;
+    HLSUserInterfaceLockToken *m_userInterfaceLockToken;            // held while an animation locking the UI is running
+    BOOL m_baked;
+    BOOL m_frameMonitoringEnabled;
+    CADisplayLink *m_displayLink;                                   // samples frames when monitoring
+    CFTimeInterval m_previousFrameTimestamp;
+    CFTimeInterval m_currentAnimationStepStartTime;
+    NSTimeInterval m_currentAnimationStepRequestedDuration;
+    HLSAnimationMetrics *m_metrics;
     BOOL m_animated;
     NSUInteger m_repeatCount;
     NSUInteger m_currentRepeatCount;
+    BOOL m_repeatingInRenderServer;                                 // are all repeats played by Core Animation within a single step?
     NSTimeInterval m_remainingTimeBeforeStart;                      // the time remaining before the start time is reached
     NSTimeInterval m_elapsedTime;                                   // the currently elapsed time (does not include pauses)
     BOOL m_runningBeforeEnteringBackground;                         // was the animation running before the application entered background?
     BOOL m_pausedBeforeEnteringBackground;                          // was the animation paused before the application entered background?
+    BOOL m_handlingApplicationStateChanges;
     BOOL m_running;
     BOOL m_playing;
     BOOL m_started;
@@ -81,6 +103,13 @@
     HLSZeroingWeakRef *m_delegateZeroingWeakRef;
 }
 
+/**
+ * Enable or disable frame monitoring for all animations, whatever the value of their frameMonitoringEnabled property
+ * (see below). Disabled by default
+ */
++ (void)setFrameMonitoringEnabledForAllAnimations:(BOOL)enabled;
++ (BOOL)isFrameMonitoringEnabledForAllAnimations;
+
 /**
  * Convenience constructor for creating an animation from HLSAnimationStep objects. Providing nil creates an empty
  * animation
@@ -116,6 +145,36 @@
  */
 @property (nonatomic, assign) BOOL lockingUI;
 
+/**
+ * If set to YES, an animation made only of layer animation steps (HLSLayerAnimationStep) is played as a whole by Core
+ * Animation when played animated: All changes applied to a layer property by the steps are merged into a single keyframe
+ * animation, which runs entirely in the render server, without any main thread work between steps. Baked animations
+ * are especially useful for complex animations with many short steps. The only difference is that the delegate does
+ * not receive -animation:didFinishStep:animated: events. Animations containing view animation steps are never baked
+ *
+ * Baked loop animations (see -loopAnimation) go further: The reverse half of the loop and all repeats are played by
+ * Core Animation as well, so that a loop repeated forever costs no main thread work at all once started
+ *
+ * Default is NO
+ */
+@property (nonatomic, assign, getter=isBaked) BOOL baked;
+
+/**
+ * If set to YES, frame timing information is collected each time the animation is played animated (e.g. to find
+ * which animations drop frames). Metrics are available from the metrics property when the animation ends, and
+ * are sent to the delegate using -animation:didCollectMetrics:. Monitoring has a small cost and should be enabled 
+ * only when needed
+ *
+ * Default is NO
+ */
+@property (nonatomic, assign, getter=isFrameMonitoringEnabled) BOOL frameMonitoringEnabled;
+
+/**
+ * The metrics collected the last time the animation was played animated with frame monitoring enabled (see
+ * HLSAnimationMetrics), nil if none
+ */
+@property (nonatomic, readonly, retain) HLSAnimationMetrics *metrics;
+
 /**
  * The animation delegate. Note that the animation is automatically cancelled if a delegate has been set
  * and gets deallocated while the animation is runnning
@@ -185,6 +244,16 @@
  */
 - (void)resume;
 
+/**
+ * Move a paused animation to a given time (measured from the beginning of the animation), so that it can be driven
+ * interactively, e.g. by a gesture. When resumed, the animation continues from this time. This method does nothing 
+ * if the animation has not been paused
+ *
+ * Remark: The time can only be moved within the animation step currently being played (values outside its range are
+ *         clamped). Only Core Animation steps support this feature
+ */
+- (void)seekToTime:(NSTimeInterval)time;
+
 /**
  * Cancel the animation. The animation immediately reaches its end state. The delegate does not receive subsequent
  * events
@@ -286,4 +355,10 @@
  */
 - (void)animation:(HLSAnimation *)animation didFinishStep:(HLSAnimationStep *)animationStep animated:(BOOL)animated;
 
+/**
+ * Called right before -animationDidStop:animated: when frame monitoring is enabled and the animation was played animated
+ * (see frameMonitoringEnabled property)
+ */
+- (void)animation:(HLSAnimation *)animation didCollectMetrics:(HLSAnimationMetrics *)metrics;
+
 @end
@@ -8,11 +8,15 @@
 
 #import "HLSAnimation.h"
 
+#import "HLSAnimation+Friend.h"
+#import "HLSAnimationMetrics+Friend.h"
+#import "HLSAnimationRegistry.h"
 #import "HLSAnimationStep+Friend.h"
 #import "HLSAssert.h"
 #import "HLSConverters.h"
 #import "HLSFloat.h"
 #import "HLSLayerAnimationStep.h"
+#import "HLSLayerAnimationStep+Friend.h"
 #import "HLSLogger.h"
 #import "HLSUserInterfaceLock.h"
 #import "HLSZeroingWeakRef.h"
@@ -27,14 +31,21 @@
  */
 
 static NSString * const kDelayLayerAnimationTag = @"HLSDelayLayerAnimationStep";
+static NSString * const kBakedLayerAnimationTag = @"HLSBakedLayerAnimationStep";
 
-@interface HLSAnimation () <HLSAnimationStepDelegate>
+static BOOL s_frameMonitoringEnabledForAllAnimations = NO;
+
+@interface HLSAnimation () <HLSAnimationStepDelegate, HLSSuspendableAnimation>
 
 + (NSArray *)duplicateAnimationSteps:(NSArray *)animationSteps;
++ (BOOL)canReplayAnimationSteps:(NSArray *)animationSteps;
 
 @property (nonatomic, retain) NSArray *animationSteps;
 @property (nonatomic, retain) NSArray *animationStepCopies;
-@property (nonatomic, retain) NSEnumerator *animationStepsEnumerator;
+@property (nonatomic, retain) NSArray *bakedAnimationStepCopies;
+@property (nonatomic, retain) NSArray *playedAnimationSteps;
+@property (nonatomic, retain) HLSLayerAnimationStep *delayAnimationStep;
+@property (nonatomic, assign) NSUInteger loopAnimationStepCount;
 @property (nonatomic, retain) HLSAnimationStep *currentAnimationStep;
 @property (nonatomic, assign, getter=isRunning) BOOL running;
 @property (nonatomic, assign, getter=isPlaying) BOOL playing;
@@ -42,6 +53,10 @@ static NSString * const kDelayLayerAnimationTag = @"HLSDelayLayerAnimationStep";
 @property (nonatomic, assign, getter=isCancelling) BOOL cancelling;
 @property (nonatomic, assign, getter=isTerminating) BOOL terminating;
 @property (nonatomic, retain) HLSZeroingWeakRef *delegateZeroingWeakRef;
+@property (nonatomic, retain) CADisplayLink *displayLink;
+@property (nonatomic, retain) HLSAnimationMetrics *metrics;
+@property (nonatomic, retain) HLSUserInterfaceLockToken *userInterfaceLockToken;
+@property (nonatomic, assign, getter=isHandlingApplicationStateChanges) BOOL handlingApplicationStateChanges;
 
 - (void)playWithStartTime:(NSTimeInterval)startTime
               repeatCount:(NSUInteger)repeatCount
@@ -49,13 +64,18 @@ static NSString * const kDelayLayerAnimationTag = @"HLSDelayLayerAnimationStep";
                afterDelay:(NSTimeInterval)delay
                  animated:(BOOL)animated;
 
+- (void)playInstantaneouslyWithRepeatCount:(NSUInteger)repeatCount;
 - (void)playAnimationStep:(HLSAnimationStep *)animationStep animated:(BOOL)animated;
 - (void)playNextAnimationStepAnimated:(BOOL)animated;
+- (void)skipAnimationStepsBeforeStartTime;
 
-- (NSArray *)reverseAnimationSteps;
+- (void)startFrameMonitoring;
+- (void)stopFrameMonitoring;
+- (void)displayLinkFired:(CADisplayLink *)displayLink;
 
-- (void)applicationDidEnterBackground:(NSNotification *)notification;
-- (void)applicationWillEnterForeground:(NSNotification *)notification;
+- (NSArray *)reverseAnimationSteps;
+- (NSArray *)bakedAnimationStepsFromAnimationSteps:(NSArray *)animationSteps;
+- (NSArray *)loopingBakedAnimationStepsFromAnimationSteps:(NSArray *)animationSteps repeatCount:(NSUInteger)repeatCount;
 
 @end
 
@@ -63,6 +83,16 @@ static NSString * const kDelayLayerAnimationTag = @"HLSDelayLayerAnimationStep";
 
 #pragma mark Class methods
 
++ (void)setFrameMonitoringEnabledForAllAnimations:(BOOL)enabled
+{
+    s_frameMonitoringEnabledForAllAnimations = enabled;
+}
+
++ (BOOL)isFrameMonitoringEnabledForAllAnimations
+{
+    return s_frameMonitoringEnabledForAllAnimations;
+}
+
 + (HLSAnimation *)animationWithAnimationSteps:(NSArray *)animationSteps
 {
     return [[[[self class] alloc] initWithAnimationSteps:animationSteps] autorelease];
@@ -86,6 +116,24 @@ static NSString * const kDelayLayerAnimationTag = @"HLSDelayLayerAnimationStep";
     return [NSArray arrayWithArray:animationStepCopies];
 }
 
+/**
+ * Return YES iff all animation steps in the array can be played again. This is not the case if one of them is still
+ * waiting for its animation to end (which happens when an animation has been terminated)
+ */
++ (BOOL)canReplayAnimationSteps:(NSArray *)animationSteps
+{
+    if (! animationSteps) {
+        return NO;
+    }
+    
+    for (HLSAnimationStep *animationStep in animationSteps) {
+        if (animationStep.waitingForCompletion) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
 #pragma mark Object creation and destruction
 
 - (id)initWithAnimationSteps:(NSArray *)animationSteps
@@ -99,14 +147,7 @@ static NSString * const kDelayLayerAnimationTag = @"HLSDelayLayerAnimationStep";
             self.animationSteps = [HLSAnimation duplicateAnimationSteps:animationSteps];
         }
         
-        [[NSNotificationCenter defaultCenter] addObserver:self
-                                                 selector:@selector(applicationDidEnterBackground:)
-                                                     name:UIApplicationDidEnterBackgroundNotification
-                                                   object:nil];
-        [[NSNotificationCenter defaultCenter] addObserver:self
-                                                 selector:@selector(applicationWillEnterForeground:)
-                                                     name:UIApplicationWillEnterForegroundNotification
-                                                   object:nil];
+        self.handlingApplicationStateChanges = YES;
     }
     return self;
 }
@@ -119,22 +160,24 @@ static NSString * const kDelayLayerAnimationTag = @"HLSDelayLayerAnimationStep";
 
 - (void)dealloc
 {
-    [[NSNotificationCenter defaultCenter] removeObserver:self
-                                                    name:UIApplicationDidEnterBackgroundNotification
-                                                  object:nil];
-    [[NSNotificationCenter defaultCenter] removeObserver:self
-                                                    name:UIApplicationWillEnterForegroundNotification
-                                                  object:nil];
-    
     [self cancel];
+    [[HLSAnimationRegistry sharedRegistry] discardAnimation:self];
     
     self.animationSteps = nil;
     self.animationStepCopies = nil;
-    self.animationStepsEnumerator = nil;
+    self.bakedAnimationStepCopies = nil;
+    self.playedAnimationSteps = nil;
+    [m_reverseAnimationSteps release];
+    [m_timedAnimationSteps release];
+    free(m_animationStepEndTimes);
+    self.delayAnimationStep = nil;
     self.currentAnimationStep = nil;
     self.tag = nil;
     self.userInfo = nil;
     self.delegateZeroingWeakRef = nil;
+    self.displayLink = nil;
+    self.metrics = nil;
+    self.userInterfaceLockToken = nil;
     
     [super dealloc];
 }
@@ -145,7 +188,13 @@ static NSString * const kDelayLayerAnimationTag = @"HLSDelayLayerAnimationStep";
 
 @synthesize animationStepCopies = m_animationStepCopies;
 
-@synthesize animationStepsEnumerator = m_animationStepsEnumerator;
+@synthesize bakedAnimationStepCopies = m_bakedAnimationStepCopies;
+
+@synthesize playedAnimationSteps = m_playedAnimationSteps;
+
+@synthesize delayAnimationStep = m_delayAnimationStep;
+
+@synthesize loopAnimationStepCount = m_loopAnimationStepCount;
 
 @synthesize currentAnimationStep = m_currentAnimationStep;
 
@@ -155,6 +204,16 @@ static NSString * const kDelayLayerAnimationTag = @"HLSDelayLayerAnimationStep";
 
 @synthesize lockingUI = m_lockingUI;
 
+@synthesize baked = m_baked;
+
+@synthesize frameMonitoringEnabled = m_frameMonitoringEnabled;
+
+@synthesize displayLink = m_displayLink;
+
+@synthesize metrics = m_metrics;
+
+@synthesize userInterfaceLockToken = m_userInterfaceLockToken;
+
 @synthesize running = m_running;
 
 @synthesize playing = m_playing;
@@ -170,6 +229,8 @@ static NSString * const kDelayLayerAnimationTag = @"HLSDelayLayerAnimationStep";
 
 @synthesize terminating = m_terminating;
 
+@synthesize handlingApplicationStateChanges = m_handlingApplicationStateChanges;
+
 @synthesize delegateZeroingWeakRef = m_delegateZeroingWeakRef;
 
 - (id<HLSAnimationDelegate>)delegate
@@ -268,23 +329,65 @@ static NSString * const kDelayLayerAnimationTag = @"HLSDelayLayerAnimationStep";
             HLSLoggerDebug(@"The animation is already running");
             return;
         }
+        
+        // Nobody needs to be notified about each step: Apply all of them at once
+        if (! animated && ! [self.delegate respondsToSelector:@selector(animation:didFinishStep:animated:)]) {
+            [self playInstantaneouslyWithRepeatCount:repeatCount];
+            return;
+        }
                 
         self.running = YES;
         self.playing = YES;
+        
+        // Application state changes are handled by the registry for all running animations
+        if (self.handlingApplicationStateChanges) {
+            [[HLSAnimationRegistry sharedRegistry] registerAnimation:self];
+        }
     
-        // Lock the UI during the animation
+        // Lock the UI during the whole animation (the token is kept even if lockingUI is changed while running)
         if (self.lockingUI) {
-            [[HLSUserInterfaceLock sharedUserInterfaceLock] lock];
+            self.userInterfaceLockToken = [[HLSUserInterfaceLock sharedUserInterfaceLock] lockTokenWithReason:@"Animation"];
+        }
+        
+        if (animated && (self.frameMonitoringEnabled || s_frameMonitoringEnabledForAllAnimations)) {
+            [self startFrameMonitoring];
         }
     }
     
     // Animation steps carry state information. To avoid issues when playing the same animation step several times (most
-    // notably when repeatCount > 1), we work on a deep copy of them
-    self.animationStepCopies = [HLSAnimation duplicateAnimationSteps:self.animationSteps];
+    // notably when repeatCount > 1), we work on a deep copy of them. This copy is kept and played again (e.g. when repeating
+    // the animation) as long as none of its steps is still waiting for a previous animation to end. Fresh copies are only
+    // made in this case, so that playing, repeating and replaying an animation does not allocate new steps each time
+    if (! [HLSAnimation canReplayAnimationSteps:self.animationStepCopies]) {
+        self.animationStepCopies = [HLSAnimation duplicateAnimationSteps:self.animationSteps];
+        self.bakedAnimationStepCopies = nil;
+    }
+    
+    // Baked loops are played by a single step running until all repeats are over, built for each play since it depends
+    // on the repeat count
+    NSArray *loopingBakedAnimationSteps = nil;
+    if (self.baked && animated && currentRepeatCount == 0) {
+        loopingBakedAnimationSteps = [self loopingBakedAnimationStepsFromAnimationSteps:self.animationStepCopies repeatCount:repeatCount];
+    }
+    
+    if (loopingBakedAnimationSteps) {
+        self.playedAnimationSteps = loopingBakedAnimationSteps;
+    }
+    else if (self.baked && animated) {
+        if (! [HLSAnimation canReplayAnimationSteps:self.bakedAnimationStepCopies]) {
+            self.bakedAnimationStepCopies = [self bakedAnimationStepsFromAnimationSteps:self.animationStepCopies];
+        }
+        self.playedAnimationSteps = self.bakedAnimationStepCopies;
+    }
+    else {
+        self.playedAnimationSteps = self.animationStepCopies;
+    }
+    m_nextAnimationStepIndex = 0;
         
     m_animated = animated;
     m_repeatCount = repeatCount;
     m_currentRepeatCount = currentRepeatCount;
+    m_repeatingInRenderServer = (loopingBakedAnimationSteps != nil);
     m_remainingTimeBeforeStart = startTime;
     m_elapsedTime = 0.;
     
@@ -298,14 +401,56 @@ static NSString * const kDelayLayerAnimationTag = @"HLSDelayLayerAnimationStep";
     //     (after all, the start delegate method is called 'didStart', not 'willStart') if the animated layers are
     //     heavy, e.g. with many transparent sublayers, creating an ugly flickering in animations. By creating delays
     //     with a dummy layer animation step, this problem vanishes
-    HLSLayerAnimationStep *delayAnimationStep = [HLSLayerAnimationStep animationStep];
-    delayAnimationStep.tag = kDelayLayerAnimationTag;
-    delayAnimationStep.duration = delay;
+    if (! self.delayAnimationStep || self.delayAnimationStep.waitingForCompletion) {
+        self.delayAnimationStep = [HLSLayerAnimationStep animationStep];
+        self.delayAnimationStep.tag = kDelayLayerAnimationTag;
+    }
+    self.delayAnimationStep.duration = delay;
     
     // Set the dummy animation step as current animation step, so that cancel / terminate work as expected, even
     // if they occur during the initial delay period
-    self.currentAnimationStep = delayAnimationStep;
-    [self playAnimationStep:delayAnimationStep animated:animated];
+    self.currentAnimationStep = self.delayAnimationStep;
+    [self playAnimationStep:self.delayAnimationStep animated:animated];
+}
+
+/**
+ * Reach the end state of the animation synchronously. All steps (and their repeats) are applied within a single 
+ * transaction, without being copied, and the delegate only receives the start and stop events
+ */
+- (void)playInstantaneouslyWithRepeatCount:(NSUInteger)repeatCount
+{
+    self.running = YES;
+    self.playing = YES;
+    
+    if ([self.delegate respondsToSelector:@selector(animationWillStart:animated:)]) {
+        [self.delegate animationWillStart:self animated:NO];
+    }
+    self.started = YES;
+    
+    // The delegate might have cancelled the animation
+    if (! self.cancelling) {
+        [CATransaction begin];
+        [CATransaction setDisableActions:YES];
+        for (NSUInteger i = 0; i < repeatCount; ++i) {
+            for (HLSAnimationStep *animationStep in self.animationSteps) {
+                [animationStep playInstantaneously];
+            }
+        }
+        [CATransaction commit];
+    }
+    
+    self.started = NO;
+    self.playing = NO;
+    
+    if (! self.cancelling) {
+        if ([self.delegate respondsToSelector:@selector(animationDidStop:animated:)]) {
+            [self.delegate animationDidStop:self animated:NO];
+        }
+    }
+    
+    self.running = NO;
+    self.cancelling = NO;
+    self.terminating = NO;
 }
 
 - (void)playAnimationStep:(HLSAnimationStep *)animationStep animated:(BOOL)animated
@@ -321,35 +466,44 @@ static NSString * const kDelayLayerAnimationTag = @"HLSDelayLayerAnimationStep";
     else {
         NSTimeInterval remainingTimeBeforeStart = m_remainingTimeBeforeStart;
         m_remainingTimeBeforeStart = 0.;
+        
+        m_currentAnimationStepStartTime = CACurrentMediaTime();
+        m_currentAnimationStepRequestedDuration = animationStep.duration - remainingTimeBeforeStart;
         [animationStep playWithDelegate:self startTime:remainingTimeBeforeStart animated:animated];
     }
 }
 
 - (void)playNextAnimationStepAnimated:(BOOL)animated
 {
-    // First call?
-    if (! self.animationStepsEnumerator) {
-        self.animationStepsEnumerator = [self.animationStepCopies objectEnumerator];
+    // Instantaneously play all remaining steps which complete before the start time at once
+    if (doublegt(m_remainingTimeBeforeStart, 0.) && m_nextAnimationStepIndex < [self.playedAnimationSteps count]) {
+        [self skipAnimationStepsBeforeStartTime];
     }
     
     // Proceeed with the next step (if any)
-    self.currentAnimationStep = [self.animationStepsEnumerator nextObject];
-    if (self.currentAnimationStep) {
+    if (m_nextAnimationStepIndex < [self.playedAnimationSteps count]) {
+        self.currentAnimationStep = [self.playedAnimationSteps objectAtIndex:m_nextAnimationStepIndex];
+        ++m_nextAnimationStepIndex;
         [self playAnimationStep:self.currentAnimationStep animated:animated];
     }
     // Done with the animation
     else {
+        self.currentAnimationStep = nil;
+        
         // Empty animations (without animation steps) must still call the animationWillStart:animated delegate method
-        if (m_currentRepeatCount == 0 && [self.animationStepCopies count] == 0) {
+        if (m_currentRepeatCount == 0 && [self.playedAnimationSteps count] == 0) {
             if ([self.delegate respondsToSelector:@selector(animationWillStart:animated:)]) {
                 [self.delegate animationWillStart:self animated:animated];
             }
             
             self.started = YES;
         }
-        
-        self.animationStepsEnumerator = nil;
                 
+        // All repeats have been played by Core Animation
+        if (m_repeatingInRenderServer) {
+            m_currentRepeatCount = m_repeatCount - 1;
+        }
+        
         // Could theoretically overflow if m_repeatCount == NSUIntegerMax, but this would still yield a correct
         // behavior here
         ++m_currentRepeatCount;
@@ -357,13 +511,24 @@ static NSString * const kDelayLayerAnimationTag = @"HLSDelayLayerAnimationStep";
         if ((m_repeatCount == NSUIntegerMax && (self.terminating || self.cancelling))
                 || (m_repeatCount != NSUIntegerMax && m_currentRepeatCount == m_repeatCount)) {
             // Unlock the UI
-            if (self.lockingUI) {
-                [[HLSUserInterfaceLock sharedUserInterfaceLock] unlock];
-            }
+            [self.userInterfaceLockToken relinquish];
+            self.userInterfaceLockToken = nil;
             
             self.started = NO;
             self.playing = NO;
             
+            if (self.displayLink) {
+                [self stopFrameMonitoring];
+                
+                if (! self.cancelling) {
+                    HLSLoggerDebug(@"Metrics for animation %@: %@", self, self.metrics);
+                    
+                    if ([self.delegate respondsToSelector:@selector(animation:didCollectMetrics:)]) {
+                        [self.delegate animation:self didCollectMetrics:self.metrics];
+                    }
+                }
+            }
+            
             if (! self.cancelling) {
                 if ([self.delegate respondsToSelector:@selector(animationDidStop:animated:)]) {
                     [self.delegate animationDidStop:self animated:self.terminating ? NO : animated];
@@ -372,6 +537,7 @@ static NSString * const kDelayLayerAnimationTag = @"HLSDelayLayerAnimationStep";
             
             // End of the animation
             self.running = NO;
+            [[HLSAnimationRegistry sharedRegistry] unregisterAnimation:self];
             self.cancelling = NO;
             self.terminating = NO;
         }    
@@ -386,6 +552,62 @@ static NSString * const kDelayLayerAnimationTag = @"HLSDelayLayerAnimationStep";
     }
 }
 
+/**
+ * Play all steps from the next one which complete before the start time is reached, non-animated and within a single
+ * transaction. The first step to be played normally is located using a binary search on the cumulative step end times, 
+ * which are calculated once for the steps being played
+ */
+- (void)skipAnimationStepsBeforeStartTime
+{
+    NSUInteger count = [self.playedAnimationSteps count];
+    if (m_timedAnimationSteps != self.playedAnimationSteps) {
+        [m_timedAnimationSteps release];
+        m_timedAnimationSteps = [self.playedAnimationSteps retain];
+        
+        free(m_animationStepEndTimes);
+        m_animationStepEndTimes = (NSTimeInterval *)malloc(MAX(count, 1) * sizeof(NSTimeInterval));
+        NSTimeInterval endTime = 0.;
+        for (NSUInteger i = 0; i < count; ++i) {
+            endTime += [[self.playedAnimationSteps objectAtIndex:i] duration];
+            m_animationStepEndTimes[i] = endTime;
+        }
+    }
+    
+    // Find the first step (from the next one) which does not complete before the start time
+    NSTimeInterval baseTime = (m_nextAnimationStepIndex == 0) ? 0. : m_animationStepEndTimes[m_nextAnimationStepIndex - 1];
+    NSTimeInterval startTime = baseTime + m_remainingTimeBeforeStart;
+    NSUInteger lowIndex = m_nextAnimationStepIndex;
+    NSUInteger highIndex = count;
+    while (lowIndex < highIndex) {
+        NSUInteger middleIndex = lowIndex + (highIndex - lowIndex) / 2;
+        if (doublegt(startTime, m_animationStepEndTimes[middleIndex])) {
+            lowIndex = middleIndex + 1;
+        }
+        else {
+            highIndex = middleIndex;
+        }
+    }
+    
+    if (lowIndex == m_nextAnimationStepIndex) {
+        return;
+    }
+    
+    // Nested transactions are committed with the outermost one. A single transaction is therefore committed for all
+    // skipped steps. Delegate events are not sent for them (the time remaining before the start time is still non-zero 
+    // while they are played)
+    m_skippingAnimationSteps = YES;
+    [CATransaction begin];
+    for (NSUInteger i = m_nextAnimationStepIndex; i < lowIndex; ++i) {
+        self.currentAnimationStep = [self.playedAnimationSteps objectAtIndex:i];
+        [self.currentAnimationStep playWithDelegate:self startTime:0. animated:NO];
+    }
+    [CATransaction commit];
+    m_skippingAnimationSteps = NO;
+    
+    m_remainingTimeBeforeStart = MAX(startTime - m_animationStepEndTimes[lowIndex - 1], 0.);
+    m_nextAnimationStepIndex = lowIndex;
+}
+
 - (void)pause
 {
     if (! self.running) {
@@ -416,6 +638,23 @@ static NSString * const kDelayLayerAnimationTag = @"HLSDelayLayerAnimationStep";
     [self.currentAnimationStep resume];
 }
 
+- (void)seekToTime:(NSTimeInterval)time
+{
+    if (! self.paused) {
+        HLSLoggerDebug(@"The animation has not been paused. Cannot seek");
+        return;
+    }
+    
+    // m_elapsedTime is the time at which the current step began
+    NSTimeInterval animationStepTime = time - m_elapsedTime;
+    if (doublelt(animationStepTime, 0.) || doublegt(animationStepTime, self.currentAnimationStep.duration)) {
+        HLSLoggerDebug(@"Can only seek within the current animation step; time clamped");
+        animationStepTime = MIN(MAX(animationStepTime, 0.), self.currentAnimationStep.duration);
+    }
+    
+    [self.currentAnimationStep seekToTime:animationStepTime];
+}
+
 - (void)cancel
 {
     if (! self.running) {
@@ -452,6 +691,36 @@ static NSString * const kDelayLayerAnimationTag = @"HLSDelayLayerAnimationStep";
     [self.currentAnimationStep terminate];
 }
 
+#pragma mark Frame monitoring
+
+- (void)startFrameMonitoring
+{
+    self.metrics = [[[HLSAnimationMetrics alloc] init] autorelease];
+    [self.metrics setTag:self.tag];
+    
+    // The display link fires on the main thread each time the display is refreshed. It retains its target, but is 
+    // invalidated when the animation ends
+    m_previousFrameTimestamp = 0.;
+    self.displayLink = [CADisplayLink displayLinkWithTarget:self selector:@selector(displayLinkFired:)];
+    [self.displayLink addToRunLoop:[NSRunLoop mainRunLoop] forMode:NSRunLoopCommonModes];
+}
+
+- (void)stopFrameMonitoring
+{
+    [self.displayLink invalidate];
+    self.displayLink = nil;
+}
+
+- (void)displayLinkFired:(CADisplayLink *)displayLink
+{
+    // Frame intervals are measured from the first frame
+    if (! doubleeq(m_previousFrameTimestamp, 0.)) {
+        [self.metrics recordFrameWithTimeInterval:displayLink.timestamp - m_previousFrameTimestamp
+                              nominalTimeInterval:displayLink.duration * displayLink.frameInterval];
+    }
+    m_previousFrameTimestamp = displayLink.timestamp;
+}
+
 #pragma mark Creating animations variants from an existing animation
 
 - (HLSAnimation *)animationWithDuration:(NSTimeInterval)duration
@@ -461,7 +730,9 @@ static NSString * const kDelayLayerAnimationTag = @"HLSDelayLayerAnimationStep";
         return nil;
     }
     
+    // Animation steps are shared between an animation and its copies. Steps with altered durations must be distinct
     HLSAnimation *animation = [[self copy] autorelease];
+    animation.animationSteps = [HLSAnimation duplicateAnimationSteps:self.animationSteps];
     
     // Find out which factor must be applied to each animation step to preserve the animation appearance for the
     // specified duration
@@ -475,20 +746,76 @@ static NSString * const kDelayLayerAnimationTag = @"HLSDelayLayerAnimationStep";
     return animation;
 }
 
+/**
+ * The reverse animation steps are calculated once. Since they are never played directly, they can be shared
+ * between all reverse animations created from the receiver
+ */
 - (NSArray *)reverseAnimationSteps
 {
-    NSMutableArray *reverseAnimationSteps = [NSMutableArray array];
-    for (HLSAnimationStep *animationStep in [self.animationSteps reverseObjectEnumerator]) {
-        [reverseAnimationSteps addObject:[animationStep reverseAnimationStep]];
+    if (! m_reverseAnimationSteps) {
+        NSMutableArray *reverseAnimationSteps = [NSMutableArray array];
+        for (HLSAnimationStep *animationStep in [self.animationSteps reverseObjectEnumerator]) {
+            [reverseAnimationSteps addObject:[animationStep reverseAnimationStep]];
+        }
+        m_reverseAnimationSteps = [[NSArray alloc] initWithArray:reverseAnimationSteps];
     }
-    return [NSArray arrayWithArray:reverseAnimationSteps];
+    return m_reverseAnimationSteps;
+}
+
+/**
+ * Return an array containing a single step playing all animation steps received as parameter, or the steps themselves
+ * if they cannot be baked
+ */
+- (NSArray *)bakedAnimationStepsFromAnimationSteps:(NSArray *)animationSteps
+{
+    if ([animationSteps count] < 2) {
+        return animationSteps;
+    }
+    
+    for (HLSAnimationStep *animationStep in animationSteps) {
+        if (! [animationStep isKindOfClass:[HLSLayerAnimationStep class]]) {
+            return animationSteps;
+        }
+    }
+    
+    HLSLayerAnimationStep *bakedAnimationStep = [HLSLayerAnimationStep bakedAnimationStepWithAnimationSteps:animationSteps];
+    bakedAnimationStep.tag = kBakedLayerAnimationTag;
+    return [NSArray arrayWithObject:bakedAnimationStep];
+}
+
+/**
+ * For loop animations made only of layer animation steps, return an array containing a single step playing the whole
+ * loop repeatCount times. Return nil if this is not possible
+ */
+- (NSArray *)loopingBakedAnimationStepsFromAnimationSteps:(NSArray *)animationSteps repeatCount:(NSUInteger)repeatCount
+{
+    if (self.loopAnimationStepCount == 0 || [animationSteps count] != 2 * self.loopAnimationStepCount) {
+        return nil;
+    }
+    
+    for (HLSAnimationStep *animationStep in animationSteps) {
+        if (! [animationStep isKindOfClass:[HLSLayerAnimationStep class]]) {
+            return nil;
+        }
+    }
+    
+    NSRange forwardRange = NSMakeRange(0, self.loopAnimationStepCount);
+    NSRange reverseRange = NSMakeRange(self.loopAnimationStepCount, self.loopAnimationStepCount);
+    HLSLayerAnimationStep *bakedAnimationStep = [HLSLayerAnimationStep loopingBakedAnimationStepWithAnimationSteps:[animationSteps subarrayWithRange:forwardRange]
+                                                                                            reverseAnimationSteps:[animationSteps subarrayWithRange:reverseRange]
+                                                                                                      repeatCount:repeatCount];
+    bakedAnimationStep.tag = kBakedLayerAnimationTag;
+    return [NSArray arrayWithObject:bakedAnimationStep];
 }
 
 - (HLSAnimation *)reverseAnimation
 {
-    HLSAnimation *reverseAnimation = [HLSAnimation animationWithAnimationSteps:[self reverseAnimationSteps]];
+    HLSAnimation *reverseAnimation = [HLSAnimation animationWithAnimationSteps:nil];
+    reverseAnimation.animationSteps = [self reverseAnimationSteps];
     reverseAnimation.tag = [self.tag isFilled] ? [NSString stringWithFormat:@"reverse_%@", self.tag] : nil;
     reverseAnimation.lockingUI = self.lockingUI;
+    reverseAnimation.baked = self.baked;
+    reverseAnimation.frameMonitoringEnabled = self.frameMonitoringEnabled;
     reverseAnimation.delegate = self.delegate;
     reverseAnimation.userInfo = self.userInfo;
     
@@ -497,17 +824,22 @@ static NSString * const kDelayLayerAnimationTag = @"HLSDelayLayerAnimationStep";
 
 - (HLSAnimation *)loopAnimation
 {
-    NSMutableArray *animationSteps = [NSMutableArray arrayWithArray:self.animationSteps];
-    [animationSteps addObjectsFromArray:[self reverseAnimationSteps]];
+    // Work on copies, since tags are altered
+    NSMutableArray *animationSteps = [NSMutableArray arrayWithArray:[HLSAnimation duplicateAnimationSteps:self.animationSteps]];
+    [animationSteps addObjectsFromArray:[HLSAnimation duplicateAnimationSteps:[self reverseAnimationSteps]]];
     
     // Add a loop_ prefix to all animation step tags
     for (HLSAnimationStep *animationStep in animationSteps) {
         animationStep.tag = [animationStep.tag isFilled] ? [NSString stringWithFormat:@"loop_%@", animationStep.tag] : nil;
     }
     
-    HLSAnimation *loopAnimation = [HLSAnimation animationWithAnimationSteps:[NSArray arrayWithArray:animationSteps]];
+    HLSAnimation *loopAnimation = [HLSAnimation animationWithAnimationSteps:nil];
+    loopAnimation.animationSteps = [NSArray arrayWithArray:animationSteps];
+    loopAnimation.loopAnimationStepCount = [self.animationSteps count];
     loopAnimation.tag = [self.tag isFilled] ? [NSString stringWithFormat:@"loop_%@", self.tag] : nil;
     loopAnimation.lockingUI = self.lockingUI;
+    loopAnimation.baked = self.baked;
+    loopAnimation.frameMonitoringEnabled = self.frameMonitoringEnabled;
     loopAnimation.delegate = self.delegate;
     loopAnimation.userInfo = self.userInfo;
     
@@ -535,7 +867,8 @@ static NSString * const kDelayLayerAnimationTag = @"HLSDelayLayerAnimationStep";
                 self.started = YES;
             }
         }
-        else {
+        // The steps merged into a baked step do not end separately
+        else if (! [animationStep.tag isEqualToString:kBakedLayerAnimationTag]) {
             if ([self.delegate respondsToSelector:@selector(animation:didFinishStep:animated:)]) {
                 [self.delegate animation:self didFinishStep:animationStep animated:animated];
             }
@@ -547,6 +880,20 @@ static NSString * const kDelayLayerAnimationTag = @"HLSDelayLayerAnimationStep";
         m_elapsedTime += [self.currentAnimationStep duration];
     }
     
+    // Record steps which have actually been played animated
+    if (self.displayLink && finished && animated && doubleeq(m_remainingTimeBeforeStart, 0.)
+            && ! [animationStep.tag isEqualToString:kDelayLayerAnimationTag]
+            && doublegt(m_currentAnimationStepRequestedDuration, 0.)) {
+        [self.metrics recordStepWithTag:animationStep.tag
+                      requestedDuration:m_currentAnimationStepRequestedDuration
+                         actualDuration:CACurrentMediaTime() - m_currentAnimationStepStartTime];
+    }
+    
+    // Steps played instantaneously to reach the start time are played in sequence by -skipAnimationStepsBeforeStartTime
+    if (m_skippingAnimationSteps) {
+        return;
+    }
+    
     // Play the next step (or the first step if the initial delay animation step has ended(), but non-animated if the
     // animation did not reach completion normally. Moreover, if some animation steps are played non-animated because
     // a start time has been set, we must override animated = NO with the original m_animated value of the animation
@@ -557,31 +904,29 @@ static NSString * const kDelayLayerAnimationTag = @"HLSDelayLayerAnimationStep";
 
 - (id)copyWithZone:(NSZone *)zone
 {
-    HLSAnimation *animationCopy = nil;
-    if (self.animationSteps) {
-        NSMutableArray *animationStepCopies = [NSMutableArray array];
-        for (HLSAnimationStep *animationStep in self.animationSteps) {
-            HLSAnimationStep *animationStepCopy = [[animationStep copyWithZone:zone] autorelease];
-            [animationStepCopies addObject:animationStepCopy];
-        }
-        animationCopy = [[HLSAnimation allocWithZone:zone] initWithAnimationSteps:[NSMutableArray arrayWithArray:animationStepCopies]];
-    }
-    else {
-        animationCopy = [[HLSAnimation allocWithZone:zone] initWithAnimationSteps:nil];
-    }
+    // The animation steps are never played directly (copies are), and are never altered. They can therefore be shared
+    HLSAnimation *animationCopy = [[HLSAnimation allocWithZone:zone] initWithAnimationSteps:nil];
+    animationCopy.animationSteps = self.animationSteps;
+    animationCopy.loopAnimationStepCount = self.loopAnimationStepCount;
     
     animationCopy.tag = self.tag;
     animationCopy.lockingUI = self.lockingUI;
+    animationCopy.baked = self.baked;
+    animationCopy.frameMonitoringEnabled = self.frameMonitoringEnabled;
     animationCopy.delegate = self.delegate;
     animationCopy.userInfo = self.userInfo;
     
     return animationCopy;
 }
 
-#pragma mark Notification callbacks
+#pragma mark Application state changes
 
-- (void)applicationDidEnterBackground:(NSNotification *)notification
+- (BOOL)suspendBeforeEnteringBackground
 {
+    if (! self.handlingApplicationStateChanges) {
+        return NO;
+    }
+    
     m_runningBeforeEnteringBackground = self.running;
     
     if (m_runningBeforeEnteringBackground) {
@@ -601,9 +946,11 @@ static NSString * const kDelayLayerAnimationTag = @"HLSDelayLayerAnimationStep";
         reverseAnimation.delegate = nil;
         [reverseAnimation playAnimated:NO];
     }
+    
+    return m_runningBeforeEnteringBackground;
 }
 
-- (void)applicationWillEnterForeground:(NSNotification *)notification
+- (void)resumeAfterEnteringForeground
 {
     if (m_runningBeforeEnteringBackground) {
         [self playWithStartTime:m_elapsedTime repeatCount:m_repeatCount];
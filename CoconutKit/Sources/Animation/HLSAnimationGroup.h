@@ -0,0 +1,148 @@
+//
+//  HLSAnimationGroup.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSAnimation.h"
+
+// Forward declarations
+@class HLSUserInterfaceLockToken;
+@class HLSZeroingWeakRef;
+@protocol HLSAnimationGroupDelegate;
+
+/**
+ * An animation (HLSAnimation) plays its steps one after the other. To play several sequences of steps in parallel,
+ * create an animation for each of them and add them to an animation group, each with an offset measuring when
+ * it must start relative to the beginning of the group. All animations in a group are started together (in the 
+ * same Core Animation transaction) and share the same clock.
+ *
+ * An animation group manages the lifecycle of its animations once for all of them:
+ *   - a single delegate is notified when the group starts and when all its animations have ended. The delegates
+ *     of the animations added to a group are not notified
+ *   - the UI is locked once for the whole group if lockingUI is set to YES. The lockingUI property of the 
+ *     animations added to a group is ignored
+ *   - the group interrupts and resumes all its animations when the application enters background, respectively
+ *     foreground, restoring them with respect to the same clock
+ *
+ * Designated initializer: -init (create an empty animation group)
+ */
+@interface HLSAnimationGroup : NSObject {
+@private
+    NSMutableArray *m_tracks;
+    NSString *m_tag;
+    NSDictionary *m_userInfo;
+    BOOL m_lockingUI;
+    HLSUserInterfaceLockToken *m_userInterfaceLockToken;
+    NSUInteger m_numberOfRunningTracks;
+    CFTimeInterval m_startTime;
+    CFTimeInterval m_pauseTime;
+    CFTimeInterval m_pauseDuration;
+    BOOL m_animated;
+    BOOL m_running;
+    BOOL m_paused;
+    BOOL m_cancelling;
+    BOOL m_terminating;
+    NSTimeInterval m_elapsedTimeBeforeEnteringBackground;
+    BOOL m_runningBeforeEnteringBackground;
+    BOOL m_pausedBeforeEnteringBackground;
+    HLSZeroingWeakRef *m_delegateZeroingWeakRef;
+}
+
+/**
+ * Convenience constructor for an empty animation group
+ */
++ (HLSAnimationGroup *)animationGroup;
+
+/**
+ * Add an animation to the group, starting after the specified offset (measured from the beginning of the group). The 
+ * animation is copied. Animations cannot be added while the group is running
+ */
+- (void)addAnimation:(HLSAnimation *)animation withOffset:(NSTimeInterval)offset;
+
+/**
+ * Tag which can optionally be used to help identifying an animation group
+ */
+@property (nonatomic, retain) NSString *tag;
+
+/**
+ * Dictionary which can be freely used to convey additional information
+ */
+@property (nonatomic, retain) NSDictionary *userInfo;
+
+/**
+ * If set to YES, the user interface interaction is blocked while the group is running
+ *
+ * Default value is NO
+ */
+@property (nonatomic, assign) BOOL lockingUI;
+
+/**
+ * The group delegate. The delegate is not retained
+ */
+@property (nonatomic, assign) id<HLSAnimationGroupDelegate> delegate;
+
+/**
+ * Play all animations in the group, animated or not
+ */
+- (void)playAnimated:(BOOL)animated;
+
+/**
+ * Play all animations in the group (animated), starting at a given time measured from the beginning of the group
+ */
+- (void)playWithStartTime:(NSTimeInterval)startTime;
+
+/**
+ * Pause, resume, cancel or terminate all animations in the group, with the same semantics as the equivalent 
+ * HLSAnimation methods
+ */
+- (void)pause;
+- (void)resume;
+- (void)cancel;
+- (void)terminate;
+
+/**
+ * Total duration of the group, i.e. the time at which its last animation ends
+ */
+@property (nonatomic, readonly, assign) NSTimeInterval duration;
+
+/**
+ * The time elapsed since the group was started (pauses are not taken into account)
+ */
+@property (nonatomic, readonly, assign) NSTimeInterval elapsedTime;
+
+/**
+ * Return YES iff the group is running
+ */
+@property (nonatomic, readonly, assign, getter=isRunning) BOOL running;
+
+/**
+ * Return YES iff the group has been paused
+ */
+@property (nonatomic, readonly, assign, getter=isPaused) BOOL paused;
+
+/**
+ * Return YES iff the group is being cancelled, respectively terminated
+ */
+@property (nonatomic, readonly, assign, getter=isCancelling) BOOL cancelling;
+@property (nonatomic, readonly, assign, getter=isTerminating) BOOL terminating;
+
+@end
+
+@protocol HLSAnimationGroupDelegate <NSObject>
+@optional
+
+/**
+ * Called right before the animations in the group are started
+ */
+- (void)animationGroupWillStart:(HLSAnimationGroup *)animationGroup animated:(BOOL)animated;
+
+/**
+ * Called right after the last animation in the group has ended. You can check -terminating to find if the group 
+ * ended normally. This method is not called when the group is cancelled
+ */
+- (void)animationGroupDidStop:(HLSAnimationGroup *)animationGroup animated:(BOOL)animated;
+
+@end
@@ -0,0 +1,463 @@
+//
+//  HLSAnimationGroup.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSAnimationGroup.h"
+
+#import "HLSAnimation+Friend.h"
+#import "HLSAnimationRegistry.h"
+#import "HLSAssert.h"
+#import "HLSConverters.h"
+#import "HLSFloat.h"
+#import "HLSLogger.h"
+#import "HLSUserInterfaceLock.h"
+#import "HLSZeroingWeakRef.h"
+
+/**
+ * An animation played by a group, with its offset
+ */
+@interface HLSAnimationGroupTrack : NSObject {
+@private
+    HLSAnimation *m_animation;
+    NSTimeInterval m_offset;
+    BOOL m_running;
+}
+
+- (id)initWithAnimation:(HLSAnimation *)animation offset:(NSTimeInterval)offset;
+
+@property (nonatomic, readonly, retain) HLSAnimation *animation;
+@property (nonatomic, readonly, assign) NSTimeInterval offset;
+@property (nonatomic, assign, getter=isRunning) BOOL running;
+
+@end
+
+@interface HLSAnimationGroup () <HLSAnimationDelegate, HLSSuspendableAnimation>
+
+@property (nonatomic, retain) NSMutableArray *tracks;
+@property (nonatomic, retain) HLSUserInterfaceLockToken *userInterfaceLockToken;
+@property (nonatomic, assign, getter=isRunning) BOOL running;
+@property (nonatomic, assign, getter=isPaused) BOOL paused;
+@property (nonatomic, assign, getter=isCancelling) BOOL cancelling;
+@property (nonatomic, assign, getter=isTerminating) BOOL terminating;
+@property (nonatomic, retain) HLSZeroingWeakRef *delegateZeroingWeakRef;
+
+- (void)playWithStartTime:(NSTimeInterval)startTime animated:(BOOL)animated;
+- (void)finishAnimated:(BOOL)animated;
+
+@end
+
+@implementation HLSAnimationGroup
+
+#pragma mark Class methods
+
++ (HLSAnimationGroup *)animationGroup
+{
+    return [[[[self class] alloc] init] autorelease];
+}
+
+#pragma mark Object creation and destruction
+
+- (id)init
+{
+    if ((self = [super init])) {
+        self.tracks = [NSMutableArray array];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [self cancel];
+    [[HLSAnimationRegistry sharedRegistry] discardAnimation:self];
+    
+    self.tracks = nil;
+    self.tag = nil;
+    self.userInfo = nil;
+    self.userInterfaceLockToken = nil;
+    self.delegateZeroingWeakRef = nil;
+    
+    [super dealloc];
+}
+
+#pragma mark Accessors and mutators
+
+@synthesize tracks = m_tracks;
+
+@synthesize tag = m_tag;
+
+@synthesize userInfo = m_userInfo;
+
+@synthesize lockingUI = m_lockingUI;
+
+@synthesize userInterfaceLockToken = m_userInterfaceLockToken;
+
+@synthesize running = m_running;
+
+@synthesize paused = m_paused;
+
+@synthesize cancelling = m_cancelling;
+
+@synthesize terminating = m_terminating;
+
+@synthesize delegateZeroingWeakRef = m_delegateZeroingWeakRef;
+
+- (id<HLSAnimationGroupDelegate>)delegate
+{
+    return self.delegateZeroingWeakRef.object;
+}
+
+- (void)setDelegate:(id<HLSAnimationGroupDelegate>)delegate
+{
+    self.delegateZeroingWeakRef = [[[HLSZeroingWeakRef alloc] initWithObject:delegate] autorelease];
+    [self.delegateZeroingWeakRef addCleanupAction:@selector(cancel) onTarget:self];
+}
+
+- (NSTimeInterval)duration
+{
+    NSTimeInterval duration = 0.;
+    for (HLSAnimationGroupTrack *track in self.tracks) {
+        duration = MAX(duration, track.offset + track.animation.duration);
+    }
+    return duration;
+}
+
+- (NSTimeInterval)elapsedTime
+{
+    if (! self.running) {
+        return 0.;
+    }
+    
+    CFTimeInterval currentTime = self.paused ? m_pauseTime : CACurrentMediaTime();
+    return currentTime - m_startTime - m_pauseDuration;
+}
+
+#pragma mark Managing animations
+
+- (void)addAnimation:(HLSAnimation *)animation withOffset:(NSTimeInterval)offset
+{
+    if (! animation) {
+        HLSLoggerError(@"Missing animation");
+        return;
+    }
+    
+    if (self.running) {
+        HLSLoggerError(@"Cannot add an animation to a running group");
+        return;
+    }
+    
+    if (doublelt(offset, 0.)) {
+        HLSLoggerWarn(@"The offset cannot be negative. Fixed to 0");
+        offset = 0.;
+    }
+    
+    // The copy is managed by the group, which receives its events and locks the UI once for all animations
+    HLSAnimation *animationCopy = [[animation copy] autorelease];
+    animationCopy.delegate = self;
+    animationCopy.lockingUI = NO;
+    animationCopy.handlingApplicationStateChanges = NO;
+    
+    HLSAnimationGroupTrack *track = [[[HLSAnimationGroupTrack alloc] initWithAnimation:animationCopy offset:offset] autorelease];
+    [self.tracks addObject:track];
+}
+
+#pragma mark Animation
+
+- (void)playAnimated:(BOOL)animated
+{
+    [self playWithStartTime:0. animated:animated];
+}
+
+- (void)playWithStartTime:(NSTimeInterval)startTime
+{
+    [self playWithStartTime:startTime animated:YES];
+}
+
+- (void)playWithStartTime:(NSTimeInterval)startTime animated:(BOOL)animated
+{
+    if (self.running) {
+        HLSLoggerDebug(@"The animation group is already running");
+        return;
+    }
+    
+    if (doublelt(startTime, 0.)) {
+        HLSLoggerWarn(@"The start time cannot be negative. Fixed to 0");
+        startTime = 0.;
+    }
+    
+    self.running = YES;
+    m_animated = animated;
+    
+    // Application state changes are handled by the registry for all running animations and groups. The group handles
+    // them once for all its animations
+    [[HLSAnimationRegistry sharedRegistry] registerAnimation:self];
+    
+    // All animations share the same clock, started now (and set back if a start time has been given)
+    m_startTime = CACurrentMediaTime() - startTime;
+    m_pauseTime = 0.;
+    m_pauseDuration = 0.;
+    
+    if (self.lockingUI) {
+        self.userInterfaceLockToken = [[HLSUserInterfaceLock sharedUserInterfaceLock] lockTokenWithReason:@"Animation group"];
+    }
+    
+    if ([self.delegate respondsToSelector:@selector(animationGroupWillStart:animated:)]) {
+        [self.delegate animationGroupWillStart:self animated:animated];
+    }
+    
+    if ([self.tracks count] == 0) {
+        [self finishAnimated:animated];
+        return;
+    }
+    
+    // Mark all tracks as running before any animation is played, since animations played non-animated end immediately
+    m_numberOfRunningTracks = [self.tracks count];
+    for (HLSAnimationGroupTrack *track in self.tracks) {
+        track.running = YES;
+    }
+    
+    // Start all animations at once. The changes they make are committed together
+    [CATransaction begin];
+    for (HLSAnimationGroupTrack *track in [NSArray arrayWithArray:self.tracks]) {
+        HLSAnimation *animation = track.animation;
+        NSTimeInterval trackStartTime = startTime - track.offset;
+        if (! animated) {
+            [animation playAnimated:NO];
+        }
+        else if (doublelt(trackStartTime, 0.)) {
+            [animation playAfterDelay:-trackStartTime];
+        }
+        else {
+            [animation playWithStartTime:MIN(trackStartTime, animation.duration)];
+        }
+    }
+    [CATransaction commit];
+}
+
+- (void)pause
+{
+    if (! self.running || self.paused) {
+        HLSLoggerDebug(@"The animation group is not running or already paused");
+        return;
+    }
+    
+    for (HLSAnimationGroupTrack *track in self.tracks) {
+        if (track.running) {
+            [track.animation pause];
+        }
+    }
+    
+    m_pauseTime = CACurrentMediaTime();
+    self.paused = YES;
+}
+
+- (void)resume
+{
+    if (! self.paused) {
+        HLSLoggerDebug(@"The animation group has not been paused. Nothing to resume");
+        return;
+    }
+    
+    for (HLSAnimationGroupTrack *track in self.tracks) {
+        if (track.running) {
+            [track.animation resume];
+        }
+    }
+    
+    m_pauseDuration += CACurrentMediaTime() - m_pauseTime;
+    m_pauseTime = 0.;
+    self.paused = NO;
+}
+
+- (void)cancel
+{
+    if (! self.running) {
+        HLSLoggerDebug(@"The animation group is not running, nothing to cancel");
+        return;
+    }
+    
+    if (self.cancelling || self.terminating) {
+        HLSLoggerDebug(@"The animation group is already being cancelled or terminated");
+        return;
+    }
+    
+    self.cancelling = YES;
+    
+    // Cancelled animations do not notify their delegate. Account for them here
+    for (HLSAnimationGroupTrack *track in [NSArray arrayWithArray:self.tracks]) {
+        if (track.running) {
+            [track.animation cancel];
+            track.running = NO;
+        }
+    }
+    m_numberOfRunningTracks = 0;
+    
+    [self finishAnimated:NO];
+}
+
+- (void)terminate
+{
+    if (! self.running) {
+        HLSLoggerDebug(@"The animation group is not running, nothing to terminate");
+        return;
+    }
+    
+    if (self.cancelling || self.terminating) {
+        HLSLoggerDebug(@"The animation group is already being cancelled or terminated");
+        return;
+    }
+    
+    self.terminating = YES;
+    
+    // Terminated animations notify their delegate synchronously. The group ends when the last one does
+    for (HLSAnimationGroupTrack *track in [NSArray arrayWithArray:self.tracks]) {
+        if (track.running) {
+            [track.animation terminate];
+        }
+    }
+}
+
+- (void)finishAnimated:(BOOL)animated
+{
+    [self.userInterfaceLockToken relinquish];
+    self.userInterfaceLockToken = nil;
+    
+    self.paused = NO;
+    
+    if (! self.cancelling) {
+        if ([self.delegate respondsToSelector:@selector(animationGroupDidStop:animated:)]) {
+            [self.delegate animationGroupDidStop:self animated:self.terminating ? NO : animated];
+        }
+    }
+    
+    self.running = NO;
+    [[HLSAnimationRegistry sharedRegistry] unregisterAnimation:self];
+    self.cancelling = NO;
+    self.terminating = NO;
+}
+
+#pragma mark HLSAnimationDelegate protocol implementation
+
+- (void)animationDidStop:(HLSAnimation *)animation animated:(BOOL)animated
+{
+    for (HLSAnimationGroupTrack *track in self.tracks) {
+        if (track.animation != animation) {
+            continue;
+        }
+        
+        if (! track.running) {
+            return;
+        }
+        
+        track.running = NO;
+        --m_numberOfRunningTracks;
+        if (m_numberOfRunningTracks == 0) {
+            [self finishAnimated:m_animated && animated];
+        }
+        return;
+    }
+}
+
+#pragma mark HLSSuspendableAnimation protocol implementation
+
+- (BOOL)suspendBeforeEnteringBackground
+{
+    m_runningBeforeEnteringBackground = self.running;
+    
+    if (m_runningBeforeEnteringBackground) {
+        // Same strategy as HLSAnimation, but applied to all animations in the group with respect to its clock: Remember 
+        // how much time has elapsed, cancel the group and rewind all animations (cancelled animations all reach their 
+        // end state, even those which had not started yet). The group is played again from the same time when the 
+        // application enters foreground
+        m_elapsedTimeBeforeEnteringBackground = self.elapsedTime;
+        m_pausedBeforeEnteringBackground = self.paused;
+        
+        [self cancel];
+        
+        for (HLSAnimationGroupTrack *track in [self.tracks reverseObjectEnumerator]) {
+            HLSAnimation *reverseAnimation = [track.animation reverseAnimation];
+            reverseAnimation.delegate = nil;
+            [reverseAnimation playAnimated:NO];
+        }
+    }
+    
+    return m_runningBeforeEnteringBackground;
+}
+
+- (void)resumeAfterEnteringForeground
+{
+    if (m_runningBeforeEnteringBackground) {
+        [self playWithStartTime:m_elapsedTimeBeforeEnteringBackground animated:YES];
+        if (m_pausedBeforeEnteringBackground) {
+            [self pause];
+        }
+        
+        m_runningBeforeEnteringBackground = NO;
+        m_pausedBeforeEnteringBackground = NO;
+    }
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; tracks: %@; tag: %@; lockingUI: %@; delegate: %p>",
+            [self class],
+            self,
+            self.tracks,
+            self.tag,
+            HLSStringFromBool(self.lockingUI),
+            self.delegate];
+}
+
+@end
+
+@implementation HLSAnimationGroupTrack
+
+#pragma mark Object creation and destruction
+
+- (id)initWithAnimation:(HLSAnimation *)animation offset:(NSTimeInterval)offset
+{
+    if ((self = [super init])) {
+        m_animation = [animation retain];
+        m_offset = offset;
+    }
+    return self;
+}
+
+- (id)init
+{
+    HLSForbiddenInheritedMethod();
+    return nil;
+}
+
+- (void)dealloc
+{
+    [m_animation release];
+    
+    [super dealloc];
+}
+
+#pragma mark Accessors and mutators
+
+@synthesize animation = m_animation;
+
+@synthesize offset = m_offset;
+
+@synthesize running = m_running;
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; animation: %@; offset: %.2f>",
+            [self class],
+            self,
+            self.animation,
+            self.offset];
+}
+
+@end
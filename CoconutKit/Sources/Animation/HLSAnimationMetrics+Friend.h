@@ -0,0 +1,31 @@
+//
+//  HLSAnimationMetrics+Friend.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+/**
+ * Interface meant to be used by friend classes of HLSAnimationMetrics (= classes which must have access to private 
+ * implementation details)
+ */
+@interface HLSAnimationMetrics (Friend)
+
+/**
+ * Set the tag of the animation the metrics are collected for
+ */
+- (void)setTag:(NSString *)tag;
+
+/**
+ * Record a frame, given the time elapsed since the previous one and the time which should have elapsed at the 
+ * display refresh rate
+ */
+- (void)recordFrameWithTimeInterval:(NSTimeInterval)timeInterval nominalTimeInterval:(NSTimeInterval)nominalTimeInterval;
+
+/**
+ * Record a step which has been played animated
+ */
+- (void)recordStepWithTag:(NSString *)tag requestedDuration:(NSTimeInterval)requestedDuration actualDuration:(NSTimeInterval)actualDuration;
+
+@end
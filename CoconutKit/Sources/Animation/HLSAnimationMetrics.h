@@ -0,0 +1,62 @@
+//
+//  HLSAnimationMetrics.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+/**
+ * Frame timing information collected while an animation was played animated with frame monitoring enabled (see
+ * HLSAnimation frameMonitoringEnabled property). Frames are sampled on the main thread using a display link: A
+ * frame is considered dropped when the display link was not able to fire at the expected display refresh rate, 
+ * which means the main thread was busy during that time. The longest time between two consecutive frames is the
+ * longest main thread stall which occurred during the animation
+ *
+ * The actual duration of each step played animated (from the moment it is started to the moment it ends, pauses
+ * included) is also recorded, together with the duration which was requested for it. The initial delay, as well 
+ * as steps played instantaneously (e.g. because of a start time) are not recorded. Several steps are recorded
+ * for a single step played several times (e.g. with a repeat count)
+ *
+ * Designated initializer: -init
+ */
+@interface HLSAnimationMetrics : NSObject {
+@private
+    NSString *m_tag;
+    NSUInteger m_frameCount;
+    NSUInteger m_droppedFrameCount;
+    NSTimeInterval m_maxFrameTimeInterval;
+    NSMutableArray *m_stepTags;
+    NSMutableArray *m_requestedStepDurations;
+    NSMutableArray *m_actualStepDurations;
+}
+
+/**
+ * The tag of the animation the metrics have been collected for
+ */
+@property (nonatomic, readonly, retain) NSString *tag;
+
+/**
+ * Number of frames displayed during the animation, and number of frames which should have been displayed but were not
+ */
+@property (nonatomic, readonly, assign) NSUInteger frameCount;
+@property (nonatomic, readonly, assign) NSUInteger droppedFrameCount;
+
+/**
+ * The longest time interval measured between two consecutive frames
+ */
+@property (nonatomic, readonly, assign) NSTimeInterval maxFrameTimeInterval;
+
+/**
+ * Number of animation steps which have been recorded
+ */
+- (NSUInteger)stepCount;
+
+/**
+ * Information about a recorded step (nil is returned for a step without tag)
+ */
+- (NSString *)tagForStepAtIndex:(NSUInteger)index;
+- (NSTimeInterval)requestedDurationForStepAtIndex:(NSUInteger)index;
+- (NSTimeInterval)actualDurationForStepAtIndex:(NSUInteger)index;
+
+@end
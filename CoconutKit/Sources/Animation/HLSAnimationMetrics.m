@@ -0,0 +1,144 @@
+//
+//  HLSAnimationMetrics.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSAnimationMetrics.h"
+
+#import "HLSAnimationMetrics+Friend.h"
+#import "HLSFloat.h"
+#import "HLSLogger.h"
+
+@interface HLSAnimationMetrics ()
+
+@property (nonatomic, retain) NSString *tag;
+@property (nonatomic, assign) NSUInteger frameCount;
+@property (nonatomic, assign) NSUInteger droppedFrameCount;
+@property (nonatomic, assign) NSTimeInterval maxFrameTimeInterval;
+@property (nonatomic, retain) NSMutableArray *stepTags;
+@property (nonatomic, retain) NSMutableArray *requestedStepDurations;
+@property (nonatomic, retain) NSMutableArray *actualStepDurations;
+
+@end
+
+@implementation HLSAnimationMetrics
+
+#pragma mark Object creation and destruction
+
+- (id)init
+{
+    if ((self = [super init])) {
+        self.stepTags = [NSMutableArray array];
+        self.requestedStepDurations = [NSMutableArray array];
+        self.actualStepDurations = [NSMutableArray array];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    self.tag = nil;
+    self.stepTags = nil;
+    self.requestedStepDurations = nil;
+    self.actualStepDurations = nil;
+    
+    [super dealloc];
+}
+
+#pragma mark Accessors and mutators
+
+@synthesize tag = m_tag;
+
+@synthesize frameCount = m_frameCount;
+
+@synthesize droppedFrameCount = m_droppedFrameCount;
+
+@synthesize maxFrameTimeInterval = m_maxFrameTimeInterval;
+
+@synthesize stepTags = m_stepTags;
+
+@synthesize requestedStepDurations = m_requestedStepDurations;
+
+@synthesize actualStepDurations = m_actualStepDurations;
+
+- (NSUInteger)stepCount
+{
+    return [self.actualStepDurations count];
+}
+
+- (NSString *)tagForStepAtIndex:(NSUInteger)index
+{
+    if (index >= [self stepCount]) {
+        HLSLoggerError(@"Invalid step index");
+        return nil;
+    }
+    
+    id tag = [self.stepTags objectAtIndex:index];
+    return (tag != [NSNull null]) ? tag : nil;
+}
+
+- (NSTimeInterval)requestedDurationForStepAtIndex:(NSUInteger)index
+{
+    if (index >= [self stepCount]) {
+        HLSLoggerError(@"Invalid step index");
+        return 0.;
+    }
+    
+    return [[self.requestedStepDurations objectAtIndex:index] doubleValue];
+}
+
+- (NSTimeInterval)actualDurationForStepAtIndex:(NSUInteger)index
+{
+    if (index >= [self stepCount]) {
+        HLSLoggerError(@"Invalid step index");
+        return 0.;
+    }
+    
+    return [[self.actualStepDurations objectAtIndex:index] doubleValue];
+}
+
+#pragma mark Recording
+
+- (void)recordFrameWithTimeInterval:(NSTimeInterval)timeInterval nominalTimeInterval:(NSTimeInterval)nominalTimeInterval
+{
+    ++self.frameCount;
+    
+    // Number of refresh periods elapsed since the previous frame. All but one of them correspond to dropped frames
+    if (doublegt(nominalTimeInterval, 0.)) {
+        NSUInteger periodCount = (NSUInteger)round(timeInterval / nominalTimeInterval);
+        if (periodCount > 1) {
+            self.droppedFrameCount += periodCount - 1;
+        }
+    }
+    
+    if (doublegt(timeInterval, self.maxFrameTimeInterval)) {
+        self.maxFrameTimeInterval = timeInterval;
+    }
+}
+
+- (void)recordStepWithTag:(NSString *)tag requestedDuration:(NSTimeInterval)requestedDuration actualDuration:(NSTimeInterval)actualDuration
+{
+    [self.stepTags addObject:tag ? (id)tag : (id)[NSNull null]];
+    [self.requestedStepDurations addObject:[NSNumber numberWithDouble:requestedDuration]];
+    [self.actualStepDurations addObject:[NSNumber numberWithDouble:actualDuration]];
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; tag: %@; frameCount: %d; droppedFrameCount: %d; maxFrameTimeInterval: %.3f; "
+            "stepCount: %d>",
+            [self class],
+            self,
+            self.tag,
+            self.frameCount,
+            self.droppedFrameCount,
+            self.maxFrameTimeInterval,
+            [self stepCount]];
+}
+
+@end
@@ -0,0 +1,59 @@
+//
+//  HLSAnimationRegistry.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+// Forward declarations
+@protocol HLSSuspendableAnimation;
+
+/**
+ * Private class for implementation purposes. A single registry observes application background / foreground 
+ * notifications on behalf of all running animations (HLSAnimation and HLSAnimationGroup objects), suspending them 
+ * when the application enters background and resuming them when it enters foreground, all in one pass. Registering 
+ * and unregistering an animation are O(1) operations, and animations are not retained.
+ *
+ * Not meant to be instantiated directly. Simply use the +sharedRegistry class method.
+ */
+@interface HLSAnimationRegistry : NSObject {
+@private
+    CFMutableSetRef m_runningAnimations;
+    CFMutableSetRef m_suspendedAnimations;
+}
+
+/**
+ * The shared registry
+ */
++ (HLSAnimationRegistry *)sharedRegistry;
+
+/**
+ * Must be called when an animation starts, respectively stops running
+ */
+- (void)registerAnimation:(id<HLSSuspendableAnimation>)animation;
+- (void)unregisterAnimation:(id<HLSSuspendableAnimation>)animation;
+
+/**
+ * Must be called when an animation is deallocated, so that it is not resumed if it was suspended
+ */
+- (void)discardAnimation:(id<HLSSuspendableAnimation>)animation;
+
+@end
+
+/**
+ * Protocol implemented by the objects registered with the animation registry
+ */
+@protocol HLSSuspendableAnimation <NSObject>
+
+/**
+ * Called when the application enters background. Return YES iff the animation was running and has been suspended
+ */
+- (BOOL)suspendBeforeEnteringBackground;
+
+/**
+ * Called when the application enters foreground, for animations which have been suspended
+ */
+- (void)resumeAfterEnteringForeground;
+
+@end
@@ -0,0 +1,129 @@
+//
+//  HLSAnimationRegistry.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSAnimationRegistry.h"
+
+// Function declarations
+static NSArray *animationsInSet(CFSetRef set);
+
+@interface HLSAnimationRegistry ()
+
+- (void)applicationDidEnterBackground:(NSNotification *)notification;
+- (void)applicationWillEnterForeground:(NSNotification *)notification;
+
+@end
+
+@implementation HLSAnimationRegistry
+
+#pragma mark Class methods
+
++ (HLSAnimationRegistry *)sharedRegistry
+{
+    static HLSAnimationRegistry *s_instance = nil;
+    
+    if (! s_instance) {
+        s_instance = [[HLSAnimationRegistry alloc] init];
+    }
+    return s_instance;
+}
+
+#pragma mark Object creation and destruction
+
+- (id)init
+{
+    if ((self = [super init])) {
+        // Animations are not retained (they unregister themselves when they stop running or are deallocated)
+        m_runningAnimations = CFSetCreateMutable(kCFAllocatorDefault, 0, NULL);
+        m_suspendedAnimations = CFSetCreateMutable(kCFAllocatorDefault, 0, NULL);
+        
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(applicationDidEnterBackground:)
+                                                     name:UIApplicationDidEnterBackgroundNotification
+                                                   object:nil];
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(applicationWillEnterForeground:)
+                                                     name:UIApplicationWillEnterForegroundNotification
+                                                   object:nil];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [[NSNotificationCenter defaultCenter] removeObserver:self
+                                                    name:UIApplicationDidEnterBackgroundNotification
+                                                  object:nil];
+    [[NSNotificationCenter defaultCenter] removeObserver:self
+                                                    name:UIApplicationWillEnterForegroundNotification
+                                                  object:nil];
+    
+    CFRelease(m_runningAnimations);
+    CFRelease(m_suspendedAnimations);
+    
+    [super dealloc];
+}
+
+#pragma mark Registration
+
+- (void)registerAnimation:(id<HLSSuspendableAnimation>)animation
+{
+    CFSetAddValue(m_runningAnimations, animation);
+}
+
+- (void)unregisterAnimation:(id<HLSSuspendableAnimation>)animation
+{
+    CFSetRemoveValue(m_runningAnimations, animation);
+}
+
+- (void)discardAnimation:(id<HLSSuspendableAnimation>)animation
+{
+    CFSetRemoveValue(m_runningAnimations, animation);
+    CFSetRemoveValue(m_suspendedAnimations, animation);
+}
+
+#pragma mark Notification callbacks
+
+- (void)applicationDidEnterBackground:(NSNotification *)notification
+{
+    // Suspended animations stop running and unregister themselves, iterate over a snapshot (which also keeps them alive
+    // in case they get released as a side effect of being cancelled)
+    NSArray *runningAnimations = animationsInSet(m_runningAnimations);
+    for (id<HLSSuspendableAnimation> animation in runningAnimations) {
+        if ([animation suspendBeforeEnteringBackground]) {
+            CFSetAddValue(m_suspendedAnimations, animation);
+        }
+    }
+}
+
+- (void)applicationWillEnterForeground:(NSNotification *)notification
+{
+    NSArray *suspendedAnimations = animationsInSet(m_suspendedAnimations);
+    CFSetRemoveAllValues(m_suspendedAnimations);
+    
+    for (id<HLSSuspendableAnimation> animation in suspendedAnimations) {
+        [animation resumeAfterEnteringForeground];
+    }
+}
+
+@end
+
+#pragma mark Static functions
+
+static NSArray *animationsInSet(CFSetRef set)
+{
+    CFIndex count = CFSetGetCount(set);
+    if (count == 0) {
+        return [NSArray array];
+    }
+    
+    const void **values = malloc(count * sizeof(const void *));
+    CFSetGetValues(set, values);
+    NSArray *animations = [NSArray arrayWithObjects:(id *)values count:count];
+    free(values);
+    return animations;
+}
@@ -21,6 +21,12 @@
  */
 - (void)playWithDelegate:(id<HLSAnimationStepDelegate>)delegate startTime:(NSTimeInterval)startTime animated:(BOOL)animated;
 
+/**
+ * Apply the changes of the step instantaneously, without any delegate event. Since the state of the step is not altered,
+ * the same step can be played this way several times in a row, or while another copy of it is running
+ */
+- (void)playInstantaneously;
+
 /**
  * Pause the animation step being played (does nothing if the animation is not running or not animated)
  */
@@ -31,6 +37,12 @@
  */
 - (void)resume;
 
+/**
+ * Move a paused animation step to a given time (between 0 and self.duration). Does nothing if the animation step has
+ * not been paused
+ */
+- (void)seekToTime:(NSTimeInterval)time;
+
 /**
  * Terminate the animation (if running). The delegate will still receive the willStart / didStop events
  */
@@ -47,11 +59,22 @@
  */
 - (id)reverseAnimationStep;
 
+/**
+ * Replace an object altered by the step with another one, keeping the same animation (does nothing if the object
+ * is not altered by the step)
+ */
+- (void)replaceObject:(id)object withObject:(id)replacementObject;
+
 /**
  * Return YES iff the animation has been paused
  */
 @property (nonatomic, readonly, assign, getter=isPaused) BOOL paused;
 
+/**
+ * Return YES iff the animation step is still waiting for its animation to end, and therefore cannot be played again
+ */
+@property (nonatomic, readonly, assign, getter=isWaitingForCompletion) BOOL waitingForCompletion;
+
 @end
 
 @protocol HLSAnimationStepDelegate <NSObject>
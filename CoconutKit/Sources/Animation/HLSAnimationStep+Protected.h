@@ -31,6 +31,13 @@
  */
 - (NSArray *)objects;
 
+/**
+ * All object animations in the step, returned in the same order as the objects they are attached to (see -objects).
+ * When applying the animations of many objects, iterate over both arrays rather than looking up the animation 
+ * of each object
+ */
+- (NSArray *)objectAnimations;
+
 /**
  * Return YES iff the step is running
  */
@@ -67,6 +74,14 @@
  */
 - (void)resumeAnimation;
 
+/**
+ * This method can be implemented by subclasses to move a paused animation step to a given time (between 0 and
+ * self.duration). The elapsed time must be updated accordingly
+ *
+ * The super method implementation must not be called (it does nothing, meaning seeking is not supported)
+ */
+- (void)seekAnimationToTime:(NSTimeInterval)time;
+
 /**
  * This method must be implemented by subclasses to return YES iff an animation step is paused
  *
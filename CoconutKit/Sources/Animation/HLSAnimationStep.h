@@ -17,6 +17,7 @@
 @interface HLSAnimationStep : NSObject <NSCopying> {
 @private
     NSMutableArray *m_objectKeys;
+    NSMutableArray *m_objectAnimations;
     NSMutableDictionary *m_objectToObjectAnimationMap;
     NSString *m_tag;
     NSDictionary *m_userInfo;
@@ -40,6 +40,7 @@
 {
     if ((self = [super init])) {
         self.objectKeys = [NSMutableArray array];
+        m_objectAnimations = [[NSMutableArray alloc] init];
         self.objectToObjectAnimationMap = [NSMutableDictionary dictionary];
         
         // Default animation settings (as given in UIKit documentation)
@@ -51,6 +52,7 @@
 - (void)dealloc
 {    
     self.objectKeys = nil;
+    [m_objectAnimations release];
     self.objectToObjectAnimationMap = nil;
     self.tag = nil;
     self.userInfo = nil;
@@ -63,6 +65,11 @@
 
 @synthesize objectKeys = m_objectKeys;
 
+- (NSArray *)objectAnimations
+{
+    return m_objectAnimations;
+}
+
 @synthesize objectToObjectAnimationMap = m_objectToObjectAnimationMap;
 
 @synthesize tag = m_tag;
@@ -90,6 +97,12 @@
     return [self isAnimationPaused];
 }
 
+- (BOOL)isWaitingForCompletion
+{
+    // The delegate is retained while an animated step is running, and released when its animation has ended
+    return self.delegate != nil;
+}
+
 @synthesize terminating = m_terminating;
 
 - (NSArray *)objects
@@ -116,9 +129,36 @@
         return;
     }
     
+    // An object appears at most once in a step. Setting an animation again for an object replaces the previous one
+    HLSObjectAnimation *objectAnimationCopy = [[objectAnimation copy] autorelease];
+    NSValue *objectKey = [NSValue valueWithPointer:object];
+    if ([self.objectToObjectAnimationMap objectForKey:objectKey]) {
+        NSUInteger index = [self.objectKeys indexOfObject:objectKey];
+        [m_objectAnimations replaceObjectAtIndex:index withObject:objectAnimationCopy];
+    }
+    else {
+        [self.objectKeys addObject:objectKey];
+        [m_objectAnimations addObject:objectAnimationCopy];
+    }
+    [self.objectToObjectAnimationMap setObject:objectAnimationCopy forKey:objectKey];
+}
+
+- (void)replaceObject:(id)object withObject:(id)replacementObject
+{
+    if (! object || ! replacementObject) {
+        return;
+    }
+    
     NSValue *objectKey = [NSValue valueWithPointer:object];
-    [self.objectKeys addObject:objectKey];
-    [self.objectToObjectAnimationMap setObject:[[objectAnimation copy] autorelease] forKey:objectKey];
+    HLSObjectAnimation *objectAnimation = [self.objectToObjectAnimationMap objectForKey:objectKey];
+    if (! objectAnimation) {
+        return;
+    }
+    
+    NSValue *replacementObjectKey = [NSValue valueWithPointer:replacementObject];
+    [self.objectKeys replaceObjectAtIndex:[self.objectKeys indexOfObject:objectKey] withObject:replacementObjectKey];
+    [self.objectToObjectAnimationMap setObject:objectAnimation forKey:replacementObjectKey];
+    [self.objectToObjectAnimationMap removeObjectForKey:objectKey];
 }
 
 - (id)objectAnimationForObject:(id)object
@@ -157,6 +197,12 @@
     }
 }
 
+- (void)playInstantaneously
+{
+    // Non-animated playback is synchronous and does not use any state information
+    [self playAnimationWithStartTime:0. animated:NO];
+}
+
 - (void)pause
 {
     if (self.terminating) {
@@ -182,6 +228,16 @@
     [self resumeAnimation];
 }
 
+- (void)seekToTime:(NSTimeInterval)time
+{
+    if (! self.paused) {
+        HLSLoggerDebug(@"The animation step has not been paused. Cannot seek");
+        return;
+    }
+    
+    [self seekAnimationToTime:time];
+}
+
 - (void)terminate
 {
     if (self.terminating) {
@@ -215,6 +271,11 @@
     HLSMissingMethodImplementation();
 }
 
+- (void)seekAnimationToTime:(NSTimeInterval)time
+{
+    HLSLoggerWarn(@"Animation steps of class %@ cannot be moved to a given time", [self class]);
+}
+
 - (BOOL)isAnimationPaused
 {
     HLSMissingMethodImplementation();
@@ -251,17 +312,21 @@
 
 - (void)notifyAsynchronousAnimationStepDidStopFinished:(BOOL)finished
 {
+    // Reset the step state before notifying, so that the step can be played again from the delegate method
+    id<HLSAnimationStepDelegate> delegate = [[self.delegate retain] autorelease];
+    BOOL terminating = self.terminating;
+    
+    self.terminating = NO;
+    
+    self.delegate = nil;
+    
     // If the animation is terminated, this event was already emitted when termination occurs (to avoid
     // waiting too long on this event to occur asynchronously). Do not notify again here
-    if (! self.terminating) {
+    if (! terminating) {
         // This method is meant to be called in the animation stop callback, which is called for animations
         // with animated = YES
-        [self.delegate animationStepDidStop:self animated:YES finished:YES];
+        [delegate animationStepDidStop:self animated:YES finished:YES];
     }
-    
-    self.terminating = NO;
-    
-    self.delegate = nil;
 }
 
 #pragma mark NSCopying protocol implementation
@@ -269,10 +334,10 @@
 - (id)copyWithZone:(NSZone *)zone
 {
     HLSAnimationStep *animationStepCopy = [[[self class] allocWithZone:zone] init];
-    for (id object in [self objects]) {
-        HLSObjectAnimation *objectAnimation = [self objectAnimationForObject:object];
-        HLSObjectAnimation *objectAnimationCopy = [[objectAnimation copyWithZone:zone] autorelease];
-        [animationStepCopy addObjectAnimation:objectAnimationCopy forObject:object];
+    NSArray *objects = [self objects];
+    for (NSUInteger i = 0; i < [objects count]; ++i) {
+        HLSObjectAnimation *objectAnimation = [self.objectAnimations objectAtIndex:i];
+        [animationStepCopy addObjectAnimation:objectAnimation forObject:[objects objectAtIndex:i]];
     }
     animationStepCopy.tag = self.tag;
     animationStepCopy.userInfo = self.userInfo;
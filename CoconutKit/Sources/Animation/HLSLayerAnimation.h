@@ -43,6 +43,10 @@
     CGFloat m_opacityIncrement;
     BOOL m_togglingShouldRasterize;
     CGFloat m_rasterizationScaleIncrement;
+    CATransform3D m_transform;                          // cached composite transform
+    BOOL m_transformValid;
+    CATransform3D m_sublayerTransform;                  // cached composite sublayer transform
+    BOOL m_sublayerTransformValid;
 }
 
 /**
@@ -82,18 +82,54 @@
 
 @synthesize rotationParameters = m_rotationParameters;
 
+- (void)setRotationParameters:(HLSVector4)rotationParameters
+{
+    m_rotationParameters = rotationParameters;
+    m_transformValid = NO;
+}
+
 @synthesize scaleParameters = m_scaleParameters;
 
+- (void)setScaleParameters:(HLSVector3)scaleParameters
+{
+    m_scaleParameters = scaleParameters;
+    m_transformValid = NO;
+}
+
 @synthesize translationParameters = m_translationParameters;
 
+- (void)setTranslationParameters:(HLSVector3)translationParameters
+{
+    m_translationParameters = translationParameters;
+    m_transformValid = NO;
+}
+
 @synthesize anchorPointTranslationParameters = m_anchorPointTranslationParameters;
 
 @synthesize sublayerRotationParameters = m_sublayerRotationParameters;
 
+- (void)setSublayerRotationParameters:(HLSVector4)sublayerRotationParameters
+{
+    m_sublayerRotationParameters = sublayerRotationParameters;
+    m_sublayerTransformValid = NO;
+}
+
 @synthesize sublayerScaleParameters = m_sublayerScaleParameters;
 
+- (void)setSublayerScaleParameters:(HLSVector3)sublayerScaleParameters
+{
+    m_sublayerScaleParameters = sublayerScaleParameters;
+    m_sublayerTransformValid = NO;
+}
+
 @synthesize sublayerTranslationParameters = m_sublayerTranslationParameters;
 
+- (void)setSublayerTranslationParameters:(HLSVector3)sublayerTranslationParameters
+{
+    m_sublayerTranslationParameters = sublayerTranslationParameters;
+    m_sublayerTransformValid = NO;
+}
+
 @synthesize sublayerCameraTranslationZ = m_sublayerCameraTranslationZ;
 
 @synthesize opacityIncrement = m_opacityIncrement;
@@ -104,9 +140,15 @@
 
 - (CATransform3D)transform
 {
-    CATransform3D transform = [self rotationTransform];
-    transform = CATransform3DConcat(transform, [self scaleTransform]);
-    return CATransform3DConcat(transform, [self translationTransform]);
+    // The composite transform is needed each time the animation is applied to a layer. Calculate it only when
+    // its parameters have changed
+    if (! m_transformValid) {
+        CATransform3D transform = [self rotationTransform];
+        transform = CATransform3DConcat(transform, [self scaleTransform]);
+        m_transform = CATransform3DConcat(transform, [self translationTransform]);
+        m_transformValid = YES;
+    }
+    return m_transform;
 }
 
 - (CATransform3D)rotationTransform
@@ -133,10 +175,14 @@
 
 - (CATransform3D)sublayerTransform
 {
-    CATransform3D sublayerTransform = [self sublayerRotationTransform];
-    sublayerTransform = CATransform3DConcat(sublayerTransform, [self sublayerScaleTransform]);
-    sublayerTransform = CATransform3DConcat(sublayerTransform, [self sublayerTranslationTransform]);
-    return sublayerTransform;
+    // Same remark as for -transform
+    if (! m_sublayerTransformValid) {
+        CATransform3D sublayerTransform = [self sublayerRotationTransform];
+        sublayerTransform = CATransform3DConcat(sublayerTransform, [self sublayerScaleTransform]);
+        m_sublayerTransform = CATransform3DConcat(sublayerTransform, [self sublayerTranslationTransform]);
+        m_sublayerTransformValid = YES;
+    }
+    return m_sublayerTransform;
 }
 
 - (CATransform3D)sublayerRotationTransform;
@@ -330,6 +376,14 @@
     layerAnimationCopy.opacityIncrement = self.opacityIncrement;
     layerAnimationCopy.togglingShouldRasterize = self.togglingShouldRasterize;
     layerAnimationCopy.rasterizationScaleIncrement = self.rasterizationScaleIncrement;
+    
+    // Animations are copied when added to steps, often to many layers at once. Calculate the composite transforms
+    // once and share them with the copies
+    layerAnimationCopy->m_transform = [self transform];
+    layerAnimationCopy->m_transformValid = YES;
+    layerAnimationCopy->m_sublayerTransform = [self sublayerTransform];
+    layerAnimationCopy->m_sublayerTransformValid = YES;
+    
     return layerAnimationCopy;
 }
 
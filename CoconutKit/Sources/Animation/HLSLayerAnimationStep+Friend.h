@@ -0,0 +1,33 @@
+//
+//  HLSLayerAnimationStep+Friend.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+/**
+ * Interface meant to be used by friend classes of HLSLayerAnimationStep (= classes which must have access to private 
+ * implementation details)
+ */
+@interface HLSLayerAnimationStep (Friend)
+
+/**
+ * Create a single step playing a sequence of layer animation steps. When played animated, all changes applied to a 
+ * layer property by the steps are merged into a single keyframe animation, so that the whole sequence runs without
+ * any intervention between steps. The steps are not copied and must not be played separately
+ */
++ (id)bakedAnimationStepWithAnimationSteps:(NSArray *)animationSteps;
+
+/**
+ * Create a single step playing a sequence of layer animation steps followed by their reverse, repeatCount times 
+ * (NSUIntegerMax to repeat forever). When played animated, the keyframe animations merging the changes of the steps
+ * are reversed and repeated by Core Animation itself, so that no main thread work is required until the whole loop
+ * ends. The reverse steps are only applied to restore the initial state of the layers. The steps are not copied and
+ * must not be played separately
+ */
++ (id)loopingBakedAnimationStepWithAnimationSteps:(NSArray *)animationSteps
+                            reverseAnimationSteps:(NSArray *)reverseAnimationSteps
+                                      repeatCount:(NSUInteger)repeatCount;
+
+@end
@@ -16,16 +16,22 @@
  * (HLSLayerAnimationStep).
  *
  * To create a layer animation step, simply instantiate it using the +animationStep class method, then add layer animations
- * to it, and set its duration and curve
+ * to it, and set its duration and curve. Layer property animations (HLSLayerPropertyAnimation) can be added as well to
+ * animate numeric layer properties
  *
  * Designated initializer: -init (create an animation step with default settings)
  */
 @interface HLSLayerAnimationStep : HLSAnimationStep {
 @private
     CAMediaTimingFunction *m_timingFunction;
+    BOOL m_additive;
+    NSString *m_layerAnimationGroupKey;
+    NSArray *m_bakedAnimationSteps;
+    NSArray *m_bakedReverseAnimationSteps;
+    float m_bakedRepeatCount;
     UIView *m_dummyView;
     NSUInteger m_numberOfLayerAnimations;
-    BOOL m_numberOfStartedLayerAnimations;
+    NSUInteger m_numberOfStartedLayerAnimations;
     NSUInteger m_numberOfFinishedLayerAnimations;
     CFTimeInterval m_startTime;
     CFTimeInterval m_pauseTime;
@@ -52,4 +58,18 @@
  */
 @property (nonatomic, retain) CAMediaTimingFunction *timingFunction;
 
+/**
+ * If set to YES, the step is played using additive animations: Each layer property animates the difference between its
+ * previous and its new value down to zero, on top of the new value, and Core Animation sums up the animations of all
+ * steps altering the same property. A step can therefore be played while another step is still animating the same 
+ * layers, without any visual jump and without having to cancel the running animation first (e.g. to retarget an 
+ * animation following a finger at touch rate). Terminating an additive step only removes its own animations
+ *
+ * Remark: Rasterization changes, and transforms which cannot be inverted (e.g. scaling to zero), are always animated
+ *         from their previous value
+ *
+ * Default value is NO
+ */
+@property (nonatomic, assign, getter=isAdditive) BOOL additive;
+
 @end
@@ -8,11 +8,14 @@
 
 #import "HLSLayerAnimationStep.h"
 
+#import "HLSLayerAnimationStep+Friend.h"
 #import "CALayer+HLSExtensions.h"
 #import "CAMediaTimingFunction+HLSExtensions.h"
 #import "HLSAnimationStep+Protected.h"
 #import "HLSFloat.h"
 #import "HLSLayerAnimation+Friend.h"
+#import "HLSLayerPropertyAnimation.h"
+#import "HLSLayerPropertyAnimation+Friend.h"
 #import "HLSLogger.h"
 
 #if TARGET_IPHONE_SIMULATOR
@@ -31,15 +34,77 @@ static NSString * const kLayerCameraZPositionForSublayersKey = @"HLSLayerCameraZ
 
 @interface HLSLayerAnimationStep ()
 
+@property (nonatomic, retain) NSArray *bakedAnimationSteps;
+@property (nonatomic, retain) NSArray *bakedReverseAnimationSteps;
+@property (nonatomic, assign) float bakedRepeatCount;
 @property (nonatomic, retain) UIView *dummyView;
+@property (nonatomic, retain) NSString *layerAnimationGroupKey;
+
+- (NSArray *)animationsByApplyingLayerAnimation:(HLSLayerAnimation *)layerAnimation toLayer:(CALayer *)layer animated:(BOOL)animated;
+- (void)playBakedAnimationStepsWithTimeScale:(double)timeScale startTime:(NSTimeInterval)startTime animated:(BOOL)animated;
+- (NSTimeInterval)bakedAnimationStepsDuration;
 
 - (void)animationDidStart:(CAAnimation *)animation;
 - (void)animationDidStop:(CAAnimation *)animation finished:(BOOL)finished;
 
 @end
 
+static NSUInteger s_additiveLayerAnimationGroupCount = 0;
+
+static id HLSLayerAnimationAdditiveValue(id value, id targetValue);
+static void HLSLayerAnimationMakeAdditive(CAPropertyAnimation *animation);
+
 @implementation HLSLayerAnimationStep
 
+#pragma mark Convenience methods
+
++ (id)bakedAnimationStepWithAnimationSteps:(NSArray *)animationSteps
+{
+    HLSLayerAnimationStep *bakedAnimationStep = [HLSLayerAnimationStep animationStep];
+    NSTimeInterval duration = 0.;
+    for (HLSLayerAnimationStep *animationStep in animationSteps) {
+        // Register all layers involved, so that they can be paused and terminated as for any other step
+        for (CALayer *layer in [animationStep objects]) {
+            if (! [bakedAnimationStep objectAnimationForObject:layer]) {
+                [bakedAnimationStep addLayerAnimation:[HLSLayerAnimation animation] forLayer:layer];
+            }
+        }
+        duration += animationStep.duration;
+    }
+    bakedAnimationStep.duration = duration;
+    bakedAnimationStep.bakedAnimationSteps = animationSteps;
+    
+    // Additive only if all steps are
+    bakedAnimationStep.additive = [animationSteps count] != 0;
+    for (HLSLayerAnimationStep *animationStep in animationSteps) {
+        if (! animationStep.additive) {
+            bakedAnimationStep.additive = NO;
+            break;
+        }
+    }
+    return bakedAnimationStep;
+}
+
++ (id)loopingBakedAnimationStepWithAnimationSteps:(NSArray *)animationSteps
+                            reverseAnimationSteps:(NSArray *)reverseAnimationSteps
+                                      repeatCount:(NSUInteger)repeatCount
+{
+    HLSLayerAnimationStep *bakedAnimationStep = [HLSLayerAnimationStep bakedAnimationStepWithAnimationSteps:animationSteps];
+    bakedAnimationStep.bakedReverseAnimationSteps = reverseAnimationSteps;
+    
+    // The duration covers all repeats (infinite if repeating forever)
+    NSTimeInterval loopDuration = 2. * bakedAnimationStep.duration;
+    if (repeatCount == NSUIntegerMax) {
+        bakedAnimationStep.bakedRepeatCount = HUGE_VALF;
+        bakedAnimationStep.duration = HUGE_VAL;
+    }
+    else {
+        bakedAnimationStep.bakedRepeatCount = repeatCount;
+        bakedAnimationStep.duration = repeatCount * loopDuration;
+    }
+    return bakedAnimationStep;
+}
+
 #pragma mark Object creation and destruction
 
 - (id)init
@@ -53,7 +118,10 @@ static NSString * const kLayerCameraZPositionForSublayersKey = @"HLSLayerCameraZ
 - (void)dealloc
 {
     self.timingFunction = nil;
+    self.bakedAnimationSteps = nil;
+    self.bakedReverseAnimationSteps = nil;
     self.dummyView = nil;
+    self.layerAnimationGroupKey = nil;
     
     [super dealloc];
 }
@@ -62,8 +130,18 @@ static NSString * const kLayerCameraZPositionForSublayersKey = @"HLSLayerCameraZ
 
 @synthesize timingFunction = m_timingFunction;
 
+@synthesize bakedAnimationSteps = m_bakedAnimationSteps;
+
+@synthesize bakedReverseAnimationSteps = m_bakedReverseAnimationSteps;
+
+@synthesize bakedRepeatCount = m_bakedRepeatCount;
+
 @synthesize dummyView = m_dummyView;
 
+@synthesize additive = m_additive;
+
+@synthesize layerAnimationGroupKey = m_layerAnimationGroupKey;
+
 #pragma mark Managing the animation
 
 - (void)addLayerAnimation:(HLSLayerAnimation *)layerAnimation forLayer:(CALayer *)layer
@@ -81,6 +159,7 @@ static NSString * const kLayerCameraZPositionForSublayersKey = @"HLSLayerCameraZ
     NSAssert(doublele(startTime, self.duration), @"The start time of a step cannot be greater than its duration");
     
     NSTimeInterval duration = self.duration;
+    double timeScale = 1.;
     if (animated) {
         // This dummy view is always animated. There is no way to set a start callback for a CATransaction.
         // Therefore, we always ensure the transaction is never empty by animating a dummy view, and we set
@@ -88,9 +167,16 @@ static NSString * const kLayerCameraZPositionForSublayersKey = @"HLSLayerCameraZ
         // will be triggered when the transaction begins / ends animating)
         self.dummyView = [[[UIView alloc] initWithFrame:CGRectZero] autorelease];
         [[UIApplication sharedApplication].keyWindow addSubview:self.dummyView];
-        
-        [CATransaction begin];
-        
+    }
+    
+    // All layer changes are applied within a single transaction. Implicit animations are disabled: When animated, the
+    // explicit animations below already animate all changes, otherwise changes must be applied instantaneously. This
+    // spares the creation of one implicit animation per changed property and per layer, which is costly when many
+    // layers are involved
+    [CATransaction begin];
+    [CATransaction setDisableActions:YES];
+    
+    if (animated) {
         // For tests within the iOS simulator only: Slow down Core Animations as UIView block-based animations (when
         // quickly pressing the shift key three times)
         //
@@ -109,168 +195,71 @@ static NSString * const kLayerCameraZPositionForSublayersKey = @"HLSLayerCameraZ
         }
         
         if (s_UIAnimationDragCoefficient) {
-            duration *= s_UIAnimationDragCoefficient();
-            startTime *= s_UIAnimationDragCoefficient();
+            timeScale = s_UIAnimationDragCoefficient();
+            duration *= timeScale;
+            startTime *= timeScale;
         }
 #endif
         // If we want to play an animation from somewhere in its middle, we need to reduce the duration of the enclosing
         // group or transaction accordingly, while letting the duration of the individual animations unchanged (see the
         // CAAnimationGroup creation below). The child animation is not scaled, rather cut at its end (see the CAAnimationGroup
         // class documentation), yielding the desired effect. For the same reason, the timing function must be applied on
-        // the animation, not on the transaction
-        [CATransaction setAnimationDuration:duration - startTime];
-    }
-    
-    // Animate all layers involved in the animation step
-    for (CALayer *layer in [self objects]) {        
-        HLSLayerAnimation *layerAnimation = (HLSLayerAnimation *)[self objectAnimationForObject:layer];
-        NSAssert(layerAnimation != nil, @"Missing layer animation; data consistency failure");
-                
-        // Remark: For each property we animate, we still must set the final value manually (CoreAnimations animate properties
-        // but do not set them). Since we do not need to support delays (which are implemented at the HLSAnimation level), we
-        // can do it right here, eliminating potentially flickering animations (for more information, see HLSAnimation.m)
-        NSMutableArray *animations = [NSMutableArray array];
-        
-        // Opacity animation (opacity must always lie between 0.f and 1.f)
-        CGFloat opacity = layer.opacity + layerAnimation.opacityIncrement;
-        if (floatlt(opacity, -1.f)) {
-            HLSLoggerWarn(@"Layer animations adding to an opacity value larger than -1 for layer %@. Fixed to -1, but your animation is incorrect", layer);
-            opacity = -1.f;
-        }
-        else if (floatgt(opacity, 1.f)) {
-            HLSLoggerWarn(@"Layer animations adding to an opacity value larger than 1 for layer %@. Fixed to 1, but your animation is incorrect", layer);
-            opacity = 1.f;
+        // the animation, not on the transaction. Loops repeated forever set their durations explicitly
+        if (! isinf(duration)) {
+            [CATransaction setAnimationDuration:duration - startTime];
         }
         
-        if (animated) {
-            CABasicAnimation *opacityAnimation = [CABasicAnimation animationWithKeyPath:@"opacity"];
-            [opacityAnimation setFromValue:[NSNumber numberWithFloat:layer.opacity]];
-            [opacityAnimation setToValue:[NSNumber numberWithFloat:opacity]];
-            [animations addObject:opacityAnimation];
-        }
-        layer.opacity = opacity;
-        
-        // Animate the transform. The transform has to be applied on the layer center. This requires a conversion in the coordinate system
-        // centered on the layer
-        CATransform3D translationTransform = CATransform3DMakeTranslation(-layer.transform.m41, -layer.transform.m42, 0.f);
-        CATransform3D convTransform = CATransform3DConcat(CATransform3DConcat(translationTransform, layerAnimation.transform),
-                                                          CATransform3DInvert(translationTransform));
-        CATransform3D transform = CATransform3DConcat(layer.transform, convTransform);
-        
-        if (animated) {
-            CABasicAnimation *transformAnimation = [CABasicAnimation animationWithKeyPath:@"transform"];
-            [transformAnimation setFromValue:[NSValue valueWithCATransform3D:layer.transform]];
-            [transformAnimation setToValue:[NSValue valueWithCATransform3D:transform]];
-            [animations addObject:transformAnimation];
-        }
-        layer.transform = transform;
-        
-        // Animate the anchor point
-        CGPoint anchorPoint = CGPointMake(layer.anchorPoint.x + layerAnimation.anchorPointTranslationParameters.v1,
-                                          layer.anchorPoint.y + layerAnimation.anchorPointTranslationParameters.v2);
-        CGFloat anchorPointZ = layer.anchorPointZ + layerAnimation.anchorPointTranslationParameters.v3;
-        
-        if (animated) {
-            CABasicAnimation *anchorPointAnimation = [CABasicAnimation animationWithKeyPath:@"anchorPoint"];
-            [anchorPointAnimation setFromValue:[NSValue valueWithCGPoint:layer.anchorPoint]];
-            [anchorPointAnimation setToValue:[NSValue valueWithCGPoint:anchorPoint]];
-            [animations addObject:anchorPointAnimation];
-            
-            CABasicAnimation *anchorPointZAnimation = [CABasicAnimation animationWithKeyPath:@"anchorPointZ"];
-            [anchorPointZAnimation setFromValue:[NSNumber numberWithFloat:layer.anchorPointZ]];
-            [anchorPointZAnimation setToValue:[NSNumber numberWithFloat:anchorPointZ]];
-            [animations addObject:anchorPointZAnimation];
-        }
-        layer.anchorPoint = anchorPoint;
-        layer.anchorPointZ = anchorPointZ;
-        
-        // Rasterization
-        if (layerAnimation.togglingShouldRasterize) {
-            BOOL shouldRasterize = ! layer.shouldRasterize;
-            if (animated) {
-                CABasicAnimation *shouldRasterizeAnimation = [CABasicAnimation animationWithKeyPath:@"shouldRasterize"];
-                [shouldRasterizeAnimation setFromValue:[NSNumber numberWithBool:layer.shouldRasterize]];
-                [shouldRasterizeAnimation setToValue:[NSNumber numberWithBool:shouldRasterize]];
-                [animations addObject:shouldRasterizeAnimation];
-            }
-            layer.shouldRasterize = shouldRasterize;
-        }
-        
-        // Rasterization scale
-        CGFloat rasterizationScale = layer.rasterizationScale + layerAnimation.rasterizationScaleIncrement;
-        if (animated) {
-            CABasicAnimation *rasterizationScaleAnimation = [CABasicAnimation animationWithKeyPath:@"rasterizationScale"];
-            [rasterizationScaleAnimation setFromValue:[NSNumber numberWithFloat:layer.rasterizationScale]];
-            [rasterizationScaleAnimation setToValue:[NSNumber numberWithFloat:rasterizationScale]];
-            [animations addObject:rasterizationScaleAnimation];
-        }
-        layer.rasterizationScale = rasterizationScale;
-        
-        // Get the sublayer transform without its perspective component (saved as additional layer information)
-        NSValue *nonProjectedSublayerTransformValue = [layer valueForKey:kLayerNonProjectedSublayerTransformKey];
-        CATransform3D nonProjectedSublayerTransform = CATransform3DIdentity;
-        if (nonProjectedSublayerTransformValue) {
-            nonProjectedSublayerTransform = [nonProjectedSublayerTransformValue CATransform3DValue];
+        // Additive animations of several steps must coexist on the same layers, each step therefore uses its own key
+        if (self.additive) {
+            self.layerAnimationGroupKey = [NSString stringWithFormat:@"%@-%u", kLayerAnimationGroupKey, ++s_additiveLayerAnimationGroupCount];
         }
         else {
-            nonProjectedSublayerTransform = layer.sublayerTransform;
+            self.layerAnimationGroupKey = kLayerAnimationGroupKey;
         }
         
-        // Get the current camera position (saved as additional layer information)
-        NSNumber *sublayerCameraZPositionNumber = [layer valueForKey:kLayerCameraZPositionForSublayersKey];
-        CGFloat sublayerCameraZPosition = 0.f;
-        if (sublayerCameraZPositionNumber) {
-            sublayerCameraZPosition = [sublayerCameraZPositionNumber floatValue];
-        }
-        else {
-            sublayerCameraZPosition = floateq(layer.sublayerTransform.m34, 0.f) ? 0.f : 1.f / layer.sublayerTransform.m34;
-        }
-        
-        // Calculate the sublayer transform (without perspective component)
-        CATransform3D sublayerTranslationTransform = CATransform3DMakeTranslation(-nonProjectedSublayerTransform.m41, -nonProjectedSublayerTransform.m42, 0.f);
-        CATransform3D sublayerConvTransform = CATransform3DConcat(CATransform3DConcat(sublayerTranslationTransform, layerAnimation.sublayerTransform),
-                                                                  CATransform3DInvert(sublayerTranslationTransform));
-        CATransform3D sublayerTransform = CATransform3DConcat(nonProjectedSublayerTransform, sublayerConvTransform);
-        
-        // Calculate the new z-position of the camera
-        sublayerCameraZPosition += layerAnimation.sublayerCameraTranslationZ;
-        
-        // Save the information relative / not relative to the perspective separately
-        [layer setValue:[NSNumber numberWithFloat:sublayerCameraZPosition] forKey:kLayerCameraZPositionForSublayersKey];
-        [layer setValue:[NSValue valueWithCATransform3D:sublayerTransform] forKey:kLayerNonProjectedSublayerTransformKey];
-        
-        // Create the perspective matrix (see http://en.wikipedia.org/wiki/3D_projection#Perspective_projection)
-        CATransform3D perspectiveProjectionTransform = CATransform3DIdentity;
-        if (! floateq(sublayerCameraZPosition, 0.f)) {
-            perspectiveProjectionTransform.m34 = -1.f / sublayerCameraZPosition;
-        }
-        
-        // Apply the perspective
-        sublayerTransform = CATransform3DConcat(sublayerTransform, perspectiveProjectionTransform);
-        
-        if (animated) {
-            CABasicAnimation *sublayerTransformAnimation = [CABasicAnimation animationWithKeyPath:@"sublayerTransform"];
-            [sublayerTransformAnimation setFromValue:[NSValue valueWithCATransform3D:layer.sublayerTransform]];
-            [sublayerTransformAnimation setToValue:[NSValue valueWithCATransform3D:sublayerTransform]];
-            [animations addObject:sublayerTransformAnimation];
-        }
-        layer.sublayerTransform = sublayerTransform;
+        // We want to be able to test the number of animations in the animation stop callback. If the animated
+        // layers are dead when the end callback is called (which can happen if the layer they are on is
+        // destroyed while the animation was running), we cannot compare to self.objects anymore (otherwise
+        // the application will crash). We therefore count the animations as they are attached to layers
+        m_numberOfLayerAnimations = 0;
+    }
+    
+    // Animate all layers involved in the animation step
+    if (self.bakedAnimationSteps) {
+        [self playBakedAnimationStepsWithTimeScale:timeScale startTime:startTime animated:animated];
+    }
+    else {
+        // Iterate over layers and their animations at the same time (no lookup needed)
+        NSArray *layers = [self objects];
+        NSArray *layerAnimations = [self objectAnimations];
+        NSAssert([layers count] == [layerAnimations count], @"Missing layer animation; data consistency failure");
         
-        // Create the animation group and attach it to the layer
-        if (animated) {
-            // All animations must have the expected duration, but must be offset according to the start time
-            // when played from somewhere in their middle. The timing function must also be attached to each
-            // animation
-            for (CAAnimation *animation in animations) {
-                animation.duration = duration;
-                animation.timeOffset = startTime;
-                animation.timingFunction = self.timingFunction;
-            }
+        for (NSUInteger i = 0; i < [layers count]; ++i) {
+            CALayer *layer = [layers objectAtIndex:i];
+            HLSLayerAnimation *layerAnimation = [layerAnimations objectAtIndex:i];
+            
+            NSArray *animations = [self animationsByApplyingLayerAnimation:layerAnimation toLayer:layer animated:animated];
             
-            CAAnimationGroup *animationGroup = [CAAnimationGroup animation];
-            animationGroup.animations = [NSArray arrayWithArray:animations];
-            animationGroup.delegate = self;
-            [layer addAnimation:animationGroup forKey:kLayerAnimationGroupKey];
+            // Create the animation group and attach it to the layer (if something changes)
+            if (animated && [animations count] != 0) {
+                // All animations must have the expected duration, but must be offset according to the start time
+                // when played from somewhere in their middle. The timing function must also be attached to each
+                // animation
+                for (CABasicAnimation *animation in animations) {
+                    animation.duration = duration;
+                    animation.timeOffset = startTime;
+                    animation.timingFunction = self.timingFunction;
+                    if (self.additive) {
+                        HLSLayerAnimationMakeAdditive(animation);
+                    }
+                }
+                
+                CAAnimationGroup *animationGroup = [CAAnimationGroup animation];
+                animationGroup.animations = animations;
+                animationGroup.delegate = self;
+                [layer addAnimation:animationGroup forKey:self.layerAnimationGroupKey];
+                ++m_numberOfLayerAnimations;
+            }
         }
     }
     
@@ -281,7 +270,12 @@ static NSString * const kLayerCameraZPositionForSublayersKey = @"HLSLayerCameraZ
         dummyViewOpacityAnimation.fromValue = [NSNumber numberWithFloat:self.dummyView.layer.opacity];
         dummyViewOpacityAnimation.toValue = [NSNumber numberWithFloat:1.f - self.dummyView.layer.opacity];
         dummyViewOpacityAnimation.delegate = self;
+        if (isinf(duration)) {
+            dummyViewOpacityAnimation.duration = 2. * [self bakedAnimationStepsDuration] * timeScale;
+            dummyViewOpacityAnimation.repeatCount = HUGE_VALF;
+        }
         [self.dummyView.layer addAnimation:dummyViewOpacityAnimation forKey:kDummyViewLayerAnimationKey];
+        ++m_numberOfLayerAnimations;
     }
         
     // Animated
@@ -292,18 +286,15 @@ static NSString * const kLayerCameraZPositionForSublayersKey = @"HLSLayerCameraZ
         m_numberOfStartedLayerAnimations = 0;
         m_numberOfFinishedLayerAnimations = 0;
         
-        // We want to be able to test the number of animations in the animation stop callback. If the animated
-        // layers are dead when the end callback is called (which can happen if the layer they are on is
-        // destroyed while the animation was running), we cannot compare to self.objects anymore (otherwise
-        // the application will crash). We therefore keep track of how animations are expected, but in a safe way
-        // (+ 1 for the dummy view animation)
-        m_numberOfLayerAnimations = [self.objects count] + 1;
-        
         // When a start time has been defined, the animation must look like it started earlier
         m_startTime = CACurrentMediaTime() - startTime;
         
-        [CATransaction commit];
+        // Steps can be played several times. Forget about previous pauses
+        m_pauseTime = 0.;
+        m_previousPauseDuration = 0.;
     }
+    
+    [CATransaction commit];
 }
 
 - (void)pauseAnimation
@@ -327,6 +318,20 @@ static NSString * const kLayerCameraZPositionForSublayersKey = @"HLSLayerCameraZ
     m_pauseTime = 0.;
 }
 
+- (void)seekAnimationToTime:(NSTimeInterval)time
+{
+    // Paused layers have a speed of 0, their local time is therefore given by their time offset (see CALayer+HLSExtensions.m).
+    // Shifting it moves all animations attached to them
+    NSTimeInterval timeShift = time - [self elapsedTime];
+    for (CALayer *layer in [self objects]) {
+        layer.timeOffset += timeShift;
+    }
+    self.dummyView.layer.timeOffset += timeShift;
+    
+    // Account for the shift as if the animation had been paused for a shorter time
+    m_previousPauseDuration -= timeShift;
+}
+
 - (BOOL)isAnimationPaused
 {
     return [self.dummyView.layer isPaused];
@@ -334,6 +339,15 @@ static NSString * const kLayerCameraZPositionForSublayersKey = @"HLSLayerCameraZ
 
 - (void)terminateAnimation
 {
+    // Other steps might still be animating the same layers additively
+    if (self.additive) {
+        for (CALayer *layer in [self objects]) {
+            [layer removeAnimationForKey:self.layerAnimationGroupKey];
+        }
+        [self.dummyView.layer removeAllAnimationsRecursively];
+        return;
+    }
+    
     // We recursively cancel subview animations. It does not seem to be an issue here (like for UIViews, see
     // HLSViewAnimationStep.m), since we do not alter layer frames, but this is a safety measure and is the
     // correct way to cancel animations attached to a layer
@@ -353,12 +367,327 @@ static NSString * const kLayerCameraZPositionForSublayersKey = @"HLSLayerCameraZ
     return CACurrentMediaTime() - m_startTime - m_previousPauseDuration - currentPauseDuration;
 }
 
+#pragma mark Calculating layer animations
+
+- (NSArray *)animationsByApplyingLayerAnimation:(HLSLayerAnimation *)layerAnimation toLayer:(CALayer *)layer animated:(BOOL)animated
+{
+    // Remark: For each property we animate, we still must set the final value manually (CoreAnimations animate properties
+    // but do not set them). Since we do not need to support delays (which are implemented at the HLSAnimation level), we
+    // can do it right here, eliminating potentially flickering animations (for more information, see HLSAnimation.m).
+    // Animations are only created for properties which actually change (when many layers are animated, most of them
+    // usually only change a few properties)
+    NSMutableArray *animations = [NSMutableArray array];
+    
+    // Opacity animation (opacity must always lie between 0.f and 1.f)
+    CGFloat opacity = layer.opacity + layerAnimation.opacityIncrement;
+    if (floatlt(opacity, -1.f)) {
+        HLSLoggerWarn(@"Layer animations adding to an opacity value larger than -1 for layer %@. Fixed to -1, but your animation is incorrect", layer);
+        opacity = -1.f;
+    }
+    else if (floatgt(opacity, 1.f)) {
+        HLSLoggerWarn(@"Layer animations adding to an opacity value larger than 1 for layer %@. Fixed to 1, but your animation is incorrect", layer);
+        opacity = 1.f;
+    }
+    
+    if (animated && ! floateq(opacity, layer.opacity)) {
+        CABasicAnimation *opacityAnimation = [CABasicAnimation animationWithKeyPath:@"opacity"];
+        [opacityAnimation setFromValue:[NSNumber numberWithFloat:layer.opacity]];
+        [opacityAnimation setToValue:[NSNumber numberWithFloat:opacity]];
+        [animations addObject:opacityAnimation];
+    }
+    layer.opacity = opacity;
+    
+    // Animate the transform. The transform has to be applied on the layer center. This requires a conversion in the coordinate system
+    // centered on the layer (the inverse of a translation is simply the opposite translation, no need for a matrix inversion)
+    CATransform3D layerTransform = layer.transform;
+    CATransform3D translationTransform = CATransform3DMakeTranslation(-layerTransform.m41, -layerTransform.m42, 0.f);
+    CATransform3D inverseTranslationTransform = CATransform3DMakeTranslation(layerTransform.m41, layerTransform.m42, 0.f);
+    CATransform3D convTransform = CATransform3DConcat(CATransform3DConcat(translationTransform, layerAnimation.transform),
+                                                      inverseTranslationTransform);
+    CATransform3D transform = CATransform3DConcat(layerTransform, convTransform);
+    
+    if (animated && ! CATransform3DEqualToTransform(transform, layerTransform)) {
+        CABasicAnimation *transformAnimation = [CABasicAnimation animationWithKeyPath:@"transform"];
+        [transformAnimation setFromValue:[NSValue valueWithCATransform3D:layerTransform]];
+        [transformAnimation setToValue:[NSValue valueWithCATransform3D:transform]];
+        [animations addObject:transformAnimation];
+    }
+    layer.transform = transform;
+    
+    // Animate the anchor point
+    CGPoint anchorPoint = CGPointMake(layer.anchorPoint.x + layerAnimation.anchorPointTranslationParameters.v1,
+                                      layer.anchorPoint.y + layerAnimation.anchorPointTranslationParameters.v2);
+    CGFloat anchorPointZ = layer.anchorPointZ + layerAnimation.anchorPointTranslationParameters.v3;
+    
+    if (animated && ! CGPointEqualToPoint(anchorPoint, layer.anchorPoint)) {
+        CABasicAnimation *anchorPointAnimation = [CABasicAnimation animationWithKeyPath:@"anchorPoint"];
+        [anchorPointAnimation setFromValue:[NSValue valueWithCGPoint:layer.anchorPoint]];
+        [anchorPointAnimation setToValue:[NSValue valueWithCGPoint:anchorPoint]];
+        [animations addObject:anchorPointAnimation];
+    }
+    if (animated && ! floateq(anchorPointZ, layer.anchorPointZ)) {
+        CABasicAnimation *anchorPointZAnimation = [CABasicAnimation animationWithKeyPath:@"anchorPointZ"];
+        [anchorPointZAnimation setFromValue:[NSNumber numberWithFloat:layer.anchorPointZ]];
+        [anchorPointZAnimation setToValue:[NSNumber numberWithFloat:anchorPointZ]];
+        [animations addObject:anchorPointZAnimation];
+    }
+    layer.anchorPoint = anchorPoint;
+    layer.anchorPointZ = anchorPointZ;
+    
+    // Rasterization
+    if (layerAnimation.togglingShouldRasterize) {
+        BOOL shouldRasterize = ! layer.shouldRasterize;
+        if (animated) {
+            CABasicAnimation *shouldRasterizeAnimation = [CABasicAnimation animationWithKeyPath:@"shouldRasterize"];
+            [shouldRasterizeAnimation setFromValue:[NSNumber numberWithBool:layer.shouldRasterize]];
+            [shouldRasterizeAnimation setToValue:[NSNumber numberWithBool:shouldRasterize]];
+            [animations addObject:shouldRasterizeAnimation];
+        }
+        layer.shouldRasterize = shouldRasterize;
+    }
+    
+    // Rasterization scale
+    CGFloat rasterizationScale = layer.rasterizationScale + layerAnimation.rasterizationScaleIncrement;
+    if (animated && ! floateq(rasterizationScale, layer.rasterizationScale)) {
+        CABasicAnimation *rasterizationScaleAnimation = [CABasicAnimation animationWithKeyPath:@"rasterizationScale"];
+        [rasterizationScaleAnimation setFromValue:[NSNumber numberWithFloat:layer.rasterizationScale]];
+        [rasterizationScaleAnimation setToValue:[NSNumber numberWithFloat:rasterizationScale]];
+        [animations addObject:rasterizationScaleAnimation];
+    }
+    layer.rasterizationScale = rasterizationScale;
+    
+    // Get the sublayer transform without its perspective component (saved as additional layer information)
+    NSValue *nonProjectedSublayerTransformValue = [layer valueForKey:kLayerNonProjectedSublayerTransformKey];
+    CATransform3D nonProjectedSublayerTransform = CATransform3DIdentity;
+    if (nonProjectedSublayerTransformValue) {
+        nonProjectedSublayerTransform = [nonProjectedSublayerTransformValue CATransform3DValue];
+    }
+    else {
+        nonProjectedSublayerTransform = layer.sublayerTransform;
+    }
+    
+    // Get the current camera position (saved as additional layer information)
+    NSNumber *sublayerCameraZPositionNumber = [layer valueForKey:kLayerCameraZPositionForSublayersKey];
+    CGFloat sublayerCameraZPosition = 0.f;
+    if (sublayerCameraZPositionNumber) {
+        sublayerCameraZPosition = [sublayerCameraZPositionNumber floatValue];
+    }
+    else {
+        sublayerCameraZPosition = floateq(layer.sublayerTransform.m34, 0.f) ? 0.f : 1.f / layer.sublayerTransform.m34;
+    }
+    
+    // Calculate the sublayer transform (without perspective component)
+    CATransform3D sublayerTranslationTransform = CATransform3DMakeTranslation(-nonProjectedSublayerTransform.m41, -nonProjectedSublayerTransform.m42, 0.f);
+    CATransform3D inverseSublayerTranslationTransform = CATransform3DMakeTranslation(nonProjectedSublayerTransform.m41, nonProjectedSublayerTransform.m42, 0.f);
+    CATransform3D sublayerConvTransform = CATransform3DConcat(CATransform3DConcat(sublayerTranslationTransform, layerAnimation.sublayerTransform),
+                                                              inverseSublayerTranslationTransform);
+    CATransform3D sublayerTransform = CATransform3DConcat(nonProjectedSublayerTransform, sublayerConvTransform);
+    
+    // Calculate the new z-position of the camera
+    sublayerCameraZPosition += layerAnimation.sublayerCameraTranslationZ;
+    
+    // Save the information relative / not relative to the perspective separately
+    [layer setValue:[NSNumber numberWithFloat:sublayerCameraZPosition] forKey:kLayerCameraZPositionForSublayersKey];
+    [layer setValue:[NSValue valueWithCATransform3D:sublayerTransform] forKey:kLayerNonProjectedSublayerTransformKey];
+    
+    // Create the perspective matrix (see http://en.wikipedia.org/wiki/3D_projection#Perspective_projection)
+    CATransform3D perspectiveProjectionTransform = CATransform3DIdentity;
+    if (! floateq(sublayerCameraZPosition, 0.f)) {
+        perspectiveProjectionTransform.m34 = -1.f / sublayerCameraZPosition;
+    }
+    
+    // Apply the perspective
+    sublayerTransform = CATransform3DConcat(sublayerTransform, perspectiveProjectionTransform);
+    
+    if (animated && ! CATransform3DEqualToTransform(sublayerTransform, layer.sublayerTransform)) {
+        CABasicAnimation *sublayerTransformAnimation = [CABasicAnimation animationWithKeyPath:@"sublayerTransform"];
+        [sublayerTransformAnimation setFromValue:[NSValue valueWithCATransform3D:layer.sublayerTransform]];
+        [sublayerTransformAnimation setToValue:[NSValue valueWithCATransform3D:sublayerTransform]];
+        [animations addObject:sublayerTransformAnimation];
+    }
+    layer.sublayerTransform = sublayerTransform;
+    
+    // Numeric properties identified by their key path. Core Animation interpolates them (and redraws the layer at each
+    // frame if it requires display for the corresponding key)
+    if ([layerAnimation isKindOfClass:[HLSLayerPropertyAnimation class]]) {
+        NSDictionary *keyPathToIncrementMap = ((HLSLayerPropertyAnimation *)layerAnimation).keyPathToIncrementMap;
+        for (NSString *keyPath in [keyPathToIncrementMap allKeys]) {
+            CGFloat increment = [[keyPathToIncrementMap objectForKey:keyPath] floatValue];
+            if (floateq(increment, 0.f)) {
+                continue;
+            }
+            
+            NSNumber *valueNumber = [layer valueForKeyPath:keyPath];
+            if (! [valueNumber isKindOfClass:[NSNumber class]]) {
+                HLSLoggerWarn(@"The value for the key path %@ of layer %@ is not numeric. Ignored", keyPath, layer);
+                continue;
+            }
+            
+            NSNumber *newValueNumber = [NSNumber numberWithFloat:[valueNumber floatValue] + increment];
+            if (animated) {
+                CABasicAnimation *propertyAnimation = [CABasicAnimation animationWithKeyPath:keyPath];
+                [propertyAnimation setFromValue:valueNumber];
+                [propertyAnimation setToValue:newValueNumber];
+                [animations addObject:propertyAnimation];
+            }
+            [layer setValue:newValueNumber forKeyPath:keyPath];
+        }
+    }
+    
+    return [NSArray arrayWithArray:animations];
+}
+
+/**
+ * Apply the baked animation steps one after the other. If animated, the animations each step would have played are 
+ * not attached to the layers, but merged into a single keyframe animation per layer property instead, with a keyframe
+ * at each step boundary. For loops, the keyframe animations are reversed and repeated by Core Animation
+ */
+- (void)playBakedAnimationStepsWithTimeScale:(double)timeScale startTime:(NSTimeInterval)startTime animated:(BOOL)animated
+{
+    // Collect the values taken by each animated property at step boundaries. Maps a layer to a dictionary, which maps
+    // the key path of each animated property to the NSMutableArray of its values
+    NSMutableDictionary *layerToValuesMap = [NSMutableDictionary dictionary];
+    NSUInteger stepIndex = 0;
+    for (HLSLayerAnimationStep *animationStep in self.bakedAnimationSteps) {
+        for (CALayer *layer in [self objects]) {
+            NSValue *layerKey = [NSValue valueWithPointer:layer];
+            NSMutableDictionary *keyPathToValuesMap = [layerToValuesMap objectForKey:layerKey];
+            if (! keyPathToValuesMap) {
+                keyPathToValuesMap = [NSMutableDictionary dictionary];
+                [layerToValuesMap setObject:keyPathToValuesMap forKey:layerKey];
+            }
+            
+            HLSLayerAnimation *layerAnimation = (HLSLayerAnimation *)[animationStep objectAnimationForObject:layer];
+            if (layerAnimation) {
+                NSArray *animations = [animationStep animationsByApplyingLayerAnimation:layerAnimation toLayer:layer animated:animated];
+                for (CABasicAnimation *animation in animations) {
+                    // A property first animated by this step kept its initial value until now
+                    NSMutableArray *values = [keyPathToValuesMap objectForKey:animation.keyPath];
+                    if (! values) {
+                        values = [NSMutableArray array];
+                        for (NSUInteger i = 0; i <= stepIndex; ++i) {
+                            [values addObject:animation.fromValue];
+                        }
+                        [keyPathToValuesMap setObject:values forKey:animation.keyPath];
+                    }
+                    [values addObject:animation.toValue];
+                }
+            }
+            
+            // Properties not animated by this step keep their value
+            for (NSMutableArray *values in [keyPathToValuesMap allValues]) {
+                if ([values count] == stepIndex + 1) {
+                    [values addObject:[values lastObject]];
+                }
+            }
+        }
+        ++stepIndex;
+    }
+    
+    // A loop ends where it started. Apply the reverse steps so that the layers (and the information attached to them)
+    // reach this state as well
+    for (HLSLayerAnimationStep *reverseAnimationStep in self.bakedReverseAnimationSteps) {
+        for (CALayer *layer in [self objects]) {
+            HLSLayerAnimation *layerAnimation = (HLSLayerAnimation *)[reverseAnimationStep objectAnimationForObject:layer];
+            if (layerAnimation) {
+                [reverseAnimationStep animationsByApplyingLayerAnimation:layerAnimation toLayer:layer animated:NO];
+            }
+        }
+    }
+    
+    if (! animated) {
+        return;
+    }
+    
+    // Key times and timing functions are the same for all layers. Each segment between two keyframes uses the timing 
+    // function of the corresponding step. If all steps have zero duration, key times cannot be derived from the step 
+    // durations (division by zero). Space them evenly instead
+    NSTimeInterval bakedDuration = [self bakedAnimationStepsDuration];
+    NSMutableArray *keyTimes = [NSMutableArray arrayWithObject:[NSNumber numberWithDouble:0.]];
+    NSMutableArray *timingFunctions = [NSMutableArray array];
+    NSTimeInterval elapsedDuration = 0.;
+    NSUInteger stepCount = 0;
+    for (HLSLayerAnimationStep *animationStep in self.bakedAnimationSteps) {
+        elapsedDuration += animationStep.duration;
+        ++stepCount;
+        if (doubleeq(bakedDuration, 0.)) {
+            [keyTimes addObject:[NSNumber numberWithDouble:(double)stepCount / [self.bakedAnimationSteps count]]];
+        }
+        else {
+            [keyTimes addObject:[NSNumber numberWithDouble:elapsedDuration / bakedDuration]];
+        }
+        
+        CAMediaTimingFunction *timingFunction = animationStep.timingFunction;
+        if (! timingFunction) {
+            timingFunction = [CAMediaTimingFunction functionWithName:kCAMediaTimingFunctionLinear];
+        }
+        [timingFunctions addObject:timingFunction];
+    }
+    
+    NSTimeInterval duration = self.duration * timeScale;
+    for (CALayer *layer in [self objects]) {
+        NSDictionary *keyPathToValuesMap = [layerToValuesMap objectForKey:[NSValue valueWithPointer:layer]];
+        if ([keyPathToValuesMap count] == 0) {
+            continue;
+        }
+        
+        // As for steps played separately, the animations must have the expected duration, but must be offset according
+        // to the start time. Reversing the keyframes yields the reverse steps since their timing functions are inverted 
+        // as well
+        NSMutableArray *animations = [NSMutableArray array];
+        for (NSString *keyPath in [keyPathToValuesMap allKeys]) {
+            CAKeyframeAnimation *keyframeAnimation = [CAKeyframeAnimation animationWithKeyPath:keyPath];
+            keyframeAnimation.values = [keyPathToValuesMap objectForKey:keyPath];
+            keyframeAnimation.keyTimes = keyTimes;
+            keyframeAnimation.timingFunctions = timingFunctions;
+            keyframeAnimation.timeOffset = startTime;
+            if (self.additive) {
+                HLSLayerAnimationMakeAdditive(keyframeAnimation);
+            }
+            if (self.bakedReverseAnimationSteps) {
+                keyframeAnimation.duration = bakedDuration * timeScale;
+                keyframeAnimation.autoreverses = YES;
+                keyframeAnimation.repeatCount = self.bakedRepeatCount;
+            }
+            else {
+                keyframeAnimation.duration = duration;
+            }
+            [animations addObject:keyframeAnimation];
+        }
+        
+        CAAnimationGroup *animationGroup = [CAAnimationGroup animation];
+        animationGroup.animations = [NSArray arrayWithArray:animations];
+        animationGroup.delegate = self;
+        
+        // The group cuts its animations at the end of the transaction, except when looping forever
+        if (isinf(duration)) {
+            animationGroup.duration = 2. * [self bakedAnimationStepsDuration] * timeScale;
+            animationGroup.repeatCount = HUGE_VALF;
+        }
+        [layer addAnimation:animationGroup forKey:self.layerAnimationGroupKey];
+        ++m_numberOfLayerAnimations;
+    }
+}
+
+/**
+ * The total duration of the baked steps (for loops, the duration of a single loop is twice as long)
+ */
+- (NSTimeInterval)bakedAnimationStepsDuration
+{
+    NSTimeInterval bakedAnimationStepsDuration = 0.;
+    for (HLSLayerAnimationStep *animationStep in self.bakedAnimationSteps) {
+        bakedAnimationStepsDuration += animationStep.duration;
+    }
+    return bakedAnimationStepsDuration;
+}
+
 #pragma mark Reverse animation
 
 - (id)reverseAnimationStep
 {
     HLSLayerAnimationStep *reverseAnimationStep = [super reverseAnimationStep];
     reverseAnimationStep.timingFunction = [self.timingFunction inverseFunction];
+    reverseAnimationStep.additive = self.additive;
     return reverseAnimationStep;
 }
 
@@ -368,6 +697,10 @@ static NSString * const kLayerCameraZPositionForSublayersKey = @"HLSLayerCameraZ
 {
     HLSLayerAnimationStep *animationStepCopy = [super copyWithZone:zone];
     animationStepCopy.timingFunction = self.timingFunction;
+    animationStepCopy.additive = self.additive;
+    animationStepCopy.bakedAnimationSteps = self.bakedAnimationSteps;
+    animationStepCopy.bakedReverseAnimationSteps = self.bakedReverseAnimationSteps;
+    animationStepCopy.bakedRepeatCount = self.bakedRepeatCount;
     return animationStepCopy;
 }
 
@@ -395,3 +728,78 @@ static NSString * const kLayerCameraZPositionForSublayersKey = @"HLSLayerCameraZ
 
 @end
 
+#pragma mark Additive animations
+
+/**
+ * Return the value which, added by Core Animation to targetValue, yields value (nil if it cannot be calculated). Numbers
+ * and points are added, transforms are concatenated
+ */
+static id HLSLayerAnimationAdditiveValue(id value, id targetValue)
+{
+    if ([value isKindOfClass:[NSNumber class]]) {
+        return [NSNumber numberWithFloat:[value floatValue] - [targetValue floatValue]];
+    }
+    else if (strcmp([value objCType], @encode(CGPoint)) == 0) {
+        CGPoint point = [value CGPointValue];
+        CGPoint targetPoint = [targetValue CGPointValue];
+        return [NSValue valueWithCGPoint:CGPointMake(point.x - targetPoint.x, point.y - targetPoint.y)];
+    }
+    else if (strcmp([value objCType], @encode(CATransform3D)) == 0) {
+        CATransform3D targetTransform = [targetValue CATransform3DValue];
+        CATransform3D inverseTargetTransform = CATransform3DInvert(targetTransform);
+        
+        // CATransform3DInvert returns its argument if it cannot be inverted. Tell such transforms from those which are
+        // their own inverse
+        if (CATransform3DEqualToTransform(inverseTargetTransform, targetTransform)) {
+            CATransform3D squareTransform = CATransform3DConcat(targetTransform, targetTransform);
+            const CGFloat *squareElements = (const CGFloat *)&squareTransform;
+            const CGFloat *identityElements = (const CGFloat *)&CATransform3DIdentity;
+            for (NSUInteger i = 0; i < sizeof(CATransform3D) / sizeof(CGFloat); ++i) {
+                if (fabs(squareElements[i] - identityElements[i]) > 1e-4) {
+                    return nil;
+                }
+            }
+        }
+        return [NSValue valueWithCATransform3D:CATransform3DConcat([value CATransform3DValue], inverseTargetTransform)];
+    }
+    else {
+        return nil;
+    }
+}
+
+/**
+ * Turn an animation from absolute values into an additive animation ending at zero (the animation is left unchanged
+ * if this is not possible)
+ */
+static void HLSLayerAnimationMakeAdditive(CAPropertyAnimation *animation)
+{
+    // Boolean values cannot be added
+    if ([animation.keyPath isEqualToString:@"shouldRasterize"]) {
+        return;
+    }
+    
+    if ([animation isKindOfClass:[CAKeyframeAnimation class]]) {
+        CAKeyframeAnimation *keyframeAnimation = (CAKeyframeAnimation *)animation;
+        id targetValue = [keyframeAnimation.values lastObject];
+        NSMutableArray *additiveValues = [NSMutableArray arrayWithCapacity:[keyframeAnimation.values count]];
+        for (id value in keyframeAnimation.values) {
+            id additiveValue = HLSLayerAnimationAdditiveValue(value, targetValue);
+            if (! additiveValue) {
+                return;
+            }
+            [additiveValues addObject:additiveValue];
+        }
+        keyframeAnimation.values = [NSArray arrayWithArray:additiveValues];
+    }
+    else {
+        CABasicAnimation *basicAnimation = (CABasicAnimation *)animation;
+        id additiveFromValue = HLSLayerAnimationAdditiveValue(basicAnimation.fromValue, basicAnimation.toValue);
+        id additiveToValue = HLSLayerAnimationAdditiveValue(basicAnimation.toValue, basicAnimation.toValue);
+        if (! additiveFromValue || ! additiveToValue) {
+            return;
+        }
+        basicAnimation.fromValue = additiveFromValue;
+        basicAnimation.toValue = additiveToValue;
+    }
+    animation.additive = YES;
+}
@@ -0,0 +1,20 @@
+//
+//  HLSLayerPropertyAnimation+Friend.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+/**
+ * Interface meant to be used by friend classes of HLSLayerPropertyAnimation (= classes which must have access to private 
+ * implementation details)
+ */
+@interface HLSLayerPropertyAnimation (Friend)
+
+/**
+ * The increments to apply to layer properties (NSNumber values), keyed by property key path
+ */
+@property (nonatomic, readonly, retain) NSDictionary *keyPathToIncrementMap;
+
+@end
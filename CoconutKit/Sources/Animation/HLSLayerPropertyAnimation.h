@@ -0,0 +1,39 @@
+//
+//  HLSLayerPropertyAnimation.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSLayerAnimation.h"
+
+/**
+ * A layer property animation is a layer animation which, in addition to the changes supported by HLSLayerAnimation,
+ * can animate any numeric layer property identified by its key path. Like all layer animations, it must be added to
+ * a layer animation step (HLSLayerAnimationStep), whose duration and timing function it uses.
+ *
+ * The value changes are performed by Core Animation:
+ *   - for animatable CALayer properties (e.g. the strokeEnd property of a CAShapeLayer, which can be used to draw
+ *     a progress ring, or the cornerRadius of any layer), the render server interpolates the values, and the main
+ *     thread is not involved during the animation
+ *   - for custom properties of your own CALayer subclasses (e.g. the value displayed by a gauge), declare the property
+ *     as @dynamic and return YES from +needsDisplayForKey: for its key. Core Animation then interpolates the values 
+ *     and asks the presentation layer to redraw itself at each frame, without any timer being required
+ *
+ * As for opacity, values are changed by increments, so that the reverse animation can be easily calculated
+ *
+ * Designated initializer: -init (create a layer property animation with default settings)
+ */
+@interface HLSLayerPropertyAnimation : HLSLayerAnimation {
+@private
+    NSDictionary *m_keyPathToIncrementMap;
+}
+
+/**
+ * Increment or decrement to be applied to the value of a numeric layer property during the layer animation. Setting
+ * an increment for a key path replaces any increment previously set for it
+ */
+- (void)addToValue:(CGFloat)increment forKeyPath:(NSString *)keyPath;
+
+@end
@@ -0,0 +1,91 @@
+//
+//  HLSLayerPropertyAnimation.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSLayerPropertyAnimation.h"
+
+#import "HLSLayerPropertyAnimation+Friend.h"
+#import "HLSLogger.h"
+#import "HLSObjectAnimation+Friend.h"
+#import "NSString+HLSExtensions.h"
+
+@interface HLSLayerPropertyAnimation ()
+
+@property (nonatomic, retain) NSDictionary *keyPathToIncrementMap;
+
+@end
+
+@implementation HLSLayerPropertyAnimation
+
+#pragma mark Object creation and destruction
+
+- (id)init
+{
+    if ((self = [super init])) {
+        self.keyPathToIncrementMap = [NSDictionary dictionary];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    self.keyPathToIncrementMap = nil;
+    
+    [super dealloc];
+}
+
+#pragma mark Accessors and mutators
+
+@synthesize keyPathToIncrementMap = m_keyPathToIncrementMap;
+
+#pragma mark Convenience methods
+
+- (void)addToValue:(CGFloat)increment forKeyPath:(NSString *)keyPath
+{
+    if (! [keyPath isFilled]) {
+        HLSLoggerError(@"A key path is required");
+        return;
+    }
+    
+    NSMutableDictionary *keyPathToIncrementMap = [NSMutableDictionary dictionaryWithDictionary:self.keyPathToIncrementMap];
+    [keyPathToIncrementMap setObject:[NSNumber numberWithFloat:increment] forKey:keyPath];
+    self.keyPathToIncrementMap = [NSDictionary dictionaryWithDictionary:keyPathToIncrementMap];
+}
+
+#pragma mark Reverse animation
+
+- (id)reverseObjectAnimation
+{
+    HLSLayerPropertyAnimation *reverseLayerPropertyAnimation = [super reverseObjectAnimation];
+    for (NSString *keyPath in [self.keyPathToIncrementMap allKeys]) {
+        CGFloat increment = [[self.keyPathToIncrementMap objectForKey:keyPath] floatValue];
+        [reverseLayerPropertyAnimation addToValue:-increment forKeyPath:keyPath];
+    }
+    return reverseLayerPropertyAnimation;
+}
+
+#pragma mark NSCopying protocol implementation
+
+- (id)copyWithZone:(NSZone *)zone
+{
+    HLSLayerPropertyAnimation *layerPropertyAnimationCopy = [super copyWithZone:zone];
+    layerPropertyAnimationCopy.keyPathToIncrementMap = self.keyPathToIncrementMap;
+    return layerPropertyAnimationCopy;
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; layerAnimation: %@; keyPathToIncrementMap: %@>",
+            [self class],
+            self,
+            [super description],
+            self.keyPathToIncrementMap];
+}
+
+@end
@@ -18,12 +18,18 @@
  * To create a view animation step, simply instantiate it using the +animationStep class method, then add view animations
  * to it, and set its duration and curve
  *
+ * Views whose frame can be changed without any layout (views which are only translated, or which have no subviews)
+ * are animated using their transform instead, and their final frame is committed once when the step ends. This saves 
+ * the layout and autoresizing passes otherwise triggered by frame changes. Views which already have a transform, or 
+ * whose anchor point is not centered, are always animated using their frame
+ *
  * Designated initializer: -init (create an animation step with default settings)
  */
 @interface HLSViewAnimationStep : HLSAnimationStep {
 @private
     UIViewAnimationCurve m_curve;
     UIView *m_dummyView;
+    NSMutableArray *m_transformedViews;
 }
 
 /**
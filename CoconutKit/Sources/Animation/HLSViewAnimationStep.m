@@ -18,6 +18,10 @@
 @interface HLSViewAnimationStep ()
 
 @property (nonatomic, retain) UIView *dummyView;
+@property (nonatomic, retain) NSMutableArray *transformedViews;
+
+- (BOOL)canAnimateView:(UIView *)view withTransformForViewAnimation:(HLSViewAnimation *)viewAnimation;
+- (void)commitTransformedViewFrames;
 
 - (void)animationStepDidStop:(NSString *)animationID finished:(NSNumber *)finished context:(void *)context;
 
@@ -38,6 +42,7 @@
 - (void)dealloc
 {
     self.dummyView = nil;
+    self.transformedViews = nil;
     
     [super dealloc];
 }
@@ -48,6 +53,8 @@
 
 @synthesize dummyView = m_dummyView;
 
+@synthesize transformedViews = m_transformedViews;
+
 #pragma mark Managing the animation
 
 - (void)addViewAnimation:(HLSViewAnimation *)viewAnimation forView:(UIView *)view
@@ -78,6 +85,14 @@
         //         in the UIKit UIView header documentation, are reserved by Apple. Using them might lead to app rejection!
         [UIView setAnimationDidStopSelector:@selector(animationStepDidStop:finished:context:)];
         [UIView setAnimationDelegate:self];
+        
+        self.transformedViews = [NSMutableArray array];
+    }
+    else {
+        // Steps played without animation (most notably the remaining steps of a cancelled or terminated animation)
+        // apply all their changes in a single transaction
+        [CATransaction begin];
+        [CATransaction setDisableActions:YES];
     }
     
     for (UIView *view in [self objects]) {
@@ -97,6 +112,14 @@
         
         view.alpha = alpha;
         
+        // Animate the transform instead of the frame when the result is the same. UIView transforms are applied on the 
+        // view center, no conversion is needed. No layout occurs until the final frame is committed
+        if (animated && [self canAnimateView:view withTransformForViewAnimation:viewAnimation]) {
+            view.transform = viewAnimation.transform;
+            [self.transformedViews addObject:view];
+            continue;
+        }
+        
         // Animate the frame. The transform has to be applied on the view center. This requires a conversion in the coordinate system
         // centered on the view
         CGAffineTransform translationTransform = CGAffineTransformMakeTranslation(-view.center.x, -view.center.y);
@@ -104,8 +127,12 @@
                                                                   CGAffineTransformInvert(translationTransform));
         view.frame = CGRectApplyAffineTransform(view.frame, convTransform);
         
-        // Ensure better subview resizing in some cases (e.g. UISearchBar)
-        [view layoutIfNeeded];
+        // Ensure better subview resizing in some cases (e.g. UISearchBar). This is only needed so that subviews are
+        // animated along. Without animation, the view is simply laid out once during the next layout pass, which
+        // spares one layout per view and per step when several steps are played in a row
+        if (animated) {
+            [view layoutIfNeeded];
+        }
     }
         
     if (animated) {
@@ -116,6 +143,9 @@
         
         // The code will resume in the animationDidStop:finished:context: method
     }
+    else {
+        [CATransaction commit];
+    }
 }
 
 - (void)pauseAnimation
@@ -141,6 +171,13 @@
 
 - (void)terminateAnimation
 {
+    // The model values of the views are already the final ones (UIView animations only animate the presentation
+    // layers). Removing the animations is therefore sufficient for the views to reach their end state, without any
+    // frame needing to be applied again (which would trigger a new layout). All animations are removed in a single 
+    // transaction so that the end state is committed at once
+    [CATransaction begin];
+    [CATransaction setDisableActions:YES];
+    
     // We must recursively cancel subview animations (this is especially important since altering the frame (e.g.
     // by scaling it) seems to create additional implicit animations, which still finish and trigger their end
     // animation callback with finished = YES!)
@@ -148,6 +185,10 @@
         [view.layer removeAllAnimationsRecursively];
     }
     [self.dummyView.layer removeAllAnimationsRecursively];
+    
+    [CATransaction commit];
+    
+    [self commitTransformedViewFrames];
 }
 
 - (NSTimeInterval)elapsedTime
@@ -158,6 +199,55 @@
     return self.duration;
 }
 
+#pragma mark Transform-based animation
+
+/**
+ * Return YES iff changing the frame of a view as required by a view animation can be replaced by a transform without
+ * any visible difference (no subview needs to be laid out)
+ */
+- (BOOL)canAnimateView:(UIView *)view withTransformForViewAnimation:(HLSViewAnimation *)viewAnimation
+{
+    if (! CGAffineTransformIsIdentity(view.transform) || ! CGPointEqualToPoint(view.layer.anchorPoint, CGPointMake(0.5f, 0.5f))) {
+        return NO;
+    }
+    
+    CGAffineTransform transform = viewAnimation.transform;
+    BOOL translationOnly = floateq(transform.a, 1.f) && floateq(transform.b, 0.f) && floateq(transform.c, 0.f) && floateq(transform.d, 1.f);
+    if (translationOnly) {
+        return YES;
+    }
+    
+    // A scaled transform stretches the current content of the view. Its frame can only be replaced by such a transform
+    // if the content is stretched as well when its frame changes, and if there is no subview to lay out
+    return [view.subviews count] == 0 && view.contentMode == UIViewContentModeScaleToFill;
+}
+
+/**
+ * Replace the transforms of the views animated using their transform with the equivalent frames, in a single transaction
+ * and without animation
+ */
+- (void)commitTransformedViewFrames
+{
+    if ([self.transformedViews count] == 0) {
+        return;
+    }
+    
+    [CATransaction begin];
+    [CATransaction setDisableActions:YES];
+    
+    for (UIView *view in self.transformedViews) {
+        // The frame of a view with a transform is the bounding box of the transformed view, i.e. the frame we want
+        // for scales and translations
+        CGRect frame = view.frame;
+        view.transform = CGAffineTransformIdentity;
+        view.frame = frame;
+    }
+    
+    [CATransaction commit];
+    
+    self.transformedViews = nil;
+}
+
 #pragma mark Reverse animation
 
 - (id)reverseAnimationStep
@@ -197,6 +287,8 @@
     [self.dummyView removeFromSuperview];
     self.dummyView = nil;
     
+    [self commitTransformedViewFrames];
+    
     [self notifyAsynchronousAnimationStepDidStopFinished:[finished boolValue]];
 }
 
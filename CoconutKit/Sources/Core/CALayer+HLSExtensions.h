@@ -15,12 +15,15 @@
 - (void)removeAllAnimationsRecursively;
 
 /**
- * Pause all animations attached to a layer. Does nothing if the layer was already paused
+ * Pause all animations attached to a layer. Does nothing if the layer was already paused. Only the timing of the
+ * layer itself is changed (sublayers inherit it), the cost of this method is therefore independent of the size of 
+ * the layer tree. The animations of the sublayers are paused as well
  */
 - (void)pauseAllAnimations;
 
 /**
- * Resume animations attached to a layer. Does nothing if the layer was not paused
+ * Resume animations attached to a layer (and to its sublayers). Does nothing if the layer was not paused.
+ * Like -pauseAllAnimations, only the timing of the layer itself is changed
  */
 - (void)resumeAllAnimations;
 
@@ -34,4 +37,29 @@
  */
 - (UIImage *)flattenedImage;
 
+/**
+ * Return the part of the layer (and of its sublayers) located within rect, flattened as a UIImage having the
+ * specified scale. Using a scale lower than the device scale factor is a cheap way to capture large layers, and
+ * if scale is 0 the device scale factor is used. The rect is expressed in a coordinate system whose origin is
+ * the top-left corner of the layer, the layer transform is ignored. Return nil if rect is empty
+ */
+- (UIImage *)flattenedImageWithScale:(CGFloat)scale rect:(CGRect)rect;
+
+/**
+ * Same as -flattenedImageWithScale:rect:, but return the result as an array of images of size tileSize (in points),
+ * listed row by row from the top-left corner of rect. Tiles on the right and bottom edges can be smaller. No bitmap 
+ * having the whole size of rect is ever created, which makes it possible to capture very large layers
+ */
+- (NSArray *)flattenedImageTilesOfSize:(CGSize)tileSize scale:(CGFloat)scale rect:(CGRect)rect;
+
+/**
+ * Asynchronous version of -flattenedImageWithScale:rect:. The layer is rendered on the main thread, but only a 
+ * band of it is rendered during each run loop iteration, so that the user interface stays responsive during the
+ * whole process. The state of the layer tree is therefore the one during which each band is rendered. Once the
+ * image has been created, the completion action is called with the following signature:
+ *   - (void)methodName:(UIImage *)image
+ * The layer and the target are retained until the action has been called. Must be called from the main thread
+ */
+- (void)flattenImageWithScale:(CGFloat)scale rect:(CGRect)rect completionTarget:(id)target action:(SEL)action;
+
 @end
@@ -8,13 +8,45 @@
 
 #import "CALayer+HLSExtensions.h"
 
+#import "HLSAssert.h"
+#import "HLSFloat.h"
 #import "HLSLogger.h"
 
 static NSString * const kLayerSpeedBeforePauseKey = @"HLSLayerSpeedBeforePause";
 
+// Height (in pixels) of the bands rendered during each run loop iteration when flattening asynchronously
+static const size_t kLayerFlatteningBandPixelHeight = 256;
+
+// Function declarations
+static CGFloat flatteningScale(CGFloat scale);
+static CGContextRef createFlatteningContext(CGRect rect, CGFloat scale, BOOL opaque);
+static UIImage *imageFromFlatteningContext(CGContextRef context, CGFloat scale);
+
+/**
+ * Asynchronous flattening of a layer, band by band
+ */
+@interface HLSLayerFlatteningRequest : NSObject {
+@private
+    CALayer *_layer;
+    CGRect _rect;
+    CGFloat _scale;
+    CGContextRef _context;
+    size_t _nextBandIndex;
+    id _target;
+    SEL _action;
+}
+
+- (id)initWithLayer:(CALayer *)layer scale:(CGFloat)scale rect:(CGRect)rect completionTarget:(id)target action:(SEL)action;
+
+- (void)start;
+- (void)renderNextBand;
+
+@end
+
 @interface CALayer (HLSExtensionsPrivate)
 
 - (void)resetAnimations;
+- (void)renderRect:(CGRect)rect inFlatteningContext:(CGContextRef)context ofRect:(CGRect)contextRect scale:(CGFloat)scale;
 
 @end
 
@@ -27,7 +59,10 @@ static NSString * const kLayerSpeedBeforePauseKey = @"HLSLayerSpeedBeforePause";
     // only reached if the animation is not paused, and resuming animation restores layer properties)
     [self resetAnimations];
     
-    [self removeAllAnimations];
+    // Layers have no animations in general. Avoid useless work in such cases
+    if ([self animationKeys]) {
+        [self removeAllAnimations];
+    }
     
     for (CALayer *sublayer in self.sublayers) {
         [sublayer removeAllAnimationsRecursively];
@@ -115,6 +150,65 @@ static NSString * const kLayerSpeedBeforePauseKey = @"HLSLayerSpeedBeforePause";
     return image;
 }
 
+- (UIImage *)flattenedImageWithScale:(CGFloat)scale rect:(CGRect)rect
+{
+    scale = flatteningScale(scale);
+    CGContextRef context = createFlatteningContext(rect, scale, self.opaque);
+    if (! context) {
+        return nil;
+    }
+    
+    [self renderRect:rect inFlatteningContext:context ofRect:rect scale:scale];
+    
+    UIImage *image = imageFromFlatteningContext(context, scale);
+    CGContextRelease(context);
+    return image;
+}
+
+- (NSArray *)flattenedImageTilesOfSize:(CGSize)tileSize scale:(CGFloat)scale rect:(CGRect)rect
+{
+    if (floatle(tileSize.width, 0.f) || floatle(tileSize.height, 0.f)) {
+        HLSLoggerError(@"Invalid tile size");
+        return nil;
+    }
+    
+    NSMutableArray *tiles = [NSMutableArray array];
+    for (CGFloat y = CGRectGetMinY(rect); floatlt(y, CGRectGetMaxY(rect)); y += tileSize.height) {
+        for (CGFloat x = CGRectGetMinX(rect); floatlt(x, CGRectGetMaxX(rect)); x += tileSize.width) {
+            CGRect tileRect = CGRectIntersection(CGRectMake(x, y, tileSize.width, tileSize.height), rect);
+            
+            // Each tile is rendered in its own pool, so that temporary objects do not accumulate
+            NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+            UIImage *tile = [self flattenedImageWithScale:scale rect:tileRect];
+            if (tile) {
+                [tiles addObject:tile];
+            }
+            [pool drain];
+        }
+    }
+    return [NSArray arrayWithArray:tiles];
+}
+
+- (void)flattenImageWithScale:(CGFloat)scale rect:(CGRect)rect completionTarget:(id)target action:(SEL)action
+{
+    if (! [NSThread isMainThread]) {
+        HLSLoggerError(@"Asynchronous flattening must be started from the main thread");
+        return;
+    }
+    
+    if (target && ! [target respondsToSelector:action]) {
+        HLSLoggerError(@"The target %@ does not respond to the selector %@", target, NSStringFromSelector(action));
+        return;
+    }
+    
+    HLSLayerFlatteningRequest *request = [[[HLSLayerFlatteningRequest alloc] initWithLayer:self
+                                                                                      scale:scale
+                                                                                       rect:rect
+                                                                           completionTarget:target
+                                                                                     action:action] autorelease];
+    [request start];
+}
+
 @end
 
 @implementation CALayer (HLSExtensionsPrivate)
@@ -128,8 +222,142 @@ static NSString * const kLayerSpeedBeforePauseKey = @"HLSLayerSpeedBeforePause";
         [self setValue:nil forKey:kLayerSpeedBeforePauseKey];
     }
     
-    self.timeOffset = 0.;
-    self.beginTime = 0.;
+    // Only paused or resumed layers have non-zero values. Since this method is called for entire layer trees,
+    // avoid setting values (and thus committing layer changes) for all other layers
+    if (self.timeOffset != 0.) {
+        self.timeOffset = 0.;
+    }
+    if (self.beginTime != 0.) {
+        self.beginTime = 0.;
+    }
+}
+
+/**
+ * Render the part of the layer within rect into a context created with createFlatteningContext() for contextRect
+ */
+- (void)renderRect:(CGRect)rect inFlatteningContext:(CGContextRef)context ofRect:(CGRect)contextRect scale:(CGFloat)scale
+{
+    CGContextSaveGState(context);
+    
+    // Bitmap contexts have their origin at the bottom left. Flip them like UIKit image contexts so that the 
+    // rect origin matches the top-left corner of the context
+    CGContextTranslateCTM(context, 0.f, CGBitmapContextGetHeight(context));
+    CGContextScaleCTM(context, scale, -scale);
+    CGContextTranslateCTM(context, -CGRectGetMinX(contextRect), -CGRectGetMinY(contextRect));
+    CGContextClipToRect(context, rect);
+    
+    [self renderInContext:context];
+    
+    CGContextRestoreGState(context);
+}
+
+@end
+
+@implementation HLSLayerFlatteningRequest
+
+#pragma mark -
+#pragma mark Object creation and destruction
+
+- (id)initWithLayer:(CALayer *)layer scale:(CGFloat)scale rect:(CGRect)rect completionTarget:(id)target action:(SEL)action
+{
+    if ((self = [super init])) {
+        _layer = [layer retain];
+        _rect = rect;
+        _scale = flatteningScale(scale);
+        _context = createFlatteningContext(rect, _scale, layer.opaque);
+        _target = [target retain];
+        _action = action;
+    }
+    return self;
+}
+
+- (id)init
+{
+    HLSForbiddenInheritedMethod();
+    return nil;
+}
+
+- (void)dealloc
+{
+    [_layer release];
+    CGContextRelease(_context);
+    [_target release];
+    [super dealloc];
+}
+
+#pragma mark -
+#pragma mark Rendering
+
+- (void)start
+{
+    // Keep the request alive until it is complete
+    [self retain];
+    [self renderNextBand];
+}
+
+- (void)renderNextBand
+{
+    if (_context) {
+        size_t pixelHeight = CGBitmapContextGetHeight(_context);
+        size_t firstPixelRow = _nextBandIndex * kLayerFlatteningBandPixelHeight;
+        if (firstPixelRow < pixelHeight) {
+            CGRect bandRect = CGRectMake(CGRectGetMinX(_rect), 
+                                         CGRectGetMinY(_rect) + firstPixelRow / _scale, 
+                                         CGRectGetWidth(_rect), 
+                                         kLayerFlatteningBandPixelHeight / _scale);
+            [_layer renderRect:CGRectIntersection(bandRect, _rect) inFlatteningContext:_context ofRect:_rect scale:_scale];
+            ++_nextBandIndex;
+            
+            // Give the run loop a chance to process events before rendering the next band
+            [self performSelector:@selector(renderNextBand) 
+                       withObject:nil 
+                       afterDelay:0. 
+                          inModes:[NSArray arrayWithObject:NSRunLoopCommonModes]];
+            return;
+        }
+    }
+    
+    UIImage *image = _context ? imageFromFlatteningContext(_context, _scale) : nil;
+    [_target performSelector:_action withObject:image];
+    [self release];
 }
 
 @end
+
+#pragma mark Static functions
+
+static CGFloat flatteningScale(CGFloat scale)
+{
+    return floatle(scale, 0.f) ? [UIScreen mainScreen].scale : scale;
+}
+
+static CGContextRef createFlatteningContext(CGRect rect, CGFloat scale, BOOL opaque)
+{
+    size_t width = (size_t)ceilf(CGRectGetWidth(rect) * scale);
+    size_t height = (size_t)ceilf(CGRectGetHeight(rect) * scale);
+    if (width == 0 || height == 0) {
+        return NULL;
+    }
+    
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    CGContextRef context = CGBitmapContextCreate(NULL, 
+                                                 width, 
+                                                 height, 
+                                                 8, 
+                                                 0, 
+                                                 colorSpace, 
+                                                 kCGBitmapByteOrder32Little | (opaque ? kCGImageAlphaNoneSkipFirst : kCGImageAlphaPremultipliedFirst));
+    CGColorSpaceRelease(colorSpace);
+    if (! context) {
+        HLSLoggerError(@"Could not create a %zux%zu bitmap context", width, height);
+    }
+    return context;
+}
+
+static UIImage *imageFromFlatteningContext(CGContextRef context, CGFloat scale)
+{
+    CGImageRef imageRef = CGBitmapContextCreateImage(context);
+    UIImage *image = [UIImage imageWithCGImage:imageRef scale:scale orientation:UIImageOrientationUp];
+    CGImageRelease(imageRef);
+    return image;
+}
@@ -9,10 +9,19 @@
 @interface CAMediaTimingFunction (HLSExtensions)
 
 /**
- * Return the inverse function, i.e. the one which must be played when playing an animation backwards
+ * Return the inverse function, i.e. the one which must be played when playing an animation backwards. Inverse
+ * functions are cached, the same object is therefore returned for functions having the same control points
  */
 - (CAMediaTimingFunction *)inverseFunction;
 
+/**
+ * Return the progress (usually between 0 and 1) corresponding to a normalized time (between 0 and 1, values outside
+ * this range are clamped), i.e. evaluate the timing curve at the given time. The result is calculated numerically,
+ * without any Core Animation object being created. This can be used to map elapsed time to progress, e.g. when an 
+ * animation is started somewhere in its middle or driven interactively
+ */
+- (CGFloat)progressAtTime:(CGFloat)time;
+
 /**
  * Return the control points as a human-readable string
  */
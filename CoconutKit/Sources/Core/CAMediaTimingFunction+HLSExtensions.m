@@ -8,40 +8,237 @@
 
 #import "CAMediaTimingFunction+HLSExtensions.h"
 
+#import "HLSAssert.h"
+
+// Number of samples of the curve x(t) which are precomputed to find a good initial guess for Newton iterations
+#define HLS_TIMING_CURVE_SAMPLE_COUNT           11
+
+static const NSUInteger kTimingCurveNewtonIterations = 4;
+static const double kTimingCurveNewtonMinSlope = 0.001;
+static const double kTimingCurvePrecision = 1e-6;
+static const NSUInteger kTimingCurveBisectionIterations = 20;
+
+// Function declarations
+static void getControlPoints(CAMediaTimingFunction *timingFunction, float controlPoints[4]);
+static NSCache *timingCurveCache(void);
+
+/**
+ * Information calculated once for all timing functions sharing the same control points (the curve is a cubic Bézier
+ * curve from (0, 0) to (1, 1), its coefficients and samples are stored)
+ */
+@interface HLSTimingCurve : NSObject {
+@private
+    double _ax;
+    double _bx;
+    double _cx;
+    double _ay;
+    double _by;
+    double _cy;
+    double _samples[HLS_TIMING_CURVE_SAMPLE_COUNT];
+    CAMediaTimingFunction *_inverseFunction;
+}
+
++ (HLSTimingCurve *)timingCurveForFunction:(CAMediaTimingFunction *)timingFunction;
+
+- (id)initWithControlPoints:(float *)controlPoints;
+
+@property (nonatomic, retain) CAMediaTimingFunction *inverseFunction;
+
+- (double)progressAtTime:(double)time;
+
+@end
+
 @implementation CAMediaTimingFunction (HLSExtensions)
 
 - (CAMediaTimingFunction *)inverseFunction
 {
-    float values1[2];
-    memset(values1, 0, sizeof(values1));
-    [self getControlPointAtIndex:1 values:values1];
-     
-    float values2[2];
-    memset(values2, 0, sizeof(values2));
-    [self getControlPointAtIndex:2 values:values2];
-    
-    // Flip the original curve around the y = 1 - x axis
-    // Refer to the "Introduction to Animation Types and Timing Programming Guide"
-    return [CAMediaTimingFunction functionWithControlPoints:1.f - values2[0] :values1[1] :1.f - values1[0] :values2[1]];
+    HLSTimingCurve *timingCurve = [HLSTimingCurve timingCurveForFunction:self];
+    @synchronized(timingCurve) {
+        if (! timingCurve.inverseFunction) {
+            float controlPoints[4];
+            getControlPoints(self, controlPoints);
+            
+            // Rotate the original curve by 180° around (0.5, 0.5) (i.e. p'(t) = 1 - p(1 - t)). The control points
+            // must be swapped so that the curve still goes from (0, 0) to (1, 1)
+            // Refer to the "Introduction to Animation Types and Timing Programming Guide"
+            timingCurve.inverseFunction = [CAMediaTimingFunction functionWithControlPoints:1.f - controlPoints[2]
+                                                                                          :1.f - controlPoints[3]
+                                                                                          :1.f - controlPoints[0] 
+                                                                                          :1.f - controlPoints[1]];
+        }
+        return timingCurve.inverseFunction;
+    }
+}
+
+- (CGFloat)progressAtTime:(CGFloat)time
+{
+    return [[HLSTimingCurve timingCurveForFunction:self] progressAtTime:time];
 }
 
 - (NSString *)controlPointsString
 {
-    NSMutableString *controlPointsString = [NSMutableString stringWithString:@"["];
+    float controlPoints[4];
+    getControlPoints(self, controlPoints);
+    return [NSString stringWithFormat:@"[(0.00, 0.00), (%.2f, %.2f), (%.2f, %.2f), (1.00, 1.00)]",
+            controlPoints[0], controlPoints[1], controlPoints[2], controlPoints[3]];
+}
+
+@end
+
+@implementation HLSTimingCurve
+
+#pragma mark Class methods
+
++ (HLSTimingCurve *)timingCurveForFunction:(CAMediaTimingFunction *)timingFunction
+{
+    float controlPoints[4];
+    getControlPoints(timingFunction, controlPoints);
+    
+    // Key by exact control point values
+    NSString *key = [NSString stringWithFormat:@"%a;%a;%a;%a", controlPoints[0], controlPoints[1], controlPoints[2], controlPoints[3]];
+    NSCache *cache = timingCurveCache();
+    HLSTimingCurve *timingCurve = [cache objectForKey:key];
+    if (! timingCurve) {
+        timingCurve = [[[HLSTimingCurve alloc] initWithControlPoints:controlPoints] autorelease];
+        [cache setObject:timingCurve forKey:key];
+    }
+    return timingCurve;
+}
+
+#pragma mark Object creation and destruction
+
+- (id)initWithControlPoints:(float *)controlPoints
+{
+    if ((self = [super init])) {
+        // Polynomial coefficients of x(t) = ((ax * t + bx) * t + cx) * t (same for y)
+        _cx = 3. * controlPoints[0];
+        _bx = 3. * (controlPoints[2] - controlPoints[0]) - _cx;
+        _ax = 1. - _cx - _bx;
+        
+        _cy = 3. * controlPoints[1];
+        _by = 3. * (controlPoints[3] - controlPoints[1]) - _cy;
+        _ay = 1. - _cy - _by;
+        
+        for (NSUInteger i = 0; i < HLS_TIMING_CURVE_SAMPLE_COUNT; ++i) {
+            double t = (double)i / (HLS_TIMING_CURVE_SAMPLE_COUNT - 1);
+            _samples[i] = ((_ax * t + _bx) * t + _cx) * t;
+        }
+    }
+    return self;
+}
+
+- (id)init
+{
+    HLSForbiddenInheritedMethod();
+    return nil;
+}
+
+- (void)dealloc
+{
+    self.inverseFunction = nil;
+    
+    [super dealloc];
+}
+
+#pragma mark Accessors and mutators
+
+@synthesize inverseFunction = _inverseFunction;
+
+#pragma mark Evaluation
+
+- (double)progressAtTime:(double)time
+{
+    if (time <= 0.) {
+        return 0.;
+    }
+    else if (time >= 1.) {
+        return 1.;
+    }
+    
+    // Find the curve parameter t for which x(t) = time. Start with a linear interpolation between the two samples
+    // enclosing the time
+    NSUInteger i = 1;
+    while (i < HLS_TIMING_CURVE_SAMPLE_COUNT - 1 && _samples[i] < time) {
+        ++i;
+    }
+    double sampleStep = 1. / (HLS_TIMING_CURVE_SAMPLE_COUNT - 1);
+    double lowerT = (i - 1) * sampleStep;
+    double sampleDelta = _samples[i] - _samples[i - 1];
+    double t = lowerT;
+    if (sampleDelta > 0.) {
+        t += sampleStep * (time - _samples[i - 1]) / sampleDelta;
+    }
     
-    for (size_t i = 0; i < 4; ++i) {
-        float values[2];
-        memset(values, 0, sizeof(values));
-        [self getControlPointAtIndex:i values:values];
-        [controlPointsString appendFormat:@"(%.2f, %.2f)", values[0], values[1]];
+    // Newton iterations (fast convergence when the slope is not too small)
+    BOOL converged = NO;
+    for (NSUInteger j = 0; j < kTimingCurveNewtonIterations; ++j) {
+        double x = ((_ax * t + _bx) * t + _cx) * t - time;
+        if (fabs(x) < kTimingCurvePrecision) {
+            converged = YES;
+            break;
+        }
         
-        if (i != 3) {
-            [controlPointsString appendString:@", "];
+        double slope = (3. * _ax * t + 2. * _bx) * t + _cx;
+        if (fabs(slope) < kTimingCurveNewtonMinSlope) {
+            break;
         }
+        t -= x / slope;
     }
-    [controlPointsString appendString:@"]"];
     
-    return [NSString stringWithString:controlPointsString];
+    // Fall back to bisection (the curve x(t) is monotonic for valid timing functions)
+    if (! converged || t < 0. || t > 1.) {
+        double lowT = lowerT;
+        double highT = lowerT + sampleStep;
+        t = (lowT + highT) / 2.;
+        for (NSUInteger j = 0; j < kTimingCurveBisectionIterations; ++j) {
+            double x = ((_ax * t + _bx) * t + _cx) * t;
+            if (fabs(x - time) < kTimingCurvePrecision) {
+                break;
+            }
+            
+            if (x < time) {
+                lowT = t;
+            }
+            else {
+                highT = t;
+            }
+            t = (lowT + highT) / 2.;
+        }
+    }
+    
+    return ((_ay * t + _by) * t + _cy) * t;
 }
 
 @end
+
+#pragma mark Static functions
+
+/**
+ * Return the coordinates of the two intermediate control points (x1, y1, x2, y2). The first and last control points
+ * are always (0, 0) and (1, 1)
+ */
+static void getControlPoints(CAMediaTimingFunction *timingFunction, float controlPoints[4])
+{
+    float values[2];
+    
+    memset(values, 0, sizeof(values));
+    [timingFunction getControlPointAtIndex:1 values:values];
+    controlPoints[0] = values[0];
+    controlPoints[1] = values[1];
+    
+    memset(values, 0, sizeof(values));
+    [timingFunction getControlPointAtIndex:2 values:values];
+    controlPoints[2] = values[0];
+    controlPoints[3] = values[1];
+}
+
+static NSCache *timingCurveCache(void)
+{
+    static NSCache *s_cache = nil;
+    @synchronized([HLSTimingCurve class]) {
+        if (! s_cache) {
+            s_cache = [[NSCache alloc] init];
+        }
+    }
+    return s_cache;
+}
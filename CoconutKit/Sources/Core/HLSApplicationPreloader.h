@@ -6,10 +6,21 @@
 //  Copyright (c) 2012 Hortis. All rights reserved.
 //
 
+// Forward declarations
+@class HLSTask;
+
 /**
  * Collects the code which can be executed right after an application has started so that perceived performance can be
- * increased. For the moment only UIWebView is preloaded so that the time usually required when instantiating the first
- * web view is reduced
+ * increased. Preloading starts once the application has finished launching and its first frame has been displayed:
+ *   - a UIWebView is loaded out of screen bounds on the main thread, so that the time usually required when instantiating 
+ *     the first web view is reduced. The shared web view pool is filled afterwards (see HLSWebViewPool)
+ *   - the preloading tasks which have been registered (e.g. for loading fonts or nibs, setting up a Core Data stack or 
+ *     decoding images) are submitted as a single task group to the default task manager, at very low priority 
+ *     (see HLSTaskManager). Dependencies between those tasks are honored
+ *
+ * Preloading tasks must be registered before the application has finished launching (a good place is the constructor
+ * function created by HLSEnableApplicationPreloading, or the beginning of -application:didFinishLaunchingWithOptions:).
+ * Registration must occur on the main thread
  */
 @interface HLSApplicationPreloader : NSObject <UIWebViewDelegate> {
 @private
@@ -22,4 +33,17 @@
  */
 + (void)enable;
 
+/**
+ * Register a task to be executed once the application has started. The task priority is set to HLSTaskPriorityVeryLow
+ * when preloading starts. Tasks registered after preloading has started are ignored
+ */
++ (void)registerPreloadingTask:(HLSTask *)task;
+
+/**
+ * Same as +registerPreloadingTask:, but the task is only started after all tasks in the dependencies array (which must
+ * have been registered before) have been processed. Dependencies are weak, i.e. the task is started even if one of them
+ * failed (see -[HLSTaskGroup addDependencyForTask:onTask:strong:])
+ */
++ (void)registerPreloadingTask:(HLSTask *)task dependencies:(NSArray *)dependencies;
+
 @end
@@ -9,19 +9,20 @@
 #import "HLSApplicationPreloader.h"
 
 #import "HLSAssert.h"
+#import "HLSLaunchTrace.h"
 #import "HLSLogger.h"
-#import "HLSRuntime.h"
+#import "HLSTaskGroup.h"
+#import "HLSTaskManager.h"
+#import "HLSWebViewPool.h"
 
-// Keys for associated objects
-static void *s_applicationPreloaderKey = &s_applicationPreloaderKey;
+static NSString * const kApplicationPreloaderTaskGroupTag = @"HLSApplicationPreloader";
 
-// Original implementations of the application:didFinishLaunchingWithOptions: methods we swizzle. We need to swizzle
-// those methods for each class which conforms to the UIApplicationDelegate protocol, thus the need for a mapping 
-// between class names and swizzled implementations
-NSDictionary *s_classNameToSwizzledApplicationDidFinishLaunchingWithOptionsImpMap = nil;
+// The preloader currently at work (retained until the web view has been preloaded)
+static HLSApplicationPreloader *s_applicationPreloader = nil;
 
-// Swizzled method implementations
-static BOOL swizzled_UIApplicationDelegate__application_didFinishLaunchingWithOptions(id self, SEL _cmd, UIApplication *application, NSDictionary *launchOptions);
+// Registered preloading tasks (nil once submitted)
+static HLSTaskGroup *s_preloadingTaskGroup = nil;
+static BOOL s_preloadingStarted = NO;
 
 @interface HLSApplicationPreloader ()
 
@@ -31,9 +32,13 @@ static BOOL swizzled_UIApplicationDelegate__application_didFinishLaunchingWithOp
 
 @interface HLSApplicationPreloader ()
 
++ (void)applicationDidFinishLaunching:(NSNotification *)notification;
+
 - (id)initWithApplication:(UIApplication *)application;
 
 - (void)preload;
+- (void)preloadWebView;
+- (void)submitPreloadingTasks;
 
 @end
 
@@ -49,38 +54,74 @@ static BOOL swizzled_UIApplicationDelegate__application_didFinishLaunchingWithOp
         return;
     }
     
-    NSMutableDictionary *classNameToSwizzledApplicationDidFinishLaunchingWithOptionsImpMap = [NSMutableDictionary dictionary];
-    
-    // Loop over all classes. Find the ones which implement the UIApplicationDelegate protocol and swizzle their application:didFinishLaunchingWithOptions: method
-    // so that we can add an HLSApplicationPreloader 
-    unsigned int numberOfClasses = 0;
-    Class *classes = objc_copyClassList(&numberOfClasses);
-    for (unsigned int i = 0; i < numberOfClasses; ++i) {
-        Class class = classes[i];
-        // TODO: Use hls_class_conformsToProtocol after merge with feature/url-connection
-        if (class_conformsToProtocol(class, @protocol(UIApplicationDelegate))) {
-            NSString *className = [NSString stringWithCString:class_getName(class) encoding:NSUTF8StringEncoding];
-            IMP UIApplicationDelegate__application_didFinishLaunchingWithOptions_Imp = HLSSwizzleSelector(class, 
-                                                                                                          @selector(application:didFinishLaunchingWithOptions:), 
-                                                                                                          (IMP)swizzled_UIApplicationDelegate__application_didFinishLaunchingWithOptions);
-            
-            // If not implemented (which might happen if the application is initialized using a nib only, i.e. if the root view controller is set in
-            // the application nib), inject a method
-            if (! UIApplicationDelegate__application_didFinishLaunchingWithOptions_Imp) {
-                class_addMethod(class, 
-                                @selector(application:didFinishLaunchingWithOptions:), 
-                                (IMP)swizzled_UIApplicationDelegate__application_didFinishLaunchingWithOptions, 
-                                "c@:@@");
-            }
-            [classNameToSwizzledApplicationDidFinishLaunchingWithOptionsImpMap setObject:[NSValue valueWithPointer:UIApplicationDelegate__application_didFinishLaunchingWithOptions_Imp]
-                                                                                  forKey:className];
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    
+    // UIApplicationDidFinishLaunchingNotification is posted right after the actual application delegate has returned from
+    // -application:didFinishLaunchingWithOptions:, which avoids having to look for all classes conforming to the 
+    // UIApplicationDelegate protocol to swizzle their implementation (an expensive operation in large binaries)
+    [[NSNotificationCenter defaultCenter] addObserver:self 
+                                             selector:@selector(applicationDidFinishLaunching:) 
+                                                 name:UIApplicationDidFinishLaunchingNotification 
+                                               object:nil];
+    
+    s_enabled = YES;
+    
+    HLSLaunchTraceRecord("+[HLSApplicationPreloader enable]", NULL, startTime);
+}
+
++ (void)registerPreloadingTask:(HLSTask *)task
+{
+    [self registerPreloadingTask:task dependencies:nil];
+}
+
++ (void)registerPreloadingTask:(HLSTask *)task dependencies:(NSArray *)dependencies
+{
+    HLSAssertObjectsInEnumerationAreKindOfClass(dependencies, HLSTask);
+    
+    if (! [NSThread isMainThread]) {
+        HLSLoggerError(@"Preloading tasks must be registered on the main thread");
+        return;
+    }
+    
+    if (! task) {
+        HLSLoggerError(@"Missing task");
+        return;
+    }
+    
+    if (s_preloadingStarted) {
+        HLSLoggerWarn(@"Preloading has already started. The task %@ will be ignored", task);
+        return;
+    }
+    
+    if (! s_preloadingTaskGroup) {
+        s_preloadingTaskGroup = [[HLSTaskGroup alloc] init];
+        s_preloadingTaskGroup.tag = kApplicationPreloaderTaskGroupTag;
+    }
+    
+    NSSet *registeredTasks = [s_preloadingTaskGroup tasks];
+    for (HLSTask *dependency in dependencies) {
+        if (! [registeredTasks containsObject:dependency]) {
+            HLSLoggerError(@"The dependency %@ has not been registered. The task %@ will be ignored", dependency, task);
+            return;
         }
     }
-    free(classes);
     
-    s_classNameToSwizzledApplicationDidFinishLaunchingWithOptionsImpMap = [[NSDictionary dictionaryWithDictionary:classNameToSwizzledApplicationDidFinishLaunchingWithOptionsImpMap] retain];
+    [s_preloadingTaskGroup addTask:task];
+    for (HLSTask *dependency in dependencies) {
+        [s_preloadingTaskGroup addDependencyForTask:task onTask:dependency strong:NO];
+    }
+}
+
+#pragma mark Notification callbacks
+
++ (void)applicationDidFinishLaunching:(NSNotification *)notification
+{
+    if (s_applicationPreloader) {
+        return;
+    }
     
-    s_enabled = YES;
+    s_applicationPreloader = [[HLSApplicationPreloader alloc] initWithApplication:[notification object]];
+    [s_applicationPreloader preload];
 }
 
 #pragma mark Object creation and destruction
@@ -113,6 +154,14 @@ static BOOL swizzled_UIApplicationDelegate__application_didFinishLaunchingWithOp
 #pragma mark Pre-loading
 
 - (void)preload
+{
+    // Wait until the current run loop iteration ends, i.e. until the first frame has been displayed, so that preloading
+    // does not delay application startup
+    [self performSelector:@selector(preloadWebView) withObject:nil afterDelay:0.];
+    [self performSelector:@selector(submitPreloadingTasks) withObject:nil afterDelay:0.];
+}
+
+- (void)preloadWebView
 {
     // To avoid the delay which occurs when loading a UIWebView for the first time, we display one as soon as possible
     // (out of screen bounds). It seems that loading a large web view (here with the application frame size) is more 
@@ -135,9 +184,31 @@ static BOOL swizzled_UIApplicationDelegate__application_didFinishLaunchingWithOp
         HLSLoggerWarn(@"No key window found. Cannot preload UIWebView. To fix this issue, your application delegate must "
                       "implement the -application:didFinishLaunchingWithOptions: method to set the key window, either by "
                       "calling -makeKeyAndVisible or -makeKeyWindow");
+        [webView release];
+        
+        [s_applicationPreloader autorelease];
+        s_applicationPreloader = nil;
     }    
 }
 
+- (void)submitPreloadingTasks
+{
+    s_preloadingStarted = YES;
+    
+    if (! s_preloadingTaskGroup) {
+        return;
+    }
+    
+    // Preloading must not compete with the work the application performs on its own
+    for (HLSTask *task in [s_preloadingTaskGroup tasks]) {
+        task.priority = HLSTaskPriorityVeryLow;
+    }
+    
+    [[HLSTaskManager defaultManager] submitTaskGroup:s_preloadingTaskGroup];
+    [s_preloadingTaskGroup release];
+    s_preloadingTaskGroup = nil;
+}
+
 #pragma mark UIWebViewDelegate protocol implementation
 
 - (void)webViewDidFinishLoad:(UIWebView *)webView
@@ -145,28 +216,13 @@ static BOOL swizzled_UIApplicationDelegate__application_didFinishLaunchingWithOp
     // The web view is not needed anymore
     [webView removeFromSuperview];
     [webView release];
-}
-
-@end
-
-#pragma mark Swizzled method implementations
-
-static BOOL swizzled_UIApplicationDelegate__application_didFinishLaunchingWithOptions(id self, SEL _cmd, UIApplication *application, NSDictionary *launchOptions)
-{
-    // Get the original implementation and call it (if any)
-    NSString *className = [NSString stringWithCString:class_getName(object_getClass(self)) encoding:NSUTF8StringEncoding];
-    BOOL (*UIApplicationDelegate__application_didFinishLaunchingWithOptions_Imp)(id, SEL, UIApplication *, NSDictionary *) = (BOOL (*)(id, SEL, id, id))[[s_classNameToSwizzledApplicationDidFinishLaunchingWithOptionsImpMap objectForKey:className] pointerValue];
-    
-    if (UIApplicationDelegate__application_didFinishLaunchingWithOptions_Imp) {
-        if (! (*UIApplicationDelegate__application_didFinishLaunchingWithOptions_Imp)(self, _cmd, application, launchOptions)) {
-            return NO;
-        }
-    }
     
-    // Install the preloader
-    HLSApplicationPreloader *applicationPreloader = [[[HLSApplicationPreloader alloc] initWithApplication:application] autorelease];
-    objc_setAssociatedObject(self, s_applicationPreloaderKey, applicationPreloader, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
-    [applicationPreloader preload];
+    // Web views are now cheaper to create. Have some ready for later use
+    [[HLSWebViewPool sharedWebViewPool] fill];
     
-    return YES;
+    // Preloading is over
+    [s_applicationPreloader autorelease];
+    s_applicationPreloader = nil;
 }
+
+@end
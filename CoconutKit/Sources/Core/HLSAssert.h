@@ -7,10 +7,32 @@
 //
 
 /**
- * The following macros are only active if NS_BLOCK_ASSERTIONS is disabled for the project configuration you use
- * (usually -DNS_BLOCK_ASSERTIONS=1)
+ * Assertion levels. Cheap assertions have a constant cost, expensive ones (collection type checks) scan whole
+ * collections. The level can be set for a project configuration using the HLS_ASSERT_LEVEL preprocessor macro 
+ * (e.g. -DHLS_ASSERT_LEVEL=1 to keep cheap assertions in beta builds without paying for collection scans). When 
+ * not set, all assertions are enabled, except if NS_BLOCK_ASSERTIONS is defined (usually -DNS_BLOCK_ASSERTIONS=1)
+ * in which case they are all disabled. Since the macros below are based on NSAssert, no assertion is ever active
+ * when NS_BLOCK_ASSERTIONS is defined, whatever the level. 
+ *
+ * Remark: The level applies to the code being compiled. To disable the collection scans made by CoconutKit itself,
+ *         HLS_ASSERT_LEVEL must be set when compiling CoconutKit as well
+ */
+#define HLSAssertLevelOff                       0
+#define HLSAssertLevelCheap                     1
+#define HLSAssertLevelExpensive                 2
+
+#ifndef HLS_ASSERT_LEVEL
+    #ifdef NS_BLOCK_ASSERTIONS
+        #define HLS_ASSERT_LEVEL                HLSAssertLevelOff
+    #else
+        #define HLS_ASSERT_LEVEL                HLSAssertLevelExpensive
+    #endif
+#endif
+
+/**
+ * The following macros are only active if the assertion level is at least HLSAssertLevelCheap
  */
-#ifndef NS_BLOCK_ASSERTIONS
+#if ! defined(NS_BLOCK_ASSERTIONS) && HLS_ASSERT_LEVEL >= HLSAssertLevelCheap
 
 /**
  * Assertion at compile time
@@ -37,10 +59,25 @@
  */
 #define HLSMissingMethodImplementation()         NSAssert(NO, @"Missing method implementation")
 
+#else
+
+#define HLSStaticAssert(expr)
+
+#define HLSForbiddenInheritedMethod()
+#define HLSMissingMethodImplementation()
+
+#endif
+
+/**
+ * The following macros are only active if the assertion level is HLSAssertLevelExpensive
+ */
+#if ! defined(NS_BLOCK_ASSERTIONS) && HLS_ASSERT_LEVEL >= HLSAssertLevelExpensive
+
 /**
- * The following macros check the type of objects in a collection. Useful for a class to verify that a collection it 
- * receives from a client through its public interface contains objects of the expected type. HLSAssert... macros can 
- * be used in methods only. In C-functions use the HLSCAssert... macros instead.
+ * The following macros check the type of objects in a collection, and therefore iterate over all of its elements. 
+ * Useful for a class to verify that a collection it receives from a client through its public interface contains 
+ * objects of the expected type. HLSAssert... macros can be used in methods only. In C-functions use the HLSCAssert... 
+ * macros instead.
  *
  * Example: HLSAssertObjectsInEnumerationAreKindOfClass(views, UIScrollView);
  */
@@ -80,11 +117,6 @@
 
 #else
 
-#define HLSStaticAssert(expr)
-
-#define HLSForbiddenInheritedMethod()
-#define HLSMissingMethodImplementation()
-
 #define HLSAssertObjectsInEnumerationAreKindOfClass(enumeration, objectClass)
 #define HLSCAssertObjectsInEnumerationAreKindOfClass(enumeration, objectClass)
 
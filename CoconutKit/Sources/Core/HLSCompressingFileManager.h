@@ -0,0 +1,39 @@
+//
+//  HLSCompressingFileManager.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSLayeredFileManager.h"
+
+/**
+ * A file manager layer compressing file contents (using zlib) before they are handed over to the underlying file 
+ * manager, and decompressing them when they are read. Files are stored in the gzip format. Appending data to a file 
+ * adds a new gzip member to it, so that existing contents never need to be decompressed and compressed again. 
+ *
+ * Files are decompressed in chunks while they are read from the underlying manager (using its input streams), which
+ * means that range reads only decompress the data up to the end of the range and never need to load the whole 
+ * compressed file at once. Since compressed data cannot be accessed randomly, reading the end of a large file is 
+ * still slower than reading its beginning, though.
+ *
+ * When stacking with an HLSEncryptingFileManager, the compressing layer must be the outermost one (encrypted data 
+ * cannot be compressed).
+ *
+ * Your project must be linked against libz.dylib
+ *
+ * Designated initializer: -initWithFileManager:
+ */
+@interface HLSCompressingFileManager : HLSLayeredFileManager {
+@private
+    NSInteger _compressionLevel;
+}
+
+/**
+ * The compression level, from 1 (fastest) to 9 (best compression). Default value is 6, which is usually a good 
+ * compromise
+ */
+@property (nonatomic, assign) NSInteger compressionLevel;
+
+@end
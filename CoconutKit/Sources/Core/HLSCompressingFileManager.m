@@ -0,0 +1,263 @@
+//
+//  HLSCompressingFileManager.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSCompressingFileManager.h"
+
+#import "HLSLogger.h"
+
+#import <zlib.h>
+
+// Size of the buffers used when compressing or decompressing data
+static const NSUInteger kCompressionBufferLength = 64 * 1024;
+
+// Add 16 to the window size to read and write gzip headers and trailers
+static const int kGzipWindowBits = MAX_WBITS + 16;
+
+@interface HLSCompressingFileManager ()
+
+- (NSData *)compressedDataWithData:(NSData *)data;
+- (NSData *)decompressedContentsOfFileAtPath:(NSString *)path range:(NSRange)range error:(NSError **)pError;
+
+@end
+
+// Function declarations
+static NSError *corruptFileErrorForPath(NSString *path);
+
+@implementation HLSCompressingFileManager
+
+#pragma mark Object creation and destruction
+
+- (id)initWithFileManager:(HLSFileManager *)fileManager
+{
+    if ((self = [super initWithFileManager:fileManager])) {
+        _compressionLevel = 6;
+    }
+    return self;
+}
+
+#pragma mark Accessors and mutators
+
+@synthesize compressionLevel = _compressionLevel;
+
+- (void)setCompressionLevel:(NSInteger)compressionLevel
+{
+    if (compressionLevel < 1 || compressionLevel > 9) {
+        HLSLoggerError(@"The compression level must be between 1 and 9");
+        return;
+    }
+    
+    _compressionLevel = compressionLevel;
+}
+
+#pragma mark HLSFileManagerAbstract protocol implementation
+
+- (NSData *)contentsOfFileAtPath:(NSString *)path error:(NSError **)pError
+{
+    return [self decompressedContentsOfFileAtPath:path range:NSMakeRange(0, NSUIntegerMax) error:pError];
+}
+
+- (NSData *)contentsOfFileAtPath:(NSString *)path range:(NSRange)range error:(NSError **)pError
+{
+    return [self decompressedContentsOfFileAtPath:path range:range error:pError];
+}
+
+- (BOOL)createFileAtPath:(NSString *)path contents:(NSData *)contents error:(NSError **)pError
+{
+    NSData *compressedContents = [self compressedDataWithData:contents];
+    if (! compressedContents) {
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSCocoaErrorDomain 
+                                          code:NSFileWriteUnknownError
+                                      userInfo:[NSDictionary dictionaryWithObject:path forKey:NSFilePathErrorKey]];
+        }
+        return NO;
+    }
+    
+    return [self.fileManager createFileAtPath:path contents:compressedContents error:pError];
+}
+
+- (BOOL)appendContents:(NSData *)contents toFileAtPath:(NSString *)path error:(NSError **)pError
+{
+    // Concatenated gzip members form a valid gzip file
+    NSData *compressedContents = [self compressedDataWithData:contents];
+    if (! compressedContents) {
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSCocoaErrorDomain
+                                          code:NSFileWriteUnknownError
+                                      userInfo:[NSDictionary dictionaryWithObject:path forKey:NSFilePathErrorKey]];
+        }
+        return NO;
+    }
+    
+    return [self.fileManager appendContents:compressedContents toFileAtPath:path error:pError];
+}
+
+#pragma mark Compression
+
+- (NSData *)compressedDataWithData:(NSData *)data
+{
+    z_stream stream;
+    memset(&stream, 0, sizeof(z_stream));
+    if (deflateInit2(&stream, self.compressionLevel, Z_DEFLATED, kGzipWindowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        HLSLoggerError(@"Could not initialize the compression stream");
+        return nil;
+    }
+    
+    NSMutableData *compressedData = [NSMutableData dataWithCapacity:[data length] / 2 + 64];
+    uint8_t *buffer = malloc(kCompressionBufferLength);
+    const uint8_t *bytes = [data bytes];
+    NSUInteger remainingLength = [data length];
+    int status = Z_OK;
+    do {
+        // Lengths are 32-bit for zlib
+        if (stream.avail_in == 0) {
+            uInt inputLength = (uInt)MIN(remainingLength, (NSUInteger)UINT32_MAX);
+            stream.next_in = (Bytef *)bytes;
+            stream.avail_in = inputLength;
+            bytes += inputLength;
+            remainingLength -= inputLength;
+        }
+        
+        stream.next_out = buffer;
+        stream.avail_out = kCompressionBufferLength;
+        status = deflate(&stream, (remainingLength == 0) ? Z_FINISH : Z_NO_FLUSH);
+        if (status == Z_STREAM_ERROR) {
+            break;
+        }
+        [compressedData appendBytes:buffer length:kCompressionBufferLength - stream.avail_out];
+    } while (status != Z_STREAM_END);
+    deflateEnd(&stream);
+    free(buffer);
+    
+    if (status != Z_STREAM_END) {
+        HLSLoggerError(@"Compression failed");
+        return nil;
+    }
+    
+    return compressedData;
+}
+
+- (NSData *)decompressedContentsOfFileAtPath:(NSString *)path range:(NSRange)range error:(NSError **)pError
+{
+    NSInputStream *inputStream = [self.fileManager inputStreamForFileAtPath:path];
+    if (! inputStream) {
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSCocoaErrorDomain
+                                          code:NSFileReadNoSuchFileError
+                                      userInfo:[NSDictionary dictionaryWithObject:path forKey:NSFilePathErrorKey]];
+        }
+        return nil;
+    }
+    
+    z_stream stream;
+    memset(&stream, 0, sizeof(z_stream));
+    if (inflateInit2(&stream, kGzipWindowBits) != Z_OK) {
+        HLSLoggerError(@"Could not initialize the decompression stream");
+        if (pError) {
+            *pError = corruptFileErrorForPath(path);
+        }
+        return nil;
+    }
+    
+    [inputStream open];
+    
+    // The range end is clamped to avoid overflows when the range extends to the end of the file
+    NSUInteger rangeEnd = range.location + MIN(range.length, NSUIntegerMax - range.location);
+    NSMutableData *contents = [NSMutableData data];
+    NSUInteger offset = 0;
+    uint8_t *inputBuffer = malloc(kCompressionBufferLength);
+    uint8_t *outputBuffer = malloc(kCompressionBufferLength);
+    NSError *streamError = nil;
+    BOOL succeeded = YES;
+    BOOL inputFinished = NO;
+    BOOL memberFinished = YES;
+    while (offset < rangeEnd) {
+        if (stream.avail_in == 0) {
+            if (inputFinished) {
+                // Fails if the last gzip member is incomplete
+                succeeded = memberFinished;
+                break;
+            }
+            
+            NSInteger readLength = [inputStream read:inputBuffer maxLength:kCompressionBufferLength];
+            if (readLength < 0) {
+                streamError = [inputStream streamError];
+                succeeded = NO;
+                break;
+            }
+            else if (readLength == 0) {
+                inputFinished = YES;
+                continue;
+            }
+            
+            stream.next_in = inputBuffer;
+            stream.avail_in = (uInt)readLength;
+        }
+        
+        // Another member follows
+        if (memberFinished) {
+            inflateReset(&stream);
+            memberFinished = NO;
+        }
+        
+        stream.next_out = outputBuffer;
+        stream.avail_out = kCompressionBufferLength;
+        int status = inflate(&stream, Z_NO_FLUSH);
+        if (status != Z_OK && status != Z_STREAM_END && status != Z_BUF_ERROR) {
+            succeeded = NO;
+            break;
+        }
+        memberFinished = (status == Z_STREAM_END);
+        
+        // Only keep the part of the output overlapping with the requested range
+        NSUInteger outputLength = kCompressionBufferLength - stream.avail_out;
+        NSUInteger outputEnd = offset + outputLength;
+        if (outputEnd > range.location) {
+            NSUInteger start = MAX(offset, range.location);
+            NSUInteger end = MIN(outputEnd, rangeEnd);
+            [contents appendBytes:outputBuffer + (start - offset) length:end - start];
+        }
+        offset = outputEnd;
+    }
+    
+    [inputStream close];
+    inflateEnd(&stream);
+    free(inputBuffer);
+    free(outputBuffer);
+    
+    if (! succeeded) {
+        if (pError) {
+            *pError = streamError ? streamError : corruptFileErrorForPath(path);
+        }
+        return nil;
+    }
+    
+    return contents;
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; compressionLevel: %d; fileManager: %@>",
+            [self class],
+            self,
+            self.compressionLevel,
+            self.fileManager];
+}
+
+@end
+
+#pragma mark Static functions
+
+static NSError *corruptFileErrorForPath(NSString *path)
+{
+    return [NSError errorWithDomain:NSCocoaErrorDomain 
+                               code:NSFileReadCorruptFileError
+                           userInfo:[NSDictionary dictionaryWithObject:path forKey:NSFilePathErrorKey]];
+}
@@ -14,6 +14,11 @@ NSString *HLSStringFromInterfaceOrientation(UIInterfaceOrientation interfaceOrie
 NSString *HLSStringFromDeviceOrientation(UIDeviceOrientation deviceOrientation);
 NSString *HLSStringFromCATransform3D(CATransform3D transform);
 
+/**
+ * Lowercase hexadecimal representation of a byte buffer (two characters per byte)
+ */
+NSString *HLSHexStringFromBytes(const void *bytes, NSUInteger length);
+
 /**
  * Conversions to numbers
  */
@@ -29,8 +34,21 @@ NSNumber *HLSUnsignedIntNumberFromString(NSString *string);
     
 }
 
+/**
+ * Parse a date using the specified format. For the fixed ISO 8601 / RFC 3339 formats yyyy-MM-dd'T'HH:mm:ssZ and
+ * yyyy-MM-dd'T'HH:mm:ssZZZZZ, a fast parser is used (see +dateFromISO8601String:) for strings having exactly the shape
+ * of the format (+HHMM offset for Z, +HH:MM offset or Z for ZZZZZ). Other strings and formats are parsed using a date 
+ * formatter
+ */
 + (NSDate *)dateFromString:(NSString *)string usingFormatString:(NSString *)formatString;
 
+/**
+ * Parse an ISO 8601 / RFC 3339 date of the form yyyy-MM-ddTHH:mm:ss[.SSS...](Z|+HH:MM|+HHMM) (the separator T can be 
+ * replaced by a space, -HH:MM and -HHMM offsets are supported as well). The string is scanned directly, without going 
+ * through a date formatter, which is much faster. Return nil if the string does not match this format
+ */
++ (NSDate *)dateFromISO8601String:(NSString *)string;
+
 + (void)convertStringValueForKey:(NSString *)sourceKey 
                     ofDictionary:(NSDictionary *)sourceDictionary
            intoStringValueForKey:(NSString *)destKey 
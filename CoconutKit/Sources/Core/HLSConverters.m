@@ -10,6 +10,29 @@
 
 #import "HLSAssert.h"
 #import "HLSLogger.h"
+#import "NSDateFormatter+HLSExtensions.h"
+
+#import <libkern/OSAtomic.h>
+
+static NSString * const HLSConvertersNumberFormatterThreadLocalStorageKey = @"HLSConvertersNumberFormatterThreadLocalStorageKey";
+static NSString * const HLSConvertersNumberFormatterGenerationThreadLocalStorageKey = @"HLSConvertersNumberFormatterGenerationThreadLocalStorageKey";
+
+// Incremented each time the current locale changes, so that cached number formatters get discarded
+static volatile int32_t s_numberFormatterGeneration = 0;
+
+// Function declarations
+static NSNumberFormatter *decimalNumberFormatterForCurrentThread(void);
+static BOOL hasFixedDateFormatShape(NSString *string, NSString *formatString);
+static BOOL scanDigits(const unichar *characters, NSUInteger length, NSUInteger *pIndex, NSUInteger numberOfDigits, NSInteger *pValue);
+static BOOL scanCharacter(const unichar *characters, NSUInteger length, NSUInteger *pIndex, unichar character);
+static NSInteger daysFromCivilDate(NSInteger year, NSInteger month, NSInteger day);
+static NSInteger numberOfDaysInMonth(NSInteger year, NSInteger month);
+
+@interface HLSConverters ()
+
++ (void)currentLocaleDidChange:(NSNotification *)notification;
+
+@end
 
 NSString *HLSStringFromBool(BOOL yesOrNo)
 {
@@ -92,31 +115,152 @@ NSString *HLSStringFromCATransform3D(CATransform3D transform)
             transform.m41, transform.m42, transform.m43, transform.m44];
 }
 
+NSString *HLSHexStringFromBytes(const void *bytes, NSUInteger length)
+{
+    static const char kHexDigits[] = "0123456789abcdef";
+    
+    // Small buffers (e.g. digests) are converted on the stack
+    char stackBuffer[256];
+    char *buffer = (2 * length <= sizeof(stackBuffer)) ? stackBuffer : (char *)malloc(2 * length);
+    
+    const unsigned char *currentByte = (const unsigned char *)bytes;
+    for (NSUInteger i = 0; i < length; ++i) {
+        buffer[2 * i] = kHexDigits[currentByte[i] >> 4];
+        buffer[2 * i + 1] = kHexDigits[currentByte[i] & 0x0f];
+    }
+    
+    NSString *hexString = [[[NSString alloc] initWithBytes:buffer length:2 * length encoding:NSASCIIStringEncoding] autorelease];
+    if (buffer != stackBuffer) {
+        free(buffer);
+    }
+    return hexString;
+}
+
 NSNumber *HLSUnsignedIntNumberFromString(NSString *string)
 {
     if (! string) {
         return nil;
     }
     
-    NSNumberFormatter *formatter = [[[NSNumberFormatter alloc] init] autorelease];
-    [formatter setNumberStyle:NSNumberFormatterDecimalStyle];
-    return [formatter numberFromString:string];
+    return [decimalNumberFormatterForCurrentThread() numberFromString:string];
 }
 
 @implementation HLSConverters
 
 #pragma mark Class methods
 
++ (void)load
+{
+    [[NSNotificationCenter defaultCenter] addObserver:self
+                                             selector:@selector(currentLocaleDidChange:)
+                                                 name:NSCurrentLocaleDidChangeNotification
+                                               object:nil];
+}
+
 + (NSDate *)dateFromString:(NSString *)string usingFormatString:(NSString *)formatString
 {
     if (! string) {
         return nil;
     }
     
-    NSDateFormatter *formatter = [[[NSDateFormatter alloc] init] autorelease];
-    [formatter setFormatterBehavior:NSDateFormatterBehavior10_4];
-    [formatter setDateFormat:formatString];
-    return [formatter dateFromString:string];
+    // Fast path for fixed machine formats. If the string does not match, let the formatter decide
+    if (([formatString isEqualToString:@"yyyy-MM-dd'T'HH:mm:ssZ"] || [formatString isEqualToString:@"yyyy-MM-dd'T'HH:mm:ssZZZZZ"])
+            && hasFixedDateFormatShape(string, formatString)) {
+        NSDate *date = [self dateFromISO8601String:string];
+        if (date) {
+            return date;
+        }
+    }
+    
+    return [[NSDateFormatter cachedDateFormatterWithFormat:formatString] dateFromString:string];
+}
+
++ (NSDate *)dateFromISO8601String:(NSString *)string
+{
+    // Longest supported string: yyyy-MM-ddTHH:mm:ss.SSSSSSSSS+HH:MM
+    static const NSUInteger kMaxLength = 64;
+    
+    NSUInteger length = [string length];
+    if (length < 20 || length > kMaxLength) {
+        return nil;
+    }
+    
+    unichar characters[kMaxLength];
+    [string getCharacters:characters range:NSMakeRange(0, length)];
+    
+    NSUInteger index = 0;
+    NSInteger year = 0, month = 0, day = 0, hour = 0, minute = 0, second = 0;
+    if (! scanDigits(characters, length, &index, 4, &year)
+            || ! scanCharacter(characters, length, &index, '-')
+            || ! scanDigits(characters, length, &index, 2, &month)
+            || ! scanCharacter(characters, length, &index, '-')
+            || ! scanDigits(characters, length, &index, 2, &day)
+            || ! (scanCharacter(characters, length, &index, 'T') || scanCharacter(characters, length, &index, ' '))
+            || ! scanDigits(characters, length, &index, 2, &hour)
+            || ! scanCharacter(characters, length, &index, ':')
+            || ! scanDigits(characters, length, &index, 2, &minute)
+            || ! scanCharacter(characters, length, &index, ':')
+            || ! scanDigits(characters, length, &index, 2, &second)) {
+        return nil;
+    }
+    
+    // Leap seconds are not supported
+    if (month < 1 || month > 12 || day < 1 || day > numberOfDaysInMonth(year, month)
+            || hour > 23 || minute > 59 || second > 59) {
+        return nil;
+    }
+    
+    // Optional fractional part
+    double fraction = 0.;
+    if (scanCharacter(characters, length, &index, '.')) {
+        double scale = 0.1;
+        NSUInteger firstFractionIndex = index;
+        while (index < length && characters[index] >= '0' && characters[index] <= '9') {
+            fraction += (characters[index] - '0') * scale;
+            scale /= 10.;
+            ++index;
+        }
+        if (index == firstFractionIndex) {
+            return nil;
+        }
+    }
+    
+    // Time zone
+    NSInteger offsetInSeconds = 0;
+    if (! scanCharacter(characters, length, &index, 'Z')) {
+        NSInteger sign = 0;
+        if (scanCharacter(characters, length, &index, '+')) {
+            sign = 1;
+        }
+        else if (scanCharacter(characters, length, &index, '-')) {
+            sign = -1;
+        }
+        else {
+            return nil;
+        }
+        
+        NSInteger offsetHours = 0, offsetMinutes = 0;
+        if (! scanDigits(characters, length, &index, 2, &offsetHours)) {
+            return nil;
+        }
+        scanCharacter(characters, length, &index, ':');
+        if (! scanDigits(characters, length, &index, 2, &offsetMinutes)) {
+            return nil;
+        }
+        if (offsetHours > 23 || offsetMinutes > 59) {
+            return nil;
+        }
+        offsetInSeconds = sign * (offsetHours * 3600 + offsetMinutes * 60);
+    }
+    
+    // Trailing garbage
+    if (index != length) {
+        return nil;
+    }
+    
+    NSTimeInterval timeIntervalSince1970 = daysFromCivilDate(year, month, day) * 86400. + hour * 3600. + minute * 60. + second
+        + fraction - offsetInSeconds;
+    return [NSDate dateWithTimeIntervalSince1970:timeIntervalSince1970];
 }
 
 + (void)convertStringValueForKey:(NSString *)sourceKey 
@@ -167,4 +311,101 @@ NSNumber *HLSUnsignedIntNumberFromString(NSString *string)
     return nil;
 }
 
+#pragma mark Notification callbacks
+
++ (void)currentLocaleDidChange:(NSNotification *)notification
+{
+    OSAtomicIncrement32Barrier(&s_numberFormatterGeneration);
+}
+
 @end
+
+#pragma mark Static functions
+
+// Number formatters are expensive to create and not thread-safe. Keep one per thread
+static NSNumberFormatter *decimalNumberFormatterForCurrentThread(void)
+{
+    NSMutableDictionary *threadDictionary = [[NSThread currentThread] threadDictionary];
+    NSNumber *generationNumber = [NSNumber numberWithInt:OSAtomicAdd32Barrier(0, &s_numberFormatterGeneration)];
+    
+    NSNumberFormatter *numberFormatter = [threadDictionary objectForKey:HLSConvertersNumberFormatterThreadLocalStorageKey];
+    if (! numberFormatter || ! [[threadDictionary objectForKey:HLSConvertersNumberFormatterGenerationThreadLocalStorageKey] isEqualToNumber:generationNumber]) {
+        numberFormatter = [[[NSNumberFormatter alloc] init] autorelease];
+        [numberFormatter setNumberStyle:NSNumberFormatterDecimalStyle];
+        [threadDictionary setObject:numberFormatter forKey:HLSConvertersNumberFormatterThreadLocalStorageKey];
+        [threadDictionary setObject:generationNumber forKey:HLSConvertersNumberFormatterGenerationThreadLocalStorageKey];
+    }
+    return numberFormatter;
+}
+
+// The fast parser accepts more variants than a formatter (space separator, fractional seconds, all kinds of offsets).
+// Only use it for strings having exactly the shape of the format, fields are then checked by the parser
+static BOOL hasFixedDateFormatShape(NSString *string, NSString *formatString)
+{
+    NSUInteger length = [string length];
+    if (length < 20 || [string characterAtIndex:10] != 'T') {
+        return NO;
+    }
+    
+    unichar zoneCharacter = [string characterAtIndex:19];
+    BOOL hasOffset = (zoneCharacter == '+' || zoneCharacter == '-');
+    
+    // yyyy-MM-dd'T'HH:mm:ssZ, e.g. 2012-02-29T13:30:15+0100
+    if ([formatString isEqualToString:@"yyyy-MM-dd'T'HH:mm:ssZ"]) {
+        return length == 24 && hasOffset;
+    }
+    // yyyy-MM-dd'T'HH:mm:ssZZZZZ, e.g. 2012-02-29T13:30:15+01:00 or 2012-02-29T12:30:15Z
+    else {
+        return (length == 25 && hasOffset && [string characterAtIndex:22] == ':') || (length == 20 && zoneCharacter == 'Z');
+    }
+}
+
+static BOOL scanDigits(const unichar *characters, NSUInteger length, NSUInteger *pIndex, NSUInteger numberOfDigits, NSInteger *pValue)
+{
+    if (*pIndex + numberOfDigits > length) {
+        return NO;
+    }
+    
+    NSInteger value = 0;
+    for (NSUInteger i = *pIndex; i < *pIndex + numberOfDigits; ++i) {
+        unichar character = characters[i];
+        if (character < '0' || character > '9') {
+            return NO;
+        }
+        value = value * 10 + (character - '0');
+    }
+    
+    *pIndex += numberOfDigits;
+    *pValue = value;
+    return YES;
+}
+
+static BOOL scanCharacter(const unichar *characters, NSUInteger length, NSUInteger *pIndex, unichar character)
+{
+    if (*pIndex >= length || characters[*pIndex] != character) {
+        return NO;
+    }
+    
+    ++*pIndex;
+    return YES;
+}
+
+// Number of days since 1970-01-01 in the proleptic Gregorian calendar (see http://howardhinnant.github.io/date_algorithms.html)
+static NSInteger daysFromCivilDate(NSInteger year, NSInteger month, NSInteger day)
+{
+    year -= (month <= 2) ? 1 : 0;
+    NSInteger era = (year >= 0 ? year : year - 399) / 400;
+    NSInteger yearOfEra = year - era * 400;                                                             // [0, 399]
+    NSInteger dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;                      // [0, 365]
+    NSInteger dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;                 // [0, 146096]
+    return era * 146097 + dayOfEra - 719468;
+}
+
+static NSInteger numberOfDaysInMonth(NSInteger year, NSInteger month)
+{
+    static const NSInteger kNumberOfDaysInMonth[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    if (month == 2 && (year % 4 == 0 && (year % 100 != 0 || year % 400 == 0))) {
+        return 29;
+    }
+    return kNumberOfDaysInMonth[month - 1];
+}
@@ -0,0 +1,65 @@
+//
+//  HLSDictionaryMapping.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+/**
+ * Types into which string values can be converted by a dictionary mapping
+ */
+typedef enum {
+    HLSDictionaryMappingTypeEnumBegin = 0,
+    HLSDictionaryMappingTypeString = HLSDictionaryMappingTypeEnumBegin,     // Copied as is
+    HLSDictionaryMappingTypeUnsignedInt,                                    // See HLSUnsignedIntNumberFromString
+    HLSDictionaryMappingTypeDate,                                           // See +[HLSConverters dateFromString:usingFormatString:]
+    HLSDictionaryMappingTypeEnumEnd,
+    HLSDictionaryMappingTypeEnumSize = HLSDictionaryMappingTypeEnumEnd - HLSDictionaryMappingTypeEnumBegin
+} HLSDictionaryMappingType;
+
+/**
+ * A dictionary mapping describes how the string values of a dictionary (e.g. a record received from a web service) must
+ * be converted into the values of another dictionary (e.g. to be fed into a model object using -setValuesForKeysWithDictionary:).
+ * This is the same as calling the -convertStringValueForKey:ofDictionary:... methods of HLSConverters once for each key,
+ * but much faster when many dictionaries must be converted: Rules are compiled once, formatters are looked up once
+ * for a whole batch of dictionaries, and work can be spread over all available cores.
+ *
+ * Rules must all be added before the first conversion. Conversions can then be made from any thread.
+ *
+ * Designated initializer: -init
+ */
+@interface HLSDictionaryMapping : NSObject {
+@private
+    struct HLSDictionaryMappingRule *_rules;
+    NSUInteger _numberOfRules;
+    BOOL _frozen;
+}
+
+/**
+ * Add a rule converting the string value for sourceKey in the source dictionary into a value of the given type for
+ * destKey in the destination dictionary. Missing values and values which are not strings or cannot be converted are
+ * omitted from the destination dictionary. For dates, a format string must be provided (it is ignored for other types)
+ */
+- (void)addRuleForSourceKey:(NSString *)sourceKey destKey:(NSString *)destKey type:(HLSDictionaryMappingType)type formatString:(NSString *)formatString;
+
+/**
+ * Convenience methods for adding rules
+ */
+- (void)addStringRuleForSourceKey:(NSString *)sourceKey destKey:(NSString *)destKey;
+- (void)addUnsignedIntRuleForSourceKey:(NSString *)sourceKey destKey:(NSString *)destKey;
+- (void)addDateRuleForSourceKey:(NSString *)sourceKey destKey:(NSString *)destKey formatString:(NSString *)formatString;
+
+/**
+ * Convert a single dictionary
+ */
+- (NSDictionary *)dictionaryFromDictionary:(NSDictionary *)dictionary;
+
+/**
+ * Convert an array of dictionaries in one pass, returning the converted dictionaries in the same order. If concurrently 
+ * is set to YES, the work is spread over all available cores (only worth it for large arrays). Objects which are not
+ * dictionaries are converted into empty dictionaries
+ */
+- (NSArray *)dictionariesFromDictionaries:(NSArray *)dictionaries concurrently:(BOOL)concurrently;
+
+@end
@@ -0,0 +1,260 @@
+//
+//  HLSDictionaryMapping.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSDictionaryMapping.h"
+
+#import "HLSConverters.h"
+#import "HLSLogger.h"
+#import "NSDateFormatter+HLSExtensions.h"
+
+// Number of dictionaries converted by each batch conversion work item
+static const size_t kDictionaryBatchStride = 256;
+
+// Compiled rule
+struct HLSDictionaryMappingRule {
+    NSString *sourceKey;
+    NSString *destKey;
+    HLSDictionaryMappingType type;
+    NSString *formatString;
+    BOOL usingISO8601Parser;                    // Dates only: Fixed format for which the fast parser can be used
+};
+
+typedef struct {
+    HLSDictionaryMapping *mapping;
+    NSArray *dictionaries;
+    id *results;
+} HLSDictionaryBatch;
+
+// Function declarations
+static void convertDictionaryBatch(void *context, size_t index);
+
+@interface HLSDictionaryMapping ()
+
+- (NSDictionary *)dictionaryFromDictionary:(NSDictionary *)dictionary usingDateFormatters:(NSDateFormatter **)dateFormatters;
+- (void)fillDateFormatters:(NSDateFormatter **)dateFormatters;
+- (void)convertDictionaries:(NSArray *)dictionaries inRange:(NSRange)range intoResults:(id *)results;
+
+@end
+
+@implementation HLSDictionaryMapping
+
+#pragma mark Object creation and destruction
+
+- (void)dealloc
+{
+    for (NSUInteger i = 0; i < _numberOfRules; ++i) {
+        [_rules[i].sourceKey release];
+        [_rules[i].destKey release];
+        [_rules[i].formatString release];
+    }
+    free(_rules);
+    _rules = NULL;
+    
+    [super dealloc];
+}
+
+#pragma mark Adding rules
+
+- (void)addRuleForSourceKey:(NSString *)sourceKey destKey:(NSString *)destKey type:(HLSDictionaryMappingType)type formatString:(NSString *)formatString
+{
+    if (_frozen) {
+        HLSLoggerError(@"Rules cannot be added once conversions have been made");
+        return;
+    }
+    
+    if (! sourceKey || ! destKey) {
+        HLSLoggerError(@"Missing source or destination key");
+        return;
+    }
+    
+    if (type == HLSDictionaryMappingTypeDate && ! formatString) {
+        HLSLoggerError(@"A format string is required for dates");
+        return;
+    }
+    
+    _rules = (struct HLSDictionaryMappingRule *)realloc(_rules, (_numberOfRules + 1) * sizeof(struct HLSDictionaryMappingRule));
+    struct HLSDictionaryMappingRule *rule = &_rules[_numberOfRules];
+    rule->sourceKey = [sourceKey copy];
+    rule->destKey = [destKey copy];
+    rule->type = type;
+    rule->formatString = (type == HLSDictionaryMappingTypeDate) ? [formatString copy] : nil;
+    rule->usingISO8601Parser = (type == HLSDictionaryMappingTypeDate) 
+        && ([formatString isEqualToString:@"yyyy-MM-dd'T'HH:mm:ssZ"] || [formatString isEqualToString:@"yyyy-MM-dd'T'HH:mm:ssZZZZZ"]);
+    ++_numberOfRules;
+}
+
+- (void)addStringRuleForSourceKey:(NSString *)sourceKey destKey:(NSString *)destKey
+{
+    [self addRuleForSourceKey:sourceKey destKey:destKey type:HLSDictionaryMappingTypeString formatString:nil];
+}
+
+- (void)addUnsignedIntRuleForSourceKey:(NSString *)sourceKey destKey:(NSString *)destKey
+{
+    [self addRuleForSourceKey:sourceKey destKey:destKey type:HLSDictionaryMappingTypeUnsignedInt formatString:nil];
+}
+
+- (void)addDateRuleForSourceKey:(NSString *)sourceKey destKey:(NSString *)destKey formatString:(NSString *)formatString
+{
+    [self addRuleForSourceKey:sourceKey destKey:destKey type:HLSDictionaryMappingTypeDate formatString:formatString];
+}
+
+#pragma mark Conversion
+
+- (NSDictionary *)dictionaryFromDictionary:(NSDictionary *)dictionary
+{
+    _frozen = YES;
+    
+    NSDateFormatter **dateFormatters = (NSDateFormatter **)calloc(MAX(_numberOfRules, 1), sizeof(NSDateFormatter *));
+    [self fillDateFormatters:dateFormatters];
+    NSDictionary *convertedDictionary = [self dictionaryFromDictionary:dictionary usingDateFormatters:dateFormatters];
+    free(dateFormatters);
+    
+    return convertedDictionary;
+}
+
+- (NSArray *)dictionariesFromDictionaries:(NSArray *)dictionaries concurrently:(BOOL)concurrently
+{
+    _frozen = YES;
+    
+    NSUInteger count = [dictionaries count];
+    if (count == 0) {
+        return [NSArray array];
+    }
+    
+    // Each work item writes to its own slice of the result array, no synchronization is therefore needed. Results
+    // are retained by the work items
+    id *results = (id *)calloc(count, sizeof(id));
+    
+    HLSDictionaryBatch batch;
+    batch.mapping = self;
+    batch.dictionaries = dictionaries;
+    batch.results = results;
+    
+    size_t numberOfWorkItems = (count + kDictionaryBatchStride - 1) / kDictionaryBatchStride;
+    if (concurrently) {
+        dispatch_apply_f(numberOfWorkItems, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), &batch, convertDictionaryBatch);
+    }
+    else {
+        for (size_t i = 0; i < numberOfWorkItems; ++i) {
+            convertDictionaryBatch(&batch, i);
+        }
+    }
+    
+    NSArray *convertedDictionaries = [NSArray arrayWithObjects:results count:count];
+    for (NSUInteger i = 0; i < count; ++i) {
+        [results[i] release];
+    }
+    free(results);
+    
+    return convertedDictionaries;
+}
+
+- (NSDictionary *)dictionaryFromDictionary:(NSDictionary *)dictionary usingDateFormatters:(NSDateFormatter **)dateFormatters
+{
+    if (! [dictionary isKindOfClass:[NSDictionary class]]) {
+        return [NSDictionary dictionary];
+    }
+    
+    NSMutableDictionary *convertedDictionary = [NSMutableDictionary dictionaryWithCapacity:_numberOfRules];
+    for (NSUInteger i = 0; i < _numberOfRules; ++i) {
+        struct HLSDictionaryMappingRule *rule = &_rules[i];
+        
+        NSString *stringValue = [dictionary objectForKey:rule->sourceKey];
+        if (! [stringValue isKindOfClass:[NSString class]]) {
+            continue;
+        }
+        
+        id value = nil;
+        switch (rule->type) {
+            case HLSDictionaryMappingTypeString: {
+                value = stringValue;
+                break;
+            }
+                
+            case HLSDictionaryMappingTypeUnsignedInt: {
+                value = HLSUnsignedIntNumberFromString(stringValue);
+                break;
+            }
+                
+            case HLSDictionaryMappingTypeDate: {
+                if (rule->usingISO8601Parser) {
+                    value = [HLSConverters dateFromISO8601String:stringValue];
+                }
+                if (! value) {
+                    value = [dateFormatters[i] dateFromString:stringValue];
+                }
+                break;
+            }
+                
+            default: {
+                HLSLoggerError(@"Unknown mapping type");
+                break;
+            }
+        }
+        
+        if (value) {
+            [convertedDictionary setObject:value forKey:rule->destKey];
+        }
+    }
+    return convertedDictionary;
+}
+
+// Date formatters must be retrieved on the thread where they are used (see +[NSDateFormatter cachedDateFormatterWithFormat:])
+- (void)fillDateFormatters:(NSDateFormatter **)dateFormatters
+{
+    for (NSUInteger i = 0; i < _numberOfRules; ++i) {
+        if (_rules[i].type == HLSDictionaryMappingTypeDate) {
+            dateFormatters[i] = [NSDateFormatter cachedDateFormatterWithFormat:_rules[i].formatString];
+        }
+    }
+}
+
+// Converted dictionaries are retained
+- (void)convertDictionaries:(NSArray *)dictionaries inRange:(NSRange)range intoResults:(id *)results
+{
+    // Formatters are looked up once per range
+    NSDateFormatter **dateFormatters = (NSDateFormatter **)calloc(MAX(_numberOfRules, 1), sizeof(NSDateFormatter *));
+    [self fillDateFormatters:dateFormatters];
+    
+    for (NSUInteger i = range.location; i < NSMaxRange(range); ++i) {
+        NSDictionary *dictionary = [dictionaries objectAtIndex:i];
+        results[i] = [[self dictionaryFromDictionary:dictionary usingDateFormatters:dateFormatters] retain];
+    }
+    
+    free(dateFormatters);
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    NSMutableArray *ruleDescriptions = [NSMutableArray arrayWithCapacity:_numberOfRules];
+    for (NSUInteger i = 0; i < _numberOfRules; ++i) {
+        [ruleDescriptions addObject:[NSString stringWithFormat:@"%@ -> %@ (%d)", _rules[i].sourceKey, _rules[i].destKey, _rules[i].type]];
+    }
+    return [NSString stringWithFormat:@"<%@: %p; rules: %@>", 
+            [self class],
+            self,
+            ruleDescriptions];
+}
+
+@end
+
+#pragma mark Static functions
+
+static void convertDictionaryBatch(void *context, size_t index)
+{
+    HLSDictionaryBatch *batch = (HLSDictionaryBatch *)context;
+    
+    NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+    NSUInteger count = [batch->dictionaries count];
+    NSUInteger begin = index * kDictionaryBatchStride;
+    NSUInteger end = MIN(begin + kDictionaryBatchStride, count);
+    [batch->mapping convertDictionaries:batch->dictionaries inRange:NSMakeRange(begin, end - begin) intoResults:batch->results];
+    [pool drain];
+}
@@ -0,0 +1,66 @@
+//
+//  HLSDigest.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+/**
+ * Digest algorithms
+ */
+typedef enum {
+    HLSDigestAlgorithmEnumBegin = 0,
+    HLSDigestAlgorithmMD2 = HLSDigestAlgorithmEnumBegin,
+    HLSDigestAlgorithmMD4,
+    HLSDigestAlgorithmMD5,
+    HLSDigestAlgorithmSHA1,
+    HLSDigestAlgorithmSHA224,
+    HLSDigestAlgorithmSHA256,
+    HLSDigestAlgorithmSHA384,
+    HLSDigestAlgorithmSHA512,
+    HLSDigestAlgorithmEnumEnd,
+    HLSDigestAlgorithmEnumSize = HLSDigestAlgorithmEnumEnd - HLSDigestAlgorithmEnumBegin
+} HLSDigestAlgorithm;
+
+/**
+ * An incremental digest. Unlike the digest methods of NSData+HLSExtensions, which need all data to be available in 
+ * memory, a digest object can be fed with successive chunks of data (e.g. read from a file or received from the 
+ * network), using constant memory. Once all data has been supplied, call -finalDigest or -finalHexDigest to get the 
+ * result. A digest cannot be updated anymore afterwards.
+ *
+ * A digest object is not thread-safe, but can be created on one thread and updated on another one
+ *
+ * Designated initializer: -initWithAlgorithm:
+ */
+@interface HLSDigest : NSObject {
+@private
+    HLSDigestAlgorithm _algorithm;
+    void *_context;
+    NSData *_finalDigestData;
+}
+
+/**
+ * Create a digest using the specified algorithm
+ */
+- (id)initWithAlgorithm:(HLSDigestAlgorithm)algorithm;
+
+/**
+ * Feed the digest with more data
+ */
+- (void)updateWithBytes:(const void *)bytes length:(NSUInteger)length;
+- (void)updateWithData:(NSData *)data;
+
+/**
+ * Return the digest of all data supplied so far (raw bytes or lowercase hexadecimal representation, as for the 
+ * NSData+HLSExtensions methods). The first call to one of these methods finalizes the digest
+ */
+- (NSData *)finalDigest;
+- (NSString *)finalHexDigest;
+
+/**
+ * The algorithm used
+ */
+@property (nonatomic, readonly, assign) HLSDigestAlgorithm algorithm;
+
+@end
@@ -0,0 +1,276 @@
+//
+//  HLSDigest.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSDigest.h"
+
+#import "HLSAssert.h"
+#import "HLSConverters.h"
+#import "HLSLogger.h"
+
+#import <CommonCrypto/CommonDigest.h>
+
+// Largest block fed to CommonCrypto at once (lengths are 32-bit)
+static const NSUInteger kMaxUpdateLength = 1 << 30;
+
+typedef union {
+    CC_MD2_CTX md2;
+    CC_MD4_CTX md4;
+    CC_MD5_CTX md5;
+    CC_SHA1_CTX sha1;
+    CC_SHA256_CTX sha256;               // Also used for SHA-224
+    CC_SHA512_CTX sha512;               // Also used for SHA-384
+} HLSDigestContext;
+
+@interface HLSDigest ()
+
+@property (nonatomic, retain) NSData *finalDigestData;
+
+@end
+
+@implementation HLSDigest
+
+#pragma mark Object creation and destruction
+
+- (id)initWithAlgorithm:(HLSDigestAlgorithm)algorithm
+{
+    if ((self = [super init])) {
+        if (algorithm < HLSDigestAlgorithmEnumBegin || algorithm >= HLSDigestAlgorithmEnumEnd) {
+            HLSLoggerError(@"Unknown digest algorithm");
+            [self release];
+            return nil;
+        }
+        
+        _algorithm = algorithm;
+        _context = calloc(1, sizeof(HLSDigestContext));
+        HLSDigestContext *context = (HLSDigestContext *)_context;
+        switch (algorithm) {
+            case HLSDigestAlgorithmMD2: {
+                CC_MD2_Init(&context->md2);
+                break;
+            }
+                
+            case HLSDigestAlgorithmMD4: {
+                CC_MD4_Init(&context->md4);
+                break;
+            }
+                
+            case HLSDigestAlgorithmMD5: {
+                CC_MD5_Init(&context->md5);
+                break;
+            }
+                
+            case HLSDigestAlgorithmSHA1: {
+                CC_SHA1_Init(&context->sha1);
+                break;
+            }
+                
+            case HLSDigestAlgorithmSHA224: {
+                CC_SHA224_Init(&context->sha256);
+                break;
+            }
+                
+            case HLSDigestAlgorithmSHA256: {
+                CC_SHA256_Init(&context->sha256);
+                break;
+            }
+                
+            case HLSDigestAlgorithmSHA384: {
+                CC_SHA384_Init(&context->sha512);
+                break;
+            }
+                
+            case HLSDigestAlgorithmSHA512: {
+                CC_SHA512_Init(&context->sha512);
+                break;
+            }
+                
+            default: {
+                break;
+            }
+        }
+    }
+    return self;
+}
+
+- (id)init
+{
+    HLSForbiddenInheritedMethod();
+    return nil;
+}
+
+- (void)dealloc
+{
+    free(_context);
+    _context = NULL;
+    
+    self.finalDigestData = nil;
+    
+    [super dealloc];
+}
+
+#pragma mark Accessors and mutators
+
+@synthesize algorithm = _algorithm;
+
+@synthesize finalDigestData = _finalDigestData;
+
+#pragma mark Updating the digest
+
+- (void)updateWithBytes:(const void *)bytes length:(NSUInteger)length
+{
+    if (self.finalDigestData) {
+        HLSLoggerError(@"The digest has already been finalized");
+        return;
+    }
+    
+    HLSDigestContext *context = (HLSDigestContext *)_context;
+    const unsigned char *currentBytes = (const unsigned char *)bytes;
+    while (length != 0) {
+        CC_LONG currentLength = (CC_LONG)MIN(length, kMaxUpdateLength);
+        switch (_algorithm) {
+            case HLSDigestAlgorithmMD2: {
+                CC_MD2_Update(&context->md2, currentBytes, currentLength);
+                break;
+            }
+                
+            case HLSDigestAlgorithmMD4: {
+                CC_MD4_Update(&context->md4, currentBytes, currentLength);
+                break;
+            }
+                
+            case HLSDigestAlgorithmMD5: {
+                CC_MD5_Update(&context->md5, currentBytes, currentLength);
+                break;
+            }
+                
+            case HLSDigestAlgorithmSHA1: {
+                CC_SHA1_Update(&context->sha1, currentBytes, currentLength);
+                break;
+            }
+                
+            case HLSDigestAlgorithmSHA224: {
+                CC_SHA224_Update(&context->sha256, currentBytes, currentLength);
+                break;
+            }
+                
+            case HLSDigestAlgorithmSHA256: {
+                CC_SHA256_Update(&context->sha256, currentBytes, currentLength);
+                break;
+            }
+                
+            case HLSDigestAlgorithmSHA384: {
+                CC_SHA384_Update(&context->sha512, currentBytes, currentLength);
+                break;
+            }
+                
+            case HLSDigestAlgorithmSHA512: {
+                CC_SHA512_Update(&context->sha512, currentBytes, currentLength);
+                break;
+            }
+                
+            default: {
+                break;
+            }
+        }
+        currentBytes += currentLength;
+        length -= currentLength;
+    }
+}
+
+- (void)updateWithData:(NSData *)data
+{
+    [self updateWithBytes:[data bytes] length:[data length]];
+}
+
+#pragma mark Final result
+
+- (NSData *)finalDigest
+{
+    if (self.finalDigestData) {
+        return self.finalDigestData;
+    }
+    
+    HLSDigestContext *context = (HLSDigestContext *)_context;
+    unsigned char md[CC_SHA512_DIGEST_LENGTH];
+    NSUInteger digestLength = 0;
+    switch (_algorithm) {
+        case HLSDigestAlgorithmMD2: {
+            CC_MD2_Final(md, &context->md2);
+            digestLength = CC_MD2_DIGEST_LENGTH;
+            break;
+        }
+            
+        case HLSDigestAlgorithmMD4: {
+            CC_MD4_Final(md, &context->md4);
+            digestLength = CC_MD4_DIGEST_LENGTH;
+            break;
+        }
+            
+        case HLSDigestAlgorithmMD5: {
+            CC_MD5_Final(md, &context->md5);
+            digestLength = CC_MD5_DIGEST_LENGTH;
+            break;
+        }
+            
+        case HLSDigestAlgorithmSHA1: {
+            CC_SHA1_Final(md, &context->sha1);
+            digestLength = CC_SHA1_DIGEST_LENGTH;
+            break;
+        }
+            
+        case HLSDigestAlgorithmSHA224: {
+            CC_SHA224_Final(md, &context->sha256);
+            digestLength = CC_SHA224_DIGEST_LENGTH;
+            break;
+        }
+            
+        case HLSDigestAlgorithmSHA256: {
+            CC_SHA256_Final(md, &context->sha256);
+            digestLength = CC_SHA256_DIGEST_LENGTH;
+            break;
+        }
+            
+        case HLSDigestAlgorithmSHA384: {
+            CC_SHA384_Final(md, &context->sha512);
+            digestLength = CC_SHA384_DIGEST_LENGTH;
+            break;
+        }
+            
+        case HLSDigestAlgorithmSHA512: {
+            CC_SHA512_Final(md, &context->sha512);
+            digestLength = CC_SHA512_DIGEST_LENGTH;
+            break;
+        }
+            
+        default: {
+            break;
+        }
+    }
+    
+    self.finalDigestData = [NSData dataWithBytes:md length:digestLength];
+    return self.finalDigestData;
+}
+
+- (NSString *)finalHexDigest
+{
+    NSData *finalDigest = [self finalDigest];
+    return HLSHexStringFromBytes([finalDigest bytes], [finalDigest length]);
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; algorithm: %d; finalized: %@>",
+            [self class],
+            self,
+            _algorithm,
+            HLSStringFromBool(self.finalDigestData != nil)];
+}
+
+@end
@@ -0,0 +1,51 @@
+//
+//  HLSDirectoryEntry.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+/**
+ * An item found in a directory, with its attributes. Entries are immutable snapshots: They are not updated when
+ * the item changes
+ *
+ * Designated initializer: -initWithPath:directory:size:modificationDate:
+ */
+@interface HLSDirectoryEntry : NSObject {
+@private
+    NSString *_path;
+    BOOL _directory;
+    unsigned long long _size;
+    NSDate *_modificationDate;
+}
+
+/**
+ * Create an entry for the item at the given path
+ */
+- (id)initWithPath:(NSString *)path directory:(BOOL)directory size:(unsigned long long)size modificationDate:(NSDate *)modificationDate;
+
+/**
+ * The full path of the item, and its name
+ */
+@property (nonatomic, readonly, retain) NSString *path;
+@property (nonatomic, readonly, retain) NSString *name;
+
+/**
+ * Return YES iff the item is a directory
+ */
+@property (nonatomic, readonly, assign, getter=isDirectory) BOOL directory;
+
+/**
+ * The size of the item as stored (in bytes). For file managers transforming file contents (e.g. compression), this
+ * is the size of the transformed data. This information might not be available for all file managers, in which case 
+ * it is 0. Always 0 for directories
+ */
+@property (nonatomic, readonly, assign) unsigned long long size;
+
+/**
+ * The date at which the item was last modified, nil if not available
+ */
+@property (nonatomic, readonly, retain) NSDate *modificationDate;
+
+@end
@@ -0,0 +1,74 @@
+//
+//  HLSDirectoryEntry.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSDirectoryEntry.h"
+
+#import "HLSAssert.h"
+#import "HLSConverters.h"
+
+@implementation HLSDirectoryEntry
+
+#pragma mark Object creation and destruction
+
+- (id)initWithPath:(NSString *)path directory:(BOOL)directory size:(unsigned long long)size modificationDate:(NSDate *)modificationDate
+{
+    if ((self = [super init])) {
+        _path = [path copy];
+        _directory = directory;
+        _size = directory ? 0 : size;
+        _modificationDate = [modificationDate retain];
+    }
+    return self;
+}
+
+- (id)init
+{
+    HLSForbiddenInheritedMethod();
+    return nil;
+}
+
+- (void)dealloc
+{
+    [_path release];
+    _path = nil;
+    
+    [_modificationDate release];
+    _modificationDate = nil;
+    
+    [super dealloc];
+}
+
+#pragma mark Accessors and mutators
+
+@synthesize path = _path;
+
+- (NSString *)name
+{
+    return [self.path lastPathComponent];
+}
+
+@synthesize directory = _directory;
+
+@synthesize size = _size;
+
+@synthesize modificationDate = _modificationDate;
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; path: %@; directory: %@; size: %llu; modificationDate: %@>",
+            [self class],
+            self,
+            self.path,
+            HLSStringFromBool(self.directory),
+            self.size,
+            self.modificationDate];
+}
+
+@end
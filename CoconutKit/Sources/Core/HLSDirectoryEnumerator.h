@@ -0,0 +1,58 @@
+//
+//  HLSDirectoryEnumerator.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSDirectoryEntry.h"
+
+@class HLSFileManager;
+
+/**
+ * An enumerator returning the HLSDirectoryEntry objects found in a directory managed by some file manager, optionally
+ * descending into subdirectories (depth-first). Each directory is listed at once with all attributes of its items,
+ * using -[HLSFileManager entriesOfDirectoryAtPath:error:]. Traversal is lazy, i.e. subdirectories are only read when 
+ * the enumeration reaches them, and stopping early (by not calling -nextObject anymore) saves all remaining work.
+ *
+ * An enumerator must not be used by several threads at the same time, but since file managers are thread-safe, it 
+ * can be used on any thread, e.g. within an HLSTask operation.
+ *
+ * Designated initializer: -initWithFileManager:path:recursive:
+ */
+@interface HLSDirectoryEnumerator : NSEnumerator {
+@private
+    HLSFileManager *_fileManager;
+    NSString *_path;
+    BOOL _recursive;
+    NSPredicate *_predicate;
+    NSMutableArray *_pendingEntryArrays;
+    HLSDirectoryEntry *_lastEntry;
+    BOOL _started;
+    NSError *_error;
+}
+
+/**
+ * Create an enumerator for the directory at the given path
+ */
+- (id)initWithFileManager:(HLSFileManager *)fileManager path:(NSString *)path recursive:(BOOL)recursive;
+
+/**
+ * If set, only entries matching the predicate (evaluated against HLSDirectoryEntry objects, e.g. "size > 1024") are
+ * returned. Subdirectories not matching the predicate are still traversed. Must be set before the enumeration starts
+ */
+@property (nonatomic, retain) NSPredicate *predicate;
+
+/**
+ * Do not descend into the directory which has just been returned by -nextObject (if any)
+ */
+- (void)skipDescendants;
+
+/**
+ * The last error encountered during enumeration, if any. If the directory itself cannot be read, the enumeration
+ * returns no entries. Subdirectories which cannot be read are skipped
+ */
+@property (nonatomic, readonly, retain) NSError *error;
+
+@end
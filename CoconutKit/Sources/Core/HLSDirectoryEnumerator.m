@@ -0,0 +1,175 @@
+//
+//  HLSDirectoryEnumerator.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSDirectoryEnumerator.h"
+
+#import "HLSAssert.h"
+#import "HLSConverters.h"
+#import "HLSFileManager.h"
+#import "HLSLogger.h"
+
+@interface HLSDirectoryEnumerator ()
+
+@property (nonatomic, retain) HLSDirectoryEntry *lastEntry;
+@property (nonatomic, retain) NSError *error;
+
+- (void)pushEntriesOfDirectoryAtPath:(NSString *)path;
+
+@end
+
+@implementation HLSDirectoryEnumerator
+
+#pragma mark Object creation and destruction
+
+- (id)initWithFileManager:(HLSFileManager *)fileManager path:(NSString *)path recursive:(BOOL)recursive
+{
+    if ((self = [super init])) {
+        if (! fileManager || ! path) {
+            HLSLoggerError(@"A file manager and a path are mandatory");
+            [self release];
+            return nil;
+        }
+        
+        _fileManager = [fileManager retain];
+        _path = [path copy];
+        _recursive = recursive;
+        
+        // Stack of the entry arrays still to be enumerated. Each array is consumed from its beginning
+        _pendingEntryArrays = [[NSMutableArray alloc] init];
+    }
+    return self;
+}
+
+- (id)init
+{
+    HLSForbiddenInheritedMethod();
+    return nil;
+}
+
+- (void)dealloc
+{
+    [_fileManager release];
+    _fileManager = nil;
+    
+    [_path release];
+    _path = nil;
+    
+    [_pendingEntryArrays release];
+    _pendingEntryArrays = nil;
+    
+    self.predicate = nil;
+    self.lastEntry = nil;
+    self.error = nil;
+    
+    [super dealloc];
+}
+
+#pragma mark Accessors and mutators
+
+@synthesize predicate = _predicate;
+
+- (void)setPredicate:(NSPredicate *)predicate
+{
+    if (_started) {
+        HLSLoggerError(@"The predicate cannot be changed once the enumeration has started");
+        return;
+    }
+    
+    if (predicate == _predicate) {
+        return;
+    }
+    
+    [_predicate release];
+    _predicate = [predicate retain];
+}
+
+@synthesize lastEntry = _lastEntry;
+
+@synthesize error = _error;
+
+#pragma mark NSEnumerator methods
+
+- (id)nextObject
+{
+    if (! _started) {
+        _started = YES;
+        [self pushEntriesOfDirectoryAtPath:_path];
+    }
+    
+    while (YES) {
+        // Descend into the last directory returned, if not skipped
+        if (_recursive && self.lastEntry.directory) {
+            NSString *directoryPath = [[self.lastEntry.path retain] autorelease];
+            self.lastEntry = nil;
+            [self pushEntriesOfDirectoryAtPath:directoryPath];
+        }
+        
+        NSMutableArray *entries = [_pendingEntryArrays lastObject];
+        if (! entries) {
+            return nil;
+        }
+        
+        if ([entries count] == 0) {
+            [_pendingEntryArrays removeLastObject];
+            continue;
+        }
+        
+        HLSDirectoryEntry *entry = [[[entries objectAtIndex:0] retain] autorelease];
+        [entries removeObjectAtIndex:0];
+        self.lastEntry = entry;
+        
+        if (! self.predicate || [self.predicate evaluateWithObject:entry]) {
+            return entry;
+        }
+    }
+}
+
+- (NSArray *)allObjects
+{
+    NSMutableArray *allObjects = [NSMutableArray array];
+    HLSDirectoryEntry *entry = nil;
+    while ((entry = [self nextObject])) {
+        [allObjects addObject:entry];
+    }
+    return [NSArray arrayWithArray:allObjects];
+}
+
+#pragma mark Traversal
+
+- (void)skipDescendants
+{
+    self.lastEntry = nil;
+}
+
+- (void)pushEntriesOfDirectoryAtPath:(NSString *)path
+{
+    NSError *error = nil;
+    NSArray *entries = [_fileManager entriesOfDirectoryAtPath:path error:&error];
+    if (! entries) {
+        HLSLoggerWarn(@"The directory %@ could not be read. Reason: %@", path, error);
+        self.error = error;
+        return;
+    }
+    
+    [_pendingEntryArrays addObject:[NSMutableArray arrayWithArray:entries]];
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; fileManager: %@; path: %@; recursive: %@; predicate: %@>",
+            [self class],
+            self,
+            _fileManager,
+            _path,
+            HLSStringFromBool(_recursive),
+            self.predicate];
+}
+
+@end
@@ -0,0 +1,36 @@
+//
+//  HLSEncryptingFileManager.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSLayeredFileManager.h"
+
+/**
+ * A file manager layer encrypting file contents (using AES in CTR mode) before they are handed over to the underlying 
+ * file manager, and decrypting them when they are read. Each file starts with a random 16-byte nonce, followed by
+ * the encrypted data, which has the same length as the original one.
+ *
+ * Since CTR mode allows any part of a file to be decrypted independently, range reads only read and decrypt the
+ * requested bytes, and appending data does not require existing contents to be encrypted again.
+ *
+ * Encryption only guarantees confidentiality: Modified files are not detected and decrypt to garbage. When stacking 
+ * with an HLSCompressingFileManager, the encrypting layer must be the innermost one (encrypted data cannot be 
+ * compressed).
+ *
+ * Designated initializer: -initWithFileManager:key:
+ */
+@interface HLSEncryptingFileManager : HLSLayeredFileManager {
+@private
+    NSData *_key;
+}
+
+/**
+ * Create a layer encrypting data with the given key, which must be 16, 24 or 32 bytes long (AES-128, AES-192
+ * or AES-256). The key is copied
+ */
+- (id)initWithFileManager:(HLSFileManager *)fileManager key:(NSData *)key;
+
+@end
@@ -0,0 +1,266 @@
+//
+//  HLSEncryptingFileManager.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSEncryptingFileManager.h"
+
+#import "HLSAssert.h"
+#import "HLSLogger.h"
+
+#import <CommonCrypto/CommonCryptor.h>
+
+// Number of counter blocks encrypted at once
+static const NSUInteger kKeystreamBlockCount = 256;
+
+@interface HLSEncryptingFileManager ()
+
+@property (nonatomic, retain) NSData *key;
+
+- (NSData *)nonceOfFileAtPath:(NSString *)path error:(NSError **)pError;
+- (NSData *)encryptedDataWithData:(NSData *)data nonce:(NSData *)nonce offset:(unsigned long long)offset;
+
+@end
+
+// Function declarations
+static NSData *randomNonce(void);
+static void setCounterBlock(uint8_t *block, const uint8_t *nonce, uint64_t blockIndex);
+static NSError *corruptFileErrorForPath(NSString *path);
+
+@implementation HLSEncryptingFileManager
+
+#pragma mark Object creation and destruction
+
+- (id)initWithFileManager:(HLSFileManager *)fileManager key:(NSData *)key
+{
+    if ((self = [super initWithFileManager:fileManager])) {
+        if ([key length] != kCCKeySizeAES128 && [key length] != kCCKeySizeAES192 && [key length] != kCCKeySizeAES256) {
+            HLSLoggerError(@"The key must be 16, 24 or 32 bytes long");
+            [self release];
+            return nil;
+        }
+        
+        self.key = [[key copy] autorelease];
+    }
+    return self;
+}
+
+- (id)initWithFileManager:(HLSFileManager *)fileManager
+{
+    HLSForbiddenInheritedMethod();
+    return nil;
+}
+
+- (void)dealloc
+{
+    self.key = nil;
+    
+    [super dealloc];
+}
+
+#pragma mark Accessors and mutators
+
+@synthesize key = _key;
+
+#pragma mark HLSFileManagerAbstract protocol implementation
+
+- (NSData *)contentsOfFileAtPath:(NSString *)path error:(NSError **)pError
+{
+    NSData *encryptedContents = [self.fileManager contentsOfFileAtPath:path error:pError];
+    if (! encryptedContents) {
+        return nil;
+    }
+    
+    if ([encryptedContents length] < kCCBlockSizeAES128) {
+        if (pError) {
+            *pError = corruptFileErrorForPath(path);
+        }
+        return nil;
+    }
+    
+    NSData *nonce = [encryptedContents subdataWithRange:NSMakeRange(0, kCCBlockSizeAES128)];
+    NSData *encryptedData = [encryptedContents subdataWithRange:NSMakeRange(kCCBlockSizeAES128, [encryptedContents length] - kCCBlockSizeAES128)];
+    return [self encryptedDataWithData:encryptedData nonce:nonce offset:0];
+}
+
+- (NSData *)contentsOfFileAtPath:(NSString *)path range:(NSRange)range error:(NSError **)pError
+{
+    NSData *nonce = [self nonceOfFileAtPath:path error:pError];
+    if (! nonce) {
+        return nil;
+    }
+    
+    // Shift the range past the nonce, avoiding overflows for ranges extending to the end of the file
+    NSRange encryptedRange = NSMakeRange(range.location + kCCBlockSizeAES128, MIN(range.length, NSUIntegerMax - range.location - kCCBlockSizeAES128));
+    NSData *encryptedData = [self.fileManager contentsOfFileAtPath:path range:encryptedRange error:pError];
+    if (! encryptedData) {
+        return nil;
+    }
+    
+    return [self encryptedDataWithData:encryptedData nonce:nonce offset:range.location];
+}
+
+- (BOOL)createFileAtPath:(NSString *)path contents:(NSData *)contents error:(NSError **)pError
+{
+    NSData *nonce = randomNonce();
+    NSData *encryptedData = [self encryptedDataWithData:contents nonce:nonce offset:0];
+    if (! encryptedData) {
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSCocoaErrorDomain
+                                          code:NSFileWriteUnknownError
+                                      userInfo:[NSDictionary dictionaryWithObject:path forKey:NSFilePathErrorKey]];
+        }
+        return NO;
+    }
+    
+    NSMutableData *encryptedContents = [NSMutableData dataWithCapacity:[nonce length] + [encryptedData length]];
+    [encryptedContents appendData:nonce];
+    [encryptedContents appendData:encryptedData];
+    return [self.fileManager createFileAtPath:path contents:encryptedContents error:pError];
+}
+
+- (BOOL)appendContents:(NSData *)contents toFileAtPath:(NSString *)path error:(NSError **)pError
+{
+    if (! [self.fileManager fileExistsAtPath:path]) {
+        return [self createFileAtPath:path contents:contents error:pError];
+    }
+    
+    // The protocol provides no way to get the size of a file. Retrieve it from its contents, which are memory-mapped
+    // by file managers supporting it
+    NSData *existingEncryptedContents = [self.fileManager contentsOfFileAtPath:path error:pError];
+    if (! existingEncryptedContents) {
+        return NO;
+    }
+    
+    if ([existingEncryptedContents length] < kCCBlockSizeAES128) {
+        if (pError) {
+            *pError = corruptFileErrorForPath(path);
+        }
+        return NO;
+    }
+    
+    NSData *nonce = [existingEncryptedContents subdataWithRange:NSMakeRange(0, kCCBlockSizeAES128)];
+    unsigned long long offset = [existingEncryptedContents length] - kCCBlockSizeAES128;
+    NSData *encryptedData = [self encryptedDataWithData:contents nonce:nonce offset:offset];
+    if (! encryptedData) {
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSCocoaErrorDomain
+                                          code:NSFileWriteUnknownError
+                                      userInfo:[NSDictionary dictionaryWithObject:path forKey:NSFilePathErrorKey]];
+        }
+        return NO;
+    }
+    
+    return [self.fileManager appendContents:encryptedData toFileAtPath:path error:pError];
+}
+
+#pragma mark Encryption
+
+- (NSData *)nonceOfFileAtPath:(NSString *)path error:(NSError **)pError
+{
+    NSData *nonce = [self.fileManager contentsOfFileAtPath:path range:NSMakeRange(0, kCCBlockSizeAES128) error:pError];
+    if (! nonce) {
+        return nil;
+    }
+    
+    if ([nonce length] != kCCBlockSizeAES128) {
+        if (pError) {
+            *pError = corruptFileErrorForPath(path);
+        }
+        return nil;
+    }
+    
+    return nonce;
+}
+
+// CTR mode: The data is XORed with the encryption of successive counter blocks (the nonce plus the block index). 
+// Encryption and decryption are therefore the same operation
+- (NSData *)encryptedDataWithData:(NSData *)data nonce:(NSData *)nonce offset:(unsigned long long)offset
+{
+    CCCryptorRef cryptor = NULL;
+    if (CCCryptorCreate(kCCEncrypt, kCCAlgorithmAES128, kCCOptionECBMode, [self.key bytes], [self.key length], NULL, &cryptor) != kCCSuccess) {
+        HLSLoggerError(@"Could not create the cryptor");
+        return nil;
+    }
+    
+    NSMutableData *encryptedData = [NSMutableData dataWithLength:[data length]];
+    const uint8_t *bytes = [data bytes];
+    uint8_t *encryptedBytes = [encryptedData mutableBytes];
+    
+    uint8_t *counterBlocks = malloc(kKeystreamBlockCount * kCCBlockSizeAES128);
+    uint8_t *keystream = malloc(kKeystreamBlockCount * kCCBlockSizeAES128);
+    uint64_t blockIndex = offset / kCCBlockSizeAES128;
+    NSUInteger keystreamOffset = (NSUInteger)(offset % kCCBlockSizeAES128);
+    NSUInteger position = 0;
+    BOOL succeeded = YES;
+    while (position < [data length]) {
+        // Number of blocks needed to cover the remaining data (including the skipped part of the first block)
+        NSUInteger blockCount = MIN((keystreamOffset + [data length] - position + kCCBlockSizeAES128 - 1) / kCCBlockSizeAES128, 
+                                    kKeystreamBlockCount);
+        for (NSUInteger i = 0; i < blockCount; ++i) {
+            setCounterBlock(counterBlocks + i * kCCBlockSizeAES128, [nonce bytes], blockIndex + i);
+        }
+        
+        size_t keystreamLength = 0;
+        if (CCCryptorUpdate(cryptor, counterBlocks, blockCount * kCCBlockSizeAES128, keystream, 
+                            kKeystreamBlockCount * kCCBlockSizeAES128, &keystreamLength) != kCCSuccess) {
+            succeeded = NO;
+            break;
+        }
+        
+        NSUInteger length = MIN(keystreamLength - keystreamOffset, [data length] - position);
+        for (NSUInteger i = 0; i < length; ++i) {
+            encryptedBytes[position + i] = bytes[position + i] ^ keystream[keystreamOffset + i];
+        }
+        
+        position += length;
+        blockIndex += blockCount;
+        keystreamOffset = 0;
+    }
+    
+    free(counterBlocks);
+    free(keystream);
+    CCCryptorRelease(cryptor);
+    
+    if (! succeeded) {
+        HLSLoggerError(@"Encryption failed");
+        return nil;
+    }
+    
+    return encryptedData;
+}
+
+@end
+
+#pragma mark Static functions
+
+static NSData *randomNonce(void)
+{
+    uint32_t nonce[kCCBlockSizeAES128 / sizeof(uint32_t)];
+    for (NSUInteger i = 0; i < sizeof(nonce) / sizeof(uint32_t); ++i) {
+        nonce[i] = arc4random();
+    }
+    return [NSData dataWithBytes:nonce length:sizeof(nonce)];
+}
+
+// The counter block is the 128-bit big-endian sum of the nonce and of the block index
+static void setCounterBlock(uint8_t *block, const uint8_t *nonce, uint64_t blockIndex)
+{
+    unsigned int carry = 0;
+    for (NSInteger i = kCCBlockSizeAES128 - 1; i >= 0; --i) {
+        unsigned int sum = nonce[i] + (unsigned int)(blockIndex & 0xff) + carry;
+        block[i] = (uint8_t)sum;
+        carry = sum >> 8;
+        blockIndex >>= 8;
+    }
+}
+
+static NSError *corruptFileErrorForPath(NSString *path)
+{
+    return [NSError errorWithDomain:NSCocoaErrorDomain
+                               code:NSFileReadCorruptFileError
+                           userInfo:[NSDictionary dictionaryWithObject:path forKey:NSFilePathErrorKey]];
+}
@@ -18,7 +18,8 @@
  */
 @interface HLSError : NSError {
 @private
-    NSDictionary *m_internalUserInfo;
+    NSMutableDictionary *m_internalUserInfo;
+    NSDictionary *m_frozenUserInfo;
 }
 
 /**
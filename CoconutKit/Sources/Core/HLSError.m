@@ -10,15 +10,17 @@
 
 #import "HLSAssert.h"
 #import "HLSLogger.h"
-#import "NSDictionary+HLSExtensions.h"
 
 @interface HLSError ()
 
 /**
  * We do not use the NSError userInfo dictionary since it is set at NSError creation time and cannot be updated afterwards.
- * Instead, we use our own internal dictionary
+ * Instead, we use our own internal dictionary, updated in place and lazily created. An immutable copy is made when the 
+ * userInfo is first read, and discarded when the error is updated. Building an error is therefore linear in the number 
+ * of fields, and errors which are never read (e.g. intermediate validation errors) are never frozen
  */
-@property (nonatomic, retain) NSDictionary *internalUserInfo;
+@property (nonatomic, retain) NSMutableDictionary *internalUserInfo;
+@property (nonatomic, retain) NSDictionary *frozenUserInfo;
 
 @end
 
@@ -42,15 +44,14 @@
 
 - (id)initWithDomain:(NSString *)domain code:(NSInteger)code
 {
-    if ((self = [super initWithDomain:domain code:code userInfo:nil /* not used */])) {
-        self.internalUserInfo = [NSDictionary dictionary];
-    }
-    return self;
+    // The internal dictionary is lazily created when the first field is set
+    return [super initWithDomain:domain code:code userInfo:nil /* not used */];
 }
 
 - (void)dealloc
 {
     self.internalUserInfo = nil;
+    self.frozenUserInfo = nil;
     
     [super dealloc];
 }
@@ -59,9 +60,14 @@
 
 @synthesize internalUserInfo = m_internalUserInfo;
 
+@synthesize frozenUserInfo = m_frozenUserInfo;
+
 - (NSDictionary *)userInfo
 {
-    return self.internalUserInfo;
+    if (! self.frozenUserInfo) {
+        self.frozenUserInfo = self.internalUserInfo ? [NSDictionary dictionaryWithDictionary:self.internalUserInfo] : [NSDictionary dictionary];
+    }
+    return self.frozenUserInfo;
 }
 
 - (void)setLocalizedDescription:(NSString *)localizedDescription
@@ -109,20 +115,27 @@
     }
     
     if (object) {
-        self.internalUserInfo = [self.internalUserInfo dictionaryBySettingObject:object forKey:key];
+        if (! self.internalUserInfo) {
+            self.internalUserInfo = [NSMutableDictionary dictionary];
+        }
+        [self.internalUserInfo setObject:object forKey:key];
     }
     else {
-        self.internalUserInfo = [self.internalUserInfo dictionaryByRemovingObjectForKey:key];
+        [self.internalUserInfo removeObjectForKey:key];
     }
+    
+    self.frozenUserInfo = nil;
 }
 
 #pragma mark NSCopying protocol implementation
 
 - (id)copyWithZone:(NSZone *)zone
 {
-    // Unlike a conventional NSError, the userInfo dictionary is here mutable. A deep copy must therefore be made
+    // Unlike a conventional NSError, the userInfo dictionary is here mutable. A deep copy must therefore be made. The
+    // frozen dictionary is immutable and can be shared
     HLSError *errorCopy = [super copyWithZone:zone];
-    errorCopy.internalUserInfo = [NSMutableDictionary dictionaryWithDictionary:self.internalUserInfo];
+    errorCopy.internalUserInfo = self.internalUserInfo ? [NSMutableDictionary dictionaryWithDictionary:self.internalUserInfo] : nil;
+    errorCopy.frozenUserInfo = self.frozenUserInfo;
     return errorCopy;
 }
 
@@ -6,6 +6,11 @@
 //  Copyright (c) 2012 Hortis. All rights reserved.
 //
 
+#import "HLSDigest.h"
+#import "HLSDirectoryEntry.h"
+
+@class HLSDirectoryEnumerator;
+
 /**
  * Concrete subclasses of HLSFileManager must implement the set of methods declared by the following protocol
  */
@@ -17,6 +22,32 @@
  */
 - (NSData *)contentsOfFileAtPath:(NSString *)path error:(NSError **)pError;
 
+/**
+ * Return the part of the content of the file at the given location which lies within the specified range. If the
+ * range extends past the end of the file, the data returned is shorter (empty if the range starts after the end
+ * of the file). HLSFileManager provides a default implementation extracting the range from -contentsOfFileAtPath:error:. 
+ * Subclasses should override it with an implementation only reading the bytes requested if possible
+ *
+ * Return nil on failure
+ */
+- (NSData *)contentsOfFileAtPath:(NSString *)path range:(NSRange)range error:(NSError **)pError;
+
+/**
+ * Return an (unopened) input stream to read the file at the given location incrementally. HLSFileManager provides 
+ * a default implementation streaming the data returned by -contentsOfFileAtPath:error:. Subclasses should override 
+ * it with an implementation reading the file incrementally if possible
+ *
+ * Return nil if the file cannot be read
+ */
+- (NSInputStream *)inputStreamForFileAtPath:(NSString *)path;
+
+/**
+ * Return an (unopened) output stream to write the file at the given location incrementally, either from its beginning
+ * (replacing any existing content) or appending data to it. There is no reasonable default implementation in terms
+ * of the other methods: HLSFileManager returns nil, subclasses must override this method to support streaming writes
+ */
+- (NSOutputStream *)outputStreamToFileAtPath:(NSString *)path append:(BOOL)append;
+
 /**
  * Create a file with the specified content at the given location
  *
@@ -24,6 +55,28 @@
  */
 - (BOOL)createFileAtPath:(NSString *)path contents:(NSData *)contents error:(NSError **)pError;
 
+/**
+ * Append data at the end of the file at the given location, creating the file if it does not exist. HLSFileManager
+ * provides a default implementation appending through -outputStreamToFileAtPath:append: if the subclass supports
+ * streaming writes, otherwise reading the file and writing it again with the data appended. Subclasses should
+ * override it with a more efficient implementation if possible
+ *
+ * Return YES iff successful
+ */
+- (BOOL)appendContents:(NSData *)contents toFileAtPath:(NSString *)path error:(NSError **)pError;
+
+/**
+ * Return the digest (lowercase hexadecimal) of the file at the given location, computed using the specified algorithm.
+ * HLSFileManager provides a default implementation feeding the file contents to the digest in fixed-size chunks read
+ * from -inputStreamForFileAtPath:, so that memory use stays constant if this method is implemented efficiently.
+ *
+ * Since file managers are thread-safe, this method can be called from any thread, e.g. from an HLSTask operation to
+ * hash large files in the background
+ *
+ * Return nil on failure
+ */
+- (NSString *)hexDigestOfFileAtPath:(NSString *)path usingAlgorithm:(HLSDigestAlgorithm)algorithm error:(NSError **)pError;
+
 /**
  * Create a directory at the specified path (create intermediate directories if enabled, otherwise fails if the parent directory does not
  * exist)
@@ -37,6 +90,14 @@
  */
 - (NSArray *)contentsOfDirectoryAtPath:(NSString *)path error:(NSError **)pError;
 
+/**
+ * List the contents of the specified directory as HLSDirectoryEntry objects, with their attributes. HLSFileManager 
+ * provides a default implementation calling -fileExistsAtPath:isDirectory: for each item (size and modification date 
+ * are then not available). Subclasses should override it to retrieve all attributes at once when listing the 
+ * directory. Use an HLSDirectoryEnumerator to traverse directory hierarchies
+ */
+- (NSArray *)entriesOfDirectoryAtPath:(NSString *)path error:(NSError **)pError;
+
 /**
  * Return YES iff the file or folder exists at the specified path (and whether it is a directory or not; you can pass NULL if you do not
  * need this information)
@@ -81,17 +142,26 @@
  * For all methods, paths represent locations relative to the managed storage, and should be given using the standard
  * notation /path/to/some/file.txt. The / at the beginning represents the storage root
  *
+ * Each file manager also provides asynchronous variants of the most common operations, so that file work can be 
+ * moved off the main thread without callers having to manage their own queues (see 'Asynchronous operations')
+ *
  * Designated initializer: -init
  */
-@interface HLSFileManager : NSObject <HLSFileManagerAbstract>
+@interface HLSFileManager : NSObject <HLSFileManagerAbstract> {
+@private
+    NSOperationQueue *_operationQueue;
+    NSMutableDictionary *_pathToPendingWriteRequestMap;
+}
 
 /**
- * Set the default file manager. The previously installed one is returned
+ * Set the default file manager. The previously installed one is returned (autoreleased). Since +defaultManager 
+ * does not retain the manager it returns, the default manager must not be replaced while other threads might still
+ * be using it
  */
 + (HLSFileManager *)setDefaultManager:(HLSFileManager *)defaultManager;
 
 /**
- * Return the current default file manager
+ * Return the current default file manager. This method is lock-free and can be called from any thread
  */
 + (HLSFileManager *)defaultManager;
 
@@ -100,4 +170,53 @@
  */
 - (BOOL)fileExistsAtPath:(NSString *)path;
 
+/**
+ * Return an enumerator for the contents of the directory at the given path, possibly including the contents of its
+ * subdirectories
+ */
+- (HLSDirectoryEnumerator *)enumeratorAtPath:(NSString *)path recursive:(BOOL)recursive;
+
+@end
+
+/**
+ * Asynchronous operations. They are performed one after the other, in submission order, on a queue dedicated to
+ * the file manager, and are implemented in terms of the synchronous HLSFileManagerAbstract methods. Subclasses 
+ * therefore get them for free.
+ *
+ * Once an operation is complete, the completion action is called on the main thread. It must have the signature
+ *   - (void)methodName:(id)result error:(NSError *)error
+ * where result is the file contents for reads, and the path for writes and removals (nil on failure, in which case
+ * error contains the reason). The target is retained until the action has been called, and can be nil if no 
+ * completion notification is needed.
+ *
+ * Writes are coalesced: If data is written to a path while a previous write to the same path is still waiting to 
+ * be processed, the previous write is replaced by the new one, and all completion actions are called once the most
+ * recent content has been written. Reads and removals are never coalesced and always see the result of the writes 
+ * submitted before them
+ */
+@interface HLSFileManager (HLSAsynchronousOperations)
+
+/**
+ * Asynchronously read the contents of the file at the given location
+ */
+- (void)readContentsOfFileAtPath:(NSString *)path completionTarget:(id)target action:(SEL)action;
+
+/**
+ * Asynchronously create or replace the file at the given location (see -createFileAtPath:contents:error:). The
+ * data is copied
+ */
+- (void)writeContents:(NSData *)contents toFileAtPath:(NSString *)path completionTarget:(id)target action:(SEL)action;
+
+/**
+ * Asynchronously remove the file or directory at the given location
+ */
+- (void)removeItemAtPath:(NSString *)path completionTarget:(id)target action:(SEL)action;
+
+/**
+ * Block the calling thread until all asynchronous operations submitted so far have been performed. Completion actions
+ * are called on the main thread afterwards, which means that they have not been called yet when this method is
+ * called from the main thread and returns
+ */
+- (void)waitUntilAsynchronousOperationsAreFinished;
+
 @end
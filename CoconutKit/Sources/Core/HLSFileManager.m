@@ -8,10 +8,65 @@
 
 #import "HLSFileManager.h"
 
+#import "HLSAssert.h"
+#import "HLSDirectoryEnumerator.h"
+#import "HLSLogger.h"
+
+#import <libkern/OSAtomic.h>
+
+#include <errno.h>
+
 // TODO: When available in CoconutKit (feature/url-connection branch), check protocol conformance (all methods from the
 //       abstract protocol must be implemented, though they have been made optional to avoid compilation warnings)
 
-static HLSFileManager *s_defaultManager = nil;
+// Number of bytes fed to a digest at once
+static const NSUInteger kDigestChunkLength = 1 << 20;
+
+static HLSFileManager * volatile s_defaultManager = nil;
+
+typedef enum {
+    HLSFileManagerRequestTypeEnumBegin = 0,
+    HLSFileManagerRequestTypeRead = HLSFileManagerRequestTypeEnumBegin,
+    HLSFileManagerRequestTypeWrite,
+    HLSFileManagerRequestTypeRemove,
+    HLSFileManagerRequestTypeEnumEnd,
+    HLSFileManagerRequestTypeEnumSize = HLSFileManagerRequestTypeEnumEnd - HLSFileManagerRequestTypeEnumBegin
+} HLSFileManagerRequestType;
+
+/**
+ * Private class describing an asynchronous operation, as well as the completion actions to call when it is done
+ */
+@interface HLSFileManagerRequest : NSObject {
+@private
+    HLSFileManagerRequestType _type;
+    NSString *_path;
+    NSData *_contents;
+    NSMutableArray *_targets;
+    NSMutableArray *_actionNames;
+    id _result;
+    NSError *_error;
+}
+
+- (id)initWithType:(HLSFileManagerRequestType)type path:(NSString *)path;
+
+@property (nonatomic, readonly, assign) HLSFileManagerRequestType type;
+@property (nonatomic, readonly, retain) NSString *path;
+@property (nonatomic, retain) NSData *contents;
+@property (nonatomic, retain) id result;
+@property (nonatomic, retain) NSError *error;
+
+- (void)addCompletionTarget:(id)target action:(SEL)action;
+- (void)callCompletionActions;
+
+@end
+
+@interface HLSFileManager ()
+
+- (void)submitRequest:(HLSFileManagerRequest *)request;
+- (void)performRequest:(HLSFileManagerRequest *)request;
+- (void)notifyCompletionOfRequest:(HLSFileManagerRequest *)request;
+
+@end
 
 @implementation HLSFileManager
 
@@ -19,18 +74,44 @@ static HLSFileManager *s_defaultManager = nil;
 
 + (HLSFileManager *)setDefaultManager:(HLSFileManager *)defaultManager
 {
+    // Only writers are serialized. The barrier ensures the new manager is fully initialized before readers can see it
     @synchronized(self) {
         HLSFileManager *previousManager = [s_defaultManager autorelease];
-        s_defaultManager = [defaultManager retain];
+        [defaultManager retain];
+        OSMemoryBarrier();
+        s_defaultManager = defaultManager;
         return previousManager;
     }
 }
 
 + (HLSFileManager *)defaultManager
 {
-    @synchronized(self) {
-        return s_defaultManager;
+    OSMemoryBarrier();
+    return s_defaultManager;
+}
+
+#pragma mark Object creation and destruction
+
+- (id)init
+{
+    if ((self = [super init])) {
+        _operationQueue = [[NSOperationQueue alloc] init];
+        [_operationQueue setMaxConcurrentOperationCount:1];
+        _pathToPendingWriteRequestMap = [[NSMutableDictionary alloc] init];
     }
+    return self;
+}
+
+- (void)dealloc
+{
+    [_operationQueue cancelAllOperations];
+    [_operationQueue release];
+    _operationQueue = nil;
+    
+    [_pathToPendingWriteRequestMap release];
+    _pathToPendingWriteRequestMap = nil;
+    
+    [super dealloc];
 }
 
 #pragma mark Convenience methods
@@ -40,4 +121,344 @@ static HLSFileManager *s_defaultManager = nil;
     return [self fileExistsAtPath:path isDirectory:NULL];
 }
 
+- (HLSDirectoryEnumerator *)enumeratorAtPath:(NSString *)path recursive:(BOOL)recursive
+{
+    return [[[HLSDirectoryEnumerator alloc] initWithFileManager:self path:path recursive:recursive] autorelease];
+}
+
+#pragma mark Default implementations
+
+- (NSData *)contentsOfFileAtPath:(NSString *)path range:(NSRange)range error:(NSError **)pError
+{
+    NSData *contents = [self contentsOfFileAtPath:path error:pError];
+    if (! contents) {
+        return nil;
+    }
+    
+    if (range.location >= [contents length]) {
+        return [NSData data];
+    }
+    
+    NSUInteger length = MIN(range.length, [contents length] - range.location);
+    return [contents subdataWithRange:NSMakeRange(range.location, length)];
+}
+
+- (NSInputStream *)inputStreamForFileAtPath:(NSString *)path
+{
+    NSData *contents = [self contentsOfFileAtPath:path error:NULL];
+    if (! contents) {
+        return nil;
+    }
+    
+    return [NSInputStream inputStreamWithData:contents];
+}
+
+- (NSOutputStream *)outputStreamToFileAtPath:(NSString *)path append:(BOOL)append
+{
+    HLSLoggerError(@"Streaming writes are not supported by %@", [self class]);
+    return nil;
+}
+
+- (BOOL)appendContents:(NSData *)contents toFileAtPath:(NSString *)path error:(NSError **)pError
+{
+    if (! [self fileExistsAtPath:path]) {
+        return [self createFileAtPath:path contents:contents error:pError];
+    }
+    
+    // Append through an output stream if the subclass supports streaming writes (the default implementation of
+    // -outputStreamToFileAtPath:append: logs an error, do not call it), otherwise read and write the whole file
+    SEL outputStreamSelector = @selector(outputStreamToFileAtPath:append:);
+    if ([[self class] instanceMethodForSelector:outputStreamSelector] != [HLSFileManager instanceMethodForSelector:outputStreamSelector]) {
+        NSOutputStream *outputStream = [self outputStreamToFileAtPath:path append:YES];
+        if (outputStream) {
+            [outputStream open];
+            
+            const uint8_t *bytes = [contents bytes];
+            NSUInteger remainingLength = [contents length];
+            while (remainingLength != 0) {
+                NSInteger writtenLength = [outputStream write:bytes maxLength:remainingLength];
+                if (writtenLength <= 0) {
+                    if (pError) {
+                        *pError = [outputStream streamError] ?: [NSError errorWithDomain:NSCocoaErrorDomain
+                                                                                     code:NSFileWriteUnknownError
+                                                                                 userInfo:[NSDictionary dictionaryWithObject:path forKey:NSFilePathErrorKey]];
+                    }
+                    [outputStream close];
+                    return NO;
+                }
+                bytes += writtenLength;
+                remainingLength -= writtenLength;
+            }
+            
+            [outputStream close];
+            return YES;
+        }
+    }
+    
+    NSData *existingContents = [self contentsOfFileAtPath:path error:pError];
+    if (! existingContents) {
+        return NO;
+    }
+    
+    NSMutableData *allContents = [NSMutableData dataWithData:existingContents];
+    [allContents appendData:contents];
+    return [self createFileAtPath:path contents:allContents error:pError];
+}
+
+- (NSString *)hexDigestOfFileAtPath:(NSString *)path usingAlgorithm:(HLSDigestAlgorithm)algorithm error:(NSError **)pError
+{
+    // Stream the file (range reads would read the whole file for each chunk with the default implementation)
+    NSInputStream *inputStream = [self inputStreamForFileAtPath:path];
+    if (! inputStream) {
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSCocoaErrorDomain 
+                                          code:NSFileReadUnknownError 
+                                      userInfo:[NSDictionary dictionaryWithObject:path forKey:NSFilePathErrorKey]];
+        }
+        return nil;
+    }
+    
+    HLSDigest *digest = [[[HLSDigest alloc] initWithAlgorithm:algorithm] autorelease];
+    uint8_t *buffer = malloc(kDigestChunkLength);
+    if (! buffer) {
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSPOSIXErrorDomain code:ENOMEM userInfo:nil];
+        }
+        return nil;
+    }
+    
+    [inputStream open];
+    NSInteger readLength = 0;
+    while ((readLength = [inputStream read:buffer maxLength:kDigestChunkLength]) > 0) {
+        [digest updateWithBytes:buffer length:readLength];
+    }
+    NSError *streamError = [[[inputStream streamError] retain] autorelease];
+    [inputStream close];
+    free(buffer);
+    
+    if (readLength < 0) {
+        if (pError) {
+            if (! streamError) {
+                streamError = [NSError errorWithDomain:NSCocoaErrorDomain 
+                                                  code:NSFileReadUnknownError 
+                                              userInfo:[NSDictionary dictionaryWithObject:path forKey:NSFilePathErrorKey]];
+            }
+            *pError = streamError;
+        }
+        return nil;
+    }
+    
+    return [digest finalHexDigest];
+}
+
+- (NSArray *)entriesOfDirectoryAtPath:(NSString *)path error:(NSError **)pError
+{
+    NSArray *names = [self contentsOfDirectoryAtPath:path error:pError];
+    if (! names) {
+        return nil;
+    }
+    
+    NSMutableArray *entries = [NSMutableArray arrayWithCapacity:[names count]];
+    for (NSString *name in names) {
+        NSString *itemPath = [path stringByAppendingPathComponent:name];
+        BOOL directory = NO;
+        if (! [self fileExistsAtPath:itemPath isDirectory:&directory]) {
+            continue;
+        }
+        
+        HLSDirectoryEntry *entry = [[[HLSDirectoryEntry alloc] initWithPath:itemPath directory:directory size:0 modificationDate:nil] autorelease];
+        [entries addObject:entry];
+    }
+    return [NSArray arrayWithArray:entries];
+}
+
+#pragma mark Asynchronous operations
+
+- (void)readContentsOfFileAtPath:(NSString *)path completionTarget:(id)target action:(SEL)action
+{
+    HLSFileManagerRequest *request = [[[HLSFileManagerRequest alloc] initWithType:HLSFileManagerRequestTypeRead path:path] autorelease];
+    [request addCompletionTarget:target action:action];
+    [self submitRequest:request];
+}
+
+- (void)writeContents:(NSData *)contents toFileAtPath:(NSString *)path completionTarget:(id)target action:(SEL)action
+{
+    NSData *contentsCopy = [[contents copy] autorelease];
+    
+    // Coalesce with a write to the same path which has not been started yet, if any
+    @synchronized(_pathToPendingWriteRequestMap) {
+        HLSFileManagerRequest *pendingRequest = [_pathToPendingWriteRequestMap objectForKey:path];
+        if (pendingRequest) {
+            pendingRequest.contents = contentsCopy;
+            [pendingRequest addCompletionTarget:target action:action];
+            return;
+        }
+    }
+    
+    HLSFileManagerRequest *request = [[[HLSFileManagerRequest alloc] initWithType:HLSFileManagerRequestTypeWrite path:path] autorelease];
+    request.contents = contentsCopy;
+    [request addCompletionTarget:target action:action];
+    [self submitRequest:request];
+}
+
+- (void)removeItemAtPath:(NSString *)path completionTarget:(id)target action:(SEL)action
+{
+    HLSFileManagerRequest *request = [[[HLSFileManagerRequest alloc] initWithType:HLSFileManagerRequestTypeRemove path:path] autorelease];
+    [request addCompletionTarget:target action:action];
+    [self submitRequest:request];
+}
+
+- (void)waitUntilAsynchronousOperationsAreFinished
+{
+    [_operationQueue waitUntilAllOperationsAreFinished];
+}
+
+- (void)submitRequest:(HLSFileManagerRequest *)request
+{
+    @synchronized(_pathToPendingWriteRequestMap) {
+        // Later writes must not be merged with a write submitted before this request, otherwise this request would
+        // see their result
+        if (request.type == HLSFileManagerRequestTypeWrite) {
+            [_pathToPendingWriteRequestMap setObject:request forKey:request.path];
+        }
+        else {
+            [_pathToPendingWriteRequestMap removeObjectForKey:request.path];
+        }
+        
+        NSInvocationOperation *operation = [[[NSInvocationOperation alloc] initWithTarget:self
+                                                                                 selector:@selector(performRequest:)
+                                                                                   object:request] autorelease];
+        [_operationQueue addOperation:operation];
+    }
+}
+
+// Called on the operation queue thread
+- (void)performRequest:(HLSFileManagerRequest *)request
+{
+    NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+    
+    // From now on, no other write can be merged with this request
+    NSData *contents = nil;
+    @synchronized(_pathToPendingWriteRequestMap) {
+        if ([_pathToPendingWriteRequestMap objectForKey:request.path] == request) {
+            [_pathToPendingWriteRequestMap removeObjectForKey:request.path];
+        }
+        contents = [[request.contents retain] autorelease];
+    }
+    
+    NSError *error = nil;
+    switch (request.type) {
+        case HLSFileManagerRequestTypeRead: {
+            request.result = [self contentsOfFileAtPath:request.path error:&error];
+            break;
+        }
+            
+        case HLSFileManagerRequestTypeWrite: {
+            if ([self createFileAtPath:request.path contents:contents error:&error]) {
+                request.result = request.path;
+            }
+            break;
+        }
+            
+        case HLSFileManagerRequestTypeRemove: {
+            if ([self removeItemAtPath:request.path error:&error]) {
+                request.result = request.path;
+            }
+            break;
+        }
+            
+        default: {
+            HLSLoggerError(@"Unknown request type");
+            break;
+        }
+    }
+    
+    if (! request.result) {
+        request.error = error;
+    }
+    
+    [self performSelectorOnMainThread:@selector(notifyCompletionOfRequest:) withObject:request waitUntilDone:NO];
+    
+    [pool drain];
+}
+
+- (void)notifyCompletionOfRequest:(HLSFileManagerRequest *)request
+{
+    [request callCompletionActions];
+}
+
+@end
+
+@implementation HLSFileManagerRequest
+
+#pragma mark Object creation and destruction
+
+- (id)initWithType:(HLSFileManagerRequestType)type path:(NSString *)path
+{
+    if ((self = [super init])) {
+        _type = type;
+        _path = [path copy];
+        _targets = [[NSMutableArray alloc] init];
+        _actionNames = [[NSMutableArray alloc] init];
+    }
+    return self;
+}
+
+- (id)init
+{
+    HLSForbiddenInheritedMethod();
+    return nil;
+}
+
+- (void)dealloc
+{
+    [_path release];
+    _path = nil;
+    
+    [_targets release];
+    _targets = nil;
+    
+    [_actionNames release];
+    _actionNames = nil;
+    
+    self.contents = nil;
+    self.result = nil;
+    self.error = nil;
+    
+    [super dealloc];
+}
+
+#pragma mark Accessors and mutators
+
+@synthesize type = _type;
+
+@synthesize path = _path;
+
+@synthesize contents = _contents;
+
+@synthesize result = _result;
+
+@synthesize error = _error;
+
+#pragma mark Completion actions
+
+- (void)addCompletionTarget:(id)target action:(SEL)action
+{
+    if (! target || ! action) {
+        return;
+    }
+    
+    [_targets addObject:target];
+    [_actionNames addObject:NSStringFromSelector(action)];
+}
+
+- (void)callCompletionActions
+{
+    for (NSUInteger i = 0; i < [_targets count]; ++i) {
+        id target = [_targets objectAtIndex:i];
+        SEL action = NSSelectorFromString([_actionNames objectAtIndex:i]);
+        [target performSelector:action withObject:self.result withObject:self.error];
+    }
+}
+
 @end
@@ -43,15 +43,70 @@
 
 /**
  * Comparison function for floating point numbers. The parameter maxDist is the maximum distance between two (discrete)
- * numbers so that they can be considered to be equal
+ * numbers so that they can be considered to be equal. Defined inline so that they can be used in tight loops without
+ * any call overhead. For a discussion of float comparison functions, see
+ *   http://www.cygnus-software.com/papers/comparingfloats/comparingfloats.htm
+ *
+ * Values are reinterpreted as integers through a union, which is well-defined with respect to strict aliasing rules
  */
-BOOL floateq_dist(float x, float y, uint32_t maxDist);
-BOOL doubleeq_dist(double x, double y, uint64_t maxDist);
+static inline BOOL floateq_dist(float x, float y, uint32_t maxDist)
+{
+    union { float f; int32_t i; } u_x = { x }, u_y = { y };
+    
+    int32_t i_x = (u_x.i < 0) ? (int32_t)0x80000000L - u_x.i : u_x.i;
+    int32_t i_y = (u_y.i < 0) ? (int32_t)0x80000000L - u_y.i : u_y.i;
+    
+    uint32_t dist = (i_x > i_y) ? (uint32_t)i_x - (uint32_t)i_y : (uint32_t)i_y - (uint32_t)i_x;
+    return dist <= maxDist;
+}
+
+static inline BOOL doubleeq_dist(double x, double y, uint64_t maxDist)
+{
+    union { double d; int64_t i; } u_x = { x }, u_y = { y };
+    
+    int64_t i_x = (u_x.i < 0) ? (int64_t)0x8000000000000000LL - u_x.i : u_x.i;
+    int64_t i_y = (u_y.i < 0) ? (int64_t)0x8000000000000000LL - u_y.i : u_y.i;
+    
+    uint64_t dist = (i_x > i_y) ? (uint64_t)i_x - (uint64_t)i_y : (uint64_t)i_y - (uint64_t)i_x;
+    return dist <= maxDist;
+}
 
 /**
  * Max / min functions (not macros; this would have provided weaker type-checking)
  */
-float floatmin_dist(float x, float y, uint32_t maxDist);
-float floatmax_dist(float x, float y, uint32_t maxDist);
-double doublemin_dist(double x, double y, uint64_t maxDist);
-double doublemax_dist(double x, double y, uint64_t maxDist);
+static inline float floatmin_dist(float x, float y, uint32_t maxDist)
+{
+    return floatlt_dist(x, y, maxDist) ? x : y;
+}
+
+static inline float floatmax_dist(float x, float y, uint32_t maxDist)
+{
+    return floatlt_dist(x, y, maxDist) ? y : x;
+}
+
+static inline double doublemin_dist(double x, double y, uint64_t maxDist)
+{
+    return doublelt_dist(x, y, maxDist) ? x : y;
+}
+
+static inline double doublemax_dist(double x, double y, uint64_t maxDist)
+{
+    return doublelt_dist(x, y, maxDist) ? y : x;
+}
+
+/**
+ * Array versions of floateq_dist / doubleeq_dist, comparing x[i] and y[i] for 0 <= i < n, and storing the result (1 if
+ * equal, 0 otherwise) in out[i]. NEON (devices) and SSE2 (simulator) instructions are used for floats when available,
+ * so that four pairs are compared at once. The arrays do not need to be aligned
+ */
+void floateq_dist_n(const float *x, const float *y, size_t n, uint32_t maxDist, uint8_t *out);
+void doubleeq_dist_n(const double *x, const double *y, size_t n, uint64_t maxDist, uint8_t *out);
+
+/**
+ * Return the smallest, respectively largest value of an array of n > 0 values (which must not contain NaN values).
+ * Vectorized for floats when NEON or SSE instructions are available
+ */
+float floatmin_n(const float *values, size_t n);
+float floatmax_n(const float *values, size_t n);
+double doublemin_n(const double *values, size_t n);
+double doublemax_n(const double *values, size_t n);
@@ -10,64 +10,184 @@
 
 #import "HLSAssert.h"
 
+#if defined(__ARM_NEON__)
+#import <arm_neon.h>
+#elif defined(__SSE2__)
+#import <emmintrin.h>
+#endif
+
 /**
- * For a discussion of float comparison functions, see
- *   http://www.cygnus-software.com/papers/comparingfloats/comparingfloats.htm
- *
- *
- * TODO: Warning: Might be unsafe (maybe safe, I think asserting that the sizes are the same should suffice to make it safe), see:
- *           http://blog.llvm.org/2011/05/what-every-c-programmer-should-know_21.html
- *           http://labs.qt.nokia.com/2011/06/10/type-punning-and-strict-aliasing/
- *           http://cellperformance.beyond3d.com/articles/2006/06/understanding-strict-aliasing.html)
- *
- *       Possible solution:
- *           http://en.wikipedia.org/wiki/Unit_in_the_last_place
+ * The vectorized kernels map each float onto an integer such that consecutive floats are mapped onto consecutive
+ * integers, exactly as floateq_dist does (i < 0 ? 0x80000000 - i : i). For a negative value with magnitude bits m,
+ * 0x80000000 - i = -m, the mapping can therefore be computed without branching as (m ^ s) - s, where s is the sign
+ * mask (0 or -1) obtained by an arithmetic shift. The distance is then the absolute difference of the mapped values,
+ * compared as an unsigned integer
  */
 
-BOOL floateq_dist(float x, float y, uint32_t maxDist)
+#pragma mark Array comparisons
+
+void floateq_dist_n(const float *x, const float *y, size_t n, uint32_t maxDist, uint8_t *out)
 {
     HLSStaticAssert(sizeof(float) == sizeof(uint32_t));
     
-    int32_t i_x = *(int32_t *)&x;
-    i_x = (i_x < 0) ? 0x80000000L - i_x : i_x;
+    size_t i = 0;
     
-    int32_t i_y = *(int32_t *)&y;
-    i_y = (i_y < 0) ? 0x80000000L - i_y : i_y;
+#if defined(__ARM_NEON__)
+    const int32x4_t magnitudeMask = vdupq_n_s32(0x7FFFFFFF);
+    const uint32x4_t maxDistVector = vdupq_n_u32(maxDist);
+    for (; i + 4 <= n; i += 4) {
+        int32x4_t i_x = vreinterpretq_s32_f32(vld1q_f32(x + i));
+        int32x4_t i_y = vreinterpretq_s32_f32(vld1q_f32(y + i));
+        
+        int32x4_t s_x = vshrq_n_s32(i_x, 31);
+        int32x4_t s_y = vshrq_n_s32(i_y, 31);
+        i_x = vsubq_s32(veorq_s32(vandq_s32(i_x, magnitudeMask), s_x), s_x);
+        i_y = vsubq_s32(veorq_s32(vandq_s32(i_y, magnitudeMask), s_y), s_y);
+        
+        uint32x4_t dist = vbslq_u32(vcgtq_s32(i_x, i_y),
+                                    vreinterpretq_u32_s32(vsubq_s32(i_x, i_y)),
+                                    vreinterpretq_u32_s32(vsubq_s32(i_y, i_x)));
+        uint32x4_t equal = vcleq_u32(dist, maxDistVector);
+        
+        // Narrow the 32-bit masks to bytes and keep the lowest bit only
+        uint16x4_t equal16 = vmovn_u32(equal);
+        uint8x8_t equal8 = vmovn_u16(vcombine_u16(equal16, equal16));
+        equal8 = vand_u8(equal8, vdup_n_u8(1));
+        uint32_t packed = vget_lane_u32(vreinterpret_u32_u8(equal8), 0);
+        memcpy(out + i, &packed, 4);
+    }
+#elif defined(__SSE2__)
+    const __m128i magnitudeMask = _mm_set1_epi32(0x7FFFFFFF);
     
-    uint32_t dist = (i_x > i_y) ? i_x - i_y : i_y - i_x;
-    return(dist <= maxDist);
+    // SSE2 only provides signed comparisons. Flipping the sign bit of both operands turns them into unsigned ones
+    const __m128i signBit = _mm_set1_epi32((int32_t)0x80000000);
+    const __m128i maxDistVector = _mm_xor_si128(_mm_set1_epi32((int32_t)maxDist), signBit);
+    for (; i + 4 <= n; i += 4) {
+        __m128i i_x = _mm_castps_si128(_mm_loadu_ps(x + i));
+        __m128i i_y = _mm_castps_si128(_mm_loadu_ps(y + i));
+        
+        __m128i s_x = _mm_srai_epi32(i_x, 31);
+        __m128i s_y = _mm_srai_epi32(i_y, 31);
+        i_x = _mm_sub_epi32(_mm_xor_si128(_mm_and_si128(i_x, magnitudeMask), s_x), s_x);
+        i_y = _mm_sub_epi32(_mm_xor_si128(_mm_and_si128(i_y, magnitudeMask), s_y), s_y);
+        
+        __m128i greater = _mm_cmpgt_epi32(i_x, i_y);
+        __m128i dist = _mm_or_si128(_mm_and_si128(greater, _mm_sub_epi32(i_x, i_y)),
+                                    _mm_andnot_si128(greater, _mm_sub_epi32(i_y, i_x)));
+        
+        // dist <= maxDist <=> ! (dist > maxDist)
+        __m128i notEqual = _mm_cmpgt_epi32(_mm_xor_si128(dist, signBit), maxDistVector);
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(notEqual));
+        out[i] = ! (mask & 0x1);
+        out[i + 1] = ! (mask & 0x2);
+        out[i + 2] = ! (mask & 0x4);
+        out[i + 3] = ! (mask & 0x8);
+    }
+#endif
+    
+    for (; i < n; ++i) {
+        out[i] = floateq_dist(x[i], y[i], maxDist);
+    }
 }
 
-BOOL doubleeq_dist(double x, double y, uint64_t maxDist)
+void doubleeq_dist_n(const double *x, const double *y, size_t n, uint64_t maxDist, uint8_t *out)
 {
-    HLSStaticAssert(sizeof(double) == sizeof(uint64_t));
-    
-    int64_t i_x = *(int64_t *)&x;
-    i_x = (i_x < 0) ? 0x8000000000000000LL - i_x : i_x;
-    
-    int64_t i_y = *(int64_t *)&y;
-    i_y = (i_y < 0) ? 0x8000000000000000LL - i_y : i_y;
-    
-    uint64_t dist = (i_x - i_y) ? i_x - i_y : i_y - i_x;
-    return(dist <= maxDist);
+    // No 64-bit integer comparisons on ARMv7 NEON or SSE2: The scalar (inline) version is used
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = doubleeq_dist(x[i], y[i], maxDist);
+    }
 }
 
-float floatmin_dist(float x, float y, uint32_t maxDist)
+#pragma mark Reductions
+
+float floatmin_n(const float *values, size_t n)
 {
-    return floatlt_dist(x, y, maxDist) ? x : y;
+    NSCAssert(n != 0, @"At least one value is required");
+    
+    float minValue = values[0];
+    size_t i = 0;
+    
+#if defined(__ARM_NEON__)
+    if (n >= 4) {
+        float32x4_t minVector = vld1q_f32(values);
+        for (i = 4; i + 4 <= n; i += 4) {
+            minVector = vminq_f32(minVector, vld1q_f32(values + i));
+        }
+        float32x2_t minPair = vpmin_f32(vget_low_f32(minVector), vget_high_f32(minVector));
+        minPair = vpmin_f32(minPair, minPair);
+        minValue = vget_lane_f32(minPair, 0);
+    }
+#elif defined(__SSE2__)
+    if (n >= 4) {
+        __m128 minVector = _mm_loadu_ps(values);
+        for (i = 4; i + 4 <= n; i += 4) {
+            minVector = _mm_min_ps(minVector, _mm_loadu_ps(values + i));
+        }
+        minVector = _mm_min_ps(minVector, _mm_movehl_ps(minVector, minVector));
+        minVector = _mm_min_ss(minVector, _mm_shuffle_ps(minVector, minVector, 1));
+        minValue = _mm_cvtss_f32(minVector);
+    }
+#endif
+    
+    for (; i < n; ++i) {
+        minValue = MIN(minValue, values[i]);
+    }
+    return minValue;
 }
 
-float floatmax_dist(float x, float y, uint32_t maxDist)
+float floatmax_n(const float *values, size_t n)
 {
-    return floatlt_dist(x, y, maxDist) ? y : x;
+    NSCAssert(n != 0, @"At least one value is required");
+    
+    float maxValue = values[0];
+    size_t i = 0;
+    
+#if defined(__ARM_NEON__)
+    if (n >= 4) {
+        float32x4_t maxVector = vld1q_f32(values);
+        for (i = 4; i + 4 <= n; i += 4) {
+            maxVector = vmaxq_f32(maxVector, vld1q_f32(values + i));
+        }
+        float32x2_t maxPair = vpmax_f32(vget_low_f32(maxVector), vget_high_f32(maxVector));
+        maxPair = vpmax_f32(maxPair, maxPair);
+        maxValue = vget_lane_f32(maxPair, 0);
+    }
+#elif defined(__SSE2__)
+    if (n >= 4) {
+        __m128 maxVector = _mm_loadu_ps(values);
+        for (i = 4; i + 4 <= n; i += 4) {
+            maxVector = _mm_max_ps(maxVector, _mm_loadu_ps(values + i));
+        }
+        maxVector = _mm_max_ps(maxVector, _mm_movehl_ps(maxVector, maxVector));
+        maxVector = _mm_max_ss(maxVector, _mm_shuffle_ps(maxVector, maxVector, 1));
+        maxValue = _mm_cvtss_f32(maxVector);
+    }
+#endif
+    
+    for (; i < n; ++i) {
+        maxValue = MAX(maxValue, values[i]);
+    }
+    return maxValue;
 }
 
-double doublemin_dist(double x, double y, uint64_t maxDist)
+double doublemin_n(const double *values, size_t n)
 {
-    return doublelt_dist(x, y, maxDist) ? x : y;
+    NSCAssert(n != 0, @"At least one value is required");
+    
+    double minValue = values[0];
+    for (size_t i = 1; i < n; ++i) {
+        minValue = MIN(minValue, values[i]);
+    }
+    return minValue;
 }
 
-double doublemax_dist(double x, double y, uint64_t maxDist)
+double doublemax_n(const double *values, size_t n)
 {
-    return doublelt_dist(x, y, maxDist) ? y : x;
+    NSCAssert(n != 0, @"At least one value is required");
+    
+    double maxValue = values[0];
+    for (size_t i = 1; i < n; ++i) {
+        maxValue = MAX(maxValue, values[i]);
+    }
+    return maxValue;
 }
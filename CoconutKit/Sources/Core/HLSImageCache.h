@@ -0,0 +1,66 @@
+//
+//  HLSImageCache.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+/**
+ * A cache for decoded images, bounded by the memory they use. Unlike +[UIImage imageNamed:], whose cache cannot be 
+ * controlled, images are evicted in least recently used order when the cost limit is exceeded, and the cache is 
+ * emptied when the application receives a memory warning. Images are stored with a key chosen by the caller, which
+ * should identify the source of the image as well as the size at which it has been decoded.
+ *
+ * The cost of an image is the size of its bitmap in bytes. The cache is therefore meant to store images which have
+ * already been decoded (see -[UIImage decodedImage] and +[UIImage imageWithContentsOfFile:maximumPixelSize:scale:]),
+ * for which this size is actually used in memory
+ *
+ * This class is not thread-safe and must only be used from the main thread
+ *
+ * Designated initializer: -init
+ */
+@interface HLSImageCache : NSObject {
+@private
+    NSMutableDictionary *_keyToImageMap;
+    NSMutableArray *_keys;                      // Least recently used first
+    NSUInteger _totalCost;
+    NSUInteger _costLimit;
+}
+
+/**
+ * The cache shared by all CoconutKit components
+ */
++ (HLSImageCache *)sharedImageCache;
+
+/**
+ * The maximum number of bytes used by the images stored in the cache. Setting a smaller value immediately evicts
+ * images in excess
+ *
+ * Default value is 20 MB
+ */
+@property (nonatomic, assign) NSUInteger costLimit;
+
+/**
+ * The number of bytes currently used by the images stored in the cache
+ */
+@property (nonatomic, readonly, assign) NSUInteger totalCost;
+
+/**
+ * Return the image stored for a given key, nil if none. The image is marked as most recently used
+ */
+- (UIImage *)imageForKey:(NSString *)key;
+
+/**
+ * Store an image for a given key, replacing any existing image. Least recently used images are evicted if needed.
+ * Images whose cost exceeds the cost limit are not stored
+ */
+- (void)setImage:(UIImage *)image forKey:(NSString *)key;
+
+/**
+ * Remove a single image, or all images from the cache
+ */
+- (void)removeImageForKey:(NSString *)key;
+- (void)removeAllImages;
+
+@end
@@ -0,0 +1,178 @@
+//
+//  HLSImageCache.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSImageCache.h"
+
+#import "HLSLogger.h"
+
+static const NSUInteger kImageCacheDefaultCostLimit = 20 * 1024 * 1024;
+
+static NSUInteger costForImage(UIImage *image);
+
+@interface HLSImageCache ()
+
+@property (nonatomic, retain) NSMutableDictionary *keyToImageMap;
+@property (nonatomic, retain) NSMutableArray *keys;
+
+- (void)evictImagesToCost:(NSUInteger)cost;
+
+- (void)applicationDidReceiveMemoryWarning:(NSNotification *)notification;
+
+@end
+
+@implementation HLSImageCache
+
+#pragma mark Class methods
+
++ (HLSImageCache *)sharedImageCache
+{
+    static HLSImageCache *s_instance = nil;
+    if (! s_instance) {
+        s_instance = [[HLSImageCache alloc] init];
+    }
+    return s_instance;
+}
+
+#pragma mark Object creation and destruction
+
+- (id)init
+{
+    if ((self = [super init])) {
+        self.keyToImageMap = [NSMutableDictionary dictionary];
+        self.keys = [NSMutableArray array];
+        _costLimit = kImageCacheDefaultCostLimit;
+        
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(applicationDidReceiveMemoryWarning:)
+                                                     name:UIApplicationDidReceiveMemoryWarningNotification
+                                                   object:nil];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [[NSNotificationCenter defaultCenter] removeObserver:self
+                                                    name:UIApplicationDidReceiveMemoryWarningNotification
+                                                  object:nil];
+    
+    self.keyToImageMap = nil;
+    self.keys = nil;
+    
+    [super dealloc];
+}
+
+#pragma mark Accessors and mutators
+
+@synthesize keyToImageMap = _keyToImageMap;
+
+@synthesize keys = _keys;
+
+@synthesize totalCost = _totalCost;
+
+@synthesize costLimit = _costLimit;
+
+- (void)setCostLimit:(NSUInteger)costLimit
+{
+    _costLimit = costLimit;
+    
+    [self evictImagesToCost:costLimit];
+}
+
+#pragma mark Image management
+
+- (UIImage *)imageForKey:(NSString *)key
+{
+    UIImage *image = [self.keyToImageMap objectForKey:key];
+    if (! image) {
+        return nil;
+    }
+    
+    // Most recently used last
+    [[key retain] autorelease];
+    [self.keys removeObject:key];
+    [self.keys addObject:key];
+    
+    return image;
+}
+
+- (void)setImage:(UIImage *)image forKey:(NSString *)key
+{
+    if (! key) {
+        HLSLoggerError(@"Missing key");
+        return;
+    }
+    
+    [self removeImageForKey:key];
+    
+    if (! image) {
+        return;
+    }
+    
+    NSUInteger cost = costForImage(image);
+    if (cost > self.costLimit) {
+        HLSLoggerDebug(@"The image for key %@ is too large to be cached (%u bytes)", key, cost);
+        return;
+    }
+    
+    [self evictImagesToCost:self.costLimit - cost];
+    
+    [self.keyToImageMap setObject:image forKey:key];
+    [self.keys addObject:key];
+    _totalCost += cost;
+}
+
+- (void)removeImageForKey:(NSString *)key
+{
+    UIImage *image = [self.keyToImageMap objectForKey:key];
+    if (! image) {
+        return;
+    }
+    
+    _totalCost -= costForImage(image);
+    [[key retain] autorelease];
+    [self.keyToImageMap removeObjectForKey:key];
+    [self.keys removeObject:key];
+}
+
+- (void)removeAllImages
+{
+    [self.keyToImageMap removeAllObjects];
+    [self.keys removeAllObjects];
+    _totalCost = 0;
+}
+
+// Evict least recently used images until the total cost does not exceed the specified cost
+- (void)evictImagesToCost:(NSUInteger)cost
+{
+    while (_totalCost > cost && [self.keys count] != 0) {
+        [self removeImageForKey:[self.keys objectAtIndex:0]];
+    }
+}
+
+#pragma mark Notification callbacks
+
+- (void)applicationDidReceiveMemoryWarning:(NSNotification *)notification
+{
+    HLSLoggerInfo(@"Memory warning received. Releasing %d cached images (%u bytes)", [self.keys count], _totalCost);
+    
+    [self removeAllImages];
+}
+
+@end
+
+#pragma mark Static functions
+
+static NSUInteger costForImage(UIImage *image)
+{
+    CGImageRef imageRef = image.CGImage;
+    if (! imageRef) {
+        return 0;
+    }
+    return CGImageGetBytesPerRow(imageRef) * CGImageGetHeight(imageRef);
+}
@@ -0,0 +1,41 @@
+//
+//  HLSInMemoryFileManager.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSFileManager.h"
+
+/**
+ * A file manager storing its whole hierarchy in memory. Nothing is ever written to disk, which makes it well suited 
+ * for scratch storage and for tests. The storage is lost when the file manager is deallocated.
+ *
+ * Copying a file does not duplicate its content, which is shared until one of the copies is modified. An optional 
+ * size limit can be set, in which case operations which would make the total size of the files exceed it fail with
+ * an NSFileWriteOutOfSpaceError error. The size counts the bytes of each file, whether they are shared or not
+ *
+ * Streaming writes are not supported (-outputStreamToFileAtPath:append: returns nil)
+ *
+ * Designated initializer: -init
+ */
+@interface HLSInMemoryFileManager : HLSFileManager {
+@private
+    NSMutableDictionary *_rootDirectory;
+    unsigned long long _size;
+    unsigned long long _sizeLimit;
+}
+
+/**
+ * Maximum total size of the files (in bytes). Default is 0 (no limit). Setting a limit lower than the current size
+ * does not remove any file, but prevents further writes until enough space is freed
+ */
+@property (nonatomic, assign) unsigned long long sizeLimit;
+
+/**
+ * Total size of the files currently stored (in bytes)
+ */
+@property (nonatomic, readonly, assign) unsigned long long size;
+
+@end
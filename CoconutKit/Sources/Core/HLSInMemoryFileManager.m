@@ -0,0 +1,449 @@
+//
+//  HLSInMemoryFileManager.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSInMemoryFileManager.h"
+
+// Directories are mutable dictionaries mapping names to child items, files are immutable NSData objects
+@interface HLSInMemoryFileManager ()
+
+- (NSArray *)componentsOfPath:(NSString *)path;
+- (id)itemAtPath:(NSString *)path;
+- (NSMutableDictionary *)parentDirectoryForPath:(NSString *)path error:(NSError **)pError;
+- (BOOL)reserveSize:(unsigned long long)size forPath:(NSString *)path error:(NSError **)pError;
+
+@end
+
+// Function declarations
+static unsigned long long sizeOfItem(id item);
+static id copyOfItem(id item);
+static NSError *fileErrorWithCode(NSInteger code, NSString *path);
+
+@implementation HLSInMemoryFileManager
+
+#pragma mark Object creation and destruction
+
+- (id)init
+{
+    if ((self = [super init])) {
+        _rootDirectory = [[NSMutableDictionary alloc] init];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [_rootDirectory release];
+    _rootDirectory = nil;
+    
+    [super dealloc];
+}
+
+#pragma mark Accessors and mutators
+
+@synthesize sizeLimit = _sizeLimit;
+
+- (unsigned long long)sizeLimit
+{
+    @synchronized(self) {
+        return _sizeLimit;
+    }
+}
+
+- (void)setSizeLimit:(unsigned long long)sizeLimit
+{
+    @synchronized(self) {
+        _sizeLimit = sizeLimit;
+    }
+}
+
+@synthesize size = _size;
+
+- (unsigned long long)size
+{
+    @synchronized(self) {
+        return _size;
+    }
+}
+
+#pragma mark HLSFileManagerAbstract protocol implementation
+
+- (NSData *)contentsOfFileAtPath:(NSString *)path error:(NSError **)pError
+{
+    @synchronized(self) {
+        id item = [self itemAtPath:path];
+        if (! [item isKindOfClass:[NSData class]]) {
+            if (pError) {
+                *pError = fileErrorWithCode(NSFileReadNoSuchFileError, path);
+            }
+            return nil;
+        }
+        
+        // Immutable, but might be replaced (and released) by a concurrent write as soon as the lock is released
+        return [[item retain] autorelease];
+    }
+}
+
+- (NSData *)contentsOfFileAtPath:(NSString *)path range:(NSRange)range error:(NSError **)pError
+{
+    NSData *contents = [self contentsOfFileAtPath:path error:pError];
+    if (! contents) {
+        return nil;
+    }
+    
+    if (range.location >= [contents length]) {
+        return [NSData data];
+    }
+    
+    NSUInteger length = MIN(range.length, [contents length] - range.location);
+    return [contents subdataWithRange:NSMakeRange(range.location, length)];
+}
+
+- (BOOL)createFileAtPath:(NSString *)path contents:(NSData *)contents error:(NSError **)pError
+{
+    @synchronized(self) {
+        NSMutableDictionary *parentDirectory = [self parentDirectoryForPath:path error:pError];
+        if (! parentDirectory) {
+            return NO;
+        }
+        
+        NSString *name = [[self componentsOfPath:path] lastObject];
+        id existingItem = [parentDirectory objectForKey:name];
+        if ([existingItem isKindOfClass:[NSDictionary class]]) {
+            if (pError) {
+                *pError = fileErrorWithCode(NSFileWriteFileExistsError, path);
+            }
+            return NO;
+        }
+        
+        // Immutable copy: If contents is immutable already, this is only a retain (content is shared)
+        NSData *newContents = contents ? [[contents copy] autorelease] : [NSData data];
+        unsigned long long existingSize = [existingItem length];
+        if ([newContents length] > existingSize && ! [self reserveSize:[newContents length] - existingSize forPath:path error:pError]) {
+            return NO;
+        }
+        
+        _size = _size - existingSize + [newContents length];
+        [parentDirectory setObject:newContents forKey:name];
+        return YES;
+    }
+}
+
+- (BOOL)appendContents:(NSData *)contents toFileAtPath:(NSString *)path error:(NSError **)pError
+{
+    @synchronized(self) {
+        NSData *existingContents = [self itemAtPath:path];
+        if (! existingContents) {
+            return [self createFileAtPath:path contents:contents error:pError];
+        }
+        
+        if (! [existingContents isKindOfClass:[NSData class]]) {
+            if (pError) {
+                *pError = fileErrorWithCode(NSFileWriteFileExistsError, path);
+            }
+            return NO;
+        }
+        
+        // The existing content might be shared with copies, and is therefore never modified in place
+        NSMutableData *allContents = [NSMutableData dataWithCapacity:[existingContents length] + [contents length]];
+        [allContents appendData:existingContents];
+        [allContents appendData:contents];
+        return [self createFileAtPath:path contents:allContents error:pError];
+    }
+}
+
+- (BOOL)createDirectoryAtPath:(NSString *)path withIntermediateDirectories:(BOOL)withIntermediateDirectories error:(NSError **)pError
+{
+    @synchronized(self) {
+        NSArray *components = [self componentsOfPath:path];
+        NSMutableDictionary *directory = _rootDirectory;
+        for (NSUInteger i = 0; i < [components count]; ++i) {
+            NSString *component = [components objectAtIndex:i];
+            BOOL last = (i == [components count] - 1);
+            id item = [directory objectForKey:component];
+            if (! item) {
+                if (! last && ! withIntermediateDirectories) {
+                    if (pError) {
+                        *pError = fileErrorWithCode(NSFileNoSuchFileError, path);
+                    }
+                    return NO;
+                }
+                
+                item = [NSMutableDictionary dictionary];
+                [directory setObject:item forKey:component];
+            }
+            else if (! [item isKindOfClass:[NSDictionary class]] || (last && ! withIntermediateDirectories)) {
+                if (pError) {
+                    *pError = fileErrorWithCode(NSFileWriteFileExistsError, path);
+                }
+                return NO;
+            }
+            directory = item;
+        }
+        return YES;
+    }
+}
+
+- (NSArray *)contentsOfDirectoryAtPath:(NSString *)path error:(NSError **)pError
+{
+    @synchronized(self) {
+        id item = [self itemAtPath:path];
+        if (! [item isKindOfClass:[NSDictionary class]]) {
+            if (pError) {
+                *pError = fileErrorWithCode(NSFileReadNoSuchFileError, path);
+            }
+            return nil;
+        }
+        return [item allKeys];
+    }
+}
+
+- (NSArray *)entriesOfDirectoryAtPath:(NSString *)path error:(NSError **)pError
+{
+    @synchronized(self) {
+        id item = [self itemAtPath:path];
+        if (! [item isKindOfClass:[NSDictionary class]]) {
+            if (pError) {
+                *pError = fileErrorWithCode(NSFileReadNoSuchFileError, path);
+            }
+            return nil;
+        }
+        
+        // Modification dates are not tracked
+        NSMutableArray *entries = [NSMutableArray arrayWithCapacity:[item count]];
+        for (NSString *name in [item allKeys]) {
+            id childItem = [item objectForKey:name];
+            BOOL directory = [childItem isKindOfClass:[NSDictionary class]];
+            HLSDirectoryEntry *entry = [[[HLSDirectoryEntry alloc] initWithPath:[path stringByAppendingPathComponent:name]
+                                                                      directory:directory
+                                                                           size:directory ? 0 : [childItem length]
+                                                               modificationDate:nil] autorelease];
+            [entries addObject:entry];
+        }
+        return [NSArray arrayWithArray:entries];
+    }
+}
+
+- (BOOL)fileExistsAtPath:(NSString *)path isDirectory:(BOOL *)pIsDirectory
+{
+    @synchronized(self) {
+        id item = [self itemAtPath:path];
+        if (pIsDirectory) {
+            *pIsDirectory = [item isKindOfClass:[NSDictionary class]];
+        }
+        return item != nil;
+    }
+}
+
+- (BOOL)copyItemAtPath:(NSString *)sourcePath toPath:(NSString *)destinationPath error:(NSError **)pError
+{
+    @synchronized(self) {
+        id item = [self itemAtPath:sourcePath];
+        if (! item) {
+            if (pError) {
+                *pError = fileErrorWithCode(NSFileNoSuchFileError, sourcePath);
+            }
+            return NO;
+        }
+        
+        if ([self itemAtPath:destinationPath]) {
+            if (pError) {
+                *pError = fileErrorWithCode(NSFileWriteFileExistsError, destinationPath);
+            }
+            return NO;
+        }
+        
+        NSMutableDictionary *destinationParentDirectory = [self parentDirectoryForPath:destinationPath error:pError];
+        if (! destinationParentDirectory) {
+            return NO;
+        }
+        
+        unsigned long long itemSize = sizeOfItem(item);
+        if (! [self reserveSize:itemSize forPath:destinationPath error:pError]) {
+            return NO;
+        }
+        
+        // File contents are shared, only the directory structure is duplicated
+        id itemCopy = copyOfItem(item);
+        [destinationParentDirectory setObject:itemCopy forKey:[[self componentsOfPath:destinationPath] lastObject]];
+        [itemCopy release];
+        _size += itemSize;
+        return YES;
+    }
+}
+
+- (BOOL)moveItemAtPath:(NSString *)sourcePath toPath:(NSString *)destinationPath error:(NSError **)pError
+{
+    @synchronized(self) {
+        NSArray *sourceComponents = [self componentsOfPath:sourcePath];
+        NSArray *destinationComponents = [self componentsOfPath:destinationPath];
+        id item = [self itemAtPath:sourcePath];
+        if (! item || [sourceComponents count] == 0) {
+            if (pError) {
+                *pError = fileErrorWithCode(NSFileNoSuchFileError, sourcePath);
+            }
+            return NO;
+        }
+        
+        if ([self itemAtPath:destinationPath]) {
+            if (pError) {
+                *pError = fileErrorWithCode(NSFileWriteFileExistsError, destinationPath);
+            }
+            return NO;
+        }
+        
+        // A directory cannot be moved into itself
+        if ([destinationComponents count] > [sourceComponents count]
+                && [[destinationComponents subarrayWithRange:NSMakeRange(0, [sourceComponents count])] isEqualToArray:sourceComponents]) {
+            if (pError) {
+                *pError = fileErrorWithCode(NSFileWriteInvalidFileNameError, destinationPath);
+            }
+            return NO;
+        }
+        
+        NSMutableDictionary *destinationParentDirectory = [self parentDirectoryForPath:destinationPath error:pError];
+        if (! destinationParentDirectory) {
+            return NO;
+        }
+        
+        NSMutableDictionary *sourceParentDirectory = [self parentDirectoryForPath:sourcePath error:NULL];
+        [item retain];
+        [sourceParentDirectory removeObjectForKey:[sourceComponents lastObject]];
+        [destinationParentDirectory setObject:item forKey:[destinationComponents lastObject]];
+        [item release];
+        return YES;
+    }
+}
+
+- (BOOL)removeItemAtPath:(NSString *)path error:(NSError **)pError
+{
+    @synchronized(self) {
+        NSArray *components = [self componentsOfPath:path];
+        id item = [self itemAtPath:path];
+        if (! item || [components count] == 0) {
+            if (pError) {
+                *pError = fileErrorWithCode(NSFileNoSuchFileError, path);
+            }
+            return NO;
+        }
+        
+        _size -= sizeOfItem(item);
+        [[self parentDirectoryForPath:path error:NULL] removeObjectForKey:[components lastObject]];
+        return YES;
+    }
+}
+
+#pragma mark Path resolution (must be called with the lock held)
+
+- (NSArray *)componentsOfPath:(NSString *)path
+{
+    NSMutableArray *components = [NSMutableArray array];
+    for (NSString *component in [path pathComponents]) {
+        if ([component isEqualToString:@"/"] || [component isEqualToString:@"."] || [component length] == 0) {
+            continue;
+        }
+        [components addObject:component];
+    }
+    return components;
+}
+
+- (id)itemAtPath:(NSString *)path
+{
+    id item = _rootDirectory;
+    for (NSString *component in [self componentsOfPath:path]) {
+        if (! [item isKindOfClass:[NSDictionary class]]) {
+            return nil;
+        }
+        item = [item objectForKey:component];
+    }
+    return item;
+}
+
+- (NSMutableDictionary *)parentDirectoryForPath:(NSString *)path error:(NSError **)pError
+{
+    NSArray *components = [self componentsOfPath:path];
+    if ([components count] == 0) {
+        if (pError) {
+            *pError = fileErrorWithCode(NSFileWriteInvalidFileNameError, path);
+        }
+        return nil;
+    }
+    
+    id parentItem = _rootDirectory;
+    for (NSString *component in [components subarrayWithRange:NSMakeRange(0, [components count] - 1)]) {
+        parentItem = [parentItem objectForKey:component];
+        if (! [parentItem isKindOfClass:[NSDictionary class]]) {
+            if (pError) {
+                *pError = fileErrorWithCode(NSFileNoSuchFileError, path);
+            }
+            return nil;
+        }
+    }
+    return parentItem;
+}
+
+- (BOOL)reserveSize:(unsigned long long)size forPath:(NSString *)path error:(NSError **)pError
+{
+    if (_sizeLimit != 0 && _size + size > _sizeLimit) {
+        if (pError) {
+            *pError = fileErrorWithCode(NSFileWriteOutOfSpaceError, path);
+        }
+        return NO;
+    }
+    return YES;
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; size: %llu; sizeLimit: %llu>",
+            [self class],
+            self,
+            self.size,
+            self.sizeLimit];
+}
+
+@end
+
+#pragma mark Static functions
+
+static unsigned long long sizeOfItem(id item)
+{
+    if ([item isKindOfClass:[NSData class]]) {
+        return [item length];
+    }
+    
+    unsigned long long size = 0;
+    for (id childItem in [item allValues]) {
+        size += sizeOfItem(childItem);
+    }
+    return size;
+}
+
+// Return a retained copy. Files are immutable and shared
+static id copyOfItem(id item)
+{
+    if ([item isKindOfClass:[NSData class]]) {
+        return [item retain];
+    }
+    
+    NSMutableDictionary *directoryCopy = [[NSMutableDictionary alloc] initWithCapacity:[item count]];
+    for (NSString *name in [item allKeys]) {
+        id childItemCopy = copyOfItem([item objectForKey:name]);
+        [directoryCopy setObject:childItemCopy forKey:name];
+        [childItemCopy release];
+    }
+    return directoryCopy;
+}
+
+static NSError *fileErrorWithCode(NSInteger code, NSString *path)
+{
+    return [NSError errorWithDomain:NSCocoaErrorDomain 
+                               code:code 
+                           userInfo:[NSDictionary dictionaryWithObject:path forKey:NSFilePathErrorKey]];
+}
@@ -0,0 +1,37 @@
+//
+//  HLSLaunchTrace.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+/**
+ * CoconutKit performs some work before main is called (method swizzling in +load methods, constructor functions).
+ * To measure the time spent in these hooks, set the HLSLaunchTrace environment variable to YES (e.g. in the scheme
+ * of your application). The wall time of each hook is then recorded and logged once the application has finished 
+ * launching, together with the total time spent.
+ *
+ * The functions below can be called at any time, even before main is called (they do not rely on Objective-C objects
+ * while recording). They are not meant to be called from several threads simultaneously, which is not an issue since 
+ * hooks are executed on the main thread
+ */
+
+/**
+ * Return YES iff launch tracing has been enabled (HLSLaunchTrace environment variable set to YES)
+ */
+BOOL HLSLaunchTraceEnabled(void);
+
+/**
+ * Record the time elapsed since startTime (obtained using CFAbsoluteTimeGetCurrent()) for the hook with the given 
+ * name and optional detail. Both strings are not copied and must therefore be constant strings or strings whose
+ * lifetime spans the whole application lifetime (e.g. class or selector names returned by the Objective-C runtime).
+ * Does nothing if launch tracing is not enabled
+ */
+void HLSLaunchTraceRecord(const char *name, const char *detail, CFAbsoluteTime startTime);
+
+/**
+ * Log all entries recorded so far. Automatically called when the application has finished launching. Does nothing
+ * if launch tracing is not enabled
+ */
+void HLSLaunchTraceLog(void);
@@ -0,0 +1,97 @@
+//
+//  HLSLaunchTrace.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSLaunchTrace.h"
+
+typedef struct {
+    const char *name;
+    const char *detail;
+    CFTimeInterval duration;
+} HLSLaunchTraceEntry;
+
+static HLSLaunchTraceEntry *s_entries = NULL;
+static NSUInteger s_numberOfEntries = 0;
+static NSUInteger s_capacity = 0;
+
+// Receives the notification sent when launch is complete
+@interface HLSLaunchTraceObserver : NSObject
+
++ (void)applicationDidFinishLaunching:(NSNotification *)notification;
+
+@end
+
+BOOL HLSLaunchTraceEnabled(void)
+{
+    static int s_enabled = -1;
+    if (s_enabled == -1) {
+        // Hooks might be executed before main, when no autorelease pool is available yet
+        const char *value = getenv("HLSLaunchTrace");
+        s_enabled = (value && strcmp(value, "YES") == 0) ? 1 : 0;
+        
+        // Log when launch is complete
+        if (s_enabled) {
+            NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+            [[NSNotificationCenter defaultCenter] addObserver:[HLSLaunchTraceObserver class]
+                                                     selector:@selector(applicationDidFinishLaunching:) 
+                                                         name:UIApplicationDidFinishLaunchingNotification 
+                                                       object:nil];
+            [pool drain];
+        }
+    }
+    return s_enabled == 1;
+}
+
+void HLSLaunchTraceRecord(const char *name, const char *detail, CFAbsoluteTime startTime)
+{
+    if (! HLSLaunchTraceEnabled()) {
+        return;
+    }
+    
+    CFTimeInterval duration = CFAbsoluteTimeGetCurrent() - startTime;
+    
+    if (s_numberOfEntries == s_capacity) {
+        s_capacity = s_capacity ? 2 * s_capacity : 64;
+        s_entries = realloc(s_entries, s_capacity * sizeof(HLSLaunchTraceEntry));
+    }
+    
+    HLSLaunchTraceEntry *entry = &s_entries[s_numberOfEntries];
+    entry->name = name;
+    entry->detail = detail;
+    entry->duration = duration;
+    ++s_numberOfEntries;
+}
+
+void HLSLaunchTraceLog(void)
+{
+    if (! HLSLaunchTraceEnabled()) {
+        return;
+    }
+    
+    // Opt-in diagnostic information: Always logged, whatever the logger level
+    NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+    CFTimeInterval totalDuration = 0.;
+    for (NSUInteger i = 0; i < s_numberOfEntries; ++i) {
+        HLSLaunchTraceEntry *entry = &s_entries[i];
+        NSLog(@"[LAUNCH] %s%s%s: %.3f ms", entry->name, entry->detail ? " " : "", entry->detail ?: "", entry->duration * 1000.);
+        totalDuration += entry->duration;
+    }
+    NSLog(@"[LAUNCH] %u hooks, total: %.3f ms", s_numberOfEntries, totalDuration * 1000.);
+    [pool drain];
+}
+
+@implementation HLSLaunchTraceObserver
+
+#pragma mark Notification callbacks
+
++ (void)applicationDidFinishLaunching:(NSNotification *)notification
+{
+    HLSLaunchTraceLog();
+    [[NSNotificationCenter defaultCenter] removeObserver:self name:UIApplicationDidFinishLaunchingNotification object:nil];
+}
+
+@end
@@ -0,0 +1,38 @@
+//
+//  HLSLayeredFileManager.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSFileManager.h"
+
+/**
+ * A file manager stacked on top of another one (the underlying file manager), to which it forwards all operations. 
+ * This class does not alter anything by itself and is meant to be subclassed to transform file contents on the fly 
+ * (e.g. for compression or encryption). The structure of the storage (directories, file names) is never altered.
+ *
+ * Subclasses must at least override -contentsOfFileAtPath:error:, -createFileAtPath:contents:error: and, if they
+ * can do better than the default HLSFileManager implementation, -contentsOfFileAtPath:range:error:, 
+ * -inputStreamForFileAtPath: and -appendContents:toFileAtPath:error:. By default, streaming writes are not supported 
+ * by layers. Layers can be stacked, the outermost one being the first to transform the contents which are written
+ *
+ * Designated initializer: -initWithFileManager:
+ */
+@interface HLSLayeredFileManager : HLSFileManager {
+@private
+    HLSFileManager *_fileManager;
+}
+
+/**
+ * Create a layer on top of the given file manager
+ */
+- (id)initWithFileManager:(HLSFileManager *)fileManager;
+
+/**
+ * The underlying file manager
+ */
+@property (nonatomic, readonly, retain) HLSFileManager *fileManager;
+
+@end
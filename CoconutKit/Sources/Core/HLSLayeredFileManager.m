@@ -0,0 +1,107 @@
+//
+//  HLSLayeredFileManager.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSLayeredFileManager.h"
+
+#import "HLSAssert.h"
+#import "HLSLogger.h"
+
+@implementation HLSLayeredFileManager
+
+#pragma mark Object creation and destruction
+
+- (id)initWithFileManager:(HLSFileManager *)fileManager
+{
+    if ((self = [super init])) {
+        if (! fileManager) {
+            HLSLoggerError(@"Missing underlying file manager");
+            [self release];
+            return nil;
+        }
+        
+        _fileManager = [fileManager retain];
+    }
+    return self;
+}
+
+- (id)init
+{
+    HLSForbiddenInheritedMethod();
+    return nil;
+}
+
+- (void)dealloc
+{
+    [_fileManager release];
+    _fileManager = nil;
+    
+    [super dealloc];
+}
+
+#pragma mark Accessors and mutators
+
+@synthesize fileManager = _fileManager;
+
+#pragma mark HLSFileManagerAbstract protocol implementation
+
+- (NSData *)contentsOfFileAtPath:(NSString *)path error:(NSError **)pError
+{
+    return [self.fileManager contentsOfFileAtPath:path error:pError];
+}
+
+- (BOOL)createFileAtPath:(NSString *)path contents:(NSData *)contents error:(NSError **)pError
+{
+    return [self.fileManager createFileAtPath:path contents:contents error:pError];
+}
+
+- (BOOL)createDirectoryAtPath:(NSString *)path withIntermediateDirectories:(BOOL)withIntermediateDirectories error:(NSError **)pError
+{
+    return [self.fileManager createDirectoryAtPath:path withIntermediateDirectories:withIntermediateDirectories error:pError];
+}
+
+- (NSArray *)contentsOfDirectoryAtPath:(NSString *)path error:(NSError **)pError
+{
+    return [self.fileManager contentsOfDirectoryAtPath:path error:pError];
+}
+
+- (NSArray *)entriesOfDirectoryAtPath:(NSString *)path error:(NSError **)pError
+{
+    return [self.fileManager entriesOfDirectoryAtPath:path error:pError];
+}
+
+- (BOOL)fileExistsAtPath:(NSString *)path isDirectory:(BOOL *)pIsDirectory
+{
+    return [self.fileManager fileExistsAtPath:path isDirectory:pIsDirectory];
+}
+
+- (BOOL)copyItemAtPath:(NSString *)sourcePath toPath:(NSString *)destinationPath error:(NSError **)pError
+{
+    return [self.fileManager copyItemAtPath:sourcePath toPath:destinationPath error:pError];
+}
+
+- (BOOL)moveItemAtPath:(NSString *)sourcePath toPath:(NSString *)destinationPath error:(NSError **)pError
+{
+    return [self.fileManager moveItemAtPath:sourcePath toPath:destinationPath error:pError];
+}
+
+- (BOOL)removeItemAtPath:(NSString *)path error:(NSError **)pError
+{
+    return [self.fileManager removeItemAtPath:path error:pError];
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; fileManager: %@>",
+            [self class],
+            self,
+            self.fileManager];
+}
+
+@end
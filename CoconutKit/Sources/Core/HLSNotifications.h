@@ -24,13 +24,17 @@
 /**
  * Manages application-wide notification mechanisms
  *
- * This class is not thread-safe
+ * Network activity notification methods can be called from any thread. Other methods must be called from the main
+ * thread
  *
  * Designated initializer: -init
  */
 @interface HLSNotificationManager : NSObject {
 @private
-    NSUInteger m_networkActivityCount;
+    volatile int32_t m_networkActivityCount;
+    NSTimeInterval m_networkActivityIndicatorShowDelay;
+    NSTimeInterval m_networkActivityIndicatorHideDelay;
+    BOOL m_networkActivityIndicatorVisible;
 }
 
 /**
@@ -52,6 +56,14 @@
  */
 - (void)notifyEndNetworkActivity;
 
+/**
+ * To avoid flickering when many short network tasks are run, the activity indicator is only displayed if network
+ * activity lasts longer than the show delay, and is only hidden if no network activity has been started during the
+ * hide delay. Default values are 0.1 and 0.3 seconds. Set both to 0 to update the indicator immediately
+ */
+@property (nonatomic, assign) NSTimeInterval networkActivityIndicatorShowDelay;
+@property (nonatomic, assign) NSTimeInterval networkActivityIndicatorHideDelay;
+
 @end
 
 /**
@@ -60,16 +72,24 @@
  * such conversion code can be tedious and error prone. The HLSNotificationConverter singleton provides a convenient
  * way to define conversions with very litte code.
  *
+ * The converter observes each notification name only once, whatever the number of objects it converts notifications
+ * for, and finds the rule to apply with a hash table lookup. The cost of converting a notification therefore does not 
+ * depend on the number of conversion rules.
+ *
  * Designated initializer: -init
  */
 @interface HLSNotificationConverter : NSObject {
 @private
     // To be able to add conversion rules for an (object, notification name), and to be able to remove all rules defined
     // for an object, we introduce two dictionary levels:
-    //   - 1st dictionary: maps objects to a notification map
+    //   - 1st dictionary: maps objects (by address, not retained) to a notification map
     //   - 2nd dictionary (notification map): maps notification name to the (object, notification name) pair to
     //                                        convert to
-    NSMutableDictionary *m_objectToNotificationMap;
+    CFMutableDictionaryRef m_objectToNotificationMap;
+    
+    // A single observer is registered per notification name, as long as at least one rule exists for it. The set
+    // counts the rules for each name
+    NSCountedSet *m_notificationNames;
 }
 
 + (HLSNotificationConverter *)sharedNotificationConverter;
@@ -115,14 +135,95 @@
  */
 @interface NSObject (HLSNotificationExtensions)
 
+/**
+ * Post a notification sent by the receiver using the default notification queue, coalescing it with notifications
+ * having the same name and sender which are already in the queue. The notification is posted immediately (NSPostNow),
+ * which means that it can only be coalesced with notifications which have been enqueued with a deferred posting
+ * style
+ */
 - (void)postCoalescingNotificationWithName:(NSString *)name userInfo:(NSDictionary *)userInfo;
 - (void)postCoalescingNotificationWithName:(NSString *)name;
 
+/**
+ * Same as -postCoalescingNotificationWithName:userInfo:, but with the specified posting style. With NSPostASAP or 
+ * NSPostWhenIdle, all notifications with the same name and sender enqueued before the current run loop iteration 
+ * ends are coalesced into the first one (the userInfo of the other ones is lost)
+ */
+- (void)postCoalescingNotificationWithName:(NSString *)name userInfo:(NSDictionary *)userInfo postingStyle:(NSPostingStyle)postingStyle;
+
+/**
+ * Post a notification sent by the receiver after the specified interval has elapsed. All notifications with the same
+ * name and sender posted in the meantime are merged into this one, their userInfo dictionaries being merged as well
+ * (for identical keys, the most recent value is kept). At most one notification is therefore posted per interval
+ * (e.g. use 1. / 60. to trigger at most one UI refresh per frame). The receiver is retained until the notification 
+ * has been posted, and the notification is delivered on the run loop of the calling thread, in all common modes.
+ *
+ * Must be called from the main thread
+ */
+- (void)postCoalescingNotificationWithName:(NSString *)name userInfo:(NSDictionary *)userInfo coalescingInterval:(NSTimeInterval)interval;
+
+@end
+
+/**
+ * Observation of a notification sent by any object belonging to a set of objects, created using 
+ * -[NSNotificationCenter addObserver:selector:name:objectsInCollectionObservation:]. Only one observer is registered
+ * with the notification center, whatever the number of objects, and checking whether a notification must be 
+ * forwarded is a single hash table lookup. Objects are compared by address and are not retained, neither is the 
+ * observer.
+ *
+ * An observation stays active until it is invalidated or deallocated, and must therefore be retained by its
+ * creator. The observer must invalidate it before being deallocated
+ *
+ * Designated initializer: -initWithNotificationCenter:observer:selector:name:objectsInCollection:
+ */
+@interface HLSCollectionObservation : NSObject {
+@private
+    NSNotificationCenter *m_notificationCenter;
+    id m_observer;
+    SEL m_selector;
+    NSString *m_name;
+    CFMutableSetRef m_objects;
+}
+
+/**
+ * Create an observation calling the observer selector (with signature - (void)methodName:(NSNotification *)notification)
+ * when a notification with the given name is sent by an object in the collection
+ */
+- (id)initWithNotificationCenter:(NSNotificationCenter *)notificationCenter
+                        observer:(id)observer
+                        selector:(SEL)selector
+                            name:(NSString *)name
+             objectsInCollection:(id<NSFastEnumeration>)collection;
+
+/**
+ * Add or remove observed objects
+ */
+- (void)addObject:(id)object;
+- (void)removeObject:(id)object;
+
+/**
+ * Stop observing notifications
+ */
+- (void)invalidate;
+
 @end
 
 @interface NSNotificationCenter (HLSNotificationExtensions)
 
+/**
+ * Register or unregister an observer for all objects within an enumerable collection, once per object. For large
+ * collections, prefer -addObserver:selector:name:objectsInCollectionObservation:
+ */
 - (void)addObserver:(id)observer selector:(SEL)selector name:(NSString *)name objectsInCollection:(id<NSFastEnumeration>)collection;
 - (void)removeObserver:(id)observer name:(NSString *)name objectsInCollection:(id<NSFastEnumeration>)collection;
 
+/**
+ * Register an observer for all objects within an enumerable collection at once, returning the corresponding
+ * observation (see HLSCollectionObservation). Call -invalidate on it to unregister the observer
+ */
+- (HLSCollectionObservation *)addObserver:(id)observer 
+                                 selector:(SEL)selector 
+                                     name:(NSString *)name
+           objectsInCollectionObservation:(id<NSFastEnumeration>)collection;
+
 @end
@@ -8,8 +8,15 @@
 
 #import "HLSNotifications.h"
 
+#import "HLSAssert.h"
+#import "HLSFloat.h"
 #import "HLSLogger.h"
 
+#import <libkern/OSAtomic.h>
+
+static const NSTimeInterval kNetworkActivityIndicatorDefaultShowDelay = 0.1;
+static const NSTimeInterval kNetworkActivityIndicatorDefaultHideDelay = 0.3;
+
 #pragma mark -
 #pragma mark NotificationSender class interface
 
@@ -33,13 +40,51 @@
 @end
 
 #pragma mark -
-#pragma mark HLSNotificationConverter class interface extension
+#pragma mark HLSPendingNotification class interface
 
-@interface HLSNotificationConverter ()
+/**
+ * A notification waiting for its coalescing interval to elapse. The userInfo dictionaries of the notifications
+ * merged into it are accumulated
+ *
+ * Designated initializer: -initWithName:object:
+ */
+@interface HLSPendingNotification : NSObject {
+@private
+    NSString *m_name;
+    id m_object;
+    NSMutableDictionary *m_userInfo;
+}
+
+/**
+ * Post the notification and forget about it
+ */
++ (void)postPendingNotification:(HLSPendingNotification *)pendingNotification;
+
+- (id)initWithName:(NSString *)name object:(id)object;
+
+@property (nonatomic, readonly, retain) NSString *name;
+@property (nonatomic, readonly, retain) id object;
+@property (nonatomic, readonly, retain) NSMutableDictionary *userInfo;
+
+@end
+
+// Maps senders (by address) to a dictionary mapping notification names to the corresponding pending notifications
+static NSMutableDictionary *s_objectToPendingNotificationsMap = nil;
+
+#pragma mark -
+#pragma mark HLSNotificationManager class interface extension
+
+@interface HLSNotificationManager ()
+
+- (void)networkActivityDidChange;
+- (void)updateNetworkActivityIndicator;
+
+@end
 
-@property (nonatomic, retain) NSMutableDictionary *objectToNotificationMap;
+#pragma mark -
+#pragma mark HLSNotificationConverter class interface extension
 
-- (NSString *)buildIdentifierForObject:(id)object;
+@interface HLSNotificationConverter ()
 
 - (void)convertNotification:(NSNotification *)notification;
 
@@ -68,39 +113,92 @@
 {
     if ((self = [super init])) {
         m_networkActivityCount = 0;
+        m_networkActivityIndicatorShowDelay = kNetworkActivityIndicatorDefaultShowDelay;
+        m_networkActivityIndicatorHideDelay = kNetworkActivityIndicatorDefaultHideDelay;
     }
     return self;
 }
 
+#pragma mark Accessors and mutators
+
+@synthesize networkActivityIndicatorShowDelay = m_networkActivityIndicatorShowDelay;
+
+@synthesize networkActivityIndicatorHideDelay = m_networkActivityIndicatorHideDelay;
+
 #pragma mark Activity notification
 
 - (void)notifyBeginNetworkActivity
 {
-    ++m_networkActivityCount;
+    int32_t networkActivityCount = OSAtomicIncrement32Barrier(&m_networkActivityCount);
     
-    HLSLoggerDebug(@"Network activity counter is now %d", m_networkActivityCount);
+    HLSLoggerDebug(@"Network activity counter is now %d", networkActivityCount);
     
-    if (m_networkActivityCount == 1) {
-        [UIApplication sharedApplication].networkActivityIndicatorVisible = YES;
+    if (networkActivityCount == 1) {
+        [self networkActivityDidChange];
     }
 }
 
 - (void)notifyEndNetworkActivity
 {
-    if (m_networkActivityCount == 0) {
-        HLSLoggerWarn(@"Warning: Notifying the end of a network activity which has not been started");
+    // Never decrement below zero, even if unbalanced calls are made concurrently
+    int32_t networkActivityCount;
+    do {
+        networkActivityCount = m_networkActivityCount;
+        if (networkActivityCount == 0) {
+            HLSLoggerWarn(@"Warning: Notifying the end of a network activity which has not been started");
+            return;
+        }
+    } while (! OSAtomicCompareAndSwap32Barrier(networkActivityCount, networkActivityCount - 1, &m_networkActivityCount));
+    
+    HLSLoggerDebug(@"Network activity counter is now %d", networkActivityCount - 1);
+    
+    if (networkActivityCount == 1) {
+        [self networkActivityDidChange];
+    }
+}
+
+/**
+ * Called (on any thread) when the network activity counter changes from or to 0
+ */
+- (void)networkActivityDidChange
+{
+    if (! [NSThread isMainThread]) {
+        [self performSelectorOnMainThread:@selector(networkActivityDidChange) withObject:nil waitUntilDone:NO];
         return;
     }
     
-    --m_networkActivityCount;
+    // Only the last transition matters. If the indicator already has the expected state, cancel pending updates
+    // so that no flickering occurs
+    [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(updateNetworkActivityIndicator) object:nil];
     
-    HLSLoggerDebug(@"Network activity counter is now %d", m_networkActivityCount);
+    BOOL visible = (m_networkActivityCount != 0);
+    if (visible == m_networkActivityIndicatorVisible) {
+        return;
+    }
     
-    if (m_networkActivityCount == 0) {
-        [UIApplication sharedApplication].networkActivityIndicatorVisible = NO;        
+    NSTimeInterval delay = visible ? self.networkActivityIndicatorShowDelay : self.networkActivityIndicatorHideDelay;
+    if (doublele(delay, 0.)) {
+        [self updateNetworkActivityIndicator];
+    }
+    else {
+        [self performSelector:@selector(updateNetworkActivityIndicator) 
+                   withObject:nil 
+                   afterDelay:delay
+                      inModes:[NSArray arrayWithObject:NSRunLoopCommonModes]];
     }
 }
 
+- (void)updateNetworkActivityIndicator
+{
+    BOOL visible = (m_networkActivityCount != 0);
+    if (visible == m_networkActivityIndicatorVisible) {
+        return;
+    }
+    
+    m_networkActivityIndicatorVisible = visible;
+    [UIApplication sharedApplication].networkActivityIndicatorVisible = visible;
+}
+
 @end
 
 #pragma mark -
@@ -156,21 +254,26 @@
 - (id)init
 {
     if ((self = [super init])) {
-        self.objectToNotificationMap = [NSMutableDictionary dictionary];
+        // Objects are compared by address and not retained
+        m_objectToNotificationMap = CFDictionaryCreateMutable(kCFAllocatorDefault, 0, NULL, &kCFTypeDictionaryValueCallBacks);
+        m_notificationNames = [[NSCountedSet alloc] init];
     }
     return self;
 }
 
 - (void)dealloc
 {
-    self.objectToNotificationMap = nil;
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+    
+    CFRelease(m_objectToNotificationMap);
+    m_objectToNotificationMap = NULL;
+    
+    [m_notificationNames release];
+    m_notificationNames = nil;
+    
     [super dealloc];
 }
 
-#pragma mark Accessors and mutators
-
-@synthesize objectToNotificationMap = m_objectToNotificationMap;
-
 #pragma mark (Un)registering conversion rules
 
 - (void)convertNotificationWithName:(NSString *)notificationNameFrom
@@ -183,14 +286,11 @@
         return;
     }
     
-    // Build the emitter identifier
-    NSString *fromIdentifier = [self buildIdentifierForObject:objectFrom];
-    
     // Get the associated notification map, or create it if it does not exist
-    NSMutableDictionary *notificationMap = [self.objectToNotificationMap objectForKey:fromIdentifier];
+    NSMutableDictionary *notificationMap = (NSMutableDictionary *)CFDictionaryGetValue(m_objectToNotificationMap, objectFrom);
     if (! notificationMap) {
         notificationMap = [[[NSMutableDictionary alloc] initWithCapacity:1] autorelease];
-        [self.objectToNotificationMap setObject:notificationMap forKey:fromIdentifier];
+        CFDictionarySetValue(m_objectToNotificationMap, objectFrom, notificationMap);
     }
     
     // If the rule already exists, nothing to do
@@ -206,12 +306,14 @@
     // Add the new rule
     [notificationMap setObject:toSender forKey:notificationNameFrom];
     
-    // Register the converter to trap the notification sent by objectFrom and to convert it into the
-    // notification sent by objectTo
-    [[NSNotificationCenter defaultCenter] addObserver:self
-                                             selector:@selector(convertNotification:)
-                                                 name:notificationNameFrom 
-                                               object:objectFrom];
+    // Register the converter to trap the notification (sent by any object) when the first rule for it is added
+    if ([m_notificationNames countForObject:notificationNameFrom] == 0) {
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(convertNotification:)
+                                                     name:notificationNameFrom 
+                                                   object:nil];
+    }
+    [m_notificationNames addObject:notificationNameFrom];
     
     HLSLoggerDebug(@"Added conversion rule for (%@, %p) into (%@, %p)", notificationNameFrom,
                    objectFrom, notificationNameTo, objectTo);
@@ -239,25 +341,25 @@
         return;
     }
     
-    // Build the emitter identifier
-    NSString *fromIdentifier = [self buildIdentifierForObject:objectFrom];
-    
     // Get all associated rules
-    NSMutableDictionary *notificationMap = [self.objectToNotificationMap objectForKey:fromIdentifier];
+    NSMutableDictionary *notificationMap = (NSMutableDictionary *)CFDictionaryGetValue(m_objectToNotificationMap, objectFrom);
     
     // If no rules, nothing to do
     if (! notificationMap) {
         return;
     }
     
-    // Unregister the converter completely for this object notifications
+    // Unregister the converter from notifications which do not have any rule anymore
     NSArray *notificationNames = [notificationMap allKeys];
     for (NSString *notificationName in notificationNames) {
-        [[NSNotificationCenter defaultCenter] removeObserver:self name:notificationName object:objectFrom];
+        [m_notificationNames removeObject:notificationName];
+        if ([m_notificationNames countForObject:notificationName] == 0) {
+            [[NSNotificationCenter defaultCenter] removeObserver:self name:notificationName object:nil];
+        }
     }
     
     // Remove all rules
-    [self.objectToNotificationMap removeObjectForKey:fromIdentifier];
+    CFDictionaryRemoveValue(m_objectToNotificationMap, objectFrom);
     
     HLSLoggerDebug(@"Removed all conversions for object %p", objectFrom);
 }
@@ -269,29 +371,18 @@
     } 
 }
 
-#pragma mark Creating a unique string identifier for indexing the dictionary
-
-- (NSString *)buildIdentifierForObject:(id)object
-{
-    // Since a pointer is unique, this is guaranteed to be unique
-    return [NSString stringWithFormat:@"%p", object];
-}
-
 #pragma mark Notification conversion callback
 
 - (void)convertNotification:(NSNotification *)notification
 {
-    // Build the emitter identifier
-    NSString *fromIdentifier = [self buildIdentifierForObject:notification.object];
-    
-    // Locate the conversion rule to apply
-    NotificationSender *sender = [[self.objectToNotificationMap objectForKey:fromIdentifier] 
-                                  objectForKey:notification.name];
+    if (! notification.object) {
+        return;
+    }
     
-    // We should never be trapped here if no conversion rule exists; but stay defensive anyway
+    // Locate the conversion rule to apply. Since notifications are observed for all objects, there might be none
+    NSDictionary *notificationMap = (NSDictionary *)CFDictionaryGetValue(m_objectToNotificationMap, notification.object);
+    NotificationSender *sender = [notificationMap objectForKey:notification.name];
     if (! sender) {
-        HLSLoggerWarn(@"Notification conversion remains registered with NSNotificationCenter for object %@ "
-                      "and notification %@, but should not be", fromIdentifier, notification.name);
         return;
     }
     
@@ -313,23 +404,241 @@
 @implementation NSObject (HLSNotificationExtensions)
 
 - (void)postCoalescingNotificationWithName:(NSString *)name userInfo:(NSDictionary *)userInfo
+{
+    [self postCoalescingNotificationWithName:name userInfo:userInfo postingStyle:NSPostNow];
+}
+
+- (void)postCoalescingNotificationWithName:(NSString *)name
+{
+    [self postCoalescingNotificationWithName:name userInfo:nil];
+}
+
+- (void)postCoalescingNotificationWithName:(NSString *)name userInfo:(NSDictionary *)userInfo postingStyle:(NSPostingStyle)postingStyle
 {
     NSNotification *notification = [NSNotification notificationWithName:name 
                                                                  object:self
                                                                userInfo:userInfo];
     [[NSNotificationQueue defaultQueue] enqueueNotification:notification
-                                               postingStyle:NSPostNow
+                                               postingStyle:postingStyle
                                                coalesceMask:NSNotificationCoalescingOnName | NSNotificationCoalescingOnSender
                                                    forModes:nil];
 }
 
-- (void)postCoalescingNotificationWithName:(NSString *)name
+- (void)postCoalescingNotificationWithName:(NSString *)name userInfo:(NSDictionary *)userInfo coalescingInterval:(NSTimeInterval)interval
 {
-    [self postCoalescingNotificationWithName:name userInfo:nil];
+    NSAssert([NSThread isMainThread], @"Must be called from the main thread");
+    
+    if (! s_objectToPendingNotificationsMap) {
+        s_objectToPendingNotificationsMap = [[NSMutableDictionary alloc] init];
+    }
+    
+    NSValue *objectKey = [NSValue valueWithNonretainedObject:self];
+    NSMutableDictionary *nameToPendingNotificationMap = [s_objectToPendingNotificationsMap objectForKey:objectKey];
+    if (! nameToPendingNotificationMap) {
+        nameToPendingNotificationMap = [NSMutableDictionary dictionary];
+        [s_objectToPendingNotificationsMap setObject:nameToPendingNotificationMap forKey:objectKey];
+    }
+    
+    // Merge with the notification waiting to be posted, if any
+    HLSPendingNotification *pendingNotification = [nameToPendingNotificationMap objectForKey:name];
+    if (! pendingNotification) {
+        pendingNotification = [[[HLSPendingNotification alloc] initWithName:name object:self] autorelease];
+        [nameToPendingNotificationMap setObject:pendingNotification forKey:name];
+        [HLSPendingNotification performSelector:@selector(postPendingNotification:)
+                                     withObject:pendingNotification
+                                     afterDelay:interval
+                                        inModes:[NSArray arrayWithObject:NSRunLoopCommonModes]];
+    }
+    [pendingNotification.userInfo addEntriesFromDictionary:userInfo];
+}
+
+@end
+
+#pragma mark -
+#pragma mark HLSCollectionObservation class implementation
+
+@interface HLSCollectionObservation ()
+
+- (void)forwardNotification:(NSNotification *)notification;
+
+@end
+
+@implementation HLSCollectionObservation
+
+#pragma mark Object creation and destruction
+
+- (id)initWithNotificationCenter:(NSNotificationCenter *)notificationCenter
+                        observer:(id)observer
+                        selector:(SEL)selector
+                            name:(NSString *)name
+             objectsInCollection:(id<NSFastEnumeration>)collection
+{
+    if ((self = [super init])) {
+        if (! notificationCenter || ! observer || ! selector) {
+            HLSLoggerError(@"A notification center, an observer and a selector are mandatory");
+            [self release];
+            return nil;
+        }
+        
+        m_notificationCenter = [notificationCenter retain];
+        m_observer = observer;
+        m_selector = selector;
+        m_name = [name copy];
+        
+        // Objects are compared by address and not retained
+        m_objects = CFSetCreateMutable(kCFAllocatorDefault, 0, NULL);
+        for (id object in collection) {
+            CFSetAddValue(m_objects, object);
+        }
+        
+        [m_notificationCenter addObserver:self selector:@selector(forwardNotification:) name:m_name object:nil];
+    }
+    return self;
+}
+
+- (id)init
+{
+    HLSForbiddenInheritedMethod();
+    return nil;
+}
+
+- (void)dealloc
+{
+    [self invalidate];
+    
+    [m_notificationCenter release];
+    m_notificationCenter = nil;
+    
+    [m_name release];
+    m_name = nil;
+    
+    CFRelease(m_objects);
+    m_objects = NULL;
+    
+    [super dealloc];
+}
+
+#pragma mark Observed objects
+
+- (void)addObject:(id)object
+{
+    if (! object) {
+        return;
+    }
+    
+    CFSetAddValue(m_objects, object);
+}
+
+- (void)removeObject:(id)object
+{
+    if (! object) {
+        return;
+    }
+    
+    CFSetRemoveValue(m_objects, object);
+}
+
+#pragma mark Observation
+
+- (void)invalidate
+{
+    if (! m_observer) {
+        return;
+    }
+    
+    [m_notificationCenter removeObserver:self name:m_name object:nil];
+    m_observer = nil;
+}
+
+- (void)forwardNotification:(NSNotification *)notification
+{
+    if (! notification.object || ! CFSetContainsValue(m_objects, notification.object)) {
+        return;
+    }
+    
+    [m_observer performSelector:m_selector withObject:notification];
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; observer: %@; name: %@; objectCount: %ld>",
+            [self class],
+            self,
+            m_observer,
+            m_name,
+            CFSetGetCount(m_objects)];
 }
 
 @end
 
+#pragma mark -
+#pragma mark HLSPendingNotification class implementation
+
+@implementation HLSPendingNotification
+
+#pragma mark Class methods
+
++ (void)postPendingNotification:(HLSPendingNotification *)pendingNotification
+{
+    // Remove first so that posts made by observers start a new interval (the notification is retained by the
+    // delayed perform until this method returns)
+    NSValue *objectKey = [NSValue valueWithNonretainedObject:pendingNotification.object];
+    NSMutableDictionary *nameToPendingNotificationMap = [s_objectToPendingNotificationsMap objectForKey:objectKey];
+    [nameToPendingNotificationMap removeObjectForKey:pendingNotification.name];
+    if ([nameToPendingNotificationMap count] == 0) {
+        [s_objectToPendingNotificationsMap removeObjectForKey:objectKey];
+    }
+    
+    NSDictionary *userInfo = [pendingNotification.userInfo count] != 0 ? [NSDictionary dictionaryWithDictionary:pendingNotification.userInfo] : nil;
+    [[NSNotificationCenter defaultCenter] postNotificationName:pendingNotification.name
+                                                        object:pendingNotification.object
+                                                      userInfo:userInfo];
+}
+
+#pragma mark Object creation and destruction
+
+- (id)initWithName:(NSString *)name object:(id)object
+{
+    if ((self = [super init])) {
+        m_name = [name copy];
+        m_object = [object retain];
+        m_userInfo = [[NSMutableDictionary alloc] init];
+    }
+    return self;
+}
+
+- (id)init
+{
+    HLSForbiddenInheritedMethod();
+    return nil;
+}
+
+- (void)dealloc
+{
+    [m_name release];
+    m_name = nil;
+    
+    [m_object release];
+    m_object = nil;
+    
+    [m_userInfo release];
+    m_userInfo = nil;
+    
+    [super dealloc];
+}
+
+#pragma mark Accessors and mutators
+
+@synthesize name = m_name;
+
+@synthesize object = m_object;
+
+@synthesize userInfo = m_userInfo;
+
+@end
+
 #pragma mark -
 #pragma mark NSNotificationCenter extensions
 
@@ -351,4 +660,16 @@
     }
 }
 
+- (HLSCollectionObservation *)addObserver:(id)observer 
+                                 selector:(SEL)selector 
+                                     name:(NSString *)name
+           objectsInCollectionObservation:(id<NSFastEnumeration>)collection
+{
+    return [[[HLSCollectionObservation alloc] initWithNotificationCenter:self
+                                                                observer:observer
+                                                                selector:selector
+                                                                    name:name
+                                                     objectsInCollection:collection] autorelease];
+}
+
 @end
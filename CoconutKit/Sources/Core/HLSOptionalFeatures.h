@@ -13,13 +13,15 @@
  */
 
 #import "HLSApplicationPreloader.h"
+#import "NSDate+HLSExtensions.h"
 #import "NSManagedObject+HLSValidation.h"
 #import "UIControl+HLSExclusiveTouch.h"
 
 /**
- * Enable preloading of some objects (currently only UIWebView) when the application is started. This 
- * incurs a memory overhead you might not want to pay if you do not need those features (most notably 
- * if your application does not contain any UIWebView)
+ * Enable preloading of some objects (UIWebView, as well as the preloading tasks registered with
+ * HLSApplicationPreloader) when the application is started. This incurs a memory overhead you might not
+ * want to pay if you do not need those features (most notably if your application does not contain any 
+ * UIWebView)
  */
 #if !__has_feature(objc_arc)
 #define HLSEnableApplicationPreloading()                                                                  \
@@ -78,3 +80,23 @@
         [UIControl enable];                                                                              \
     }
 #endif
+
+/**
+ * Append the date in the system time zone to NSDate descriptions. Useful when debugging, but you probably do not
+ * want this feature in production builds since it swizzles a method on a class used everywhere
+ */
+#if !__has_feature(objc_arc)
+#define HLSEnableNSDateSystemTimeZoneDescription()                                                       \
+    __attribute__ ((constructor)) void HLSEnableNSDateSystemTimeZoneDescriptionConstructor(void)         \
+    {                                                                                                    \
+        NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];                                      \
+        [NSDate enable];                                                                                 \
+        [pool drain];                                                                                    \
+    }
+#else
+#define HLSEnableNSDateSystemTimeZoneDescription()                                                       \
+    __attribute__ ((constructor)) void HLSEnableNSDateSystemTimeZoneDescriptionConstructor(void)         \
+    {                                                                                                    \
+        [NSDate enable];                                                                                 \
+    }
+#endif
@@ -0,0 +1,38 @@
+//
+//  HLSPersistentDictionary.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+/**
+ * An immutable dictionary optimized for creating modified copies. Its contents are stored in a hash array mapped
+ * trie, and the dictionaries returned by -dictionaryBySettingObject:forKey: and -dictionaryByRemovingObjectForKey: 
+ * share all the trie nodes which have not been affected by the change with the receiver. Such updates are performed
+ * in O(log n) instead of copying the whole dictionary. Lookups are in O(log n) as well (in practice at most 7 levels
+ * are traversed, since 5 bits of the key hash are consumed at each level).
+ *
+ * The NSDictionary (HLSExtensions) update methods return instances of this class, so that chained updates only
+ * pay for a full copy once. Keys are copied, as for NSDictionary. Mutable copies are usual NSMutableDictionary
+ * instances.
+ *
+ * Designated initializer: -initWithObjects:forKeys:count:
+ */
+@interface HLSPersistentDictionary : NSDictionary {
+@private
+    id _rootNode;
+    NSUInteger _count;
+}
+
+/**
+ * Return a dictionary where object has been set for key (which is copied). Neither object nor key can be nil
+ */
+- (id)dictionaryBySettingObject:(id)object forKey:(id)key;
+
+/**
+ * Return a dictionary without the object designated by key
+ */
+- (id)dictionaryByRemovingObjectForKey:(id)key;
+
+@end
@@ -0,0 +1,516 @@
+//
+//  HLSPersistentDictionary.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSPersistentDictionary.h"
+
+// Number of hash bits consumed at each trie level
+static const NSUInteger kHashBitsPerLevel = 5;
+static const uint32_t kHashLevelMask = 0x1f;
+
+// Number of hash bits. Beyond, keys have the same hash and are stored in collision nodes
+static const NSUInteger kHashBitCount = 32;
+
+// Maximum trie depth (7 bitmap-indexed levels and one collision level)
+#define HLSPersistentDictionaryMaxDepth 8
+
+// Function declarations
+static uint32_t hashForKey(id key);
+
+/**
+ * A trie node. Entries are either key-value pairs or child nodes (in which case the key is nil and the value is
+ * the child node). Nodes are immutable and can therefore be shared between dictionaries.
+ *
+ * At depths where hash bits remain, the bitmap tells which of the 32 possible slots are occupied, and entries
+ * are stored compactly in slot order. Collision nodes (below all bitmap-indexed levels) do not use the bitmap
+ * and only contain key-value pairs for keys having the same hash
+ */
+@interface HLSPersistentDictionaryNode : NSObject {
+@private
+    uint32_t _bitmap;
+    NSUInteger _entryCount;
+    id *_keys;
+    id *_values;
+}
+
++ (HLSPersistentDictionaryNode *)emptyNode;
+
+- (id)initWithBitmap:(uint32_t)bitmap keys:(id *)keys values:(id *)values entryCount:(NSUInteger)entryCount;
+
+@property (nonatomic, readonly, assign) NSUInteger entryCount;
+
+- (id)keyAtIndex:(NSUInteger)index;
+- (id)valueAtIndex:(NSUInteger)index;
+
+- (id)objectForKey:(id)key hash:(uint32_t)hash shift:(NSUInteger)shift;
+- (HLSPersistentDictionaryNode *)nodeBySettingObject:(id)object forKey:(id)key hash:(uint32_t)hash shift:(NSUInteger)shift added:(BOOL *)pAdded;
+- (HLSPersistentDictionaryNode *)nodeByRemovingObjectForKey:(id)key hash:(uint32_t)hash shift:(NSUInteger)shift removed:(BOOL *)pRemoved;
+
+- (HLSPersistentDictionaryNode *)nodeByInsertingKey:(id)key value:(id)value atIndex:(NSUInteger)index bitmap:(uint32_t)bitmap;
+- (HLSPersistentDictionaryNode *)nodeByReplacingKey:(id)key value:(id)value atIndex:(NSUInteger)index;
+- (HLSPersistentDictionaryNode *)nodeByRemovingEntryAtIndex:(NSUInteger)index bitmap:(uint32_t)bitmap;
+
+@end
+
+/**
+ * Depth-first enumeration of the keys stored in a trie
+ */
+@interface HLSPersistentDictionaryKeyEnumerator : NSEnumerator {
+@private
+    HLSPersistentDictionaryNode *_rootNode;
+    HLSPersistentDictionaryNode *_nodes[HLSPersistentDictionaryMaxDepth];
+    NSUInteger _indices[HLSPersistentDictionaryMaxDepth];
+    NSUInteger _depth;
+}
+
+- (id)initWithRootNode:(HLSPersistentDictionaryNode *)rootNode;
+
+@end
+
+@interface HLSPersistentDictionary ()
+
+- (id)initWithRootNode:(HLSPersistentDictionaryNode *)rootNode count:(NSUInteger)count;
+
+@end
+
+@implementation HLSPersistentDictionary
+
+#pragma mark Object creation and destruction
+
+- (id)initWithObjects:(const id [])objects forKeys:(const id<NSCopying> [])keys count:(NSUInteger)count
+{
+    if ((self = [super init])) {
+        HLSPersistentDictionaryNode *rootNode = [HLSPersistentDictionaryNode emptyNode];
+        for (NSUInteger i = 0; i < count; ++i) {
+            if (! objects[i] || ! keys[i]) {
+                [self release];
+                [NSException raise:NSInvalidArgumentException format:@"Dictionary objects and keys cannot be nil"];
+            }
+            
+            id key = [[(id)keys[i] copyWithZone:NULL] autorelease];
+            BOOL added = NO;
+            rootNode = [rootNode nodeBySettingObject:objects[i] forKey:key hash:hashForKey(key) shift:0 added:&added];
+            if (added) {
+                ++_count;
+            }
+        }
+        _rootNode = [rootNode retain];
+    }
+    return self;
+}
+
+- (id)initWithRootNode:(HLSPersistentDictionaryNode *)rootNode count:(NSUInteger)count
+{
+    if ((self = [super init])) {
+        _rootNode = [rootNode retain];
+        _count = count;
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [_rootNode release];
+    [super dealloc];
+}
+
+#pragma mark NSDictionary primitive methods
+
+- (NSUInteger)count
+{
+    return _count;
+}
+
+- (id)objectForKey:(id)key
+{
+    if (! key) {
+        return nil;
+    }
+    
+    return [_rootNode objectForKey:key hash:hashForKey(key) shift:0];
+}
+
+- (NSEnumerator *)keyEnumerator
+{
+    return [[[HLSPersistentDictionaryKeyEnumerator alloc] initWithRootNode:_rootNode] autorelease];
+}
+
+#pragma mark Updates
+
+- (id)dictionaryBySettingObject:(id)object forKey:(id)key
+{
+    if (! object || ! key) {
+        [NSException raise:NSInvalidArgumentException format:@"Dictionary objects and keys cannot be nil"];
+    }
+    
+    key = [[key copyWithZone:NULL] autorelease];
+    BOOL added = NO;
+    HLSPersistentDictionaryNode *rootNode = [_rootNode nodeBySettingObject:object forKey:key hash:hashForKey(key) shift:0 added:&added];
+    if (rootNode == _rootNode) {
+        return self;
+    }
+    
+    return [[[HLSPersistentDictionary alloc] initWithRootNode:rootNode count:added ? _count + 1 : _count] autorelease];
+}
+
+- (id)dictionaryByRemovingObjectForKey:(id)key
+{
+    if (! key) {
+        return self;
+    }
+    
+    BOOL removed = NO;
+    HLSPersistentDictionaryNode *rootNode = [_rootNode nodeByRemovingObjectForKey:key hash:hashForKey(key) shift:0 removed:&removed];
+    if (! removed) {
+        return self;
+    }
+    
+    return [[[HLSPersistentDictionary alloc] initWithRootNode:rootNode count:_count - 1] autorelease];
+}
+
+#pragma mark NSCopying protocol implementation
+
+- (id)copyWithZone:(NSZone *)zone
+{
+    return [self retain];
+}
+
+#pragma mark NSCoding protocol implementation
+
+- (Class)classForCoder
+{
+    // Archived as a usual dictionary
+    return [NSDictionary class];
+}
+
+@end
+
+@implementation HLSPersistentDictionaryNode
+
+#pragma mark Class methods
+
++ (HLSPersistentDictionaryNode *)emptyNode
+{
+    return [[[HLSPersistentDictionaryNode alloc] initWithBitmap:0 keys:NULL values:NULL entryCount:0] autorelease];
+}
+
+#pragma mark Object creation and destruction
+
+- (id)initWithBitmap:(uint32_t)bitmap keys:(id *)keys values:(id *)values entryCount:(NSUInteger)entryCount
+{
+    if ((self = [super init])) {
+        _bitmap = bitmap;
+        _entryCount = entryCount;
+        if (entryCount != 0) {
+            _keys = malloc(entryCount * sizeof(id));
+            _values = malloc(entryCount * sizeof(id));
+            for (NSUInteger i = 0; i < entryCount; ++i) {
+                _keys[i] = [keys[i] retain];
+                _values[i] = [values[i] retain];
+            }
+        }
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    for (NSUInteger i = 0; i < _entryCount; ++i) {
+        [_keys[i] release];
+        [_values[i] release];
+    }
+    free(_keys);
+    free(_values);
+    [super dealloc];
+}
+
+#pragma mark Accessors and mutators
+
+@synthesize entryCount = _entryCount;
+
+- (id)keyAtIndex:(NSUInteger)index
+{
+    return _keys[index];
+}
+
+- (id)valueAtIndex:(NSUInteger)index
+{
+    return _values[index];
+}
+
+#pragma mark Trie operations
+
+- (id)objectForKey:(id)key hash:(uint32_t)hash shift:(NSUInteger)shift
+{
+    if (shift >= kHashBitCount) {
+        for (NSUInteger i = 0; i < _entryCount; ++i) {
+            if ([_keys[i] isEqual:key]) {
+                return _values[i];
+            }
+        }
+        return nil;
+    }
+    
+    uint32_t bit = 1U << ((hash >> shift) & kHashLevelMask);
+    if (! (_bitmap & bit)) {
+        return nil;
+    }
+    
+    NSUInteger index = __builtin_popcount(_bitmap & (bit - 1));
+    id entryKey = _keys[index];
+    if (! entryKey) {
+        return [_values[index] objectForKey:key hash:hash shift:shift + kHashBitsPerLevel];
+    }
+    
+    return [entryKey isEqual:key] ? _values[index] : nil;
+}
+
+- (HLSPersistentDictionaryNode *)nodeBySettingObject:(id)object forKey:(id)key hash:(uint32_t)hash shift:(NSUInteger)shift added:(BOOL *)pAdded
+{
+    NSParameterAssert(pAdded);
+    
+    if (shift >= kHashBitCount) {
+        for (NSUInteger i = 0; i < _entryCount; ++i) {
+            if ([_keys[i] isEqual:key]) {
+                *pAdded = NO;
+                return (_values[i] == object) ? self : [self nodeByReplacingKey:_keys[i] value:object atIndex:i];
+            }
+        }
+        *pAdded = YES;
+        return [self nodeByInsertingKey:key value:object atIndex:_entryCount bitmap:0];
+    }
+    
+    uint32_t bit = 1U << ((hash >> shift) & kHashLevelMask);
+    NSUInteger index = __builtin_popcount(_bitmap & (bit - 1));
+    if (! (_bitmap & bit)) {
+        *pAdded = YES;
+        return [self nodeByInsertingKey:key value:object atIndex:index bitmap:_bitmap | bit];
+    }
+    
+    id entryKey = _keys[index];
+    id entryValue = _values[index];
+    
+    // Child node
+    if (! entryKey) {
+        HLSPersistentDictionaryNode *childNode = [entryValue nodeBySettingObject:object 
+                                                                          forKey:key 
+                                                                            hash:hash 
+                                                                           shift:shift + kHashBitsPerLevel 
+                                                                           added:pAdded];
+        return (childNode == entryValue) ? self : [self nodeByReplacingKey:nil value:childNode atIndex:index];
+    }
+    
+    // Same key
+    if ([entryKey isEqual:key]) {
+        *pAdded = NO;
+        return (entryValue == object) ? self : [self nodeByReplacingKey:entryKey value:object atIndex:index];
+    }
+    
+    // Different keys in the same slot: Move both into a new child node
+    BOOL added = NO;
+    HLSPersistentDictionaryNode *childNode = [[HLSPersistentDictionaryNode emptyNode] nodeBySettingObject:entryValue 
+                                                                                                   forKey:entryKey 
+                                                                                                     hash:hashForKey(entryKey) 
+                                                                                                    shift:shift + kHashBitsPerLevel 
+                                                                                                    added:&added];
+    childNode = [childNode nodeBySettingObject:object forKey:key hash:hash shift:shift + kHashBitsPerLevel added:&added];
+    *pAdded = YES;
+    return [self nodeByReplacingKey:nil value:childNode atIndex:index];
+}
+
+- (HLSPersistentDictionaryNode *)nodeByRemovingObjectForKey:(id)key hash:(uint32_t)hash shift:(NSUInteger)shift removed:(BOOL *)pRemoved
+{
+    NSParameterAssert(pRemoved);
+    
+    *pRemoved = NO;
+    
+    if (shift >= kHashBitCount) {
+        for (NSUInteger i = 0; i < _entryCount; ++i) {
+            if ([_keys[i] isEqual:key]) {
+                *pRemoved = YES;
+                return [self nodeByRemovingEntryAtIndex:i bitmap:0];
+            }
+        }
+        return self;
+    }
+    
+    uint32_t bit = 1U << ((hash >> shift) & kHashLevelMask);
+    if (! (_bitmap & bit)) {
+        return self;
+    }
+    
+    NSUInteger index = __builtin_popcount(_bitmap & (bit - 1));
+    id entryKey = _keys[index];
+    id entryValue = _values[index];
+    
+    // Child node
+    if (! entryKey) {
+        HLSPersistentDictionaryNode *childNode = [entryValue nodeByRemovingObjectForKey:key 
+                                                                                   hash:hash 
+                                                                                  shift:shift + kHashBitsPerLevel 
+                                                                                removed:pRemoved];
+        if (childNode == entryValue) {
+            return self;
+        }
+        
+        // Remove empty child nodes, and move single key-value pairs up so that the trie stays as shallow as possible
+        if ([childNode entryCount] == 0) {
+            return [self nodeByRemovingEntryAtIndex:index bitmap:_bitmap & ~bit];
+        }
+        else if ([childNode entryCount] == 1 && [childNode keyAtIndex:0]) {
+            return [self nodeByReplacingKey:[childNode keyAtIndex:0] value:[childNode valueAtIndex:0] atIndex:index];
+        }
+        else {
+            return [self nodeByReplacingKey:nil value:childNode atIndex:index];
+        }
+    }
+    
+    if (! [entryKey isEqual:key]) {
+        return self;
+    }
+    
+    *pRemoved = YES;
+    return [self nodeByRemovingEntryAtIndex:index bitmap:_bitmap & ~bit];
+}
+
+#pragma mark Node copies
+
+- (HLSPersistentDictionaryNode *)nodeByInsertingKey:(id)key value:(id)value atIndex:(NSUInteger)index bitmap:(uint32_t)bitmap
+{
+    NSUInteger entryCount = _entryCount + 1;
+    id *keys = malloc(entryCount * sizeof(id));
+    id *values = malloc(entryCount * sizeof(id));
+    for (NSUInteger i = 0; i < index; ++i) {
+        keys[i] = _keys[i];
+        values[i] = _values[i];
+    }
+    keys[index] = key;
+    values[index] = value;
+    for (NSUInteger i = index; i < _entryCount; ++i) {
+        keys[i + 1] = _keys[i];
+        values[i + 1] = _values[i];
+    }
+    
+    HLSPersistentDictionaryNode *node = [[[HLSPersistentDictionaryNode alloc] initWithBitmap:bitmap 
+                                                                                        keys:keys 
+                                                                                      values:values 
+                                                                                  entryCount:entryCount] autorelease];
+    free(keys);
+    free(values);
+    return node;
+}
+
+- (HLSPersistentDictionaryNode *)nodeByReplacingKey:(id)key value:(id)value atIndex:(NSUInteger)index
+{
+    id *keys = malloc(_entryCount * sizeof(id));
+    id *values = malloc(_entryCount * sizeof(id));
+    for (NSUInteger i = 0; i < _entryCount; ++i) {
+        keys[i] = _keys[i];
+        values[i] = _values[i];
+    }
+    keys[index] = key;
+    values[index] = value;
+    
+    HLSPersistentDictionaryNode *node = [[[HLSPersistentDictionaryNode alloc] initWithBitmap:_bitmap 
+                                                                                        keys:keys 
+                                                                                      values:values 
+                                                                                  entryCount:_entryCount] autorelease];
+    free(keys);
+    free(values);
+    return node;
+}
+
+- (HLSPersistentDictionaryNode *)nodeByRemovingEntryAtIndex:(NSUInteger)index bitmap:(uint32_t)bitmap
+{
+    NSUInteger entryCount = _entryCount - 1;
+    if (entryCount == 0) {
+        return [HLSPersistentDictionaryNode emptyNode];
+    }
+    
+    id *keys = malloc(entryCount * sizeof(id));
+    id *values = malloc(entryCount * sizeof(id));
+    for (NSUInteger i = 0; i < index; ++i) {
+        keys[i] = _keys[i];
+        values[i] = _values[i];
+    }
+    for (NSUInteger i = index + 1; i < _entryCount; ++i) {
+        keys[i - 1] = _keys[i];
+        values[i - 1] = _values[i];
+    }
+    
+    HLSPersistentDictionaryNode *node = [[[HLSPersistentDictionaryNode alloc] initWithBitmap:bitmap 
+                                                                                        keys:keys 
+                                                                                      values:values 
+                                                                                  entryCount:entryCount] autorelease];
+    free(keys);
+    free(values);
+    return node;
+}
+
+@end
+
+@implementation HLSPersistentDictionaryKeyEnumerator
+
+#pragma mark Object creation and destruction
+
+- (id)initWithRootNode:(HLSPersistentDictionaryNode *)rootNode
+{
+    if ((self = [super init])) {
+        // The root node keeps all nodes alive
+        _rootNode = [rootNode retain];
+        _nodes[0] = rootNode;
+        _indices[0] = 0;
+        _depth = 1;
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [_rootNode release];
+    [super dealloc];
+}
+
+#pragma mark NSEnumerator methods
+
+- (id)nextObject
+{
+    while (_depth != 0) {
+        HLSPersistentDictionaryNode *node = _nodes[_depth - 1];
+        NSUInteger index = _indices[_depth - 1];
+        if (index == [node entryCount]) {
+            --_depth;
+            continue;
+        }
+        ++_indices[_depth - 1];
+        
+        id key = [node keyAtIndex:index];
+        if (key) {
+            return key;
+        }
+        
+        NSAssert(_depth < HLSPersistentDictionaryMaxDepth, @"Trie too deep");
+        _nodes[_depth] = [node valueAtIndex:index];
+        _indices[_depth] = 0;
+        ++_depth;
+    }
+    return nil;
+}
+
+@end
+
+#pragma mark Static functions
+
+static uint32_t hashForKey(id key)
+{
+    NSUInteger hash = [key hash];
+#if __LP64__
+    return (uint32_t)(hash ^ (hash >> 32));
+#else
+    return (uint32_t)hash;
+#endif
+}
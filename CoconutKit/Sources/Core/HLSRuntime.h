@@ -20,6 +20,25 @@
  */
 void instrumentObjcMessageSends(BOOL start);
 
+/**
+ * Message send profiling. Logging all messages with instrumentObjcMessageSends produces huge files and slows down the
+ * application a lot. The functions below restrict logging to messages sent to or implemented by the given classes
+ * (all classes if classNames is nil or empty), and optionally to short windows of windowDuration seconds, repeated every
+ * samplingInterval seconds (windowDuration <= 0 for continuous profiling). Messages sent to other classes are cached
+ * by the runtime as usual and therefore do not incur any logging overhead.
+ *
+ * Messages are logged to the file whose path is returned by HLSMessageSendProfilingFilePath() (in the caches directory,
+ * so that it can be retrieved from a device), with the same format as instrumentObjcMessageSends:
+ *    <+ or -> <Receiver object class> <Class which implements the method> <Selector name>
+ * The file is truncated when profiling starts. Use Tools/Profiling/msgsends.py to aggregate it into per-selector counts.
+ *
+ * Profiling is meant for debugging sessions only, and relies on functions private to the Objective-C runtime. Start and 
+ * stop profiling from the main thread
+ */
+void HLSMessageSendProfilingStart(NSArray *classNames, NSTimeInterval windowDuration, NSTimeInterval samplingInterval);
+void HLSMessageSendProfilingStop(void);
+NSString *HLSMessageSendProfilingFilePath(void);
+
 /**
  * Replace the implementation of a class method, given its selector. Return the original implementation
  */
@@ -29,3 +48,26 @@ IMP HLSSwizzleClassSelector(Class clazz, SEL selector, IMP newImplementation);
  * Replace the implementation of an instance method, given its selector. Return the original implementation
  */
 IMP HLSSwizzleSelector(Class clazz, SEL selector, IMP newImplementation);
+
+/**
+ * Describe a method swizzling for use with HLSSwizzleSelectors and HLSSwizzleClassSelectors. The original 
+ * implementation is stored into the variable pointed at by pOriginalImplementation (set to NULL if the method does 
+ * not exist, in which case the method is not swizzled)
+ */
+typedef struct {
+    SEL selector;
+    IMP newImplementation;
+    IMP *pOriginalImplementation;
+} HLSSwizzling;
+
+/**
+ * Replace the implementation of several class or instance methods at once. Equivalent to calling HLSSwizzleClassSelector
+ * or HLSSwizzleSelector for each swizzling, but the method list of the class is only retrieved once, and methods
+ * implemented by the class itself are swizzled in place instead of being replaced. Prefer these functions when a 
+ * class swizzles more than a few methods in its +load method.
+ *
+ * When assertions are enabled, swizzlings are validated: An assertion fails if the same selector appears twice or
+ * if a method has already been swizzled with the same implementation
+ */
+void HLSSwizzleClassSelectors(Class clazz, const HLSSwizzling *swizzlings, NSUInteger count);
+void HLSSwizzleSelectors(Class clazz, const HLSSwizzling *swizzlings, NSUInteger count);
@@ -8,8 +8,54 @@
 
 #import "HLSRuntime.h"
 
+#import "HLSLaunchTrace.h"
+
+#import <errno.h>
+#import <fcntl.h>
+
+/**
+ * Private Objective-C runtime hook called when a message is about to be logged (instead of writing it to the
+ * /tmp/msgSends-XXXX file). The return value tells whether the method can be cached, i.e. whether further identical
+ * message sends can skip logging
+ */
+typedef BOOL (*HLSObjCLogProc)(BOOL isClassMethod, const char *objectsClass, const char *implementingClass, SEL selector);
+void logObjcMessageSends(HLSObjCLogProc logProc);
+
+/**
+ * Parameters of a profiling session, passed to the profiling queue when it starts
+ */
+typedef struct {
+    char **classNames;
+    NSUInteger classNameCount;
+    int fileDescriptor;
+    NSTimeInterval windowDuration;
+    NSTimeInterval samplingInterval;
+} HLSMessageSendProfilingParameters;
+
+// Function declarations
+static BOOL HLSMessageSendProfilingLog(BOOL isClassMethod, const char *objectsClass, const char *implementingClass, SEL selector);
+static void createProfilingQueue(void *context);
+static void startProfiling(void *context);
+static void stopProfiling(void *context);
+static void openProfilingWindow(void *context);
+static void closeProfilingWindow(void *context);
+
+// Profiling state, only updated on the profiling queue
+static dispatch_queue_t s_profilingQueue = NULL;
+static dispatch_source_t s_profilingTimer = NULL;
+static int32_t s_profilingGeneration = 0;
+static char **s_profilingClassNames = NULL;
+static NSUInteger s_profilingClassNameCount = 0;
+static int s_profilingFileDescriptor = -1;
+static NSTimeInterval s_profilingWindowDuration = 0.;
+
+// Set by the log hook if the profiling file cannot be written anymore (reported when profiling stops)
+static volatile BOOL s_profilingWriteFailed = NO;
+
 IMP HLSSwizzleClassSelector(Class clazz, SEL selector, IMP newImplementation)
 {
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    
     // Get the original implementation we are replacing
     Class metaClass = objc_getMetaClass(class_getName(clazz));
     Method method = class_getClassMethod(metaClass, selector);
@@ -19,11 +65,14 @@ IMP HLSSwizzleClassSelector(Class clazz, SEL selector, IMP newImplementation)
     }
     
     class_replaceMethod(metaClass, selector, newImplementation, method_getTypeEncoding(method));
+    HLSLaunchTraceRecord(class_getName(clazz), sel_getName(selector), startTime);
     return origImp;
 }
 
 IMP HLSSwizzleSelector(Class clazz, SEL selector, IMP newImplementation)
 {
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    
     // Get the original implementation we are replacing
     Method method = class_getInstanceMethod(clazz, selector);
     IMP origImp = method_getImplementation(method);
@@ -32,5 +81,242 @@ IMP HLSSwizzleSelector(Class clazz, SEL selector, IMP newImplementation)
     }
     
     class_replaceMethod(clazz, selector, newImplementation, method_getTypeEncoding(method));
+    HLSLaunchTraceRecord(class_getName(clazz), sel_getName(selector), startTime);
     return origImp;
 }
+
+static void HLSSwizzleSelectorsInClass(Class clazz, const HLSSwizzling *swizzlings, NSUInteger count)
+{
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    
+    // Methods implemented by the class itself (not inherited ones)
+    unsigned int numberOfMethods = 0;
+    Method *methods = class_copyMethodList(clazz, &numberOfMethods);
+    
+    for (NSUInteger i = 0; i < count; ++i) {
+        const HLSSwizzling *swizzling = &swizzlings[i];
+        
+#ifndef NS_BLOCK_ASSERTIONS
+        for (NSUInteger j = 0; j < i; ++j) {
+            NSCAssert(! sel_isEqual(swizzlings[j].selector, swizzling->selector), @"The selector %s is swizzled twice", 
+                      sel_getName(swizzling->selector));
+        }
+#endif
+        
+        Method method = NULL;
+        for (unsigned int j = 0; j < numberOfMethods; ++j) {
+            if (sel_isEqual(method_getName(methods[j]), swizzling->selector)) {
+                method = methods[j];
+                break;
+            }
+        }
+        
+        IMP origImp = NULL;
+        
+        // Implemented by the class itself: Swizzle in place
+        if (method) {
+            NSCAssert(method_getImplementation(method) != swizzling->newImplementation, @"The method %s of class %s has already "
+                      "been swizzled", sel_getName(swizzling->selector), class_getName(clazz));
+            origImp = method_setImplementation(method, swizzling->newImplementation);
+        }
+        // Inherited: Override
+        else {
+            // Might not exist (e.g. methods not available on older iOS versions)
+            Method inheritedMethod = class_getInstanceMethod(clazz, swizzling->selector);
+            origImp = method_getImplementation(inheritedMethod);
+            if (origImp) {
+                class_addMethod(clazz, swizzling->selector, swizzling->newImplementation, method_getTypeEncoding(inheritedMethod));
+            }
+        }
+        
+        if (swizzling->pOriginalImplementation) {
+            *swizzling->pOriginalImplementation = origImp;
+        }
+    }
+    
+    free(methods);
+    
+    HLSLaunchTraceRecord(class_getName(clazz), "(batch)", startTime);
+}
+
+void HLSSwizzleClassSelectors(Class clazz, const HLSSwizzling *swizzlings, NSUInteger count)
+{
+    HLSSwizzleSelectorsInClass(objc_getMetaClass(class_getName(clazz)), swizzlings, count);
+}
+
+void HLSSwizzleSelectors(Class clazz, const HLSSwizzling *swizzlings, NSUInteger count)
+{
+    HLSSwizzleSelectorsInClass(clazz, swizzlings, count);
+}
+
+#pragma mark Message send profiling
+
+NSString *HLSMessageSendProfilingFilePath(void)
+{
+    NSString *cachesDirectoryPath = [NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES) objectAtIndex:0];
+    NSString *fileName = [NSString stringWithFormat:@"msgSends-%d", [[NSProcessInfo processInfo] processIdentifier]];
+    return [cachesDirectoryPath stringByAppendingPathComponent:fileName];
+}
+
+void HLSMessageSendProfilingStart(NSArray *classNames, NSTimeInterval windowDuration, NSTimeInterval samplingInterval)
+{
+    HLSMessageSendProfilingStop();
+    
+    // Class names are copied as C strings, the log hook must not send any message
+    NSUInteger classNameCount = [classNames count];
+    char **profilingClassNames = classNameCount != 0 ? calloc(classNameCount, sizeof(char *)) : NULL;
+    for (NSUInteger i = 0; i < classNameCount; ++i) {
+        profilingClassNames[i] = strdup([[classNames objectAtIndex:i] UTF8String]);
+    }
+    
+    int fileDescriptor = open([HLSMessageSendProfilingFilePath() fileSystemRepresentation], O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    if (fileDescriptor == -1) {
+        HLSLoggerError(@"Could not open the message send profiling file");
+        for (NSUInteger i = 0; i < classNameCount; ++i) {
+            free(profilingClassNames[i]);
+        }
+        free(profilingClassNames);
+        return;
+    }
+    
+    HLSMessageSendProfilingParameters parameters;
+    parameters.classNames = profilingClassNames;
+    parameters.classNameCount = classNameCount;
+    parameters.fileDescriptor = fileDescriptor;
+    parameters.windowDuration = windowDuration;
+    parameters.samplingInterval = samplingInterval;
+    dispatch_sync_f(s_profilingQueue, &parameters, startProfiling);
+}
+
+void HLSMessageSendProfilingStop(void)
+{
+    static dispatch_once_t s_onceToken;
+    dispatch_once_f(&s_onceToken, NULL, createProfilingQueue);
+    
+    dispatch_sync_f(s_profilingQueue, NULL, stopProfiling);
+}
+
+static void createProfilingQueue(void *context)
+{
+    s_profilingQueue = dispatch_queue_create("ch.hortis.CoconutKit.messageSendProfiling", NULL);
+}
+
+// Called on the profiling queue. The context is a pointer to the HLSMessageSendProfilingParameters of the session
+static void startProfiling(void *context)
+{
+    HLSMessageSendProfilingParameters *pParameters = (HLSMessageSendProfilingParameters *)context;
+    s_profilingClassNames = pParameters->classNames;
+    s_profilingClassNameCount = pParameters->classNameCount;
+    s_profilingFileDescriptor = pParameters->fileDescriptor;
+    s_profilingWindowDuration = pParameters->windowDuration;
+    s_profilingWriteFailed = NO;
+    logObjcMessageSends(HLSMessageSendProfilingLog);
+    
+    if (pParameters->windowDuration <= 0.) {
+        instrumentObjcMessageSends(YES);
+        return;
+    }
+    
+    s_profilingTimer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, s_profilingQueue);
+    dispatch_source_set_timer(s_profilingTimer, dispatch_time(DISPATCH_TIME_NOW, 0), 
+                              MAX(pParameters->samplingInterval, pParameters->windowDuration) * NSEC_PER_SEC, 0.01 * NSEC_PER_SEC);
+    dispatch_source_set_event_handler_f(s_profilingTimer, openProfilingWindow);
+    dispatch_resume(s_profilingTimer);
+}
+
+// Called on the profiling queue
+static void stopProfiling(void *context)
+{
+    if (s_profilingFileDescriptor == -1) {
+        return;
+    }
+    
+    ++s_profilingGeneration;
+    if (s_profilingTimer) {
+        dispatch_source_cancel(s_profilingTimer);
+        dispatch_release(s_profilingTimer);
+        s_profilingTimer = NULL;
+    }
+    
+    // Disabling instrumentation flushes method caches under the runtime lock, which the runtime also holds when 
+    // calling the log hook. No hook call is therefore pending afterwards, and the state can be safely released
+    instrumentObjcMessageSends(NO);
+    logObjcMessageSends(NULL);
+    
+    if (s_profilingWriteFailed) {
+        HLSLoggerError(@"The message send profiling file could not be entirely written");
+    }
+    
+    close(s_profilingFileDescriptor);
+    s_profilingFileDescriptor = -1;
+    for (NSUInteger i = 0; i < s_profilingClassNameCount; ++i) {
+        free(s_profilingClassNames[i]);
+    }
+    free(s_profilingClassNames);
+    s_profilingClassNames = NULL;
+    s_profilingClassNameCount = 0;
+}
+
+// Timer event handler, called on the profiling queue. Each window ends on its own, unless profiling has been stopped 
+// or restarted meanwhile (the context of the window end is the generation it belongs to)
+static void openProfilingWindow(void *context)
+{
+    instrumentObjcMessageSends(YES);
+    dispatch_after_f(dispatch_time(DISPATCH_TIME_NOW, s_profilingWindowDuration * NSEC_PER_SEC), s_profilingQueue, 
+                     (void *)(intptr_t)s_profilingGeneration, closeProfilingWindow);
+}
+
+// Called on the profiling queue
+static void closeProfilingWindow(void *context)
+{
+    if ((int32_t)(intptr_t)context == s_profilingGeneration) {
+        instrumentObjcMessageSends(NO);
+    }
+}
+
+/**
+ * Called by the runtime (which holds its lock) for method cache misses while instrumentation is enabled. Neither
+ * Objective-C messages nor allocations here
+ */
+static BOOL HLSMessageSendProfilingLog(BOOL isClassMethod, const char *objectsClass, const char *implementingClass, SEL selector)
+{
+    if (s_profilingClassNameCount != 0) {
+        BOOL profiled = NO;
+        for (NSUInteger i = 0; i < s_profilingClassNameCount; ++i) {
+            if (strcmp(objectsClass, s_profilingClassNames[i]) == 0 || strcmp(implementingClass, s_profilingClassNames[i]) == 0) {
+                profiled = YES;
+                break;
+            }
+        }
+        
+        // Let the runtime cache methods of classes which are not profiled, so that they are not slowed down
+        if (! profiled) {
+            return YES;
+        }
+    }
+    
+    char line[1024];
+    int length = snprintf(line, sizeof(line), "%c %s %s %s\n", isClassMethod ? '+' : '-', objectsClass, implementingClass, 
+                          sel_getName(selector));
+    if (length > 0 && ! s_profilingWriteFailed) {
+        const char *buffer = line;
+        size_t remainingLength = MIN(length, (int)sizeof(line) - 1);
+        while (remainingLength != 0) {
+            ssize_t writtenLength = write(s_profilingFileDescriptor, buffer, remainingLength);
+            if (writtenLength == -1) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                
+                // Cannot log here. Stop writing, the failure is reported when profiling stops
+                s_profilingWriteFailed = YES;
+                break;
+            }
+            buffer += writtenLength;
+            remainingLength -= writtenLength;
+        }
+    }
+    
+    // Never cache profiled methods, so that each message send is logged
+    return NO;
+}
@@ -0,0 +1,83 @@
+//
+//  HLSSearchIndex.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 15.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import <pthread.h>
+
+// Forward declarations
+@class HLSCancellationToken;
+
+/**
+ * A search index finds the objects whose string values for a set of key paths contain some search text (case and
+ * diacritic insensitive, as a CONTAINS[cd] predicate would), without scanning all objects for each search:
+ *   - the values of the indexed key paths are normalized once, when an object is added to the index
+ *   - the trigrams (sequences of 3 characters) of the normalized values are indexed, so that candidates for search
+ *     texts of 3 characters or more are obtained by intersecting the objects containing each of their trigrams
+ *   - when a search text only narrows the previous one (e.g. when a character is appended while the user types),
+ *     only the previous results are considered, even if the scope has changed
+ *
+ * Objects can belong to a set of scopes (usually the scope buttons of a search bar), and searches are performed
+ * within a scope. Results are returned in the order in which objects have been added to the index.
+ *
+ * The index can be updated incrementally when objects are added, changed or removed. Objects are not observed,
+ * the index must therefore be told when an object has changed (by adding it again).
+ *
+ * This class is thread-safe. Searches are meant to be performed on a background thread, for example by the
+ * asynchronous search of HLSTableSearchDisplayViewController (see its searchIndex property)
+ *
+ * Designated initializer: -initWithKeyPaths:
+ */
+@interface HLSSearchIndex : NSObject {
+@private
+    NSArray *_keyPaths;
+    CFMutableDictionaryRef _objectToEntryMap;
+    NSMutableDictionary *_trigramToEntriesMap;
+    NSArray *_orderedEntries;
+    NSUInteger _nextSerialNumber;
+    NSString *_previousNormalizedSearchText;
+    NSArray *_previousResultEntries;
+    pthread_mutex_t _mutex;
+}
+
+/**
+ * Create an index for the string values of the given key paths
+ */
+- (id)initWithKeyPaths:(NSArray *)keyPaths;
+
+/**
+ * The indexed key paths
+ */
+@property (nonatomic, readonly, retain) NSArray *keyPaths;
+
+/**
+ * The number of objects in the index
+ */
+@property (nonatomic, readonly, assign) NSUInteger count;
+
+/**
+ * Add an object to the index, for the scopes whose indexes are given (nil if the object belongs to all scopes). If
+ * the object is already in the index, it is updated with its current values and the new scopes. Objects are retained
+ * and compared by identity
+ */
+- (void)addObject:(id)object scopeButtonIndexes:(NSIndexSet *)scopeButtonIndexes;
+
+/**
+ * Remove a single object, or all objects from the index
+ */
+- (void)removeObject:(id)object;
+- (void)removeAllObjects;
+
+/**
+ * Return the objects belonging to a scope and matching a search text, in the order in which they have been added. If
+ * the search text is empty, all objects belonging to the scope are returned. If a cancellation token is provided and
+ * gets cancelled during the search, the method returns nil
+ */
+- (NSArray *)objectsMatchingSearchText:(NSString *)searchText
+                      scopeButtonIndex:(NSInteger)scopeButtonIndex
+                     cancellationToken:(HLSCancellationToken *)cancellationToken;
+
+@end
@@ -0,0 +1,427 @@
+//
+//  HLSSearchIndex.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 15.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSSearchIndex.h"
+
+#import "HLSAssert.h"
+#import "HLSCancellationToken.h"
+#import "HLSLogger.h"
+
+// Number of characters of indexed sequences
+static const NSUInteger kSearchIndexTrigramLength = 3;
+
+// Number of candidates checked between two cancellation tests
+static const NSUInteger kSearchIndexCancellationCheckInterval = 256;
+
+// Static helper functions
+static NSString *normalizedString(NSString *string);
+static NSSet *trigramsForString(NSString *string);
+static NSInteger compareSetsByCount(id set1, id set2, void *context);
+
+/**
+ * Private class storing what is known about an indexed object
+ */
+@interface HLSSearchIndexEntry : NSObject {
+@private
+    id _object;
+    NSArray *_normalizedValues;
+    NSIndexSet *_scopeButtonIndexes;
+    NSUInteger _serialNumber;
+}
+
+@property (nonatomic, retain) id object;
+@property (nonatomic, retain) NSArray *normalizedValues;
+@property (nonatomic, retain) NSIndexSet *scopeButtonIndexes;
+@property (nonatomic, assign) NSUInteger serialNumber;
+
+- (BOOL)belongsToScopeButtonIndex:(NSInteger)scopeButtonIndex;
+- (BOOL)matchesNormalizedSearchText:(NSString *)normalizedSearchText;
+
+- (NSComparisonResult)compareSerialNumber:(HLSSearchIndexEntry *)entry;
+
+@end
+
+@interface HLSSearchIndex ()
+
+@property (nonatomic, retain) NSArray *keyPaths;
+@property (nonatomic, retain) NSArray *orderedEntries;
+@property (nonatomic, retain) NSString *previousNormalizedSearchText;
+@property (nonatomic, retain) NSArray *previousResultEntries;
+
+- (void)removeEntry:(HLSSearchIndexEntry *)entry;
+- (void)invalidateCachedEntries;
+
+@end
+
+@implementation HLSSearchIndex
+
+#pragma mark Object creation and destruction
+
+- (id)initWithKeyPaths:(NSArray *)keyPaths
+{
+    if ((self = [super init])) {
+        if ([keyPaths count] == 0) {
+            HLSLoggerError(@"At least one key path must be indexed");
+            [self release];
+            return nil;
+        }
+        
+        self.keyPaths = keyPaths;
+        
+        // Objects are compared by identity
+        CFDictionaryKeyCallBacks keyCallBacks = kCFTypeDictionaryKeyCallBacks;
+        keyCallBacks.equal = NULL;
+        keyCallBacks.hash = NULL;
+        _objectToEntryMap = CFDictionaryCreateMutable(kCFAllocatorDefault, 0, &keyCallBacks, &kCFTypeDictionaryValueCallBacks);
+        
+        _trigramToEntriesMap = [[NSMutableDictionary alloc] init];
+        
+        pthread_mutex_init(&_mutex, NULL);
+    }
+    return self;
+}
+
+- (id)init
+{
+    HLSForbiddenInheritedMethod();
+    return nil;
+}
+
+- (void)dealloc
+{
+    self.keyPaths = nil;
+    self.orderedEntries = nil;
+    self.previousNormalizedSearchText = nil;
+    self.previousResultEntries = nil;
+    
+    CFRelease(_objectToEntryMap);
+    [_trigramToEntriesMap release];
+    
+    pthread_mutex_destroy(&_mutex);
+    
+    [super dealloc];
+}
+
+#pragma mark Accessors and mutators
+
+@synthesize keyPaths = _keyPaths;
+
+@synthesize orderedEntries = _orderedEntries;
+
+@synthesize previousNormalizedSearchText = _previousNormalizedSearchText;
+
+@synthesize previousResultEntries = _previousResultEntries;
+
+- (NSUInteger)count
+{
+    pthread_mutex_lock(&_mutex);
+    NSUInteger count = CFDictionaryGetCount(_objectToEntryMap);
+    pthread_mutex_unlock(&_mutex);
+    return count;
+}
+
+#pragma mark Updating the index
+
+- (void)addObject:(id)object scopeButtonIndexes:(NSIndexSet *)scopeButtonIndexes
+{
+    if (! object) {
+        HLSLoggerError(@"Missing object");
+        return;
+    }
+    
+    // Values are read and normalized outside the lock
+    NSMutableArray *normalizedValues = [NSMutableArray arrayWithCapacity:[self.keyPaths count]];
+    NSMutableSet *trigrams = [NSMutableSet set];
+    for (NSString *keyPath in self.keyPaths) {
+        id value = [object valueForKeyPath:keyPath];
+        if (! value || value == [NSNull null]) {
+            continue;
+        }
+        
+        NSString *normalizedValue = normalizedString([value description]);
+        if ([normalizedValue length] == 0) {
+            continue;
+        }
+        
+        [normalizedValues addObject:normalizedValue];
+        [trigrams unionSet:trigramsForString(normalizedValue)];
+    }
+    
+    HLSSearchIndexEntry *entry = [[[HLSSearchIndexEntry alloc] init] autorelease];
+    entry.object = object;
+    entry.normalizedValues = [NSArray arrayWithArray:normalizedValues];
+    entry.scopeButtonIndexes = scopeButtonIndexes;
+    
+    pthread_mutex_lock(&_mutex);
+    
+    HLSSearchIndexEntry *existingEntry = (HLSSearchIndexEntry *)CFDictionaryGetValue(_objectToEntryMap, object);
+    if (existingEntry) {
+        // Keep the position of the object in the results
+        entry.serialNumber = existingEntry.serialNumber;
+        [self removeEntry:existingEntry];
+    }
+    else {
+        entry.serialNumber = _nextSerialNumber++;
+    }
+    
+    CFDictionarySetValue(_objectToEntryMap, object, entry);
+    for (NSString *trigram in trigrams) {
+        NSMutableSet *entries = [_trigramToEntriesMap objectForKey:trigram];
+        if (! entries) {
+            entries = [NSMutableSet set];
+            [_trigramToEntriesMap setObject:entries forKey:trigram];
+        }
+        [entries addObject:entry];
+    }
+    [self invalidateCachedEntries];
+    
+    pthread_mutex_unlock(&_mutex);
+}
+
+- (void)removeObject:(id)object
+{
+    if (! object) {
+        return;
+    }
+    
+    pthread_mutex_lock(&_mutex);
+    
+    HLSSearchIndexEntry *entry = (HLSSearchIndexEntry *)CFDictionaryGetValue(_objectToEntryMap, object);
+    if (entry) {
+        [self removeEntry:entry];
+        [self invalidateCachedEntries];
+    }
+    
+    pthread_mutex_unlock(&_mutex);
+}
+
+- (void)removeAllObjects
+{
+    pthread_mutex_lock(&_mutex);
+    
+    CFDictionaryRemoveAllValues(_objectToEntryMap);
+    [_trigramToEntriesMap removeAllObjects];
+    [self invalidateCachedEntries];
+    
+    pthread_mutex_unlock(&_mutex);
+}
+
+// Must be called with the mutex locked
+- (void)removeEntry:(HLSSearchIndexEntry *)entry
+{
+    // Retained since the map is the only owner
+    [[entry retain] autorelease];
+    
+    for (NSString *normalizedValue in entry.normalizedValues) {
+        for (NSString *trigram in trigramsForString(normalizedValue)) {
+            NSMutableSet *entries = [_trigramToEntriesMap objectForKey:trigram];
+            [entries removeObject:entry];
+            if ([entries count] == 0) {
+                [_trigramToEntriesMap removeObjectForKey:trigram];
+            }
+        }
+    }
+    CFDictionaryRemoveValue(_objectToEntryMap, entry.object);
+}
+
+// Must be called with the mutex locked
+- (void)invalidateCachedEntries
+{
+    self.orderedEntries = nil;
+    self.previousNormalizedSearchText = nil;
+    self.previousResultEntries = nil;
+}
+
+#pragma mark Searching
+
+- (NSArray *)objectsMatchingSearchText:(NSString *)searchText
+                      scopeButtonIndex:(NSInteger)scopeButtonIndex
+                     cancellationToken:(HLSCancellationToken *)cancellationToken
+{
+    NSString *normalizedSearchText = normalizedString(searchText);
+    NSUInteger searchTextLength = [normalizedSearchText length];
+    
+    pthread_mutex_lock(&_mutex);
+    
+    // Narrowing the previous search (search text containing the previous one): Only previous results can match
+    NSArray *candidateEntries = nil;
+    BOOL verified = NO;
+    if (self.previousNormalizedSearchText
+            && [normalizedSearchText rangeOfString:self.previousNormalizedSearchText options:NSLiteralSearch].length != 0) {
+        candidateEntries = self.previousResultEntries;
+        verified = [normalizedSearchText isEqualToString:self.previousNormalizedSearchText];
+    }
+    // Long enough to use trigrams. Start with the smallest set of objects containing one of them
+    else if (searchTextLength >= kSearchIndexTrigramLength) {
+        NSMutableArray *entrySets = [NSMutableArray array];
+        for (NSString *trigram in trigramsForString(normalizedSearchText)) {
+            NSSet *entries = [_trigramToEntriesMap objectForKey:trigram];
+            if (! entries) {
+                entrySets = nil;
+                break;
+            }
+            [entrySets addObject:entries];
+        }
+        
+        if (entrySets) {
+            [entrySets sortUsingFunction:compareSetsByCount context:NULL];
+            NSMutableSet *candidateEntrySet = [NSMutableSet setWithSet:[entrySets objectAtIndex:0]];
+            for (NSUInteger i = 1; i < [entrySets count] && [candidateEntrySet count] != 0; ++i) {
+                [candidateEntrySet intersectSet:[entrySets objectAtIndex:i]];
+            }
+            candidateEntries = [[candidateEntrySet allObjects] sortedArrayUsingSelector:@selector(compareSerialNumber:)];
+        }
+        else {
+            candidateEntries = [NSArray array];
+        }
+        
+        // Trigrams locate the exact search text only if it is itself a trigram
+        verified = (searchTextLength == kSearchIndexTrigramLength);
+    }
+    // Too short: All objects are candidates
+    else {
+        if (! self.orderedEntries) {
+            NSArray *entries = [(NSDictionary *)_objectToEntryMap allValues];
+            self.orderedEntries = [entries sortedArrayUsingSelector:@selector(compareSerialNumber:)];
+        }
+        candidateEntries = self.orderedEntries;
+        verified = (searchTextLength == 0);
+    }
+    
+    // Check the candidates
+    NSMutableArray *resultEntries = [NSMutableArray array];
+    NSMutableArray *objects = [NSMutableArray array];
+    BOOL cancelled = NO;
+    NSUInteger index = 0;
+    for (HLSSearchIndexEntry *entry in candidateEntries) {
+        if (index++ % kSearchIndexCancellationCheckInterval == 0 && [cancellationToken isCancelled]) {
+            cancelled = YES;
+            break;
+        }
+        
+        if (! verified && ! [entry matchesNormalizedSearchText:normalizedSearchText]) {
+            continue;
+        }
+        
+        [resultEntries addObject:entry];
+        if ([entry belongsToScopeButtonIndex:scopeButtonIndex]) {
+            [objects addObject:entry.object];
+        }
+    }
+    
+    // Remember the entries matching the search text. Scopes are not taken into account, so that they can be reused
+    // when the scope changes as well
+    if (! cancelled && searchTextLength != 0) {
+        self.previousNormalizedSearchText = normalizedSearchText;
+        self.previousResultEntries = [NSArray arrayWithArray:resultEntries];
+    }
+    
+    pthread_mutex_unlock(&_mutex);
+    
+    return cancelled ? nil : [NSArray arrayWithArray:objects];
+}
+
+@end
+
+@implementation HLSSearchIndexEntry
+
+#pragma mark Object creation and destruction
+
+- (void)dealloc
+{
+    self.object = nil;
+    self.normalizedValues = nil;
+    self.scopeButtonIndexes = nil;
+    
+    [super dealloc];
+}
+
+#pragma mark Accessors and mutators
+
+@synthesize object = _object;
+
+@synthesize normalizedValues = _normalizedValues;
+
+@synthesize scopeButtonIndexes = _scopeButtonIndexes;
+
+@synthesize serialNumber = _serialNumber;
+
+#pragma mark Matching
+
+- (BOOL)belongsToScopeButtonIndex:(NSInteger)scopeButtonIndex
+{
+    return ! self.scopeButtonIndexes || (scopeButtonIndex >= 0 && [self.scopeButtonIndexes containsIndex:scopeButtonIndex]);
+}
+
+- (BOOL)matchesNormalizedSearchText:(NSString *)normalizedSearchText
+{
+    for (NSString *normalizedValue in self.normalizedValues) {
+        if ([normalizedValue rangeOfString:normalizedSearchText options:NSLiteralSearch].length != 0) {
+            return YES;
+        }
+    }
+    return NO;
+}
+
+#pragma mark Sorting
+
+- (NSComparisonResult)compareSerialNumber:(HLSSearchIndexEntry *)entry
+{
+    if (self.serialNumber < entry.serialNumber) {
+        return NSOrderedAscending;
+    }
+    else if (self.serialNumber > entry.serialNumber) {
+        return NSOrderedDescending;
+    }
+    else {
+        return NSOrderedSame;
+    }
+}
+
+@end
+
+#pragma mark Static helper functions
+
+/**
+ * Return a case and diacritic insensitive version of a string
+ */
+static NSString *normalizedString(NSString *string)
+{
+    if (! string) {
+        return @"";
+    }
+    
+    return [string stringByFoldingWithOptions:NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch locale:nil];
+}
+
+/**
+ * Return all distinct trigrams contained in a string
+ */
+static NSSet *trigramsForString(NSString *string)
+{
+    NSUInteger length = [string length];
+    if (length < kSearchIndexTrigramLength) {
+        return [NSSet set];
+    }
+    
+    NSMutableSet *trigrams = [NSMutableSet setWithCapacity:length - kSearchIndexTrigramLength + 1];
+    for (NSUInteger i = 0; i <= length - kSearchIndexTrigramLength; ++i) {
+        [trigrams addObject:[string substringWithRange:NSMakeRange(i, kSearchIndexTrigramLength)]];
+    }
+    return trigrams;
+}
+
+/**
+ * Order sets by increasing number of elements
+ */
+static NSInteger compareSetsByCount(id set1, id set2, void *context)
+{
+    NSUInteger count1 = [set1 count];
+    NSUInteger count2 = [set2 count];
+    return (count1 < count2) ? NSOrderedAscending : (count1 > count2) ? NSOrderedDescending : NSOrderedSame;
+}
@@ -8,10 +8,22 @@
 
 #import "HLSStandardFileManager.h"
 
+#import "HLSLaunchTrace.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Size of the buffer used to read files when computing digests
+static const size_t kDigestBufferLength = 256 * 1024;
+
 __attribute__ ((constructor)) static void HLSStandardFileManagerInstall(void)
 {
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
     HLSStandardFileManager *fileManager = [[[HLSStandardFileManager alloc] init] autorelease];
     [HLSFileManager setDefaultManager:fileManager];
+    HLSLaunchTraceRecord("HLSStandardFileManagerInstall", NULL, startTime);
 }
 
 @implementation HLSStandardFileManager
@@ -23,11 +35,169 @@ __attribute__ ((constructor)) static void HLSStandardFileManagerInstall(void)
     return [NSData dataWithContentsOfFile:path options:NSDataReadingMappedIfSafe error:pError];
 }
 
+- (NSData *)contentsOfFileAtPath:(NSString *)path range:(NSRange)range error:(NSError **)pError
+{
+    int fileDescriptor = open([path fileSystemRepresentation], O_RDONLY);
+    if (fileDescriptor < 0) {
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSPOSIXErrorDomain 
+                                          code:errno 
+                                      userInfo:[NSDictionary dictionaryWithObject:path forKey:NSFilePathErrorKey]];
+        }
+        return nil;
+    }
+    
+    struct stat fileStat;
+    if (fstat(fileDescriptor, &fileStat) != 0) {
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSPOSIXErrorDomain 
+                                          code:errno 
+                                      userInfo:[NSDictionary dictionaryWithObject:path forKey:NSFilePathErrorKey]];
+        }
+        close(fileDescriptor);
+        return nil;
+    }
+    
+    // Only read the bytes requested (less if the end of the file is reached). Large ranges are common (e.g. to read
+    // until the end of the file), the buffer must therefore not be larger than the file
+    unsigned long long fileSize = (unsigned long long)fileStat.st_size;
+    NSUInteger length = 0;
+    if (range.location < fileSize) {
+        length = (NSUInteger)MIN((unsigned long long)range.length, fileSize - range.location);
+    }
+    
+    NSMutableData *contents = [NSMutableData dataWithLength:length];
+    size_t totalReadLength = 0;
+    BOOL success = YES;
+    while (totalReadLength < length) {
+        ssize_t readLength = pread(fileDescriptor, 
+                                   (char *)[contents mutableBytes] + totalReadLength, 
+                                   length - totalReadLength, 
+                                   range.location + totalReadLength);
+        if (readLength == 0) {
+            break;
+        }
+        else if (readLength < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (pError) {
+                *pError = [NSError errorWithDomain:NSPOSIXErrorDomain 
+                                              code:errno 
+                                          userInfo:[NSDictionary dictionaryWithObject:path forKey:NSFilePathErrorKey]];
+            }
+            success = NO;
+            break;
+        }
+        totalReadLength += readLength;
+    }
+    close(fileDescriptor);
+    
+    if (! success) {
+        return nil;
+    }
+    
+    [contents setLength:totalReadLength];
+    return contents;
+}
+
+- (NSInputStream *)inputStreamForFileAtPath:(NSString *)path
+{
+    if (! [[NSFileManager defaultManager] isReadableFileAtPath:path]) {
+        return nil;
+    }
+    return [NSInputStream inputStreamWithFileAtPath:path];
+}
+
+- (NSOutputStream *)outputStreamToFileAtPath:(NSString *)path append:(BOOL)append
+{
+    return [NSOutputStream outputStreamToFileAtPath:path append:append];
+}
+
 - (BOOL)createFileAtPath:(NSString *)path contents:(NSData *)contents error:(NSError **)pError
 {
     return [contents writeToFile:path options:NSDataWritingAtomic error:pError];
 }
 
+- (BOOL)appendContents:(NSData *)contents toFileAtPath:(NSString *)path error:(NSError **)pError
+{
+    if (! [[NSFileManager defaultManager] fileExistsAtPath:path]) {
+        return [self createFileAtPath:path contents:contents error:pError];
+    }
+    
+    NSFileHandle *fileHandle = [NSFileHandle fileHandleForWritingAtPath:path];
+    if (! fileHandle) {
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSCocoaErrorDomain 
+                                          code:NSFileWriteUnknownError 
+                                      userInfo:[NSDictionary dictionaryWithObject:path forKey:NSFilePathErrorKey]];
+        }
+        return NO;
+    }
+    
+    // Remark: -writeData: raises an exception on failure
+    BOOL success = YES;
+    @try {
+        [fileHandle seekToEndOfFile];
+        [fileHandle writeData:contents];
+    }
+    @catch (NSException *exception) {
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSCocoaErrorDomain 
+                                          code:NSFileWriteUnknownError 
+                                      userInfo:[NSDictionary dictionaryWithObject:path forKey:NSFilePathErrorKey]];
+        }
+        success = NO;
+    }
+    [fileHandle closeFile];
+    return success;
+}
+
+- (NSString *)hexDigestOfFileAtPath:(NSString *)path usingAlgorithm:(HLSDigestAlgorithm)algorithm error:(NSError **)pError
+{
+    HLSDigest *digest = [[[HLSDigest alloc] initWithAlgorithm:algorithm] autorelease];
+    
+    // Read the file in fixed-size chunks, so that memory use does not depend on the file size
+    int fileDescriptor = open([path fileSystemRepresentation], O_RDONLY);
+    if (fileDescriptor < 0) {
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSPOSIXErrorDomain 
+                                          code:errno 
+                                      userInfo:[NSDictionary dictionaryWithObject:path forKey:NSFilePathErrorKey]];
+        }
+        return nil;
+    }
+    
+    // No need to keep read pages in the cache
+    fcntl(fileDescriptor, F_NOCACHE, 1);
+    
+    void *buffer = malloc(kDigestBufferLength);
+    ssize_t readLength = 0;
+    while ((readLength = read(fileDescriptor, buffer, kDigestBufferLength)) != 0) {
+        if (readLength < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        [digest updateWithBytes:buffer length:readLength];
+    }
+    int readErrno = errno;
+    free(buffer);
+    close(fileDescriptor);
+    
+    if (readLength < 0) {
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSPOSIXErrorDomain 
+                                          code:readErrno 
+                                      userInfo:[NSDictionary dictionaryWithObject:path forKey:NSFilePathErrorKey]];
+        }
+        return nil;
+    }
+    
+    return [digest finalHexDigest];
+}
+
 - (BOOL)createDirectoryAtPath:(NSString *)path withIntermediateDirectories:(BOOL)withIntermediateDirectories error:(NSError **)pError
 {
     return [[NSFileManager defaultManager] createDirectoryAtPath:path withIntermediateDirectories:withIntermediateDirectories attributes:nil error:pError];
@@ -38,6 +208,31 @@ __attribute__ ((constructor)) static void HLSStandardFileManagerInstall(void)
     return [[NSFileManager defaultManager] contentsOfDirectoryAtPath:path error:pError];
 }
 
+- (NSArray *)entriesOfDirectoryAtPath:(NSString *)path error:(NSError **)pError
+{
+    // All attributes are fetched when the directory is read
+    NSArray *keys = [NSArray arrayWithObjects:NSURLIsDirectoryKey, NSURLFileSizeKey, NSURLContentModificationDateKey, nil];
+    NSArray *itemURLs = [[NSFileManager defaultManager] contentsOfDirectoryAtURL:[NSURL fileURLWithPath:path]
+                                                      includingPropertiesForKeys:keys
+                                                                         options:0
+                                                                           error:pError];
+    if (! itemURLs) {
+        return nil;
+    }
+    
+    NSMutableArray *entries = [NSMutableArray arrayWithCapacity:[itemURLs count]];
+    for (NSURL *itemURL in itemURLs) {
+        NSDictionary *resourceValues = [itemURL resourceValuesForKeys:keys error:NULL];
+        NSString *itemPath = [path stringByAppendingPathComponent:[itemURL lastPathComponent]];
+        HLSDirectoryEntry *entry = [[[HLSDirectoryEntry alloc] initWithPath:itemPath
+                                                                  directory:[[resourceValues objectForKey:NSURLIsDirectoryKey] boolValue]
+                                                                       size:[[resourceValues objectForKey:NSURLFileSizeKey] unsignedLongLongValue]
+                                                           modificationDate:[resourceValues objectForKey:NSURLContentModificationDateKey]] autorelease];
+        [entries addObject:entry];
+    }
+    return [NSArray arrayWithArray:entries];
+}
+
 - (BOOL)fileExistsAtPath:(NSString *)path isDirectory:(BOOL *)pIsDirectory
 {
     return [[NSFileManager defaultManager] fileExistsAtPath:path isDirectory:pIsDirectory];
@@ -0,0 +1,54 @@
+//
+//  HLSURLCache.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+/**
+ * An NSURLCache subclass which stores responses on disk (prior to iOS 5, the NSURLCache used by iOS only keeps
+ * responses in memory). Successful responses to GET requests are stored in the directory specified at creation time, 
+ * up to the disk capacity of the cache, the least recently used responses being evicted first. Responses forbidding 
+ * storage (Cache-Control: no-store, or storage policies not allowing it) are never stored
+ *
+ * Stored responses are always returned when they are requested, even if they are stale. The URL loading system then 
+ * decides whether they can be used as is, depending on the request cache policy, or revalidates them using the HTTP 
+ * validators they carry (ETag and Last-Modified headers). In addition, stale responses are revalidated in the 
+ * background (stale-while-revalidate policy): Requests using the NSURLRequestReturnCacheDataElseLoad cache policy
+ * therefore get an immediate response, which is up-to-date the next time it is requested, and which is available
+ * even when offline.
+ *
+ * To use it, create an instance (with an absolute or relative disk path, the latter being relative to the application
+ * cache directory), and install it by calling +[NSURLCache setSharedURLCache:] as soon as possible, e.g. 
+ * at the beginning of -application:didFinishLaunchingWithOptions:
+ *
+ * This class is thread-safe
+ *
+ * Designated initializer: -initWithMemoryCapacity:diskCapacity:diskPath:
+ */
+@interface HLSURLCache : NSURLCache {
+@private
+    NSString *_cacheDirectoryPath;
+    NSMutableDictionary *_fileNameToSizeMap;
+    NSMutableDictionary *_fileNameToExpirationDateMap;
+    NSMutableArray *_fileNames;
+    NSUInteger _diskUsage;
+    BOOL _revalidatingInBackground;
+    NSMutableSet *_revalidatedFileNames;
+    NSOperationQueue *_revalidationQueue;
+}
+
+/**
+ * If set to YES, stale responses returned by the cache are revalidated in the background
+ *
+ * Default value is YES
+ */
+@property (nonatomic, assign, getter=isRevalidatingInBackground) BOOL revalidatingInBackground;
+
+/**
+ * Return YES iff a response has been stored for the specified request (whether it is stale or not)
+ */
+- (BOOL)hasCachedResponseForRequest:(NSURLRequest *)request;
+
+@end
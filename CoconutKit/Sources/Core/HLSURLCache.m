@@ -0,0 +1,488 @@
+//
+//  HLSURLCache.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSURLCache.h"
+
+#import "HLSLogger.h"
+#import "NSString+HLSExtensions.h"
+
+// Keys of the dictionaries archived on disk
+static NSString * const kEntryCachedResponseKey = @"cachedResponse";
+static NSString * const kEntryDateKey = @"date";
+
+@interface HLSURLCache ()
+
+@property (nonatomic, retain) NSString *cacheDirectoryPath;
+@property (nonatomic, retain) NSMutableDictionary *fileNameToSizeMap;
+@property (nonatomic, retain) NSMutableDictionary *fileNameToExpirationDateMap;
+@property (nonatomic, retain) NSMutableArray *fileNames;
+@property (nonatomic, retain) NSMutableSet *revalidatedFileNames;
+@property (nonatomic, retain) NSOperationQueue *revalidationQueue;
+
+- (NSString *)fileNameForRequest:(NSURLRequest *)request;
+- (BOOL)isCacheableRequest:(NSURLRequest *)request;
+
+- (void)loadIndex;
+- (NSDictionary *)entryWithFileName:(NSString *)fileName;
+- (void)touchFileName:(NSString *)fileName;
+- (void)updateAccessDateOfFileName:(NSString *)fileName;
+- (void)writeEntryWithCachedResponse:(NSCachedURLResponse *)cachedResponse date:(NSDate *)date fileName:(NSString *)fileName;
+- (void)removeEntryWithFileName:(NSString *)fileName;
+- (void)evictEntriesOverCapacity;
+
+- (NSDate *)expirationDateForEntry:(NSDictionary *)entry;
+- (NSDate *)dateFromHTTPDateString:(NSString *)dateString;
+
+- (void)revalidateRequest:(NSURLRequest *)request withCachedResponse:(NSCachedURLResponse *)cachedResponse;
+- (void)performRevalidationWithRequest:(NSURLRequest *)request;
+
+@end
+
+@implementation HLSURLCache
+
+#pragma mark Object creation and destruction
+
+- (id)initWithMemoryCapacity:(NSUInteger)memoryCapacity diskCapacity:(NSUInteger)diskCapacity diskPath:(NSString *)path
+{
+    if ((self = [super initWithMemoryCapacity:memoryCapacity diskCapacity:diskCapacity diskPath:path])) {
+        if (! [path isFilled]) {
+            path = @"HLSURLCache";
+        }
+        if (! [path isAbsolutePath]) {
+            NSString *cachesDirectoryPath = [NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES) objectAtIndex:0];
+            path = [cachesDirectoryPath stringByAppendingPathComponent:path];
+        }
+        self.cacheDirectoryPath = path;
+        
+        NSError *error = nil;
+        if (! [[NSFileManager defaultManager] createDirectoryAtPath:self.cacheDirectoryPath
+                                        withIntermediateDirectories:YES
+                                                         attributes:nil
+                                                              error:&error]) {
+            HLSLoggerError(@"Could not create the cache directory %@. Reason: %@", self.cacheDirectoryPath, error);
+        }
+        
+        self.revalidatingInBackground = YES;
+        self.revalidatedFileNames = [NSMutableSet set];
+        self.revalidationQueue = [[[NSOperationQueue alloc] init] autorelease];
+        [self.revalidationQueue setMaxConcurrentOperationCount:2];
+        
+        [self loadIndex];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [self.revalidationQueue cancelAllOperations];
+    
+    self.cacheDirectoryPath = nil;
+    self.fileNameToSizeMap = nil;
+    self.fileNameToExpirationDateMap = nil;
+    self.fileNames = nil;
+    self.revalidatedFileNames = nil;
+    self.revalidationQueue = nil;
+    
+    [super dealloc];
+}
+
+#pragma mark Accessors and mutators
+
+@synthesize cacheDirectoryPath = _cacheDirectoryPath;
+
+@synthesize fileNameToSizeMap = _fileNameToSizeMap;
+
+@synthesize fileNameToExpirationDateMap = _fileNameToExpirationDateMap;
+
+@synthesize fileNames = _fileNames;
+
+@synthesize revalidatingInBackground = _revalidatingInBackground;
+
+@synthesize revalidatedFileNames = _revalidatedFileNames;
+
+@synthesize revalidationQueue = _revalidationQueue;
+
+- (void)setDiskCapacity:(NSUInteger)diskCapacity
+{
+    [super setDiskCapacity:diskCapacity];
+    
+    @synchronized(self) {
+        [self evictEntriesOverCapacity];
+    }
+}
+
+- (NSUInteger)currentDiskUsage
+{
+    @synchronized(self) {
+        return _diskUsage;
+    }
+}
+
+#pragma mark NSURLCache overrides
+
+- (NSCachedURLResponse *)cachedResponseForRequest:(NSURLRequest *)request
+{
+    NSCachedURLResponse *cachedResponse = [super cachedResponseForRequest:request];
+    if (! [self isCacheableRequest:request]) {
+        return cachedResponse;
+    }
+    
+    NSString *fileName = [self fileNameForRequest:request];
+    NSDate *expirationDate = nil;
+    @synchronized(self) {
+        if (! [self.fileNameToSizeMap objectForKey:fileName]) {
+            return cachedResponse;
+        }
+        
+        [self touchFileName:fileName];
+        expirationDate = [[[self.fileNameToExpirationDateMap objectForKey:fileName] retain] autorelease];
+    }
+    
+    // Disk I/O is performed outside the lock, so that concurrent lookups do not wait on each other. The disk is only 
+    // read if the response is not available in memory (the version in memory is never older), or if its expiration 
+    // date is not known yet (entries found at launch)
+    if (! cachedResponse || ! expirationDate) {
+        NSDictionary *entry = [self entryWithFileName:fileName];
+        NSCachedURLResponse *diskCachedResponse = [entry objectForKey:kEntryCachedResponseKey];
+        if (! diskCachedResponse) {
+            @synchronized(self) {
+                [self removeEntryWithFileName:fileName];
+            }
+            return cachedResponse;
+        }
+        
+        if (! cachedResponse) {
+            cachedResponse = diskCachedResponse;
+        }
+        
+        if (! expirationDate) {
+            @synchronized(self) {
+                expirationDate = [self expirationDateForEntry:entry];
+                if ([self.fileNameToSizeMap objectForKey:fileName]) {
+                    [self.fileNameToExpirationDateMap setObject:expirationDate forKey:fileName];
+                }
+            }
+        }
+    }
+    
+    [self updateAccessDateOfFileName:fileName];
+    
+    BOOL stale = [expirationDate compare:[NSDate date]] != NSOrderedDescending;
+    if (stale && self.revalidatingInBackground) {
+        [self revalidateRequest:request withCachedResponse:cachedResponse];
+    }
+    
+    return cachedResponse;
+}
+
+- (void)storeCachedResponse:(NSCachedURLResponse *)cachedResponse forRequest:(NSURLRequest *)request
+{
+    [super storeCachedResponse:cachedResponse forRequest:request];
+    
+    if (! [self isCacheableRequest:request] || cachedResponse.storagePolicy != NSURLCacheStorageAllowed) {
+        return;
+    }
+    
+    // Only successful HTTP responses which can be stored are saved
+    if (! [cachedResponse.response isKindOfClass:[NSHTTPURLResponse class]]) {
+        return;
+    }
+    NSHTTPURLResponse *HTTPResponse = (NSHTTPURLResponse *)cachedResponse.response;
+    if ([HTTPResponse statusCode] != 200) {
+        return;
+    }
+    NSString *cacheControl = [[[HTTPResponse allHeaderFields] objectForKey:@"Cache-Control"] lowercaseString];
+    if ([cacheControl rangeOfString:@"no-store"].location != NSNotFound) {
+        return;
+    }
+    
+    [self writeEntryWithCachedResponse:cachedResponse date:[NSDate date] fileName:[self fileNameForRequest:request]];
+}
+
+- (void)removeCachedResponseForRequest:(NSURLRequest *)request
+{
+    [super removeCachedResponseForRequest:request];
+    
+    @synchronized(self) {
+        [self removeEntryWithFileName:[self fileNameForRequest:request]];
+    }
+}
+
+- (void)removeAllCachedResponses
+{
+    [super removeAllCachedResponses];
+    
+    @synchronized(self) {
+        for (NSString *fileName in [NSArray arrayWithArray:self.fileNames]) {
+            [self removeEntryWithFileName:fileName];
+        }
+    }
+}
+
+#pragma mark Querying the cache
+
+- (BOOL)hasCachedResponseForRequest:(NSURLRequest *)request
+{
+    if (! [self isCacheableRequest:request]) {
+        return NO;
+    }
+    
+    @synchronized(self) {
+        return [self.fileNameToSizeMap objectForKey:[self fileNameForRequest:request]] != nil;
+    }
+}
+
+#pragma mark Entries
+
+- (NSString *)fileNameForRequest:(NSURLRequest *)request
+{
+    return [[[request URL] absoluteString] md5hash];
+}
+
+- (BOOL)isCacheableRequest:(NSURLRequest *)request
+{
+    NSString *scheme = [[[request URL] scheme] lowercaseString];
+    return ([scheme isEqualToString:@"http"] || [scheme isEqualToString:@"https"])
+        && [[request HTTPMethod] isEqualToString:@"GET"];
+}
+
+// Build the index of the entries available on disk, from the least to the most recently used one
+- (void)loadIndex
+{
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    NSArray *fileNames = [fileManager contentsOfDirectoryAtPath:self.cacheDirectoryPath error:NULL];
+    
+    NSMutableDictionary *fileNameToSizeMap = [NSMutableDictionary dictionary];
+    NSMutableDictionary *fileNameToDateMap = [NSMutableDictionary dictionary];
+    _diskUsage = 0;
+    for (NSString *fileName in fileNames) {
+        NSString *filePath = [self.cacheDirectoryPath stringByAppendingPathComponent:fileName];
+        NSDictionary *attributes = [fileManager attributesOfItemAtPath:filePath error:NULL];
+        if (! attributes) {
+            continue;
+        }
+        
+        [fileNameToSizeMap setObject:[NSNumber numberWithUnsignedLongLong:[attributes fileSize]] forKey:fileName];
+        [fileNameToDateMap setObject:[attributes fileModificationDate] forKey:fileName];
+        _diskUsage += [attributes fileSize];
+    }
+    
+    self.fileNameToSizeMap = fileNameToSizeMap;
+    self.fileNameToExpirationDateMap = [NSMutableDictionary dictionary];
+    self.fileNames = [NSMutableArray arrayWithArray:[fileNameToDateMap keysSortedByValueUsingSelector:@selector(compare:)]];
+    
+    [self evictEntriesOverCapacity];
+}
+
+// Return nil if the entry cannot be read. Can be called outside a synchronized section
+- (NSDictionary *)entryWithFileName:(NSString *)fileName
+{
+    NSString *filePath = [self.cacheDirectoryPath stringByAppendingPathComponent:fileName];
+    @try {
+        return [NSKeyedUnarchiver unarchiveObjectWithFile:filePath];
+    }
+    @catch (NSException *exception) {
+        HLSLoggerWarn(@"The cache entry %@ is corrupt and has been discarded", filePath);
+        return nil;
+    }
+}
+
+- (void)touchFileName:(NSString *)fileName
+{
+    [self.fileNames removeObject:fileName];
+    [self.fileNames addObject:fileName];
+}
+
+// Keep track of the access date on disk as well, so that the order is preserved between launches. Can be called
+// outside a synchronized section
+- (void)updateAccessDateOfFileName:(NSString *)fileName
+{
+    NSDictionary *attributes = [NSDictionary dictionaryWithObject:[NSDate date] forKey:NSFileModificationDate];
+    NSString *filePath = [self.cacheDirectoryPath stringByAppendingPathComponent:fileName];
+    [[NSFileManager defaultManager] setAttributes:attributes ofItemAtPath:filePath error:NULL];
+}
+
+// Must be called outside a synchronized section. The entry is archived and written to a temporary file without
+// holding the lock, so that concurrent lookups are not blocked. Only moving the file in place and updating the
+// index are synchronized
+- (void)writeEntryWithCachedResponse:(NSCachedURLResponse *)cachedResponse date:(NSDate *)date fileName:(NSString *)fileName
+{
+    // Responses larger than the whole cache are not stored
+    NSDictionary *entry = [NSDictionary dictionaryWithObjectsAndKeys:cachedResponse, kEntryCachedResponseKey, 
+                           date, kEntryDateKey, 
+                           nil];
+    NSData *entryData = [NSKeyedArchiver archivedDataWithRootObject:entry];
+    if ([entryData length] > [self diskCapacity]) {
+        return;
+    }
+    
+    NSString *temporaryFilePath = [NSTemporaryDirectory() stringByAppendingPathComponent:[[NSProcessInfo processInfo] globallyUniqueString]];
+    if (! [entryData writeToFile:temporaryFilePath atomically:NO]) {
+        HLSLoggerWarn(@"Could not write the cache entry %@", temporaryFilePath);
+        return;
+    }
+    
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    NSString *filePath = [self.cacheDirectoryPath stringByAppendingPathComponent:fileName];
+    @synchronized(self) {
+        [self removeEntryWithFileName:fileName];
+        
+        NSError *error = nil;
+        if (! [fileManager moveItemAtPath:temporaryFilePath toPath:filePath error:&error]) {
+            HLSLoggerWarn(@"Could not write the cache entry %@. Reason: %@", filePath, error);
+            [fileManager removeItemAtPath:temporaryFilePath error:NULL];
+            return;
+        }
+        
+        [self.fileNameToSizeMap setObject:[NSNumber numberWithUnsignedInteger:[entryData length]] forKey:fileName];
+        [self.fileNameToExpirationDateMap setObject:[self expirationDateForEntry:entry] forKey:fileName];
+        [self.fileNames addObject:fileName];
+        _diskUsage += [entryData length];
+        
+        [self evictEntriesOverCapacity];
+    }
+}
+
+- (void)removeEntryWithFileName:(NSString *)fileName
+{
+    NSNumber *size = [self.fileNameToSizeMap objectForKey:fileName];
+    if (! size) {
+        return;
+    }
+    
+    NSString *filePath = [self.cacheDirectoryPath stringByAppendingPathComponent:fileName];
+    [[NSFileManager defaultManager] removeItemAtPath:filePath error:NULL];
+    
+    _diskUsage -= [size unsignedIntegerValue];
+    [self.fileNameToSizeMap removeObjectForKey:fileName];
+    [self.fileNameToExpirationDateMap removeObjectForKey:fileName];
+    [self.fileNames removeObject:fileName];
+}
+
+- (void)evictEntriesOverCapacity
+{
+    while (_diskUsage > [self diskCapacity] && [self.fileNames count] != 0) {
+        [self removeEntryWithFileName:[self.fileNames objectAtIndex:0]];
+    }
+}
+
+#pragma mark Freshness
+
+/**
+ * Return the date at which the entry becomes stale. Only explicit freshness information (Cache-Control max-age, or 
+ * Expires) is taken into account. Responses without such information (or with Cache-Control: no-cache) are always
+ * stale. Must be called from a synchronized section
+ */
+- (NSDate *)expirationDateForEntry:(NSDictionary *)entry
+{
+    NSCachedURLResponse *cachedResponse = [entry objectForKey:kEntryCachedResponseKey];
+    NSDictionary *headerFields = [(NSHTTPURLResponse *)cachedResponse.response allHeaderFields];
+    NSDate *date = [entry objectForKey:kEntryDateKey];
+    
+    NSString *cacheControl = [[headerFields objectForKey:@"Cache-Control"] lowercaseString];
+    if ([cacheControl rangeOfString:@"no-cache"].location != NSNotFound) {
+        return [NSDate distantPast];
+    }
+    
+    NSRange maxAgeRange = [cacheControl rangeOfString:@"max-age="];
+    if (maxAgeRange.location != NSNotFound) {
+        NSTimeInterval maxAge = [[cacheControl substringFromIndex:NSMaxRange(maxAgeRange)] doubleValue];
+        return [date dateByAddingTimeInterval:maxAge];
+    }
+    
+    NSDate *expirationDate = [self dateFromHTTPDateString:[headerFields objectForKey:@"Expires"]];
+    NSDate *responseDate = [self dateFromHTTPDateString:[headerFields objectForKey:@"Date"]];
+    if (expirationDate && responseDate) {
+        return [date dateByAddingTimeInterval:[expirationDate timeIntervalSinceDate:responseDate]];
+    }
+    
+    return [NSDate distantPast];
+}
+
+// RFC 1123 dates only (the format HTTP/1.1 servers must use). Must be called from a synchronized section
+- (NSDate *)dateFromHTTPDateString:(NSString *)dateString
+{
+    if (! dateString) {
+        return nil;
+    }
+    
+    static NSDateFormatter *s_dateFormatter = nil;
+    if (! s_dateFormatter) {
+        s_dateFormatter = [[NSDateFormatter alloc] init];
+        [s_dateFormatter setLocale:[[[NSLocale alloc] initWithLocaleIdentifier:@"en_US_POSIX"] autorelease]];
+        [s_dateFormatter setTimeZone:[NSTimeZone timeZoneWithAbbreviation:@"GMT"]];
+        [s_dateFormatter setDateFormat:@"EEE',' dd MMM yyyy HH':'mm':'ss 'GMT'"];
+    }
+    return [s_dateFormatter dateFromString:dateString];
+}
+
+#pragma mark Revalidation
+
+- (void)revalidateRequest:(NSURLRequest *)request withCachedResponse:(NSCachedURLResponse *)cachedResponse
+{
+    NSString *fileName = [self fileNameForRequest:request];
+    @synchronized(self) {
+        if ([self.revalidatedFileNames containsObject:fileName]) {
+            return;
+        }
+        [self.revalidatedFileNames addObject:fileName];
+    }
+    
+    // Conditional request bypassing the cache, using the validators of the cached response (if any)
+    NSMutableURLRequest *revalidationRequest = [NSMutableURLRequest requestWithURL:[request URL]
+                                                                       cachePolicy:NSURLRequestReloadIgnoringLocalCacheData
+                                                                   timeoutInterval:[request timeoutInterval]];
+    [revalidationRequest setAllHTTPHeaderFields:[request allHTTPHeaderFields]];
+    NSDictionary *headerFields = [(NSHTTPURLResponse *)cachedResponse.response allHeaderFields];
+    NSString *entityTag = [headerFields objectForKey:@"ETag"];
+    if (entityTag) {
+        [revalidationRequest setValue:entityTag forHTTPHeaderField:@"If-None-Match"];
+    }
+    NSString *lastModified = [headerFields objectForKey:@"Last-Modified"];
+    if (lastModified) {
+        [revalidationRequest setValue:lastModified forHTTPHeaderField:@"If-Modified-Since"];
+    }
+    
+    NSInvocationOperation *revalidationOperation = [[[NSInvocationOperation alloc] initWithTarget:self
+                                                                                         selector:@selector(performRevalidationWithRequest:)
+                                                                                           object:revalidationRequest] autorelease];
+    [self.revalidationQueue addOperation:revalidationOperation];
+}
+
+// Called on a background thread
+- (void)performRevalidationWithRequest:(NSURLRequest *)request
+{
+    NSHTTPURLResponse *response = nil;
+    NSError *error = nil;
+    NSData *data = [NSURLConnection sendSynchronousRequest:request returningResponse:&response error:&error];
+    
+    NSString *fileName = [self fileNameForRequest:request];
+    @synchronized(self) {
+        [self.revalidatedFileNames removeObject:fileName];
+    }
+    
+    if (! response) {
+        HLSLoggerDebug(@"The response for %@ could not be revalidated. Reason: %@", [request URL], error);
+        return;
+    }
+    
+    // Not modified: The stored response is fresh again
+    if ([response statusCode] == 304) {
+        NSCachedURLResponse *cachedResponse = [[self entryWithFileName:fileName] objectForKey:kEntryCachedResponseKey];
+        if (cachedResponse) {
+            [self writeEntryWithCachedResponse:cachedResponse date:[NSDate date] fileName:fileName];
+        }
+    }
+    // When the cache is installed as shared cache, the URL loading system has already stored the new response
+    else if ([response statusCode] == 200 && [NSURLCache sharedURLCache] != self) {
+        NSCachedURLResponse *cachedResponse = [[[NSCachedURLResponse alloc] initWithResponse:response data:data] autorelease];
+        [self storeCachedResponse:cachedResponse forRequest:request];
+    }
+}
+
+@end
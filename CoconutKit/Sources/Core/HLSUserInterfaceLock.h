@@ -6,14 +6,29 @@
 //  Copyright 2010 Hortis. All rights reserved.
 //
 
+// Forward declarations
+@class HLSUserInterfaceLockToken;
+
 /**
  * Singleton class for preventing / allowing user interface interaction
  *
+ * When the last lock is released, interaction events are only re-enabled at the end of the current run loop
+ * iteration. If the UI is locked again in the meantime (e.g. when an animation completion callback plays another
+ * animation), the lock is simply kept, without any UIKit call and without letting touches slip through.
+ *
+ * The time during which the user interface has been locked is measured, so that you can check how long your
+ * application is unresponsive.
+ *
  * Designated initializer: -init
  */
 @interface HLSUserInterfaceLock : NSObject {
 @private
     NSUInteger m_useCount;
+    BOOL m_ignoringInteractionEvents;
+    CFAbsoluteTime m_lockStartTime;
+    NSTimeInterval m_totalLockedTimeInterval;
+    NSTimeInterval m_longestLockedTimeInterval;
+    NSUInteger m_lockPeriodCount;
 }
 
 + (HLSUserInterfaceLock *)sharedUserInterfaceLock;
@@ -25,4 +40,48 @@
 - (void)lock;
 - (void)unlock;
 
+/**
+ * Lock the UI and return a token keeping it locked until it is relinquished (or deallocated). Tokens are easier to 
+ * balance than -lock / -unlock pairs when the UI must be held locked across several asynchronous steps: Simply keep 
+ * the token as long as needed. The reason is used for logging purposes and can be nil
+ */
+- (HLSUserInterfaceLockToken *)lockTokenWithReason:(NSString *)reason;
+
+/**
+ * Instrumentation. The total time is the sum of all periods during which interaction events were ignored (including
+ * the current one, if any), and the count is the number of such periods
+ */
+@property (nonatomic, readonly, assign) NSTimeInterval totalLockedTimeInterval;
+@property (nonatomic, readonly, assign) NSTimeInterval longestLockedTimeInterval;
+@property (nonatomic, readonly, assign) NSUInteger lockPeriodCount;
+
+/**
+ * Reset the values above
+ */
+- (void)resetStatistics;
+
+@end
+
+/**
+ * A token holding the user interface lock (see -[HLSUserInterfaceLock lockTokenWithReason:])
+ */
+@interface HLSUserInterfaceLockToken : NSObject {
+@private
+    NSString *m_reason;
+    CFAbsoluteTime m_creationTime;
+    BOOL m_relinquished;
+}
+
+/**
+ * Release the lock held by the token. Does nothing if already relinquished
+ */
+- (void)relinquish;
+
+@property (nonatomic, readonly, retain) NSString *reason;
+
+/**
+ * Return YES iff the token still holds the lock
+ */
+@property (nonatomic, readonly, assign, getter=isValid) BOOL valid;
+
 @end
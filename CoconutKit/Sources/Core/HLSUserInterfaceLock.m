@@ -8,8 +8,24 @@
 
 #import "HLSUserInterfaceLock.h"
 
+#import "HLSAssert.h"
+#import "HLSConverters.h"
 #import "HLSLogger.h"
 
+@interface HLSUserInterfaceLock ()
+
+- (void)endIgnoringInteractionEventsIfUnlocked;
+
+@end
+
+@interface HLSUserInterfaceLockToken ()
+
+- (id)initWithReason:(NSString *)reason;
+
+@property (nonatomic, retain) NSString *reason;
+
+@end
+
 @implementation HLSUserInterfaceLock
 
 #pragma mark Class methods
@@ -34,6 +50,30 @@
     return self;
 }
 
+#pragma mark Accessors and mutators
+
+- (NSTimeInterval)totalLockedTimeInterval
+{
+    if (m_ignoringInteractionEvents) {
+        return m_totalLockedTimeInterval + CFAbsoluteTimeGetCurrent() - m_lockStartTime;
+    }
+    else {
+        return m_totalLockedTimeInterval;
+    }
+}
+
+- (NSTimeInterval)longestLockedTimeInterval
+{
+    if (m_ignoringInteractionEvents) {
+        return MAX(m_longestLockedTimeInterval, CFAbsoluteTimeGetCurrent() - m_lockStartTime);
+    }
+    else {
+        return m_longestLockedTimeInterval;
+    }
+}
+
+@synthesize lockPeriodCount = m_lockPeriodCount;
+
 #pragma mark Locking and unlocking user interaction
 
 - (void)lock
@@ -41,8 +81,12 @@
     ++m_useCount;
     HLSLoggerDebug(@"Acquire UI lock");
     
-    if (m_useCount == 1) {
+    // If interaction events are still ignored (unlock in the same run loop iteration), simply keep them ignored
+    if (m_useCount == 1 && ! m_ignoringInteractionEvents) {
         [[UIApplication sharedApplication] beginIgnoringInteractionEvents];
+        m_ignoringInteractionEvents = YES;
+        m_lockStartTime = CFAbsoluteTimeGetCurrent();
+        ++m_lockPeriodCount;
     }
 }
 
@@ -57,9 +101,118 @@
     --m_useCount;
     HLSLoggerDebug(@"Release UI lock");
     
+    // Coalesce with locks occurring during the same run loop iteration
     if (m_useCount == 0) {
-        [[UIApplication sharedApplication] endIgnoringInteractionEvents];
+        [self performSelector:@selector(endIgnoringInteractionEventsIfUnlocked) 
+                   withObject:nil 
+                   afterDelay:0. 
+                      inModes:[NSArray arrayWithObject:NSRunLoopCommonModes]];
     }
 }
 
+- (void)endIgnoringInteractionEventsIfUnlocked
+{
+    if (m_useCount != 0 || ! m_ignoringInteractionEvents) {
+        return;
+    }
+    
+    [[UIApplication sharedApplication] endIgnoringInteractionEvents];
+    m_ignoringInteractionEvents = NO;
+    
+    NSTimeInterval lockedTimeInterval = CFAbsoluteTimeGetCurrent() - m_lockStartTime;
+    m_totalLockedTimeInterval += lockedTimeInterval;
+    m_longestLockedTimeInterval = MAX(m_longestLockedTimeInterval, lockedTimeInterval);
+    HLSLoggerDebug(@"The UI has been locked for %.3f s", lockedTimeInterval);
+}
+
+- (HLSUserInterfaceLockToken *)lockTokenWithReason:(NSString *)reason
+{
+    return [[[HLSUserInterfaceLockToken alloc] initWithReason:reason] autorelease];
+}
+
+#pragma mark Instrumentation
+
+- (void)resetStatistics
+{
+    m_totalLockedTimeInterval = 0.;
+    m_longestLockedTimeInterval = 0.;
+    m_lockPeriodCount = m_ignoringInteractionEvents ? 1 : 0;
+    m_lockStartTime = CFAbsoluteTimeGetCurrent();
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; useCount: %u; totalLockedTimeInterval: %.3f; longestLockedTimeInterval: %.3f; lockPeriodCount: %u>",
+            [self class],
+            self,
+            m_useCount,
+            self.totalLockedTimeInterval,
+            self.longestLockedTimeInterval,
+            self.lockPeriodCount];
+}
+
+@end
+
+@implementation HLSUserInterfaceLockToken
+
+#pragma mark Object creation and destruction
+
+- (id)initWithReason:(NSString *)reason
+{
+    if ((self = [super init])) {
+        self.reason = reason;
+        m_creationTime = CFAbsoluteTimeGetCurrent();
+        [[HLSUserInterfaceLock sharedUserInterfaceLock] lock];
+    }
+    return self;
+}
+
+- (id)init
+{
+    HLSForbiddenInheritedMethod();
+    return nil;
+}
+
+- (void)dealloc
+{
+    [self relinquish];
+    self.reason = nil;
+    [super dealloc];
+}
+
+#pragma mark Accessors and mutators
+
+@synthesize reason = m_reason;
+
+- (BOOL)isValid
+{
+    return ! m_relinquished;
+}
+
+#pragma mark Unlocking
+
+- (void)relinquish
+{
+    if (m_relinquished) {
+        return;
+    }
+    
+    m_relinquished = YES;
+    HLSLoggerDebug(@"UI lock token held for %.3f s (reason: %@)", CFAbsoluteTimeGetCurrent() - m_creationTime, self.reason);
+    [[HLSUserInterfaceLock sharedUserInterfaceLock] unlock];
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; reason: %@; valid: %@>",
+            [self class],
+            self,
+            self.reason,
+            HLSStringFromBool(self.valid)];
+}
+
 @end
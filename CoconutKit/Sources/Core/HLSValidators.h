@@ -7,7 +7,7 @@
 //
 
 /**
- * Not meant to be instantiated
+ * Not meant to be instantiated. All methods can be called from any thread
  */
 @interface HLSValidators : NSObject {
 @private
@@ -19,4 +19,10 @@
  */
 + (BOOL)validateEmailAddress:(NSString *)emailAddress;
 
+/**
+ * Validates a batch of e-mail addresses, spreading the work over all available cores. Returns the indexes of the valid
+ * addresses within the array received as parameter. Objects which are not strings are considered invalid
+ */
++ (NSIndexSet *)validateEmailAddresses:(NSArray *)emailAddresses;
+
 @end
@@ -10,18 +10,58 @@
 
 #import "HLSAssert.h"
 
+// Number of e-mail addresses checked by each batch validation work item
+static const size_t kEmailAddressBatchStride = 256;
+
+// Compiled once and shared. NSRegularExpression objects are immutable and can be used from any thread
+static NSRegularExpression *s_emailRegularExpression = nil;
+
+typedef struct {
+    NSArray *emailAddresses;
+    BOOL *results;
+} HLSEmailAddressBatch;
+
+// Function declarations
+static void createEmailRegularExpression(void *context);
+static NSRegularExpression *emailRegularExpression(void);
+static BOOL validateEmailAddress(NSString *emailAddress);
+static void validateEmailAddressBatch(void *context, size_t index);
+
 @implementation HLSValidators
 
 + (BOOL)validateEmailAddress:(NSString *)emailAddress
 {
-    // For some obscure reason, escaping the % in the directly in the format string (using %%) does not work and crashes at runtime! But creating the
-    // regex outside and inserting it into the control string works. Are control strings in Objective-C really standard? 
-    // The following regex is the one used by Apple, e.g. in iOS mail. Thanks to Cédric Lüthi (0xced) for its extraction
-    // (method -[NSString(NSEmailAddressString) mf_isLegalEmailAddress] in /System/Library/PrivateFrameworks/MIME.framework)
-    NSString *emailRegex = @"^[[:alnum:]!#$%&'*+/=?^_`{|}~-]+((\\.?)[[:alnum:]!#$%&'*+/=?^_`{|}~-]+)*@[[:alnum:]-]+(\\.[[:alnum:]-]+)*(\\.[[:alpha:]]+)+$";
+    return validateEmailAddress(emailAddress);
+}
+
++ (NSIndexSet *)validateEmailAddresses:(NSArray *)emailAddresses
+{
+    NSUInteger count = [emailAddresses count];
+    if (count == 0) {
+        return [NSIndexSet indexSet];
+    }
+    
+    // Compile the regular expression before dispatching work items
+    emailRegularExpression();
+    
+    // Each work item writes to its own slice of the result array, no synchronization is therefore needed
+    BOOL *results = (BOOL *)calloc(count, sizeof(BOOL));
+    HLSEmailAddressBatch batch;
+    batch.emailAddresses = emailAddresses;
+    batch.results = results;
+    
+    size_t numberOfWorkItems = (count + kEmailAddressBatchStride - 1) / kEmailAddressBatchStride;
+    dispatch_apply_f(numberOfWorkItems, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), &batch, validateEmailAddressBatch);
     
-    NSPredicate *emailPredicate = [NSPredicate predicateWithFormat:@"SELF MATCHES %@", emailRegex]; 
-    return [emailPredicate evaluateWithObject:emailAddress];
+    NSMutableIndexSet *validIndexes = [NSMutableIndexSet indexSet];
+    for (NSUInteger i = 0; i < count; ++i) {
+        if (results[i]) {
+            [validIndexes addIndex:i];
+        }
+    }
+    free(results);
+    
+    return [NSIndexSet indexSetWithIndexSet:validIndexes];
 }
 
 #pragma mark Object creation and destruction
@@ -33,3 +73,47 @@
 }
 
 @end
+
+#pragma mark Static functions
+
+static void createEmailRegularExpression(void *context)
+{
+    // The following regex is the one used by Apple, e.g. in iOS mail. Thanks to Cédric Lüthi (0xced) for its extraction
+    // (method -[NSString(NSEmailAddressString) mf_isLegalEmailAddress] in /System/Library/PrivateFrameworks/MIME.framework)
+    NSString *emailPattern = @"^[[:alnum:]!#$%&'*+/=?^_`{|}~-]+((\\.?)[[:alnum:]!#$%&'*+/=?^_`{|}~-]+)*@[[:alnum:]-]+(\\.[[:alnum:]-]+)*(\\.[[:alpha:]]+)+$";
+    s_emailRegularExpression = [[NSRegularExpression alloc] initWithPattern:emailPattern options:0 error:NULL];
+    NSCAssert(s_emailRegularExpression, @"Invalid e-mail regular expression");
+}
+
+static NSRegularExpression *emailRegularExpression(void)
+{
+    static dispatch_once_t s_onceToken;
+    dispatch_once_f(&s_onceToken, NULL, createEmailRegularExpression);
+    return s_emailRegularExpression;
+}
+
+static BOOL validateEmailAddress(NSString *emailAddress)
+{
+    if (! [emailAddress isKindOfClass:[NSString class]]) {
+        return NO;
+    }
+    
+    // The whole string must match (as for the MATCHES predicate operator). Anchors alone would namely accept a trailing
+    // line break
+    NSRange range = NSMakeRange(0, [emailAddress length]);
+    NSRange matchRange = [emailRegularExpression() rangeOfFirstMatchInString:emailAddress options:0 range:range];
+    return NSEqualRanges(matchRange, range);
+}
+
+static void validateEmailAddressBatch(void *context, size_t index)
+{
+    HLSEmailAddressBatch *batch = (HLSEmailAddressBatch *)context;
+    
+    NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+    NSUInteger count = [batch->emailAddresses count];
+    NSUInteger end = MIN((index + 1) * kEmailAddressBatchStride, count);
+    for (NSUInteger i = index * kEmailAddressBatchStride; i < end; ++i) {
+        batch->results[i] = validateEmailAddress([batch->emailAddresses objectAtIndex:i]);
+    }
+    [pool drain];
+}
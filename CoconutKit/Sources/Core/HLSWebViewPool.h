@@ -0,0 +1,61 @@
+//
+//  HLSWebViewPool.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+/**
+ * Creating a UIWebView is expensive (in time as well as in memory). The web view pool keeps a small number of web
+ * views ready for use, prepared when the main run loop is idle, so that the cost of their creation is not paid when a
+ * web view is needed (e.g. when an HLSWebViewController is displayed).
+ *
+ * Web views are checked out using -dequeueWebView and returned to the pool using -enqueueWebView:. Since UIWebView
+ * provides no way to clear its history, only web views which have never loaded any content are kept when they
+ * are returned. Other web views are discarded, and a fresh web view is prepared in their place when the main run loop
+ * is idle. The pool is emptied when the application receives a memory warning
+ *
+ * This class is not thread-safe and must only be used from the main thread
+ *
+ * Designated initializer: -init
+ */
+@interface HLSWebViewPool : NSObject {
+@private
+    NSMutableArray *_webViews;
+    NSUInteger _capacity;
+}
+
+/**
+ * The pool shared by all CoconutKit components
+ */
++ (HLSWebViewPool *)sharedWebViewPool;
+
+/**
+ * The maximum number of web views kept ready by the pool. Setting a smaller value immediately releases the web views 
+ * in excess
+ *
+ * Default value is 1
+ */
+@property (nonatomic, assign) NSUInteger capacity;
+
+/**
+ * Return a web view which has never loaded any content, taken from the pool if available, otherwise created. The pool
+ * is refilled when the main run loop is idle. Web views have default UIWebView settings and no delegate, configure them
+ * as needed
+ */
+- (UIWebView *)dequeueWebView;
+
+/**
+ * Return a web view to the pool. The web view is removed from its superview, its delegate is set to nil and its
+ * loading is stopped. If it has never loaded any content and the pool is not full, it is kept for later use
+ */
+- (void)enqueueWebView:(UIWebView *)webView;
+
+/**
+ * Prepare web views until the capacity of the pool is reached. Web views are created one at a time, when the main
+ * run loop is idle
+ */
+- (void)fill;
+
+@end
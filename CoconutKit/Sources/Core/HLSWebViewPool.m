@@ -0,0 +1,169 @@
+//
+//  HLSWebViewPool.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSWebViewPool.h"
+
+#import "HLSLogger.h"
+
+static const NSUInteger kWebViewPoolDefaultCapacity = 1;
+
+@interface HLSWebViewPool ()
+
+@property (nonatomic, retain) NSMutableArray *webViews;
+
+- (UIWebView *)webView;
+- (void)scheduleFill;
+- (void)prepareWebView;
+
+- (void)applicationDidReceiveMemoryWarning:(NSNotification *)notification;
+
+@end
+
+@implementation HLSWebViewPool
+
+#pragma mark Class methods
+
++ (HLSWebViewPool *)sharedWebViewPool
+{
+    static HLSWebViewPool *s_instance = nil;
+    if (! s_instance) {
+        s_instance = [[HLSWebViewPool alloc] init];
+    }
+    return s_instance;
+}
+
+#pragma mark Object creation and destruction
+
+- (id)init
+{
+    if ((self = [super init])) {
+        self.webViews = [NSMutableArray array];
+        _capacity = kWebViewPoolDefaultCapacity;
+        
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(applicationDidReceiveMemoryWarning:)
+                                                     name:UIApplicationDidReceiveMemoryWarningNotification
+                                                   object:nil];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [[NSNotificationCenter defaultCenter] removeObserver:self
+                                                    name:UIApplicationDidReceiveMemoryWarningNotification
+                                                  object:nil];
+    [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(prepareWebView) object:nil];
+    
+    self.webViews = nil;
+    
+    [super dealloc];
+}
+
+#pragma mark Accessors and mutators
+
+@synthesize webViews = _webViews;
+
+@synthesize capacity = _capacity;
+
+- (void)setCapacity:(NSUInteger)capacity
+{
+    _capacity = capacity;
+    
+    if ([self.webViews count] > capacity) {
+        [self.webViews removeObjectsInRange:NSMakeRange(capacity, [self.webViews count] - capacity)];
+    }
+}
+
+#pragma mark Web view management
+
+- (UIWebView *)dequeueWebView
+{
+    UIWebView *webView = [self.webViews lastObject];
+    if (webView) {
+        [[webView retain] autorelease];
+        [self.webViews removeLastObject];
+    }
+    else {
+        webView = [self webView];
+    }
+    
+    [self scheduleFill];
+    return webView;
+}
+
+- (void)enqueueWebView:(UIWebView *)webView
+{
+    if (! webView) {
+        return;
+    }
+    
+    [webView stopLoading];
+    webView.delegate = nil;
+    [webView removeFromSuperview];
+    
+    // UIWebView history cannot be cleared. Only keep web views which have not been used to load anything
+    if (webView.request || webView.canGoBack || webView.canGoForward) {
+        [self scheduleFill];
+        return;
+    }
+    
+    if ([self.webViews count] < self.capacity && ! [self.webViews containsObject:webView]) {
+        [self.webViews addObject:webView];
+    }
+}
+
+- (void)fill
+{
+    [self scheduleFill];
+}
+
+// Create a new web view
+- (UIWebView *)webView
+{
+    return [[[UIWebView alloc] initWithFrame:[UIScreen mainScreen].applicationFrame] autorelease];
+}
+
+- (void)scheduleFill
+{
+    if ([self.webViews count] >= self.capacity) {
+        return;
+    }
+    
+    // Create web views when the run loop is idle, and not while the user is interacting with a scroll view (tracking mode)
+    [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(prepareWebView) object:nil];
+    [self performSelector:@selector(prepareWebView) 
+               withObject:nil 
+               afterDelay:0. 
+                  inModes:[NSArray arrayWithObject:NSDefaultRunLoopMode]];
+}
+
+- (void)prepareWebView
+{
+    if ([self.webViews count] >= self.capacity) {
+        return;
+    }
+    
+    [self.webViews addObject:[self webView]];
+    
+    // Prepare one web view per run loop iteration only
+    [self scheduleFill];
+}
+
+#pragma mark Notification callbacks
+
+- (void)applicationDidReceiveMemoryWarning:(NSNotification *)notification
+{
+    HLSLoggerInfo(@"Memory warning received. Releasing %d pooled web views", [self.webViews count]);
+    
+    // Do not refill the pool until a web view is requested again
+    [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(prepareWebView) object:nil];
+    [self.webViews removeAllObjects];
+}
+
+@end
@@ -15,20 +15,36 @@
  *
  * HLSZeroingWeakRef instances must be retained by the objects which store them.
  *
- * The current implementation of HLSZeroingWeakRef is fairly basic:
+ * When available (iOS 5 and above), the weak references provided by the Objective-C runtime (the ones used
+ * by ARC) are used. Cleanup invocations are then stored in a small side object attached to the referenced
+ * object, and only when some have been added. On iOS 4, or for objects which do not support runtime weak 
+ * references, the class of the referenced object is replaced by a dynamic subclass (one per class) overriding 
+ * -dealloc.
+ *
+ * Zeroing weak references to the same object can be created and released from several threads. Their 
+ * bookkeeping is protected by a set of locks, each object always being protected by the same lock (chosen
+ * from its address). Cleanup invocations are performed after this lock has been released, and can therefore
+ * create or release zeroing weak references, or wait for other threads doing so.
+ *
+ * The current implementation of HLSZeroingWeakRef has some limitations, though:
  *   - zeroing weak references to toll-free bridged objects (NSString, NSURL, NSNumber, etc.) are not 
  *     supported. Attempting to initialize a zeroing weak with a toll-free bridged object results in 
  *     an exception being thrown
- *   - thread-safety issues have been ignored
+ *   - with the legacy implementation (iOS 4), an object read from a zeroing weak reference on some thread
+ *     can still be deallocated by another thread at the same time. Runtime weak references do not have 
+ *     this issue
  *
  * This implementation should suffice in most cases (weak pointers to instances of custom Objective-C 
- * classes, accessed from a single thread). In other cases, consider using Mike Ash implementation
- * found at https://github.com/mikeash/MAZeroingWeakRef or ARC zeroing weak references.
+ * classes). In other cases, consider using Mike Ash implementation found at 
+ * https://github.com/mikeash/MAZeroingWeakRef or ARC zeroing weak references.
  */
 @interface HLSZeroingWeakRef : NSObject {
 @private
     id m_object;
     NSMutableArray *m_invocations;
+    BOOL m_runtimeWeakReference;
+    id m_cleanupSentinel;
+    NSUInteger m_lockIndex;
 }
 
 /**
@@ -44,7 +60,8 @@
 
 /**
  * Optional invocations to be performed just before the weak reference is zeroed. The actions / invocations 
- * are called in the order in which they have been added
+ * are called in the order in which they have been added. When runtime weak references are used, they are
+ * called after the -dealloc methods of the object have been executed: They must not send messages to it
  */
 - (void)addInvocation:(NSInvocation *)invocation;
 
@@ -8,36 +8,97 @@
 
 #import "HLSZeroingWeakRef.h"
 
+#import "HLSAssert.h"
+
 #import <objc/runtime.h>
+#import <pthread.h>
 #import "NSObject+HLSExtensions.h"
 
+// Runtime functions backing ARC weak references. Weakly linked since only available on iOS 5 and above
+OBJC_EXPORT id objc_storeWeak(id *location, id obj) __attribute__((weak_import));
+OBJC_EXPORT id objc_loadWeak(id *location) __attribute__((weak_import));
+
 // Associated object keys
 static void *s_zeroingWeakRefListKey = &s_zeroingWeakRefListKey;
+static void *s_cleanupSentinelKey = &s_cleanupSentinelKey;
+
+// Locks protecting the bookkeeping of zeroing weak references (list of references, dynamic subclass, cleanup 
+// sentinel). A referenced object is always protected by the same lock, chosen from its address, so that 
+// unrelated objects rarely contend. Cleanup invocations are collected with the lock held but performed after
+// it has been released, so that they can freely create or release zeroing weak references
+#define HLSZeroingWeakRefLockCount 64
+static pthread_mutex_t s_locks[HLSZeroingWeakRefLockCount];
+
+// Function declarations
+static NSUInteger lockIndexForObject(id object);
 
 // Static methods
 static void subclass_dealloc(id object, SEL _cmd);
 static Class subclass_class(id object, SEL _cmd);
 
+/**
+ * Implemented by NSObject when runtime weak references are available. Objects with custom retain / release
+ * implementations can return NO
+ */
+@interface NSObject (HLSZeroingWeakRefRuntime)
+
+- (BOOL)allowsWeakReference;
+
+@end
+
+/**
+ * Private class attached (as associated object) to an object referenced by runtime zeroing weak references
+ * having cleanup invocations. Associated objects are released when the object is deallocated, before its 
+ * runtime weak references are cleared, which is when the invocations are performed. The list of zeroing
+ * weak references does not retain them
+ */
+@interface HLSZeroingWeakRefCleanupSentinel : NSObject {
+@private
+    CFMutableArrayRef _zeroingWeakRefs;
+    NSUInteger _lockIndex;
+}
+
+- (id)initWithLockIndex:(NSUInteger)lockIndex;
+
+- (void)addZeroingWeakRef:(HLSZeroingWeakRef *)zeroingWeakRef;
+- (void)removeZeroingWeakRef:(HLSZeroingWeakRef *)zeroingWeakRef;
+
+@end
+
 @interface HLSZeroingWeakRef ()
 
 @property (nonatomic, assign) id object;
 @property (nonatomic, retain) NSMutableArray *invocations;
+@property (nonatomic, assign) id cleanupSentinel;
+
+- (void)registerLegacyZeroingWeakRefForObject:(id)object;
+- (void)unregisterLegacyZeroingWeakRef;
 
 @end
 
 @implementation HLSZeroingWeakRef
 
+#pragma mark Class methods
+
++ (void)initialize
+{
+    if (self != [HLSZeroingWeakRef class]) {
+        return;
+    }
+    
+    for (NSUInteger i = 0; i < HLSZeroingWeakRefLockCount; ++i) {
+        pthread_mutex_init(&s_locks[i], NULL);
+    }
+}
+
 #pragma mark Object creation and destruction
 
 - (id)initWithObject:(id)object
 {
     if ((self = [super init])) {
         self.invocations = [NSMutableArray array];
-        self.object = object;
         
         if (object) {
-            static NSString * const kSubclassPrefix = @"HLSZeroingWeakRef_";
-            
             // Access the real class, do not use [self class] here since can be faked
             Class class = object_getClass(object);
             
@@ -45,60 +106,43 @@ static Class subclass_class(id object, SEL _cmd);
             // For more information, see
             //   http://www.mikeash.com/pyblog/friday-qa-2010-01-22-toll-free-bridging-internals.html
             if ([NSStringFromClass(class) hasPrefix:@"NSCF"] || [NSStringFromClass(class) hasPrefix: @"__NSCF"]) {
+                [self release];
                 @throw [NSException exceptionWithName:NSInvalidArgumentException 
                                                reason:@"Cannot create zeroing weak references to toll-free bridged objects"
                                              userInfo:nil];
             }
             
-            // Dynamically subclass the object class to override -dealloc selectively, and use this class instead.
-            // Another approach would involve swizzling -dealloc at the NSObject level, but this solution would 
-            // incur an unacceptable overhead on all NSObjects
-            NSString *className = [NSString stringWithUTF8String:class_getName(class)];
-            if (! [className hasPrefix:kSubclassPrefix]) {
-                NSString *subclassName = [kSubclassPrefix stringByAppendingString:className];
-                Class subclass = NSClassFromString(subclassName);
-                if (! subclass) {
-                    subclass = objc_allocateClassPair(class, [subclassName UTF8String], 0);
-                    NSAssert(subclass != Nil, @"Could not register subclass");
-                    class_addMethod(subclass, 
-                                    @selector(dealloc), 
-                                    (IMP)subclass_dealloc, 
-                                    method_getTypeEncoding(class_getInstanceMethod(class, @selector(dealloc))));
-                    class_addMethod(subclass, 
-                                    @selector(class), 
-                                    (IMP)subclass_class, 
-                                    method_getTypeEncoding(class_getClassMethod(class, @selector(class))));
-                    objc_registerClassPair(subclass);
-                }
-                
-                // Changes the object class
-                object_setClass(object, subclass);    
-            }
+            // Use the same lock as long as the weak reference lives, even after the object has been deallocated
+            m_lockIndex = lockIndexForObject(object);
             
-            // Attach to object a list storing all zeroing weak references pointing at it
-            NSMutableSet *zeroingWeakRefValues = objc_getAssociatedObject(object, s_zeroingWeakRefListKey);
-            if (! zeroingWeakRefValues) {
-                zeroingWeakRefValues = [NSMutableSet set];
-                objc_setAssociatedObject(object, s_zeroingWeakRefListKey, zeroingWeakRefValues, OBJC_ASSOCIATION_RETAIN);
+            // Use runtime weak references when available. The class of the object is then left untouched
+            if (objc_storeWeak != NULL && objc_loadWeak != NULL
+                    && (! [object respondsToSelector:@selector(allowsWeakReference)] || [object allowsWeakReference])) {
+                m_runtimeWeakReference = YES;
+                self.object = object;
+            }
+            else {
+                pthread_mutex_lock(&s_locks[m_lockIndex]);
+                self.object = object;
+                [self registerLegacyZeroingWeakRefForObject:object];
+                pthread_mutex_unlock(&s_locks[m_lockIndex]);
             }
-            NSValue *selfValue = [NSValue valueWithPointer:self];
-            [zeroingWeakRefValues addObject:selfValue];
-        }        
+        }
     }
     return self;
 }
 
 - (void)dealloc
 {
-    NSMutableSet *zeroingWeakRefValues = objc_getAssociatedObject(self.object, s_zeroingWeakRefListKey);
-    NSValue *selfValue = [NSValue valueWithPointer:self];
-    [zeroingWeakRefValues removeObject:selfValue];
-    
-    // No weak ref anymore. Can remove the dynamic subclass
-    if ([zeroingWeakRefValues count] == 0) {
-        Class superclass = class_getSuperclass(object_getClass(self.object));
-        object_setClass(self.object, superclass);
+    pthread_mutex_lock(&s_locks[m_lockIndex]);
+    if (m_runtimeWeakReference) {
+        [self.cleanupSentinel removeZeroingWeakRef:self];
+        self.cleanupSentinel = nil;
+    }
+    else {
+        [self unregisterLegacyZeroingWeakRef];
     }
+    pthread_mutex_unlock(&s_locks[m_lockIndex]);
     
     self.object = nil;
     self.invocations = nil;
@@ -110,13 +154,51 @@ static Class subclass_class(id object, SEL _cmd);
 
 @synthesize object = m_object;
 
+- (id)object
+{
+    if (m_runtimeWeakReference) {
+        return objc_loadWeak(&m_object);
+    }
+    else {
+        return m_object;
+    }
+}
+
+- (void)setObject:(id)object
+{
+    if (m_runtimeWeakReference) {
+        objc_storeWeak(&m_object, object);
+    }
+    else {
+        m_object = object;
+    }
+}
+
 @synthesize invocations = m_invocations;
 
+@synthesize cleanupSentinel = m_cleanupSentinel;
+
 #pragma mark Optional cleanup
 
 - (void)addInvocation:(NSInvocation *)invocation
 {
+    pthread_mutex_lock(&s_locks[m_lockIndex]);
     [self.invocations addObject:invocation];
+    
+    // With runtime weak references, the object only gets a cleanup sentinel when needed
+    if (m_runtimeWeakReference && ! self.cleanupSentinel) {
+        id object = self.object;
+        if (object) {
+            HLSZeroingWeakRefCleanupSentinel *cleanupSentinel = objc_getAssociatedObject(object, s_cleanupSentinelKey);
+            if (! cleanupSentinel) {
+                cleanupSentinel = [[[HLSZeroingWeakRefCleanupSentinel alloc] initWithLockIndex:m_lockIndex] autorelease];
+                objc_setAssociatedObject(object, s_cleanupSentinelKey, cleanupSentinel, OBJC_ASSOCIATION_RETAIN);
+            }
+            [cleanupSentinel addZeroingWeakRef:self];
+            self.cleanupSentinel = cleanupSentinel;
+        }
+    }
+    pthread_mutex_unlock(&s_locks[m_lockIndex]);
 }
 
 - (void)addCleanupAction:(SEL)action onTarget:(id)target
@@ -128,26 +210,195 @@ static Class subclass_class(id object, SEL _cmd);
     [self addInvocation:invocation];
 }
 
+#pragma mark Legacy implementation (dynamic subclassing, must be called with the lock held)
+
+- (void)registerLegacyZeroingWeakRefForObject:(id)object
+{
+    static NSString * const kSubclassPrefix = @"HLSZeroingWeakRef_";
+    
+    Class class = object_getClass(object);
+    
+    // Dynamically subclass the object class to override -dealloc selectively, and use this class instead.
+    // Another approach would involve swizzling -dealloc at the NSObject level, but this solution would 
+    // incur an unacceptable overhead on all NSObjects
+    NSString *className = [NSString stringWithUTF8String:class_getName(class)];
+    if (! [className hasPrefix:kSubclassPrefix]) {
+        NSString *subclassName = [kSubclassPrefix stringByAppendingString:className];
+        
+        // Objects of the same class may be protected by different locks
+        Class subclass = Nil;
+        @synchronized([HLSZeroingWeakRef class]) {
+            subclass = NSClassFromString(subclassName);
+            if (! subclass) {
+                subclass = objc_allocateClassPair(class, [subclassName UTF8String], 0);
+                NSAssert(subclass != Nil, @"Could not register subclass");
+                class_addMethod(subclass, 
+                                @selector(dealloc), 
+                                (IMP)subclass_dealloc, 
+                                method_getTypeEncoding(class_getInstanceMethod(class, @selector(dealloc))));
+                class_addMethod(subclass, 
+                                @selector(class), 
+                                (IMP)subclass_class, 
+                                method_getTypeEncoding(class_getClassMethod(class, @selector(class))));
+                objc_registerClassPair(subclass);
+            }
+        }
+        
+        // Changes the object class
+        object_setClass(object, subclass);    
+    }
+    
+    // Attach to object a list storing all zeroing weak references pointing at it
+    NSMutableSet *zeroingWeakRefValues = objc_getAssociatedObject(object, s_zeroingWeakRefListKey);
+    if (! zeroingWeakRefValues) {
+        zeroingWeakRefValues = [NSMutableSet set];
+        objc_setAssociatedObject(object, s_zeroingWeakRefListKey, zeroingWeakRefValues, OBJC_ASSOCIATION_RETAIN);
+    }
+    NSValue *selfValue = [NSValue valueWithPointer:self];
+    [zeroingWeakRefValues addObject:selfValue];
+}
+
+- (void)unregisterLegacyZeroingWeakRef
+{
+    if (! self.object) {
+        return;
+    }
+    
+    NSMutableSet *zeroingWeakRefValues = objc_getAssociatedObject(self.object, s_zeroingWeakRefListKey);
+    NSValue *selfValue = [NSValue valueWithPointer:self];
+    [zeroingWeakRefValues removeObject:selfValue];
+    
+    // No weak ref anymore. Can remove the dynamic subclass
+    if ([zeroingWeakRefValues count] == 0) {
+        Class superclass = class_getSuperclass(object_getClass(self.object));
+        object_setClass(self.object, superclass);
+    }
+}
+
+@end
+
+@implementation HLSZeroingWeakRefCleanupSentinel
+
+#pragma mark Object creation and destruction
+
+- (id)initWithLockIndex:(NSUInteger)lockIndex
+{
+    if ((self = [super init])) {
+        _zeroingWeakRefs = CFArrayCreateMutable(kCFAllocatorDefault, 0, NULL);
+        _lockIndex = lockIndex;
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    // The referenced object is being deallocated. Invocations might release some of the zeroing weak references,
+    // which then remove themselves from the list: Only those still in it can be accessed. Their invocations are
+    // collected with the lock held, but performed after it has been released
+    pthread_mutex_lock(&s_locks[_lockIndex]);
+    CFArrayRef zeroingWeakRefs = CFArrayCreateCopy(kCFAllocatorDefault, _zeroingWeakRefs);
+    pthread_mutex_unlock(&s_locks[_lockIndex]);
+    
+    for (CFIndex i = 0; i < CFArrayGetCount(zeroingWeakRefs); ++i) {
+        HLSZeroingWeakRef *zeroingWeakRef = (HLSZeroingWeakRef *)CFArrayGetValueAtIndex(zeroingWeakRefs, i);
+        
+        NSArray *invocations = nil;
+        pthread_mutex_lock(&s_locks[_lockIndex]);
+        if (CFArrayContainsValue(_zeroingWeakRefs, CFRangeMake(0, CFArrayGetCount(_zeroingWeakRefs)), zeroingWeakRef)) {
+            invocations = [NSArray arrayWithArray:zeroingWeakRef.invocations];
+        }
+        pthread_mutex_unlock(&s_locks[_lockIndex]);
+        
+        for (NSInvocation *invocation in invocations) {
+            [invocation invoke];
+        }
+    }
+    CFRelease(zeroingWeakRefs);
+    
+    // Detach the remaining zeroing weak references
+    pthread_mutex_lock(&s_locks[_lockIndex]);
+    for (CFIndex i = 0; i < CFArrayGetCount(_zeroingWeakRefs); ++i) {
+        HLSZeroingWeakRef *zeroingWeakRef = (HLSZeroingWeakRef *)CFArrayGetValueAtIndex(_zeroingWeakRefs, i);
+        zeroingWeakRef.cleanupSentinel = nil;
+    }
+    CFRelease(_zeroingWeakRefs);
+    _zeroingWeakRefs = NULL;
+    pthread_mutex_unlock(&s_locks[_lockIndex]);
+    
+    [super dealloc];
+}
+
+- (id)init
+{
+    HLSForbiddenInheritedMethod();
+    return nil;
+}
+
+#pragma mark Zeroing weak references (must be called with the lock held)
+
+- (void)addZeroingWeakRef:(HLSZeroingWeakRef *)zeroingWeakRef
+{
+    CFArrayAppendValue(_zeroingWeakRefs, zeroingWeakRef);
+}
+
+- (void)removeZeroingWeakRef:(HLSZeroingWeakRef *)zeroingWeakRef
+{
+    CFIndex index = CFArrayGetFirstIndexOfValue(_zeroingWeakRefs, CFRangeMake(0, CFArrayGetCount(_zeroingWeakRefs)), zeroingWeakRef);
+    if (index != kCFNotFound) {
+        CFArrayRemoveValueAtIndex(_zeroingWeakRefs, index);
+    }
+}
+
 @end
 
+#pragma mark Static functions
+
+static NSUInteger lockIndexForObject(id object)
+{
+    // Objects are at least 16-byte aligned. Mix higher bits in as well
+    uintptr_t address = (uintptr_t)object;
+    return ((address >> 4) ^ (address >> 12)) % HLSZeroingWeakRefLockCount;
+}
+
 static void subclass_dealloc(id object, SEL _cmd)
 {
-    // Set all weak references bound to object to nil
-    NSMutableSet *zeroingWeakRefValues = objc_getAssociatedObject(object, s_zeroingWeakRefListKey);
-    for (NSValue *zeroingWeakRefValue in zeroingWeakRefValues) {
+    // Invocations might release zeroing weak references, which could then restore the original class. Locate
+    // the parent implementation first
+    Class superclass = class_getSuperclass(object_getClass(object));
+    
+    // Set all weak references bound to object to nil. References released by invocations remove themselves 
+    // from the list: Only those still in it can be accessed. Invocations are collected with the lock held, but
+    // performed after it has been released
+    pthread_mutex_t *lock = &s_locks[lockIndexForObject(object)];
+    pthread_mutex_lock(lock);
+    NSMutableSet *zeroingWeakRefValues = [[objc_getAssociatedObject(object, s_zeroingWeakRefListKey) retain] autorelease];
+    NSArray *allZeroingWeakRefValues = [zeroingWeakRefValues allObjects];
+    pthread_mutex_unlock(lock);
+    
+    for (NSValue *zeroingWeakRefValue in allZeroingWeakRefValues) {
         HLSZeroingWeakRef *zeroingWeakRef = [zeroingWeakRefValue pointerValue];
         
         // Execute optional invocations
-        for (NSInvocation *invocation in zeroingWeakRef.invocations) {
+        NSArray *invocations = nil;
+        pthread_mutex_lock(lock);
+        if ([zeroingWeakRefValues containsObject:zeroingWeakRefValue]) {
+            invocations = [NSArray arrayWithArray:zeroingWeakRef.invocations];
+        }
+        pthread_mutex_unlock(lock);
+        
+        for (NSInvocation *invocation in invocations) {
             [invocation invoke];
         }
         
-        // Zeroing
-        zeroingWeakRef.object = nil;
+        // Zeroing (if still alive)
+        pthread_mutex_lock(lock);
+        if ([zeroingWeakRefValues containsObject:zeroingWeakRefValue]) {
+            zeroingWeakRef.object = nil;
+        }
+        pthread_mutex_unlock(lock);
     }
     
     // Call parent implementation
-    Class superclass = class_getSuperclass(object_getClass(object));
     void (*parent_dealloc_Imp)(id, SEL) = (void (*)(id, SEL))class_getMethodImplementation(superclass, @selector(dealloc));
     NSCAssert(parent_dealloc_Imp != NULL, @"Could not locate parent dealloc implementation");
     (*parent_dealloc_Imp)(object, _cmd);
@@ -16,14 +16,29 @@
 - (id)firstObject_hls;
 
 /**
- * Rotate array elements left or right (elements disappearing at an end are moved to the other end)
+ * Rotate array elements left or right (elements disappearing at an end are moved to the other end). No objects are
+ * copied: The returned array is a view on the receiver contents with remapped indices, which is created in constant
+ * time (an immutable copy of the receiver is made first if it is mutable). Rotating a rotated array does not nest 
+ * views. A mutable copy of the returned array is a usual NSMutableArray
  */
 - (NSArray *)arrayByLeftRotatingNumberOfObjects:(NSUInteger)numberOfElements;
 - (NSArray *)arrayByRightRotatingNumberOfObjects:(NSUInteger)numberOfElements;
 
 /**
- * Sort an array using a single descriptor
+ * Sort an array using a single descriptor. For selector-based descriptors, the sort keys are extracted once per 
+ * object (instead of going through KVC for each comparison), and objects are sorted with a stable merge sort, 
+ * performed on several threads for large arrays. Keys must therefore be immutable objects whose comparison 
+ * method is thread-safe (strings, numbers, dates, etc.). A nil key compares smaller than any other key, i.e. objects 
+ * with a nil key come first in ascending order, last in descending order
  */
 - (NSArray *)sortedArrayUsingDescriptor:(NSSortDescriptor *)sortDescriptor;
 
+/**
+ * Binary search in an array sorted using the specified descriptor. The first method returns the index of the first
+ * object comparing equal to object (NSNotFound if none), the second one returns the index at which object must be
+ * inserted to keep the array sorted (after all objects comparing equal to it). Both are O(log n)
+ */
+- (NSUInteger)indexOfObject:(id)object sortedUsingDescriptor:(NSSortDescriptor *)sortDescriptor;
+- (NSUInteger)insertionIndexForObject:(id)object sortedUsingDescriptor:(NSSortDescriptor *)sortDescriptor;
+
 @end
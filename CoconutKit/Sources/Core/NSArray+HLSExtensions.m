@@ -8,9 +8,67 @@
 
 #import "NSArray+HLSExtensions.h"
 
+#import <objc/runtime.h>
+
+// Below this number of objects, merge sort falls back to insertion sort
+static const NSUInteger kInsertionSortThreshold = 16;
+
+// Above this number of objects, chunks are sorted in parallel before being merged
+static const NSUInteger kParallelSortThreshold = 16384;
+
+// Maximum number of chunks sorted in parallel
+static const NSUInteger kParallelSortMaxChunkCount = 8;
+
+/**
+ * Information needed to compare sort keys. The comparison method implementation is cached for the last key class
+ * encountered, contexts must therefore not be shared between threads
+ */
+typedef struct {
+    id *keys;
+    SEL selector;
+    BOOL ascending;
+    Class cachedClass;
+    IMP cachedImplementation;
+} HLSSortContext;
+
+// Function declarations
+static NSComparisonResult compareKeysAtIndices(HLSSortContext *pContext, NSUInteger index1, NSUInteger index2);
+static void mergeSortIndices(HLSSortContext *pContext, NSUInteger *indices, NSUInteger *buffer, NSUInteger count);
+static void mergeIndices(HLSSortContext *pContext, NSUInteger *indices, NSUInteger leftCount, NSUInteger count, NSUInteger *buffer);
+
+/**
+ * Immutable array presenting the contents of another array shifted by some number of objects. Indices are remapped
+ * on the fly
+ */
+@interface HLSRotatedArray : NSArray {
+@private
+    NSArray *_array;
+    NSUInteger _shift;
+}
+
+- (id)initWithArray:(NSArray *)array shift:(NSUInteger)shift;
+
+@end
+
+/**
+ * Operation sorting a chunk of indices
+ */
+@interface HLSSortChunkOperation : NSOperation {
+@private
+    HLSSortContext _context;
+    NSUInteger *_indices;
+    NSUInteger *_buffer;
+    NSUInteger _count;
+}
+
+- (id)initWithContext:(HLSSortContext)context indices:(NSUInteger *)indices buffer:(NSUInteger *)buffer count:(NSUInteger)count;
+
+@end
+
 @interface NSArray (HLSExtensionsPrivate)
 
 - (NSArray *)arrayByShiftingNumberOfObjects:(NSUInteger)numberOfElements;
+- (NSUInteger)lowerBound:(BOOL)lowerBound forObject:(id)object sortedUsingDescriptor:(NSSortDescriptor *)sortDescriptor;
 
 @end
 
@@ -27,7 +85,7 @@
 
 - (NSArray *)arrayByLeftRotatingNumberOfObjects:(NSUInteger)numberOfObjects
 {
-    if (numberOfObjects == 0) {
+    if (numberOfObjects == 0 || [self count] == 0) {
         return self;
     }
     
@@ -37,7 +95,7 @@
 
 - (NSArray *)arrayByRightRotatingNumberOfObjects:(NSUInteger)numberOfObjects
 {
-    if (numberOfObjects == 0) {
+    if (numberOfObjects == 0 || [self count] == 0) {
         return self;
     }
     
@@ -45,16 +103,305 @@
     return [self arrayByShiftingNumberOfObjects:[self count] - shift];
 }
 
+- (NSArray *)sortedArrayUsingDescriptor:(NSSortDescriptor *)sortDescriptor
+{
+    // Comparator-based descriptors are sorted as usual
+    NSUInteger count = [self count];
+    if (! sortDescriptor || ! [sortDescriptor selector] || count < 2
+            || ([sortDescriptor respondsToSelector:@selector(comparator)] && [sortDescriptor comparator])) {
+        NSArray *sortDescriptors = sortDescriptor ? [NSArray arrayWithObject:sortDescriptor] : nil;
+        return [self sortedArrayUsingDescriptors:sortDescriptors];
+    }
+    
+    id *objects = malloc(count * sizeof(id));
+    id *keys = malloc(count * sizeof(id));
+    NSUInteger *indices = malloc(count * sizeof(NSUInteger));
+    NSUInteger *buffer = malloc(count * sizeof(NSUInteger));
+    
+    // Extract keys once (on the calling thread, since KVC might not be thread-safe for the objects)
+    [self getObjects:objects range:NSMakeRange(0, count)];
+    NSString *keyPath = [sortDescriptor key];
+    for (NSUInteger i = 0; i < count; ++i) {
+        keys[i] = keyPath ? [objects[i] valueForKeyPath:keyPath] : objects[i];
+        indices[i] = i;
+    }
+    
+    HLSSortContext context;
+    context.keys = keys;
+    context.selector = [sortDescriptor selector];
+    context.ascending = [sortDescriptor ascending];
+    context.cachedClass = Nil;
+    context.cachedImplementation = NULL;
+    
+    NSUInteger processorCount = [[NSProcessInfo processInfo] activeProcessorCount];
+    if (count >= kParallelSortThreshold && processorCount > 1) {
+        // Sort chunks in parallel, then merge them pairwise
+        NSUInteger chunkCount = MIN(processorCount, kParallelSortMaxChunkCount);
+        NSUInteger chunkSize = (count + chunkCount - 1) / chunkCount;
+        
+        NSOperationQueue *queue = [[[NSOperationQueue alloc] init] autorelease];
+        for (NSUInteger start = 0; start < count; start += chunkSize) {
+            NSUInteger length = MIN(chunkSize, count - start);
+            HLSSortChunkOperation *operation = [[[HLSSortChunkOperation alloc] initWithContext:context 
+                                                                                       indices:indices + start 
+                                                                                        buffer:buffer + start 
+                                                                                         count:length] autorelease];
+            [queue addOperation:operation];
+        }
+        [queue waitUntilAllOperationsAreFinished];
+        
+        for (NSUInteger width = chunkSize; width < count; width *= 2) {
+            for (NSUInteger start = 0; start + width < count; start += 2 * width) {
+                NSUInteger length = MIN(2 * width, count - start);
+                mergeIndices(&context, indices + start, width, length, buffer + start);
+            }
+        }
+    }
+    else {
+        mergeSortIndices(&context, indices, buffer, count);
+    }
+    
+    for (NSUInteger i = 0; i < count; ++i) {
+        keys[i] = objects[indices[i]];
+    }
+    NSArray *sortedArray = [NSArray arrayWithObjects:keys count:count];
+    
+    free(objects);
+    free(keys);
+    free(indices);
+    free(buffer);
+    
+    return sortedArray;
+}
+
+- (NSUInteger)indexOfObject:(id)object sortedUsingDescriptor:(NSSortDescriptor *)sortDescriptor
+{
+    NSUInteger index = [self lowerBound:YES forObject:object sortedUsingDescriptor:sortDescriptor];
+    if (index == [self count] || [sortDescriptor compareObject:[self objectAtIndex:index] toObject:object] != NSOrderedSame) {
+        return NSNotFound;
+    }
+    return index;
+}
+
+- (NSUInteger)insertionIndexForObject:(id)object sortedUsingDescriptor:(NSSortDescriptor *)sortDescriptor
+{
+    return [self lowerBound:NO forObject:object sortedUsingDescriptor:sortDescriptor];
+}
+
+@end
+
+@implementation NSArray (HLSExtensionsPrivate)
+
 - (NSArray *)arrayByShiftingNumberOfObjects:(NSUInteger)numberOfObjects
 {
-    return [[self subarrayWithRange:NSMakeRange(numberOfObjects, [self count] -  numberOfObjects)] 
-            arrayByAddingObjectsFromArray:[self subarrayWithRange:NSMakeRange(0, numberOfObjects)]];
+    if (numberOfObjects == 0) {
+        return self;
+    }
+    
+    return [[[HLSRotatedArray alloc] initWithArray:self shift:numberOfObjects] autorelease];
 }
 
-- (NSArray *)sortedArrayUsingDescriptor:(NSSortDescriptor *)sortDescriptor
+/**
+ * Return the index of the first object not ordered before object (lowerBound = YES), or the index of the first
+ * object ordered after it (lowerBound = NO)
+ */
+- (NSUInteger)lowerBound:(BOOL)lowerBound forObject:(id)object sortedUsingDescriptor:(NSSortDescriptor *)sortDescriptor
 {
-    NSArray *sortDescriptors = sortDescriptor ? [NSArray arrayWithObject:sortDescriptor] : nil;
-    return [self sortedArrayUsingDescriptors:sortDescriptors];
+    NSUInteger low = 0;
+    NSUInteger high = [self count];
+    while (low < high) {
+        NSUInteger middle = low + (high - low) / 2;
+        NSComparisonResult result = [sortDescriptor compareObject:[self objectAtIndex:middle] toObject:object];
+        if (result == NSOrderedAscending || (! lowerBound && result == NSOrderedSame)) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+    return low;
 }
 
 @end
+
+@implementation HLSRotatedArray
+
+#pragma mark -
+#pragma mark Object creation and destruction
+
+- (id)initWithArray:(NSArray *)array shift:(NSUInteger)shift
+{
+    if ((self = [super init])) {
+        // Compose with an existing rotation instead of nesting views
+        if ([array isKindOfClass:[HLSRotatedArray class]]) {
+            HLSRotatedArray *rotatedArray = (HLSRotatedArray *)array;
+            _array = [rotatedArray->_array retain];
+            _shift = (rotatedArray->_shift + shift) % [_array count];
+        }
+        else {
+            // Cheap (simply retains) for immutable arrays
+            _array = [array copy];
+            _shift = shift % [_array count];
+        }
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [_array release];
+    [super dealloc];
+}
+
+#pragma mark -
+#pragma mark NSArray primitive methods
+
+- (NSUInteger)count
+{
+    return [_array count];
+}
+
+- (id)objectAtIndex:(NSUInteger)index
+{
+    NSUInteger count = [_array count];
+    if (index >= count) {
+        [NSException raise:NSRangeException format:@"Index %u beyond bounds [0 .. %u]", index, count - 1];
+    }
+    
+    NSUInteger shiftedIndex = index + _shift;
+    return [_array objectAtIndex:(shiftedIndex < count) ? shiftedIndex : shiftedIndex - count];
+}
+
+#pragma mark -
+#pragma mark NSArray methods
+
+- (void)getObjects:(id *)objects range:(NSRange)range
+{
+    NSUInteger count = [_array count];
+    if (NSMaxRange(range) > count) {
+        [NSException raise:NSRangeException format:@"Range %@ beyond bounds [0 .. %u]", NSStringFromRange(range), count];
+    }
+    
+    // At most two contiguous ranges in the underlying array
+    NSUInteger location = range.location + _shift;
+    if (location >= count) {
+        location -= count;
+    }
+    NSUInteger firstLength = MIN(range.length, count - location);
+    [_array getObjects:objects range:NSMakeRange(location, firstLength)];
+    if (firstLength < range.length) {
+        [_array getObjects:objects + firstLength range:NSMakeRange(0, range.length - firstLength)];
+    }
+}
+
+#pragma mark -
+#pragma mark NSCopying protocol implementation
+
+- (id)copyWithZone:(NSZone *)zone
+{
+    return [self retain];
+}
+
+@end
+
+@implementation HLSSortChunkOperation
+
+#pragma mark -
+#pragma mark Object creation and destruction
+
+- (id)initWithContext:(HLSSortContext)context indices:(NSUInteger *)indices buffer:(NSUInteger *)buffer count:(NSUInteger)count
+{
+    if ((self = [super init])) {
+        // Each operation has its own context copy (and thus its own implementation cache)
+        _context = context;
+        _indices = indices;
+        _buffer = buffer;
+        _count = count;
+    }
+    return self;
+}
+
+#pragma mark -
+#pragma mark Operation
+
+- (void)main
+{
+    NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+    mergeSortIndices(&_context, _indices, _buffer, _count);
+    [pool drain];
+}
+
+@end
+
+#pragma mark Static functions
+
+static NSComparisonResult compareKeysAtIndices(HLSSortContext *pContext, NSUInteger index1, NSUInteger index2)
+{
+    id key1 = pContext->keys[index1];
+    id key2 = pContext->keys[index2];
+    
+    // nil is smaller than any other key (the order is then reversed for descending sorts, as any other result)
+    NSComparisonResult result;
+    if (! key1 || ! key2) {
+        result = (key1 == key2) ? NSOrderedSame : (key1 ? NSOrderedDescending : NSOrderedAscending);
+    }
+    else {
+        Class keyClass = object_getClass(key1);
+        if (keyClass != pContext->cachedClass) {
+            pContext->cachedClass = keyClass;
+            pContext->cachedImplementation = class_getMethodImplementation(keyClass, pContext->selector);
+        }
+        result = ((NSComparisonResult (*)(id, SEL, id))pContext->cachedImplementation)(key1, pContext->selector, key2);
+    }
+    
+    return pContext->ascending ? result : (NSComparisonResult)-result;
+}
+
+// Stable merge sort of indices (buffer must have the same size)
+static void mergeSortIndices(HLSSortContext *pContext, NSUInteger *indices, NSUInteger *buffer, NSUInteger count)
+{
+    if (count <= kInsertionSortThreshold) {
+        for (NSUInteger i = 1; i < count; ++i) {
+            NSUInteger index = indices[i];
+            NSUInteger j = i;
+            while (j > 0 && compareKeysAtIndices(pContext, indices[j - 1], index) == NSOrderedDescending) {
+                indices[j] = indices[j - 1];
+                --j;
+            }
+            indices[j] = index;
+        }
+        return;
+    }
+    
+    NSUInteger leftCount = count / 2;
+    mergeSortIndices(pContext, indices, buffer, leftCount);
+    mergeSortIndices(pContext, indices + leftCount, buffer + leftCount, count - leftCount);
+    mergeIndices(pContext, indices, leftCount, count, buffer);
+}
+
+// Merge the sorted ranges [0, leftCount[ and [leftCount, count[ of indices. Equal elements of the left range come first
+static void mergeIndices(HLSSortContext *pContext, NSUInteger *indices, NSUInteger leftCount, NSUInteger count, NSUInteger *buffer)
+{
+    // Already in order
+    if (compareKeysAtIndices(pContext, indices[leftCount - 1], indices[leftCount]) != NSOrderedDescending) {
+        return;
+    }
+    
+    NSUInteger left = 0;
+    NSUInteger right = leftCount;
+    NSUInteger i = 0;
+    while (left < leftCount && right < count) {
+        if (compareKeysAtIndices(pContext, indices[right], indices[left]) == NSOrderedAscending) {
+            buffer[i++] = indices[right++];
+        }
+        else {
+            buffer[i++] = indices[left++];
+        }
+    }
+    while (left < leftCount) {
+        buffer[i++] = indices[left++];
+    }
+    
+    // Remaining right elements are already in place
+    memcpy(indices, buffer, i * sizeof(NSUInteger));
+}
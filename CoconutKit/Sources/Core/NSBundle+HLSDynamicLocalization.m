@@ -48,7 +48,20 @@ NSString *HLSLocalizedStringFromUIKit(NSString *key)
 
 static NSString *currentLocalization = nil;
 
+// Parsed .strings tables (or NSNull if missing) and resolved .lproj names (or NSNull if not found) for the current
+// localization. Access must be synchronized since strings can be localized from any thread
+static NSMutableDictionary *s_localizationTables = nil;
+static NSMutableDictionary *s_localizationNames = nil;
+
+// Resolved single resource paths and URLs (or NSNull if not found) for the current localization. Bundle contents
+// do not change, so lookups only need to be performed again when the localization changes
+static NSMutableDictionary *s_resourceLookups = nil;
+
 static void setDefaultLocalization(void);
+static NSString *localizationNameForBundle(NSBundle *bundle);
+static NSString *resourceLookupKey(NSBundle *bundle, NSString *kind, NSString *name, NSString *extension, NSString *subpath);
+static id cachedResourceLookup(NSString *key, BOOL *pFound);
+static void cacheResourceLookup(NSString *key, id pathOrURL);
 static void exchangeNSBundleInstanceMethod(SEL originalSelector);
 static void initialize(void);
 
@@ -107,6 +120,13 @@ static void setDefaultLocalization(void)
     }
     
     if (![currentLocalization isEqualToString:previousLocalization]) {
+        // Tables for the previous localization are not needed anymore
+        @synchronized(s_localizationTables) {
+            [s_localizationTables removeAllObjects];
+            [s_localizationNames removeAllObjects];
+            [s_resourceLookups removeAllObjects];
+        }
+        
         [[NSNotificationCenter defaultCenter] postNotificationName:HLSCurrentLocalizationDidChangeNotification object:self];
     }
     
@@ -116,11 +136,11 @@ static void setDefaultLocalization(void)
 
 // MARK: - Localized strings
 
-- (NSString *)dynamic_localizedStringForKey:(NSString *)key value:(NSString *)value table:(NSString *)tableName;
+// Return the name of the .lproj directory of a bundle for the current localization, nil if none
+static NSString *localizationNameForBundle(NSBundle *bundle)
 {
     NSString *localizationName = currentLocalization;
-    BOOL lprojFound = YES;
-    NSString *lprojPath = [[[self bundlePath] stringByAppendingPathComponent:currentLocalization] stringByAppendingPathExtension:@"lproj"];
+    NSString *lprojPath = [[[bundle bundlePath] stringByAppendingPathComponent:currentLocalization] stringByAppendingPathExtension:@"lproj"];
     if (![[NSFileManager defaultManager] fileExistsAtPath:lprojPath]) {
         // Handle old style English.lproj / French.lproj / German.lproj ...
         static NSLocale *enLocale = nil;
@@ -128,16 +148,48 @@ static void setDefaultLocalization(void)
             enLocale = [[NSLocale alloc] initWithLocaleIdentifier:@"en"];
         }
         NSString *displayLocalizationName = [enLocale displayNameForKey:NSLocaleLanguageCode value:currentLocalization];
-        lprojPath = [[[self bundlePath] stringByAppendingPathComponent:displayLocalizationName] stringByAppendingPathExtension:@"lproj"];
+        lprojPath = [[[bundle bundlePath] stringByAppendingPathComponent:displayLocalizationName] stringByAppendingPathExtension:@"lproj"];
         if ([[NSFileManager defaultManager] fileExistsAtPath:lprojPath]) {
             localizationName = displayLocalizationName;
         }
         else {
-            lprojFound = NO;
+            return nil;
+        }
+    }
+    return localizationName;
+}
+
+- (NSString *)dynamic_localizedStringForKey:(NSString *)key value:(NSString *)value table:(NSString *)tableName;
+{
+    if (!currentLocalization) {
+        return [self dynamic_localizedStringForKey:key value:value table:tableName];
+    }
+    
+    if ([tableName length] == 0) {
+        tableName = @"Localizable";
+    }
+    
+    // Resolving the .lproj and parsing the .strings file is expensive. Do it once per bundle, localization and table
+    NSString *localizationNameKey = [NSString stringWithFormat:@"%@|%@", [self bundlePath], currentLocalization];
+    NSString *tableKey = [NSString stringWithFormat:@"%@|%@", localizationNameKey, tableName];
+    id localizationName = nil;
+    id table = nil;
+    @synchronized(s_localizationTables) {
+        localizationName = [[[s_localizationNames objectForKey:localizationNameKey] retain] autorelease];
+        table = [[[s_localizationTables objectForKey:tableKey] retain] autorelease];
+    }
+    
+    if (! localizationName) {
+        localizationName = localizationNameForBundle(self);
+        @synchronized(s_localizationTables) {
+            [s_localizationNames setObject:(localizationName ?: [NSNull null]) forKey:localizationNameKey];
         }
     }
+    else if (localizationName == [NSNull null]) {
+        localizationName = nil;
+    }
     
-    if (!currentLocalization || !lprojFound) {
+    if (!localizationName) {
         return [self dynamic_localizedStringForKey:key value:value table:tableName];
     }
     
@@ -145,12 +197,16 @@ static void setDefaultLocalization(void)
         return value;
     }
     
-    if ([tableName length] == 0) {
-        tableName = @"Localizable";
+    if (! table) {
+        NSString *tablePath = [self pathForResource:tableName ofType:@"strings" inDirectory:nil forLocalization:localizationName];
+        table = [NSDictionary dictionaryWithContentsOfFile:tablePath];
+        @synchronized(s_localizationTables) {
+            [s_localizationTables setObject:(table ?: [NSNull null]) forKey:tableKey];
+        }
+    }
+    else if (table == [NSNull null]) {
+        table = nil;
     }
-    
-    NSString *tablePath = [self pathForResource:tableName ofType:@"strings" inDirectory:nil forLocalization:localizationName];
-    NSDictionary *table = [NSDictionary dictionaryWithContentsOfFile:tablePath];
     
     NSString *localizedString = [table objectForKey:key];
     
@@ -169,7 +225,14 @@ static void setDefaultLocalization(void)
 
 - (NSURL *)dynamic_URLForResource:(NSString *)name withExtension:(NSString *)extension subdirectory:(NSString *)subpath
 {
-    return [self URLForResource:name withExtension:extension subdirectory:subpath localization:currentLocalization];
+    NSString *key = resourceLookupKey(self, @"URL", name, extension, subpath);
+    BOOL found = NO;
+    NSURL *URL = cachedResourceLookup(key, &found);
+    if (! found) {
+        URL = [self URLForResource:name withExtension:extension subdirectory:subpath localization:currentLocalization];
+        cacheResourceLookup(key, URL);
+    }
+    return URL;
 }
 
 - (NSURL *)dynamic_URLForResource:(NSString *)name withExtension:(NSString *)extension
@@ -187,7 +250,14 @@ static void setDefaultLocalization(void)
 
 - (NSString *)dynamic_pathForResource:(NSString *)name ofType:(NSString *)extension inDirectory:(NSString *)subpath
 {
-    return [self pathForResource:name ofType:extension inDirectory:subpath forLocalization:currentLocalization];
+    NSString *key = resourceLookupKey(self, @"path", name, extension, subpath);
+    BOOL found = NO;
+    NSString *path = cachedResourceLookup(key, &found);
+    if (! found) {
+        path = [self pathForResource:name ofType:extension inDirectory:subpath forLocalization:currentLocalization];
+        cacheResourceLookup(key, path);
+    }
+    return path;
 }
 
 - (NSString *)dynamic_pathForResource:(NSString *)name ofType:(NSString *)extension
@@ -201,6 +271,34 @@ static void setDefaultLocalization(void)
     return [self pathsForResourcesOfType:extension inDirectory:subpath forLocalization:currentLocalization];
 }
 
+// MARK: - Resource lookup cache
+
+static NSString *resourceLookupKey(NSBundle *bundle, NSString *kind, NSString *name, NSString *extension, NSString *subpath)
+{
+    return [NSString stringWithFormat:@"%@|%@|%@|%@|%@|%@", kind, [bundle bundlePath], currentLocalization, name ?: @"", 
+            extension ?: @"", subpath ?: @""];
+}
+
+// Return the cached path or URL for a key (nil if the resource was not found). Set *pFound to NO if the key has not
+// been looked up yet
+static id cachedResourceLookup(NSString *key, BOOL *pFound)
+{
+    id pathOrURL = nil;
+    @synchronized(s_localizationTables) {
+        pathOrURL = [[[s_resourceLookups objectForKey:key] retain] autorelease];
+    }
+    
+    *pFound = (pathOrURL != nil);
+    return (pathOrURL == [NSNull null]) ? nil : pathOrURL;
+}
+
+static void cacheResourceLookup(NSString *key, id pathOrURL)
+{
+    @synchronized(s_localizationTables) {
+        [s_resourceLookups setObject:(pathOrURL ?: [NSNull null]) forKey:key];
+    }
+}
+
 // MARK: - Swizzling
 
 static void exchangeNSBundleInstanceMethod(SEL originalSelector)
@@ -228,6 +326,10 @@ static void initialize(void)
     }
     initialized = YES;
     
+    s_localizationTables = [[NSMutableDictionary alloc] init];
+    s_localizationNames = [[NSMutableDictionary alloc] init];
+    s_resourceLookups = [[NSMutableDictionary alloc] init];
+    
     exchangeNSBundleInstanceMethod(@selector(localizedStringForKey:value:table:));
     
     exchangeNSBundleInstanceMethod(@selector(URLForResource:withExtension:));
@@ -17,7 +17,8 @@
 
 /**
  * Shortcuts to apply calendrical calculation methods to +[NSCalendar currentCalendar]. Refer to the instance method documentation
- * for more information
+ * for more information. These methods can be called from any thread. They do not create a new calendar for each call
+ * (the current calendar is cached per thread, and discarded when the current locale or the time zone change)
  */
 + (NSDate *)dateFromComponents:(NSDateComponents *)components;
 + (NSDate *)dateFromComponents:(NSDateComponents *)components inTimeZone:(NSTimeZone *)timeZone;
@@ -29,6 +30,11 @@
 + (NSUInteger)numberOfDaysInUnit:(NSCalendarUnit)unit containingDate:(NSDate *)date inTimeZone:(NSTimeZone *)timeZone;
 + (NSDate *)startDateOfUnit:(NSCalendarUnit)unit containingDate:(NSDate *)date;
 + (NSDate *)startDateOfUnit:(NSCalendarUnit)unit containingDate:(NSDate *)date inTimeZone:(NSTimeZone *)timeZone;
++ (void)getStartTimeIntervals:(NSTimeInterval *)startTimeIntervals 
+                       ofUnit:(NSCalendarUnit)unit 
+      containingTimeIntervals:(const NSTimeInterval *)timeIntervals 
+                        count:(NSUInteger)count
+                   inTimeZone:(NSTimeZone *)timeZone;
 + (NSDate *)endDateOfUnit:(NSCalendarUnit)unit containingDate:(NSDate *)date;
 + (NSDate *)endDateOfUnit:(NSCalendarUnit)unit containingDate:(NSDate *)date inTimeZone:(NSTimeZone *)timeZone;
 + (NSRange)rangeOfUnit:(NSCalendarUnit)smaller inUnit:(NSCalendarUnit)larger forDate:(NSDate *)date;
@@ -92,6 +98,23 @@
  */
 - (NSDate *)startDateOfUnit:(NSCalendarUnit)unit containingDate:(NSDate *)date inTimeZone:(NSTimeZone *)timeZone;
 
+/**
+ * Bulk version of -startDateOfUnit:containingDate:inTimeZone:, e.g. to group a large number of events by day or week. 
+ * Dates are given as time intervals since the reference date (see -[NSDate timeIntervalSinceReferenceDate]), and the 
+ * startTimeIntervals array (which must be able to hold count values) is filled with the start of the unit containing
+ * each of them. If timeZone is nil, the calendar time zone is used.
+ *
+ * For the NSDayCalendarUnit and NSWeekCalendarUnit units of the Gregorian calendar, most results are computed 
+ * arithmetically from the cached time zone offsets (see -[NSTimeZone secondsFromGMTForTimeInterval:]), without any 
+ * object being created. 
+ * Other units and calendars are supported as well, but are not faster than -startDateOfUnit:containingDate:inTimeZone:
+ */
+- (void)getStartTimeIntervals:(NSTimeInterval *)startTimeIntervals 
+                       ofUnit:(NSCalendarUnit)unit 
+      containingTimeIntervals:(const NSTimeInterval *)timeIntervals 
+                        count:(NSUInteger)count
+                   inTimeZone:(NSTimeZone *)timeZone;
+
 /**
  * Same as -startDateOfUnit:containingDate:, but returning the first date after the unit. For example, if unit is NSWeekCalendarUnit, 
  * the method returns the date corresponding to the first day (at midnight) of the week after the week to which the given date belongs
@@ -11,6 +11,24 @@
 #import "NSDate+HLSExtensions.h"
 #import "NSTimeZone+HLSExtensions.h"
 
+#import <libkern/OSAtomic.h>
+
+static NSString * const HLSCalendarThreadLocalStorageKey = @"HLSCalendarThreadLocalStorageKey";
+static NSString * const HLSCalendarGenerationThreadLocalStorageKey = @"HLSCalendarGenerationThreadLocalStorageKey";
+static NSString * const HLSCalendarTimeZoneThreadLocalStorageKey = @"HLSCalendarTimeZoneThreadLocalStorageKey";
+
+// Incremented each time the current locale or the system time zone change, so that cached calendars get discarded
+static volatile int32_t s_calendarGeneration = 0;
+
+// Margin around bucket starts within which no time zone transition must occur for the arithmetic computation to
+// be valid (larger than the largest offset from GMT)
+static const NSTimeInterval kTimeZoneTransitionMargin = 15. * 60. * 60.;
+
+static const NSTimeInterval kSecondsPerDay = 24. * 60. * 60.;
+
+// Function declarations
+static NSCalendar *currentCalendarForCurrentThread(void);
+
 /**
  * The strategy is always the same here: Since all methods available from NSCalendar use the calendar time zone, we
  * always have to convert dates from the time zone in which we want to work to the calendar time zone. In this time 
@@ -24,168 +42,200 @@
 
 @end
 
+@interface NSCalendar (HLSExtensionsPrivate)
+
++ (void)currentLocaleDidChange:(NSNotification *)notification;
++ (void)systemTimeZoneDidChange:(NSNotification *)notification;
+
+@end
+
 @implementation NSCalendar (HLSExtensions)
 
 #pragma mark Class methods
 
++ (void)load
+{
+    [[NSNotificationCenter defaultCenter] addObserver:self
+                                             selector:@selector(currentLocaleDidChange:)
+                                                 name:NSCurrentLocaleDidChangeNotification
+                                               object:nil];
+    [[NSNotificationCenter defaultCenter] addObserver:self
+                                             selector:@selector(systemTimeZoneDidChange:)
+                                                 name:NSSystemTimeZoneDidChangeNotification
+                                               object:nil];
+}
+
 + (NSDate *)dateFromComponents:(NSDateComponents *)components
 {
-    return [[NSCalendar currentCalendar] dateFromComponents:components];
+    return [currentCalendarForCurrentThread() dateFromComponents:components];
 }
 
 + (NSDate *)dateFromComponents:(NSDateComponents *)components inTimeZone:(NSTimeZone *)timeZone
 {
-    return [[NSCalendar currentCalendar] dateFromComponents:components inTimeZone:timeZone];
+    return [currentCalendarForCurrentThread() dateFromComponents:components inTimeZone:timeZone];
 }
 
 + (NSDateComponents *)components:(NSUInteger)unitFlags fromDate:(NSDate *)date
 {
-    return [[NSCalendar currentCalendar] components:unitFlags fromDate:date];
+    return [currentCalendarForCurrentThread() components:unitFlags fromDate:date];
 }
 
 + (NSDateComponents *)components:(NSUInteger)unitFlags fromDate:(NSDate *)date inTimeZone:(NSTimeZone *)timeZone
 {
-    return [[NSCalendar currentCalendar] components:unitFlags fromDate:date inTimeZone:timeZone];
+    return [currentCalendarForCurrentThread() components:unitFlags fromDate:date inTimeZone:timeZone];
 }
 
 + (NSRange)minimumRangeOfUnit:(NSCalendarUnit)unit
 {
-    return [[NSCalendar currentCalendar] minimumRangeOfUnit:unit];
+    return [currentCalendarForCurrentThread() minimumRangeOfUnit:unit];
 }
 
 + (NSRange)maximumRangeOfUnit:(NSCalendarUnit)unit
 {
-    return [[NSCalendar currentCalendar] maximumRangeOfUnit:unit];
+    return [currentCalendarForCurrentThread() maximumRangeOfUnit:unit];
 }
 
 + (NSUInteger)numberOfDaysInUnit:(NSCalendarUnit)unit containingDate:(NSDate *)date
 {
-    return [[NSCalendar currentCalendar] numberOfDaysInUnit:unit containingDate:date];
+    return [currentCalendarForCurrentThread() numberOfDaysInUnit:unit containingDate:date];
 }
 
 + (NSUInteger)numberOfDaysInUnit:(NSCalendarUnit)unit containingDate:(NSDate *)date inTimeZone:(NSTimeZone *)timeZone
 {
-    return [[NSCalendar currentCalendar] numberOfDaysInUnit:unit containingDate:date inTimeZone:timeZone];
+    return [currentCalendarForCurrentThread() numberOfDaysInUnit:unit containingDate:date inTimeZone:timeZone];
 }
 
 + (NSDate *)startDateOfUnit:(NSCalendarUnit)unit containingDate:(NSDate *)date
 {
-    return [[NSCalendar currentCalendar] startDateOfUnit:unit containingDate:date];
+    return [currentCalendarForCurrentThread() startDateOfUnit:unit containingDate:date];
 }
 
 + (NSDate *)startDateOfUnit:(NSCalendarUnit)unit containingDate:(NSDate *)date inTimeZone:(NSTimeZone *)timeZone
 {
-    return [[NSCalendar currentCalendar] startDateOfUnit:unit containingDate:date inTimeZone:timeZone];
+    return [currentCalendarForCurrentThread() startDateOfUnit:unit containingDate:date inTimeZone:timeZone];
+}
+
++ (void)getStartTimeIntervals:(NSTimeInterval *)startTimeIntervals 
+                       ofUnit:(NSCalendarUnit)unit 
+      containingTimeIntervals:(const NSTimeInterval *)timeIntervals 
+                        count:(NSUInteger)count
+                   inTimeZone:(NSTimeZone *)timeZone
+{
+    [currentCalendarForCurrentThread() getStartTimeIntervals:startTimeIntervals 
+                                                      ofUnit:unit 
+                                     containingTimeIntervals:timeIntervals 
+                                                       count:count 
+                                                  inTimeZone:timeZone];
 }
 
 + (NSDate *)endDateOfUnit:(NSCalendarUnit)unit containingDate:(NSDate *)date
 {
-    return [[NSCalendar currentCalendar] endDateOfUnit:unit containingDate:date];
+    return [currentCalendarForCurrentThread() endDateOfUnit:unit containingDate:date];
 }
 
 + (NSDate *)endDateOfUnit:(NSCalendarUnit)unit containingDate:(NSDate *)date inTimeZone:(NSTimeZone *)timeZone
 {
-    return [[NSCalendar currentCalendar] endDateOfUnit:unit containingDate:date inTimeZone:timeZone];
+    return [currentCalendarForCurrentThread() endDateOfUnit:unit containingDate:date inTimeZone:timeZone];
 }
 
 + (NSRange)rangeOfUnit:(NSCalendarUnit)smaller inUnit:(NSCalendarUnit)larger forDate:(NSDate *)date
 {
-    return [[NSCalendar currentCalendar] rangeOfUnit:smaller inUnit:larger forDate:date];
+    return [currentCalendarForCurrentThread() rangeOfUnit:smaller inUnit:larger forDate:date];
 }
 
 + (NSRange)rangeOfUnit:(NSCalendarUnit)smaller inUnit:(NSCalendarUnit)larger forDate:(NSDate *)date inTimeZone:(NSTimeZone *)timeZone
 {
-    return [[NSCalendar currentCalendar] rangeOfUnit:smaller inUnit:larger forDate:date inTimeZone:timeZone];
+    return [currentCalendarForCurrentThread() rangeOfUnit:smaller inUnit:larger forDate:date inTimeZone:timeZone];
 }
 
 + (NSUInteger)ordinalityOfUnit:(NSCalendarUnit)smaller inUnit:(NSCalendarUnit)larger forDate:(NSDate *)date
 {
-    return [[NSCalendar currentCalendar] ordinalityOfUnit:smaller inUnit:larger forDate:date];
+    return [currentCalendarForCurrentThread() ordinalityOfUnit:smaller inUnit:larger forDate:date];
 }
 
 + (NSUInteger)ordinalityOfUnit:(NSCalendarUnit)smaller inUnit:(NSCalendarUnit)larger forDate:(NSDate *)date inTimeZone:(NSTimeZone *)timeZone
 {
-    return [[NSCalendar currentCalendar] ordinalityOfUnit:smaller inUnit:larger forDate:date inTimeZone:timeZone];
+    return [currentCalendarForCurrentThread() ordinalityOfUnit:smaller inUnit:larger forDate:date inTimeZone:timeZone];
 }
 
 + (BOOL)rangeOfUnit:(NSCalendarUnit)unit startDate:(NSDate **)pStartDate interval:(NSTimeInterval *)pInterval forDate:(NSDate *)date
 {
-    return [[NSCalendar currentCalendar] rangeOfUnit:unit startDate:pStartDate interval:pInterval forDate:date];
+    return [currentCalendarForCurrentThread() rangeOfUnit:unit startDate:pStartDate interval:pInterval forDate:date];
 }
 
 + (BOOL)rangeOfUnit:(NSCalendarUnit)unit startDate:(NSDate **)pStartDate interval:(NSTimeInterval *)pInterval forDate:(NSDate *)date inTimeZone:(NSTimeZone *)timeZone
 {
-    return [[NSCalendar currentCalendar] rangeOfUnit:unit startDate:pStartDate interval:pInterval forDate:date inTimeZone:timeZone];
+    return [currentCalendarForCurrentThread() rangeOfUnit:unit startDate:pStartDate interval:pInterval forDate:date inTimeZone:timeZone];
 }
 
 + (NSDate *)dateByAddingComponents:(NSDateComponents *)components toDate:(NSDate *)date options:(NSUInteger)options
 {
-    return [[NSCalendar currentCalendar] dateByAddingComponents:components toDate:date options:options];
+    return [currentCalendarForCurrentThread() dateByAddingComponents:components toDate:date options:options];
 }
 
 + (NSDate *)dateByAddingComponents:(NSDateComponents *)components toDate:(NSDate *)date options:(NSUInteger)options inTimeZone:(NSTimeZone *)timeZone
 {
-    return [[NSCalendar currentCalendar] dateByAddingComponents:components toDate:date options:options inTimeZone:timeZone];
+    return [currentCalendarForCurrentThread() dateByAddingComponents:components toDate:date options:options inTimeZone:timeZone];
 }
 
 + (NSDateComponents *)components:(NSUInteger)unitFlags fromDate:(NSDate *)startDate toDate:(NSDate *)endDate options:(NSUInteger)options
 {
-    return [[NSCalendar currentCalendar] components:unitFlags fromDate:startDate toDate:endDate options:options];
+    return [currentCalendarForCurrentThread() components:unitFlags fromDate:startDate toDate:endDate options:options];
 }
 
 + (NSDateComponents *)components:(NSUInteger)unitFlags fromDate:(NSDate *)startDate toDate:(NSDate *)endDate options:(NSUInteger)options inTimeZone:(NSTimeZone *)timeZone
 {
-    return [[NSCalendar currentCalendar] components:unitFlags fromDate:startDate toDate:endDate options:options inTimeZone:timeZone];
+    return [currentCalendarForCurrentThread() components:unitFlags fromDate:startDate toDate:endDate options:options inTimeZone:timeZone];
 }
 
 + (NSDate *)dateAtNoonTheSameDayAsDate:(NSDate *)date
 {
-    return [[NSCalendar currentCalendar] dateAtNoonTheSameDayAsDate:date];
+    return [currentCalendarForCurrentThread() dateAtNoonTheSameDayAsDate:date];
 }
 
 + (NSDate *)dateAtNoonTheSameDayAsDate:(NSDate *)date inTimeZone:(NSTimeZone *)timeZone
 {
-    return [[NSCalendar currentCalendar] dateAtNoonTheSameDayAsDate:date inTimeZone:timeZone];
+    return [currentCalendarForCurrentThread() dateAtNoonTheSameDayAsDate:date inTimeZone:timeZone];
 }
 
 + (NSDate *)dateAtMidnightTheSameDayAsDate:(NSDate *)date
 {
-    return [[NSCalendar currentCalendar] dateAtMidnightTheSameDayAsDate:date];
+    return [currentCalendarForCurrentThread() dateAtMidnightTheSameDayAsDate:date];
 }
 
 + (NSDate *)dateAtMidnightTheSameDayAsDate:(NSDate *)date inTimeZone:(NSTimeZone *)timeZone
 {
-    return [[NSCalendar currentCalendar] dateAtMidnightTheSameDayAsDate:date inTimeZone:timeZone];
+    return [currentCalendarForCurrentThread() dateAtMidnightTheSameDayAsDate:date inTimeZone:timeZone];
 }
 
 + (NSDate *)dateAtHour:(NSInteger)hour minute:(NSInteger)minute second:(NSInteger)second theSameDayAsDate:(NSDate *)date
 {
-    return [[NSCalendar currentCalendar] dateAtHour:hour minute:minute second:second theSameDayAsDate:date];
+    return [currentCalendarForCurrentThread() dateAtHour:hour minute:minute second:second theSameDayAsDate:date];
 }
 
 + (NSDate *)dateAtHour:(NSInteger)hour minute:(NSInteger)minute second:(NSInteger)second theSameDayAsDate:(NSDate *)date inTimeZone:(NSTimeZone *)timeZone
 {
-    return [[NSCalendar currentCalendar] dateAtHour:hour minute:minute second:second theSameDayAsDate:date inTimeZone:timeZone];
+    return [currentCalendarForCurrentThread() dateAtHour:hour minute:minute second:second theSameDayAsDate:date inTimeZone:timeZone];
 }
 
 + (NSComparisonResult)compareDaysBetweenDate:(NSDate *)date1 andDate:(NSDate *)date2
 {
-    return [[NSCalendar currentCalendar] compareDaysBetweenDate:date1 andDate:date2];
+    return [currentCalendarForCurrentThread() compareDaysBetweenDate:date1 andDate:date2];
 }
 
 + (NSComparisonResult)compareDaysBetweenDate:(NSDate *)date1 andDate:(NSDate *)date2 inTimeZone:(NSTimeZone *)timeZone
 {
-    return [[NSCalendar currentCalendar] compareDaysBetweenDate:date1 andDate:date2 inTimeZone:timeZone];
+    return [currentCalendarForCurrentThread() compareDaysBetweenDate:date1 andDate:date2 inTimeZone:timeZone];
 }
 
 + (BOOL)isDate:(NSDate *)date1 theSameDayAsDate:(NSDate *)date2
 {
-    return [[NSCalendar currentCalendar] isDate:date1 theSameDayAsDate:date2];
+    return [currentCalendarForCurrentThread() isDate:date1 theSameDayAsDate:date2];
 }
 
 + (BOOL)isDate:(NSDate *)date1 theSameDayAsDate:(NSDate *)date2 inTimeZone:(NSTimeZone *)timeZone
 {
-    return [[NSCalendar currentCalendar] isDate:date1 theSameDayAsDate:date2 inTimeZone:timeZone];
+    return [currentCalendarForCurrentThread() isDate:date1 theSameDayAsDate:date2 inTimeZone:timeZone];
 }
 
 #pragma mark Calendrical calculations
@@ -266,6 +316,76 @@
     return [timeZone dateWithSameComponentsAsDate:startDateInCalendarTimeZone fromTimeZone:[self timeZone]];
 }
 
+- (void)getStartTimeIntervals:(NSTimeInterval *)startTimeIntervals 
+                       ofUnit:(NSCalendarUnit)unit 
+      containingTimeIntervals:(const NSTimeInterval *)timeIntervals 
+                        count:(NSUInteger)count
+                   inTimeZone:(NSTimeZone *)timeZone
+{
+    if (count == 0) {
+        return;
+    }
+    
+    if (! timeZone) {
+        timeZone = [self timeZone];
+    }
+    
+    // Slow path: Unit lengths vary or the calendar is not known
+    BOOL arithmetic = (unit == NSDayCalendarUnit || unit == NSWeekCalendarUnit) 
+        && [[self calendarIdentifier] isEqualToString:NSGregorianCalendar];
+    if (! arithmetic) {
+        for (NSUInteger i = 0; i < count; ++i) {
+            NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+            NSDate *date = [NSDate dateWithTimeIntervalSinceReferenceDate:timeIntervals[i]];
+            startTimeIntervals[i] = [[self startDateOfUnit:unit containingDate:date inTimeZone:timeZone] timeIntervalSinceReferenceDate];
+            [pool drain];
+        }
+        return;
+    }
+    
+    // The reference date (2001-01-01) is a Monday (weekday 2 in the Gregorian calendar)
+    NSInteger firstWeekday = [self firstWeekday];
+    
+    // Bucket starts close to a time zone transition are computed by the calendar. Remember the last one, since dates
+    // are often sorted
+    NSTimeInterval lastFallbackLocalStartTimeInterval = NAN;
+    NSTimeInterval lastFallbackStartTimeInterval = 0.;
+    
+    for (NSUInteger i = 0; i < count; ++i) {
+        NSTimeInterval timeInterval = timeIntervals[i];
+        NSInteger offset = [timeZone secondsFromGMTForTimeInterval:timeInterval];
+        
+        // Day number in local time
+        NSInteger day = (NSInteger)floor((timeInterval + offset) / kSecondsPerDay);
+        if (unit == NSWeekCalendarUnit) {
+            NSInteger weekday = (day + 1) % 7;
+            if (weekday < 0) {
+                weekday += 7;
+            }
+            weekday += 1;
+            day -= (weekday - firstWeekday + 7) % 7;
+        }
+        NSTimeInterval localStartTimeInterval = day * kSecondsPerDay;
+        
+        // Same offset on both sides of the margin: No transition near the bucket start (time zones never have two 
+        // transitions within such a short time), the offset is constant there
+        NSInteger startOffset = [timeZone secondsFromGMTForTimeInterval:localStartTimeInterval - kTimeZoneTransitionMargin];
+        if (startOffset == [timeZone secondsFromGMTForTimeInterval:localStartTimeInterval + kTimeZoneTransitionMargin]) {
+            startTimeIntervals[i] = localStartTimeInterval - startOffset;
+        }
+        else {
+            if (localStartTimeInterval != lastFallbackLocalStartTimeInterval) {
+                NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+                NSDate *date = [NSDate dateWithTimeIntervalSinceReferenceDate:timeInterval];
+                lastFallbackStartTimeInterval = [[self startDateOfUnit:unit containingDate:date inTimeZone:timeZone] timeIntervalSinceReferenceDate];
+                lastFallbackLocalStartTimeInterval = localStartTimeInterval;
+                [pool drain];
+            }
+            startTimeIntervals[i] = lastFallbackStartTimeInterval;
+        }
+    }
+}
+
 - (NSDate *)endDateOfUnit:(NSCalendarUnit)unit containingDate:(NSDate *)date
 {
     return [self endDateOfUnit:unit containingDate:date inTimeZone:[self timeZone]];
@@ -420,6 +540,18 @@
     return comparisonResult == NSOrderedSame;
 }
 
+#pragma mark Notification callbacks
+
++ (void)currentLocaleDidChange:(NSNotification *)notification
+{
+    OSAtomicIncrement32Barrier(&s_calendarGeneration);
+}
+
++ (void)systemTimeZoneDidChange:(NSNotification *)notification
+{
+    OSAtomicIncrement32Barrier(&s_calendarGeneration);
+}
+
 @end
 
 @implementation NSDateComponents (HLSExtensionsPrivate)
@@ -468,3 +600,25 @@
 
 @end
 
+#pragma mark Static functions
+
+// +[NSCalendar currentCalendar] returns a new calendar each time it is called. Since calendars are not thread-safe, 
+// keep one per thread. The calendar is discarded when the current locale or the system time zone change, or when
+// the default time zone is changed (this is not notified, the time zone is therefore checked each time)
+static NSCalendar *currentCalendarForCurrentThread(void)
+{
+    NSMutableDictionary *threadDictionary = [[NSThread currentThread] threadDictionary];
+    NSNumber *generationNumber = [NSNumber numberWithInt:OSAtomicAdd32Barrier(0, &s_calendarGeneration)];
+    NSTimeZone *defaultTimeZone = [NSTimeZone defaultTimeZone];
+    
+    NSCalendar *calendar = [threadDictionary objectForKey:HLSCalendarThreadLocalStorageKey];
+    if (! calendar 
+            || ! [[threadDictionary objectForKey:HLSCalendarGenerationThreadLocalStorageKey] isEqualToNumber:generationNumber]
+            || [threadDictionary objectForKey:HLSCalendarTimeZoneThreadLocalStorageKey] != defaultTimeZone) {
+        calendar = [NSCalendar currentCalendar];
+        [threadDictionary setObject:calendar forKey:HLSCalendarThreadLocalStorageKey];
+        [threadDictionary setObject:generationNumber forKey:HLSCalendarGenerationThreadLocalStorageKey];
+        [threadDictionary setObject:defaultTimeZone forKey:HLSCalendarTimeZoneThreadLocalStorageKey];
+    }
+    return calendar;
+}
@@ -6,6 +6,12 @@
 //  Copyright 2011 Hortis. All rights reserved.
 //
 
+/**
+ * 64-bit xxHash (XXH64) of a byte buffer. xxHash is a very fast non-cryptographic hash function, well suited for
+ * computing e.g. cache keys, but which must not be used when cryptographic strength is required
+ */
+uint64_t HLSXXH64(const void *bytes, size_t length, uint64_t seed);
+
 @interface NSData (HLSExtensions)
 
 /**
@@ -48,4 +54,11 @@
  */
 - (NSString *)sha512hash;
 
+/**
+ * Calculates the XXH64 hash (seed 0), as value or in its canonical (big-endian) hexadecimal representation. Much 
+ * faster than the digest methods above, but not cryptographic
+ */
+- (uint64_t)xxh64Value;
+- (NSString *)xxh64hash;
+
 @end
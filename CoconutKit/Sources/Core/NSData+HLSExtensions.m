@@ -8,21 +8,117 @@
 
 #import "NSData+HLSExtensions.h"
 
+#import "HLSConverters.h"
+
 #import <CommonCrypto/CommonDigest.h>
 
+// XXH64 constants (see https://github.com/Cyan4973/xxHash)
+static const uint64_t kXXH64Prime1 = 11400714785074694791ULL;
+static const uint64_t kXXH64Prime2 = 14029467366897019727ULL;
+static const uint64_t kXXH64Prime3 = 1609587929392839161ULL;
+static const uint64_t kXXH64Prime4 = 9650029242287828579ULL;
+static const uint64_t kXXH64Prime5 = 2870177450012600261ULL;
+
 static NSString* digest(NSData *data, unsigned char *(*cc_digest)(const void *, CC_LONG, unsigned char *), CC_LONG digestLength)
 {
 	unsigned char md[digestLength];     // C99
     memset(md, 0, sizeof(md));
 	cc_digest([data bytes], [data length], md);
+    return HLSHexStringFromBytes(md, sizeof(md));
+}
+
+#pragma mark XXH64 implementation
+
+static inline uint64_t xxh64RotateLeft(uint64_t value, int count)
+{
+    return (value << count) | (value >> (64 - count));
+}
+
+// Reads are unaligned-safe. Values are read in the native byte order, which is little-endian on all iOS devices, as
+// required by XXH64
+static inline uint64_t xxh64Read64(const unsigned char *bytes)
+{
+    uint64_t value;
+    memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+static inline uint32_t xxh64Read32(const unsigned char *bytes)
+{
+    uint32_t value;
+    memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+static inline uint64_t xxh64Round(uint64_t accumulator, uint64_t input)
+{
+    accumulator += input * kXXH64Prime2;
+    accumulator = xxh64RotateLeft(accumulator, 31);
+    return accumulator * kXXH64Prime1;
+}
+
+static inline uint64_t xxh64MergeRound(uint64_t accumulator, uint64_t value)
+{
+    accumulator ^= xxh64Round(0, value);
+    return accumulator * kXXH64Prime1 + kXXH64Prime4;
+}
+
+uint64_t HLSXXH64(const void *bytes, size_t length, uint64_t seed)
+{
+    const unsigned char *p = (const unsigned char *)bytes;
+    const unsigned char *end = p + length;
+    uint64_t hash;
+    
+    if (length >= 32) {
+        const unsigned char *limit = end - 32;
+        uint64_t v1 = seed + kXXH64Prime1 + kXXH64Prime2;
+        uint64_t v2 = seed + kXXH64Prime2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - kXXH64Prime1;
+        do {
+            v1 = xxh64Round(v1, xxh64Read64(p)); p += 8;
+            v2 = xxh64Round(v2, xxh64Read64(p)); p += 8;
+            v3 = xxh64Round(v3, xxh64Read64(p)); p += 8;
+            v4 = xxh64Round(v4, xxh64Read64(p)); p += 8;
+        } while (p <= limit);
+        
+        hash = xxh64RotateLeft(v1, 1) + xxh64RotateLeft(v2, 7) + xxh64RotateLeft(v3, 12) + xxh64RotateLeft(v4, 18);
+        hash = xxh64MergeRound(hash, v1);
+        hash = xxh64MergeRound(hash, v2);
+        hash = xxh64MergeRound(hash, v3);
+        hash = xxh64MergeRound(hash, v4);
+    }
+    else {
+        hash = seed + kXXH64Prime5;
+    }
+    
+    hash += (uint64_t)length;
+    
+    while (p + 8 <= end) {
+        hash ^= xxh64Round(0, xxh64Read64(p));
+        hash = xxh64RotateLeft(hash, 27) * kXXH64Prime1 + kXXH64Prime4;
+        p += 8;
+    }
+    
+    if (p + 4 <= end) {
+        hash ^= (uint64_t)xxh64Read32(p) * kXXH64Prime1;
+        hash = xxh64RotateLeft(hash, 23) * kXXH64Prime2 + kXXH64Prime3;
+        p += 4;
+    }
     
-    // Hexadecimal representation
-    NSMutableString *hexHash = [NSMutableString string];
-    for (NSUInteger i = 0; i < sizeof(md); ++i) {
-        [hexHash appendFormat:@"%02X", md[i]];
+    while (p < end) {
+        hash ^= (*p) * kXXH64Prime5;
+        hash = xxh64RotateLeft(hash, 11) * kXXH64Prime1;
+        ++p;
     }
     
-    return [hexHash lowercaseString];
+    // Avalanche
+    hash ^= hash >> 33;
+    hash *= kXXH64Prime2;
+    hash ^= hash >> 29;
+    hash *= kXXH64Prime3;
+    hash ^= hash >> 32;
+    return hash;
 }
 
 @implementation NSData (HLSExtensions)
@@ -69,4 +165,21 @@ static NSString* digest(NSData *data, unsigned char *(*cc_digest)(const void *,
     return digest(self, CC_SHA512, CC_SHA512_DIGEST_LENGTH);
 }
 
+- (uint64_t)xxh64Value
+{
+    return HLSXXH64([self bytes], [self length], 0);
+}
+
+- (NSString *)xxh64hash
+{
+    uint64_t hash = [self xxh64Value];
+    
+    // Canonical representation (big-endian)
+    unsigned char bytes[sizeof(hash)];
+    for (NSUInteger i = 0; i < sizeof(hash); ++i) {
+        bytes[i] = (unsigned char)(hash >> (8 * (sizeof(hash) - 1 - i)));
+    }
+    return HLSHexStringFromBytes(bytes, sizeof(bytes));
+}
+
 @end
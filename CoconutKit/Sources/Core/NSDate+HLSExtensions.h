@@ -8,6 +8,13 @@
 
 @interface NSDate (HLSExtensions)
 
+/**
+ * Call this method as soon as possible if you want date descriptions (e.g. when logging dates) to also display the
+ * date in the system time zone. Only meant for debugging purposes. For simplicity you should use the 
+ * HLSEnableNSDateSystemTimeZoneDescription convenience macro instead (see HLSOptionalFeatures.h)
+ */
++ (void)enable;
+
 /**
  * Convenience methods for date comparisons. Easier to read than -[NSDate compare:]
  */
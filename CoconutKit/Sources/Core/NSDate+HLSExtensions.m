@@ -8,10 +8,11 @@
 
 #import "NSDate+HLSExtensions.h"
 
+#import "HLSLogger.h"
 #import "HLSRuntime.h"
 #import "NSCalendar+HLSExtensions.h"
 
-static NSDateFormatter *s_dateFormatter = nil;
+#include <time.h>
 
 // Original implementation of the methods we swizzle
 static id (*s_NSDate__descriptionWithLocale_Imp)(id, SEL, id) = NULL;
@@ -23,22 +24,20 @@ static NSString *swizzled_NSDate__descriptionWithLocale_Imp(NSDate *self, SEL _c
 
 #pragma mark Class methods
 
-+ (void)load
++ (void)enable
 {
+    static BOOL s_injected = NO;
+    if (s_injected) {
+        HLSLoggerInfo(@"Date system time zone description already injected");
+        return;
+    }
+    
+    // Only needed for debugging purposes
     s_NSDate__descriptionWithLocale_Imp = (id (*)(id, SEL, id))HLSSwizzleSelector(self, 
                                                                                   @selector(descriptionWithLocale:),
                                                                                   (IMP)swizzled_NSDate__descriptionWithLocale_Imp);
-}
-
-+ (void)initialize
-{
-    if (self != [NSDate class]) {
-        return;
-    }
     
-    // Create time formatter for system timezone (which is the default one if not set)
-    s_dateFormatter = [[NSDateFormatter alloc] init];
-    [s_dateFormatter setDateFormat:@"yyyy'-'MM'-'dd' 'HH':'mm':'ss' 'ZZZ"];
+    s_injected = YES;
 }
 
 #pragma mark Convenience methods
@@ -70,5 +69,19 @@ static NSString *swizzled_NSDate__descriptionWithLocale_Imp(NSDate *self, SEL _c
 static NSString *swizzled_NSDate__descriptionWithLocale_Imp(NSDate *self, SEL _cmd, id locale)
 {
     NSString *originalString = (*s_NSDate__descriptionWithLocale_Imp)(self, _cmd, locale);
-    return [NSString stringWithFormat:@"%@ (system time zone: %@)", originalString, [s_dateFormatter stringFromDate:self]];
+    
+    // Formatted using the C library (thread-safe when using the reentrant version of gmtime, and much cheaper than 
+    // a date formatter). The time zone offset is the one of the default time zone, as for a date formatter (the 
+    // process time zone used by localtime would ignore changes made using +[NSTimeZone setDefaultTimeZone:])
+    NSInteger offset = [[NSTimeZone defaultTimeZone] secondsFromGMTForDate:self];
+    time_t time = (time_t)floor([self timeIntervalSince1970]) + offset;
+    struct tm localTime;
+    char buffer[32];
+    if (! gmtime_r(&time, &localTime) || strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &localTime) == 0) {
+        return originalString;
+    }
+    
+    NSInteger absoluteOffsetInMinutes = labs(offset) / 60;
+    return [NSString stringWithFormat:@"%@ (system time zone: %s %c%02d%02d)", originalString, buffer, offset < 0 ? '-' : '+',
+            (int)(absoluteOffsetInMinutes / 60), (int)(absoluteOffsetInMinutes % 60)];
 }
@@ -15,4 +15,15 @@
 + (NSArray *)orderedWeekdaySymbols;
 + (NSArray *)orderedShortWeekdaySymbols;
 
+/**
+ * Return a date formatter for the given format (10.4 behavior), the current locale and the default time zone. Creating 
+ * and configuring a date formatter is expensive, this method therefore returns formatters from a cache (discarded 
+ * when the current locale or the system time zone change). Date formatters are not thread-safe, each thread therefore
+ * gets its own cache
+ *
+ * The formatter returned is shared and must not be altered. It must not be passed to another thread either. If you 
+ * need to customize a formatter, create your own
+ */
++ (NSDateFormatter *)cachedDateFormatterWithFormat:(NSString *)dateFormat;
+
 @end
@@ -10,32 +10,125 @@
 
 #import "NSArray+HLSExtensions.h"
 
+#import <libkern/OSAtomic.h>
+
+static NSString * const HLSDateFormatterCacheThreadLocalStorageKey = @"HLSDateFormatterCacheThreadLocalStorageKey";
+static NSString * const HLSDateFormatterCacheGenerationThreadLocalStorageKey = @"HLSDateFormatterCacheGenerationThreadLocalStorageKey";
+
+// Incremented each time cached formatters and symbols must be discarded
+static volatile int32_t s_cacheGeneration = 0;
+
+@interface NSDateFormatter (HLSExtensionsPrivate)
+
++ (NSMutableDictionary *)dateFormatterCacheForCurrentThread;
+
++ (void)currentLocaleDidChange:(NSNotification *)notification;
++ (void)systemTimeZoneDidChange:(NSNotification *)notification;
+
+@end
+
 @implementation NSDateFormatter (HLSExtensions)
 
+#pragma mark Class methods
+
++ (void)load
+{
+    [[NSNotificationCenter defaultCenter] addObserver:self
+                                             selector:@selector(currentLocaleDidChange:)
+                                                 name:NSCurrentLocaleDidChangeNotification
+                                               object:nil];
+    [[NSNotificationCenter defaultCenter] addObserver:self
+                                             selector:@selector(systemTimeZoneDidChange:)
+                                                 name:NSSystemTimeZoneDidChangeNotification
+                                               object:nil];
+}
+
 + (NSArray *)orderedWeekdaySymbols
 {
     static NSArray *s_orderedWeekdays = nil;
-    if (! s_orderedWeekdays) {
-        NSDateFormatter *dateFormatter = [[[NSDateFormatter alloc] init] autorelease];
-        NSArray *weekDays = [dateFormatter weekdaySymbols];
-        // firstWeekday returns indices starting at 1
-        NSUInteger offset = [[NSCalendar currentCalendar] firstWeekday] - 1;
-        s_orderedWeekdays = [[weekDays arrayByLeftRotatingNumberOfObjects:offset] retain];
+    static int32_t s_orderedWeekdaysGeneration = -1;
+    int32_t cacheGeneration = OSAtomicAdd32Barrier(0, &s_cacheGeneration);
+    @synchronized(self) {
+        if (! s_orderedWeekdays || s_orderedWeekdaysGeneration != cacheGeneration) {
+            NSArray *weekDays = [[self cachedDateFormatterWithFormat:nil] weekdaySymbols];
+            // firstWeekday returns indices starting at 1
+            NSUInteger offset = [[NSCalendar currentCalendar] firstWeekday] - 1;
+            [s_orderedWeekdays release];
+            s_orderedWeekdays = [[weekDays arrayByLeftRotatingNumberOfObjects:offset] retain];
+            s_orderedWeekdaysGeneration = cacheGeneration;
+        }
+        
+        // The cached array might be replaced by another thread after the lock has been released
+        return [[s_orderedWeekdays retain] autorelease];
     }
-    return s_orderedWeekdays;
 }
 
 + (NSArray *)orderedShortWeekdaySymbols
 {
     static NSArray *s_orderedShortWeekdays = nil;
-    if (! s_orderedShortWeekdays) {
-        NSDateFormatter *dateFormatter = [[[NSDateFormatter alloc] init] autorelease];
-        NSArray *shortWeekDays = [dateFormatter shortWeekdaySymbols];
-        // firstWeekday returns indices starting at 1
-        NSUInteger offset = [[NSCalendar currentCalendar] firstWeekday] - 1;
-        s_orderedShortWeekdays = [[shortWeekDays arrayByLeftRotatingNumberOfObjects:offset] retain];
+    static int32_t s_orderedShortWeekdaysGeneration = -1;
+    int32_t cacheGeneration = OSAtomicAdd32Barrier(0, &s_cacheGeneration);
+    @synchronized(self) {
+        if (! s_orderedShortWeekdays || s_orderedShortWeekdaysGeneration != cacheGeneration) {
+            NSArray *shortWeekDays = [[self cachedDateFormatterWithFormat:nil] shortWeekdaySymbols];
+            // firstWeekday returns indices starting at 1
+            NSUInteger offset = [[NSCalendar currentCalendar] firstWeekday] - 1;
+            [s_orderedShortWeekdays release];
+            s_orderedShortWeekdays = [[shortWeekDays arrayByLeftRotatingNumberOfObjects:offset] retain];
+            s_orderedShortWeekdaysGeneration = cacheGeneration;
+        }
+        
+        // The cached array might be replaced by another thread after the lock has been released
+        return [[s_orderedShortWeekdays retain] autorelease];
     }
-    return s_orderedShortWeekdays;
+}
+
++ (NSDateFormatter *)cachedDateFormatterWithFormat:(NSString *)dateFormat
+{
+    NSLocale *locale = [NSLocale currentLocale];
+    NSTimeZone *timeZone = [NSTimeZone defaultTimeZone];
+    NSString *key = [NSString stringWithFormat:@"%@|%@|%@", dateFormat ? dateFormat : @"", [locale localeIdentifier], [timeZone name]];
+    
+    NSMutableDictionary *dateFormatterCache = [self dateFormatterCacheForCurrentThread];
+    NSDateFormatter *dateFormatter = [dateFormatterCache objectForKey:key];
+    if (! dateFormatter) {
+        dateFormatter = [[[NSDateFormatter alloc] init] autorelease];
+        [dateFormatter setFormatterBehavior:NSDateFormatterBehavior10_4];
+        [dateFormatter setLocale:locale];
+        [dateFormatter setTimeZone:timeZone];
+        if (dateFormat) {
+            [dateFormatter setDateFormat:dateFormat];
+        }
+        [dateFormatterCache setObject:dateFormatter forKey:key];
+    }
+    return dateFormatter;
+}
+
++ (NSMutableDictionary *)dateFormatterCacheForCurrentThread
+{
+    NSMutableDictionary *threadDictionary = [[NSThread currentThread] threadDictionary];
+    NSNumber *cacheGenerationNumber = [NSNumber numberWithInt:OSAtomicAdd32Barrier(0, &s_cacheGeneration)];
+    
+    // Discard formatters created before the last locale or time zone change
+    NSMutableDictionary *dateFormatterCache = [threadDictionary objectForKey:HLSDateFormatterCacheThreadLocalStorageKey];
+    if (! dateFormatterCache || ! [[threadDictionary objectForKey:HLSDateFormatterCacheGenerationThreadLocalStorageKey] isEqualToNumber:cacheGenerationNumber]) {
+        dateFormatterCache = [NSMutableDictionary dictionary];
+        [threadDictionary setObject:dateFormatterCache forKey:HLSDateFormatterCacheThreadLocalStorageKey];
+        [threadDictionary setObject:cacheGenerationNumber forKey:HLSDateFormatterCacheGenerationThreadLocalStorageKey];
+    }
+    return dateFormatterCache;
+}
+
+#pragma mark Notification callbacks
+
++ (void)currentLocaleDidChange:(NSNotification *)notification
+{
+    OSAtomicIncrement32Barrier(&s_cacheGeneration);
+}
+
++ (void)systemTimeZoneDidChange:(NSNotification *)notification
+{
+    OSAtomicIncrement32Barrier(&s_cacheGeneration);
 }
 
 @end
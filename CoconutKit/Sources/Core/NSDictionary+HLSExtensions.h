@@ -9,17 +9,18 @@
 @interface NSDictionary (HLSExtensions)
 
 /**
- * Return the receiver, to which object has been set for key
+ * Return the receiver, to which object has been set for key. The returned dictionary is an HLSPersistentDictionary,
+ * so that subsequent updates applied to it share most of their storage and do not copy the whole dictionary
  */
 - (id)dictionaryBySettingObject:(id)object forKey:(id)key;
 
 /**
- * Return the receiver without the object designated by key
+ * Return the receiver without the object designated by key (as an HLSPersistentDictionary)
  */
 - (id)dictionaryByRemovingObjectForKey:(id)key;
 
 /**
- * Return the receiver without the objects designated by the keys and the array
+ * Return the receiver without the objects designated by the keys and the array (as an HLSPersistentDictionary)
  */
 - (id)dictionaryByRemovingObjectsForKeys:(NSArray *)keyArray;
 
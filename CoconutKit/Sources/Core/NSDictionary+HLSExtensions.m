@@ -8,27 +8,66 @@
 
 #import "NSDictionary+HLSExtensions.h"
 
+#import "HLSPersistentDictionary.h"
+#import "HLSRuntime.h"
+
+// Associated object keys
+static void *s_persistentDictionaryKey = &s_persistentDictionaryKey;
+
+@interface NSDictionary (HLSExtensionsPrivate)
+
+- (HLSPersistentDictionary *)persistentDictionary;
+
+@end
+
 @implementation NSDictionary (HLSExtensions)
 
+// HLSPersistentDictionary overrides the first two methods. Other dictionaries are converted
 - (id)dictionaryBySettingObject:(id)object forKey:(id)key
 {
-    NSMutableDictionary *dictionary = [NSMutableDictionary dictionaryWithDictionary:self];
-    [dictionary setObject:object forKey:key];
-    return [NSDictionary dictionaryWithDictionary:dictionary];
+    return [[self persistentDictionary] dictionaryBySettingObject:object forKey:key];
 }
 
 - (id)dictionaryByRemovingObjectForKey:(id)key
 {
-    NSMutableDictionary *dictionary = [NSMutableDictionary dictionaryWithDictionary:self];
-    [dictionary removeObjectForKey:key];
-    return [NSDictionary dictionaryWithDictionary:dictionary];
+    return [[self persistentDictionary] dictionaryByRemovingObjectForKey:key];
 }
 
 - (id)dictionaryByRemovingObjectsForKeys:(NSArray *)keyArray
 {
-    NSMutableDictionary *dictionary = [NSMutableDictionary dictionaryWithDictionary:self];
-    [dictionary removeObjectsForKeys:keyArray];
-    return [NSDictionary dictionaryWithDictionary:dictionary];
+    NSDictionary *dictionary = [self persistentDictionary];
+    for (id key in keyArray) {
+        dictionary = [dictionary dictionaryByRemovingObjectForKey:key];
+    }
+    return dictionary;
+}
+
+@end
+
+@implementation NSDictionary (HLSExtensionsPrivate)
+
+// Return the receiver as an HLSPersistentDictionary. Immutable dictionaries are converted once, the result is cached
+// so that repeated updates of the same dictionary do not pay for a full copy each time. Mutable dictionaries might
+// have changed since the last call and are always converted (so are toll-free bridged dictionaries, which cannot be
+// told apart from mutable ones)
+- (HLSPersistentDictionary *)persistentDictionary
+{
+    if ([self isKindOfClass:[HLSPersistentDictionary class]]) {
+        return (HLSPersistentDictionary *)self;
+    }
+    
+    if ([self isKindOfClass:[NSMutableDictionary class]]) {
+        return [HLSPersistentDictionary dictionaryWithDictionary:self];
+    }
+    
+    // Immutable dictionaries are often shared between threads. Concurrent first calls might convert the receiver
+    // several times, which is harmless
+    HLSPersistentDictionary *persistentDictionary = objc_getAssociatedObject(self, s_persistentDictionaryKey);
+    if (! persistentDictionary) {
+        persistentDictionary = [HLSPersistentDictionary dictionaryWithDictionary:self];
+        objc_setAssociatedObject(self, s_persistentDictionaryKey, persistentDictionary, OBJC_ASSOCIATION_RETAIN);
+    }
+    return persistentDictionary;
 }
 
 @end
@@ -14,8 +14,14 @@
 - (void)safelyAddObject:(id)object;
 
 /**
- * Sort an array using a single descriptor
+ * Sort an array using a single descriptor (see -[NSArray sortedArrayUsingDescriptor:])
  */
 - (void)sortUsingDescriptor:(NSSortDescriptor *)sortDescriptor;
 
+/**
+ * Insert an object into an array sorted using the specified descriptor, so that it stays sorted. The object is
+ * inserted after all objects comparing equal to it. Return the index at which the object has been inserted
+ */
+- (NSUInteger)insertObject:(id)object sortedUsingDescriptor:(NSSortDescriptor *)sortDescriptor;
+
 @end
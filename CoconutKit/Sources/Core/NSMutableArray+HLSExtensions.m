@@ -8,6 +8,8 @@
 
 #import "NSMutableArray+HLSExtensions.h"
 
+#import "NSArray+HLSExtensions.h"
+
 @implementation NSMutableArray (HLSExtensions)
 
 - (void)safelyAddObject:(id)object
@@ -20,8 +22,14 @@
 
 - (void)sortUsingDescriptor:(NSSortDescriptor *)sortDescriptor
 {
-    NSArray *sortDescriptors = sortDescriptor ? [NSArray arrayWithObject:sortDescriptor] : nil;
-    return [self sortUsingDescriptors:sortDescriptors];
+    [self setArray:[self sortedArrayUsingDescriptor:sortDescriptor]];
+}
+
+- (NSUInteger)insertObject:(id)object sortedUsingDescriptor:(NSSortDescriptor *)sortDescriptor
+{
+    NSUInteger index = [self insertionIndexForObject:object sortedUsingDescriptor:sortDescriptor];
+    [self insertObject:object atIndex:index];
+    return index;
 }
 
 @end
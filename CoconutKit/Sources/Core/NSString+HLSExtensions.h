@@ -21,9 +21,34 @@ NSString *HLSStringFromCATransform3D(CATransform3D transform);
  */
 - (BOOL)isFilled;
 
+/**
+ * Same as -[NSString sizeWithFont:constrainedToSize:lineBreakMode:], but results are stored in a cache shared by the 
+ * whole application, keyed by string, font, size constraint and line break mode. Layout code measuring the same strings
+ * again and again should use this method instead. Since string measurement is thread-safe since iOS 4, this method can 
+ * be called from any thread, e.g. to compute sizes for a list in the background before it is displayed. The cache 
+ * is automatically purged when memory is low
+ */
+- (CGSize)cachedSizeWithFont:(UIFont *)font constrainedToSize:(CGSize)size lineBreakMode:(UILineBreakMode)lineBreakMode;
+
+/**
+ * Same as -[NSString sizeWithFont:], using the cache of -cachedSizeWithFont:constrainedToSize:lineBreakMode:
+ */
+- (CGSize)cachedSizeWithFont:(UIFont *)font;
+
 /**
  * Given a font, return the largest font size (smaller than font.pointSize and larger than a given minimum size) so that
- * the receiver fits within a given area on a maximum number of lines.
+ * the receiver fits within a given area on a maximum number of lines. Candidate sizes are obtained by decreasing 
+ * font.pointSize in steps of the given precision (which must be > 0), and are tested using a binary search. Results
+ * are cached, and this method can be called from any thread
+ */
+- (CGFloat)fontSizeWithFont:(UIFont *)font 
+          constrainedToSize:(CGSize)size 
+                minFontSize:(CGFloat)minFontSize
+              numberOfLines:(NSUInteger)numberOfLines
+                  precision:(CGFloat)precision;
+
+/**
+ * Same as above, with a precision of 1 point
  */
 - (CGFloat)fontSizeWithFont:(UIFont *)font 
           constrainedToSize:(CGSize)size 
@@ -36,6 +61,14 @@ NSString *HLSStringFromCATransform3D(CATransform3D transform);
  */
 - (NSString *)urlEncodedStringUsingEncoding:(NSStringEncoding)encoding;
 
+/**
+ * Build a URL query string (without leading question mark) from a dictionary of parameters, e.g. a=1&b=hello%20world. 
+ * Keys and values are URL encoded as with -urlEncodedStringUsingEncoding:. Values which are not strings are converted
+ * using their description. Parameters are sorted by key so that the result is reproducible (e.g. for caching or 
+ * signing requests). Return nil if a key or a value cannot be represented using the specified encoding
+ */
++ (NSString *)queryStringWithParameters:(NSDictionary *)parameters usingEncoding:(NSStringEncoding)encoding;
+
 /**
  * Calculate the MD2 hash of a string (hexadecimal)
  */
@@ -76,6 +109,13 @@ NSString *HLSStringFromCATransform3D(CATransform3D transform);
  */
 - (NSString *)sha512hash;
 
+/**
+ * Calculate the XXH64 hash of a string (UTF-8), as value or in hexadecimal form. Much faster than the digest methods 
+ * above and well suited for cache keys, but not cryptographic (see NSData+HLSExtensions.h)
+ */
+- (uint64_t)xxh64Value;
+- (NSString *)xxh64hash;
+
 /**
  * At Hortis, we use a convenient way to identify versions during development, for tags and for official releases:
  *   - For all versions except AppStore releases:         [lastVersionNumber+]versionNumber[+qualifier]
@@ -9,8 +9,132 @@
 #import "NSString+HLSExtensions.h"
 
 #import <CommonCrypto/CommonDigest.h>
+#import "HLSConverters.h"
 #import "HLSFloat.h"
 #import "HLSLogger.h"
+#import "NSData+HLSExtensions.h"
+
+static const NSUInteger kStringSizeCacheCountLimit = 1000;
+
+static NSCache *s_stringSizeCache = nil;
+
+static NSCache *s_fontSizeCache = nil;
+
+static void createStringSizeCache(void *context)
+{
+    s_stringSizeCache = [[NSCache alloc] init];
+    s_stringSizeCache.countLimit = kStringSizeCacheCountLimit;
+}
+
+static void createFontSizeCache(void *context)
+{
+    s_fontSizeCache = [[NSCache alloc] init];
+    s_fontSizeCache.countLimit = kStringSizeCacheCountLimit;
+}
+
+// Return YES iff a string drawn with the specified font fits within a given area, on a maximum number of lines
+static BOOL stringFitsWithFont(NSString *string, UIFont *font, CGSize size, NSUInteger numberOfLines)
+{
+    CGFloat height = [string cachedSizeWithFont:font
+                              constrainedToSize:CGSizeMake(size.width, FLT_MAX)
+                                  lineBreakMode:UILineBreakModeWordWrap].height;
+    
+    // Empty text
+    if (floateq(height, 0.f)) {
+        return YES;
+    }
+    
+    CGFloat lineHeight = [string cachedSizeWithFont:font
+                                  constrainedToSize:CGSizeMake(FLT_MAX, FLT_MAX)
+                                      lineBreakMode:UILineBreakModeWordWrap].height;
+    return floatle(height, size.height) && floatle(ceilf(height / lineHeight), numberOfLines);
+}
+
+// Return the index of the first (or last, if backwards is YES) non-whitespace character of a string, kCFNotFound if none. 
+// Characters are read using an inline buffer (directly from the string storage if possible), no memory is allocated
+static CFIndex nonWhitespaceCharacterIndex(NSString *string, BOOL backwards)
+{
+    CFIndex length = CFStringGetLength((CFStringRef)string);
+    if (length == 0) {
+        return kCFNotFound;
+    }
+    
+    CFCharacterSetRef whitespaceCharacterSet = CFCharacterSetGetPredefined(kCFCharacterSetWhitespace);
+    CFStringInlineBuffer inlineBuffer;
+    CFStringInitInlineBuffer((CFStringRef)string, &inlineBuffer, CFRangeMake(0, length));
+    for (CFIndex i = 0; i < length; ++i) {
+        CFIndex index = backwards ? length - 1 - i : i;
+        UniChar character = CFStringGetCharacterFromInlineBuffer(&inlineBuffer, index);
+        if (! CFCharacterSetIsCharacterMember(whitespaceCharacterSet, character)) {
+            return index;
+        }
+    }
+    return kCFNotFound;
+}
+
+// Percent-encode a string (bytes obtained using the specified encoding) into a buffer, which must be able to hold at least 
+// 3 * [string maxLengthOfBytesUsingEncoding:encoding] bytes. Only unreserved characters (RFC 3986) are left as is. Bytes 
+// are converted in chunks on the stack, no memory is allocated. Return the number of bytes written, or NSNotFound if the 
+// string cannot be represented using the encoding
+static NSUInteger urlEncodeStringIntoBuffer(NSString *string, NSStringEncoding encoding, char *buffer)
+{
+    static const char kHexDigits[] = "0123456789ABCDEF";
+    
+    // Unreserved characters: ALPHA / DIGIT / "-" / "." / "_" / "~"
+    static const BOOL kUnreservedCharacters[256] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,    // 0x00 - 0x0F
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,    // 0x10 - 0x1F
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0,    // 0x20 - 0x2F
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0,    // 0x30 - 0x3F
+        0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,    // 0x40 - 0x4F
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 1,    // 0x50 - 0x5F
+        0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,    // 0x60 - 0x6F
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 1, 0,    // 0x70 - 0x7F
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,    // 0x80 - 0x8F
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,    // 0x90 - 0x9F
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,    // 0xA0 - 0xAF
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,    // 0xB0 - 0xBF
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,    // 0xC0 - 0xCF
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,    // 0xD0 - 0xDF
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,    // 0xE0 - 0xEF
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0     // 0xF0 - 0xFF
+    };
+    
+    char *position = buffer;
+    NSUInteger length = [string length];
+    NSRange remainingRange = NSMakeRange(0, length);
+    while (remainingRange.length != 0) {
+        uint8_t bytes[256];
+        NSUInteger usedLength = 0;
+        if (! [string getBytes:bytes
+                     maxLength:sizeof(bytes)
+                    usedLength:&usedLength
+                      encoding:encoding
+                       options:0
+                         range:remainingRange
+                remainingRange:&remainingRange]) {
+            return NSNotFound;
+        }
+        
+        // Not a single character could be converted
+        if (usedLength == 0) {
+            return NSNotFound;
+        }
+        
+        for (NSUInteger i = 0; i < usedLength; ++i) {
+            uint8_t byte = bytes[i];
+            if (kUnreservedCharacters[byte]) {
+                *position++ = (char)byte;
+            }
+            else {
+                *position++ = '%';
+                *position++ = kHexDigits[byte >> 4];
+                *position++ = kHexDigits[byte & 0x0F];
+            }
+        }
+    }
+    return position - buffer;
+}
 
 static NSString* digest(NSString *string, unsigned char *(*cc_digest)(const void *, CC_LONG, unsigned char *), CC_LONG digestLength)
 {
@@ -19,14 +143,7 @@ static NSString* digest(NSString *string, unsigned char *(*cc_digest)(const void
     memset(md, 0, sizeof(md));
     const char *utf8str = [string UTF8String];
 	cc_digest(utf8str, strlen(utf8str), md);
-    
-    // Hexadecimal representation
-    NSMutableString *hexHash = [NSMutableString string];
-    for (NSUInteger i = 0; i < sizeof(md); ++i) {
-        [hexHash appendFormat:@"%02X", md[i]];
-    }
-    
-    return [hexHash lowercaseString];
+    return HLSHexStringFromBytes(md, sizeof(md));
 }
 
 @implementation NSString (HLSExtensions)
@@ -35,12 +152,54 @@ static NSString* digest(NSString *string, unsigned char *(*cc_digest)(const void
 
 - (NSString *)stringByTrimmingWhitespaces
 {
-    return [self stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+    CFIndex firstIndex = nonWhitespaceCharacterIndex(self, NO);
+    if (firstIndex == kCFNotFound) {
+        return @"";
+    }
+    
+    CFIndex lastIndex = nonWhitespaceCharacterIndex(self, YES);
+    
+    // Nothing to trim. Copying an immutable string just retains it
+    if (firstIndex == 0 && lastIndex == (CFIndex)[self length] - 1) {
+        return [[self copy] autorelease];
+    }
+    
+    return [self substringWithRange:NSMakeRange(firstIndex, lastIndex - firstIndex + 1)];
 }
 
 - (BOOL)isFilled
 {
-    return [[self stringByTrimmingWhitespaces] length] != 0;
+    // Stops at the first non-whitespace character
+    return nonWhitespaceCharacterIndex(self, NO) != kCFNotFound;
+}
+
+#pragma mark Text measurement
+
+- (CGSize)cachedSizeWithFont:(UIFont *)font constrainedToSize:(CGSize)size lineBreakMode:(UILineBreakMode)lineBreakMode
+{
+    // NSCache is thread-safe. Create it once, in a thread-safe way
+    static dispatch_once_t s_onceToken;
+    dispatch_once_f(&s_onceToken, NULL, createStringSizeCache);
+    
+    if (! font) {
+        return CGSizeZero;
+    }
+    
+    NSString *key = [NSString stringWithFormat:@"%@|%g|%g|%g|%d|%@", font.fontName, font.pointSize, size.width, size.height, 
+                     lineBreakMode, self];
+    NSValue *sizeValue = [s_stringSizeCache objectForKey:key];
+    if (sizeValue) {
+        return [sizeValue CGSizeValue];
+    }
+    
+    CGSize textSize = [self sizeWithFont:font constrainedToSize:size lineBreakMode:lineBreakMode];
+    [s_stringSizeCache setObject:[NSValue valueWithCGSize:textSize] forKey:key];
+    return textSize;
+}
+
+- (CGSize)cachedSizeWithFont:(UIFont *)font
+{
+    return [self cachedSizeWithFont:font constrainedToSize:CGSizeMake(FLT_MAX, FLT_MAX) lineBreakMode:UILineBreakModeWordWrap];
 }
 
 #pragma mark Font size adjustment
@@ -50,6 +209,7 @@ static NSString* digest(NSString *string, unsigned char *(*cc_digest)(const void
           constrainedToSize:(CGSize)size 
                 minFontSize:(CGFloat)minFontSize
               numberOfLines:(NSUInteger)numberOfLines
+                  precision:(CGFloat)precision
 {    
     if (floatle(font.pointSize, minFontSize)) {
         return minFontSize;
@@ -60,50 +220,133 @@ static NSString* digest(NSString *string, unsigned char *(*cc_digest)(const void
         return font.pointSize;
     }
     
-    CGFloat height = [self sizeWithFont:font
-                      constrainedToSize:CGSizeMake(size.width, FLT_MAX)
-                          lineBreakMode:UILineBreakModeWordWrap].height;
-    
-    // Empty text
-    if (floateq(height, 0.f)) {
-        return font.pointSize;
+    if (floatle(precision, 0.f)) {
+        HLSLoggerWarn(@"The precision must be > 0. Fixed to 1");
+        precision = 1.f;
     }
     
-    CGFloat lineHeight = [self sizeWithFont:font
-                          constrainedToSize:CGSizeMake(FLT_MAX, FLT_MAX)
-                              lineBreakMode:UILineBreakModeWordWrap].height;
+    static dispatch_once_t s_onceToken;
+    dispatch_once_f(&s_onceToken, NULL, createFontSizeCache);
+    
+    NSString *key = [NSString stringWithFormat:@"%@|%g|%g|%g|%g|%u|%g|%@", font.fontName, font.pointSize, size.width, size.height,
+                     minFontSize, numberOfLines, precision, self];
+    NSNumber *fontSizeNumber = [s_fontSizeCache objectForKey:key];
+    if (fontSizeNumber) {
+        return [fontSizeNumber floatValue];
+    }
     
-    // Reduce the font size so that the text fits vertically
-    UIFont *newFont = font;
-    while (floatgt(height, size.height) || floatgt(ceilf(height / lineHeight), numberOfLines)) {
-        if (floatle(newFont.pointSize, minFontSize)) {
-            return minFontSize;
+    CGFloat fontSize = minFontSize;
+    if (stringFitsWithFont(self, font, size, numberOfLines)) {
+        fontSize = font.pointSize;
+    }
+    else {
+        // The candidate sizes are font.pointSize - k * precision, for k in [1; numberOfSteps]. The text fits for all
+        // values of k from some value on. Find it using a binary search
+        NSUInteger lowerStep = 1;
+        NSUInteger upperStep = (NSUInteger)floorf((font.pointSize - minFontSize) / precision) + 1;
+        while (lowerStep < upperStep) {
+            NSUInteger step = (lowerStep + upperStep) / 2;
+            UIFont *candidateFont = [UIFont fontWithName:font.fontName size:font.pointSize - step * precision];
+            if (stringFitsWithFont(self, candidateFont, size, numberOfLines)) {
+                upperStep = step;
+            }
+            else {
+                lowerStep = step + 1;
+            }
         }
         
-        newFont = [UIFont fontWithName:font.fontName size:newFont.pointSize - 1.f];
-        height = [self sizeWithFont:newFont 
-                  constrainedToSize:CGSizeMake(size.width, FLT_MAX) 
-                      lineBreakMode:UILineBreakModeWordWrap].height;
-        
-        lineHeight = [self sizeWithFont:newFont 
-                      constrainedToSize:CGSizeMake(FLT_MAX, FLT_MAX) 
-                          lineBreakMode:UILineBreakModeWordWrap].height;        
+        // If no candidate size fits, the search ends beyond the last candidate, below the minimum size
+        fontSize = floatmax(font.pointSize - lowerStep * precision, minFontSize);
     }
     
-    return newFont.pointSize;
+    [s_fontSizeCache setObject:[NSNumber numberWithFloat:fontSize] forKey:key];
+    return fontSize;
+}
+
+- (CGFloat)fontSizeWithFont:(UIFont *)font 
+          constrainedToSize:(CGSize)size 
+                minFontSize:(CGFloat)minFontSize
+              numberOfLines:(NSUInteger)numberOfLines
+{
+    return [self fontSizeWithFont:font constrainedToSize:size minFontSize:minFontSize numberOfLines:numberOfLines precision:1.f];
 }
 
 #pragma mark URL encoding
 
++ (NSString *)queryStringWithParameters:(NSDictionary *)parameters usingEncoding:(NSStringEncoding)encoding
+{
+    NSArray *keys = [[parameters allKeys] sortedArrayUsingSelector:@selector(compare:)];
+    
+    // Collect the strings to encode, and the maximum size of the result (one '=' and one '&' per parameter)
+    NSMutableArray *strings = [NSMutableArray arrayWithCapacity:2 * [keys count]];
+    NSUInteger capacity = 0;
+    for (id key in keys) {
+        id value = [parameters objectForKey:key];
+        NSString *keyString = [key isKindOfClass:[NSString class]] ? key : [key description];
+        NSString *valueString = [value isKindOfClass:[NSString class]] ? value : [value description];
+        [strings addObject:keyString];
+        [strings addObject:valueString];
+        capacity += 3 * ([keyString maxLengthOfBytesUsingEncoding:encoding] + [valueString maxLengthOfBytesUsingEncoding:encoding]) + 2;
+    }
+    
+    if ([strings count] == 0) {
+        return @"";
+    }
+    
+    // Encode everything into a single buffer, which is then owned by the resulting string
+    char *buffer = malloc(capacity);
+    if (! buffer) {
+        HLSLoggerError(@"Could not allocate the buffer needed to encode the parameters");
+        return nil;
+    }
+    
+    char *position = buffer;
+    NSUInteger index = 0;
+    for (NSString *string in strings) {
+        if (index != 0) {
+            *position++ = (index % 2 == 0) ? '&' : '=';
+        }
+        
+        NSUInteger length = urlEncodeStringIntoBuffer(string, encoding, position);
+        if (length == NSNotFound) {
+            HLSLoggerError(@"The string %@ cannot be represented using the specified encoding", string);
+            free(buffer);
+            return nil;
+        }
+        position += length;
+        ++index;
+    }
+    
+    // If the buffer cannot be shrunk, keep it as is
+    NSUInteger length = position - buffer;
+    char *shrunkBuffer = realloc(buffer, length);
+    if (shrunkBuffer) {
+        buffer = shrunkBuffer;
+    }
+    return [[[NSString alloc] initWithBytesNoCopy:buffer length:length encoding:NSASCIIStringEncoding freeWhenDone:YES] autorelease];
+}
+
 - (NSString *)urlEncodedStringUsingEncoding:(NSStringEncoding)encoding
 {
-    CFStringEncoding cfEncoding = CFStringConvertNSStringEncodingToEncoding(encoding);
-    NSString *result = NSMakeCollectable(CFURLCreateStringByAddingPercentEscapes(kCFAllocatorDefault, 
-                                                                                 (CFStringRef)self, 
-                                                                                 NULL, 
-                                                                                 CFSTR("!*'();:@&=+$,/?%#[]"), 
-                                                                                 cfEncoding));
-    return [result autorelease];
+    // Avoid heap allocations for usual (short) strings
+    char stackBuffer[1024];
+    NSUInteger capacity = 3 * [self maxLengthOfBytesUsingEncoding:encoding];
+    char *buffer = (capacity <= sizeof(stackBuffer)) ? stackBuffer : malloc(capacity);
+    if (! buffer) {
+        HLSLoggerError(@"Could not allocate the buffer needed to encode the string");
+        return nil;
+    }
+    
+    NSString *result = nil;
+    NSUInteger length = urlEncodeStringIntoBuffer(self, encoding, buffer);
+    if (length != NSNotFound) {
+        result = [[[NSString alloc] initWithBytes:buffer length:length encoding:NSASCIIStringEncoding] autorelease];
+    }
+    
+    if (buffer != stackBuffer) {
+        free(buffer);
+    }
+    return result;
 }
 
 #pragma mark Hash digests
@@ -148,6 +391,28 @@ static NSString* digest(NSString *string, unsigned char *(*cc_digest)(const void
     return digest(self, CC_SHA512, CC_SHA512_DIGEST_LENGTH);
 }
 
+- (uint64_t)xxh64Value
+{
+    // Avoid creating a C string if the string already stores its characters as UTF-8
+    const char *utf8str = CFStringGetCStringPtr((CFStringRef)self, kCFStringEncodingUTF8);
+    if (! utf8str) {
+        utf8str = [self UTF8String];
+    }
+    return HLSXXH64(utf8str, strlen(utf8str), 0);
+}
+
+- (NSString *)xxh64hash
+{
+    uint64_t hash = [self xxh64Value];
+    
+    // Canonical representation (big-endian)
+    unsigned char bytes[sizeof(hash)];
+    for (NSUInteger i = 0; i < sizeof(hash); ++i) {
+        bytes[i] = (unsigned char)(hash >> (8 * (sizeof(hash) - 1 - i)));
+    }
+    return HLSHexStringFromBytes(bytes, sizeof(bytes));
+}
+
 #pragma mark Version strings
 
 - (NSString *)friendlyVersionNumber
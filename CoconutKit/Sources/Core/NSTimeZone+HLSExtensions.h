@@ -17,6 +17,11 @@
 + (NSDate *)dateByAddingTimeInterval:(NSTimeInterval)timeInterval toDate:(NSDate *)date;
 + (NSDate *)dateByAddingNumberOfDays:(NSInteger)numberOfDays toDate:(NSDate *)date;
 + (NSTimeInterval)timeIntervalBetweenDate:(NSDate *)date1 andDate:(NSDate *)date2;
++ (NSTimeInterval)offsetFromTimeZone:(NSTimeZone *)timeZone forTimeInterval:(NSTimeInterval)timeInterval;
++ (NSTimeInterval)timeIntervalWithSameComponentsAsTimeInterval:(NSTimeInterval)timeInterval fromTimeZone:(NSTimeZone *)timeZone;
++ (NSTimeInterval)timeIntervalByAddingTimeInterval:(NSTimeInterval)timeInterval toTimeInterval:(NSTimeInterval)otherTimeInterval;
++ (NSTimeInterval)timeIntervalByAddingNumberOfDays:(NSInteger)numberOfDays toTimeInterval:(NSTimeInterval)timeInterval;
++ (NSTimeInterval)timeIntervalBetweenTimeInterval:(NSTimeInterval)timeInterval1 andTimeInterval:(NSTimeInterval)timeInterval2;
 
 /**
  * Return the offset (in seconds) between the receiver and another time zone for a given date. Take into account daylight 
@@ -74,4 +79,24 @@
  */
 - (NSTimeInterval)timeIntervalBetweenDate:(NSDate *)date1 andDate:(NSDate *)date2;
 
+/**
+ * Same as -secondsFromGMTForDate: and -daylightSavingTimeOffsetForDate:, but for a date given as a time interval since 
+ * the reference date (see -[NSDate timeIntervalSinceReferenceDate])
+ *
+ * The offset transitions of each time zone between 1970 and 2100 are computed once and cached. Within this range,
+ * these methods (as well as the time interval-based methods below) do not create any object and can be used for 
+ * calculations over large ranges of dates. Outside this range, they fall back to the NSTimeZone methods
+ */
+- (NSInteger)secondsFromGMTForTimeInterval:(NSTimeInterval)timeInterval;
+- (NSTimeInterval)daylightSavingTimeOffsetForTimeInterval:(NSTimeInterval)timeInterval;
+
+/**
+ * Same as the date-based methods above, but for dates given as time intervals since the reference date
+ */
+- (NSTimeInterval)offsetFromTimeZone:(NSTimeZone *)timeZone forTimeInterval:(NSTimeInterval)timeInterval;
+- (NSTimeInterval)timeIntervalWithSameComponentsAsTimeInterval:(NSTimeInterval)timeInterval fromTimeZone:(NSTimeZone *)timeZone;
+- (NSTimeInterval)timeIntervalByAddingTimeInterval:(NSTimeInterval)timeInterval toTimeInterval:(NSTimeInterval)otherTimeInterval;
+- (NSTimeInterval)timeIntervalByAddingNumberOfDays:(NSInteger)numberOfDays toTimeInterval:(NSTimeInterval)timeInterval;
+- (NSTimeInterval)timeIntervalBetweenTimeInterval:(NSTimeInterval)timeInterval1 andTimeInterval:(NSTimeInterval)timeInterval2;
+
 @end
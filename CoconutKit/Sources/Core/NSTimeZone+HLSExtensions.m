@@ -8,6 +8,42 @@
 
 #import "NSTimeZone+HLSExtensions.h"
 
+#import <libkern/OSAtomic.h>
+
+// Range covered by transition tables (1970-01-01 00:00:00 UTC to 2100-01-01 00:00:00 UTC, as time intervals since
+// the reference date)
+static const NSTimeInterval kTransitionTableBeginTimeInterval = -978307200.;
+static const NSTimeInterval kTransitionTableEndTimeInterval = 3124137600.;
+
+// Transition tables, per time zone name. Never discarded (there is a bounded number of time zones)
+static NSMutableDictionary *s_timeZoneNameToTransitionTableMap = nil;
+static OSSpinLock s_transitionTablesLock = OS_SPINLOCK_INIT;
+
+/**
+ * Offsets of a time zone between two transitions. Immutable, can be used from any thread
+ */
+@interface HLSTimeZoneTransitionTable : NSObject {
+@private
+    NSTimeInterval *_transitionTimeIntervals;       // Offsets at index i + 1 apply from transition i on
+    NSInteger *_secondsFromGMT;
+    NSTimeInterval *_daylightSavingTimeOffsets;
+    NSUInteger _numberOfTransitions;
+}
+
+- (id)initWithTimeZone:(NSTimeZone *)timeZone;
+
+- (NSUInteger)offsetIndexForTimeInterval:(NSTimeInterval)timeInterval;
+- (NSInteger)secondsFromGMTAtIndex:(NSUInteger)index;
+- (NSTimeInterval)daylightSavingTimeOffsetAtIndex:(NSUInteger)index;
+
+@end
+
+@interface NSTimeZone (HLSExtensionsPrivate)
+
+- (HLSTimeZoneTransitionTable *)cachedTransitionTable;
+
+@end
+
 @implementation NSTimeZone (HLSExtensions)
 
 #pragma mark Class methods
@@ -37,32 +73,50 @@
     return [[NSTimeZone systemTimeZone] timeIntervalBetweenDate:date1 andDate:date2];
 }
 
++ (NSTimeInterval)offsetFromTimeZone:(NSTimeZone *)timeZone forTimeInterval:(NSTimeInterval)timeInterval
+{
+    return [[NSTimeZone systemTimeZone] offsetFromTimeZone:timeZone forTimeInterval:timeInterval];
+}
+
++ (NSTimeInterval)timeIntervalWithSameComponentsAsTimeInterval:(NSTimeInterval)timeInterval fromTimeZone:(NSTimeZone *)timeZone
+{
+    return [[NSTimeZone systemTimeZone] timeIntervalWithSameComponentsAsTimeInterval:timeInterval fromTimeZone:timeZone];
+}
+
++ (NSTimeInterval)timeIntervalByAddingTimeInterval:(NSTimeInterval)timeInterval toTimeInterval:(NSTimeInterval)otherTimeInterval
+{
+    return [[NSTimeZone systemTimeZone] timeIntervalByAddingTimeInterval:timeInterval toTimeInterval:otherTimeInterval];
+}
+
++ (NSTimeInterval)timeIntervalByAddingNumberOfDays:(NSInteger)numberOfDays toTimeInterval:(NSTimeInterval)timeInterval
+{
+    return [[NSTimeZone systemTimeZone] timeIntervalByAddingNumberOfDays:numberOfDays toTimeInterval:timeInterval];
+}
+
++ (NSTimeInterval)timeIntervalBetweenTimeInterval:(NSTimeInterval)timeInterval1 andTimeInterval:(NSTimeInterval)timeInterval2
+{
+    return [[NSTimeZone systemTimeZone] timeIntervalBetweenTimeInterval:timeInterval1 andTimeInterval:timeInterval2];
+}
+
 #pragma mark Time zone calculations
 
 - (NSTimeInterval)offsetFromTimeZone:(NSTimeZone *)timeZone forDate:(NSDate *)date
 {
-    return [self secondsFromGMTForDate:date] - [timeZone secondsFromGMTForDate:date];
+    return [self offsetFromTimeZone:timeZone forTimeInterval:[date timeIntervalSinceReferenceDate]];
 }
 
 - (NSDate *)dateWithSameComponentsAsDate:(NSDate *)date fromTimeZone:(NSTimeZone *)timeZone
 {
-    NSTimeInterval timeZoneOffset = [timeZone offsetFromTimeZone:self forDate:date];
-    NSDate *dateInSelf = [date dateByAddingTimeInterval:timeZoneOffset];
-    
-    // If we crossed the DST transition, we must compensante its effect
-    NSTimeInterval dstTransitionCorrection = [self daylightSavingTimeOffsetForDate:date]
-        - [self daylightSavingTimeOffsetForDate:dateInSelf];
-    return [dateInSelf dateByAddingTimeInterval:dstTransitionCorrection];
+    NSTimeInterval timeInterval = [self timeIntervalWithSameComponentsAsTimeInterval:[date timeIntervalSinceReferenceDate] 
+                                                                        fromTimeZone:timeZone];
+    return [NSDate dateWithTimeIntervalSinceReferenceDate:timeInterval];
 }
 
 - (NSDate *)dateByAddingTimeInterval:(NSTimeInterval)timeInterval toDate:(NSDate *)date
 {
-    NSDate *resultDate = [date dateByAddingTimeInterval:timeInterval];
-    
-    // If we crossed the DST transition, we must compensante its effect
-    NSTimeInterval dstTransitionCorrection = [self daylightSavingTimeOffsetForDate:date]
-        - [self daylightSavingTimeOffsetForDate:resultDate];
-    return [resultDate dateByAddingTimeInterval:dstTransitionCorrection];
+    NSTimeInterval resultTimeInterval = [self timeIntervalByAddingTimeInterval:timeInterval 
+                                                                toTimeInterval:[date timeIntervalSinceReferenceDate]];
+    return [NSDate dateWithTimeIntervalSinceReferenceDate:resultTimeInterval];
 }
 
 - (NSDate *)dateByAddingNumberOfDays:(NSInteger)numberOfDays toDate:(NSDate *)date
@@ -72,12 +126,186 @@
 
 - (NSTimeInterval)timeIntervalBetweenDate:(NSDate *)date1 andDate:(NSDate *)date2
 {
-    NSTimeInterval timeInterval = [date1 timeIntervalSinceDate:date2];
+    return [self timeIntervalBetweenTimeInterval:[date1 timeIntervalSinceReferenceDate] 
+                                 andTimeInterval:[date2 timeIntervalSinceReferenceDate]];
+}
+
+- (NSInteger)secondsFromGMTForTimeInterval:(NSTimeInterval)timeInterval
+{
+    if (timeInterval < kTransitionTableBeginTimeInterval || timeInterval >= kTransitionTableEndTimeInterval) {
+        return [self secondsFromGMTForDate:[NSDate dateWithTimeIntervalSinceReferenceDate:timeInterval]];
+    }
+    
+    HLSTimeZoneTransitionTable *transitionTable = [self cachedTransitionTable];
+    return [transitionTable secondsFromGMTAtIndex:[transitionTable offsetIndexForTimeInterval:timeInterval]];
+}
+
+- (NSTimeInterval)daylightSavingTimeOffsetForTimeInterval:(NSTimeInterval)timeInterval
+{
+    if (timeInterval < kTransitionTableBeginTimeInterval || timeInterval >= kTransitionTableEndTimeInterval) {
+        return [self daylightSavingTimeOffsetForDate:[NSDate dateWithTimeIntervalSinceReferenceDate:timeInterval]];
+    }
+    
+    HLSTimeZoneTransitionTable *transitionTable = [self cachedTransitionTable];
+    return [transitionTable daylightSavingTimeOffsetAtIndex:[transitionTable offsetIndexForTimeInterval:timeInterval]];
+}
+
+- (NSTimeInterval)offsetFromTimeZone:(NSTimeZone *)timeZone forTimeInterval:(NSTimeInterval)timeInterval
+{
+    return [self secondsFromGMTForTimeInterval:timeInterval] - [timeZone secondsFromGMTForTimeInterval:timeInterval];
+}
+
+- (NSTimeInterval)timeIntervalWithSameComponentsAsTimeInterval:(NSTimeInterval)timeInterval fromTimeZone:(NSTimeZone *)timeZone
+{
+    NSTimeInterval timeZoneOffset = [timeZone offsetFromTimeZone:self forTimeInterval:timeInterval];
+    NSTimeInterval timeIntervalInSelf = timeInterval + timeZoneOffset;
     
     // If we crossed the DST transition, we must compensante its effect
-    NSTimeInterval dstTransitionCorrection = [self daylightSavingTimeOffsetForDate:date1]
-        - [self daylightSavingTimeOffsetForDate:date2];
+    NSTimeInterval dstTransitionCorrection = [self daylightSavingTimeOffsetForTimeInterval:timeInterval]
+        - [self daylightSavingTimeOffsetForTimeInterval:timeIntervalInSelf];
+    return timeIntervalInSelf + dstTransitionCorrection;
+}
+
+- (NSTimeInterval)timeIntervalByAddingTimeInterval:(NSTimeInterval)timeInterval toTimeInterval:(NSTimeInterval)otherTimeInterval
+{
+    NSTimeInterval resultTimeInterval = otherTimeInterval + timeInterval;
+    
+    // If we crossed the DST transition, we must compensante its effect
+    NSTimeInterval dstTransitionCorrection = [self daylightSavingTimeOffsetForTimeInterval:otherTimeInterval]
+        - [self daylightSavingTimeOffsetForTimeInterval:resultTimeInterval];
+    return resultTimeInterval + dstTransitionCorrection;
+}
+
+- (NSTimeInterval)timeIntervalByAddingNumberOfDays:(NSInteger)numberOfDays toTimeInterval:(NSTimeInterval)timeInterval
+{
+    return [self timeIntervalByAddingTimeInterval:24. * 60. * 60. * numberOfDays toTimeInterval:timeInterval];
+}
+
+- (NSTimeInterval)timeIntervalBetweenTimeInterval:(NSTimeInterval)timeInterval1 andTimeInterval:(NSTimeInterval)timeInterval2
+{
+    NSTimeInterval timeInterval = timeInterval1 - timeInterval2;
+    
+    // If we crossed the DST transition, we must compensante its effect
+    NSTimeInterval dstTransitionCorrection = [self daylightSavingTimeOffsetForTimeInterval:timeInterval1]
+        - [self daylightSavingTimeOffsetForTimeInterval:timeInterval2];
     return timeInterval + dstTransitionCorrection;
 }
 
 @end
+
+@implementation NSTimeZone (HLSExtensionsPrivate)
+
+- (HLSTimeZoneTransitionTable *)cachedTransitionTable
+{
+    NSString *name = [self name];
+    
+    OSSpinLockLock(&s_transitionTablesLock);
+    HLSTimeZoneTransitionTable *transitionTable = [s_timeZoneNameToTransitionTableMap objectForKey:name];
+    OSSpinLockUnlock(&s_transitionTablesLock);
+    if (transitionTable) {
+        return transitionTable;
+    }
+    
+    // Not computed while holding the lock. If two threads compute the same table, the first one inserted wins
+    HLSTimeZoneTransitionTable *newTransitionTable = [[[HLSTimeZoneTransitionTable alloc] initWithTimeZone:self] autorelease];
+    
+    OSSpinLockLock(&s_transitionTablesLock);
+    if (! s_timeZoneNameToTransitionTableMap) {
+        s_timeZoneNameToTransitionTableMap = [[NSMutableDictionary alloc] init];
+    }
+    transitionTable = [s_timeZoneNameToTransitionTableMap objectForKey:name];
+    if (! transitionTable) {
+        [s_timeZoneNameToTransitionTableMap setObject:newTransitionTable forKey:name];
+        transitionTable = newTransitionTable;
+    }
+    OSSpinLockUnlock(&s_transitionTablesLock);
+    
+    return transitionTable;
+}
+
+@end
+
+@implementation HLSTimeZoneTransitionTable
+
+#pragma mark Object creation and destruction
+
+- (id)initWithTimeZone:(NSTimeZone *)timeZone
+{
+    if ((self = [super init])) {
+        NSUInteger capacity = 256;
+        _transitionTimeIntervals = (NSTimeInterval *)malloc(capacity * sizeof(NSTimeInterval));
+        _secondsFromGMT = (NSInteger *)malloc((capacity + 1) * sizeof(NSInteger));
+        _daylightSavingTimeOffsets = (NSTimeInterval *)malloc((capacity + 1) * sizeof(NSTimeInterval));
+        
+        NSDate *date = [NSDate dateWithTimeIntervalSinceReferenceDate:kTransitionTableBeginTimeInterval];
+        _secondsFromGMT[0] = [timeZone secondsFromGMTForDate:date];
+        _daylightSavingTimeOffsets[0] = [timeZone daylightSavingTimeOffsetForDate:date];
+        
+        NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+        while ((date = [timeZone nextDaylightSavingTimeTransitionAfterDate:date])) {
+            NSTimeInterval transitionTimeInterval = [date timeIntervalSinceReferenceDate];
+            if (transitionTimeInterval >= kTransitionTableEndTimeInterval) {
+                break;
+            }
+            
+            if (_numberOfTransitions == capacity) {
+                capacity *= 2;
+                _transitionTimeIntervals = (NSTimeInterval *)realloc(_transitionTimeIntervals, capacity * sizeof(NSTimeInterval));
+                _secondsFromGMT = (NSInteger *)realloc(_secondsFromGMT, (capacity + 1) * sizeof(NSInteger));
+                _daylightSavingTimeOffsets = (NSTimeInterval *)realloc(_daylightSavingTimeOffsets, (capacity + 1) * sizeof(NSTimeInterval));
+            }
+            
+            _transitionTimeIntervals[_numberOfTransitions] = transitionTimeInterval;
+            _secondsFromGMT[_numberOfTransitions + 1] = [timeZone secondsFromGMTForDate:date];
+            _daylightSavingTimeOffsets[_numberOfTransitions + 1] = [timeZone daylightSavingTimeOffsetForDate:date];
+            ++_numberOfTransitions;
+        }
+        [pool drain];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    free(_transitionTimeIntervals);
+    _transitionTimeIntervals = NULL;
+    
+    free(_secondsFromGMT);
+    _secondsFromGMT = NULL;
+    
+    free(_daylightSavingTimeOffsets);
+    _daylightSavingTimeOffsets = NULL;
+    
+    [super dealloc];
+}
+
+#pragma mark Offsets
+
+// Binary search
+- (NSUInteger)offsetIndexForTimeInterval:(NSTimeInterval)timeInterval
+{
+    NSUInteger low = 0;
+    NSUInteger high = _numberOfTransitions;
+    while (low < high) {
+        NSUInteger middle = (low + high) / 2;
+        if (_transitionTimeIntervals[middle] <= timeInterval) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+- (NSInteger)secondsFromGMTAtIndex:(NSUInteger)index
+{
+    return _secondsFromGMT[index];
+}
+
+- (NSTimeInterval)daylightSavingTimeOffsetAtIndex:(NSUInteger)index
+{
+    return _daylightSavingTimeOffsets[index];
+}
+
+@end
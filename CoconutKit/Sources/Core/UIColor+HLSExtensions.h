@@ -6,6 +6,26 @@
 //  Copyright 2011 Hortis. All rights reserved.
 //
 
+/**
+ * Normalized RGBA color components (0.f - 1.f)
+ */
+typedef struct {
+    CGFloat red;
+    CGFloat green;
+    CGFloat blue;
+    CGFloat alpha;
+} HLSColorRGBA;
+
+/**
+ * Create RGBA components
+ */
+HLSColorRGBA HLSColorRGBAMake(CGFloat red, CGFloat green, CGFloat blue, CGFloat alpha);
+
+/**
+ * Return the components of the inverted color (the alpha is preserved)
+ */
+HLSColorRGBA HLSColorRGBAInverted(HLSColorRGBA rgba);
+
 @interface UIColor (HLSExtensions)
 
 /**
@@ -13,6 +33,31 @@
  */
 + (UIColor *)randomColor;
 
+/**
+ * Return the color with the given components
+ */
++ (UIColor *)colorWithRGBA:(HLSColorRGBA)rgba;
+
+/**
+ * Bulk conversions for palettes of colors. The first method fills rgbaValues (which must be able to hold as many
+ * values as there are colors) and returns NO if some color could not be converted (its components are then set to 0).
+ * The second one returns an array of colors
+ */
++ (BOOL)getRGBA:(HLSColorRGBA *)rgbaValues ofColors:(NSArray *)colors;
++ (NSArray *)colorsWithRGBA:(const HLSColorRGBA *)rgbaValues count:(NSUInteger)count;
+
+/**
+ * Extract the RGBA components of the receiver, converting them from its color space if needed. Return NO if the 
+ * color cannot be expressed in RGBA (e.g. pattern colors). If you need several components, or the same components 
+ * several times, call this method once and store the result, since extraction might be expensive
+ */
+- (BOOL)getRGBA:(HLSColorRGBA *)pRGBA;
+
+/**
+ * Same as -getRGBA:, but returns the components directly (all 0 if the color cannot be expressed in RGBA)
+ */
+- (HLSColorRGBA)rgba;
+
 /**
  * Return the ivert color corresponding to the receiver
  */
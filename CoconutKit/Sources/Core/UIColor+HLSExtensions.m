@@ -8,8 +8,30 @@
 
 #import "UIColor+HLSExtensions.h"
 
+#import "HLSLogger.h"
+
+// Function declarations
+static BOOL convertColorToRGBA(CGColorRef colorRef, HLSColorRGBA *pRGBA);
+
+HLSColorRGBA HLSColorRGBAMake(CGFloat red, CGFloat green, CGFloat blue, CGFloat alpha)
+{
+    HLSColorRGBA rgba;
+    rgba.red = red;
+    rgba.green = green;
+    rgba.blue = blue;
+    rgba.alpha = alpha;
+    return rgba;
+}
+
+HLSColorRGBA HLSColorRGBAInverted(HLSColorRGBA rgba)
+{
+    return HLSColorRGBAMake(1.f - rgba.red, 1.f - rgba.green, 1.f - rgba.blue, rgba.alpha);
+}
+
 @implementation UIColor (HLSExtensions)
 
+#pragma mark Class methods
+
 + (UIColor *)randomColor
 {
     return [UIColor colorWithRed:(arc4random() % 256) / 255.f
@@ -18,16 +40,79 @@
                            alpha:1.f];
 }
 
-- (UIColor *)invertedColor
++ (UIColor *)colorWithRGBA:(HLSColorRGBA)rgba
+{
+    return [UIColor colorWithRed:rgba.red green:rgba.green blue:rgba.blue alpha:rgba.alpha];
+}
+
++ (BOOL)getRGBA:(HLSColorRGBA *)rgbaValues ofColors:(NSArray *)colors
 {
-    const CGFloat *components = CGColorGetComponents(self.CGColor);
+    NSParameterAssert(rgbaValues || [colors count] == 0);
     
-    UIColor *invertedColor = [[[UIColor alloc] initWithRed:1.f - components[0]
-                                                   green:1.f - components[1]
-                                                    blue:1.f - components[2]
-                                                   alpha:components[3]] autorelease];
+    BOOL success = YES;
+    NSUInteger i = 0;
+    for (UIColor *color in colors) {
+        if (! [color getRGBA:&rgbaValues[i]]) {
+            success = NO;
+        }
+        ++i;
+    }
+    return success;
+}
+
++ (NSArray *)colorsWithRGBA:(const HLSColorRGBA *)rgbaValues count:(NSUInteger)count
+{
+    NSMutableArray *colors = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; ++i) {
+        [colors addObject:[UIColor colorWithRGBA:rgbaValues[i]]];
+    }
+    return [NSArray arrayWithArray:colors];
+}
+
+#pragma mark Components
+
+- (BOOL)getRGBA:(HLSColorRGBA *)pRGBA
+{
+    NSParameterAssert(pRGBA);
     
-    return invertedColor;
+    CGColorRef colorRef = self.CGColor;
+    const CGFloat *components = CGColorGetComponents(colorRef);
+    switch (CGColorSpaceGetModel(CGColorGetColorSpace(colorRef))) {
+        case kCGColorSpaceModelMonochrome: {
+            *pRGBA = HLSColorRGBAMake(components[0], components[0], components[0], components[1]);
+            return YES;
+            break;
+        }
+            
+        case kCGColorSpaceModelRGB: {
+            *pRGBA = HLSColorRGBAMake(components[0], components[1], components[2], components[3]);
+            return YES;
+            break;
+        }
+            
+        default: {
+            if (convertColorToRGBA(colorRef, pRGBA)) {
+                return YES;
+            }
+            
+            HLSLoggerWarn(@"The color %@ cannot be expressed in RGBA", self);
+            *pRGBA = HLSColorRGBAMake(0.f, 0.f, 0.f, 0.f);
+            return NO;
+            break;
+        }
+    }
+}
+
+- (HLSColorRGBA)rgba
+{
+    HLSColorRGBA rgba;
+    [self getRGBA:&rgba];
+    return rgba;
+}
+
+- (UIColor *)invertedColor
+{
+    return [UIColor colorWithRGBA:HLSColorRGBAInverted([self rgba])];
 }
 
 #pragma mark Color components
@@ -49,20 +134,51 @@
 
 - (CGFloat)normalizedRedComponent
 {
-    const CGFloat *components = CGColorGetComponents(self.CGColor);
-    return components[0];
+    return [self rgba].red;
 }
 
 - (CGFloat)normalizedGreenComponent
 {
-    const CGFloat *components = CGColorGetComponents(self.CGColor);
-    return components[1];
+    return [self rgba].green;
 }
 
 - (CGFloat)normalizedBlueComponent
 {
-    const CGFloat *components = CGColorGetComponents(self.CGColor);
-    return components[2];
+    return [self rgba].blue;
 }
 
 @end
+
+#pragma mark Static functions
+
+/**
+ * Convert a color from an arbitrary (non-pattern) color space by drawing it into a 1x1 RGBA bitmap
+ */
+static BOOL convertColorToRGBA(CGColorRef colorRef, HLSColorRGBA *pRGBA)
+{
+    if (CGColorSpaceGetModel(CGColorGetColorSpace(colorRef)) == kCGColorSpaceModelPattern) {
+        return NO;
+    }
+    
+    unsigned char pixel[4] = { 0, 0, 0, 0 };
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    CGContextRef context = CGBitmapContextCreate(pixel, 1, 1, 8, 4, colorSpace, kCGImageAlphaPremultipliedLast);
+    CGColorSpaceRelease(colorSpace);
+    if (! context) {
+        return NO;
+    }
+    
+    CGContextSetFillColorWithColor(context, colorRef);
+    CGContextFillRect(context, CGRectMake(0.f, 0.f, 1.f, 1.f));
+    CGContextRelease(context);
+    
+    // Undo alpha premultiplication
+    CGFloat alpha = pixel[3] / 255.f;
+    if (pixel[3] == 0) {
+        *pRGBA = HLSColorRGBAMake(0.f, 0.f, 0.f, 0.f);
+    }
+    else {
+        *pRGBA = HLSColorRGBAMake(pixel[0] / 255.f / alpha, pixel[1] / 255.f / alpha, pixel[2] / 255.f / alpha, alpha);
+    }
+    return YES;
+}
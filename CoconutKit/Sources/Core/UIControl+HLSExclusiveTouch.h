@@ -8,6 +8,9 @@
 
 /**
  * Globally set exclusive touch to YES for all UIControl objects, preventing quasi-simultaneous taps.
+ *
+ * Exclusive touch is set once when a control is created (from code or from a nib), and touch delivery is left
+ * untouched. Controls can still disable exclusive touch individually after they have been created
  */
 @interface UIControl (HLSExclusiveTouch)
 
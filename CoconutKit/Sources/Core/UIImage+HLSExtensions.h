@@ -9,19 +9,106 @@
 @interface UIImage (HLSExtensions)
 
 /**
- * Return a 1x1 px image having a given color
+ * Return a 1x1 px image having a given color. Images are cached by RGBA value (8 bits per component), so that
+ * repeated calls for the same color return the same instance. Can be called from any thread
  */
 + (UIImage *)imageWithColor:(UIColor *)color;
 
+/**
+ * Load the image stored in a file, downsampled (with ImageIO) so that its largest dimension does not exceed 
+ * maximumPixelSize. The image is decoded directly at this size, which is much faster and requires far less memory
+ * than loading the full-size image and scaling it afterwards. Images smaller than maximumPixelSize are not upscaled.
+ * The orientation stored in the image metadata is applied, and the returned image has the specified scale. Return
+ * nil if the image could not be loaded. Can be called from any thread
+ */
++ (UIImage *)imageWithContentsOfFile:(NSString *)filePath maximumPixelSize:(NSUInteger)maximumPixelSize scale:(CGFloat)scale;
+
+/**
+ * Same as +imageWithContentsOfFile:maximumPixelSize:scale:, but for image data already in memory (e.g. mapped or 
+ * downloaded). Can be called from any thread
+ */
++ (UIImage *)imageWithData:(NSData *)data maximumPixelSize:(NSUInteger)maximumPixelSize scale:(CGFloat)scale;
+
+/**
+ * Return the dimensions (in pixels, orientation applied) of the image stored in a file, without decoding it. Return
+ * CGSizeZero if the file could not be read. Can be called from any thread
+ */
++ (CGSize)pixelSizeOfImageWithContentsOfFile:(NSString *)filePath;
+
+/**
+ * Same as +pixelSizeOfImageWithContentsOfFile:, but for image data already in memory. Can be called from any thread
+ */
++ (CGSize)pixelSizeOfImageWithData:(NSData *)data;
+
 /**
  * Return the receiver masked with some image. Black mask pixels correspond to unmasked portions. To make parts of
- * the mask transparent, use pixels between black (opaque) and white (transparent), not an alpha
+ * the mask transparent, use pixels between black (opaque) and white (transparent), not an alpha. The mask is applied
+ * to the underlying pixels, the scale and orientation of the receiver are preserved. Masking is only performed
+ * when the image is drawn, call -decodedImage on the result to perform it once and for all. Can be called from 
+ * any thread
  */
 - (UIImage *)imageMaskedWithImage:(UIImage *)maskImage;
 
 /**
- * Return the image scaled to fill the specified size. The image will be stretched as needed
+ * Same as -imageScaledToSize:opaque:scale:interpolationQuality:, with a transparent background, the scale of the 
+ * receiver and the default interpolation quality
  */
 - (UIImage *)imageScaledToSize:(CGSize)size;
 
+/**
+ * Return the image scaled to fill the specified size (in points). The image will be stretched as needed. The 
+ * orientation of the receiver is applied, the returned image is therefore always UIImageOrientationUp. Set opaque 
+ * to YES if the image has no transparent parts (the result requires less memory and is faster to draw). If scale 
+ * is 0, the scale of the receiver is used. Only Core Graphics is used, this method can therefore be called from 
+ * any thread. If you want to scale down an image loaded from a file, +imageWithContentsOfFile:maximumPixelSize:scale: 
+ * is more efficient
+ */
+- (UIImage *)imageScaledToSize:(CGSize)size 
+                        opaque:(BOOL)opaque 
+                         scale:(CGFloat)scale 
+          interpolationQuality:(CGInterpolationQuality)interpolationQuality;
+
+/**
+ * Return a copy of the receiver whose pixels have been decompressed. Images loaded from files are usually decoded
+ * lazily when they are first drawn, which can cause stuttering if this happens during an animation. This method
+ * only uses Core Graphics and can therefore be called from any thread
+ */
+- (UIImage *)decodedImage;
+
+@end
+
+/**
+ * Asynchronous variants of the methods above. Images are processed on a queue shared by all images, which runs
+ * a few operations concurrently. If you need more control (priorities, cancellation, progress), call the
+ * synchronous methods from the tasks you submit to an HLSTaskManager instead, since they can be called from
+ * any thread.
+ *
+ * Once an image has been processed, the completion action is called on the main thread. It must have the signature
+ *   - (void)methodName:(UIImage *)image
+ * where image is the resulting image (nil if it could not be created). The receiver and the target are retained 
+ * until the action has been called
+ */
+@interface UIImage (HLSAsynchronousProcessing)
+
+/**
+ * Asynchronously scale the receiver (see -imageScaledToSize:opaque:scale:interpolationQuality:)
+ */
+- (void)scaleToSize:(CGSize)size 
+             opaque:(BOOL)opaque 
+              scale:(CGFloat)scale 
+interpolationQuality:(CGInterpolationQuality)interpolationQuality
+   completionTarget:(id)target 
+             action:(SEL)action;
+
+/**
+ * Asynchronously mask the receiver (see -imageMaskedWithImage:). The resulting image is decoded, so that the masking
+ * cost is not paid again when drawing it
+ */
+- (void)maskWithImage:(UIImage *)maskImage completionTarget:(id)target action:(SEL)action;
+
+/**
+ * Asynchronously decode the receiver (see -decodedImage)
+ */
+- (void)decodeWithCompletionTarget:(id)target action:(SEL)action;
+
 @end
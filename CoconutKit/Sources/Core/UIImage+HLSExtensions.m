@@ -8,24 +8,153 @@
 
 #import "UIImage+HLSExtensions.h"
 
+#import "HLSFloat.h"
+#import "HLSLogger.h"
+
+#import <ImageIO/ImageIO.h>
+
+static const NSInteger kImageProcessingMaxConcurrentOperationCount = 2;
+
+// Function declarations
+static BOOL packedRGBAValueForColor(UIColor *color, uint32_t *pValue);
+static NSCache *colorImageCache(void);
+static NSOperationQueue *imageProcessingQueue(void);
+static UIImage *imageFromImageSource(CGImageSourceRef imageSource, NSUInteger maximumPixelSize, CGFloat scale);
+static CGSize pixelSizeOfImageSource(CGImageSourceRef imageSource);
+
+/**
+ * Operation calling an image processing method, and notifying the result on the main thread
+ */
+@interface HLSImageProcessingOperation : NSOperation {
+@private
+    NSInvocation *_invocation;
+    BOOL _decodingResult;
+    id _target;
+    SEL _action;
+    UIImage *_image;
+}
+
+- (id)initWithInvocation:(NSInvocation *)invocation decodingResult:(BOOL)decodingResult completionTarget:(id)target action:(SEL)action;
+
+@end
+
+@interface UIImage (HLSAsynchronousProcessingPrivate)
+
+- (void)processWithInvocation:(NSInvocation *)invocation decodingResult:(BOOL)decodingResult completionTarget:(id)target action:(SEL)action;
+
+@end
+
 @implementation UIImage (HLSExtensions)
 
 + (UIImage *)imageWithColor:(UIColor *)color
 {
+    // Colors which cannot be expressed as RGBA (e.g. pattern colors) are not cached
+    uint32_t packedRGBAValue = 0;
+    BOOL cacheable = packedRGBAValueForColor(color, &packedRGBAValue);
+    NSNumber *key = nil;
+    if (cacheable) {
+        key = [NSNumber numberWithUnsignedInt:packedRGBAValue];
+        UIImage *cachedImage = [colorImageCache() objectForKey:key];
+        if (cachedImage) {
+            return cachedImage;
+        }
+    }
+    
     CGRect rect = CGRectMake(0.0f, 0.0f, 1.0f, 1.0f);
     
-    UIGraphicsBeginImageContext(rect.size);
+    // Do not use UIKit image contexts, so that the method can be called from any thread
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    CGContextRef context = CGBitmapContextCreate(NULL, 
+                                                 1, 
+                                                 1, 
+                                                 8, 
+                                                 0, 
+                                                 colorSpace, 
+                                                 kCGBitmapByteOrder32Little | kCGImageAlphaPremultipliedFirst);
+    CGColorSpaceRelease(colorSpace);
+    if (! context) {
+        return nil;
+    }
     
-    CGContextRef context = UIGraphicsGetCurrentContext();
     CGContextSetFillColorWithColor(context, color.CGColor);
     CGContextFillRect(context, rect);
     
-    UIImage *image = UIGraphicsGetImageFromCurrentImageContext();
+    CGImageRef imageRef = CGBitmapContextCreateImage(context);
+    CGContextRelease(context);
     
-    UIGraphicsEndImageContext();
+    UIImage *image = [UIImage imageWithCGImage:imageRef];
+    CGImageRelease(imageRef);
+    
+    if (cacheable) {
+        [colorImageCache() setObject:image forKey:key];
+    }
     return image;
 }
 
++ (UIImage *)imageWithContentsOfFile:(NSString *)filePath maximumPixelSize:(NSUInteger)maximumPixelSize scale:(CGFloat)scale
+{
+    if (! filePath) {
+        return nil;
+    }
+    
+    CGImageSourceRef imageSource = CGImageSourceCreateWithURL((CFURLRef)[NSURL fileURLWithPath:filePath], NULL);
+    if (! imageSource) {
+        return nil;
+    }
+    
+    UIImage *image = imageFromImageSource(imageSource, maximumPixelSize, scale);
+    CFRelease(imageSource);
+    return image;
+}
+
++ (UIImage *)imageWithData:(NSData *)data maximumPixelSize:(NSUInteger)maximumPixelSize scale:(CGFloat)scale
+{
+    if (! data) {
+        return nil;
+    }
+    
+    CGImageSourceRef imageSource = CGImageSourceCreateWithData((CFDataRef)data, NULL);
+    if (! imageSource) {
+        return nil;
+    }
+    
+    UIImage *image = imageFromImageSource(imageSource, maximumPixelSize, scale);
+    CFRelease(imageSource);
+    return image;
+}
+
++ (CGSize)pixelSizeOfImageWithContentsOfFile:(NSString *)filePath
+{
+    if (! filePath) {
+        return CGSizeZero;
+    }
+    
+    CGImageSourceRef imageSource = CGImageSourceCreateWithURL((CFURLRef)[NSURL fileURLWithPath:filePath], NULL);
+    if (! imageSource) {
+        return CGSizeZero;
+    }
+    
+    CGSize pixelSize = pixelSizeOfImageSource(imageSource);
+    CFRelease(imageSource);
+    return pixelSize;
+}
+
++ (CGSize)pixelSizeOfImageWithData:(NSData *)data
+{
+    if (! data) {
+        return CGSizeZero;
+    }
+    
+    CGImageSourceRef imageSource = CGImageSourceCreateWithData((CFDataRef)data, NULL);
+    if (! imageSource) {
+        return CGSizeZero;
+    }
+    
+    CGSize pixelSize = pixelSizeOfImageSource(imageSource);
+    CFRelease(imageSource);
+    return pixelSize;
+}
+
 - (UIImage *)imageMaskedWithImage:(UIImage *)maskImage
 {
 	CGImageRef maskImageRef = CGImageMaskCreate(CGImageGetWidth(maskImage.CGImage),
@@ -40,7 +169,7 @@
 	CGImageRef maskedImageRef = CGImageCreateWithMask(self.CGImage, maskImageRef);
     CGImageRelease(maskImageRef);
     
-	UIImage *maskedImage = [UIImage imageWithCGImage:maskedImageRef];
+	UIImage *maskedImage = [UIImage imageWithCGImage:maskedImageRef scale:self.scale orientation:self.imageOrientation];
     CGImageRelease(maskedImageRef);
     
     return maskedImage;
@@ -48,11 +177,357 @@
 
 - (UIImage *)imageScaledToSize:(CGSize)size
 {
-    UIGraphicsBeginImageContext(size);
-    [self drawInRect:CGRectMake(0.f, 0.f, size.width, size.height)];
-    UIImage *image = UIGraphicsGetImageFromCurrentImageContext();
-    UIGraphicsEndImageContext();
-    return image;
+    return [self imageScaledToSize:size opaque:NO scale:0.f interpolationQuality:kCGInterpolationDefault];
+}
+
+- (UIImage *)imageScaledToSize:(CGSize)size 
+                        opaque:(BOOL)opaque 
+                         scale:(CGFloat)scale 
+          interpolationQuality:(CGInterpolationQuality)interpolationQuality
+{
+    CGImageRef imageRef = self.CGImage;
+    if (! imageRef) {
+        return nil;
+    }
+    
+    if (floatle(scale, 0.f)) {
+        scale = self.scale;
+    }
+    
+    size_t width = (size_t)roundf(size.width * scale);
+    size_t height = (size_t)roundf(size.height * scale);
+    if (width == 0 || height == 0) {
+        HLSLoggerError(@"Cannot scale an image to an empty size");
+        return nil;
+    }
+    
+    // Same format as -decodedImage, so that the result can be rendered directly
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    CGContextRef context = CGBitmapContextCreate(NULL, 
+                                                 width, 
+                                                 height, 
+                                                 8, 
+                                                 0, 
+                                                 colorSpace, 
+                                                 kCGBitmapByteOrder32Little | (opaque ? kCGImageAlphaNoneSkipFirst : kCGImageAlphaPremultipliedFirst));
+    CGColorSpaceRelease(colorSpace);
+    if (! context) {
+        return nil;
+    }
+    
+    CGContextSetInterpolationQuality(context, interpolationQuality);
+    
+    // Apply the orientation (the Core Graphics coordinate system has its origin at the bottom left)
+    BOOL transposed = NO;
+    switch (self.imageOrientation) {
+        case UIImageOrientationDown:
+        case UIImageOrientationDownMirrored: {
+            CGContextTranslateCTM(context, width, height);
+            CGContextRotateCTM(context, M_PI);
+            break;
+        }
+            
+        case UIImageOrientationLeft:
+        case UIImageOrientationLeftMirrored: {
+            CGContextTranslateCTM(context, width, 0.f);
+            CGContextRotateCTM(context, M_PI_2);
+            transposed = YES;
+            break;
+        }
+            
+        case UIImageOrientationRight:
+        case UIImageOrientationRightMirrored: {
+            CGContextTranslateCTM(context, 0.f, height);
+            CGContextRotateCTM(context, -M_PI_2);
+            transposed = YES;
+            break;
+        }
+            
+        default: {
+            break;
+        }
+    }
+    
+    switch (self.imageOrientation) {
+        case UIImageOrientationUpMirrored:
+        case UIImageOrientationDownMirrored: {
+            CGContextTranslateCTM(context, width, 0.f);
+            CGContextScaleCTM(context, -1.f, 1.f);
+            break;
+        }
+            
+        case UIImageOrientationLeftMirrored:
+        case UIImageOrientationRightMirrored: {
+            CGContextTranslateCTM(context, height, 0.f);
+            CGContextScaleCTM(context, -1.f, 1.f);
+            break;
+        }
+            
+        default: {
+            break;
+        }
+    }
+    
+    CGRect drawRect = transposed ? CGRectMake(0.f, 0.f, height, width) : CGRectMake(0.f, 0.f, width, height);
+    CGContextDrawImage(context, drawRect, imageRef);
+    CGImageRef scaledImageRef = CGBitmapContextCreateImage(context);
+    CGContextRelease(context);
+    
+    UIImage *scaledImage = [UIImage imageWithCGImage:scaledImageRef scale:scale orientation:UIImageOrientationUp];
+    CGImageRelease(scaledImageRef);
+    return scaledImage;
+}
+
+- (UIImage *)decodedImage
+{
+    CGImageRef imageRef = self.CGImage;
+    if (! imageRef) {
+        return self;
+    }
+    
+    size_t width = CGImageGetWidth(imageRef);
+    size_t height = CGImageGetHeight(imageRef);
+    
+    // Use the format Core Animation can render directly
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    CGImageAlphaInfo alphaInfo = CGImageGetAlphaInfo(imageRef);
+    BOOL hasAlpha = (alphaInfo != kCGImageAlphaNone && alphaInfo != kCGImageAlphaNoneSkipFirst && alphaInfo != kCGImageAlphaNoneSkipLast);
+    CGContextRef context = CGBitmapContextCreate(NULL, 
+                                                 width, 
+                                                 height, 
+                                                 8, 
+                                                 0, 
+                                                 colorSpace, 
+                                                 kCGBitmapByteOrder32Little | (hasAlpha ? kCGImageAlphaPremultipliedFirst : kCGImageAlphaNoneSkipFirst));
+    CGColorSpaceRelease(colorSpace);
+    if (! context) {
+        return self;
+    }
+    
+    CGContextDrawImage(context, CGRectMake(0.f, 0.f, width, height), imageRef);
+    CGImageRef decodedImageRef = CGBitmapContextCreateImage(context);
+    CGContextRelease(context);
+    
+    UIImage *decodedImage = [UIImage imageWithCGImage:decodedImageRef scale:self.scale orientation:self.imageOrientation];
+    CGImageRelease(decodedImageRef);
+    return decodedImage;
+}
+
+@end
+
+@implementation UIImage (HLSAsynchronousProcessing)
+
+- (void)scaleToSize:(CGSize)size 
+             opaque:(BOOL)opaque 
+              scale:(CGFloat)scale 
+interpolationQuality:(CGInterpolationQuality)interpolationQuality
+   completionTarget:(id)target 
+             action:(SEL)action
+{
+    SEL selector = @selector(imageScaledToSize:opaque:scale:interpolationQuality:);
+    NSInvocation *invocation = [NSInvocation invocationWithMethodSignature:[self methodSignatureForSelector:selector]];
+    [invocation setSelector:selector];
+    [invocation setArgument:&size atIndex:2];
+    [invocation setArgument:&opaque atIndex:3];
+    [invocation setArgument:&scale atIndex:4];
+    [invocation setArgument:&interpolationQuality atIndex:5];
+    [self processWithInvocation:invocation decodingResult:NO completionTarget:target action:action];
+}
+
+- (void)maskWithImage:(UIImage *)maskImage completionTarget:(id)target action:(SEL)action
+{
+    SEL selector = @selector(imageMaskedWithImage:);
+    NSInvocation *invocation = [NSInvocation invocationWithMethodSignature:[self methodSignatureForSelector:selector]];
+    [invocation setSelector:selector];
+    [invocation setArgument:&maskImage atIndex:2];
+    [self processWithInvocation:invocation decodingResult:YES completionTarget:target action:action];
+}
+
+- (void)decodeWithCompletionTarget:(id)target action:(SEL)action
+{
+    SEL selector = @selector(decodedImage);
+    NSInvocation *invocation = [NSInvocation invocationWithMethodSignature:[self methodSignatureForSelector:selector]];
+    [invocation setSelector:selector];
+    [self processWithInvocation:invocation decodingResult:NO completionTarget:target action:action];
+}
+
+@end
+
+@implementation UIImage (HLSAsynchronousProcessingPrivate)
+
+- (void)processWithInvocation:(NSInvocation *)invocation decodingResult:(BOOL)decodingResult completionTarget:(id)target action:(SEL)action
+{
+    if (target && ! [target respondsToSelector:action]) {
+        HLSLoggerError(@"The target %@ does not respond to the selector %@", target, NSStringFromSelector(action));
+        return;
+    }
+    
+    [invocation setTarget:self];
+    [invocation retainArguments];
+    
+    HLSImageProcessingOperation *operation = [[[HLSImageProcessingOperation alloc] initWithInvocation:invocation
+                                                                                       decodingResult:decodingResult
+                                                                                     completionTarget:target
+                                                                                               action:action] autorelease];
+    [imageProcessingQueue() addOperation:operation];
 }
 
 @end
+
+@implementation HLSImageProcessingOperation
+
+#pragma mark -
+#pragma mark Object creation and destruction
+
+- (id)initWithInvocation:(NSInvocation *)invocation decodingResult:(BOOL)decodingResult completionTarget:(id)target action:(SEL)action
+{
+    if ((self = [super init])) {
+        _invocation = [invocation retain];
+        _decodingResult = decodingResult;
+        _target = [target retain];
+        _action = action;
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [_invocation release];
+    [_target release];
+    [_image release];
+    [super dealloc];
+}
+
+#pragma mark -
+#pragma mark Operation
+
+- (void)main
+{
+    NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+    
+    [_invocation invoke];
+    
+    UIImage *image = nil;
+    [_invocation getReturnValue:&image];
+    if (_decodingResult) {
+        image = [image decodedImage];
+    }
+    _image = [image retain];
+    
+    // The processed image and the arguments can be released as soon as possible
+    [_invocation release];
+    _invocation = nil;
+    
+    [self performSelectorOnMainThread:@selector(notifyCompletion) withObject:nil waitUntilDone:NO];
+    
+    [pool drain];
+}
+
+#pragma mark -
+#pragma mark Completion
+
+- (void)notifyCompletion
+{
+    [_target performSelector:_action withObject:_image];
+}
+
+@end
+
+#pragma mark Static functions
+
+static BOOL packedRGBAValueForColor(UIColor *color, uint32_t *pValue)
+{
+    NSCParameterAssert(pValue);
+    
+    CGColorRef colorRef = color.CGColor;
+    if (! colorRef) {
+        return NO;
+    }
+    
+    const CGFloat *components = CGColorGetComponents(colorRef);
+    CGFloat red, green, blue, alpha;
+    switch (CGColorSpaceGetModel(CGColorGetColorSpace(colorRef))) {
+        case kCGColorSpaceModelMonochrome: {
+            red = green = blue = components[0];
+            alpha = components[1];
+            break;
+        }
+            
+        case kCGColorSpaceModelRGB: {
+            red = components[0];
+            green = components[1];
+            blue = components[2];
+            alpha = components[3];
+            break;
+        }
+            
+        default: {
+            return NO;
+            break;
+        }
+    }
+    
+    *pValue = ((uint32_t)roundf(red * 255.f) << 24) 
+        | ((uint32_t)roundf(green * 255.f) << 16) 
+        | ((uint32_t)roundf(blue * 255.f) << 8) 
+        | (uint32_t)roundf(alpha * 255.f);
+    return YES;
+}
+
+static NSCache *colorImageCache(void)
+{
+    static NSCache *s_cache = nil;
+    @synchronized([HLSImageProcessingOperation class]) {
+        if (! s_cache) {
+            s_cache = [[NSCache alloc] init];
+        }
+    }
+    return s_cache;
+}
+
+static NSOperationQueue *imageProcessingQueue(void)
+{
+    static NSOperationQueue *s_queue = nil;
+    @synchronized([HLSImageProcessingOperation class]) {
+        if (! s_queue) {
+            s_queue = [[NSOperationQueue alloc] init];
+            [s_queue setMaxConcurrentOperationCount:kImageProcessingMaxConcurrentOperationCount];
+        }
+    }
+    return s_queue;
+}
+
+static UIImage *imageFromImageSource(CGImageSourceRef imageSource, NSUInteger maximumPixelSize, CGFloat scale)
+{
+    // Always create the thumbnail from the full image (embedded thumbnails are usually too small)
+    NSDictionary *options = [NSDictionary dictionaryWithObjectsAndKeys:(id)kCFBooleanTrue, (id)kCGImageSourceCreateThumbnailFromImageAlways,
+                             (id)kCFBooleanTrue, (id)kCGImageSourceCreateThumbnailWithTransform,
+                             [NSNumber numberWithUnsignedInteger:maximumPixelSize], (id)kCGImageSourceThumbnailMaxPixelSize,
+                             nil];
+    CGImageRef imageRef = CGImageSourceCreateThumbnailAtIndex(imageSource, 0, (CFDictionaryRef)options);
+    if (! imageRef) {
+        return nil;
+    }
+    
+    UIImage *image = [UIImage imageWithCGImage:imageRef scale:scale orientation:UIImageOrientationUp];
+    CGImageRelease(imageRef);
+    return image;
+}
+
+static CGSize pixelSizeOfImageSource(CGImageSourceRef imageSource)
+{
+    // Only reads the image header
+    NSDictionary *properties = [(NSDictionary *)CGImageSourceCopyPropertiesAtIndex(imageSource, 0, NULL) autorelease];
+    
+    CGFloat width = [[properties objectForKey:(id)kCGImagePropertyPixelWidth] floatValue];
+    CGFloat height = [[properties objectForKey:(id)kCGImagePropertyPixelHeight] floatValue];
+    
+    // EXIF orientations 5 to 8 swap width and height
+    NSInteger orientation = [[properties objectForKey:(id)kCGImagePropertyOrientation] integerValue];
+    if (orientation >= 5 && orientation <= 8) {
+        return CGSizeMake(height, width);
+    }
+    else {
+        return CGSizeMake(width, height);
+    }
+}
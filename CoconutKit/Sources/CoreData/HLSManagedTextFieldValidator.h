@@ -22,6 +22,17 @@
     NSFormatter *m_formatter;
     id<HLSTextFieldValidationDelegate> m_validationDelegate;
     BOOL m_checkingOnChange;
+    NSTimeInterval m_checkingOnChangeDelay;
+    NSString *m_pendingText;
+    NSString *m_parsedString;
+    id m_parsedValue;
+    BOOL m_parsingSuccessful;
+    id m_formattedValue;
+    NSString *m_formattedText;
+    id m_checkedValue;
+    BOOL m_hasCheckedValue;
+    BOOL m_checkedValueValid;
+    NSError *m_checkingError;
 }
 
 /**
@@ -41,7 +52,16 @@
 @property (nonatomic, assign, getter=isCheckingOnChange) BOOL checkingOnChange;
 
 /**
- * Formats string and returns it by reference in pValue (must not be NULL). Returns YES iff successful
+ * When checking on change, the time to wait after the last keystroke before formatting and validating the text. Each
+ * keystroke cancels any check still pending, so that only the most recent text is ever checked. Set to 0 to check
+ * synchronously on every keystroke
+ * Default value is 0.3 seconds
+ */
+@property (nonatomic, assign) NSTimeInterval checkingOnChangeDelay;
+
+/**
+ * Formats string and returns it by reference in pValue (must not be NULL). Returns YES iff successful. The result
+ * obtained for the last string is cached, so that the formatter is not invoked again while the text does not change
  */
 - (BOOL)getValue:(id *)pValue forString:(NSString *)string;
 
@@ -51,8 +71,14 @@
 - (void)setValue:(id)value;
 
 /**
- * Check the value currently displayed by the text field. Returns YES iff valid
+ * Check the value currently displayed by the text field. Returns YES iff valid. Unlike checks made during input or
+ * when the model changes, which are only performed again when the value changes, model validation is always run
  */
 - (BOOL)checkDisplayedValue;
 
+/**
+ * Cancel any check scheduled during input which has not been performed yet
+ */
+- (void)cancelPendingCheck;
+
 @end
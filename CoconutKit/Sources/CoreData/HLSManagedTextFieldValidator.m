@@ -10,21 +10,36 @@
 
 #import "HLSAssert.h"
 #import "HLSError.h"
+#import "HLSFloat.h"
 #import "HLSLogger.h"
 #import "NSManagedObject+HLSValidation.h"
 #import "NSObject+HLSExtensions.h"
 
+static const NSTimeInterval kManagedTextFieldValidatorDefaultCheckingOnChangeDelay = 0.3;
+
 // This implementation has been swizzled in UITextField+HLSValidation.m
 extern void (*UITextField__setText_Imp)(id, SEL, id);
 
+// Function declarations
+static BOOL valuesEqual(id value1, id value2);
+
 @interface HLSManagedTextFieldValidator ()
 
 @property (nonatomic, retain) NSManagedObject *managedObject;
 @property (nonatomic, retain) NSString *fieldName;
 @property (nonatomic, retain) NSFormatter *formatter;
 @property (nonatomic, assign) id<HLSTextFieldValidationDelegate> validationDelegate;
+@property (nonatomic, retain) NSString *pendingText;
+@property (nonatomic, copy) NSString *parsedString;
+@property (nonatomic, retain) id parsedValue;
+@property (nonatomic, retain) id formattedValue;
+@property (nonatomic, retain) NSString *formattedText;
+@property (nonatomic, retain) id checkedValue;
+@property (nonatomic, retain) NSError *checkingError;
 
 - (BOOL)checkValue:(id)value;
+- (BOOL)checkValue:(id)value usingCache:(BOOL)usingCache;
+- (void)checkPendingText;
 - (void)synchronizeTextField;
 
 @end
@@ -68,6 +83,7 @@ extern void (*UITextField__setText_Imp)(id, SEL, id);
         self.fieldName = fieldName;
         self.formatter = formatter;
         self.validationDelegate = validationDelegate;
+        self.checkingOnChangeDelay = kManagedTextFieldValidatorDefaultCheckingOnChangeDelay;
         
         // Perform initial synchronization of the text field with the model object field value
         [self synchronizeTextField];
@@ -83,12 +99,20 @@ extern void (*UITextField__setText_Imp)(id, SEL, id);
 
 - (void)dealloc
 {
+    [self cancelPendingCheck];
     [self.managedObject removeObserver:self forKeyPath:self.fieldName];
     
     self.managedObject = nil;
     self.fieldName = nil;
     self.formatter = nil;
     self.validationDelegate = nil;
+    self.pendingText = nil;
+    self.parsedString = nil;
+    self.parsedValue = nil;
+    self.formattedValue = nil;
+    self.formattedText = nil;
+    self.checkedValue = nil;
+    self.checkingError = nil;
     
     [super dealloc];
 }
@@ -105,6 +129,22 @@ extern void (*UITextField__setText_Imp)(id, SEL, id);
 
 @synthesize checkingOnChange = m_checkingOnChange;
 
+@synthesize checkingOnChangeDelay = m_checkingOnChangeDelay;
+
+@synthesize pendingText = m_pendingText;
+
+@synthesize parsedString = m_parsedString;
+
+@synthesize parsedValue = m_parsedValue;
+
+@synthesize formattedValue = m_formattedValue;
+
+@synthesize formattedText = m_formattedText;
+
+@synthesize checkedValue = m_checkedValue;
+
+@synthesize checkingError = m_checkingError;
+
 #pragma mark UITextFieldDelegate protocol implementation
 
 - (BOOL)textField:(UITextField *)textField shouldChangeCharactersInRange:(NSRange)range replacementString:(NSString *)string
@@ -115,10 +155,22 @@ extern void (*UITextField__setText_Imp)(id, SEL, id);
     
     // Check when typing?
     if (self.checkingOnChange) {
-        id value = nil;
         NSString *updatedText = [textField.text stringByReplacingCharactersInRange:range withString:string];
-        if ([self getValue:&value forString:updatedText]) {
-            [self checkValue:value];
+        
+        // Debounce: Formatting and validation can be expensive (regular expressions, fetches against the store), 
+        // and running them for every keystroke makes typing lag. Only check the most recent text once input
+        // pauses, discarding checks made stale by further changes. Validation still occurs on the main thread
+        // since managed objects must only be accessed from the thread of their context
+        [self cancelPendingCheck];
+        if (doublele(self.checkingOnChangeDelay, 0.)) {
+            id value = nil;
+            if ([self getValue:&value forString:updatedText]) {
+                [self checkValue:value];
+            }
+        }
+        else {
+            self.pendingText = updatedText;
+            [self performSelector:@selector(checkPendingText) withObject:nil afterDelay:self.checkingOnChangeDelay];
         }
         
         // The model is not updated here. It will be when input mode is exited
@@ -127,6 +179,14 @@ extern void (*UITextField__setText_Imp)(id, SEL, id);
     return YES;
 }
 
+- (void)textFieldDidEndEditing:(UITextField *)textField
+{
+    // Any check still pending is now stale
+    [self cancelPendingCheck];
+    
+    [super textFieldDidEndEditing:textField];
+}
+
 #pragma mark Sync and check
 
 // Does not return nil on failure, but a BOOL. nil could namely be a valid value
@@ -146,9 +206,17 @@ extern void (*UITextField__setText_Imp)(id, SEL, id);
         return YES;
     }
     
-    // Format the value
+    // Format the value, unless the same string has just been formatted (the text is checked on each keystroke, when
+    // input ends and when the model is updated)
     // Remark: The formatting error descriptions are not explicit. No need to have a look at them 
-    if (! [self.formatter getObjectValue:pValue forString:string errorDescription:NULL]) {
+    if (! self.parsedString || ! [self.parsedString isEqualToString:string]) {
+        id parsedValue = nil;
+        m_parsingSuccessful = [self.formatter getObjectValue:&parsedValue forString:string errorDescription:NULL];
+        self.parsedString = string;
+        self.parsedValue = parsedValue;
+    }
+    
+    if (! m_parsingSuccessful) {
         HLSLoggerDebug(@"Formatting failed for field %@", self.fieldName);
         if ([self.validationDelegate respondsToSelector:@selector(textFieldDidFailFormatting:)]) {
             [self.validationDelegate textFieldDidFailFormatting:self.textField];
@@ -156,6 +224,8 @@ extern void (*UITextField__setText_Imp)(id, SEL, id);
         return NO;
     }
     
+    *pValue = self.parsedValue;
+    
     HLSLoggerDebug(@"Formatting successful for field %@", self.fieldName);
     if ([self.validationDelegate respondsToSelector:@selector(textFieldDidPassFormatting:)]) {
         [self.validationDelegate textFieldDidPassFormatting:self.textField];
@@ -172,8 +242,21 @@ extern void (*UITextField__setText_Imp)(id, SEL, id);
 // Check the given value. Returns YES iff valid
 - (BOOL)checkValue:(id)value
 {
-    NSError *error = nil;
-    if ([self.managedObject checkValue:value forKey:self.fieldName error:&error]) {
+    return [self checkValue:value usingCache:YES];
+}
+
+// If usingCache is set to YES, model validation is only run if the value differs from the one last checked
+- (BOOL)checkValue:(id)value usingCache:(BOOL)usingCache
+{
+    if (! usingCache || ! m_hasCheckedValue || ! valuesEqual(value, self.checkedValue)) {
+        NSError *error = nil;
+        m_checkedValueValid = [self.managedObject checkValue:value forKey:self.fieldName error:&error];
+        m_hasCheckedValue = YES;
+        self.checkedValue = value;
+        self.checkingError = error;
+    }
+    
+    if (m_checkedValueValid) {
         if ([self.validationDelegate respondsToSelector:@selector(textFieldDidPassValidation:)]) {
             HLSLoggerDebug(@"Value %@ for field %@ is valid", value, self.fieldName);
             [self.validationDelegate textFieldDidPassValidation:self.textField];
@@ -183,7 +266,7 @@ extern void (*UITextField__setText_Imp)(id, SEL, id);
     else {
         if ([self.validationDelegate respondsToSelector:@selector(textField:didFailValidationWithError:)]) {
             HLSLoggerDebug(@"Value %@ for field %@ is invalid", value, self.fieldName);
-            [self.validationDelegate textField:self.textField didFailValidationWithError:error];
+            [self.validationDelegate textField:self.textField didFailValidationWithError:self.checkingError];
         }
         return NO;
     }
@@ -191,12 +274,37 @@ extern void (*UITextField__setText_Imp)(id, SEL, id);
 
 - (BOOL)checkDisplayedValue
 {
+    // Supersedes any pending check
+    [self cancelPendingCheck];
+    
     id value = nil;
     if (! [self getValue:&value forString:self.textField.text]) {
         return NO;
     }
     
-    return [self checkValue:value];
+    // Validation might depend on other values which have changed in the meantime
+    return [self checkValue:value usingCache:NO];
+}
+
+- (void)checkPendingText
+{
+    NSString *pendingText = [[self.pendingText retain] autorelease];
+    self.pendingText = nil;
+    
+    id value = nil;
+    if ([self getValue:&value forString:pendingText]) {
+        [self checkValue:value];
+    }
+}
+
+- (void)cancelPendingCheck
+{
+    if (! self.pendingText) {
+        return;
+    }
+    
+    [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(checkPendingText) object:nil];
+    self.pendingText = nil;
 }
 
 // Synchronize the string displayed by the text field with the underlying model object field value
@@ -209,9 +317,13 @@ extern void (*UITextField__setText_Imp)(id, SEL, id);
     NSString *text = @"";
     if (value) {
         if (self.formatter) {
-            NSString *formattedValue = [self.formatter stringForObjectValue:value];
-            if (formattedValue) {
-                text = formattedValue;
+            // Only format again if the value has changed
+            if (! self.formattedText || ! valuesEqual(value, self.formattedValue)) {
+                self.formattedValue = value;
+                self.formattedText = [self.formatter stringForObjectValue:value];
+            }
+            if (self.formattedText) {
+                text = self.formattedText;
             }
         }
         else {
@@ -229,7 +341,9 @@ extern void (*UITextField__setText_Imp)(id, SEL, id);
 - (void)observeValueForKeyPath:(NSString *)keyPath ofObject:(id)object change:(NSDictionary *)change context:(void *)context
 {
     // Every time the value of the model object field changes, we want to trigger validation to update the text field
-    // accordingly
+    // accordingly. A check pending for text typed before the change is stale
+    [self cancelPendingCheck];
+    
     id newValue = [object valueForKey:keyPath];
     [self checkValue:newValue];
     
@@ -253,3 +367,10 @@ extern void (*UITextField__setText_Imp)(id, SEL, id);
 }
 
 @end
+
+#pragma mark Static functions
+
+static BOOL valuesEqual(id value1, id value2)
+{
+    return value1 == value2 || [value1 isEqual:value2];
+}
@@ -0,0 +1,27 @@
+//
+//  HLSModelChangeSet+Friend.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+/**
+ * Interface meant to be used by friend classes of HLSModelChangeSet (= classes which must have access to private
+ * implementation details)
+ */
+@interface HLSModelChangeSet (Friend)
+
+/**
+ * Create an empty change set for an entity
+ */
+- (id)initWithEntityName:(NSString *)entityName;
+
+/**
+ * Coalesce changes which have been saved after those already in the change set
+ */
+- (void)addInsertedObjectIDs:(NSSet *)insertedObjectIDs
+            updatedObjectIDs:(NSSet *)updatedObjectIDs
+            deletedObjectIDs:(NSSet *)deletedObjectIDs;
+
+@end
@@ -0,0 +1,59 @@
+//
+//  HLSModelChangeSet.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSModelListChanges.h"
+
+/**
+ * The changes saved for an entity since a model manager last published its change sets (see the publishingChangeSets
+ * property of HLSModelManager). Changes saved consecutively are coalesced:
+ *   - an object inserted and then updated is only reported as inserted
+ *   - an object updated and then deleted is only reported as deleted
+ *   - an object inserted and then deleted is not reported at all
+ *
+ * Instead of fetching and reloading a whole list of objects when a change set is received, call
+ * -listChangesForObjects:predicate:sortDescriptors: to obtain the minimal changes to apply to it (e.g. as table view
+ * row animations). No fetch is made, except for objects which enter the list
+ *
+ * You do not instantiate change sets yourself. They are received from HLSModelManager notifications
+ */
+@interface HLSModelChangeSet : NSObject {
+@private
+    NSString *_entityName;
+    NSMutableSet *_insertedObjectIDs;
+    NSMutableSet *_updatedObjectIDs;
+    NSMutableSet *_deletedObjectIDs;
+}
+
+/**
+ * The name of the entity the changes have been made to
+ */
+@property (nonatomic, readonly, retain) NSString *entityName;
+
+/**
+ * The NSManagedObjectID objects of the changed objects
+ */
+@property (nonatomic, readonly, retain) NSSet *insertedObjectIDs;
+@property (nonatomic, readonly, retain) NSSet *updatedObjectIDs;
+@property (nonatomic, readonly, retain) NSSet *deletedObjectIDs;
+
+/**
+ * Given an ordered list of objects (of the change set entity) matching a predicate and sorted using the specified
+ * descriptors, return the changes which must be applied to it. Both the predicate and the sort descriptors can be
+ * nil; objects entering an unsorted list are appended at its end. Objects entering the list are retrieved from the
+ * specified context (without context parameter, the current HLSModelManager context is used), which must be the
+ * one the objects belong to
+ */
+- (HLSModelListChanges *)listChangesForObjects:(NSArray *)objects
+                                     predicate:(NSPredicate *)predicate
+                               sortDescriptors:(NSArray *)sortDescriptors
+                        inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext;
+- (HLSModelListChanges *)listChangesForObjects:(NSArray *)objects
+                                     predicate:(NSPredicate *)predicate
+                               sortDescriptors:(NSArray *)sortDescriptors;
+
+@end
@@ -0,0 +1,267 @@
+//
+//  HLSModelChangeSet.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSModelChangeSet.h"
+
+#import "HLSAssert.h"
+#import "HLSModelChangeSet+Friend.h"
+#import "HLSModelManager.h"
+
+// Function declarations
+static NSIndexSet *longestIncreasingSubsequencePositions(const NSUInteger *values, NSUInteger count);
+
+@interface HLSModelChangeSet ()
+
+@property (nonatomic, retain) NSString *entityName;
+@property (nonatomic, retain) NSMutableSet *insertedObjectIDs;
+@property (nonatomic, retain) NSMutableSet *updatedObjectIDs;
+@property (nonatomic, retain) NSMutableSet *deletedObjectIDs;
+
+@end
+
+@implementation HLSModelChangeSet
+
+#pragma mark Object creation and destruction
+
+- (id)initWithEntityName:(NSString *)entityName
+{
+    if ((self = [super init])) {
+        self.entityName = entityName;
+        self.insertedObjectIDs = [NSMutableSet set];
+        self.updatedObjectIDs = [NSMutableSet set];
+        self.deletedObjectIDs = [NSMutableSet set];
+    }
+    return self;
+}
+
+- (id)init
+{
+    HLSForbiddenInheritedMethod();
+    return nil;
+}
+
+- (void)dealloc
+{
+    self.entityName = nil;
+    self.insertedObjectIDs = nil;
+    self.updatedObjectIDs = nil;
+    self.deletedObjectIDs = nil;
+
+    [super dealloc];
+}
+
+#pragma mark Accessors and mutators
+
+@synthesize entityName = _entityName;
+
+@synthesize insertedObjectIDs = _insertedObjectIDs;
+
+@synthesize updatedObjectIDs = _updatedObjectIDs;
+
+@synthesize deletedObjectIDs = _deletedObjectIDs;
+
+#pragma mark Coalescing changes
+
+- (void)addInsertedObjectIDs:(NSSet *)insertedObjectIDs
+            updatedObjectIDs:(NSSet *)updatedObjectIDs
+            deletedObjectIDs:(NSSet *)deletedObjectIDs
+{
+    [self.deletedObjectIDs minusSet:insertedObjectIDs];
+    [self.insertedObjectIDs unionSet:insertedObjectIDs];
+
+    for (NSManagedObjectID *objectID in updatedObjectIDs) {
+        if (! [self.insertedObjectIDs containsObject:objectID]) {
+            [self.updatedObjectIDs addObject:objectID];
+        }
+    }
+
+    for (NSManagedObjectID *objectID in deletedObjectIDs) {
+        [self.updatedObjectIDs removeObject:objectID];
+
+        // Never seen by anyone
+        if ([self.insertedObjectIDs containsObject:objectID]) {
+            [self.insertedObjectIDs removeObject:objectID];
+        }
+        else {
+            [self.deletedObjectIDs addObject:objectID];
+        }
+    }
+}
+
+#pragma mark List changes
+
+- (HLSModelListChanges *)listChangesForObjects:(NSArray *)objects
+                                     predicate:(NSPredicate *)predicate
+                               sortDescriptors:(NSArray *)sortDescriptors
+                        inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext
+{
+    // Objects remaining in the list, with the index they had in it
+    NSMutableArray *newObjects = [NSMutableArray arrayWithCapacity:[objects count]];
+    NSMutableDictionary *objectIDToOldIndexMap = [NSMutableDictionary dictionaryWithCapacity:[objects count]];
+    NSMutableIndexSet *deletedIndexes = [NSMutableIndexSet indexSet];
+    NSUInteger oldIndex = 0;
+    for (NSManagedObject *object in objects) {
+        NSManagedObjectID *objectID = [object objectID];
+        [objectIDToOldIndexMap setObject:[NSNumber numberWithUnsignedInteger:oldIndex] forKey:objectID];
+
+        // Deleted, or updated so that it does not match anymore
+        if ([self.deletedObjectIDs containsObject:objectID]
+                || ([self.updatedObjectIDs containsObject:objectID] && predicate && ! [predicate evaluateWithObject:object])) {
+            [deletedIndexes addIndex:oldIndex];
+        }
+        else {
+            [newObjects addObject:object];
+        }
+        ++oldIndex;
+    }
+
+    // Objects entering the list: Inserted ones, or updated ones which now match
+    NSMutableSet *candidateObjectIDs = [NSMutableSet setWithSet:self.insertedObjectIDs];
+    [candidateObjectIDs unionSet:self.updatedObjectIDs];
+    for (NSManagedObjectID *objectID in candidateObjectIDs) {
+        if ([objectIDToOldIndexMap objectForKey:objectID]) {
+            continue;
+        }
+
+        NSManagedObject *object = [managedObjectContext existingObjectWithID:objectID error:NULL];
+        if (! object || [object isDeleted]) {
+            continue;
+        }
+
+        if (predicate && ! [predicate evaluateWithObject:object]) {
+            continue;
+        }
+
+        [newObjects addObject:object];
+    }
+
+    if ([sortDescriptors count] != 0) {
+        [newObjects sortUsingDescriptors:sortDescriptors];
+    }
+
+    // Scan the new list. Among objects which were already in the list, those forming the longest subsequence whose
+    // old indexes are increasing keep their relative order. All other ones have moved
+    NSMutableIndexSet *insertedIndexes = [NSMutableIndexSet indexSet];
+    NSUInteger *commonOldIndexes = (NSUInteger *)malloc([newObjects count] * sizeof(NSUInteger));
+    NSUInteger *commonNewIndexes = (NSUInteger *)malloc([newObjects count] * sizeof(NSUInteger));
+    NSUInteger commonCount = 0;
+    NSUInteger newIndex = 0;
+    for (NSManagedObject *object in newObjects) {
+        NSNumber *oldIndexNumber = [objectIDToOldIndexMap objectForKey:[object objectID]];
+        if (oldIndexNumber) {
+            commonOldIndexes[commonCount] = [oldIndexNumber unsignedIntegerValue];
+            commonNewIndexes[commonCount] = newIndex;
+            ++commonCount;
+        }
+        else {
+            [insertedIndexes addIndex:newIndex];
+        }
+        ++newIndex;
+    }
+
+    NSIndexSet *stablePositions = longestIncreasingSubsequencePositions(commonOldIndexes, commonCount);
+    NSMutableIndexSet *updatedIndexes = [NSMutableIndexSet indexSet];
+    NSMutableArray *movedFromIndexes = [NSMutableArray array];
+    NSMutableArray *movedToIndexes = [NSMutableArray array];
+    for (NSUInteger i = 0; i < commonCount; ++i) {
+        if ([stablePositions containsIndex:i]) {
+            NSManagedObject *object = [objects objectAtIndex:commonOldIndexes[i]];
+            if ([self.updatedObjectIDs containsObject:[object objectID]]) {
+                [updatedIndexes addIndex:commonOldIndexes[i]];
+            }
+        }
+        else {
+            [movedFromIndexes addObject:[NSNumber numberWithUnsignedInteger:commonOldIndexes[i]]];
+            [movedToIndexes addObject:[NSNumber numberWithUnsignedInteger:commonNewIndexes[i]]];
+        }
+    }
+
+    free(commonOldIndexes);
+    free(commonNewIndexes);
+
+    return [[[HLSModelListChanges alloc] initWithObjects:[NSArray arrayWithArray:newObjects]
+                                          deletedIndexes:deletedIndexes
+                                         insertedIndexes:insertedIndexes
+                                          updatedIndexes:updatedIndexes
+                                        movedFromIndexes:movedFromIndexes
+                                          movedToIndexes:movedToIndexes] autorelease];
+}
+
+- (HLSModelListChanges *)listChangesForObjects:(NSArray *)objects
+                                     predicate:(NSPredicate *)predicate
+                               sortDescriptors:(NSArray *)sortDescriptors
+{
+    return [self listChangesForObjects:objects
+                             predicate:predicate
+                       sortDescriptors:sortDescriptors
+                inManagedObjectContext:[HLSModelManager currentModelContext]];
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; entityName: %@; insertedObjectIDs: %@; updatedObjectIDs: %@; deletedObjectIDs: %@>",
+            [self class],
+            self,
+            self.entityName,
+            self.insertedObjectIDs,
+            self.updatedObjectIDs,
+            self.deletedObjectIDs];
+}
+
+@end
+
+#pragma mark Static functions
+
+/**
+ * Return the positions of the values forming one longest strictly increasing subsequence (patience sorting, O(n log n))
+ */
+static NSIndexSet *longestIncreasingSubsequencePositions(const NSUInteger *values, NSUInteger count)
+{
+    if (count == 0) {
+        return [NSIndexSet indexSet];
+    }
+
+    // tailPositions[k]: position of the smallest value ending an increasing subsequence of length k + 1
+    // predecessorPositions[i]: position of the value before values[i] in the subsequence it ends
+    NSUInteger *tailPositions = (NSUInteger *)malloc(count * sizeof(NSUInteger));
+    NSInteger *predecessorPositions = (NSInteger *)malloc(count * sizeof(NSInteger));
+    NSUInteger length = 0;
+    for (NSUInteger i = 0; i < count; ++i) {
+        NSUInteger lowerIndex = 0;
+        NSUInteger upperIndex = length;
+        while (lowerIndex < upperIndex) {
+            NSUInteger middleIndex = (lowerIndex + upperIndex) / 2;
+            if (values[tailPositions[middleIndex]] < values[i]) {
+                lowerIndex = middleIndex + 1;
+            }
+            else {
+                upperIndex = middleIndex;
+            }
+        }
+
+        predecessorPositions[i] = (lowerIndex > 0) ? (NSInteger)tailPositions[lowerIndex - 1] : -1;
+        tailPositions[lowerIndex] = i;
+        if (lowerIndex == length) {
+            ++length;
+        }
+    }
+
+    NSMutableIndexSet *positions = [NSMutableIndexSet indexSet];
+    NSInteger position = (NSInteger)tailPositions[length - 1];
+    while (position >= 0) {
+        [positions addIndex:(NSUInteger)position];
+        position = predecessorPositions[position];
+    }
+
+    free(tailPositions);
+    free(predecessorPositions);
+
+    return positions;
+}
@@ -0,0 +1,69 @@
+//
+//  HLSModelImportTask.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSModelManager.h"
+#import "HLSTask.h"
+
+/**
+ * An import task inserts objects for a stream of records into the store of a model manager, in batches. After each
+ * batch has been imported, changes are saved and the import context is reset, so that memory consumption does not
+ * depend on the number of records to import. Progress is reported as for any other task
+ *
+ * To use an import task, subclass HLSModelImportTask and implement the -importRecord: method. An import task runs 
+ * on a thread of the task manager it is submitted to, using its own context, which shares the persistent store 
+ * coordinator of the model manager it has been created with. If merging changes is enabled (the default), the 
+ * model manager context must be used from the main thread (see -[HLSModelManager backgroundDuplicate])
+ *
+ * If the import is cancelled or if a batch cannot be saved, the current batch is discarded. Batches which have
+ * already been saved are kept
+ *
+ * Designated initializer: -initWithModelManager:recordEnumerator:recordCount:
+ */
+@interface HLSModelImportTask : HLSTask {
+@private
+    HLSModelManager *_modelManager;
+    NSEnumerator *_recordEnumerator;
+    NSUInteger _recordCount;
+    NSUInteger _batchSize;
+    BOOL _mergingChanges;
+}
+
+/**
+ * Create an import task for the records returned by an enumerator, saving them into the store of the given model
+ * manager. The enumerator is consumed on the import thread. If known, provide the number of records so that progress
+ * can be reported (0 if unknown, in which case progress is only updated when the import is complete)
+ */
+- (id)initWithModelManager:(HLSModelManager *)modelManager
+          recordEnumerator:(NSEnumerator *)recordEnumerator
+               recordCount:(NSUInteger)recordCount;
+
+@property (nonatomic, readonly, retain) HLSModelManager *modelManager;
+@property (nonatomic, readonly, retain) NSEnumerator *recordEnumerator;
+@property (nonatomic, readonly, assign) NSUInteger recordCount;
+
+/**
+ * The number of records imported between two saves. Must be > 0, and must not be changed while the task is running
+ * Default value is 500
+ */
+@property (nonatomic, assign) NSUInteger batchSize;
+
+/**
+ * If set to YES, saved batches are merged into the context of the model manager on the main thread
+ * Default value is YES
+ */
+@property (nonatomic, assign, getter=isMergingChanges) BOOL mergingChanges;
+
+/**
+ * Import a single record. This method is called on the import thread, with the import model manager pushed onto
+ * its model manager stack. Context-free methods of NSManagedObject+HLSExtensions.h can therefore be used to insert
+ * objects. Objects created for previous batches must not be kept, since they are invalidated between batches
+ * Must be overridden
+ */
+- (void)importRecord:(id)record;
+
+@end
@@ -0,0 +1,100 @@
+//
+//  HLSModelImportTask.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSModelImportTask.h"
+
+#import "HLSAssert.h"
+#import "HLSLogger.h"
+#import "HLSModelImportTaskOperation.h"
+
+static const NSUInteger kModelImportTaskDefaultBatchSize = 500;
+
+@interface HLSModelImportTask ()
+
+@property (nonatomic, retain) HLSModelManager *modelManager;
+@property (nonatomic, retain) NSEnumerator *recordEnumerator;
+@property (nonatomic, assign) NSUInteger recordCount;
+
+@end
+
+@implementation HLSModelImportTask
+
+#pragma mark -
+#pragma mark Object creation and destruction
+
+- (id)initWithModelManager:(HLSModelManager *)modelManager
+          recordEnumerator:(NSEnumerator *)recordEnumerator
+               recordCount:(NSUInteger)recordCount
+{
+    if ((self = [super init])) {
+        if (! modelManager) {
+            HLSLoggerError(@"Missing model manager");
+            [self release];
+            return nil;
+        }
+        
+        self.modelManager = modelManager;
+        self.recordEnumerator = recordEnumerator;
+        self.recordCount = recordCount;
+        self.batchSize = kModelImportTaskDefaultBatchSize;
+        self.mergingChanges = YES;
+    }
+    return self;
+}
+
+- (id)init
+{
+    HLSForbiddenInheritedMethod();
+    return nil;
+}
+
+- (void)dealloc
+{
+    self.modelManager = nil;
+    self.recordEnumerator = nil;
+    
+    [super dealloc];
+}
+
+#pragma mark -
+#pragma mark Accessors and mutators
+
+- (Class)operationClass
+{
+    return [HLSModelImportTaskOperation class];
+}
+
+@synthesize modelManager = _modelManager;
+
+@synthesize recordEnumerator = _recordEnumerator;
+
+@synthesize recordCount = _recordCount;
+
+@synthesize batchSize = _batchSize;
+
+- (void)setBatchSize:(NSUInteger)batchSize
+{
+    if (batchSize == 0) {
+        HLSLoggerError(@"The batch size must be > 0");
+        return;
+    }
+    
+    _batchSize = batchSize;
+}
+
+@synthesize mergingChanges = _mergingChanges;
+
+#pragma mark -
+#pragma mark Importing
+
+- (void)importRecord:(id)record
+{
+    HLSMissingMethodImplementation();
+}
+
+@end
@@ -0,0 +1,19 @@
+//
+//  HLSModelImportTaskOperation.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSTaskOperation.h"
+
+/**
+ * Operation processing an HLSModelImportTask
+ */
+@interface HLSModelImportTaskOperation : HLSTaskOperation {
+@private
+    
+}
+
+@end
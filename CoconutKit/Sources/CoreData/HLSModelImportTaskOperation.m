@@ -0,0 +1,79 @@
+//
+//  HLSModelImportTaskOperation.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSModelImportTaskOperation.h"
+
+#import "HLSLogger.h"
+#import "HLSModelImportTask.h"
+#import "HLSTaskOperation+Protected.h"
+
+@implementation HLSModelImportTaskOperation
+
+#pragma mark Thread main function
+
+- (void)operationMain
+{
+    HLSModelImportTask *importTask = (HLSModelImportTask *)self.task;
+    
+    // The import context must be created on the import thread
+    HLSModelManager *importModelManager = importTask.mergingChanges ? [importTask.modelManager backgroundDuplicate] 
+        : [importTask.modelManager duplicate];
+    NSManagedObjectContext *importContext = importModelManager.managedObjectContext;
+    
+    // Not needed for inserted objects, and would keep changes in memory across batches
+    [importContext setUndoManager:nil];
+    
+    [HLSModelManager pushModelManager:importModelManager];
+    
+    NSUInteger importedRecordCount = 0;
+    BOOL exhausted = NO;
+    while (! exhausted && ! [self isCancelled]) {
+        NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+        
+        NSUInteger batchRecordCount = 0;
+        while (batchRecordCount < importTask.batchSize) {
+            id record = [importTask.recordEnumerator nextObject];
+            if (! record) {
+                exhausted = YES;
+                break;
+            }
+            
+            [importTask importRecord:record];
+            ++batchRecordCount;
+        }
+        
+        if ([self isCancelled]) {
+            [importContext rollback];
+            [pool drain];
+            break;
+        }
+        
+        NSError *error = nil;
+        if ([importContext hasChanges] && ! [importContext save:&error]) {
+            HLSLoggerError(@"Could not save imported records; reason: %@", error);
+            [self attachError:error];
+            [importContext rollback];
+            [pool drain];
+            break;
+        }
+        
+        // Objects of the previous batch are not needed anymore. Release them
+        [importContext reset];
+        
+        importedRecordCount += batchRecordCount;
+        if (importTask.recordCount != 0) {
+            [self updateProgressToValue:MIN((float)importedRecordCount / importTask.recordCount, 1.f)];
+        }
+        
+        [pool drain];
+    }
+    
+    [HLSModelManager popModelManager];
+}
+
+@end
@@ -0,0 +1,57 @@
+//
+//  HLSModelInstrumentation.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+/**
+ * Private class for implementation purposes. Collects the Core Data metrics exposed by HLSModelManager (see its
+ * instrumentation class methods). Recording methods can be called from any thread and do nothing when instrumentation
+ * is disabled
+ *
+ * Not meant to be instantiated directly. Simply use the +sharedInstrumentation class method.
+ */
+@interface HLSModelInstrumentation : NSObject {
+@private
+    NSMutableDictionary *_entityNameToMetricsMap;
+}
+
+/**
+ * The shared instrumentation object
+ */
++ (HLSModelInstrumentation *)sharedInstrumentation;
+
+/**
+ * Enable or disable instrumentation. Disabled by default
+ */
++ (void)setEnabled:(BOOL)enabled;
++ (BOOL)isEnabled;
+
+/**
+ * Execute a fetch request in a context, recording it for an entity and a template name (nil if none). Faults fired 
+ * while the fetch is executed are not counted as fault fires
+ */
+- (NSArray *)executeFetchRequest:(NSFetchRequest *)fetchRequest
+          inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext
+                    templateName:(NSString *)templateName
+                           error:(NSError **)pError;
+
+/**
+ * Save a context, recording the save duration for each entity it contains changes for
+ */
+- (BOOL)saveManagedObjectContext:(NSManagedObjectContext *)managedObjectContext error:(NSError **)pError;
+
+/**
+ * Return the metrics collected so far (see HLSModelManager.h for the format), or discard them
+ */
+- (NSDictionary *)snapshot;
+- (void)reset;
+
+/**
+ * Log the metrics collected so far using HLSLogger
+ */
+- (void)logMetrics;
+
+@end
@@ -0,0 +1,385 @@
+//
+//  HLSModelInstrumentation.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSModelInstrumentation.h"
+
+#import "HLSLogger.h"
+#import "HLSModelManager.h"
+#import "HLSRuntime.h"
+#import <pthread.h>
+
+// Minimum number of faults fired for an entity before excessive faulting is reported
+static const NSUInteger kExcessiveFaultCountThreshold = 100;
+
+static BOOL s_enabled = NO;
+
+// Thread-local slot storing the number of fetches being executed by the current thread
+static pthread_key_t s_fetchDepthKey;
+
+// Original implementation of the method swizzled to count fault fires
+static void (*s_NSManagedObject__awakeFromFetch_Imp)(id, SEL) = NULL;
+
+/**
+ * Fetch metrics for an entity or a fetch template
+ */
+@interface HLSModelFetchMetrics : NSObject {
+@public
+    NSUInteger _fetchCount;
+    NSUInteger _rowCount;
+    CFTimeInterval _duration;
+    CFTimeInterval _maxDuration;
+}
+
+- (void)recordFetchWithRowCount:(NSUInteger)rowCount duration:(CFTimeInterval)duration;
+- (NSMutableDictionary *)dictionary;
+
+@end
+
+/**
+ * All metrics for an entity
+ */
+@interface HLSModelEntityMetrics : NSObject {
+@public
+    HLSModelFetchMetrics *_fetchMetrics;
+    NSMutableDictionary *_templateNameToFetchMetricsMap;
+    NSUInteger _faultCount;
+    NSUInteger _saveCount;
+    NSUInteger _changedObjectCount;
+    CFTimeInterval _saveDuration;
+}
+
+- (NSDictionary *)dictionary;
+
+@end
+
+// Function declarations
+static void prepareInstrumentation(void *context);
+static void swizzleAwakeFromFetch(void *context);
+static void addChangedObjectsToCountMap(NSMutableDictionary *entityNameToCountMap, NSSet *objects);
+static void swizzled_NSManagedObject__awakeFromFetch_Imp(NSManagedObject *self, SEL _cmd);
+
+@interface HLSModelInstrumentation ()
+
+- (HLSModelEntityMetrics *)metricsForEntityName:(NSString *)entityName;
+- (void)recordFaultForEntityName:(NSString *)entityName;
+
+@end
+
+@implementation HLSModelInstrumentation
+
+#pragma mark Class methods
+
++ (HLSModelInstrumentation *)sharedInstrumentation
+{
+    static HLSModelInstrumentation *s_instance = nil;
+    
+    static dispatch_once_t s_onceToken;
+    dispatch_once_f(&s_onceToken, &s_instance, prepareInstrumentation);
+    
+    return s_instance;
+}
+
++ (void)setEnabled:(BOOL)enabled
+{
+    // Fault fires are only counted once instrumentation has been enabled, swizzle before enabling. The original method
+    // is therefore left untouched in applications which never use instrumentation
+    if (enabled) {
+        [self sharedInstrumentation];
+        
+        static dispatch_once_t s_onceToken;
+        dispatch_once_f(&s_onceToken, NULL, swizzleAwakeFromFetch);
+    }
+    s_enabled = enabled;
+}
+
++ (BOOL)isEnabled
+{
+    return s_enabled;
+}
+
+#pragma mark Object creation and destruction
+
+- (id)init
+{
+    if ((self = [super init])) {
+        _entityNameToMetricsMap = [[NSMutableDictionary alloc] init];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [_entityNameToMetricsMap release];
+    _entityNameToMetricsMap = nil;
+    
+    [super dealloc];
+}
+
+#pragma mark Recording
+
+- (HLSModelEntityMetrics *)metricsForEntityName:(NSString *)entityName
+{
+    // Must be called with the receiver locked
+    NSString *key = entityName ? entityName : @"";
+    HLSModelEntityMetrics *entityMetrics = [_entityNameToMetricsMap objectForKey:key];
+    if (! entityMetrics) {
+        entityMetrics = [[[HLSModelEntityMetrics alloc] init] autorelease];
+        [_entityNameToMetricsMap setObject:entityMetrics forKey:key];
+    }
+    return entityMetrics;
+}
+
+- (NSArray *)executeFetchRequest:(NSFetchRequest *)fetchRequest
+          inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext
+                    templateName:(NSString *)templateName
+                           error:(NSError **)pError
+{
+    if (! s_enabled) {
+        return [managedObjectContext executeFetchRequest:fetchRequest error:pError];
+    }
+    
+    intptr_t fetchDepth = (intptr_t)pthread_getspecific(s_fetchDepthKey);
+    pthread_setspecific(s_fetchDepthKey, (void *)(fetchDepth + 1));
+    
+    CFTimeInterval startTime = CFAbsoluteTimeGetCurrent();
+    NSArray *objects = [managedObjectContext executeFetchRequest:fetchRequest error:pError];
+    CFTimeInterval duration = CFAbsoluteTimeGetCurrent() - startTime;
+    
+    pthread_setspecific(s_fetchDepthKey, (void *)fetchDepth);
+    
+    NSUInteger rowCount = [objects count];
+    @synchronized(self) {
+        HLSModelEntityMetrics *entityMetrics = [self metricsForEntityName:[[fetchRequest entity] name]];
+        [entityMetrics->_fetchMetrics recordFetchWithRowCount:rowCount duration:duration];
+    
+        if (templateName) {
+            HLSModelFetchMetrics *templateMetrics = [entityMetrics->_templateNameToFetchMetricsMap objectForKey:templateName];
+            if (! templateMetrics) {
+                templateMetrics = [[[HLSModelFetchMetrics alloc] init] autorelease];
+                [entityMetrics->_templateNameToFetchMetricsMap setObject:templateMetrics forKey:templateName];
+            }
+            [templateMetrics recordFetchWithRowCount:rowCount duration:duration];
+        }
+    }
+    
+    return objects;
+}
+
+- (BOOL)saveManagedObjectContext:(NSManagedObjectContext *)managedObjectContext error:(NSError **)pError
+{
+    if (! s_enabled) {
+        return [managedObjectContext save:pError];
+    }
+    
+    NSMutableDictionary *entityNameToCountMap = [NSMutableDictionary dictionary];
+    addChangedObjectsToCountMap(entityNameToCountMap, [managedObjectContext insertedObjects]);
+    addChangedObjectsToCountMap(entityNameToCountMap, [managedObjectContext updatedObjects]);
+    addChangedObjectsToCountMap(entityNameToCountMap, [managedObjectContext deletedObjects]);
+    
+    CFTimeInterval startTime = CFAbsoluteTimeGetCurrent();
+    BOOL saved = [managedObjectContext save:pError];
+    CFTimeInterval duration = CFAbsoluteTimeGetCurrent() - startTime;
+    
+    if (saved) {
+        @synchronized(self) {
+            for (NSString *entityName in [entityNameToCountMap allKeys]) {
+                HLSModelEntityMetrics *entityMetrics = [self metricsForEntityName:entityName];
+                ++entityMetrics->_saveCount;
+                entityMetrics->_changedObjectCount += [[entityNameToCountMap objectForKey:entityName] unsignedIntegerValue];
+                entityMetrics->_saveDuration += duration;
+            }
+        }
+    }
+    
+    return saved;
+}
+
+- (void)recordFaultForEntityName:(NSString *)entityName
+{
+    // Objects materialized by a fetch are not faults being fired
+    if ((intptr_t)pthread_getspecific(s_fetchDepthKey) != 0) {
+        return;
+    }
+    
+    @synchronized(self) {
+        ++[self metricsForEntityName:entityName]->_faultCount;
+    }
+}
+
+#pragma mark Results
+
+- (NSDictionary *)snapshot
+{
+    @synchronized(self) {
+        NSMutableDictionary *snapshot = [NSMutableDictionary dictionaryWithCapacity:[_entityNameToMetricsMap count]];
+        for (NSString *entityName in [_entityNameToMetricsMap allKeys]) {
+            HLSModelEntityMetrics *entityMetrics = [_entityNameToMetricsMap objectForKey:entityName];
+            [snapshot setObject:[entityMetrics dictionary] forKey:entityName];
+        }
+        return [NSDictionary dictionaryWithDictionary:snapshot];
+    }
+}
+
+- (void)reset
+{
+    @synchronized(self) {
+        [_entityNameToMetricsMap removeAllObjects];
+    }
+}
+
+- (void)logMetrics
+{
+    NSDictionary *snapshot = [self snapshot];
+    NSArray *entityNames = [[snapshot allKeys] sortedArrayUsingSelector:@selector(compare:)];
+    for (NSString *entityName in entityNames) {
+        NSDictionary *metrics = [snapshot objectForKey:entityName];
+        NSUInteger fetchCount = [[metrics objectForKey:HLSModelMetricsFetchCountKey] unsignedIntegerValue];
+        NSUInteger rowCount = [[metrics objectForKey:HLSModelMetricsRowCountKey] unsignedIntegerValue];
+        NSUInteger faultCount = [[metrics objectForKey:HLSModelMetricsFaultCountKey] unsignedIntegerValue];
+        HLSLoggerInfo(@"Entity %@: %u fetches returning %u rows in %.1f ms (max %.1f ms); %u faults fired; %u saves "
+                      "changing %u objects in %.1f ms",
+                      entityName,
+                      fetchCount,
+                      rowCount,
+                      [[metrics objectForKey:HLSModelMetricsFetchDurationKey] doubleValue] * 1000.,
+                      [[metrics objectForKey:HLSModelMetricsMaxFetchDurationKey] doubleValue] * 1000.,
+                      faultCount,
+                      [[metrics objectForKey:HLSModelMetricsSaveCountKey] unsignedIntegerValue],
+                      [[metrics objectForKey:HLSModelMetricsChangedObjectCountKey] unsignedIntegerValue],
+                      [[metrics objectForKey:HLSModelMetricsSaveDurationKey] doubleValue] * 1000.);
+    
+        NSDictionary *templateNameToMetricsMap = [metrics objectForKey:HLSModelMetricsTemplatesKey];
+        NSArray *templateNames = [[templateNameToMetricsMap allKeys] sortedArrayUsingSelector:@selector(compare:)];
+        for (NSString *templateName in templateNames) {
+            NSDictionary *templateMetrics = [templateNameToMetricsMap objectForKey:templateName];
+            HLSLoggerInfo(@"    Template %@: %u fetches returning %u rows in %.1f ms (max %.1f ms)",
+                          templateName,
+                          [[templateMetrics objectForKey:HLSModelMetricsFetchCountKey] unsignedIntegerValue],
+                          [[templateMetrics objectForKey:HLSModelMetricsRowCountKey] unsignedIntegerValue],
+                          [[templateMetrics objectForKey:HLSModelMetricsFetchDurationKey] doubleValue] * 1000.,
+                          [[templateMetrics objectForKey:HLSModelMetricsMaxFetchDurationKey] doubleValue] * 1000.);
+        }
+    
+        // Typical of objects whose relationships are traversed one object at a time (N+1 faulting)
+        if (faultCount >= kExcessiveFaultCountThreshold && faultCount > rowCount) {
+            HLSLoggerWarn(@"Entity %@: %u faults fired for %u rows fetched. Consider prefetching relationships or batching fetches",
+                          entityName, faultCount, rowCount);
+        }
+    }
+}
+
+@end
+
+@implementation HLSModelFetchMetrics
+
+#pragma mark Recording
+
+- (void)recordFetchWithRowCount:(NSUInteger)rowCount duration:(CFTimeInterval)duration
+{
+    ++_fetchCount;
+    _rowCount += rowCount;
+    _duration += duration;
+    if (duration > _maxDuration) {
+        _maxDuration = duration;
+    }
+}
+
+#pragma mark Results
+
+- (NSMutableDictionary *)dictionary
+{
+    return [NSMutableDictionary dictionaryWithObjectsAndKeys:[NSNumber numberWithUnsignedInteger:_fetchCount], HLSModelMetricsFetchCountKey,
+            [NSNumber numberWithUnsignedInteger:_rowCount], HLSModelMetricsRowCountKey,
+            [NSNumber numberWithDouble:_duration], HLSModelMetricsFetchDurationKey,
+            [NSNumber numberWithDouble:_maxDuration], HLSModelMetricsMaxFetchDurationKey,
+            nil];
+}
+
+@end
+
+@implementation HLSModelEntityMetrics
+
+#pragma mark Object creation and destruction
+
+- (id)init
+{
+    if ((self = [super init])) {
+        _fetchMetrics = [[HLSModelFetchMetrics alloc] init];
+        _templateNameToFetchMetricsMap = [[NSMutableDictionary alloc] init];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [_fetchMetrics release];
+    _fetchMetrics = nil;
+    
+    [_templateNameToFetchMetricsMap release];
+    _templateNameToFetchMetricsMap = nil;
+    
+    [super dealloc];
+}
+
+#pragma mark Results
+
+- (NSDictionary *)dictionary
+{
+    NSMutableDictionary *templateNameToMetricsMap = [NSMutableDictionary dictionaryWithCapacity:[_templateNameToFetchMetricsMap count]];
+    for (NSString *templateName in [_templateNameToFetchMetricsMap allKeys]) {
+        HLSModelFetchMetrics *templateMetrics = [_templateNameToFetchMetricsMap objectForKey:templateName];
+        [templateNameToMetricsMap setObject:[NSDictionary dictionaryWithDictionary:[templateMetrics dictionary]] forKey:templateName];
+    }
+    
+    NSMutableDictionary *dictionary = [_fetchMetrics dictionary];
+    [dictionary setObject:[NSNumber numberWithUnsignedInteger:_faultCount] forKey:HLSModelMetricsFaultCountKey];
+    [dictionary setObject:[NSNumber numberWithUnsignedInteger:_saveCount] forKey:HLSModelMetricsSaveCountKey];
+    [dictionary setObject:[NSNumber numberWithUnsignedInteger:_changedObjectCount] forKey:HLSModelMetricsChangedObjectCountKey];
+    [dictionary setObject:[NSNumber numberWithDouble:_saveDuration] forKey:HLSModelMetricsSaveDurationKey];
+    [dictionary setObject:[NSDictionary dictionaryWithDictionary:templateNameToMetricsMap] forKey:HLSModelMetricsTemplatesKey];
+    return [NSDictionary dictionaryWithDictionary:dictionary];
+}
+
+@end
+
+#pragma mark Static functions
+
+static void prepareInstrumentation(void *context)
+{
+    HLSModelInstrumentation **pInstance = (HLSModelInstrumentation **)context;
+    *pInstance = [[HLSModelInstrumentation alloc] init];
+    
+    pthread_key_create(&s_fetchDepthKey, NULL);
+}
+
+static void swizzleAwakeFromFetch(void *context)
+{
+    // Called when the properties of an object are loaded from the store, i.e. when a fetch materializes it or when it
+    // is a fault being fired. Subclasses overriding it must call the super implementation
+    s_NSManagedObject__awakeFromFetch_Imp = (void (*)(id, SEL))HLSSwizzleSelector([NSManagedObject class],
+                                                                                  @selector(awakeFromFetch),
+                                                                                  (IMP)swizzled_NSManagedObject__awakeFromFetch_Imp);
+}
+
+static void addChangedObjectsToCountMap(NSMutableDictionary *entityNameToCountMap, NSSet *objects)
+{
+    for (NSManagedObject *object in objects) {
+        NSString *entityName = [[object entity] name];
+        NSUInteger count = [[entityNameToCountMap objectForKey:entityName] unsignedIntegerValue];
+        [entityNameToCountMap setObject:[NSNumber numberWithUnsignedInteger:count + 1] forKey:entityName];
+    }
+}
+
+static void swizzled_NSManagedObject__awakeFromFetch_Imp(NSManagedObject *self, SEL _cmd)
+{
+    (*s_NSManagedObject__awakeFromFetch_Imp)(self, _cmd);
+    
+    if (s_enabled) {
+        [[HLSModelInstrumentation sharedInstrumentation] recordFaultForEntityName:[[self entity] name]];
+    }
+}
@@ -0,0 +1,62 @@
+//
+//  HLSModelListChanges.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+/**
+ * Describes how an ordered list of managed objects (e.g. the rows of a table view) must be updated to reflect the
+ * changes of an HLSModelChangeSet. Indexes follow the usual table view batch update conventions:
+ *   - deleted and updated indexes refer to the list before the changes
+ *   - inserted indexes refer to the list after the changes
+ *   - a moved object is found in the old list at the index stored in movedFromIndexes, and in the new list at the
+ *     index stored at the same position in movedToIndexes. Moved objects may have been updated as well. Moves are
+ *     kept minimal: Objects whose relative order has not changed are never reported as moved. If moving rows is not
+ *     available (UITableView before iOS 5), apply moves as a deletion followed by an insertion
+ *
+ * You do not instantiate list changes yourself. Use -[HLSModelChangeSet listChangesForObjects:predicate:sortDescriptors:]
+ *
+ * Designated initializer: -initWithObjects:deletedIndexes:insertedIndexes:updatedIndexes:movedFromIndexes:movedToIndexes:
+ */
+@interface HLSModelListChanges : NSObject {
+@private
+    NSArray *_objects;
+    NSIndexSet *_deletedIndexes;
+    NSIndexSet *_insertedIndexes;
+    NSIndexSet *_updatedIndexes;
+    NSArray *_movedFromIndexes;
+    NSArray *_movedToIndexes;
+}
+
+/**
+ * Create list changes. The moved index arrays must contain NSNumber objects and have the same size
+ */
+- (id)initWithObjects:(NSArray *)objects
+       deletedIndexes:(NSIndexSet *)deletedIndexes
+      insertedIndexes:(NSIndexSet *)insertedIndexes
+       updatedIndexes:(NSIndexSet *)updatedIndexes
+     movedFromIndexes:(NSArray *)movedFromIndexes
+       movedToIndexes:(NSArray *)movedToIndexes;
+
+/**
+ * The list of objects after the changes have been applied
+ */
+@property (nonatomic, readonly, retain) NSArray *objects;
+
+/**
+ * Index changes
+ */
+@property (nonatomic, readonly, retain) NSIndexSet *deletedIndexes;
+@property (nonatomic, readonly, retain) NSIndexSet *insertedIndexes;
+@property (nonatomic, readonly, retain) NSIndexSet *updatedIndexes;
+@property (nonatomic, readonly, retain) NSArray *movedFromIndexes;
+@property (nonatomic, readonly, retain) NSArray *movedToIndexes;
+
+/**
+ * Return NO iff the list is not affected at all
+ */
+- (BOOL)hasChanges;
+
+@end
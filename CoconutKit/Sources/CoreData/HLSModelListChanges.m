@@ -0,0 +1,105 @@
+//
+//  HLSModelListChanges.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSModelListChanges.h"
+
+#import "HLSAssert.h"
+#import "HLSLogger.h"
+
+@interface HLSModelListChanges ()
+
+@property (nonatomic, retain) NSArray *objects;
+@property (nonatomic, retain) NSIndexSet *deletedIndexes;
+@property (nonatomic, retain) NSIndexSet *insertedIndexes;
+@property (nonatomic, retain) NSIndexSet *updatedIndexes;
+@property (nonatomic, retain) NSArray *movedFromIndexes;
+@property (nonatomic, retain) NSArray *movedToIndexes;
+
+@end
+
+@implementation HLSModelListChanges
+
+#pragma mark Object creation and destruction
+
+- (id)initWithObjects:(NSArray *)objects
+       deletedIndexes:(NSIndexSet *)deletedIndexes
+      insertedIndexes:(NSIndexSet *)insertedIndexes
+       updatedIndexes:(NSIndexSet *)updatedIndexes
+     movedFromIndexes:(NSArray *)movedFromIndexes
+       movedToIndexes:(NSArray *)movedToIndexes
+{
+    if ((self = [super init])) {
+        if ([movedFromIndexes count] != [movedToIndexes count]) {
+            HLSLoggerError(@"The moved index arrays must have the same size");
+            [self release];
+            return nil;
+        }
+
+        self.objects = objects ? objects : [NSArray array];
+        self.deletedIndexes = deletedIndexes ? deletedIndexes : [NSIndexSet indexSet];
+        self.insertedIndexes = insertedIndexes ? insertedIndexes : [NSIndexSet indexSet];
+        self.updatedIndexes = updatedIndexes ? updatedIndexes : [NSIndexSet indexSet];
+        self.movedFromIndexes = movedFromIndexes ? movedFromIndexes : [NSArray array];
+        self.movedToIndexes = movedToIndexes ? movedToIndexes : [NSArray array];
+    }
+    return self;
+}
+
+- (id)init
+{
+    HLSForbiddenInheritedMethod();
+    return nil;
+}
+
+- (void)dealloc
+{
+    self.objects = nil;
+    self.deletedIndexes = nil;
+    self.insertedIndexes = nil;
+    self.updatedIndexes = nil;
+    self.movedFromIndexes = nil;
+    self.movedToIndexes = nil;
+
+    [super dealloc];
+}
+
+#pragma mark Accessors and mutators
+
+@synthesize objects = _objects;
+
+@synthesize deletedIndexes = _deletedIndexes;
+
+@synthesize insertedIndexes = _insertedIndexes;
+
+@synthesize updatedIndexes = _updatedIndexes;
+
+@synthesize movedFromIndexes = _movedFromIndexes;
+
+@synthesize movedToIndexes = _movedToIndexes;
+
+- (BOOL)hasChanges
+{
+    return [self.deletedIndexes count] != 0 || [self.insertedIndexes count] != 0 || [self.updatedIndexes count] != 0
+        || [self.movedFromIndexes count] != 0;
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; deletedIndexes: %@; insertedIndexes: %@; updatedIndexes: %@; movedFromIndexes: %@; movedToIndexes: %@>",
+            [self class],
+            self,
+            self.deletedIndexes,
+            self.insertedIndexes,
+            self.updatedIndexes,
+            self.movedFromIndexes,
+            self.movedToIndexes];
+}
+
+@end
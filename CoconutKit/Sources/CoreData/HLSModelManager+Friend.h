@@ -0,0 +1,31 @@
+//
+//  HLSModelManager+Friend.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+/**
+ * Interface meant to be used by friend classes of HLSModelManager (= classes which must have access to private 
+ * implementation details)
+ */
+@interface HLSModelManager (Friend)
+
+/**
+ * Create the persistent store coordinator for a model, opening (and migrating if needed) its store. Can be called
+ * from any thread. Return nil on failure
+ */
++ (NSPersistentStoreCoordinator *)persistentStoreCoordinatorWithModelFileName:(NSString *)modelFileName
+                                                                     inBundle:(NSBundle *)bundle
+                                                                    storeType:(NSString *)storeType
+                                                                configuration:(NSString *)configuration
+                                                               storeDirectory:(NSString *)storeDirectory
+                                                                      options:(NSDictionary *)options;
+
+/**
+ * Create a model manager for an existing persistent store coordinator. The context is created on the calling thread
+ */
+- (id)initWithPersistentStoreCoordinator:(NSPersistentStoreCoordinator *)persistentStoreCoordinator;
+
+@end
@@ -6,6 +6,29 @@
 //  Copyright 2011 Hortis. All rights reserved.
 //
 
+/**
+ * Notification posted on the main thread when a model manager publishing change sets has received saved changes
+ * (see publishingChangeSets property). The user info dictionary contains the change sets, as a dictionary mapping
+ * entity names to HLSModelChangeSet objects, under the HLSModelManagerChangeSetsKey key
+ */
+extern NSString * const HLSModelManagerDidChangeNotification;
+extern NSString * const HLSModelManagerChangeSetsKey;
+
+/**
+ * Keys of the per-entity metrics dictionaries returned by +instrumentationSnapshot. Values are NSNumber objects
+ * (durations are in seconds), except for HLSModelMetricsTemplatesKey, which maps the names of the fetch templates
+ * used with the entity (see NSManagedObject+HLSExtensions) to dictionaries containing the fetch metrics keys only
+ */
+extern NSString * const HLSModelMetricsFetchCountKey;                   // Number of fetches
+extern NSString * const HLSModelMetricsRowCountKey;                     // Total number of objects fetched
+extern NSString * const HLSModelMetricsFetchDurationKey;                // Total fetch duration
+extern NSString * const HLSModelMetricsMaxFetchDurationKey;             // Longest fetch duration
+extern NSString * const HLSModelMetricsFaultCountKey;                   // Number of faults fired outside fetches
+extern NSString * const HLSModelMetricsSaveCountKey;                    // Number of saves containing changes
+extern NSString * const HLSModelMetricsChangedObjectCountKey;           // Total number of objects changed by saves
+extern NSString * const HLSModelMetricsSaveDurationKey;                 // Total duration of the saves
+extern NSString * const HLSModelMetricsTemplatesKey;                    // Per-template fetch metrics
+
 // Standard option combinations
 #define HLSModelManagerLightweightMigrationOptions          [NSDictionary dictionaryWithObjectsAndKeys:[NSNumber numberWithBool:YES], NSMigratePersistentStoresAutomaticallyOption,   \
                                                                                                        [NSNumber numberWithBool:YES], NSInferMappingModelAutomaticallyOption,         \
@@ -40,6 +63,10 @@
  *   - go on working with the previously pushed model manager
  *   - if you need to perform database operations on another thread, duplicate the current context and push 
  *     the new instance onto the other thread model manager stack
+ *   - if you need to import data on another thread while the main thread keeps working with its model manager,
+ *     create a background duplicate of the main thread model manager (by calling -backgroundDuplicate) and push 
+ *     it onto the other thread model manager stack. Each time its context is saved, changes are automatically 
+ *     merged into the main thread context
  *
  * Designated initializer: -initWithModelFileName:storeType:configuration:storeDirectory:options:
  */
@@ -48,6 +75,10 @@
     NSManagedObjectModel *_managedObjectModel;
     NSPersistentStoreCoordinator *_persistentStoreCoordinator;
     NSManagedObjectContext *_managedObjectContext;
+    NSManagedObjectContext *_mergeTargetManagedObjectContext;
+    BOOL _publishingChangeSets;
+    NSMutableDictionary *_pendingChangeSets;
+    BOOL _readOnly;
 }
 
 /**
@@ -127,6 +158,22 @@
 + (void)rollbackCurrentModelContext;
 + (void)deleteObjectFromCurrentModelContext:(NSManagedObject *)managedObject;
 
+/**
+ * Core Data instrumentation, disabled by default. When enabled, fetches made using NSManagedObject+HLSExtensions
+ * methods, saves made using +saveCurrentModelContext:, as well as faults fired on any thread, are recorded per entity.
+ * Instrumentation has a small cost and is meant to be enabled while investigating performance issues (e.g. excessive
+ * faulting caused by traversing relationships one object at a time)
+ *
+ * +instrumentationSnapshot returns the metrics collected so far as a dictionary mapping entity names to metrics
+ * dictionaries (see HLSModelMetrics keys above). +logInstrumentation logs them using HLSLogger, with a warning for
+ * entities whose faults are fired in large numbers
+ */
++ (void)setInstrumentationEnabled:(BOOL)instrumentationEnabled;
++ (BOOL)isInstrumentationEnabled;
++ (NSDictionary *)instrumentationSnapshot;
++ (void)resetInstrumentation;
++ (void)logInstrumentation;
+
 /**
  * Create a model manager using the model file given as parameter (lookup is performed in the specified bundle,
  * or in the main bundle if nil), and saving it in the specified directory. 
@@ -140,6 +187,9 @@
  *
  * Convenience constructors have been provided for easy instantiation of the most common store types and are the
  * preferred way of instantiating model managers.
+ *
+ * The store is opened (and migrated if needed) on the calling thread. If this might take long, use an 
+ * HLSModelManagerOpeningTask to open the store on another thread instead
  */
 - (id)initWithModelFileName:(NSString *)modelFileName
                    inBundle:(NSBundle *)bundle
@@ -152,6 +202,28 @@
  */
 - (HLSModelManager *)duplicate;
 
+/**
+ * Duplicate an existing manager whose context must be used from the main thread. The duplicate shares the same 
+ * persistent store coordinator (no additional store is opened) and is meant to be used on another thread, e.g. for
+ * bulk imports. Each time the duplicate context is saved, changes are merged into the context of the receiver on the 
+ * main thread, so that objects it has loaded are refreshed
+ */
+- (HLSModelManager *)backgroundDuplicate;
+
+/**
+ * Duplicate an existing manager for reading only. The duplicate shares the same persistent store coordinator (and 
+ * therefore its row cache), and its context has no undo manager. It must be created and used on the thread it is
+ * meant for, e.g. by a worker reading the store while the main thread keeps working with its own context. Saving its
+ * context using +saveCurrentModelContext: fails. HLSModelQueryTask uses such duplicates to query a store on task 
+ * manager threads
+ */
+- (HLSModelManager *)readOnlyDuplicate;
+
+/**
+ * Migrate the store of the receiver to a new location and / or store type. The whole store is migrated at once on the
+ * calling thread, and the receiver uses the new store afterwards. For large stores, use an HLSModelMigrationTask instead,
+ * which copies the store in batches on another thread, reports progress and can be cancelled
+ */
 - (BOOL)migrateStoreToURL:(NSURL *)url withStoreType:(NSString *)storeType error:(NSError **)pError;
 
 /**
@@ -161,4 +233,22 @@
 @property (nonatomic, readonly, retain) NSPersistentStoreCoordinator *persistentStoreCoordinator;
 @property (nonatomic, readonly, retain) NSManagedObjectContext *managedObjectContext;
 
+/**
+ * Return YES iff the model manager has been created using -readOnlyDuplicate
+ */
+@property (nonatomic, readonly, assign, getter=isReadOnly) BOOL readOnly;
+
+/**
+ * If set to YES, the receiver tracks the changes saved by all contexts sharing its persistent store coordinator (i.e.
+ * by its context, by its duplicates and by its background duplicates), and publishes them as coalesced per-entity
+ * change sets (see HLSModelManagerDidChangeNotification and HLSModelChangeSet). Changes saved during the same run 
+ * loop iteration are published at once. Lists displaying objects can then apply minimal updates instead of fetching 
+ * and reloading everything
+ *
+ * Change sets are meant to be used with model managers whose context is used on the main thread
+ *
+ * Default value is NO
+ */
+@property (nonatomic, assign, getter=isPublishingChangeSets) BOOL publishingChangeSets;
+
 @end
@@ -11,7 +11,33 @@
 #import "HLSError.h"
 #import "HLSFileManager.h"
 #import "HLSLogger.h"
+#import "HLSModelChangeSet.h"
+#import "HLSModelChangeSet+Friend.h"
+#import "HLSModelInstrumentation.h"
+#import "HLSModelManager+Friend.h"
 #import "NSArray+HLSExtensions.h"
+#import <pthread.h>
+
+NSString * const HLSModelManagerDidChangeNotification = @"HLSModelManagerDidChangeNotification";
+NSString * const HLSModelManagerChangeSetsKey = @"HLSModelManagerChangeSets";
+
+NSString * const HLSModelMetricsFetchCountKey = @"HLSModelMetricsFetchCount";
+NSString * const HLSModelMetricsRowCountKey = @"HLSModelMetricsRowCount";
+NSString * const HLSModelMetricsFetchDurationKey = @"HLSModelMetricsFetchDuration";
+NSString * const HLSModelMetricsMaxFetchDurationKey = @"HLSModelMetricsMaxFetchDuration";
+NSString * const HLSModelMetricsFaultCountKey = @"HLSModelMetricsFaultCount";
+NSString * const HLSModelMetricsSaveCountKey = @"HLSModelMetricsSaveCount";
+NSString * const HLSModelMetricsChangedObjectCountKey = @"HLSModelMetricsChangedObjectCount";
+NSString * const HLSModelMetricsSaveDurationKey = @"HLSModelMetricsSaveDuration";
+NSString * const HLSModelMetricsTemplatesKey = @"HLSModelMetricsTemplates";
+
+// Thread-local slot caching the model manager stack of the current thread (not retained, the stack is owned by the 
+// thread dictionary)
+static pthread_key_t s_modelManagerStackKey;
+
+// Function declarations
+static void createModelManagerStackKey(void *context);
+static void addObjectIDsToChangesMap(NSMutableDictionary *entityNameToChangesMap, NSSet *objects, NSUInteger changeIndex);
 
 @interface HLSModelManager ()
 
@@ -20,21 +46,31 @@
                                      storeDirectory:(NSString *)storeDirectory;
 
 + (NSMutableArray *)modelManagerStackForThread:(NSThread *)thread;
++ (NSMutableArray *)modelManagerStackForCurrentThread;
 + (HLSModelManager *)currentModelManagerForThread:(NSThread *)thread;
 + (HLSModelManager *)rootModelManagerForThread:(NSThread *)thread;
 
 @property (nonatomic, retain) NSManagedObjectModel *managedObjectModel;
 @property (nonatomic, retain) NSPersistentStoreCoordinator *persistentStoreCoordinator;
 @property (nonatomic, retain) NSManagedObjectContext *managedObjectContext;
+@property (nonatomic, retain) NSManagedObjectContext *mergeTargetManagedObjectContext;
+@property (nonatomic, retain) NSMutableDictionary *pendingChangeSets;
+@property (nonatomic, assign, getter=isReadOnly) BOOL readOnly;
 
-- (NSManagedObjectModel *)managedObjectModelFromModelFileName:(NSString *)modelFileName inBundle:(NSBundle *)bundle;
-- (NSPersistentStoreCoordinator *)persistentStoreCoordinatorForManagedObjectModel:(NSManagedObjectModel *)managedObjectModel
++ (NSManagedObjectModel *)managedObjectModelFromModelFileName:(NSString *)modelFileName inBundle:(NSBundle *)bundle;
++ (NSPersistentStoreCoordinator *)persistentStoreCoordinatorForManagedObjectModel:(NSManagedObjectModel *)managedObjectModel
                                                                         storeType:(NSString *)storeType 
                                                                     configuration:(NSString *)configuration 
                                                                               URL:(NSURL *)storeURL 
                                                                           options:(NSDictionary *)options;
 - (NSManagedObjectContext *)managedObjectContextForPersistentStoreCoordinator:(NSPersistentStoreCoordinator *)persistentStoreCoordinator;
 
+- (void)managedObjectContextDidSave:(NSNotification *)notification;
+- (void)anyManagedObjectContextDidSave:(NSNotification *)notification;
+
+- (void)accumulateChanges:(NSDictionary *)entityNameToChangesMap;
+- (void)publishChangeSets;
+
 @end
 
 @implementation HLSModelManager
@@ -132,13 +168,13 @@
         return;
     }
     
-    NSMutableArray *modelManagerStack = [self modelManagerStackForThread:[NSThread currentThread]];
+    NSMutableArray *modelManagerStack = [self modelManagerStackForCurrentThread];
     [modelManagerStack addObject:modelManager];
 }
 
 + (void)popModelManager
 {
-    NSMutableArray *modelManagerStack = [self modelManagerStackForThread:[NSThread currentThread]];
+    NSMutableArray *modelManagerStack = [self modelManagerStackForCurrentThread];
     if ([modelManagerStack count] == 0) {
         HLSLoggerInfo(@"No model manager to pop");
         return;
@@ -159,9 +195,24 @@
     return modelManagerStack;
 }
 
+// The current model manager is needed by all context-free methods, e.g. for each object inserted using +insert. Avoid 
+// retrieving the current thread and looking up its dictionary each time by caching the stack in a thread-local slot
++ (NSMutableArray *)modelManagerStackForCurrentThread
+{
+    static dispatch_once_t s_onceToken;
+    dispatch_once_f(&s_onceToken, NULL, createModelManagerStackKey);
+    
+    NSMutableArray *modelManagerStack = (NSMutableArray *)pthread_getspecific(s_modelManagerStackKey);
+    if (! modelManagerStack) {
+        modelManagerStack = [self modelManagerStackForThread:[NSThread currentThread]];
+        pthread_setspecific(s_modelManagerStackKey, modelManagerStack);
+    }
+    return modelManagerStack;
+}
+
 + (HLSModelManager *)currentModelManager
 {
-    return [self currentModelManagerForThread:[NSThread currentThread]];
+    return [[self modelManagerStackForCurrentThread] lastObject];
 }
 
 + (HLSModelManager *)currentModelManagerForMainThread
@@ -177,7 +228,7 @@
 
 + (HLSModelManager *)rootModelManager
 {
-    return [self rootModelManagerForThread:[NSThread currentThread]];
+    return [[self modelManagerStackForCurrentThread] firstObject_hls];
 }
 
 + (HLSModelManager *)rootModelManagerForMainThread
@@ -208,7 +259,20 @@
         return NO;
     }
     
-    return [currentModelContext save:pError];
+    if ([self currentModelManager].readOnly) {
+        if (pError) {
+            *pError = [HLSError errorWithDomain:NSCocoaErrorDomain
+                                           code:NSCoreDataError];
+        }
+        HLSLoggerError(@"The current context is read-only");
+        return NO;
+    }
+    
+    if (! [HLSModelInstrumentation isEnabled]) {
+        return [currentModelContext save:pError];
+    }
+    
+    return [[HLSModelInstrumentation sharedInstrumentation] saveManagedObjectContext:currentModelContext error:pError];
 }
 
 + (void)rollbackCurrentModelContext
@@ -233,6 +297,31 @@
     [currentModelContext deleteObject:managedObject];
 }
 
++ (void)setInstrumentationEnabled:(BOOL)instrumentationEnabled
+{
+    [HLSModelInstrumentation setEnabled:instrumentationEnabled];
+}
+
++ (BOOL)isInstrumentationEnabled
+{
+    return [HLSModelInstrumentation isEnabled];
+}
+
++ (NSDictionary *)instrumentationSnapshot
+{
+    return [[HLSModelInstrumentation sharedInstrumentation] snapshot];
+}
+
++ (void)resetInstrumentation
+{
+    [[HLSModelInstrumentation sharedInstrumentation] reset];
+}
+
++ (void)logInstrumentation
+{
+    [[HLSModelInstrumentation sharedInstrumentation] logMetrics];
+}
+
 #pragma mark Object creation and destruction
 
 - (id)initWithModelFileName:(NSString *)modelFileName
@@ -243,28 +332,17 @@
                     options:(NSDictionary *)options
 {
     if ((self = [super init])) {
-        self.managedObjectModel = [self managedObjectModelFromModelFileName:modelFileName inBundle:bundle];
-        if (! self.managedObjectModel) {
-            [self release];
-            return nil;
-        }
-        
-        NSURL *standardStoreURL = nil;
-        if (storeDirectory) {
-            NSString *standardStoreFilePath = [HLSModelManager standardStoreFilePathForModelFileName:modelFileName
-                                                                                           storeType:storeType
-                                                                                      storeDirectory:storeDirectory];
-            standardStoreURL = [NSURL fileURLWithPath:standardStoreFilePath];            
-        }
-        self.persistentStoreCoordinator = [self persistentStoreCoordinatorForManagedObjectModel:self.managedObjectModel 
-                                                                                      storeType:storeType 
-                                                                                  configuration:configuration
-                                                                                            URL:standardStoreURL
-                                                                                        options:options];
+        self.persistentStoreCoordinator = [HLSModelManager persistentStoreCoordinatorWithModelFileName:modelFileName
+                                                                                              inBundle:bundle
+                                                                                             storeType:storeType
+                                                                                         configuration:configuration
+                                                                                        storeDirectory:storeDirectory
+                                                                                               options:options];
         if (! self.persistentStoreCoordinator) {
             [self release];
             return nil;
         }
+        self.managedObjectModel = [self.persistentStoreCoordinator managedObjectModel];
         
         self.managedObjectContext = [self managedObjectContextForPersistentStoreCoordinator:self.persistentStoreCoordinator];
         if (! self.managedObjectContext) {
@@ -275,11 +353,41 @@
     return self;
 }
 
+- (id)initWithPersistentStoreCoordinator:(NSPersistentStoreCoordinator *)persistentStoreCoordinator
+{
+    if ((self = [super init])) {
+        if (! persistentStoreCoordinator) {
+            HLSLoggerError(@"Missing persistent store coordinator");
+            [self release];
+            return nil;
+        }
+        
+        self.persistentStoreCoordinator = persistentStoreCoordinator;
+        self.managedObjectModel = [persistentStoreCoordinator managedObjectModel];
+        self.managedObjectContext = [self managedObjectContextForPersistentStoreCoordinator:persistentStoreCoordinator];
+    }
+    return self;
+}
+
 - (void)dealloc
 {
+    if (self.mergeTargetManagedObjectContext) {
+        [[NSNotificationCenter defaultCenter] removeObserver:self
+                                                        name:NSManagedObjectContextDidSaveNotification
+                                                      object:self.managedObjectContext];
+    }
+    
+    if (self.publishingChangeSets) {
+        [[NSNotificationCenter defaultCenter] removeObserver:self
+                                                        name:NSManagedObjectContextDidSaveNotification
+                                                      object:nil];
+    }
+    self.pendingChangeSets = nil;
+    
     self.managedObjectModel = nil;
     self.persistentStoreCoordinator = nil;
     self.managedObjectContext = nil;
+    self.mergeTargetManagedObjectContext = nil;
     
     [super dealloc];
 }
@@ -292,9 +400,67 @@
 
 @synthesize managedObjectContext = _managedObjectContext;
 
+@synthesize mergeTargetManagedObjectContext = _mergeTargetManagedObjectContext;
+
+@synthesize publishingChangeSets = _publishingChangeSets;
+
+- (void)setPublishingChangeSets:(BOOL)publishingChangeSets
+{
+    if (_publishingChangeSets == publishingChangeSets) {
+        return;
+    }
+    
+    _publishingChangeSets = publishingChangeSets;
+    
+    // Saves made by any context must be observed, since duplicates can be created at any time
+    if (publishingChangeSets) {
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(anyManagedObjectContextDidSave:)
+                                                     name:NSManagedObjectContextDidSaveNotification
+                                                   object:nil];
+    }
+    else {
+        [[NSNotificationCenter defaultCenter] removeObserver:self
+                                                        name:NSManagedObjectContextDidSaveNotification
+                                                      object:nil];
+        [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(publishChangeSets) object:nil];
+        self.pendingChangeSets = nil;
+    }
+}
+
+@synthesize pendingChangeSets = _pendingChangeSets;
+
+@synthesize readOnly = _readOnly;
+
 #pragma mark Initialization
 
-- (NSManagedObjectModel *)managedObjectModelFromModelFileName:(NSString *)modelFileName inBundle:(NSBundle *)bundle
++ (NSPersistentStoreCoordinator *)persistentStoreCoordinatorWithModelFileName:(NSString *)modelFileName
+                                                                     inBundle:(NSBundle *)bundle
+                                                                    storeType:(NSString *)storeType
+                                                                configuration:(NSString *)configuration
+                                                               storeDirectory:(NSString *)storeDirectory
+                                                                      options:(NSDictionary *)options
+{
+    NSManagedObjectModel *managedObjectModel = [self managedObjectModelFromModelFileName:modelFileName inBundle:bundle];
+    if (! managedObjectModel) {
+        return nil;
+    }
+    
+    NSURL *standardStoreURL = nil;
+    if (storeDirectory) {
+        NSString *standardStoreFilePath = [HLSModelManager standardStoreFilePathForModelFileName:modelFileName
+                                                                                       storeType:storeType
+                                                                                  storeDirectory:storeDirectory];
+        standardStoreURL = [NSURL fileURLWithPath:standardStoreFilePath];            
+    }
+    return [self persistentStoreCoordinatorForManagedObjectModel:managedObjectModel 
+                                                       storeType:storeType 
+                                                   configuration:configuration
+                                                             URL:standardStoreURL
+                                                         options:options];
+}
+
++ (NSManagedObjectModel *)managedObjectModelFromModelFileName:(NSString *)modelFileName inBundle:(NSBundle *)bundle
 {
     if (! bundle) {
         bundle = [NSBundle mainBundle];
@@ -310,7 +476,7 @@
     return [[[NSManagedObjectModel alloc] initWithContentsOfURL:modelFileURL] autorelease];
 }
 
-- (NSPersistentStoreCoordinator *)persistentStoreCoordinatorForManagedObjectModel:(NSManagedObjectModel *)managedObjectModel
++ (NSPersistentStoreCoordinator *)persistentStoreCoordinatorForManagedObjectModel:(NSManagedObjectModel *)managedObjectModel
                                                                         storeType:(NSString *)storeType 
                                                                     configuration:(NSString *)configuration 
                                                                               URL:(NSURL *)storeURL 
@@ -367,10 +533,132 @@
     return modelManager;
 }
 
+- (HLSModelManager *)backgroundDuplicate
+{
+    HLSModelManager *modelManager = [self duplicate];
+    
+    // Contexts sharing a coordinator do not see each other's saved changes for objects they have already loaded. Merge 
+    // saves into the receiver context, on the main thread where it must be used
+    modelManager.mergeTargetManagedObjectContext = self.managedObjectContext;
+    [[NSNotificationCenter defaultCenter] addObserver:modelManager
+                                             selector:@selector(managedObjectContextDidSave:)
+                                                 name:NSManagedObjectContextDidSaveNotification
+                                               object:modelManager.managedObjectContext];
+    
+    return modelManager;
+}
+
+- (HLSModelManager *)readOnlyDuplicate
+{
+    HLSModelManager *modelManager = [self duplicate];
+    modelManager.readOnly = YES;
+    
+    // No changes are ever made. Fetched rows are served from the coordinator row cache when possible
+    [modelManager.managedObjectContext setUndoManager:nil];
+    
+    return modelManager;
+}
+
 - (BOOL)migrateStoreToURL:(NSURL *)url withStoreType:(NSString *)storeType error:(NSError **)pError
 {
     NSPersistentStore *persistentStore = [[self.persistentStoreCoordinator persistentStores] firstObject_hls];
     return [self.persistentStoreCoordinator migratePersistentStore:persistentStore toURL:url options:nil withType:storeType error:pError] != nil;
 }
 
+#pragma mark Notification callbacks
+
+- (void)managedObjectContextDidSave:(NSNotification *)notification
+{
+    // Received on the thread where the duplicate context was saved. The notification and the target context are retained
+    // until the merge has been performed
+    [self.mergeTargetManagedObjectContext performSelectorOnMainThread:@selector(mergeChangesFromContextDidSaveNotification:)
+                                                           withObject:notification
+                                                        waitUntilDone:NO];
+}
+
+// Received on the thread where the context was saved
+- (void)anyManagedObjectContextDidSave:(NSNotification *)notification
+{
+    NSManagedObjectContext *managedObjectContext = [notification object];
+    if ([managedObjectContext persistentStoreCoordinator] != self.persistentStoreCoordinator) {
+        return;
+    }
+    
+    // Objects must not be accessed outside the thread of their context. Only extract their IDs here
+    NSMutableDictionary *entityNameToChangesMap = [NSMutableDictionary dictionary];
+    NSDictionary *userInfo = [notification userInfo];
+    addObjectIDsToChangesMap(entityNameToChangesMap, [userInfo objectForKey:NSInsertedObjectsKey], 0);
+    addObjectIDsToChangesMap(entityNameToChangesMap, [userInfo objectForKey:NSUpdatedObjectsKey], 1);
+    addObjectIDsToChangesMap(entityNameToChangesMap, [userInfo objectForKey:NSDeletedObjectsKey], 2);
+    if ([entityNameToChangesMap count] == 0) {
+        return;
+    }
+    
+    [self performSelectorOnMainThread:@selector(accumulateChanges:) withObject:entityNameToChangesMap waitUntilDone:NO];
+}
+
+#pragma mark Change sets
+
+- (void)accumulateChanges:(NSDictionary *)entityNameToChangesMap
+{
+    if (! self.publishingChangeSets) {
+        return;
+    }
+    
+    if (! self.pendingChangeSets) {
+        self.pendingChangeSets = [NSMutableDictionary dictionary];
+    }
+    
+    for (NSString *entityName in [entityNameToChangesMap allKeys]) {
+        HLSModelChangeSet *changeSet = [self.pendingChangeSets objectForKey:entityName];
+        if (! changeSet) {
+            changeSet = [[[HLSModelChangeSet alloc] initWithEntityName:entityName] autorelease];
+            [self.pendingChangeSets setObject:changeSet forKey:entityName];
+        }
+        
+        NSArray *changes = [entityNameToChangesMap objectForKey:entityName];
+        [changeSet addInsertedObjectIDs:[changes objectAtIndex:0]
+                       updatedObjectIDs:[changes objectAtIndex:1]
+                       deletedObjectIDs:[changes objectAtIndex:2]];
+    }
+    
+    // Coalesce all changes received during the current run loop iteration
+    [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(publishChangeSets) object:nil];
+    [self performSelector:@selector(publishChangeSets) withObject:nil afterDelay:0.];
+}
+
+- (void)publishChangeSets
+{
+    NSDictionary *changeSets = [NSDictionary dictionaryWithDictionary:self.pendingChangeSets];
+    self.pendingChangeSets = nil;
+    if ([changeSets count] == 0) {
+        return;
+    }
+    
+    [[NSNotificationCenter defaultCenter] postNotificationName:HLSModelManagerDidChangeNotification
+                                                        object:self
+                                                      userInfo:[NSDictionary dictionaryWithObject:changeSets forKey:HLSModelManagerChangeSetsKey]];
+}
+
 @end
+
+#pragma mark Static functions
+
+static void createModelManagerStackKey(void *context)
+{
+    pthread_key_create(&s_modelManagerStackKey, NULL);
+}
+
+// Changes are stored as arrays of three sets (inserted, updated and deleted object IDs), keyed by entity name
+static void addObjectIDsToChangesMap(NSMutableDictionary *entityNameToChangesMap, NSSet *objects, NSUInteger changeIndex)
+{
+    for (NSManagedObject *object in objects) {
+        NSString *entityName = [[object entity] name];
+        NSArray *changes = [entityNameToChangesMap objectForKey:entityName];
+        if (! changes) {
+            changes = [NSArray arrayWithObjects:[NSMutableSet set], [NSMutableSet set], [NSMutableSet set], nil];
+            [entityNameToChangesMap setObject:changes forKey:entityName];
+        }
+        [[changes objectAtIndex:changeIndex] addObject:[object objectID]];
+    }
+}
@@ -0,0 +1,20 @@
+//
+//  HLSModelManagerOpeningTask+Friend.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+/**
+ * Interface meant to be used by friend classes of HLSModelManagerOpeningTask (= classes which must have access to 
+ * private implementation details)
+ */
+@interface HLSModelManagerOpeningTask (Friend)
+
+/**
+ * The coordinator of the opened store, set by the operation
+ */
+@property (nonatomic, retain) NSPersistentStoreCoordinator *persistentStoreCoordinator;
+
+@end
@@ -0,0 +1,60 @@
+//
+//  HLSModelManagerOpeningTask.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSModelManager.h"
+#import "HLSTask.h"
+
+/**
+ * A task opening the store of a model manager on a thread of the task manager it is submitted to. If migration options
+ * are provided (e.g. HLSModelManagerLightweightMigrationOptions), store migration is performed on this thread as well.
+ * Use this task instead of the model manager creation methods if opening the store might take long, so that the
+ * main thread stays responsive (e.g. to display some UI while the store is being migrated), and get the model manager 
+ * when the task has been processed
+ *
+ * Core Data does not report migration progress. Progress is therefore only updated once the store has been opened
+ *
+ * Designated initializer: -initWithModelFileName:inBundle:storeType:configuration:storeDirectory:options:
+ */
+@interface HLSModelManagerOpeningTask : HLSTask {
+@private
+    NSString *_modelFileName;
+    NSBundle *_bundle;
+    NSString *_storeType;
+    NSString *_configuration;
+    NSString *_storeDirectory;
+    NSDictionary *_options;
+    NSPersistentStoreCoordinator *_persistentStoreCoordinator;
+    HLSModelManager *_modelManager;
+}
+
+/**
+ * Create a task opening a store. Parameters have the same meaning as for the model manager initializer (see
+ * HLSModelManager.h)
+ */
+- (id)initWithModelFileName:(NSString *)modelFileName
+                   inBundle:(NSBundle *)bundle
+                  storeType:(NSString *)storeType 
+              configuration:(NSString *)configuration 
+             storeDirectory:(NSString *)storeDirectory
+                    options:(NSDictionary *)options;
+
+@property (nonatomic, readonly, retain) NSString *modelFileName;
+@property (nonatomic, readonly, retain) NSBundle *bundle;
+@property (nonatomic, readonly, retain) NSString *storeType;
+@property (nonatomic, readonly, retain) NSString *configuration;
+@property (nonatomic, readonly, retain) NSString *storeDirectory;
+@property (nonatomic, readonly, retain) NSDictionary *options;
+
+/**
+ * The model manager for the opened store, nil if the task has not been successfully processed. Its context is 
+ * created on the thread calling this accessor for the first time, usually the main thread when the task delegate 
+ * is notified that the task has been processed
+ */
+@property (nonatomic, readonly, retain) HLSModelManager *modelManager;
+
+@end
@@ -0,0 +1,104 @@
+//
+//  HLSModelManagerOpeningTask.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSModelManagerOpeningTask.h"
+
+#import "HLSAssert.h"
+#import "HLSModelManager+Friend.h"
+#import "HLSModelManagerOpeningTaskOperation.h"
+
+@interface HLSModelManagerOpeningTask ()
+
+@property (nonatomic, retain) NSString *modelFileName;
+@property (nonatomic, retain) NSBundle *bundle;
+@property (nonatomic, retain) NSString *storeType;
+@property (nonatomic, retain) NSString *configuration;
+@property (nonatomic, retain) NSString *storeDirectory;
+@property (nonatomic, retain) NSDictionary *options;
+@property (nonatomic, retain) NSPersistentStoreCoordinator *persistentStoreCoordinator;
+@property (nonatomic, retain) HLSModelManager *modelManager;
+
+@end
+
+@implementation HLSModelManagerOpeningTask
+
+#pragma mark -
+#pragma mark Object creation and destruction
+
+- (id)initWithModelFileName:(NSString *)modelFileName
+                   inBundle:(NSBundle *)bundle
+                  storeType:(NSString *)storeType 
+              configuration:(NSString *)configuration 
+             storeDirectory:(NSString *)storeDirectory
+                    options:(NSDictionary *)options
+{
+    if ((self = [super init])) {
+        self.modelFileName = modelFileName;
+        self.bundle = bundle;
+        self.storeType = storeType;
+        self.configuration = configuration;
+        self.storeDirectory = storeDirectory;
+        self.options = options;
+    }
+    return self;
+}
+
+- (id)init
+{
+    HLSForbiddenInheritedMethod();
+    return nil;
+}
+
+- (void)dealloc
+{
+    self.modelFileName = nil;
+    self.bundle = nil;
+    self.storeType = nil;
+    self.configuration = nil;
+    self.storeDirectory = nil;
+    self.options = nil;
+    self.persistentStoreCoordinator = nil;
+    self.modelManager = nil;
+    
+    [super dealloc];
+}
+
+#pragma mark -
+#pragma mark Accessors and mutators
+
+- (Class)operationClass
+{
+    return [HLSModelManagerOpeningTaskOperation class];
+}
+
+@synthesize modelFileName = _modelFileName;
+
+@synthesize bundle = _bundle;
+
+@synthesize storeType = _storeType;
+
+@synthesize configuration = _configuration;
+
+@synthesize storeDirectory = _storeDirectory;
+
+@synthesize options = _options;
+
+@synthesize persistentStoreCoordinator = _persistentStoreCoordinator;
+
+@synthesize modelManager = _modelManager;
+
+- (HLSModelManager *)modelManager
+{
+    // Managed object contexts must be created on the thread they are used from. Create the model manager lazily
+    if (! _modelManager && self.persistentStoreCoordinator) {
+        self.modelManager = [[[HLSModelManager alloc] initWithPersistentStoreCoordinator:self.persistentStoreCoordinator] autorelease];
+    }
+    return _modelManager;
+}
+
+@end
@@ -0,0 +1,19 @@
+//
+//  HLSModelManagerOpeningTaskOperation.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSTaskOperation.h"
+
+/**
+ * Operation processing an HLSModelManagerOpeningTask
+ */
+@interface HLSModelManagerOpeningTaskOperation : HLSTaskOperation {
+@private
+    
+}
+
+@end
@@ -0,0 +1,41 @@
+//
+//  HLSModelManagerOpeningTaskOperation.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSModelManagerOpeningTaskOperation.h"
+
+#import "HLSError.h"
+#import "HLSModelManager+Friend.h"
+#import "HLSModelManagerOpeningTask.h"
+#import "HLSModelManagerOpeningTask+Friend.h"
+#import "HLSTaskOperation+Protected.h"
+
+@implementation HLSModelManagerOpeningTaskOperation
+
+#pragma mark Thread main function
+
+- (void)operationMain
+{
+    HLSModelManagerOpeningTask *openingTask = (HLSModelManagerOpeningTask *)self.task;
+    
+    // Opening the store performs migration if needed. This can take long
+    NSPersistentStoreCoordinator *persistentStoreCoordinator = [HLSModelManager persistentStoreCoordinatorWithModelFileName:openingTask.modelFileName
+                                                                                                                   inBundle:openingTask.bundle
+                                                                                                                  storeType:openingTask.storeType
+                                                                                                              configuration:openingTask.configuration
+                                                                                                             storeDirectory:openingTask.storeDirectory
+                                                                                                                    options:openingTask.options];
+    if (! persistentStoreCoordinator) {
+        [self attachError:[HLSError errorWithDomain:NSCocoaErrorDomain code:NSCoreDataError]];
+        return;
+    }
+    
+    openingTask.persistentStoreCoordinator = persistentStoreCoordinator;
+    [self updateProgressToValue:1.f];
+}
+
+@end
@@ -0,0 +1,54 @@
+//
+//  HLSModelMigrationTask.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 15.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSModelManager.h"
+#import "HLSTask.h"
+
+/**
+ * A migration task copies the store of a model manager to a new store (at another location and / or with another store
+ * type), in batches. Unlike -[HLSModelManager migrateStoreToURL:withStoreType:error:], which migrates the whole store 
+ * at once on the calling thread, a migration task runs on a thread of the task manager it is submitted to, reports 
+ * its progress (and therefore remaining time estimates) as for any other task, and can be cancelled. Objects are copied
+ * entity after entity, and the contexts used are saved and reset after each batch, so that memory consumption does not 
+ * depend on the size of the store. Only the identifiers of the copied objects are kept until the migration is complete, 
+ * so that relationships can be restored
+ *
+ * The source store is read using a read-only duplicate of the model manager (see -[HLSModelManager readOnlyDuplicate]).
+ * Changes saved to the source store while the migration is running might not be copied. The model manager is not 
+ * altered by the migration: Once the task has been processed, create a new model manager to open the new store
+ *
+ * The destination store must not exist. If the migration is cancelled or fails, the destination store is removed
+ *
+ * Designated initializer: -initWithModelManager:storeURL:storeType:
+ */
+@interface HLSModelMigrationTask : HLSTask {
+@private
+    HLSModelManager *_modelManager;
+    NSURL *_storeURL;
+    NSString *_storeType;
+    NSUInteger _batchSize;
+}
+
+/**
+ * Create a task copying the store of a model manager to a new store of the given type, saved at the specified URL
+ */
+- (id)initWithModelManager:(HLSModelManager *)modelManager
+                  storeURL:(NSURL *)storeURL
+                 storeType:(NSString *)storeType;
+
+@property (nonatomic, readonly, retain) HLSModelManager *modelManager;
+@property (nonatomic, readonly, retain) NSURL *storeURL;
+@property (nonatomic, readonly, retain) NSString *storeType;
+
+/**
+ * The number of objects copied between two saves. Must be > 0, and must not be changed while the task is running
+ * Default value is 500
+ */
+@property (nonatomic, assign) NSUInteger batchSize;
+
+@end
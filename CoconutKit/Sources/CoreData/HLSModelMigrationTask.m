@@ -0,0 +1,96 @@
+//
+//  HLSModelMigrationTask.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 15.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSModelMigrationTask.h"
+
+#import "HLSAssert.h"
+#import "HLSLogger.h"
+#import "HLSModelMigrationTaskOperation.h"
+
+static const NSUInteger kModelMigrationTaskDefaultBatchSize = 500;
+
+@interface HLSModelMigrationTask ()
+
+@property (nonatomic, retain) HLSModelManager *modelManager;
+@property (nonatomic, retain) NSURL *storeURL;
+@property (nonatomic, retain) NSString *storeType;
+
+@end
+
+@implementation HLSModelMigrationTask
+
+#pragma mark -
+#pragma mark Object creation and destruction
+
+- (id)initWithModelManager:(HLSModelManager *)modelManager
+                  storeURL:(NSURL *)storeURL
+                 storeType:(NSString *)storeType
+{
+    if ((self = [super init])) {
+        if (! modelManager) {
+            HLSLoggerError(@"Missing model manager");
+            [self release];
+            return nil;
+        }
+        
+        if (! storeURL || ! storeType) {
+            HLSLoggerError(@"Missing store URL or type");
+            [self release];
+            return nil;
+        }
+        
+        self.modelManager = modelManager;
+        self.storeURL = storeURL;
+        self.storeType = storeType;
+        self.batchSize = kModelMigrationTaskDefaultBatchSize;
+    }
+    return self;
+}
+
+- (id)init
+{
+    HLSForbiddenInheritedMethod();
+    return nil;
+}
+
+- (void)dealloc
+{
+    self.modelManager = nil;
+    self.storeURL = nil;
+    self.storeType = nil;
+    
+    [super dealloc];
+}
+
+#pragma mark -
+#pragma mark Accessors and mutators
+
+- (Class)operationClass
+{
+    return [HLSModelMigrationTaskOperation class];
+}
+
+@synthesize modelManager = _modelManager;
+
+@synthesize storeURL = _storeURL;
+
+@synthesize storeType = _storeType;
+
+@synthesize batchSize = _batchSize;
+
+- (void)setBatchSize:(NSUInteger)batchSize
+{
+    if (batchSize == 0) {
+        HLSLoggerError(@"The batch size must be > 0");
+        return;
+    }
+    
+    _batchSize = batchSize;
+}
+
+@end
@@ -0,0 +1,19 @@
+//
+//  HLSModelMigrationTaskOperation.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 15.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSTaskOperation.h"
+
+/**
+ * Operation processing an HLSModelMigrationTask
+ */
+@interface HLSModelMigrationTaskOperation : HLSTaskOperation {
+@private
+    
+}
+
+@end
@@ -0,0 +1,350 @@
+//
+//  HLSModelMigrationTaskOperation.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 15.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSModelMigrationTaskOperation.h"
+
+#import "HLSError.h"
+#import "HLSFileManager.h"
+#import "HLSLogger.h"
+#import "HLSModelMigrationTask.h"
+#import "HLSTaskOperation+Protected.h"
+
+// Static helper functions
+static NSManagedObjectModel *unconstrainedModelForModel(NSManagedObjectModel *model);
+static BOOL isRelationshipCopied(NSRelationshipDescription *relationship);
+
+@interface HLSModelMigrationTaskOperation ()
+
+- (BOOL)copyObjectsWithIDs:(NSArray *)objectIDs
+                  ofEntity:(NSEntityDescription *)entity
+  fromManagedObjectContext:(NSManagedObjectContext *)sourceContext
+    toManagedObjectContext:(NSManagedObjectContext *)destinationContext
+               objectIDMap:(NSMutableDictionary *)objectIDMap
+                     error:(NSError **)pError;
+
+- (BOOL)copyRelationshipsOfObjectsWithIDs:(NSArray *)objectIDs
+                                 ofEntity:(NSEntityDescription *)entity
+                 fromManagedObjectContext:(NSManagedObjectContext *)sourceContext
+                   toManagedObjectContext:(NSManagedObjectContext *)destinationContext
+                              objectIDMap:(NSDictionary *)objectIDMap
+                                    error:(NSError **)pError;
+
+@end
+
+@implementation HLSModelMigrationTaskOperation
+
+#pragma mark Thread main function
+
+- (void)operationMain
+{
+    HLSModelMigrationTask *migrationTask = (HLSModelMigrationTask *)self.task;
+    NSURL *storeURL = migrationTask.storeURL;
+    
+    if ([storeURL isFileURL] && [[HLSFileManager defaultManager] fileExistsAtPath:[storeURL path]]) {
+        HLSLoggerError(@"A store already exists at %@", storeURL);
+        [self attachError:[HLSError errorWithDomain:NSCocoaErrorDomain code:NSFileWriteFileExistsError]];
+        return;
+    }
+    
+    // Source objects are read using a context created on the migration thread
+    HLSModelManager *sourceModelManager = [migrationTask.modelManager readOnlyDuplicate];
+    NSManagedObjectContext *sourceContext = sourceModelManager.managedObjectContext;
+    NSManagedObjectModel *model = sourceModelManager.managedObjectModel;
+    
+    // Objects are saved before their relationships have been restored. The destination store is therefore filled using
+    // a model without constraints and generic managed objects, so that no validation fails in the meantime. The
+    // store schema does not depend on those constraints
+    NSPersistentStoreCoordinator *destinationCoordinator = [[[NSPersistentStoreCoordinator alloc]
+                                                             initWithManagedObjectModel:unconstrainedModelForModel(model)] autorelease];
+    NSError *error = nil;
+    NSPersistentStore *destinationStore = [destinationCoordinator addPersistentStoreWithType:migrationTask.storeType
+                                                                                configuration:nil
+                                                                                          URL:storeURL
+                                                                                      options:nil
+                                                                                        error:&error];
+    if (! destinationStore) {
+        HLSLoggerError(@"Could not create the destination store; reason: %@", error);
+        [self attachError:error];
+        return;
+    }
+    
+    NSManagedObjectContext *destinationContext = [[[NSManagedObjectContext alloc] init] autorelease];
+    [destinationContext setPersistentStoreCoordinator:destinationCoordinator];
+    
+    // Not needed for inserted objects, and would keep changes in memory across batches
+    [destinationContext setUndoManager:nil];
+    
+    // Collect the identifiers of the objects to copy, per concrete entity (subentities are collected separately)
+    NSMutableArray *entities = [NSMutableArray array];
+    NSMutableArray *objectIDArrays = [NSMutableArray array];
+    NSUInteger objectCount = 0;
+    BOOL succeeded = YES;
+    for (NSEntityDescription *entity in [model entities]) {
+        if ([entity isAbstract]) {
+            continue;
+        }
+        
+        NSFetchRequest *fetchRequest = [[[NSFetchRequest alloc] init] autorelease];
+        [fetchRequest setEntity:entity];
+        [fetchRequest setIncludesSubentities:NO];
+        [fetchRequest setResultType:NSManagedObjectIDResultType];
+        NSArray *objectIDs = [sourceContext executeFetchRequest:fetchRequest error:&error];
+        if (! objectIDs) {
+            HLSLoggerError(@"Could not fetch objects of entity %@; reason: %@", [entity name], error);
+            [self attachError:error];
+            succeeded = NO;
+            break;
+        }
+        
+        [entities addObject:entity];
+        [objectIDArrays addObject:objectIDs];
+        objectCount += [objectIDs count];
+    }
+    
+    // Objects are copied in a first pass, relationships restored in a second one. Each object therefore accounts for
+    // two progress steps
+    NSMutableDictionary *objectIDMap = [NSMutableDictionary dictionaryWithCapacity:objectCount];
+    NSUInteger progressStepCount = 2 * objectCount;
+    NSUInteger progressStep = 0;
+    for (NSUInteger pass = 0; pass < 2 && succeeded; ++pass) {
+        for (NSUInteger i = 0; i < [entities count] && succeeded; ++i) {
+            NSEntityDescription *entity = [entities objectAtIndex:i];
+            NSArray *objectIDs = [objectIDArrays objectAtIndex:i];
+            
+            for (NSUInteger j = 0; j < [objectIDs count]; j += migrationTask.batchSize) {
+                if ([self isCancelled]) {
+                    succeeded = NO;
+                    break;
+                }
+                
+                NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+                
+                NSRange batchRange = NSMakeRange(j, MIN(migrationTask.batchSize, [objectIDs count] - j));
+                NSArray *batchObjectIDs = [objectIDs subarrayWithRange:batchRange];
+                if (pass == 0) {
+                    succeeded = [self copyObjectsWithIDs:batchObjectIDs
+                                                ofEntity:entity
+                                fromManagedObjectContext:sourceContext
+                                  toManagedObjectContext:destinationContext
+                                             objectIDMap:objectIDMap
+                                                   error:&error];
+                }
+                else {
+                    succeeded = [self copyRelationshipsOfObjectsWithIDs:batchObjectIDs
+                                                               ofEntity:entity
+                                               fromManagedObjectContext:sourceContext
+                                                 toManagedObjectContext:destinationContext
+                                                            objectIDMap:objectIDMap
+                                                                  error:&error];
+                }
+                
+                // Objects of the previous batch are not needed anymore. Release them
+                [sourceContext reset];
+                [destinationContext reset];
+                
+                if (! succeeded) {
+                    HLSLoggerError(@"Could not migrate objects of entity %@; reason: %@", [entity name], error);
+                    [self attachError:error];
+                    [pool drain];
+                    break;
+                }
+                
+                progressStep += batchRange.length;
+                [self updateProgressToValue:(float)progressStep / progressStepCount];
+                
+                [pool drain];
+            }
+        }
+    }
+    
+    if (! [destinationCoordinator removePersistentStore:destinationStore error:&error]) {
+        HLSLoggerWarn(@"Could not close the destination store; reason: %@", error);
+    }
+    
+    // Record the original model in the store metadata, so that the store can be opened with it
+    if (succeeded) {
+        NSDictionary *destinationMetadata = [NSPersistentStoreCoordinator metadataForPersistentStoreOfType:migrationTask.storeType
+                                                                                                       URL:storeURL
+                                                                                                     error:&error];
+        if (destinationMetadata) {
+            NSMutableDictionary *metadata = [NSMutableDictionary dictionaryWithDictionary:destinationMetadata];
+            [metadata setObject:[model entityVersionHashesByName] forKey:NSStoreModelVersionHashesKey];
+            [metadata setObject:[[model versionIdentifiers] allObjects] forKey:NSStoreModelVersionIdentifiersKey];
+            succeeded = [NSPersistentStoreCoordinator setMetadata:metadata 
+                                         forPersistentStoreOfType:migrationTask.storeType 
+                                                              URL:storeURL 
+                                                            error:&error];
+        }
+        else {
+            succeeded = NO;
+        }
+        
+        if (! succeeded) {
+            HLSLoggerError(@"Could not update the metadata of the destination store; reason: %@", error);
+            [self attachError:error];
+        }
+    }
+    
+    // Cancelled or failed: Remove the incomplete store (which could not be opened with the original model anyway)
+    if (! succeeded) {
+        if ([storeURL isFileURL] && ! [[HLSFileManager defaultManager] removeItemAtPath:[storeURL path] error:&error]) {
+            HLSLoggerWarn(@"Could not remove the incomplete store at %@; reason: %@", storeURL, error);
+        }
+        return;
+    }
+    
+    [self updateProgressToValue:1.f];
+}
+
+#pragma mark Copying objects
+
+/**
+ * Copy the attributes of the objects with the given identifiers, recording the identifiers of the copies
+ */
+- (BOOL)copyObjectsWithIDs:(NSArray *)objectIDs
+                  ofEntity:(NSEntityDescription *)entity
+  fromManagedObjectContext:(NSManagedObjectContext *)sourceContext
+    toManagedObjectContext:(NSManagedObjectContext *)destinationContext
+               objectIDMap:(NSMutableDictionary *)objectIDMap
+                     error:(NSError **)pError
+{
+    NSFetchRequest *fetchRequest = [[[NSFetchRequest alloc] init] autorelease];
+    [fetchRequest setEntity:entity];
+    [fetchRequest setIncludesSubentities:NO];
+    [fetchRequest setPredicate:[NSPredicate predicateWithFormat:@"self IN %@", objectIDs]];
+    [fetchRequest setReturnsObjectsAsFaults:NO];
+    NSArray *sourceObjects = [sourceContext executeFetchRequest:fetchRequest error:pError];
+    if (! sourceObjects) {
+        return NO;
+    }
+    
+    NSMutableArray *attributeNames = [NSMutableArray array];
+    for (NSAttributeDescription *attribute in [[entity attributesByName] allValues]) {
+        if (! [attribute isTransient]) {
+            [attributeNames addObject:[attribute name]];
+        }
+    }
+    
+    NSMutableArray *destinationObjects = [NSMutableArray arrayWithCapacity:[sourceObjects count]];
+    for (NSManagedObject *sourceObject in sourceObjects) {
+        NSManagedObject *destinationObject = [NSEntityDescription insertNewObjectForEntityForName:[entity name]
+                                                                           inManagedObjectContext:destinationContext];
+        [destinationObject setValuesForKeysWithDictionary:[sourceObject dictionaryWithValuesForKeys:attributeNames]];
+        [destinationObjects addObject:destinationObject];
+    }
+    
+    if (! [destinationContext save:pError]) {
+        return NO;
+    }
+    
+    // Identifiers are permanent once saved
+    for (NSUInteger i = 0; i < [sourceObjects count]; ++i) {
+        NSManagedObjectID *sourceObjectID = [[sourceObjects objectAtIndex:i] objectID];
+        NSManagedObjectID *destinationObjectID = [[destinationObjects objectAtIndex:i] objectID];
+        [objectIDMap setObject:destinationObjectID forKey:sourceObjectID];
+    }
+    
+    return YES;
+}
+
+/**
+ * Restore the relationships of the copies of the objects with the given identifiers
+ */
+- (BOOL)copyRelationshipsOfObjectsWithIDs:(NSArray *)objectIDs
+                                 ofEntity:(NSEntityDescription *)entity
+                 fromManagedObjectContext:(NSManagedObjectContext *)sourceContext
+                   toManagedObjectContext:(NSManagedObjectContext *)destinationContext
+                              objectIDMap:(NSDictionary *)objectIDMap
+                                    error:(NSError **)pError
+{
+    NSMutableArray *relationships = [NSMutableArray array];
+    for (NSRelationshipDescription *relationship in [[entity relationshipsByName] allValues]) {
+        if (isRelationshipCopied(relationship)) {
+            [relationships addObject:relationship];
+        }
+    }
+    
+    if ([relationships count] == 0) {
+        return YES;
+    }
+    
+    NSFetchRequest *fetchRequest = [[[NSFetchRequest alloc] init] autorelease];
+    [fetchRequest setEntity:entity];
+    [fetchRequest setIncludesSubentities:NO];
+    [fetchRequest setPredicate:[NSPredicate predicateWithFormat:@"self IN %@", objectIDs]];
+    NSArray *sourceObjects = [sourceContext executeFetchRequest:fetchRequest error:pError];
+    if (! sourceObjects) {
+        return NO;
+    }
+    
+    for (NSManagedObject *sourceObject in sourceObjects) {
+        NSManagedObject *destinationObject = [destinationContext objectWithID:[objectIDMap objectForKey:[sourceObject objectID]]];
+        for (NSRelationshipDescription *relationship in relationships) {
+            NSString *name = [relationship name];
+            
+            // Only identifiers are needed. Related objects are not faulted in
+            if ([relationship isToMany]) {
+                NSSet *sourceRelatedObjects = [sourceObject valueForKey:name];
+                NSMutableSet *destinationRelatedObjects = [NSMutableSet setWithCapacity:[sourceRelatedObjects count]];
+                for (NSManagedObject *sourceRelatedObject in sourceRelatedObjects) {
+                    NSManagedObjectID *destinationRelatedObjectID = [objectIDMap objectForKey:[sourceRelatedObject objectID]];
+                    if (destinationRelatedObjectID) {
+                        [destinationRelatedObjects addObject:[destinationContext objectWithID:destinationRelatedObjectID]];
+                    }
+                }
+                [destinationObject setValue:destinationRelatedObjects forKey:name];
+            }
+            else {
+                NSManagedObject *sourceRelatedObject = [sourceObject valueForKey:name];
+                NSManagedObjectID *destinationRelatedObjectID = sourceRelatedObject ? [objectIDMap objectForKey:[sourceRelatedObject objectID]] : nil;
+                [destinationObject setValue:destinationRelatedObjectID ? [destinationContext objectWithID:destinationRelatedObjectID] : nil
+                                     forKey:name];
+            }
+        }
+    }
+    
+    return [destinationContext save:pError];
+}
+
+@end
+
+#pragma mark Static helper functions
+
+/**
+ * Return a copy of a model, with all properties optional and without validation predicates, whose entities are
+ * represented by NSManagedObject (so that no custom validation logic is called either)
+ */
+static NSManagedObjectModel *unconstrainedModelForModel(NSManagedObjectModel *model)
+{
+    NSManagedObjectModel *unconstrainedModel = [[model copy] autorelease];
+    for (NSEntityDescription *entity in [unconstrainedModel entities]) {
+        [entity setManagedObjectClassName:NSStringFromClass([NSManagedObject class])];
+        for (NSPropertyDescription *property in [entity properties]) {
+            [property setOptional:YES];
+            [property setValidationPredicates:nil withValidationWarnings:nil];
+            if ([property isKindOfClass:[NSRelationshipDescription class]]) {
+                [(NSRelationshipDescription *)property setMinCount:0];
+            }
+        }
+    }
+    return unconstrainedModel;
+}
+
+/**
+ * Return YES iff a relationship must be restored explicitly. When a to-many relationship has a to-one inverse, it
+ * is restored by Core Data when the inverse is set, which is cheaper
+ */
+static BOOL isRelationshipCopied(NSRelationshipDescription *relationship)
+{
+    if ([relationship isTransient]) {
+        return NO;
+    }
+    
+    NSRelationshipDescription *inverseRelationship = [relationship inverseRelationship];
+    return ! inverseRelationship || ! [relationship isToMany] || [inverseRelationship isToMany];
+}
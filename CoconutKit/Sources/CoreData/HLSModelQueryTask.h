@@ -0,0 +1,45 @@
+//
+//  HLSModelQueryTask.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSModelManager.h"
+#import "HLSTask.h"
+
+/**
+ * A query task reads the store of a model manager on a task manager thread, without blocking the context used by the
+ * main thread. Several query tasks can run at the same time (e.g. report generation and search), each one using its
+ * own read-only snapshot context which shares the persistent store coordinator of the model manager it has been 
+ * created with (see -[HLSModelManager readOnlyDuplicate])
+ *
+ * To use a query task, subclass HLSModelQueryTask and implement the -performQuery method. By default, query tasks
+ * belong to the HLSTaskExecutionClassCPU execution class
+ *
+ * Designated initializer: -initWithModelManager:
+ */
+@interface HLSModelQueryTask : HLSTask {
+@private
+    HLSModelManager *_modelManager;
+}
+
+/**
+ * Create a query task reading the store of the given model manager
+ */
+- (id)initWithModelManager:(HLSModelManager *)modelManager;
+
+@property (nonatomic, readonly, retain) HLSModelManager *modelManager;
+
+/**
+ * Perform the query and return its results, which are attached to the task as return information. This method is 
+ * called on the query thread, with the read-only snapshot model manager pushed onto its model manager stack. Context-
+ * free methods of NSManagedObject+HLSExtensions.h can therefore be used to fetch objects. Managed objects must not 
+ * be returned since they cannot be used outside the snapshot context. Return object IDs or plain values instead. 
+ * Long queries should check -isCancelled regularly
+ * Must be overridden
+ */
+- (NSDictionary *)performQuery;
+
+@end
@@ -0,0 +1,73 @@
+//
+//  HLSModelQueryTask.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSModelQueryTask.h"
+
+#import "HLSAssert.h"
+#import "HLSLogger.h"
+#import "HLSModelQueryTaskOperation.h"
+
+@interface HLSModelQueryTask ()
+
+@property (nonatomic, retain) HLSModelManager *modelManager;
+
+@end
+
+@implementation HLSModelQueryTask
+
+#pragma mark -
+#pragma mark Object creation and destruction
+
+- (id)initWithModelManager:(HLSModelManager *)modelManager
+{
+    if ((self = [super init])) {
+        if (! modelManager) {
+            HLSLoggerError(@"Missing model manager");
+            [self release];
+            return nil;
+        }
+        
+        self.modelManager = modelManager;
+        self.executionClass = HLSTaskExecutionClassCPU;
+    }
+    return self;
+}
+
+- (id)init
+{
+    HLSForbiddenInheritedMethod();
+    return nil;
+}
+
+- (void)dealloc
+{
+    self.modelManager = nil;
+    
+    [super dealloc];
+}
+
+#pragma mark -
+#pragma mark Accessors and mutators
+
+- (Class)operationClass
+{
+    return [HLSModelQueryTaskOperation class];
+}
+
+@synthesize modelManager = _modelManager;
+
+#pragma mark -
+#pragma mark Querying
+
+- (NSDictionary *)performQuery
+{
+    HLSMissingMethodImplementation();
+    return nil;
+}
+
+@end
@@ -0,0 +1,19 @@
+//
+//  HLSModelQueryTaskOperation.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSTaskOperation.h"
+
+/**
+ * Operation processing an HLSModelQueryTask
+ */
+@interface HLSModelQueryTaskOperation : HLSTaskOperation {
+@private
+    
+}
+
+@end
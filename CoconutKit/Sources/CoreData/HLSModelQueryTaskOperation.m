@@ -0,0 +1,39 @@
+//
+//  HLSModelQueryTaskOperation.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSModelQueryTaskOperation.h"
+
+#import "HLSModelQueryTask.h"
+#import "HLSTaskOperation+Protected.h"
+
+@implementation HLSModelQueryTaskOperation
+
+#pragma mark Thread main function
+
+- (void)operationMain
+{
+    HLSModelQueryTask *queryTask = (HLSModelQueryTask *)self.task;
+    
+    // The snapshot context must be created on the query thread
+    HLSModelManager *snapshotModelManager = [queryTask.modelManager readOnlyDuplicate];
+    [HLSModelManager pushModelManager:snapshotModelManager];
+    
+    // Objects fetched by the query are released with the pool, before the snapshot context is
+    NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+    NSDictionary *returnInfo = [[queryTask performQuery] retain];
+    [pool drain];
+    
+    [HLSModelManager popModelManager];
+    
+    if (! [self isCancelled] && returnInfo) {
+        [self attachReturnInfo:returnInfo];
+    }
+    [returnInfo release];
+}
+
+@end
@@ -24,6 +24,27 @@
 + (id)insertIntoManagedObjectContext:(NSManagedObjectContext *)managedObjectContext;
 + (id)insert;
 
+/**
+ * When called on an NSManagedObject subclass, create a fetch request for instances of it matching a predicate, sorted
+ * using the specified descriptors (without context parameter, the current HLSModelManager context is used). The request
+ * can then be tuned (batch size, limit, relationships to prefetch, properties to fetch, result type, etc.) and executed
+ * using +objectsWithFetchRequest:inManagedObjectContext:, e.g. to avoid loading whole entities for long lists or
+ * to prevent faulting relationships one object at a time
+ */
++ (NSFetchRequest *)fetchRequestWithPredicate:(NSPredicate *)predicate
+                       sortedUsingDescriptors:(NSArray *)sortDescriptors
+                       inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext;
++ (NSFetchRequest *)fetchRequestWithPredicate:(NSPredicate *)predicate
+                       sortedUsingDescriptors:(NSArray *)sortDescriptors;
+
+/**
+ * Execute a fetch request in a managed object context (without context parameter, the current HLSModelManager context 
+ * is used). Return nil on failure
+ */
++ (NSArray *)objectsWithFetchRequest:(NSFetchRequest *)fetchRequest
+              inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext;
++ (NSArray *)objectsWithFetchRequest:(NSFetchRequest *)fetchRequest;
+
 /**
  * When called on an NSManagedObject subclass, query instances of it matching a predicate, sorting them using the
  * specified descriptors (without context parameter, the current HLSModelManager context is used)
@@ -40,6 +61,38 @@
 + (NSArray *)filteredObjectsUsingPredicate:(NSPredicate *)predicate
                      sortedUsingDescriptor:(NSSortDescriptor *)sortDescriptor;
 
+/**
+ * When called on an NSManagedObject subclass, register a named fetch template for it. The predicate format is parsed
+ * once, and can contain substitution variables (e.g. @"lastName == $lastName") which are bound each time the template 
+ * is used. Templates are meant for queries which are executed often (e.g. each time a table view cell is configured), 
+ * and avoid parsing predicates and setting up fetch requests again and again. Registering a template with an existing
+ * name replaces it
+ */
++ (void)registerFetchTemplateWithName:(NSString *)name
+                      predicateFormat:(NSString *)predicateFormat
+               sortedUsingDescriptors:(NSArray *)sortDescriptors;
+
+/**
+ * When called on an NSManagedObject subclass, create a fetch request from one of its registered templates, binding
+ * the specified substitution variables (without context parameter, the current HLSModelManager context is used). 
+ * Return nil if no such template has been registered
+ */
++ (NSFetchRequest *)fetchRequestFromTemplateWithName:(NSString *)name
+                               substitutionVariables:(NSDictionary *)substitutionVariables
+                              inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext;
++ (NSFetchRequest *)fetchRequestFromTemplateWithName:(NSString *)name
+                               substitutionVariables:(NSDictionary *)substitutionVariables;
+
+/**
+ * When called on an NSManagedObject subclass, query instances of it using one of its registered templates, binding
+ * the specified substitution variables (without context parameter, the current HLSModelManager context is used)
+ */
++ (NSArray *)objectsFromTemplateWithName:(NSString *)name
+                   substitutionVariables:(NSDictionary *)substitutionVariables
+                  inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext;
++ (NSArray *)objectsFromTemplateWithName:(NSString *)name
+                   substitutionVariables:(NSDictionary *)substitutionVariables;
+
 /**
  * When called on an NSManagedObject subclass, query all instances of it, sorting them using the specified descriptors
  * (without context parameter, the current HLSModelManager context is used)
@@ -78,6 +131,7 @@
  *   - for relationships, a shallow copy is performed, except if the relationship corresponds to ownership of one
  *     or more objects also implementing the HLSManagedObjectCopying protocol (ownership is assumed when the relationship
  *     deletion behavior is set to cascade)
+ *   - each owned object is copied once, even if it can be reached several times (or through a cycle) from the receiver
  *
  * After the method successfully returns an object, you must still commit the changes by calling -save: on the
  * managed object context in which it was created.
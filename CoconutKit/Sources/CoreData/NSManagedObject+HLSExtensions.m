@@ -11,9 +11,51 @@
 #import "HLSAssert.h"
 #import "HLSLogger.h"
 #import "HLSManagedObjectCopying.h"
+#import "HLSModelInstrumentation.h"
 #import "HLSModelManager.h"
 #import "NSObject+HLSExtensions.h"
 
+// Number of objects fetched and deleted at a time
+static const NSUInteger kDeleteAllObjectsBatchSize = 500;
+
+// Number of objects filled between two autorelease pool drains when duplicating an object graph
+static const NSUInteger kDuplicateBatchSize = 200;
+
+// Copy plans, per entity (retained keys compared by pointer)
+static CFMutableDictionaryRef s_entityToCopyPlanMap = NULL;
+
+// Fetch request prototypes (without entity), per class name and template name
+static NSMutableDictionary *s_fetchTemplateKeyToFetchRequestMap = nil;
+
+/**
+ * How the properties of an entity must be copied when duplicating an object. Calculated once per entity
+ */
+@interface HLSManagedObjectCopyPlan : NSObject {
+@private
+    NSArray *_sharedKeys;
+    NSArray *_ownedToManyRelationshipNames;
+    NSArray *_ownedToOneRelationshipNames;
+    NSArray *_ownerRelationshipNames;
+}
+
+- (id)initWithEntityDescription:(NSEntityDescription *)entityDescription;
+
+@property (nonatomic, readonly) NSArray *sharedKeys;                       // Attributes and non-owning relationships
+@property (nonatomic, readonly) NSArray *ownedToManyRelationshipNames;
+@property (nonatomic, readonly) NSArray *ownedToOneRelationshipNames;
+@property (nonatomic, readonly) NSArray *ownerRelationshipNames;           // To-one inverses of owning relationships
+
+@end
+
+// Function declarations
+static NSEntityDescription *entityDescriptionForClass(Class managedObjectClass, NSManagedObjectContext *managedObjectContext);
+static NSManagedObject *insertCopyForObject(NSManagedObject *object, CFMutableDictionaryRef originalToCopyMap, NSMutableArray *pendingObjects);
+static NSManagedObject *copyForOwnedObject(NSManagedObject *ownedObject, CFMutableDictionaryRef originalToCopyMap, NSMutableArray *pendingObjects);
+static void fillCopyForObject(NSManagedObject *object, NSManagedObject *objectCopy, CFMutableDictionaryRef originalToCopyMap, NSMutableArray *pendingObjects);
+static HLSManagedObjectCopyPlan *copyPlanForEntity(NSEntityDescription *entityDescription);
+static NSString *fetchTemplateKey(Class managedObjectClass, NSString *name);
+static NSArray *objectsWithFetchRequest(NSFetchRequest *fetchRequest, NSManagedObjectContext *managedObjectContext, NSString *templateName);
+
 @implementation NSManagedObject (HLSExtensions)
 
 #pragma mark Class methods
@@ -29,9 +71,9 @@
     return [self insertIntoManagedObjectContext:[HLSModelManager currentModelContext]];
 }
 
-+ (NSArray *)filteredObjectsUsingPredicate:(NSPredicate *)predicate
-                    sortedUsingDescriptors:(NSArray *)sortDescriptors
-                    inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext
++ (NSFetchRequest *)fetchRequestWithPredicate:(NSPredicate *)predicate
+                       sortedUsingDescriptors:(NSArray *)sortDescriptors
+                       inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext
 {
     HLSAssertObjectsInEnumerationAreKindOfClass(sortDescriptors, NSSortDescriptor);
     if (! managedObjectContext) {
@@ -39,21 +81,40 @@
         return nil;
     }
     
-    NSEntityDescription *entityDescription = [NSEntityDescription entityForName:[self className]
-                                                         inManagedObjectContext:managedObjectContext];
     NSFetchRequest *fetchRequest = [[[NSFetchRequest alloc] init] autorelease];
-    [fetchRequest setEntity:entityDescription];
+    [fetchRequest setEntity:entityDescriptionForClass(self, managedObjectContext)];
     fetchRequest.sortDescriptors = sortDescriptors;
     fetchRequest.predicate = predicate;
-    
-    NSError *error = nil;
-    NSArray *objects = [managedObjectContext executeFetchRequest:fetchRequest error:&error];
-    if (error) {
-        HLSLoggerError(@"Could not retrieve objects; reason: %@", error);
-        return nil;
-    }
-    
-    return objects;
+    return fetchRequest;
+}
+
++ (NSFetchRequest *)fetchRequestWithPredicate:(NSPredicate *)predicate
+                       sortedUsingDescriptors:(NSArray *)sortDescriptors
+{
+    return [self fetchRequestWithPredicate:predicate
+                    sortedUsingDescriptors:sortDescriptors
+                    inManagedObjectContext:[HLSModelManager currentModelContext]];
+}
+
++ (NSArray *)objectsWithFetchRequest:(NSFetchRequest *)fetchRequest
+              inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext
+{
+    return objectsWithFetchRequest(fetchRequest, managedObjectContext, nil);
+}
+
++ (NSArray *)objectsWithFetchRequest:(NSFetchRequest *)fetchRequest
+{
+    return [self objectsWithFetchRequest:fetchRequest inManagedObjectContext:[HLSModelManager currentModelContext]];
+}
+
++ (NSArray *)filteredObjectsUsingPredicate:(NSPredicate *)predicate
+                    sortedUsingDescriptors:(NSArray *)sortDescriptors
+                    inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext
+{
+    NSFetchRequest *fetchRequest = [self fetchRequestWithPredicate:predicate
+                                            sortedUsingDescriptors:sortDescriptors
+                                            inManagedObjectContext:managedObjectContext];
+    return [self objectsWithFetchRequest:fetchRequest inManagedObjectContext:managedObjectContext];
 }
 
 + (NSArray *)filteredObjectsUsingPredicate:(NSPredicate *)predicate
@@ -82,6 +143,82 @@
                         sortedUsingDescriptors:sortDescriptors];
 }
 
++ (void)registerFetchTemplateWithName:(NSString *)name
+                      predicateFormat:(NSString *)predicateFormat
+               sortedUsingDescriptors:(NSArray *)sortDescriptors
+{
+    HLSAssertObjectsInEnumerationAreKindOfClass(sortDescriptors, NSSortDescriptor);
+    if (! name) {
+        HLSLoggerError(@"Missing template name");
+        return;
+    }
+    
+    // Parsed once here
+    NSFetchRequest *fetchRequest = [[[NSFetchRequest alloc] init] autorelease];
+    fetchRequest.predicate = predicateFormat ? [NSPredicate predicateWithFormat:predicateFormat] : nil;
+    fetchRequest.sortDescriptors = sortDescriptors;
+    
+    // Templates can be used from contexts living on any thread, access is therefore synchronized
+    @synchronized([NSFetchRequest class]) {
+        if (! s_fetchTemplateKeyToFetchRequestMap) {
+            s_fetchTemplateKeyToFetchRequestMap = [[NSMutableDictionary alloc] init];
+        }
+        [s_fetchTemplateKeyToFetchRequestMap setObject:fetchRequest forKey:fetchTemplateKey(self, name)];
+    }
+}
+
++ (NSFetchRequest *)fetchRequestFromTemplateWithName:(NSString *)name
+                               substitutionVariables:(NSDictionary *)substitutionVariables
+                              inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext
+{
+    if (! managedObjectContext) {
+        HLSLoggerError(@"Missing managed object context");
+        return nil;
+    }
+    
+    // Fetch requests are mutable. Each caller gets its own copy of the prototype
+    NSFetchRequest *fetchRequest = nil;
+    @synchronized([NSFetchRequest class]) {
+        fetchRequest = [[[s_fetchTemplateKeyToFetchRequestMap objectForKey:fetchTemplateKey(self, name)] copy] autorelease];
+    }
+    if (! fetchRequest) {
+        HLSLoggerError(@"No fetch template %@ has been registered for class %@", name, [self className]);
+        return nil;
+    }
+    
+    [fetchRequest setEntity:entityDescriptionForClass(self, managedObjectContext)];
+    if (fetchRequest.predicate && [substitutionVariables count] != 0) {
+        fetchRequest.predicate = [fetchRequest.predicate predicateWithSubstitutionVariables:substitutionVariables];
+    }
+    return fetchRequest;
+}
+
++ (NSFetchRequest *)fetchRequestFromTemplateWithName:(NSString *)name
+                               substitutionVariables:(NSDictionary *)substitutionVariables
+{
+    return [self fetchRequestFromTemplateWithName:name
+                            substitutionVariables:substitutionVariables
+                           inManagedObjectContext:[HLSModelManager currentModelContext]];
+}
+
++ (NSArray *)objectsFromTemplateWithName:(NSString *)name
+                   substitutionVariables:(NSDictionary *)substitutionVariables
+                  inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext
+{
+    NSFetchRequest *fetchRequest = [self fetchRequestFromTemplateWithName:name
+                                                    substitutionVariables:substitutionVariables
+                                                   inManagedObjectContext:managedObjectContext];
+    return objectsWithFetchRequest(fetchRequest, managedObjectContext, name);
+}
+
++ (NSArray *)objectsFromTemplateWithName:(NSString *)name
+                   substitutionVariables:(NSDictionary *)substitutionVariables
+{
+    return [self objectsFromTemplateWithName:name
+                       substitutionVariables:substitutionVariables
+                      inManagedObjectContext:[HLSModelManager currentModelContext]];
+}
+
 + (NSArray *)allObjectsSortedUsingDescriptors:(NSArray *)sortDescriptors
                        inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext
 {
@@ -122,9 +259,33 @@
 
 + (void)deleteAllObjectsInManagedObjectContext:(NSManagedObjectContext *)managedObjectContext
 {
-    NSArray *allObjects = [self allObjects];
-    for (NSManagedObject *managedObject in allObjects) {
-        [managedObjectContext deleteObject:managedObject];
+    if (! managedObjectContext) {
+        HLSLoggerError(@"Missing managed object context");
+        return;
+    }
+    
+    // Property values are not needed to delete objects. Only fetch object ids (registered objects are still returned,
+    // with pending changes) and return them in batches, so that objects only get instantiated when they are deleted
+    NSFetchRequest *fetchRequest = [[[NSFetchRequest alloc] init] autorelease];
+    [fetchRequest setEntity:entityDescriptionForClass(self, managedObjectContext)];
+    fetchRequest.includesPropertyValues = NO;
+    fetchRequest.fetchBatchSize = kDeleteAllObjectsBatchSize;
+    
+    NSError *error = nil;
+    NSArray *objects = [managedObjectContext executeFetchRequest:fetchRequest error:&error];
+    if (error) {
+        HLSLoggerError(@"Could not retrieve objects; reason: %@", error);
+        return;
+    }
+    
+    NSUInteger count = [objects count];
+    for (NSUInteger i = 0; i < count; i += kDeleteAllObjectsBatchSize) {
+        NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+        NSUInteger end = MIN(i + kDeleteAllObjectsBatchSize, count);
+        for (NSUInteger j = i; j < end; ++j) {
+            [managedObjectContext deleteObject:[objects objectAtIndex:j]];
+        }
+        [pool drain];
     }
 }
 
@@ -141,74 +302,258 @@
         return nil;
     }
     
-    // Create the deep copy
-    NSManagedObject *objectCopy = [NSEntityDescription insertNewObjectForEntityForName:self.entity.name
-                                                                inManagedObjectContext:self.managedObjectContext];
+    // The object graph is copied iteratively. Each original object is mapped to its copy (objects and copies are not
+    // retained by the map, but by the context), so that each object reachable through owning relationships is copied 
+    // once, even if the graph contains cycles
+    CFMutableDictionaryRef originalToCopyMap = CFDictionaryCreateMutable(kCFAllocatorDefault, 0, NULL, NULL);
+    NSMutableArray *pendingObjects = [NSMutableArray array];
+    
+    NSManagedObject *objectCopy = insertCopyForObject(self, originalToCopyMap, pendingObjects);
+    
+    // Fill copies in batches, so that autoreleased temporaries do not accumulate for large graphs
+    NSUInteger index = 0;
+    while (index < [pendingObjects count]) {
+        NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+        NSUInteger end = MIN(index + kDuplicateBatchSize, [pendingObjects count]);
+        for (; index < end; ++index) {
+            NSManagedObject *object = [pendingObjects objectAtIndex:index];
+            fillCopyForObject(object, (NSManagedObject *)CFDictionaryGetValue(originalToCopyMap, object), originalToCopyMap, pendingObjects);
+        }
+        [pool drain];
+    }
+    
+    CFRelease(originalToCopyMap);
+    return objectCopy;
+}
+
+@end
+
+@implementation HLSManagedObjectCopyPlan
+
+#pragma mark Object creation and destruction
+
+- (id)initWithEntityDescription:(NSEntityDescription *)entityDescription
+{
+    if ((self = [super init])) {
+        NSMutableArray *sharedKeys = [NSMutableArray arrayWithArray:[[entityDescription attributesByName] allKeys]];
+        NSMutableArray *ownedToManyRelationshipNames = [NSMutableArray array];
+        NSMutableArray *ownedToOneRelationshipNames = [NSMutableArray array];
+        NSMutableArray *ownerRelationshipNames = [NSMutableArray array];
+        
+        // Ownership is assumed when the deletion rule is set to cascade
+        NSDictionary *relationships = [entityDescription relationshipsByName];
+        for (NSString *relationshipName in [relationships allKeys]) {
+            NSRelationshipDescription *relationshipDescription = [relationships objectForKey:relationshipName];
+            if ([relationshipDescription deleteRule] == NSCascadeDeleteRule) {
+                if ([relationshipDescription isToMany]) {
+                    [ownedToManyRelationshipNames addObject:relationshipName];
+                }
+                else {
+                    [ownedToOneRelationshipNames addObject:relationshipName];
+                }
+            }
+            else if (! [relationshipDescription isToMany] && [[relationshipDescription inverseRelationship] deleteRule] == NSCascadeDeleteRule) {
+                [ownerRelationshipNames addObject:relationshipName];
+            }
+            else {
+                [sharedKeys addObject:relationshipName];
+            }
+        }
         
+        _sharedKeys = [[NSArray alloc] initWithArray:sharedKeys];
+        _ownedToManyRelationshipNames = [[NSArray alloc] initWithArray:ownedToManyRelationshipNames];
+        _ownedToOneRelationshipNames = [[NSArray alloc] initWithArray:ownedToOneRelationshipNames];
+        _ownerRelationshipNames = [[NSArray alloc] initWithArray:ownerRelationshipNames];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [_sharedKeys release];
+    _sharedKeys = nil;
+    
+    [_ownedToManyRelationshipNames release];
+    _ownedToManyRelationshipNames = nil;
+    
+    [_ownedToOneRelationshipNames release];
+    _ownedToOneRelationshipNames = nil;
+    
+    [_ownerRelationshipNames release];
+    _ownerRelationshipNames = nil;
+    
+    [super dealloc];
+}
+
+#pragma mark Accessors and mutators
+
+@synthesize sharedKeys = _sharedKeys;
+
+@synthesize ownedToManyRelationshipNames = _ownedToManyRelationshipNames;
+
+@synthesize ownedToOneRelationshipNames = _ownedToOneRelationshipNames;
+
+@synthesize ownerRelationshipNames = _ownerRelationshipNames;
+
+@end
+
+#pragma mark Static functions
+
+// +[NSEntityDescription entityForName:inManagedObjectContext:] looks the entity up through the context each time a 
+// fetch request is created. Use the entity dictionary of the model directly, which the model builds once
+static NSEntityDescription *entityDescriptionForClass(Class managedObjectClass, NSManagedObjectContext *managedObjectContext)
+{
+    NSManagedObjectModel *managedObjectModel = [[managedObjectContext persistentStoreCoordinator] managedObjectModel];
+    if (! managedObjectModel) {
+        return [NSEntityDescription entityForName:[managedObjectClass className] inManagedObjectContext:managedObjectContext];
+    }
+    return [[managedObjectModel entitiesByName] objectForKey:[managedObjectClass className]];
+}
+
+// Insert an empty copy for an object implementing HLSManagedObjectCopying (if not already done), and schedule it
+// to be filled
+static NSManagedObject *insertCopyForObject(NSManagedObject *object, CFMutableDictionaryRef originalToCopyMap, NSMutableArray *pendingObjects)
+{
+    NSManagedObject *objectCopy = (NSManagedObject *)CFDictionaryGetValue(originalToCopyMap, object);
+    if (! objectCopy) {
+        objectCopy = [NSEntityDescription insertNewObjectForEntityForName:object.entity.name
+                                                   inManagedObjectContext:object.managedObjectContext];
+        CFDictionarySetValue(originalToCopyMap, object, objectCopy);
+        [pendingObjects addObject:object];
+    }
+    return objectCopy;
+}
+
+// Return the copy to use for an object related to a copied object through an owning relationship: A (deep) copy if the 
+// object implements HLSManagedObjectCopying, the object itself otherwise
+static NSManagedObject *copyForOwnedObject(NSManagedObject *ownedObject, CFMutableDictionaryRef originalToCopyMap, NSMutableArray *pendingObjects)
+{
+    if (! [ownedObject conformsToProtocol:@protocol(HLSManagedObjectCopying)]) {
+        return ownedObject;
+    }
+    return insertCopyForObject(ownedObject, originalToCopyMap, pendingObjects);
+}
+
+// Copy the attributes and relationships of an object into its copy
+static void fillCopyForObject(NSManagedObject *object, NSManagedObject *objectCopy, CFMutableDictionaryRef originalToCopyMap, NSMutableArray *pendingObjects)
+{
+    HLSManagedObjectCopyPlan *copyPlan = copyPlanForEntity(object.entity);
+    
     // Get keys to exclude (if any)
     NSSet *keysToExclude = nil;
-    NSManagedObject<HLSManagedObjectCopying> *managedObjectCopyable = (NSManagedObject<HLSManagedObjectCopying> *)self;
+    NSManagedObject<HLSManagedObjectCopying> *managedObjectCopyable = (NSManagedObject<HLSManagedObjectCopying> *)object;
     if ([managedObjectCopyable respondsToSelector:@selector(keysToExclude)]) {
         keysToExclude = [managedObjectCopyable keysToExclude];
     }
     
-    // Copy attributes (shallow copy for all: Those are of "primitive" immutable types anyway)
-    NSEntityDescription *entityDescription = [NSEntityDescription entityForName:self.entity.name
-                                                         inManagedObjectContext:self.managedObjectContext];
-    NSDictionary *attributes = [entityDescription attributesByName];
-    for (NSString *attributeName in [attributes allKeys]) {
-        if ([keysToExclude containsObject:attributeName]) {
+    // Attributes and non-owning relationships: Shallow copy (attributes are of "primitive" immutable types anyway)
+    NSArray *sharedKeys = copyPlan.sharedKeys;
+    if ([keysToExclude count] != 0) {
+        NSMutableArray *filteredSharedKeys = [NSMutableArray arrayWithArray:sharedKeys];
+        [filteredSharedKeys removeObjectsInArray:[keysToExclude allObjects]];
+        sharedKeys = filteredSharedKeys;
+    }
+    [objectCopy setValuesForKeysWithDictionary:[object dictionaryWithValuesForKeys:sharedKeys]];
+    
+    // Owning to-many relationships: Deep copy of owned objects implementing the HLSManagedObjectCopying protocol
+    for (NSString *relationshipName in copyPlan.ownedToManyRelationshipNames) {
+        if ([keysToExclude containsObject:relationshipName]) {
             continue;
         }
-        [objectCopy setValue:[self valueForKey:attributeName] forKey:attributeName];
+        
+        NSSet *ownedObjects = [object valueForKey:relationshipName];
+        NSMutableSet *ownedObjectCopies = [NSMutableSet setWithCapacity:[ownedObjects count]];
+        for (NSManagedObject *ownedObject in ownedObjects) {
+            [ownedObjectCopies addObject:copyForOwnedObject(ownedObject, originalToCopyMap, pendingObjects)];
+        }
+        [objectCopy setValue:[NSSet setWithSet:ownedObjectCopies] forKey:relationshipName];
     }
     
-    // Copy relationships
-    NSDictionary *relationships = [entityDescription relationshipsByName];
-    for (NSString *relationshipName in [relationships allKeys]) {
+    // Owning to-one relationships: Same as above
+    for (NSString *relationshipName in copyPlan.ownedToOneRelationshipNames) {
         if ([keysToExclude containsObject:relationshipName]) {
             continue;
         }
         
-        // Deep copy owned objects implementing the NSManagedObjectCopying protocol
-        NSRelationshipDescription *relationshipDescription = [relationships objectForKey:relationshipName];
-        if ([relationshipDescription deleteRule] == NSCascadeDeleteRule) {
-            // To-many relationship
-            if ([relationshipDescription isToMany]) {
-                // The set of owned objects might be altered when we duplicate them below. To avoid iterating
-                // over mutating sets, we copy it first
-                NSSet *ownedObjects = [NSSet setWithSet:[managedObjectCopyable valueForKey:relationshipName]];
-                NSMutableSet *ownedObjectCopies = [NSMutableSet set];
-                for (NSManagedObject *ownedObject in ownedObjects) {
-                    NSManagedObject *ownedObjectCopy = [ownedObject duplicate];
-                    if (ownedObjectCopy) {
-                        [ownedObjectCopies addObject:ownedObjectCopy];
-                    }
-                    else {
-                        [ownedObjectCopies addObject:ownedObject];
-                    }   
-                }
-                [objectCopy setValue:[NSSet setWithSet:ownedObjectCopies] forKey:relationshipName];
-            }
-            // To-one relationship
-            else {
-                NSManagedObject *ownedObject = [managedObjectCopyable valueForKey:relationshipName];
-                NSManagedObject *ownedObjectCopy = [ownedObject duplicate];
-                if (ownedObjectCopy) {
-                    [objectCopy setValue:ownedObjectCopy forKey:relationshipName];
-                }
-                else {
-                    [objectCopy setValue:ownedObject forKey:relationshipName];
-                }
-            }
+        NSManagedObject *ownedObject = [object valueForKey:relationshipName];
+        if (ownedObject) {
+            [objectCopy setValue:copyForOwnedObject(ownedObject, originalToCopyMap, pendingObjects) forKey:relationshipName];
         }
-        // Shallow copy in all other cases
         else {
-            [objectCopy setValue:[managedObjectCopyable valueForKey:relationshipName] forKey:relationshipName];
+            [objectCopy setValue:nil forKey:relationshipName];
         }
     }
     
-    return objectCopy;
+    // Relationships to an owner: If the owner has been copied, the copy has already been attached to the owner copy 
+    // (inverse relationship). Otherwise shallow copy
+    for (NSString *relationshipName in copyPlan.ownerRelationshipNames) {
+        if ([keysToExclude containsObject:relationshipName]) {
+            continue;
+        }
+        
+        NSManagedObject *ownerObject = [object valueForKey:relationshipName];
+        if (! ownerObject || ! CFDictionaryGetValue(originalToCopyMap, ownerObject)) {
+            [objectCopy setValue:ownerObject forKey:relationshipName];
+        }
+    }
 }
 
-@end
+// Return the (cached) copy plan for an entity. Entities never change once a model is in use. Copies can be made in 
+// contexts living on any thread, access is therefore synchronized
+static HLSManagedObjectCopyPlan *copyPlanForEntity(NSEntityDescription *entityDescription)
+{
+    @synchronized([HLSManagedObjectCopyPlan class]) {
+        if (! s_entityToCopyPlanMap) {
+            CFDictionaryKeyCallBacks keyCallBacks = kCFTypeDictionaryKeyCallBacks;
+            keyCallBacks.equal = NULL;
+            keyCallBacks.hash = NULL;
+            s_entityToCopyPlanMap = CFDictionaryCreateMutable(kCFAllocatorDefault, 0, &keyCallBacks, &kCFTypeDictionaryValueCallBacks);
+        }
+        
+        HLSManagedObjectCopyPlan *copyPlan = (HLSManagedObjectCopyPlan *)CFDictionaryGetValue(s_entityToCopyPlanMap, entityDescription);
+        if (! copyPlan) {
+            copyPlan = [[[HLSManagedObjectCopyPlan alloc] initWithEntityDescription:entityDescription] autorelease];
+            CFDictionarySetValue(s_entityToCopyPlanMap, entityDescription, copyPlan);
+        }
+        return copyPlan;
+    }
+}
+
+static NSString *fetchTemplateKey(Class managedObjectClass, NSString *name)
+{
+    return [NSString stringWithFormat:@"%@|%@", [managedObjectClass className], name];
+}
+
+/**
+ * Execute a fetch request, recording it under a template name (nil if none) when instrumentation is enabled
+ */
+static NSArray *objectsWithFetchRequest(NSFetchRequest *fetchRequest, NSManagedObjectContext *managedObjectContext, NSString *templateName)
+{
+    if (! managedObjectContext) {
+        HLSLoggerError(@"Missing managed object context");
+        return nil;
+    }
+    
+    if (! fetchRequest) {
+        HLSLoggerError(@"Missing fetch request");
+        return nil;
+    }
+    
+    NSError *error = nil;
+    NSArray *objects = nil;
+    if ([HLSModelInstrumentation isEnabled]) {
+        objects = [[HLSModelInstrumentation sharedInstrumentation] executeFetchRequest:fetchRequest
+                                                                inManagedObjectContext:managedObjectContext
+                                                                          templateName:templateName
+                                                                                 error:&error];
+    }
+    else {
+        objects = [managedObjectContext executeFetchRequest:fetchRequest error:&error];
+    }
+    if (error) {
+        HLSLoggerError(@"Could not retrieve objects; reason: %@", error);
+        return nil;
+    }
+    
+    return objects;
+}
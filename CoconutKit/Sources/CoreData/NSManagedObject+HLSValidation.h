@@ -114,15 +114,38 @@
  */
 - (BOOL)check:(NSError **)pError;
 
+/**
+ * Check several objects as a whole (same as calling -check: on each of them), e.g. before saving a large import. 
+ * All objects are checked, and errors are combined into a single (flat) NSValidationMultipleErrorsError if several 
+ * are found. Returns YES iff all objects are valid
+ *
+ * Validation methods access the objects they validate and must therefore be called from the thread of their context. 
+ * Objects are checked one after the other on the calling thread, which must be this thread
+ */
++ (BOOL)checkObjects:(NSArray *)managedObjects error:(NSError **)pError;
+
 /**
  * Subclasses of NSManagedObject can override this method to perform additional consistency validations when
  * inserted or updated objects are committed (i.e. when the managed object context they live in is saved).
  * This defaut implementation does nothing and returns YES.
  *
  * When implementing this method, you do not have to (and should not) call the method on super first.
+ *
+ * When an updated object is saved, only its changed properties are validated individually. The consistency check
+ * is always called, unless the class implementing it also implements +keysAffectingConsistency (see below)
  */
 - (BOOL)checkForConsistency:(NSError **)pError;
 
+/**
+ * Return the keys the -checkForConsistency: method implemented by a class depends on. When an updated object is saved,
+ * this check is skipped if none of these keys has changed. This default implementation returns nil, which means that
+ * the check is always performed. The set is read once when the class is initialized and applies to the -checkForConsistency:
+ * implementation of this class level only (subclasses implementing their own check must declare their own keys)
+ *
+ * When implementing this method, you do not have to (and should not) call the method on super first.
+ */
++ (NSSet *)keysAffectingConsistency;
+
 /**
  * Same as -checkForConsistency: (see above), but when an object deletion is committed
  */
@@ -12,11 +12,13 @@
 #import "HLSLogger.h"
 #import "HLSModelManager.h"
 #import "HLSRuntime.h"
+#import "NSArray+HLSExtensions.h"
 #import "NSDictionary+HLSExtensions.h"
 #import "NSError+HLSExtensions.h"
 #import "NSObject+HLSExtensions.h"
 #import "UITextField+HLSValidation.h"
 
+#import <libkern/OSAtomic.h>
 #import <objc/runtime.h>
 
 // Return YES iff injection has been enabled. External linkage, but not public
@@ -25,6 +27,17 @@ BOOL injectedManagedObjectValidation(void);
 // Variables with internal linkage
 static BOOL s_injectedManagedObjectValidation = NO;
 
+// Resolution tables filled when managed object classes are initialized, so that validation does not need to derive
+// selectors from strings or to walk method lists. Keys and values are not retained (selectors, classes and IMPs)
+static CFMutableDictionaryRef s_validationSelectorToCheckSelectorMap = NULL;
+static CFMutableDictionaryRef s_classToConsistencyCheckImpMap = NULL;      // IMP of -checkForConsistency: at each class level
+static CFMutableDictionaryRef s_classToDeleteCheckImpMap = NULL;           // IMP of -checkForDelete: at each class level
+static CFMutableDictionaryRef s_classToConsistencyKeysMap = NULL;          // +keysAffectingConsistency at each class level (retained)
+static OSSpinLock s_resolutionTablesLock = OS_SPINLOCK_INIT;
+
+// Number of objects checked between two autorelease pool drains
+static const NSUInteger kCheckObjectsBatchSize = 200;
+
 // Original implementation of the methods we swizzle
 static void (*s_NSManagedObject__initialize_Imp)(id, SEL) = NULL;
 
@@ -34,9 +47,13 @@ static void swizzled_NSManagedObject__initialize_Imp(Class self, SEL _cmd);
 // Static helper functions
 static Method instanceMethodOnClass(Class class, SEL sel);
 static SEL checkSelectorForValidationSelector(SEL sel);
+static SEL cachedCheckSelectorForValidationSelector(SEL sel);
+static IMP checkImpOnClass(Class class, SEL checkSel);
+static BOOL isConsistencyCheckAffectedOnClass(Class class, NSDictionary *changedValues);
 static BOOL validateProperty(id self, SEL sel, id *pValue, NSError **pError);
 static BOOL validateObjectConsistency(id self, SEL sel, NSError **pError);
-static BOOL validateObjectConsistencyInClassHierarchy(id self, Class class, SEL sel, NSError **pError);
+static BOOL validateChangedProperties(id self, NSDictionary *changedValues, NSError **pError);
+static BOOL validateObjectConsistencyInClassHierarchy(id self, Class class, SEL sel, NSDictionary *changedValues, NSError **pError);
 
 #pragma mark -
 #pragma mark HLSValidationPrivate category interface
@@ -47,6 +64,8 @@ static BOOL validateObjectConsistencyInClassHierarchy(id self, Class class, SEL
 
 + (NSError *)flattenHiearchyForError:(NSError *)error;
 
++ (NSError *)combinedErrorWithErrors:(NSArray *)errors;
+
 @end
 
 #pragma mark -
@@ -63,6 +82,11 @@ static BOOL validateObjectConsistencyInClassHierarchy(id self, Class class, SEL
         return;
     }
     
+    s_validationSelectorToCheckSelectorMap = CFDictionaryCreateMutable(kCFAllocatorDefault, 0, NULL, NULL);
+    s_classToConsistencyCheckImpMap = CFDictionaryCreateMutable(kCFAllocatorDefault, 0, NULL, NULL);
+    s_classToDeleteCheckImpMap = CFDictionaryCreateMutable(kCFAllocatorDefault, 0, NULL, NULL);
+    s_classToConsistencyKeysMap = CFDictionaryCreateMutable(kCFAllocatorDefault, 0, NULL, &kCFTypeDictionaryValueCallBacks);
+    
     s_NSManagedObject__initialize_Imp = (void (*)(id, SEL))HLSSwizzleClassSelector(self,
                                                                                    @selector(initialize), 
                                                                                    (IMP)swizzled_NSManagedObject__initialize_Imp);
@@ -88,8 +112,45 @@ static BOOL validateObjectConsistencyInClassHierarchy(id self, Class class, SEL
     return [self validateForInsert:pError];
 }
 
++ (BOOL)checkObjects:(NSArray *)managedObjects error:(NSError **)pError
+{
+    HLSAssertObjectsInEnumerationAreKindOfClass(managedObjects, NSManagedObject);
+    NSAssert(injectedManagedObjectValidation(), @"Managed object validation not injected. Call HLSEnableNSManagedObjectValidation first");
+    
+    // Collect errors (survive pool drains) and combine them at the end
+    NSMutableArray *errors = pError ? [NSMutableArray array] : nil;
+    BOOL valid = YES;
+    NSUInteger count = [managedObjects count];
+    for (NSUInteger i = 0; i < count; i += kCheckObjectsBatchSize) {
+        NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+        NSUInteger end = MIN(i + kCheckObjectsBatchSize, count);
+        for (NSUInteger j = i; j < end; ++j) {
+            NSManagedObject *managedObject = [managedObjects objectAtIndex:j];
+            NSError *error = nil;
+            if (! [managedObject check:pError ? &error : NULL]) {
+                valid = NO;
+                if (error) {
+                    [errors addObject:error];
+                }
+            }
+        }
+        [pool drain];
+    }
+    
+    if (pError) {
+        *pError = [NSManagedObject combinedErrorWithErrors:errors];
+    }
+    
+    return valid;
+}
+
 #pragma mark Global validation method stubs
 
++ (NSSet *)keysAffectingConsistency
+{
+    return nil;
+}
+
 - (BOOL)checkForConsistency:(NSError **)pError
 {
     return YES;
@@ -238,18 +299,18 @@ static BOOL validateObjectConsistencyInClassHierarchy(id self, Class class, SEL
     
     // Flatten out errors if necessary
     BOOL flattened = NO;
-    NSArray *flattenedErrors = [NSArray array];
+    NSMutableArray *flattenedErrors = [NSMutableArray arrayWithCapacity:[errors count]];
     for (NSError *error in errors) {
         // Not a nested mulitple error. Nothing to do
         if (! [error hasCode:NSValidationMultipleErrorsError withinDomain:NSCocoaErrorDomain]) {
-            flattenedErrors = [flattenedErrors arrayByAddingObject:error];
+            [flattenedErrors addObject:error];
             continue;
         }
         
         // Flatten out nested errors
         NSArray *errorsInError = [[error userInfo] objectForKey:NSDetailedErrorsKey];
         if ([errorsInError count] != 0) {
-            flattenedErrors = [flattenedErrors arrayByAddingObjectsFromArray:errorsInError];
+            [flattenedErrors addObjectsFromArray:errorsInError];
         }
         
         flattened = YES;
@@ -261,7 +322,48 @@ static BOOL validateObjectConsistencyInClassHierarchy(id self, Class class, SEL
     }
     
     // Return the flattened error
-    userInfo = [userInfo dictionaryBySettingObject:flattenedErrors forKey:NSDetailedErrorsKey];
+    userInfo = [userInfo dictionaryBySettingObject:[NSArray arrayWithArray:flattenedErrors] forKey:NSDetailedErrorsKey];
+    return [NSError errorWithDomain:NSCocoaErrorDomain
+                               code:NSValidationMultipleErrorsError 
+                           userInfo:userInfo];
+}
+
+/**
+ * Combine a list of errors at once, in linear time (+combineError:withError: has to create a new error and a new 
+ * error list each time an error is added). Multiple errors in the list are flattened out, so that the result is
+ * either a single error or a flat multiple error. Returns nil if the list is empty
+ */
++ (NSError *)combinedErrorWithErrors:(NSArray *)errors
+{
+    if ([errors count] == 0) {
+        return nil;
+    }
+    else if ([errors count] == 1) {
+        return [self flattenHiearchyForError:[errors firstObject_hls]];
+    }
+    
+    NSMutableArray *flattenedErrors = [NSMutableArray arrayWithCapacity:[errors count]];
+    for (NSError *error in errors) {
+        if ([error hasCode:NSValidationMultipleErrorsError withinDomain:NSCocoaErrorDomain]) {
+            NSArray *errorsInError = [[error userInfo] objectForKey:NSDetailedErrorsKey];
+            if ([errorsInError count] != 0) {
+                // Nested errors might themselves be multiple errors
+                for (NSError *errorInError in errorsInError) {
+                    if ([errorInError hasCode:NSValidationMultipleErrorsError withinDomain:NSCocoaErrorDomain]) {
+                        [flattenedErrors addObjectsFromArray:[[errorInError userInfo] objectForKey:NSDetailedErrorsKey]];
+                    }
+                    else {
+                        [flattenedErrors addObject:errorInError];
+                    }
+                }
+            }
+        }
+        else {
+            [flattenedErrors addObject:error];
+        }
+    }
+    
+    NSDictionary *userInfo = [NSDictionary dictionaryWithObject:[NSArray arrayWithArray:flattenedErrors] forKey:NSDetailedErrorsKey];
     return [NSError errorWithDomain:NSCocoaErrorDomain
                                code:NSValidationMultipleErrorsError 
                            userInfo:userInfo];
@@ -298,7 +400,8 @@ static Method instanceMethodOnClass(Class class, SEL sel)
 }
 
 /**
- * Return the check selector associated with a validation selector
+ * Return the check selector associated with a validation selector. Involves string manipulations, use the cached
+ * version when validating
  */
 static SEL checkSelectorForValidationSelector(SEL sel)
 {
@@ -314,6 +417,84 @@ static SEL checkSelectorForValidationSelector(SEL sel)
     }    
 }
 
+/**
+ * Same as checkSelectorForValidationSelector, but using the table filled when injecting validation methods
+ */
+static SEL cachedCheckSelectorForValidationSelector(SEL sel)
+{
+    if (sel == @selector(validateForInsert:) || sel == @selector(validateForUpdate:)) {
+        return @selector(checkForConsistency:);
+    }
+    else if (sel == @selector(validateForDelete:)) {
+        return @selector(checkForDelete:);
+    }
+    
+    OSSpinLockLock(&s_resolutionTablesLock);
+    SEL checkSel = (SEL)CFDictionaryGetValue(s_validationSelectorToCheckSelectorMap, sel);
+    OSSpinLockUnlock(&s_resolutionTablesLock);
+    
+    // Validation selector not injected by us (should not happen). Resolve it
+    if (! checkSel) {
+        checkSel = checkSelectorForValidationSelector(sel);
+    }
+    return checkSel;
+}
+
+/**
+ * Return the implementation of a global check method defined by a class (not by its parents), NULL if none.
+ * Implementations are recorded when the class is initialized
+ */
+static IMP checkImpOnClass(Class class, SEL checkSel)
+{
+    CFMutableDictionaryRef classToCheckImpMap = NULL;
+    if (checkSel == @selector(checkForConsistency:)) {
+        classToCheckImpMap = s_classToConsistencyCheckImpMap;
+    }
+    else if (checkSel == @selector(checkForDelete:)) {
+        classToCheckImpMap = s_classToDeleteCheckImpMap;
+    }
+    else {
+        Method method = instanceMethodOnClass(class, checkSel);
+        return method ? method_getImplementation(method) : NULL;
+    }
+    
+    const void *imp = NULL;
+    OSSpinLockLock(&s_resolutionTablesLock);
+    Boolean found = CFDictionaryGetValueIfPresent(classToCheckImpMap, class, &imp);
+    OSSpinLockUnlock(&s_resolutionTablesLock);
+    
+    // Class not recorded yet (should not happen since superclasses are initialized first). Resolve it
+    if (! found) {
+        Method method = instanceMethodOnClass(class, checkSel);
+        return method ? method_getImplementation(method) : NULL;
+    }
+    return (IMP)imp;
+}
+
+/**
+ * Return YES iff the -checkForConsistency: method defined at a class level must be called when an object with the
+ * given changed values is updated, i.e. if this class level does not declare the keys its check depends on, or if
+ * one of them has changed
+ */
+static BOOL isConsistencyCheckAffectedOnClass(Class class, NSDictionary *changedValues)
+{
+    OSSpinLockLock(&s_resolutionTablesLock);
+    NSSet *keys = [[(NSSet *)CFDictionaryGetValue(s_classToConsistencyKeysMap, class) retain] autorelease];
+    OSSpinLockUnlock(&s_resolutionTablesLock);
+    
+    // No dependencies declared: Always check
+    if (! keys) {
+        return YES;
+    }
+    
+    for (NSString *key in keys) {
+        if ([changedValues objectForKey:key]) {
+            return YES;
+        }
+    }
+    return NO;
+}
+
 #pragma mark Validation
 
 /**
@@ -324,15 +505,15 @@ static SEL checkSelectorForValidationSelector(SEL sel)
  */
 static BOOL validateProperty(id self, SEL sel, id *pValue, NSError **pError)
 {
-    // If the check method does not exist, the field is valid
-    SEL checkSel = checkSelectorForValidationSelector(sel);
-    Method method = class_getInstanceMethod([self class], checkSel);
-    if (! method) {
+    // If the check method does not exist, the field is valid. The runtime method cache makes this test cheap
+    SEL checkSel = cachedCheckSelectorForValidationSelector(sel);
+    Class class = [self class];
+    if (! class_respondsToSelector(class, checkSel)) {
         return YES;
     }
     
     // Get the check method implementation
-    BOOL (*checkImp)(id, SEL, id, NSError **) = (BOOL (*)(id, SEL, id, NSError **))method_getImplementation(method);
+    BOOL (*checkImp)(id, SEL, id, NSError **) = (BOOL (*)(id, SEL, id, NSError **))class_getMethodImplementation(class, checkSel);
     
     // Check
     NSError *newError = nil;
@@ -365,7 +546,37 @@ static BOOL validateProperty(id self, SEL sel, id *pValue, NSError **pError)
  */
 static BOOL validateObjectConsistency(id self, SEL sel, NSError **pError)
 {
-    return validateObjectConsistencyInClassHierarchy(self, [self class], sel, pError);
+    // When updating, only changed properties (and consistency checks depending on them) need to be validated, the
+    // other ones were already validated when the object was last saved. Objects are fully validated otherwise
+    NSDictionary *changedValues = (sel == @selector(validateForUpdate:)) ? [self changedValues] : nil;
+    return validateObjectConsistencyInClassHierarchy(self, [self class], sel, changedValues, pError);
+}
+
+/**
+ * Perform individual validations for the changed properties of an updated object only (-[NSManagedObject validateForUpdate:]
+ * would validate all properties). Validation goes through -validateValue:forKey:error:, so that the validation logic
+ * of the xcdatamodel is triggered as well
+ */
+static BOOL validateChangedProperties(id self, NSDictionary *changedValues, NSError **pError)
+{
+    NSMutableArray *errors = pError ? [NSMutableArray array] : nil;
+    BOOL valid = YES;
+    for (NSString *key in [changedValues allKeys]) {
+        id value = [self valueForKey:key];
+        NSError *error = nil;
+        if (! [self validateValue:&value forKey:key error:pError ? &error : NULL]) {
+            valid = NO;
+            if (error) {
+                [errors addObject:error];
+            }
+        }
+    }
+    
+    if (pError) {
+        *pError = [NSManagedObject combinedErrorWithErrors:errors];
+    }
+    
+    return valid;
 }
 
 /**
@@ -373,10 +584,20 @@ static BOOL validateObjectConsistency(id self, SEL sel, NSError **pError)
  * it the selector given as parameter (using the implementation defined for it by the class given as parameter). This 
  * method can therefore be used to check global object consistency at all levels of the managed object inheritance hierarchy
  */
-static BOOL validateObjectConsistencyInClassHierarchy(id self, Class class, SEL sel, NSError **pError)
+static BOOL validateObjectConsistencyInClassHierarchy(id self, Class class, SEL sel, NSDictionary *changedValues, NSError **pError)
 {
     // Top of the managed object hierarchy
     if (class == [NSManagedObject class]) {
+        // Update: Only validate changed properties
+        if (changedValues) {
+            NSError *newError = nil;
+            if (! validateChangedProperties(self, changedValues, &newError)) {
+                [NSManagedObject combineError:newError withError:pError];
+                return NO;
+            }
+            return YES;
+        }
+        
         // Get the implementation. This method exists on NSManagedObject, no need to test if responding to selector
         BOOL (*imp)(id, SEL, NSError **) = (BOOL (*)(id, SEL, NSError **))class_getMethodImplementation(class, sel);
         
@@ -398,21 +619,25 @@ static BOOL validateObjectConsistencyInClassHierarchy(id self, Class class, SEL
         
         // Climb up the inheritance hierarchy
         NSError *newError = nil;
-        if (! validateObjectConsistencyInClassHierarchy(self, class_getSuperclass(class), sel, &newError)) {
+        if (! validateObjectConsistencyInClassHierarchy(self, class_getSuperclass(class), sel, changedValues, &newError)) {
             [NSManagedObject combineError:newError withError:pError];
             valid = NO;
         }
         
         // Find whether a check method has been defined at this class hierarchy level. If none is found, valid 
         // (i.e. we do not alter the above validation status)
-        SEL checkSel = checkSelectorForValidationSelector(sel);
-        Method method = instanceMethodOnClass(class, checkSel);
-        if (! method) {
+        SEL checkSel = cachedCheckSelectorForValidationSelector(sel);
+        BOOL (*checkImp)(id, SEL, NSError **) = (BOOL (*)(id, SEL, NSError **))checkImpOnClass(class, checkSel);
+        if (! checkImp) {
+            return valid;
+        }
+        
+        // Update: Skip the check if none of the keys it depends on has changed
+        if (changedValues && ! isConsistencyCheckAffectedOnClass(class, changedValues)) {
             return valid;
         }
         
         // A check method has been found. Call the underlying check method implementation
-        BOOL (*checkImp)(id, SEL, NSError **) = (BOOL (*)(id, SEL, NSError **))method_getImplementation(method);
         NSError *newCheckError = nil;
         if (! (*checkImp)(self, checkSel, &newCheckError)) {
             if (! newCheckError) {
@@ -455,6 +680,22 @@ static void swizzled_NSManagedObject__initialize_Imp(Class self, SEL _cmd)
     // No class identity test here. This must be executed for all objects in the hierarchy rooted at NSManagedObject, so that we can
     // locate the @dynamic properties we are interested in (those which need validation)
     
+    // Record the global check methods defined at this class level (NULL if none), so that validation along the class 
+    // hierarchy does not need to walk method lists
+    Method consistencyCheckMethod = instanceMethodOnClass(self, @selector(checkForConsistency:));
+    Method deleteCheckMethod = instanceMethodOnClass(self, @selector(checkForDelete:));
+    
+    // Same for the keys the consistency check depends on (only if declared at this class level)
+    NSSet *consistencyKeys = instanceMethodOnClass(object_getClass(self), @selector(keysAffectingConsistency)) ? [self keysAffectingConsistency] : nil;
+    
+    OSSpinLockLock(&s_resolutionTablesLock);
+    CFDictionarySetValue(s_classToConsistencyCheckImpMap, self, consistencyCheckMethod ? method_getImplementation(consistencyCheckMethod) : NULL);
+    CFDictionarySetValue(s_classToDeleteCheckImpMap, self, deleteCheckMethod ? method_getImplementation(deleteCheckMethod) : NULL);
+    if (consistencyKeys) {
+        CFDictionarySetValue(s_classToConsistencyKeysMap, self, consistencyKeys);
+    }
+    OSSpinLockUnlock(&s_resolutionTablesLock);
+    
     // Inject validation methods for each managed object property
     unsigned int numberOfProperties = 0;
     objc_property_t *properties = class_copyPropertyList(self, &numberOfProperties);
@@ -479,8 +720,9 @@ static void swizzled_NSManagedObject__initialize_Imp(Class self, SEL _cmd)
         //   - (BOOL)validate<fieldName>:(id *)pValue error:(NSError **)pError
         NSString *validationSelectorName = [NSString stringWithFormat:@"validate%@%@:error:", [[propertyName substringToIndex:1] uppercaseString], 
                                             [propertyName substringFromIndex:1]];
+        SEL validationSel = NSSelectorFromString(validationSelectorName);
         if (! class_addMethod(self, 
-                              NSSelectorFromString(validationSelectorName),         // Remark: (SEL)[validationSelectorName cStringUsingEncoding:NSUTF8StringEncoding] 
+                              validationSel,         // Remark: (SEL)[validationSelectorName cStringUsingEncoding:NSUTF8StringEncoding] 
                               // does NOT work (returns YES, but IMP does not get called since the selector has not 
                               // been properly registered in this case)
                               (IMP)validateProperty, 
@@ -491,6 +733,12 @@ static void swizzled_NSManagedObject__initialize_Imp(Class self, SEL _cmd)
         
         HLSLoggerDebug(@"Automatically added validation wrapper %@ on class %@", validationSelectorName, self);
         
+        // Resolve the corresponding check selector once
+        SEL checkSel = checkSelectorForValidationSelector(validationSel);
+        OSSpinLockLock(&s_resolutionTablesLock);
+        CFDictionarySetValue(s_validationSelectorToCheckSelectorMap, validationSel, checkSel);
+        OSSpinLockUnlock(&s_resolutionTablesLock);
+        
         added = YES;
     }
     free(properties);
@@ -0,0 +1,68 @@
+//
+//  HLSLogFileSink.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+/**
+ * Private class used by HLSLogger to write log entries to disk through the default HLSFileManager. Entries are
+ * accumulated in memory and written in batches. Log files are segments named after a file path given at creation
+ * (e.g. /path/to/log-20121014-120000.txt for /path/to/log.txt), a new segment being started when the current one
+ * is too large or too old. Only the most recent segments are kept.
+ *
+ * Not thread-safe. Use from a single thread (the HLSLogger writer thread)
+ *
+ * Designated initializer: -initWithFilePath:
+ */
+@interface HLSLogFileSink : NSObject {
+@private
+    NSString *m_directoryPath;
+    NSString *m_baseName;
+    NSString *m_extension;
+    unsigned long long m_maximumFileSize;
+    NSTimeInterval m_maximumFileAge;
+    NSUInteger m_maximumFileCount;
+    NSMutableData *m_buffer;
+    NSString *m_currentFilePath;
+    unsigned long long m_currentFileSize;
+    NSDate *m_currentFileCreationDate;
+}
+
+- (id)initWithFilePath:(NSString *)filePath;
+
+/**
+ * Size (in bytes) and age above which a new segment is started. Defaults are 1 MB and one day
+ */
+@property (nonatomic, assign) unsigned long long maximumFileSize;
+@property (nonatomic, assign) NSTimeInterval maximumFileAge;
+
+/**
+ * Number of segments to keep (including the current one). Default is 5
+ */
+@property (nonatomic, assign) NSUInteger maximumFileCount;
+
+/**
+ * Start a new segment if the current one is too old or cannot receive length more bytes. Return YES iff a new segment
+ * has been started. Called by -appendBytes:length:, but can be called beforehand if a group of bytes must not be split
+ * between two segments
+ */
+- (BOOL)startNewSegmentIfNeededForLength:(NSUInteger)length;
+
+/**
+ * Add bytes to the buffer, writing it if it has grown large
+ */
+- (void)appendBytes:(const void *)bytes length:(NSUInteger)length;
+
+/**
+ * Write all buffered bytes to disk
+ */
+- (void)flush;
+
+/**
+ * Paths of the log segments, from the oldest to the most recent one
+ */
+- (NSArray *)logFilePaths;
+
+@end
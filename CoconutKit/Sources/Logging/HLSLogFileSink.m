@@ -0,0 +1,258 @@
+//
+//  HLSLogFileSink.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSLogFileSink.h"
+
+#import "HLSAssert.h"
+#import "HLSFileManager.h"
+
+// Buffered bytes are written when this size is reached
+static const NSUInteger kLogFileSinkBufferSize = 64 * 1024;
+
+static NSString * const kLogFileSinkDateFormat = @"yyyyMMdd'-'HHmmss";
+
+@interface HLSLogFileSink ()
+
+@property (nonatomic, retain) NSString *directoryPath;
+@property (nonatomic, retain) NSString *baseName;
+@property (nonatomic, retain) NSString *extension;
+@property (nonatomic, retain) NSMutableData *buffer;
+@property (nonatomic, retain) NSString *currentFilePath;
+@property (nonatomic, retain) NSDate *currentFileCreationDate;
+
++ (NSDateFormatter *)fileNameDateFormatter;
+
+- (NSString *)segmentFileNameForDate:(NSDate *)date;
+- (NSDate *)creationDateForSegmentFileName:(NSString *)fileName;
+
+- (void)restoreCurrentSegment;
+- (void)startNewSegment;
+- (void)removeOldSegments;
+
+@end
+
+@implementation HLSLogFileSink
+
+#pragma mark Class methods
+
++ (NSDateFormatter *)fileNameDateFormatter
+{
+    static NSDateFormatter *s_dateFormatter = nil;
+    if (! s_dateFormatter) {
+        s_dateFormatter = [[NSDateFormatter alloc] init];
+        [s_dateFormatter setLocale:[[[NSLocale alloc] initWithLocaleIdentifier:@"en_US_POSIX"] autorelease]];
+        [s_dateFormatter setDateFormat:kLogFileSinkDateFormat];
+    }
+    return s_dateFormatter;
+}
+
+#pragma mark Object creation and destruction
+
+- (id)initWithFilePath:(NSString *)filePath
+{
+    if ((self = [super init])) {
+        self.directoryPath = [filePath stringByDeletingLastPathComponent];
+        self.baseName = [[filePath lastPathComponent] stringByDeletingPathExtension];
+        self.extension = [filePath pathExtension];
+        self.maximumFileSize = 1024 * 1024;
+        self.maximumFileAge = 24. * 60. * 60.;
+        self.maximumFileCount = 5;
+        self.buffer = [NSMutableData dataWithCapacity:kLogFileSinkBufferSize];
+        
+        [self restoreCurrentSegment];
+    }
+    return self;
+}
+
+- (id)init
+{
+    HLSForbiddenInheritedMethod();
+    return nil;
+}
+
+- (void)dealloc
+{
+    [self flush];
+    
+    self.directoryPath = nil;
+    self.baseName = nil;
+    self.extension = nil;
+    self.buffer = nil;
+    self.currentFilePath = nil;
+    self.currentFileCreationDate = nil;
+    
+    [super dealloc];
+}
+
+#pragma mark Accessors and mutators
+
+@synthesize directoryPath = m_directoryPath;
+
+@synthesize baseName = m_baseName;
+
+@synthesize extension = m_extension;
+
+@synthesize maximumFileSize = m_maximumFileSize;
+
+@synthesize maximumFileAge = m_maximumFileAge;
+
+@synthesize maximumFileCount = m_maximumFileCount;
+
+- (void)setMaximumFileCount:(NSUInteger)maximumFileCount
+{
+    m_maximumFileCount = MAX(maximumFileCount, 1);
+}
+
+@synthesize buffer = m_buffer;
+
+@synthesize currentFilePath = m_currentFilePath;
+
+@synthesize currentFileCreationDate = m_currentFileCreationDate;
+
+#pragma mark Writing
+
+- (BOOL)startNewSegmentIfNeededForLength:(NSUInteger)length
+{
+    if (self.currentFilePath
+            && m_currentFileSize + [self.buffer length] + length <= self.maximumFileSize
+            && [[NSDate date] timeIntervalSinceDate:self.currentFileCreationDate] < self.maximumFileAge) {
+        return NO;
+    }
+    
+    // Buffered bytes belong to the current segment
+    [self flush];
+    
+    NSString *previousFilePath = [[self.currentFilePath retain] autorelease];
+    [self startNewSegment];
+    return ! [self.currentFilePath isEqualToString:previousFilePath];
+}
+
+- (void)appendBytes:(const void *)bytes length:(NSUInteger)length
+{
+    [self startNewSegmentIfNeededForLength:length];
+    
+    [self.buffer appendBytes:bytes length:length];
+    if ([self.buffer length] >= kLogFileSinkBufferSize) {
+        [self flush];
+    }
+}
+
+- (void)flush
+{
+    if ([self.buffer length] == 0) {
+        return;
+    }
+    
+    NSError *error = nil;
+    if (! [[HLSFileManager defaultManager] appendContents:self.buffer toFileAtPath:self.currentFilePath error:&error]) {
+        // Cannot use HLSLogger here
+        NSLog(@"[ERROR] Could not write log file %@. Reason: %@", self.currentFilePath, error);
+    }
+    else {
+        m_currentFileSize += [self.buffer length];
+    }
+    [self.buffer setLength:0];
+}
+
+#pragma mark Segments
+
+- (NSString *)segmentFileNameForDate:(NSDate *)date
+{
+    NSString *fileName = [NSString stringWithFormat:@"%@-%@", self.baseName, [[HLSLogFileSink fileNameDateFormatter] stringFromDate:date]];
+    if ([self.extension length] != 0) {
+        fileName = [fileName stringByAppendingPathExtension:self.extension];
+    }
+    return fileName;
+}
+
+- (NSDate *)creationDateForSegmentFileName:(NSString *)fileName
+{
+    NSString *prefix = [self.baseName stringByAppendingString:@"-"];
+    if (! [fileName hasPrefix:prefix] || ! [[fileName pathExtension] isEqualToString:self.extension]) {
+        return nil;
+    }
+    
+    NSString *dateString = [[fileName stringByDeletingPathExtension] substringFromIndex:[prefix length]];
+    return [[HLSLogFileSink fileNameDateFormatter] dateFromString:dateString];
+}
+
+- (NSArray *)logFilePaths
+{
+    NSArray *fileNames = [[HLSFileManager defaultManager] contentsOfDirectoryAtPath:self.directoryPath error:NULL];
+    
+    // The date format ensures that the alphabetical order is the chronological one
+    NSMutableArray *logFilePaths = [NSMutableArray array];
+    for (NSString *fileName in [fileNames sortedArrayUsingSelector:@selector(compare:)]) {
+        if ([self creationDateForSegmentFileName:fileName]) {
+            [logFilePaths addObject:[self.directoryPath stringByAppendingPathComponent:fileName]];
+        }
+    }
+    return [NSArray arrayWithArray:logFilePaths];
+}
+
+- (void)restoreCurrentSegment
+{
+    // Continue with the most recent segment, if any
+    NSString *lastFilePath = [[self logFilePaths] lastObject];
+    if (! lastFilePath) {
+        return;
+    }
+    
+    self.currentFilePath = lastFilePath;
+    self.currentFileCreationDate = [self creationDateForSegmentFileName:[lastFilePath lastPathComponent]];
+    
+    // Get the size from the file attributes, without reading the file
+    HLSFileManager *fileManager = [HLSFileManager defaultManager];
+    m_currentFileSize = 0;
+    for (HLSDirectoryEntry *entry in [fileManager entriesOfDirectoryAtPath:self.directoryPath error:NULL]) {
+        if ([entry.path isEqualToString:lastFilePath]) {
+            m_currentFileSize = entry.size;
+            break;
+        }
+    }
+    
+    // File managers which cannot provide sizes report 0. Read the file instead (mapped by file managers supporting it)
+    if (m_currentFileSize == 0) {
+        m_currentFileSize = [[fileManager contentsOfFileAtPath:lastFilePath error:NULL] length];
+    }
+}
+
+- (void)startNewSegment
+{
+    HLSFileManager *fileManager = [HLSFileManager defaultManager];
+    if (! [fileManager fileExistsAtPath:self.directoryPath]) {
+        [fileManager createDirectoryAtPath:self.directoryPath withIntermediateDirectories:YES error:NULL];
+    }
+    
+    NSDate *date = [NSDate date];
+    NSString *filePath = [self.directoryPath stringByAppendingPathComponent:[self segmentFileNameForDate:date]];
+    
+    // Two segments cannot be started the same second (names would collide). Keep the current one
+    if ([filePath isEqualToString:self.currentFilePath]) {
+        return;
+    }
+    
+    self.currentFilePath = filePath;
+    self.currentFileCreationDate = date;
+    m_currentFileSize = 0;
+    
+    [self removeOldSegments];
+}
+
+- (void)removeOldSegments
+{
+    NSArray *logFilePaths = [self logFilePaths];
+    
+    // The current segment has not been created yet
+    NSInteger numberOfFilesToRemove = (NSInteger)[logFilePaths count] - (NSInteger)self.maximumFileCount + 1;
+    for (NSInteger i = 0; i < numberOfFilesToRemove; ++i) {
+        [[HLSFileManager defaultManager] removeItemAtPath:[logFilePaths objectAtIndex:i] error:NULL];
+    }
+}
+
+@end
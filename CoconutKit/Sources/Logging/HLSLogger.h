@@ -6,25 +6,138 @@
 //  Copyright 2010 Hortis. All rights reserved.
 //
 
+#include <libkern/OSAtomic.h>
+
 /**
  * Logging macros. Only active if HLS_LOGGER is added to your configuration preprocessor flags (-DHLS_LOGGER)
+ *
+ * Macros for levels below a minimum can be stripped at compile time by setting HLS_LOGGER_MINIMUM_LEVEL in your 
+ * preprocessor flags to 0 (DEBUG, the default), 1 (INFO), 2 (WARN), 3 (ERROR) or 4 (FATAL). For example, with 
+ * -DHLS_LOGGER_MINIMUM_LEVEL=2, debug and info messages are not compiled at all, whatever the level set at runtime
  */
+#ifndef HLS_LOGGER_MINIMUM_LEVEL
+#define HLS_LOGGER_MINIMUM_LEVEL                0
+#endif
+
 #ifdef HLS_LOGGER
 
-// Note the ## in front of __VA_ARGS__ to support 0 variable arguments
-#define HLSLoggerDebug(format, ...)	[[HLSLogger sharedLogger] debug:[NSString stringWithFormat:@"(%s) - %@", __PRETTY_FUNCTION__, [NSString stringWithFormat:format, ## __VA_ARGS__]]]
-#define HLSLoggerInfo(format, ...)	[[HLSLogger sharedLogger] info:[NSString stringWithFormat:@"(%s) - %@", __PRETTY_FUNCTION__, [NSString stringWithFormat:format, ## __VA_ARGS__]]]
-#define HLSLoggerWarn(format, ...)	[[HLSLogger sharedLogger] warn:[NSString stringWithFormat:@"(%s) - %@", __PRETTY_FUNCTION__, [NSString stringWithFormat:format, ## __VA_ARGS__]]]
-#define HLSLoggerError(format, ...)	[[HLSLogger sharedLogger] error:[NSString stringWithFormat:@"(%s) - %@", __PRETTY_FUNCTION__, [NSString stringWithFormat:format, ## __VA_ARGS__]]]
-#define HLSLoggerFatal(format, ...)	[[HLSLogger sharedLogger] fatal:[NSString stringWithFormat:@"(%s) - %@", __PRETTY_FUNCTION__, [NSString stringWithFormat:format, ## __VA_ARGS__]]]
+// Note the ## in front of __VA_ARGS__ to support 0 variable arguments. The format must be a string literal, which is
+// concatenated with the function name prefix so that a single formatting step is required. Messages are not formatted
+// at all if the logging level filters them out, or if the call site exceeds its rate limit (a static variable keeps
+// track of each call site). Call sites which are not rate limited (errors and fatal errors) never suppress messages
+#define HLSLoggerLogIf(condition, rateLimited, method, prefix, format, ...)                                           \
+    do {                                                                                                                \
+        HLSLogger *hlsLogger = [HLSLogger sharedLogger];                                                                \
+        if (condition) {                                                                                                \
+            static HLSLoggerCallSite hlsCallSite = {0, 0, 0};                                                           \
+            NSUInteger hlsSuppressedMessageCount = 0;                                                                   \
+            if (! (rateLimited) || HLSLoggerCallSiteShouldLog(&hlsCallSite, &hlsSuppressedMessageCount)) {              \
+                [hlsLogger method:[NSString stringWithFormat:@"%@(%s)%@ - " format,                                      \
+                                   prefix,                                                                              \
+                                   __PRETTY_FUNCTION__,                                                                 \
+                                   HLSLoggerSuppressedMessagesDescription(hlsSuppressedMessageCount),                   \
+                                   ## __VA_ARGS__]];                                                                    \
+            }                                                                                                           \
+        }                                                                                                               \
+    } while (0)
+
+#define HLSLoggerLog(tester, rateLimited, method, format, ...)                                                          \
+    HLSLoggerLogIf([hlsLogger tester], rateLimited, method, @"", format, ## __VA_ARGS__)
+
+#define HLSLoggerCategoryLog(category, level, rateLimited, method, format, ...)                                         \
+    HLSLoggerLogIf([hlsLogger isLevel:level enabledForCategory:category],                                               \
+                   rateLimited,                                                                                         \
+                   method,                                                                                              \
+                   [NSString stringWithFormat:@"[%@] ", category],                                                      \
+                   format,                                                                                              \
+                   ## __VA_ARGS__)
+
+// High-volume tracing at the debug level. The format is a C string literal (not an NSString) used as is as identifier, 
+// and up to 16 numeric arguments are stored as doubles without any formatting on the calling thread. Use printf-like 
+// numeric conversions only (%d, %u, %x, %f, %g, etc.). For asynchronous loggers writing to a file, traces are written 
+// in binary form to separate .hlstrace files, which can be decoded offline using Tools/Logging/hlstrace.py
+#define HLSLoggerTraceLog(format, ...)                                                                                  \
+    do {                                                                                                                \
+        HLSLogger *hlsLogger = [HLSLogger sharedLogger];                                                                \
+        if ([hlsLogger isDebug]) {                                                                                      \
+            double hlsValues[] = {0., ## __VA_ARGS__};                                                                  \
+            [hlsLogger trace:format values:hlsValues + 1 count:sizeof(hlsValues) / sizeof(double) - 1];                 \
+        }                                                                                                               \
+    } while (0)
+
+#define HLSLoggerConcatenate(x, y)          x ## y
+#define HLSLoggerUniqueName(prefix, line)   HLSLoggerConcatenate(prefix, line)
+
+// Scope timing at the debug level. The name is a C string literal. The time elapsed until the end of the enclosing scope 
+// is measured using a monotonic clock and logged if it reaches the threshold (in seconds). Timings are also aggregated
+// for each call site (see -[HLSLogger logScopeTimings]). Scopes only cost a level check if debug messages are not logged
+#define HLSLoggerTimeScopeLog(name, threshold)                                                                          \
+    static HLSLoggerScopeTimings HLSLoggerUniqueName(hlsScopeTimings, __LINE__) = {name, 0, 0, INT64_MAX, 0, NULL, 0};   \
+    HLSLoggerScope HLSLoggerUniqueName(hlsScope, __LINE__) __attribute__((cleanup(HLSLoggerScopeEnd)))                  \
+        = HLSLoggerScopeBegin(&HLSLoggerUniqueName(hlsScopeTimings, __LINE__), threshold, __PRETTY_FUNCTION__)
+
+// Same as the macros below, but for a category (an NSString) which can be given its own level (see -setLevel:forCategory:)
+#if HLS_LOGGER_MINIMUM_LEVEL <= 0
+#define HLSLoggerDebug(format, ...)	HLSLoggerLog(isDebug, YES, debug, format, ## __VA_ARGS__)
+#define HLSLoggerCategoryDebug(category, format, ...)	HLSLoggerCategoryLog(category, HLSLoggerLevelDebug, YES, debug, format, ## __VA_ARGS__)
+#define HLSLoggerTrace(format, ...)	HLSLoggerTraceLog(format, ## __VA_ARGS__)
+#define HLSLoggerTimeScope(name)	HLSLoggerTimeScopeLog(name, 0.)
+#define HLSLoggerTimeScopeWithThreshold(name, threshold)	HLSLoggerTimeScopeLog(name, threshold)
+#else
+#define HLSLoggerDebug(format, ...)
+#define HLSLoggerCategoryDebug(category, format, ...)
+#define HLSLoggerTrace(format, ...)
+#define HLSLoggerTimeScope(name)
+#define HLSLoggerTimeScopeWithThreshold(name, threshold)
+#endif
+
+#if HLS_LOGGER_MINIMUM_LEVEL <= 1
+#define HLSLoggerInfo(format, ...)	HLSLoggerLog(isInfo, YES, info, format, ## __VA_ARGS__)
+#define HLSLoggerCategoryInfo(category, format, ...)	HLSLoggerCategoryLog(category, HLSLoggerLevelInfo, YES, info, format, ## __VA_ARGS__)
+#else
+#define HLSLoggerInfo(format, ...)
+#define HLSLoggerCategoryInfo(category, format, ...)
+#endif
+
+#if HLS_LOGGER_MINIMUM_LEVEL <= 2
+#define HLSLoggerWarn(format, ...)	HLSLoggerLog(isWarn, YES, warn, format, ## __VA_ARGS__)
+#define HLSLoggerCategoryWarn(category, format, ...)	HLSLoggerCategoryLog(category, HLSLoggerLevelWarn, YES, warn, format, ## __VA_ARGS__)
+#else
+#define HLSLoggerWarn(format, ...)
+#define HLSLoggerCategoryWarn(category, format, ...)
+#endif
+
+#if HLS_LOGGER_MINIMUM_LEVEL <= 3
+#define HLSLoggerError(format, ...)	HLSLoggerLog(isError, NO, error, format, ## __VA_ARGS__)
+#define HLSLoggerCategoryError(category, format, ...)	HLSLoggerCategoryLog(category, HLSLoggerLevelError, NO, error, format, ## __VA_ARGS__)
+#else
+#define HLSLoggerError(format, ...)
+#define HLSLoggerCategoryError(category, format, ...)
+#endif
+
+#if HLS_LOGGER_MINIMUM_LEVEL <= 4
+#define HLSLoggerFatal(format, ...)	HLSLoggerLog(isFatal, NO, fatal, format, ## __VA_ARGS__)
+#define HLSLoggerCategoryFatal(category, format, ...)	HLSLoggerCategoryLog(category, HLSLoggerLevelFatal, NO, fatal, format, ## __VA_ARGS__)
+#else
+#define HLSLoggerFatal(format, ...)
+#define HLSLoggerCategoryFatal(category, format, ...)
+#endif
 
 #else
 
 #define HLSLoggerDebug(format, ...)
+#define HLSLoggerCategoryDebug(category, format, ...)
+#define HLSLoggerTrace(format, ...)
+#define HLSLoggerTimeScope(name)
+#define HLSLoggerTimeScopeWithThreshold(name, threshold)
 #define HLSLoggerInfo(format, ...)
+#define HLSLoggerCategoryInfo(category, format, ...)
 #define HLSLoggerWarn(format, ...)
+#define HLSLoggerCategoryWarn(category, format, ...)
 #define HLSLoggerError(format, ...)
+#define HLSLoggerCategoryError(category, format, ...)
 #define HLSLoggerFatal(format, ...)
+#define HLSLoggerCategoryFatal(category, format, ...)
 
 #endif
 
@@ -46,6 +159,61 @@ typedef enum {
     HLSLoggerLevelEnumSize = HLSLoggerLevelEnumEnd - HLSLoggerLevelEnumBegin
 } HLSLoggerLevel;
 
+/**
+ * Rate limiting information for a logging macro call site. Used internally by the logging macros
+ */
+typedef struct {
+    volatile int64_t windowStartTime;               // in milliseconds
+    volatile int32_t messageCount;
+    volatile int32_t suppressedMessageCount;
+} HLSLoggerCallSite;
+
+/**
+ * Return YES iff a message can be logged from the given call site. If messages have been suppressed since the call site
+ * last logged, their number is returned in pSuppressedMessageCount. Used internally by the logging macros
+ */
+BOOL HLSLoggerCallSiteShouldLog(HLSLoggerCallSite *callSite, NSUInteger *pSuppressedMessageCount);
+
+/**
+ * Return a description of the number of suppressed messages (an empty string if 0). Used internally by the logging macros
+ */
+NSString *HLSLoggerSuppressedMessagesDescription(NSUInteger suppressedMessageCount);
+
+/**
+ * Timings aggregated for a scope timing macro call site. Used internally by the logging macros
+ */
+typedef struct HLSLoggerScopeTimings {
+    const char *name;
+    volatile int64_t count;
+    volatile int64_t totalTime;                     // in mach absolute time units
+    volatile int64_t minTime;
+    volatile int64_t maxTime;
+    struct HLSLoggerScopeTimings *next;             // registered call sites form a list
+    volatile int32_t registered;
+} HLSLoggerScopeTimings;
+
+/**
+ * A timed scope being executed. Used internally by the logging macros
+ */
+typedef struct {
+    HLSLoggerScopeTimings *timings;
+    const char *function;
+    NSTimeInterval threshold;
+    uint64_t startTime;                             // 0 if the scope is not timed
+} HLSLoggerScope;
+
+/**
+ * Begin and end timing a scope. Used internally by the logging macros
+ */
+HLSLoggerScope HLSLoggerScopeBegin(HLSLoggerScopeTimings *timings, NSTimeInterval threshold, const char *function);
+void HLSLoggerScopeEnd(HLSLoggerScope *scope);
+
+/**
+ * Monotonic time in seconds (since an arbitrary origin, unaffected by changes of the system clock), used to timestamp
+ * log entries and to time scopes
+ */
+NSTimeInterval HLSLoggerMonotonicTime(void);
+
 /**
  * Basic logging facility writing to the console. Thread-safe
  *
@@ -58,6 +226,35 @@ typedef enum {
  *   - add an HLSLoggerLevel setting to your project main .plist file, with one of the following values (DEBUG, INFO,
  *     WARN, ERROR or FATAL). This sets the logging level to apply
  *
+ * By default messages are written synchronously using NSLog. If logging is used on performance-critical paths, you 
+ * can enable asynchronous logging by adding an HLSLoggerAsynchronous boolean setting to your project main .plist file. 
+ * Messages are then copied into a preallocated lock-free ring buffer and written by a background thread, to the 
+ * standard error and, if an HLSLoggerFileName setting is provided (e.g. log.txt), to files in the Library/Caches 
+ * directory. File writes are batched and occur every few seconds, when the application enters the background or when
+ * -flush is called. Files are segments named after the setting (e.g. log-20121014-120000.txt). A new segment is 
+ * started when the current one reaches 1 MB or is one day old, and only the five most recent segments are kept.
+ * Messages which do not fit into the buffer are dropped (the number of dropped messages is logged as soon as possible). 
+ * Fatal messages are always written before the logging method returns
+ *
+ * Call sites of logging macros can be rate limited by adding an HLSLoggerCallSiteRateLimit number setting to your 
+ * project main .plist file, setting the maximum number of messages each call site can log per second (the default is 
+ * 0, i.e. no rate limiting). Further messages are suppressed (and not even formatted), their number being reported 
+ * with the next message which gets logged from the same call site. Error and fatal messages are never suppressed.
+ *
+ * Messages can be logged in categories, using the HLSLoggerCategory... macros. By default categories use the level 
+ * of the logger, but independent levels can be set for each category, either by calling -setLevel:forCategory: or
+ * by adding an HLSLoggerCategoryLevels dictionary setting to your project main .plist file, mapping category names
+ * to level names (DEBUG, INFO, WARN, ERROR or FATAL)
+ *
+ * Each log entry is prefixed with its monotonic timestamp (see HLSLoggerMonotonicTime()) and the identifier of the 
+ * thread which logged it, e.g. [DEBUG] [1234.567890 0x1a03].
+ *
+ * Code sections can be timed using the HLSLoggerTimeScope and HLSLoggerTimeScopeWithThreshold macros, which log 
+ * the time elapsed until the end of the enclosing scope (at the debug level). Timings are aggregated as well, and
+ * can be logged using -logScopeTimings. For hot paths, set aggregatingScopeTimings to YES (or add an 
+ * HLSLoggerAggregateScopeTimings boolean setting to your project main .plist file) so that only aggregated timings 
+ * are logged
+ *
  * HLSLogger supports XcodeColors (see https://github.com/robbiehanson/XcodeColors for the active fork), an Xcode plugin
  * adding colors to the Xcode debugging console. Simply install the plugin and set an environment variable called 
  * 'XcodeColors' to YES to enable it for your project.
@@ -67,6 +264,11 @@ typedef enum {
 @interface HLSLogger : NSObject {
 @private
 	HLSLoggerLevel m_level;
+    NSDictionary *m_categoryToLevelMap;
+    OSSpinLock m_categoryToLevelMapLock;
+    BOOL m_asynchronous;
+    void *m_ringBuffer;
+    BOOL m_aggregatingScopeTimings;
 }
 
 /**
@@ -77,13 +279,48 @@ typedef enum {
 - (id)initWithLevel:(HLSLoggerLevel)level;
 
 /**
- * Logging functions; should never be called directly, use the macros instead
+ * Create an asynchronous logger (see class documentation above). If filePath is nil, messages are only written to 
+ * the standard error, otherwise log segments are named after filePath. Asynchronous loggers are never deallocated 
+ * since their writer thread retains them
+ */
+- (id)initWithLevel:(HLSLoggerLevel)level asynchronous:(BOOL)asynchronous filePath:(NSString *)filePath;
+
+/**
+ * Logging functions; should never be called directly, use the macros instead (those functions do not check the level)
  */
 - (void)debug:(NSString *)message;
 - (void)info:(NSString *)message;
 - (void)warn:(NSString *)message;
 - (void)error:(NSString *)message;
 - (void)fatal:(NSString *)message;
+- (void)trace:(const char *)format values:(const double *)values count:(NSUInteger)count;
+
+/**
+ * Block until all messages recorded so far have been written (does nothing for synchronous loggers)
+ */
+- (void)flush;
+
+/**
+ * Set the level of a category. Use HLSLoggerLevelEnumEnd to have the category use the logger level again
+ */
+- (void)setLevel:(HLSLoggerLevel)level forCategory:(NSString *)category;
+
+/**
+ * Return YES iff messages with the given level are logged for the category
+ */
+- (BOOL)isLevel:(HLSLoggerLevel)level enabledForCategory:(NSString *)category;
+
+/**
+ * If set to YES, timed scopes are not logged individually, their timings are only aggregated. Default value is NO
+ */
+@property (nonatomic, assign, getter=isAggregatingScopeTimings) BOOL aggregatingScopeTimings;
+
+/**
+ * Log the count, minimum, maximum and average durations of all timed scopes executed so far (at the info level),
+ * resp. discard them
+ */
+- (void)logScopeTimings;
+- (void)resetScopeTimings;
 
 /**
  * Level testers
@@ -8,6 +8,66 @@
 
 #import "HLSLogger.h"
 
+#import "HLSLogFileSink.h"
+
+#import <mach/mach_time.h>
+#import <pthread.h>
+
+#pragma mark -
+#pragma mark HLSLoggerRingBuffer struct
+
+#define kLoggerRingBufferSlotCount          1024
+#define kLoggerRingBufferSlotSize           1024
+
+#define kLoggerTraceMaximumValueCount       16
+
+// Buffered file entries are written at least with this period
+static const NSTimeInterval kLoggerFileFlushInterval = 5.;
+
+// Record types of binary trace files (see Tools/Logging/hlstrace.py)
+static const uint8_t kLoggerTraceFormatDefinitionRecordType = 'D';
+static const uint8_t kLoggerTraceEntryRecordType = 'E';
+
+typedef enum {
+    HLSLoggerRingBufferSlotKindEnumBegin = 0,
+    HLSLoggerRingBufferSlotKindMessage = HLSLoggerRingBufferSlotKindEnumBegin,        // UTF-8 bytes
+    HLSLoggerRingBufferSlotKindTrace,                                                   // HLSLoggerTraceEntry struct
+    HLSLoggerRingBufferSlotKindEnumEnd,
+    HLSLoggerRingBufferSlotKindEnumSize = HLSLoggerRingBufferSlotKindEnumEnd - HLSLoggerRingBufferSlotKindEnumBegin
+} HLSLoggerRingBufferSlotKind;
+
+typedef struct {
+    const char *format;
+    NSUInteger count;
+    double values[kLoggerTraceMaximumValueCount];
+} HLSLoggerTraceEntry;
+
+/**
+ * Bounded multiple-producer, single-consumer lock-free queue. Each slot has a sequence number telling whether it
+ * is free for the producer expecting it (sequence == position) or ready for the consumer (sequence == position + 1)
+ */
+typedef struct {
+    volatile int64_t sequence;
+    HLSLoggerRingBufferSlotKind kind;
+    CFAbsoluteTime time;
+    NSUInteger length;
+    char bytes[kLoggerRingBufferSlotSize] __attribute__ ((aligned (8)));       // can store an HLSLoggerTraceEntry
+} HLSLoggerRingBufferSlot;
+
+typedef struct {
+    HLSLoggerRingBufferSlot slots[kLoggerRingBufferSlotCount];
+    volatile int64_t writePosition;
+    volatile int64_t readPosition;                  // only updated by the writer thread
+    volatile int32_t droppedMessageCount;
+    volatile int32_t flushRequestCount;             // incremented to request a file flush, decremented when done
+    dispatch_semaphore_t semaphore;
+    HLSLogFileSink *fileSink;                       // only used by the writer thread
+    HLSLogFileSink *traceFileSink;                  // only used by the writer thread
+    CFMutableDictionaryRef traceFormatToIdentifierMap;   // only used by the writer thread, reset for each trace file segment
+} HLSLoggerRingBuffer;
+
+static void HLSLoggerFormatTrace(char *buffer, size_t size, const HLSLoggerTraceEntry *trace);
+
 #pragma mark -
 #pragma mark HLSLoggerMode struct
 
@@ -23,12 +83,34 @@ static const HLSLoggerMode kLoggerModeWarn = {@"WARN", 2, @"255,120,0"};
 static const HLSLoggerMode kLoggerModeError = {@"ERROR", 3, @"255,0,0"};
 static const HLSLoggerMode kLoggerModeFatal = {@"FATAL", 4, @"255,0,0"};
 
+// Maximum number of messages per second and call site (0 if unlimited, the default)
+static int32_t s_callSiteRateLimit = 0;
+
+static HLSLoggerLevel HLSLoggerLevelForName(NSString *levelName);
+
+// Timed scope call sites registered so far (a lock-free list, call sites are static and never unregistered)
+static HLSLoggerScopeTimings *volatile s_scopeTimingsList = NULL;
+
+static NSTimeInterval HLSLoggerMachTimeToSeconds(uint64_t machTime);
+
 #pragma mark -
 #pragma mark HLSLogger class
 
 @interface HLSLogger ()
 
 - (void)logMessage:(NSString *)message forMode:(HLSLoggerMode)mode;
+- (NSString *)logEntryWithMessage:(NSString *)message forMode:(HLSLoggerMode)mode;
+- (void)enqueueLogEntry:(NSString *)logEntry;
+
+- (HLSLoggerRingBufferSlot *)reserveSlotAtPosition:(int64_t *)pPosition;
+- (void)publishSlot:(HLSLoggerRingBufferSlot *)slot atPosition:(int64_t)position;
+
+- (void)writeLogEntriesInBackground;
+- (void)writeLogEntryBytes:(const char *)bytes length:(NSUInteger)length atTime:(CFAbsoluteTime)time;
+- (void)writeBytes:(const char *)bytes length:(NSUInteger)length;
+- (void)writeTrace:(const HLSLoggerTraceEntry *)trace atTime:(CFAbsoluteTime)time;
+
+- (void)applicationDidEnterBackground:(NSNotification *)notification;
 
 @end
 
@@ -49,26 +131,29 @@ static const HLSLoggerMode kLoggerModeFatal = {@"FATAL", 4, @"255,0,0"};
                 
                 // Create a logger with the corresponding level
                 NSString *levelName = [infoProperties valueForKey:@"HLSLoggerLevel"];
-                HLSLoggerLevel level;
-                if ([levelName isEqualToString:kLoggerModeDebug.name]) {
-                    level = HLSLoggerLevelDebug;
-                }
-                else if ([levelName isEqualToString:kLoggerModeInfo.name]) {
-                    level = HLSLoggerLevelInfo;		
-                }
-                else if ([levelName isEqualToString:kLoggerModeWarn.name]) {
-                    level = HLSLoggerLevelWarn;
-                }
-                else if ([levelName isEqualToString:kLoggerModeError.name]) {
-                    level = HLSLoggerLevelError;
+                HLSLoggerLevel level = HLSLoggerLevelForName(levelName);
+                
+                NSNumber *callSiteRateLimitNumber = [infoProperties valueForKey:@"HLSLoggerCallSiteRateLimit"];
+                if (callSiteRateLimitNumber) {
+                    s_callSiteRateLimit = MAX([callSiteRateLimitNumber intValue], 0);
                 }
-                else if ([levelName isEqualToString:kLoggerModeFatal.name]) {
-                    level = HLSLoggerLevelFatal;
+                
+                BOOL asynchronous = [[infoProperties valueForKey:@"HLSLoggerAsynchronous"] boolValue];
+                NSString *fileName = [infoProperties valueForKey:@"HLSLoggerFileName"];
+                NSString *filePath = nil;
+                if (asynchronous && [fileName length] != 0) {
+                    NSString *cachesDirectoryPath = [NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES) objectAtIndex:0];
+                    filePath = [cachesDirectoryPath stringByAppendingPathComponent:fileName];
                 }
-                else {
-                    level = HLSLoggerLevelNone;
+                
+                s_instance = [[HLSLogger alloc] initWithLevel:level asynchronous:asynchronous filePath:filePath];
+                s_instance.aggregatingScopeTimings = [[infoProperties valueForKey:@"HLSLoggerAggregateScopeTimings"] boolValue];
+                
+                NSDictionary *categoryToLevelNameMap = [infoProperties valueForKey:@"HLSLoggerCategoryLevels"];
+                for (NSString *category in [categoryToLevelNameMap allKeys]) {
+                    HLSLoggerLevel categoryLevel = HLSLoggerLevelForName([categoryToLevelNameMap objectForKey:category]);
+                    [s_instance setLevel:categoryLevel forCategory:category];
                 }
-                s_instance = [[HLSLogger alloc] initWithLevel:level];                
             }
         }
 	}
@@ -77,27 +162,130 @@ static const HLSLoggerMode kLoggerModeFatal = {@"FATAL", 4, @"255,0,0"};
 
 #pragma mark Object creation and destruction
 
-- (id)initWithLevel:(HLSLoggerLevel)level
+- (id)initWithLevel:(HLSLoggerLevel)level asynchronous:(BOOL)asynchronous filePath:(NSString *)filePath
 {
 	if ((self = [super init])) {
 		m_level = level;
+        m_categoryToLevelMapLock = OS_SPINLOCK_INIT;
+        m_asynchronous = asynchronous;
+        
+        // No need for a writer thread if nothing is logged
+        if (m_asynchronous && m_level != HLSLoggerLevelNone) {
+            HLSLoggerRingBuffer *ringBuffer = calloc(1, sizeof(HLSLoggerRingBuffer));
+            for (NSUInteger i = 0; i < kLoggerRingBufferSlotCount; ++i) {
+                ringBuffer->slots[i].sequence = i;
+            }
+            ringBuffer->semaphore = dispatch_semaphore_create(0);
+            if (filePath) {
+                ringBuffer->fileSink = [[HLSLogFileSink alloc] initWithFilePath:filePath];
+                
+                // e.g. log-trace.hlstrace for log.txt
+                NSString *traceFileName = [NSString stringWithFormat:@"%@-trace.hlstrace", [[filePath lastPathComponent] stringByDeletingPathExtension]];
+                NSString *traceFilePath = [[filePath stringByDeletingLastPathComponent] stringByAppendingPathComponent:traceFileName];
+                ringBuffer->traceFileSink = [[HLSLogFileSink alloc] initWithFilePath:traceFilePath];
+                ringBuffer->traceFormatToIdentifierMap = CFDictionaryCreateMutable(kCFAllocatorDefault, 0, NULL, NULL);
+                
+                // Buffered entries would be lost if the application is killed while in the background
+                [[NSNotificationCenter defaultCenter] addObserver:self 
+                                                         selector:@selector(applicationDidEnterBackground:) 
+                                                             name:UIApplicationDidEnterBackgroundNotification 
+                                                           object:nil];
+            }
+            m_ringBuffer = ringBuffer;
+            
+            // The thread retains the logger
+            [NSThread detachNewThreadSelector:@selector(writeLogEntriesInBackground) toTarget:self withObject:nil];
+        }
+        else {
+            m_asynchronous = NO;
+        }
 	}
 	return self;
 }
 
+- (id)initWithLevel:(HLSLoggerLevel)level
+{
+    return [self initWithLevel:level asynchronous:NO filePath:nil];
+}
+
 - (id)init
 {
 	return [self initWithLevel:HLSLoggerLevelNone];
 }
 
+- (void)dealloc
+{
+    [m_categoryToLevelMap release];
+    
+    [super dealloc];
+}
+
+#pragma mark Accessors and mutators
+
+@synthesize aggregatingScopeTimings = m_aggregatingScopeTimings;
+
+#pragma mark Categories
+
+- (void)setLevel:(HLSLoggerLevel)level forCategory:(NSString *)category
+{
+    if (! category) {
+        return;
+    }
+    
+    // Copy on write, so that lookups are short
+    NSMutableDictionary *categoryToLevelMap = [NSMutableDictionary dictionaryWithDictionary:m_categoryToLevelMap];
+    if (level == HLSLoggerLevelEnumEnd) {
+        [categoryToLevelMap removeObjectForKey:category];
+    }
+    else {
+        [categoryToLevelMap setObject:[NSNumber numberWithInt:level] forKey:category];
+    }
+    
+    NSDictionary *previousCategoryToLevelMap = nil;
+    OSSpinLockLock(&m_categoryToLevelMapLock);
+    previousCategoryToLevelMap = m_categoryToLevelMap;
+    m_categoryToLevelMap = [categoryToLevelMap copy];
+    OSSpinLockUnlock(&m_categoryToLevelMapLock);
+    
+    [previousCategoryToLevelMap release];
+}
+
+- (BOOL)isLevel:(HLSLoggerLevel)level enabledForCategory:(NSString *)category
+{
+    HLSLoggerLevel categoryLevel = m_level;
+    
+    OSSpinLockLock(&m_categoryToLevelMapLock);
+    NSNumber *categoryLevelNumber = category ? [m_categoryToLevelMap objectForKey:category] : nil;
+    if (categoryLevelNumber) {
+        categoryLevel = [categoryLevelNumber intValue];
+    }
+    OSSpinLockUnlock(&m_categoryToLevelMapLock);
+    
+    return categoryLevel <= level;
+}
+
 #pragma mark Logging methods
 
 - (void)logMessage:(NSString *)message forMode:(HLSLoggerMode)mode
 {
-	if (m_level > mode.level) {
-		return;
-	}
+    // The level has already been checked by the macros (the category level might differ from the logger level)
+    NSString *fullLogEntry = [self logEntryWithMessage:message forMode:mode];
+    if (m_asynchronous) {
+        [self enqueueLogEntry:fullLogEntry];
+        
+        // The application is likely to terminate
+        if (mode.level == kLoggerModeFatal.level) {
+            [self flush];
+        }
+    }
+    else {
+        // NSLog is thread-safe
+        NSLog(@"%@", fullLogEntry);
+    }
+}
 
+- (NSString *)logEntryWithMessage:(NSString *)message forMode:(HLSLoggerMode)mode
+{
     static BOOL s_configurationLoaded = NO;
     static BOOL s_xcodeColorsEnabled = NO;
     if (! s_configurationLoaded) {
@@ -106,13 +294,17 @@ static const HLSLoggerMode kLoggerModeFatal = {@"FATAL", 4, @"255,0,0"};
         s_configurationLoaded = YES;
     }
     
-    // NSLog is thread-safe
-    NSString *fullLogEntry = [NSString stringWithFormat:@"[%@] %@", mode.name, message];
+    // Timestamp and thread identifier are captured on the calling thread, even for asynchronous loggers
+    NSString *header = [NSString stringWithFormat:@"[%@] [%.6f 0x%x]", 
+                        mode.name, 
+                        HLSLoggerMonotonicTime(), 
+                        pthread_mach_thread_np(pthread_self())];
+    
     if (s_xcodeColorsEnabled && mode.rgbValues) {
-        NSLog(@"\033[fg%@;%@\033[;", mode.rgbValues, fullLogEntry);
+        return [NSString stringWithFormat:@"\033[fg%@;%@ %@\033[;", mode.rgbValues, header, message];
     }
     else {
-        NSLog(@"%@", fullLogEntry);
+        return [NSString stringWithFormat:@"%@ %@", header, message];
     }
 }
 
@@ -141,6 +333,292 @@ static const HLSLoggerMode kLoggerModeFatal = {@"FATAL", 4, @"255,0,0"};
 	[self logMessage:message forMode:kLoggerModeFatal];
 }
 
+- (void)trace:(const char *)format values:(const double *)values count:(NSUInteger)count
+{
+    NSUInteger valueCount = MIN(count, kLoggerTraceMaximumValueCount);
+    
+    if (m_asynchronous) {
+        int64_t position = 0;
+        HLSLoggerRingBufferSlot *slot = [self reserveSlotAtPosition:&position];
+        if (! slot) {
+            return;
+        }
+        
+        HLSLoggerTraceEntry *trace = (HLSLoggerTraceEntry *)slot->bytes;
+        trace->format = format;
+        trace->count = valueCount;
+        memcpy(trace->values, values, valueCount * sizeof(double));
+        slot->kind = HLSLoggerRingBufferSlotKindTrace;
+        slot->length = sizeof(HLSLoggerTraceEntry);
+        [self publishSlot:slot atPosition:position];
+    }
+    else {
+        HLSLoggerTraceEntry trace;
+        trace.format = format;
+        trace.count = valueCount;
+        memcpy(trace.values, values, valueCount * sizeof(double));
+        
+        char message[kLoggerRingBufferSlotSize];
+        HLSLoggerFormatTrace(message, sizeof(message), &trace);
+        NSLog(@"[TRACE] %s", message);
+    }
+}
+
+#pragma mark Scope timings
+
+- (void)logScopeTimings
+{
+    for (HLSLoggerScopeTimings *timings = s_scopeTimingsList; timings; timings = timings->next) {
+        int64_t count = timings->count;
+        if (count == 0) {
+            continue;
+        }
+        
+        [self info:[NSString stringWithFormat:@"Scope '%s': count = %lld, min = %.3f ms, max = %.3f ms, average = %.3f ms", 
+                    timings->name,
+                    count,
+                    HLSLoggerMachTimeToSeconds(timings->minTime) * 1000.,
+                    HLSLoggerMachTimeToSeconds(timings->maxTime) * 1000.,
+                    HLSLoggerMachTimeToSeconds(timings->totalTime / count) * 1000.]];
+    }
+}
+
+- (void)resetScopeTimings
+{
+    // Scopes ending meanwhile might be partially accounted for, which is harmless
+    for (HLSLoggerScopeTimings *timings = s_scopeTimingsList; timings; timings = timings->next) {
+        timings->count = 0;
+        timings->totalTime = 0;
+        timings->minTime = INT64_MAX;
+        timings->maxTime = 0;
+    }
+    OSMemoryBarrier();
+}
+
+#pragma mark Asynchronous logging
+
+- (HLSLoggerRingBufferSlot *)reserveSlotAtPosition:(int64_t *)pPosition
+{
+    HLSLoggerRingBuffer *ringBuffer = m_ringBuffer;
+    
+    int64_t position = ringBuffer->writePosition;
+    while (YES) {
+        HLSLoggerRingBufferSlot *slot = &ringBuffer->slots[position % kLoggerRingBufferSlotCount];
+        int64_t difference = slot->sequence - position;
+        if (difference == 0) {
+            if (OSAtomicCompareAndSwap64Barrier(position, position + 1, &ringBuffer->writePosition)) {
+                *pPosition = position;
+                return slot;
+            }
+        }
+        // Full. Never block the caller
+        else if (difference < 0) {
+            OSAtomicIncrement32Barrier(&ringBuffer->droppedMessageCount);
+            return NULL;
+        }
+        position = ringBuffer->writePosition;
+    }
+}
+
+- (void)publishSlot:(HLSLoggerRingBufferSlot *)slot atPosition:(int64_t)position
+{
+    HLSLoggerRingBuffer *ringBuffer = m_ringBuffer;
+    
+    slot->time = CFAbsoluteTimeGetCurrent();
+    OSMemoryBarrier();
+    slot->sequence = position + 1;
+    
+    dispatch_semaphore_signal(ringBuffer->semaphore);
+}
+
+- (void)enqueueLogEntry:(NSString *)logEntry
+{
+    int64_t position = 0;
+    HLSLoggerRingBufferSlot *slot = [self reserveSlotAtPosition:&position];
+    if (! slot) {
+        return;
+    }
+    
+    // Copy the message (truncated if too long) and publish it
+    NSUInteger length = 0;
+    [logEntry getBytes:slot->bytes 
+             maxLength:kLoggerRingBufferSlotSize 
+            usedLength:&length 
+              encoding:NSUTF8StringEncoding 
+               options:NSStringEncodingConversionAllowLossy 
+                 range:NSMakeRange(0, [logEntry length]) 
+        remainingRange:NULL];
+    slot->kind = HLSLoggerRingBufferSlotKindMessage;
+    slot->length = length;
+    [self publishSlot:slot atPosition:position];
+}
+
+- (void)flush
+{
+    if (! m_asynchronous) {
+        return;
+    }
+    
+    HLSLoggerRingBuffer *ringBuffer = m_ringBuffer;
+    int64_t writePosition = ringBuffer->writePosition;
+    while (ringBuffer->readPosition < writePosition) {
+        usleep(1000);
+    }
+    
+    // Wait until buffered entries have been written as well
+    if (ringBuffer->fileSink) {
+        OSAtomicIncrement32Barrier(&ringBuffer->flushRequestCount);
+        dispatch_semaphore_signal(ringBuffer->semaphore);
+        while (ringBuffer->flushRequestCount != 0) {
+            usleep(1000);
+        }
+    }
+}
+
+- (void)writeLogEntriesInBackground
+{
+    HLSLoggerRingBuffer *ringBuffer = m_ringBuffer;
+    CFAbsoluteTime lastFileFlushTime = CFAbsoluteTimeGetCurrent();
+    
+    while (YES) {
+        dispatch_semaphore_wait(ringBuffer->semaphore, dispatch_time(DISPATCH_TIME_NOW, kLoggerFileFlushInterval * NSEC_PER_SEC));
+        
+        NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+        
+        int32_t droppedMessageCount = ringBuffer->droppedMessageCount;
+        if (droppedMessageCount != 0) {
+            OSAtomicAdd32Barrier(-droppedMessageCount, &ringBuffer->droppedMessageCount);
+            
+            // Formatted as any other warning
+            NSString *message = [NSString stringWithFormat:@"%d log messages dropped", droppedMessageCount];
+            const char *logEntry = [[self logEntryWithMessage:message forMode:kLoggerModeWarn] UTF8String];
+            [self writeLogEntryBytes:logEntry length:strlen(logEntry) atTime:CFAbsoluteTimeGetCurrent()];
+        }
+        
+        // Write all published entries. A slot might have been reserved but not published yet, in which case its producer
+        // signals the semaphore again when done
+        while (YES) {
+            int64_t position = ringBuffer->readPosition;
+            HLSLoggerRingBufferSlot *slot = &ringBuffer->slots[position % kLoggerRingBufferSlotCount];
+            if (slot->sequence != position + 1) {
+                break;
+            }
+            OSMemoryBarrier();
+            
+            if (slot->kind == HLSLoggerRingBufferSlotKindTrace) {
+                [self writeTrace:(const HLSLoggerTraceEntry *)slot->bytes atTime:slot->time];
+                
+                OSMemoryBarrier();
+                slot->sequence = position + kLoggerRingBufferSlotCount;
+                ringBuffer->readPosition = position + 1;
+                continue;
+            }
+            
+            [self writeLogEntryBytes:slot->bytes length:slot->length atTime:slot->time];
+            
+            // Free the slot for the producer which will wrap around
+            OSMemoryBarrier();
+            slot->sequence = position + kLoggerRingBufferSlotCount;
+            ringBuffer->readPosition = position + 1;
+        }
+        
+        // Entries buffered by the file sink are written periodically or when requested
+        int32_t flushRequestCount = ringBuffer->flushRequestCount;
+        CFAbsoluteTime currentTime = CFAbsoluteTimeGetCurrent();
+        if (flushRequestCount != 0 || currentTime - lastFileFlushTime >= kLoggerFileFlushInterval) {
+            [ringBuffer->fileSink flush];
+            [ringBuffer->traceFileSink flush];
+            lastFileFlushTime = currentTime;
+            if (flushRequestCount != 0) {
+                OSAtomicAdd32Barrier(-flushRequestCount, &ringBuffer->flushRequestCount);
+            }
+        }
+        
+        [pool drain];
+    }
+}
+
+- (void)writeLogEntryBytes:(const char *)bytes length:(NSUInteger)length atTime:(CFAbsoluteTime)time
+{
+    // Same information as NSLog, but formatted without Foundation objects
+    time_t seconds = (time_t)(time + kCFAbsoluteTimeIntervalSince1970);
+    struct tm localTime;
+    localtime_r(&seconds, &localTime);
+    char timeString[32];
+    strftime(timeString, sizeof(timeString), "%Y-%m-%d %H:%M:%S", &localTime);
+    int milliseconds = (int)((time - floor(time)) * 1000.);
+    
+    char line[kLoggerRingBufferSlotSize + 32];
+    int lineLength = snprintf(line, sizeof(line), "%s.%03d %.*s", timeString, milliseconds, (int)length, bytes);
+    [self writeBytes:line length:MIN(lineLength, (int)sizeof(line) - 1)];
+}
+
+- (void)writeBytes:(const char *)bytes length:(NSUInteger)length
+{
+    HLSLoggerRingBuffer *ringBuffer = m_ringBuffer;
+    
+    fprintf(stderr, "%.*s\n", (int)length, bytes);
+    if (ringBuffer->fileSink) {
+        [ringBuffer->fileSink appendBytes:bytes length:length];
+        [ringBuffer->fileSink appendBytes:"\n" length:1];
+    }
+}
+
+- (void)writeTrace:(const HLSLoggerTraceEntry *)trace atTime:(CFAbsoluteTime)time
+{
+    HLSLoggerRingBuffer *ringBuffer = m_ringBuffer;
+    
+    // No trace file: Format here, the calling thread has not paid for it anyway
+    if (! ringBuffer->traceFileSink) {
+        char message[kLoggerRingBufferSlotSize];
+        HLSLoggerFormatTrace(message, sizeof(message), trace);
+        
+        char line[kLoggerRingBufferSlotSize + 32];
+        int length = snprintf(line, sizeof(line), "%.3f [TRACE] %s", time + kCFAbsoluteTimeIntervalSince1970, message);
+        [self writeBytes:line length:MIN(length, (int)sizeof(line) - 1)];
+        return;
+    }
+    
+    // A format definition and the entries using it must lie in the same segment, so that each segment can be decoded
+    // on its own
+    size_t formatLength = MIN(strlen(trace->format), UINT16_MAX);
+    size_t definitionLength = sizeof(uint8_t) + sizeof(uint32_t) + sizeof(uint16_t) + formatLength;
+    size_t entryLength = sizeof(uint8_t) + sizeof(uint32_t) + sizeof(double) + sizeof(uint8_t) + trace->count * sizeof(double);
+    if ([ringBuffer->traceFileSink startNewSegmentIfNeededForLength:definitionLength + entryLength]) {
+        CFDictionaryRemoveAllValues(ringBuffer->traceFormatToIdentifierMap);
+    }
+    
+    // Identifiers start at 1 (0 cannot be stored in the map)
+    uint32_t identifier = (uint32_t)(uintptr_t)CFDictionaryGetValue(ringBuffer->traceFormatToIdentifierMap, trace->format);
+    if (identifier == 0) {
+        identifier = (uint32_t)CFDictionaryGetCount(ringBuffer->traceFormatToIdentifierMap) + 1;
+        CFDictionarySetValue(ringBuffer->traceFormatToIdentifierMap, trace->format, (const void *)(uintptr_t)identifier);
+        
+        uint16_t length = (uint16_t)formatLength;
+        [ringBuffer->traceFileSink appendBytes:&kLoggerTraceFormatDefinitionRecordType length:sizeof(uint8_t)];
+        [ringBuffer->traceFileSink appendBytes:&identifier length:sizeof(uint32_t)];
+        [ringBuffer->traceFileSink appendBytes:&length length:sizeof(uint16_t)];
+        [ringBuffer->traceFileSink appendBytes:trace->format length:formatLength];
+    }
+    
+    double timestamp = time + kCFAbsoluteTimeIntervalSince1970;
+    uint8_t count = (uint8_t)trace->count;
+    [ringBuffer->traceFileSink appendBytes:&kLoggerTraceEntryRecordType length:sizeof(uint8_t)];
+    [ringBuffer->traceFileSink appendBytes:&identifier length:sizeof(uint32_t)];
+    [ringBuffer->traceFileSink appendBytes:&timestamp length:sizeof(double)];
+    [ringBuffer->traceFileSink appendBytes:&count length:sizeof(uint8_t)];
+    [ringBuffer->traceFileSink appendBytes:trace->values length:trace->count * sizeof(double)];
+}
+
+#pragma mark Notification callbacks
+
+- (void)applicationDidEnterBackground:(NSNotification *)notification
+{
+    HLSLoggerRingBuffer *ringBuffer = m_ringBuffer;
+    OSAtomicIncrement32Barrier(&ringBuffer->flushRequestCount);
+    dispatch_semaphore_signal(ringBuffer->semaphore);
+}
+
 #pragma mark Level testers
 
 - (BOOL)isDebug
@@ -169,3 +647,226 @@ static const HLSLoggerMode kLoggerModeFatal = {@"FATAL", 4, @"255,0,0"};
 }
 
 @end
+
+#pragma mark Trace formatting
+
+/**
+ * Format a trace like printf would. Values are doubles, converted for integer conversions. Length modifiers are
+ * ignored, and conversions which cannot be applied to numbers (%s, %@, etc.) are replaced with a question mark
+ */
+static void HLSLoggerFormatTrace(char *buffer, size_t size, const HLSLoggerTraceEntry *trace)
+{
+    if (size == 0) {
+        return;
+    }
+    
+    size_t position = 0;
+    NSUInteger valueIndex = 0;
+    const char *character = trace->format;
+    while (*character != '\0' && position < size - 1) {
+        if (*character != '%') {
+            buffer[position++] = *character++;
+            continue;
+        }
+        
+        if (*(character + 1) == '%') {
+            buffer[position++] = '%';
+            character += 2;
+            continue;
+        }
+        
+        // Flags, width and precision are kept, length modifiers dropped
+        char specification[32] = "%";
+        size_t specificationLength = 1;
+        ++character;
+        while (*character != '\0' && strchr("-+ #0123456789.", *character) && specificationLength < sizeof(specification) - 4) {
+            specification[specificationLength++] = *character++;
+        }
+        while (*character != '\0' && strchr("hlLqjzt", *character)) {
+            ++character;
+        }
+        
+        char conversion = *character;
+        if (conversion == '\0') {
+            break;
+        }
+        ++character;
+        
+        double value = (valueIndex < trace->count) ? trace->values[valueIndex] : 0.;
+        ++valueIndex;
+        
+        int length = 0;
+        if (strchr("di", conversion)) {
+            specification[specificationLength++] = 'l';
+            specification[specificationLength++] = 'l';
+            specification[specificationLength++] = conversion;
+            specification[specificationLength] = '\0';
+            length = snprintf(buffer + position, size - position, specification, (long long)value);
+        }
+        else if (strchr("ouxX", conversion)) {
+            specification[specificationLength++] = 'l';
+            specification[specificationLength++] = 'l';
+            specification[specificationLength++] = conversion;
+            specification[specificationLength] = '\0';
+            length = snprintf(buffer + position, size - position, specification, (unsigned long long)value);
+        }
+        else if (strchr("eEfFgGaA", conversion)) {
+            specification[specificationLength++] = conversion;
+            specification[specificationLength] = '\0';
+            length = snprintf(buffer + position, size - position, specification, value);
+        }
+        else if (conversion == 'c') {
+            specification[specificationLength++] = conversion;
+            specification[specificationLength] = '\0';
+            length = snprintf(buffer + position, size - position, specification, (int)value);
+        }
+        else {
+            length = snprintf(buffer + position, size - position, "?");
+        }
+        
+        position = MIN(position + MAX(length, 0), size - 1);
+    }
+    buffer[position] = '\0';
+}
+
+#pragma mark Level names
+
+static HLSLoggerLevel HLSLoggerLevelForName(NSString *levelName)
+{
+    if ([levelName isEqualToString:kLoggerModeDebug.name]) {
+        return HLSLoggerLevelDebug;
+    }
+    else if ([levelName isEqualToString:kLoggerModeInfo.name]) {
+        return HLSLoggerLevelInfo;
+    }
+    else if ([levelName isEqualToString:kLoggerModeWarn.name]) {
+        return HLSLoggerLevelWarn;
+    }
+    else if ([levelName isEqualToString:kLoggerModeError.name]) {
+        return HLSLoggerLevelError;
+    }
+    else if ([levelName isEqualToString:kLoggerModeFatal.name]) {
+        return HLSLoggerLevelFatal;
+    }
+    else {
+        return HLSLoggerLevelNone;
+    }
+}
+
+#pragma mark Rate limiting
+
+BOOL HLSLoggerCallSiteShouldLog(HLSLoggerCallSite *callSite, NSUInteger *pSuppressedMessageCount)
+{
+    if (pSuppressedMessageCount) {
+        *pSuppressedMessageCount = 0;
+    }
+    
+    if (s_callSiteRateLimit == 0) {
+        return YES;
+    }
+    
+    // Start a new one-second window if needed. Races between threads are harmless (at worst a few more or less messages 
+    // are logged)
+    int64_t currentTime = (int64_t)(CFAbsoluteTimeGetCurrent() * 1000.);
+    int64_t windowStartTime = callSite->windowStartTime;
+    if (currentTime - windowStartTime >= 1000 
+            && OSAtomicCompareAndSwap64Barrier(windowStartTime, currentTime, &callSite->windowStartTime)) {
+        callSite->messageCount = 0;
+    }
+    
+    if (OSAtomicIncrement32Barrier(&callSite->messageCount) > s_callSiteRateLimit) {
+        OSAtomicIncrement32Barrier(&callSite->suppressedMessageCount);
+        return NO;
+    }
+    
+    int32_t suppressedMessageCount = callSite->suppressedMessageCount;
+    if (suppressedMessageCount != 0) {
+        OSAtomicAdd32Barrier(-suppressedMessageCount, &callSite->suppressedMessageCount);
+        if (pSuppressedMessageCount) {
+            *pSuppressedMessageCount = suppressedMessageCount;
+        }
+    }
+    return YES;
+}
+
+NSString *HLSLoggerSuppressedMessagesDescription(NSUInteger suppressedMessageCount)
+{
+    if (suppressedMessageCount == 0) {
+        return @"";
+    }
+    
+    return [NSString stringWithFormat:@" [%u similar messages suppressed]", suppressedMessageCount];
+}
+
+#pragma mark Monotonic time
+
+static NSTimeInterval HLSLoggerMachTimeToSeconds(uint64_t machTime)
+{
+    static mach_timebase_info_data_t s_timebaseInfo = {0, 0};
+    if (s_timebaseInfo.denom == 0) {
+        mach_timebase_info(&s_timebaseInfo);
+    }
+    return (NSTimeInterval)machTime * s_timebaseInfo.numer / s_timebaseInfo.denom / NSEC_PER_SEC;
+}
+
+NSTimeInterval HLSLoggerMonotonicTime(void)
+{
+    return HLSLoggerMachTimeToSeconds(mach_absolute_time());
+}
+
+#pragma mark Scope timing
+
+HLSLoggerScope HLSLoggerScopeBegin(HLSLoggerScopeTimings *timings, NSTimeInterval threshold, const char *function)
+{
+    HLSLoggerScope scope = {timings, function, threshold, 0};
+    if (! [[HLSLogger sharedLogger] isDebug]) {
+        return scope;
+    }
+    
+    // Register the call site the first time it is executed
+    if (OSAtomicCompareAndSwap32Barrier(0, 1, &timings->registered)) {
+        HLSLoggerScopeTimings *head = NULL;
+        do {
+            head = s_scopeTimingsList;
+            timings->next = head;
+        } while (! OSAtomicCompareAndSwapPtrBarrier(head, timings, (void *volatile *)&s_scopeTimingsList));
+    }
+    
+    scope.startTime = mach_absolute_time();
+    return scope;
+}
+
+void HLSLoggerScopeEnd(HLSLoggerScope *scope)
+{
+    if (scope->startTime == 0) {
+        return;
+    }
+    
+    int64_t elapsedTime = (int64_t)(mach_absolute_time() - scope->startTime);
+    
+    HLSLoggerScopeTimings *timings = scope->timings;
+    OSAtomicIncrement64Barrier(&timings->count);
+    OSAtomicAdd64Barrier(elapsedTime, &timings->totalTime);
+    
+    int64_t minTime = timings->minTime;
+    while (elapsedTime < minTime && ! OSAtomicCompareAndSwap64Barrier(minTime, elapsedTime, &timings->minTime)) {
+        minTime = timings->minTime;
+    }
+    int64_t maxTime = timings->maxTime;
+    while (elapsedTime > maxTime && ! OSAtomicCompareAndSwap64Barrier(maxTime, elapsedTime, &timings->maxTime)) {
+        maxTime = timings->maxTime;
+    }
+    
+    HLSLogger *logger = [HLSLogger sharedLogger];
+    if ([logger isAggregatingScopeTimings]) {
+        return;
+    }
+    
+    NSTimeInterval elapsedSeconds = HLSLoggerMachTimeToSeconds(elapsedTime);
+    if (elapsedSeconds >= scope->threshold) {
+        [logger debug:[NSString stringWithFormat:@"(%s) - Scope '%s' took %.3f ms", 
+                       scope->function, 
+                       timings->name, 
+                       elapsedSeconds * 1000.]];
+    }
+}
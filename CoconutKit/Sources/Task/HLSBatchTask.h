@@ -0,0 +1,56 @@
+//
+//  HLSBatchTask.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSTask.h"
+
+/**
+ * A batch task processes a range of independent items in parallel, as a single task. Instead of creating one task
+ * per item (and paying for one operation, one delegate round-trip and one set of task group entries per item), 
+ * create a single batch task. Its operation splits the range among several worker threads, workers running out 
+ * of items stealing items from the others, so that all cores are kept busy even if items have very different costs. 
+ * Progress is reported once for the whole batch
+ *
+ * To use a batch task, subclass HLSBatchTask and implement the -processItemAtIndex: method. Batch tasks are tagged with
+ * the HLSTaskExecutionClassCPU execution class by default
+ *
+ * Remark: Worker threads are spawned by the batch operation itself and therefore not subject to the concurrency 
+ *         limits of the task manager, use the maxWorkerCount property to limit them
+ *
+ * Designated initializer: -initWithRange:
+ */
+@interface HLSBatchTask : HLSTask {
+@private
+    NSRange _range;
+    NSUInteger _maxWorkerCount;
+}
+
+/**
+ * Create a batch task processing all indices in the given range
+ */
+- (id)initWithRange:(NSRange)range;
+
+/**
+ * The range of indices to process
+ */
+@property (nonatomic, readonly, assign) NSRange range;
+
+/**
+ * The maximum number of worker threads to use (including the thread running the batch operation). Default value is
+ * the number of active processors. Must be > 0, and must not be changed while the task is running
+ */
+@property (nonatomic, assign) NSUInteger maxWorkerCount;
+
+/**
+ * Process the item at the given index. This method is called exactly once for each index of the range, from several
+ * threads at the same time. Your implementation must therefore be thread-safe, and should not take long (check 
+ * cancellation within the implementation if it does)
+ * Must be overridden
+ */
+- (void)processItemAtIndex:(NSUInteger)index;
+
+@end
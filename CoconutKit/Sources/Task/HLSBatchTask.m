@@ -0,0 +1,66 @@
+//
+//  HLSBatchTask.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSBatchTask.h"
+
+#import "HLSAssert.h"
+#import "HLSBatchTaskOperation.h"
+#import "HLSLogger.h"
+
+@implementation HLSBatchTask
+
+#pragma mark -
+#pragma mark Object creation and destruction
+
+- (id)initWithRange:(NSRange)range
+{
+    if ((self = [super init])) {
+        _range = range;
+        self.maxWorkerCount = [[NSProcessInfo processInfo] activeProcessorCount];
+        self.executionClass = HLSTaskExecutionClassCPU;
+    }
+    return self;
+}
+
+- (id)init
+{
+    HLSForbiddenInheritedMethod();
+    return nil;
+}
+
+#pragma mark -
+#pragma mark Accessors and mutators
+
+- (Class)operationClass
+{
+    return [HLSBatchTaskOperation class];
+}
+
+@synthesize range = _range;
+
+@synthesize maxWorkerCount = _maxWorkerCount;
+
+- (void)setMaxWorkerCount:(NSUInteger)maxWorkerCount
+{
+    if (maxWorkerCount == 0) {
+        HLSLoggerError(@"The maximum number of workers must be > 0");
+        return;
+    }
+    
+    _maxWorkerCount = maxWorkerCount;
+}
+
+#pragma mark -
+#pragma mark Processing
+
+- (void)processItemAtIndex:(NSUInteger)index
+{
+    HLSMissingMethodImplementation();
+}
+
+@end
@@ -0,0 +1,34 @@
+//
+//  HLSBatchTaskOperation.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSTaskOperation.h"
+
+#include <libkern/OSAtomic.h>
+
+/**
+ * Range of indices owned by a worker. The owner takes items from the front, other workers steal from the back
+ */
+typedef struct {
+    OSSpinLock lock;
+    NSUInteger begin;
+    NSUInteger end;
+} HLSBatchWorkRange;
+
+/**
+ * Operation processing an HLSBatchTask using several worker threads
+ */
+@interface HLSBatchTaskOperation : HLSTaskOperation {
+@private
+    HLSBatchWorkRange *_workRanges;             // One per worker
+    NSUInteger _workerCount;
+    NSCondition *_workersCondition;             // Guards the number of spawned workers still running ...
+    NSUInteger _runningWorkerCount;             // ... which is this one
+    volatile int64_t _processedItemCount;
+}
+
+@end
@@ -0,0 +1,223 @@
+//
+//  HLSBatchTaskOperation.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSBatchTaskOperation.h"
+
+#import "HLSBatchTask.h"
+#import "HLSTaskOperation+Protected.h"
+
+// A worker takes this fraction of its remaining items at once. Chunks therefore get smaller as the range gets
+// exhausted, which keeps synchronization cheap at the beginning and load well balanced at the end
+static const NSUInteger kBatchChunkDivisor = 8;
+
+// Period at which progress is reported while the operation thread waits for the other workers
+static const NSTimeInterval kBatchProgressReportInterval = 0.1;
+
+@interface HLSBatchTaskOperation ()
+
+@property (nonatomic, retain) NSCondition *workersCondition;
+
+- (void)workerThreadMain:(NSNumber *)workerIndexNumber;
+- (void)processItemsForWorkerAtIndex:(NSUInteger)workerIndex;
+- (BOOL)takeChunkForWorkerAtIndex:(NSUInteger)workerIndex begin:(NSUInteger *)pBegin end:(NSUInteger *)pEnd;
+- (BOOL)stealItemsForWorkerAtIndex:(NSUInteger)workerIndex;
+- (void)reportProgress;
+
+@end
+
+@implementation HLSBatchTaskOperation
+
+#pragma mark -
+#pragma mark Object creation and destruction
+
+- (id)initWithTaskManager:(HLSTaskManager *)taskManager task:(HLSTask *)task
+{
+    if ((self = [super initWithTaskManager:taskManager task:task])) {
+        self.workersCondition = [[[NSCondition alloc] init] autorelease];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    self.workersCondition = nil;
+    [super dealloc];
+}
+
+#pragma mark -
+#pragma mark Accessors and mutators
+
+@synthesize workersCondition = _workersCondition;
+
+#pragma mark -
+#pragma mark Thread main function
+
+- (void)operationMain
+{
+    HLSBatchTask *batchTask = (HLSBatchTask *)self.task;
+    NSRange range = batchTask.range;
+    if (range.length == 0) {
+        return;
+    }
+    
+    // Initially split the range evenly between workers
+    _workerCount = MIN(batchTask.maxWorkerCount, range.length);
+    _workRanges = calloc(_workerCount, sizeof(HLSBatchWorkRange));
+    for (NSUInteger i = 0; i < _workerCount; ++i) {
+        _workRanges[i].lock = OS_SPINLOCK_INIT;
+        _workRanges[i].begin = range.location + (range.length * i) / _workerCount;
+        _workRanges[i].end = range.location + (range.length * (i + 1)) / _workerCount;
+    }
+    _processedItemCount = 0;
+    
+    // The thread running the operation is the first worker. Spawn the other ones
+    _runningWorkerCount = _workerCount - 1;
+    for (NSUInteger i = 1; i < _workerCount; ++i) {
+        [NSThread detachNewThreadSelector:@selector(workerThreadMain:) 
+                                 toTarget:self 
+                               withObject:[NSNumber numberWithUnsignedInteger:i]];
+    }
+    [self processItemsForWorkerAtIndex:0];
+    
+    // The operation must not end before all workers are done. Report progress meanwhile (only the operation thread
+    // is allowed to update the progress)
+    [self.workersCondition lock];
+    while (_runningWorkerCount != 0) {
+        [self.workersCondition waitUntilDate:[NSDate dateWithTimeIntervalSinceNow:kBatchProgressReportInterval]];
+        [self.workersCondition unlock];
+        [self reportProgress];
+        [self.workersCondition lock];
+    }
+    [self.workersCondition unlock];
+    
+    free(_workRanges);
+    _workRanges = NULL;
+    
+    [self reportProgress];
+}
+
+- (void)workerThreadMain:(NSNumber *)workerIndexNumber
+{
+    NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+    [self processItemsForWorkerAtIndex:[workerIndexNumber unsignedIntegerValue]];
+    [pool drain];
+    
+    [self.workersCondition lock];
+    --_runningWorkerCount;
+    [self.workersCondition signal];
+    [self.workersCondition unlock];
+}
+
+#pragma mark -
+#pragma mark Work distribution
+
+- (void)processItemsForWorkerAtIndex:(NSUInteger)workerIndex
+{
+    HLSBatchTask *batchTask = (HLSBatchTask *)self.task;
+    while (! [self isCancelled]) {
+        NSUInteger begin = 0;
+        NSUInteger end = 0;
+        if (! [self takeChunkForWorkerAtIndex:workerIndex begin:&begin end:&end]) {
+            // Own range exhausted. Steal from other workers, or stop if there is nothing left to steal
+            if (! [self stealItemsForWorkerAtIndex:workerIndex]) {
+                break;
+            }
+            continue;
+        }
+        
+        NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+        for (NSUInteger index = begin; index < end; ++index) {
+            if ([self isCancelled]) {
+                break;
+            }
+            [batchTask processItemAtIndex:index];
+        }
+        [pool drain];
+        
+        OSAtomicAdd64Barrier(end - begin, &_processedItemCount);
+        if (workerIndex == 0) {
+            [self reportProgress];
+        }
+    }
+}
+
+- (BOOL)takeChunkForWorkerAtIndex:(NSUInteger)workerIndex begin:(NSUInteger *)pBegin end:(NSUInteger *)pEnd
+{
+    HLSBatchWorkRange *workRange = &_workRanges[workerIndex];
+    
+    OSSpinLockLock(&workRange->lock);
+    NSUInteger remainingItemCount = workRange->end - workRange->begin;
+    if (remainingItemCount == 0) {
+        OSSpinLockUnlock(&workRange->lock);
+        return NO;
+    }
+    
+    NSUInteger chunkSize = MAX(remainingItemCount / kBatchChunkDivisor, 1);
+    *pBegin = workRange->begin;
+    *pEnd = workRange->begin + chunkSize;
+    workRange->begin = *pEnd;
+    OSSpinLockUnlock(&workRange->lock);
+    return YES;
+}
+
+/**
+ * Steal half of the remaining items of the most loaded worker. Return NO iff no worker has items left
+ */
+- (BOOL)stealItemsForWorkerAtIndex:(NSUInteger)workerIndex
+{
+    // Locate the most loaded worker. Ranges are read without locking, this is only a heuristic
+    NSUInteger victimIndex = NSNotFound;
+    NSUInteger maxRemainingItemCount = 0;
+    for (NSUInteger i = 0; i < _workerCount; ++i) {
+        if (i == workerIndex) {
+            continue;
+        }
+        
+        NSUInteger end = _workRanges[i].end;
+        NSUInteger begin = _workRanges[i].begin;
+        NSUInteger remainingItemCount = (begin < end) ? end - begin : 0;
+        if (remainingItemCount > maxRemainingItemCount) {
+            victimIndex = i;
+            maxRemainingItemCount = remainingItemCount;
+        }
+    }
+    
+    if (victimIndex == NSNotFound) {
+        return NO;
+    }
+    
+    // Steal from the back. The victim might have consumed its items meanwhile, in which case nothing is stolen (the
+    // caller will simply try again). Locks are never held simultaneously, which avoids deadlocks
+    HLSBatchWorkRange *victimWorkRange = &_workRanges[victimIndex];
+    OSSpinLockLock(&victimWorkRange->lock);
+    NSUInteger stolenItemCount = (victimWorkRange->end - victimWorkRange->begin + 1) / 2;
+    NSUInteger stolenEnd = victimWorkRange->end;
+    victimWorkRange->end -= stolenItemCount;
+    OSSpinLockUnlock(&victimWorkRange->lock);
+    
+    if (stolenItemCount != 0) {
+        HLSBatchWorkRange *workRange = &_workRanges[workerIndex];
+        OSSpinLockLock(&workRange->lock);
+        workRange->begin = stolenEnd - stolenItemCount;
+        workRange->end = stolenEnd;
+        OSSpinLockUnlock(&workRange->lock);
+    }
+    return YES;
+}
+
+#pragma mark -
+#pragma mark Progress
+
+- (void)reportProgress
+{
+    HLSBatchTask *batchTask = (HLSBatchTask *)self.task;
+    int64_t processedItemCount = OSAtomicAdd64Barrier(0, &_processedItemCount);
+    [self updateProgressToValue:(double)processedItemCount / batchTask.range.length];
+}
+
+@end
@@ -0,0 +1,60 @@
+//
+//  HLSCancellationToken.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+/**
+ * A cancellation token is an object which can be cancelled once, and which performs the cancellation actions 
+ * registered on it at that moment. Unlike polling a cancelled flag, this makes it possible to interrupt work 
+ * immediately (e.g. closing a socket on which some thread is blocked), or to forward cancellation to nested
+ * work (by registering child tokens which get cancelled together with their parent).
+ *
+ * Each HLSTaskOperation has a cancellation token, which gets cancelled as soon as the operation is (see 
+ * HLSTaskOperation+Protected.h).
+ *
+ * This class is thread-safe. Cancellation actions are performed synchronously on the thread calling -cancel (or
+ * on the thread registering them if the token has already been cancelled)
+ *
+ * Designated initializer: -init
+ */
+@interface HLSCancellationToken : NSObject {
+@private
+    BOOL _cancelled;
+    NSMutableArray *_invocations;
+    NSMutableArray *_childTokens;
+}
+
+/**
+ * Cancel the token, performing all registered cancellation actions / invocations in the order in which they have
+ * been added, and cancelling all child tokens. Calling this method on a token which has already been cancelled
+ * does nothing
+ */
+- (void)cancel;
+
+/**
+ * Return YES iff the token has been cancelled
+ */
+@property (nonatomic, readonly, assign, getter=isCancelled) BOOL cancelled;
+
+/**
+ * Optional invocations to be performed when the token gets cancelled. If the token has already been cancelled,
+ * the invocation is performed immediately
+ */
+- (void)addInvocation:(NSInvocation *)invocation;
+
+/**
+ * Optional actions (with signature - (void)methodName) to be invoked on some target when the token gets cancelled.
+ * The target is not retained. If the token has already been cancelled, the action is performed immediately
+ */
+- (void)addCancellationAction:(SEL)action onTarget:(id)target;
+
+/**
+ * Register a token to be cancelled when the receiver gets cancelled (the child token is retained). If the receiver
+ * has already been cancelled, the child token is cancelled immediately
+ */
+- (void)addChildToken:(HLSCancellationToken *)childToken;
+
+@end
@@ -0,0 +1,116 @@
+//
+//  HLSCancellationToken.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSCancellationToken.h"
+
+@interface HLSCancellationToken ()
+
+@property (nonatomic, assign, getter=isCancelled) BOOL cancelled;
+@property (nonatomic, retain) NSMutableArray *invocations;
+@property (nonatomic, retain) NSMutableArray *childTokens;
+
+@end
+
+@implementation HLSCancellationToken
+
+#pragma mark Object creation and destruction
+
+- (void)dealloc
+{
+    self.invocations = nil;
+    self.childTokens = nil;
+    [super dealloc];
+}
+
+#pragma mark Accessors and mutators
+
+@synthesize cancelled = _cancelled;
+
+- (BOOL)isCancelled
+{
+    @synchronized(self) {
+        return _cancelled;
+    }
+}
+
+@synthesize invocations = _invocations;
+
+@synthesize childTokens = _childTokens;
+
+#pragma mark Cancellation
+
+- (void)cancel
+{
+    // Flag as cancelled and extract pending work within the critical section, but perform it outside (actions might
+    // take some time, or access the token again)
+    NSArray *invocations = nil;
+    NSArray *childTokens = nil;
+    @synchronized(self) {
+        if (_cancelled) {
+            return;
+        }
+        _cancelled = YES;
+        
+        // Arrays are only created when needed, most tokens are never used
+        invocations = [[self.invocations retain] autorelease];
+        childTokens = [[self.childTokens retain] autorelease];
+        self.invocations = nil;
+        self.childTokens = nil;
+    }
+    
+    for (NSInvocation *invocation in invocations) {
+        [invocation invoke];
+    }
+    
+    for (HLSCancellationToken *childToken in childTokens) {
+        [childToken cancel];
+    }
+}
+
+- (void)addInvocation:(NSInvocation *)invocation
+{
+    @synchronized(self) {
+        if (! _cancelled) {
+            if (! self.invocations) {
+                self.invocations = [NSMutableArray array];
+            }
+            [self.invocations addObject:invocation];
+            return;
+        }
+    }
+    
+    // Already cancelled
+    [invocation invoke];
+}
+
+- (void)addCancellationAction:(SEL)action onTarget:(id)target
+{
+    NSMethodSignature *methodSignature = [[target class] instanceMethodSignatureForSelector:action];
+    NSInvocation *invocation = [NSInvocation invocationWithMethodSignature:methodSignature];
+    invocation.target = target;             // NSInvocation not set to retain its arguments here
+    invocation.selector = action;
+    [self addInvocation:invocation];
+}
+
+- (void)addChildToken:(HLSCancellationToken *)childToken
+{
+    @synchronized(self) {
+        if (! _cancelled) {
+            if (! self.childTokens) {
+                self.childTokens = [NSMutableArray array];
+            }
+            [self.childTokens addObject:childToken];
+            return;
+        }
+    }
+    
+    // Already cancelled
+    [childToken cancel];
+}
+
+@end
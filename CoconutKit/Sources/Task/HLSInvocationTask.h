@@ -0,0 +1,35 @@
+//
+//  HLSInvocationTask.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSTask.h"
+
+/**
+ * A task calling a method on some target, on one of the threads of the task manager it is submitted to. Use it
+ * for small units of work which do not deserve dedicated HLSTask and HLSTaskOperation subclasses. The method must 
+ * have the signature - (void)methodName:(id)object (or - (void)methodName if no object is provided), and must be 
+ * thread-safe. Information can be returned by the target itself, e.g. by storing it in the object it receives.
+ *
+ * The target and the object are retained until the task is deallocated. Be careful not to create retain cycles
+ * (e.g. by using an object keeping a reference to the task as target)
+ *
+ * Designated initializer: -initWithTarget:selector:object:
+ */
+@interface HLSInvocationTask : HLSTask {
+@private
+    id _target;
+    SEL _selector;
+    id _object;
+}
+
+- (id)initWithTarget:(id)target selector:(SEL)selector object:(id)object;
+
+@property (nonatomic, readonly, retain) id target;
+@property (nonatomic, readonly, assign) SEL selector;
+@property (nonatomic, readonly, retain) id object;
+
+@end
@@ -0,0 +1,71 @@
+//
+//  HLSInvocationTask.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSInvocationTask.h"
+
+#import "HLSAssert.h"
+#import "HLSInvocationTaskOperation.h"
+#import "HLSLogger.h"
+
+@interface HLSInvocationTask ()
+
+@property (nonatomic, retain) id target;
+@property (nonatomic, assign) SEL selector;
+@property (nonatomic, retain) id object;
+
+@end
+
+@implementation HLSInvocationTask
+
+#pragma mark -
+#pragma mark Object creation and destruction
+
+- (id)initWithTarget:(id)target selector:(SEL)selector object:(id)object
+{
+    if ((self = [super init])) {
+        if (! [target respondsToSelector:selector]) {
+            HLSLoggerError(@"The target %@ does not respond to the selector %@", target, NSStringFromSelector(selector));
+            [self release];
+            return nil;
+        }
+        
+        self.target = target;
+        self.selector = selector;
+        self.object = object;
+    }
+    return self;
+}
+
+- (id)init
+{
+    HLSForbiddenInheritedMethod();
+    return nil;
+}
+
+- (void)dealloc
+{
+    self.target = nil;
+    self.object = nil;
+    [super dealloc];
+}
+
+#pragma mark -
+#pragma mark Accessors and mutators
+
+- (Class)operationClass
+{
+    return [HLSInvocationTaskOperation class];
+}
+
+@synthesize target = _target;
+
+@synthesize selector = _selector;
+
+@synthesize object = _object;
+
+@end
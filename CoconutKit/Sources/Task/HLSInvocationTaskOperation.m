@@ -0,0 +1,24 @@
+//
+//  HLSInvocationTaskOperation.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSInvocationTaskOperation.h"
+
+#import "HLSInvocationTask.h"
+#import "HLSTaskOperation+Protected.h"
+
+@implementation HLSInvocationTaskOperation
+
+#pragma mark Thread main function
+
+- (void)operationMain
+{
+    HLSInvocationTask *invocationTask = (HLSInvocationTask *)self.task;
+    [invocationTask.target performSelector:invocationTask.selector withObject:invocationTask.object];
+}
+
+@end
@@ -0,0 +1,59 @@
+//
+//  HLSRemainingTimeEstimator.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#define kRemainingTimeEstimatorNoEstimateAvailable          -1.
+
+/**
+ * Estimates the time remaining before some progress value (between 0 and 1) reaches 1. Progress values are sampled
+ * using a monotonic clock, and the progress velocity is smoothed using an exponentially weighted moving average, so 
+ * that estimates do not jump when progress is irregular. Updating an estimator does not allocate any memory
+ *
+ * HLSTask and HLSTaskGroup objects use such an estimator by default. You can subclass HLSRemainingTimeEstimator to 
+ * implement your own estimation strategy and attach it to a task or a task group before it is submitted. Subclasses 
+ * must call the super implementation of the methods they override
+ *
+ * Designated initializer: -init
+ */
+@interface HLSRemainingTimeEstimator : NSObject {
+@private
+    double _smoothingFactor;
+    NSTimeInterval _minSamplingInterval;
+    uint64_t _lastSampleTime;               // 0 if no sample has been taken yet
+    float _lastSampleProgress;
+    double _smoothedVelocity;               // Progress per second, 0 if not available yet
+    float _progress;
+}
+
+/**
+ * Weight given to the most recent velocity sample, between 0 (exclusive) and 1 (inclusive, no smoothing). 
+ * Default value is 0.2
+ */
+@property (nonatomic, assign) double smoothingFactor;
+
+/**
+ * Progress values received faster are merged into a single velocity sample, which avoids estimates being 
+ * dominated by clock resolution or notification jitter. Default value is 0.1 seconds
+ */
+@property (nonatomic, assign) NSTimeInterval minSamplingInterval;
+
+/**
+ * Call this method when the progress value changes
+ */
+- (void)updateWithProgress:(float)progress;
+
+/**
+ * Discard all samples collected so far
+ */
+- (void)reset;
+
+/**
+ * The current estimate, or kRemainingTimeEstimatorNoEstimateAvailable if not enough samples have been collected yet
+ */
+- (NSTimeInterval)remainingTimeIntervalEstimate;
+
+@end
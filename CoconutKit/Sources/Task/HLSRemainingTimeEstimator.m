@@ -0,0 +1,130 @@
+//
+//  HLSRemainingTimeEstimator.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSRemainingTimeEstimator.h"
+
+#import "HLSFloat.h"
+#import "HLSLogger.h"
+
+#include <mach/mach_time.h>
+
+static NSTimeInterval timeIntervalFromMachTime(uint64_t machTime);
+
+@implementation HLSRemainingTimeEstimator
+
+#pragma mark Object creation and destruction
+
+- (id)init
+{
+    if ((self = [super init])) {
+        _smoothingFactor = 0.2;
+        _minSamplingInterval = 0.1;
+        [self reset];
+    }
+    return self;
+}
+
+#pragma mark Accessors and mutators
+
+@synthesize smoothingFactor = _smoothingFactor;
+
+- (void)setSmoothingFactor:(double)smoothingFactor
+{
+    if (doublele(smoothingFactor, 0.) || doublegt(smoothingFactor, 1.)) {
+        HLSLoggerWarn(@"The smoothing factor must be in ]0; 1]");
+        return;
+    }
+    
+    _smoothingFactor = smoothingFactor;
+}
+
+@synthesize minSamplingInterval = _minSamplingInterval;
+
+- (void)setMinSamplingInterval:(NSTimeInterval)minSamplingInterval
+{
+    if (doublelt(minSamplingInterval, 0.)) {
+        HLSLoggerWarn(@"The minimum sampling interval must be >= 0");
+        return;
+    }
+    
+    _minSamplingInterval = minSamplingInterval;
+}
+
+#pragma mark Estimation
+
+- (void)updateWithProgress:(float)progress
+{
+    _progress = progress;
+    
+    uint64_t currentTime = mach_absolute_time();
+    
+    // First sample: Nothing to compare with yet
+    if (_lastSampleTime == 0) {
+        _lastSampleTime = currentTime;
+        _lastSampleProgress = progress;
+        return;
+    }
+    
+    // Merge samples received too fast
+    NSTimeInterval elapsedTimeInterval = timeIntervalFromMachTime(currentTime - _lastSampleTime);
+    if (elapsedTimeInterval < _minSamplingInterval || doubleeq(elapsedTimeInterval, 0.)) {
+        return;
+    }
+    
+    // Progress going backwards cannot be used to estimate a velocity. Restart sampling from there
+    double velocity = (progress - _lastSampleProgress) / elapsedTimeInterval;
+    if (doublelt(velocity, 0.)) {
+        _lastSampleTime = currentTime;
+        _lastSampleProgress = progress;
+        return;
+    }
+    
+    // The first velocity sample is used as is
+    if (doubleeq(_smoothedVelocity, 0.)) {
+        _smoothedVelocity = velocity;
+    }
+    else {
+        _smoothedVelocity = _smoothingFactor * velocity + (1. - _smoothingFactor) * _smoothedVelocity;
+    }
+    
+    _lastSampleTime = currentTime;
+    _lastSampleProgress = progress;
+}
+
+- (void)reset
+{
+    _lastSampleTime = 0;
+    _lastSampleProgress = 0.f;
+    _smoothedVelocity = 0.;
+    _progress = 0.f;
+}
+
+- (NSTimeInterval)remainingTimeIntervalEstimate
+{
+    if (doubleeq(_smoothedVelocity, 0.)) {
+        return kRemainingTimeEstimatorNoEstimateAvailable;
+    }
+    
+    return (1. - _progress) / _smoothedVelocity;
+}
+
+@end
+
+/**
+ * Convert a mach absolute time difference into seconds. The timebase is retrieved once
+ */
+static NSTimeInterval timeIntervalFromMachTime(uint64_t machTime)
+{
+    static double s_secondsPerMachTimeUnit = 0.;
+    if (doubleeq(s_secondsPerMachTimeUnit, 0.)) {
+        mach_timebase_info_data_t timebaseInfo;
+        mach_timebase_info(&timebaseInfo);
+        s_secondsPerMachTimeUnit = ((double)timebaseInfo.numer / timebaseInfo.denom) * 1e-9;
+    }
+    return machTime * s_secondsPerMachTimeUnit;
+}
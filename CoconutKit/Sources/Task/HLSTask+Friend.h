@@ -8,6 +8,9 @@
 
 #import "HLSTaskGroup.h"
 
+// Forward declarations
+@class HLSTaskOperation;
+
 /**
  * Interface meant to be used by friend classes of HLSTask (= classes which must have access to private implementation
  * details)
@@ -20,6 +23,12 @@
 
 @property (nonatomic, assign, getter=isCancelled) BOOL cancelled;
 
+/**
+ * Set to YES by the task manager when the task deadline has passed, which attaches an HLSTaskErrorTimeout error to
+ * the task. Not affected by -reset, the task manager sets it to NO when the task is submitted
+ */
+@property (nonatomic, assign, getter=isTimedOut) BOOL timedOut;
+
 /**
  * Set the operation progress to 0.f (task not processed), 1.f (task fully processed), or a value in between 
  * (which should reflect an estimate about how much of the task has been processed)
@@ -32,6 +41,34 @@
 
 @property (nonatomic, assign) HLSTaskGroup *taskGroup;           // weak ref to parent task group
 
+/**
+ * The delegate registered for the task with the task manager it is submitted to. Stored on the task itself so that
+ * the task manager can retrieve it in constant time
+ */
+@property (nonatomic, retain) id<HLSTaskDelegate> registeredDelegate;
+
+/**
+ * Times at which the task has been submitted and started, used by the task manager to collect metrics. Both are 0
+ * if the task is not tracked. Not affected by -reset
+ */
+@property (nonatomic, assign) CFAbsoluteTime submissionTime;
+@property (nonatomic, assign) CFAbsoluteTime startTime;
+
+/**
+ * Identifier of the task in the task manager journal, 0 if the task is not currently recorded in a journal
+ */
+@property (nonatomic, assign) uint64_t journalIdentifier;
+
+/**
+ * The operation processing the task while it is registered with a task manager, nil otherwise
+ */
+@property (nonatomic, retain) HLSTaskOperation *operation;
+
+/**
+ * The timer used by the task manager to detect when the task deadline passes, nil if none
+ */
+@property (nonatomic, retain) NSTimer *deadlineTimer;
+
 /**
  * Reset internal status variables
  */
@@ -6,12 +6,54 @@
 //  Copyright 2010 Hortis. All rights reserved.
 //
 
+#import "HLSRemainingTimeEstimator.h"
+
 // Forward declarations
 @class HLSTaskGroup;
+@class HLSTaskOperation;
 @protocol HLSTaskDelegate;
 
 #define kTaskNoTimeIntervalEstimateAvailable        -1.
 
+/**
+ * Domain and codes of the errors attached to tasks by the task manager
+ */
+extern NSString * const HLSTaskErrorDomain;
+
+typedef enum {
+    HLSTaskErrorEnumBegin = 0,
+    HLSTaskErrorTimeout = HLSTaskErrorEnumBegin,                            // The task deadline has passed (see -[HLSTask timeoutInterval])
+    HLSTaskErrorEnumEnd,
+    HLSTaskErrorEnumSize = HLSTaskErrorEnumEnd - HLSTaskErrorEnumBegin
+} HLSTaskError;
+
+/**
+ * Kind of work a task performs. A task manager processes each kind of task in a separate pool of threads, so that
+ * e.g. many I/O-bound tasks waiting on the network cannot starve CPU-bound ones, and vice versa (see HLSTaskManager)
+ */
+typedef enum {
+    HLSTaskExecutionClassEnumBegin = 0,
+    HLSTaskExecutionClassDefault = HLSTaskExecutionClassEnumBegin,          // Default: General purpose pool
+    HLSTaskExecutionClassCPU,                                               // CPU-bound work (decoding, parsing, etc.)
+    HLSTaskExecutionClassIO,                                                // I/O-bound work (downloads, file copies, etc.)
+    HLSTaskExecutionClassEnumEnd,
+    HLSTaskExecutionClassEnumSize = HLSTaskExecutionClassEnumEnd - HLSTaskExecutionClassEnumBegin
+} HLSTaskExecutionClass;
+
+/**
+ * Task priorities. Among tasks ready to be started, a task manager starts those with higher priority first
+ */
+typedef enum {
+    HLSTaskPriorityEnumBegin = 0,
+    HLSTaskPriorityVeryLow = HLSTaskPriorityEnumBegin,
+    HLSTaskPriorityLow,
+    HLSTaskPriorityNormal,                                                  // Default
+    HLSTaskPriorityHigh,
+    HLSTaskPriorityVeryHigh,
+    HLSTaskPriorityEnumEnd,
+    HLSTaskPriorityEnumSize = HLSTaskPriorityEnumEnd - HLSTaskPriorityEnumBegin
+} HLSTaskPriority;
+
 /**
  * Abstract class for tasks. Tasks offer a delegate mechanism for tracking their status. To create your own
  * tasks, simply subclass HLSTask and override the -operationClass method to return the class of the operation
@@ -27,17 +69,27 @@
 @private
     NSString *_tag;
     NSDictionary *_userInfo;
+    HLSTaskExecutionClass _executionClass;
+    HLSTaskPriority _priority;
+    NSTimeInterval _timeoutInterval;
+    BOOL _journaled;
+    BOOL _deferrable;
+    dispatch_queue_t _delegateQueue;
+    uint64_t _journalIdentifier;                        // 0 if not recorded in a journal
     BOOL _running;
     BOOL _finished;
     BOOL _cancelled;
+    BOOL _timedOut;
     float _progress;
-    NSTimeInterval _remainingTimeIntervalEstimate;
-    NSDate *_lastEstimateDate;              // date & time when the remaining time was previously estimated ...
-    float _lastEstimateProgress;            // ... and corresponding progress value 
-    NSUInteger _progressStepsCounter; 
+    HLSRemainingTimeEstimator *_remainingTimeEstimator;
     NSDictionary *_returnInfo;
     NSError *_error;
     HLSTaskGroup *_taskGroup;               // parent task group if any, nil if none
+    id<HLSTaskDelegate> _registeredDelegate;            // delegate registered with the task manager, if any
+    HLSTaskOperation *_operation;                       // operation processing the task, if any
+    NSTimer *_deadlineTimer;                            // fires when the task deadline passes, nil if none
+    CFAbsoluteTime _submissionTime;                     // 0 if the task is not tracked by task manager metrics
+    CFAbsoluteTime _startTime;                          // 0 if not started yet
 }
 
 /**
@@ -47,7 +99,23 @@
 - (Class)operationClass;
 
 /**
- * Optional tag to identify a task
+ * Key identifying the result of the task, used by the task manager result cache (see -[HLSTaskManager resultCacheEnabled]).
+ * Tasks returning equal keys must produce the same returnInfo. The key must conform to NSCopying, e.g. the task userInfo
+ * if it completely describes the work to be done, and must not change while the task is running. Return nil (the default)
+ * if the result of the task cannot be cached
+ * Can be overridden
+ */
+- (id)resultCacheKey;
+
+/**
+ * Cost of keeping the result of the task in the task manager result cache (e.g. the approximate size in bytes of the
+ * objects it contains), counted against -[HLSTaskManager resultCacheTotalCostLimit]. Default is 0
+ * Can be overridden
+ */
+- (NSUInteger)resultCacheCostForReturnInfo:(NSDictionary *)returnInfo;
+
+/**
+ * Optional tag to identify a task. Must not be changed while the task is running
  * Not meant to be overridden
  */
 @property (nonatomic, retain) NSString *tag;
@@ -58,6 +126,60 @@
  */
 @property (nonatomic, retain) NSDictionary *userInfo;
 
+/**
+ * The kind of work performed by the task, which determines the pool of threads it is processed by. Default
+ * value is HLSTaskExecutionClassDefault. Must not be changed while the task is running
+ * Not meant to be overridden
+ */
+@property (nonatomic, assign) HLSTaskExecutionClass executionClass;
+
+/**
+ * The task priority. Default value is HLSTaskPriorityNormal. Within a task group, tasks with the same priority are
+ * started so that the longest chains of dependent tasks start first. Must not be changed while the task is running
+ * Not meant to be overridden
+ */
+@property (nonatomic, assign) HLSTaskPriority priority;
+
+/**
+ * Maximum time given to the task to complete, counted from the time it is submitted to a task manager. If the task
+ * has not been started when its deadline passes, it is dropped without being started. If it is running, it is 
+ * cancelled (see HLSTaskOperation for how operations must handle cancellation). In both cases, the task is reported
+ * as cancelled, and its error property is set to an HLSTaskErrorTimeout error. Set to 0 (the default) for no 
+ * deadline. Must not be changed while the task is running
+ * Not meant to be overridden
+ */
+@property (nonatomic, assign) NSTimeInterval timeoutInterval;
+
+/**
+ * If set to YES, the task is recorded in the journal of the task manager it is submitted to (if any, see 
+ * -[HLSTaskManager openJournalAtPath:error:]), so that it can be resumed if the application is terminated before
+ * it ends. A journaled task is recreated using -init, and its tag, userInfo, executionClass and priority properties
+ * are restored. Journaled tasks must therefore be completely described by these properties, and their userInfo must 
+ * only contain objects conforming to NSCoding. Default value is NO. Tasks belonging to a task group are recorded 
+ * if their task group is (see -[HLSTaskGroup journaled])
+ * Not meant to be overridden
+ */
+@property (nonatomic, assign, getter=isJournaled) BOOL journaled;
+
+/**
+ * If set to YES, the task is not urgent. When the throttling policy of the task manager it is submitted to says so 
+ * (see -[HLSTaskManager throttlingPolicy]), e.g. when the application is in the background, a deferrable task is not
+ * started until conditions improve. Default value is NO. Must not be changed while the task is running
+ * Not meant to be overridden
+ */
+@property (nonatomic, assign, getter=isDeferrable) BOOL deferrable;
+
+/**
+ * The dispatch queue onto which the delegate of the task is notified (asynchronously). If NULL (the default), the 
+ * delegate is notified where the task manager delivers notifications (see -[HLSTaskManager delegateQueue]). This
+ * way, a task manager can perform its bookkeeping on a background queue, while the delegate of a task updating the
+ * user interface is notified on the main queue. Since notifications are asynchronous, the task status might have 
+ * changed further when the delegate receives them. The queue is retained. Must not be changed while the task is 
+ * running
+ * Not meant to be overridden
+ */
+@property (nonatomic, assign) dispatch_queue_t delegateQueue;
+
 /**
  * Return YES if the task processing is running
  * Not meant to be overridden
@@ -91,6 +213,13 @@
  */
 @property (nonatomic, readonly, assign) NSTimeInterval remainingTimeIntervalEstimate;
 
+/**
+ * The object used to calculate remaining time estimates. By default, an HLSRemainingTimeEstimator object, which you 
+ * can customize or replace with an instance of a subclass implementing another strategy. Cannot be set to nil, and 
+ * must not be changed while the task is running
+ */
+@property (nonatomic, retain) HLSRemainingTimeEstimator *remainingTimeEstimator;
+
 /**
  * Return a localized string describing the estimated time before completion
  * (see remark of -remainingTimeIntervalEstimate method)
@@ -126,6 +255,12 @@
  */
 - (void)taskProgressUpdated:(HLSTask *)task;
 
+/**
+ * The task operation has produced a partial result (see -[HLSTaskOperation emitPartialResult:]). Partial results
+ * are received in the order they were emitted, always before the task ends
+ */
+- (void)task:(HLSTask *)task didProduceResult:(id)result;
+
 /**
  * The task has been fully processed. Check the error property to find if the processing was successful or not (and
  * why)
@@ -8,24 +8,33 @@
 
 #import "HLSTask.h"
 
+#import "HLSError.h"
 #import "HLSFloat.h"
 #import "HLSLogger.h"
+#import "HLSTaskGroup+Friend.h"
 #import "HLSTaskGroup.h"
 #import "NSBundle+HLSExtensions.h"
 
-const NSUInteger kProgressStepsCounterThreshold = 50;
+NSString * const HLSTaskErrorDomain = @"ch.hortis.CoconutKit.task";
 
 @interface HLSTask ()
 
 @property (nonatomic, assign, getter=isRunning) BOOL running;
 @property (nonatomic, assign, getter=isFinished) BOOL finished;
 @property (nonatomic, assign, getter=isCancelled) BOOL cancelled;
+@property (nonatomic, assign, getter=isTimedOut) BOOL timedOut;
 @property (nonatomic, assign) float progress;
-@property (nonatomic, assign) NSTimeInterval remainingTimeIntervalEstimate;
-@property (nonatomic, retain) NSDate *lastEstimateDate;
 @property (nonatomic, retain) NSDictionary *returnInfo;
 @property (nonatomic, retain) NSError *error;
 @property (nonatomic, assign) HLSTaskGroup *taskGroup;           // weak ref to parent task group
+@property (nonatomic, retain) id<HLSTaskDelegate> registeredDelegate;
+@property (nonatomic, assign) CFAbsoluteTime submissionTime;
+@property (nonatomic, assign) CFAbsoluteTime startTime;
+@property (nonatomic, assign) uint64_t journalIdentifier;
+@property (nonatomic, retain) HLSTaskOperation *operation;
+@property (nonatomic, retain) NSTimer *deadlineTimer;
+
+- (NSError *)timeoutError;
 
 - (void)reset;
 
@@ -39,6 +48,10 @@ const NSUInteger kProgressStepsCounterThreshold = 50;
 - (id)init
 {
     if ((self = [super init])) {
+        self.executionClass = HLSTaskExecutionClassDefault;
+        self.priority = HLSTaskPriorityNormal;
+        self.timeoutInterval = 0.;
+        self.remainingTimeEstimator = [[[HLSRemainingTimeEstimator alloc] init] autorelease];
         [self reset];
     }
     return self;
@@ -46,12 +59,18 @@ const NSUInteger kProgressStepsCounterThreshold = 50;
 
 - (void)dealloc
 {
+    // Detach from the task group first, so that it is not notified about status changes below
+    self.taskGroup = nil;
+    
     self.tag = nil;
     self.userInfo = nil;
-    self.lastEstimateDate = nil;
+    [_remainingTimeEstimator release];             // The setter rejects nil
     self.returnInfo = nil;
     self.error = nil;
-    self.taskGroup = nil;
+    self.registeredDelegate = nil;
+    self.operation = nil;
+    self.deadlineTimer = nil;
+    self.delegateQueue = NULL;
     [super dealloc];
 }
 
@@ -64,16 +83,82 @@ const NSUInteger kProgressStepsCounterThreshold = 50;
     return NULL;
 }
 
+- (id)resultCacheKey
+{
+    return nil;
+}
+
+- (NSUInteger)resultCacheCostForReturnInfo:(NSDictionary *)returnInfo
+{
+    return 0;
+}
+
 @synthesize tag = _tag;
 
 @synthesize userInfo = _userInfo;
 
+@synthesize executionClass = _executionClass;
+
+@synthesize priority = _priority;
+
+@synthesize timeoutInterval = _timeoutInterval;
+
+- (void)setTimeoutInterval:(NSTimeInterval)timeoutInterval
+{
+    if (doublelt(timeoutInterval, 0.)) {
+        HLSLoggerError(@"The timeout interval must be positive, or 0 for no deadline; value not changed");
+        return;
+    }
+    
+    _timeoutInterval = timeoutInterval;
+}
+
+@synthesize journaled = _journaled;
+
+@synthesize deferrable = _deferrable;
+
+@synthesize delegateQueue = _delegateQueue;
+
+- (void)setDelegateQueue:(dispatch_queue_t)delegateQueue
+{
+    if (delegateQueue == _delegateQueue) {
+        return;
+    }
+    
+    if (_delegateQueue) {
+        dispatch_release(_delegateQueue);
+    }
+    _delegateQueue = delegateQueue;
+    if (_delegateQueue) {
+        dispatch_retain(_delegateQueue);
+    }
+}
+
 @synthesize running = _running;
 
 @synthesize finished = _finished;
 
+- (void)setFinished:(BOOL)finished
+{
+    if (finished == _finished) {
+        return;
+    }
+    
+    [self.taskGroup removeStatusContributionOfTask:self];
+    _finished = finished;
+    [self.taskGroup addStatusContributionOfTask:self];
+}
+
 @synthesize cancelled = _cancelled;
 
+@synthesize timedOut = _timedOut;
+
+- (void)setTimedOut:(BOOL)timedOut
+{
+    _timedOut = timedOut;
+    self.error = timedOut ? [self timeoutError] : nil;
+}
+
 @synthesize progress = _progress;
 
 - (void)setProgress:(float)progress
@@ -83,6 +168,8 @@ const NSUInteger kProgressStepsCounterThreshold = 50;
         return;
     }
     
+    [self.taskGroup removeStatusContributionOfTask:self];
+    
     // Sanitize input
     if (floatlt(progress, 0.f) || floatgt(progress, 1.f)) {
         if (floatlt(progress, 0.f)) {
@@ -97,54 +184,76 @@ const NSUInteger kProgressStepsCounterThreshold = 50;
         _progress = progress;
     }
     
-    // Estimation is not made with each progress value change. If progress values are incremented fast, it is calculated
-    // after several changes. If progress value change is slow, we use a time difference criterium. This should provide
-    // accurate enough results
-    if (! _lastEstimateDate) {
-        _progressStepsCounter = 0;
-        self.lastEstimateDate = [NSDate date];
-        _lastEstimateProgress = progress;
-    }
-    else {
-        ++_progressStepsCounter;
+    [self.taskGroup addStatusContributionOfTask:self];
+    
+    [self.remainingTimeEstimator updateWithProgress:_progress];
+}
+
+@synthesize remainingTimeEstimator = _remainingTimeEstimator;
+
+- (void)setRemainingTimeEstimator:(HLSRemainingTimeEstimator *)remainingTimeEstimator
+{
+    if (_remainingTimeEstimator == remainingTimeEstimator) {
+        return;
     }
     
-    // Should update estimate?
-    NSTimeInterval elapsedTimeIntervalSinceLastEstimate = [[NSDate date] timeIntervalSinceDate:self.lastEstimateDate];
-    if (_progressStepsCounter > kProgressStepsCounterThreshold) {
-        // Calculate estimate based on velocity during previous step (never 0 since this method returns if progress does not change)
-        double progressSinceLastEstimate = progress - _lastEstimateProgress;
-        if (! doubleeq(progressSinceLastEstimate, 0.)) {
-            self.remainingTimeIntervalEstimate = (elapsedTimeIntervalSinceLastEstimate / progressSinceLastEstimate) * (1 - progress);
-            
-            // Get ready for next estimate
-            _progressStepsCounter = 0;
-            self.lastEstimateDate = [NSDate date];
-            _lastEstimateProgress = progress;
-        }
+    if (! remainingTimeEstimator) {
+        HLSLoggerWarn(@"A remaining time estimator is mandatory");
+        return;
     }
+    
+    [_remainingTimeEstimator release];
+    _remainingTimeEstimator = [remainingTimeEstimator retain];
 }
 
-@synthesize remainingTimeIntervalEstimate = _remainingTimeIntervalEstimate;
-
 - (NSTimeInterval)remainingTimeIntervalEstimate
 {
     if (! self.finished &&  ! self.cancelled) {
-        return _remainingTimeIntervalEstimate;
+        NSTimeInterval remainingTimeIntervalEstimate = [self.remainingTimeEstimator remainingTimeIntervalEstimate];
+        return doublege(remainingTimeIntervalEstimate, 0.) ? remainingTimeIntervalEstimate : kTaskNoTimeIntervalEstimateAvailable;
     }
     else {
         return kTaskNoTimeIntervalEstimateAvailable;
     }
 }
 
-@synthesize lastEstimateDate = _lastEstimateDate;
-
 @synthesize returnInfo = _returnInfo;
 
 @synthesize error = _error;
 
+- (void)setError:(NSError *)error
+{
+    if (error == _error) {
+        return;
+    }
+    
+    [self.taskGroup removeStatusContributionOfTask:self];
+    [_error release];
+    _error = [error retain];
+    [self.taskGroup addStatusContributionOfTask:self];
+}
+
 @synthesize taskGroup = _taskGroup;
 
+@synthesize registeredDelegate = _registeredDelegate;
+
+@synthesize submissionTime = _submissionTime;
+
+@synthesize startTime = _startTime;
+
+@synthesize journalIdentifier = _journalIdentifier;
+
+@synthesize operation = _operation;
+
+@synthesize deadlineTimer = _deadlineTimer;
+
+- (NSError *)timeoutError
+{
+    return [HLSError errorWithDomain:HLSTaskErrorDomain
+                                code:HLSTaskErrorTimeout 
+                localizedDescription:NSLocalizedStringFromTableInBundle(@"The task has timed out", @"Localizable", [NSBundle coconutKitBundle], @"The task has timed out")];
+}
+
 - (NSString *)remainingTimeIntervalEstimateLocalizedString
 {
     if (self.remainingTimeIntervalEstimate == kTaskGroupNoTimeIntervalEstimateAvailable) {
@@ -181,10 +290,11 @@ const NSUInteger kProgressStepsCounterThreshold = 50;
     self.finished = NO;
     self.cancelled = NO;
     self.progress = 0.f;
-    self.remainingTimeIntervalEstimate = kTaskNoTimeIntervalEstimateAvailable;
-    self.lastEstimateDate = nil;
+    [self.remainingTimeEstimator reset];
     self.returnInfo = nil;
-    self.error = nil;
+    
+    // The deadline might have passed before the task is reset when it starts
+    self.error = self.timedOut ? [self timeoutError] : nil;
 }
 
 @end
@@ -0,0 +1,32 @@
+//
+//  HLSTaskDelegateProxy.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+/**
+ * Private class for implementation purposes. Forward the messages it receives to a delegate, asynchronously on
+ * a dispatch queue (see -[HLSTask delegateQueue] and -[HLSTaskGroup delegateQueue]). Only messages returning void
+ * can be forwarded. The delegate and the message arguments are retained until the message has been delivered
+ *
+ * Designated initializer: -initWithDelegate:queue:
+ */
+@interface HLSTaskDelegateProxy : NSProxy {
+@private
+    id _delegate;
+    dispatch_queue_t _queue;
+}
+
+/**
+ * Convenience constructor
+ */
++ (id)proxyWithDelegate:(id)delegate queue:(dispatch_queue_t)queue;
+
+/**
+ * Create a proxy forwarding messages to the specified delegate (not retained) on the specified queue (retained)
+ */
+- (id)initWithDelegate:(id)delegate queue:(dispatch_queue_t)queue;
+
+@end
@@ -0,0 +1,75 @@
+//
+//  HLSTaskDelegateProxy.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSTaskDelegateProxy.h"
+
+// Function declarations
+static void deliverInvocation(void *context);
+
+@implementation HLSTaskDelegateProxy
+
+#pragma mark -
+#pragma mark Class methods
+
++ (id)proxyWithDelegate:(id)delegate queue:(dispatch_queue_t)queue
+{
+    return [[[[self class] alloc] initWithDelegate:delegate queue:queue] autorelease];
+}
+
+#pragma mark -
+#pragma mark Object creation and destruction
+
+- (id)initWithDelegate:(id)delegate queue:(dispatch_queue_t)queue
+{
+    // NSProxy has no -init method
+    _delegate = delegate;
+    _queue = queue;
+    dispatch_retain(_queue);
+    return self;
+}
+
+- (void)dealloc
+{
+    dispatch_release(_queue);
+    [super dealloc];
+}
+
+#pragma mark -
+#pragma mark Message forwarding
+
+- (BOOL)respondsToSelector:(SEL)selector
+{
+    return [_delegate respondsToSelector:selector];
+}
+
+- (NSMethodSignature *)methodSignatureForSelector:(SEL)selector
+{
+    return [_delegate methodSignatureForSelector:selector];
+}
+
+- (void)forwardInvocation:(NSInvocation *)invocation
+{
+    // The invocation retains the delegate and the arguments until it has been delivered
+    [invocation setTarget:_delegate];
+    [invocation retainArguments];
+    dispatch_async_f(_queue, [invocation retain], deliverInvocation);
+}
+
+@end
+
+#pragma mark -
+#pragma mark Static functions
+
+static void deliverInvocation(void *context)
+{
+    NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+    NSInvocation *invocation = (NSInvocation *)context;
+    [invocation invoke];
+    [invocation release];
+    [pool drain];
+}
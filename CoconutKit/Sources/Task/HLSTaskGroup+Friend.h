@@ -17,6 +17,24 @@
  */
 - (void)updateStatus;
 
+/**
+ * Called by a task of the task group before and after its progress, error or finished status changes, so that the
+ * task group can maintain its status incrementally. Each call costs constant time, whatever the number of tasks
+ */
+- (void)removeStatusContributionOfTask:(HLSTask *)task;
+- (void)addStatusContributionOfTask:(HLSTask *)task;
+
+/**
+ * Same as above, called by a task group contained in the receiver. Changes propagate to the enclosing task groups
+ */
+- (void)removeStatusContributionOfTaskGroup:(HLSTaskGroup *)taskGroup;
+- (void)addStatusContributionOfTaskGroup:(HLSTaskGroup *)taskGroup;
+
+/**
+ * Return the receiver and all task groups it contains, directly or not, enclosing task groups first
+ */
+- (NSArray *)allTaskGroups;
+
 @property (nonatomic, assign, getter=isRunning) BOOL running;
 
 @property (nonatomic, assign, getter=isFinished) BOOL finished;
@@ -24,18 +42,36 @@
 @property (nonatomic, assign, getter=isCancelled) BOOL cancelled;
 
 /**
- * Return the set of tasks which a task depends on
+ * Time at which the task group delegate was last notified about a progress update
+ */
+@property (nonatomic, assign) CFAbsoluteTime lastProgressNotificationTime;
+
+/**
+ * Return the set of members (HLSTask or HLSTaskGroup objects) which a member depends on
+ */
+- (NSSet *)dependenciesForTask:(id)task;
+- (NSSet *)weakDependenciesForTask:(id)task;
+- (NSSet *)strongDependenciesForTask:(id)task;
+
+/**
+ * Returns the set of members (HLSTask or HLSTaskGroup objects) depending on a member
+ */
+- (NSSet *)dependentsForTask:(id)task;
+- (NSSet *)weakDependentsForTask:(id)task;
+- (NSSet *)strongDependentsForTask:(id)task;
+
+/**
+ * Return the length of the longest chain of members depending (directly or indirectly) on a member, the member itself 
+ * included. A member on which no other member depends has therefore a critical path length of 1
  */
-- (NSSet *)dependenciesForTask:(HLSTask *)task;
-- (NSSet *)weakDependenciesForTask:(HLSTask *)task;
-- (NSSet *)strongDependenciesForTask:(HLSTask *)task;
+- (NSUInteger)criticalPathLengthForTask:(id)task;
 
 /**
- * Returns the set of tasks depending on a task
+ * Return all tasks (including those of the contained task groups) in the order they should preferably be scheduled: 
+ * By decreasing priority, and by decreasing critical path length for members with the same priority. The tasks of
+ * a contained task group are ordered recursively and take its place
  */
-- (NSSet *)dependentsForTask:(HLSTask *)task;
-- (NSSet *)weakDependentsForTask:(HLSTask *)task;
-- (NSSet *)strongDependentsForTask:(HLSTask *)task;
+- (NSArray *)tasksInSchedulingOrder;
 
 /**
  * Reset internal status variables
@@ -24,6 +24,15 @@
  * group which was fully processed can be submitted again (and with another delegate if needed), but must not be 
  * already running.
  *
+ * Task groups can also contain other task groups, e.g. for workflows made of successive stages, each stage processing
+ * several tasks in parallel. A task group and the task groups it contains are submitted as a whole (the contained 
+ * task groups cannot be submitted on their own), and members can depend on other members of the same task group,
+ * whether tasks or task groups. A task group is a single member of the task group it belongs to and, when another
+ * member depends on it, makes it wait for all tasks it contains (directly or not). Such dependencies are cheap: No 
+ * matter how many tasks the task groups contain, each dependency is set using a single method call and requires a 
+ * constant number of operation dependencies. The progress of a task group is the mean progress of its direct members. 
+ * The delegates of contained task groups are notified as usual.
+ *
  * Designated initializer: -init:
  */
 @interface HLSTaskGroup : NSObject {
@@ -31,25 +40,30 @@
     NSString *_tag;
     NSDictionary *_userInfo;
     NSMutableSet *_taskSet;                                     // contains HLSTask objects
-    // Dependencies between tasks are saved in both directions for faster lookup
-    NSMutableDictionary *_weakTaskDependencyMap;                // maps an HLSTask object to the NSMutableSet of all other HLSTask objects it weakly depends on
-    NSMutableDictionary *_strongTaskDependencyMap;              // maps an HLSTask object to the NSMutableSet of all other HLSTask objects it strongly depends on
-    NSMutableDictionary *_taskToWeakDependentsMap;              // maps an HLSTask object to the NSMutableSet of all HLSTask objects weakly depending on it
-    NSMutableDictionary *_taskToStrongDependentsMap;            // maps an HLSTask object to the NSMutableSet of all HLSTask objects strongly depending on it
+    NSMutableSet *_taskGroupSet;                                // contains HLSTaskGroup objects
+    HLSTaskGroup *_parentTaskGroup;                             // weak ref to the task group the receiver belongs to
+    // Dependencies between members (tasks or task groups) are saved in both directions for faster lookup
+    NSMutableDictionary *_weakTaskDependencyMap;                // maps a member to the NSMutableSet of all other members it weakly depends on
+    NSMutableDictionary *_strongTaskDependencyMap;              // maps a member to the NSMutableSet of all other members it strongly depends on
+    NSMutableDictionary *_taskToWeakDependentsMap;              // maps a member to the NSMutableSet of all members weakly depending on it
+    NSMutableDictionary *_taskToStrongDependentsMap;            // maps a member to the NSMutableSet of all members strongly depending on it
     BOOL _running;
     BOOL _finished;
     BOOL _cancelled;
     float _progress;                            // all individual progress values added
     float _fullProgress;                        // all individual progress values added (failures count as 1.f). 1 - _fullProgress is remainder
-    NSTimeInterval _remainingTimeIntervalEstimate;
-    NSDate *_lastEstimateDate;                  // date & time when the remaining time was previously estimated ...
-    float _lastEstimateFullProgress;            // ... and corresponding progress value 
-    NSUInteger _fullProgressStepsCounter;     
+    double _progressSum;                        // sums from which _progress and _fullProgress are calculated, updated as tasks 
+    double _fullProgressSum;                    // report their status
+    NSUInteger _nbrFinishedTasks;                               // finished members
+    HLSRemainingTimeEstimator *_remainingTimeEstimator;
     NSUInteger _nbrFailures;
+    CFAbsoluteTime _lastProgressNotificationTime;             // used by the task manager for progress update rate limiting
+    BOOL _journaled;
+    dispatch_queue_t _delegateQueue;
 }
 
 /**
- * Optional tag to identify a task group
+ * Optional tag to identify a task group. Must not be changed while the task group is running
  */
 @property (nonatomic, retain) NSString *tag;
 
@@ -58,16 +72,52 @@
  */
 @property (nonatomic, retain) NSDictionary *userInfo;
 
+/**
+ * If set to YES, the task group, its tasks and their dependencies are recorded in the journal of the task manager
+ * the task group is submitted to (if any), so that unfinished tasks can be resumed if the application is terminated. 
+ * All tasks must fulfill the requirements of journaled tasks (see -[HLSTask journaled]). The tag and userInfo
+ * of the task group are restored as well, and therefore must fulfill the same requirements. Default value is NO
+ */
+@property (nonatomic, assign, getter=isJournaled) BOOL journaled;
+
+/**
+ * The dispatch queue onto which the delegate of the task group is notified (asynchronously). If NULL (the default), 
+ * the delegate is notified where the task manager delivers notifications (see -[HLSTask delegateQueue] and
+ * -[HLSTaskManager delegateQueue]). The queue is retained. Must not be changed while the task group is running
+ */
+@property (nonatomic, assign) dispatch_queue_t delegateQueue;
+
 /**
  * Add a task to the task group
  */
 - (void)addTask:(HLSTask *)task;
 
 /**
- * Return the current set of HLSTask objects
+ * Return the current set of HLSTask objects directly contained in the task group
  */
 - (NSSet *)tasks;
 
+/**
+ * Add a task group to the task group. The task group must not belong to another task group, and must not contain
+ * the receiver
+ */
+- (void)addTaskGroup:(HLSTaskGroup *)taskGroup;
+
+/**
+ * Return the current set of HLSTaskGroup objects directly contained in the task group
+ */
+- (NSSet *)taskGroups;
+
+/**
+ * Return all HLSTask objects contained in the task group, directly or within the task groups it contains
+ */
+- (NSSet *)allTasks;
+
+/**
+ * The task group the receiver has been added to, nil if none
+ */
+@property (nonatomic, readonly, assign) HLSTaskGroup *parentTaskGroup;
+
 /**
  * Return YES if the task group is being processed
  */
@@ -98,6 +148,12 @@
  */
 @property (nonatomic, readonly, assign) NSTimeInterval remainingTimeIntervalEstimate;
 
+/**
+ * The object used to calculate remaining time estimates (see -[HLSTask remainingTimeEstimator]). Cannot be set to nil, 
+ * and must not be changed while the task group is running
+ */
+@property (nonatomic, retain) HLSRemainingTimeEstimator *remainingTimeEstimator;
+
 /**
  * Return a localized string describing the estimated time before completion
  * Not meant to be overridden
@@ -118,6 +174,16 @@
  */
 - (void)addDependencyForTask:(HLSTask *)task1 onTask:(HLSTask *)task2 strong:(BOOL)strong;
 
+/**
+ * Create dependencies involving task groups contained in the task group (see -addDependencyForTask:onTask:strong:).
+ * A task group depending on another member only starts processing its tasks once this member has been fully processed.
+ * A dependency on a task group is satisfied once all tasks it contains have been processed, and it fails if at least 
+ * one of them fails or is cancelled
+ */
+- (void)addDependencyForTaskGroup:(HLSTaskGroup *)taskGroup1 onTaskGroup:(HLSTaskGroup *)taskGroup2 strong:(BOOL)strong;
+- (void)addDependencyForTask:(HLSTask *)task onTaskGroup:(HLSTaskGroup *)taskGroup strong:(BOOL)strong;
+- (void)addDependencyForTaskGroup:(HLSTaskGroup *)taskGroup onTask:(HLSTask *)task strong:(BOOL)strong;
+
 @end
 
 @protocol HLSTaskGroupDelegate <NSObject>
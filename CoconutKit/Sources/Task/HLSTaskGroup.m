@@ -19,11 +19,15 @@
 // keep everything simple (because it is already complicated enough), I chose to create two separate kinds of
 // objects instead.
 
-const NSUInteger kFullProgressStepsCounterThreshold = 50;
+// Function declarations
+static HLSTaskPriority schedulingPriorityForMember(id member);
+static NSInteger compareTasksForScheduling(id task1, id task2, void *context);
 
 @interface HLSTaskGroup ()
 
 @property (nonatomic, retain) NSMutableSet *taskSet;
+@property (nonatomic, retain) NSMutableSet *taskGroupSet;
+@property (nonatomic, assign) HLSTaskGroup *parentTaskGroup;
 @property (nonatomic, retain) NSMutableDictionary *weakTaskDependencyMap;
 @property (nonatomic, retain) NSMutableDictionary *strongTaskDependencyMap;
 @property (nonatomic, retain) NSMutableDictionary *taskToWeakDependentsMap;
@@ -33,18 +37,38 @@ const NSUInteger kFullProgressStepsCounterThreshold = 50;
 @property (nonatomic, assign, getter=isCancelled) BOOL cancelled;
 @property (nonatomic, assign) float progress;
 @property (nonatomic, assign) float fullProgress;
-@property (nonatomic, assign) NSTimeInterval remainingTimeIntervalEstimate;
-@property (nonatomic, retain) NSDate *lastEstimateDate;
+@property (nonatomic, assign) CFAbsoluteTime lastProgressNotificationTime;
 
-- (void)updateStatus;
-
-- (NSSet *)dependenciesForTask:(HLSTask *)task;
-- (NSSet *)weakDependenciesForTask:(HLSTask *)task;
-- (NSSet *)strongDependenciesForTask:(HLSTask *)task;
+- (BOOL)containsTaskGroup:(HLSTaskGroup *)taskGroup;
+- (NSArray *)allTaskGroups;
 
-- (NSSet *)dependentsForTask:(HLSTask *)task;
-- (NSSet *)weakDependentsForTask:(HLSTask *)task;
-- (NSSet *)strongDependentsForTask:(HLSTask *)task;
+- (void)updateStatus;
+- (void)removeStatusContributionOfTask:(HLSTask *)task;
+- (void)addStatusContributionOfTask:(HLSTask *)task;
+- (void)removeStatusContributionOfTaskGroup:(HLSTaskGroup *)taskGroup;
+- (void)addStatusContributionOfTaskGroup:(HLSTaskGroup *)taskGroup;
+- (void)subtractContributionOfMember:(id)member;
+- (void)addContributionOfMember:(id)member;
+- (NSUInteger)nbrMembers;
+- (double)progressFromSums;
+- (double)fullProgressFromSums;
+- (BOOL)isFinishedFromSums;
+
+- (void)addDependencyForMember:(id)member1 onMember:(id)member2 strong:(BOOL)strong;
+
+- (NSSet *)dependenciesForTask:(id)task;
+- (NSSet *)weakDependenciesForTask:(id)task;
+- (NSSet *)strongDependenciesForTask:(id)task;
+
+- (NSSet *)dependentsForTask:(id)task;
+- (NSSet *)weakDependentsForTask:(id)task;
+- (NSSet *)strongDependentsForTask:(id)task;
+
+- (NSUInteger)criticalPathLengthForTask:(id)task;
+- (NSUInteger)criticalPathLengthForTask:(id)task 
+                        visitedTaskKeys:(NSMutableSet *)visitedTaskKeys
+                           lengthsCache:(NSMutableDictionary *)lengthsCache;
+- (NSArray *)tasksInSchedulingOrder;
 
 - (void)reset;
 
@@ -59,10 +83,12 @@ const NSUInteger kFullProgressStepsCounterThreshold = 50;
 {
     if ((self = [super init])) {
         self.taskSet = [NSMutableSet set];
+        self.taskGroupSet = [NSMutableSet set];
         self.weakTaskDependencyMap = [NSMutableDictionary dictionary];
         self.strongTaskDependencyMap = [NSMutableDictionary dictionary];
         self.taskToWeakDependentsMap = [NSMutableDictionary dictionary];
         self.taskToStrongDependentsMap = [NSMutableDictionary dictionary];
+        self.remainingTimeEstimator = [[[HLSRemainingTimeEstimator alloc] init] autorelease];
         [self reset];
     }
     return self;
@@ -70,14 +96,24 @@ const NSUInteger kFullProgressStepsCounterThreshold = 50;
 
 - (void)dealloc
 {
+    // Tasks might outlive their task group
+    for (HLSTask *task in self.taskSet) {
+        task.taskGroup = nil;
+    }
+    for (HLSTaskGroup *taskGroup in self.taskGroupSet) {
+        taskGroup.parentTaskGroup = nil;
+    }
+    
     self.tag = nil;
     self.userInfo = nil;
     self.taskSet = nil;
+    self.taskGroupSet = nil;
     self.weakTaskDependencyMap = nil;
     self.strongTaskDependencyMap = nil;
     self.taskToWeakDependentsMap = nil;
     self.taskToStrongDependentsMap = nil;
-    self.lastEstimateDate = nil;
+    [_remainingTimeEstimator release];             // The setter rejects nil
+    self.delegateQueue = NULL;
     [super dealloc];
 }
 
@@ -88,6 +124,25 @@ const NSUInteger kFullProgressStepsCounterThreshold = 50;
 
 @synthesize userInfo = _userInfo;
 
+@synthesize journaled = _journaled;
+
+@synthesize delegateQueue = _delegateQueue;
+
+- (void)setDelegateQueue:(dispatch_queue_t)delegateQueue
+{
+    if (delegateQueue == _delegateQueue) {
+        return;
+    }
+    
+    if (_delegateQueue) {
+        dispatch_release(_delegateQueue);
+    }
+    _delegateQueue = delegateQueue;
+    if (_delegateQueue) {
+        dispatch_retain(_delegateQueue);
+    }
+}
+
 @synthesize taskSet = _taskSet;
 
 - (NSSet *)tasks
@@ -95,6 +150,39 @@ const NSUInteger kFullProgressStepsCounterThreshold = 50;
     return [NSSet setWithSet:self.taskSet];
 }
 
+@synthesize taskGroupSet = _taskGroupSet;
+
+- (NSSet *)taskGroups
+{
+    return [NSSet setWithSet:self.taskGroupSet];
+}
+
+- (NSSet *)allTasks
+{
+    NSMutableSet *allTasks = [NSMutableSet set];
+    for (HLSTaskGroup *taskGroup in [self allTaskGroups]) {
+        [allTasks unionSet:taskGroup.taskSet];
+    }
+    return [NSSet setWithSet:allTasks];
+}
+
+- (NSArray *)allTaskGroups
+{
+    NSMutableArray *allTaskGroups = [NSMutableArray arrayWithObject:self];
+    for (NSUInteger i = 0; i < [allTaskGroups count]; ++i) {
+        HLSTaskGroup *taskGroup = [allTaskGroups objectAtIndex:i];
+        [allTaskGroups addObjectsFromArray:[taskGroup.taskGroupSet allObjects]];
+    }
+    return [NSArray arrayWithArray:allTaskGroups];
+}
+
+- (BOOL)containsTaskGroup:(HLSTaskGroup *)taskGroup
+{
+    return [[self allTaskGroups] indexOfObjectIdenticalTo:taskGroup] != NSNotFound;
+}
+
+@synthesize parentTaskGroup = _parentTaskGroup;
+
 @synthesize weakTaskDependencyMap = _weakTaskDependencyMap;
 
 @synthesize strongTaskDependencyMap = _strongTaskDependencyMap;
@@ -134,48 +222,38 @@ const NSUInteger kFullProgressStepsCounterThreshold = 50;
         _fullProgress = fullProgress;
     }    
     
-    // Estimation is not made with each progress value change. If progress values are incremented fast, it is calculated
-    // after several changes. If progress value change is slow, we use a time difference criterium. This should provide
-    // accurate enough results
-    if (! _lastEstimateDate) {
-        _fullProgressStepsCounter = 0;
-        self.lastEstimateDate = [NSDate date];
-        _lastEstimateFullProgress = fullProgress;
+    [self.remainingTimeEstimator updateWithProgress:_fullProgress];
+}
+
+@synthesize remainingTimeEstimator = _remainingTimeEstimator;
+
+- (void)setRemainingTimeEstimator:(HLSRemainingTimeEstimator *)remainingTimeEstimator
+{
+    if (_remainingTimeEstimator == remainingTimeEstimator) {
+        return;
     }
-    else {
-        ++_fullProgressStepsCounter;
-    }
-    
-    // Should update estimate?
-    NSTimeInterval elapsedTimeIntervalSinceLastEstimate = [[NSDate date] timeIntervalSinceDate:self.lastEstimateDate];
-    if (_fullProgressStepsCounter > kFullProgressStepsCounterThreshold) {
-        // Calculate estimate based on velocity during previous step
-        double fullProgressSinceLastEstimate = fullProgress - _lastEstimateFullProgress;
-        if (! doubleeq(fullProgressSinceLastEstimate, 0.)) {
-            self.remainingTimeIntervalEstimate = (elapsedTimeIntervalSinceLastEstimate / fullProgressSinceLastEstimate) * (1 - fullProgress);
-            
-            // Get ready for next estimate
-            _fullProgressStepsCounter = 0;
-            self.lastEstimateDate = [NSDate date];
-            _lastEstimateFullProgress = fullProgress;
-        }
+    
+    if (! remainingTimeEstimator) {
+        HLSLoggerWarn(@"A remaining time estimator is mandatory");
+        return;
     }
+    
+    [_remainingTimeEstimator release];
+    _remainingTimeEstimator = [remainingTimeEstimator retain];
 }
 
-@synthesize remainingTimeIntervalEstimate = _remainingTimeIntervalEstimate;
-
 - (NSTimeInterval)remainingTimeIntervalEstimate
 {
     if (! self.finished && ! self.cancelled) {
-        return _remainingTimeIntervalEstimate;
+        NSTimeInterval remainingTimeIntervalEstimate = [self.remainingTimeEstimator remainingTimeIntervalEstimate];
+        return doublege(remainingTimeIntervalEstimate, 0.) ? remainingTimeIntervalEstimate : kTaskGroupNoTimeIntervalEstimateAvailable;
     }
     else {
         return kTaskGroupNoTimeIntervalEstimateAvailable;
     }
 }
 
-@synthesize lastEstimateDate = _lastEstimateDate;
-
+@synthesize lastProgressNotificationTime = _lastProgressNotificationTime;
 
 - (NSUInteger)nbrFailures
 {
@@ -219,8 +297,46 @@ const NSUInteger kFullProgressStepsCounterThreshold = 50;
         return;
     }
     
+    if ([self.taskSet containsObject:task]) {
+        HLSLoggerInfo(@"Task %@ already belongs to the task group", task);
+        return;
+    }
+    
+    // The number of members changes, and so does the contribution of the task group to its enclosing task group
+    [self.parentTaskGroup removeStatusContributionOfTaskGroup:self];
     [self.taskSet addObject:task];
     task.taskGroup = self;
+    [self addContributionOfMember:task];
+    [self.parentTaskGroup addStatusContributionOfTaskGroup:self];
+}
+
+- (void)addTaskGroup:(HLSTaskGroup *)taskGroup
+{
+    if (self.running) {
+        HLSLoggerInfo(@"Cannot add a task group to a running task group");
+        return;
+    }
+    
+    if ([self.taskGroupSet containsObject:taskGroup]) {
+        HLSLoggerInfo(@"Task group %@ already belongs to the task group", taskGroup);
+        return;
+    }
+    
+    if (taskGroup.parentTaskGroup) {
+        HLSLoggerError(@"Task group %@ already belongs to another task group", taskGroup);
+        return;
+    }
+    
+    if ([taskGroup containsTaskGroup:self]) {
+        HLSLoggerError(@"Task group %@ contains the receiver and cannot be added to it", taskGroup);
+        return;
+    }
+    
+    [self.parentTaskGroup removeStatusContributionOfTaskGroup:self];
+    [self.taskGroupSet addObject:taskGroup];
+    taskGroup.parentTaskGroup = self;
+    [self addContributionOfMember:taskGroup];
+    [self.parentTaskGroup addStatusContributionOfTaskGroup:self];
 }
 
 #pragma mark -
@@ -228,34 +344,124 @@ const NSUInteger kFullProgressStepsCounterThreshold = 50;
 
 - (void)updateStatus
 {
-    // Calculate the overall progress and status
-    float progress = 0.f;
-    float fullProgress = 0.f;
-    BOOL finished = YES;
-    for (HLSTask *task in self.taskSet) {
-        progress += task.progress;
-        
-        // If at least one task is not finished, so is the task group
-        if (! task.finished) {
-            finished = NO;
-        }
-        
-        // Failed tasks increase the failure counter and count for 1 in fullProgress
-        if (task.error) {
-            fullProgress += 1.f;
-            ++_nbrFailures;
+    if ([self nbrMembers] == 0) {
+        return;
+    }
+    
+    self.progress = [self progressFromSums];
+    self.fullProgress = [self fullProgressFromSums];
+    
+    // If at least one member is not finished, so is the task group
+    self.finished = [self isFinishedFromSums];
+}
+
+// The status of the enclosing task groups depends on the status of the receiver: Remove its contribution before it
+// changes, and add it again afterwards
+- (void)removeStatusContributionOfTask:(HLSTask *)task
+{
+    [self.parentTaskGroup removeStatusContributionOfTaskGroup:self];
+    [self subtractContributionOfMember:task];
+}
+
+- (void)addStatusContributionOfTask:(HLSTask *)task
+{
+    [self addContributionOfMember:task];
+    [self.parentTaskGroup addStatusContributionOfTaskGroup:self];
+}
+
+- (void)removeStatusContributionOfTaskGroup:(HLSTaskGroup *)taskGroup
+{
+    [self.parentTaskGroup removeStatusContributionOfTaskGroup:self];
+    [self subtractContributionOfMember:taskGroup];
+}
+
+- (void)addStatusContributionOfTaskGroup:(HLSTaskGroup *)taskGroup
+{
+    [self addContributionOfMember:taskGroup];
+    [self.parentTaskGroup addStatusContributionOfTaskGroup:self];
+}
+
+- (void)subtractContributionOfMember:(id)member
+{
+    if ([member isKindOfClass:[HLSTaskGroup class]]) {
+        HLSTaskGroup *taskGroup = (HLSTaskGroup *)member;
+        _progressSum -= [taskGroup progressFromSums];
+        _fullProgressSum -= [taskGroup fullProgressFromSums];
+        _nbrFailures -= taskGroup->_nbrFailures;
+        if ([taskGroup isFinishedFromSums]) {
+            --_nbrFinishedTasks;
         }
-        else {
-            fullProgress += task.progress;
+        return;
+    }
+    
+    HLSTask *task = (HLSTask *)member;
+    _progressSum -= task.progress;
+    
+    // Failed tasks increase the failure counter and count for 1 in fullProgress
+    if (task.error) {
+        _fullProgressSum -= 1.;
+        --_nbrFailures;
+    }
+    else {
+        _fullProgressSum -= task.progress;
+    }
+    
+    if (task.finished) {
+        --_nbrFinishedTasks;
+    }
+}
+
+- (void)addContributionOfMember:(id)member
+{
+    if ([member isKindOfClass:[HLSTaskGroup class]]) {
+        HLSTaskGroup *taskGroup = (HLSTaskGroup *)member;
+        _progressSum += [taskGroup progressFromSums];
+        _fullProgressSum += [taskGroup fullProgressFromSums];
+        _nbrFailures += taskGroup->_nbrFailures;
+        if ([taskGroup isFinishedFromSums]) {
+            ++_nbrFinishedTasks;
         }
+        return;
+    }
+    
+    HLSTask *task = (HLSTask *)member;
+    _progressSum += task.progress;
+    
+    if (task.error) {
+        _fullProgressSum += 1.;
+        ++_nbrFailures;
+    }
+    else {
+        _fullProgressSum += task.progress;
     }
-    progress /= [self.taskSet count];
-    fullProgress /= [self.taskSet count];
     
-    // Update the values stored internally
-    self.progress = progress;
-    self.fullProgress = fullProgress;
-    self.finished = finished;
+    if (task.finished) {
+        ++_nbrFinishedTasks;
+    }
+}
+
+- (NSUInteger)nbrMembers
+{
+    return [self.taskSet count] + [self.taskGroupSet count];
+}
+
+// The sums are updated incrementally as members report their status. Rounding errors might accumulate, clamp the 
+// values. An empty task group has nothing left to do
+- (double)progressFromSums
+{
+    NSUInteger nbrMembers = [self nbrMembers];
+    return (nbrMembers != 0) ? MIN(MAX(_progressSum / nbrMembers, 0.), 1.) : 1.;
+}
+
+- (double)fullProgressFromSums
+{
+    NSUInteger nbrMembers = [self nbrMembers];
+    return (nbrMembers != 0) ? MIN(MAX(_fullProgressSum / nbrMembers, 0.), 1.) : 1.;
+}
+
+- (BOOL)isFinishedFromSums
+{
+    return _nbrFinishedTasks == [self nbrMembers];
 }
 
 #pragma mark -
@@ -263,19 +469,40 @@ const NSUInteger kFullProgressStepsCounterThreshold = 50;
 
 - (void)addDependencyForTask:(HLSTask *)task1 onTask:(HLSTask *)task2 strong:(BOOL)strong
 {
-    // Check that both tasks are part of the task group
-    if (! [self.taskSet containsObject:task1]) {
-        HLSLoggerError(@"First task %@ does not belong to the task group set; cannot set a dependency", task1);
+    [self addDependencyForMember:task1 onMember:task2 strong:strong];
+}
+
+- (void)addDependencyForTaskGroup:(HLSTaskGroup *)taskGroup1 onTaskGroup:(HLSTaskGroup *)taskGroup2 strong:(BOOL)strong
+{
+    [self addDependencyForMember:taskGroup1 onMember:taskGroup2 strong:strong];
+}
+
+- (void)addDependencyForTask:(HLSTask *)task onTaskGroup:(HLSTaskGroup *)taskGroup strong:(BOOL)strong
+{
+    [self addDependencyForMember:task onMember:taskGroup strong:strong];
+}
+
+- (void)addDependencyForTaskGroup:(HLSTaskGroup *)taskGroup onTask:(HLSTask *)task strong:(BOOL)strong
+{
+    [self addDependencyForMember:taskGroup onMember:task strong:strong];
+}
+
+- (void)addDependencyForMember:(id)task1 onMember:(id)task2 strong:(BOOL)strong
+{
+    // Check that both members are part of the task group
+    if (! [self.taskSet containsObject:task1] && ! [self.taskGroupSet containsObject:task1]) {
+        HLSLoggerError(@"First member %@ does not belong to the task group; cannot set a dependency", task1);
         return;
     }
-    if (! [self.taskSet containsObject:task2]) {
-        HLSLoggerError(@"Second task %@ does not belong to the task group set; cannot set a dependency", task2);
+    if (! [self.taskSet containsObject:task2] && ! [self.taskGroupSet containsObject:task2]) {
+        HLSLoggerError(@"Second member %@ does not belong to the task group; cannot set a dependency", task2);
         return;
     }
     
     // Cannot set a dependency on itself!
     if (task1 == task2) {
-        HLSLoggerError(@"A task cannot add itself as dependency");
+        HLSLoggerError(@"A member cannot add itself as dependency");
+        return;
     }
     
     // A dependency is either weak or strong, and cannot be registered several times
@@ -314,44 +541,112 @@ const NSUInteger kFullProgressStepsCounterThreshold = 50;
     [task2Dependents addObject:task1];
 }
 
-- (NSSet *)dependenciesForTask:(HLSTask *)task
+- (NSSet *)dependenciesForTask:(id)task
 {
     NSSet *weakDependencies = [self weakDependenciesForTask:task];
     NSSet *strongDependencies = [self strongDependenciesForTask:task];
     return [weakDependencies setByAddingObjectsFromSet:strongDependencies];
 }
 
-- (NSSet *)weakDependenciesForTask:(HLSTask *)task
+- (NSSet *)weakDependenciesForTask:(id)task
 {
     NSValue *taskKey = [NSValue valueWithPointer:task];
     return [NSSet setWithSet:[self.weakTaskDependencyMap objectForKey:taskKey]];
 }
 
-- (NSSet *)strongDependenciesForTask:(HLSTask *)task
+- (NSSet *)strongDependenciesForTask:(id)task
 {
     NSValue *taskKey = [NSValue valueWithPointer:task];
     return [NSSet setWithSet:[self.strongTaskDependencyMap objectForKey:taskKey]];    
 }
 
-- (NSSet *)dependentsForTask:(HLSTask *)task
+- (NSSet *)dependentsForTask:(id)task
 {
     NSSet *weakDependents = [self weakDependentsForTask:task];
     NSSet *strongDependents = [self strongDependentsForTask:task];
     return [weakDependents setByAddingObjectsFromSet:strongDependents];
 }
 
-- (NSSet *)weakDependentsForTask:(HLSTask *)task
+- (NSSet *)weakDependentsForTask:(id)task
 {
     NSValue *taskKey = [NSValue valueWithPointer:task];
     return [NSSet setWithSet:[self.taskToWeakDependentsMap objectForKey:taskKey]];
 }
 
-- (NSSet *)strongDependentsForTask:(HLSTask *)task
+- (NSSet *)strongDependentsForTask:(id)task
 {
     NSValue *taskKey = [NSValue valueWithPointer:task];
     return [NSSet setWithSet:[self.taskToStrongDependentsMap objectForKey:taskKey]];    
 }
 
+#pragma mark -
+#pragma mark Scheduling
+
+- (NSUInteger)criticalPathLengthForTask:(id)task
+{
+    return [self criticalPathLengthForTask:task 
+                           visitedTaskKeys:[NSMutableSet set] 
+                              lengthsCache:[NSMutableDictionary dictionary]];
+}
+
+- (NSUInteger)criticalPathLengthForTask:(id)task 
+                        visitedTaskKeys:(NSMutableSet *)visitedTaskKeys
+                           lengthsCache:(NSMutableDictionary *)lengthsCache
+{
+    NSValue *taskKey = [NSValue valueWithPointer:task];
+    NSNumber *cachedLength = [lengthsCache objectForKey:taskKey];
+    if (cachedLength) {
+        return [cachedLength unsignedIntegerValue];
+    }
+    
+    // Dependency cycles cannot be processed (and would deadlock anyway). Just avoid infinite recursion
+    if ([visitedTaskKeys containsObject:taskKey]) {
+        HLSLoggerWarn(@"Dependency cycle detected for task %@", task);
+        return 0;
+    }
+    [visitedTaskKeys addObject:taskKey];
+    
+    NSUInteger maxDependentLength = 0;
+    for (id dependent in [self dependentsForTask:task]) {
+        NSUInteger dependentLength = [self criticalPathLengthForTask:dependent 
+                                                     visitedTaskKeys:visitedTaskKeys 
+                                                        lengthsCache:lengthsCache];
+        maxDependentLength = MAX(maxDependentLength, dependentLength);
+    }
+    
+    [visitedTaskKeys removeObject:taskKey];
+    
+    NSUInteger length = maxDependentLength + 1;
+    [lengthsCache setObject:[NSNumber numberWithUnsignedInteger:length] forKey:taskKey];
+    return length;
+}
+
+- (NSArray *)tasksInSchedulingOrder
+{
+    // Calculate all critical path lengths at once, sharing intermediate results
+    NSArray *members = [[self.taskSet allObjects] arrayByAddingObjectsFromArray:[self.taskGroupSet allObjects]];
+    NSMutableDictionary *lengthsCache = [NSMutableDictionary dictionary];
+    for (id member in members) {
+        [self criticalPathLengthForTask:member visitedTaskKeys:[NSMutableSet set] lengthsCache:lengthsCache];
+    }
+    
+    NSArray *sortedMembers = [members sortedArrayUsingFunction:compareTasksForScheduling context:lengthsCache];
+    if ([self.taskGroupSet count] == 0) {
+        return sortedMembers;
+    }
+    
+    NSMutableArray *tasks = [NSMutableArray array];
+    for (id member in sortedMembers) {
+        if ([member isKindOfClass:[HLSTaskGroup class]]) {
+            [tasks addObjectsFromArray:[member tasksInSchedulingOrder]];
+        }
+        else {
+            [tasks addObject:member];
+        }
+    }
+    return [NSArray arrayWithArray:tasks];
+}
+
 #pragma mark -
 #pragma mark Resetting
 
@@ -362,9 +657,64 @@ const NSUInteger kFullProgressStepsCounterThreshold = 50;
     self.cancelled = NO;
     self.progress = 0.f;
     self.fullProgress = 0.f;
-    self.remainingTimeIntervalEstimate = kTaskGroupNoTimeIntervalEstimateAvailable;
-    self.lastEstimateDate = nil;
+    [self.remainingTimeEstimator reset];
+    self.lastProgressNotificationTime = 0.;
+    
+    // Calculate the sums from scratch once (contained task groups first), from then on they are updated incrementally
+    for (HLSTaskGroup *taskGroup in self.taskGroupSet) {
+        [taskGroup reset];
+    }
+    
+    _progressSum = 0.;
+    _fullProgressSum = 0.;
+    _nbrFinishedTasks = 0;
     _nbrFailures = 0;
+    for (HLSTask *task in self.taskSet) {
+        [self addContributionOfMember:task];
+    }
+    for (HLSTaskGroup *taskGroup in self.taskGroupSet) {
+        [self addContributionOfMember:taskGroup];
+    }
 }
 
 @end
+
+#pragma mark Static functions
+
+/**
+ * A task group is scheduled with the highest priority of the tasks it contains
+ */
+static HLSTaskPriority schedulingPriorityForMember(id member)
+{
+    if (! [member isKindOfClass:[HLSTaskGroup class]]) {
+        return ((HLSTask *)member).priority;
+    }
+    
+    HLSTaskPriority priority = HLSTaskPriorityEnumBegin;
+    for (HLSTask *task in [(HLSTaskGroup *)member allTasks]) {
+        priority = MAX(priority, task.priority);
+    }
+    return priority;
+}
+
+/**
+ * Sort members by decreasing priority, then by decreasing critical path length (the context being a dictionary mapping 
+ * member pointers to their critical path length)
+ */
+static NSInteger compareTasksForScheduling(id task1, id task2, void *context)
+{
+    HLSTaskPriority firstPriority = schedulingPriorityForMember(task1);
+    HLSTaskPriority secondPriority = schedulingPriorityForMember(task2);
+    if (firstPriority != secondPriority) {
+        return firstPriority > secondPriority ? NSOrderedAscending : NSOrderedDescending;
+    }
+    
+    NSDictionary *lengthsCache = (NSDictionary *)context;
+    NSUInteger firstLength = [[lengthsCache objectForKey:[NSValue valueWithPointer:task1]] unsignedIntegerValue];
+    NSUInteger secondLength = [[lengthsCache objectForKey:[NSValue valueWithPointer:task2]] unsignedIntegerValue];
+    if (firstLength != secondLength) {
+        return firstLength > secondLength ? NSOrderedAscending : NSOrderedDescending;
+    }
+    
+    return NSOrderedSame;
+}
@@ -0,0 +1,61 @@
+//
+//  HLSTaskJournal.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSFileManager.h"
+#import "HLSTask.h"
+#import "HLSTaskGroup.h"
+
+/**
+ * Append-only journal recording journaled tasks and task groups submitted to a task manager, as well as their end,
+ * so that unfinished work can be resumed after the application has been terminated (see -[HLSTaskManager 
+ * openJournalAtPath:error:]).
+ *
+ * The journal is a binary file made of a header followed by records: A 1-byte record type, a 4-byte little-endian 
+ * payload length and the payload. End records, by far the most frequent ones, only contain a 8-byte task identifier. 
+ * Submission records also contain the keyed archive of the properties needed to recreate the task (or task group). 
+ * A record truncated because the application was killed while writing it is ignored. When a journal is opened, it 
+ * is compacted so that it only contains unfinished work.
+ *
+ * This class is not thread-safe, and is meant to be used by a task manager only
+ *
+ * Designated initializer: -initWithPath:fileManager:
+ */
+@interface HLSTaskJournal : NSObject {
+@private
+    NSString *_path;
+    HLSFileManager *_fileManager;
+    uint64_t _nextIdentifier;
+    NSMutableArray *_unfinishedDescriptions;        // Descriptions of unfinished tasks and task groups read when opening
+}
+
+- (id)initWithPath:(NSString *)path fileManager:(HLSFileManager *)fileManager;
+
+/**
+ * Read the journal (if it exists) and compact it. Return YES iff successful
+ */
+- (BOOL)open:(NSError **)pError;
+
+/**
+ * Recreate the unfinished tasks and task groups found when the journal was opened, as HLSTask and HLSTaskGroup 
+ * objects. Tasks are returned with their journal identifier set, so that they are not recorded again when submitted.
+ * Objects are restored once, subsequent calls return an empty array
+ */
+- (NSArray *)restoreUnfinishedObjects;
+
+/**
+ * Record the submission of a task or of a task group (and all its tasks). Assign journal identifiers to tasks
+ */
+- (void)recordSubmissionForTask:(HLSTask *)task;
+- (void)recordSubmissionForTaskGroup:(HLSTaskGroup *)taskGroup;
+
+/**
+ * Record the end of a task (whether it succeeded, failed or has been cancelled). Its journal identifier is reset
+ */
+- (void)recordEndForTask:(HLSTask *)task;
+
+@end
@@ -0,0 +1,448 @@
+//
+//  HLSTaskJournal.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSTaskJournal.h"
+
+#import "HLSAssert.h"
+#import "HLSLogger.h"
+#import "HLSTask+Friend.h"
+#import "HLSTaskGroup+Friend.h"
+
+typedef enum {
+    HLSTaskJournalRecordTypeEnumBegin = 1,
+    HLSTaskJournalRecordTypeTask = HLSTaskJournalRecordTypeEnumBegin,
+    HLSTaskJournalRecordTypeTaskGroup,
+    HLSTaskJournalRecordTypeEnd,
+    HLSTaskJournalRecordTypeEnumEnd,
+    HLSTaskJournalRecordTypeEnumSize = HLSTaskJournalRecordTypeEnumEnd - HLSTaskJournalRecordTypeEnumBegin
+} HLSTaskJournalRecordType;
+
+static const char kTaskJournalMagic[4] = { 'H', 'L', 'S', 'J' };
+static const uint8_t kTaskJournalVersion = 1;
+
+// Size of the record type and of the payload length
+static const NSUInteger kTaskJournalRecordHeaderSize = sizeof(uint8_t) + sizeof(uint32_t);
+
+static NSString * const kTaskJournalIdentifierKey = @"identifier";
+static NSString * const kTaskJournalClassNameKey = @"className";
+static NSString * const kTaskJournalTagKey = @"tag";
+static NSString * const kTaskJournalUserInfoKey = @"userInfo";
+static NSString * const kTaskJournalExecutionClassKey = @"executionClass";
+static NSString * const kTaskJournalPriorityKey = @"priority";
+static NSString * const kTaskJournalTasksKey = @"tasks";
+static NSString * const kTaskJournalDependenciesKey = @"dependencies";
+static NSString * const kTaskJournalDependencyTaskKey = @"task";
+static NSString * const kTaskJournalDependencyOnTaskKey = @"onTask";
+static NSString * const kTaskJournalDependencyStrongKey = @"strong";
+static NSString * const kTaskJournalTaskGroupFlagKey = @"taskGroup";
+
+@interface HLSTaskJournal ()
+
+@property (nonatomic, retain) NSString *path;
+@property (nonatomic, retain) HLSFileManager *fileManager;
+@property (nonatomic, retain) NSMutableArray *unfinishedDescriptions;
+
+- (NSDictionary *)descriptionForTask:(HLSTask *)task;
+- (HLSTask *)taskFromDescription:(NSDictionary *)description;
+- (HLSTaskGroup *)taskGroupFromDescription:(NSDictionary *)description;
+
+- (NSData *)recordWithType:(HLSTaskJournalRecordType)type identifier:(uint64_t)identifier description:(NSDictionary *)description;
+- (NSData *)headerData;
+- (void)appendRecord:(NSData *)record;
+
+@end
+
+@implementation HLSTaskJournal
+
+#pragma mark Object creation and destruction
+
+- (id)initWithPath:(NSString *)path fileManager:(HLSFileManager *)fileManager
+{
+    if ((self = [super init])) {
+        if (! path || ! fileManager) {
+            HLSLoggerError(@"A path and a file manager are mandatory");
+            [self release];
+            return nil;
+        }
+        
+        self.path = path;
+        self.fileManager = fileManager;
+        _nextIdentifier = 1;
+        self.unfinishedDescriptions = [NSMutableArray array];
+    }
+    return self;
+}
+
+- (id)init
+{
+    HLSForbiddenInheritedMethod();
+    return nil;
+}
+
+- (void)dealloc
+{
+    self.path = nil;
+    self.fileManager = nil;
+    self.unfinishedDescriptions = nil;
+    [super dealloc];
+}
+
+#pragma mark Accessors and mutators
+
+@synthesize path = _path;
+
+@synthesize fileManager = _fileManager;
+
+@synthesize unfinishedDescriptions = _unfinishedDescriptions;
+
+#pragma mark Opening
+
+- (BOOL)open:(NSError **)pError
+{
+    [self.unfinishedDescriptions removeAllObjects];
+    
+    // Read all records. Descriptions are collected in submission order
+    NSMutableArray *descriptions = [NSMutableArray array];
+    NSMutableSet *endedIdentifiers = [NSMutableSet set];
+    if ([self.fileManager fileExistsAtPath:self.path]) {
+        NSData *data = [self.fileManager contentsOfFileAtPath:self.path error:pError];
+        if (! data) {
+            return NO;
+        }
+        
+        const uint8_t *bytes = [data bytes];
+        NSUInteger length = [data length];
+        if (length < sizeof(kTaskJournalMagic) + sizeof(kTaskJournalVersion)
+                || memcmp(bytes, kTaskJournalMagic, sizeof(kTaskJournalMagic)) != 0
+                || bytes[sizeof(kTaskJournalMagic)] != kTaskJournalVersion) {
+            HLSLoggerError(@"The journal at %@ is invalid", self.path);
+            if (pError) {
+                *pError = [NSError errorWithDomain:NSCocoaErrorDomain 
+                                              code:NSFileReadCorruptFileError 
+                                          userInfo:[NSDictionary dictionaryWithObject:self.path forKey:NSFilePathErrorKey]];
+            }
+            return NO;
+        }
+        
+        NSUInteger offset = sizeof(kTaskJournalMagic) + sizeof(kTaskJournalVersion);
+        while (offset + kTaskJournalRecordHeaderSize <= length) {
+            HLSTaskJournalRecordType type = bytes[offset];
+            uint32_t payloadLength = 0;
+            memcpy(&payloadLength, bytes + offset + sizeof(uint8_t), sizeof(uint32_t));
+            payloadLength = CFSwapInt32LittleToHost(payloadLength);
+            if (payloadLength < sizeof(uint64_t) || offset + kTaskJournalRecordHeaderSize + payloadLength > length) {
+                break;
+            }
+            
+            const uint8_t *payload = bytes + offset + kTaskJournalRecordHeaderSize;
+            offset += kTaskJournalRecordHeaderSize + payloadLength;
+            
+            uint64_t identifier = 0;
+            memcpy(&identifier, payload, sizeof(uint64_t));
+            identifier = CFSwapInt64LittleToHost(identifier);
+            _nextIdentifier = MAX(_nextIdentifier, identifier + 1);
+            
+            if (type == HLSTaskJournalRecordTypeEnd) {
+                [endedIdentifiers addObject:[NSNumber numberWithUnsignedLongLong:identifier]];
+                continue;
+            }
+            
+            NSData *archive = [NSData dataWithBytesNoCopy:(void *)(payload + sizeof(uint64_t))
+                                                   length:payloadLength - sizeof(uint64_t) 
+                                             freeWhenDone:NO];
+            NSDictionary *description = nil;
+            @try {
+                description = [NSKeyedUnarchiver unarchiveObjectWithData:archive];
+            }
+            @catch (NSException *exception) {
+                HLSLoggerWarn(@"Could not read a journal record (%@). Skipped", exception);
+                continue;
+            }
+            if (! [description isKindOfClass:[NSDictionary class]]) {
+                HLSLoggerWarn(@"Invalid journal record. Skipped");
+                continue;
+            }
+            
+            if (type == HLSTaskJournalRecordTypeTaskGroup) {
+                for (NSDictionary *taskDescription in [description objectForKey:kTaskJournalTasksKey]) {
+                    uint64_t taskIdentifier = [[taskDescription objectForKey:kTaskJournalIdentifierKey] unsignedLongLongValue];
+                    _nextIdentifier = MAX(_nextIdentifier, taskIdentifier + 1);
+                }
+            }
+            [descriptions addObject:description];
+        }
+        
+        if (offset != length) {
+            HLSLoggerWarn(@"The journal at %@ ends with an incomplete record. Ignored", self.path);
+        }
+    }
+    
+    // Keep unfinished work only
+    NSMutableData *compactedData = [NSMutableData dataWithData:[self headerData]];
+    for (NSDictionary *description in descriptions) {
+        NSDictionary *unfinishedDescription = nil;
+        HLSTaskJournalRecordType type = HLSTaskJournalRecordTypeTask;
+        if ([[description objectForKey:kTaskJournalTaskGroupFlagKey] boolValue]) {
+            NSMutableArray *unfinishedTaskDescriptions = [NSMutableArray array];
+            NSMutableSet *unfinishedIdentifiers = [NSMutableSet set];
+            for (NSDictionary *taskDescription in [description objectForKey:kTaskJournalTasksKey]) {
+                NSNumber *taskIdentifier = [taskDescription objectForKey:kTaskJournalIdentifierKey];
+                if (! [endedIdentifiers containsObject:taskIdentifier]) {
+                    [unfinishedTaskDescriptions addObject:taskDescription];
+                    [unfinishedIdentifiers addObject:taskIdentifier];
+                }
+            }
+            if ([unfinishedTaskDescriptions count] == 0) {
+                continue;
+            }
+            
+            // Only keep dependencies between unfinished tasks
+            NSMutableArray *unfinishedDependencies = [NSMutableArray array];
+            for (NSDictionary *dependency in [description objectForKey:kTaskJournalDependenciesKey]) {
+                if ([unfinishedIdentifiers containsObject:[dependency objectForKey:kTaskJournalDependencyTaskKey]]
+                        && [unfinishedIdentifiers containsObject:[dependency objectForKey:kTaskJournalDependencyOnTaskKey]]) {
+                    [unfinishedDependencies addObject:dependency];
+                }
+            }
+            
+            NSMutableDictionary *taskGroupDescription = [NSMutableDictionary dictionaryWithDictionary:description];
+            [taskGroupDescription setObject:unfinishedTaskDescriptions forKey:kTaskJournalTasksKey];
+            [taskGroupDescription setObject:unfinishedDependencies forKey:kTaskJournalDependenciesKey];
+            unfinishedDescription = taskGroupDescription;
+            type = HLSTaskJournalRecordTypeTaskGroup;
+        }
+        else {
+            if ([endedIdentifiers containsObject:[description objectForKey:kTaskJournalIdentifierKey]]) {
+                continue;
+            }
+            unfinishedDescription = description;
+        }
+        
+        uint64_t identifier = [[unfinishedDescription objectForKey:kTaskJournalIdentifierKey] unsignedLongLongValue];
+        [compactedData appendData:[self recordWithType:type identifier:identifier description:unfinishedDescription]];
+        [self.unfinishedDescriptions addObject:unfinishedDescription];
+    }
+    
+    return [self.fileManager createFileAtPath:self.path contents:compactedData error:pError];
+}
+
+#pragma mark Restoring unfinished work
+
+- (NSArray *)restoreUnfinishedObjects
+{
+    NSMutableArray *objects = [NSMutableArray array];
+    for (NSDictionary *description in self.unfinishedDescriptions) {
+        id object = nil;
+        if ([[description objectForKey:kTaskJournalTaskGroupFlagKey] boolValue]) {
+            object = [self taskGroupFromDescription:description];
+        }
+        else {
+            object = [self taskFromDescription:description];
+        }
+        
+        if (object) {
+            [objects addObject:object];
+        }
+    }
+    [self.unfinishedDescriptions removeAllObjects];
+    return [NSArray arrayWithArray:objects];
+}
+
+- (HLSTask *)taskFromDescription:(NSDictionary *)description
+{
+    uint64_t identifier = [[description objectForKey:kTaskJournalIdentifierKey] unsignedLongLongValue];
+    
+    NSString *className = [description objectForKey:kTaskJournalClassNameKey];
+    Class taskClass = NSClassFromString(className);
+    if (! [taskClass isSubclassOfClass:[HLSTask class]]) {
+        HLSLoggerError(@"The task class %@ does not exist anymore. The task is dropped", className);
+        
+        // Never try again
+        [self appendRecord:[self recordWithType:HLSTaskJournalRecordTypeEnd identifier:identifier description:nil]];
+        return nil;
+    }
+    
+    HLSTask *task = [[[taskClass alloc] init] autorelease];
+    task.tag = [description objectForKey:kTaskJournalTagKey];
+    task.userInfo = [description objectForKey:kTaskJournalUserInfoKey];
+    task.executionClass = [[description objectForKey:kTaskJournalExecutionClassKey] intValue];
+    task.priority = [[description objectForKey:kTaskJournalPriorityKey] intValue];
+    task.journaled = YES;
+    task.journalIdentifier = identifier;
+    return task;
+}
+
+- (HLSTaskGroup *)taskGroupFromDescription:(NSDictionary *)description
+{
+    HLSTaskGroup *taskGroup = [[[HLSTaskGroup alloc] init] autorelease];
+    taskGroup.tag = [description objectForKey:kTaskJournalTagKey];
+    taskGroup.userInfo = [description objectForKey:kTaskJournalUserInfoKey];
+    taskGroup.journaled = YES;
+    
+    NSMutableDictionary *identifierToTaskMap = [NSMutableDictionary dictionary];
+    for (NSDictionary *taskDescription in [description objectForKey:kTaskJournalTasksKey]) {
+        HLSTask *task = [self taskFromDescription:taskDescription];
+        if (! task) {
+            continue;
+        }
+        [taskGroup addTask:task];
+        [identifierToTaskMap setObject:task forKey:[taskDescription objectForKey:kTaskJournalIdentifierKey]];
+    }
+    
+    if ([identifierToTaskMap count] == 0) {
+        return nil;
+    }
+    
+    for (NSDictionary *dependency in [description objectForKey:kTaskJournalDependenciesKey]) {
+        HLSTask *task = [identifierToTaskMap objectForKey:[dependency objectForKey:kTaskJournalDependencyTaskKey]];
+        HLSTask *onTask = [identifierToTaskMap objectForKey:[dependency objectForKey:kTaskJournalDependencyOnTaskKey]];
+        if (! task || ! onTask) {
+            continue;
+        }
+        [taskGroup addDependencyForTask:task 
+                                 onTask:onTask 
+                                 strong:[[dependency objectForKey:kTaskJournalDependencyStrongKey] boolValue]];
+    }
+    
+    return taskGroup;
+}
+
+#pragma mark Recording
+
+- (void)recordSubmissionForTask:(HLSTask *)task
+{
+    // Restored tasks are already recorded
+    if (task.journalIdentifier != 0) {
+        return;
+    }
+    
+    task.journalIdentifier = _nextIdentifier++;
+    NSDictionary *description = [self descriptionForTask:task];
+    [self appendRecord:[self recordWithType:HLSTaskJournalRecordTypeTask identifier:task.journalIdentifier description:description]];
+}
+
+- (void)recordSubmissionForTaskGroup:(HLSTaskGroup *)taskGroup
+{
+    // Restored task groups are already recorded (either all tasks are, or none)
+    NSSet *tasks = [taskGroup tasks];
+    if ([[tasks anyObject] journalIdentifier] != 0) {
+        return;
+    }
+    
+    uint64_t identifier = _nextIdentifier++;
+    NSMutableArray *taskDescriptions = [NSMutableArray array];
+    for (HLSTask *task in tasks) {
+        task.journalIdentifier = _nextIdentifier++;
+        [taskDescriptions addObject:[self descriptionForTask:task]];
+    }
+    
+    NSMutableArray *dependencies = [NSMutableArray array];
+    for (HLSTask *task in tasks) {
+        NSNumber *taskIdentifier = [NSNumber numberWithUnsignedLongLong:task.journalIdentifier];
+        for (HLSTask *onTask in [taskGroup dependenciesForTask:task]) {
+            BOOL strong = [[taskGroup strongDependenciesForTask:task] containsObject:onTask];
+            NSDictionary *dependency = [NSDictionary dictionaryWithObjectsAndKeys:taskIdentifier, kTaskJournalDependencyTaskKey,
+                                        [NSNumber numberWithUnsignedLongLong:onTask.journalIdentifier], kTaskJournalDependencyOnTaskKey,
+                                        [NSNumber numberWithBool:strong], kTaskJournalDependencyStrongKey, nil];
+            [dependencies addObject:dependency];
+        }
+    }
+    
+    NSMutableDictionary *description = [NSMutableDictionary dictionary];
+    [description setObject:[NSNumber numberWithUnsignedLongLong:identifier] forKey:kTaskJournalIdentifierKey];
+    [description setObject:[NSNumber numberWithBool:YES] forKey:kTaskJournalTaskGroupFlagKey];
+    if (taskGroup.tag) {
+        [description setObject:taskGroup.tag forKey:kTaskJournalTagKey];
+    }
+    if (taskGroup.userInfo) {
+        [description setObject:taskGroup.userInfo forKey:kTaskJournalUserInfoKey];
+    }
+    [description setObject:taskDescriptions forKey:kTaskJournalTasksKey];
+    [description setObject:dependencies forKey:kTaskJournalDependenciesKey];
+    [self appendRecord:[self recordWithType:HLSTaskJournalRecordTypeTaskGroup identifier:identifier description:description]];
+}
+
+- (void)recordEndForTask:(HLSTask *)task
+{
+    if (task.journalIdentifier == 0) {
+        return;
+    }
+    
+    [self appendRecord:[self recordWithType:HLSTaskJournalRecordTypeEnd identifier:task.journalIdentifier description:nil]];
+    task.journalIdentifier = 0;
+}
+
+- (NSDictionary *)descriptionForTask:(HLSTask *)task
+{
+    NSMutableDictionary *description = [NSMutableDictionary dictionary];
+    [description setObject:[NSNumber numberWithUnsignedLongLong:task.journalIdentifier] forKey:kTaskJournalIdentifierKey];
+    [description setObject:NSStringFromClass([task class]) forKey:kTaskJournalClassNameKey];
+    if (task.tag) {
+        [description setObject:task.tag forKey:kTaskJournalTagKey];
+    }
+    if (task.userInfo) {
+        [description setObject:task.userInfo forKey:kTaskJournalUserInfoKey];
+    }
+    [description setObject:[NSNumber numberWithInt:task.executionClass] forKey:kTaskJournalExecutionClassKey];
+    [description setObject:[NSNumber numberWithInt:task.priority] forKey:kTaskJournalPriorityKey];
+    return description;
+}
+
+#pragma mark Reading and writing records
+
+- (NSData *)headerData
+{
+    NSMutableData *headerData = [NSMutableData dataWithBytes:kTaskJournalMagic length:sizeof(kTaskJournalMagic)];
+    [headerData appendBytes:&kTaskJournalVersion length:sizeof(kTaskJournalVersion)];
+    return headerData;
+}
+
+/**
+ * Create the binary representation of a record. The description can be nil for end records
+ */
+- (NSData *)recordWithType:(HLSTaskJournalRecordType)type identifier:(uint64_t)identifier description:(NSDictionary *)description
+{
+    NSData *archive = nil;
+    if (description) {
+        // Raises if an object does not conform to NSCoding
+        @try {
+            archive = [NSKeyedArchiver archivedDataWithRootObject:description];
+        }
+        @catch (NSException *exception) {
+            HLSLoggerError(@"Could not journal %@ (%@). All objects must conform to NSCoding", description, exception);
+            return nil;
+        }
+    }
+    
+    uint8_t recordType = type;
+    uint32_t payloadLength = CFSwapInt32HostToLittle(sizeof(uint64_t) + [archive length]);
+    uint64_t littleEndianIdentifier = CFSwapInt64HostToLittle(identifier);
+    
+    NSMutableData *record = [NSMutableData dataWithCapacity:kTaskJournalRecordHeaderSize + sizeof(uint64_t) + [archive length]];
+    [record appendBytes:&recordType length:sizeof(uint8_t)];
+    [record appendBytes:&payloadLength length:sizeof(uint32_t)];
+    [record appendBytes:&littleEndianIdentifier length:sizeof(uint64_t)];
+    if (archive) {
+        [record appendData:archive];
+    }
+    return record;
+}
+
+- (void)appendRecord:(NSData *)record
+{
+    if (! record) {
+        return;
+    }
+    
+    NSError *error = nil;
+    if (! [self.fileManager appendContents:record toFileAtPath:self.path error:&error]) {
+        HLSLoggerError(@"Could not write to the journal at %@. Reason: %@", self.path, error);
+    }
+}
+
+@end
@@ -19,6 +19,36 @@
  */
 - (void)unregisterOperation:(HLSTaskOperation *)operation;
 
+/**
+ * Called by an operation when the task it processes starts, so that the manager can collect metrics
+ */
+- (void)recordStartForTask:(HLSTask *)task;
+
+/**
+ * Called when the deadline of a task has passed. The task is cancelled, and a timeout error is attached to it
+ */
+- (void)timeOutTask:(HLSTask *)task;
+
+/**
+ * Called by an operation when the task it processes starts, before the task delegate is notified. The task groups
+ * containing the task which were not running yet start, enclosing task groups first
+ */
+- (void)startTaskGroupsOfTask:(HLSTask *)task;
+
+/**
+ * Called by an operation when the status of the task it processes has changed. The status of the task groups 
+ * containing the task is updated (innermost task group first), and their delegates are notified about their progress,
+ * as well as about their end if the task was the last one they were waiting for
+ */
+- (void)updateTaskGroupsOfTask:(HLSTask *)task;
+
+/**
+ * Called by an operation when the task it processes has failed or has been cancelled. Cancel all members strongly
+ * depending on the task, as well as all members strongly depending on the task groups containing it (which have
+ * failed as well)
+ */
+- (void)cancelStrongDependentsOfTask:(HLSTask *)task;
+
 /**
  * Retrieving registered delegates
  */
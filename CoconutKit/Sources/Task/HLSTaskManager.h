@@ -8,7 +8,33 @@
 
 #import "HLSTask.h"
 #import "HLSTaskGroup.h"
-                
+#import "HLSTaskMetrics.h"
+#import "HLSTaskThrottlingPolicy.h"
+
+// Forward declarations
+@class HLSTaskJournal;
+
+/**
+ * Define how status notifications (start, progress, return information, error, end) are forwarded from the worker
+ * threads processing tasks to the thread which submitted them:
+ *   - HLSTaskNotificationModeSynchronous: A worker thread is blocked until each notification has been processed by
+ *     the submitting thread run loop. Simple, but worker threads stall if the submitting thread (usually the main
+ *     thread) is busy
+ *   - HLSTaskNotificationModeAsynchronous: Notifications are enqueued in a per-operation FIFO and delivered in order
+ *     by the submitting thread run loop, without blocking the worker thread. Only the end notification still waits
+ *     until it has been processed, so that task dependencies and cancellation behave exactly as in synchronous mode
+ *
+ * In both modes notifications are received in the order they were emitted. In particular, the end notification can
+ * never overtake a progress update
+ */
+typedef enum {
+    HLSTaskNotificationModeEnumBegin = 0,
+    HLSTaskNotificationModeSynchronous = HLSTaskNotificationModeEnumBegin,          // Default
+    HLSTaskNotificationModeAsynchronous,
+    HLSTaskNotificationModeEnumEnd,
+    HLSTaskNotificationModeEnumSize = HLSTaskNotificationModeEnumEnd - HLSTaskNotificationModeEnumBegin
+} HLSTaskNotificationMode;
+
 /**
  * Concrete class responsible for instantiating, processing and managing HLSTaskOperation objects spawned for each
  * task submitted to it. Each such object represents a work unit processed by a dedicated thread.
@@ -24,6 +50,13 @@
  * or -unregisterDelegate in the dealloc method of your delegates. This will unregister the delegate, ensuring that
  * it cannot be notified anymore when it gets destroyed.
  *
+ * Tasks are processed by separate pools of threads depending on their execution class (see HLSTask executionClass
+ * property). Each pool has its own concurrency limit, by default:
+ *   - HLSTaskExecutionClassDefault: 4 tasks
+ *   - HLSTaskExecutionClassCPU: As many tasks as there are active processors (at least 2)
+ *   - HLSTaskExecutionClassIO: 8 tasks
+ * Dependencies between tasks of a task group are honored across pools.
+ *
  * This object is not thread-safe. All operations on it must stem from the same thread, otherwise the behavior is 
  * undefined.
  *
@@ -31,14 +64,34 @@
  */
 @interface HLSTaskManager : NSObject {
 @private
-    NSOperationQueue *_operationQueue;                   // Manages the separate threads used for task processing
+    NSOperationQueue *_operationQueue;                   // Manages the separate threads used for HLSTaskExecutionClassDefault task processing
+    NSOperationQueue *_cpuOperationQueue;                // Same for HLSTaskExecutionClassCPU tasks
+    NSOperationQueue *_ioOperationQueue;                 // Same for HLSTaskExecutionClassIO tasks
+    NSInteger _maxConcurrentTaskCounts[HLSTaskExecutionClassEnumSize];  // Counts set by the user, before throttling
+    HLSTaskThrottlingPolicy *_throttlingPolicy;
+    NSOperation *_deferredTasksGate;                     // Deferred operations depend on it, nil if tasks are not deferred
     NSMutableSet *_tasks;                                // Keep a strong ref to task groups so that they stay alive
     NSMutableSet *_taskGroups;                           // Keep a strong ref to task groups so that they stay alive
-    NSMutableDictionary *_taskToOperationMap;            // Maps a task to the associated HLSTaskOperation object
-    NSMutableDictionary *_taskToDelegateMap;             // Maps a task to the associated id<HLSTaskDelegate> object
     NSMutableDictionary *_delegateToTasksMap;            // Maps some object id to the NSMutableSet of all HLSTask objects it is the delegate of
     NSMutableDictionary *_taskGroupToDelegateMap;        // Maps a task group to the associated id<HLSTaskGroupDelegate> object
     NSMutableDictionary *_delegateToTaskGroupsMap;       // Maps some object id to the NSMutableSet of all HLSTaskGroup objects it is the delegate of
+    NSMutableDictionary *_tagToTasksMap;                 // Maps a tag to the NSMutableSet of all running or pending HLSTask objects bearing it
+    NSMutableDictionary *_tagToTaskGroupsMap;            // Maps a tag to the NSMutableSet of all running or pending HLSTaskGroup objects bearing it
+    HLSTaskNotificationMode _notificationMode;
+    dispatch_queue_t _delegateQueue;
+    NSUInteger _maxProgressUpdateRate;
+    NSUInteger _maxPendingPartialResultCount;
+    BOOL _usingSharedThreadPool;
+    id _threadPoolClientToken;                           // Identifies the manager as client of the shared thread pools
+    BOOL _metricsEnabled;
+    HLSTaskMetrics *_metrics;                            // Metrics for all tasks ...
+    NSMutableDictionary *_tagToMetricsMap;               // ... and metrics for tasks bearing a given tag (maps a tag to an HLSTaskMetrics object)
+    NSUInteger _runningTaskCounts[HLSTaskExecutionClassEnumSize];
+    HLSTaskJournal *_journal;
+    BOOL _resultCacheEnabled;
+    NSCache *_resultCache;                               // Maps a task result cache key to its returnInfo
+    NSMutableDictionary *_resultCacheKeyToTaskMap;       // Maps a result cache key to the running or pending HLSTask computing the result ...
+    NSMutableDictionary *_resultCacheKeyToDuplicateTasksMap;     // ... and to the NSMutableSet of HLSTask objects waiting for it
 }
 
 /**
@@ -49,11 +102,93 @@
 + (HLSTaskManager *)defaultManager;
 
 /**
- * Change the number of tasks processed simultaneously. Default is 4. This setting does not affect already running
- * operations
+ * Change the number of HLSTaskExecutionClassDefault tasks processed simultaneously. Default is 4. This setting does
+ * not affect already running operations
  */
 - (void)setMaxConcurrentTaskCount:(NSInteger)count;
 
+/**
+ * Change the number of tasks of a given execution class processed simultaneously. This setting does not affect already
+ * running operations. A throttling policy might temporarily reduce this number (see throttlingPolicy)
+ */
+- (void)setMaxConcurrentTaskCount:(NSInteger)count forExecutionClass:(HLSTaskExecutionClass)executionClass;
+
+/**
+ * The policy used to adjust the number of tasks processed simultaneously, and to defer deferrable tasks (see 
+ * -[HLSTask deferrable]), depending on the application and battery states. If nil (the default), the numbers of
+ * tasks set using -setMaxConcurrentTaskCount:forExecutionClass: are always used, and tasks are never deferred.
+ *
+ * Setting a policy enables battery monitoring on the current device. Running tasks are never interrupted, but
+ * deferrable tasks which have not been started yet are deferred as soon as the policy says so. Policies are evaluated
+ * on the main thread when the application or the battery state changes (on the delegate queue if one has been set, 
+ * see delegateQueue). If the task manager is used from another thread, call -updateThrottling from this thread instead
+ */
+@property (nonatomic, retain) HLSTaskThrottlingPolicy *throttlingPolicy;
+
+/**
+ * Evaluate the throttling policy again, applying the resulting numbers of concurrent tasks and deferring or resuming
+ * deferrable tasks
+ */
+- (void)updateThrottling;
+
+/**
+ * Return YES iff deferrable tasks are currently deferred
+ */
+@property (nonatomic, readonly, assign, getter=isDeferringTasks) BOOL deferringTasks;
+
+/**
+ * By default, each task manager has its own pools of threads. Several task managers processing tasks at the same time
+ * therefore use more threads than there are processors, and the time spent switching between them increases.
+ *
+ * When set to YES, tasks are processed by pools of threads shared by all task managers using them (one pool per 
+ * execution class, sized according to the number of processors, see +setSharedThreadPoolSize:forExecutionClass:).
+ * The number of tasks set using -setMaxConcurrentTaskCount:forExecutionClass: is then the maximum number of shared
+ * threads the manager can use at the same time. Threads becoming available are assigned to the managers in turn, 
+ * so that no manager can starve the others. Task priorities and dependencies are honored as usual.
+ *
+ * Default value is NO. This setting only affects tasks submitted after it has been changed
+ */
+@property (nonatomic, assign, getter=isUsingSharedThreadPool) BOOL usingSharedThreadPool;
+
+/**
+ * Change the number of threads of the pool shared by task managers for tasks of a given execution class (see
+ * usingSharedThreadPool). Defaults are as many threads as there are active processors (at least 2) for
+ * HLSTaskExecutionClassDefault and HLSTaskExecutionClassCPU tasks, and 8 threads for HLSTaskExecutionClassIO
+ * tasks. This setting does not affect already running operations
+ */
++ (void)setSharedThreadPoolSize:(NSUInteger)size forExecutionClass:(HLSTaskExecutionClass)executionClass;
+
+/**
+ * The way task status notifications are delivered to the thread which submitted the tasks (see HLSTaskNotificationMode).
+ * Default is HLSTaskNotificationModeSynchronous. This setting only affects tasks submitted after it has been changed
+ */
+@property (nonatomic, assign) HLSTaskNotificationMode notificationMode;
+
+/**
+ * The serial dispatch queue onto which task status notifications are delivered, and on which the task manager performs
+ * its bookkeeping. If NULL (the default), notifications are delivered to the thread which submitted the tasks, which 
+ * must therefore run a run loop. When a queue is set, the task manager must only be used from this queue (submitting 
+ * and cancelling tasks, registering delegates, etc.), which lets threads without a run loop (e.g. GCD workers) use a
+ * task manager. Tasks and task groups can further deliver notifications to their own delegate on another queue (see
+ * -[HLSTask delegateQueue]). The queue is retained. This setting only affects tasks submitted after it has been changed
+ */
+@property (nonatomic, assign) dispatch_queue_t delegateQueue;
+
+/**
+ * Maximum number of progress updates per second delivered to task and task group delegates (e.g. 30). Intermediate
+ * progress values reported in between are merged, so that only the latest one is delivered. Completion is always
+ * delivered. Set to 0 (the default) for no limit. This setting only affects tasks submitted after it has been changed
+ */
+@property (nonatomic, assign) NSUInteger maxProgressUpdateRate;
+
+/**
+ * Maximum number of partial results (see -[HLSTaskOperation emitPartialResult:]) an operation can emit before they
+ * have been delivered to the task delegate. When this limit is reached, the operation is blocked until some results
+ * have been delivered (back-pressure), which bounds the memory used by results waiting for delivery. Default value
+ * is 16. This setting only affects tasks submitted after it has been changed
+ */
+@property (nonatomic, assign) NSUInteger maxPendingPartialResultCount;
+
 /**
  * Submit a single task; if you have several tasks to process, consider bundling them as a task group, and use
  * submitTaskGroup: instead
@@ -65,6 +200,50 @@
  */
 - (void)submitTaskGroup:(HLSTaskGroup *)taskGroup;
 
+/**
+ * Open a journal at the given location (relative to the storage of the default HLSFileManager), creating it if it
+ * does not exist. Journaled tasks and task groups (see -[HLSTask journaled] and -[HLSTaskGroup journaled]) submitted 
+ * afterwards are recorded in it, as well as their end. If the application is terminated while they are pending or 
+ * running, they can be resumed the next time the journal is opened by calling -resumeJournaledTasks.
+ *
+ * Return YES iff the journal could be opened
+ */
+- (BOOL)openJournalAtPath:(NSString *)path error:(NSError **)pError;
+
+/**
+ * Submit again the journaled tasks and task groups which had not ended when the journal was last used. The 
+ * resubmitted HLSTask and HLSTaskGroup objects are returned, so that you can register delegates for them (delegates
+ * are not journaled). Tasks are only resumed once, subsequent calls return an empty array
+ */
+- (NSArray *)resumeJournaledTasks;
+
+/**
+ * Enable or disable the result cache. When enabled, the returnInfo of tasks which complete successfully is cached
+ * using their result cache key (see -[HLSTask resultCacheKey]). When a task with the same key is submitted afterwards,
+ * it is not processed but completed with the cached returnInfo on the next run loop iteration (its delegate still 
+ * receives the usual start, progress and end notifications, even if registered after the task was submitted). If an identical task is running or pending at that time, the new task 
+ * waits for its result instead of being processed as well (its timeoutInterval is not applied while it waits). Only 
+ * tasks submitted using -submitTask: are cached. The cache is emptied when the application receives a memory warning.
+ * Disabled by default
+ */
+@property (nonatomic, assign, getter=isResultCacheEnabled) BOOL resultCacheEnabled;
+
+/**
+ * Maximum number of results kept in the result cache. Default is 100. Set to 0 for no limit
+ */
+@property (nonatomic, assign) NSUInteger resultCacheCountLimit;
+
+/**
+ * Maximum total cost of the results kept in the result cache (see -[HLSTask resultCacheCostForReturnInfo:]). Default
+ * is 0 (no limit)
+ */
+@property (nonatomic, assign) NSUInteger resultCacheTotalCostLimit;
+
+/**
+ * Remove all results from the result cache
+ */
+- (void)clearResultCache;
+
 /**
  * Cancel a single task
  */
@@ -98,17 +277,43 @@
 - (void)cancelTasksWithDelegate:(id)delegate;
 
 /**
- * Return an NSArray of running or pending HLSTask objects bearing the specified tag (already completed tasks are not
- * returned). If no match is found, this method returns an empty array
+ * Return an NSArray of running or pending HLSTask objects whose tag matches the specified regular expression (already
+ * completed tasks are not returned). If no match is found, this method returns an empty array. Tags containing no 
+ * regular expression special character are looked up in constant time
  */
 - (NSArray *)tasksWithTag:(NSString *)tag;
 
 /**
- * Return an NSArray of running or pending HLSTaskGroup objects bearing the specified tag (already completed tasks are not
- * returned). If no match is found, this method returns an empty array
+ * Return an NSArray of running or pending HLSTaskGroup objects whose tag matches the specified regular expression 
+ * (already completed tasks are not returned). If no match is found, this method returns an empty array. Tags containing 
+ * no regular expression special character are looked up in constant time
  */
 - (NSArray *)taskGroupsWithTag:(NSString *)tag;
 
+/**
+ * Enable or disable the collection of metrics about waiting and running times of the tasks processed by the manager
+ * (see HLSTaskMetrics). Metrics are collected for tasks submitted while collection is enabled. Disabled by default
+ */
+@property (nonatomic, assign, getter=isMetricsEnabled) BOOL metricsEnabled;
+
+/**
+ * Return a snapshot of the metrics collected for all tasks
+ */
+- (HLSTaskMetrics *)metrics;
+
+/**
+ * Return a snapshot of the metrics collected per tag, as a dictionary mapping tags to HLSTaskMetrics objects. Untagged 
+ * tasks only contribute to the global metrics (see -metrics). Metrics are kept for each tag which has ever been used,
+ * avoid enabling metrics collection if your tags are not drawn from a small set of values
+ */
+- (NSDictionary *)metricsByTag;
+
+/**
+ * Return the fraction of the threads available for a given execution class which are currently processing tasks 
+ * (between 0.f and 1.f). Only tasks tracked by metrics collection are taken into account
+ */
+- (float)concurrencyUtilizationForExecutionClass:(HLSTaskExecutionClass)executionClass;
+
 /**
  * Register delegates for tasks. Only one delegate can be registered. If another delegate registers itself,
  * any existing registration is removed first 
@@ -8,33 +8,97 @@
 
 #import "HLSTaskManager.h"
 
+#import "HLSFileManager.h"
+#import "HLSFloat.h"
 #import "HLSLogger.h"
 #import "HLSTask+Friend.h"
+#import "HLSTaskDelegateProxy.h"
 #import "HLSTaskGroup+Friend.h"
+#import "HLSTaskJournal.h"
+#import "HLSTaskMetrics+Friend.h"
 #import "HLSTaskOperation.h"
+#import "HLSTaskThreadPool.h"
+
+// Context of a task deadline scheduled on the delegate queue
+typedef struct {
+    HLSTaskManager *taskManager;                // Retained
+    HLSTask *task;                              // Retained
+    HLSTaskOperation *operation;                // Retained
+} HLSTaskDeadlineContext;
+
+// Function declarations
+static void deadlinePassed(void *context);
+static void updateThrottling(void *context);
+static BOOL isLiteralPattern(NSString *pattern);
 
 @interface HLSTaskManager ()
 
 @property (nonatomic, retain) NSOperationQueue *operationQueue;
+@property (nonatomic, retain) NSOperationQueue *cpuOperationQueue;
+@property (nonatomic, retain) NSOperationQueue *ioOperationQueue;
+@property (nonatomic, retain) NSOperation *deferredTasksGate;
 @property (nonatomic, retain) NSMutableSet *tasks;
 @property (nonatomic, retain) NSMutableSet *taskGroups;
-@property (nonatomic, retain) NSMutableDictionary *taskToOperationMap;
-@property (nonatomic, retain) NSMutableDictionary *taskToDelegateMap;
 @property (nonatomic, retain) NSMutableDictionary *delegateToTasksMap;
 @property (nonatomic, retain) NSMutableDictionary *taskGroupToDelegateMap;
 @property (nonatomic, retain) NSMutableDictionary *delegateToTaskGroupsMap;
+@property (nonatomic, retain) NSMutableDictionary *tagToTasksMap;
+@property (nonatomic, retain) NSMutableDictionary *tagToTaskGroupsMap;
+@property (nonatomic, retain) HLSTaskMetrics *metrics;
+@property (nonatomic, retain) NSMutableDictionary *tagToMetricsMap;
+@property (nonatomic, retain) id threadPoolClientToken;
+@property (nonatomic, retain) HLSTaskJournal *journal;
+@property (nonatomic, retain) NSCache *resultCache;
+@property (nonatomic, retain) NSMutableDictionary *resultCacheKeyToTaskMap;
+@property (nonatomic, retain) NSMutableDictionary *resultCacheKeyToDuplicateTasksMap;
 
+- (NSOperationQueue *)operationQueueForExecutionClass:(HLSTaskExecutionClass)executionClass;
+- (void)applyMaxConcurrentTaskCountForExecutionClass:(HLSTaskExecutionClass)executionClass;
+- (void)deferTaskIfNeeded:(HLSTask *)task;
+- (void)scheduleOperationForTask:(HLSTask *)task;
+- (NSArray *)linkOperationsForTaskGroup:(HLSTaskGroup *)taskGroup;
+- (NSOperation *)operationForMember:(id)member taskGroupOperationMap:(NSDictionary *)taskGroupKeyToOperationMap;
+
+- (HLSTaskOperation *)operationForTask:(HLSTask *)task;
 - (NSSet *)operationsForTasks:(NSSet *)tasks;
+- (NSOperationQueuePriority)queuePriorityForTaskPriority:(HLSTaskPriority)priority;
 
 - (void)registerOperation:(HLSTaskOperation *)operation;
 - (void)unregisterOperation:(HLSTaskOperation *)operation;
 
+- (void)deadlineTimerFired:(NSTimer *)timer;
+- (void)timeOutTask:(HLSTask *)task;
+
+- (void)registerDuplicateTask:(HLSTask *)task forResultCacheKey:(id)resultCacheKey;
+- (void)unregisterDuplicateTask:(HLSTask *)task forResultCacheKey:(id)resultCacheKey;
+- (BOOL)isDuplicateTask:(HLSTask *)task;
+- (void)processResultOfTask:(HLSTask *)task;
+- (void)completeTask:(HLSTask *)task withReturnInfo:(NSDictionary *)returnInfo;
+- (void)completeTaskWithCachedResult:(NSArray *)taskAndReturnInfo;
+
 - (void)registerTaskGroup:(HLSTaskGroup *)taskGroup;
 - (void)unregisterTaskGroup:(HLSTaskGroup *)taskGroup;
+- (void)finishEmptyTaskGroup:(HLSTaskGroup *)taskGroup;
+
+- (void)startTaskGroupsOfTask:(HLSTask *)task;
+- (void)updateTaskGroupsOfTask:(HLSTask *)task;
+- (void)cancelStrongDependentsOfTask:(HLSTask *)task;
+
+- (void)addObject:(id)object toIndex:(NSMutableDictionary *)index forKey:(id)key;
+- (void)removeObject:(id)object fromIndex:(NSMutableDictionary *)index forKey:(id)key;
+- (NSArray *)objectsInIndex:(NSDictionary *)index matchingTag:(NSString *)tag;
+
+- (void)recordSubmissionForTask:(HLSTask *)task;
+- (void)recordStartForTask:(HLSTask *)task;
+- (void)recordEndForTask:(HLSTask *)task;
+- (NSArray *)metricsForTask:(HLSTask *)task;
 
 - (id<HLSTaskDelegate>)delegateForTask:(HLSTask *)task;
 - (id<HLSTaskGroupDelegate>)delegateForTaskGroup:(HLSTaskGroup *)taskGroup;
 
+- (void)applicationDidReceiveMemoryWarning:(NSNotification *)notification;
+- (void)throttlingConditionsDidChange:(NSNotification *)notification;
+
 @end
 
 @implementation HLSTaskManager
@@ -51,6 +115,11 @@
     return s_instance;
 }
 
++ (void)setSharedThreadPoolSize:(NSUInteger)size forExecutionClass:(HLSTaskExecutionClass)executionClass
+{
+    [[HLSTaskThreadPool sharedThreadPoolForExecutionClass:executionClass] setSize:size];
+}
+
 #pragma mark -
 #pragma mark Object creation and destruction
 
@@ -59,28 +128,72 @@
     if ((self = [super init])) {
         self.operationQueue = [[[NSOperationQueue alloc] init] autorelease];
         [self setMaxConcurrentTaskCount:4];
-        [self.operationQueue setMaxConcurrentOperationCount:4];
+        
+        self.cpuOperationQueue = [[[NSOperationQueue alloc] init] autorelease];
+        [self setMaxConcurrentTaskCount:MAX([[NSProcessInfo processInfo] activeProcessorCount], 2)
+                      forExecutionClass:HLSTaskExecutionClassCPU];
+        
+        self.ioOperationQueue = [[[NSOperationQueue alloc] init] autorelease];
+        [self setMaxConcurrentTaskCount:8 forExecutionClass:HLSTaskExecutionClassIO];
+        
         self.tasks = [NSMutableSet set];
         self.taskGroups = [NSMutableSet set];
-        self.taskToOperationMap = [NSMutableDictionary dictionary];
-        self.taskToDelegateMap = [NSMutableDictionary dictionary];
         self.delegateToTasksMap =[NSMutableDictionary dictionary];
         self.taskGroupToDelegateMap = [NSMutableDictionary dictionary];
         self.delegateToTaskGroupsMap = [NSMutableDictionary dictionary];
+        self.tagToTasksMap = [NSMutableDictionary dictionary];
+        self.tagToTaskGroupsMap = [NSMutableDictionary dictionary];
+        self.notificationMode = HLSTaskNotificationModeSynchronous;
+        self.maxProgressUpdateRate = 0;
+        self.maxPendingPartialResultCount = 16;
+        self.usingSharedThreadPool = NO;
+        self.threadPoolClientToken = [HLSTaskThreadPool clientToken];
+        self.metricsEnabled = NO;
+        self.metrics = [[[HLSTaskMetrics alloc] init] autorelease];
+        self.tagToMetricsMap = [NSMutableDictionary dictionary];
+        self.resultCacheEnabled = NO;
+        self.resultCache = [[[NSCache alloc] init] autorelease];
+        self.resultCacheCountLimit = 100;
+        self.resultCacheTotalCostLimit = 0;
+        self.resultCacheKeyToTaskMap = [NSMutableDictionary dictionary];
+        self.resultCacheKeyToDuplicateTasksMap = [NSMutableDictionary dictionary];
+        
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(applicationDidReceiveMemoryWarning:)
+                                                     name:UIApplicationDidReceiveMemoryWarningNotification
+                                                   object:nil];
     }
     return self;
 }
 
 - (void)dealloc
 {
+    [[NSNotificationCenter defaultCenter] removeObserver:self
+                                                    name:UIApplicationDidReceiveMemoryWarningNotification
+                                                  object:nil];
+    
+    // Resumes deferred tasks, if any
+    self.throttlingPolicy = nil;
+    
     self.operationQueue = nil;
+    self.cpuOperationQueue = nil;
+    self.ioOperationQueue = nil;
+    self.deferredTasksGate = nil;
     self.tasks = nil;
     self.taskGroups = nil;
-    self.taskToOperationMap = nil;
-    self.taskToDelegateMap = nil;
     self.delegateToTasksMap = nil;
     self.taskGroupToDelegateMap = nil;
     self.delegateToTaskGroupsMap = nil;
+    self.tagToTasksMap = nil;
+    self.tagToTaskGroupsMap = nil;
+    self.metrics = nil;
+    self.tagToMetricsMap = nil;
+    self.threadPoolClientToken = nil;
+    self.journal = nil;
+    self.resultCache = nil;
+    self.resultCacheKeyToTaskMap = nil;
+    self.resultCacheKeyToDuplicateTasksMap = nil;
+    self.delegateQueue = NULL;
     [super dealloc];
 }
 
@@ -89,13 +202,52 @@
 
 @synthesize operationQueue = _operationQueue;
 
-@synthesize tasks = _tasks;
+@synthesize cpuOperationQueue = _cpuOperationQueue;
 
-@synthesize taskGroups = _taskGroups;
+@synthesize ioOperationQueue = _ioOperationQueue;
 
-@synthesize taskToOperationMap = _taskToOperationMap;
+@synthesize throttlingPolicy = _throttlingPolicy;
 
-@synthesize taskToDelegateMap = _taskToDelegateMap;
+- (void)setThrottlingPolicy:(HLSTaskThrottlingPolicy *)throttlingPolicy
+{
+    if (_throttlingPolicy == throttlingPolicy) {
+        return;
+    }
+    
+    NSNotificationCenter *notificationCenter = [NSNotificationCenter defaultCenter];
+    if (_throttlingPolicy) {
+        [notificationCenter removeObserver:self name:UIApplicationDidEnterBackgroundNotification object:nil];
+        [notificationCenter removeObserver:self name:UIApplicationWillEnterForegroundNotification object:nil];
+        [notificationCenter removeObserver:self name:UIDeviceBatteryLevelDidChangeNotification object:nil];
+        [notificationCenter removeObserver:self name:UIDeviceBatteryStateDidChangeNotification object:nil];
+    }
+    
+    [_throttlingPolicy release];
+    _throttlingPolicy = [throttlingPolicy retain];
+    
+    if (_throttlingPolicy) {
+        [UIDevice currentDevice].batteryMonitoringEnabled = YES;
+        
+        SEL selector = @selector(throttlingConditionsDidChange:);
+        [notificationCenter addObserver:self selector:selector name:UIApplicationDidEnterBackgroundNotification object:nil];
+        [notificationCenter addObserver:self selector:selector name:UIApplicationWillEnterForegroundNotification object:nil];
+        [notificationCenter addObserver:self selector:selector name:UIDeviceBatteryLevelDidChangeNotification object:nil];
+        [notificationCenter addObserver:self selector:selector name:UIDeviceBatteryStateDidChangeNotification object:nil];
+    }
+    
+    [self updateThrottling];
+}
+
+@synthesize deferredTasksGate = _deferredTasksGate;
+
+- (BOOL)isDeferringTasks
+{
+    return self.deferredTasksGate != nil;
+}
+
+@synthesize tasks = _tasks;
+
+@synthesize taskGroups = _taskGroups;
 
 @synthesize delegateToTasksMap = _delegateToTasksMap;
 
@@ -103,8 +255,132 @@
 
 @synthesize delegateToTaskGroupsMap = _delegateToTaskGroupsMap;
 
+@synthesize tagToTasksMap = _tagToTasksMap;
+
+@synthesize tagToTaskGroupsMap = _tagToTaskGroupsMap;
+
+@synthesize notificationMode = _notificationMode;
+
+@synthesize delegateQueue = _delegateQueue;
+
+- (void)setDelegateQueue:(dispatch_queue_t)delegateQueue
+{
+    if (delegateQueue == _delegateQueue) {
+        return;
+    }
+    
+    if (_delegateQueue) {
+        dispatch_release(_delegateQueue);
+    }
+    _delegateQueue = delegateQueue;
+    if (_delegateQueue) {
+        dispatch_retain(_delegateQueue);
+    }
+}
+
+@synthesize maxProgressUpdateRate = _maxProgressUpdateRate;
+
+@synthesize maxPendingPartialResultCount = _maxPendingPartialResultCount;
+
+@synthesize usingSharedThreadPool = _usingSharedThreadPool;
+
+@synthesize metricsEnabled = _metricsEnabled;
+
+@synthesize metrics = _metrics;
+
+- (HLSTaskMetrics *)metrics
+{
+    return [[_metrics copy] autorelease];
+}
+
+@synthesize tagToMetricsMap = _tagToMetricsMap;
+
+@synthesize threadPoolClientToken = _threadPoolClientToken;
+
+@synthesize journal = _journal;
+
+@synthesize resultCacheEnabled = _resultCacheEnabled;
+
+- (void)setResultCacheEnabled:(BOOL)resultCacheEnabled
+{
+    _resultCacheEnabled = resultCacheEnabled;
+    if (! resultCacheEnabled) {
+        [self clearResultCache];
+    }
+}
+
+@synthesize resultCache = _resultCache;
+
+- (NSUInteger)resultCacheCountLimit
+{
+    return [self.resultCache countLimit];
+}
+
+- (void)setResultCacheCountLimit:(NSUInteger)resultCacheCountLimit
+{
+    [self.resultCache setCountLimit:resultCacheCountLimit];
+}
+
+- (NSUInteger)resultCacheTotalCostLimit
+{
+    return [self.resultCache totalCostLimit];
+}
+
+- (void)setResultCacheTotalCostLimit:(NSUInteger)resultCacheTotalCostLimit
+{
+    [self.resultCache setTotalCostLimit:resultCacheTotalCostLimit];
+}
+
+@synthesize resultCacheKeyToTaskMap = _resultCacheKeyToTaskMap;
+
+@synthesize resultCacheKeyToDuplicateTasksMap = _resultCacheKeyToDuplicateTasksMap;
+
+- (NSDictionary *)metricsByTag
+{
+    NSMutableDictionary *metricsByTag = [NSMutableDictionary dictionaryWithCapacity:[self.tagToMetricsMap count]];
+    for (NSString *tag in [self.tagToMetricsMap allKeys]) {
+        HLSTaskMetrics *metrics = [self.tagToMetricsMap objectForKey:tag];
+        [metricsByTag setObject:[[metrics copy] autorelease] forKey:tag];
+    }
+    return [NSDictionary dictionaryWithDictionary:metricsByTag];
+}
+
+- (float)concurrencyUtilizationForExecutionClass:(HLSTaskExecutionClass)executionClass
+{
+    if (executionClass >= HLSTaskExecutionClassEnumEnd) {
+        HLSLoggerError(@"Invalid execution class");
+        return 0.f;
+    }
+    
+    NSInteger maxConcurrentOperationCount = [[self operationQueueForExecutionClass:executionClass] maxConcurrentOperationCount];
+    if (maxConcurrentOperationCount <= 0) {
+        return 0.f;
+    }
+    return MIN((float)_runningTaskCounts[executionClass] / maxConcurrentOperationCount, 1.f);
+}
+
+- (void)setMaxPendingPartialResultCount:(NSUInteger)maxPendingPartialResultCount
+{
+    if (maxPendingPartialResultCount == 0) {
+        HLSLoggerError(@"The maximum number of pending partial results must be at least 1; value not changed");
+        return;
+    }
+    
+    _maxPendingPartialResultCount = maxPendingPartialResultCount;
+}
+
 - (void)setMaxConcurrentTaskCount:(NSInteger)count
 {
+    [self setMaxConcurrentTaskCount:count forExecutionClass:HLSTaskExecutionClassDefault];
+}
+
+- (void)setMaxConcurrentTaskCount:(NSInteger)count forExecutionClass:(HLSTaskExecutionClass)executionClass
+{
+    if (executionClass >= HLSTaskExecutionClassEnumEnd) {
+        HLSLoggerError(@"Invalid execution class");
+        return;
+    }
+    
     // Remark: It seems that with the recommended setting NSOperationQueueDefaultMaxConcurrentOperationCount (which
     //         lets the OS decide dynamically how many threads are needed), dependencies betweeen NSOperation objects
     //         are not applied anymore (bug?). Anyway, this does not work correctly, so we fix the number of threads
@@ -113,13 +389,81 @@
         HLSLoggerWarn(@"Dynamic number of concurrent tasks is currently not working correctly; task count not changed");
     }
     else if (count > 1) {
-        [self.operationQueue setMaxConcurrentOperationCount:count];
+        _maxConcurrentTaskCounts[executionClass] = count;
+        [self applyMaxConcurrentTaskCountForExecutionClass:executionClass];
     }
     else {
         HLSLoggerError(@"Invalid number of concurrent tasks; task count not changed");
     }
 }
 
+- (NSOperationQueue *)operationQueueForExecutionClass:(HLSTaskExecutionClass)executionClass
+{
+    switch (executionClass) {
+        case HLSTaskExecutionClassCPU: {
+            return self.cpuOperationQueue;
+        }
+            
+        case HLSTaskExecutionClassIO: {
+            return self.ioOperationQueue;
+        }
+            
+        case HLSTaskExecutionClassDefault:
+        default: {
+            return self.operationQueue;
+        }
+    }
+}
+
+- (void)applyMaxConcurrentTaskCountForExecutionClass:(HLSTaskExecutionClass)executionClass
+{
+    NSInteger count = _maxConcurrentTaskCounts[executionClass];
+    if (self.throttlingPolicy) {
+        float concurrencyFactor = [self.throttlingPolicy concurrencyFactorForExecutionClass:executionClass];
+        count = MAX((NSInteger)floorf(count * MIN(MAX(concurrencyFactor, 0.f), 1.f)), 1);
+    }
+    [[self operationQueueForExecutionClass:executionClass] setMaxConcurrentOperationCount:count];
+}
+
+#pragma mark -
+#pragma mark Throttling
+
+- (void)updateThrottling
+{
+    for (NSUInteger i = HLSTaskExecutionClassEnumBegin; i < HLSTaskExecutionClassEnumEnd; ++i) {
+        [self applyMaxConcurrentTaskCountForExecutionClass:(HLSTaskExecutionClass)i];
+    }
+    
+    // Deferred operations depend on a gate operation, which is only scheduled when tasks must not be deferred anymore
+    BOOL deferringTasks = self.throttlingPolicy && [self.throttlingPolicy shouldDeferTasks];
+    if (deferringTasks && ! self.deferredTasksGate) {
+        HLSLoggerInfo(@"Deferrable tasks are deferred");
+        self.deferredTasksGate = [[[NSOperation alloc] init] autorelease];
+        for (HLSTask *task in self.tasks) {
+            [self deferTaskIfNeeded:task];
+        }
+    }
+    else if (! deferringTasks && self.deferredTasksGate) {
+        HLSLoggerInfo(@"Deferrable tasks are resumed");
+        [self.operationQueue addOperation:self.deferredTasksGate];
+        self.deferredTasksGate = nil;
+    }
+}
+
+- (void)deferTaskIfNeeded:(HLSTask *)task
+{
+    if (! self.deferredTasksGate || ! task.deferrable) {
+        return;
+    }
+    
+    // Adding a dependency to an operation which has been started meanwhile has no effect
+    HLSTaskOperation *operation = task.operation;
+    if (! operation || [operation isExecuting] || [operation isFinished]) {
+        return;
+    }
+    [operation addDependency:self.deferredTasksGate];
+}
+
 #pragma mark -
 #pragma mark Submitting tasks
 
@@ -131,14 +475,41 @@
         return;
     }
     
-    // Get the corresponding operations
-    NSSet *operations = [self operationsForTasks:[NSSet setWithObject:task]];
+    // If the result of the task is cached, we are already done. If an identical task is running or pending, wait for
+    // its result
+    id resultCacheKey = (self.resultCacheEnabled && ! task.taskGroup) ? [task resultCacheKey] : nil;
+    if (resultCacheKey) {
+        NSDictionary *cachedReturnInfo = [self.resultCache objectForKey:resultCacheKey];
+        if (cachedReturnInfo) {
+            HLSLoggerDebug(@"The result of task %@ was found in the cache", task);
+            
+            // Notify on the next run loop iteration, so that delegates registered right after submission still
+            // receive all events. Until then, the task is registered so that it can be found and cancelled
+            [task reset];
+            [self.tasks addObject:task];
+            [self addObject:task toIndex:self.tagToTasksMap forKey:task.tag];
+            [self performSelector:@selector(completeTaskWithCachedResult:)
+                       withObject:[NSArray arrayWithObjects:task, cachedReturnInfo, nil]
+                       afterDelay:0.];
+            return;
+        }
+        
+        if ([self.resultCacheKeyToTaskMap objectForKey:resultCacheKey]) {
+            HLSLoggerDebug(@"Task %@ waits for the result of an identical task", task);
+            [self registerDuplicateTask:task forResultCacheKey:resultCacheKey];
+            return;
+        }
+        
+        [self.resultCacheKeyToTaskMap setObject:task forKey:resultCacheKey];
+    }
     
-    // Register and schedule all operations
-    for (HLSTaskOperation *operation in operations) {
-        [self registerOperation:operation];
-        [self.operationQueue addOperation:operation];
+    // Register and schedule the corresponding operation
+    HLSTaskOperation *operation = [self operationForTask:task];
+    [self registerOperation:operation];
+    if (task.journaled) {
+        [self.journal recordSubmissionForTask:task];
     }
+    [self scheduleOperationForTask:task];
 }
 
 - (void)submitTaskGroup:(HLSTaskGroup *)taskGroup
@@ -149,28 +520,24 @@
         return;
     }
     
+    // Contained task groups are submitted with the task group they belong to
+    if (taskGroup.parentTaskGroup) {
+        HLSLoggerError(@"Task group %@ belongs to another task group and cannot be submitted on its own", taskGroup);
+        return;
+    }
+    
     // Reset status
     [taskGroup reset];
     
-    // If no operation in the task group, we are already done; update the status accordingly and simulate events
-    if ([[taskGroup tasks] count] == 0) {
-        id<HLSTaskGroupDelegate> taskGroupDelegate = [self delegateForTaskGroup:taskGroup];
-        if (taskGroupDelegate) {
-            if ([taskGroupDelegate respondsToSelector:@selector(taskGroupHasStartedProcessing:)]) {
-                [taskGroupDelegate taskGroupHasStartedProcessing:taskGroup];
-            }
-            
-            if ([taskGroupDelegate respondsToSelector:@selector(taskGroupHasBeenProcessed:)]) {
-                [taskGroupDelegate taskGroupHasBeenProcessed:taskGroup];
-            }            
-        }
-        
-        taskGroup.finished = YES;
+    // If no operation in the task group, we are already done
+    NSSet *tasks = [taskGroup allTasks];
+    if ([tasks count] == 0) {
+        [self finishEmptyTaskGroup:taskGroup];
         return;
     }    
     
     // Get the corresponding operations
-    NSSet *operations = [self operationsForTasks:[taskGroup tasks]];
+    NSSet *operations = [self operationsForTasks:tasks];
     
     // Register all operations
     for (HLSTaskOperation *operation in operations) {
@@ -178,38 +545,150 @@
     }
     
     // Apply task group dependencies
-    for (HLSTask *task in [taskGroup tasks]) {
-        // Get dependencies if any
-        NSSet *dependencyTasks = [taskGroup dependenciesForTask:task];
-        if ([dependencyTasks count] == 0) {
+    NSArray *barrierOperations = [self linkOperationsForTaskGroup:taskGroup];
+    
+    // Register object relationships, for the contained task groups as well
+    for (HLSTaskGroup *containedTaskGroup in [taskGroup allTaskGroups]) {
+        [self registerTaskGroup:containedTaskGroup];
+    }
+    
+    // Contained task groups without any task are already done. No task will ever update their status, finish and 
+    // unregister them immediately
+    for (HLSTaskGroup *containedTaskGroup in [taskGroup allTaskGroups]) {
+        if ([[containedTaskGroup allTasks] count] == 0) {
+            [self finishEmptyTaskGroup:containedTaskGroup];
+            [self unregisterTaskGroup:containedTaskGroup];
+        }
+    }
+    
+    if (taskGroup.journaled) {
+        if ([[taskGroup taskGroups] count] != 0) {
+            HLSLoggerWarn(@"Task groups containing task groups cannot be journaled. Task group %@ is not journaled", taskGroup);
+        }
+        else {
+            [self.journal recordSubmissionForTaskGroup:taskGroup];
+        }
+    }
+    
+    // Barrier operations do nothing and finish as soon as they are ready
+    [self.operationQueue addOperations:barrierOperations waitUntilFinished:NO];
+    
+    // Schedule all operations, each in the pool matching its task execution class. Operation queues start ready operations
+    // with the same priority in the order they were added, so that adding them in scheduling order starts tasks with longer
+    // dependency chains first
+    for (HLSTask *task in [taskGroup tasksInSchedulingOrder]) {
+        [self scheduleOperationForTask:task];
+    }
+}
+
+// Each contained task group is represented by a start operation, on which all its members depend, and by an end
+// operation, which depends on all its members. Dependencies of and on task groups are set on these operations, so 
+// that each dependency costs a single operation dependency, whatever the number of tasks involved. Return the
+// operations created, which must be scheduled as well
+- (NSArray *)linkOperationsForTaskGroup:(HLSTaskGroup *)taskGroup
+{
+    NSArray *allTaskGroups = [taskGroup allTaskGroups];
+    NSMutableDictionary *taskGroupKeyToStartOperationMap = [NSMutableDictionary dictionary];
+    NSMutableDictionary *taskGroupKeyToEndOperationMap = [NSMutableDictionary dictionary];
+    NSMutableArray *barrierOperations = [NSMutableArray array];
+    for (HLSTaskGroup *containedTaskGroup in allTaskGroups) {
+        if (containedTaskGroup == taskGroup) {
             continue;
         }
         
-        // Retrieve the corresponding operation
-        NSValue *taskKey = [NSValue valueWithPointer:task];
-        HLSTaskOperation *operation = [self.taskToOperationMap objectForKey:taskKey];
+        NSValue *containedTaskGroupKey = [NSValue valueWithPointer:containedTaskGroup];
+        NSOperation *startOperation = [[[NSOperation alloc] init] autorelease];
+        [taskGroupKeyToStartOperationMap setObject:startOperation forKey:containedTaskGroupKey];
+        NSOperation *endOperation = [[[NSOperation alloc] init] autorelease];
+        [taskGroupKeyToEndOperationMap setObject:endOperation forKey:containedTaskGroupKey];
+        [barrierOperations addObject:startOperation];
+        [barrierOperations addObject:endOperation];
+    }
+    
+    for (HLSTaskGroup *containedTaskGroup in allTaskGroups) {
+        NSValue *containedTaskGroupKey = [NSValue valueWithPointer:containedTaskGroup];
+        NSOperation *startOperation = [taskGroupKeyToStartOperationMap objectForKey:containedTaskGroupKey];
+        NSOperation *endOperation = [taskGroupKeyToEndOperationMap objectForKey:containedTaskGroupKey];
         
-        // Set dependencies
-        for (HLSTask *dependencyTask in dependencyTasks) {
-            // Get the dependency operation
-            NSValue *dependencyTaskKey = [NSValue valueWithPointer:dependencyTask];
-            HLSTaskOperation *dependencyOperation = [self.taskToOperationMap objectForKey:dependencyTaskKey];
-            if (! dependencyOperation) {
-                continue;
+        NSArray *members = [[[containedTaskGroup tasks] allObjects] arrayByAddingObjectsFromArray:[[containedTaskGroup taskGroups] allObjects]];
+        for (id member in members) {
+            NSOperation *memberStartOperation = [self operationForMember:member taskGroupOperationMap:taskGroupKeyToStartOperationMap];
+            NSOperation *memberEndOperation = [self operationForMember:member taskGroupOperationMap:taskGroupKeyToEndOperationMap];
+            
+            // No barrier for the submitted task group
+            if (startOperation) {
+                [memberStartOperation addDependency:startOperation];
+                [endOperation addDependency:memberEndOperation];
             }
             
-            // Create the dependency between operations
-            [operation addDependency:dependencyOperation];
+            for (id dependency in [containedTaskGroup dependenciesForTask:member]) {
+                NSOperation *dependencyEndOperation = [self operationForMember:dependency taskGroupOperationMap:taskGroupKeyToEndOperationMap];
+                if (! dependencyEndOperation) {
+                    continue;
+                }
+                [memberStartOperation addDependency:dependencyEndOperation];
+            }
         }
     }
     
-    // Register object relationships
-    [self registerTaskGroup:taskGroup];
+    return [NSArray arrayWithArray:barrierOperations];
+}
+
+- (NSOperation *)operationForMember:(id)member taskGroupOperationMap:(NSDictionary *)taskGroupKeyToOperationMap
+{
+    if ([member isKindOfClass:[HLSTaskGroup class]]) {
+        return [taskGroupKeyToOperationMap objectForKey:[NSValue valueWithPointer:member]];
+    }
+    else {
+        return ((HLSTask *)member).operation;
+    }
+}
+
+// Shared thread pools also start ready operations with the same priority in submission order
+- (void)scheduleOperationForTask:(HLSTask *)task
+{
+    if (self.throttlingPolicy) {
+        [task.operation setThreadPriority:[self.throttlingPolicy threadPriorityForTask:task]];
+        [self deferTaskIfNeeded:task];
+    }
     
-    // Schedule all operations
-    for (HLSTaskOperation *operation in operations) {
-        [self.operationQueue addOperation:operation];
+    NSOperationQueue *operationQueue = [self operationQueueForExecutionClass:task.executionClass];
+    if (self.usingSharedThreadPool) {
+        [[HLSTaskThreadPool sharedThreadPoolForExecutionClass:task.executionClass] addOperation:task.operation
+                                                                                  forClientToken:self.threadPoolClientToken
+                                                                     maxConcurrentOperationCount:[operationQueue maxConcurrentOperationCount]];
+    }
+    else {
+        [operationQueue addOperation:task.operation];
+    }
+}
+
+#pragma mark -
+#pragma mark Journaling
+
+- (BOOL)openJournalAtPath:(NSString *)path error:(NSError **)pError
+{
+    HLSTaskJournal *journal = [[[HLSTaskJournal alloc] initWithPath:path fileManager:[HLSFileManager defaultManager]] autorelease];
+    if (! [journal open:pError]) {
+        return NO;
+    }
+    
+    self.journal = journal;
+    return YES;
+}
+
+- (NSArray *)resumeJournaledTasks
+{
+    NSArray *objects = [self.journal restoreUnfinishedObjects];
+    for (id object in objects) {
+        if ([object isKindOfClass:[HLSTaskGroup class]]) {
+            [self submitTaskGroup:object];
+        }
+        else {
+            [self submitTask:object];
+        }
     }
+    return objects;
 }
 
 #pragma mark -
@@ -223,32 +702,41 @@
         return;
     }
     
-    // Locate the associated operation
-    NSValue *taskKey = [NSValue valueWithPointer:task];
-    HLSTaskOperation *operation = [self.taskToOperationMap objectForKey:taskKey];
+    // Locate the associated operation. Tasks waiting for the result of an identical task have none
+    HLSTaskOperation *operation = task.operation;
     if (! operation) {
+        if ([self isDuplicateTask:task]) {
+            task.cancelled = YES;
+            task.finished = YES;
+            
+            id<HLSTaskDelegate> taskDelegate = [self delegateForTask:task];
+            if ([taskDelegate respondsToSelector:@selector(taskHasBeenCancelled:)]) {
+                [taskDelegate taskHasBeenCancelled:task];
+            }
+            
+            [self unregisterDuplicateTask:task forResultCacheKey:[task resultCacheKey]];
+            [self unregisterDelegateForTask:task];
+        }
+        // Waiting for the delivery of a cached result, which will notify the cancellation instead
+        else if ([self.tasks containsObject:task]) {
+            task.cancelled = YES;
+        }
         return;
     }
     
     // Flag the operation as cancelled
     task.cancelled = YES;
     
+    // If part of a task group, first cancel all dependent tasks, whether the task is running or not (a running task 
+    // might take some time to gracefully stop, dependents must not wait for it). A task group is removed once all tasks 
+    // it contains are marked as finished. Here we are careful enough to cancel all dependent task before the current 
+    // task is set as finished. This way the task group is guaranteed to survive the loop below
+    [self cancelStrongDependentsOfTask:task];
+    
     // When cancelling tasks, all those which have been started will update their status when they gracefully
     // stop (and unregister them at this point). For tasks which have not been started, this has to be done
     // here
     if (! [operation isExecuting]) {
-        // If part of a task group, first cancel all dependent tasks; a task group is removed once all tasks it contains are
-        // marked as finished. Here we are careful enough to cancel all dependent task before the current task is set as 
-        // finished. This way the task group is guaranteed to survive the loop below
-        HLSTaskGroup *taskGroup = task.taskGroup;
-        if (taskGroup) {
-            // Cancel all tasks strongly depending on the task
-            NSSet *strongDependents = [taskGroup strongDependentsForTask:task];
-            for (HLSTask *dependent in strongDependents) {
-                [self cancelTask:dependent];
-            }
-        }
-        
         task.finished = YES;
         
         // Notify the task delegate
@@ -257,28 +745,8 @@
             [taskDelegate taskHasBeenCancelled:task];
         }
         
-        if (taskGroup) {            
-            [taskGroup updateStatus];
-            
-            // If the task group is now complete, update and notify as well
-            if (taskGroup.finished) {
-                taskGroup.running = NO;
-                
-                id<HLSTaskGroupDelegate> taskGroupDelegate = [self delegateForTaskGroup:taskGroup];
-                if (! taskGroup.cancelled) {
-                    HLSLoggerDebug(@"Task group %@ ends successfully", taskGroup);
-                    if ([taskGroupDelegate respondsToSelector:@selector(taskGroupHasBeenProcessed:)]) {
-                        [taskGroupDelegate taskGroupHasBeenProcessed:taskGroup];
-                    }
-                }
-                else {
-                    HLSLoggerDebug(@"Task group %@ has been cancelled", taskGroup);
-                    if ([taskGroupDelegate respondsToSelector:@selector(taskGroupHasBeenCancelled:)]) {
-                        [taskGroupDelegate taskGroupHasBeenCancelled:taskGroup];
-                    }
-                }
-            }
-        }
+        // If the task groups containing the task are now complete, update and notify as well
+        [self updateTaskGroupsOfTask:task];
         
         [self unregisterOperation:operation];
     }
@@ -288,10 +756,12 @@
 
 - (void)cancelTaskGroup:(HLSTaskGroup *)taskGroup
 {
-    taskGroup.cancelled = YES;
+    for (HLSTaskGroup *containedTaskGroup in [taskGroup allTaskGroups]) {
+        containedTaskGroup.cancelled = YES;
+    }
     
     // Cancel all individual tasks
-    for (HLSTask *task in [taskGroup tasks]) {
+    for (HLSTask *task in [taskGroup allTasks]) {
         [self cancelTask:task];
     }
 }
@@ -328,19 +798,37 @@
     }
 }
 
+#pragma mark -
+#pragma mark Timing out tasks
+
+- (void)deadlineTimerFired:(NSTimer *)timer
+{
+    HLSTask *task = [timer userInfo];
+    [self timeOutTask:task];
+}
+
+- (void)timeOutTask:(HLSTask *)task
+{
+    if (task.finished || task.cancelled) {
+        return;
+    }
+    
+    HLSLoggerDebug(@"Task %@ has timed out", task);
+    task.timedOut = YES;
+    [self cancelTask:task];
+}
+
 #pragma mark -
 #pragma mark Finding tasks
 
 - (NSArray *)tasksWithTag:(NSString *)tag
 {
-    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"tag MATCHES %@", tag];
-    return [[self.tasks filteredSetUsingPredicate:predicate] allObjects];
+    return [self objectsInIndex:self.tagToTasksMap matchingTag:tag];
 }
 
 - (NSArray *)taskGroupsWithTag:(NSString *)tag
 {
-    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"tag MATCHES %@", tag];
-    return [[self.taskGroups filteredSetUsingPredicate:predicate] allObjects];    
+    return [self objectsInIndex:self.tagToTaskGroupsMap matchingTag:tag];
 }
 
 #pragma mark -
@@ -351,23 +839,11 @@
     // Unregister any previously registered delegate first
     [self unregisterDelegateForTask:task];
     
-    // Register the task - delegate relationship; use the task pointer as key
-    // TODO: I first expected the obvious following code to work:
-    //          NSValue *taskKey = [NSValue valueWithPointer:task];
-    //          [self.taskToDelegateMap setObject:delegate forKey:taskKey];
-    //       but some strange crashes occurred under some circumstances (most notably when the manager
-    //       object was fed with many tasks while many other tasks were still being processed; in my
-    //       case web service requests were being sent fast with a slow internet connection). After
-    //       investigation the dictionary taskToDelegateMap is in some cases corrupt, but the
-    //       reason is unclear since:
-    //         - all processing occurs on the calling thread, no thread interleaving issues come into play
-    //         - I was careful enough to iterate on copies of data structures when a loop body can potentially
-    //           alter it, so no enumerator invalidation issues should occur
-    //       I could not find the reason why this problem occurs, but I found a solution: copy & swap. 
-    NSValue *taskKey = [NSValue valueWithPointer:task];
-    NSMutableDictionary *tempTaskToDelegateMap = [NSMutableDictionary dictionaryWithDictionary:self.taskToDelegateMap];
-    [tempTaskToDelegateMap setObject:delegate forKey:taskKey];
-    self.taskToDelegateMap = tempTaskToDelegateMap;
+    // Register the task - delegate relationship. The delegate is stored on the task itself
+    // Remark: This relationship was formerly stored in a dictionary, which had to be copied (copy & swap) on each change
+    //         because of dictionary corruption issues whose reason could never be found. Besides avoiding this issue,
+    //         storing the delegate on the task makes registration and lookup cost constant time
+    task.registeredDelegate = delegate;
     
     // Register the inverse delegate - task relationship; use the delegate pointer as key
     NSValue *delegateKey = [NSValue valueWithPointer:delegate];
@@ -402,23 +878,19 @@
 
 - (void)unregisterDelegateForTask:(HLSTask *)task
 {
-    // Find if a delegate has been defined for this task; use the task pointer as key
-    NSValue *taskKey = [NSValue valueWithPointer:task];
-    id<HLSTaskDelegate> delegate = [self.taskToDelegateMap objectForKey:taskKey];
+    // Find if a delegate has been defined for this task
+    id<HLSTaskDelegate> delegate = task.registeredDelegate;
     if (! delegate) {
         return;
     }
     
-    // Remove the task - delegate relationship
-    // TODO: Copy & swap strategy to avoid strange dictionary corruption; see registerDelegate:. Normally the following
-    //       should have worked:
-    //           [self.taskToDelegateMap removeObjectForKey:taskKey];
-    NSMutableDictionary *tempTaskToDelegateMap = [NSMutableDictionary dictionaryWithDictionary:self.taskToDelegateMap];
-    [tempTaskToDelegateMap removeObjectForKey:taskKey];
-    self.taskToDelegateMap = tempTaskToDelegateMap;
-    
-    // Remove the inverse delegate - task relationship; use the delegate pointer as key
+    // Use the delegate pointer as key (computed first since the delegate might be released below)
     NSValue *delegateKey = [NSValue valueWithPointer:delegate];
+    
+    // Remove the task - delegate relationship
+    task.registeredDelegate = nil;
+    
+    // Remove the inverse delegate - task relationship
     NSMutableSet *tasksForDelegate = [self.delegateToTasksMap objectForKey:delegateKey];
     [tasksForDelegate removeObject:task];
     
@@ -478,20 +950,52 @@
 #pragma mark -
 #pragma mark Instantiating operations for a set of tasks
 
+- (HLSTaskOperation *)operationForTask:(HLSTask *)task
+{
+    Class operationClass = [task operationClass];
+    NSAssert([operationClass isSubclassOfClass:[HLSTaskOperation class]], @"Class %@ is not a subclass of HLSTaskOperation", operationClass);
+    HLSTaskOperation *operation = [[[operationClass alloc] initWithTaskManager:self
+                                                                          task:task]
+                                   autorelease];
+    [operation setQueuePriority:[self queuePriorityForTaskPriority:task.priority]];
+    return operation;
+}
+
 - (NSSet *)operationsForTasks:(NSSet *)tasks
 {
-    NSMutableSet *operations = [NSMutableSet set];
+    NSMutableSet *operations = [NSMutableSet setWithCapacity:[tasks count]];
     for (HLSTask *task in tasks) {
-        Class operationClass = [task operationClass];
-        NSAssert([operationClass isSubclassOfClass:[HLSTaskOperation class]], @"Class %@ is not a subclass of HLSTaskOperation", operationClass);
-        HLSTaskOperation *operation = [[[operationClass alloc] initWithTaskManager:self
-                                                                              task:task]
-                                       autorelease];
-        [operations addObject:operation];
+        [operations addObject:[self operationForTask:task]];
     }
     return operations;
 }
 
+- (NSOperationQueuePriority)queuePriorityForTaskPriority:(HLSTaskPriority)priority
+{
+    switch (priority) {
+        case HLSTaskPriorityVeryLow: {
+            return NSOperationQueuePriorityVeryLow;
+        }
+            
+        case HLSTaskPriorityLow: {
+            return NSOperationQueuePriorityLow;
+        }
+            
+        case HLSTaskPriorityHigh: {
+            return NSOperationQueuePriorityHigh;
+        }
+            
+        case HLSTaskPriorityVeryHigh: {
+            return NSOperationQueuePriorityVeryHigh;
+        }
+            
+        case HLSTaskPriorityNormal:
+        default: {
+            return NSOperationQueuePriorityNormal;
+        }
+    }
+}
+
 #pragma mark -
 #pragma mark Registering object relationships
 
@@ -500,28 +1004,71 @@
     // Keep a strong reference to the operation
     [self.tasks addObject:operation.task];
     
-    // Save the relationship between task and operation; use the task pointer as key
-    NSValue *taskKey = [NSValue valueWithPointer:operation.task];
-    [self.taskToOperationMap setObject:operation forKey:taskKey];
+    // Save the relationship between task and operation. The operation is stored on the task itself so that it can
+    // be retrieved in constant time, without allocating a lookup key
+    operation.task.operation = operation;
+    
+    // Index by tag
+    [self addObject:operation.task toIndex:self.tagToTasksMap forKey:operation.task.tag];
+    
+    // Schedule a timer for the task deadline, if any. Common run loop modes are used so that the timer also fires 
+    // during event tracking. Dispatch queues have no run loop, the deadline is scheduled on the queue instead
+    operation.task.timedOut = NO;
+    if (self.delegateQueue && doublegt(operation.task.timeoutInterval, 0.)) {
+        HLSTaskDeadlineContext *deadlineContext = (HLSTaskDeadlineContext *)calloc(1, sizeof(HLSTaskDeadlineContext));
+        deadlineContext->taskManager = [self retain];
+        deadlineContext->task = [operation.task retain];
+        deadlineContext->operation = [operation retain];
+        dispatch_after_f(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(operation.task.timeoutInterval * NSEC_PER_SEC)), 
+                         self.delegateQueue, 
+                         deadlineContext, 
+                         deadlinePassed);
+    }
+    else if (doublegt(operation.task.timeoutInterval, 0.)) {
+        NSTimer *deadlineTimer = [NSTimer timerWithTimeInterval:operation.task.timeoutInterval
+                                                         target:self
+                                                       selector:@selector(deadlineTimerFired:)
+                                                       userInfo:operation.task
+                                                        repeats:NO];
+        [[NSRunLoop currentRunLoop] addTimer:deadlineTimer forMode:NSRunLoopCommonModes];
+        operation.task.deadlineTimer = deadlineTimer;
+    }
+    
+    [self recordSubmissionForTask:operation.task];
 }
 
 - (void)unregisterOperation:(HLSTaskOperation *)operation
 {
-    // Unregister the associated task - operation relationship; use the task pointer as key
-    NSValue *taskKey = [NSValue valueWithPointer:operation.task];
-    [self.taskToOperationMap removeObjectForKey:taskKey];   
+    // Unregister the associated task - operation relationship. The operation is kept alive by its queue while
+    // it is still running
+    operation.task.operation = nil;
+    
+    // The timer retains the task, invalidate it so that both get released
+    [operation.task.deadlineTimer invalidate];
+    operation.task.deadlineTimer = nil;
     
     // Automatically cleanup delegate registrations
     [self unregisterDelegateForTask:operation.task];
     
-    // If the task is part of a task group, unregister it if all task group operations are complete
+    // If the task is part of task groups, unregister those whose operations are all complete. The enclosing task group
+    // might be released when unregistered, get its parent first
     HLSTaskGroup *taskGroup = operation.task.taskGroup;
-    if (taskGroup) {
+    while (taskGroup) {
+        HLSTaskGroup *parentTaskGroup = taskGroup.parentTaskGroup;
         if (taskGroup.finished) {
             [self unregisterTaskGroup:taskGroup];
-        }        
+        }
+        taskGroup = parentTaskGroup;
     }
     
+    // Remove from the tag index
+    [self removeObject:operation.task fromIndex:self.tagToTasksMap forKey:operation.task.tag];
+    
+    [self recordEndForTask:operation.task];
+    [self.journal recordEndForTask:operation.task];
+    
+    [self processResultOfTask:operation.task];
+    
     // Finally, release the strong ref to the task
     [self.tasks removeObject:operation.task];
 }
@@ -530,6 +1077,9 @@
 {
     // Keep a strong ref to the task group
     [self.taskGroups addObject:taskGroup];
+    
+    // Index by tag
+    [self addObject:taskGroup toIndex:self.tagToTaskGroupsMap forKey:taskGroup.tag];
 }
 
 - (void)unregisterTaskGroup:(HLSTaskGroup *)taskGroup
@@ -537,23 +1087,446 @@
     // Automatically cleanup delegate registrations
     [self unregisterDelegateForTaskGroup:taskGroup];
     
+    // Remove from the tag index
+    [self removeObject:taskGroup fromIndex:self.tagToTaskGroupsMap forKey:taskGroup.tag];
+    
     // Release the strong ref to the task group
     [self.taskGroups removeObject:taskGroup];
 }
 
+// Update the status of a task group without any task and simulate events
+- (void)finishEmptyTaskGroup:(HLSTaskGroup *)taskGroup
+{
+    id<HLSTaskGroupDelegate> taskGroupDelegate = [self delegateForTaskGroup:taskGroup];
+    if (taskGroupDelegate) {
+        if ([taskGroupDelegate respondsToSelector:@selector(taskGroupHasStartedProcessing:)]) {
+            [taskGroupDelegate taskGroupHasStartedProcessing:taskGroup];
+        }
+        
+        if ([taskGroupDelegate respondsToSelector:@selector(taskGroupHasBeenProcessed:)]) {
+            [taskGroupDelegate taskGroupHasBeenProcessed:taskGroup];
+        }            
+    }
+    
+    taskGroup.finished = YES;
+}
+
+- (void)startTaskGroupsOfTask:(HLSTask *)task
+{
+    NSMutableArray *taskGroups = [NSMutableArray array];
+    for (HLSTaskGroup *taskGroup = task.taskGroup; taskGroup; taskGroup = taskGroup.parentTaskGroup) {
+        [taskGroups insertObject:taskGroup atIndex:0];
+    }
+    
+    for (HLSTaskGroup *taskGroup in taskGroups) {
+        if (taskGroup.running) {
+            continue;
+        }
+        
+        HLSLoggerDebug(@"Task group %@ starts", taskGroup);
+        
+        taskGroup.running = YES;
+        id<HLSTaskGroupDelegate> taskGroupDelegate = [self delegateForTaskGroup:taskGroup];
+        if ([taskGroupDelegate respondsToSelector:@selector(taskGroupHasStartedProcessing:)]) {
+            [taskGroupDelegate taskGroupHasStartedProcessing:taskGroup];
+        }
+    }
+}
+
+- (void)updateTaskGroupsOfTask:(HLSTask *)task
+{
+    for (HLSTaskGroup *taskGroup = task.taskGroup; taskGroup; taskGroup = taskGroup.parentTaskGroup) {
+        BOOL wasFinished = taskGroup.finished;
+        
+        // Update and notify about the task group progress
+        id<HLSTaskGroupDelegate> taskGroupDelegate = [self delegateForTaskGroup:taskGroup];
+        [taskGroup updateStatus];
+        if ([taskGroupDelegate respondsToSelector:@selector(taskGroupProgressUpdated:)]) {
+            [taskGroupDelegate taskGroupProgressUpdated:taskGroup];
+        }
+        
+        // If the task group is now complete, update and notify as well
+        if (taskGroup.finished && ! wasFinished) {
+            taskGroup.running = NO;
+            
+            if (! taskGroup.cancelled) {
+                HLSLoggerDebug(@"Task group %@ ends successfully", taskGroup);
+                if ([taskGroupDelegate respondsToSelector:@selector(taskGroupHasBeenProcessed:)]) {
+                    [taskGroupDelegate taskGroupHasBeenProcessed:taskGroup];
+                }
+            }
+            else {
+                HLSLoggerDebug(@"Task group %@ has been cancelled", taskGroup);
+                if ([taskGroupDelegate respondsToSelector:@selector(taskGroupHasBeenCancelled:)]) {
+                    [taskGroupDelegate taskGroupHasBeenCancelled:taskGroup];
+                }
+            }
+        }
+    }
+}
+
+- (void)cancelStrongDependentsOfTask:(HLSTask *)task
+{
+    // A task group containing a task which failed or has been cancelled has failed as well
+    id member = task;
+    for (HLSTaskGroup *taskGroup = task.taskGroup; taskGroup; taskGroup = taskGroup.parentTaskGroup) {
+        for (id dependent in [taskGroup strongDependentsForTask:member]) {
+            // Already cancelled (cancellation propagates along several paths)
+            if ([dependent isCancelled]) {
+                continue;
+            }
+            
+            if ([dependent isKindOfClass:[HLSTaskGroup class]]) {
+                [self cancelTaskGroup:dependent];
+            }
+            else {
+                [self cancelTask:dependent];
+            }
+        }
+        member = taskGroup;
+    }
+}
+
+#pragma mark -
+#pragma mark Caching results
+
+- (void)clearResultCache
+{
+    [self.resultCache removeAllObjects];
+}
+
+- (void)registerDuplicateTask:(HLSTask *)task forResultCacheKey:(id)resultCacheKey
+{
+    // Keep a strong reference to the task, and index it by tag so that it can be found and cancelled as any other task
+    [self.tasks addObject:task];
+    [self addObject:task toIndex:self.tagToTasksMap forKey:task.tag];
+    
+    [self addObject:task toIndex:self.resultCacheKeyToDuplicateTasksMap forKey:resultCacheKey];
+}
+
+- (void)unregisterDuplicateTask:(HLSTask *)task forResultCacheKey:(id)resultCacheKey
+{
+    // Might be the last reference to the task
+    [[task retain] autorelease];
+    
+    [self removeObject:task fromIndex:self.resultCacheKeyToDuplicateTasksMap forKey:resultCacheKey];
+    [self removeObject:task fromIndex:self.tagToTasksMap forKey:task.tag];
+    [self.tasks removeObject:task];
+}
+
+- (BOOL)isDuplicateTask:(HLSTask *)task
+{
+    if ([self.resultCacheKeyToDuplicateTasksMap count] == 0) {
+        return NO;
+    }
+    
+    id resultCacheKey = [task resultCacheKey];
+    if (! resultCacheKey) {
+        return NO;
+    }
+    
+    return [[self.resultCacheKeyToDuplicateTasksMap objectForKey:resultCacheKey] containsObject:task];
+}
+
+/**
+ * Cache the result of a task which has ended, and complete the identical tasks waiting for it. If the task was not 
+ * successful, these are submitted again instead (one of them is processed, the others wait for its result)
+ */
+- (void)processResultOfTask:(HLSTask *)task
+{
+    if ([self.resultCacheKeyToTaskMap count] == 0) {
+        return;
+    }
+    
+    id resultCacheKey = [task resultCacheKey];
+    if (! resultCacheKey || [self.resultCacheKeyToTaskMap objectForKey:resultCacheKey] != task) {
+        return;
+    }
+    
+    [[resultCacheKey retain] autorelease];
+    [self.resultCacheKeyToTaskMap removeObjectForKey:resultCacheKey];
+    
+    BOOL successful = ! task.cancelled && ! task.error;
+    NSDictionary *returnInfo = task.returnInfo ? task.returnInfo : [NSDictionary dictionary];
+    if (successful && self.resultCacheEnabled) {
+        [self.resultCache setObject:returnInfo
+                             forKey:resultCacheKey
+                               cost:[task resultCacheCostForReturnInfo:returnInfo]];
+    }
+    
+    NSSet *duplicateTasks = [NSSet setWithSet:[self.resultCacheKeyToDuplicateTasksMap objectForKey:resultCacheKey]];
+    for (HLSTask *duplicateTask in duplicateTasks) {
+        [self unregisterDuplicateTask:duplicateTask forResultCacheKey:resultCacheKey];
+        if (successful) {
+            [self completeTask:duplicateTask withReturnInfo:returnInfo];
+        }
+        else {
+            [self submitTask:duplicateTask];
+        }
+    }
+}
+
+/**
+ * Complete a task without processing it, simulating the events an operation would have triggered
+ */
+- (void)completeTask:(HLSTask *)task withReturnInfo:(NSDictionary *)returnInfo
+{
+    [task reset];
+    
+    id<HLSTaskDelegate> taskDelegate = [self delegateForTask:task];
+    task.running = YES;
+    if ([taskDelegate respondsToSelector:@selector(taskHasStartedProcessing:)]) {
+        [taskDelegate taskHasStartedProcessing:task];
+    }
+    
+    task.returnInfo = returnInfo;
+    task.progress = 1.f;
+    if ([taskDelegate respondsToSelector:@selector(taskProgressUpdated:)]) {
+        [taskDelegate taskProgressUpdated:task];
+    }
+    
+    task.finished = YES;
+    task.running = NO;
+    if ([taskDelegate respondsToSelector:@selector(taskHasBeenProcessed:)]) {
+        [taskDelegate taskHasBeenProcessed:task];
+    }
+    
+    // As for processed tasks, the delegate registration is automatically removed
+    [self unregisterDelegateForTask:task];
+}
+
+/**
+ * Deferred completion of a task whose result was found in the cache. The parameter contains the task and its
+ * return info. If the task has been cancelled meanwhile, its cancellation is notified instead
+ */
+- (void)completeTaskWithCachedResult:(NSArray *)taskAndReturnInfo
+{
+    HLSTask *task = [taskAndReturnInfo objectAtIndex:0];
+    [self removeObject:task fromIndex:self.tagToTasksMap forKey:task.tag];
+    [self.tasks removeObject:task];
+    
+    if (task.cancelled) {
+        task.finished = YES;
+        
+        id<HLSTaskDelegate> taskDelegate = [self delegateForTask:task];
+        if ([taskDelegate respondsToSelector:@selector(taskHasBeenCancelled:)]) {
+            [taskDelegate taskHasBeenCancelled:task];
+        }
+        
+        [self unregisterDelegateForTask:task];
+        return;
+    }
+    
+    NSDictionary *returnInfo = [taskAndReturnInfo objectAtIndex:1];
+    [self completeTask:task withReturnInfo:returnInfo];
+}
+
+#pragma mark -
+#pragma mark Maintaining indexes
+
+- (void)addObject:(id)object toIndex:(NSMutableDictionary *)index forKey:(id)key
+{
+    if (! key) {
+        return;
+    }
+    
+    NSMutableSet *objects = [index objectForKey:key];
+    // Create the set lazily if it does not exist
+    if (! objects) {
+        objects = [NSMutableSet set];
+        [index setObject:objects forKey:key];
+    }
+    [objects addObject:object];
+}
+
+- (void)removeObject:(id)object fromIndex:(NSMutableDictionary *)index forKey:(id)key
+{
+    if (! key) {
+        return;
+    }
+    
+    NSMutableSet *objects = [index objectForKey:key];
+    [objects removeObject:object];
+    
+    // If the set is now empty, then remove the dictionary entry as well
+    if ([objects count] == 0) {
+        [index removeObjectForKey:key];
+    }
+}
+
+/**
+ * Return the objects of a tag index whose tag matches a regular expression
+ */
+- (NSArray *)objectsInIndex:(NSDictionary *)index matchingTag:(NSString *)tag
+{
+    if (! tag) {
+        return [NSArray array];
+    }
+    
+    // Most tags are plain strings, which only match themselves. Look them up directly
+    if (isLiteralPattern(tag)) {
+        NSSet *objects = [index objectForKey:tag];
+        return objects ? [objects allObjects] : [NSArray array];
+    }
+    
+    // Match the pattern against the distinct tags only, not against every object
+    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"SELF MATCHES %@", tag];
+    NSMutableSet *objects = [NSMutableSet set];
+    for (NSString *matchingTag in [[index allKeys] filteredArrayUsingPredicate:predicate]) {
+        [objects unionSet:[index objectForKey:matchingTag]];
+    }
+    return [objects allObjects];
+}
+
+#pragma mark -
+#pragma mark Collecting metrics
+
+- (void)recordSubmissionForTask:(HLSTask *)task
+{
+    task.startTime = 0.;
+    if (! self.metricsEnabled) {
+        task.submissionTime = 0.;
+        return;
+    }
+    
+    task.submissionTime = CFAbsoluteTimeGetCurrent();
+    for (HLSTaskMetrics *metrics in [self metricsForTask:task]) {
+        [metrics recordSubmission];
+    }
+}
+
+- (void)recordStartForTask:(HLSTask *)task
+{
+    // Only tasks submitted while metrics collection was enabled are tracked
+    if (doubleeq(task.submissionTime, 0.)) {
+        return;
+    }
+    
+    task.startTime = CFAbsoluteTimeGetCurrent();
+    ++_runningTaskCounts[task.executionClass];
+    
+    NSTimeInterval waitTimeInterval = task.startTime - task.submissionTime;
+    for (HLSTaskMetrics *metrics in [self metricsForTask:task]) {
+        [metrics recordStartWithWaitTimeInterval:waitTimeInterval];
+    }
+}
+
+- (void)recordEndForTask:(HLSTask *)task
+{
+    if (doubleeq(task.submissionTime, 0.)) {
+        return;
+    }
+    
+    // Tasks cancelled before they started are recorded with a negative running time
+    NSTimeInterval runTimeInterval = -1.;
+    if (! doubleeq(task.startTime, 0.)) {
+        runTimeInterval = CFAbsoluteTimeGetCurrent() - task.startTime;
+        --_runningTaskCounts[task.executionClass];
+    }
+    
+    for (HLSTaskMetrics *metrics in [self metricsForTask:task]) {
+        [metrics recordEndWithRunTimeInterval:runTimeInterval];
+    }
+    
+    task.submissionTime = 0.;
+    task.startTime = 0.;
+}
+
+/**
+ * Return the metrics objects a task contributes to (created lazily)
+ */
+- (NSArray *)metricsForTask:(HLSTask *)task
+{
+    if (! task.tag) {
+        return [NSArray arrayWithObject:_metrics];
+    }
+    
+    HLSTaskMetrics *tagMetrics = [self.tagToMetricsMap objectForKey:task.tag];
+    if (! tagMetrics) {
+        tagMetrics = [[[HLSTaskMetrics alloc] init] autorelease];
+        [self.tagToMetricsMap setObject:tagMetrics forKey:task.tag];
+    }
+    return [NSArray arrayWithObjects:_metrics, tagMetrics, nil];
+}
+
 #pragma mark -
 #pragma mark Retrieving registered delegates
 
+// If the delegate must be notified on another queue, a proxy forwarding messages onto it is returned
 - (id<HLSTaskDelegate>)delegateForTask:(HLSTask *)task
 {
-    NSValue *taskKey = [NSValue valueWithPointer:task];
-    return [self.taskToDelegateMap objectForKey:taskKey];
+    id<HLSTaskDelegate> taskDelegate = task.registeredDelegate;
+    if (taskDelegate && task.delegateQueue) {
+        return [HLSTaskDelegateProxy proxyWithDelegate:taskDelegate queue:task.delegateQueue];
+    }
+    return taskDelegate;
 }
 
 - (id<HLSTaskGroupDelegate>)delegateForTaskGroup:(HLSTaskGroup *)taskGroup
 {
     NSValue *taskGroupKey = [NSValue valueWithPointer:taskGroup];
-    return [self.taskGroupToDelegateMap objectForKey:taskGroupKey];
+    id<HLSTaskGroupDelegate> taskGroupDelegate = [self.taskGroupToDelegateMap objectForKey:taskGroupKey];
+    if (taskGroupDelegate && taskGroup.delegateQueue) {
+        return [HLSTaskDelegateProxy proxyWithDelegate:taskGroupDelegate queue:taskGroup.delegateQueue];
+    }
+    return taskGroupDelegate;
+}
+
+#pragma mark -
+#pragma mark Notification callbacks
+
+- (void)applicationDidReceiveMemoryWarning:(NSNotification *)notification
+{
+    [self clearResultCache];
+}
+
+- (void)throttlingConditionsDidChange:(NSNotification *)notification
+{
+    // Notifications are received on the main thread
+    if (self.delegateQueue) {
+        dispatch_async_f(self.delegateQueue, [self retain], updateThrottling);
+    }
+    else {
+        [self updateThrottling];
+    }
 }
 
 @end
+
+#pragma mark -
+#pragma mark Static functions
+
+static void deadlinePassed(void *context)
+{
+    HLSTaskDeadlineContext *deadlineContext = (HLSTaskDeadlineContext *)context;
+    
+    // Only if the task is still processed by the same operation (it might have ended and been submitted again since)
+    if (deadlineContext->task.operation == deadlineContext->operation) {
+        [deadlineContext->taskManager timeOutTask:deadlineContext->task];
+    }
+    
+    [deadlineContext->taskManager release];
+    [deadlineContext->task release];
+    [deadlineContext->operation release];
+    free(deadlineContext);
+}
+
+static void updateThrottling(void *context)
+{
+    HLSTaskManager *taskManager = (HLSTaskManager *)context;
+    [taskManager updateThrottling];
+    [taskManager release];
+}
+
+// Return YES iff a regular expression contains no special character, i.e. only matches itself
+static BOOL isLiteralPattern(NSString *pattern)
+{
+    NSUInteger length = [pattern length];
+    for (NSUInteger i = 0; i < length; ++i) {
+        unichar character = [pattern characterAtIndex:i];
+        if (character < 128 && strchr("\\^$.|?*+()[]{}", character)) {
+            return NO;
+        }
+    }
+    return YES;
+}
@@ -0,0 +1,23 @@
+//
+//  HLSTaskMetrics+Friend.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+/**
+ * Interface meant to be used by friend classes of HLSTaskMetrics (= classes which must have access to private implementation
+ * details)
+ */
+@interface HLSTaskMetrics (Friend)
+
+/**
+ * Record the different events in the life of a task. A task which has not started when it ends (i.e. which has been 
+ * cancelled before) must be recorded with a negative running time interval
+ */
+- (void)recordSubmission;
+- (void)recordStartWithWaitTimeInterval:(NSTimeInterval)waitTimeInterval;
+- (void)recordEndWithRunTimeInterval:(NSTimeInterval)runTimeInterval;
+
+@end
@@ -0,0 +1,70 @@
+//
+//  HLSTaskMetrics.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#define kTaskMetricsHistogramBucketCount            7
+
+/**
+ * Metrics collected by a task manager for a set of tasks (see -[HLSTaskManager metrics] and -[HLSTaskManager metricsByTag]).
+ * The time a task spends waiting is measured from its submission to the moment it starts, its running time from the
+ * moment it starts to the moment it ends. Durations are also counted in histograms with logarithmic buckets: < 1 ms,
+ * < 10 ms, < 100 ms, < 1 s, < 10 s, < 100 s and >= 100 s (see +upperBoundForHistogramBucketAtIndex:).
+ *
+ * Objects returned by the task manager are snapshots, which are not updated afterwards
+ *
+ * Designated initializer: -init
+ */
+@interface HLSTaskMetrics : NSObject <NSCopying> {
+@private
+    NSUInteger _pendingTaskCount;
+    NSUInteger _runningTaskCount;
+    NSUInteger _finishedTaskCount;
+    NSUInteger _startedTaskCount;
+    NSTimeInterval _totalWaitTimeInterval;
+    NSTimeInterval _maxWaitTimeInterval;
+    NSTimeInterval _totalRunTimeInterval;
+    NSTimeInterval _maxRunTimeInterval;
+    NSUInteger _waitTimeHistogram[kTaskMetricsHistogramBucketCount];
+    NSUInteger _runTimeHistogram[kTaskMetricsHistogramBucketCount];
+}
+
+/**
+ * Upper bound (exclusive) of the durations counted in a histogram bucket. The last bucket has no upper bound 
+ * (DBL_MAX is returned)
+ */
++ (NSTimeInterval)upperBoundForHistogramBucketAtIndex:(NSUInteger)index;
+
+/**
+ * Number of tasks submitted but not started yet (queue depth)
+ */
+@property (nonatomic, readonly, assign) NSUInteger pendingTaskCount;
+
+/**
+ * Number of tasks currently running
+ */
+@property (nonatomic, readonly, assign) NSUInteger runningTaskCount;
+
+/**
+ * Number of tasks which have ended (successfully or not), or have been cancelled
+ */
+@property (nonatomic, readonly, assign) NSUInteger finishedTaskCount;
+
+/**
+ * Waiting time statistics, over all tasks which have started
+ */
+@property (nonatomic, readonly, assign) NSTimeInterval maxWaitTimeInterval;
+- (NSTimeInterval)averageWaitTimeInterval;
+- (NSUInteger)waitTimeCountInHistogramBucketAtIndex:(NSUInteger)index;
+
+/**
+ * Running time statistics, over all tasks which have started and ended
+ */
+@property (nonatomic, readonly, assign) NSTimeInterval maxRunTimeInterval;
+- (NSTimeInterval)averageRunTimeInterval;
+- (NSUInteger)runTimeCountInHistogramBucketAtIndex:(NSUInteger)index;
+
+@end
@@ -0,0 +1,173 @@
+//
+//  HLSTaskMetrics.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSTaskMetrics.h"
+
+#import "HLSLogger.h"
+
+static NSUInteger histogramBucketIndexForTimeInterval(NSTimeInterval timeInterval);
+
+@interface HLSTaskMetrics ()
+
+@property (nonatomic, assign) NSUInteger pendingTaskCount;
+@property (nonatomic, assign) NSUInteger runningTaskCount;
+@property (nonatomic, assign) NSUInteger finishedTaskCount;
+@property (nonatomic, assign) NSTimeInterval maxWaitTimeInterval;
+@property (nonatomic, assign) NSTimeInterval maxRunTimeInterval;
+
+@end
+
+@implementation HLSTaskMetrics
+
+#pragma mark Class methods
+
++ (NSTimeInterval)upperBoundForHistogramBucketAtIndex:(NSUInteger)index
+{
+    if (index >= kTaskMetricsHistogramBucketCount) {
+        HLSLoggerError(@"Invalid bucket index");
+        return 0.;
+    }
+    
+    if (index == kTaskMetricsHistogramBucketCount - 1) {
+        return DBL_MAX;
+    }
+    
+    // 1 ms, 10 ms, ...
+    return pow(10., (double)index - 3.);
+}
+
+#pragma mark Accessors and mutators
+
+@synthesize pendingTaskCount = _pendingTaskCount;
+
+@synthesize runningTaskCount = _runningTaskCount;
+
+@synthesize finishedTaskCount = _finishedTaskCount;
+
+@synthesize maxWaitTimeInterval = _maxWaitTimeInterval;
+
+- (NSTimeInterval)averageWaitTimeInterval
+{
+    return (_startedTaskCount != 0) ? _totalWaitTimeInterval / _startedTaskCount : 0.;
+}
+
+- (NSUInteger)waitTimeCountInHistogramBucketAtIndex:(NSUInteger)index
+{
+    if (index >= kTaskMetricsHistogramBucketCount) {
+        HLSLoggerError(@"Invalid bucket index");
+        return 0;
+    }
+    
+    return _waitTimeHistogram[index];
+}
+
+@synthesize maxRunTimeInterval = _maxRunTimeInterval;
+
+- (NSTimeInterval)averageRunTimeInterval
+{
+    NSUInteger completedTaskCount = 0;
+    for (NSUInteger i = 0; i < kTaskMetricsHistogramBucketCount; ++i) {
+        completedTaskCount += _runTimeHistogram[i];
+    }
+    return (completedTaskCount != 0) ? _totalRunTimeInterval / completedTaskCount : 0.;
+}
+
+- (NSUInteger)runTimeCountInHistogramBucketAtIndex:(NSUInteger)index
+{
+    if (index >= kTaskMetricsHistogramBucketCount) {
+        HLSLoggerError(@"Invalid bucket index");
+        return 0;
+    }
+    
+    return _runTimeHistogram[index];
+}
+
+#pragma mark Recording events
+
+- (void)recordSubmission
+{
+    ++_pendingTaskCount;
+}
+
+- (void)recordStartWithWaitTimeInterval:(NSTimeInterval)waitTimeInterval
+{
+    --_pendingTaskCount;
+    ++_runningTaskCount;
+    
+    ++_startedTaskCount;
+    _totalWaitTimeInterval += waitTimeInterval;
+    _maxWaitTimeInterval = MAX(_maxWaitTimeInterval, waitTimeInterval);
+    ++_waitTimeHistogram[histogramBucketIndexForTimeInterval(waitTimeInterval)];
+}
+
+- (void)recordEndWithRunTimeInterval:(NSTimeInterval)runTimeInterval
+{
+    ++_finishedTaskCount;
+    
+    // Never started
+    if (runTimeInterval < 0.) {
+        --_pendingTaskCount;
+        return;
+    }
+    
+    --_runningTaskCount;
+    
+    _totalRunTimeInterval += runTimeInterval;
+    _maxRunTimeInterval = MAX(_maxRunTimeInterval, runTimeInterval);
+    ++_runTimeHistogram[histogramBucketIndexForTimeInterval(runTimeInterval)];
+}
+
+#pragma mark NSCopying protocol implementation
+
+- (id)copyWithZone:(NSZone *)zone
+{
+    HLSTaskMetrics *metricsCopy = [[[self class] allocWithZone:zone] init];
+    metricsCopy->_pendingTaskCount = _pendingTaskCount;
+    metricsCopy->_runningTaskCount = _runningTaskCount;
+    metricsCopy->_finishedTaskCount = _finishedTaskCount;
+    metricsCopy->_startedTaskCount = _startedTaskCount;
+    metricsCopy->_totalWaitTimeInterval = _totalWaitTimeInterval;
+    metricsCopy->_maxWaitTimeInterval = _maxWaitTimeInterval;
+    metricsCopy->_totalRunTimeInterval = _totalRunTimeInterval;
+    metricsCopy->_maxRunTimeInterval = _maxRunTimeInterval;
+    memcpy(metricsCopy->_waitTimeHistogram, _waitTimeHistogram, sizeof(_waitTimeHistogram));
+    memcpy(metricsCopy->_runTimeHistogram, _runTimeHistogram, sizeof(_runTimeHistogram));
+    return metricsCopy;
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; pendingTaskCount: %d; runningTaskCount: %d; finishedTaskCount: %d; "
+            "averageWaitTimeInterval: %.3f; maxWaitTimeInterval: %.3f; averageRunTimeInterval: %.3f; maxRunTimeInterval: %.3f>",
+            [self class],
+            self,
+            self.pendingTaskCount,
+            self.runningTaskCount,
+            self.finishedTaskCount,
+            [self averageWaitTimeInterval],
+            self.maxWaitTimeInterval,
+            [self averageRunTimeInterval],
+            self.maxRunTimeInterval];
+}
+
+@end
+
+/**
+ * Return the index of the histogram bucket in which a duration must be counted
+ */
+static NSUInteger histogramBucketIndexForTimeInterval(NSTimeInterval timeInterval)
+{
+    for (NSUInteger i = 0; i < kTaskMetricsHistogramBucketCount - 1; ++i) {
+        if (timeInterval < [HLSTaskMetrics upperBoundForHistogramBucketAtIndex:i]) {
+            return i;
+        }
+    }
+    return kTaskMetricsHistogramBucketCount - 1;
+}
@@ -19,6 +19,14 @@
  */
 - (void)operationMain;
 
+/**
+ * Asynchronous operations (i.e. overriding -isConcurrent to return YES) must call this method once, from any thread,
+ * when the work started by -operationMain is over, whether it succeeded, failed or has been cancelled. This method
+ * must not be called by other operations
+ * Not meant to be overridden
+ */
+- (void)finishOperation;
+
 /**
  * Update the status of an operation; valid values are 0.f (task not processed), 1.f (task fully processed) or a value 
  * in between (which should reflect an estimate about how much of the task has been processed)
@@ -32,6 +40,24 @@
  */
 - (void)attachReturnInfo:(NSDictionary *)returnInfo;
 
+/**
+ * Call this method to deliver a partial result to the task delegate (-task:didProduceResult: method) while the 
+ * operation is still running, e.g. to let a consumer display rows while the operation is still parsing. If too many 
+ * results are waiting to be delivered (see -[HLSTaskManager maxPendingPartialResultCount]), this method blocks until
+ * some have been delivered. Return YES if the result will be delivered, NO if the operation has been cancelled
+ * meanwhile (in which case the result is discarded and the operation should stop producing results)
+ * Not meant to be overridden
+ */
+- (BOOL)emitPartialResult:(id)result;
+
+/**
+ * The cancellation token associated with the operation. It is cancelled as soon as the operation is, on the thread
+ * cancelling it. Register cancellation actions on it to react to cancellation immediately (e.g. to abort a blocking
+ * call or a network connection), or child tokens to forward cancellation to nested work you spawn
+ * Not meant to be overridden
+ */
+- (HLSCancellationToken *)cancellationToken;
+
 /**
  * Call this method to attach an error to the task processed by the operation. The task is then considered to have
  * failed
@@ -6,6 +6,7 @@
 //  Copyright 2010 Hortis. All rights reserved.
 //
 
+#import "HLSCancellationToken.h"
 #import "HLSTask.h"
 #import "HLSTaskManager.h"
 
@@ -21,7 +22,11 @@
  *    if your operations are already running (e.g. downloading data), they will only be put in the cancelled state,
  *    but the corresponding thread will not be killed. Your operation implementation is therefore responsible to check
  *    its state regularly so that if a running operation is switched to the cancelled state it gracefully stops its
- *    current work as soon as possible
+ *    current work as soon as possible. Instead of polling, operations can also register cancellation actions on 
+ *    their cancellation token (see HLSTaskOperation+Protected.h), e.g. to interrupt a blocking call immediately
+ *  - operations performing asynchronous work (e.g. network connections) need not block a thread while waiting for it
+ *    to complete. Such operations override -isConcurrent to return YES, return from -operationMain as soon as the
+ *    work has been started, and call -finishOperation when it is over (see HLSTaskOperation+Protected.h)
  *  - operations are instantiated by the HLSTaskManager using their designated initializer. Your subclass must therefore
  *    not define any other initializer since they would never be called
  *
@@ -32,6 +37,20 @@
     HLSTaskManager *_taskManager;       // The task manager which spawned the operation
     HLSTask *_task;                     // The task the operation is processing
     NSThread *_callingThread;           // Thread onto which spawned the operation
+    dispatch_queue_t _delegateQueue;    // Queue onto which notifications are delivered, NULL if delivered to the calling thread
+    HLSTaskNotificationMode _notificationMode;
+    NSMutableArray *_pendingNotificationInvocations;        // FIFO of NSInvocation objects waiting to be performed on the calling thread
+    NSTimeInterval _minProgressUpdateInterval;              // 0 if progress updates are not rate-limited
+    CFAbsoluteTime _lastProgressUpdateTime;                 // Worker thread: Time at which progress was last sent ...
+    float _pendingProgress;                                 // ... and latest value which has been merged since
+    BOOL _hasPendingProgress;
+    NSCondition *_partialResultsCondition;                  // Guards the number of emitted results not delivered yet ...
+    NSUInteger _pendingPartialResultCount;                  // ... which is this one ...
+    NSUInteger _maxPendingPartialResultCount;               // ... and must not exceed this limit
+    HLSCancellationToken *_cancellationToken;
+    CFAbsoluteTime _deadline;                               // 0 if the task has no deadline
+    BOOL _executing;                                        // Status of asynchronous operations (see -isConcurrent)
+    BOOL _finished;
 }
 
 - (id)initWithTaskManager:(HLSTaskManager *)taskManager task:(HLSTask *)task;
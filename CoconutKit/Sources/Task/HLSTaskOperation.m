@@ -9,26 +9,44 @@
 #import "HLSTaskOperation.h"
 
 #import "HLSAssert.h"
+#import "HLSFloat.h"
 #import "HLSLogger.h"
 #import "HLSTask+Friend.h"
 #import "HLSTaskGroup+Friend.h"
 #import "HLSTaskManager+Friend.h"
 
+// Function declarations
+static void performNotificationInvocation(void *context);
+static void flushPendingNotificationInvocations(void *context);
+
 @interface HLSTaskOperation ()
 
 @property (nonatomic, assign) HLSTaskManager *taskManager;
 @property (nonatomic, assign) HLSTask *task;
 @property (nonatomic, retain) NSThread *callingThread;
+@property (nonatomic, retain) NSMutableArray *pendingNotificationInvocations;
+@property (nonatomic, retain) NSCondition *partialResultsCondition;
+@property (nonatomic, retain) HLSCancellationToken *cancellationToken;
 
 - (void)operationMain;
+- (void)finishOperation;
+- (BOOL)beginOperation;
+- (void)endOperation;
+- (void)setAsynchronousOperationExecuting:(BOOL)executing finished:(BOOL)finished;
 
 - (void)onCallingThreadPerformSelector:(SEL)selector object:(NSObject *)objectOrNil;
+- (void)onCallingThreadPerformSelector:(SEL)selector object:(NSObject *)objectOrNil waitUntilDone:(BOOL)waitUntilDone;
+- (NSInvocation *)notificationInvocationWithSelector:(SEL)selector object:(NSObject *)objectOrNil;
+- (void)flushPendingNotificationInvocations;
 - (void)updateProgressToValue:(float)progress;
+- (BOOL)emitPartialResult:(id)result;
 - (void)attachError:(NSError *)error;
 
 - (void)notifyStart;
 - (void)notifyRunningWithProgress:(NSNumber *)progress;
 - (void)notifyEnd;
+- (void)notifyTimeout;
+- (void)notifyPartialResult:(id)result;
 - (void)notifySettingReturnInfo:(NSDictionary *)returnInfo;
 - (void)notifySettingError:(NSError *)error;
 
@@ -45,6 +63,22 @@
         self.taskManager = taskManager;
         self.task = task;
         self.callingThread = [NSThread currentThread];
+        _delegateQueue = taskManager.delegateQueue;
+        if (_delegateQueue) {
+            dispatch_retain(_delegateQueue);
+        }
+        _notificationMode = taskManager.notificationMode;
+        if (_notificationMode == HLSTaskNotificationModeAsynchronous) {
+            self.pendingNotificationInvocations = [NSMutableArray array];
+        }
+        _minProgressUpdateInterval = (taskManager.maxProgressUpdateRate != 0) ? 1. / taskManager.maxProgressUpdateRate : 0.;
+        _lastProgressUpdateTime = 0.;
+        _hasPendingProgress = NO;
+        self.partialResultsCondition = [[[NSCondition alloc] init] autorelease];
+        _pendingPartialResultCount = 0;
+        _maxPendingPartialResultCount = taskManager.maxPendingPartialResultCount;
+        self.cancellationToken = [[[HLSCancellationToken alloc] init] autorelease];
+        _deadline = doublegt(task.timeoutInterval, 0.) ? CFAbsoluteTimeGetCurrent() + task.timeoutInterval : 0.;
     }
     return self;
 }
@@ -60,6 +94,12 @@
     self.taskManager = nil;
     self.task = nil;
     self.callingThread = nil;
+    if (_delegateQueue) {
+        dispatch_release(_delegateQueue);
+    }
+    self.pendingNotificationInvocations = nil;
+    self.partialResultsCondition = nil;
+    self.cancellationToken = nil;
     [super dealloc];
 }
 
@@ -72,19 +112,25 @@
 
 @synthesize callingThread = _callingThread;
 
+@synthesize pendingNotificationInvocations = _pendingNotificationInvocations;
+
+@synthesize partialResultsCondition = _partialResultsCondition;
+
+@synthesize cancellationToken = _cancellationToken;
+
 #pragma mark -
 #pragma mark Thread main function
 
 - (void)main
 {
-    // Notify begin
-    [self onCallingThreadPerformSelector:@selector(notifyStart) object:nil];
+    if (! [self beginOperation]) {
+        return;
+    }
     
     // Execute the main method code
     [self operationMain];
     
-    // Notify end
-    [self onCallingThreadPerformSelector:@selector(notifyEnd) object:nil];
+    [self endOperation];
 }
 
 - (void)operationMain
@@ -92,10 +138,121 @@
     HLSMissingMethodImplementation();
 }
 
+#pragma mark -
+#pragma mark Asynchronous operations
+
+- (void)start
+{
+    if (! [self isConcurrent]) {
+        [super start];
+        return;
+    }
+    
+    // Cancelled before it could be started. The task manager has already taken care of the task
+    if ([self isCancelled]) {
+        [self setAsynchronousOperationExecuting:NO finished:YES];
+        return;
+    }
+    
+    [self setAsynchronousOperationExecuting:YES finished:NO];
+    if (! [self beginOperation]) {
+        [self setAsynchronousOperationExecuting:NO finished:YES];
+        return;
+    }
+    
+    // Only starts the work, which calls -finishOperation when done
+    [self operationMain];
+}
+
+- (BOOL)isExecuting
+{
+    return [self isConcurrent] ? _executing : [super isExecuting];
+}
+
+- (BOOL)isFinished
+{
+    return [self isConcurrent] ? _finished : [super isFinished];
+}
+
+- (void)finishOperation
+{
+    if (! [self isConcurrent] || _finished) {
+        HLSLoggerError(@"Only asynchronous operations can be finished, and only once");
+        return;
+    }
+    
+    [self endOperation];
+    [self setAsynchronousOperationExecuting:NO finished:YES];
+}
+
+- (void)setAsynchronousOperationExecuting:(BOOL)executing finished:(BOOL)finished
+{
+    [self willChangeValueForKey:@"isExecuting"];
+    [self willChangeValueForKey:@"isFinished"];
+    _executing = executing;
+    _finished = finished;
+    [self didChangeValueForKey:@"isFinished"];
+    [self didChangeValueForKey:@"isExecuting"];
+}
+
+#pragma mark -
+#pragma mark Notifying the beginning and the end of an operation
+
+// Return NO if the operation must not be performed
+- (BOOL)beginOperation
+{
+    // Drop the task if its deadline has passed before it could be started. The task manager usually does it first, but
+    // its deadline timer cannot fire while the calling thread is busy
+    if (! doubleeq(_deadline, 0.) && CFAbsoluteTimeGetCurrent() >= _deadline) {
+        [self onCallingThreadPerformSelector:@selector(notifyTimeout) object:nil waitUntilDone:YES];
+        [self onCallingThreadPerformSelector:@selector(notifyEnd) object:nil waitUntilDone:YES];
+        return NO;
+    }
+    
+    // Notify begin
+    [self onCallingThreadPerformSelector:@selector(notifyStart) object:nil];
+    return YES;
+}
+
+- (void)endOperation
+{
+    // Deliver the latest progress value which might have been merged, if any
+    if (_hasPendingProgress) {
+        _hasPendingProgress = NO;
+        [self onCallingThreadPerformSelector:@selector(notifyRunningWithProgress:) 
+                                      object:[NSNumber numberWithFloat:_pendingProgress]];
+    }
+    
+    // Notify end. Always wait until the end notification has been processed (even in asynchronous mode), so that the
+    // operation is still executing when the task manager updates its status and cancels strong dependents
+    [self onCallingThreadPerformSelector:@selector(notifyEnd) object:nil waitUntilDone:YES];
+}
+
+#pragma mark -
+#pragma mark Cancellation
+
+- (void)cancel
+{
+    [super cancel];
+    
+    // Wake up a producer waiting for partial results to be delivered. The condition lock is acquired so that the
+    // wake up cannot be missed between the producer checking the cancelled status and waiting
+    [self.partialResultsCondition lock];
+    [self.partialResultsCondition broadcast];
+    [self.partialResultsCondition unlock];
+    
+    [self.cancellationToken cancel];
+}
+
 #pragma mark -
 #pragma mark Executing code on the calling thread
 
 - (void)onCallingThreadPerformSelector:(SEL)selector object:(NSObject *)objectOrNil
+{
+    [self onCallingThreadPerformSelector:selector object:objectOrNil waitUntilDone:NO];
+}
+
+- (void)onCallingThreadPerformSelector:(SEL)selector object:(NSObject *)objectOrNil waitUntilDone:(BOOL)waitUntilDone
 {
     // HUGE WARNING here! If we do not wait until done, we might sometimes (most notably under heavy load) perform selectors
     // on the calling thread, but not in the order they were scheduled. This can be a complete disaster if we perform the
@@ -106,10 +263,65 @@
     //         are "sent" to the calling thread. Most of the time they seem to, but not always. Setting waitUntilDone to YES 
     //         guarantees they will be processed sequentially (of course, since performSelector blocks the thread). IMHO, I would 
     //         have not called this method performSelector:onThread:withObject:waitUntilDone:, 
-    [self performSelector:selector 
-                 onThread:self.callingThread 
-               withObject:objectOrNil
-            waitUntilDone:YES];
+    // The delegate queue is serial, and waiting until done works the same way
+    if (_notificationMode == HLSTaskNotificationModeSynchronous) {
+        if (_delegateQueue) {
+            NSInvocation *invocation = [self notificationInvocationWithSelector:selector object:objectOrNil];
+            [invocation setTarget:self];
+            dispatch_sync_f(_delegateQueue, invocation, performNotificationInvocation);
+        }
+        else {
+            [self performSelector:selector 
+                         onThread:self.callingThread 
+                       withObject:objectOrNil
+                    waitUntilDone:YES];
+        }
+        return;
+    }
+    
+    // In asynchronous mode, the ordering guarantee is obtained differently: Notifications are appended to a FIFO, which
+    // only the calling thread empties, in order. Which flush message reaches the calling thread first does not matter
+    NSInvocation *invocation = [self notificationInvocationWithSelector:selector object:objectOrNil];
+    
+    BOOL first = NO;
+    @synchronized(self.pendingNotificationInvocations) {
+        [self.pendingNotificationInvocations addObject:invocation];
+        first = ([self.pendingNotificationInvocations count] == 1);
+    }
+    
+    // A flush is only scheduled when the FIFO was empty (a flush is already pending otherwise), or when the caller
+    // must wait until everything enqueued so far has been processed
+    if (first || waitUntilDone) {
+        if (_delegateQueue) {
+            // Released by the flush function
+            [self retain];
+            if (waitUntilDone) {
+                dispatch_sync_f(_delegateQueue, self, flushPendingNotificationInvocations);
+            }
+            else {
+                dispatch_async_f(_delegateQueue, self, flushPendingNotificationInvocations);
+            }
+        }
+        else {
+            [self performSelector:@selector(flushPendingNotificationInvocations)
+                         onThread:self.callingThread
+                       withObject:nil
+                    waitUntilDone:waitUntilDone];
+        }
+    }
+}
+
+// Remark: The target is not set (this would create a retain cycle). The invocation is always performed on the operation
+- (NSInvocation *)notificationInvocationWithSelector:(SEL)selector object:(NSObject *)objectOrNil
+{
+    NSMethodSignature *methodSignature = [self methodSignatureForSelector:selector];
+    NSInvocation *invocation = [NSInvocation invocationWithMethodSignature:methodSignature];
+    [invocation setSelector:selector];
+    if (objectOrNil) {
+        [invocation setArgument:&objectOrNil atIndex:2];
+    }
+    [invocation retainArguments];
+    return invocation;
 }
 
 // Remark: Originally, I intended to call this method "setProgress:", but this was a bad idea. It could have conflicted
@@ -117,10 +329,42 @@
 //         since one of my subclasses implemented the ASIProgressDelegate protocol, which declares a setProgress: method)
 - (void)updateProgressToValue:(float)progress
 {
+    // Rate limiting: Merge progress values received too fast, keeping only the latest one. Completion is never merged
+    if (! doubleeq(_minProgressUpdateInterval, 0.) && ! floateq(progress, 1.f)) {
+        CFAbsoluteTime currentTime = CFAbsoluteTimeGetCurrent();
+        if (currentTime - _lastProgressUpdateTime < _minProgressUpdateInterval) {
+            _pendingProgress = progress;
+            _hasPendingProgress = YES;
+            return;
+        }
+        _lastProgressUpdateTime = currentTime;
+    }
+    _hasPendingProgress = NO;
+    
     [self onCallingThreadPerformSelector:@selector(notifyRunningWithProgress:) 
                                   object:[NSNumber numberWithFloat:progress]];
 }
 
+- (BOOL)emitPartialResult:(id)result
+{
+    // Back-pressure: Wait until the number of results waiting for delivery is below the limit (or until the operation
+    // gets cancelled, which signals the condition as well)
+    [self.partialResultsCondition lock];
+    while (_pendingPartialResultCount >= _maxPendingPartialResultCount && ! [self isCancelled]) {
+        [self.partialResultsCondition wait];
+    }
+    if ([self isCancelled]) {
+        [self.partialResultsCondition unlock];
+        return NO;
+    }
+    ++_pendingPartialResultCount;
+    [self.partialResultsCondition unlock];
+    
+    [self onCallingThreadPerformSelector:@selector(notifyPartialResult:) 
+                                  object:result];
+    return YES;
+}
+
 - (void)attachReturnInfo:(NSDictionary *)returnInfo
 {
     [self onCallingThreadPerformSelector:@selector(notifySettingReturnInfo:) 
@@ -136,6 +380,19 @@
 #pragma mark -
 #pragma mark Code to be executed on the calling thread
 
+- (void)flushPendingNotificationInvocations
+{
+    NSArray *invocations = nil;
+    @synchronized(self.pendingNotificationInvocations) {
+        invocations = [NSArray arrayWithArray:self.pendingNotificationInvocations];
+        [self.pendingNotificationInvocations removeAllObjects];
+    }
+    
+    for (NSInvocation *invocation in invocations) {
+        [invocation invokeWithTarget:self];
+    }
+}
+
 - (void)notifyStart
 {
     HLSLoggerDebug(@"Task %@ starts", self.task);
@@ -143,17 +400,10 @@
     // Reset status
     [self.task reset];
     
-    // If part of a non-running task group, first flag the task group as running and notify
-    HLSTaskGroup *taskGroup = self.task.taskGroup;
-    if (taskGroup && ! taskGroup.running) {
-        HLSLoggerDebug(@"Task group %@ starts", taskGroup);
-        
-        taskGroup.running = YES;
-        id<HLSTaskGroupDelegate> taskGroupDelegate = [self.taskManager delegateForTaskGroup:taskGroup];
-        if ([taskGroupDelegate respondsToSelector:@selector(taskGroupHasStartedProcessing:)]) {
-            [taskGroupDelegate taskGroupHasStartedProcessing:taskGroup];
-        }
-    }
+    // If part of non-running task groups, first flag the task groups as running and notify
+    [self.taskManager startTaskGroupsOfTask:self.task];
+    
+    [self.taskManager recordStartForTask:self.task];
     
     // ... then flag the task as running and notify ...
     id<HLSTaskDelegate> taskDelegate = [self.taskManager delegateForTask:self.task];
@@ -166,14 +416,8 @@
         [taskDelegate taskProgressUpdated:self.task];
     }
     
-    // ... and finally update and notify about the task group status
-    if (taskGroup) {
-        [taskGroup updateStatus];
-        id<HLSTaskGroupDelegate> taskGroupDelegate = [self.taskManager delegateForTaskGroup:taskGroup];
-        if ([taskGroupDelegate respondsToSelector:@selector(taskGroupProgressUpdated:)]) {
-            [taskGroupDelegate taskGroupProgressUpdated:taskGroup];
-        }
-    }
+    // ... and finally update and notify about the task groups status
+    [self.taskManager updateTaskGroupsOfTask:self.task];
 }
 
 - (void)notifyRunningWithProgress:(NSNumber *)progress
@@ -185,14 +429,19 @@
         [taskDelegate taskProgressUpdated:self.task];
     }
     
-    // If part of a task group, update and notify about its status as well
+    // If part of a task group, update and notify about its status as well. Several tasks contribute to the task group
+    // progress, which is therefore rate-limited as well (the end of each task always triggers an update)
     HLSTaskGroup *taskGroup = self.task.taskGroup;
     if (taskGroup) {
-        [taskGroup updateStatus];
-        id<HLSTaskGroupDelegate> taskGroupDelegate = [self.taskManager delegateForTaskGroup:taskGroup];
-        if ([taskGroupDelegate respondsToSelector:@selector(taskGroupProgressUpdated:)]) {
-            [taskGroupDelegate taskGroupProgressUpdated:taskGroup];
+        if (! doubleeq(_minProgressUpdateInterval, 0.)) {
+            CFAbsoluteTime currentTime = CFAbsoluteTimeGetCurrent();
+            if (currentTime - taskGroup.lastProgressNotificationTime < _minProgressUpdateInterval) {
+                return;
+            }
+            taskGroup.lastProgressNotificationTime = currentTime;
         }
+        
+        [self.taskManager updateTaskGroupsOfTask:self.task];
     }
 }
 
@@ -203,15 +452,9 @@
     // If part of a task group, first cancel all dependent tasks; a task group is removed once all tasks it contains are
     // marked as finished. Here we are careful enough to cancel all dependent task before the current task is set as 
     // finished. This way the task group is guaranteed to survive the loop below
-    HLSTaskGroup *taskGroup = self.task.taskGroup;
-    if (taskGroup) {
-        // Cancel all tasks strongly depending on the task it not successful
-        if ([self isCancelled] || self.task.error) {
-            NSSet *strongDependents = [taskGroup strongDependentsForTask:self.task];
-            for (HLSTask *dependent in strongDependents) {
-                [self.taskManager cancelTask:dependent];
-            }
-        }
+    if ([self isCancelled] || self.task.error) {
+        // Cancel all members strongly depending on the task (or on the task groups containing it) if not successful
+        [self.taskManager cancelStrongDependentsOfTask:self.task];
     }
     
     // Update the progress to 1.f on success, else do not alter current value (so that the progress value cannot go backwards)
@@ -247,39 +490,33 @@
         }        
     }
     
-    // If part of a task group
-    if (taskGroup) {
-        // Update an notify about the task group progress as well
-        id<HLSTaskGroupDelegate> taskGroupDelegate = [self.taskManager delegateForTaskGroup:taskGroup];
-        [taskGroup updateStatus];
-        if ([taskGroupDelegate respondsToSelector:@selector(taskGroupProgressUpdated:)]) {
-            [taskGroupDelegate taskGroupProgressUpdated:taskGroup];
-        }
-        
-        // If the task group is now complete, update and notify as well
-        if (taskGroup.finished) {
-            taskGroup.running = NO;
-            
-            if (! taskGroup.cancelled) {
-                HLSLoggerDebug(@"Task group %@ ends successfully", taskGroup);
-                if ([taskGroupDelegate respondsToSelector:@selector(taskGroupHasBeenProcessed:)]) {
-                    [taskGroupDelegate taskGroupHasBeenProcessed:taskGroup];
-                }
-            }
-            else {
-                HLSLoggerDebug(@"Task group %@ has been cancelled", taskGroup);
-                if ([taskGroupDelegate respondsToSelector:@selector(taskGroupHasBeenCancelled:)]) {
-                    [taskGroupDelegate taskGroupHasBeenCancelled:taskGroup];
-                }
-            }
-        }
-    }
+    // If part of task groups, update and notify about their progress (and end) as well
+    [self.taskManager updateTaskGroupsOfTask:self.task];
     
     // Only the operation itself knows when it is done and can unregister itself from the manager it was
     // executed from
     [self.taskManager unregisterOperation:self];
 }
 
+- (void)notifyTimeout
+{
+    [self.taskManager timeOutTask:self.task];
+}
+
+- (void)notifyPartialResult:(id)result
+{
+    // Make room for a new result first, so that the operation can produce the next one while this one is consumed
+    [self.partialResultsCondition lock];
+    --_pendingPartialResultCount;
+    [self.partialResultsCondition signal];
+    [self.partialResultsCondition unlock];
+    
+    id<HLSTaskDelegate> taskDelegate = [self.taskManager delegateForTask:self.task];
+    if ([taskDelegate respondsToSelector:@selector(task:didProduceResult:)]) {
+        [taskDelegate task:self.task didProduceResult:result];
+    }
+}
+
 - (void)notifySettingReturnInfo:(NSDictionary *)returnInfo
 {
     self.task.returnInfo = returnInfo;
@@ -287,7 +524,30 @@
 
 - (void)notifySettingError:(NSError *)error
 {
+    // The timeout error takes precedence over errors attached by the operation when it stops
+    if (self.task.timedOut) {
+        return;
+    }
+    
     self.task.error = error;
 }
 
 @end
+
+#pragma mark -
+#pragma mark Static functions
+
+static void performNotificationInvocation(void *context)
+{
+    NSInvocation *invocation = (NSInvocation *)context;
+    [invocation invoke];
+}
+
+static void flushPendingNotificationInvocations(void *context)
+{
+    NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+    HLSTaskOperation *operation = (HLSTaskOperation *)context;
+    [operation flushPendingNotificationInvocations];
+    [operation release];
+    [pool drain];
+}
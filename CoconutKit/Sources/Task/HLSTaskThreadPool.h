@@ -0,0 +1,62 @@
+//
+//  HLSTaskThreadPool.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSTask.h"
+
+/**
+ * Private class for implementation purposes. A pool of threads shared by several clients (task managers, see
+ * -[HLSTaskManager usingSharedThreadPool]), which processes at most size operations at the same time, and at most
+ * a given number of operations for each client (its quota).
+ *
+ * Operations are only handed over to the threads once they are ready (i.e. when all their dependencies have finished)
+ * and a thread is available. Clients are then served in turn (fair share), each one receiving its ready operation
+ * with the highest queue priority (the first one submitted if several have the same priority). Cancelled operations
+ * are handed over immediately, since they finish without doing anything.
+ *
+ * This class is thread-safe. Its bookkeeping is performed on a private serial queue
+ *
+ * Not meant to be instantiated directly. Simply use the +sharedThreadPoolForExecutionClass: class method.
+ */
+@interface HLSTaskThreadPool : NSObject {
+@private
+    NSOperationQueue *_operationQueue;
+    dispatch_queue_t _schedulingQueue;
+    NSMutableArray *_clients;                                   // Clients in fair share order
+    CFMutableDictionaryRef _operationToClientMap;               // Maps a submitted operation to its client
+    NSUInteger _nextClientIndex;
+    NSUInteger _dispatchedOperationCount;
+    NSUInteger _size;
+}
+
+/**
+ * The pool shared by all clients for tasks of a given execution class
+ */
++ (HLSTaskThreadPool *)sharedThreadPoolForExecutionClass:(HLSTaskExecutionClass)executionClass;
+
+/**
+ * Return a new token identifying a client. A client must create its token once and keep it as long as it lives
+ */
++ (id)clientToken;
+
+/**
+ * Maximum number of operations processed at the same time by the pool. Default values are:
+ *   - HLSTaskExecutionClassDefault and HLSTaskExecutionClassCPU: As many as there are active processors (at least 2)
+ *   - HLSTaskExecutionClassIO: 8 (I/O-bound operations mostly wait)
+ * Changing the size does not interrupt operations already being processed
+ */
+@property (nonatomic, assign) NSUInteger size;
+
+/**
+ * Submit an operation on behalf of the client identified by the given token (see +clientToken), which cannot have more 
+ * than maxConcurrentOperationCount operations processed at the same time. The most recent count supplied by a client 
+ * is applied to all its operations. The token is retained as long as the client has operations in the pool, so that 
+ * another client cannot be mistaken for it (as could happen with the address of a deallocated object)
+ */
+- (void)addOperation:(NSOperation *)operation forClientToken:(id)clientToken maxConcurrentOperationCount:(NSUInteger)maxConcurrentOperationCount;
+
+@end
@@ -0,0 +1,372 @@
+//
+//  HLSTaskThreadPool.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSTaskThreadPool.h"
+
+#import "HLSAssert.h"
+#import "HLSLogger.h"
+
+// Context used to observe operations
+static void *s_operationObservationContext = &s_operationObservationContext;
+
+/**
+ * Operations submitted by a client which have not finished yet
+ */
+@interface HLSTaskThreadPoolClient : NSObject {
+@public
+    id _clientToken;                                // Retained, see +[HLSTaskThreadPool clientToken]
+    NSMutableArray *_pendingOperations;             // Operations not handed over to the threads yet, in submission order
+    NSUInteger _dispatchedOperationCount;
+    NSUInteger _maxConcurrentOperationCount;
+}
+
+@end
+
+/**
+ * Parameters of an operation submission or end, processed on the scheduling queue
+ */
+typedef struct {
+    HLSTaskThreadPool *threadPool;
+    NSOperation *operation;                         // Retained
+    id clientToken;                                 // Retained
+    NSUInteger maxConcurrentOperationCount;
+} HLSTaskThreadPoolOperationContext;
+
+// Function declarations
+static void prepareThreadPools(void *context);
+static HLSTaskThreadPoolOperationContext *createOperationContext(HLSTaskThreadPool *threadPool, NSOperation *operation);
+static void submitOperation(void *context);
+static void finishOperation(void *context);
+static void scheduleOperations(void *context);
+
+@interface HLSTaskThreadPool ()
+
+- (id)initWithSize:(NSUInteger)size label:(const char *)label;
+
+- (void)submitOperation:(NSOperation *)operation forClientToken:(id)clientToken maxConcurrentOperationCount:(NSUInteger)maxConcurrentOperationCount;
+- (void)finishOperation:(NSOperation *)operation;
+- (void)scheduleOperations;
+- (NSOperation *)nextOperationForClient:(HLSTaskThreadPoolClient *)client cancelledOnly:(BOOL)cancelledOnly;
+
+@end
+
+@implementation HLSTaskThreadPool
+
+#pragma mark Class methods
+
++ (HLSTaskThreadPool *)sharedThreadPoolForExecutionClass:(HLSTaskExecutionClass)executionClass
+{
+    static HLSTaskThreadPool *s_threadPools[HLSTaskExecutionClassEnumSize];
+    
+    static dispatch_once_t s_onceToken;
+    dispatch_once_f(&s_onceToken, s_threadPools, prepareThreadPools);
+    
+    if (executionClass >= HLSTaskExecutionClassEnumEnd) {
+        HLSLoggerError(@"Invalid execution class");
+        return nil;
+    }
+    
+    return s_threadPools[executionClass];
+}
+
++ (id)clientToken
+{
+    return [[[NSObject alloc] init] autorelease];
+}
+
+#pragma mark Object creation and destruction
+
+- (id)initWithSize:(NSUInteger)size label:(const char *)label
+{
+    if ((self = [super init])) {
+        // Never more operations than the pool size are handed over to the queue, they therefore start immediately
+        _operationQueue = [[NSOperationQueue alloc] init];
+        [_operationQueue setMaxConcurrentOperationCount:NSIntegerMax];
+        _schedulingQueue = dispatch_queue_create(label, NULL);
+        _clients = [[NSMutableArray alloc] init];
+        _operationToClientMap = CFDictionaryCreateMutable(NULL, 0, NULL, NULL);
+        _size = size;
+    }
+    return self;
+}
+
+- (id)init
+{
+    HLSForbiddenInheritedMethod();
+    return nil;
+}
+
+- (void)dealloc
+{
+    // Shared instances are never deallocated
+    [_operationQueue release];
+    _operationQueue = nil;
+    
+    dispatch_release(_schedulingQueue);
+    _schedulingQueue = NULL;
+    
+    [_clients release];
+    _clients = nil;
+    
+    CFRelease(_operationToClientMap);
+    _operationToClientMap = NULL;
+    
+    [super dealloc];
+}
+
+#pragma mark Accessors and mutators
+
+@synthesize size = _size;
+
+- (void)setSize:(NSUInteger)size
+{
+    if (size == 0) {
+        HLSLoggerError(@"The size of a thread pool must be at least 1; value not changed");
+        return;
+    }
+    
+    _size = size;
+    
+    // Threads might have become available
+    dispatch_async_f(_schedulingQueue, self, scheduleOperations);
+}
+
+#pragma mark Submitting operations
+
+- (void)addOperation:(NSOperation *)operation forClientToken:(id)clientToken maxConcurrentOperationCount:(NSUInteger)maxConcurrentOperationCount
+{
+    if (! operation || ! clientToken) {
+        HLSLoggerError(@"Missing operation or client token");
+        return;
+    }
+    
+    if (maxConcurrentOperationCount == 0) {
+        HLSLoggerError(@"The maximum number of concurrent operations must be at least 1");
+        return;
+    }
+    
+    // Readiness changes when dependencies (possibly processed by other pools) finish, or when the operation is cancelled
+    [operation addObserver:self forKeyPath:@"isReady" options:0 context:s_operationObservationContext];
+    [operation addObserver:self forKeyPath:@"isCancelled" options:0 context:s_operationObservationContext];
+    [operation addObserver:self forKeyPath:@"isFinished" options:0 context:s_operationObservationContext];
+    
+    HLSTaskThreadPoolOperationContext *operationContext = createOperationContext(self, operation);
+    operationContext->clientToken = [clientToken retain];
+    operationContext->maxConcurrentOperationCount = maxConcurrentOperationCount;
+    dispatch_async_f(_schedulingQueue, operationContext, submitOperation);
+}
+
+#pragma mark Scheduling (on the scheduling queue only)
+
+- (void)submitOperation:(NSOperation *)operation forClientToken:(id)clientToken maxConcurrentOperationCount:(NSUInteger)maxConcurrentOperationCount
+{
+    HLSTaskThreadPoolClient *threadPoolClient = nil;
+    for (HLSTaskThreadPoolClient *existingThreadPoolClient in _clients) {
+        if (existingThreadPoolClient->_clientToken == clientToken) {
+            threadPoolClient = existingThreadPoolClient;
+            break;
+        }
+    }
+    
+    if (! threadPoolClient) {
+        threadPoolClient = [[[HLSTaskThreadPoolClient alloc] init] autorelease];
+        threadPoolClient->_clientToken = [clientToken retain];
+        [_clients addObject:threadPoolClient];
+    }
+    threadPoolClient->_maxConcurrentOperationCount = maxConcurrentOperationCount;
+    
+    [threadPoolClient->_pendingOperations addObject:operation];
+    CFDictionarySetValue(_operationToClientMap, operation, threadPoolClient);
+    
+    [self scheduleOperations];
+}
+
+- (void)finishOperation:(NSOperation *)operation
+{
+    HLSTaskThreadPoolClient *threadPoolClient = (HLSTaskThreadPoolClient *)CFDictionaryGetValue(_operationToClientMap, operation);
+    if (! threadPoolClient) {
+        return;
+    }
+    CFDictionaryRemoveValue(_operationToClientMap, operation);
+    
+    [operation removeObserver:self forKeyPath:@"isReady"];
+    [operation removeObserver:self forKeyPath:@"isCancelled"];
+    [operation removeObserver:self forKeyPath:@"isFinished"];
+    
+    --threadPoolClient->_dispatchedOperationCount;
+    --_dispatchedOperationCount;
+    
+    // Forget about clients without operations
+    if (threadPoolClient->_dispatchedOperationCount == 0 && [threadPoolClient->_pendingOperations count] == 0) {
+        NSUInteger clientIndex = [_clients indexOfObjectIdenticalTo:threadPoolClient];
+        if (clientIndex < _nextClientIndex) {
+            --_nextClientIndex;
+        }
+        [_clients removeObjectAtIndex:clientIndex];
+    }
+    
+    [self scheduleOperations];
+}
+
+- (void)scheduleOperations
+{
+    while ([_clients count] != 0) {
+        // When no thread is available or a client has reached its quota, only cancelled operations (which finish
+        // immediately) can still be handed over
+        BOOL threadAvailable = (_dispatchedOperationCount < _size);
+    
+        // Serve clients in turn, starting with the one after the client served last
+        NSOperation *operation = nil;
+        HLSTaskThreadPoolClient *threadPoolClient = nil;
+        NSUInteger clientCount = [_clients count];
+        for (NSUInteger i = 0; i < clientCount; ++i) {
+            NSUInteger clientIndex = (_nextClientIndex + i) % clientCount;
+            threadPoolClient = [_clients objectAtIndex:clientIndex];
+            BOOL cancelledOnly = ! threadAvailable
+                || threadPoolClient->_dispatchedOperationCount >= threadPoolClient->_maxConcurrentOperationCount;
+            operation = [self nextOperationForClient:threadPoolClient cancelledOnly:cancelledOnly];
+            if (operation) {
+                _nextClientIndex = (clientIndex + 1) % clientCount;
+                break;
+            }
+        }
+    
+        if (! operation) {
+            break;
+        }
+    
+        [threadPoolClient->_pendingOperations removeObjectIdenticalTo:operation];
+        ++threadPoolClient->_dispatchedOperationCount;
+        ++_dispatchedOperationCount;
+        [_operationQueue addOperation:operation];
+    }
+}
+
+- (NSOperation *)nextOperationForClient:(HLSTaskThreadPoolClient *)threadPoolClient cancelledOnly:(BOOL)cancelledOnly
+{
+    NSOperation *nextOperation = nil;
+    for (NSOperation *operation in threadPoolClient->_pendingOperations) {
+        if ([operation isCancelled]) {
+            return operation;
+        }
+    
+        if (cancelledOnly || ! [operation isReady]) {
+            continue;
+        }
+    
+        // Same priority: Keep submission order
+        if (! nextOperation || [operation queuePriority] > [nextOperation queuePriority]) {
+            nextOperation = operation;
+        }
+    }
+    return nextOperation;
+}
+
+#pragma mark Key-value observing
+
+- (void)observeValueForKeyPath:(NSString *)keyPath ofObject:(id)object change:(NSDictionary *)change context:(void *)context
+{
+    if (context != s_operationObservationContext) {
+        [super observeValueForKeyPath:keyPath ofObject:object change:change context:context];
+        return;
+    }
+    
+    // Received on any thread. Never wait for the scheduling queue here
+    if ([keyPath isEqualToString:@"isFinished"]) {
+        if ([object isFinished]) {
+            dispatch_async_f(_schedulingQueue, createOperationContext(self, object), finishOperation);
+        }
+    }
+    else {
+        dispatch_async_f(_schedulingQueue, self, scheduleOperations);
+    }
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; size: %u>",
+            [self class],
+            self,
+            self.size];
+}
+
+@end
+
+@implementation HLSTaskThreadPoolClient
+
+#pragma mark Object creation and destruction
+
+- (id)init
+{
+    if ((self = [super init])) {
+        _pendingOperations = [[NSMutableArray alloc] init];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [_clientToken release];
+    _clientToken = nil;
+    
+    [_pendingOperations release];
+    _pendingOperations = nil;
+    
+    [super dealloc];
+}
+
+@end
+
+#pragma mark Static functions
+
+static void prepareThreadPools(void *context)
+{
+    HLSTaskThreadPool **threadPools = (HLSTaskThreadPool **)context;
+    NSUInteger processorCount = MAX([[NSProcessInfo processInfo] activeProcessorCount], 2);
+    threadPools[HLSTaskExecutionClassDefault] = [[HLSTaskThreadPool alloc] initWithSize:processorCount
+                                                                                   label:"ch.hortis.CoconutKit.HLSTaskThreadPool.default"];
+    threadPools[HLSTaskExecutionClassCPU] = [[HLSTaskThreadPool alloc] initWithSize:processorCount
+                                                                               label:"ch.hortis.CoconutKit.HLSTaskThreadPool.cpu"];
+    threadPools[HLSTaskExecutionClassIO] = [[HLSTaskThreadPool alloc] initWithSize:8
+                                                                              label:"ch.hortis.CoconutKit.HLSTaskThreadPool.io"];
+}
+
+static HLSTaskThreadPoolOperationContext *createOperationContext(HLSTaskThreadPool *threadPool, NSOperation *operation)
+{
+    HLSTaskThreadPoolOperationContext *operationContext = (HLSTaskThreadPoolOperationContext *)calloc(1, sizeof(HLSTaskThreadPoolOperationContext));
+    operationContext->threadPool = threadPool;
+    operationContext->operation = [operation retain];
+    return operationContext;
+}
+
+static void submitOperation(void *context)
+{
+    HLSTaskThreadPoolOperationContext *operationContext = (HLSTaskThreadPoolOperationContext *)context;
+    [operationContext->threadPool submitOperation:operationContext->operation
+                                   forClientToken:operationContext->clientToken
+                      maxConcurrentOperationCount:operationContext->maxConcurrentOperationCount];
+    [operationContext->operation release];
+    [operationContext->clientToken release];
+    free(operationContext);
+}
+
+static void finishOperation(void *context)
+{
+    HLSTaskThreadPoolOperationContext *operationContext = (HLSTaskThreadPoolOperationContext *)context;
+    [operationContext->threadPool finishOperation:operationContext->operation];
+    [operationContext->operation release];
+    free(operationContext);
+}
+
+static void scheduleOperations(void *context)
+{
+    HLSTaskThreadPool *threadPool = (HLSTaskThreadPool *)context;
+    [threadPool scheduleOperations];
+}
@@ -0,0 +1,78 @@
+//
+//  HLSTaskThrottlingPolicy.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSTask.h"
+
+/**
+ * Decides how much of its concurrency a task manager uses depending on the conditions the device is in (see
+ * -[HLSTaskManager throttlingPolicy]). Running long jobs at full concurrency while the application is in the 
+ * background or while the battery is low drains the battery and gets the application throttled or suspended by 
+ * the system. A lower, but predictable throughput is preferable.
+ *
+ * The default policy reduces concurrency when the application is in the background, or when the device is running
+ * on a low battery. In both cases, deferrable tasks (see -[HLSTask deferrable]) are not started until conditions
+ * improve. Deferrable tasks are processed with a lower thread priority as well.
+ *
+ * You can subclass HLSTaskThrottlingPolicy to implement another policy. Policies are evaluated when the application
+ * state or the battery state changes. If your policy depends on other conditions, call -[HLSTaskManager updateThrottling] 
+ * when they change
+ *
+ * Designated initializer: -init
+ */
+@interface HLSTaskThrottlingPolicy : NSObject {
+@private
+    float _lowBatteryLevel;
+    float _backgroundConcurrencyFactor;
+    float _lowBatteryConcurrencyFactor;
+}
+
+/**
+ * Battery level (between 0.f and 1.f) below which the battery is considered low when the device is not charging.
+ * Default value is 0.2f
+ */
+@property (nonatomic, assign) float lowBatteryLevel;
+
+/**
+ * Fraction of the maximum number of concurrent tasks (see -[HLSTaskManager setMaxConcurrentTaskCount:forExecutionClass:])
+ * used when the application is in the background, resp. when the battery is low (both are multiplied if both apply). At
+ * least one task is always processed. Default values are 0.5f
+ */
+@property (nonatomic, assign) float backgroundConcurrencyFactor;
+@property (nonatomic, assign) float lowBatteryConcurrencyFactor;
+
+/**
+ * Return YES iff the application is currently in the background
+ */
+- (BOOL)isApplicationInBackground;
+
+/**
+ * Return YES iff the device is not charging and its battery level is below lowBatteryLevel
+ */
+- (BOOL)isBatteryLow;
+
+/**
+ * Fraction (between 0.f and 1.f) of the maximum number of concurrent tasks of the given execution class a task manager 
+ * currently uses
+ * Can be overridden
+ */
+- (float)concurrencyFactorForExecutionClass:(HLSTaskExecutionClass)executionClass;
+
+/**
+ * Return YES if deferrable tasks must currently not be started. By default, YES in the background or on low battery
+ * Can be overridden
+ */
+- (BOOL)shouldDeferTasks;
+
+/**
+ * The thread priority (between 0. and 1., see -[NSOperation threadPriority]) with which a task is processed. Evaluated
+ * when the task is submitted. By default, 0.25 for deferrable tasks, 0.5 (the system default) otherwise
+ * Can be overridden
+ */
+- (double)threadPriorityForTask:(HLSTask *)task;
+
+@end
@@ -0,0 +1,117 @@
+//
+//  HLSTaskThrottlingPolicy.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSTaskThrottlingPolicy.h"
+
+#import "HLSConverters.h"
+#import "HLSFloat.h"
+#import "HLSLogger.h"
+
+@implementation HLSTaskThrottlingPolicy
+
+#pragma mark -
+#pragma mark Object creation and destruction
+
+- (id)init
+{
+    if ((self = [super init])) {
+        self.lowBatteryLevel = 0.2f;
+        self.backgroundConcurrencyFactor = 0.5f;
+        self.lowBatteryConcurrencyFactor = 0.5f;
+    }
+    return self;
+}
+
+#pragma mark -
+#pragma mark Accessors and mutators
+
+@synthesize lowBatteryLevel = _lowBatteryLevel;
+
+@synthesize backgroundConcurrencyFactor = _backgroundConcurrencyFactor;
+
+- (void)setBackgroundConcurrencyFactor:(float)backgroundConcurrencyFactor
+{
+    if (floatlt(backgroundConcurrencyFactor, 0.f) || floatgt(backgroundConcurrencyFactor, 1.f)) {
+        HLSLoggerError(@"The concurrency factor must be between 0 and 1; value not changed");
+        return;
+    }
+    
+    _backgroundConcurrencyFactor = backgroundConcurrencyFactor;
+}
+
+@synthesize lowBatteryConcurrencyFactor = _lowBatteryConcurrencyFactor;
+
+- (void)setLowBatteryConcurrencyFactor:(float)lowBatteryConcurrencyFactor
+{
+    if (floatlt(lowBatteryConcurrencyFactor, 0.f) || floatgt(lowBatteryConcurrencyFactor, 1.f)) {
+        HLSLoggerError(@"The concurrency factor must be between 0 and 1; value not changed");
+        return;
+    }
+    
+    _lowBatteryConcurrencyFactor = lowBatteryConcurrencyFactor;
+}
+
+#pragma mark -
+#pragma mark Conditions
+
+- (BOOL)isApplicationInBackground
+{
+    return [[UIApplication sharedApplication] applicationState] == UIApplicationStateBackground;
+}
+
+- (BOOL)isBatteryLow
+{
+    // When battery monitoring is disabled, the state is unknown and the level is -1.f
+    UIDevice *device = [UIDevice currentDevice];
+    if ([device batteryState] != UIDeviceBatteryStateUnplugged) {
+        return NO;
+    }
+    
+    float batteryLevel = [device batteryLevel];
+    return floatge(batteryLevel, 0.f) && floatlt(batteryLevel, self.lowBatteryLevel);
+}
+
+#pragma mark -
+#pragma mark Policy
+
+- (float)concurrencyFactorForExecutionClass:(HLSTaskExecutionClass)executionClass
+{
+    float concurrencyFactor = 1.f;
+    if ([self isApplicationInBackground]) {
+        concurrencyFactor *= self.backgroundConcurrencyFactor;
+    }
+    if ([self isBatteryLow]) {
+        concurrencyFactor *= self.lowBatteryConcurrencyFactor;
+    }
+    return concurrencyFactor;
+}
+
+- (BOOL)shouldDeferTasks
+{
+    return [self isApplicationInBackground] || [self isBatteryLow];
+}
+
+- (double)threadPriorityForTask:(HLSTask *)task
+{
+    return task.deferrable ? 0.25 : 0.5;
+}
+
+#pragma mark -
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; applicationInBackground: %@; batteryLow: %@; shouldDeferTasks: %@>", 
+            [self class],
+            self,
+            HLSStringFromBool([self isApplicationInBackground]),
+            HLSStringFromBool([self isBatteryLow]),
+            HLSStringFromBool([self shouldDeferTasks])];
+}
+
+@end
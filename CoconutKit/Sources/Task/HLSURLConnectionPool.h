@@ -0,0 +1,59 @@
+//
+//  HLSURLConnectionPool.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+@class HLSURLTaskOperation;
+
+/**
+ * Private class for implementation purposes. Schedules the connections of all HLSURLTaskOperation objects on
+ * a single network thread, whose run loop delivers connection events. No other thread is therefore blocked while
+ * waiting for data, however many connections are open.
+ *
+ * At most maxConnectionCountPerHost connections are open with a given host at the same time. Further operations
+ * wait for a connection to the same host to end. This keeps the number of simultaneous connections low enough for
+ * the URL loading system to reuse persistent (keep-alive) connections with each host.
+ *
+ * This class is thread-safe.
+ *
+ * Not meant to be instantiated directly. Simply use the +sharedConnectionPool class method.
+ */
+@interface HLSURLConnectionPool : NSObject {
+@private
+    NSThread *_networkThread;
+    NSMutableDictionary *_hostToPendingOperationsMap;       // Maps a host to the NSMutableArray of operations waiting for a connection
+    NSMutableDictionary *_hostToConnectedOperationsMap;     // Maps a host to the NSMutableSet of operations having a connection open with it
+    NSUInteger _maxConnectionCountPerHost;
+}
+
+/**
+ * The pool shared by all URL task operations
+ */
++ (HLSURLConnectionPool *)sharedConnectionPool;
+
+/**
+ * Maximum number of connections open with a host at the same time. Default value is 4
+ */
+@property (nonatomic, assign) NSUInteger maxConnectionCountPerHost;
+
+/**
+ * The thread on which connections are scheduled
+ */
+@property (nonatomic, readonly, retain) NSThread *networkThread;
+
+/**
+ * Ask for a connection to the host of the operation request. The operation is sent -startConnection on the network
+ * thread as soon as the per-host limit allows it. The operation is retained until -removeOperation: is called
+ */
+- (void)addOperation:(HLSURLTaskOperation *)operation;
+
+/**
+ * Must be called exactly once for each operation which has been added, when it does not need its connection
+ * anymore (whether it was started or not)
+ */
+- (void)removeOperation:(HLSURLTaskOperation *)operation;
+
+@end
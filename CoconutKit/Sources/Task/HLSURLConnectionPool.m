@@ -0,0 +1,204 @@
+//
+//  HLSURLConnectionPool.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSURLConnectionPool.h"
+
+#import "HLSAssert.h"
+#import "HLSLogger.h"
+#import "HLSURLTask.h"
+#import "HLSURLTaskOperation.h"
+
+// Function declarations
+static void prepareConnectionPool(void *context);
+static NSString *hostForOperation(HLSURLTaskOperation *operation);
+
+@interface HLSURLConnectionPool ()
+
+- (void)networkThreadMain:(id)object;
+- (void)startConnectionsForHost:(NSString *)host;
+
+@end
+
+@implementation HLSURLConnectionPool
+
+#pragma mark Class methods
+
++ (HLSURLConnectionPool *)sharedConnectionPool
+{
+    static HLSURLConnectionPool *s_connectionPool = nil;
+    
+    static dispatch_once_t s_onceToken;
+    dispatch_once_f(&s_onceToken, &s_connectionPool, prepareConnectionPool);
+    
+    return s_connectionPool;
+}
+
+#pragma mark Object creation and destruction
+
+- (id)init
+{
+    if ((self = [super init])) {
+        _hostToPendingOperationsMap = [[NSMutableDictionary alloc] init];
+        _hostToConnectedOperationsMap = [[NSMutableDictionary alloc] init];
+        _maxConnectionCountPerHost = 4;
+    
+        _networkThread = [[NSThread alloc] initWithTarget:self selector:@selector(networkThreadMain:) object:nil];
+        [_networkThread setName:@"ch.hortis.CoconutKit.HLSURLConnectionPool"];
+        [_networkThread start];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    // The shared instance is never deallocated
+    [_networkThread release];
+    _networkThread = nil;
+    
+    [_hostToPendingOperationsMap release];
+    _hostToPendingOperationsMap = nil;
+    
+    [_hostToConnectedOperationsMap release];
+    _hostToConnectedOperationsMap = nil;
+    
+    [super dealloc];
+}
+
+#pragma mark Accessors and mutators
+
+@synthesize networkThread = _networkThread;
+
+- (NSUInteger)maxConnectionCountPerHost
+{
+    @synchronized(self) {
+        return _maxConnectionCountPerHost;
+    }
+}
+
+- (void)setMaxConnectionCountPerHost:(NSUInteger)maxConnectionCountPerHost
+{
+    if (maxConnectionCountPerHost == 0) {
+        HLSLoggerError(@"At least one connection per host is required; value not changed");
+        return;
+    }
+    
+    @synchronized(self) {
+        _maxConnectionCountPerHost = maxConnectionCountPerHost;
+    
+        // Connections might have become available
+        for (NSString *host in [_hostToPendingOperationsMap allKeys]) {
+            [self startConnectionsForHost:host];
+        }
+    }
+}
+
+#pragma mark Network thread
+
+- (void)networkThreadMain:(id)object
+{
+    NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+    
+    // A port keeps the run loop alive when no connection is scheduled
+    NSRunLoop *runLoop = [NSRunLoop currentRunLoop];
+    [runLoop addPort:[NSMachPort port] forMode:NSDefaultRunLoopMode];
+    
+    while (YES) {
+        NSAutoreleasePool *runLoopPool = [[NSAutoreleasePool alloc] init];
+        [runLoop runMode:NSDefaultRunLoopMode beforeDate:[NSDate distantFuture]];
+        [runLoopPool drain];
+    }
+    
+    [pool drain];
+}
+
+#pragma mark Connections
+
+- (void)addOperation:(HLSURLTaskOperation *)operation
+{
+    NSString *host = hostForOperation(operation);
+    @synchronized(self) {
+        NSMutableArray *pendingOperations = [_hostToPendingOperationsMap objectForKey:host];
+        if (! pendingOperations) {
+            pendingOperations = [NSMutableArray array];
+            [_hostToPendingOperationsMap setObject:pendingOperations forKey:host];
+        }
+        [pendingOperations addObject:operation];
+    
+        [self startConnectionsForHost:host];
+    }
+}
+
+- (void)removeOperation:(HLSURLTaskOperation *)operation
+{
+    NSString *host = hostForOperation(operation);
+    @synchronized(self) {
+        // Keep the operation alive until the end of the method
+        [[operation retain] autorelease];
+    
+        NSMutableArray *pendingOperations = [_hostToPendingOperationsMap objectForKey:host];
+        [pendingOperations removeObjectIdenticalTo:operation];
+        if ([pendingOperations count] == 0) {
+            [_hostToPendingOperationsMap removeObjectForKey:host];
+        }
+    
+        NSMutableSet *connectedOperations = [_hostToConnectedOperationsMap objectForKey:host];
+        [connectedOperations removeObject:operation];
+        if ([connectedOperations count] == 0) {
+            [_hostToConnectedOperationsMap removeObjectForKey:host];
+        }
+    
+        [self startConnectionsForHost:host];
+    }
+}
+
+// Must be called from a synchronized block
+- (void)startConnectionsForHost:(NSString *)host
+{
+    NSMutableArray *pendingOperations = [_hostToPendingOperationsMap objectForKey:host];
+    while ([pendingOperations count] != 0) {
+        NSMutableSet *connectedOperations = [_hostToConnectedOperationsMap objectForKey:host];
+        if ([connectedOperations count] >= _maxConnectionCountPerHost) {
+            break;
+        }
+    
+        if (! connectedOperations) {
+            connectedOperations = [NSMutableSet set];
+            [_hostToConnectedOperationsMap setObject:connectedOperations forKey:host];
+        }
+    
+        HLSURLTaskOperation *operation = [pendingOperations objectAtIndex:0];
+        [connectedOperations addObject:operation];
+        [operation performSelector:@selector(startConnection)
+                          onThread:_networkThread
+                        withObject:nil
+                     waitUntilDone:NO];
+        [pendingOperations removeObjectAtIndex:0];
+    }
+    
+    if (pendingOperations && [pendingOperations count] == 0) {
+        [_hostToPendingOperationsMap removeObjectForKey:host];
+    }
+}
+
+@end
+
+#pragma mark Static functions
+
+static void prepareConnectionPool(void *context)
+{
+    HLSURLConnectionPool **pConnectionPool = (HLSURLConnectionPool **)context;
+    *pConnectionPool = [[HLSURLConnectionPool alloc] init];
+}
+
+static NSString *hostForOperation(HLSURLTaskOperation *operation)
+{
+    // Requests without host (e.g. file URLs) share a single key
+    HLSURLTask *URLTask = (HLSURLTask *)operation.task;
+    NSString *host = [[URLTask.request URL] host];
+    return host ? [host lowercaseString] : @"";
+}
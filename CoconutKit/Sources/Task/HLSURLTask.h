@@ -0,0 +1,88 @@
+//
+//  HLSURLTask.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSFileManager.h"
+#import "HLSTask.h"
+
+/**
+ * Error codes
+ */
+extern NSString * const HLSURLTaskErrorDomain;
+
+typedef enum {
+    HLSURLTaskErrorEnumBegin = 0,
+    HLSURLTaskErrorHTTPStatus = HLSURLTaskErrorEnumBegin,                   // The server replied with an HTTP error status (>= 400)
+    HLSURLTaskErrorFileWrite,                                               // The download file could not be written
+    HLSURLTaskErrorEnumEnd,
+    HLSURLTaskErrorEnumSize = HLSURLTaskErrorEnumEnd - HLSURLTaskErrorEnumBegin
+} HLSURLTaskError;
+
+/**
+ * Keys of the returnInfo dictionary of a URL task
+ */
+extern NSString * const HLSURLTaskResponseKey;                              // The NSURLResponse received
+extern NSString * const HLSURLTaskDataKey;                                  // The NSData received (absent if downloaded to a file)
+
+/**
+ * A task loading the contents of a URL request. Unlike an operation performing a synchronous request, a URL task
+ * does not block a thread while waiting for data: Connections of all URL tasks are scheduled on a single network
+ * thread, and their task manager slot is released as soon as the connection ends. Raising the maximum number of 
+ * concurrent HLSTaskExecutionClassIO tasks of a task manager (see -[HLSTaskManager setMaxConcurrentTaskCount:forExecutionClass:])
+ * is therefore cheap when most of them are URL tasks.
+ *
+ * At most +maxConnectionCountPerHost connections are open with the same host at any time, whichever task manager
+ * the tasks were submitted to. Further tasks wait for a connection with their host to end. This way persistent 
+ * (keep-alive) connections can be reused by the URL loading system, instead of opening many connections with the
+ * same host. While connections are open, the network activity indicator is displayed (see HLSNotificationManager).
+ *
+ * The data received is either returned in memory (HLSURLTaskDataKey) or streamed to a file (see downloadFilePath).
+ * The response must have an HTTP status lower than 400, otherwise an HLSURLTaskErrorHTTPStatus error is attached 
+ * to the task. If the download file cannot be written, an HLSURLTaskErrorFileWrite error is attached to the task (the
+ * file manager must support streaming writes, see -[HLSFileManager outputStreamToFileAtPath:append:]). Connection errors
+ * are attached as they are received from the URL loading system.
+ *
+ * URL task delegates are notified from the network thread. Prefer the HLSTaskNotificationModeAsynchronous mode
+ * of HLSTaskManager, so that connections are not delayed while the calling thread processes notifications.
+ *
+ * URL tasks cannot be journaled, and default to the HLSTaskExecutionClassIO execution class.
+ *
+ * Designated initializer: -initWithRequest:
+ */
+@interface HLSURLTask : HLSTask {
+@private
+    NSURLRequest *_request;
+    NSString *_downloadFilePath;
+    HLSFileManager *_fileManager;
+}
+
+/**
+ * Maximum number of connections open with a host at the same time, for all URL tasks. Default value is 4
+ */
++ (NSUInteger)maxConnectionCountPerHost;
++ (void)setMaxConnectionCountPerHost:(NSUInteger)maxConnectionCountPerHost;
+
+/**
+ * Create a task loading the specified request
+ */
+- (id)initWithRequest:(NSURLRequest *)request;
+
+@property (nonatomic, readonly, retain) NSURLRequest *request;
+
+/**
+ * If set, the data received is written to the file at the given path (replacing its previous contents) as it is
+ * received, rather than being kept in memory. Must not be changed while the task is running
+ */
+@property (nonatomic, retain) NSString *downloadFilePath;
+
+/**
+ * The file manager used to write the downloaded file. Default is [HLSFileManager defaultManager]. Cannot be set
+ * to nil, and must not be changed while the task is running
+ */
+@property (nonatomic, retain) HLSFileManager *fileManager;
+
+@end
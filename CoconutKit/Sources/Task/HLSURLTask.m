@@ -0,0 +1,118 @@
+//
+//  HLSURLTask.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSURLTask.h"
+
+#import "HLSAssert.h"
+#import "HLSLogger.h"
+#import "HLSURLConnectionPool.h"
+#import "HLSURLTaskOperation.h"
+
+NSString * const HLSURLTaskErrorDomain = @"ch.hortis.CoconutKit.URLTask";
+
+NSString * const HLSURLTaskResponseKey = @"HLSURLTaskResponse";
+NSString * const HLSURLTaskDataKey = @"HLSURLTaskData";
+
+@interface HLSURLTask ()
+
+@property (nonatomic, retain) NSURLRequest *request;
+
+@end
+
+@implementation HLSURLTask
+
+#pragma mark -
+#pragma mark Class methods
+
++ (NSUInteger)maxConnectionCountPerHost
+{
+    return [[HLSURLConnectionPool sharedConnectionPool] maxConnectionCountPerHost];
+}
+
++ (void)setMaxConnectionCountPerHost:(NSUInteger)maxConnectionCountPerHost
+{
+    [[HLSURLConnectionPool sharedConnectionPool] setMaxConnectionCountPerHost:maxConnectionCountPerHost];
+}
+
+#pragma mark -
+#pragma mark Object creation and destruction
+
+- (id)initWithRequest:(NSURLRequest *)request
+{
+    if ((self = [super init])) {
+        if (! request) {
+            HLSLoggerError(@"Missing request");
+            [self release];
+            return nil;
+        }
+    
+        self.request = request;
+        self.fileManager = [HLSFileManager defaultManager];
+        self.executionClass = HLSTaskExecutionClassIO;
+    }
+    return self;
+}
+
+- (id)init
+{
+    HLSForbiddenInheritedMethod();
+    return nil;
+}
+
+- (void)dealloc
+{
+    self.request = nil;
+    self.downloadFilePath = nil;
+    
+    // The setter does not accept nil
+    [_fileManager release];
+    _fileManager = nil;
+    
+    [super dealloc];
+}
+
+#pragma mark -
+#pragma mark Accessors and mutators
+
+- (Class)operationClass
+{
+    return [HLSURLTaskOperation class];
+}
+
+@synthesize request = _request;
+
+@synthesize downloadFilePath = _downloadFilePath;
+
+@synthesize fileManager = _fileManager;
+
+- (void)setFileManager:(HLSFileManager *)fileManager
+{
+    if (_fileManager == fileManager) {
+        return;
+    }
+    
+    if (! fileManager) {
+        HLSLoggerWarn(@"A file manager is mandatory");
+        return;
+    }
+    
+    [_fileManager release];
+    _fileManager = [fileManager retain];
+}
+
+- (void)setJournaled:(BOOL)journaled
+{
+    if (journaled) {
+        HLSLoggerError(@"URL tasks cannot be journaled");
+        return;
+    }
+    
+    [super setJournaled:journaled];
+}
+
+@end
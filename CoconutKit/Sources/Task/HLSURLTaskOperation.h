@@ -0,0 +1,30 @@
+//
+//  HLSURLTaskOperation.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSTaskOperation.h"
+
+/**
+ * Operation processing an HLSURLTask. This operation is asynchronous: Its connection is scheduled on the network 
+ * thread of the shared HLSURLConnectionPool, on which all connection events are received
+ */
+@interface HLSURLTaskOperation : HLSTaskOperation {
+@private
+    NSURLConnection *_connection;
+    NSOutputStream *_outputStream;
+    NSMutableData *_data;
+    NSURLResponse *_response;
+    long long _receivedContentLength;
+    BOOL _connectionEnded;
+}
+
+/**
+ * Open the connection. Sent on the network thread by the connection pool
+ */
+- (void)startConnection;
+
+@end
@@ -0,0 +1,254 @@
+//
+//  HLSURLTaskOperation.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSURLTaskOperation.h"
+
+#import "HLSError.h"
+#import "HLSLogger.h"
+#import "HLSNotifications.h"
+#import "HLSTaskOperation+Protected.h"
+#import "HLSURLConnectionPool.h"
+#import "HLSURLTask.h"
+#import "NSBundle+HLSExtensions.h"
+
+@interface HLSURLTaskOperation ()
+
+@property (nonatomic, retain) NSURLConnection *connection;
+@property (nonatomic, retain) NSOutputStream *outputStream;
+@property (nonatomic, retain) NSMutableData *data;
+@property (nonatomic, retain) NSURLResponse *response;
+
+- (void)cancelConnection;
+- (void)endConnectionWithError:(NSError *)error;
+- (BOOL)openOutputStream;
+- (BOOL)writeData:(NSData *)data;
+- (NSError *)fileWriteError;
+
+@end
+
+@implementation HLSURLTaskOperation
+
+#pragma mark -
+#pragma mark Object creation and destruction
+
+- (void)dealloc
+{
+    self.connection = nil;
+    self.outputStream = nil;
+    self.data = nil;
+    self.response = nil;
+    [super dealloc];
+}
+
+#pragma mark -
+#pragma mark Accessors and mutators
+
+@synthesize connection = _connection;
+
+@synthesize outputStream = _outputStream;
+
+@synthesize data = _data;
+
+@synthesize response = _response;
+
+#pragma mark -
+#pragma mark Thread main function
+
+- (BOOL)isConcurrent
+{
+    return YES;
+}
+
+- (void)operationMain
+{
+    // Wait for a connection with the host. Cancellation is registered afterwards, so that the operation is known to
+    // the pool when it is removed from it
+    [[HLSURLConnectionPool sharedConnectionPool] addOperation:self];
+    [[self cancellationToken] addCancellationAction:@selector(cancelConnection) onTarget:self];
+}
+
+#pragma mark -
+#pragma mark Connection (on the network thread)
+
+- (void)startConnection
+{
+    // Cancelled while waiting for the connection
+    if (_connectionEnded) {
+        return;
+    }
+    
+    HLSURLTask *URLTask = (HLSURLTask *)self.task;
+    if (URLTask.downloadFilePath) {
+        if (! [self openOutputStream]) {
+            [self endConnectionWithError:[self fileWriteError]];
+            return;
+        }
+    }
+    else {
+        self.data = [NSMutableData data];
+    }
+    
+    self.connection = [[[NSURLConnection alloc] initWithRequest:URLTask.request delegate:self startImmediately:NO] autorelease];
+    [self.connection scheduleInRunLoop:[NSRunLoop currentRunLoop] forMode:NSDefaultRunLoopMode];
+    [self.connection start];
+    
+    [[HLSNotificationManager sharedNotificationManager] notifyBeginNetworkActivity];
+}
+
+- (void)cancelConnection
+{
+    // Cancellation actions are performed on the thread cancelling the operation
+    if ([NSThread currentThread] != [[HLSURLConnectionPool sharedConnectionPool] networkThread]) {
+        [self performSelector:@selector(cancelConnection)
+                     onThread:[[HLSURLConnectionPool sharedConnectionPool] networkThread]
+                   withObject:nil
+                waitUntilDone:NO];
+        return;
+    }
+    
+    [self endConnectionWithError:nil];
+}
+
+- (void)endConnectionWithError:(NSError *)error
+{
+    if (_connectionEnded) {
+        return;
+    }
+    _connectionEnded = YES;
+    
+    if (self.connection) {
+        [self.connection cancel];
+        self.connection = nil;
+        [[HLSNotificationManager sharedNotificationManager] notifyEndNetworkActivity];
+    }
+    
+    [self.outputStream close];
+    self.outputStream = nil;
+    
+    // The response and the data are returned even if an HTTP error status has been received
+    if (! [self isCancelled]) {
+        NSMutableDictionary *returnInfo = [NSMutableDictionary dictionary];
+        if (self.response) {
+            [returnInfo setObject:self.response forKey:HLSURLTaskResponseKey];
+        }
+        if (self.data) {
+            [returnInfo setObject:self.data forKey:HLSURLTaskDataKey];
+        }
+        [self attachReturnInfo:[NSDictionary dictionaryWithDictionary:returnInfo]];
+    }
+    if (error) {
+        [self attachError:error];
+    }
+    self.data = nil;
+    self.response = nil;
+    
+    [[HLSURLConnectionPool sharedConnectionPool] removeOperation:self];
+    [self finishOperation];
+}
+
+// Open the output stream to the download file, replacing its contents
+- (BOOL)openOutputStream
+{
+    HLSURLTask *URLTask = (HLSURLTask *)self.task;
+    [self.outputStream close];
+    self.outputStream = [URLTask.fileManager outputStreamToFileAtPath:URLTask.downloadFilePath append:NO];
+    [self.outputStream open];
+    if (! self.outputStream || [self.outputStream streamStatus] == NSStreamStatusError) {
+        HLSLoggerError(@"Cannot write to file %@", URLTask.downloadFilePath);
+        return NO;
+    }
+    return YES;
+}
+
+- (BOOL)writeData:(NSData *)data
+{
+    const uint8_t *bytes = [data bytes];
+    NSUInteger length = [data length];
+    while (length != 0) {
+        NSInteger writtenLength = [self.outputStream write:bytes maxLength:length];
+        if (writtenLength <= 0) {
+            return NO;
+        }
+        bytes += writtenLength;
+        length -= writtenLength;
+    }
+    return YES;
+}
+
+- (NSError *)fileWriteError
+{
+    HLSError *error = [HLSError errorWithDomain:HLSURLTaskErrorDomain
+                                           code:HLSURLTaskErrorFileWrite
+                           localizedDescription:NSLocalizedStringFromTableInBundle(@"The file could not be written", @"Localizable", [NSBundle coconutKitBundle], @"The file could not be written")];
+    [error setObject:((HLSURLTask *)self.task).downloadFilePath forKey:NSFilePathErrorKey];
+    if ([self.outputStream streamError]) {
+        [error setUnderlyingError:[self.outputStream streamError]];
+    }
+    return error;
+}
+
+#pragma mark -
+#pragma mark NSURLConnectionDelegate protocol implementation
+
+- (void)connection:(NSURLConnection *)connection didReceiveResponse:(NSURLResponse *)response
+{
+    self.response = response;
+    
+    // A new response (e.g. after a redirect or an authentication challenge) replaces everything received so far
+    if (self.outputStream) {
+        if (_receivedContentLength != 0 && ! [self openOutputStream]) {
+            [self endConnectionWithError:[self fileWriteError]];
+            return;
+        }
+    }
+    else {
+        [self.data setLength:0];
+    }
+    _receivedContentLength = 0;
+}
+
+- (void)connection:(NSURLConnection *)connection didReceiveData:(NSData *)data
+{
+    if (self.outputStream) {
+        if (! [self writeData:data]) {
+            HLSLoggerError(@"Cannot write to file %@", ((HLSURLTask *)self.task).downloadFilePath);
+            [self endConnectionWithError:[self fileWriteError]];
+            return;
+        }
+    }
+    else {
+        [self.data appendData:data];
+    }
+    
+    _receivedContentLength += [data length];
+    long long expectedContentLength = [self.response expectedContentLength];
+    if (expectedContentLength > 0) {
+        [self updateProgressToValue:MIN((float)_receivedContentLength / expectedContentLength, 1.f)];
+    }
+}
+
+- (void)connection:(NSURLConnection *)connection didFailWithError:(NSError *)error
+{
+    [self endConnectionWithError:error];
+}
+
+- (void)connectionDidFinishLoading:(NSURLConnection *)connection
+{
+    NSError *error = nil;
+    if ([self.response isKindOfClass:[NSHTTPURLResponse class]]) {
+        NSInteger statusCode = [(NSHTTPURLResponse *)self.response statusCode];
+        if (statusCode >= 400) {
+            error = [HLSError errorWithDomain:HLSURLTaskErrorDomain
+                                         code:HLSURLTaskErrorHTTPStatus
+                         localizedDescription:[NSHTTPURLResponse localizedStringForStatusCode:statusCode]];
+        }
+    }
+    [self endConnectionWithError:error];
+}
+
+@end
@@ -41,6 +41,7 @@
 @private
     NSArray *m_elementWrapperViews;
     NSArray *m_elementWrapperViewSizeValues;
+    CGRect *m_elementWrapperViewFrames;
     UIView *m_pointerView;
     UIView *m_pointerContainerView;
     CGSize m_pointerViewTopLeftOffset;
@@ -12,8 +12,8 @@
 #import "HLSFloat.h"
 #import "HLSLogger.h"
 #import "HLSViewAnimationStep.h"
-#import "NSArray+HLSExtensions.h"
 #import "NSBundle+HLSExtensions.h"
+#import "NSString+HLSExtensions.h"
 #import "UIView+HLSExtensions.h"
 
 @interface HLSCursor ()
@@ -26,6 +26,8 @@
 @property (nonatomic, retain) UIView *pointerContainerView;
 
 - (UIView *)elementViewForIndex:(NSUInteger)index selected:(BOOL)selected;
+- (UIFont *)fontAtIndex:(NSUInteger)index selected:(BOOL)selected;
+- (UILabel *)elementLabelForIndex:(NSUInteger)index title:(NSString *)title font:(UIFont *)font size:(CGSize)size selected:(BOOL)selected;
 - (UIView *)elementWrapperViewForIndex:(NSUInteger)index;
 
 - (CGFloat)xPosForIndex:(NSUInteger)index;
@@ -64,6 +66,7 @@
 {
     self.elementWrapperViews = nil;
     self.elementWrapperViewSizeValues = nil;
+    free(m_elementWrapperViewFrames);
     
     // Very special case here. Cannot use the property since it cannot change the pointer view once set!
     [m_pointerView release];
@@ -118,26 +121,31 @@
     // Create subviews views lazily the first time they are needed; not doing this in init allows clients to customize
     // the views before they are displayed
     if (! m_viewsCreated) {
-        // Create the subview set
-        self.elementWrapperViews = [NSArray array];
-        self.elementWrapperViewSizeValues = [NSArray array];
-        
         // Check the data source
         NSUInteger nbrElements = [self.dataSource numberOfElementsForCursor:self];
         if (nbrElements == 0) {
+            self.elementWrapperViews = [NSArray array];
+            self.elementWrapperViewSizeValues = [NSArray array];
             HLSLoggerError(@"Cursor data source is empty");
             return;
         }
         
         // Fill with views generated from the data source
+        NSMutableArray *elementWrapperViews = [NSMutableArray arrayWithCapacity:nbrElements];
+        NSMutableArray *elementWrapperViewSizeValues = [NSMutableArray arrayWithCapacity:nbrElements];
         for (NSInteger index = 0; index < nbrElements; ++index) {
             UIView *elementWrapperView = [self elementWrapperViewForIndex:index];
+            if (! elementWrapperView) {
+                continue;
+            }
             [self addSubview:elementWrapperView];
-            self.elementWrapperViews = [self.elementWrapperViews arrayByAddingObject:elementWrapperView];
+            [elementWrapperViews addObject:elementWrapperView];
             
             // The original size needs to be saved separately (since views are not created again)
-            self.elementWrapperViewSizeValues = [self.elementWrapperViewSizeValues arrayByAddingObject:[NSValue valueWithCGSize:elementWrapperView.frame.size]];
+            [elementWrapperViewSizeValues addObject:[NSValue valueWithCGSize:elementWrapperView.frame.size]];
         }
+        self.elementWrapperViews = [NSArray arrayWithArray:elementWrapperViews];
+        self.elementWrapperViewSizeValues = [NSArray arrayWithArray:elementWrapperViewSizeValues];
     }
     
     // Calculate the needed total size to display all elements
@@ -170,7 +178,12 @@
         heightScaleFactor = CGRectGetHeight(self.frame) / requiredHeight;
     }
     
-    // Adjust individual frames so that the element views are centered within the available frame
+    // Adjust individual frames so that the element views are centered within the available frame. Frames are also
+    // saved in a plain array, sorted from left to right, which touch events can binary search without having to query
+    // the views
+    free(m_elementWrapperViewFrames);
+    m_elementWrapperViewFrames = (CGRect *)malloc([self.elementWrapperViews count] * sizeof(CGRect));
+    
     CGFloat xPos = floatmax(-self.pointerViewTopLeftOffset.width, 0.f);
     NSUInteger i = 0;
     for (UIView *elementWrapperView in self.elementWrapperViews) {
@@ -182,6 +195,7 @@
                                               widthScaleFactor * elementWrapperViewSize.width,
                                               heightScaleFactor * elementWrapperViewSize.height);
         xPos += CGRectGetWidth(elementWrapperView.frame) + m_spacing;
+        m_elementWrapperViewFrames[i] = elementWrapperView.frame;
         
         ++i;
     }
@@ -227,88 +241,96 @@
 
 - (UIView *)elementViewForIndex:(NSUInteger)index selected:(BOOL)selected
 {
-    // First check if a custom view is used
+    // Only custom views are retrieved one state at a time. Label-based elements are created for both states at once
+    // by -elementWrapperViewForIndex:, which avoids asking the data source for the same information several times
     if ([self.dataSource respondsToSelector:@selector(cursor:viewAtIndex:selected:)]) {
-        // The size must accomodate both the selected and non-selected versions of an element view (i.e. be the largest).
-        // To avoid changing the frame of the views we receive, we simply find the rectangle in which both versions fit,
-        // then we create a view with this size and we put the view we receive at its center.
         UIView *elementView = [self.dataSource cursor:self viewAtIndex:index selected:selected];
         if (elementView) {
             return elementView;
         }
     }
+    return nil;
+}
+
+- (UIFont *)fontAtIndex:(NSUInteger)index selected:(BOOL)selected
+{
+    // Font. If not defined by the data source, use standard font
+    UIFont *font = nil;
+    if ([self.dataSource respondsToSelector:@selector(cursor:fontAtIndex:selected:)]) {
+        font = [self.dataSource cursor:self fontAtIndex:index selected:selected];
+    }
+    if (! font) {
+        font = [UIFont systemFontOfSize:17.f];
+    }
+    return font;
+}
+
+- (UILabel *)elementLabelForIndex:(NSUInteger)index title:(NSString *)title font:(UIFont *)font size:(CGSize)size selected:(BOOL)selected
+{
+    // Text color. If not defined by the data source, use standard colors
+    UIColor *textColor = nil;
+    if ([self.dataSource respondsToSelector:@selector(cursor:textColorAtIndex:selected:)]) {
+        textColor = [self.dataSource cursor:self textColorAtIndex:index selected:selected];
+    }
+    if (! textColor) {
+        textColor = selected ? [UIColor blackColor] : [UIColor grayColor];
+    }
+    
+    // Shadow color. If not defined by the data source, none
+    UIColor *shadowColor = nil;
+    if ([self.dataSource respondsToSelector:@selector(cursor:shadowColorAtIndex:selected:)]) {
+        shadowColor = [self.dataSource cursor:self shadowColorAtIndex:index selected:selected];
+    }
+    
+    // Shadow offset. If not defined, default value (CGSizeMake(0, -1), see UILabel documentation)
+    CGSize shadowOffset = kCursorShadowOffsetDefault;
+    if ([self.dataSource respondsToSelector:@selector(cursor:shadowOffsetAtIndex:selected:)]) {
+        shadowOffset = [self.dataSource cursor:self shadowOffsetAtIndex:index selected:selected];
+    }
+    
+    UILabel *elementLabel = [[[UILabel alloc] initWithFrame:CGRectMake(0.f, 0.f, size.width, size.height)] autorelease];
+    elementLabel.text = title;
+    elementLabel.backgroundColor = [UIColor clearColor];
+    elementLabel.font = font;
+    elementLabel.textColor = textColor;
+    elementLabel.shadowColor = shadowColor;
+    elementLabel.shadowOffset = shadowOffset;
+    elementLabel.textAlignment = UITextAlignmentCenter;
+    elementLabel.autoresizingMask = HLSViewAutoresizingAll;
+    
+    return elementLabel;
+}
+
+- (UIView *)elementWrapperViewForIndex:(NSUInteger)index
+{
+    // First check if custom views are used
+    UIView *elementView = [self elementViewForIndex:index selected:NO];
+    UIView *selectedElementView = [self elementViewForIndex:index selected:YES];
     
     // Check if a bare label is used
-    if ([self.dataSource respondsToSelector:@selector(cursor:titleAtIndex:)]) {
-        // Title
+    if ((! elementView || ! selectedElementView) && [self.dataSource respondsToSelector:@selector(cursor:titleAtIndex:)]) {
         NSString *title = [self.dataSource cursor:self titleAtIndex:index];
         if ([title length] == 0) {
             HLSLoggerWarn(@"Empty title string at index %d", index);
         }
         
-        // Font. If not defined by the data source, use standard font
-        UIFont *font = nil;
-        UIFont *otherFont = nil;
-        if ([self.dataSource respondsToSelector:@selector(cursor:fontAtIndex:selected:)]) {
-            font = [self.dataSource cursor:self fontAtIndex:index selected:selected];
-            otherFont = [self.dataSource cursor:self fontAtIndex:index selected:! selected];
-        }
-        if (! font) {
-            font = [UIFont systemFontOfSize:17.f];
-        }
-        
-        // Text color. If not defined by the data source, use standard colors
-        UIColor *textColor = nil;
-        if ([self.dataSource respondsToSelector:@selector(cursor:textColorAtIndex:selected:)]) {
-            textColor = [self.dataSource cursor:self textColorAtIndex:index selected:selected];
-        }
-        if (! textColor) {
-            textColor = selected ? [UIColor blackColor] : [UIColor grayColor];
-        }
+        // Create labels with appropriate size. The size must accomodate both the font sizes for selected and non-selected
+        // states
+        UIFont *font = [self fontAtIndex:index selected:NO];
+        UIFont *selectedFont = [self fontAtIndex:index selected:YES];
+        CGSize titleSize = [title cachedSizeWithFont:font];
+        CGSize selectedTitleSize = [title cachedSizeWithFont:selectedFont];
+        CGSize labelSize = CGSizeMake(floatmax(titleSize.width, selectedTitleSize.width), 
+                                      floatmax(titleSize.height, selectedTitleSize.height));
         
-        // Shadow color. If not defined by the data source, none
-        UIColor *shadowColor = nil;
-        if ([self.dataSource respondsToSelector:@selector(cursor:shadowColorAtIndex:selected:)]) {
-            shadowColor = [self.dataSource cursor:self shadowColorAtIndex:index selected:selected];
+        if (! elementView) {
+            elementView = [self elementLabelForIndex:index title:title font:font size:labelSize selected:NO];
         }
-        
-        // Shadow offset. If not defined, default value (CGSizeMake(0, -1), see UILabel documentation)
-        CGSize shadowOffset = kCursorShadowOffsetDefault;
-        if ([self.dataSource respondsToSelector:@selector(cursor:shadowOffsetAtIndex:selected:)]) {
-            shadowOffset = [self.dataSource cursor:self shadowOffsetAtIndex:index selected:selected];
+        if (! selectedElementView) {
+            selectedElementView = [self elementLabelForIndex:index title:title font:selectedFont size:labelSize selected:YES];
         }
-        
-        // Create a label with appropriate size. The size must accomodate both the font sizes for selected and non-selected
-        // states
-        CGSize titleSize = [title sizeWithFont:font];
-        CGSize otherTitleSize = [title sizeWithFont:otherFont];
-        UILabel *elementLabel = [[[UILabel alloc] initWithFrame:CGRectMake(0.f,
-                                                                           0.f,
-                                                                           floatmax(titleSize.width, otherTitleSize.width),
-                                                                           floatmax(titleSize.height, otherTitleSize.height))]
-                                 autorelease];
-        elementLabel.text = title;
-        elementLabel.backgroundColor = [UIColor clearColor];
-        elementLabel.font = font;
-        elementLabel.textColor = textColor;
-        elementLabel.shadowColor = shadowColor;
-        elementLabel.shadowOffset = shadowOffset;
-        elementLabel.textAlignment = UITextAlignmentCenter;
-        elementLabel.autoresizingMask = HLSViewAutoresizingAll;
-        
-        return elementLabel;
     }
     
-    // Incorrect data source implementation
-    HLSLoggerError(@"Cursor data source must either implement cursor:viewAtIndex: or cursor:titleAtIndex:");
-    return nil;
-}
-
-- (UIView *)elementWrapperViewForIndex:(NSUInteger)index
-{
-    UIView *elementView = [self elementViewForIndex:index selected:NO];
-    UIView *selectedElementView = [self elementViewForIndex:index selected:YES];
-    
     if (! elementView || ! selectedElementView) {
         // Incorrect data source implementation
         HLSLoggerError(@"Cursor data source must either implement cursor:viewAtIndex: or cursor:titleAtIndex:");
@@ -395,29 +417,33 @@
         return 0.f;
     }
     
-    UIView *elementWrapperView = [self.elementWrapperViews objectAtIndex:index];
-    return elementWrapperView.center.x;
+    return CGRectGetMidX(m_elementWrapperViewFrames[index]);
 }
 
 - (NSUInteger)indexForXPos:(CGFloat)xPos
 {
-    NSUInteger index = 0;
-    for (UIView *elementWrapperView in self.elementWrapperViews) {
-        if (floatge(xPos, CGRectGetMinX(elementWrapperView.frame) - m_spacing / 2.f)
-            && floatle(xPos, CGRectGetMinX(elementWrapperView.frame) + CGRectGetWidth(elementWrapperView.frame) + m_spacing / 2.f)) {
-            return index;
-        }
-        ++index;
-    }
-    
-    // No match found; return leftmost or rightmost element view
-    UIView *firstElementWrapperView = [self.elementWrapperViews firstObject_hls];
-    if (floatlt(xPos, CGRectGetMinX(firstElementWrapperView.frame) - m_spacing / 2.f)) {
+    // Element views are laid out from left to right. Binary search for the first one whose right edge (including half 
+    // of the spacing) is not on the left of xPos. This is called for each touch move while dragging, and must remain
+    // fast for cursors with many elements
+    if ([self.elementWrapperViews count] == 0) {
         return 0;
     }
-    else {
-        return [self.elementWrapperViews count] - 1;
+    
+    NSUInteger lowerIndex = 0;
+    NSUInteger upperIndex = [self.elementWrapperViews count];
+    while (lowerIndex < upperIndex) {
+        NSUInteger index = (lowerIndex + upperIndex) / 2;
+        if (floatlt(CGRectGetMaxX(m_elementWrapperViewFrames[index]) + m_spacing / 2.f, xPos)) {
+            lowerIndex = index + 1;
+        }
+        else {
+            upperIndex = index;
+        }
     }
+    
+    // Too far on the right: Return the rightmost element view. Otherwise the element found is the leftmost one if 
+    // too far on the left, else the element view under xPos
+    return MIN(lowerIndex, [self.elementWrapperViews count] - 1);
 }
 
 - (CGRect)pointerFrameForIndex:(NSUInteger)index
@@ -429,36 +455,46 @@
 // xPos is here where the pointer is located, i.e. the center of the pointer rectangle
 - (CGRect)pointerFrameForXPos:(CGFloat)xPos
 {
-    // Find the index of the element view whose x center coordinate is the first >= xPos along the x axis
+    // Find the index of the element view whose x center coordinate is the first >= xPos along the x axis (binary search,
+    // centers are sorted from left to right)
+    NSUInteger count = [self.elementWrapperViews count];
+    if (count == 0) {
+        return CGRectZero;
+    }
+    
     NSUInteger index = 0;
-    for (UIView *elementWrapperView in self.elementWrapperViews) {
-        if (floatle(xPos, elementWrapperView.center.x)) {
-            break;
+    NSUInteger upperIndex = count;
+    while (index < upperIndex) {
+        NSUInteger middleIndex = (index + upperIndex) / 2;
+        if (floatle(xPos, CGRectGetMidX(m_elementWrapperViewFrames[middleIndex]))) {
+            upperIndex = middleIndex;
+        }
+        else {
+            index = middleIndex + 1;
         }
-        ++index;
     }
     
     // Too far on the left; cursor around the first view
     CGRect pointerRect;
     if (index == 0) {
-        UIView *firstElementWrapperView = [self.elementWrapperViews firstObject_hls];
-        pointerRect = firstElementWrapperView.frame;
+        pointerRect = m_elementWrapperViewFrames[0];
     }
     // Too far on the right; cursor around the last view
-    else if (index == [self.elementWrapperViews count]) {
-        UIView *lastElementWrapperView = [self.elementWrapperViews lastObject];
-        pointerRect = lastElementWrapperView.frame;
+    else if (index == count) {
+        pointerRect = m_elementWrapperViewFrames[count - 1];
     }
     // Cursor in between views with indices index-1 and index. Interpolate
     else {
-        UIView *previousElementWrapperView = [self.elementWrapperViews objectAtIndex:index - 1];
-        UIView *nextElementWrapperView = [self.elementWrapperViews objectAtIndex:index];
+        CGRect previousFrame = m_elementWrapperViewFrames[index - 1];
+        CGRect nextFrame = m_elementWrapperViewFrames[index];
+        CGFloat previousCenterX = CGRectGetMidX(previousFrame);
+        CGFloat nextCenterX = CGRectGetMidX(nextFrame);
         
         // Linear interpolation
-        CGFloat width = ((xPos - nextElementWrapperView.center.x) * CGRectGetWidth(previousElementWrapperView.frame)
-                         + (previousElementWrapperView.center.x - xPos) * CGRectGetWidth(nextElementWrapperView.frame)) / (previousElementWrapperView.center.x - nextElementWrapperView.center.x);
-        CGFloat height = ((xPos - nextElementWrapperView.center.x) * CGRectGetHeight(previousElementWrapperView.frame)
-                          + (previousElementWrapperView.center.x - xPos) * CGRectGetHeight(nextElementWrapperView.frame)) / (previousElementWrapperView.center.x - nextElementWrapperView.center.x);
+        CGFloat width = ((xPos - nextCenterX) * CGRectGetWidth(previousFrame)
+                         + (previousCenterX - xPos) * CGRectGetWidth(nextFrame)) / (previousCenterX - nextCenterX);
+        CGFloat height = ((xPos - nextCenterX) * CGRectGetHeight(previousFrame)
+                          + (previousCenterX - xPos) * CGRectGetHeight(nextFrame)) / (previousCenterX - nextCenterX);
         
         pointerRect = CGRectMake(xPos - width / 2.f,
                                  (CGRectGetHeight(self.frame) - height) / 2.f,
@@ -492,6 +528,9 @@
     self.elementWrapperViews = nil;
     self.elementWrapperViewSizeValues = nil;
     
+    free(m_elementWrapperViewFrames);
+    m_elementWrapperViewFrames = NULL;
+    
     [self.pointerContainerView removeFromSuperview];
     self.pointerContainerView = nil;
     
@@ -42,6 +42,11 @@ typedef enum {
     BOOL m_layoutDone;
     BOOL m_expanded;
     BOOL m_animating;
+    HLSAnimation *m_expansionAnimation;
+    HLSAnimation *m_collapseAnimation;
+    CGSize m_animationSize;
+    CGSize m_laidOutSize;
+    BOOL m_laidOutExpanded;
 }
 
 /**
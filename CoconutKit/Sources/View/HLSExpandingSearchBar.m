@@ -22,8 +22,14 @@ static const CGFloat kSearchBarStandardHeight = 44.f;
 
 @property (nonatomic, retain) UISearchBar *searchBar;
 @property (nonatomic, retain) UIButton *searchButton;
+@property (nonatomic, retain) HLSAnimation *expansionAnimation;
+@property (nonatomic, retain) HLSAnimation *collapseAnimation;
 
-- (HLSAnimation *)expansionAnimation;
+- (CGRect)collapsedFrame;
+- (CGRect)expandedSearchBarFrame;
+- (CGRect)expandedSearchButtonFrame;
+
+- (void)updateAnimationsIfNeeded;
 
 - (void)toggleSearchBar:(id)sender;
 
@@ -53,6 +59,8 @@ static const CGFloat kSearchBarStandardHeight = 44.f;
 {
     self.searchBar = nil;
     self.searchButton = nil;
+    self.expansionAnimation = nil;
+    self.collapseAnimation = nil;
     self.delegate = nil;
 
     [super dealloc];
@@ -195,6 +203,10 @@ static const CGFloat kSearchBarStandardHeight = 44.f;
 
 @synthesize searchButton = m_searchButton;
 
+@synthesize expansionAnimation = m_expansionAnimation;
+
+@synthesize collapseAnimation = m_collapseAnimation;
+
 @synthesize alignment = m_alignment;
 
 - (void)setAlignment:(HLSExpandingSearchBarAlignment)alignment
@@ -211,6 +223,35 @@ static const CGFloat kSearchBarStandardHeight = 44.f;
 
 #pragma mark Layout
 
+- (CGRect)collapsedFrame
+{
+    if (self.alignment == HLSExpandingSearchBarAlignmentLeft) {
+        return [self expandedSearchButtonFrame];
+    }
+    else {
+        return CGRectMake(CGRectGetWidth(self.bounds) - kSearchBarStandardHeight,
+                          roundf((CGRectGetHeight(self.frame) - kSearchBarStandardHeight) / 2.f),
+                          kSearchBarStandardHeight,
+                          kSearchBarStandardHeight);
+    }
+}
+
+- (CGRect)expandedSearchBarFrame
+{
+    return CGRectMake(0.f,
+                      roundf((CGRectGetHeight(self.frame) - kSearchBarStandardHeight) / 2.f),
+                      CGRectGetWidth(self.bounds),
+                      kSearchBarStandardHeight);
+}
+
+- (CGRect)expandedSearchButtonFrame
+{
+    return CGRectMake(0.f,
+                      roundf((CGRectGetHeight(self.frame) - kSearchBarStandardHeight) / 2.f),
+                      kSearchBarStandardHeight,
+                      kSearchBarStandardHeight);
+}
+
 - (void)layoutSubviews
 {
     if (self.autoresizingMask & UIViewAutoresizingFlexibleHeight) {
@@ -218,31 +259,22 @@ static const CGFloat kSearchBarStandardHeight = 44.f;
         self.autoresizingMask &= ~UIViewAutoresizingFlexibleHeight;
     }
     
-    // TODO: Factor out collapsed frame creation code
-    if (! m_animating) {
-        if (self.alignment == HLSExpandingSearchBarAlignmentLeft || m_expanded) {
-            self.searchButton.frame = CGRectMake(0.f,
-                                                 roundf((CGRectGetHeight(self.frame) - kSearchBarStandardHeight) / 2.f),
-                                                 kSearchBarStandardHeight,
-                                                 kSearchBarStandardHeight);
-        }
-        else {
-            self.searchButton.frame = CGRectMake(CGRectGetWidth(self.bounds) - kSearchBarStandardHeight,
-                                                 roundf((CGRectGetHeight(self.frame) - kSearchBarStandardHeight) / 2.f),
-                                                 kSearchBarStandardHeight,
-                                                 kSearchBarStandardHeight);
-        }
-        
+    // Frames only need to be calculated again when the geometry or the expansion status has changed since the
+    // last layout
+    if (! m_animating
+            && (! m_layoutDone || ! CGSizeEqualToSize(self.bounds.size, m_laidOutSize) || m_expanded != m_laidOutExpanded)) {
         if (m_expanded) {
+            self.searchButton.frame = [self expandedSearchButtonFrame];
             self.searchBar.alpha = 1.f;
-            self.searchBar.frame = CGRectMake(0.f,
-                                              roundf((CGRectGetHeight(self.frame) - kSearchBarStandardHeight) / 2.f),
-                                              CGRectGetWidth(self.bounds),
-                                              kSearchBarStandardHeight);
+            self.searchBar.frame = [self expandedSearchBarFrame];
         }
         else {
+            self.searchButton.frame = [self collapsedFrame];
             self.searchBar.frame = self.searchButton.frame;
         }
+        
+        m_laidOutSize = self.bounds.size;
+        m_laidOutExpanded = m_expanded;
     }
     
     // Notify initial status
@@ -260,10 +292,15 @@ static const CGFloat kSearchBarStandardHeight = 44.f;
 
 #pragma mark Animation
 
-// We do not cache the animation: The source and target frames can vary depending on rotations. We
-// therefore need a way to generate the animation easily when we need it
-- (HLSAnimation *)expansionAnimation
+// The source and target frames vary with the search bar size (e.g. when the device is rotated). The animations are
+// therefore cached for a given size, and built again only when the size changes. The alignment cannot change once
+// the search bar has been displayed, and does not need to be taken into account
+- (void)updateAnimationsIfNeeded
 {
+    if (self.expansionAnimation && CGSizeEqualToSize(self.bounds.size, m_animationSize)) {
+        return;
+    }
+    
     HLSViewAnimationStep *animationStep1 = [HLSViewAnimationStep animationStep];
     animationStep1.duration = 0.15;
     HLSViewAnimation *viewAnimation11 = [HLSViewAnimation animation];
@@ -273,44 +310,28 @@ static const CGFloat kSearchBarStandardHeight = 44.f;
     HLSViewAnimationStep *animationStep2 = [HLSViewAnimationStep animationStep];
     animationStep2.duration = 0.25;
     
-    CGRect collapsedFrame;
-    if (self.alignment == HLSExpandingSearchBarAlignmentLeft) {
-        collapsedFrame = CGRectMake(0.f, 
-                                    roundf((CGRectGetHeight(self.frame) - kSearchBarStandardHeight) / 2.f), 
-                                    kSearchBarStandardHeight, 
-                                    kSearchBarStandardHeight);
-    }
-    else {
-        collapsedFrame = CGRectMake(CGRectGetWidth(self.bounds) - kSearchBarStandardHeight, 
-                                    roundf((CGRectGetHeight(self.frame) - kSearchBarStandardHeight) / 2.f), 
-                                    kSearchBarStandardHeight, 
-                                    kSearchBarStandardHeight);    
-    }
+    CGRect collapsedFrame = [self collapsedFrame];
     
     HLSViewAnimation *viewAnimation21 = [HLSViewAnimation animation];
-    [viewAnimation21 transformFromRect:collapsedFrame
-                                toRect:CGRectMake(0.f,
-                                                  roundf((CGRectGetHeight(self.frame) - kSearchBarStandardHeight) / 2.f),
-                                                  CGRectGetWidth(self.bounds),
-                                                  kSearchBarStandardHeight)];
+    [viewAnimation21 transformFromRect:collapsedFrame toRect:[self expandedSearchBarFrame]];
     [animationStep2 addViewAnimation:viewAnimation21 forView:self.searchBar];
     
     if (self.alignment == HLSExpandingSearchBarAlignmentRight) {
         HLSViewAnimation *viewAnimation22 = [HLSViewAnimation animation];
-        [viewAnimation22 transformFromRect:collapsedFrame
-                                    toRect:CGRectMake(0.f,
-                                                      roundf((CGRectGetHeight(self.frame) - kSearchBarStandardHeight) / 2.f),
-                                                      kSearchBarStandardHeight,
-                                                      kSearchBarStandardHeight)];
+        [viewAnimation22 transformFromRect:collapsedFrame toRect:[self expandedSearchButtonFrame]];
         [animationStep2 addViewAnimation:viewAnimation22 forView:self.searchButton];
     }
     
-    HLSAnimation *animation = [HLSAnimation animationWithAnimationSteps:[NSArray arrayWithObjects:animationStep1, animationStep2, nil]];
-    animation.tag = @"searchBar";
-    animation.lockingUI = YES;
-    animation.delegate = self;
+    HLSAnimation *expansionAnimation = [HLSAnimation animationWithAnimationSteps:[NSArray arrayWithObjects:animationStep1, animationStep2, nil]];
+    expansionAnimation.tag = @"searchBar";
+    expansionAnimation.lockingUI = YES;
+    expansionAnimation.delegate = self;
+    self.expansionAnimation = expansionAnimation;
     
-    return animation;
+    // The reverse animation inherits the tag (prefixed with reverse_), the UI locking behavior and the delegate
+    self.collapseAnimation = [expansionAnimation reverseAnimation];
+    
+    m_animationSize = self.bounds.size;
 }
 
 - (void)setExpanded:(BOOL)expanded animated:(BOOL)animated
@@ -334,8 +355,8 @@ static const CGFloat kSearchBarStandardHeight = 44.f;
         
         m_animating = YES;
         
-        HLSAnimation *animation = [self expansionAnimation];
-        [animation playAnimated:animated];        
+        [self updateAnimationsIfNeeded];
+        [self.expansionAnimation playAnimated:animated];
     }
     else {
         if (! m_expanded) {
@@ -356,8 +377,8 @@ static const CGFloat kSearchBarStandardHeight = 44.f;
         
         [self.searchBar resignFirstResponder];
         
-        HLSAnimation *reverseAnimation = [[self expansionAnimation] reverseAnimation];
-        [reverseAnimation playAnimated:animated];
+        [self updateAnimationsIfNeeded];
+        [self.collapseAnimation playAnimated:animated];
     }
 }
 
@@ -399,9 +420,16 @@ static const CGFloat kSearchBarStandardHeight = 44.f;
         }
     }
     
-    // Force layout so that the views resize properly, even if the expansion / collapsing animation occurs during
-    // a device rotation
-    [self layoutSubviews];
+    // The animation ends with the frames which layout would set for the geometry it was created for. If this geometry
+    // has not changed, no layout is required. Otherwise force layout so that the views resize properly (this happens
+    // if the expansion / collapsing animation occurs during a device rotation)
+    if (CGSizeEqualToSize(self.bounds.size, m_animationSize)) {
+        m_laidOutSize = self.bounds.size;
+        m_laidOutExpanded = m_expanded;
+    }
+    else {
+        [self layoutSubviews];
+    }
 }
 
 #pragma mark UISearchBarDelegate protocol implementation
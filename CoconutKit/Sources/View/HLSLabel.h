@@ -27,10 +27,15 @@ typedef enum {
  *     number of lines is larger than 1). Unlike UILabel, the font size can never be smaller than this minimum
  *     value (even if no size adjustment is needed)
  *   - the baselineAdjustment property is ignored
+ *   - text can optionally be laid out and rasterized on a background queue (asynchronousDisplayEnabled property)
  */
 @interface HLSLabel : UILabel {
 @private
     HLSLabelVerticalAlignment _verticalAlignment;
+    BOOL _asynchronousDisplayEnabled;
+    NSString *_pendingRenderingKey;
+    NSString *_renderedImageKey;
+    UIImage *_renderedImage;
 }
 
 /**
@@ -40,4 +45,16 @@ typedef enum {
  */
 @property (nonatomic, assign) HLSLabelVerticalAlignment verticalAlignment;
 
+/**
+ * If set to YES, the text is laid out and rasterized on a background queue when it needs to be drawn, and displayed
+ * once ready. Nothing is displayed in the meantime. Rendered images are cached by content and size so that labels
+ * with identical attributes (e.g. in table view cells being reused while scrolling) are displayed immediately. Use 
+ * this mode for text-heavy labels in views which must scroll smoothly
+ *
+ * Highlighted or disabled labels are always drawn synchronously so that their state changes are visible immediately
+ *
+ * Default value is NO
+ */
+@property (nonatomic, assign, getter=isAsynchronousDisplayEnabled) BOOL asynchronousDisplayEnabled;
+
 @end
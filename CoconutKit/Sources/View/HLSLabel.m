@@ -9,17 +9,45 @@
 #import "HLSLabel.h"
 
 #import "HLSFloat.h"
+#import "HLSLabelRenderingRequest.h"
 #import "HLSLogger.h"
 #import "NSString+HLSExtensions.h"
 
+static const NSUInteger kRenderedImageCacheCountLimit = 200;
+
+static NSCache *s_renderedImageCache = nil;
+
+// Function declarations
+static void createRenderedImageCache(void *context);
+static void renderRequest(void *context);
+static void finishRequest(void *context);
+
 @interface HLSLabel ()
 
+@property (nonatomic, retain) NSString *pendingRenderingKey;
+@property (nonatomic, retain) NSString *renderedImageKey;
+@property (nonatomic, retain) UIImage *renderedImage;
+
 - (CGRect)textRectForBounds:(CGRect)bounds limitedToNumberOfLines:(NSInteger)numberOfLines;
 
+- (void)drawTextAsynchronouslyInRect:(CGRect)rect;
+- (void)finishRenderingWithRequest:(HLSLabelRenderingRequest *)request;
+
 @end
 
 @implementation HLSLabel
 
+#pragma mark Object creation and destruction
+
+- (void)dealloc
+{
+    self.pendingRenderingKey = nil;
+    self.renderedImageKey = nil;
+    self.renderedImage = nil;
+    
+    [super dealloc];
+}
+
 #pragma mark Accessors and mutators
 
 @synthesize verticalAlignment = _verticalAlignment;
@@ -41,6 +69,29 @@
     [self setNeedsDisplay];
 }
 
+@synthesize asynchronousDisplayEnabled = _asynchronousDisplayEnabled;
+
+- (void)setAsynchronousDisplayEnabled:(BOOL)asynchronousDisplayEnabled
+{
+    if (_asynchronousDisplayEnabled == asynchronousDisplayEnabled) {
+        return;
+    }
+    
+    _asynchronousDisplayEnabled = asynchronousDisplayEnabled;
+    
+    self.pendingRenderingKey = nil;
+    self.renderedImageKey = nil;
+    self.renderedImage = nil;
+    
+    [self setNeedsDisplay];
+}
+
+@synthesize pendingRenderingKey = _pendingRenderingKey;
+
+@synthesize renderedImageKey = _renderedImageKey;
+
+@synthesize renderedImage = _renderedImage;
+
 #pragma mark UILabel drawing override points
 
 /**
@@ -74,6 +125,11 @@
 
 - (void)drawTextInRect:(CGRect)requestedRect
 {
+    if (self.asynchronousDisplayEnabled && ! self.highlighted && self.enabled) {
+        [self drawTextAsynchronouslyInRect:requestedRect];
+        return;
+    }
+    
     CGFloat fontSize = 0.f;
     if (self.adjustsFontSizeToFitWidth) {
         fontSize = [self.text fontSizeWithFont:self.font 
@@ -84,10 +140,95 @@
     else {
         fontSize = floatmax(self.font.pointSize, self.minimumFontSize);
     }
-    self.font = [UIFont fontWithName:self.font.fontName size:fontSize];
+    
+    // Changing the font triggers a new layout pass
+    if (! floateq(fontSize, self.font.pointSize)) {
+        self.font = [UIFont fontWithName:self.font.fontName size:fontSize];
+    }
     
     CGRect actualRect = [self textRectForBounds:requestedRect limitedToNumberOfLines:self.numberOfLines];
     [super drawTextInRect:actualRect];
 }
 
+#pragma mark Asynchronous display
+
+- (void)drawTextAsynchronouslyInRect:(CGRect)rect
+{
+    if ([self.text length] == 0 || floatle(rect.size.width, 0.f) || floatle(rect.size.height, 0.f)) {
+        return;
+    }
+    
+    static dispatch_once_t s_onceToken;
+    dispatch_once_f(&s_onceToken, NULL, createRenderedImageCache);
+    
+    HLSLabelRenderingRequest *request = [[[HLSLabelRenderingRequest alloc] initWithLabel:self size:rect.size] autorelease];
+    
+    // Draw the result if available
+    UIImage *image = nil;
+    if ([request.key isEqualToString:self.renderedImageKey]) {
+        image = self.renderedImage;
+    }
+    else {
+        image = [s_renderedImageCache objectForKey:request.key];
+    }
+    if (image) {
+        [image drawInRect:rect];
+        return;
+    }
+    
+    // Already being rendered
+    if ([request.key isEqualToString:self.pendingRenderingKey]) {
+        return;
+    }
+    
+    // Rendering requests which are not pending anymore are simply discarded when they finish
+    self.pendingRenderingKey = request.key;
+    dispatch_async_f(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), [request retain], renderRequest);
+}
+
+- (void)finishRenderingWithRequest:(HLSLabelRenderingRequest *)request
+{
+    if (! [request.key isEqualToString:self.pendingRenderingKey]) {
+        return;
+    }
+    
+    self.pendingRenderingKey = nil;
+    self.renderedImageKey = request.key;
+    self.renderedImage = request.image;
+    
+    [self setNeedsDisplay];
+}
+
 @end
+
+#pragma mark Static functions
+
+static void createRenderedImageCache(void *context)
+{
+    s_renderedImageCache = [[NSCache alloc] init];
+    s_renderedImageCache.countLimit = kRenderedImageCacheCountLimit;
+}
+
+// Called on a background thread
+static void renderRequest(void *context)
+{
+    NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+    
+    HLSLabelRenderingRequest *request = (HLSLabelRenderingRequest *)context;
+    [request render];
+    if (request.image) {
+        [s_renderedImageCache setObject:request.image forKey:request.key];
+    }
+    
+    [pool drain];
+    
+    // The request (and therefore the label) is released on the main thread
+    dispatch_async_f(dispatch_get_main_queue(), request, finishRequest);
+}
+
+static void finishRequest(void *context)
+{
+    HLSLabelRenderingRequest *request = (HLSLabelRenderingRequest *)context;
+    [request.label finishRenderingWithRequest:request];
+    [request release];
+}
@@ -22,6 +22,9 @@ typedef enum {
 /**
  * Internal class for containing the localization information attached to a UILabel (see UILabel+HLSDynamicLocalization.m)
  *
+ * Localization information objects are immutable. Labels created with the same text (e.g. labels of table view cells 
+ * instantiated from a nib) should share a single object, obtained using +localizationInfoWithText:
+ *
  * Designated initializer: -initWithText:
  */
 @interface HLSLabelLocalizationInfo : NSObject {
@@ -29,9 +32,14 @@ typedef enum {
     NSString *m_localizationKey;
     NSString *m_table;
     HLSLabelRepresentation m_representation;
-    BOOL m_locked;
 }
 
+/**
+ * Return the shared localization object corresponding to a given text. Objects for localized texts are created once 
+ * and then looked up, texts without localization prefix share a single object. Must be called from the main thread
+ */
++ (HLSLabelLocalizationInfo *)localizationInfoWithText:(NSString *)text;
+
 /**
  * Create a localization object from a given text, processing any prefix contained in the text (see complete list in
  * UILabel+HLSDynamicLocalization.h)
@@ -54,9 +62,4 @@ typedef enum {
  */
 - (NSString *)localizedText;
 
-/**
- * Used to mark the object as locked
- */
-@property (nonatomic, assign, getter=isLocked) BOOL locked;
-
 @end
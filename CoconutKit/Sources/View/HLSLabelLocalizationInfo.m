@@ -14,6 +14,10 @@
 
 static NSString * const kMissingLocalizedString = @"UILabel_HLSDynamicLocalization_missing";
 
+// Shared localization information objects, for localized texts only (localized texts come from nibs or code and are
+// therefore in limited number)
+static NSMutableDictionary *s_textToLocalizationInfoMap = nil;
+
 static NSString *stringForLabelRepresentation(HLSLabelRepresentation representation);
 
 @interface HLSLabelLocalizationInfo ()
@@ -28,6 +32,35 @@ static NSString *stringForLabelRepresentation(HLSLabelRepresentation representat
 
 @implementation HLSLabelLocalizationInfo
 
+#pragma mark Class methods
+
++ (HLSLabelLocalizationInfo *)localizationInfoWithText:(NSString *)text
+{
+    static HLSLabelLocalizationInfo *s_unlocalizedInfo = nil;
+    if (! s_textToLocalizationInfoMap) {
+        s_textToLocalizationInfoMap = [[NSMutableDictionary alloc] init];
+        s_unlocalizedInfo = [[HLSLabelLocalizationInfo alloc] initWithText:nil];
+    }
+    
+    if (! text) {
+        return s_unlocalizedInfo;
+    }
+    
+    HLSLabelLocalizationInfo *localizationInfo = [s_textToLocalizationInfoMap objectForKey:text];
+    if (localizationInfo) {
+        return localizationInfo;
+    }
+    
+    localizationInfo = [[[HLSLabelLocalizationInfo alloc] initWithText:text] autorelease];
+    if (! [localizationInfo isLocalized]) {
+        return s_unlocalizedInfo;
+    }
+    
+    // Copy the key, the text might be mutable
+    [s_textToLocalizationInfoMap setObject:localizationInfo forKey:[[text copy] autorelease]];
+    return localizationInfo;
+}
+
 #pragma mark Object creation and destruction
 
 - (id)initWithText:(NSString *)text
@@ -60,8 +93,6 @@ static NSString *stringForLabelRepresentation(HLSLabelRepresentation representat
 
 @synthesize representation = m_representation;
 
-@synthesize locked = m_locked;
-
 #pragma mark Parsing text
 
 - (void)parseText:(NSString *)text
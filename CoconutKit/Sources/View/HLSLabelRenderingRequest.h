@@ -0,0 +1,65 @@
+//
+//  HLSLabelRenderingRequest.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSLabel.h"
+
+/**
+ * Private class for implementation purposes. A rendering request is a snapshot of the attributes of an HLSLabel
+ * which determine how its text is drawn. Since it does not refer to the label for anything else than delivering
+ * the result, its text can be laid out and rasterized on a background thread. The key uniquely identifies the
+ * resulting image and can be used for caching
+ *
+ * Designated initializer: -initWithLabel:size:
+ */
+@interface HLSLabelRenderingRequest : NSObject {
+@private
+    HLSLabel *m_label;
+    NSString *m_text;
+    UIFont *m_font;
+    UIColor *m_textColor;
+    UIColor *m_shadowColor;
+    CGSize m_shadowOffset;
+    UITextAlignment m_textAlignment;
+    UILineBreakMode m_lineBreakMode;
+    NSInteger m_numberOfLines;
+    BOOL m_adjustsFontSizeToFitWidth;
+    CGFloat m_minimumFontSize;
+    HLSLabelVerticalAlignment m_verticalAlignment;
+    CGSize m_size;
+    CGFloat m_scale;
+    NSString *m_key;
+    UIImage *m_image;
+}
+
+/**
+ * Capture the current attributes of a label (must be called from the main thread). The label is retained until
+ * the request is released
+ */
+- (id)initWithLabel:(HLSLabel *)label size:(CGSize)size;
+
+/**
+ * The label for which the request has been made
+ */
+@property (nonatomic, readonly, retain) HLSLabel *label;
+
+/**
+ * A key identifying the rendered image
+ */
+@property (nonatomic, readonly, retain) NSString *key;
+
+/**
+ * The rendered image, nil until -render has been called
+ */
+@property (nonatomic, readonly, retain) UIImage *image;
+
+/**
+ * Layout and rasterize the text. Can be called from any thread
+ */
+- (void)render;
+
+@end
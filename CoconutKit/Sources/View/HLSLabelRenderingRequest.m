@@ -0,0 +1,148 @@
+//
+//  HLSLabelRenderingRequest.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSLabelRenderingRequest.h"
+
+#import "HLSFloat.h"
+#import "HLSAssert.h"
+#import "NSString+HLSExtensions.h"
+
+@interface HLSLabelRenderingRequest ()
+
+@property (nonatomic, retain) HLSLabel *label;
+@property (nonatomic, retain) NSString *key;
+@property (nonatomic, retain) UIImage *image;
+
+@end
+
+@implementation HLSLabelRenderingRequest
+
+#pragma mark Object creation and destruction
+
+- (id)initWithLabel:(HLSLabel *)label size:(CGSize)size
+{
+    if ((self = [super init])) {
+        self.label = label;
+        m_text = [label.text copy];
+        m_font = [label.font retain];
+        m_textColor = [label.textColor retain];
+        m_shadowColor = [label.shadowColor retain];
+        m_shadowOffset = label.shadowOffset;
+        m_textAlignment = label.textAlignment;
+        m_lineBreakMode = label.lineBreakMode;
+        m_numberOfLines = label.numberOfLines;
+        m_adjustsFontSizeToFitWidth = label.adjustsFontSizeToFitWidth;
+        m_minimumFontSize = label.minimumFontSize;
+        m_verticalAlignment = label.verticalAlignment;
+        m_size = size;
+        m_scale = [UIScreen mainScreen].scale;
+    
+        self.key = [NSString stringWithFormat:@"%@|%g|%@|%@|%@|%d|%d|%d|%d|%g|%d|%@|%g|%@",
+                    m_font.fontName, m_font.pointSize, m_textColor, m_shadowColor, NSStringFromCGSize(m_shadowOffset),
+                    m_textAlignment, m_lineBreakMode, m_numberOfLines, m_adjustsFontSizeToFitWidth,
+                    m_minimumFontSize, m_verticalAlignment, NSStringFromCGSize(m_size), m_scale, m_text];
+    }
+    return self;
+}
+
+- (id)init
+{
+    HLSForbiddenInheritedMethod();
+    return nil;
+}
+
+- (void)dealloc
+{
+    self.label = nil;
+    [m_text release];
+    [m_font release];
+    [m_textColor release];
+    [m_shadowColor release];
+    self.key = nil;
+    self.image = nil;
+    
+    [super dealloc];
+}
+
+#pragma mark Accessors and mutators
+
+@synthesize label = m_label;
+
+@synthesize key = m_key;
+
+@synthesize image = m_image;
+
+#pragma mark Rendering
+
+- (void)render
+{
+    // Same font size rules as -[HLSLabel drawTextInRect:]
+    CGFloat fontSize = 0.f;
+    if (m_adjustsFontSizeToFitWidth) {
+        fontSize = [m_text fontSizeWithFont:m_font
+                          constrainedToSize:m_size
+                                minFontSize:m_minimumFontSize
+                              numberOfLines:m_numberOfLines];
+    }
+    else {
+        fontSize = floatmax(m_font.pointSize, m_minimumFontSize);
+    }
+    UIFont *font = floateq(fontSize, m_font.pointSize) ? m_font : [UIFont fontWithName:m_font.fontName size:fontSize];
+    
+    // Same vertical alignment rules as -[HLSLabel textRectForBounds:limitedToNumberOfLines:]
+    CGFloat maxHeight = m_size.height;
+    if (m_numberOfLines > 0) {
+        maxHeight = floatmin(maxHeight, m_numberOfLines * font.lineHeight);
+    }
+    CGSize textSize = [m_text sizeWithFont:font constrainedToSize:CGSizeMake(m_size.width, maxHeight) lineBreakMode:m_lineBreakMode];
+    
+    CGFloat y = 0.f;
+    switch (m_verticalAlignment) {
+        case HLSLabelVerticalAlignmentTop: {
+            y = 0.f;
+            break;
+        }
+    
+        case HLSLabelVerticalAlignmentBottom: {
+            y = m_size.height - textSize.height;
+            break;
+        }
+    
+        case HLSLabelVerticalAlignmentMiddle:
+        default: {
+            y = (m_size.height - textSize.height) / 2.f;
+            break;
+        }
+    }
+    CGRect textRect = CGRectMake(0.f, y, m_size.width, textSize.height);
+    
+    // UIKit drawing functions are thread-safe since iOS 4
+    UIGraphicsBeginImageContextWithOptions(m_size, NO, m_scale);
+    CGContextRef context = UIGraphicsGetCurrentContext();
+    if (m_shadowColor) {
+        CGContextSetShadowWithColor(context, m_shadowOffset, 0.f, m_shadowColor.CGColor);
+    }
+    [m_textColor set];
+    [m_text drawInRect:textRect withFont:font lineBreakMode:m_lineBreakMode alignment:m_textAlignment];
+    self.image = UIGraphicsGetImageFromCurrentImageContext();
+    UIGraphicsEndImageContext();
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; label: %@; key: %@; image: %@>",
+            [self class],
+            self,
+            self.label,
+            self.key,
+            self.image];
+}
+
+@end
@@ -10,9 +10,20 @@
 
 #import "HLSLogger.h"
 #import "NSArray+HLSExtensions.h"
+#import "NSBundle+HLSDynamicLocalization.h"
 #import "NSObject+HLSExtensions.h"
 
 static NSMutableDictionary *s_classNameToSizeMap = nil;
+static NSMutableDictionary *s_classNameToNibMap = nil;
+
+@interface HLSNibView ()
+
++ (UINib *)nib;
+
++ (void)applicationDidReceiveMemoryWarning:(NSNotification *)notification;
++ (void)currentLocalizationDidChange:(NSNotification *)notification;
+
+@end
 
 @implementation HLSNibView
 
@@ -26,6 +37,19 @@ static NSMutableDictionary *s_classNameToSizeMap = nil;
     }
     
     s_classNameToSizeMap = [[NSMutableDictionary dictionary] retain];
+    s_classNameToNibMap = [[NSMutableDictionary dictionary] retain];
+    
+    // Nibs can be parsed again when needed. Release them when memory gets low
+    [[NSNotificationCenter defaultCenter] addObserver:self
+                                             selector:@selector(applicationDidReceiveMemoryWarning:)
+                                                 name:UIApplicationDidReceiveMemoryWarningNotification
+                                               object:nil];
+    
+    // Localized nibs might have different dimensions
+    [[NSNotificationCenter defaultCenter] addObserver:self
+                                             selector:@selector(currentLocalizationDidChange:)
+                                                 name:HLSCurrentLocalizationDidChangeNotification
+                                               object:nil];
 }
 
 + (id)view
@@ -36,11 +60,11 @@ static NSMutableDictionary *s_classNameToSizeMap = nil;
     }
     
     // A xib has been found, use it
-    NSString *nibName = [self nibName];
-    if ([[NSBundle mainBundle] pathForResource:nibName ofType:@"nib"]) {
-        NSArray *bundleContents = [[NSBundle mainBundle] loadNibNamed:nibName owner:nil options:nil];
+    UINib *nib = [self nib];
+    if (nib) {
+        NSArray *bundleContents = [nib instantiateWithOwner:nil options:nil];
         if ([bundleContents count] == 0) {
-            HLSLoggerError(@"Missing view object in xib file %@", nibName);
+            HLSLoggerError(@"Missing view object in xib file %@", [self nibName]);
             return nil;
         }
         
@@ -83,9 +107,51 @@ static NSMutableDictionary *s_classNameToSizeMap = nil;
     return [viewSizeValue CGSizeValue];
 }
 
++ (void)invalidateSize
+{
+    if (self == [HLSNibView class]) {
+        [s_classNameToSizeMap removeAllObjects];
+    }
+    else {
+        [s_classNameToSizeMap removeObjectForKey:[self className]];
+    }
+}
+
 + (NSString *)nibName
 {
     return [self className];
 }
 
+#pragma mark Nib cache
+
+// Return the (cached) nib for the class, nil if none is found. Instantiating from a UINib avoids reading and
+// parsing the nib file each time a view is created
++ (UINib *)nib
+{
+    UINib *nib = [s_classNameToNibMap objectForKey:[self className]];
+    if (! nib) {
+        NSString *nibName = [self nibName];
+        if (! [[NSBundle mainBundle] pathForResource:nibName ofType:@"nib"]) {
+            return nil;
+        }
+        
+        nib = [UINib nibWithNibName:nibName bundle:nil];
+        [s_classNameToNibMap setObject:nib forKey:[self className]];
+    }
+    return nib;
+}
+
+#pragma mark Notification callbacks
+
++ (void)applicationDidReceiveMemoryWarning:(NSNotification *)notification
+{
+    [s_classNameToNibMap removeAllObjects];
+}
+
++ (void)currentLocalizationDidChange:(NSNotification *)notification
+{
+    [s_classNameToNibMap removeAllObjects];
+    [HLSNibView invalidateSize];
+}
+
 @end
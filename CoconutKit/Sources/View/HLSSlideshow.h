@@ -7,6 +7,7 @@
 //
 
 #import "HLSAnimation.h"
+#import "HLSFileManager.h"
 
 /**
  * Slideshow effects. Depending on which effect is applied the images will be scaled to fill or fit the slideshow
@@ -37,6 +38,15 @@ typedef enum {
  *
  * You should not alter the frame of a slideshow while it is running. This is currently not supported.
  *
+ * To avoid stuttering during transitions, the image following the next one is loaded and decoded in the background
+ * (using the default HLSTaskManager) while the current image is displayed. Decoded images are stored in the shared 
+ * HLSImageCache, so that images displayed again (e.g. in random mode or when skipping back) are not decoded again.
+ *
+ * Images can also be given by http or https URL. The next remote images to be displayed (in the order in which they
+ * will be displayed, even in random mode) are downloaded in advance using HLSURLTask, and stored in a small disk 
+ * cache (see remoteImage... properties). Images whose download has not completed when they should be displayed are 
+ * skipped for this time, so that the slideshow can start immediately and never waits for the network.
+ *
  * Designated initializer: -initWithFrame:
  */
 @interface HLSSlideshow : UIView <HLSAnimationDelegate> {
@@ -46,7 +56,15 @@ typedef enum {
     NSArray *m_imageNamesOrPaths;
     NSInteger m_currentImageIndex;
     NSInteger m_nextImageIndex;
+    NSMutableArray *m_upcomingImageIndexes;     // Indices (as NSNumber) of the images following the next one, in order
     NSInteger m_currentImageViewIndex;
+    NSMutableDictionary *m_preloadingTasks;     // Maps image names or paths to the HLSTask objects loading them
+    NSMutableDictionary *m_downloadTasks;       // Maps image URLs to the HLSURLTask objects downloading them
+    NSMutableArray *m_remoteImageFileNames;     // Names of the files in the remote image cache, least recently used first
+    HLSFileManager *m_remoteImageFileManager;
+    NSString *m_remoteImageCacheDirectoryPath;
+    NSUInteger m_remoteImagePrefetchCount;
+    NSUInteger m_remoteImageCacheCapacity;
     HLSAnimation *m_animation;
     NSTimeInterval m_imageDuration;
     NSTimeInterval m_transitionDuration;
@@ -62,8 +80,8 @@ typedef enum {
 @property (nonatomic, assign) HLSSlideshowEffect effect;
 
 /**
- * An array giving the names (for images inside the main bundle) or the full path of the images to be displayed. Images
- * are displayed in an endless loop, either sequentially or in a random order (see random property). 
+ * An array giving the names (for images inside the main bundle), the full path or the http(s) URL of the images to be 
+ * displayed. Images are displayed in an endless loop, either sequentially or in a random order (see random property). 
  *
  * This property can be changed while the slideshow is running. The images are not changed immediately on screen, 
  * though, one or two additional slideshow animations are required to display the new image set so that the 
@@ -95,6 +113,36 @@ typedef enum {
  */
 @property (nonatomic, assign) BOOL random;
 
+/**
+ * The number of upcoming remote images which are downloaded in advance. Default is 3. Must be >= 1
+ *
+ * This property can be changed while the slideshow is running
+ */
+@property (nonatomic, assign) NSUInteger remoteImagePrefetchCount;
+
+/**
+ * The maximum number of downloaded images kept in the remote image cache directory. The least recently displayed
+ * images are removed first, images about to be displayed are never removed. Default is 10
+ *
+ * This property can be changed while the slideshow is running
+ */
+@property (nonatomic, assign) NSUInteger remoteImageCacheCapacity;
+
+/**
+ * The directory where downloaded images are stored. Default is the HLSSlideshow directory in the application
+ * Caches directory. Slideshows sharing a directory share their downloaded images
+ *
+ * This property cannot be changed while the slideshow is running
+ */
+@property (nonatomic, retain) NSString *remoteImageCacheDirectoryPath;
+
+/**
+ * The file manager used to store downloaded images. Default is [HLSFileManager defaultManager]. Cannot be set to nil
+ *
+ * This property cannot be changed while the slideshow is running
+ */
+@property (nonatomic, retain) HLSFileManager *remoteImageFileManager;
+
 @property (nonatomic, assign) id<HLSSlideshowDelegate> delegate;
 
 /**
@@ -135,6 +183,12 @@ typedef enum {
 
 @end
 
+/**
+ * The animation displaying an image and the transition to the next one is played entirely by Core Animation, with
+ * no main thread work until the next image needs to be installed. This is not possible if the delegate implements
+ * -slideshow:willShowImageWithNameOrPath: or -slideshow:willHideImageWithNameOrPath:, which must be called from 
+ * the main thread when the transition starts. Only implement these methods if you really need them
+ */
 @protocol HLSSlideshowDelegate <NSObject>
 
 @optional
@@ -10,25 +10,57 @@
 
 #import "HLSAssert.h"
 #import "HLSFloat.h"
+#import "HLSImageCache.h"
+#import "HLSInvocationTask.h"
 #import "HLSLayerAnimationStep.h"
 #import "HLSLogger.h"
+#import "HLSTaskManager.h"
+#import "HLSURLTask.h"
+#import "NSString+HLSExtensions.h"
 #import "UIImage+HLSExtensions.h"
 #import "UIView+HLSExtensions.h"
 
 static const NSTimeInterval kSlideshowDefaultImageDuration = 4.;
 static const NSTimeInterval kSlideshowDefaultTransitionDuration = 3.;
 static const CGFloat kKenBurnsSlideshowMaxScaleFactorDelta = 0.4f;
+static const NSUInteger kSlideshowDefaultRemoteImagePrefetchCount = 3;
+static const NSUInteger kSlideshowDefaultRemoteImageCacheCapacity = 10;
+
+static NSString * const kSlideshowDownloadFileExtension = @"download";
 
 static const NSInteger kSlideshowNoIndex = -1;
 
-@interface HLSSlideshow () <HLSAnimationDelegate>
+static CGFloat HLSSlideshowZoomScale(CGSize imageSize, CGSize frameSize, BOOL aspectFit);
+
+@interface HLSSlideshow () <HLSAnimationDelegate, HLSTaskDelegate>
 
 - (void)hlsSlideshowInit;
 
 @property (nonatomic, retain) NSArray *imageViews;
 @property (nonatomic, retain) HLSAnimation *animation;
+@property (nonatomic, retain) NSMutableArray *upcomingImageIndexes;
+@property (nonatomic, retain) NSMutableDictionary *preloadingTasks;
+@property (nonatomic, retain) NSMutableDictionary *downloadTasks;
+@property (nonatomic, retain) NSMutableArray *remoteImageFileNames;
+
++ (BOOL)isRemoteImageNameOrPath:(NSString *)imageNameOrPath;
++ (NSString *)pathForImageNameOrPath:(NSString *)imageNameOrPath scale:(CGFloat)scale;
++ (UIImage *)imageWithInfo:(NSDictionary *)imageInfo;
++ (void)loadImageWithInfo:(NSMutableDictionary *)imageInfo;
 
+- (NSMutableDictionary *)imageInfoForNameOrPath:(NSString *)imageNameOrPath;
 - (UIImage *)imageForNameOrPath:(NSString *)imageNameOrPath;
+- (void)preloadImages;
+- (void)cancelPreloading;
+
+- (NSString *)remoteImageFilePathForNameOrPath:(NSString *)imageNameOrPath;
+- (void)loadRemoteImageCache;
+- (BOOL)isImageAvailableWithNameOrPath:(NSString *)imageNameOrPath;
+- (void)touchRemoteImageWithNameOrPath:(NSString *)imageNameOrPath;
+- (void)prefetchRemoteImages;
+- (void)trimRemoteImageCacheKeepingImageNamesOrPaths:(NSArray *)imageNamesOrPaths;
+- (void)cancelDownloadTask:(HLSURLTask *)downloadTask;
+- (void)cancelDownloads;
 - (void)prepareImageView:(UIImageView *)imageView withImageNameOrPath:(NSString *)imageNameOrPath;
 - (void)releaseImageView:(UIImageView *)imageView;
 - (NSString *)imageNameOrPathForImageView:(UIImageView *)imageView;
@@ -46,6 +78,8 @@ static const NSInteger kSlideshowNoIndex = -1;
                                                    xOffset:(CGFloat)xOffset
                                                    yOffset:(CGFloat)yOffset;
 
+- (NSInteger)followingImageIndexForImageIndex:(NSInteger)imageIndex;
+
 - (void)playNextAnimation;
 - (void)playAnimationForImageWithNameOrPath:(NSString *)imageNameOrPath;
 - (void)playAnimationForNextImage;
@@ -82,6 +116,10 @@ static const NSInteger kSlideshowNoIndex = -1;
     
     m_currentImageIndex = kSlideshowNoIndex;
     
+    self.upcomingImageIndexes = [NSMutableArray array];
+    self.preloadingTasks = [NSMutableDictionary dictionary];
+    self.downloadTasks = [NSMutableDictionary dictionary];
+    
     self.imageViews = [NSArray array];
     for (NSUInteger i = 0; i < 2; ++i) {
         UIImageView *imageView = [[[UIImageView alloc] initWithFrame:self.bounds] autorelease];
@@ -94,17 +132,33 @@ static const NSInteger kSlideshowNoIndex = -1;
     self.imageDuration = kSlideshowDefaultImageDuration;
     self.transitionDuration = kSlideshowDefaultTransitionDuration;
     self.random = NO;
+    
+    self.remoteImagePrefetchCount = kSlideshowDefaultRemoteImagePrefetchCount;
+    self.remoteImageCacheCapacity = kSlideshowDefaultRemoteImageCacheCapacity;
+    self.remoteImageFileManager = [HLSFileManager defaultManager];
+    NSString *cachesDirectoryPath = [NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES) objectAtIndex:0];
+    self.remoteImageCacheDirectoryPath = [cachesDirectoryPath stringByAppendingPathComponent:@"HLSSlideshow"];
 }
 
 - (void)dealloc
 {
     [self stop];
+    [[HLSTaskManager defaultManager] unregisterDelegateAndCancelAssociatedTasks:self];
     
     self.imageViews = nil;
     self.imageNamesOrPaths = nil;
     self.animation = nil;
+    self.upcomingImageIndexes = nil;
+    self.preloadingTasks = nil;
+    self.downloadTasks = nil;
+    self.remoteImageFileNames = nil;
+    self.remoteImageCacheDirectoryPath = nil;
     self.delegate = nil;
     
+    // The setter does not accept nil
+    [m_remoteImageFileManager release];
+    m_remoteImageFileManager = nil;
+    
     [super dealloc];
 }
 
@@ -154,12 +208,25 @@ static const NSInteger kSlideshowNoIndex = -1;
         [self stop];
     }
     
+    // The next and upcoming images might not be part of the new image set. The next image (already displayed
+    // during the transition) is then given by the position of the current image in the new set
+    m_nextImageIndex = kSlideshowNoIndex;
+    [self.upcomingImageIndexes removeAllObjects];
+    
     [m_imageNamesOrPaths release];
     m_imageNamesOrPaths = [imageNamesOrPaths retain];
 }
 
 @synthesize animation = m_animation;
 
+@synthesize upcomingImageIndexes = m_upcomingImageIndexes;
+
+@synthesize preloadingTasks = m_preloadingTasks;
+
+@synthesize downloadTasks = m_downloadTasks;
+
+@synthesize remoteImageFileNames = m_remoteImageFileNames;
+
 @synthesize imageDuration = m_imageDuration;
 
 - (void)setImageDuration:(NSTimeInterval)imageDuration
@@ -186,6 +253,65 @@ static const NSInteger kSlideshowNoIndex = -1;
 
 @synthesize random = m_random;
 
+@synthesize remoteImagePrefetchCount = m_remoteImagePrefetchCount;
+
+- (void)setRemoteImagePrefetchCount:(NSUInteger)remoteImagePrefetchCount
+{
+    if (remoteImagePrefetchCount == 0) {
+        HLSLoggerWarn(@"The remote image prefetch count must be >= 1; fixed to 1");
+        remoteImagePrefetchCount = 1;
+    }
+    
+    m_remoteImagePrefetchCount = remoteImagePrefetchCount;
+}
+
+@synthesize remoteImageCacheCapacity = m_remoteImageCacheCapacity;
+
+@synthesize remoteImageCacheDirectoryPath = m_remoteImageCacheDirectoryPath;
+
+- (void)setRemoteImageCacheDirectoryPath:(NSString *)remoteImageCacheDirectoryPath
+{
+    if (self.running) {
+        HLSLoggerWarn(@"The remote image cache directory cannot be changed while the slideshow is running");
+        return;
+    }
+    
+    if (m_remoteImageCacheDirectoryPath == remoteImageCacheDirectoryPath) {
+        return;
+    }
+    
+    [m_remoteImageCacheDirectoryPath release];
+    m_remoteImageCacheDirectoryPath = [remoteImageCacheDirectoryPath retain];
+    
+    // Read the directory again when needed
+    self.remoteImageFileNames = nil;
+}
+
+@synthesize remoteImageFileManager = m_remoteImageFileManager;
+
+- (void)setRemoteImageFileManager:(HLSFileManager *)remoteImageFileManager
+{
+    if (self.running) {
+        HLSLoggerWarn(@"The remote image file manager cannot be changed while the slideshow is running");
+        return;
+    }
+    
+    if (m_remoteImageFileManager == remoteImageFileManager) {
+        return;
+    }
+    
+    if (! remoteImageFileManager) {
+        HLSLoggerWarn(@"A file manager is mandatory");
+        return;
+    }
+    
+    [m_remoteImageFileManager release];
+    m_remoteImageFileManager = [remoteImageFileManager retain];
+    
+    // Read the directory again when needed
+    self.remoteImageFileNames = nil;
+}
+
 - (BOOL)isRunning
 {
     return self.animation.running;
@@ -215,6 +341,7 @@ static const NSInteger kSlideshowNoIndex = -1;
     m_currentImageIndex = kSlideshowNoIndex;
     m_nextImageIndex = kSlideshowNoIndex;
     m_currentImageViewIndex = kSlideshowNoIndex;
+    [self.upcomingImageIndexes removeAllObjects];
     
     [self playAnimationForNextImage];
 }
@@ -257,10 +384,14 @@ static const NSInteger kSlideshowNoIndex = -1;
     m_currentImageIndex = kSlideshowNoIndex;
     m_nextImageIndex = kSlideshowNoIndex;
     m_currentImageViewIndex = kSlideshowNoIndex;
+    [self.upcomingImageIndexes removeAllObjects];
     
     for (UIImageView *imageView in self.imageViews) {
         imageView.image = nil;
     }
+    
+    [self cancelPreloading];
+    [self cancelDownloads];
 }
 
 - (void)skipToNextImage
@@ -332,55 +463,382 @@ static const NSInteger kSlideshowNoIndex = -1;
 
 #pragma mark Image management
 
++ (BOOL)isRemoteImageNameOrPath:(NSString *)imageNameOrPath
+{
+    return [imageNameOrPath hasPrefix:@"http://"] || [imageNameOrPath hasPrefix:@"https://"];
+}
+
+// Return the path of the file containing an image given by name or path (nil if not found). Prefers @2x resources 
+// for Retina displays. Unlike +[UIImage imageNamed:], this can be called from any thread
++ (NSString *)pathForImageNameOrPath:(NSString *)imageNameOrPath scale:(CGFloat)scale
+{
+    if ([imageNameOrPath isAbsolutePath]) {
+        return [[NSFileManager defaultManager] fileExistsAtPath:imageNameOrPath] ? imageNameOrPath : nil;
+    }
+    
+    NSString *extension = [imageNameOrPath pathExtension];
+    if ([extension length] == 0) {
+        extension = @"png";
+    }
+    NSString *name = [imageNameOrPath stringByDeletingPathExtension];
+    
+    NSString *imagePath = nil;
+    if (floatgt(scale, 1.f)) {
+        imagePath = [[NSBundle mainBundle] pathForResource:[name stringByAppendingString:@"@2x"] ofType:extension];
+    }
+    if (! imagePath) {
+        imagePath = [[NSBundle mainBundle] pathForResource:name ofType:extension];
+    }
+    return imagePath;
+}
+
+// Load an image decoded at the pixel size it will be displayed with (see -imageInfoForNameOrPath:). Return nil if the
+// image could not be found. Can be called from any thread
++ (UIImage *)imageWithInfo:(NSDictionary *)imageInfo
+{
+    NSString *imageNameOrPath = [imageInfo objectForKey:@"imageNameOrPath"];
+    CGFloat scale = [[imageInfo objectForKey:@"scale"] floatValue];
+    
+    // Downloaded images are read through the file manager which stored them
+    NSString *imagePath = nil;
+    NSData *imageData = nil;
+    if ([self isRemoteImageNameOrPath:imageNameOrPath]) {
+        HLSFileManager *fileManager = [imageInfo objectForKey:@"fileManager"];
+        imageData = [fileManager contentsOfFileAtPath:[imageInfo objectForKey:@"filePath"] error:NULL];
+        if (! imageData) {
+            return nil;
+        }
+    }
+    else {
+        imagePath = [self pathForImageNameOrPath:imageNameOrPath scale:scale];
+    }
+    
+    CGSize pixelSize = imageData ? [UIImage pixelSizeOfImageWithData:imageData] : [UIImage pixelSizeOfImageWithContentsOfFile:imagePath];
+    if (floateq(pixelSize.width, 0.f) || floateq(pixelSize.height, 0.f)) {
+        return nil;
+    }
+    
+    // Largest dimension of the image once displayed, in pixels. Never upscale
+    CGSize frameSize = [[imageInfo objectForKey:@"frameSize"] CGSizeValue];
+    CGFloat zoomScale = HLSSlideshowZoomScale(pixelSize, frameSize, [[imageInfo objectForKey:@"aspectFit"] boolValue]);
+    CGFloat maximumZoomFactor = [[imageInfo objectForKey:@"maximumZoomFactor"] floatValue];
+    CGFloat maximumPixelSize = ceilf(MAX(pixelSize.width, pixelSize.height) * zoomScale * scale * maximumZoomFactor);
+    maximumPixelSize = MIN(maximumPixelSize, MAX(pixelSize.width, pixelSize.height));
+    
+    if (imageData) {
+        return [UIImage imageWithData:imageData maximumPixelSize:(NSUInteger)maximumPixelSize scale:scale];
+    }
+    else {
+        return [UIImage imageWithContentsOfFile:imagePath maximumPixelSize:(NSUInteger)maximumPixelSize scale:scale];
+    }
+}
+
+// Load an image in the background, storing the result in imageInfo. If this fails, the image will be loaded on the 
+// main thread when needed
++ (void)loadImageWithInfo:(NSMutableDictionary *)imageInfo
+{
+    UIImage *image = [self imageWithInfo:imageInfo];
+    if (image) {
+        [imageInfo setObject:image forKey:@"image"];
+    }
+}
+
+// Collect the information the image loading code needs, so that it does not have to access the slideshow. Must be 
+// called from the main thread
+- (NSMutableDictionary *)imageInfoForNameOrPath:(NSString *)imageNameOrPath
+{
+    BOOL aspectFit = (self.effect == HLSSlideshowEffectNone || self.effect == HLSSlideshowEffectCrossDissolve);
+    
+    // The Ken Burns effect zooms on images, which must therefore be loaded with more pixels
+    CGFloat maximumZoomFactor = (self.effect == HLSSlideshowEffectKenBurns) ? 1.f + kKenBurnsSlideshowMaxScaleFactorDelta : 1.f;
+    CGFloat scale = [UIScreen mainScreen].scale;
+    
+    // The decoded image only depends on these parameters. Use them to identify it in the cache
+    NSString *cacheKey = [NSString stringWithFormat:@"%@|%.0fx%.0f|%d|%.2f|%.0f", imageNameOrPath, CGRectGetWidth(self.frame), 
+                          CGRectGetHeight(self.frame), aspectFit, maximumZoomFactor, scale];
+    
+    NSMutableDictionary *imageInfo = [NSMutableDictionary dictionaryWithObjectsAndKeys:imageNameOrPath, @"imageNameOrPath",
+                                      [NSValue valueWithCGSize:self.frame.size], @"frameSize",
+                                      [NSNumber numberWithBool:aspectFit], @"aspectFit",
+                                      [NSNumber numberWithFloat:maximumZoomFactor], @"maximumZoomFactor",
+                                      [NSNumber numberWithFloat:scale], @"scale",
+                                      cacheKey, @"cacheKey",
+                                      nil];
+    if ([HLSSlideshow isRemoteImageNameOrPath:imageNameOrPath]) {
+        [imageInfo setObject:[self remoteImageFilePathForNameOrPath:imageNameOrPath] forKey:@"filePath"];
+        [imageInfo setObject:self.remoteImageFileManager forKey:@"fileManager"];
+    }
+    return imageInfo;
+}
+
 // Return the image corresponding to a name or path. If the image is not found, return a dummy invisible image
 - (UIImage *)imageForNameOrPath:(NSString *)imageNameOrPath
 {
-    UIImage *image = [UIImage imageNamed:imageNameOrPath];
-    if (! image) {
-        image = [UIImage imageWithContentsOfFile:imageNameOrPath];
+    NSDictionary *imageInfo = [self imageInfoForNameOrPath:imageNameOrPath];
+    NSString *cacheKey = [imageInfo objectForKey:@"cacheKey"];
+    UIImage *image = [[HLSImageCache sharedImageCache] imageForKey:cacheKey];
+    if (image) {
+        return image;
+    }
+    
+    // Not preloaded. Decode now rather than lazily during the transition. Remote images are never loaded
+    // synchronously
+    image = [HLSSlideshow imageWithInfo:imageInfo];
+    if (! [HLSSlideshow isRemoteImageNameOrPath:imageNameOrPath]) {
+        if (! image) {
+            image = [[UIImage imageNamed:imageNameOrPath] decodedImage];
+        }
+        if (! image) {
+            image = [[UIImage imageWithContentsOfFile:imageNameOrPath] decodedImage];
+        }
     }
     if (! image) {
         HLSLoggerWarn(@"Missing image %@", imageNameOrPath);
-        image = [UIImage imageWithColor:[UIColor clearColor]];
+        return [UIImage imageWithColor:[UIColor clearColor]];
     }
+    
+    [[HLSImageCache sharedImageCache] setImage:image forKey:cacheKey];
     return image;
 }
 
-// Setup an image view to display a given image. The image view frame is adjusted to get an aspect fill / aspect fit
-// behavior for the image view, and is centered in self. The view alpha is reset to 1
-- (void)prepareImageView:(UIImageView *)imageView withImageNameOrPath:(NSString *)imageNameOrPath
+// Decide which images will be displayed after the next one, download the remote ones, and load the first one which 
+// is available in the background (if not already cached). Cancel loads which are not needed anymore
+- (void)preloadImages
 {
-    UIImage *image = [self imageForNameOrPath:imageNameOrPath];
+    NSUInteger numberOfImages = [self.imageNamesOrPaths count];
+    if (numberOfImages == 0 || m_nextImageIndex == kSlideshowNoIndex) {
+        return;
+    }
     
-    // Calculate the scale which needs to be applied to get aspect fill behavior for the image view
-    // TODO: This code is quite common (most notably in PDF generator code). Factor it somewhere where it can easily
-    //       be reused
-    CGFloat zoomScale;
-    // Aspect ratios of frame and image
-    CGFloat frameRatio = CGRectGetWidth(self.frame) / CGRectGetHeight(self.frame);
-    CGFloat imageRatio = image.size.width / image.size.height;
-    if (self.effect == HLSSlideshowEffectNone || self.effect == HLSSlideshowEffectCrossDissolve) {
-        // The image is more portrait-shaped than self
-        if (floatlt(imageRatio, frameRatio)) {
-            zoomScale = CGRectGetHeight(self.frame) / image.size.height;
+    NSInteger lastImageIndex = ([self.upcomingImageIndexes count] != 0) ? [[self.upcomingImageIndexes lastObject] integerValue] : m_nextImageIndex;
+    while ([self.upcomingImageIndexes count] < self.remoteImagePrefetchCount) {
+        lastImageIndex = [self followingImageIndexForImageIndex:lastImageIndex];
+        [self.upcomingImageIndexes addObject:[NSNumber numberWithInteger:lastImageIndex]];
+    }
+    
+    [self prefetchRemoteImages];
+    
+    NSString *upcomingImageNameOrPath = nil;
+    for (NSNumber *imageIndexNumber in self.upcomingImageIndexes) {
+        NSString *imageNameOrPath = [self.imageNamesOrPaths objectAtIndex:[imageIndexNumber integerValue]];
+        if ([self isImageAvailableWithNameOrPath:imageNameOrPath]) {
+            upcomingImageNameOrPath = imageNameOrPath;
+            break;
         }
-        // The image is more landscape-shaped than self
-        else {
-            zoomScale = CGRectGetWidth(self.frame) / image.size.width;
+    }
+    
+    for (NSString *imageNameOrPath in [self.preloadingTasks allKeys]) {
+        if (! [imageNameOrPath isEqualToString:upcomingImageNameOrPath]) {
+            HLSTask *preloadingTask = [self.preloadingTasks objectForKey:imageNameOrPath];
+            [[HLSTaskManager defaultManager] unregisterDelegateForTask:preloadingTask];
+            [[HLSTaskManager defaultManager] cancelTask:preloadingTask];
+            [self.preloadingTasks removeObjectForKey:imageNameOrPath];
         }
     }
-    // Calculate the scale which needs to be applied to get aspect fit behavior for the image view
-    else {
-        // The image is more portrait-shaped than self
-        if (floatlt(imageRatio, frameRatio)) {
-            zoomScale = CGRectGetWidth(self.frame) / image.size.width;
+    
+    if (! upcomingImageNameOrPath || [self.preloadingTasks objectForKey:upcomingImageNameOrPath]) {
+        return;
+    }
+    
+    NSMutableDictionary *imageInfo = [self imageInfoForNameOrPath:upcomingImageNameOrPath];
+    if ([[HLSImageCache sharedImageCache] imageForKey:[imageInfo objectForKey:@"cacheKey"]]) {
+        return;
+    }
+    
+    // The target is the class so that the slideshow is not retained by the task
+    HLSInvocationTask *preloadingTask = [[[HLSInvocationTask alloc] initWithTarget:[HLSSlideshow class]
+                                                                          selector:@selector(loadImageWithInfo:) 
+                                                                            object:imageInfo] autorelease];
+    preloadingTask.executionClass = HLSTaskExecutionClassCPU;
+    [self.preloadingTasks setObject:preloadingTask forKey:upcomingImageNameOrPath];
+    [[HLSTaskManager defaultManager] registerDelegate:self forTask:preloadingTask];
+    [[HLSTaskManager defaultManager] submitTask:preloadingTask];
+}
+
+- (void)cancelPreloading
+{
+    for (HLSTask *preloadingTask in [self.preloadingTasks allValues]) {
+        [[HLSTaskManager defaultManager] unregisterDelegateForTask:preloadingTask];
+        [[HLSTaskManager defaultManager] cancelTask:preloadingTask];
+    }
+    [self.preloadingTasks removeAllObjects];
+}
+
+#pragma mark Remote images
+
+// Downloaded images are stored under the hash of their URL
+- (NSString *)remoteImageFilePathForNameOrPath:(NSString *)imageNameOrPath
+{
+    return [self.remoteImageCacheDirectoryPath stringByAppendingPathComponent:[imageNameOrPath md5hash]];
+}
+
+// Read the list of images downloaded by previous runs (in no particular order), and remove incomplete downloads
+- (void)loadRemoteImageCache
+{
+    if (self.remoteImageFileNames) {
+        return;
+    }
+    
+    self.remoteImageFileNames = [NSMutableArray array];
+    
+    NSError *error = nil;
+    if (! [self.remoteImageFileManager fileExistsAtPath:self.remoteImageCacheDirectoryPath]) {
+        if (! [self.remoteImageFileManager createDirectoryAtPath:self.remoteImageCacheDirectoryPath withIntermediateDirectories:YES error:&error]) {
+            HLSLoggerError(@"Could not create the remote image cache directory; reason: %@", error);
         }
-        // The image is more landscape-shaped than self
-        else {
-            zoomScale = CGRectGetHeight(self.frame) / image.size.height;
+        return;
+    }
+    
+    NSArray *fileNames = [self.remoteImageFileManager contentsOfDirectoryAtPath:self.remoteImageCacheDirectoryPath error:&error];
+    if (! fileNames) {
+        HLSLoggerError(@"Could not read the remote image cache directory; reason: %@", error);
+        return;
+    }
+    
+    for (NSString *fileName in fileNames) {
+        if ([[fileName pathExtension] isEqualToString:kSlideshowDownloadFileExtension]) {
+            NSString *filePath = [self.remoteImageCacheDirectoryPath stringByAppendingPathComponent:fileName];
+            [self.remoteImageFileManager removeItemAtPath:filePath error:NULL];
+            continue;
+        }
+        [self.remoteImageFileNames addObject:fileName];
+    }
+}
+
+// Return NO iff the image is a remote one which has not been downloaded yet
+- (BOOL)isImageAvailableWithNameOrPath:(NSString *)imageNameOrPath
+{
+    if (! [HLSSlideshow isRemoteImageNameOrPath:imageNameOrPath]) {
+        return YES;
+    }
+    
+    [self loadRemoteImageCache];
+    return [self.remoteImageFileNames containsObject:[imageNameOrPath md5hash]];
+}
+
+// Mark a downloaded image as the most recently used one
+- (void)touchRemoteImageWithNameOrPath:(NSString *)imageNameOrPath
+{
+    if (! [HLSSlideshow isRemoteImageNameOrPath:imageNameOrPath]) {
+        return;
+    }
+    
+    NSString *fileName = [imageNameOrPath md5hash];
+    if (! [self.remoteImageFileNames containsObject:fileName]) {
+        return;
+    }
+    
+    [self.remoteImageFileNames removeObject:fileName];
+    [self.remoteImageFileNames addObject:fileName];
+}
+
+// Download the remote images which will be displayed soon (in the order in which they will be displayed), and cancel
+// downloads which are not needed anymore
+- (void)prefetchRemoteImages
+{
+    NSMutableArray *windowImageNamesOrPaths = [NSMutableArray array];
+    NSUInteger numberOfImages = [self.imageNamesOrPaths count];
+    if (m_currentImageIndex != kSlideshowNoIndex && m_currentImageIndex < numberOfImages) {
+        [windowImageNamesOrPaths addObject:[self.imageNamesOrPaths objectAtIndex:m_currentImageIndex]];
+    }
+    if (m_nextImageIndex != kSlideshowNoIndex && m_nextImageIndex < numberOfImages) {
+        [windowImageNamesOrPaths addObject:[self.imageNamesOrPaths objectAtIndex:m_nextImageIndex]];
+    }
+    for (NSNumber *imageIndexNumber in self.upcomingImageIndexes) {
+        [windowImageNamesOrPaths addObject:[self.imageNamesOrPaths objectAtIndex:[imageIndexNumber integerValue]]];
+    }
+    
+    for (NSString *imageURLString in [self.downloadTasks allKeys]) {
+        if (! [windowImageNamesOrPaths containsObject:imageURLString]) {
+            [self cancelDownloadTask:[self.downloadTasks objectForKey:imageURLString]];
+            [self.downloadTasks removeObjectForKey:imageURLString];
+        }
+    }
+    
+    for (NSString *imageNameOrPath in windowImageNamesOrPaths) {
+        if ([self isImageAvailableWithNameOrPath:imageNameOrPath] || [self.downloadTasks objectForKey:imageNameOrPath]) {
+            continue;
+        }
+        
+        NSURL *imageURL = [NSURL URLWithString:imageNameOrPath];
+        if (! imageURL) {
+            HLSLoggerWarn(@"Invalid image URL %@", imageNameOrPath);
+            continue;
+        }
+        
+        // Download to a temporary file, so that incomplete downloads are never mistaken for images
+        HLSURLTask *downloadTask = [[[HLSURLTask alloc] initWithRequest:[NSURLRequest requestWithURL:imageURL]] autorelease];
+        downloadTask.downloadFilePath = [[self remoteImageFilePathForNameOrPath:imageNameOrPath] stringByAppendingPathExtension:kSlideshowDownloadFileExtension];
+        downloadTask.fileManager = self.remoteImageFileManager;
+        [self.downloadTasks setObject:downloadTask forKey:imageNameOrPath];
+        [[HLSTaskManager defaultManager] registerDelegate:self forTask:downloadTask];
+        [[HLSTaskManager defaultManager] submitTask:downloadTask];
+    }
+    
+    [self trimRemoteImageCacheKeepingImageNamesOrPaths:windowImageNamesOrPaths];
+}
+
+// Remove the least recently used downloaded images until the cache capacity is met, except the ones given
+- (void)trimRemoteImageCacheKeepingImageNamesOrPaths:(NSArray *)imageNamesOrPaths
+{
+    if ([self.remoteImageFileNames count] <= self.remoteImageCacheCapacity) {
+        return;
+    }
+    
+    NSMutableSet *keptFileNames = [NSMutableSet set];
+    for (NSString *imageNameOrPath in imageNamesOrPaths) {
+        if ([HLSSlideshow isRemoteImageNameOrPath:imageNameOrPath]) {
+            [keptFileNames addObject:[imageNameOrPath md5hash]];
         }
     }
     
+    for (NSString *fileName in [NSArray arrayWithArray:self.remoteImageFileNames]) {
+        if ([self.remoteImageFileNames count] <= self.remoteImageCacheCapacity) {
+            break;
+        }
+        
+        if ([keptFileNames containsObject:fileName]) {
+            continue;
+        }
+        
+        NSString *filePath = [self.remoteImageCacheDirectoryPath stringByAppendingPathComponent:fileName];
+        [self.remoteImageFileManager removeItemAtPath:filePath error:NULL];
+        [self.remoteImageFileNames removeObject:fileName];
+    }
+}
+
+// Cancel a download and remove the partially downloaded file. A connection which was just about to start might still
+// create the file afterwards, in which case it is removed when the cache is loaded again
+- (void)cancelDownloadTask:(HLSURLTask *)downloadTask
+{
+    [[HLSTaskManager defaultManager] unregisterDelegateForTask:downloadTask];
+    [[HLSTaskManager defaultManager] cancelTask:downloadTask];
+    
+    if ([self.remoteImageFileManager fileExistsAtPath:downloadTask.downloadFilePath]) {
+        [self.remoteImageFileManager removeItemAtPath:downloadTask.downloadFilePath error:NULL];
+    }
+}
+
+- (void)cancelDownloads
+{
+    for (HLSURLTask *downloadTask in [self.downloadTasks allValues]) {
+        [self cancelDownloadTask:downloadTask];
+    }
+    [self.downloadTasks removeAllObjects];
+}
+
+#pragma mark Image views
+
+// Setup an image view to display a given image. The image view frame is adjusted to get an aspect fill / aspect fit
+// behavior for the image view, and is centered in self. The view alpha is reset to 1
+- (void)prepareImageView:(UIImageView *)imageView withImageNameOrPath:(NSString *)imageNameOrPath
+{
+    UIImage *image = [self imageForNameOrPath:imageNameOrPath];
+    [self touchRemoteImageWithNameOrPath:imageNameOrPath];
+    
+    BOOL aspectFit = (self.effect == HLSSlideshowEffectNone || self.effect == HLSSlideshowEffectCrossDissolve);
+    CGFloat zoomScale = HLSSlideshowZoomScale(image.size, self.frame.size, aspectFit);
+    
     // Update the image view to match the image dimensions with an aspect fill behavior inside self
     CGFloat scaledImageWidth = ceilf(image.size.width * zoomScale);
     CGFloat scaledImageHeight = ceilf(image.size.height * zoomScale);
@@ -672,28 +1130,69 @@ static const NSInteger kSlideshowNoIndex = -1;
         }
     }
     animation.delegate = self;
+    
+    // Steps are merged into a single Core Animation track per image view, except when the delegate must be notified
+    // when the transition starts (baked animations do not report individual steps)
+    animation.baked = ! [self.delegate respondsToSelector:@selector(slideshow:willHideImageWithNameOrPath:)]
+        && ! [self.delegate respondsToSelector:@selector(slideshow:willShowImageWithNameOrPath:)];
+    
     return animation;
 }
 
-- (void)playNextAnimation
+// Return the index of the image to be displayed after the one at imageIndex
+- (NSInteger)followingImageIndexForImageIndex:(NSInteger)imageIndex
 {
     NSUInteger numberOfImages = [self.imageNamesOrPaths count];
-    NSAssert(numberOfImages != 0, @"Cannot be called when no images have been loaded");
-    
     if (self.random) {
         if (numberOfImages > 1) {
             // Avoid displaying the same image twice in a row
-            m_currentImageIndex = m_nextImageIndex;
-            m_nextImageIndex = [self randomIndexWithUpperBound:numberOfImages forbiddenIndex:m_currentImageIndex];
+            return [self randomIndexWithUpperBound:numberOfImages forbiddenIndex:imageIndex];
         }
         else {
-            m_currentImageIndex = 0;
-            m_nextImageIndex = 0;
+            return 0;
         }
     }
     else {
-        m_currentImageIndex = (m_currentImageIndex + 1) % numberOfImages;
-        m_nextImageIndex = (m_currentImageIndex + 1) % numberOfImages;
+        return (imageIndex + 1) % numberOfImages;
+    }
+}
+
+- (void)playNextAnimation
+{
+    NSUInteger numberOfImages = [self.imageNamesOrPaths count];
+    NSAssert(numberOfImages != 0, @"Cannot be called when no images have been loaded");
+    
+    if (m_nextImageIndex != kSlideshowNoIndex) {
+        m_currentImageIndex = m_nextImageIndex;
+    }
+    // The image set has been changed
+    else {
+        m_currentImageIndex = [self followingImageIndexForImageIndex:m_currentImageIndex];
+    }
+    
+    // Use the upcoming images in order. Remote images which have not been downloaded yet are skipped, except if no
+    // upcoming image is available
+    NSUInteger upcomingPosition = NSNotFound;
+    for (NSUInteger i = 0; i < [self.upcomingImageIndexes count]; ++i) {
+        NSInteger imageIndex = [[self.upcomingImageIndexes objectAtIndex:i] integerValue];
+        if (imageIndex != m_currentImageIndex 
+                && [self isImageAvailableWithNameOrPath:[self.imageNamesOrPaths objectAtIndex:imageIndex]]) {
+            upcomingPosition = i;
+            break;
+        }
+    }
+    if (upcomingPosition == NSNotFound && [self.upcomingImageIndexes count] != 0
+            && [[self.upcomingImageIndexes objectAtIndex:0] integerValue] != m_currentImageIndex) {
+        upcomingPosition = 0;
+    }
+    
+    if (upcomingPosition != NSNotFound) {
+        m_nextImageIndex = [[self.upcomingImageIndexes objectAtIndex:upcomingPosition] integerValue];
+        [self.upcomingImageIndexes removeObjectsInRange:NSMakeRange(0, upcomingPosition + 1)];
+    }
+    else {
+        [self.upcomingImageIndexes removeAllObjects];
+        m_nextImageIndex = [self followingImageIndexForImageIndex:m_currentImageIndex];
     }
     
     [self animateImages];
@@ -704,6 +1203,9 @@ static const NSInteger kSlideshowNoIndex = -1;
     NSUInteger numberOfImages = [self.imageNamesOrPaths count];
     NSAssert(numberOfImages != 0, @"Cannot be called when no images have been loaded");
     
+    // The upcoming images are not the same anymore
+    [self.upcomingImageIndexes removeAllObjects];
+    
     NSUInteger imageIndex = [self.imageNamesOrPaths indexOfObject:imageNameOrPath];
     if (imageIndex == NSNotFound) {
         HLSLoggerWarn(@"The image %@ does not appear in the slideshow image list", imageNameOrPath);
@@ -734,6 +1236,9 @@ static const NSInteger kSlideshowNoIndex = -1;
     NSUInteger numberOfImages = [self.imageNamesOrPaths count];
     NSAssert(numberOfImages != 0, @"Cannot be called when no images have been loaded");
     
+    // The upcoming images are not the same anymore
+    [self.upcomingImageIndexes removeAllObjects];
+    
     if (self.random) {
         if (numberOfImages > 1) {
             // Avoid displaying the same image twice in a row
@@ -758,6 +1263,9 @@ static const NSInteger kSlideshowNoIndex = -1;
     NSUInteger numberOfImages = [self.imageNamesOrPaths count];
     NSAssert(numberOfImages != 0, @"Cannot be called when no images have been loaded");
     
+    // The upcoming images are not the same anymore
+    [self.upcomingImageIndexes removeAllObjects];
+    
     if (self.random) {
         if (numberOfImages > 1) {
             // Avoid displaying the same image twice in a row
@@ -800,6 +1308,8 @@ static const NSInteger kSlideshowNoIndex = -1;
                              currentImageView:currentImageView
                                 nextImageView:nextImageView];
     [self.animation playAnimated:YES];
+    
+    [self preloadImages];
 }
 
 #pragma mark Miscellaneous
@@ -815,6 +1325,57 @@ static const NSInteger kSlideshowNoIndex = -1;
     return randomIndex;
 }
 
+#pragma mark HLSTaskDelegate protocol implementation
+
+- (void)taskHasBeenProcessed:(HLSTask *)task
+{
+    if ([task isKindOfClass:[HLSURLTask class]]) {
+        NSString *imageURLString = [[self.downloadTasks allKeysForObject:task] lastObject];
+        if (! imageURLString) {
+            return;
+        }
+        [self.downloadTasks removeObjectForKey:imageURLString];
+        
+        HLSURLTask *downloadTask = (HLSURLTask *)task;
+        NSString *filePath = [self remoteImageFilePathForNameOrPath:imageURLString];
+        if (task.error) {
+            HLSLoggerWarn(@"Could not download image %@; reason: %@", imageURLString, task.error);
+            [self.remoteImageFileManager removeItemAtPath:downloadTask.downloadFilePath error:NULL];
+            return;
+        }
+        
+        NSError *error = nil;
+        if ([self.remoteImageFileManager fileExistsAtPath:filePath]) {
+            [self.remoteImageFileManager removeItemAtPath:filePath error:NULL];
+        }
+        if (! [self.remoteImageFileManager moveItemAtPath:downloadTask.downloadFilePath toPath:filePath error:&error]) {
+            HLSLoggerWarn(@"Could not store image %@; reason: %@", imageURLString, error);
+            return;
+        }
+        
+        [self loadRemoteImageCache];
+        if (! [self.remoteImageFileNames containsObject:[filePath lastPathComponent]]) {
+            [self.remoteImageFileNames addObject:[filePath lastPathComponent]];
+        }
+        
+        // The image might be the next one to be decoded
+        [self preloadImages];
+        return;
+    }
+    
+    NSDictionary *imageInfo = [(HLSInvocationTask *)task object];
+    NSString *imageNameOrPath = [imageInfo objectForKey:@"imageNameOrPath"];
+    if ([self.preloadingTasks objectForKey:imageNameOrPath] != task) {
+        return;
+    }
+    
+    UIImage *image = [imageInfo objectForKey:@"image"];
+    if (image) {
+        [[HLSImageCache sharedImageCache] setImage:image forKey:[imageInfo objectForKey:@"cacheKey"]];
+    }
+    [self.preloadingTasks removeObjectForKey:imageNameOrPath];
+}
+
 #pragma mark HLSAnimationDelegate protocol implementation
 
 - (void)animation:(HLSAnimation *)animation didFinishStep:(HLSAnimationStep *)animationStep animated:(BOOL)animated
@@ -855,3 +1416,35 @@ static const NSInteger kSlideshowNoIndex = -1;
 }
 
 @end
+
+#pragma mark Static functions
+
+// Return the scale which needs to be applied to an image to get aspect fit (or aspect fill) behavior in a frame
+// TODO: This code is quite common (most notably in PDF generator code). Factor it somewhere where it can easily
+//       be reused
+static CGFloat HLSSlideshowZoomScale(CGSize imageSize, CGSize frameSize, BOOL aspectFit)
+{
+    // Aspect ratios of frame and image
+    CGFloat frameRatio = frameSize.width / frameSize.height;
+    CGFloat imageRatio = imageSize.width / imageSize.height;
+    if (aspectFit) {
+        // The image is more portrait-shaped than the frame
+        if (floatlt(imageRatio, frameRatio)) {
+            return frameSize.height / imageSize.height;
+        }
+        // The image is more landscape-shaped than the frame
+        else {
+            return frameSize.width / imageSize.width;
+        }
+    }
+    else {
+        // The image is more portrait-shaped than the frame
+        if (floatlt(imageRatio, frameRatio)) {
+            return frameSize.width / imageSize.width;
+        }
+        // The image is more landscape-shaped than the frame
+        else {
+            return frameSize.height / imageSize.height;
+        }
+    }
+}
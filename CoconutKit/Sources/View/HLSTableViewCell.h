@@ -91,6 +91,14 @@
 + (CGFloat)width;
 + (CGSize)size;
 
+/**
+ * Dimensions are calculated once per class and cached. Call this method on a subclass to discard the dimensions
+ * cached for it (e.g. if the cell layout depends on settings which have changed), or on HLSTableViewCell to discard 
+ * the dimensions cached for all classes. Cached dimensions are automatically discarded when the localization changes
+ * Not meant to be overridden
+ */
++ (void)invalidateSize;
+
 /**
  * If the cell layout is created using Interface Builder, override this accessor to return the name of the associated xib
  * file. This is not needed if the xib file name is identical to the class name
@@ -11,13 +11,21 @@
 #import "HLSLogger.h"
 #import "HLSTableViewCell+Protected.h"
 #import "NSArray+HLSExtensions.h"
+#import "NSBundle+HLSDynamicLocalization.h"
 #import "NSObject+HLSExtensions.h"
 
 static NSMutableDictionary *s_classNameToSizeMap = nil;
+static NSMutableDictionary *s_classNameToNibMap = nil;
 
 @interface HLSTableViewCell ()
 
 + (NSString *)findNibName;
++ (UINib *)nib;
+
+- (UIImageView *)backgroundImageViewWithImage:(UIImage *)image reusingView:(UIView *)view;
+
++ (void)applicationDidReceiveMemoryWarning:(NSNotification *)notification;
++ (void)currentLocalizationDidChange:(NSNotification *)notification;
 
 @end
 
@@ -34,6 +42,19 @@ static NSMutableDictionary *s_classNameToSizeMap = nil;
     
     // The size map is common for the whole HLSTableViewCell inheritance hierarchy
     s_classNameToSizeMap = [[NSMutableDictionary dictionary] retain];
+    
+    // Same for the nib cache. Nibs can be parsed again when needed, release them when memory gets low
+    s_classNameToNibMap = [[NSMutableDictionary dictionary] retain];
+    [[NSNotificationCenter defaultCenter] addObserver:self
+                                             selector:@selector(applicationDidReceiveMemoryWarning:)
+                                                 name:UIApplicationDidReceiveMemoryWarningNotification
+                                               object:nil];
+    
+    // Localized nibs might have different dimensions
+    [[NSNotificationCenter defaultCenter] addObserver:self
+                                             selector:@selector(currentLocalizationDidChange:)
+                                                 name:HLSCurrentLocalizationDidChangeNotification
+                                               object:nil];
 }
 
 + (id)cellForTableView:(UITableView *)tableView
@@ -43,11 +64,12 @@ static NSMutableDictionary *s_classNameToSizeMap = nil;
     
     // If not, create one lazily
     if (! cell) {
-        NSString *nibName = [self findNibName];
+        UINib *nib = [self nib];
         
         // A xib file is used
-        if (nibName) {
-            NSArray *bundleContents = [[NSBundle mainBundle] loadNibNamed:nibName owner:nil options:nil];
+        if (nib) {
+            NSString *nibName = [self findNibName];
+            NSArray *bundleContents = [nib instantiateWithOwner:nil options:nil];
             if ([bundleContents count] == 0) {
                 HLSLoggerError(@"Missing cell object in xib file %@", nibName);
                 return nil;
@@ -86,25 +108,41 @@ static NSMutableDictionary *s_classNameToSizeMap = nil;
     if (backgroundImageName) {
         UIImage *backgroundImage = [UIImage imageNamed:backgroundImageName];
         if (backgroundImage) {
-            self.backgroundView = [[[UIImageView alloc] initWithImage:backgroundImage] autorelease];
+            self.backgroundView = [self backgroundImageViewWithImage:backgroundImage reusingView:self.backgroundView];
         }
         else {
             HLSLoggerWarn(@"The image %@ does not exist", backgroundImageName);
             self.backgroundView = nil;
         }
-        
     }
     
     if (selectedBackgroundImageName) {
         UIImage *selectedBackgroundImage = [UIImage imageNamed:selectedBackgroundImageName];
         if (selectedBackgroundImage) {
-            self.selectedBackgroundView = [[[UIImageView alloc] initWithImage:selectedBackgroundImage] autorelease];
+            self.selectedBackgroundView = [self backgroundImageViewWithImage:selectedBackgroundImage 
+                                                                 reusingView:self.selectedBackgroundView];
         }
         else {
-            HLSLoggerWarn(@"The image %@ does not exist", selectedBackgroundImage);
+            HLSLoggerWarn(@"The image %@ does not exist", selectedBackgroundImageName);
             self.selectedBackgroundView = nil;
         }
-        self.selectedBackgroundView = [[[UIImageView alloc] initWithImage:selectedBackgroundImage] autorelease];
+    }
+}
+
+// Images returned by +[UIImage imageNamed:] are cached and shared, and so are their bitmaps, which image views displaying
+// them use as layer contents. The only objects created per cell are therefore the image views, and those are reused 
+// when the background is set again (e.g. when a dequeued cell is configured)
+- (UIImageView *)backgroundImageViewWithImage:(UIImage *)image reusingView:(UIView *)view
+{
+    if ([view isMemberOfClass:[UIImageView class]]) {
+        UIImageView *imageView = (UIImageView *)view;
+        if (imageView.image != image) {
+            imageView.image = image;
+        }
+        return imageView;
+    }
+    else {
+        return [[[UIImageView alloc] initWithImage:image] autorelease];
     }
 }
 
@@ -134,6 +172,16 @@ static NSMutableDictionary *s_classNameToSizeMap = nil;
     return [cellSizeValue CGSizeValue];
 }
 
++ (void)invalidateSize
+{
+    if (self == [HLSTableViewCell class]) {
+        [s_classNameToSizeMap removeAllObjects];
+    }
+    else {
+        [s_classNameToSizeMap removeObjectForKey:[self className]];
+    }
+}
+
 + (NSString *)nibName
 {
     // Return nil by default (since can be created programmatically)
@@ -162,4 +210,30 @@ static NSMutableDictionary *s_classNameToSizeMap = nil;
     return nibName;
 }
 
+// Return the (cached) nib for the class, nil if the cell is created programmatically. Instantiating from a UINib avoids 
+// reading and parsing the nib file for each cell which cannot be dequeued
++ (UINib *)nib
+{
+    id nib = [s_classNameToNibMap objectForKey:[self className]];
+    if (! nib) {
+        NSString *nibName = [self findNibName];
+        nib = nibName ? [UINib nibWithNibName:nibName bundle:nil] : [NSNull null];
+        [s_classNameToNibMap setObject:nib forKey:[self className]];
+    }
+    return [nib isKindOfClass:[UINib class]] ? nib : nil;
+}
+
+#pragma mark Notification callbacks
+
++ (void)applicationDidReceiveMemoryWarning:(NSNotification *)notification
+{
+    [s_classNameToNibMap removeAllObjects];
+}
+
++ (void)currentLocalizationDidChange:(NSNotification *)notification
+{
+    [s_classNameToNibMap removeAllObjects];
+    [HLSTableViewCell invalidateSize];
+}
+
 @end
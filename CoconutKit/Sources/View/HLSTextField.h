@@ -14,7 +14,9 @@
  *
  * Most notably, when wrapped within a scroll view (either as direct parent view or higher in the view hierarchy),
  * the scroll view is automatically applied an offset so that the field stays completely visible (vertically) when 
- * the keyboard is displayed. When exiting input mode, the original scroll view offset is restored. Moreover, such
+ * the keyboard is displayed. Its bottom content inset is also enlarged to match the area covered by the keyboard,
+ * so that the whole form can still be scrolled. Both changes are animated along with the keyboard. When exiting 
+ * input mode, the original scroll view offset and insets are restored. Moreover, such
  * text fields allow the user to exit edit mode by tapping outside the text field (this behavior is enabled by
  * default).
  *
@@ -0,0 +1,64 @@
+//
+//  HLSTextFieldKeyboardCoordinator.h
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+// Forward declarations
+@class HLSTextField;
+
+/**
+ * Private class for implementation purposes. A single coordinator observes keyboard notifications on behalf of all
+ * HLSTextField objects, keeps track of the active one, and adjusts the bottommost scroll view enclosing it so that
+ * the field stays visible. The content inset and content offset changes are applied in a single animation, using
+ * the keyboard animation duration and curve.
+ *
+ * The bottommost scroll view enclosing a text field is cached. The cache entry of a field must be invalidated when
+ * it is moved to another superview or window, and when it is deallocated.
+ *
+ * Not meant to be instantiated directly. Simply use the +sharedCoordinator class method.
+ */
+@interface HLSTextFieldKeyboardCoordinator : NSObject {
+@private
+    HLSTextField *m_activeTextField;
+    UIScrollView *m_scrollView;
+    CGFloat m_originalYOffset;
+    UIEdgeInsets m_originalContentInset;
+    UIEdgeInsets m_originalScrollIndicatorInsets;
+    CFMutableDictionaryRef m_textFieldToScrollViewMap;
+    BOOL m_adjustmentPending;
+    BOOL m_deactivating;
+}
+
+/**
+ * The shared coordinator
+ */
++ (HLSTextFieldKeyboardCoordinator *)sharedCoordinator;
+
+/**
+ * The text field currently active, nil if none
+ */
+@property (nonatomic, readonly, assign) HLSTextField *activeTextField;
+
+/**
+ * Must be called before, respectively after the super implementation of -becomeFirstResponder is called on a text
+ * field. The keyboard notifications received in between correspond to the keyboard being displayed
+ */
+- (void)textFieldWillBecomeActive:(HLSTextField *)textField;
+- (void)textFieldDidBecomeActive:(HLSTextField *)textField;
+
+/**
+ * Must be called before, respectively after the super implementation of -resignFirstResponder is called on the
+ * active text field. The keyboard notifications received in between correspond to the keyboard being dismissed
+ */
+- (void)textFieldWillBecomeInactive:(HLSTextField *)textField;
+- (void)textFieldDidBecomeInactive:(HLSTextField *)textField;
+
+/**
+ * Discard the scroll view cached for a text field
+ */
+- (void)invalidateScrollViewForTextField:(HLSTextField *)textField;
+
+@end
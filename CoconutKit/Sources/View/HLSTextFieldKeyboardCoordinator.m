@@ -0,0 +1,437 @@
+//
+//  HLSTextFieldKeyboardCoordinator.m
+//  CoconutKit
+//
+//  Created by Samuel Défago on 14.10.12.
+//  Copyright (c) 2012 Hortis. All rights reserved.
+//
+
+#import "HLSTextFieldKeyboardCoordinator.h"
+
+#import "HLSFloat.h"
+#import "HLSKeyboardInformation.h"
+#import "HLSTextField.h"
+
+/**
+ * Test workflow:
+ * --------------
+ * To understand this code, create a form with at least two HLSTextFields, supporting all orientations. Then debug the
+ * code using the following test workflow (covering all possible cases). Setting a breakpoint on each method can
+ * help you understand when each method gets called and why:
+ *   1) With the keyboard dismissed, click on a field A (A receives becomeFirstResponder, keyboardWillShow: is received
+ *      while A is becoming active)
+ *   2) Rotate the device (keyboardWillHide:, then keyboardWillShow: are received while A is active)
+ *   3) Click on another field B (B receives becomeFirstResponder, which calls resignFirstResponder on A. No keyboard
+ *      notification is received)
+ *   4) Rotate the device (keyboardWillHide:, then keyboardWillShow: are received while B is active)
+ *   5) Dismiss the keyboard (B receives resignFirstResponder, keyboardWillHide: is received while B is becoming
+ *      inactive)
+ */
+
+// Animation settings used when no keyboard animation is available
+static const NSTimeInterval kTextFieldDefaultAnimationDuration = 0.25;
+static const UIViewAnimationCurve kTextFieldDefaultAnimationCurve = UIViewAnimationCurveEaseInOut;
+
+@interface HLSTextFieldKeyboardCoordinator ()
+
+@property (nonatomic, assign) HLSTextField *activeTextField;
+
+- (UIScrollView *)scrollViewForTextField:(HLSTextField *)textField;
+
+- (void)adjustScrollViewForTextField:(HLSTextField *)textField
+                    keyboardEndFrame:(CGRect)keyboardEndFrame
+                   animationDuration:(NSTimeInterval)animationDuration
+                      animationCurve:(UIViewAnimationCurve)animationCurve;
+- (void)restoreScrollViewWithAnimationDuration:(NSTimeInterval)animationDuration
+                                animationCurve:(UIViewAnimationCurve)animationCurve;
+
+- (void)keyboardWillShow:(NSNotification *)notification;
+- (void)keyboardWillHide:(NSNotification *)notification;
+
+@end
+
+// Function declarations
+static void applyScrollViewGeometry(UIScrollView *scrollView, CGPoint contentOffset, UIEdgeInsets contentInset,
+                                    UIEdgeInsets scrollIndicatorInsets, NSTimeInterval animationDuration,
+                                    UIViewAnimationCurve animationCurve);
+
+@implementation HLSTextFieldKeyboardCoordinator
+
+#pragma mark Class methods
+
++ (HLSTextFieldKeyboardCoordinator *)sharedCoordinator
+{
+    static HLSTextFieldKeyboardCoordinator *s_instance = nil;
+    if (! s_instance) {
+        s_instance = [[HLSTextFieldKeyboardCoordinator alloc] init];
+    }
+    return s_instance;
+}
+
+#pragma mark Object creation and destruction
+
+- (id)init
+{
+    if ((self = [super init])) {
+        // Keys are not retained. Fields remove their entry when they are deallocated
+        m_textFieldToScrollViewMap = CFDictionaryCreateMutable(kCFAllocatorDefault, 0, NULL, NULL);
+
+        // Register once for all text fields. Note that when the keyboard is visible and the device is rotated,
+        // we get a hide and a show notifications (keyboard with first orientation is dismissed, keyboard with
+        // new orientation is displayed again)
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(keyboardWillShow:)
+                                                     name:UIKeyboardWillShowNotification
+                                                   object:nil];
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(keyboardWillHide:)
+                                                     name:UIKeyboardWillHideNotification
+                                                   object:nil];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+
+    CFRelease(m_textFieldToScrollViewMap);
+    m_textFieldToScrollViewMap = NULL;
+
+    [super dealloc];
+}
+
+#pragma mark Accessors and mutators
+
+@synthesize activeTextField = m_activeTextField;
+
+#pragma mark Tracking the active text field
+
+- (void)textFieldWillBecomeActive:(HLSTextField *)textField
+{
+    // We must update the active text field before the super becomeFirstResponder method is called. The reason is that
+    // when switching between text fields, the becomeFirstResponder of the new field is called, and when its super
+    // becomeFirstResponder method is called, it calls the resignFirstResponder method of the old text field! But in
+    // the old text field resignFirstResponder method, we want to know the identity of the new field
+    self.activeTextField = textField;
+
+    // If the keyboard is about to be displayed, the adjustment will be made when the keyboard notification is
+    // received, so that the scroll view moves in step with the keyboard
+    m_adjustmentPending = YES;
+}
+
+- (void)textFieldDidBecomeActive:(HLSTextField *)textField
+{
+    if (textField != self.activeTextField || ! m_adjustmentPending) {
+        return;
+    }
+    m_adjustmentPending = NO;
+
+    // No keyboard notification was received (the keyboard was already displayed or is floating). Use the keyboard
+    // animation settings if available
+    HLSKeyboardInformation *keyboardInformation = [HLSKeyboardInformation keyboardInformation];
+    if (keyboardInformation) {
+        [self adjustScrollViewForTextField:textField
+                          keyboardEndFrame:keyboardInformation.endFrame
+                         animationDuration:keyboardInformation.animationDuration
+                            animationCurve:keyboardInformation.animationCurve];
+    }
+    else {
+        [self adjustScrollViewForTextField:textField
+                          keyboardEndFrame:CGRectNull
+                         animationDuration:kTextFieldDefaultAnimationDuration
+                            animationCurve:kTextFieldDefaultAnimationCurve];
+    }
+}
+
+- (void)textFieldWillBecomeInactive:(HLSTextField *)textField
+{
+    if (textField != self.activeTextField) {
+        return;
+    }
+
+    m_deactivating = YES;
+}
+
+- (void)textFieldDidBecomeInactive:(HLSTextField *)textField
+{
+    if (textField != self.activeTextField) {
+        return;
+    }
+
+    // If no keyboard notification was received while resigning (floating keyboard), restore the scroll view now
+    HLSKeyboardInformation *keyboardInformation = [HLSKeyboardInformation keyboardInformation];
+    if (keyboardInformation) {
+        [self restoreScrollViewWithAnimationDuration:keyboardInformation.animationDuration
+                                      animationCurve:keyboardInformation.animationCurve];
+    }
+    else {
+        [self restoreScrollViewWithAnimationDuration:kTextFieldDefaultAnimationDuration
+                                      animationCurve:kTextFieldDefaultAnimationCurve];
+    }
+
+    self.activeTextField = nil;
+    m_adjustmentPending = NO;
+    m_deactivating = NO;
+}
+
+#pragma mark Locating a scroll view and using it to keep the text field visible
+
+/**
+ * When a text field must be made visible, we climb up the view hierarchy to find the bottommost scroll view (i.e. the
+ * one which is not contained in any other scroll view). This is the one we adjust to make the field visible. Originally
+ * the nearest parent scroll view of a text field was used, but this was a bad idea (it is easier to couple scroll
+ * view motions vertically if using the bottommost one)
+ *
+ * The result is cached per text field (a missing scroll view is cached as well). Walking up the view hierarchy
+ * is only needed again when the field has been moved
+ *
+ * Remark:
+ * To keep a field visible, some implementations directly move the parent view (not the content offset of a scroll view).
+ * This is only possible in a view controller implementation, where the UI appearance is precisely known (since managed
+ * by the view controller). Here, to get the same behavior without a using view controller (i.e. we cannot know how the UI is
+ * supposed to look, which fields are grouped, etc.), we cannot simply adjust the parent view frame. What we need is a
+ * way to identify which view up the caller hierarchy can be adjusted when some of its content needs to stay visible.
+ * The most natural such object is the scroll view.
+ */
+- (UIScrollView *)scrollViewForTextField:(HLSTextField *)textField
+{
+    const void *cachedScrollView = NULL;
+    if (CFDictionaryGetValueIfPresent(m_textFieldToScrollViewMap, textField, &cachedScrollView)) {
+        // Cheap sanity check in case an ancestor has been moved to another parent within the same window
+        if (! cachedScrollView || [textField isDescendantOfView:(UIScrollView *)cachedScrollView]) {
+            return (UIScrollView *)cachedScrollView;
+        }
+    }
+
+    UIScrollView *bottomMostScrollView = nil;
+    UIView *parentView = [textField superview];
+    while (parentView) {
+        if ([parentView isKindOfClass:[UIScrollView class]]) {
+            bottomMostScrollView = (UIScrollView *)parentView;
+        }
+        parentView = [parentView superview];
+    }
+
+    CFDictionarySetValue(m_textFieldToScrollViewMap, textField, bottomMostScrollView);
+    return bottomMostScrollView;
+}
+
+- (void)invalidateScrollViewForTextField:(HLSTextField *)textField
+{
+    CFDictionaryRemoveValue(m_textFieldToScrollViewMap, textField);
+}
+
+/**
+ * Make the text field visible by adjusting the content inset and offset of its bottommost enclosing scroll view (if
+ * needed and if a scroll view is available). Pass CGRectNull as keyboard frame if no keyboard is docked
+ */
+- (void)adjustScrollViewForTextField:(HLSTextField *)textField
+                    keyboardEndFrame:(CGRect)keyboardEndFrame
+                   animationDuration:(NSTimeInterval)animationDuration
+                      animationCurve:(UIViewAnimationCurve)animationCurve
+{
+    UIScrollView *scrollView = [self scrollViewForTextField:textField];
+
+    // If a different scroll view was already adjusted, restore it. We must adjust at most one scroll view at a time,
+    // and we are done with the old one since the field we are now tracking is wrapped in another scroll view
+    if (m_scrollView != scrollView) {
+        [self restoreScrollViewWithAnimationDuration:animationDuration animationCurve:animationCurve];
+
+        // Changing scroll view. Save its original geometry to be able to restore it later. Saving the original offset
+        // (and not the total offset which is applied) is made on purpose. Animations which have not ended when others
+        // are started (especially when we fast switch between fields) make the total offset unreliable
+        if (scrollView) {
+            m_originalYOffset = scrollView.contentOffset.y;
+            m_originalContentInset = scrollView.contentInset;
+            m_originalScrollIndicatorInsets = scrollView.scrollIndicatorInsets;
+        }
+        m_scrollView = scrollView;
+    }
+
+    // If no scroll view found, we are done
+    if (! m_scrollView) {
+        return;
+    }
+
+    CGPoint contentOffset = m_scrollView.contentOffset;
+    UIEdgeInsets contentInset = m_originalContentInset;
+    UIEdgeInsets scrollIndicatorInsets = m_originalScrollIndicatorInsets;
+
+    // Text field frame in the scroll view coordinate system
+    CGRect frameInScrollView = [textField convertRect:textField.bounds toView:m_scrollView];
+
+    // Work in the scroll view coordinate system
+    // Remark: Initially, I intended to work in the window coordinate system, but this is a bad idea
+    //         (the window coordinate system is in portrait mode, and this does not make conversion
+    //         of coordinates easy for views displayed in landscape mode). But we can pick any
+    //         coordinate system (as long as all coordinates are converted back to it, of course),
+    //         and the most natural is the scroll view coordinate system
+    CGRect keyboardFrameInScrollView = CGRectNull;
+    if (! CGRectIsNull(keyboardEndFrame)) {
+        keyboardFrameInScrollView = [m_scrollView convertRect:keyboardEndFrame fromView:nil];
+
+        // Inset the content by the height of the scroll view area covered by the keyboard, so that the whole content
+        // can be scrolled above it
+        CGFloat coveredHeight = CGRectGetMaxY(m_scrollView.bounds) - CGRectGetMinY(keyboardFrameInScrollView);
+        if (floatgt(coveredHeight, contentInset.bottom)) {
+            contentInset.bottom = coveredHeight;
+        }
+        if (floatgt(coveredHeight, scrollIndicatorInsets.bottom)) {
+            scrollIndicatorInsets.bottom = coveredHeight;
+        }
+    }
+
+    // If the text field is hidden at the top, adjust the scroll view offset to make it visible; must take
+    // the current offset (if any) into account
+    CGFloat yOffsetTop = frameInScrollView.origin.y - contentOffset.y - textField.minVisibilityDistance;
+    if (floatle(yOffsetTop, 0.f)) {
+        contentOffset.y += yOffsetTop;
+    }
+    else if (! CGRectIsNull(keyboardFrameInScrollView)) {
+        // Find if the text field is covered by the keyboard, and scroll if this is the case
+        //
+        //                                                  Scroll view
+        //                                     +    +--------------------------+    +
+        //                                     |    |                          |    |
+        //      a (text field origin in scroll |    |                          |    | b (keyboard origin in scroll)
+        //         view coordinate system)     |    |                          |    |    view coordinate system)
+        //                                     |    |                          |    |
+        //                                     |    |                          |    |
+        //                                     +    |   +---------+            |    |        +
+        //                                          |   |  Field  |            |    |        |   f (text field height)
+        //                                          |   +---------+            |    |        +
+        //                                          |                          |    |
+        //                                          |                          |    |
+        //                                          +--------------------------+    +
+        //                                          |                          |
+        //                                          |         Keyboard         |
+        //                                          |                          |
+        //                                          +--------------------------+
+        //
+        //
+        // Let d be the minimal distance to be kept between text field and keyboard. Then, in order for the field to
+        // be visible, we must have:
+        //   a + f + d < b
+        // or
+        //   a + f + d - b < 0
+        // Let delta := a + f + d - b, then we must shift the scroll view content offset if this condition is not satisfied,
+        // i.e. when
+        //   delta >= 0
+        // The shift to apply is just delta
+        CGFloat yOffset = frameInScrollView.origin.y + frameInScrollView.size.height + textField.minVisibilityDistance
+            - keyboardFrameInScrollView.origin.y;
+        if (floatge(yOffset, 0.f)) {
+            contentOffset.y += yOffset;
+        }
+    }
+
+    applyScrollViewGeometry(m_scrollView, contentOffset, contentInset, scrollIndicatorInsets, animationDuration, animationCurve);
+}
+
+/**
+ * Restore the scroll view geometry. Must be called for the same orientation as when the adjustment was made,
+ * otherwise the behavior is undefined
+ */
+- (void)restoreScrollViewWithAnimationDuration:(NSTimeInterval)animationDuration
+                                animationCurve:(UIViewAnimationCurve)animationCurve
+{
+    // If nothing to restore, nothing to do
+    if (! m_scrollView) {
+        return;
+    }
+
+    CGPoint contentOffset = CGPointMake(m_scrollView.contentOffset.x, m_originalYOffset);
+    applyScrollViewGeometry(m_scrollView, contentOffset, m_originalContentInset, m_originalScrollIndicatorInsets,
+                            animationDuration, animationCurve);
+
+    // Done with the scroll view
+    m_scrollView = nil;
+    m_originalYOffset = 0.f;
+    m_originalContentInset = UIEdgeInsetsZero;
+    m_originalScrollIndicatorInsets = UIEdgeInsetsZero;
+}
+
+#pragma mark Notification callbacks
+
+/**
+ * Extremely important: When rotating the interface with the keyboard enabled, the willShow event is fired after the new
+ * orientation has been installed, i.e. coordinates are relative to the new orientation
+ */
+- (void)keyboardWillShow:(NSNotification *)notification
+{
+    if (! self.activeTextField) {
+        return;
+    }
+
+    // Do not rely on HLSKeyboardInformation here, it might not have received the notification yet
+    NSDictionary *userInfo = [notification userInfo];
+    CGRect keyboardEndFrame = CGRectZero;
+    [[userInfo objectForKey:UIKeyboardFrameEndUserInfoKey] getValue:&keyboardEndFrame];
+
+    // Keyboard displayed because a text field is becoming active: Move in step with the keyboard
+    if (m_adjustmentPending) {
+        m_adjustmentPending = NO;
+        [self adjustScrollViewForTextField:self.activeTextField
+                          keyboardEndFrame:keyboardEndFrame
+                         animationDuration:[[userInfo objectForKey:UIKeyboardAnimationDurationUserInfoKey] doubleValue]
+                            animationCurve:[[userInfo objectForKey:UIKeyboardAnimationCurveUserInfoKey] unsignedIntValue]];
+    }
+    // Keyboard displayed again after a rotation: Adjust immediately
+    else {
+        [self adjustScrollViewForTextField:self.activeTextField
+                          keyboardEndFrame:keyboardEndFrame
+                         animationDuration:0.
+                            animationCurve:kTextFieldDefaultAnimationCurve];
+    }
+}
+
+/**
+ * Extremely important: When rotating the interface with the keyboard enabled, the willHide event is fired before the new
+ * orientation has been installed, i.e. coordinates are relative to the old orientation
+ */
+- (void)keyboardWillHide:(NSNotification *)notification
+{
+    if (! self.activeTextField) {
+        return;
+    }
+
+    // Keyboard dismissed because the active text field resigns: Move in step with the keyboard
+    if (m_deactivating) {
+        NSDictionary *userInfo = [notification userInfo];
+        [self restoreScrollViewWithAnimationDuration:[[userInfo objectForKey:UIKeyboardAnimationDurationUserInfoKey] doubleValue]
+                                      animationCurve:[[userInfo objectForKey:UIKeyboardAnimationCurveUserInfoKey] unsignedIntValue]];
+    }
+    // Keyboard dismissed before a rotation: Restore immediately
+    else {
+        [self restoreScrollViewWithAnimationDuration:0. animationCurve:kTextFieldDefaultAnimationCurve];
+    }
+}
+
+@end
+
+#pragma mark Static functions
+
+/**
+ * Apply content offset and insets as a single change, animated if a non-zero duration is given
+ */
+static void applyScrollViewGeometry(UIScrollView *scrollView, CGPoint contentOffset, UIEdgeInsets contentInset,
+                                    UIEdgeInsets scrollIndicatorInsets, NSTimeInterval animationDuration,
+                                    UIViewAnimationCurve animationCurve)
+{
+    BOOL animated = doublegt(animationDuration, 0.);
+    if (animated) {
+        [UIView beginAnimations:nil context:NULL];
+        [UIView setAnimationDuration:animationDuration];
+        [UIView setAnimationCurve:animationCurve];
+        [UIView setAnimationBeginsFromCurrentState:YES];
+    }
+
+    scrollView.contentInset = contentInset;
+    scrollView.scrollIndicatorInsets = scrollIndicatorInsets;
+    scrollView.contentOffset = contentOffset;
+
+    if (animated) {
+        [UIView commitAnimations];
+    }
+}
@@ -43,7 +43,8 @@
  *   [[NSUserDefaults standardUserDefaults] setValue:[NSNumber numberWithBool:YES] forKey:@"NSShowNonLocalizedStrings"];
  *
  * This category integrates with HLSBundle+HLSDynamicLocalization so that localized labels are updated when the 
- * localization language is changed at runtime.
+ * localization language is changed at runtime. Labels currently in a window are updated immediately, other labels
+ * are updated when they are added to a window again.
  *
  * This category currently has three limitations, but which should not be real issues:
  *   - only localization dictionaries in the main bundle are considered. For applications this should not be
@@ -16,6 +16,14 @@
 
 static BOOL s_missingLocalizationsVisible = NO;
 
+// Labels localized with prefixes, and those among them which have not been updated after a localization change
+// because they were not in a window at that time. Labels are not retained
+static CFMutableSetRef s_localizedLabels = NULL;
+static CFMutableSetRef s_outdatedLabels = NULL;
+
+// Labels whose next text update must not be localized (see -setAndLocalizeText:). Labels are not retained
+static CFMutableSetRef s_lockedLabels = NULL;
+
 // Keys for associated objects
 static void *s_localizationInfosKey = &s_localizationInfosKey;
 static void *s_originalBackgroundColorKey = &s_originalBackgroundColorKey;
@@ -25,12 +33,16 @@ static void (*s_UILabel__dealloc_Imp)(id, SEL) = NULL;
 static void (*s_UILabel__awakeFromNib_Imp)(id, SEL) = NULL;
 static void (*s_UILabel__setText_Imp)(id, SEL, id) = NULL;
 static void (*s_UILabel__setBackgroundColor_Imp)(id, SEL, id) = NULL;
+static void (*s_UILabel__didMoveToWindow_Imp)(id, SEL) = NULL;
 
 // Swizzled method implementations
 static void swizzled_UILabel__dealloc_Imp(UILabel *self, SEL _cmd);
 static void swizzled_UILabel__awakeFromNib_Imp(UILabel *self, SEL _cmd);
 static void swizzled_UILabel__setText_Imp(UILabel *self, SEL _cmd, NSString *text);
 static void swizzled_UILabel__setBackgroundColor_Imp(UILabel *self, SEL _cmd, UIColor *backgroundColor);
+static void swizzled_UILabel__didMoveToWindow_Imp(UILabel *self, SEL _cmd);
+
+static BOOL textHasLocalizationPrefix(NSString *text);
 
 @interface UILabel (HLSDynamicLocalizationPrivate)
 
@@ -40,7 +52,7 @@ static void swizzled_UILabel__setBackgroundColor_Imp(UILabel *self, SEL _cmd, UI
 - (void)setAndLocalizeText:(NSString *)text;
 - (void)localizeTextWithLocalizationInfo:(HLSLabelLocalizationInfo *)localizationInfo;
 
-- (void)currentLocalizationDidChange:(NSNotification *)notification;
++ (void)currentLocalizationDidChange:(NSNotification *)notification;
 
 @end
 
@@ -69,18 +81,24 @@ static void swizzled_UILabel__setBackgroundColor_Imp(UILabel *self, SEL _cmd, UI
 
 + (void)load
 {
-    s_UILabel__dealloc_Imp = (void (*)(id, SEL))HLSSwizzleSelector(self, 
-                                                                   @selector(dealloc), 
-                                                                   (IMP)swizzled_UILabel__dealloc_Imp);
-    s_UILabel__awakeFromNib_Imp = (void (*)(id, SEL))HLSSwizzleSelector(self, 
-                                                                        @selector(awakeFromNib),
-                                                                        (IMP)swizzled_UILabel__awakeFromNib_Imp);
-    s_UILabel__setText_Imp = (void (*)(id, SEL, id))HLSSwizzleSelector(self, 
-                                                                       @selector(setText:), 
-                                                                       (IMP)swizzled_UILabel__setText_Imp);
-    s_UILabel__setBackgroundColor_Imp = (void (*)(id, SEL, id))HLSSwizzleSelector(self,
-                                                                                  @selector(setBackgroundColor:),
-                                                                                  (IMP)swizzled_UILabel__setBackgroundColor_Imp);
+    HLSSwizzling swizzlings[] = {
+        {@selector(dealloc), (IMP)swizzled_UILabel__dealloc_Imp, (IMP *)&s_UILabel__dealloc_Imp},
+        {@selector(awakeFromNib), (IMP)swizzled_UILabel__awakeFromNib_Imp, (IMP *)&s_UILabel__awakeFromNib_Imp},
+        {@selector(setText:), (IMP)swizzled_UILabel__setText_Imp, (IMP *)&s_UILabel__setText_Imp},
+        {@selector(setBackgroundColor:), (IMP)swizzled_UILabel__setBackgroundColor_Imp, (IMP *)&s_UILabel__setBackgroundColor_Imp},
+        {@selector(didMoveToWindow), (IMP)swizzled_UILabel__didMoveToWindow_Imp, (IMP *)&s_UILabel__didMoveToWindow_Imp}
+    };
+    HLSSwizzleSelectors(self, swizzlings, sizeof(swizzlings) / sizeof(HLSSwizzling));
+    
+    // A single observer for all labels, instead of one per label. Labels are only registered in sets, which is much
+    // cheaper than registering them with the notification center
+    s_localizedLabels = CFSetCreateMutable(kCFAllocatorDefault, 0, NULL);
+    s_outdatedLabels = CFSetCreateMutable(kCFAllocatorDefault, 0, NULL);
+    s_lockedLabels = CFSetCreateMutable(kCFAllocatorDefault, 0, NULL);
+    [[NSNotificationCenter defaultCenter] addObserver:self
+                                             selector:@selector(currentLocalizationDidChange:)
+                                                 name:HLSCurrentLocalizationDidChangeNotification
+                                               object:nil];
 }
 
 #pragma mark Localization
@@ -134,9 +152,11 @@ static void swizzled_UILabel__setBackgroundColor_Imp(UILabel *self, SEL _cmd, UI
 
 - (void)setAndLocalizeText:(NSString *)text
 {
-    // Each label is lazily associated with localization information the first time its text is set (even
-    // if the label is not localized). The localization settings it contains (most notably the key) cannot 
-    // be updated afterwards. 
+    // Each label is lazily associated with localization information the first time its text is set with a
+    // localization prefix (labels which have never received such a text do not get here, see the setText:
+    // swizzled implementation). From then on, localization information is created even if the label is not
+    // localized (e.g. for other button states). The localization settings it contains (most notably the key) 
+    // cannot be updated afterwards. 
     //
     // The reason of this behavior is that objects embedding labels (like buttons) might call setText: 
     // several times in their implementation, and for various reasons. Moreover, we cannot reliably 
@@ -156,25 +176,25 @@ static void swizzled_UILabel__setBackgroundColor_Imp(UILabel *self, SEL _cmd, UI
     // though, since the prefix-in-nib trick makes really sense for static labels (those which do not have 
     // to be connected using outlets). By definition such labels have a constant text (except of course if 
     // you want to mess with the view hierarchy to set a label. But do you really want to?)
+    //
+    // Localization information objects are shared between labels with the same text, so that creating many identical
+    // labels (e.g. in table view cells) neither requires parsing the text again nor additional memory
     HLSLabelLocalizationInfo *localizationInfo = [self localizationInfo];
     if (! localizationInfo) {
-        localizationInfo = [[[HLSLabelLocalizationInfo alloc] initWithText:text] autorelease];
+        localizationInfo = [HLSLabelLocalizationInfo localizationInfoWithText:text];
         [self setLocalizationInfo:localizationInfo];
         
-        // For labels localized with prefixes only: Listen to localization change notifications
+        // For labels localized with prefixes only: Update when the localization changes
         if ([localizationInfo isLocalized]) {
-            [[NSNotificationCenter defaultCenter] addObserver:self 
-                                                     selector:@selector(currentLocalizationDidChange:) 
-                                                         name:HLSCurrentLocalizationDidChangeNotification 
-                                                       object:nil];
+            CFSetAddValue(s_localizedLabels, self);
         }
     }
     
     // Prevent the call to -[UIButton setTitle:forState:] in localizeTextWithLocalizationInfo: from ending
     // up in an infinite recursion
-    if (localizationInfo.locked) {
+    if (CFSetContainsValue(s_lockedLabels, self)) {
         (*s_UILabel__setText_Imp)(self, @selector(setText:), text);
-        localizationInfo.locked = NO;
+        CFSetRemoveValue(s_lockedLabels, self);
         return;
     }
     
@@ -198,7 +218,7 @@ static void swizzled_UILabel__setBackgroundColor_Imp(UILabel *self, SEL _cmd, UI
     // Button label
     if ([[self superview] isKindOfClass:[UIButton class]]) {
         UIButton *button = (UIButton *)[self superview];
-        localizationInfo.locked = YES;
+        CFSetAddValue(s_lockedLabels, self);
         
         // We must call setTitle:forState: on the button to get proper reszing behavior
         [button setTitle:localizedText forState:button.state];
@@ -220,21 +240,40 @@ static void swizzled_UILabel__setBackgroundColor_Imp(UILabel *self, SEL _cmd, UI
 
 #pragma mark Notification callbacks
 
-- (void)currentLocalizationDidChange:(NSNotification *)notification
++ (void)currentLocalizationDidChange:(NSNotification *)notification
 {
-    HLSLabelLocalizationInfo *localizationInfo = [self localizationInfo];
-    if ([localizationInfo isLocalized]) {
-        [self localizeTextWithLocalizationInfo:localizationInfo];
+    // Only labels which are displayed are updated immediately. Other labels are updated when they are added to a
+    // window again. The set is copied since localizing a label might alter it (e.g. button labels)
+    CFIndex numberOfLabels = CFSetGetCount(s_localizedLabels);
+    if (numberOfLabels == 0) {
+        return;
     }
+    
+    const void **labels = malloc(numberOfLabels * sizeof(const void *));
+    CFSetGetValues(s_localizedLabels, labels);
+    for (CFIndex i = 0; i < numberOfLabels; ++i) {
+        UILabel *label = (UILabel *)labels[i];
+        if (! label.window) {
+            CFSetAddValue(s_outdatedLabels, label);
+            continue;
+        }
+        
+        HLSLabelLocalizationInfo *localizationInfo = [label localizationInfo];
+        if ([localizationInfo isLocalized]) {
+            [label localizeTextWithLocalizationInfo:localizationInfo];
+        }
+        CFSetRemoveValue(s_outdatedLabels, label);
+    }
+    free(labels);
 }
 
 @end
 
 static void swizzled_UILabel__dealloc_Imp(UILabel *self, SEL _cmd)
 {
-    [[NSNotificationCenter defaultCenter] removeObserver:self 
-                                                    name:HLSCurrentLocalizationDidChangeNotification 
-                                                  object:nil];
+    CFSetRemoveValue(s_localizedLabels, self);
+    CFSetRemoveValue(s_outdatedLabels, self);
+    CFSetRemoveValue(s_lockedLabels, self);
     
     (*s_UILabel__dealloc_Imp)(self, _cmd);
 }
@@ -244,11 +283,21 @@ static void swizzled_UILabel__awakeFromNib_Imp(UILabel *self, SEL _cmd)
     (*s_UILabel__awakeFromNib_Imp)(self, _cmd);
     
     // Here self.text returns the string filled by deserialization from the nib (which is not set using setText:)
-    [self setAndLocalizeText:self.text];
+    NSString *text = self.text;
+    if (CFSetContainsValue(s_localizedLabels, self) || textHasLocalizationPrefix(text)) {
+        [self setAndLocalizeText:text];
+    }
 }
 
 static void swizzled_UILabel__setText_Imp(UILabel *self, SEL _cmd, NSString *text)
 {
+    // Fast path for labels which are not localized (most labels whose text is set from code, e.g. in table view cells),
+    // avoiding associated object lookups
+    if (! CFSetContainsValue(s_localizedLabels, self) && ! textHasLocalizationPrefix(text)) {
+        (*s_UILabel__setText_Imp)(self, _cmd, text);
+        return;
+    }
+    
     [self setAndLocalizeText:text];
 }
 
@@ -261,3 +310,39 @@ static void swizzled_UILabel__setBackgroundColor_Imp(UILabel *self, SEL _cmd, UI
     // usually set earlier (i.e. when this object is not available)
     objc_setAssociatedObject(self, s_originalBackgroundColorKey, backgroundColor, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
 }
+
+static void swizzled_UILabel__didMoveToWindow_Imp(UILabel *self, SEL _cmd)
+{
+    (*s_UILabel__didMoveToWindow_Imp)(self, _cmd);
+    
+    // Lazily apply a localization change which occurred while the label was not displayed
+    if (self.window && CFSetContainsValue(s_outdatedLabels, self)) {
+        CFSetRemoveValue(s_outdatedLabels, self);
+        
+        HLSLabelLocalizationInfo *localizationInfo = [self localizationInfo];
+        if ([localizationInfo isLocalized]) {
+            [self localizeTextWithLocalizationInfo:localizationInfo];
+        }
+    }
+}
+
+// Return YES iff the text begins with one of the prefixes recognized by HLSLabelLocalizationInfo. Must be fast since
+// it is called for each setText:
+static BOOL textHasLocalizationPrefix(NSString *text)
+{
+    NSUInteger length = [text length];
+    if (length < 2) {
+        return NO;
+    }
+    
+    // Quickly discard texts which cannot start with LS, ULS, LLS or CLS
+    unichar firstCharacter = [text characterAtIndex:0];
+    if (firstCharacter != 'L' && firstCharacter != 'U' && firstCharacter != 'C') {
+        return NO;
+    }
+    
+    NSRange separatorRange = [text rangeOfString:@"/" options:NSLiteralSearch range:NSMakeRange(0, MIN(length, 4))];
+    NSString *leadingPrefix = (separatorRange.location != NSNotFound) ? [text substringToIndex:separatorRange.location] : text;
+    return [leadingPrefix isEqualToString:@"LS"] || [leadingPrefix isEqualToString:@"ULS"]
+        || [leadingPrefix isEqualToString:@"LLS"] || [leadingPrefix isEqualToString:@"CLS"];
+}
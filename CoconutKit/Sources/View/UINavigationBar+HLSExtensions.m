@@ -8,29 +8,26 @@
 
 #import "UINavigationBar+HLSExtensions.h"
 
+#import <objc/runtime.h>
 #import "HLSRuntime.h"
-#import "UIView+HLSExtensions.h"
 
 /**
- * As navigation levels are pushed onto the stack, the navigation bar is updated. During this process, and if we
- * do nothing, the background view gets on top of the title and button widgets, hiding them. To avoid this, we
- * ensure that any view hierarchy change leaves the background view at the bottom of the view hierarchy. This
- * is done by swizzling methods which can potentially put a view behind the background view
+ * Below iOS 5, the navigation bar draws its background in -drawRect:. Instead of adding a background view (which would
+ * then need to be kept at the bottom of the view hierarchy each time the navigation bar updates its subviews, i.e. 
+ * at each push and pop), the image is drawn in place of the standard background. The image is only drawn when the
+ * bar is displayed, which does not happen when the navigation bar updates its subviews
  *
- * This idea was borrowed from http://sebastiancelis.com/2009/12/21/adding-background-image-uinavigationbar/
+ * On iOS 5 and above, the built-in appearance API is used, and no method is swizzled
  */
 
-static const NSInteger kBackgroundImageViewTag = 7456;          // Hopefully not colliding with another tag :-)
+// Associated object keys
+static void *s_backgroundImageKey = &s_backgroundImageKey;
 
 // Original implementation of the methods we swizzle
-static void (*s_UINavigationBar__insertSubview_atIndex_Imp)(id, SEL, id, NSInteger) = NULL;
-static void (*s_UINavigationBar__insertSubview_belowSubview_Imp)(id, SEL, id, id) = NULL;
-static void (*s_UINavigationBar__sendSubviewToBack_Imp)(id, SEL, id) = NULL;
+static void (*s_UINavigationBar__drawRect_Imp)(id, SEL, CGRect) = NULL;
 
 // Swizzled method implementations
-static void swizzled_UINavigationBar__insertSubview_atIndex_Imp(UINavigationBar *self, SEL _cmd, UIView *view, NSInteger index);
-static void swizzled_UINavigationBar__insertSubview_belowSubview_Imp(UINavigationBar *self, SEL _cmd, UIView *view, UIView *siblingSubview);
-static void swizzled_UINavigationBar__sendSubviewToBack_Imp(UINavigationBar *self, SEL _cmd, UIView *view);
+static void swizzled_UINavigationBar__drawRect_Imp(UINavigationBar *self, SEL _cmd, CGRect rect);
 
 @implementation UINavigationBar (HLSExtensions)
 
@@ -38,15 +35,14 @@ static void swizzled_UINavigationBar__sendSubviewToBack_Imp(UINavigationBar *sel
 
 + (void)load
 {
-    s_UINavigationBar__insertSubview_atIndex_Imp = (void (*)(id, SEL, id, NSInteger))HLSSwizzleSelector(self, 
-                                                                                                        @selector(insertSubview:atIndex:), 
-                                                                                                        (IMP)swizzled_UINavigationBar__insertSubview_atIndex_Imp);
-    s_UINavigationBar__insertSubview_belowSubview_Imp = (void (*)(id, SEL, id, id))HLSSwizzleSelector(self, 
-                                                                                                      @selector(insertSubview:belowSubview:), 
-                                                                                                      (IMP)swizzled_UINavigationBar__insertSubview_belowSubview_Imp);
-    s_UINavigationBar__sendSubviewToBack_Imp = (void (*)(id, SEL, id))HLSSwizzleSelector(self, 
-                                                                                         @selector(sendSubviewToBack:), 
-                                                                                         (IMP)swizzled_UINavigationBar__sendSubviewToBack_Imp);
+    // iOS 5 and above: Built-in support
+    if ([self instancesRespondToSelector:@selector(setBackgroundImage:forBarMetrics:)]) {
+        return;
+    }
+    
+    s_UINavigationBar__drawRect_Imp = (void (*)(id, SEL, CGRect))HLSSwizzleSelector(self, 
+                                                                                    @selector(drawRect:), 
+                                                                                    (IMP)swizzled_UINavigationBar__drawRect_Imp);
 }
 
 #pragma mark Accessors and mutators
@@ -55,8 +51,13 @@ static void swizzled_UINavigationBar__sendSubviewToBack_Imp(UINavigationBar *sel
 
 - (UIImage *)backgroundImage
 {
-    UIImageView *backgroundImageView = (UIImageView *)[self viewWithTag:kBackgroundImageViewTag];
-    return backgroundImageView.image;
+    // iOS 5 and above: Built-in support
+    if ([self respondsToSelector:@selector(backgroundImageForBarMetrics:)]) {
+        return [self backgroundImageForBarMetrics:UIBarMetricsDefault];
+    }
+    else {
+        return objc_getAssociatedObject(self, s_backgroundImageKey);
+    }
 }
 
 - (void)setBackgroundImage:(UIImage *)backgroundImage
@@ -64,36 +65,11 @@ static void swizzled_UINavigationBar__sendSubviewToBack_Imp(UINavigationBar *sel
     // iOS 5 and above: Built-in support
     if ([self respondsToSelector:@selector(setBackgroundImage:forBarMetrics:)]) {
         [self setBackgroundImage:backgroundImage forBarMetrics:UIBarMetricsDefault];
-        return;
     }
-    // Below iOS 5: Tweak view hierarchy
-    else {    
-        // Trick: The background view is identified using a tag
-        UIImageView *backgroundImageView = (UIImageView *)[self viewWithTag:kBackgroundImageViewTag];
-        
-        // Already added
-        if (backgroundImageView) {
-            // Changing the existing image
-            if (backgroundImage) {
-                backgroundImageView.image = backgroundImage;
-            }
-            // Removing the image
-            else {
-                [backgroundImageView removeFromSuperview];
-            }
-        }
-        // Adding
-        else {
-            if (backgroundImage) {
-                UIImageView *backgroundImageView = [[[UIImageView alloc] initWithFrame:self.bounds] autorelease];
-                backgroundImageView.image = backgroundImage;
-                backgroundImageView.tag = kBackgroundImageViewTag;
-                backgroundImageView.contentMode = UIViewContentModeScaleToFill;
-                backgroundImageView.autoresizingMask = HLSViewAutoresizingAll;
-                
-                (*s_UINavigationBar__insertSubview_atIndex_Imp)(self, @selector(insertSubview:atIndex:), backgroundImageView, 0);
-            }
-        }
+    // Below iOS 5: Draw the image instead of the standard background
+    else {
+        objc_setAssociatedObject(self, s_backgroundImageKey, backgroundImage, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+        [self setNeedsDisplay];
     }
 }
 
@@ -101,32 +77,14 @@ static void swizzled_UINavigationBar__sendSubviewToBack_Imp(UINavigationBar *sel
 
 #pragma mark Swizzled method implementations
 
-static void swizzled_UINavigationBar__insertSubview_atIndex_Imp(UINavigationBar *self, SEL _cmd, UIView *view, NSInteger index)
-{
-    (*s_UINavigationBar__insertSubview_atIndex_Imp)(self, _cmd, view, index);
-    
-    UIImageView *backgroundImageView = (UIImageView *)[self viewWithTag:kBackgroundImageViewTag];
-    if (backgroundImageView) {
-        (*s_UINavigationBar__sendSubviewToBack_Imp)(self, @selector(sendSubviewToBack:), backgroundImageView);
-    }
-}
-
-static void swizzled_UINavigationBar__insertSubview_belowSubview_Imp(UINavigationBar *self, SEL _cmd, UIView *view, UIView *siblingSubview)
+static void swizzled_UINavigationBar__drawRect_Imp(UINavigationBar *self, SEL _cmd, CGRect rect)
 {
-    (*s_UINavigationBar__insertSubview_belowSubview_Imp)(self, _cmd, view, siblingSubview);
-    
-    UIImageView *backgroundImageView = (UIImageView *)[self viewWithTag:kBackgroundImageViewTag];
-    if (backgroundImageView) {
-        (*s_UINavigationBar__sendSubviewToBack_Imp)(self, @selector(sendSubviewToBack:), backgroundImageView);
+    // The image is stretched according to its caps, if any (see -[UIImage stretchableImageWithLeftCapWidth:topCapHeight:])
+    UIImage *backgroundImage = objc_getAssociatedObject(self, s_backgroundImageKey);
+    if (backgroundImage) {
+        [backgroundImage drawInRect:self.bounds];
     }
-}
-
-static void swizzled_UINavigationBar__sendSubviewToBack_Imp(UINavigationBar *self, SEL _cmd, UIView *view)
-{
-    (*s_UINavigationBar__sendSubviewToBack_Imp)(self, _cmd, view);
-    
-    UIImageView *backgroundImageView = (UIImageView *)[self viewWithTag:kBackgroundImageViewTag];
-    if (backgroundImageView) {
-        (*s_UINavigationBar__sendSubviewToBack_Imp)(self, @selector(sendSubviewToBack:), backgroundImageView);
+    else {
+        (*s_UINavigationBar__drawRect_Imp)(self, _cmd, rect);
     }
 }
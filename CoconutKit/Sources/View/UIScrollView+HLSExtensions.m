@@ -25,8 +25,12 @@
  */
 
 // Associated object keys
-static void *s_synchronizedScrollViewsKey = &s_synchronizedScrollViewsKey;
-static void *s_parallaxBouncesKey = &s_parallaxBouncesKey;
+static void *s_synchronizationKey = &s_synchronizationKey;
+
+// Synchronization objects for master scroll views (keys and values not retained; values are retained as associated
+// objects). Checked on each contentOffset change. Scroll views which are not synchronized therefore only pay for
+// a pointer hash lookup
+static CFMutableDictionaryRef s_scrollViewToSynchronizationMap = NULL;
 
 // Original implementation of the methods we swizzle
 static void (*s_UIScrollView__setContentOffset_Imp)(id, SEL, CGPoint) = NULL;
@@ -34,9 +38,27 @@ static void (*s_UIScrollView__setContentOffset_Imp)(id, SEL, CGPoint) = NULL;
 // Swizzled method implementations
 static void swizzled_UIScrollView__setContentOffset_Imp(UIScrollView *self, SEL _cmd, CGPoint contentOffset);
 
+/**
+ * Synchronization settings of a master scroll view. Its lifetime is bound to the one of the master scroll view
+ */
+@interface HLSScrollViewSynchronization : NSObject {
+@private
+    UIScrollView *m_scrollView;
+    NSArray *m_synchronizedScrollViews;
+    BOOL m_bounces;
+}
+
+- (id)initWithScrollView:(UIScrollView *)scrollView synchronizedScrollViews:(NSArray *)synchronizedScrollViews bounces:(BOOL)bounces;
+
+@property (nonatomic, readonly) UIScrollView *scrollView;           // weak ref
+@property (nonatomic, readonly) NSArray *synchronizedScrollViews;
+@property (nonatomic, readonly) BOOL bounces;
+
+@end
+
 @interface UIScrollView (HLSExtensionsPrivate)
 
-- (void)synchronizeScrolling;
+- (void)synchronizeScrollingWithSynchronization:(HLSScrollViewSynchronization *)synchronization;
 
 @end
 
@@ -58,14 +80,16 @@ static void swizzled_UIScrollView__setContentOffset_Imp(UIScrollView *self, SEL
         return;
     }
     
-    objc_setAssociatedObject(self, s_synchronizedScrollViewsKey, scrollViews, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
-    objc_setAssociatedObject(self, s_parallaxBouncesKey, [NSNumber numberWithBool:bounces], OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+    HLSScrollViewSynchronization *synchronization = [[[HLSScrollViewSynchronization alloc] initWithScrollView:self
+                                                                                       synchronizedScrollViews:scrollViews
+                                                                                                       bounces:bounces] autorelease];
+    objc_setAssociatedObject(self, s_synchronizationKey, synchronization, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+    CFDictionarySetValue(s_scrollViewToSynchronizationMap, self, synchronization);
 }
 
 - (void)removeSynchronization
 {
-    objc_setAssociatedObject(self, s_synchronizedScrollViewsKey, nil, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
-    objc_setAssociatedObject(self, s_parallaxBouncesKey, nil, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+    objc_setAssociatedObject(self, s_synchronizationKey, nil, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
 }
 
 @end
@@ -76,6 +100,7 @@ static void swizzled_UIScrollView__setContentOffset_Imp(UIScrollView *self, SEL
 
 + (void)load
 {
+    s_scrollViewToSynchronizationMap = CFDictionaryCreateMutable(kCFAllocatorDefault, 0, NULL, NULL);
     s_UIScrollView__setContentOffset_Imp = (void (*)(id, SEL, CGPoint))HLSSwizzleSelector(self, 
                                                                                           @selector(setContentOffset:), 
                                                                                           (IMP)swizzled_UIScrollView__setContentOffset_Imp);
@@ -83,13 +108,8 @@ static void swizzled_UIScrollView__setContentOffset_Imp(UIScrollView *self, SEL
 
 #pragma mark Scrolling synchronization
 
-- (void)synchronizeScrolling
+- (void)synchronizeScrollingWithSynchronization:(HLSScrollViewSynchronization *)synchronization
 {
-    NSArray *synchronizedScrollViews = objc_getAssociatedObject(self, s_synchronizedScrollViewsKey);
-    if (! synchronizedScrollViews) {
-        return;
-    }
-    
     // Calculate the relative offset position (in [0; 1]) of the receiver
     CGFloat relativeXPos = 0.f;
     if (floatle(self.contentSize.width, CGRectGetWidth(self.frame))) {
@@ -109,8 +129,7 @@ static void swizzled_UIScrollView__setContentOffset_Imp(UIScrollView *self, SEL
     
     // If reaching the top or the bottom of the master scroll view, prevent the other scroll views from
     // scrolling further (if enabled)
-    BOOL bounces = [objc_getAssociatedObject(self, s_parallaxBouncesKey) boolValue];
-    if (! bounces) {
+    if (! synchronization.bounces) {
         if (floatlt(relativeXPos, 0.f)) {
             relativeXPos = 0.f;
         }
@@ -126,20 +145,72 @@ static void swizzled_UIScrollView__setContentOffset_Imp(UIScrollView *self, SEL
         }            
     }
     
-    // Apply the same relative offset position to all scroll views to keep in sync
-    for (UIScrollView *scrollView in synchronizedScrollViews) {
+    // Apply the same relative offset position to all scroll views to keep in sync. Changes are grouped so that
+    // all synchronized scroll views are committed together, without implicit animations
+    [CATransaction begin];
+    [CATransaction setDisableActions:YES];
+    for (UIScrollView *scrollView in synchronization.synchronizedScrollViews) {
         CGFloat xPos = relativeXPos * (scrollView.contentSize.width - CGRectGetWidth(scrollView.frame));
         CGFloat yPos = relativeYPos * (scrollView.contentSize.height - CGRectGetHeight(scrollView.frame));
         scrollView.contentOffset = CGPointMake(xPos, yPos);
     }
+    [CATransaction commit];
 }
 
 @end
 
+@implementation HLSScrollViewSynchronization
+
+#pragma mark Object creation and destruction
+
+- (id)initWithScrollView:(UIScrollView *)scrollView synchronizedScrollViews:(NSArray *)synchronizedScrollViews bounces:(BOOL)bounces
+{
+    if ((self = [super init])) {
+        m_scrollView = scrollView;
+        m_synchronizedScrollViews = [synchronizedScrollViews retain];
+        m_bounces = bounces;
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    // Released when the master scroll view is deallocated or gets another synchronization. Only remove the map entry
+    // if it still refers to this object
+    if (CFDictionaryGetValue(s_scrollViewToSynchronizationMap, m_scrollView) == self) {
+        CFDictionaryRemoveValue(s_scrollViewToSynchronizationMap, m_scrollView);
+    }
+    m_scrollView = nil;
+    
+    [m_synchronizedScrollViews release];
+    m_synchronizedScrollViews = nil;
+    
+    [super dealloc];
+}
+
+#pragma mark Accessors and mutators
+
+@synthesize scrollView = m_scrollView;
+
+@synthesize synchronizedScrollViews = m_synchronizedScrollViews;
+
+@synthesize bounces = m_bounces;
+
+@end
+
 #pragma mark Swizzled method implementations
 
 static void swizzled_UIScrollView__setContentOffset_Imp(UIScrollView *self, SEL _cmd, CGPoint contentOffset)
 {
     (*s_UIScrollView__setContentOffset_Imp)(self, _cmd, contentOffset);
-    [self synchronizeScrolling];
+    
+    // Fast path for the (usual) case where no scroll views are synchronized
+    if (CFDictionaryGetCount(s_scrollViewToSynchronizationMap) == 0) {
+        return;
+    }
+    
+    HLSScrollViewSynchronization *synchronization = (HLSScrollViewSynchronization *)CFDictionaryGetValue(s_scrollViewToSynchronizationMap, self);
+    if (synchronization) {
+        [self synchronizeScrollingWithSynchronization:synchronization];
+    }
 }
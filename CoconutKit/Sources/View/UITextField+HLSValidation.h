@@ -57,6 +57,15 @@
 - (BOOL)isCheckingOnChange;
 - (void)setCheckingOnChange:(BOOL)checkingOnChange;
 
+/**
+ * When checking on change, validation is deferred until the user pauses typing for the given delay (0.3 seconds by
+ * default), and only the most recent text is checked. This keeps input responsive when formatters or validation 
+ * methods are expensive. Set to 0 to check on every keystroke. Validation events are always received on the main 
+ * thread. Must be set after the text field has been bound
+ */
+- (NSTimeInterval)checkingOnChangeDelay;
+- (void)setCheckingOnChangeDelay:(NSTimeInterval)checkingOnChangeDelay;
+
 @end
 
 /**
@@ -97,6 +97,7 @@ extern BOOL injectedManagedObjectValidation(void);
     
     // Restore the original delegate
     HLSManagedTextFieldValidator *validator = objc_getAssociatedObject(self, s_validatorKey);
+    [validator cancelPendingCheck];
     (*s_UITextField__setDelegate_Imp)(self, @selector(setDelegate:), validator.delegate);
     
     // Remove the validator
@@ -129,6 +130,30 @@ extern BOOL injectedManagedObjectValidation(void);
     validator.checkingOnChange = checkingOnChange;
 }
 
+- (NSTimeInterval)checkingOnChangeDelay
+{
+    NSAssert(injectedManagedObjectValidation(), @"Managed object validation not injected. Call HLSEnableNSManagedObjectValidation first");
+    
+    HLSManagedTextFieldValidator *validator = objc_getAssociatedObject(self, s_validatorKey);
+    if (! validator) {
+        return 0.;
+    }
+    
+    return validator.checkingOnChangeDelay;
+}
+
+- (void)setCheckingOnChangeDelay:(NSTimeInterval)checkingOnChangeDelay
+{
+    NSAssert(injectedManagedObjectValidation(), @"Managed object validation not injected. Call HLSEnableNSManagedObjectValidation first");
+    
+    HLSManagedTextFieldValidator *validator = objc_getAssociatedObject(self, s_validatorKey);
+    if (! validator) {
+        return;
+    }
+    
+    validator.checkingOnChangeDelay = checkingOnChangeDelay;
+}
+
 @end
 
 #pragma mark -
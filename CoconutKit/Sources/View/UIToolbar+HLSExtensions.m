@@ -8,55 +8,78 @@
 
 #import "UIToolbar+HLSExtensions.h"
 
-#import "UIView+HLSExtensions.h"
+#import <objc/runtime.h>
+#import "HLSRuntime.h"
 
-static const NSInteger kBackgroundImageViewTag = 28756;         // Very unlikely to be used by another view in the toolbar view hierarchy
+/**
+ * Same approach as for UINavigationBar (see UINavigationBar+HLSExtensions.m): Below iOS 5, the image is drawn in place 
+ * of the standard toolbar background, otherwise the built-in appearance API is used
+ */
+
+// Associated object keys
+static void *s_backgroundImageKey = &s_backgroundImageKey;
+
+// Original implementation of the methods we swizzle
+static void (*s_UIToolbar__drawRect_Imp)(id, SEL, CGRect) = NULL;
+
+// Swizzled method implementations
+static void swizzled_UIToolbar__drawRect_Imp(UIToolbar *self, SEL _cmd, CGRect rect);
 
 @implementation UIToolbar (HLSExtensions)
 
+#pragma mark Class methods
+
++ (void)load
+{
+    // iOS 5 and above: Built-in support
+    if ([self instancesRespondToSelector:@selector(setBackgroundImage:forToolbarPosition:barMetrics:)]) {
+        return;
+    }
+    
+    s_UIToolbar__drawRect_Imp = (void (*)(id, SEL, CGRect))HLSSwizzleSelector(self, 
+                                                                              @selector(drawRect:), 
+                                                                              (IMP)swizzled_UIToolbar__drawRect_Imp);
+}
+
 #pragma mark Accessors and mutators
 
 @dynamic backgroundImage;
 
 - (UIImage *)backgroundImage
 {
-    UIImageView *backgroundImageView = (UIImageView *)[self viewWithTag:kBackgroundImageViewTag];
-    return backgroundImageView.image;
+    // iOS 5 and above: Built-in support
+    if ([self respondsToSelector:@selector(backgroundImageForToolbarPosition:barMetrics:)]) {
+        return [self backgroundImageForToolbarPosition:UIToolbarPositionAny barMetrics:UIBarMetricsDefault];
+    }
+    else {
+        return objc_getAssociatedObject(self, s_backgroundImageKey);
+    }
 }
 
 - (void)setBackgroundImage:(UIImage *)backgroundImage
 {
-    UIImageView *backgroundImageView = (UIImageView *)[self viewWithTag:kBackgroundImageViewTag];
-    
-    // Already added
-    if (backgroundImageView) {
-        // Changing the existing image
-        if (backgroundImage) {
-            backgroundImageView.image = backgroundImage;
-        }
-        // Removing the image
-        else {
-            [backgroundImageView removeFromSuperview];
-        }
+    // iOS 5 and above: Built-in support
+    if ([self respondsToSelector:@selector(setBackgroundImage:forToolbarPosition:barMetrics:)]) {
+        [self setBackgroundImage:backgroundImage forToolbarPosition:UIToolbarPositionAny barMetrics:UIBarMetricsDefault];
     }
-    // Adding
+    // Below iOS 5: Draw the image instead of the standard background
     else {
-        if (backgroundImage) {
-            UIImageView *backgroundImageView = [[[UIImageView alloc] initWithFrame:self.bounds] autorelease];
-            backgroundImageView.image = backgroundImage;
-            backgroundImageView.tag = kBackgroundImageViewTag;
-            backgroundImageView.contentMode = UIViewContentModeScaleToFill;
-            backgroundImageView.autoresizingMask = HLSViewAutoresizingAll;
-            
-            // iOS 5
-            if([[[UIDevice currentDevice] systemVersion] intValue] >= 5) {
-                [self insertSubview:backgroundImageView atIndex:1];
-            }
-            else {
-                [self insertSubview:backgroundImageView atIndex:0];
-            }
-        }
+        objc_setAssociatedObject(self, s_backgroundImageKey, backgroundImage, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+        [self setNeedsDisplay];
     }
 }
 
 @end
+
+#pragma mark Swizzled method implementations
+
+static void swizzled_UIToolbar__drawRect_Imp(UIToolbar *self, SEL _cmd, CGRect rect)
+{
+    UIImage *backgroundImage = objc_getAssociatedObject(self, s_backgroundImageKey);
+    if (backgroundImage) {
+        [backgroundImage drawInRect:self.bounds];
+    }
+    else {
+        (*s_UIToolbar__drawRect_Imp)(self, _cmd, rect);
+    }
+}
@@ -27,4 +27,11 @@
  */
 - (UIImage *)flattenedImage;
 
+/**
+ * Flatten the view layer (see CALayer+HLSExtensions.h)
+ */
+- (UIImage *)flattenedImageWithScale:(CGFloat)scale rect:(CGRect)rect;
+- (NSArray *)flattenedImageTilesOfSize:(CGSize)tileSize scale:(CGFloat)scale rect:(CGRect)rect;
+- (void)flattenImageWithScale:(CGFloat)scale rect:(CGRect)rect completionTarget:(id)target action:(SEL)action;
+
 @end
@@ -44,4 +44,19 @@ static void *s_userInfoKey = &s_userInfoKey;
     return [self.layer flattenedImage];
 }
 
+- (UIImage *)flattenedImageWithScale:(CGFloat)scale rect:(CGRect)rect
+{
+    return [self.layer flattenedImageWithScale:scale rect:rect];
+}
+
+- (NSArray *)flattenedImageTilesOfSize:(CGSize)tileSize scale:(CGFloat)scale rect:(CGRect)rect
+{
+    return [self.layer flattenedImageTilesOfSize:tileSize scale:scale rect:rect];
+}
+
+- (void)flattenImageWithScale:(CGFloat)scale rect:(CGRect)rect completionTarget:(id)target action:(SEL)action
+{
+    [self.layer flattenImageWithScale:scale rect:rect completionTarget:target action:action];
+}
+
 @end
@@ -73,6 +73,8 @@
     UIViewAutoresizing m_originalAutoresizingMask;              // The view controller's view autoresizing mask prior to insertion
     BOOL m_movingToParentViewController;
     BOOL m_movingFromParentViewController;
+    BOOL m_rotationDeferred;
+    UIInterfaceOrientation m_deferredFromInterfaceOrientation;
 }
 
 /**
@@ -176,4 +178,15 @@
 - (void)willAnimateRotationToInterfaceOrientation:(UIInterfaceOrientation)toInterfaceOrientation duration:(NSTimeInterval)duration;
 - (void)didRotateFromInterfaceOrientation:(UIInterfaceOrientation)fromInterfaceOrientation;
 
+/**
+ * Containers can avoid forwarding rotation events to view controllers which are not visible, and forward them once 
+ * when they become visible again. Call -deferRotationFromInterfaceOrientation: instead of forwarding rotation events
+ * (successive calls keep the orientation of the first rotation which has been deferred), and call 
+ * -forwardDeferredRotationToInterfaceOrientation: before the view controller appears again. All rotation events
+ * are then received at once, without animation. Nothing happens if no rotation has been deferred, or if the view
+ * controller is back in its original orientation
+ */
+- (void)deferRotationFromInterfaceOrientation:(UIInterfaceOrientation)fromInterfaceOrientation;
+- (void)forwardDeferredRotationToInterfaceOrientation:(UIInterfaceOrientation)toInterfaceOrientation;
+
 @end
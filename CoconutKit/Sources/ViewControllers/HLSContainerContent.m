@@ -21,6 +21,11 @@
 // Keys for runtime container - view controller / view object association
 static void *s_containerContentKey = &s_containerContentKey;
 
+// Number of view controllers currently associated with a container content object. When no view controller is
+// associated, the swizzled UIViewController accessors below can skip the associated object lookup altogether. Only
+// updated on the main thread, where containers are manipulated
+static NSUInteger s_containerContentCount = 0;
+
 // Original implementation of the methods we swizzle
 static id (*s_UIViewController__parentViewController_Imp)(id, SEL) = NULL;
 static BOOL (*s_UIViewController__isMovingToParentViewController_Imp)(id, SEL) = NULL;
@@ -147,6 +152,7 @@ static BOOL iOS4_UIViewController__isMovingFromParentViewController_Imp(UIViewCo
             return nil;
         }
         objc_setAssociatedObject(viewController, s_containerContentKey, self, OBJC_ASSOCIATION_ASSIGN);
+        ++s_containerContentCount;
         
         // >= iOS 5: For containers having automaticallyForwardAppearanceAndRotationMethodsToChildViewControllers
         // return NO, we MUST use the UIViewController containment API to declare each view controller we insert
@@ -191,6 +197,7 @@ static BOOL iOS4_UIViewController__isMovingFromParentViewController_Imp(UIViewCo
     // Remove the association of the view controller with its content container object
     NSAssert(objc_getAssociatedObject(self.viewController, s_containerContentKey), @"The view controller was not associated with a content container");
     objc_setAssociatedObject(self.viewController, s_containerContentKey, nil, OBJC_ASSOCIATION_ASSIGN);
+    --s_containerContentCount;
     
     // We must call -willMoveToParentViewController: manually right before the containment relationship is removed without
     // animation, if one remains of course (iOS 5 and above, see UIViewController documentation)
@@ -455,6 +462,32 @@ static BOOL iOS4_UIViewController__isMovingFromParentViewController_Imp(UIViewCo
     return [self.viewController didRotateFromInterfaceOrientation:fromInterfaceOrientation];
 }
 
+- (void)deferRotationFromInterfaceOrientation:(UIInterfaceOrientation)fromInterfaceOrientation
+{
+    if (m_rotationDeferred) {
+        return;
+    }
+    
+    m_rotationDeferred = YES;
+    m_deferredFromInterfaceOrientation = fromInterfaceOrientation;
+}
+
+- (void)forwardDeferredRotationToInterfaceOrientation:(UIInterfaceOrientation)toInterfaceOrientation
+{
+    if (! m_rotationDeferred) {
+        return;
+    }
+    
+    m_rotationDeferred = NO;
+    if (toInterfaceOrientation == m_deferredFromInterfaceOrientation) {
+        return;
+    }
+    
+    [self willRotateToInterfaceOrientation:toInterfaceOrientation duration:0.];
+    [self willAnimateRotationToInterfaceOrientation:toInterfaceOrientation duration:0.];
+    [self didRotateFromInterfaceOrientation:m_deferredFromInterfaceOrientation];
+}
+
 #pragma mark Description
 
 - (NSString *)description
@@ -524,6 +557,11 @@ static BOOL iOS4_UIViewController__isMovingFromParentViewController_Imp(UIViewCo
 
 static UIViewController *swizzled_UIViewController__parentViewController_Imp(UIViewController *self, SEL _cmd)
 {
+    // Fast path: Called very often by UIKit, avoid the associated object lookup when no HLS container is in use
+    if (s_containerContentCount == 0) {
+        return (*s_UIViewController__parentViewController_Imp)(self, _cmd);
+    }
+    
     HLSContainerContent *containerContent = objc_getAssociatedObject(self, s_containerContentKey);
     if (containerContent) {
         return containerContent.containerViewController;
@@ -535,6 +573,10 @@ static UIViewController *swizzled_UIViewController__parentViewController_Imp(UIV
 
 static BOOL swizzled_UIViewController__isMovingToParentViewController_Imp(UIViewController *self, SEL _cmd)
 {
+    if (s_containerContentCount == 0) {
+        return (*s_UIViewController__isMovingToParentViewController_Imp)(self, _cmd);
+    }
+    
     HLSContainerContent *containerContent = objc_getAssociatedObject(self, s_containerContentKey);
     if (containerContent) {
         return containerContent.movingToParentViewController;
@@ -546,6 +588,10 @@ static BOOL swizzled_UIViewController__isMovingToParentViewController_Imp(UIView
 
 static BOOL swizzled_UIViewController__isMovingFromParentViewController_Imp(UIViewController *self, SEL _cmd)
 {
+    if (s_containerContentCount == 0) {
+        return (*s_UIViewController__isMovingFromParentViewController_Imp)(self, _cmd);
+    }
+    
     HLSContainerContent *containerContent = objc_getAssociatedObject(self, s_containerContentKey);
     if (containerContent) {
         return containerContent.movingFromParentViewController;
@@ -567,6 +613,10 @@ static void iOS4_UIViewController__didMoveToParentViewController_Imp(UIViewContr
 
 static BOOL iOS4_UIViewController__isMovingToParentViewController_Imp(UIViewController *self, SEL _cmd)
 {
+    if (s_containerContentCount == 0) {
+        return NO;
+    }
+    
     UIViewController *currentViewController = self;
     while (currentViewController) {
         HLSContainerContent *containerContent = objc_getAssociatedObject(currentViewController, s_containerContentKey);
@@ -580,6 +630,10 @@ static BOOL iOS4_UIViewController__isMovingToParentViewController_Imp(UIViewCont
 
 static BOOL iOS4_UIViewController__isMovingFromParentViewController_Imp(UIViewController *self, SEL _cmd)
 {
+    if (s_containerContentCount == 0) {
+        return NO;
+    }
+    
     UIViewController *currentViewController = self;
     while (currentViewController) {
         HLSContainerContent *containerContent = objc_getAssociatedObject(currentViewController, s_containerContentKey);
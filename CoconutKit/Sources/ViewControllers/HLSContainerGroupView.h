@@ -55,4 +55,11 @@
  */
 @property (nonatomic, readonly, retain) UIView *backView;
 
+/**
+ * Return YES iff the front content is guaranteed to completely hide the back content, i.e. if the front content view 
+ * and its wrapper are visible, not transformed (except for rotations by multiples of 90 degrees), have an opaque 
+ * background color and cover the whole group view
+ */
+- (BOOL)isFrontContentViewCoveringBackView;
+
 @end
@@ -9,6 +9,7 @@
 #import "HLSContainerGroupView.h"
 
 #import "HLSAssert.h"
+#import "HLSFloat.h"
 #import "HLSLogger.h"
 #import "NSArray+HLSExtensions.h"
 #import "UIView+HLSExtensions.h"
@@ -119,4 +120,39 @@
     }    
 }
 
+#pragma mark Covering
+
+- (BOOL)isFrontContentViewCoveringBackView
+{
+    // The wrapper is the view animated by transitions. It must be exactly in its rest position
+    UIView *frontView = self.frontView;
+    if (frontView.hidden || ! floateq(frontView.alpha, 1.f) 
+            || ! CGAffineTransformIsIdentity(frontView.transform)
+            || ! CATransform3DIsIdentity(frontView.layer.transform)) {
+        return NO;
+    }
+    
+    UIView *frontContentView = self.frontContentView;
+    if (frontContentView.hidden || ! floateq(frontContentView.alpha, 1.f)) {
+        return NO;
+    }
+    
+    CGColorRef backgroundColor = frontContentView.backgroundColor.CGColor;
+    if (! backgroundColor || ! floateq(CGColorGetAlpha(backgroundColor), 1.f)) {
+        return NO;
+    }
+    
+    // Content views might be rotated by multiples of 90 degrees (landscape-only view controllers displayed in portrait 
+    // orientation, and conversely), in which case their bounding box in the group view is still exact
+    CGAffineTransform transform = frontContentView.transform;
+    BOOL axisAligned = (floateq(transform.b, 0.f) && floateq(transform.c, 0.f)) 
+        || (floateq(transform.a, 0.f) && floateq(transform.d, 0.f));
+    if (! axisAligned || ! CATransform3DIsAffine(frontContentView.layer.transform)) {
+        return NO;
+    }
+    
+    CGRect frontContentFrame = [frontContentView convertRect:frontContentView.bounds toView:self];
+    return CGRectContainsRect(CGRectInset(frontContentFrame, -0.5f, -0.5f), self.bounds);
+}
+
 @end
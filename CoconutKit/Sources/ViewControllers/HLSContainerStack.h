@@ -11,8 +11,29 @@
 #import "HLSTransition.h"
 
 // Forward declarations
+@class HLSUserInterfaceLockToken;
 @protocol HLSContainerStackDelegate;
 
+/**
+ * View controllers which are often pushed into stacks, popped and then pushed again (e.g. detail views in a browsing flow) 
+ * can adopt this protocol to be recycled instead of being created from scratch each time. When such a view controller
+ * is popped from an HLSContainerStack (or removed from it), it is kept in a per-class reuse pool, with its view loaded,
+ * instead of being released. Call +[HLSContainerStack dequeueReusableViewControllerOfClass:] to get a view controller
+ * from the pool before allocating a new one: This avoids loading the view (and the associated nib) again. The pool
+ * keeps a few view controllers per class and is emptied when a memory warning is received
+ *
+ * Since view controllers are recycled, do not keep references to a reusable view controller once it has been popped
+ */
+@protocol HLSReusableViewController <NSObject>
+
+/**
+ * Called when the view controller is dequeued from the reuse pool, right before it is returned to the caller. Reset
+ * any state related to the content previously displayed
+ */
+- (void)prepareForReuse;
+
+@end
+
 // Standard capacities
 extern const NSUInteger HLSContainerStackMinimalCapacity;
 extern const NSUInteger HLSContainerStackDefaultCapacity;
@@ -60,6 +81,10 @@ extern const NSUInteger HLSContainerStackUnlimitedCapacity;
  *     to a stack displaying a single child view controller). Usually, the default capacity (which is given by
  *     HLSContainerStackDefaultCapacity = 2) should fulfill most needs, but if you require more transparency levels
  *     you can increase this value. Standard capacity values are provided at the beginning of this file.
+ *     When view controllers are not removed, the capacity adapts to memory pressure: Each memory warning halves the
+ *     number of views which can be loaded, unloading those of the deepest (i.e. least recently shown) view controllers
+ *     first. Once no memory warning has been received for a while, the capacity grows back by one view controller at 
+ *     each transition until the capacity given at creation is reached again
  *   - custom containers implemented using HLSContainerStack behave correctly, whether they are embedded into 
  *     another container (even built-in ones), displayed as the root of an application, or modally
  *   - stacks can be used to display any kind of view controllers, even standard UIKit containers like
@@ -71,6 +96,8 @@ extern const NSUInteger HLSContainerStackUnlimitedCapacity;
  *   - children view controller's views are instantiated right when needed, avoding wasting memory
  *   - view controllers are owned by a stack, but if you need to cache some of them for performance reasons,
  *     you still can: Simply keep and manage an external strong reference to the view controllers you want to cache
+ *   - view controllers pushed often can adopt the HLSReusableViewController protocol so that they are recycled
+ *     when popped, sparing view loading when pushed again
  *   - storyboards are supported (iOS 5 and above only). You are responsible of implementing segues in your own
  *     container implementations, though (see HLSPlaceholderViewController.m and HLSStackController.m for examples)
  *   - view controller containment relationships are consistent with those expected from UIKit built-in containers.
@@ -121,12 +148,26 @@ extern const NSUInteger HLSContainerStackUnlimitedCapacity;
     NSMutableArray *m_containerContents;                       // The contents loaded into the stack. The first element corresponds to the root view controller
     UIView *m_containerView;                                   // The view where the stack displays its contents
     NSUInteger m_capacity;                                     // The maximum number of top view controllers loaded / not removed at any time
+    NSUInteger m_adaptiveCapacity;                             // The capacity currently applied (lowered when memory warnings are received)
+    CFAbsoluteTime m_lastMemoryWarningTime;                    // The time at which the last memory warning was received
+    BOOL m_releasingViewsOverAdaptiveCapacity;                 // Set to YES when views must be released once the running animation ends
     BOOL m_removing;                                           // If YES, view controllers over capacity are removed from the stack, otherwise their views are simply unloaded
     BOOL m_rootViewControllerFixed;                            // Is the root view controller fixed?
     BOOL m_animating;                                          // Set to YES when a transition animation is running
     BOOL m_rotating;
+    NSUInteger m_rotatingContainerContentCount;                // Number of top contents receiving the events of the rotation being performed
     HLSAutorotationMode m_autorotationMode;                    // How the container decides to behave when rotation occurs
     id<HLSContainerStackDelegate> m_delegate;                  // The stack delegate, usually the custom container which is implemented
+    UIViewController *m_preloadedViewController;               // The view controller likely to be pushed next, if any
+    HLSAnimation *m_interactiveAnimation;                      // The paused pop animation driven by an interactive transition
+    CGFloat m_interactiveTransitionProgress;                   // The progress of the interactive transition, in [0; 1]
+    BOOL m_beginningInteractiveTransition;                     // Set to YES while the interactive pop animation is being created
+    NSMutableArray *m_updateEntries;                           // The stack contents while batching updates (see -beginUpdates)
+    NSUInteger m_updateCount;                                  // Number of -beginUpdates calls not balanced by -endUpdatesAnimated: yet
+    NSArray *m_deferredUpdateEntries;                          // The stack contents to reach below the top once a batched transition is over
+    NSArray *m_queuedUpdateEntries;                            // The stack contents of a batch which ended while a transition was running
+    BOOL m_queuedUpdatesAnimated;
+    HLSUserInterfaceLockToken *m_transitionLockToken;          // Keeps the UI locked during a whole locking transition, callbacks included
 }
 
 /**
@@ -134,6 +175,17 @@ extern const NSUInteger HLSContainerStackUnlimitedCapacity;
  */
 + (id)singleControllerContainerStackWithContainerViewController:(UIViewController *)containerViewController;
 
+/**
+ * Return a view controller of the specified class from the reuse pool (see HLSReusableViewController protocol), or nil 
+ * if none is available. The view controller received -prepareForReuse before being returned
+ */
++ (id)dequeueReusableViewControllerOfClass:(Class)viewControllerClass;
+
+/**
+ * Release all view controllers currently kept in the reuse pool
+ */
++ (void)purgeReusableViewControllers;
+
 /**
  * Create a stack which will manage the children view controllers of a container view controller. The containerViewController
  * parameter is the container you want to implement (which must itself instantiate the HLSContainerStack objects it requires) 
@@ -216,12 +268,75 @@ extern const NSUInteger HLSContainerStackUnlimitedCapacity;
                   duration:(NSTimeInterval)duration
                   animated:(BOOL)animated;
 
+/**
+ * Register the view controller which is likely to be pushed next. Its view is loaded and laid out with the container
+ * view bounds during the next run loop iteration, i.e. off the critical path of the push itself, so that a later push
+ * of this view controller starts animating right away instead of paying for -loadView and -viewDidLoad first. Only one
+ * view controller can be preloaded at a time: Calling this method again replaces the previous registration, and nil
+ * cancels it. The view controller is retained until pushed, replaced or until -releaseViews is called. If it is already
+ * in the stack, this method does nothing
+ */
+- (void)preloadViewController:(UIViewController *)viewController;
+
 /**
  * Pop the current top view controller, playing the reverse animation corresponding to the one it has been pushed with.
  * If the root view controller is fixed, you cannot pop it
  */
 - (void)popViewControllerAnimated:(BOOL)animated;
 
+/**
+ * Batch stack changes. Between -beginUpdates and the matching -endUpdatesAnimated: call, pushes, pops, insertions and 
+ * removals are not applied to the stack immediately, but recorded. Methods returning the stack contents (e.g. -count
+ * or -viewControllers) already reflect the recorded changes. When -endUpdatesAnimated: is called, the changes collapse into 
+ * their net result, which is applied with at most one transition: 
+ *   - if the top view controller changes into one which was not in the stack, the new top view controller is pushed 
+ *     with the transition it was recorded with
+ *   - if the new top view controller was already in the stack, a pop to it is played
+ *   - otherwise no transition occurs 
+ * View controllers are compared by identity. Those which only moved within the stack are kept, and only the ones whose
+ * order changed are removed and inserted again. View controllers unaffected by the net change (e.g. pushed and popped 
+ * within the same batch) are neither loaded nor do they receive any view lifecycle events. Calls can be nested, the 
+ * changes are applied when the outermost batch ends. If a transition animation is running at that time, the changes are
+ * applied once it is over (a batch started in the meantime starts from the queued stack contents and replaces them)
+ */
+- (void)beginUpdates;
+- (void)endUpdatesAnimated:(BOOL)animated;
+
+/**
+ * Interactive pop transitions. Instead of running to completion, the pop transition can be driven by a gesture:
+ *   - call -beginInteractivePopTransition to pop the top view controller. The reverse animation corresponding to the
+ *     one it was pushed with is started, but paused immediately
+ *   - call -updateInteractivePopTransitionWithProgress: as the gesture changes to move the animation accordingly (the 
+ *     progress must be between 0 and 1)
+ *   - call -finishInteractivePopTransition to let the animation run to completion from its current position, or
+ *     -cancelInteractivePopTransition to animate back to the original position, leaving the view controller in the
+ *     stack
+ * The UI is not locked during an interactive transition, but other pushes and pops are rejected until it is over. When
+ * a transition is cancelled, the view controller which was about to be revealed receives the disappearance events, while
+ * the top view controller receives the appearance events again. The delegate receives the will events as for any other
+ * pop, but no did events if the pop is cancelled
+ *
+ * Remark: Animations can only be moved within their current animation step. Interactive transitions therefore work
+ *         best with transition classes made of a single animation step
+ */
+- (void)beginInteractivePopTransition;
+- (void)updateInteractivePopTransitionWithProgress:(CGFloat)progress;
+- (void)finishInteractivePopTransition;
+- (void)cancelInteractivePopTransition;
+
+/**
+ * Return YES iff an interactive pop transition is running
+ */
+- (BOOL)isInteractivePopTransitionRunning;
+
+/**
+ * Drive an interactive pop transition with a horizontal pan gesture, so that a recognizer can be directly bound to a stack
+ * using -addTarget:action:. The progress is the horizontal translation relative to the container view width. When the gesture
+ * ends, the transition is finished if the gesture is fast enough in the pop direction, or if more than half of it has been
+ * performed without moving back, otherwise it is cancelled
+ */
+- (void)handleInteractivePopPanGesture:(UIPanGestureRecognizer *)panGestureRecognizer;
+
 /**
  * Pop all view controllers up to a given view controller (animated or not). If viewController is set to nil, this 
  * method pops all view controllers (except if the root view controller is fixed, in which case this method does
@@ -14,6 +14,7 @@
 #import "HLSFloat.h"
 #import "HLSLayerAnimationStep.h"
 #import "HLSLogger.h"
+#import "HLSUserInterfaceLock.h"
 #import "NSArray+HLSExtensions.h"
 #import "UIViewController+HLSExtensions.h"
 
@@ -22,11 +23,35 @@ const NSUInteger HLSContainerStackMinimalCapacity = 1;
 const NSUInteger HLSContainerStackDefaultCapacity = 2;
 const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
 
+// Time during which no memory warning must have been received before the adaptive capacity can grow again
+static const NSTimeInterval kContainerStackCapacityRecoveryDelay = 30.;
+
+// Keys of the entries recorded while batching updates
+static NSString * const kUpdateEntryViewControllerKey = @"viewController";
+static NSString * const kUpdateEntryTransitionClassKey = @"transitionClass";
+static NSString * const kUpdateEntryDurationKey = @"duration";
+
+// Horizontal velocity (in points per second) above which an interactive pop gesture always finishes the transition
+static const CGFloat kContainerStackInteractivePopMinimumVelocity = 500.f;
+
+// Maximum number of view controllers kept in the reuse pool for each class
+static const NSUInteger kContainerStackReusePoolCapacityPerClass = 2;
+
+// Map class names to the arrays of view controllers available for reuse
+static NSMutableDictionary *s_classNameToReusableViewControllersMap = nil;
+
 @interface HLSContainerStack () <HLSContainerStackViewDelegate>
 
 @property (nonatomic, assign) UIViewController *containerViewController;
 @property (nonatomic, retain) NSMutableArray *containerContents;
 @property (nonatomic, assign) NSUInteger capacity;
+@property (nonatomic, retain) UIViewController *preloadedViewController;
+@property (nonatomic, assign) NSUInteger adaptiveCapacity;
+@property (nonatomic, retain) HLSAnimation *interactiveAnimation;
+@property (nonatomic, retain) NSMutableArray *updateEntries;
+@property (nonatomic, retain) NSArray *deferredUpdateEntries;
+@property (nonatomic, retain) NSArray *queuedUpdateEntries;
+@property (nonatomic, retain) HLSUserInterfaceLockToken *transitionLockToken;
 
 - (HLSContainerContent *)topContainerContent;
 - (HLSContainerContent *)secondTopContainerContent;
@@ -36,8 +61,18 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
 - (void)addViewForContainerContent:(HLSContainerContent *)containerContent
                          inserting:(BOOL)inserting
                           animated:(BOOL)animated;
+- (void)loadPreloadedViewControllerView;
+- (void)releaseViewsOverAdaptiveCapacity;
+- (void)applyUpdateEntries:(NSArray *)updateEntries animated:(BOOL)animated;
+- (void)applyDeferredUpdates;
+- (void)arrangeViewControllersWithUpdateEntries:(NSArray *)updateEntries;
+- (void)applyQueuedUpdates;
+- (void)increaseAdaptiveCapacityIfPossible;
+- (NSUInteger)visibleContainerContentCount;
+- (void)forwardDeferredRotationsToVisibleContainerContents;
 - (void)rotateContainerContent:(HLSContainerContent *)containerContent
        forInterfaceOrientation:(UIInterfaceOrientation)interfaceOrientation;
+- (void)recycleViewController:(UIViewController *)viewController;
 
 @end
 
@@ -45,6 +80,39 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
 
 #pragma mark Class methods
 
++ (void)initialize
+{
+    if (self != [HLSContainerStack class]) {
+        return;
+    }
+    
+    s_classNameToReusableViewControllersMap = [[NSMutableDictionary alloc] init];
+    
+    // The reuse pool is shared by all stacks. Trim it even if no stack is alive
+    [[NSNotificationCenter defaultCenter] addObserver:self
+                                             selector:@selector(reusePoolDidReceiveMemoryWarning:)
+                                                 name:UIApplicationDidReceiveMemoryWarningNotification
+                                               object:nil];
+}
+
++ (id)dequeueReusableViewControllerOfClass:(Class)viewControllerClass
+{
+    NSMutableArray *reusableViewControllers = [s_classNameToReusableViewControllersMap objectForKey:NSStringFromClass(viewControllerClass)];
+    UIViewController<HLSReusableViewController> *viewController = [[[reusableViewControllers lastObject] retain] autorelease];
+    if (! viewController) {
+        return nil;
+    }
+    
+    [reusableViewControllers removeLastObject];
+    [viewController prepareForReuse];
+    return viewController;
+}
+
++ (void)purgeReusableViewControllers
+{
+    [s_classNameToReusableViewControllersMap removeAllObjects];
+}
+
 + (id)singleControllerContainerStackWithContainerViewController:(UIViewController *)containerViewController
 {
     return [[[[self class] alloc] initWithContainerViewController:containerViewController
@@ -73,6 +141,11 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
         m_removing = removing;
         m_rootViewControllerFixed = rootViewControllerFixed;
         m_autorotationMode = HLSAutorotationModeContainer;
+        
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(applicationDidReceiveMemoryWarning:)
+                                                     name:UIApplicationDidReceiveMemoryWarningNotification
+                                                   object:nil];
     }
     return self;
 }
@@ -85,10 +158,20 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
 
 - (void)dealloc
 {
+    [[NSNotificationCenter defaultCenter] removeObserver:self
+                                                    name:UIApplicationDidReceiveMemoryWarningNotification
+                                                  object:nil];
+    
     self.containerViewController = nil;
     self.containerContents = nil;
     self.containerView = nil;
     self.delegate = nil;
+    self.preloadedViewController = nil;
+    self.interactiveAnimation = nil;
+    self.updateEntries = nil;
+    self.deferredUpdateEntries = nil;
+    self.queuedUpdateEntries = nil;
+    self.transitionLockToken = nil;
 
     [super dealloc];
 }
@@ -127,6 +210,13 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
         [containerView addSubview:containerStackView];
     }
     
+    // The previous container view might be kept (e.g. when only the stack views are released). Do not leave the stack
+    // view behind
+    UIView *previousContainerStackView = [self containerStackView];
+    if ([previousContainerStackView isKindOfClass:[HLSContainerStackView class]]) {
+        [previousContainerStackView removeFromSuperview];
+    }
+    
     [m_containerView release];
     m_containerView = [containerView retain];
 }
@@ -138,6 +228,8 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
 
 @synthesize capacity = m_capacity;
 
+@synthesize preloadedViewController = m_preloadedViewController;
+
 - (void)setCapacity:(NSUInteger)capacity
 {
     if (capacity < HLSContainerStackMinimalCapacity) {
@@ -146,6 +238,25 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
     }
     
     m_capacity = capacity;
+    m_adaptiveCapacity = capacity;
+}
+
+@synthesize adaptiveCapacity = m_adaptiveCapacity;
+
+@synthesize interactiveAnimation = m_interactiveAnimation;
+
+@synthesize updateEntries = m_updateEntries;
+
+@synthesize deferredUpdateEntries = m_deferredUpdateEntries;
+
+@synthesize queuedUpdateEntries = m_queuedUpdateEntries;
+
+@synthesize transitionLockToken = m_transitionLockToken;
+
+- (NSUInteger)adaptiveCapacity
+{
+    // When removing, the capacity is the number of view controllers in the stack, which must not change
+    return m_removing ? m_capacity : m_adaptiveCapacity;
 }
 
 @synthesize autorotationMode = m_autorotationMode;
@@ -167,18 +278,30 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
 
 - (UIViewController *)rootViewController
 {
+    if (m_updateCount != 0) {
+        return [[self viewControllers] firstObject_hls];
+    }
+    
     HLSContainerContent *rootContainerContent = [self.containerContents firstObject_hls];
     return rootContainerContent.viewController;
 }
 
 - (UIViewController *)topViewController
 {
+    if (m_updateCount != 0) {
+        return [[self viewControllers] lastObject];
+    }
+    
     HLSContainerContent *topContainerContent = [self topContainerContent];
     return topContainerContent.viewController;
 }
 
 - (NSArray *)viewControllers
 {
+    if (m_updateCount != 0) {
+        return [self.updateEntries valueForKey:kUpdateEntryViewControllerKey];
+    }
+    
     NSMutableArray *viewControllers = [NSMutableArray array];
     for (HLSContainerContent *containerContent in self.containerContents) {
         [viewControllers addObject:containerContent.viewController];
@@ -188,6 +311,10 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
 
 - (NSUInteger)count
 {
+    if (m_updateCount != 0) {
+        return [self.updateEntries count];
+    }
+    
     return [self.containerContents count];
 }
 
@@ -203,13 +330,33 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
 
 #pragma mark Adding and removing view controllers
 
+- (void)preloadViewController:(UIViewController *)viewController
+{
+    [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(loadPreloadedViewControllerView) object:nil];
+    
+    if (viewController && [[self viewControllers] containsObject:viewController]) {
+        HLSLoggerWarn(@"The view controller to preload is already in the stack");
+        self.preloadedViewController = nil;
+        return;
+    }
+    
+    self.preloadedViewController = viewController;
+    if (! viewController) {
+        return;
+    }
+    
+    // Defer loading to the next run loop iteration so that the caller (usually the top view controller reacting to some
+    // user interaction) is not slowed down
+    [self performSelector:@selector(loadPreloadedViewControllerView) withObject:nil afterDelay:0.];
+}
+
 - (void)pushViewController:(UIViewController *)viewController
        withTransitionClass:(Class)transitionClass
                   duration:(NSTimeInterval)duration
                   animated:(BOOL)animated
 {
     [self insertViewController:viewController
-                       atIndex:[self.containerContents count] 
+                       atIndex:[self count] 
            withTransitionClass:transitionClass
                       duration:duration
                       animated:animated];
@@ -217,7 +364,306 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
 
 - (void)popViewControllerAnimated:(BOOL)animated
 {
-    [self removeViewControllerAtIndex:[self.containerContents count] - 1 animated:animated];
+    [self removeViewControllerAtIndex:[self count] - 1 animated:animated];
+}
+
+- (void)beginUpdates
+{
+    if (m_updateCount == 0) {
+        // Start from the stack contents which will be reached once the running transition is over (if any)
+        NSArray *pendingUpdateEntries = self.queuedUpdateEntries ? self.queuedUpdateEntries : self.deferredUpdateEntries;
+        if (pendingUpdateEntries) {
+            self.updateEntries = [NSMutableArray arrayWithArray:pendingUpdateEntries];
+            ++m_updateCount;
+            return;
+        }
+        
+        self.updateEntries = [NSMutableArray array];
+        for (HLSContainerContent *containerContent in self.containerContents) {
+            NSDictionary *updateEntry = [NSDictionary dictionaryWithObjectsAndKeys:containerContent.viewController, kUpdateEntryViewControllerKey,
+                                         containerContent.transitionClass, kUpdateEntryTransitionClassKey,
+                                         [NSNumber numberWithDouble:containerContent.duration], kUpdateEntryDurationKey, nil];
+            [self.updateEntries addObject:updateEntry];
+        }
+    }
+    ++m_updateCount;
+}
+
+- (void)endUpdatesAnimated:(BOOL)animated
+{
+    if (m_updateCount == 0) {
+        HLSLoggerError(@"Unbalanced -endUpdatesAnimated: call");
+        return;
+    }
+    
+    --m_updateCount;
+    if (m_updateCount != 0) {
+        return;
+    }
+    
+    NSArray *updateEntries = [NSArray arrayWithArray:self.updateEntries];
+    self.updateEntries = nil;
+    
+    // Apply the changes once the running transition is over. Since the batch describes the whole stack, it replaces
+    // any batch queued before
+    if (m_animating) {
+        self.queuedUpdateEntries = updateEntries;
+        m_queuedUpdatesAnimated = animated;
+        return;
+    }
+    
+    [self applyUpdateEntries:updateEntries animated:animated];
+}
+
+- (void)applyUpdateEntries:(NSArray *)updateEntries animated:(BOOL)animated
+{
+    NSArray *updatedViewControllers = [updateEntries valueForKey:kUpdateEntryViewControllerKey];
+    UIViewController *updatedTopViewController = [updatedViewControllers lastObject];
+    HLSContainerContent *topContainerContent = [self topContainerContent];
+    
+    // Remove the view controllers which have disappeared, except the top one (no transition animation is involved)
+    for (HLSContainerContent *containerContent in [NSArray arrayWithArray:self.containerContents]) {
+        if (containerContent != topContainerContent && ! [updatedViewControllers containsObject:containerContent.viewController]) {
+            [self removeViewController:containerContent.viewController animated:NO];
+        }
+    }
+    
+    // The view controllers below the top are arranged once the transition is over, so that they receive no view lifecycle 
+    // events
+    self.deferredUpdateEntries = updateEntries;
+    
+    NSArray *viewControllers = [self viewControllers];
+    if (updatedTopViewController == topContainerContent.viewController) {
+        // The top view controller does not change. No transition
+    }
+    else if (! updatedTopViewController || [viewControllers containsObject:updatedTopViewController]) {
+        // Pop to the new top view controller (or pop everything). The view controllers between it and the current top 
+        // are not visible and can be removed without transition
+        NSUInteger index = updatedTopViewController ? [viewControllers indexOfObject:updatedTopViewController] : NSUIntegerMax;
+        while ([self.containerContents count] > 1 && (index == NSUIntegerMax || [self.containerContents count] > index + 2)) {
+            [self removeViewControllerAtIndex:[self.containerContents count] - 2 animated:NO];
+        }
+        [self removeViewControllerAtIndex:[self.containerContents count] - 1 animated:animated];
+    }
+    else {
+        // Push the new top view controller over the current one
+        NSDictionary *topUpdateEntry = [updateEntries lastObject];
+        [self insertViewController:updatedTopViewController
+                           atIndex:[self.containerContents count]
+               withTransitionClass:[topUpdateEntry objectForKey:kUpdateEntryTransitionClassKey]
+                          duration:[[topUpdateEntry objectForKey:kUpdateEntryDurationKey] doubleValue]
+                          animated:animated];
+    }
+    
+    // Not animated or not displayed: Nothing to wait for (nothing happens if the updates have already been applied)
+    if (! m_animating) {
+        [self applyDeferredUpdates];
+    }
+}
+
+- (void)applyDeferredUpdates
+{
+    // A batch started in the meantime already contains these changes, and will apply them. The entries are discarded
+    // only once applied, so that the view controllers they move are not recycled when removed to be inserted again
+    if (self.deferredUpdateEntries && m_updateCount == 0) {
+        [self arrangeViewControllersWithUpdateEntries:[[self.deferredUpdateEntries retain] autorelease]];
+    }
+    self.deferredUpdateEntries = nil;
+}
+
+- (void)arrangeViewControllersWithUpdateEntries:(NSArray *)updateEntries
+{
+    NSArray *updatedViewControllers = [updateEntries valueForKey:kUpdateEntryViewControllerKey];
+    HLSContainerContent *topContainerContent = [self topContainerContent];
+    if (topContainerContent.viewController != [updatedViewControllers lastObject]) {
+        HLSLoggerWarn(@"The top view controller is not the expected one. Batched updates cannot be completed");
+        return;
+    }
+    
+    // Everything has been popped
+    if ([updateEntries count] == 0) {
+        return;
+    }
+    
+    // Remove the view controllers which are not part of the updated stack (e.g. the view controller covered by a push)
+    for (HLSContainerContent *containerContent in [NSArray arrayWithArray:self.containerContents]) {
+        if (containerContent != topContainerContent && ! [updatedViewControllers containsObject:containerContent.viewController]) {
+            [self removeViewController:containerContent.viewController animated:NO];
+        }
+    }
+    
+    // Keep the longest sequence of view controllers below the top which are already in the expected order. Only the
+    // view controllers which moved relative to it need to be removed and inserted again
+    NSUInteger count = [self.containerContents count] - 1;
+    if (count != 0) {
+        NSUInteger *updatedIndexes = malloc(count * sizeof(NSUInteger));
+        NSUInteger *sequenceLengths = malloc(count * sizeof(NSUInteger));
+        NSUInteger *previousIndexes = malloc(count * sizeof(NSUInteger));
+        NSUInteger lastIndex = 0;
+        for (NSUInteger i = 0; i < count; ++i) {
+            UIViewController *viewController = [[self.containerContents objectAtIndex:i] viewController];
+            updatedIndexes[i] = [updatedViewControllers indexOfObject:viewController];
+            sequenceLengths[i] = 1;
+            previousIndexes[i] = NSNotFound;
+            for (NSUInteger j = 0; j < i; ++j) {
+                if (updatedIndexes[j] < updatedIndexes[i] && sequenceLengths[j] + 1 > sequenceLengths[i]) {
+                    sequenceLengths[i] = sequenceLengths[j] + 1;
+                    previousIndexes[i] = j;
+                }
+            }
+            if (sequenceLengths[i] > sequenceLengths[lastIndex]) {
+                lastIndex = i;
+            }
+        }
+        
+        NSMutableSet *keptViewControllers = [NSMutableSet set];
+        for (NSUInteger i = lastIndex; i != NSNotFound; i = previousIndexes[i]) {
+            [keptViewControllers addObject:[[self.containerContents objectAtIndex:i] viewController]];
+        }
+        free(updatedIndexes);
+        free(sequenceLengths);
+        free(previousIndexes);
+        
+        for (HLSContainerContent *containerContent in [NSArray arrayWithArray:self.containerContents]) {
+            if (containerContent != topContainerContent && ! [keptViewControllers containsObject:containerContent.viewController]) {
+                [self removeViewController:containerContent.viewController animated:NO];
+            }
+        }
+    }
+    
+    // The view controllers below the top are now in the expected order. Insert the missing ones
+    for (NSUInteger i = 0; i < [updateEntries count] - 1; ++i) {
+        NSDictionary *updateEntry = [updateEntries objectAtIndex:i];
+        UIViewController *viewController = [updateEntry objectForKey:kUpdateEntryViewControllerKey];
+        if ([[self.containerContents objectAtIndex:i] viewController] == viewController) {
+            continue;
+        }
+        
+        [self insertViewController:viewController
+                           atIndex:i
+               withTransitionClass:[updateEntry objectForKey:kUpdateEntryTransitionClassKey]
+                          duration:[[updateEntry objectForKey:kUpdateEntryDurationKey] doubleValue]
+                          animated:NO];
+    }
+}
+
+- (void)applyQueuedUpdates
+{
+    NSArray *queuedUpdateEntries = [[self.queuedUpdateEntries retain] autorelease];
+    self.queuedUpdateEntries = nil;
+    
+    // A batch started in the meantime already contains these changes, and will apply them
+    if (! queuedUpdateEntries || m_updateCount != 0) {
+        return;
+    }
+    
+    [self applyUpdateEntries:queuedUpdateEntries animated:m_queuedUpdatesAnimated];
+}
+
+- (void)beginInteractivePopTransition
+{
+    if (self.interactiveAnimation) {
+        HLSLoggerWarn(@"An interactive pop transition is already running");
+        return;
+    }
+    
+    // The pop animation is created and paused when the top view controller is removed (see -removeViewControllerAtIndex:animated:)
+    m_beginningInteractiveTransition = YES;
+    [self popViewControllerAnimated:YES];
+    m_beginningInteractiveTransition = NO;
+    
+    m_interactiveTransitionProgress = 0.f;
+}
+
+- (void)updateInteractivePopTransitionWithProgress:(CGFloat)progress
+{
+    if (! self.interactiveAnimation) {
+        HLSLoggerDebug(@"No interactive pop transition is running");
+        return;
+    }
+    
+    m_interactiveTransitionProgress = MIN(MAX(progress, 0.f), 1.f);
+    [self.interactiveAnimation seekToTime:m_interactiveTransitionProgress * self.interactiveAnimation.duration];
+}
+
+- (void)finishInteractivePopTransition
+{
+    if (! self.interactiveAnimation) {
+        HLSLoggerDebug(@"No interactive pop transition is running");
+        return;
+    }
+    
+    // The pop then ends as usual (see animation callbacks)
+    HLSAnimation *interactiveAnimation = [[self.interactiveAnimation retain] autorelease];
+    self.interactiveAnimation = nil;
+    [interactiveAnimation resume];
+}
+
+- (void)cancelInteractivePopTransition
+{
+    if (! self.interactiveAnimation) {
+        HLSLoggerDebug(@"No interactive pop transition is running");
+        return;
+    }
+    
+    HLSAnimation *interactiveAnimation = [[self.interactiveAnimation retain] autorelease];
+    self.interactiveAnimation = nil;
+    
+    // Cancelling brings the views to their popped position without the pop animation end being notified (the view
+    // controller therefore stays in the stack). Then animate back from the point reached by the gesture
+    [interactiveAnimation cancel];
+    
+    HLSAnimation *cancelAnimation = [interactiveAnimation reverseAnimation];
+    cancelAnimation.tag = @"cancel_pop_animation";
+    cancelAnimation.lockingUI = YES;
+    cancelAnimation.delegate = self;
+    [cancelAnimation playWithStartTime:(1.f - m_interactiveTransitionProgress) * cancelAnimation.duration];
+}
+
+- (BOOL)isInteractivePopTransitionRunning
+{
+    return self.interactiveAnimation != nil;
+}
+
+- (void)handleInteractivePopPanGesture:(UIPanGestureRecognizer *)panGestureRecognizer
+{
+    switch (panGestureRecognizer.state) {
+        case UIGestureRecognizerStateBegan: {
+            [self beginInteractivePopTransition];
+            break;
+        }
+            
+        case UIGestureRecognizerStateChanged: {
+            CGFloat width = CGRectGetWidth(self.containerView.bounds);
+            if (floateq(width, 0.f)) {
+                break;
+            }
+            [self updateInteractivePopTransitionWithProgress:[panGestureRecognizer translationInView:self.containerView].x / width];
+            break;
+        }
+            
+        case UIGestureRecognizerStateEnded: {
+            CGFloat velocity = [panGestureRecognizer velocityInView:self.containerView].x;
+            if (velocity > kContainerStackInteractivePopMinimumVelocity
+                    || (m_interactiveTransitionProgress > 0.5f && velocity >= 0.f)) {
+                [self finishInteractivePopTransition];
+            }
+            else {
+                [self cancelInteractivePopTransition];
+            }
+            break;
+        }
+            
+        case UIGestureRecognizerStateCancelled:
+        case UIGestureRecognizerStateFailed: {
+            [self cancelInteractivePopTransition];
+            break;
+        }
+            
+        default: {
+            break;
+        }
+    }
 }
 
 - (void)popToViewController:(UIViewController *)viewController animated:(BOOL)animated
@@ -242,7 +688,7 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
 
 - (void)popToViewControllerAtIndex:(NSUInteger)index animated:(BOOL)animated
 {
-    if ([self.containerContents count] == 0) {
+    if ([self count] == 0) {
         HLSLoggerInfo(@"Nothing to pop: The view controller container is empty");
         return;
     }
@@ -251,16 +697,16 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
     NSUInteger firstRemovedIndex = 0;
     if (index != NSUIntegerMax) {
         // Remove in the middle
-        if (index < [self.containerContents count] - 1) {
+        if (index < [self count] - 1) {
             firstRemovedIndex = index + 1;
         }
         // Nothing to do if we pop to the current top view controller
-        else if (index == [self.containerContents count] - 1) {
+        else if (index == [self count] - 1) {
             HLSLoggerInfo(@"Nothing to pop: The view controller displayed is already the one you try to pop to");
             return;            
         }
         else {
-            HLSLoggerError(@"Invalid index %d. Expected in [0;%d]", index, [self.containerContents count] - 2);
+            HLSLoggerError(@"Invalid index %d. Expected in [0;%d]", index, [self count] - 2);
             return;
         }
     }
@@ -274,17 +720,26 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
         firstRemovedIndex = 0;
     }
     
+    // Batching updates: Just record the change
+    if (m_updateCount != 0) {
+        [self.updateEntries removeObjectsInRange:NSMakeRange(firstRemovedIndex, [self.updateEntries count] - firstRemovedIndex)];
+        return;
+    }
+    
     // Remove the view controllers until the one we want to pop to (except the topmost one, for which we will play
     // the pop animation if desired)
     NSUInteger i = [self.containerContents count] - firstRemovedIndex - 1;
     while (i > 0) {
+        UIViewController *removedViewController = [[[self.containerContents objectAtIndex:firstRemovedIndex] viewController] retain];
         [self.containerContents removeObjectAtIndex:firstRemovedIndex];
+        [self recycleViewController:removedViewController];
+        [removedViewController release];
         --i;
     }
     
     // Resurrect view controller's views below the view controller we pop to so that the capacity criterium
     // is satisfied
-    for (NSUInteger i = 0; i < MIN(self.capacity, [self.containerContents count]); ++i) {
+    for (NSUInteger i = 0; i < MIN(self.adaptiveCapacity, [self.containerContents count]); ++i) {
         NSUInteger index = firstRemovedIndex - 1 - i;
         HLSContainerContent *containerContent = [self.containerContents objectAtIndex:index];
         [self addViewForContainerContent:containerContent inserting:NO animated:NO];
@@ -319,13 +774,8 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
         return;
     }
     
-    if (index > [self.containerContents count]) {
-        HLSLoggerError(@"Invalid index %d. Expected in [0;%d]", index, [self.containerContents count]);
-        return;
-    }
-    
-    if (m_animating) {
-        HLSLoggerWarn(@"Cannot insert a view controller while a transition animation is running");
+    if (index > [self count]) {
+        HLSLoggerError(@"Invalid index %d. Expected in [0;%d]", index, [self count]);
         return;
     }
     
@@ -335,6 +785,20 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
         return;
     }
     
+    // Batching updates: Just record the change
+    if (m_updateCount != 0) {
+        NSDictionary *updateEntry = [NSDictionary dictionaryWithObjectsAndKeys:viewController, kUpdateEntryViewControllerKey,
+                                     transitionClass ? transitionClass : [HLSTransition class], kUpdateEntryTransitionClassKey,
+                                     [NSNumber numberWithDouble:duration], kUpdateEntryDurationKey, nil];
+        [self.updateEntries insertObject:updateEntry atIndex:index];
+        return;
+    }
+    
+    if (m_animating) {
+        HLSLoggerWarn(@"Cannot insert a view controller while a transition animation is running");
+        return;
+    }
+    
     if ([self.containerViewController isViewDisplayed]) {
         // Notify the delegate before the view controller is actually installed on top of the stack and associated with the
         // container (see HLSContainerStackDelegate interface contract)
@@ -348,6 +812,9 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
         }
     }
         
+    // A view controller installed again must not be dequeued from the reuse pool anymore
+    [[s_classNameToReusableViewControllersMap objectForKey:NSStringFromClass([viewController class])] removeObjectIdenticalTo:viewController];
+    
     // Associate the new view controller with its container (this increases [container count])
     HLSContainerContent *containerContent = [[[HLSContainerContent alloc] initWithViewController:viewController
                                                                          containerViewController:self.containerViewController
@@ -360,6 +827,13 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
     }
     
     [self.containerContents insertObject:containerContent atIndex:index];
+    
+    // The preloaded view controller is now managed by the stack. If its view has not been loaded yet, this will happen
+    // as usual when it gets added to the container view
+    if (viewController == self.preloadedViewController) {
+        [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(loadPreloadedViewControllerView) object:nil];
+        self.preloadedViewController = nil;
+    }
 
     // If no transition occurs (pre-loading before the container view is displayed, or insertion not at the top while
     // displayed), we must call -didMoveToParentViewController: manually right after the containment relationship has
@@ -374,7 +848,7 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
     if ([self.containerViewController isViewDisplayed]) {
         // A correction needs to be applied here to account for the [container count] increase (since index was relative
         // to the previous value)
-        if ([self.containerContents count] - index - 1 <= self.capacity) {
+        if ([self.containerContents count] - index - 1 <= self.adaptiveCapacity) {
             [self addViewForContainerContent:containerContent inserting:YES animated:animated];
         }
     }
@@ -417,13 +891,8 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
 
 - (void)removeViewControllerAtIndex:(NSUInteger)index animated:(BOOL)animated
 {
-    if (index >= [self.containerContents count]) {
-        HLSLoggerError(@"Invalid index %d. Expected in [0;%d]", index, [self.containerContents count] - 1);
-        return;
-    }
-    
-    if (m_animating) {
-        HLSLoggerWarn(@"Cannot remove a view controller while a transition animation is running");
+    if (index >= [self count]) {
+        HLSLoggerError(@"Invalid index %d. Expected in [0;%d]", index, [self count] - 1);
         return;
     }
     
@@ -433,6 +902,17 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
         return;
     }
     
+    // Batching updates: Just record the change
+    if (m_updateCount != 0) {
+        [self.updateEntries removeObjectAtIndex:index];
+        return;
+    }
+    
+    if (m_animating) {
+        HLSLoggerWarn(@"Cannot remove a view controller while a transition animation is running");
+        return;
+    }
+    
     if ([self.containerViewController isViewDisplayed]) {
         // Notify the delegate
         if (index == [self.containerContents count] - 1) {
@@ -451,7 +931,7 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
         // view controller, we will have capacity + 1 view controller's views loaded during the animation. This ensures that no
         // view controllers magically pops up during animation (which could be noticed depending on the pop animation, or if view
         // controllers on top of it are transparent)
-        HLSContainerContent *containerContentAtCapacity = [self containerContentAtDepth:self.capacity];
+        HLSContainerContent *containerContentAtCapacity = [self containerContentAtDepth:self.adaptiveCapacity];
         if (containerContentAtCapacity) {
             [self addViewForContainerContent:containerContentAtCapacity inserting:NO animated:NO];
         }
@@ -469,18 +949,31 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
             //
             // Same remark as in -addViewForContainerContent:inserting:animated: regarding animations in nested containers
             reverseAnimation.tag = @"pop_animation";
-            reverseAnimation.lockingUI = YES;
+            
+            // The UI must remain responsive to the gesture driving an interactive transition
+            reverseAnimation.lockingUI = ! m_beginningInteractiveTransition;
             [reverseAnimation playAnimated:animated];
             
+            if (m_beginningInteractiveTransition) {
+                [reverseAnimation pause];
+                self.interactiveAnimation = reverseAnimation;
+            }
+            
             // Check the animation callback implementations for what happens next
         }
         else {
+            UIViewController *removedViewController = [containerContent.viewController retain];
             [reverseAnimation playAnimated:NO];
             [self.containerContents removeObject:containerContent];
+            [self recycleViewController:removedViewController];
+            [removedViewController release];
         }        
     }
     else {
+        UIViewController *removedViewController = [containerContent.viewController retain];
         [self.containerContents removeObjectAtIndex:index];
+        [self recycleViewController:removedViewController];
+        [removedViewController release];
     }
 }
 
@@ -496,6 +989,9 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
 
 - (void)releaseViews
 {
+    [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(loadPreloadedViewControllerView) object:nil];
+    self.preloadedViewController = nil;
+    
     for (HLSContainerContent *containerContent in self.containerContents) {
         [containerContent releaseViews];
     }
@@ -518,7 +1014,7 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
     }
     
     // Create the container view hierarchy with those views required according to the capacity
-    for (NSUInteger i = 0; i < MIN(self.capacity, [self.containerContents count]); ++i) {
+    for (NSUInteger i = 0; i < MIN(self.adaptiveCapacity, [self.containerContents count]); ++i) {
         // Never play transitions (we are building the view hierarchy). Only the top view controller receives the animated
         // information
         HLSContainerContent *containerContent = [self containerContentAtDepth:i];
@@ -601,7 +1097,7 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
             
         case HLSAutorotationModeContainer:
         default: {
-            for (NSUInteger i = 0; i < MIN(self.capacity, [self.containerContents count]); ++i) {
+            for (NSUInteger i = 0; i < MIN(self.adaptiveCapacity, [self.containerContents count]); ++i) {
                 NSUInteger index = [self.containerContents count] - 1 - i;
                 HLSContainerContent *containerContent = [self.containerContents objectAtIndex:index];
                 if (! [containerContent shouldAutorotate]) {
@@ -640,7 +1136,7 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
             
         case HLSAutorotationModeContainer:
         default: {
-            for (NSUInteger i = 0; i < MIN(self.capacity, [self.containerContents count]); ++i) {
+            for (NSUInteger i = 0; i < MIN(self.adaptiveCapacity, [self.containerContents count]); ++i) {
                 NSUInteger index = [self.containerContents count] - 1 - i;
                 HLSContainerContent *containerContent = [self.containerContents objectAtIndex:index];
                 supportedInterfaceOrientations &= [containerContent supportedInterfaceOrientations];
@@ -658,7 +1154,7 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
     
     if ([self.containerContents count] != 0) {
         // Avoid frame issues due to rotation
-        for (NSUInteger i = 0; i < MIN(self.capacity, [self.containerContents count]); ++i) {
+        for (NSUInteger i = 0; i < MIN(self.adaptiveCapacity, [self.containerContents count]); ++i) {
             NSUInteger index = [self.containerContents count] - 1 - i;
             HLSContainerContent *containerContent = [self.containerContents objectAtIndex:index];
             
@@ -708,10 +1204,18 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
                 
             case HLSAutorotationModeContainer:
             default: {
-                for (NSUInteger i = 0; i < MIN(self.capacity, [self.containerContents count]); ++i) {
+                // Only visible children receive rotation events. Those which are covered receive them when they appear again
+                m_rotatingContainerContentCount = [self visibleContainerContentCount];
+                UIInterfaceOrientation fromInterfaceOrientation = self.containerViewController.interfaceOrientation;
+                for (NSUInteger i = 0; i < MIN(self.adaptiveCapacity, [self.containerContents count]); ++i) {
                     NSUInteger index = [self.containerContents count] - 1 - i;
                     HLSContainerContent *containerContent = [self.containerContents objectAtIndex:index];
-                    [containerContent willRotateToInterfaceOrientation:toInterfaceOrientation duration:duration];
+                    if (i < m_rotatingContainerContentCount) {
+                        [containerContent willRotateToInterfaceOrientation:toInterfaceOrientation duration:duration];
+                    }
+                    else {
+                        [containerContent deferRotationFromInterfaceOrientation:fromInterfaceOrientation];
+                    }
                 }
                 break;
             }
@@ -723,7 +1227,7 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
 {
     if ([self.containerContents count] != 0) {
         // Avoid frame issues due to rotation
-        for (NSUInteger i = 0; i < MIN(self.capacity, [self.containerContents count]); ++i) {
+        for (NSUInteger i = 0; i < MIN(self.adaptiveCapacity, [self.containerContents count]); ++i) {
             NSUInteger index = [self.containerContents count] - 1 - i;
             HLSContainerContent *containerContent = [self.containerContents objectAtIndex:index];
             
@@ -764,7 +1268,8 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
                 
             case HLSAutorotationModeContainer:
             default: {
-                for (NSUInteger i = 0; i < MIN(self.capacity, [self.containerContents count]); ++i) {
+                // Same children as in -willRotateToInterfaceOrientation:duration:
+                for (NSUInteger i = 0; i < MIN(m_rotatingContainerContentCount, [self.containerContents count]); ++i) {
                     NSUInteger index = [self.containerContents count] - 1 - i;
                     HLSContainerContent *containerContent = [self.containerContents objectAtIndex:index];
                     [containerContent willAnimateRotationToInterfaceOrientation:toInterfaceOrientation duration:duration];
@@ -779,7 +1284,7 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
 {
     if ([self.containerContents count] != 0) {
         // Rotate the loaded child view controller's views to an orientation they support (if needed)
-        for (NSUInteger i = 0; i < MIN(self.capacity, [self.containerContents count]); ++i) {
+        for (NSUInteger i = 0; i < MIN(self.adaptiveCapacity, [self.containerContents count]); ++i) {
             NSUInteger index = [self.containerContents count] - 1 - i;
             HLSContainerContent *containerContent = [self.containerContents objectAtIndex:index];
             
@@ -813,7 +1318,8 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
                 
             case HLSAutorotationModeContainer:
             default: {
-                for (NSUInteger i = 0; i < MIN(self.capacity, [self.containerContents count]); ++i) {
+                // Same children as in -willRotateToInterfaceOrientation:duration:
+                for (NSUInteger i = 0; i < MIN(m_rotatingContainerContentCount, [self.containerContents count]); ++i) {
                     NSUInteger index = [self.containerContents count] - 1 - i;
                     HLSContainerContent *containerContent = [self.containerContents objectAtIndex:index];
                     [containerContent didRotateFromInterfaceOrientation:fromInterfaceOrientation];
@@ -915,6 +1421,145 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
     }
 }
 
+/**
+ * Return the number of top contents which are visible, i.e. down to the first one whose view completely covers
+ * the views below (included). All contents within capacity are considered visible during transitions
+ */
+- (NSUInteger)visibleContainerContentCount
+{
+    NSUInteger loadedCount = MIN(self.adaptiveCapacity, [self.containerContents count]);
+    if (m_animating) {
+        return loadedCount;
+    }
+    
+    NSUInteger visibleCount = 0;
+    while (visibleCount < loadedCount) {
+        NSUInteger index = [self.containerContents count] - 1 - visibleCount;
+        HLSContainerContent *containerContent = [self.containerContents objectAtIndex:index];
+        ++visibleCount;
+        
+        if (! [containerContent viewIfLoaded]) {
+            continue;
+        }
+        
+        HLSContainerGroupView *groupView = [[self containerStackView] groupViewForContentView:[containerContent viewIfLoaded]];
+        if ([groupView isFrontContentViewCoveringBackView]) {
+            break;
+        }
+    }
+    return visibleCount;
+}
+
+/**
+ * Forward the rotation events which have been deferred for children which are now visible
+ */
+- (void)forwardDeferredRotationsToVisibleContainerContents
+{
+    UIInterfaceOrientation interfaceOrientation = self.containerViewController.interfaceOrientation;
+    NSUInteger visibleCount = [self visibleContainerContentCount];
+    for (NSUInteger i = 0; i < visibleCount; ++i) {
+        NSUInteger index = [self.containerContents count] - 1 - i;
+        HLSContainerContent *containerContent = [self.containerContents objectAtIndex:index];
+        [containerContent forwardDeferredRotationToInterfaceOrientation:interfaceOrientation];
+    }
+}
+
+- (void)loadPreloadedViewControllerView
+{
+    UIViewController *viewController = self.preloadedViewController;
+    if (! viewController) {
+        return;
+    }
+    
+    // This is where lazy loading of the view controller's view occurs if needed
+    UIView *viewControllerView = viewController.view;
+    
+    // Lay out the view with the dimensions it will have when displayed (see -[HLSContainerContent insertAsSubviewIntoContainerStackView:atIndex:]),
+    // so that no layout pass is required when it is pushed
+    HLSContainerStackView *stackView = [self containerStackView];
+    if (stackView) {
+        viewControllerView.frame = stackView.bounds;
+        [viewControllerView layoutIfNeeded];
+    }
+}
+
+- (void)releaseViewsOverAdaptiveCapacity
+{
+    // Cannot alter the view hierarchy during a transition. Wait until it is over
+    if (m_animating) {
+        m_releasingViewsOverAdaptiveCapacity = YES;
+        return;
+    }
+    m_releasingViewsOverAdaptiveCapacity = NO;
+    
+    // The deepest view controllers are the ones which have been shown the least recently. Evict them first
+    for (NSUInteger depth = [self.containerContents count]; depth > self.adaptiveCapacity; --depth) {
+        HLSContainerContent *containerContent = [self containerContentAtDepth:depth - 1];
+        [containerContent releaseViews];
+    }
+}
+
+- (void)increaseAdaptiveCapacityIfPossible
+{
+    if (m_removing || m_adaptiveCapacity >= m_capacity) {
+        return;
+    }
+    
+    if (CFAbsoluteTimeGetCurrent() - m_lastMemoryWarningTime < kContainerStackCapacityRecoveryDelay) {
+        return;
+    }
+    
+    // All view controllers already fit: Revert to the nominal capacity directly
+    if (m_adaptiveCapacity >= [self.containerContents count]) {
+        m_adaptiveCapacity = m_capacity;
+        return;
+    }
+    
+    ++m_adaptiveCapacity;
+    HLSLoggerDebug(@"Adaptive capacity increased to %d", m_adaptiveCapacity);
+    
+    // Restore the view which has entered the capacity range (if any), so that the view hierarchy is the same as if the
+    // capacity had never been decreased
+    HLSContainerContent *containerContent = [self containerContentAtDepth:m_adaptiveCapacity - 1];
+    if (containerContent) {
+        [self addViewForContainerContent:containerContent inserting:NO animated:NO];
+    }
+}
+
+- (void)recycleViewController:(UIViewController *)viewController
+{
+    if (! [viewController conformsToProtocol:@protocol(HLSReusableViewController)]) {
+        return;
+    }
+    
+    // Only worth it if the view does not need to be loaded again. Moreover, a view controller still belonging to a 
+    // container (e.g. if its content is kept alive a little bit longer) cannot be pushed again yet
+    if (! [viewController isViewLoaded] || [HLSContainerContent containerViewControllerKindOfClass:nil forViewController:viewController]) {
+        return;
+    }
+    
+    // View controllers removed while batched updates are pending can be inserted again when they are applied
+    if ([[self.updateEntries valueForKey:kUpdateEntryViewControllerKey] containsObject:viewController]
+            || [[self.deferredUpdateEntries valueForKey:kUpdateEntryViewControllerKey] containsObject:viewController]
+            || [[self.queuedUpdateEntries valueForKey:kUpdateEntryViewControllerKey] containsObject:viewController]) {
+        return;
+    }
+    
+    NSString *className = NSStringFromClass([viewController class]);
+    NSMutableArray *reusableViewControllers = [s_classNameToReusableViewControllersMap objectForKey:className];
+    if (! reusableViewControllers) {
+        reusableViewControllers = [NSMutableArray arrayWithCapacity:kContainerStackReusePoolCapacityPerClass];
+        [s_classNameToReusableViewControllersMap setObject:reusableViewControllers forKey:className];
+    }
+    
+    if ([reusableViewControllers count] >= kContainerStackReusePoolCapacityPerClass
+            || [reusableViewControllers indexOfObjectIdenticalTo:viewController] != NSNotFound) {
+        return;
+    }
+    
+    [reusableViewControllers addObject:viewController];
+}
+
 /**
  * Call this method when a child view controller's view must be rotated to make it compatible with the container interface
  * orientation. Landscape-only view controllers, e.g., must be rotated from PI/2 when inserted in a container in portrait
@@ -1009,6 +1654,15 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
 {
     m_animating = YES;
     
+    // Views covered when idle might be revealed by the animation
+    [[self containerStackView] showCoveredContentViews];
+    
+    // The animation lock is released before its end callback is called. Hold the UI locked until the transition
+    // has been completely performed (lifecycle events, batched updates, delegate notifications)
+    if (animation.lockingUI && ! self.transitionLockToken) {
+        self.transitionLockToken = [[HLSUserInterfaceLock sharedUserInterfaceLock] lockTokenWithReason:@"Container stack transition"];
+    }
+    
     // Extra work needed for push and pop animations
     if ([animation.tag isEqualToString:@"push_animation"] || [animation.tag isEqualToString:@"pop_animation"]) {
         HLSContainerContent *appearingContainerContent = nil;
@@ -1023,6 +1677,9 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
             disappearingContainerContent = [self topContainerContent];
         }
         
+        // A revealed child must have the correct orientation before it appears
+        [appearingContainerContent forwardDeferredRotationToInterfaceOrientation:self.containerViewController.interfaceOrientation];
+        
         // Forward events (willHide is sent to the delegate before willDisappear is sent to the view controller)
         if (disappearingContainerContent && [self.delegate respondsToSelector:@selector(containerStack:willHideViewController:animated:)]) {
             [self.delegate containerStack:self willHideViewController:disappearingContainerContent.viewController animated:animated];
@@ -1073,7 +1730,7 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
         
         if ([animation.tag isEqualToString:@"push_animation"]) {
             // Now that the animation is over, get rid of the view or view controller which does not match the capacity criterium
-            HLSContainerContent *containerContentAtCapacity = [self containerContentAtDepth:self.capacity];
+            HLSContainerContent *containerContentAtCapacity = [self containerContentAtDepth:self.adaptiveCapacity];
             if (! m_removing) {
                 // The view is only removed from the view hierarchy, so that blending can be made faster. The view is NOT unloaded
                 // (on iOS 4 and 5, it will only be unloaded if a memory warning is later received)
@@ -1083,6 +1740,9 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
                 [self.containerContents removeObject:containerContentAtCapacity];
             }
             
+            // Complete batched updates (if any)
+            [self applyDeferredUpdates];
+            
             // iOS 5 and above only: -didMoveToParentViewController: must be called manually after the push transition has
             // been performed (iOS 5 and above, see UIViewController documentation)
             // This method is always available, even on iOS 4 through method injection (see HLSContainerContent.m)
@@ -1107,10 +1767,80 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
                          revealViewController:appearingContainerContent.viewController
                                      animated:animated];
             }
+            
+            [self recycleViewController:disappearingViewController];
+            
+            // Complete batched updates (if any)
+            [self applyDeferredUpdates];
         }
     
         [disappearingViewController release];
     }
+    // Interactive pop transition cancelled. The top view controller remains
+    else if ([animation.tag isEqualToString:@"cancel_pop_animation"]) {
+        HLSContainerContent *topContainerContent = [self topContainerContent];
+        HLSContainerContent *secondTopContainerContent = [self secondTopContainerContent];
+        
+        // The view controller which was about to be revealed disappears again
+        [secondTopContainerContent viewWillDisappear:animated movingFromParentViewController:NO];
+        [secondTopContainerContent viewDidDisappear:animated movingFromParentViewController:NO];
+        
+        // The view lifecycle does not allow going from -viewWillDisappear: to -viewWillAppear: directly
+        [topContainerContent viewDidDisappear:animated movingFromParentViewController:NO];
+        [topContainerContent viewWillAppear:animated movingToParentViewController:NO];
+        [topContainerContent viewDidAppear:animated movingToParentViewController:NO];
+        
+        // Remove the view which was added for the pop so that the capacity criterium is fulfilled again
+        if (! m_removing) {
+            HLSContainerContent *containerContentAtCapacity = [self containerContentAtDepth:self.adaptiveCapacity];
+            [containerContentAtCapacity removeViewFromContainerStackView];
+        }
+    }
+    
+    if ([animation.tag isEqualToString:@"push_animation"] || [animation.tag isEqualToString:@"pop_animation"]
+            || [animation.tag isEqualToString:@"cancel_pop_animation"]) {
+        if (m_releasingViewsOverAdaptiveCapacity) {
+            [self releaseViewsOverAdaptiveCapacity];
+        }
+        else {
+            [self increaseAdaptiveCapacityIfPossible];
+        }
+    }
+    
+    [self.transitionLockToken relinquish];
+    self.transitionLockToken = nil;
+    
+    // Remove views hidden by opaque views above from the render tree, unless another transition has been started
+    // in the meantime
+    if (! m_animating) {
+        [[self containerStackView] hideCoveredContentViews];
+        [self forwardDeferredRotationsToVisibleContainerContents];
+        
+        // Apply batched updates which ended while the transition was running
+        [self applyQueuedUpdates];
+    }
+}
+
+#pragma mark Notification callbacks
+
++ (void)reusePoolDidReceiveMemoryWarning:(NSNotification *)notification
+{
+    [self purgeReusableViewControllers];
+}
+
+- (void)applicationDidReceiveMemoryWarning:(NSNotification *)notification
+{
+    m_lastMemoryWarningTime = CFAbsoluteTimeGetCurrent();
+    
+    if (m_removing) {
+        return;
+    }
+    
+    // Halve the number of views which can be loaded (the top one is always kept)
+    m_adaptiveCapacity = MAX(MIN(m_adaptiveCapacity, [self.containerContents count]) / 2, HLSContainerStackMinimalCapacity);
+    HLSLoggerDebug(@"Memory warning received; adaptive capacity decreased to %d", m_adaptiveCapacity);
+    
+    [self releaseViewsOverAdaptiveCapacity];
 }
 
 #pragma mark HLSContainerStackViewDelegate protocol implementation
@@ -1125,7 +1855,7 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
     // Children are pushed with layer animations (i.e. transform animations). Those do not play well wit frame changes.
     // To solve those issues, we reset the children views to their initial state before the frame is changed (the
     // previous state is then restored after the frame has changed, see below)
-    for (NSUInteger i = 0; i < MIN(self.capacity, [self.containerContents count]); ++i) {
+    for (NSUInteger i = 0; i < MIN(self.adaptiveCapacity, [self.containerContents count]); ++i) {
         NSUInteger index = [self.containerContents count] - 1 - i;
         HLSContainerContent *containerContent = [self.containerContents objectAtIndex:index];
         
@@ -1152,7 +1882,7 @@ const NSUInteger HLSContainerStackUnlimitedCapacity = NSUIntegerMax;
     }
     
     // See comment in -containerStackViewWillChangeFrame:
-    for (NSUInteger i = 0; i < MIN(self.capacity, [self.containerContents count]); ++i) {
+    for (NSUInteger i = 0; i < MIN(self.adaptiveCapacity, [self.containerContents count]); ++i) {
         NSUInteger index = [self.containerContents count] - 1 - i;
         HLSContainerContent *containerContent = [self.containerContents objectAtIndex:index];
         
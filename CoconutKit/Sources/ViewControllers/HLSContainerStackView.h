@@ -127,6 +127,16 @@
  */
 - (HLSContainerGroupView *)groupViewForContentView:(UIView *)contentView;
 
+/**
+ * Content views which are completely covered by opaque views above them need not be composited. Call 
+ * -hideCoveredContentViews when no transition is running to hide them (they stay loaded and in the view 
+ * hierarchy, but are removed from the render tree), and -showCoveredContentViews before a transition 
+ * is played so that all views are visible again. Covered views are also shown again automatically when 
+ * a content view is inserted or removed
+ */
+- (void)hideCoveredContentViews;
+- (void)showCoveredContentViews;
+
 @property (nonatomic, assign) id<HLSContainerStackViewDelegate> delegate;
 
 @end
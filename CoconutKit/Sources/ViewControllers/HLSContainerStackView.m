@@ -84,6 +84,8 @@
         return;
     }
     
+    [self showCoveredContentViews];
+    
     // Add to the top
     if (index == [self.groupViews count]) {
         HLSContainerGroupView *topGroupView = [self.groupViews lastObject];
@@ -115,6 +117,8 @@
         return;
     }
     
+    [self showCoveredContentViews];
+    
     HLSContainerGroupView *groupView = [self.groupViews objectAtIndex:index];
     HLSContainerGroupView *belowGroupView = (index > 0) ? [self.groupViews objectAtIndex:index - 1] : nil;
     
@@ -146,4 +150,22 @@
     return nil;
 }
 
+- (void)hideCoveredContentViews
+{
+    // The back view of a group view contains all group views below. Stop at the topmost covering content view
+    for (HLSContainerGroupView *groupView in [self.groupViews reverseObjectEnumerator]) {
+        if ([groupView isFrontContentViewCoveringBackView]) {
+            groupView.backView.hidden = YES;
+            break;
+        }
+    }
+}
+
+- (void)showCoveredContentViews
+{
+    for (HLSContainerGroupView *groupView in self.groupViews) {
+        groupView.backView.hidden = NO;
+    }
+}
+
 @end
@@ -102,6 +102,9 @@
     HLSAutorotationMode m_autorotationMode;
     id<HLSPlaceholderViewControllerDelegate> m_delegate;
     BOOL m_loadedOnce;
+    BOOL m_loadingInsetViewsLazily;
+    NSTimeInterval m_insetViewUnloadDelay;
+    NSMutableIndexSet *m_displayedInsetIndexes;             // Indices of the insets which received appearance events
 }
 
 /**
@@ -175,6 +178,47 @@
  */
 @property (nonatomic, assign) HLSAutorotationMode autorotationMode;
 
+/**
+ * If set to YES, inset views are only loaded and displayed when their placeholder view is visible, i.e. when neither it nor
+ * one of its ancestors is hidden or fully transparent, and when it intersects the placeholder view controller's view bounds.
+ * This is useful if you have many placeholder views, only some of them being visible at any time (e.g. if you implement
+ * tab-like interfaces). The insets which are not visible receive the disappearance events, and their views are unloaded 
+ * after insetViewUnloadDelay (the view controllers are kept)
+ *
+ * Since visibility changes cannot be detected automatically, you must call -updateInsetViewsVisibility after having shown
+ * or hidden placeholder views. Inset view controllers which are set on a hidden placeholder view while the placeholder
+ * view controller is displayed are still loaded immediately
+ *
+ * The default value is NO
+ */
+@property (nonatomic, assign, getter=isLoadingInsetViewsLazily) BOOL loadingInsetViewsLazily;
+
+/**
+ * The time after which the view of an inset whose placeholder is hidden gets unloaded when insets are loaded lazily. Set
+ * a negative value to never unload inset views
+ *
+ * The default value is 10 seconds
+ */
+@property (nonatomic, assign) NSTimeInterval insetViewUnloadDelay;
+
+/**
+ * When insets are loaded lazily, call this method after having shown or hidden placeholder views so that the insets are
+ * loaded and displayed, or hidden, accordingly. Does nothing if the placeholder view controller is not displayed
+ */
+- (void)updateInsetViewsVisibility;
+
+/**
+ * Load and lay out the views of the inset view controllers which are set but not displayed (most notably those on hidden
+ * placeholder views when insets are loaded lazily), so that displaying them later does not require their views to be 
+ * created first. This is especially useful for tab-like interfaces, so that switching tabs is fast. Views are not loaded 
+ * immediately, but when the run loop is idle (i.e. not while the user is interacting with a scroll view), one inset 
+ * per run loop iteration, so that no single frame is delayed by the whole work. Pending unloads of prewarmed inset views 
+ * are cancelled. Prewarming is stopped when the placeholder view controller disappears
+ *
+ * Does nothing if the placeholder view controller's view is not loaded
+ */
+- (void)prewarmInsetViews;
+
 /**
  * The placeholder view controller delegate
  */
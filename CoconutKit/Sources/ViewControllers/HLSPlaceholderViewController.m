@@ -9,6 +9,7 @@
 #import "HLSPlaceholderViewController.h"
 
 #import "HLSContainerContent.h"
+#import "HLSFloat.h"
 #import "HLSLogger.h"
 #import "HLSPlaceholderInsetSegue.h"
 #import "NSArray+HLSExtensions.h"
@@ -19,6 +20,15 @@
 - (void)hlsPlaceholderViewControllerInit;
 
 @property (nonatomic, retain) NSMutableArray *containerStacks;
+@property (nonatomic, retain) NSMutableIndexSet *displayedInsetIndexes;
+
+- (BOOL)isPlaceholderViewVisibleAtIndex:(NSUInteger)index;
+- (BOOL)shouldDisplayInsetAtIndex:(NSUInteger)index;
+- (void)cancelInsetViewUnloadAtIndex:(NSUInteger)index;
+- (void)unloadInsetViewAtIndexNumber:(NSNumber *)indexNumber;
+- (NSUInteger)nextPrewarmedInsetIndex;
+- (void)scheduleInsetViewPrewarming;
+- (void)prewarmNextInsetView;
 
 @end
 
@@ -45,6 +55,8 @@
 - (void)hlsPlaceholderViewControllerInit
 {
     self.autorotationMode = HLSAutorotationModeContainer;
+    self.insetViewUnloadDelay = 10.;
+    self.displayedInsetIndexes = [NSMutableIndexSet indexSet];
 }
 
 - (void)awakeFromNib
@@ -69,6 +81,7 @@
 {
     self.containerStacks = nil;
     self.delegate = nil;
+    self.displayedInsetIndexes = nil;
     
     [super dealloc];
 }
@@ -103,6 +116,12 @@
 
 @synthesize delegate = m_delegate;
 
+@synthesize loadingInsetViewsLazily = m_loadingInsetViewsLazily;
+
+@synthesize insetViewUnloadDelay = m_insetViewUnloadDelay;
+
+@synthesize displayedInsetIndexes = m_displayedInsetIndexes;
+
 - (UIView *)placeholderViewAtIndex:(NSUInteger)index
 {
     if (index >= [self.placeholderViews count]) {
@@ -206,17 +225,35 @@
 {
     [super viewWillAppear:animated];
     
-    for (HLSContainerStack *containerStack in self.containerStacks) {
+    [self.displayedInsetIndexes removeAllIndexes];
+    for (NSUInteger i = 0; i < [self.containerStacks count]; ++i) {
+        if (! [self shouldDisplayInsetAtIndex:i]) {
+            continue;
+        }
+        
+        HLSContainerStack *containerStack = [self.containerStacks objectAtIndex:i];
+        
+        // The container view might have been released when the inset view was unloaded
+        if (! containerStack.containerView) {
+            containerStack.containerView = [self.placeholderViews objectAtIndex:i];
+        }
+        
+        [self cancelInsetViewUnloadAtIndex:i];
         [containerStack viewWillAppear:animated];
-    }    
+        [self.displayedInsetIndexes addIndex:i];
+    }
 }
 
 - (void)viewDidAppear:(BOOL)animated
 {
     [super viewDidAppear:animated];
     
+    NSUInteger i = 0;
     for (HLSContainerStack *containerStack in self.containerStacks) {
-        [containerStack viewDidAppear:animated];
+        if ([self.displayedInsetIndexes containsIndex:i]) {
+            [containerStack viewDidAppear:animated];
+        }
+        ++i;
     }
 }
 
@@ -224,8 +261,12 @@
 {
     [super viewWillDisappear:animated];
     
+    NSUInteger i = 0;
     for (HLSContainerStack *containerStack in self.containerStacks) {
-        [containerStack viewWillDisappear:animated];
+        if ([self.displayedInsetIndexes containsIndex:i]) {
+            [containerStack viewWillDisappear:animated];
+        }
+        ++i;
     }
 }
 
@@ -233,9 +274,20 @@
 {
     [super viewDidDisappear:animated];
     
+    NSUInteger i = 0;
     for (HLSContainerStack *containerStack in self.containerStacks) {
-        [containerStack viewDidDisappear:animated];
+        if ([self.displayedInsetIndexes containsIndex:i]) {
+            [containerStack viewDidDisappear:animated];
+        }
+        
+        // Pending unloads would otherwise keep the placeholder view controller alive
+        [self cancelInsetViewUnloadAtIndex:i];
+        ++i;
     }
+    [self.displayedInsetIndexes removeAllIndexes];
+    
+    // Same for prewarming
+    [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(prewarmNextInsetView) object:nil];
 }
 
 #pragma mark Orientation management (these methods are only called if the view controller is visible)
@@ -291,6 +343,150 @@
     }
 }
 
+#pragma mark Lazy inset view loading
+
+- (BOOL)isPlaceholderViewVisibleAtIndex:(NSUInteger)index
+{
+    UIView *placeholderView = [self placeholderViewAtIndex:index];
+    if (! placeholderView || ! [self isViewLoaded]) {
+        return NO;
+    }
+    
+    for (UIView *view = placeholderView; view != self.view; view = view.superview) {
+        if (! view || view.hidden || floateq(view.alpha, 0.f)) {
+            return NO;
+        }
+    }
+    
+    CGRect placeholderViewFrame = [placeholderView convertRect:placeholderView.bounds toView:self.view];
+    return CGRectIntersectsRect(placeholderViewFrame, self.view.bounds);
+}
+
+- (BOOL)shouldDisplayInsetAtIndex:(NSUInteger)index
+{
+    return ! self.loadingInsetViewsLazily || [self isPlaceholderViewVisibleAtIndex:index];
+}
+
+- (void)updateInsetViewsVisibility
+{
+    if (! [self isViewDisplayed]) {
+        return;
+    }
+    
+    for (NSUInteger i = 0; i < [self.containerStacks count]; ++i) {
+        HLSContainerStack *containerStack = [self.containerStacks objectAtIndex:i];
+        BOOL displayed = [self.displayedInsetIndexes containsIndex:i];
+        BOOL shouldBeDisplayed = [self shouldDisplayInsetAtIndex:i];
+        
+        // Placeholder view revealed
+        if (! displayed && shouldBeDisplayed) {
+            if (! containerStack.containerView) {
+                containerStack.containerView = [self.placeholderViews objectAtIndex:i];
+            }
+            
+            [self cancelInsetViewUnloadAtIndex:i];
+            [containerStack viewWillAppear:NO];
+            [containerStack viewDidAppear:NO];
+            [self.displayedInsetIndexes addIndex:i];
+        }
+        // Placeholder view hidden
+        else if (displayed && ! shouldBeDisplayed) {
+            [containerStack viewWillDisappear:NO];
+            [containerStack viewDidDisappear:NO];
+            [self.displayedInsetIndexes removeIndex:i];
+            
+            if (doublege(self.insetViewUnloadDelay, 0.)) {
+                [self performSelector:@selector(unloadInsetViewAtIndexNumber:)
+                           withObject:[NSNumber numberWithUnsignedInteger:i]
+                           afterDelay:self.insetViewUnloadDelay];
+            }
+        }
+    }
+}
+
+- (void)cancelInsetViewUnloadAtIndex:(NSUInteger)index
+{
+    [NSObject cancelPreviousPerformRequestsWithTarget:self
+                                             selector:@selector(unloadInsetViewAtIndexNumber:)
+                                               object:[NSNumber numberWithUnsignedInteger:index]];
+}
+
+- (void)unloadInsetViewAtIndexNumber:(NSNumber *)indexNumber
+{
+    NSUInteger index = [indexNumber unsignedIntegerValue];
+    if (index >= [self.containerStacks count] || [self.displayedInsetIndexes containsIndex:index]) {
+        return;
+    }
+    
+    // Only the views are released. The inset view controller is kept
+    HLSContainerStack *containerStack = [self.containerStacks objectAtIndex:index];
+    [containerStack releaseViews];
+}
+
+#pragma mark Inset view prewarming
+
+- (void)prewarmInsetViews
+{
+    if (! [self isViewLoaded]) {
+        HLSLoggerInfo(@"The view is not loaded. Nothing to prewarm");
+        return;
+    }
+    
+    [self scheduleInsetViewPrewarming];
+}
+
+- (NSUInteger)nextPrewarmedInsetIndex
+{
+    for (NSUInteger i = 0; i < [self.containerStacks count]; ++i) {
+        if ([self.displayedInsetIndexes containsIndex:i]) {
+            continue;
+        }
+        
+        UIViewController *insetViewController = [self insetViewControllerAtIndex:i];
+        if (insetViewController && ! [insetViewController isViewLoaded]) {
+            return i;
+        }
+    }
+    return NSNotFound;
+}
+
+- (void)scheduleInsetViewPrewarming
+{
+    if ([self nextPrewarmedInsetIndex] == NSNotFound) {
+        return;
+    }
+    
+    // Load views when the run loop is idle, and not while the user is interacting with a scroll view (tracking mode)
+    [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(prewarmNextInsetView) object:nil];
+    [self performSelector:@selector(prewarmNextInsetView)
+               withObject:nil
+               afterDelay:0.
+                  inModes:[NSArray arrayWithObject:NSDefaultRunLoopMode]];
+}
+
+- (void)prewarmNextInsetView
+{
+    if (! [self isViewLoaded]) {
+        return;
+    }
+    
+    NSUInteger index = [self nextPrewarmedInsetIndex];
+    if (index == NSNotFound) {
+        return;
+    }
+    
+    [self cancelInsetViewUnloadAtIndex:index];
+    
+    // Lay out the view with the dimensions it will have when displayed, so that no layout pass is required then
+    UIViewController *insetViewController = [self insetViewControllerAtIndex:index];
+    UIView *insetView = insetViewController.view;
+    insetView.frame = [self placeholderViewAtIndex:index].bounds;
+    [insetView layoutIfNeeded];
+    
+    // Prewarm one inset per run loop iteration only
+    [self scheduleInsetViewPrewarming];
+}
+
 #pragma mark Setting the inset view controller
 
 - (void)setInsetViewController:(UIViewController *)insetViewController 
@@ -10,6 +10,7 @@
 #import "HLSViewController.h"
 
 // Forward declarations
+@class HLSTask;
 @protocol HLSStackControllerDelegate;
 
 /**
@@ -42,6 +43,10 @@
  * to minimize blending calculations. Usually, the default value should fulfill most needs, but if you require more transparency 
  * levels you can increase this value. Standard capacity values are provided at the beginning of the HLSContainerStack.h file.
  *
+ * If the same kinds of view controllers are pushed over and over (e.g. when browsing from detail to detail), have them
+ * adopt the HLSReusableViewController protocol and get them using +[HLSContainerStack dequeueReusableViewControllerOfClass:] 
+ * before allocating new ones. Popped view controllers are then recycled with their views loaded (see HLSContainerStack.h)
+ *
  * You can also use stack controllers with storyboards (a feature available since iOS 5):
  *   - drop a view controller onto the storyboard, and set its class to HLSStackController. You can customize the
  *     view controller capacity by setting an NSNumber user-defined runtime attribute called 'capacity'
@@ -90,6 +95,30 @@
  */
 - (id)initWithRootViewController:(UIViewController *)rootViewController;
 
+/**
+ * Create a new stack controller restoring a whole stack of view controllers at once (e.g. when restoring the state of
+ * an application at launch). The first view controller is the root one, the others are pushed in order using the
+ * specified transition class (which defines the animation played when they are later popped). Since the stack is
+ * installed before the stack controller is displayed, no transition animation is played and the view controllers 
+ * below the top one do not receive appearance events. Their views are laid out in a single pass when the stack controller
+ * is displayed
+ *
+ * The viewControllers array must not be empty. If transitionClass is nil, HLSTransitionNone is used. The expensive
+ * work needed by the view controllers can be performed beforehand on a background thread (see +restorationTaskForViewControllers:)
+ */
+- (id)initWithViewControllers:(NSArray *)viewControllers transitionClass:(Class)transitionClass capacity:(NSUInteger)capacity;
+
+/**
+ * Return a task which, when submitted to an HLSTaskManager, prepares the view controllers of a stack to be restored
+ * on a background thread: View controllers conforming to the HLSRestorableViewController protocol receive
+ * -prepareForRestoration, and the nib files they will load are read ahead. Once the task has been processed, create
+ * the stack controller using -initWithViewControllers:transitionClass:capacity: on the main thread (e.g. from the
+ * -taskHasBeenProcessed: task delegate method). The view controllers are retained until the task is deallocated
+ *
+ * This method must be called on the main thread
+ */
++ (HLSTask *)restorationTaskForViewControllers:(NSArray *)viewControllers;
+
 /**
  * Set how the stack controller decides whether it must rotate or not
  *
@@ -155,6 +184,18 @@
                   duration:(NSTimeInterval)duration
                   animated:(BOOL)animated;
 
+/**
+ * Register the view controller which is likely to be pushed next, so that its view gets loaded and laid out before the
+ * push actually occurs. Refer to -[HLSContainerStack preloadViewController:] for more information
+ */
+- (void)preloadViewController:(UIViewController *)viewController;
+
+/**
+ * Action method to be bound to a pan gesture recognizer (using -addTarget:action:) so that the top view controller can be
+ * popped interactively. Refer to -[HLSContainerStack handleInteractivePopPanGesture:] for more information
+ */
+- (void)handleInteractivePopPanGesture:(UIPanGestureRecognizer *)panGestureRecognizer;
+
 /**
  * Remove the top view controller from the stack, using the reverse animation corresponding to the transition which was 
  * used to push it
@@ -320,6 +361,20 @@
 
 @end
 
+/**
+ * View controllers which need to decode their state or to prepare model data before being restored into a stack controller
+ * can implement this protocol (see +[HLSStackController restorationTaskForViewControllers:])
+ */
+@protocol HLSRestorableViewController <NSObject>
+
+/**
+ * Called on a background thread before the view controller is restored into a stack. Your implementation must be
+ * thread-safe and must only prepare data (UIKit objects, in particular the view controller view, must not be accessed)
+ */
+- (void)prepareForRestoration;
+
+@end
+
 @interface UIViewController (HLSStackController)
 
 /**
@@ -10,17 +10,24 @@
 
 #import "HLSAssert.h"
 #import "HLSContainerContent.h"
+#import "HLSInvocationTask.h"
 #import "HLSLogger.h"
 #import "HLSStackPushSegue.h"
 #import "NSArray+HLSExtensions.h"
 #import "UIView+HLSExtensions.h"
 #import "UIViewController+HLSExtensions.h"
 
+// Keys of the dictionary supplied to the restoration task
+static NSString * const kRestorationInfoViewControllersKey = @"viewControllers";
+static NSString * const kRestorationInfoNibPathsKey = @"nibPaths";
+
 @interface HLSStackController ()
 
 @property (nonatomic, retain) HLSContainerStack *containerStack;
 @property (nonatomic, assign) NSUInteger capacity;
 
++ (void)prepareForRestorationWithInfo:(NSDictionary *)restorationInfo;
+
 @end
 
 @implementation HLSStackController
@@ -51,6 +58,26 @@
     return [self initWithRootViewController:rootViewController capacity:HLSContainerStackDefaultCapacity];
 }
 
+- (id)initWithViewControllers:(NSArray *)viewControllers transitionClass:(Class)transitionClass capacity:(NSUInteger)capacity
+{
+    if ([viewControllers count] == 0) {
+        HLSLoggerError(@"At least a root view controller is required");
+        [self release];
+        return nil;
+    }
+    
+    if ((self = [self initWithRootViewController:[viewControllers objectAtIndex:0] capacity:capacity])) {
+        // The stack controller is not displayed yet: Pushing does not play any animation nor trigger any appearance event
+        for (UIViewController *viewController in [viewControllers subarrayWithRange:NSMakeRange(1, [viewControllers count] - 1)]) {
+            [self.containerStack pushViewController:viewController
+                                withTransitionClass:transitionClass ? transitionClass : [HLSTransitionNone class]
+                                           duration:kAnimationTransitionDefaultDuration
+                                           animated:NO];
+        }
+    }
+    return self;
+}
+
 - (id)initWithCoder:(NSCoder *)aDecoder
 {
     if ((self = [super initWithCoder:aDecoder])) {
@@ -289,6 +316,16 @@
                                    animated:animated];
 }
 
+- (void)preloadViewController:(UIViewController *)viewController
+{
+    [self.containerStack preloadViewController:viewController];
+}
+
+- (void)handleInteractivePopPanGesture:(UIPanGestureRecognizer *)panGestureRecognizer
+{
+    [self.containerStack handleInteractivePopPanGesture:panGestureRecognizer];
+}
+
 - (void)popViewControllerAnimated:(BOOL)animated
 {    
     [self.containerStack popViewControllerAnimated:animated];
@@ -356,6 +393,49 @@
     [self.containerStack removeViewController:viewController animated:animated];
 }
 
+#pragma mark Restoration
+
++ (HLSTask *)restorationTaskForViewControllers:(NSArray *)viewControllers
+{
+    // Nib paths are retrieved on the main thread, only the files are read on the background thread
+    NSMutableArray *nibPaths = [NSMutableArray array];
+    for (UIViewController *viewController in viewControllers) {
+        if (! viewController.nibName) {
+            continue;
+        }
+        
+        NSBundle *nibBundle = viewController.nibBundle ? viewController.nibBundle : [NSBundle mainBundle];
+        NSString *nibPath = [nibBundle pathForResource:viewController.nibName ofType:@"nib"];
+        if (nibPath) {
+            [nibPaths addObject:nibPath];
+        }
+    }
+    
+    NSDictionary *restorationInfo = [NSDictionary dictionaryWithObjectsAndKeys:
+                                     [NSArray arrayWithArray:viewControllers], kRestorationInfoViewControllersKey,
+                                     [NSArray arrayWithArray:nibPaths], kRestorationInfoNibPathsKey,
+                                     nil];
+    HLSInvocationTask *restorationTask = [[[HLSInvocationTask alloc] initWithTarget:self
+                                                                           selector:@selector(prepareForRestorationWithInfo:)
+                                                                             object:restorationInfo] autorelease];
+    return restorationTask;
+}
+
+// Called on a background thread
++ (void)prepareForRestorationWithInfo:(NSDictionary *)restorationInfo
+{
+    for (id viewController in [restorationInfo objectForKey:kRestorationInfoViewControllersKey]) {
+        if ([viewController conformsToProtocol:@protocol(HLSRestorableViewController)]) {
+            [viewController prepareForRestoration];
+        }
+    }
+    
+    // Read nib files ahead so that their data is cached by the system when the views are loaded on the main thread
+    for (NSString *nibPath in [restorationInfo objectForKey:kRestorationInfoNibPathsKey]) {
+        [NSData dataWithContentsOfFile:nibPath];
+    }
+}
+
 #pragma mark HLSContainerStackDelegate protocol implementation
 
 - (void)containerStack:(HLSContainerStack *)containerStack
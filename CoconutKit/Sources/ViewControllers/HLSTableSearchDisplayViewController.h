@@ -6,8 +6,14 @@
 //  Copyright 2010 Hortis. All rights reserved.
 //
 
+#import "HLSTaskManager.h"
 #import "HLSViewController.h"
 
+// Forward declarations
+@class HLSCancellationToken;
+@class HLSInvocationTask;
+@class HLSSearchIndex;
+
 /**
  * This class conveniently implements the UISearchDisplayController behavior for a table view (the most common case). It 
  * manages two table views:
@@ -32,6 +38,13 @@
  * UISearchDisplayDelegate methods to return YES when the table view needs reloading. These methods are called each 
  * time the search string or the search scope are changed.
  *
+ * When filtering is expensive, you can also let HLSTableSearchDisplayViewController perform the search asynchronously
+ * (see the searchingAsynchronously property). In this case, you do not return YES from the UISearchDisplayDelegate
+ * methods above (simply call and return their super implementation), but override
+ * -searchResultsForSearchText:scopeButtonIndex:cancellationToken: to return the matching entries. For large data sets,
+ * you can instead fill an HLSSearchIndex with your entries and assign it to the searchIndex property, so that 
+ * searches do not have to scan all entries.
+ *
  * HLSTableSearchDisplayViewController saves the current search criteria and restore them if the view has been
  * unloaded. You do not have to code this mechanism yourself.
  *
@@ -49,11 +62,18 @@
 @interface HLSTableSearchDisplayViewController : HLSViewController <
     UISearchDisplayDelegate,
     UITableViewDataSource,
-    UITableViewDelegate
+    UITableViewDelegate,
+    HLSTaskDelegate
 > {
 @private
     UISearchBar *m_searchBar;
     UITableView *m_tableView;
+    BOOL m_searchingAsynchronously;
+    NSTimeInterval m_searchDebounceInterval;
+    NSArray *m_searchResults;
+    HLSSearchIndex *m_searchIndex;
+    HLSInvocationTask *m_searchTask;
+    HLSCancellationToken *m_searchCancellationToken;
     NSString *m_searchText;
     NSInteger m_selectedScopeButtonIndex;
     BOOL m_searchInterfaceActive;
@@ -81,4 +101,46 @@
  */
 @property (nonatomic, readonly, assign) UITableView *searchResultsTableView;
 
+/**
+ * If set to YES, the search is performed asynchronously: Each time the search string or scope changes, and once
+ * no further change has been made during searchDebounceInterval, -searchResultsForSearchText:scopeButtonIndex:cancellationToken:
+ * is called on a background thread. Any search still running is cancelled when a new one starts, and the 
+ * searchResultsTableView is reloaded on the main thread once the results of the most recent search are available.
+ * Since search results are always replaced as a whole, the data source methods of searchResultsTableView should
+ * use the searchResults property
+ *
+ * Default value is NO
+ */
+@property (nonatomic, assign, getter=isSearchingAsynchronously) BOOL searchingAsynchronously;
+
+/**
+ * The time to wait after the last search criterium change before an asynchronous search starts. Must be >= 0
+ *
+ * Default value is 0.3
+ */
+@property (nonatomic, assign) NSTimeInterval searchDebounceInterval;
+
+/**
+ * The results of the most recent asynchronous search (nil if none has been completed yet)
+ */
+@property (nonatomic, readonly, retain) NSArray *searchResults;
+
+/**
+ * An optional index used to search entries asynchronously. Entries must belong to the scopes of the search bar scope
+ * buttons they are displayed for (see HLSSearchIndex). You can keep updating the index while it is being used
+ *
+ * Default value is nil
+ */
+@property (nonatomic, retain) HLSSearchIndex *searchIndex;
+
+/**
+ * Called on a background thread when searching asynchronously. Override this method to return the entries matching
+ * the search criteria. Your implementation must be thread-safe, and should regularly check whether the cancellation 
+ * token supplied has been cancelled, in which case it can return immediately (its results will be discarded anyway).
+ * The default implementation returns the entries found in the searchIndex (nil if none)
+ */
+- (NSArray *)searchResultsForSearchText:(NSString *)searchText 
+                       scopeButtonIndex:(NSInteger)scopeButtonIndex
+                      cancellationToken:(HLSCancellationToken *)cancellationToken;
+
 @end
@@ -9,27 +9,81 @@
 #import "HLSTableSearchDisplayViewController.h"
 
 #import "HLSAssert.h"
+#import "HLSCancellationToken.h"
+#import "HLSFloat.h"
+#import "HLSInvocationTask.h"
+#import "HLSLogger.h"
+#import "HLSSearchIndex.h"
 #import "NSBundle+HLSDynamicLocalization.h"
 
 // Height of the UIKit search bar
 static const CGFloat kSearchBarStandardHeight = 44.f;
 
+// Default time to wait for the search criteria to settle before an asynchronous search starts
+static const NSTimeInterval kSearchDefaultDebounceInterval = 0.3;
+
+// Keys of the dictionary supplied to the asynchronous search method
+static NSString * const kSearchInfoSearchTextKey = @"searchText";
+static NSString * const kSearchInfoScopeButtonIndexKey = @"scopeButtonIndex";
+static NSString * const kSearchInfoCancellationTokenKey = @"cancellationToken";
+static NSString * const kSearchInfoResultsKey = @"results";
+
 @interface HLSTableSearchDisplayViewController ()
 
 @property (nonatomic, retain) UISearchBar *searchBar;
 @property (nonatomic, retain) NSString *searchText;
 @property (nonatomic, retain) UISearchDisplayController *searchController;      // Not called searchDisplayController to avoid conflicts with 
                                                                                 // UIViewController's searchViewController property
+@property (nonatomic, retain) NSArray *searchResults;
+@property (nonatomic, retain) HLSInvocationTask *searchTask;
+@property (nonatomic, retain) HLSCancellationToken *searchCancellationToken;
+
+- (void)hlsTableSearchDisplayViewControllerInit;
+
+- (void)scheduleAsynchronousSearch;
+- (void)startAsynchronousSearch;
+- (void)cancelAsynchronousSearch;
+- (void)performSearchWithInfo:(NSMutableDictionary *)searchInfo;
+
 @end
 
 @implementation HLSTableSearchDisplayViewController
 
 #pragma mark Object creation and destruction
 
+- (id)initWithNibName:(NSString *)nibNameOrNil bundle:(NSBundle *)nibBundleOrNil
+{
+    if ((self = [super initWithNibName:nibNameOrNil bundle:nibBundleOrNil])) {
+        [self hlsTableSearchDisplayViewControllerInit];
+    }
+    return self;
+}
+
+- (id)initWithCoder:(NSCoder *)aDecoder
+{
+    if ((self = [super initWithCoder:aDecoder])) {
+        [self hlsTableSearchDisplayViewControllerInit];
+    }
+    return self;
+}
+
+// Common initialization code
+- (void)hlsTableSearchDisplayViewControllerInit
+{
+    m_searchDebounceInterval = kSearchDefaultDebounceInterval;
+}
+
 - (void)dealloc
 {
+    [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(startAsynchronousSearch) object:nil];
+    [[HLSTaskManager defaultManager] unregisterDelegateAndCancelAssociatedTasks:self];
+    
     self.searchText = nil;
     self.searchController = nil;
+    self.searchResults = nil;
+    self.searchIndex = nil;
+    self.searchTask = nil;
+    self.searchCancellationToken = nil;
     
     [super dealloc];
 }
@@ -57,6 +111,42 @@ static const CGFloat kSearchBarStandardHeight = 44.f;
 
 @synthesize searchController = m_searchController;
 
+@synthesize searchingAsynchronously = m_searchingAsynchronously;
+
+- (void)setSearchingAsynchronously:(BOOL)searchingAsynchronously
+{
+    if (m_searchingAsynchronously == searchingAsynchronously) {
+        return;
+    }
+    
+    m_searchingAsynchronously = searchingAsynchronously;
+    
+    if (! searchingAsynchronously) {
+        [self cancelAsynchronousSearch];
+        self.searchResults = nil;
+    }
+}
+
+@synthesize searchDebounceInterval = m_searchDebounceInterval;
+
+- (void)setSearchDebounceInterval:(NSTimeInterval)searchDebounceInterval
+{
+    if (doublelt(searchDebounceInterval, 0.)) {
+        HLSLoggerWarn(@"The search debounce interval must be >= 0. Fixed to 0");
+        searchDebounceInterval = 0.;
+    }
+    
+    m_searchDebounceInterval = searchDebounceInterval;
+}
+
+@synthesize searchResults = m_searchResults;
+
+@synthesize searchIndex = m_searchIndex;
+
+@synthesize searchTask = m_searchTask;
+
+@synthesize searchCancellationToken = m_searchCancellationToken;
+
 #pragma mark View lifecycle
 
 - (void)viewDidLoad
@@ -173,12 +263,25 @@ static const CGFloat kSearchBarStandardHeight = 44.f;
 - (BOOL)searchDisplayController:(UISearchDisplayController *)controller shouldReloadTableForSearchString:(NSString *)searchString
 {
     self.searchText = searchString;
+    
+    // When searching asynchronously, the table is reloaded when the results are available
+    if (self.searchingAsynchronously) {
+        [self scheduleAsynchronousSearch];
+        return NO;
+    }
+    
     return YES;
 }
 
 - (BOOL)searchDisplayController:(UISearchDisplayController *)controller shouldReloadTableForSearchScope:(NSInteger)searchOption
 {
     m_selectedScopeButtonIndex = searchOption;
+    
+    if (self.searchingAsynchronously) {
+        [self scheduleAsynchronousSearch];
+        return NO;
+    }
+    
     return YES;
 }
 
@@ -196,6 +299,107 @@ static const CGFloat kSearchBarStandardHeight = 44.f;
     return nil;
 }
 
+#pragma mark Asynchronous search
+
+- (NSArray *)searchResultsForSearchText:(NSString *)searchText
+                       scopeButtonIndex:(NSInteger)scopeButtonIndex
+                      cancellationToken:(HLSCancellationToken *)cancellationToken
+{
+    return [self.searchIndex objectsMatchingSearchText:searchText
+                                      scopeButtonIndex:scopeButtonIndex
+                                     cancellationToken:cancellationToken];
+}
+
+- (void)scheduleAsynchronousSearch
+{
+    // Wait until the search criteria have not changed for a while. Any search still running is now stale
+    [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(startAsynchronousSearch) object:nil];
+    [self cancelAsynchronousSearch];
+    
+    [self performSelector:@selector(startAsynchronousSearch) withObject:nil afterDelay:self.searchDebounceInterval];
+}
+
+- (void)startAsynchronousSearch
+{
+    [self cancelAsynchronousSearch];
+    
+    self.searchCancellationToken = [[[HLSCancellationToken alloc] init] autorelease];
+    
+    // The search criteria are copied so that the background search does not access the view controller state
+    NSMutableDictionary *searchInfo = [NSMutableDictionary dictionary];
+    if (self.searchText) {
+        [searchInfo setObject:[[self.searchText copy] autorelease] forKey:kSearchInfoSearchTextKey];
+    }
+    [searchInfo setObject:[NSNumber numberWithInteger:m_selectedScopeButtonIndex] forKey:kSearchInfoScopeButtonIndexKey];
+    [searchInfo setObject:self.searchCancellationToken forKey:kSearchInfoCancellationTokenKey];
+    
+    // The task retains the view controller until the search ends (no cycle remains since the task is released then)
+    self.searchTask = [[[HLSInvocationTask alloc] initWithTarget:self 
+                                                        selector:@selector(performSearchWithInfo:) 
+                                                          object:searchInfo] autorelease];
+    self.searchTask.executionClass = HLSTaskExecutionClassCPU;
+    [[HLSTaskManager defaultManager] registerDelegate:self forTask:self.searchTask];
+    [[HLSTaskManager defaultManager] submitTask:self.searchTask];
+}
+
+- (void)cancelAsynchronousSearch
+{
+    [self.searchCancellationToken cancel];
+    self.searchCancellationToken = nil;
+    
+    if (self.searchTask) {
+        // Unregister first so that stale tasks never notify the view controller
+        [[HLSTaskManager defaultManager] unregisterDelegateForTask:self.searchTask];
+        [[HLSTaskManager defaultManager] cancelTask:self.searchTask];
+        self.searchTask = nil;
+    }
+}
+
+// Called on a background thread
+- (void)performSearchWithInfo:(NSMutableDictionary *)searchInfo
+{
+    HLSCancellationToken *cancellationToken = [searchInfo objectForKey:kSearchInfoCancellationTokenKey];
+    if ([cancellationToken isCancelled]) {
+        return;
+    }
+    
+    NSString *searchText = [searchInfo objectForKey:kSearchInfoSearchTextKey];
+    NSInteger scopeButtonIndex = [[searchInfo objectForKey:kSearchInfoScopeButtonIndexKey] integerValue];
+    NSArray *results = [self searchResultsForSearchText:searchText 
+                                       scopeButtonIndex:scopeButtonIndex
+                                      cancellationToken:cancellationToken];
+    if (results) {
+        [searchInfo setObject:results forKey:kSearchInfoResultsKey];
+    }
+}
+
+#pragma mark HLSTaskDelegate protocol implementation
+
+- (void)taskHasBeenProcessed:(HLSTask *)task
+{
+    // Discard the results of stale searches
+    if (task != self.searchTask || [self.searchCancellationToken isCancelled]) {
+        return;
+    }
+    
+    // Swap the whole result set at once, and reload the table accordingly
+    NSDictionary *searchInfo = [(HLSInvocationTask *)task object];
+    self.searchResults = [searchInfo objectForKey:kSearchInfoResultsKey];
+    
+    self.searchTask = nil;
+    self.searchCancellationToken = nil;
+    
+    [self.searchResultsTableView reloadData];
+}
+
+- (void)taskHasBeenCancelled:(HLSTask *)task
+{
+    if (task == self.searchTask) {
+        self.searchTask = nil;
+        self.searchCancellationToken = nil;
+    }
+}
+
 #pragma mark Localization
 
 - (void)localize
@@ -13,6 +13,20 @@
 // of an animation as defined by its implementation
 extern const NSTimeInterval kAnimationTransitionDefaultDuration;
 
+/**
+ * Views which can be replaced by a snapshot while a transition animation is played (see +setSnapshotMode:)
+ */
+typedef enum {
+    HLSTransitionSnapshotModeEnumBegin = 0,
+    HLSTransitionSnapshotModeNone = HLSTransitionSnapshotModeEnumBegin,         // The live views are animated
+    HLSTransitionSnapshotModeDisappearingView,                                  // A snapshot of the disappearing view is animated
+    HLSTransitionSnapshotModeAllViews,                                          // Snapshots of both the appearing and disappearing views are animated
+    HLSTransitionSnapshotModeThreeDimensional,                                  // Same as HLSTransitionSnapshotModeAllViews for 3D transitions (see 
+                                                                                // +isThreeDimensional), same as HLSTransitionSnapshotModeNone otherwise
+    HLSTransitionSnapshotModeEnumEnd,
+    HLSTransitionSnapshotModeEnumSize = HLSTransitionSnapshotModeEnumEnd - HLSTransitionSnapshotModeEnumBegin
+} HLSTransitionSnapshotMode;
+
 /**
  * Base class for transition animations involving two views (currently for use by containers). To define your
  * own transition animation, subclass HLSTransition and implement the
@@ -48,6 +62,9 @@ extern const NSTimeInterval kAnimationTransitionDefaultDuration;
  *   - your transition animations will in general animate appearingView and disappearingView. You can also animate
  *     view as well if needed, most notably to alter its sublayer transform, e.g. when adding perspective to
  *     appearingView and disappearingView animations
+ *   - the animation steps you return are generated once for a given set of bounds and cached (for placeholder views which
+ *     are replaced with the real views when the animation is created). Your implementation must therefore only depend
+ *     on its parameters, and must only animate appearingView, disappearingView and view (not their subviews)
  *   - the duration of your animation steps is arbitrary. The sum of those durations defines the default duration
  *     of the resulting animation, which can be retrieved by calling the +defaultDuration method on a transition
  *     class. The duration of each animation step might be scaled depending on the total duration which is desired
@@ -100,11 +117,24 @@ extern const NSTimeInterval kAnimationTransitionDefaultDuration;
 @interface HLSTransition : NSObject
 
 /**
- * Return all class names corresponding to available transition animations (except HLSTransition itself). These include
- * custom transitions as well
+ * Return the class names of all registered transition animations (except HLSTransition itself), sorted alphabetically.
+ * Transitions provided by CoconutKit are always registered, custom transitions must be registered explicitly (see
+ * below)
  */
 + (NSArray *)availableTransitionNames;
 
+/**
+ * Register a custom transition class so that it is listed by +availableTransitionNames. Classes are not looked up
+ * at runtime (which would require walking through all classes of the application), you should therefore call this
+ * method from the +load method of your transition class:
+ *   + (void)load
+ *   {
+ *       [HLSTransition registerTransitionClass:self];
+ *   }
+ * Registration is not required to use a transition class, only to have it listed
+ */
++ (void)registerTransitionClass:(Class)transitionClass;
+
 /**
  * The method to be overridden by subclasses to return the transition animation steps which the animation is made of.
  * The returned array must only contain HLSAnimationStep objects
@@ -138,6 +168,33 @@ extern const NSTimeInterval kAnimationTransitionDefaultDuration;
  */
 + (NSTimeInterval)defaultDuration;
 
+/**
+ * Return YES iff the transition rotates views in 3D space (e.g. flip or rotation transitions). The base implementation
+ * returns NO. Custom transition classes can override this method so that HLSTransitionSnapshotModeThreeDimensional
+ * applies to them
+ */
++ (BOOL)isThreeDimensional;
+
+/**
+ * Animating deep view hierarchies, especially with transparent views, requires offscreen rendering passes which can
+ * make transitions drop frames. When a snapshot mode is set, the layers of the views involved are rasterized while the
+ * transition animation is played: Each view hierarchy is flattened once into a bitmap, which is then animated instead
+ * of the live view hierarchy. Views stay in place and return to their normal state when the animation ends. Note that
+ * if the content of a rasterized view changes during the transition, the bitmap has to be rendered again
+ *
+ * The snapshot mode applies to the transition class it is set on and to its subclasses, except those for which a
+ * mode has been explicitly set. Setting it on HLSTransition therefore sets the default mode for all transitions
+ *
+ * Snapshots are most effective for 3D transitions, which otherwise may require the container view to be rendered
+ * offscreen for each frame. With snapshots, both faces are rasterized once at the screen scale, and only their
+ * compositing transforms are animated. Use HLSTransitionSnapshotModeThreeDimensional to enable snapshots for these
+ * transitions only
+ *
+ * Default is HLSTransitionSnapshotModeNone
+ */
++ (void)setSnapshotMode:(HLSTransitionSnapshotMode)snapshotMode;
++ (HLSTransitionSnapshotMode)snapshotMode;
+
 /**
  * Return the transition animation for an appearing view and disappearing view pair (both of which must be subviews of
  * view)
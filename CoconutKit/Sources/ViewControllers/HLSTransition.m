@@ -9,12 +9,13 @@
 #import "HLSTransition.h"
 
 #import "HLSAnimation.h"
+#import "HLSAnimationStep+Friend.h"
 #import "HLSAssert.h"
 #import "HLSFloat.h"
 #import "HLSLayerAnimationStep.h"
+#import "HLSLogger.h"
 #import "NSObject+HLSExtensions.h"
 #import "NSSet+HLSExtensions.h"
-#import <objc/runtime.h>
 
 // Constants
 const NSTimeInterval kAnimationTransitionDefaultDuration = -1.;
@@ -22,8 +23,33 @@ const NSTimeInterval kAnimationTransitionDefaultDuration = -1.;
 static CGFloat kPushToTheBackScaleFactor = 0.95f;
 static CGFloat kEmergeFromCenterScaleFactor = 0.8f;
 
+static NSMutableDictionary *s_transitionClassNameToSnapshotModeMap = nil;
+
+// Registered transition classes, and the corresponding sorted names (calculated when needed)
+static NSMutableSet *s_registeredTransitionClasses = nil;
+static NSArray *s_availableTransitionNames = nil;
+
+// Maps a string identifying the transition class, bounds and duration to template animation steps (or NSNull if none)
+static NSCache *s_templateAnimationStepsCache = nil;
+
 @interface HLSTransition ()
 
++ (void)registerBuiltInTransitionClasses;
+
++ (HLSAnimation *)animationWithAppearingView:(UIView *)appearingView
+                            disappearingView:(UIView *)disappearingView
+                                      inView:(UIView *)view
+                                    duration:(NSTimeInterval)duration
+                               snapshotViews:(NSArray *)snapshotViews;
++ (NSArray *)layerAnimationStepsWithAppearingView:(UIView *)appearingView
+                                 disappearingView:(UIView *)disappearingView
+                                           inView:(UIView *)view
+                                       withBounds:(CGRect)bounds
+                                         duration:(NSTimeInterval)duration
+                                          reverse:(BOOL)reverse;
++ (NSArray *)snapshotViewsForAppearingView:(UIView *)appearingView disappearingView:(UIView *)disappearingView;
++ (NSArray *)animationStepsWithAnimationSteps:(NSArray *)animationSteps snapshotViews:(NSArray *)snapshotViews;
+
 + (NSArray *)coverLayerAnimationStepsWithInitialXOffset:(CGFloat)xOffset
                                                 yOffset:(CGFloat)yOffset
                                           appearingView:(UIView *)appearingView;
@@ -81,69 +107,137 @@ static CGFloat kEmergeFromCenterScaleFactor = 0.8f;
 
 + (NSArray *)availableTransitionNames
 {
-    static NSArray *s_availableTransitionNames = nil;
     if (! s_availableTransitionNames) {
-        NSMutableArray *availableTransitionNames = [NSMutableArray array];
+        [self registerBuiltInTransitionClasses];
         
-        // Find all HLSTransition subclasses (except HLSTransition itself)
-        unsigned int numberOfClasses = 0;
-        Class *classes = objc_copyClassList(&numberOfClasses);
-        for (int i = 0; i < numberOfClasses; ++i) {
-            Class class = classes[i];
-            
-            // Discard HLSTransition
-            if (class == [HLSTransition class]) {
-                continue;
-            }
-            
-            // Find whether HLSTransition is a superclass. We cannot use -isSubclassOfClass: since it is an NSObject
-            // method and we might encounter other kinds of classes (e.g. proxies)
-            // TODO: Factor out in HLSRuntime.h after merge with url-networking branch
-            Class superclass = class;
-            do {
-                superclass = class_getSuperclass(superclass);
-            } while (superclass && superclass != [HLSTransition class]);
-            
-            if (! superclass) {
-                continue;
-            }
-            
-            [availableTransitionNames addObject:NSStringFromClass(class)];
+        NSMutableArray *availableTransitionNames = [NSMutableArray arrayWithCapacity:[s_registeredTransitionClasses count]];
+        for (Class transitionClass in s_registeredTransitionClasses) {
+            [availableTransitionNames addObject:NSStringFromClass(transitionClass)];
         }
-        free(classes);
-        
         s_availableTransitionNames = [[availableTransitionNames sortedArrayUsingSelector:@selector(caseInsensitiveCompare:)] retain];
     }
     return s_availableTransitionNames;
 }
 
+#pragma mark Registering transitions
+
++ (void)registerTransitionClass:(Class)transitionClass
+{
+    if (! [transitionClass isSubclassOfClass:[HLSTransition class]] || transitionClass == [HLSTransition class]) {
+        HLSLoggerError(@"The class %@ is not an HLSTransition subclass", transitionClass);
+        return;
+    }
+    
+    if (! s_registeredTransitionClasses) {
+        s_registeredTransitionClasses = [[NSMutableSet alloc] init];
+    }
+    [s_registeredTransitionClasses addObject:transitionClass];
+    
+    // Names are calculated again when needed
+    [s_availableTransitionNames release];
+    s_availableTransitionNames = nil;
+}
+
+/**
+ * Built-in transitions are registered when first needed, so that nothing happens when the application is launched
+ */
++ (void)registerBuiltInTransitionClasses
+{
+    static BOOL s_builtInTransitionClassesRegistered = NO;
+    if (s_builtInTransitionClassesRegistered) {
+        return;
+    }
+    
+    Class builtInTransitionClasses[] = {
+        [HLSTransitionNone class],
+        [HLSTransitionCoverFromBottom class],
+        [HLSTransitionCoverFromTop class],
+        [HLSTransitionCoverFromLeft class],
+        [HLSTransitionCoverFromRight class],
+        [HLSTransitionCoverFromTopLeft class],
+        [HLSTransitionCoverFromTopRight class],
+        [HLSTransitionCoverFromBottomLeft class],
+        [HLSTransitionCoverFromBottomRight class],
+        [HLSTransitionCoverFromBottomPushToBack class],
+        [HLSTransitionCoverFromTopPushToBack class],
+        [HLSTransitionCoverFromLeftPushToBack class],
+        [HLSTransitionCoverFromRightPushToBack class],
+        [HLSTransitionCoverFromTopLeftPushToBack class],
+        [HLSTransitionCoverFromTopRightPushToBack class],
+        [HLSTransitionCoverFromBottomLeftPushToBack class],
+        [HLSTransitionCoverFromBottomRightPushToBack class],
+        [HLSTransitionFadeIn class],
+        [HLSTransitionFadeInPushToBack class],
+        [HLSTransitionCrossDissolve class],
+        [HLSTransitionPushFromBottom class],
+        [HLSTransitionPushFromTop class],
+        [HLSTransitionPushFromLeft class],
+        [HLSTransitionPushFromRight class],
+        [HLSTransitionPushFromBottomFadeIn class],
+        [HLSTransitionPushFromTopFadeIn class],
+        [HLSTransitionPushFromLeftFadeIn class],
+        [HLSTransitionPushFromRightFadeIn class],
+        [HLSTransitionPushToBackFromBottom class],
+        [HLSTransitionPushToBackFromTop class],
+        [HLSTransitionPushToBackFromLeft class],
+        [HLSTransitionPushToBackFromRight class],
+        [HLSTransitionFlowFromBottom class],
+        [HLSTransitionFlowFromTop class],
+        [HLSTransitionFlowFromLeft class],
+        [HLSTransitionFlowFromRight class],
+        [HLSTransitionEmergeFromCenter class],
+        [HLSTransitionEmergeFromCenterPushToBack class],
+        [HLSTransitionFlipVertically class],
+        [HLSTransitionFlipHorizontally class],
+        [HLSTransitionRotateHorizontallyFromBottomCounterclockwise class],
+        [HLSTransitionRotateHorizontallyFromBottomClockwise class],
+        [HLSTransitionRotateHorizontallyFromTopCounterclockwise class],
+        [HLSTransitionRotateHorizontallyFromTopClockwise class],
+        [HLSTransitionRotateVerticallyFromLeftCounterclockwise class],
+        [HLSTransitionRotateVerticallyFromLeftClockwise class],
+        [HLSTransitionRotateVerticallyFromRightCounterclockwise class],
+        [HLSTransitionRotateVerticallyFromRightClockwise class]
+    };
+    for (NSUInteger i = 0; i < sizeof(builtInTransitionClasses) / sizeof(Class); ++i) {
+        [self registerTransitionClass:builtInTransitionClasses[i]];
+    }
+    
+    s_builtInTransitionClassesRegistered = YES;
+}
+
 #pragma mark Generating the animation
 
 + (HLSAnimation *)animationWithAppearingView:(UIView *)appearingView
                             disappearingView:(UIView *)disappearingView
                                       inView:(UIView *)view
                                     duration:(NSTimeInterval)duration
+{
+    return [self animationWithAppearingView:appearingView
+                           disappearingView:disappearingView
+                                     inView:view
+                                   duration:duration
+                              snapshotViews:[self snapshotViewsForAppearingView:appearingView disappearingView:disappearingView]];
+}
+
++ (HLSAnimation *)animationWithAppearingView:(UIView *)appearingView
+                            disappearingView:(UIView *)disappearingView
+                                      inView:(UIView *)view
+                                    duration:(NSTimeInterval)duration
+                               snapshotViews:(NSArray *)snapshotViews
 {
     NSAssert(view && (! appearingView || appearingView.superview == view) && (! disappearingView || disappearingView.superview == view),
              @"Both the appearing and disappearing views must be children of the view in which the transition takes place");
     
-    // Build the animation with default parameters. Beware of the inView parameter here: If no appearing view has been set,
+    // Build the animation with the proper duration. Beware of the inView parameter here: If no appearing view has been set,
     // we are replaying an animation only for disappearing view
     NSArray *animationSteps = [self layerAnimationStepsWithAppearingView:appearingView
                                                         disappearingView:disappearingView
                                                                   inView:appearingView ? view : nil
-                                                              withBounds:view.bounds];
-    HLSAssertObjectsInEnumerationAreKindOfClass(animationSteps, [HLSLayerAnimationStep class]);
-        
-    HLSAnimation *animation = [HLSAnimation animationWithAnimationSteps:animationSteps];
-    
-    // Generate an animation with the proper duration
-    if (doubleeq(duration, kAnimationTransitionDefaultDuration)) {
-        return animation;
-    }
-    else {
-        return [animation animationWithDuration:duration];
-    }
+                                                              withBounds:view.bounds
+                                                                duration:duration
+                                                                 reverse:NO];
+    return [HLSAnimation animationWithAnimationSteps:[self animationStepsWithAnimationSteps:animationSteps
+                                                                              snapshotViews:snapshotViews]];
 }
 
 + (HLSAnimation *)reverseAnimationWithAppearingView:(UIView *)appearingView
@@ -157,34 +251,30 @@ static CGFloat kEmergeFromCenterScaleFactor = 0.8f;
     // Build the animation with default parameters. Calculate the original bounds to take into account any transform
     // which might be applied
     CGRect originalFrame = CGRectApplyAffineTransform(view.frame, CGAffineTransformInvert(view.transform));
-    NSArray *animationSteps = [self reverseLayerAnimationStepsWithAppearingView:appearingView
-                                                               disappearingView:disappearingView
-                                                                         inView:view
-                                                                     withBounds:CGRectMake(0.f,
-                                                                                           0.f,
-                                                                                           CGRectGetWidth(originalFrame),
-                                                                                           CGRectGetHeight(originalFrame))];
+    NSArray *animationSteps = [self layerAnimationStepsWithAppearingView:appearingView
+                                                        disappearingView:disappearingView
+                                                                  inView:view
+                                                              withBounds:CGRectMake(0.f,
+                                                                                    0.f,
+                                                                                    CGRectGetWidth(originalFrame),
+                                                                                    CGRectGetHeight(originalFrame))
+                                                                duration:duration
+                                                                 reverse:YES];
     
     // If custom reverse animation implemented by the animation class, use it
     if (animationSteps) {
-        HLSAssertObjectsInEnumerationAreKindOfClass(animationSteps, [HLSLayerAnimationStep class]);
-                
-        HLSAnimation *animation = [HLSAnimation animationWithAnimationSteps:animationSteps];
-        
-        // Generate an animation with the proper duration
-        if (doubleeq(duration, kAnimationTransitionDefaultDuration)) {
-            return animation;
-        }
-        else {
-            return [animation animationWithDuration:duration];
-        }
+        NSArray *snapshotViews = [self snapshotViewsForAppearingView:appearingView disappearingView:disappearingView];
+        return [HLSAnimation animationWithAnimationSteps:[self animationStepsWithAnimationSteps:animationSteps
+                                                                                  snapshotViews:snapshotViews]];
     }
-    // If not implemented by the transition class, use the default reverse animation
+    // If not implemented by the transition class, use the default reverse animation. The views to snapshot are the ones
+    // of the reverse transition
     else {
         return [[self animationWithAppearingView:disappearingView
                                 disappearingView:appearingView
                                           inView:view
-                                        duration:duration] reverseAnimation];
+                                        duration:duration
+                                   snapshotViews:[self snapshotViewsForAppearingView:appearingView disappearingView:disappearingView]] reverseAnimation];
     }
 }
 
@@ -210,6 +300,190 @@ static CGFloat kEmergeFromCenterScaleFactor = 0.8f;
     return [duration doubleValue];
 }
 
++ (BOOL)isThreeDimensional
+{
+    return NO;
+}
+
+#pragma mark Template animation steps
+
+/**
+ * Return the animation steps (reverse ones if reverse = YES) for the views received as parameters, scaled to the
+ * specified duration. Since animation steps only depend on the transition class, the bounds and the duration, they
+ * are generated once for placeholder views and cached as templates. Animation steps for the real views are then
+ * simply obtained by copying the templates and replacing placeholder views with them. Returns nil if the transition
+ * class does not implement custom reverse animation steps
+ */
++ (NSArray *)layerAnimationStepsWithAppearingView:(UIView *)appearingView
+                                 disappearingView:(UIView *)disappearingView
+                                           inView:(UIView *)view
+                                       withBounds:(CGRect)bounds
+                                         duration:(NSTimeInterval)duration
+                                          reverse:(BOOL)reverse
+{
+    // Placeholder views. Never released since template animation steps refer to their layers
+    static UIView *s_appearingPlaceholderView = nil;
+    static UIView *s_disappearingPlaceholderView = nil;
+    static UIView *s_placeholderView = nil;
+    if (! s_templateAnimationStepsCache) {
+        s_templateAnimationStepsCache = [[NSCache alloc] init];
+        s_appearingPlaceholderView = [[UIView alloc] initWithFrame:CGRectZero];
+        s_disappearingPlaceholderView = [[UIView alloc] initWithFrame:CGRectZero];
+        s_placeholderView = [[UIView alloc] initWithFrame:CGRectZero];
+    }
+    
+    // Steps also depend on which views are missing (no animations are generated for them)
+    NSString *key = [NSString stringWithFormat:@"%@_%@_%@_%d%d%d_%f",
+                     [self className],
+                     reverse ? @"reverse" : @"normal",
+                     NSStringFromCGRect(bounds),
+                     appearingView != nil,
+                     disappearingView != nil,
+                     view != nil,
+                     duration];
+    id templateAnimationSteps = [s_templateAnimationStepsCache objectForKey:key];
+    if (! templateAnimationSteps) {
+        UIView *appearingPlaceholderView = appearingView ? s_appearingPlaceholderView : nil;
+        UIView *disappearingPlaceholderView = disappearingView ? s_disappearingPlaceholderView : nil;
+        UIView *placeholderView = view ? s_placeholderView : nil;
+        
+        NSArray *animationSteps = nil;
+        if (reverse) {
+            animationSteps = [self reverseLayerAnimationStepsWithAppearingView:appearingPlaceholderView
+                                                              disappearingView:disappearingPlaceholderView
+                                                                        inView:placeholderView
+                                                                    withBounds:bounds];
+        }
+        else {
+            animationSteps = [self layerAnimationStepsWithAppearingView:appearingPlaceholderView
+                                                       disappearingView:disappearingPlaceholderView
+                                                                 inView:placeholderView
+                                                             withBounds:bounds];
+        }
+        
+        if (animationSteps) {
+            HLSAssertObjectsInEnumerationAreKindOfClass(animationSteps, [HLSLayerAnimationStep class]);
+            
+            // Distribute the total duration evenly among animation steps (see -[HLSAnimation animationWithDuration:])
+            if (! doubleeq(duration, kAnimationTransitionDefaultDuration)) {
+                NSTimeInterval defaultDuration = 0.;
+                for (HLSAnimationStep *animationStep in animationSteps) {
+                    defaultDuration += animationStep.duration;
+                }
+                
+                if (doublegt(defaultDuration, 0.)) {
+                    double factor = duration / defaultDuration;
+                    for (HLSAnimationStep *animationStep in animationSteps) {
+                        animationStep.duration *= factor;
+                    }
+                }
+            }
+            
+            templateAnimationSteps = animationSteps;
+        }
+        else {
+            templateAnimationSteps = [NSNull null];
+        }
+        [s_templateAnimationStepsCache setObject:templateAnimationSteps forKey:key];
+    }
+    
+    if (templateAnimationSteps == [NSNull null]) {
+        return nil;
+    }
+    
+    // Bind the templates to the real views
+    NSMutableArray *animationSteps = [NSMutableArray array];
+    for (HLSAnimationStep *templateAnimationStep in templateAnimationSteps) {
+        HLSAnimationStep *animationStep = [[templateAnimationStep copy] autorelease];
+        [animationStep replaceObject:s_appearingPlaceholderView.layer withObject:appearingView.layer];
+        [animationStep replaceObject:s_disappearingPlaceholderView.layer withObject:disappearingView.layer];
+        [animationStep replaceObject:s_placeholderView.layer withObject:view.layer];
+        [animationSteps addObject:animationStep];
+    }
+    return [NSArray arrayWithArray:animationSteps];
+}
+
+#pragma mark Snapshots
+
++ (void)setSnapshotMode:(HLSTransitionSnapshotMode)snapshotMode
+{
+    if (! s_transitionClassNameToSnapshotModeMap) {
+        s_transitionClassNameToSnapshotModeMap = [[NSMutableDictionary dictionary] retain];
+    }
+    
+    [s_transitionClassNameToSnapshotModeMap setObject:[NSNumber numberWithInt:snapshotMode] forKey:[self className]];
+}
+
++ (HLSTransitionSnapshotMode)snapshotMode
+{
+    // Use the mode of the nearest transition class in the hierarchy for which a mode has been set
+    Class transitionClass = self;
+    while (transitionClass) {
+        NSNumber *snapshotMode = [s_transitionClassNameToSnapshotModeMap objectForKey:[transitionClass className]];
+        if (snapshotMode) {
+            return [snapshotMode intValue];
+        }
+        
+        if (transitionClass == [HLSTransition class]) {
+            break;
+        }
+        transitionClass = [transitionClass superclass];
+    }
+    return HLSTransitionSnapshotModeNone;
+}
+
++ (NSArray *)snapshotViewsForAppearingView:(UIView *)appearingView disappearingView:(UIView *)disappearingView
+{
+    HLSTransitionSnapshotMode snapshotMode = [self snapshotMode];
+    if (snapshotMode == HLSTransitionSnapshotModeThreeDimensional) {
+        snapshotMode = [self isThreeDimensional] ? HLSTransitionSnapshotModeAllViews : HLSTransitionSnapshotModeNone;
+    }
+    
+    NSMutableArray *snapshotViews = [NSMutableArray array];
+    if (snapshotMode == HLSTransitionSnapshotModeAllViews && appearingView) {
+        [snapshotViews addObject:appearingView];
+    }
+    if (snapshotMode != HLSTransitionSnapshotModeNone && disappearingView) {
+        [snapshotViews addObject:disappearingView];
+    }
+    return [NSArray arrayWithArray:snapshotViews];
+}
+
+/**
+ * Surround the animation steps received as parameter with steps rasterizing the layers of the views to snapshot (at 
+ * the screen scale, so that they do not look blurry), and restoring them at the end. Since those steps are reversible,
+ * snapshots are also made when the animation is reversed
+ */
++ (NSArray *)animationStepsWithAnimationSteps:(NSArray *)animationSteps snapshotViews:(NSArray *)snapshotViews
+{
+    if ([snapshotViews count] == 0 || [animationSteps count] == 0) {
+        return animationSteps;
+    }
+    
+    CGFloat screenScale = [UIScreen mainScreen].scale;
+    
+    HLSLayerAnimationStep *snapshotAnimationStep = [HLSLayerAnimationStep animationStep];
+    HLSLayerAnimationStep *restoreAnimationStep = [HLSLayerAnimationStep animationStep];
+    for (UIView *snapshotView in snapshotViews) {
+        HLSLayerAnimation *snapshotLayerAnimation = [HLSLayerAnimation animation];
+        snapshotLayerAnimation.togglingShouldRasterize = YES;
+        [snapshotLayerAnimation addToRasterizationScale:screenScale - 1.f];
+        [snapshotAnimationStep addLayerAnimation:snapshotLayerAnimation forView:snapshotView];
+        
+        HLSLayerAnimation *restoreLayerAnimation = [HLSLayerAnimation animation];
+        restoreLayerAnimation.togglingShouldRasterize = YES;
+        [restoreLayerAnimation addToRasterizationScale:1.f - screenScale];
+        [restoreAnimationStep addLayerAnimation:restoreLayerAnimation forView:snapshotView];
+    }
+    snapshotAnimationStep.duration = 0.;
+    restoreAnimationStep.duration = 0.;
+    
+    NSMutableArray *snapshotAnimationSteps = [NSMutableArray arrayWithObject:snapshotAnimationStep];
+    [snapshotAnimationSteps addObjectsFromArray:animationSteps];
+    [snapshotAnimationSteps addObject:restoreAnimationStep];
+    return [NSArray arrayWithArray:snapshotAnimationSteps];
+}
+
 #pragma mark Built-in transition common code
 
 + (NSArray *)coverLayerAnimationStepsWithInitialXOffset:(CGFloat)xOffset
@@ -1212,6 +1486,11 @@ static CGFloat kEmergeFromCenterScaleFactor = 0.8f;
 
 @implementation HLSTransitionFlipVertically
 
++ (BOOL)isThreeDimensional
+{
+    return YES;
+}
+
 + (NSArray *)layerAnimationStepsWithAppearingView:(UIView *)appearingView
                                  disappearingView:(UIView *)disappearingView
                                            inView:(UIView *)view
@@ -1231,6 +1510,11 @@ static CGFloat kEmergeFromCenterScaleFactor = 0.8f;
 
 @implementation HLSTransitionFlipHorizontally
 
++ (BOOL)isThreeDimensional
+{
+    return YES;
+}
+
 + (NSArray *)layerAnimationStepsWithAppearingView:(UIView *)appearingView
                                  disappearingView:(UIView *)disappearingView
                                            inView:(UIView *)view
@@ -1250,6 +1534,11 @@ static CGFloat kEmergeFromCenterScaleFactor = 0.8f;
 
 @implementation HLSTransitionRotateHorizontallyFromBottomCounterclockwise
 
++ (BOOL)isThreeDimensional
+{
+    return YES;
+}
+
 + (NSArray *)layerAnimationStepsWithAppearingView:(UIView *)appearingView
                                  disappearingView:(UIView *)disappearingView
                                            inView:(UIView *)view
@@ -1272,6 +1561,11 @@ static CGFloat kEmergeFromCenterScaleFactor = 0.8f;
 
 @implementation HLSTransitionRotateHorizontallyFromBottomClockwise
 
++ (BOOL)isThreeDimensional
+{
+    return YES;
+}
+
 + (NSArray *)layerAnimationStepsWithAppearingView:(UIView *)appearingView
                                  disappearingView:(UIView *)disappearingView
                                            inView:(UIView *)view
@@ -1294,6 +1588,11 @@ static CGFloat kEmergeFromCenterScaleFactor = 0.8f;
 
 @implementation HLSTransitionRotateHorizontallyFromTopCounterclockwise
 
++ (BOOL)isThreeDimensional
+{
+    return YES;
+}
+
 + (NSArray *)layerAnimationStepsWithAppearingView:(UIView *)appearingView
                                  disappearingView:(UIView *)disappearingView
                                            inView:(UIView *)view
@@ -1316,6 +1615,11 @@ static CGFloat kEmergeFromCenterScaleFactor = 0.8f;
 
 @implementation HLSTransitionRotateHorizontallyFromTopClockwise
 
++ (BOOL)isThreeDimensional
+{
+    return YES;
+}
+
 + (NSArray *)layerAnimationStepsWithAppearingView:(UIView *)appearingView
                                  disappearingView:(UIView *)disappearingView
                                            inView:(UIView *)view
@@ -1338,6 +1642,11 @@ static CGFloat kEmergeFromCenterScaleFactor = 0.8f;
 
 @implementation HLSTransitionRotateVerticallyFromLeftCounterclockwise
 
++ (BOOL)isThreeDimensional
+{
+    return YES;
+}
+
 + (NSArray *)layerAnimationStepsWithAppearingView:(UIView *)appearingView
                                  disappearingView:(UIView *)disappearingView
                                            inView:(UIView *)view
@@ -1360,6 +1669,11 @@ static CGFloat kEmergeFromCenterScaleFactor = 0.8f;
 
 @implementation HLSTransitionRotateVerticallyFromLeftClockwise
 
++ (BOOL)isThreeDimensional
+{
+    return YES;
+}
+
 + (NSArray *)layerAnimationStepsWithAppearingView:(UIView *)appearingView
                                  disappearingView:(UIView *)disappearingView
                                            inView:(UIView *)view
@@ -1382,6 +1696,11 @@ static CGFloat kEmergeFromCenterScaleFactor = 0.8f;
 
 @implementation HLSTransitionRotateVerticallyFromRightCounterclockwise
 
++ (BOOL)isThreeDimensional
+{
+    return YES;
+}
+
 + (NSArray *)layerAnimationStepsWithAppearingView:(UIView *)appearingView
                                  disappearingView:(UIView *)disappearingView
                                            inView:(UIView *)view
@@ -1404,6 +1723,11 @@ static CGFloat kEmergeFromCenterScaleFactor = 0.8f;
 
 @implementation HLSTransitionRotateVerticallyFromRightClockwise
 
++ (BOOL)isThreeDimensional
+{
+    return YES;
+}
+
 + (NSArray *)layerAnimationStepsWithAppearingView:(UIView *)appearingView
                                  disappearingView:(UIView *)disappearingView
                                            inView:(UIView *)view
@@ -11,6 +11,13 @@
 /**
  * A web browser with standard features (navigation buttons, link sharing, etc.)
  *
+ * If an HLSURLCache has been installed as shared URL cache and a response has been stored for the initial request,
+ * this response is displayed immediately (even when offline) and revalidated in the background
+ *
+ * A snapshot and the scroll position of each page which is left are kept in a small cache. When navigating back or
+ * forward, the snapshot of the target page is displayed immediately while the page is reloaded underneath. The
+ * cache memory is bounded, and the cache is emptied when a memory warning is received
+ *
  * Designated initializer: -initWithRequest:
  */
 @interface HLSWebViewController : HLSViewController <MFMailComposeViewControllerDelegate, UIWebViewDelegate> {
@@ -18,6 +25,7 @@
     NSURLRequest *m_request;
     NSURL *m_currentURL;
     UIWebView *m_webView;
+    UIView *m_webViewPlaceholderView;
     UIToolbar *m_toolbar;
     UIBarButtonItem *m_goBackBarButtonItem;
     UIBarButtonItem *m_goForwardBarButtonItem;
@@ -25,6 +33,10 @@
     UIBarButtonItem *m_actionBarButtonItem;
     UIActivityIndicatorView *m_activityIndicator;
     UIImage *m_refreshImage;
+    NSCache *m_snapshotCache;
+    NSMutableDictionary *m_URLStringToScrollPositionValueMap;
+    UIImageView *m_snapshotImageView;
+    NSValue *m_pendingScrollPositionValue;
 }
 
 /**
@@ -37,10 +49,15 @@
  */
 @property (nonatomic, readonly, retain) NSURLRequest *request;
 
+/**
+ * The web view. Taken from the shared web view pool (see HLSWebViewPool) when the view is loaded, and returned to it
+ * when the view is released
+ */
+@property (nonatomic, readonly, retain) UIWebView *webView;
+
 /**
  * View outlets. Do not change
  */
-@property (nonatomic, retain) IBOutlet UIWebView *webView;
 @property (nonatomic, retain) IBOutlet UIToolbar *toolbar;
 @property (nonatomic, retain) IBOutlet UIBarButtonItem *goBackBarButtonItem;
 @property (nonatomic, retain) IBOutlet UIBarButtonItem *goForwardBarButtonItem;
@@ -11,20 +11,41 @@
 #import "HLSActionSheet.h"
 #import "HLSAutorotation.h"
 #import "HLSNotifications.h"
+#import "HLSURLCache.h"
+#import "HLSWebViewPool.h"
 #import "NSBundle+HLSDynamicLocalization.h"
 #import "NSBundle+HLSExtensions.h"
 #import "NSError+HLSExtensions.h"
 #import "NSBundle+HLSExtensions.h"
 #import "NSObject+HLSExtensions.h"
 #import "NSString+HLSExtensions.h"
+#import "UIView+HLSExtensions.h"
+
+static const NSUInteger kSnapshotCacheCountLimit = 10;
+static const NSUInteger kSnapshotCacheTotalCostLimit = 10 * 1024 * 1024;
 
 @interface HLSWebViewController ()
 
 @property (nonatomic, retain) NSURLRequest *request;
 @property (nonatomic, retain) NSURL *currentURL;
 
+@property (nonatomic, retain) UIWebView *webView;
+@property (nonatomic, retain) IBOutlet UIView *webViewPlaceholderView;
+
 @property (nonatomic, retain) UIImage *refreshImage;
 
+@property (nonatomic, retain) NSCache *snapshotCache;
+@property (nonatomic, retain) NSMutableDictionary *URLStringToScrollPositionValueMap;
+@property (nonatomic, retain) UIImageView *snapshotImageView;
+@property (nonatomic, retain) NSValue *pendingScrollPositionValue;
+
+- (NSURLRequest *)initialRequest;
+
+- (void)saveSnapshotForCurrentPage;
+- (void)displaySnapshotForURL:(NSURL *)URL;
+- (void)hideSnapshot;
+- (void)clearSnapshots;
+
 - (void)layoutForInterfaceOrientation:(UIInterfaceOrientation)interfaceOrientation;
 - (void)updateInterface;
 - (void)updateTitle;
@@ -42,6 +63,11 @@
 {
     if ((self = [super initWithBundle:[NSBundle coconutKitBundle]])) {
         self.request = request;
+        
+        self.snapshotCache = [[[NSCache alloc] init] autorelease];
+        self.snapshotCache.countLimit = kSnapshotCacheCountLimit;
+        self.snapshotCache.totalCostLimit = kSnapshotCacheTotalCostLimit;
+        self.URLStringToScrollPositionValueMap = [NSMutableDictionary dictionary];
     }
     return self;
 }
@@ -50,6 +76,8 @@
 {
     self.request = nil;
     self.currentURL = nil;
+    self.snapshotCache = nil;
+    self.URLStringToScrollPositionValueMap = nil;
     
     [super dealloc];
 }
@@ -58,7 +86,9 @@
 {
     [super releaseViews];
     
+    [[HLSWebViewPool sharedWebViewPool] enqueueWebView:self.webView];
     self.webView = nil;
+    self.webViewPlaceholderView = nil;
     self.toolbar = nil;
     self.goBackBarButtonItem = nil;
     self.goForwardBarButtonItem = nil;
@@ -66,6 +96,10 @@
     self.actionBarButtonItem = nil;
     self.activityIndicator = nil;
     self.refreshImage = nil;
+    self.snapshotImageView = nil;
+    
+    // The history is lost when the web view is returned to the pool
+    [self clearSnapshots];
 }
 
 #pragma mark Accessors and mutators
@@ -76,6 +110,8 @@
 
 @synthesize webView = m_webView;
 
+@synthesize webViewPlaceholderView = m_webViewPlaceholderView;
+
 @synthesize toolbar = m_toolbar;
 
 @synthesize goBackBarButtonItem = m_goBackBarButtonItem;
@@ -90,6 +126,14 @@
 
 @synthesize refreshImage = m_refreshImage;
 
+@synthesize snapshotCache = m_snapshotCache;
+
+@synthesize URLStringToScrollPositionValueMap = m_URLStringToScrollPositionValueMap;
+
+@synthesize snapshotImageView = m_snapshotImageView;
+
+@synthesize pendingScrollPositionValue = m_pendingScrollPositionValue;
+
 #pragma mark View lifecycle
 
 - (void)viewDidLoad
@@ -98,11 +142,30 @@
     
     self.refreshImage = self.refreshBarButtonItem.image;
     
+    // Creating a web view is expensive. Use one from the pool, installed in place of the placeholder view from the nib
+    self.webView = [[HLSWebViewPool sharedWebViewPool] dequeueWebView];
+    self.webView.frame = self.webViewPlaceholderView.frame;
+    self.webView.autoresizingMask = self.webViewPlaceholderView.autoresizingMask;
+    self.webView.multipleTouchEnabled = YES;
+    self.webView.scalesPageToFit = YES;
+    self.webView.dataDetectorTypes = UIDataDetectorTypePhoneNumber;
+    [self.view insertSubview:self.webView aboveSubview:self.webViewPlaceholderView];
+    [self.webViewPlaceholderView removeFromSuperview];
+    self.webViewPlaceholderView = nil;
+    
+    // Displays the snapshot of a page while it is being reloaded during back / forward navigation
+    self.snapshotImageView = [[[UIImageView alloc] initWithFrame:self.webView.frame] autorelease];
+    self.snapshotImageView.autoresizingMask = self.webView.autoresizingMask;
+    self.snapshotImageView.contentMode = UIViewContentModeTopLeft;
+    self.snapshotImageView.clipsToBounds = YES;
+    self.snapshotImageView.hidden = YES;
+    [self.view insertSubview:self.snapshotImageView aboveSubview:self.webView];
+    
     // Start with the initial URL when the view gets (re)loaded
     self.currentURL = nil;
     
     self.webView.delegate = self;
-    [self.webView loadRequest:self.request];
+    [self.webView loadRequest:[self initialRequest]];
 }
 
 - (void)viewWillAppear:(BOOL)animated
@@ -148,6 +211,22 @@
     [self updateTitle];
 }
 
+#pragma mark Loading
+
+// Display the stored response immediately when available. The cache takes care of revalidating it
+- (NSURLRequest *)initialRequest
+{
+    NSURLCache *sharedURLCache = [NSURLCache sharedURLCache];
+    if (! [sharedURLCache isKindOfClass:[HLSURLCache class]] 
+            || ! [(HLSURLCache *)sharedURLCache hasCachedResponseForRequest:self.request]) {
+        return self.request;
+    }
+    
+    NSMutableURLRequest *initialRequest = [[self.request mutableCopy] autorelease];
+    [initialRequest setCachePolicy:NSURLRequestReturnCacheDataElseLoad];
+    return initialRequest;
+}
+
 #pragma mark Layout and display
 
 - (void)layoutForInterfaceOrientation:(UIInterfaceOrientation)interfaceOrientation
@@ -156,6 +235,7 @@
     CGSize toolbarSize = [self.toolbar sizeThatFits:self.view.bounds.size];
     self.toolbar.frame = (CGRect){CGPointMake(0.f, CGRectGetHeight(self.view.bounds) - toolbarSize.height), toolbarSize};
     self.webView.frame = (CGRect){CGPointZero, CGSizeMake(CGRectGetWidth(self.view.bounds), CGRectGetMinY(self.toolbar.frame))};
+    self.snapshotImageView.frame = self.webView.frame;
     
     // Center UI elements accordingly
     self.activityIndicator.center = CGPointMake(self.activityIndicator.center.x, CGRectGetMidY(self.toolbar.frame));
@@ -182,6 +262,66 @@
     }
 }
 
+#pragma mark Page snapshots
+
+- (void)saveSnapshotForCurrentPage
+{
+    // Nothing to save if no page has been loaded yet, or if a snapshot is currently covering the web view
+    if (! self.currentURL || ! self.snapshotImageView.hidden) {
+        return;
+    }
+    
+    NSString *URLString = [self.currentURL absoluteString];
+    UIImage *snapshot = [self.webView flattenedImage];
+    NSUInteger cost = (NSUInteger)(snapshot.size.width * snapshot.size.height * snapshot.scale * snapshot.scale * 4.f);
+    [self.snapshotCache setObject:snapshot forKey:URLString cost:cost];
+    
+    NSString *scrollPositionString = [self.webView stringByEvaluatingJavaScriptFromString:@"window.scrollX + ',' + window.scrollY"];
+    NSArray *scrollPositionComponents = [scrollPositionString componentsSeparatedByString:@","];
+    if ([scrollPositionComponents count] == 2) {
+        CGPoint scrollPosition = CGPointMake([[scrollPositionComponents objectAtIndex:0] floatValue],
+                                             [[scrollPositionComponents objectAtIndex:1] floatValue]);
+        [self.URLStringToScrollPositionValueMap setObject:[NSValue valueWithCGPoint:scrollPosition] forKey:URLString];
+    }
+}
+
+- (void)displaySnapshotForURL:(NSURL *)URL
+{
+    NSString *URLString = [URL absoluteString];
+    self.pendingScrollPositionValue = [self.URLStringToScrollPositionValueMap objectForKey:URLString];
+    
+    UIImage *snapshot = [self.snapshotCache objectForKey:URLString];
+    if (! snapshot) {
+        return;
+    }
+    
+    self.snapshotImageView.image = snapshot;
+    self.snapshotImageView.hidden = NO;
+}
+
+- (void)hideSnapshot
+{
+    self.snapshotImageView.hidden = YES;
+    self.snapshotImageView.image = nil;
+}
+
+- (void)clearSnapshots
+{
+    [self.snapshotCache removeAllObjects];
+    [self.URLStringToScrollPositionValueMap removeAllObjects];
+    self.pendingScrollPositionValue = nil;
+}
+
+#pragma mark Memory warnings
+
+- (void)didReceiveMemoryWarning
+{
+    [super didReceiveMemoryWarning];
+    
+    // Scroll positions are small and kept
+    [self.snapshotCache removeAllObjects];
+}
+
 #pragma mark MFMailComposeViewControllerDelegate protocol implementation
 
 - (void)mailComposeController:(MFMailComposeViewController*)controller didFinishWithResult:(MFMailComposeResult)result error:(NSError*)error
@@ -191,6 +331,22 @@
 
 #pragma mark UIWebViewDelegate protocol implementation
 
+- (BOOL)webView:(UIWebView *)webView shouldStartLoadWithRequest:(NSURLRequest *)request navigationType:(UIWebViewNavigationType)navigationType
+{
+    // Only main document loads leave the current page
+    if (! [[request URL] isEqual:[request mainDocumentURL]]) {
+        return YES;
+    }
+    
+    [self saveSnapshotForCurrentPage];
+    
+    if (navigationType == UIWebViewNavigationTypeBackForward) {
+        [self displaySnapshotForURL:[request URL]];
+    }
+    
+    return YES;
+}
+
 - (void)webViewDidStartLoad:(UIWebView *)webView
 {
     [[HLSNotificationManager sharedNotificationManager] notifyBeginNetworkActivity];
@@ -207,6 +363,15 @@
     // A new page has been displayed. Remember its URL
     self.currentURL = [self.webView.request URL];
     
+    // Back / forward navigation: Restore the scroll position the page had when it was left, and reveal it
+    if (self.pendingScrollPositionValue) {
+        CGPoint scrollPosition = [self.pendingScrollPositionValue CGPointValue];
+        [self.webView stringByEvaluatingJavaScriptFromString:[NSString stringWithFormat:@"window.scrollTo(%.0f, %.0f)",
+                                                              scrollPosition.x, scrollPosition.y]];
+        self.pendingScrollPositionValue = nil;
+    }
+    [self hideSnapshot];
+    
     [self updateInterface];
 }
 
@@ -215,6 +380,9 @@
     [[HLSNotificationManager sharedNotificationManager] notifyEndNetworkActivity];
     [self.activityIndicator stopAnimating];
     
+    self.pendingScrollPositionValue = nil;
+    [self hideSnapshot];
+    
     [self updateInterface];
     
     // We can also encounter other types of errors here (e.g. if a user clicks on two links consecutively on the same page. 
@@ -254,7 +422,7 @@
     }
     // Reload the start page
     else {
-        [self.webView loadRequest:self.request];
+        [self.webView loadRequest:[self initialRequest]];
     }
     
     [self updateInterface];
@@ -48,6 +48,7 @@ typedef enum {
     NSArray *m_viewControllers;
     HLSWizardTransitionStyle m_wizardTransitionStyle;
     NSInteger m_currentPage;
+    NSUInteger m_pageViewRetentionDistance;
 }
 
 /**
@@ -68,6 +69,13 @@ typedef enum {
  */
 @property (nonatomic, assign) HLSWizardTransitionStyle wizardTransitionStyle;
 
+/**
+ * The views of the pages next to the current one are loaded in advance, so that moving to them involves no view loading.
+ * The views of pages farther from the current page than this distance are released (the view controllers are kept). The
+ * minimum value is 1. Default is 2
+ */
+@property (nonatomic, assign) NSUInteger pageViewRetentionDistance;
+
 /**
  * Go to some page; hopping in forward direction will block if some page in between is not valid
  */
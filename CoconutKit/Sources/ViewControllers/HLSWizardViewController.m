@@ -23,6 +23,8 @@ static const NSInteger kWizardViewControllerNoPage = -1;
 
 - (void)refreshWizardInterface;
 
+- (void)prefetchNeighbouringPages;
+
 - (BOOL)validatePage:(NSInteger)page;
 
 - (void)previousPage:(id)sender;
@@ -56,6 +58,7 @@ static const NSInteger kWizardViewControllerNoPage = -1;
 {
     m_currentPage = kWizardViewControllerNoPage;
     m_wizardTransitionStyle = HLSWizardTransitionStyleNone;
+    m_pageViewRetentionDistance = 2;
 }
 
 - (void)dealloc
@@ -69,6 +72,8 @@ static const NSInteger kWizardViewControllerNoPage = -1;
 {
     [super releaseViews];
     
+    [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(prefetchNeighbouringPages) object:nil];
+    
     self.previousButton = nil;
     self.nextButton = nil;
     self.doneButton = nil;
@@ -124,6 +129,19 @@ static const NSInteger kWizardViewControllerNoPage = -1;
 
 @synthesize wizardTransitionStyle = m_wizardTransitionStyle;
 
+@synthesize pageViewRetentionDistance = m_pageViewRetentionDistance;
+
+- (void)setPageViewRetentionDistance:(NSUInteger)pageViewRetentionDistance
+{
+    // The previous page might still be animated out
+    if (pageViewRetentionDistance < 1) {
+        pageViewRetentionDistance = 1;
+        HLSLoggerWarn(@"The page view retention distance cannot be smaller than 1; set to this value");
+    }
+    
+    m_pageViewRetentionDistance = pageViewRetentionDistance;
+}
+
 @synthesize currentPage = m_currentPage;
 
 - (void)setCurrentPage:(NSInteger)currentPage
@@ -182,6 +200,14 @@ static const NSInteger kWizardViewControllerNoPage = -1;
     // Display the current page
     UIViewController *viewController = [self.viewControllers objectAtIndex:m_currentPage];
     [self setInsetViewController:viewController atIndex:0 withTransitionClass:transitionClass];
+    
+    // Prepare the neighbouring pages once the run loop is idle (not while the user interacts with the interface), so that
+    // the transition is not slowed down
+    [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(prefetchNeighbouringPages) object:nil];
+    [self performSelector:@selector(prefetchNeighbouringPages)
+               withObject:nil
+               afterDelay:0.
+                  inModes:[NSArray arrayWithObject:NSDefaultRunLoopMode]];
 }
 
 #pragma mark Refreshing the UI
@@ -231,6 +257,45 @@ static const NSInteger kWizardViewControllerNoPage = -1;
 
 #pragma mark Handling pages
 
+- (void)prefetchNeighbouringPages
+{
+    if (self.currentPage == kWizardViewControllerNoPage || ! [self isViewLoaded]) {
+        return;
+    }
+    
+    // Release the views of distant pages
+    for (NSInteger i = 0; i < [self.viewControllers count]; ++i) {
+        if ((NSUInteger)abs(i - self.currentPage) <= self.pageViewRetentionDistance) {
+            continue;
+        }
+        
+        UIViewController *viewController = [self.viewControllers objectAtIndex:i];
+        if ([viewController isViewLoaded]) {
+            [viewController unloadViews];
+        }
+    }
+    
+    // Load the views of the previous and next pages, and lay them out with the dimensions they will be displayed with
+    UIView *placeholderView = [self placeholderViewAtIndex:0];
+    for (NSInteger i = self.currentPage - 1; i <= self.currentPage + 1; i += 2) {
+        if (i < 0 || i >= [self.viewControllers count]) {
+            continue;
+        }
+        
+        UIViewController *viewController = [self.viewControllers objectAtIndex:i];
+        if ([viewController isViewLoaded]) {
+            continue;
+        }
+        
+        // This is where lazy loading of the view controller's view occurs
+        UIView *view = viewController.view;
+        if (placeholderView) {
+            view.frame = placeholderView.bounds;
+            [view layoutIfNeeded];
+        }
+    }
+}
+
 - (BOOL)validatePage:(NSInteger)page
 {
     // Sanitize input (deals with the "no page" case)
@@ -23,6 +23,18 @@ typedef enum {
     HLSViewControllerLifeCyclePhaseEnumSize = HLSViewControllerLifeCyclePhaseEnumEnd - HLSViewControllerLifeCyclePhaseEnumBegin
 } HLSViewControllerLifeCyclePhase;
 
+// Lifecycle timing metrics (see +lifeCycleTimings)
+extern NSString * const HLSViewControllerLifeCycleMetricLoadView;               // From the first view access to -[super viewDidLoad] (nib loading included)
+extern NSString * const HLSViewControllerLifeCycleMetricViewDidLoad;            // From -[super viewDidLoad] until the view is available
+extern NSString * const HLSViewControllerLifeCycleMetricAppearance;             // From -[super viewWillAppear:] to -[super viewDidAppear:]
+extern NSString * const HLSViewControllerLifeCycleMetricDisappearance;          // From -[super viewWillDisappear:] to -[super viewDidDisappear:]
+
+// Statistics available for each lifecycle timing metric (NSNumber values, durations in seconds)
+extern NSString * const HLSViewControllerLifeCycleTimingCountKey;
+extern NSString * const HLSViewControllerLifeCycleTimingAverageKey;
+extern NSString * const HLSViewControllerLifeCycleTimingMaximumKey;
+extern NSString * const HLSViewControllerLifeCycleTimingTotalKey;
+
 /**
  * Various useful additions to UIViewController, most notably the ability get more information about the view lifecycle.
  * This category also provide automatic keyboard dismissal when a view controller disappears while a text field was
@@ -39,9 +51,45 @@ typedef enum {
  * The same is true for rotations: The final frame dimensions are known in -willAnimateRotationToInterfaceOrientation:duration:
  * (1-step rotation) or -willAnimateFirstHalfOfRotationToInterfaceOrientation:duration: (2-step rotation, deprecated
  * starting with iOS 5).
+ *
+ * Lifecycle timing:
+ * -----------------
+ * To find slow screens without adding timers to view controller implementations, lifecycle timings can be recorded for
+ * all view controllers. Enable them by calling +setLifeCycleTimingEnabled: or by adding an HLSViewControllerLifeCycleTiming
+ * boolean setting to your project main .plist file. Timings are aggregated per view controller class and can be retrieved
+ * with +lifeCycleTimings or logged with +logLifeCycleTimings. 
+ *
+ * Durations are measured when UIViewController lifecycle methods are reached, i.e. when subclasses call the super 
+ * implementation, which is usually done first. Subclass work performed before calling super -viewDidLoad is therefore
+ * accounted to view loading, and work performed before calling super -viewWillAppear: (-viewWillDisappear:) or after 
+ * calling super -viewDidAppear: (-viewDidDisappear:) is not measured. View loading is measured as a whole, whether it is
+ * performed from a nib or by -loadView
  */
 @interface UIViewController (HLSExtensions)
 
+/**
+ * Enable or disable lifecycle timing. Must be called from the main thread. Disabled by default
+ */
++ (void)setLifeCycleTimingEnabled:(BOOL)lifeCycleTimingEnabled;
++ (BOOL)isLifeCycleTimingEnabled;
+
+/**
+ * Return the timings recorded so far, as a dictionary mapping view controller class names to dictionaries, which map
+ * each metric (see HLSViewControllerLifeCycleMetric... constants) to its statistics (see HLSViewControllerLifeCycleTiming...Key
+ * constants). Metrics for which nothing has been recorded yet are omitted. Must be called from the main thread
+ */
++ (NSDictionary *)lifeCycleTimings;
+
+/**
+ * Log the timings recorded so far (at the info level), slowest view controller classes first
+ */
++ (void)logLifeCycleTimings;
+
+/**
+ * Discard the timings recorded so far
+ */
++ (void)resetLifeCycleTimings;
+
 /**
  * Convenience method to set the view controller to nil and forward -viewWill/DidUnload events correctly
  * Not meant to be overridden
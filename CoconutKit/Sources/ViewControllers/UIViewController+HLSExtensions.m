@@ -15,13 +15,28 @@
 #import "UITextField+HLSExtensions.h"
 #import "UITextView+HLSExtensions.h"
 
+// Lifecycle timing metrics and statistics
+NSString * const HLSViewControllerLifeCycleMetricLoadView = @"loadView";
+NSString * const HLSViewControllerLifeCycleMetricViewDidLoad = @"viewDidLoad";
+NSString * const HLSViewControllerLifeCycleMetricAppearance = @"appearance";
+NSString * const HLSViewControllerLifeCycleMetricDisappearance = @"disappearance";
+
+NSString * const HLSViewControllerLifeCycleTimingCountKey = @"count";
+NSString * const HLSViewControllerLifeCycleTimingAverageKey = @"average";
+NSString * const HLSViewControllerLifeCycleTimingMaximumKey = @"maximum";
+NSString * const HLSViewControllerLifeCycleTimingTotalKey = @"total";
+
 // Associated object keys
-static void *s_lifeCyclePhaseKey = &s_lifeCyclePhaseKey;
-static void *s_originalViewSizeKey = &s_originalViewSizeKey;
+static void *s_lifeCycleStateKey = &s_lifeCycleStateKey;
+
+// Lifecycle timing (main thread only)
+static BOOL s_lifeCycleTimingEnabled = NO;
+static NSMutableDictionary *s_classNameToLifeCycleTimingsMap = nil;
 
 // Original implementation of the methods we swizzle
 static id (*s_UIViewController__initWithNibName_bundle_Imp)(id, SEL, id, id) = NULL;
 static id (*s_UIViewController__initWithCoder_Imp)(id, SEL, id) = NULL;
+static id (*s_UIViewController__view_Imp)(id, SEL) = NULL;
 static void (*s_UIViewController__viewDidLoad_Imp)(id, SEL) = NULL;
 static void (*s_UIViewController__viewWillAppear_Imp)(id, SEL, BOOL) = NULL;
 static void (*s_UIViewController__viewDidAppear_Imp)(id, SEL, BOOL) = NULL;
@@ -33,6 +48,7 @@ static void (*s_UIViewController__viewDidUnload_Imp)(id, SEL) = NULL;
 // Swizzled method implementations
 static id swizzled_UIViewController__initWithNibName_bundle_Imp(UIViewController *self, SEL _cmd, NSString *nibName, NSBundle *bundle);
 static id swizzled_UIViewController__initWithCoder_Imp(UIViewController *self, SEL _cmd, NSCoder *aDecoder);
+static id swizzled_UIViewController__view_Imp(UIViewController *self, SEL _cmd);
 static void swizzled_UIViewController__viewDidLoad_Imp(UIViewController *self, SEL _cmd);
 static void swizzled_UIViewController__viewWillAppear_Imp(UIViewController *self, SEL _cmd, BOOL animated);
 static void swizzled_UIViewController__viewDidAppear_Imp(UIViewController *self, SEL _cmd, BOOL animated);
@@ -41,10 +57,54 @@ static void swizzled_UIViewController__viewDidDisappear_Imp(UIViewController *se
 static void swizzled_UIViewController__viewWillUnload_Imp(UIViewController *self, SEL _cmd);
 static void swizzled_UIViewController__viewDidUnload_Imp(UIViewController *self, SEL _cmd);
 
+static void HLSViewControllerRecordLifeCycleTiming(UIViewController *viewController, NSString *metric, NSTimeInterval duration);
+static NSInteger compareClassNamesByDecreasingTotalDuration(id className1, id className2, void *context);
+
+/**
+ * Lifecycle bookkeeping information attached to a view controller. A single object is associated with a view
+ * controller when it is created, and then updated in place. This avoids allocating a new object and going through
+ * the associated object machinery each time the view controller transitions from one lifecycle phase to the next
+ */
+@interface HLSViewControllerLifeCycleState : NSObject {
+@private
+    HLSViewControllerLifeCyclePhase m_lifeCyclePhase;
+    CGSize m_originalViewSize;
+    NSTimeInterval m_viewDidLoadTime;
+    NSTimeInterval m_transitionStartTime;
+}
+
+@property (nonatomic, assign) HLSViewControllerLifeCyclePhase lifeCyclePhase;
+@property (nonatomic, assign) CGSize originalViewSize;
+@property (nonatomic, assign) NSTimeInterval viewDidLoadTime;               // Time at which -[super viewDidLoad] was reached (0 if not timed)
+@property (nonatomic, assign) NSTimeInterval transitionStartTime;           // Time at which the current appearance or disappearance began (0 if not timed)
+
+@end
+
+/**
+ * Aggregated durations of a lifecycle timing metric
+ */
+@interface HLSViewControllerLifeCycleTiming : NSObject {
+@private
+    NSUInteger m_count;
+    NSTimeInterval m_totalDuration;
+    NSTimeInterval m_maximumDuration;
+}
+
+- (void)addDuration:(NSTimeInterval)duration;
+
+@property (nonatomic, readonly, assign) NSUInteger count;
+@property (nonatomic, readonly, assign) NSTimeInterval totalDuration;
+
+- (NSDictionary *)statistics;
+
+@end
+
 @interface UIViewController (HLSExtensionsPrivate) <HLSAutorotationCompatibility>
 
 - (void)uiViewControllerHLSExtensionsInit;
 
+- (HLSViewControllerLifeCycleState *)lifeCycleState;
+
 - (void)setLifeCyclePhase:(HLSViewControllerLifeCyclePhase)lifeCyclePhase;
 - (void)setOriginalViewSize:(CGSize)originalViewSize;
 
@@ -52,6 +112,66 @@ static void swizzled_UIViewController__viewDidUnload_Imp(UIViewController *self,
 
 @implementation UIViewController (HLSExtensions)
 
+#pragma mark Class methods
+
++ (void)setLifeCycleTimingEnabled:(BOOL)lifeCycleTimingEnabled
+{
+    s_lifeCycleTimingEnabled = lifeCycleTimingEnabled;
+}
+
++ (BOOL)isLifeCycleTimingEnabled
+{
+    return s_lifeCycleTimingEnabled;
+}
+
++ (NSDictionary *)lifeCycleTimings
+{
+    NSMutableDictionary *lifeCycleTimings = [NSMutableDictionary dictionary];
+    for (NSString *className in [s_classNameToLifeCycleTimingsMap allKeys]) {
+        NSDictionary *metricToTimingMap = [s_classNameToLifeCycleTimingsMap objectForKey:className];
+        NSMutableDictionary *metricToStatisticsMap = [NSMutableDictionary dictionary];
+        for (NSString *metric in [metricToTimingMap allKeys]) {
+            HLSViewControllerLifeCycleTiming *timing = [metricToTimingMap objectForKey:metric];
+            [metricToStatisticsMap setObject:[timing statistics] forKey:metric];
+        }
+        [lifeCycleTimings setObject:[NSDictionary dictionaryWithDictionary:metricToStatisticsMap] forKey:className];
+    }
+    return [NSDictionary dictionaryWithDictionary:lifeCycleTimings];
+}
+
++ (void)logLifeCycleTimings
+{
+    // Slowest classes (overall) first
+    NSMutableDictionary *classNameToTotalDurationMap = [NSMutableDictionary dictionary];
+    for (NSString *className in [s_classNameToLifeCycleTimingsMap allKeys]) {
+        NSTimeInterval totalDuration = 0.;
+        for (HLSViewControllerLifeCycleTiming *timing in [[s_classNameToLifeCycleTimingsMap objectForKey:className] allValues]) {
+            totalDuration += timing.totalDuration;
+        }
+        [classNameToTotalDurationMap setObject:[NSNumber numberWithDouble:totalDuration] forKey:className];
+    }
+    NSArray *classNames = [[classNameToTotalDurationMap allKeys] sortedArrayUsingFunction:compareClassNamesByDecreasingTotalDuration 
+                                                                                  context:classNameToTotalDurationMap];
+    
+    for (NSString *className in classNames) {
+        NSDictionary *metricToTimingMap = [s_classNameToLifeCycleTimingsMap objectForKey:className];
+        for (NSString *metric in [[metricToTimingMap allKeys] sortedArrayUsingSelector:@selector(compare:)]) {
+            NSDictionary *statistics = [[metricToTimingMap objectForKey:metric] statistics];
+            HLSLoggerInfo(@"%@ %@: count = %@, max = %.3f ms, average = %.3f ms", 
+                          className, 
+                          metric,
+                          [statistics objectForKey:HLSViewControllerLifeCycleTimingCountKey],
+                          [[statistics objectForKey:HLSViewControllerLifeCycleTimingMaximumKey] doubleValue] * 1000.,
+                          [[statistics objectForKey:HLSViewControllerLifeCycleTimingAverageKey] doubleValue] * 1000.);
+        }
+    }
+}
+
++ (void)resetLifeCycleTimings
+{
+    [s_classNameToLifeCycleTimingsMap removeAllObjects];
+}
+
 #pragma mark View management
 
 /**
@@ -83,7 +203,7 @@ static void swizzled_UIViewController__viewDidUnload_Imp(UIViewController *self,
 
 - (HLSViewControllerLifeCyclePhase)lifeCyclePhase
 {
-    return [objc_getAssociatedObject(self, s_lifeCyclePhaseKey) intValue];
+    return [self lifeCycleState].lifeCyclePhase;
 }
 
 - (UIView *)viewIfLoaded
@@ -112,7 +232,7 @@ static void swizzled_UIViewController__viewDidUnload_Imp(UIViewController *self,
         return CGSizeZero;
     }
     
-    return [objc_getAssociatedObject(self, s_originalViewSizeKey) CGSizeValue];
+    return [self lifeCycleState].originalViewSize;
 }
 
 - (BOOL)isReadyForLifeCyclePhase:(HLSViewControllerLifeCyclePhase)lifeCyclePhase
@@ -293,57 +413,127 @@ static void swizzled_UIViewController__viewDidUnload_Imp(UIViewController *self,
 
 + (void)load
 {
-    s_UIViewController__initWithNibName_bundle_Imp = (id (*)(id, SEL, id, id))HLSSwizzleSelector(self, 
-                                                                                                 @selector(initWithNibName:bundle:), 
-                                                                                                 (IMP)swizzled_UIViewController__initWithNibName_bundle_Imp);
-    s_UIViewController__initWithCoder_Imp = (id (*)(id, SEL, id))HLSSwizzleSelector(self, 
-                                                                                    @selector(initWithCoder:), 
-                                                                                    (IMP)swizzled_UIViewController__initWithCoder_Imp);
-    s_UIViewController__viewDidLoad_Imp = (void (*)(id, SEL))HLSSwizzleSelector(self, 
-                                                                                @selector(viewDidLoad), 
-                                                                                (IMP)swizzled_UIViewController__viewDidLoad_Imp);
-    s_UIViewController__viewWillAppear_Imp = (void (*)(id, SEL, BOOL))HLSSwizzleSelector(self, 
-                                                                                         @selector(viewWillAppear:), 
-                                                                                         (IMP)swizzled_UIViewController__viewWillAppear_Imp);
-    s_UIViewController__viewDidAppear_Imp = (void (*)(id, SEL, BOOL))HLSSwizzleSelector(self, 
-                                                                                        @selector(viewDidAppear:), 
-                                                                                        (IMP)swizzled_UIViewController__viewDidAppear_Imp);
-    s_UIViewController__viewWillDisappear_Imp = (void (*)(id, SEL, BOOL))HLSSwizzleSelector(self, 
-                                                                                            @selector(viewWillDisappear:), 
-                                                                                            (IMP)swizzled_UIViewController__viewWillDisappear_Imp);
-    s_UIViewController__viewDidDisappear_Imp = (void (*)(id, SEL, BOOL))HLSSwizzleSelector(self, 
-                                                                                           @selector(viewDidDisappear:),
-                                                                                           (IMP)swizzled_UIViewController__viewDidDisappear_Imp);
-    s_UIViewController__viewWillUnload_Imp = (void (*)(id, SEL))HLSSwizzleSelector(self,
-                                                                                   @selector(viewWillUnload),
-                                                                                   (IMP)swizzled_UIViewController__viewWillUnload_Imp);
-    s_UIViewController__viewDidUnload_Imp = (void (*)(id, SEL))HLSSwizzleSelector(self,
-                                                                                  @selector(viewDidUnload),
-                                                                                  (IMP)swizzled_UIViewController__viewDidUnload_Imp);
+    HLSSwizzling swizzlings[] = {
+        {@selector(initWithNibName:bundle:), (IMP)swizzled_UIViewController__initWithNibName_bundle_Imp, (IMP *)&s_UIViewController__initWithNibName_bundle_Imp},
+        {@selector(initWithCoder:), (IMP)swizzled_UIViewController__initWithCoder_Imp, (IMP *)&s_UIViewController__initWithCoder_Imp},
+        {@selector(view), (IMP)swizzled_UIViewController__view_Imp, (IMP *)&s_UIViewController__view_Imp},
+        {@selector(viewDidLoad), (IMP)swizzled_UIViewController__viewDidLoad_Imp, (IMP *)&s_UIViewController__viewDidLoad_Imp},
+        {@selector(viewWillAppear:), (IMP)swizzled_UIViewController__viewWillAppear_Imp, (IMP *)&s_UIViewController__viewWillAppear_Imp},
+        {@selector(viewDidAppear:), (IMP)swizzled_UIViewController__viewDidAppear_Imp, (IMP *)&s_UIViewController__viewDidAppear_Imp},
+        {@selector(viewWillDisappear:), (IMP)swizzled_UIViewController__viewWillDisappear_Imp, (IMP *)&s_UIViewController__viewWillDisappear_Imp},
+        {@selector(viewDidDisappear:), (IMP)swizzled_UIViewController__viewDidDisappear_Imp, (IMP *)&s_UIViewController__viewDidDisappear_Imp},
+        {@selector(viewWillUnload), (IMP)swizzled_UIViewController__viewWillUnload_Imp, (IMP *)&s_UIViewController__viewWillUnload_Imp},
+        {@selector(viewDidUnload), (IMP)swizzled_UIViewController__viewDidUnload_Imp, (IMP *)&s_UIViewController__viewDidUnload_Imp}
+    };
+    HLSSwizzleSelectors(self, swizzlings, sizeof(swizzlings) / sizeof(HLSSwizzling));
+    
+    s_classNameToLifeCycleTimingsMap = [[NSMutableDictionary alloc] init];
+    
+    NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+    s_lifeCycleTimingEnabled = [[[[NSBundle mainBundle] infoDictionary] objectForKey:@"HLSViewControllerLifeCycleTiming"] boolValue];
+    [pool drain];
 }
 
 #pragma mark Object creation and destruction
 
 - (void)uiViewControllerHLSExtensionsInit
 {
-    [self setLifeCyclePhase:HLSViewControllerLifeCyclePhaseInitialized];
-    [self setOriginalViewSize:CGSizeZero];
+    // Phase and size are initially HLSViewControllerLifeCyclePhaseInitialized and CGSizeZero
+    HLSViewControllerLifeCycleState *lifeCycleState = [[[HLSViewControllerLifeCycleState alloc] init] autorelease];
+    objc_setAssociatedObject(self, s_lifeCycleStateKey, lifeCycleState, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
 }
 
 #pragma mark Accessors and mutators
 
+- (HLSViewControllerLifeCycleState *)lifeCycleState
+{
+    HLSViewControllerLifeCycleState *lifeCycleState = objc_getAssociatedObject(self, s_lifeCycleStateKey);
+    if (! lifeCycleState) {
+        // Should not happen since all initializers are swizzled, but be safe
+        [self uiViewControllerHLSExtensionsInit];
+        lifeCycleState = objc_getAssociatedObject(self, s_lifeCycleStateKey);
+    }
+    return lifeCycleState;
+}
+
 - (void)setLifeCyclePhase:(HLSViewControllerLifeCyclePhase)lifeCyclePhase
 {
-    objc_setAssociatedObject(self, s_lifeCyclePhaseKey, [NSNumber numberWithInt:lifeCyclePhase], OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+    [self lifeCycleState].lifeCyclePhase = lifeCyclePhase;
 }
 
 - (void)setOriginalViewSize:(CGSize)originalViewSize
 {
-    objc_setAssociatedObject(self, s_originalViewSizeKey, [NSValue valueWithCGSize:originalViewSize], OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+    [self lifeCycleState].originalViewSize = originalViewSize;
+}
+
+@end
+
+@implementation HLSViewControllerLifeCycleState
+
+#pragma mark Accessors and mutators
+
+@synthesize lifeCyclePhase = m_lifeCyclePhase;
+
+@synthesize originalViewSize = m_originalViewSize;
+
+@synthesize viewDidLoadTime = m_viewDidLoadTime;
+
+@synthesize transitionStartTime = m_transitionStartTime;
+
+@end
+
+@implementation HLSViewControllerLifeCycleTiming
+
+#pragma mark Accessors and mutators
+
+@synthesize count = m_count;
+
+@synthesize totalDuration = m_totalDuration;
+
+- (void)addDuration:(NSTimeInterval)duration
+{
+    ++m_count;
+    m_totalDuration += duration;
+    m_maximumDuration = MAX(m_maximumDuration, duration);
+}
+
+- (NSDictionary *)statistics
+{
+    return [NSDictionary dictionaryWithObjectsAndKeys:[NSNumber numberWithUnsignedInteger:m_count], HLSViewControllerLifeCycleTimingCountKey,
+            [NSNumber numberWithDouble:m_count != 0 ? m_totalDuration / m_count : 0.], HLSViewControllerLifeCycleTimingAverageKey,
+            [NSNumber numberWithDouble:m_maximumDuration], HLSViewControllerLifeCycleTimingMaximumKey,
+            [NSNumber numberWithDouble:m_totalDuration], HLSViewControllerLifeCycleTimingTotalKey,
+            nil];
 }
 
 @end
 
+#pragma mark Lifecycle timing
+
+static void HLSViewControllerRecordLifeCycleTiming(UIViewController *viewController, NSString *metric, NSTimeInterval duration)
+{
+    NSString *className = NSStringFromClass([viewController class]);
+    NSMutableDictionary *metricToTimingMap = [s_classNameToLifeCycleTimingsMap objectForKey:className];
+    if (! metricToTimingMap) {
+        metricToTimingMap = [NSMutableDictionary dictionary];
+        [s_classNameToLifeCycleTimingsMap setObject:metricToTimingMap forKey:className];
+    }
+    
+    HLSViewControllerLifeCycleTiming *timing = [metricToTimingMap objectForKey:metric];
+    if (! timing) {
+        timing = [[[HLSViewControllerLifeCycleTiming alloc] init] autorelease];
+        [metricToTimingMap setObject:timing forKey:metric];
+    }
+    [timing addDuration:duration];
+}
+
+// The context is a dictionary mapping class names to their total duration
+static NSInteger compareClassNamesByDecreasingTotalDuration(id className1, id className2, void *context)
+{
+    NSDictionary *classNameToTotalDurationMap = (NSDictionary *)context;
+    return [[classNameToTotalDurationMap objectForKey:className2] compare:[classNameToTotalDurationMap objectForKey:className1]];
+}
+
 #pragma mark Swizzled method implementations
 
 static id swizzled_UIViewController__initWithNibName_bundle_Imp(UIViewController *self, SEL _cmd, NSString *nibName, NSBundle *bundle)
@@ -362,6 +552,32 @@ static id swizzled_UIViewController__initWithCoder_Imp(UIViewController *self, S
     return self;
 }
 
+static id swizzled_UIViewController__view_Imp(UIViewController *self, SEL _cmd)
+{
+    // Fast path: This accessor is called very often
+    if (! s_lifeCycleTimingEnabled || [self isViewLoaded]) {
+        return (*s_UIViewController__view_Imp)(self, _cmd);
+    }
+    
+    HLSViewControllerLifeCycleState *lifeCycleState = [self lifeCycleState];
+    lifeCycleState.viewDidLoadTime = 0.;
+    
+    NSTimeInterval startTime = HLSLoggerMonotonicTime();
+    id view = (*s_UIViewController__view_Imp)(self, _cmd);
+    NSTimeInterval endTime = HLSLoggerMonotonicTime();
+    
+    // If -[super viewDidLoad] was not reached, the whole duration is accounted to view loading
+    NSTimeInterval viewDidLoadTime = lifeCycleState.viewDidLoadTime;
+    if (viewDidLoadTime != 0.) {
+        HLSViewControllerRecordLifeCycleTiming(self, HLSViewControllerLifeCycleMetricLoadView, viewDidLoadTime - startTime);
+        HLSViewControllerRecordLifeCycleTiming(self, HLSViewControllerLifeCycleMetricViewDidLoad, endTime - viewDidLoadTime);
+    }
+    else {
+        HLSViewControllerRecordLifeCycleTiming(self, HLSViewControllerLifeCycleMetricLoadView, endTime - startTime);
+    }
+    return view;
+}
+
 static void swizzled_UIViewController__viewDidLoad_Imp(UIViewController *self, SEL _cmd)
 {
     if (! [self isViewLoaded]) {
@@ -380,6 +596,10 @@ static void swizzled_UIViewController__viewDidLoad_Imp(UIViewController *self, S
     
     [self setOriginalViewSize:self.view.bounds.size];
     [self setLifeCyclePhase:HLSViewControllerLifeCyclePhaseViewDidLoad];
+    
+    if (s_lifeCycleTimingEnabled) {
+        [self lifeCycleState].viewDidLoadTime = HLSLoggerMonotonicTime();
+    }
 }
 
 static void swizzled_UIViewController__viewWillAppear_Imp(UIViewController *self, SEL _cmd, BOOL animated)
@@ -393,6 +613,8 @@ static void swizzled_UIViewController__viewWillAppear_Imp(UIViewController *self
     }
     
     [self setLifeCyclePhase:HLSViewControllerLifeCyclePhaseViewWillAppear];
+    
+    [self lifeCycleState].transitionStartTime = s_lifeCycleTimingEnabled ? HLSLoggerMonotonicTime() : 0.;
 }
 
 static void swizzled_UIViewController__viewDidAppear_Imp(UIViewController *self, SEL _cmd, BOOL animated)
@@ -405,7 +627,14 @@ static void swizzled_UIViewController__viewDidAppear_Imp(UIViewController *self,
                       "or maybe [super viewDidAppear:] has not been called by class %@ or one of its parents", self, [self class]);
     }
     
-    [self setLifeCyclePhase:HLSViewControllerLifeCyclePhaseViewDidAppear];    
+    [self setLifeCyclePhase:HLSViewControllerLifeCyclePhaseViewDidAppear];
+    
+    HLSViewControllerLifeCycleState *lifeCycleState = [self lifeCycleState];
+    if (s_lifeCycleTimingEnabled && lifeCycleState.transitionStartTime != 0.) {
+        HLSViewControllerRecordLifeCycleTiming(self, HLSViewControllerLifeCycleMetricAppearance, 
+                                               HLSLoggerMonotonicTime() - lifeCycleState.transitionStartTime);
+    }
+    lifeCycleState.transitionStartTime = 0.;
 }
 
 static void swizzled_UIViewController__viewWillDisappear_Imp(UIViewController *self, SEL _cmd, BOOL animated)
@@ -420,6 +649,8 @@ static void swizzled_UIViewController__viewWillDisappear_Imp(UIViewController *s
     
     [self setLifeCyclePhase:HLSViewControllerLifeCyclePhaseViewWillDisappear];
     
+    [self lifeCycleState].transitionStartTime = s_lifeCycleTimingEnabled ? HLSLoggerMonotonicTime() : 0.;
+    
     // Automatic keyboard dismissal when the view disappears. We test that the view has been loaded to account for the possibility 
     // that the view lifecycle has been incorrectly implemented
     if ([self isViewLoaded]) {
@@ -446,6 +677,13 @@ static void swizzled_UIViewController__viewDidDisappear_Imp(UIViewController *se
     }
     
     [self setLifeCyclePhase:HLSViewControllerLifeCyclePhaseViewDidDisappear];
+    
+    HLSViewControllerLifeCycleState *lifeCycleState = [self lifeCycleState];
+    if (s_lifeCycleTimingEnabled && lifeCycleState.transitionStartTime != 0.) {
+        HLSViewControllerRecordLifeCycleTiming(self, HLSViewControllerLifeCycleMetricDisappearance, 
+                                               HLSLoggerMonotonicTime() - lifeCycleState.transitionStartTime);
+    }
+    lifeCycleState.transitionStartTime = 0.;
 }
 
 static void swizzled_UIViewController__viewWillUnload_Imp(UIViewController *self, SEL _cmd)
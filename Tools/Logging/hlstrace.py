@@ -0,0 +1,73 @@
+#!/usr/bin/env python
+#
+# Decode the binary trace files written by HLSLogger (HLSLoggerTrace macro)
+#
+# Usage: hlstrace.py file1.hlstrace [file2.hlstrace ...]
+#
+# Files are decoded in the order they are given (pass segments from the oldest to the most recent one, which is
+# the alphabetical order of their names). Each file is made of little-endian records:
+#   - format definition: 'D', uint32 identifier, uint16 length, format bytes (UTF-8)
+#   - entry: 'E', uint32 identifier, double timestamp (since 1970), uint8 count, count doubles
+# Identifiers are reused between application launches, a definition always preceding the entries using it
+import datetime
+import re
+import struct
+import sys
+
+CONVERSION_PATTERN = re.compile(r'%([-+ #0-9.]*)[hlLqjzt]*([A-Za-z@%]?)')
+
+def format_entry(format, values):
+    values = list(values)
+    def replace(match):
+        flags, conversion = match.group(1), match.group(2)
+        if conversion == '%':
+            return '%'
+        value = values.pop(0) if values else 0.
+        if not conversion or conversion not in 'diouxXeEfFgGaAc':
+            return '?'
+        if conversion in 'di':
+            return ('%' + flags + 'd') % int(value)
+        if conversion in 'ouxX':
+            return ('%' + flags + conversion) % int(value)
+        if conversion == 'c':
+            return chr(int(value))
+        if conversion in 'aA':
+            return float(value).hex()
+        return ('%' + flags + conversion) % value
+    return CONVERSION_PATTERN.sub(replace, format)
+
+def decode(path):
+    formats = {}
+    with open(path, 'rb') as file:
+        data = file.read()
+    offset = 0
+    while offset < len(data):
+        record_type = data[offset:offset + 1]
+        offset += 1
+        if record_type == b'D':
+            identifier, length = struct.unpack_from('<IH', data, offset)
+            offset += 6
+            formats[identifier] = data[offset:offset + length].decode('utf-8', 'replace')
+            offset += length
+        elif record_type == b'E':
+            identifier, timestamp, count = struct.unpack_from('<IdB', data, offset)
+            offset += 13
+            values = struct.unpack_from('<%dd' % count, data, offset)
+            offset += 8 * count
+            format = formats.get(identifier)
+            if format is None:
+                message = '<unknown format %d> %s' % (identifier, ', '.join(repr(value) for value in values))
+            else:
+                message = format_entry(format, values)
+            time = datetime.datetime.fromtimestamp(timestamp).strftime('%Y-%m-%d %H:%M:%S.%f')[:-3]
+            print('%s [TRACE] %s' % (time, message))
+        else:
+            sys.stderr.write('%s: corrupted record at offset %d, stopping\n' % (path, offset - 1))
+            return
+
+if __name__ == '__main__':
+    if len(sys.argv) < 2:
+        sys.stderr.write('Usage: %s file1.hlstrace [file2.hlstrace ...]\n' % sys.argv[0])
+        sys.exit(1)
+    for path in sys.argv[1:]:
+        decode(path)
@@ -0,0 +1,44 @@
+#!/usr/bin/env python
+#
+# Aggregate message send logs into per-selector counts, most frequent first. Logs are written by HLSMessageSendProfilingStart
+# (in the application caches directory) or by instrumentObjcMessageSends (/tmp/msgSends-XXXX)
+#
+# Usage: msgsends.py [-c] [-n count] file1 [file2 ...]
+#   -c          count per implementing class and selector (e.g. -[UIView setFrame:]) instead of per selector
+#   -n count    only display the count most frequent entries
+#
+# Each line has the following format:
+#   <+ or -> <Receiver object class> <Class which implements the method> <Selector name>
+import collections
+import getopt
+import sys
+
+def aggregate(paths, by_class):
+    counts = collections.Counter()
+    for path in paths:
+        with open(path, 'r') as file:
+            for line in file:
+                fields = line.split()
+                if len(fields) != 4 or fields[0] not in '+-':
+                    continue
+                method_type, objects_class, implementing_class, selector = fields
+                if by_class:
+                    counts['%s[%s %s]' % (method_type, implementing_class, selector)] += 1
+                else:
+                    counts[selector] += 1
+    return counts
+
+if __name__ == '__main__':
+    try:
+        options, paths = getopt.getopt(sys.argv[1:], 'cn:')
+    except getopt.GetoptError:
+        paths = []
+    if not paths:
+        sys.stderr.write('Usage: %s [-c] [-n count] file1 [file2 ...]\n' % sys.argv[0])
+        sys.exit(1)
+    options = dict(options)
+    limit = int(options['-n']) if '-n' in options else None
+    counts = aggregate(paths, '-c' in options)
+    total = sum(counts.values())
+    for name, count in counts.most_common(limit):
+        print('%10d %6.2f%% %s' % (count, 100. * count / total, name))